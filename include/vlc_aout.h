@@ -60,6 +60,10 @@
  * above which upsampling will be performed */
 #define AOUT_MAX_PTS_DELAY              VLC_TICK_FROM_MS(60)
 
+/** Buffering targeted by the outputs in low-latency mode
+ * ("audio-low-latency"), the drift tolerance is halved accordingly */
+#define AOUT_LOW_LATENCY_TIME           VLC_TICK_FROM_MS(20)
+
 /* Max acceptable resampling (in %) */
 #define AOUT_MAX_RESAMPLING             10
 
@@ -47,6 +47,11 @@ struct audio_volume
 
     vlc_fourcc_t format; /**< Audio samples format */
     void (*amplify)(audio_volume_t *, block_t *, float); /**< Amplifier */
+    /**
+     * Amplifier ramping linearly from the first to the second factor over the
+     * buffer, to avoid clicks on volume changes (optional, may be NULL)
+     */
+    void (*amplify_ramp)(audio_volume_t *, block_t *, float, float);
 };
 
 /** @} */
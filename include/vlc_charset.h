@@ -49,6 +49,16 @@
  */
 VLC_API ssize_t vlc_towc(const char *str, uint32_t *restrict pwc);
 
+/**
+ * Measures the ASCII prefix of a bytes sequence.
+ *
+ * \param str bytes sequence to check
+ * \param length length of the sequence in bytes
+ *
+ * \return the number of leading bytes below 0x80 (at most length)
+ */
+VLC_API size_t vlc_ascii_span(const char *str, size_t length) VLC_USED;
+
 /**
  * Checks UTF-8 validity.
  *
@@ -61,15 +71,22 @@ VLC_API ssize_t vlc_towc(const char *str, uint32_t *restrict pwc);
  */
 VLC_USED static inline const char *IsUTF8(const char *str)
 {
+    const char *end = str + strlen(str);
     ssize_t n;
     uint32_t cp;
 
-    while ((n = vlc_towc(str, &cp)) != 0)
-        if (likely(n != -1))
-            str += n;
-        else
+    for (;;)
+    {
+        /* skip ASCII runs in bulk */
+        str += vlc_ascii_span(str, end - str);
+        if (str == end)
+            return str;
+
+        n = vlc_towc(str, &cp);
+        if (unlikely(n == -1))
             return NULL;
-    return str;
+        str += n;
+    }
 }
 
 /**
@@ -85,12 +102,9 @@ VLC_USED static inline const char *IsUTF8(const char *str)
  */
 VLC_USED static inline const char *IsASCII(const char *str)
 {
-    unsigned char c;
+    size_t len = strlen(str);
 
-    for (const char *p = str; (c = *p) != '\0'; p++)
-        if (c >= 0x80)
-            return NULL;
-    return str;
+    return (vlc_ascii_span(str, len) == len) ? str : NULL;
 }
 
 /**
@@ -114,10 +128,17 @@ VLC_USED static inline const char *IsASCII(const char *str)
 static inline char *EnsureUTF8(char *str)
 {
     char *ret = str;
+    const char *end = str + strlen(str);
     ssize_t n;
     uint32_t cp;
 
-    while ((n = vlc_towc(str, &cp)) != 0)
+    for (;;)
+    {
+        str += vlc_ascii_span(str, end - str);
+        if (str == end)
+            return ret;
+
+        n = vlc_towc(str, &cp);
         if (likely(n != -1))
             str += n;
         else
@@ -125,7 +146,7 @@ static inline char *EnsureUTF8(char *str)
             *str++ = '?';
             ret = NULL;
         }
-    return ret;
+    }
 }
 
 /**
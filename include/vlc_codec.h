@@ -115,6 +115,11 @@ struct decoder_t
     /* Tell the decoder if it is allowed to drop frames */
     bool                b_frame_drop_allowed;
 
+    /* Tell the packetizer that its output is remuxed, not decoded: only
+     * access units and random access points matter, and data for the
+     * decoder side (closed captions...) can be skipped */
+    bool                b_packetize_only;
+
     /**
      * Number of extra (ie in addition to the DPB) picture buffers
      * needed for decoding.
@@ -591,6 +596,7 @@ enum vlc_decoder_device_type
     VLC_DECODER_DEVICE_NVDEC,
     VLC_DECODER_DEVICE_MMAL,
     VLC_DECODER_DEVICE_GSTDECODE,
+    VLC_DECODER_DEVICE_VULKAN,
 };
 
 struct vlc_decoder_device_operations
@@ -627,6 +633,7 @@ typedef struct vlc_decoder_device
      * AWindow: android AWindowHandler*
      * NVDEC: decoder_device_nvdec_t*
      * MMAL: MMAL_PORT_T*
+     * VULKAN: vlc_vk_device_t*
      */
     void *opaque;
 } vlc_decoder_device;
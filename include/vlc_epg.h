@@ -81,6 +81,13 @@ VLC_API void vlc_epg_event_Delete(vlc_epg_event_t *p_event);
  */
 VLC_API vlc_epg_event_t * vlc_epg_event_Duplicate(const vlc_epg_event_t *p_src);
 
+/**
+ * Returns true if \p a and \p b describe the same event with the same
+ * contents.
+ */
+VLC_API bool vlc_epg_event_Equals(const vlc_epg_event_t *a,
+                                  const vlc_epg_event_t *b) VLC_USED;
+
 /**
  * It creates a new vlc_epg_t*
  *
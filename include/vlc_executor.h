@@ -23,6 +23,7 @@
 
 #include <vlc_common.h>
 #include <vlc_list.h>
+#include <vlc_tick.h>
 
 # ifdef __cplusplus
 extern "C" {
@@ -60,6 +61,43 @@ struct vlc_runnable {
 
     /* Private data used by the vlc_executor_t (do not touch) */
     struct vlc_list node;
+    vlc_tick_t submitted;
+};
+
+/**
+ * Scheduling priority of a runnable.
+ *
+ * Among the tasks of all the executors sharing the same threads, a task of a
+ * higher priority is always started before a task of a lower priority.
+ * Tasks of equal priority from a single executor are started in submission
+ * order, and executors get their turn in a round-robin fashion.
+ */
+enum vlc_executor_priority
+{
+    VLC_EXECUTOR_PRIORITY_LOW,
+    VLC_EXECUTOR_PRIORITY_NORMAL,
+    VLC_EXECUTOR_PRIORITY_HIGH,
+};
+
+/**
+ * Executor statistics, see vlc_executor_GetStats().
+ */
+struct vlc_executor_stats
+{
+    /** Number of tasks currently queued */
+    size_t queued;
+    /** Number of tasks currently running */
+    size_t running;
+    /** Highest number of queued tasks ever observed */
+    size_t max_queued;
+    /** Number of tasks started since the executor creation */
+    uint64_t started;
+    /** Number of tasks canceled before being started */
+    uint64_t canceled;
+    /** Cumulated time spent in the queue by started tasks */
+    vlc_tick_t total_wait;
+    /** Longest time spent in the queue by a started task */
+    vlc_tick_t max_wait;
 };
 
 /**
@@ -71,6 +109,27 @@ struct vlc_runnable {
 VLC_API vlc_executor_t *
 vlc_executor_New(unsigned max_threads);
 
+/**
+ * Create a new executor sharing the threads of another executor.
+ *
+ * The new executor has its own queue, and the tasks submitted to it can be
+ * canceled or waited on independently (see vlc_executor_Cancel() and
+ * vlc_executor_WaitIdle()). However, the tasks are executed by the same set
+ * of threads as the ones of the specified executor, so that idle threads can
+ * pick tasks from any queue instead of sleeping.
+ *
+ * The threads are kept alive until all the executors sharing them are
+ * deleted, in any order.
+ *
+ * \param other an executor whose threads are to be shared
+ * \param max_threads the maximum number of tasks from the new executor that
+ *                    may run concurrently; the shared set of threads is
+ *                    extended accordingly
+ * \return a pointer to a new executor, or NULL if an error occurred
+ */
+VLC_API vlc_executor_t *
+vlc_executor_NewShared(vlc_executor_t *other, unsigned max_threads);
+
 /**
  * Delete an executor.
  *
@@ -125,6 +184,9 @@ vlc_executor_Delete(vlc_executor_t *executor);
  *  }
  * \endcode
  *
+ * Tasks are started in order of priority (see enum vlc_executor_priority),
+ * then in submission order.
+ *
  * A runnable instance is intended to be submitted at most once. The caller is
  * expected to allocate a new task structure (embedding the runnable) for every
  * submission.
@@ -141,9 +203,28 @@ vlc_executor_Delete(vlc_executor_t *executor);
  *
  * \param executor the executor
  * \param runnable the task to run
+ * \param priority the scheduling priority of the task
  */
 VLC_API void
-vlc_executor_Submit(vlc_executor_t *executor, struct vlc_runnable *runnable);
+vlc_executor_SubmitPriority(vlc_executor_t *executor,
+                            struct vlc_runnable *runnable,
+                            enum vlc_executor_priority priority);
+
+/**
+ * Submit a runnable for execution with the normal priority.
+ *
+ * This is equivalent to vlc_executor_SubmitPriority() with
+ * VLC_EXECUTOR_PRIORITY_NORMAL.
+ *
+ * \param executor the executor
+ * \param runnable the task to run
+ */
+static inline void
+vlc_executor_Submit(vlc_executor_t *executor, struct vlc_runnable *runnable)
+{
+    vlc_executor_SubmitPriority(executor, runnable,
+                                VLC_EXECUTOR_PRIORITY_NORMAL);
+}
 
 /**
  * Cancel a runnable previously submitted.
@@ -176,6 +257,19 @@ vlc_executor_Cancel(vlc_executor_t *executor, struct vlc_runnable *runnable);
 VLC_API void
 vlc_executor_WaitIdle(vlc_executor_t *executor);
 
+/**
+ * Get the statistics of an executor.
+ *
+ * The statistics only account for the tasks submitted to this executor, even
+ * if its threads are shared with other executors.
+ *
+ * \param executor the executor
+ * \param stats structure to fill [OUT]
+ */
+VLC_API void
+vlc_executor_GetStats(vlc_executor_t *executor,
+                      struct vlc_executor_stats *stats);
+
 # ifdef __cplusplus
 }
 # endif
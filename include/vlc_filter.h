@@ -224,6 +224,11 @@ struct filter_t
     es_format_t         fmt_out;
     vlc_video_context   *vctx_out; // video filter, handled by the filter
     bool                b_allow_fmt_out_change;
+    /* Set by video filters that can write the output picture over the input
+     * picture, i.e. whose output pixels only depend on the input pixels at
+     * the same position. The owner may then return the input picture itself
+     * from filter_NewPicture(). */
+    bool                b_in_place;
 
     /* Name of the "video filter" shortcut that is requested, can be NULL */
     const char *        psz_name;
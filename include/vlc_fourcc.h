@@ -489,6 +489,10 @@
 #define VLC_CODEC_CVPX_BGRA       VLC_FOURCC('C','V','P','B')
 #define VLC_CODEC_CVPX_P010       VLC_FOURCC('C','V','P','P')
 
+/* Vulkan image opaque buffer type */
+#define VLC_CODEC_VULKAN_420        VLC_FOURCC('V','K','O','P') /* 4:2:0  8 bpc */
+#define VLC_CODEC_VULKAN_420_10BPP  VLC_FOURCC('V','K','O','0') /* 4:2:0 10 bpc */
+
 /* GStreamer Memory opaque buffer type */
 #define VLC_CODEC_GST_MEM_OPAQUE  VLC_FOURCC('G','S','T','M')
 
@@ -324,6 +324,78 @@ static inline vlc_frame_t *vlc_frame_Duplicate( const vlc_frame_t *frame )
     return p_dup;
 }
 
+/**
+ * Splits the leading bytes off a frame.
+ *
+ * Creates a frame referring to the first bytes of the payload of another
+ * frame, without copying. Both frames then share the underlying buffer, which
+ * is released along with the last frame referring to it.
+ *
+ * The leading frame has default properties (timestamps, flags...) and keeps
+ * the head room of the original frame. The remaining frame keeps the
+ * properties and the tail room. Neither can grow into the other.
+ *
+ * @note As the whole buffer is kept until all the parts are released, holding
+ * a small part of a large frame for a long time wastes memory.
+ *
+ * @param pp pointer to the frame to split [IN/OUT]; on success, it is updated
+ *           to point to the remaining part, which may be empty
+ * @param length number of payload bytes to split off
+ *        (must not exceed the payload size)
+ *
+ * @return the leading part on success, NULL on memory error
+ * (the original frame is then left untouched).
+ */
+VLC_API vlc_frame_t *vlc_frame_Split(vlc_frame_t **pp, size_t length) VLC_USED;
+
+/**
+ * Joins split frames back.
+ *
+ * Merges a chain of parts obtained with vlc_frame_Split() from the same
+ * frame, adjacent and in order, into a single frame without copying.
+ * The joined frame keeps the properties of the first part and the sum of
+ * the lengths.
+ *
+ * @param chain chain of frames to join
+ *
+ * @return the joined frame, the rest of the chain being released, or NULL if
+ * the frames are not adjacent parts of one frame (the chain is then left
+ * untouched).
+ */
+VLC_API vlc_frame_t *vlc_frame_TryJoin(vlc_frame_t *chain) VLC_USED;
+
+/**
+ * Shares a frame.
+ *
+ * Creates another frame with the same payload and properties, without
+ * copying. Both frames then refer to the same buffer, which is released
+ * along with the last frame referring to it.
+ *
+ * Shared frames are read-only: they have no head nor tail room, and must be
+ * passed through vlc_frame_MakeWritable() before their payload is modified.
+ * The next frame in the chain, if any, is not shared.
+ *
+ * @param pp pointer to the frame to share [IN/OUT]; on success, it may be
+ *           updated to point to a read-only view of the same payload
+ *
+ * @return the new view on success, NULL on memory error
+ * (the original frame is then left untouched).
+ */
+VLC_API vlc_frame_t *vlc_frame_Share(vlc_frame_t **pp) VLC_USED;
+
+/**
+ * Ensures the payload of a frame can be modified.
+ *
+ * Shared frames (see vlc_frame_Share()) are replaced with a copy, other
+ * frames are returned as is.
+ *
+ * @param frame the frame to write to, which is released if it is copied
+ *
+ * @return the writable frame, or NULL on memory error (the original frame is
+ * then released too).
+ */
+VLC_API vlc_frame_t *vlc_frame_MakeWritable(vlc_frame_t *frame) VLC_USED;
+
 /**
  * Wraps heap in a frame.
  *
@@ -590,6 +662,11 @@ static inline vlc_frame_t *vlc_frame_ChainGather( vlc_frame_t *p_list )
     if( p_list->p_next == NULL )
         return p_list;  /* Already gathered */
 
+    /* Parts of a split frame merge back without a copy */
+    g = vlc_frame_TryJoin( p_list );
+    if( g )
+        return g;
+
     vlc_frame_ChainProperties( p_list, NULL, &i_total, &i_length );
 
     g = vlc_frame_Alloc( i_total );
@@ -884,6 +961,104 @@ static inline size_t vlc_fifo_Count (vlc_fifo_t *fifo)
     return depth;
 }
 
+/**
+ * @}
+ * \defgroup frame_ring Frame ring
+ * Lock-free single-producer single-consumer frame queue
+ *
+ * A frame ring is a bounded queue of frames with exactly one producer thread
+ * and one consumer thread. Frames are queued and dequeued in batches without
+ * taking any lock, and the consumer is only woken up if it is actually
+ * sleeping. This is cheaper than a \ref block_fifo for simple hand-offs where
+ * no other state needs to be protected.
+ * @{
+ */
+
+typedef struct vlc_frame_ring vlc_frame_ring_t;
+
+/**
+ * Creates a single-producer single-consumer frame ring.
+ *
+ * @param capacity minimum number of frames the ring can hold
+ *                 (it is rounded up to a power of two)
+ * @return the ring or NULL on memory error
+ */
+VLC_API vlc_frame_ring_t *vlc_frame_ring_New(size_t capacity)
+VLC_USED VLC_MALLOC;
+
+/**
+ * Deletes a frame ring created by vlc_frame_ring_New().
+ *
+ * @note Any queued frames are released.
+ * @warning Neither the producer nor the consumer may be using the ring when
+ * this function is called.
+ */
+VLC_API void vlc_frame_ring_Delete(vlc_frame_ring_t *);
+
+/**
+ * Queues a batch of frames.
+ *
+ * Only the producer thread may call this function.
+ * Frames are queued in order, until the ring is full. The ownership of the
+ * frames that could not be queued remains with the caller.
+ *
+ * @note Chained frames (vlc_frame_t.p_next) count as a single entry.
+ *
+ * @param frames table of frames to queue
+ * @param count number of frames in the table
+ * @return the number of frames actually queued (possibly zero)
+ */
+VLC_API size_t vlc_frame_ring_Enqueue(vlc_frame_ring_t *,
+                                      vlc_frame_t *const *frames,
+                                      size_t count);
+
+/**
+ * Dequeues a batch of frames.
+ *
+ * Only the consumer thread may call this function. It never waits.
+ *
+ * @param frames table to store the dequeued frames into [OUT]
+ * @param max size of the table
+ * @return the number of dequeued frames (zero if the ring is empty)
+ */
+VLC_API size_t vlc_frame_ring_Dequeue(vlc_frame_ring_t *,
+                                      vlc_frame_t **frames, size_t max)
+VLC_USED;
+
+/**
+ * Waits for frames to be queued.
+ *
+ * Only the consumer thread may call this function. It returns when the ring
+ * is not empty, or when vlc_frame_ring_Signal() is called.
+ * This function may also return spuriously at any moment.
+ */
+VLC_API void vlc_frame_ring_Wait(vlc_frame_ring_t *);
+
+/**
+ * Wakes up the consumer thread if it is waiting on the ring.
+ *
+ * This can be called from any thread, e.g. to request termination.
+ */
+VLC_API void vlc_frame_ring_Signal(vlc_frame_ring_t *);
+
+/**
+ * Counts frames in a ring.
+ *
+ * @note The value is only accurate when called from the producer or consumer
+ * thread, and may be outdated by the time it is returned.
+ */
+VLC_API size_t vlc_frame_ring_GetCount(const vlc_frame_ring_t *) VLC_USED;
+
+/**
+ * Counts bytes in a ring.
+ *
+ * This is the sum of vlc_frame_t.i_buffer of all queued frames, including
+ * chained ones.
+ *
+ * @note The same accuracy limitations as vlc_frame_ring_GetCount() apply.
+ */
+VLC_API size_t vlc_frame_ring_GetBytes(const vlc_frame_ring_t *) VLC_USED;
+
 /** @} */
 
 /** @} */
@@ -25,6 +25,7 @@
 
 # include <vlc_picture.h>
 # include <vlc_picture_fifo.h>
+# include <vlc_threads.h>
 
 /**
  * \file
@@ -55,11 +56,12 @@ struct image_handler_t
 
     /* Private properties */
     vlc_object_t *p_parent;
-    decoder_t *p_dec;
+    decoder_t *p_dec[4]; /* by most recent use, one per codec */
     encoder_t *p_enc;
     filter_t  *p_converter;
 
     picture_fifo_t *outfifo;
+    vlc_mutex_t lock; /* the handler can be shared by threads */
 };
 
 VLC_API image_handler_t * image_HandlerCreate( vlc_object_t * ) VLC_USED;
@@ -221,6 +221,18 @@ VLC_API input_item_node_t * input_item_node_Create( input_item_t *p_input ) VLC_
  */
 VLC_API input_item_node_t * input_item_node_AppendItem( input_item_node_t *p_node, input_item_t *p_item );
 
+/**
+ * Add new child nodes to this parent node, pointing to these subitems.
+ *
+ * The children array grows once for all the items, so that large lists can
+ * be added in batches rather than one item at a time.
+ *
+ * \return VLC_SUCCESS, or VLC_ENOMEM if no items were added
+ */
+VLC_API int input_item_node_AppendItems( input_item_node_t *p_node,
+                                         input_item_t *const *pp_items,
+                                         size_t i_count );
+
 /**
  * Add an already created node to children of this parent node.
  */
@@ -524,12 +536,27 @@ input_item_parser_id_Release(input_item_parser_id_t *parser);
 /******************
  * Input stats
  ******************/
+#define INPUT_STATS_QUEUE_LATENCY_BUCKETS 8
+#define INPUT_STATS_FRAME_LATENCY_BUCKETS 8
+#define INPUT_STATS_MAX_MODULES 16
+
+/** Resources used by one module of the pipeline, with --stats-modules */
+struct input_stats_module_t
+{
+    char psz_kind[16]; /**< demux, packetizer, decoder, sout or vout */
+    char psz_name[32]; /**< module name */
+    vlc_tick_t i_cpu_time; /**< CPU time of the calling threads */
+    uint64_t i_calls;
+    uint64_t i_allocs; /**< pictures requested or audio buffers output */
+};
+
 struct input_stats_t
 {
     /* Input */
     uint64_t i_read_packets;
     uint64_t i_read_bytes;
     float f_input_bitrate;
+    uint64_t i_read_dropped; /**< Packets lost before the access read them */
 
     /* Demux */
     uint64_t i_demux_read_packets;
@@ -546,10 +573,35 @@ struct input_stats_t
     uint64_t i_displayed_pictures;
     uint64_t i_late_pictures;
     uint64_t i_lost_pictures;
+    vlc_tick_t i_render_time; /**< GPU time spent rendering the pictures */
+    /** Per-frame timings: the n-th bucket counts the pictures that took less
+     * than 2^n ms, the last one all the others */
+    uint64_t i_frame_queue[INPUT_STATS_FRAME_LATENCY_BUCKETS]; /**< decoded to rendered */
+    uint64_t i_frame_render[INPUT_STATS_FRAME_LATENCY_BUCKETS]; /**< rendering time */
+    uint64_t i_frame_present[INPUT_STATS_FRAME_LATENCY_BUCKETS]; /**< displayed to vsync */
 
     /* Aout */
     uint64_t i_played_abuffers;
     uint64_t i_lost_abuffers;
+
+    /* Decoder queues */
+    uint64_t i_queued_blocks; /**< Blocks waiting to be decoded */
+    uint64_t i_queued_bytes; /**< Bytes waiting to be decoded */
+    uint64_t i_dropped_blocks; /**< Blocks dropped from full queues */
+    /** Time spent by the blocks in the queues: the n-th bucket counts the
+     * blocks that waited less than 4^n ms, the last one all the others */
+    uint64_t i_queue_latency[INPUT_STATS_QUEUE_LATENCY_BUCKETS];
+
+    /* Input clock, when the source pace is not controlled */
+    float f_clock_skew; /**< Drift of the source clock, in ppm */
+    vlc_tick_t i_clock_jitter; /**< Mean delay of the clock references */
+
+    /** From the last seek (decoders flush) to its first queued picture */
+    vlc_tick_t i_seek_latency;
+
+    /* Modules, in loading order */
+    size_t i_modules;
+    struct input_stats_module_t modules[INPUT_STATS_MAX_MODULES];
 };
 
 /**
@@ -204,6 +204,22 @@ VLC_API input_item_node_t *
 vlc_media_tree_Add(vlc_media_tree_t *tree, input_item_node_t *parent,
                    input_item_t *media);
 
+/**
+ * Add several items to the media tree.
+ *
+ * The listeners are notified once for all the added items.
+ *
+ * \param tree the media tree, locked
+ * \param parent the parent node, belonging to the media tree
+ * \param medias the medias to add as children of `parent`
+ * \param count the number of medias
+ * \return the number of items added (they are added in order, and the ones
+ *         failing to be allocated are skipped)
+ */
+VLC_API size_t
+vlc_media_tree_AddItems(vlc_media_tree_t *tree, input_item_node_t *parent,
+                        input_item_t *const medias[], size_t count);
+
 /**
  * Remove an item from the media tree.
  *
@@ -213,6 +229,21 @@ vlc_media_tree_Add(vlc_media_tree_t *tree, input_item_node_t *parent,
 VLC_API bool
 vlc_media_tree_Remove(vlc_media_tree_t *tree, input_item_t *media);
 
+/**
+ * Remove several items from the media tree.
+ *
+ * The listeners are notified once for each run of consecutive medias sharing
+ * the same parent.
+ *
+ * \param tree the media tree, locked
+ * \param medias the medias to remove
+ * \param count the number of medias
+ * \return the number of items removed
+ */
+VLC_API size_t
+vlc_media_tree_RemoveItems(vlc_media_tree_t *tree,
+                           input_item_t *const medias[], size_t count);
+
 /**
  * Find the node containing the requested input item (and its parent).
  *
@@ -321,6 +321,20 @@ VLC_API int vlc_getaddrinfo (const char *node, unsigned i_port,
 VLC_API int vlc_getaddrinfo_i11e(const char *, unsigned,
                                  const struct addrinfo *, struct addrinfo **);
 
+/**
+ * Resolves a host name through the process-wide resolution cache.
+ *
+ * This is the same as vlc_getaddrinfo_i11e(), except that the results are
+ * kept for a while to be reused by later calls. The resulting list is shared
+ * and must not be modified.
+ *
+ * On success, *res must be freed with vlc_freeaddrinfo_cached().
+ */
+VLC_API int vlc_getaddrinfo_cached(const char *, unsigned,
+                                   const struct addrinfo *,
+                                   struct addrinfo **);
+VLC_API void vlc_freeaddrinfo_cached(struct addrinfo *);
+
 static inline bool
 net_SockAddrIsMulticast (const struct sockaddr *addr, socklen_t len)
 {
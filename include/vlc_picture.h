@@ -100,6 +100,7 @@ enum vlc_video_context_type
     VLC_VIDEO_CONTEXT_CVPX,      //!< private: cvpx_video_context*
     VLC_VIDEO_CONTEXT_MMAL,      //!< empty
     VLC_VIDEO_CONTEXT_GSTDECODE, //!< empty
+    VLC_VIDEO_CONTEXT_VULKAN,    //!< empty
 };
 
 VLC_API vlc_video_context * vlc_video_context_Create(vlc_decoder_device *,
@@ -415,6 +416,28 @@ VLC_API void picture_Copy( picture_t *p_dst, const picture_t *p_src );
  */
 VLC_API picture_t *picture_Clone(picture_t *pic);
 
+/**
+ * Create a view of a rectangle of a picture
+ *
+ * The view uses the planes of the picture, which it holds, without copying
+ * the pixels. Only the pixels are shared, the properties of the picture
+ * are not copied (see picture_CopyProperties()).
+ *
+ * This only works for pictures in system memory.
+ *
+ * \param pic the picture to take the rectangle from
+ * \param fmt the format of the view, giving the size of the rectangle
+ * \param x the horizontal offset of the rectangle, in luma samples from
+ *          the start of the planes
+ * \param y the vertical offset of the rectangle, in luma lines
+ * 
+eturn A new picture on success, NULL if the picture has a hardware
+ * context, if the offsets do not fall on chroma samples, if the rectangle
+ * does not fit in the planes, or on error.
+ */
+VLC_API picture_t *picture_NewView(picture_t *pic, const video_format_t *fmt,
+                                   unsigned x, unsigned y) VLC_USED;
+
 /**
  * Merge two ancillary arrays
  *
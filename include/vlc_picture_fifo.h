@@ -42,6 +42,15 @@ typedef struct picture_fifo_t picture_fifo_t;
  */
 VLC_API picture_fifo_t * picture_fifo_New( void ) VLC_USED;
 
+/**
+ * It creates an empty picture_fifo_t holding up to max pictures.
+ *
+ * picture_fifo_Push() never fails nor waits, producers are expected to call
+ * picture_fifo_WaitSpace() first. A max of 0 makes the fifo unbounded, as
+ * picture_fifo_New() does.
+ */
+VLC_API picture_fifo_t * picture_fifo_NewBounded( size_t max ) VLC_USED;
+
 /**
  * It destroys a fifo created by picture_fifo_New.
  *
@@ -56,11 +65,44 @@ VLC_API void picture_fifo_Delete( picture_fifo_t * );
  */
 VLC_API picture_t * picture_fifo_Pop( picture_fifo_t * ) VLC_USED;
 
+/**
+ * It retrieves, at once, the leading pictures dated before or at the given
+ * date.
+ *
+ * The pictures are stored in out, in order, and are owned by the caller.
+ *
+ * \return the number of pictures retrieved
+ */
+VLC_API size_t picture_fifo_PopUntil( picture_fifo_t *, vlc_tick_t date,
+                                      vlc_picture_chain_t *out );
+
+/**
+ * It returns the date of the next picture to be retrieved, or
+ * VLC_TICK_INVALID if the fifo is empty.
+ */
+VLC_API vlc_tick_t picture_fifo_PeekDate( picture_fifo_t * ) VLC_USED;
+
 /**
  * It returns whether the fifo is empty or not.
  */
 VLC_API bool picture_fifo_IsEmpty( picture_fifo_t * );
 
+/**
+ * It returns the number of pictures inside the fifo.
+ */
+VLC_API size_t picture_fifo_GetCount( picture_fifo_t * );
+
+/**
+ * It waits until a bounded fifo has room for one more picture.
+ *
+ * It returns at once for an unbounded fifo. Pictures being retrieved or
+ * flushed wake the waiters up.
+ *
+ * \param deadline time to give up at, or VLC_TICK_INVALID to wait forever
+ * \return 0 if there is room, ETIMEDOUT if the deadline was reached first
+ */
+VLC_API int picture_fifo_WaitSpace( picture_fifo_t *, vlc_tick_t deadline );
+
 /**
  * It saves a picture_t into the fifo.
  */
@@ -3537,6 +3537,97 @@ vlc_player_timer_point_GetNextIntervalDate(const struct vlc_player_timer_point *
 
 /** @} vlc_player__timer */
 
+/**
+ * @defgroup vlc_player__preview Seek bar previews
+ * @{
+ */
+
+/**
+ * Player preview listener opaque structure.
+ *
+ * This opaque structure is returned by vlc_player_preview_AddListener() and
+ * can be used to remove the listener via vlc_player_preview_RemoveListener().
+ */
+typedef struct vlc_player_preview_listener_id vlc_player_preview_listener_id;
+
+/**
+ * Player preview callbacks
+ *
+ * Can be registered with vlc_player_preview_AddListener().
+ *
+ * @warning These callbacks are called from a background thread, with an
+ * internal lock held. To avoid deadlocks, users should never call
+ * vlc_player_t functions from these callbacks.
+ */
+struct vlc_player_preview_cbs
+{
+    /**
+     * Called when a preview requested by vlc_player_preview_Get() is ready
+     *
+     * @param player player instance
+     * @param media media of the preview
+     * @param time time of the preview, as returned by vlc_player_preview_Get()
+     * @param picture downscaled picture, it must be held with picture_Hold()
+     * to be used past the callback scope
+     * @param data opaque pointer set by vlc_player_preview_AddListener()
+     */
+    void (*on_ready)(vlc_player_t *player, input_item_t *media,
+                     vlc_tick_t time, picture_t *picture, void *data);
+};
+
+/**
+ * Add a listener callback for previews
+ *
+ * @note The player instance doesn't need to be locked for
+ * vlc_player_preview_AddListener() and vlc_player_preview_RemoveListener().
+ *
+ * @param player player instance
+ * @param cbs pointer to a vlc_player_preview_cbs structure, the structure must
+ * be valid during the lifetime of the listener
+ * @param cbs_data opaque pointer used by the callbacks
+ * @return a valid listener id, or NULL in case of allocation error
+ */
+VLC_API vlc_player_preview_listener_id *
+vlc_player_preview_AddListener(vlc_player_t *player,
+                               const struct vlc_player_preview_cbs *cbs,
+                               void *cbs_data);
+
+/**
+ * Remove a preview listener callback
+ *
+ * @param player player instance
+ * @param listener_id listener id returned by vlc_player_preview_AddListener()
+ */
+VLC_API void
+vlc_player_preview_RemoveListener(vlc_player_t *player,
+                                  vlc_player_preview_listener_id *listener_id);
+
+/**
+ * Get a preview of the current media, typically for a seek bar hover
+ *
+ * Previews are small pictures of the key frames of the current media, decoded
+ * in the background (by a thumbnailer, independently of the playback) and
+ * cached by time. The time is rounded to a step depending on the media
+ * length, and the least recently used previews are evicted first.
+ *
+ * If the preview is not cached yet, it is requested, and
+ * vlc_player_preview_cbs.on_ready is called once it is available. A pending
+ * request for another time is cancelled: only the last requested time
+ * matters while the pointer moves along the seek bar.
+ *
+ * @param player locked player instance
+ * @param time media time to preview
+ * @param[out] preview_time time of the preview, passed to
+ * vlc_player_preview_cbs.on_ready if it is not cached yet (can be NULL)
+ * @return a picture to release with picture_Release(), or NULL if the preview
+ * is not cached yet (or if there is no media)
+ */
+VLC_API picture_t *
+vlc_player_preview_Get(vlc_player_t *player, vlc_tick_t time,
+                       vlc_tick_t *preview_time);
+
+/** @} vlc_player__preview */
+
 /** @} vlc_player */
 
 #endif
@@ -51,11 +51,16 @@ typedef size_t vlc_preparser_req_id;
 #define VLC_PREPARSER_TYPE_FETCHMETA_NET    0x04
 #define VLC_PREPARSER_TYPE_THUMBNAIL        0x08
 #define VLC_PREPARSER_TYPE_THUMBNAIL_TO_FILES 0x10
+#define VLC_PREPARSER_TYPE_LOUDNESS         0x20
 #define VLC_PREPARSER_TYPE_FETCHMETA_ALL \
     (VLC_PREPARSER_TYPE_FETCHMETA_LOCAL|VLC_PREPARSER_TYPE_FETCHMETA_NET)
 
 #define VLC_PREPARSER_OPTION_INTERACT 0x1000
 #define VLC_PREPARSER_OPTION_SUBITEMS 0x2000
+/** Run the parsing after the requests of normal priority */
+#define VLC_PREPARSER_OPTION_PRIORITY_LOW  0x4000
+/** Run the parsing before the requests of normal priority */
+#define VLC_PREPARSER_OPTION_PRIORITY_HIGH 0x8000
 
 /**
  * Preparser thumbnailer callbacks
@@ -126,6 +131,37 @@ struct vlc_thumbnailer_to_files_cbs
                      const bool *result_array, size_t result_count, void *data);
 };
 
+struct vlc_audio_loudness;
+
+/**
+ * Preparser loudness measurement callbacks
+ *
+ * Used by vlc_preparser_MeasureLoudness()
+ */
+struct vlc_preparser_loudness_cbs
+{
+    /**
+     * Event received on measurement completion or error
+     *
+     * This callback will always be called, provided
+     * vlc_preparser_MeasureLoudness() returned a valid request, and provided
+     * the request is not cancelled before its completion.
+     *
+     * @note This callback is mandatory if calling
+     * vlc_preparser_MeasureLoudness()
+     *
+     * @param item item used for the measurement
+     * @param status VLC_SUCCESS in case of success, VLC_ETIMEOUT in case of
+     * timeout, -EINTR if cancelled, an error otherwise
+     * @param loudness EBU R 128 measurement of the whole audio track
+     * (integrated, range and true peak) and of its last seconds (momentary
+     * and short-term), or NULL in case of failure
+     * @param data opaque pointer passed by vlc_preparser_MeasureLoudness()
+     */
+    void (*on_ended)(input_item_t *item, int status,
+                     const struct vlc_audio_loudness *loudness, void *data);
+};
+
 /**
  * Thumbnailer argument
  *
@@ -239,10 +275,25 @@ struct vlc_preparser_cfg
      */
     unsigned max_thumbnailer_threads;
 
+    /**
+     * The maximum number of items measured in parallel by the loudness
+     * meter, 0 for default (1 thread)
+     */
+    unsigned max_loudness_threads;
+
     /**
      * Timeout of the preparser and/or thumbnailer, 0 for no limits.
      */
     vlc_tick_t timeout;
+
+    /**
+     * Store the parsing results (duration, meta data and tracks) of local
+     * files on disk, and reuse them as long as the file path, size and
+     * modification time are unchanged.
+     *
+     * Cached results are not used for requests listening to attachments.
+     */
+    bool cache;
 };
 
 /**
@@ -278,6 +329,29 @@ VLC_API vlc_preparser_req_id
 vlc_preparser_Push( vlc_preparser_t *preparser, input_item_t *item, int type_option,
                     const input_item_parser_cbs_t *cbs, void *cbs_userdata );
 
+/**
+ * This function enqueues several items to be preparsed or fetched.
+ *
+ * This is equivalent to calling vlc_preparser_Push() for each item, with the
+ * same options and callbacks.
+ *
+ * @param preparser the preparser object
+ * @param items array of valid items to preparse
+ * @param count number of items
+ * @param type_option see vlc_preparser_Push()
+ * @param cbs callback to listen to events (can't be NULL)
+ * @param cbs_userdata opaque pointer used by the callbacks
+ * @param ids array of count ids to fill, or NULL; an id is
+ * VLC_PREPARSER_REQ_ID_INVALID if the corresponding item could not be
+ * scheduled
+ * @return number of items scheduled for preparsing
+ */
+VLC_API size_t
+vlc_preparser_PushBatch( vlc_preparser_t *preparser,
+                         input_item_t *const *items, size_t count,
+                         int type_option, const input_item_parser_cbs_t *cbs,
+                         void *cbs_userdata, vlc_preparser_req_id *ids );
+
 /**
  * This function enqueues the provided item for generating a thumbnail
  *
@@ -347,6 +421,29 @@ vlc_preparser_GenerateThumbnailToFiles( vlc_preparser_t *preparser, input_item_t
                                         const struct vlc_thumbnailer_to_files_cbs *cbs,
                                         void *cbs_userdata );
 
+/**
+ * This function measures the loudness of the audio of an item
+ *
+ * The default audio track is decoded as fast as possible, without any
+ * output, and analysed by the "ebur128" audio meter.
+ *
+ * @param preparser the preparser object, created with
+ * VLC_PREPARSER_TYPE_LOUDNESS
+ * @param item a valid item to measure
+ * @param cbs callback to listen to events (can't be NULL)
+ * @param cbs_userdata opaque pointer used by the callbacks
+ * @return VLC_PREPARSER_REQ_ID_INVALID in case of error, or a valid id if the
+ * item was scheduled for measurement. If this returns an error, the
+ * on_ended callback will *not* be invoked
+ *
+ * The provided input_item will be held by the preparser and can safely be
+ * released safely after calling this function.
+ */
+VLC_API vlc_preparser_req_id
+vlc_preparser_MeasureLoudness( vlc_preparser_t *preparser, input_item_t *item,
+                               const struct vlc_preparser_loudness_cbs *cbs,
+                               void *cbs_userdata );
+
 /**
  * This function cancel all preparsing requests for a given id
  *
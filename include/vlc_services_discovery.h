@@ -44,6 +44,12 @@ struct services_discovery_callbacks
     void (*item_added)(struct services_discovery_t *sd, input_item_t *parent,
                        input_item_t *item);
     void (*item_removed)(struct services_discovery_t *sd, input_item_t *item);
+    /* Optional batched variants, item_added() and item_removed() are called
+     * for each item if they are NULL */
+    void (*items_added)(struct services_discovery_t *sd, input_item_t *parent,
+                        input_item_t *const items[], size_t count);
+    void (*items_removed)(struct services_discovery_t *sd,
+                          input_item_t *const items[], size_t count);
 };
 
 struct services_discovery_owner_t
@@ -203,6 +209,45 @@ static inline void services_discovery_RemoveItem(services_discovery_t *sd,
     sd->owner.cbs->item_removed(sd, item);
 }
 
+/**
+ * Added services callback.
+ *
+ * Same as services_discovery_AddSubItem() for several items at once, sharing
+ * the same parent. The owner can then update its views only once.
+ *
+ * @param sd the service discovery instance exposing the items
+ * @param parent the parent to attach the items to (or NULL)
+ * @param items input items to add
+ * @param count number of items
+ */
+static inline void services_discovery_AddSubItems(services_discovery_t *sd,
+                                                  input_item_t *parent,
+                                                  input_item_t *const items[],
+                                                  size_t count)
+{
+    if (sd->owner.cbs->items_added != NULL)
+        sd->owner.cbs->items_added(sd, parent, items, count);
+    else
+        for (size_t i = 0; i < count; i++)
+            sd->owner.cbs->item_added(sd, parent, items[i]);
+}
+
+/**
+ * Removed services callback.
+ *
+ * Same as services_discovery_RemoveItem() for several items at once.
+ */
+static inline void services_discovery_RemoveItems(services_discovery_t *sd,
+                                                  input_item_t *const items[],
+                                                  size_t count)
+{
+    if (sd->owner.cbs->items_removed != NULL)
+        sd->owner.cbs->items_removed(sd, items, count);
+    else
+        for (size_t i = 0; i < count; i++)
+            sd->owner.cbs->item_removed(sd, items[i]);
+}
+
 /* SD probing */
 
 VLC_API int vlc_sd_probe_Add(vlc_probe_t *, const char *, const char *, int category);
@@ -40,6 +40,19 @@ extern "C" {
  * Byte streams and byte stream filter modules interface
  */
 
+/**
+ * Caching statistics of a stream (see STREAM_GET_CACHE_STATS)
+ */
+struct vlc_stream_cache_stats
+{
+    uint64_t hits; /**< Seeks served from the cached data */
+    uint64_t misses; /**< Seeks outside of the cached data */
+    uint64_t upstream_seeks; /**< Seeks performed on the underlying stream */
+    uint64_t upstream_bytes; /**< Bytes read from the underlying stream */
+    unsigned ranges; /**< Number of distinct ranges that can be cached */
+    bool alternating; /**< An alternating access pattern was detected */
+};
+
 struct vlc_stream_operations {
     /* Cannot fail */
     bool (*can_seek)(stream_t *);
@@ -74,6 +87,8 @@ struct vlc_stream_operations {
             int (*get_tags)(stream_t *, const block_t **);
             int (*get_private_id_state)(stream_t *, int, bool *);
             vlc_tick_t (*get_pts_delay)(stream_t *);
+            int (*get_cache_stats)(stream_t *, struct vlc_stream_cache_stats *);
+            int (*get_dropped_packets)(stream_t *, uint64_t *);
 
             int (*set_record_state)(stream_t *, bool, const char *, const char *);
             int (*set_private_id_state)(stream_t *, int, bool);
@@ -270,6 +285,8 @@ enum stream_query_e
     STREAM_GET_SIGNAL,                      /**< arg1=(double *pf_quality), arg2=(double *pf_strength) res=can fail */
     STREAM_GET_TAGS,                        /**< arg1=(const block_t **) res=can fail */
     STREAM_GET_TYPE,                        /**< arg1=(int*) res=can fail */
+    STREAM_GET_CACHE_STATS,                 /**< arg1=(struct vlc_stream_cache_stats *) res=can fail */
+    STREAM_GET_DROPPED_PACKETS,             /**< arg1=(uint64_t *) res=can fail */
 
     STREAM_SET_PAUSE_STATE = 0x200,         /**< arg1=(bool) res=can fail */
     STREAM_SET_TITLE,                       /**< arg1=(int) res=can fail */
@@ -500,6 +517,22 @@ VLC_USED static inline int vlc_stream_GetType(stream_t *s, int *type)
     return vlc_stream_Control(s, STREAM_GET_TYPE, type);
 }
 
+VLC_USED static inline int vlc_stream_GetCacheStats(stream_t *s,
+                                    struct vlc_stream_cache_stats *stats)
+{
+    return vlc_stream_Control(s, STREAM_GET_CACHE_STATS, stats);
+}
+
+/**
+ * Get the number of packets lost before they could be read, e.g. by the
+ * kernel when a socket receive buffer overflowed.
+ */
+VLC_USED static inline int vlc_stream_GetDroppedPackets(stream_t *s,
+                                                        uint64_t *dropped)
+{
+    return vlc_stream_Control(s, STREAM_GET_DROPPED_PACKETS, dropped);
+}
+
 /**
  * Get the size of the stream.
  */
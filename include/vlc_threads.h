@@ -954,6 +954,26 @@ VLC_API unsigned vlc_timer_getoverrun(vlc_timer_t timer) VLC_USED;
  */
 VLC_API unsigned vlc_GetCPUCount(void);
 
+/**
+ * Reserves worker threads from the process-wide CPU budget.
+ *
+ * Modules sizing their own thread pools (codecs...) should call this when
+ * opening instead of using vlc_GetCPUCount(). Concurrent instances then share
+ * the CPUs between them instead of each one using all of them.
+ *
+ * \param max maximum number of threads wanted (0 for no limit)
+ * \return number of granted threads, at least 1, to be given back with
+ *         vlc_CPUBudgetRelease()
+ */
+VLC_API unsigned vlc_CPUBudgetAcquire(unsigned max);
+
+/**
+ * Gives back threads reserved with vlc_CPUBudgetAcquire().
+ *
+ * \param count number of threads that were granted (0 is a no-op)
+ */
+VLC_API void vlc_CPUBudgetRelease(unsigned count);
+
 #if defined (LIBVLC_USE_PTHREAD_CLEANUP)
 /**
  * Registers a thread cancellation handler.
@@ -362,6 +362,20 @@ VLC_API char *vlc_tls_GetLine(vlc_tls_t *);
  */
 VLC_API ssize_t vlc_tls_Write(vlc_tls_t *, const void *buf, size_t len);
 
+/**
+ * Sends data from an I/O vector through a socket.
+ *
+ * This sends all the entries in order, waiting as needed like
+ * vlc_tls_Write() does. Gathering headers and payloads this way avoids
+ * sending them as separate packets on sockets without Nagle's algorithm.
+ *
+ * @param iov I/O vector to send data from (not modified)
+ * @param count number of entries of the I/O vector
+ * @return the number of bytes actually sent, or -1 on error.
+ */
+VLC_API ssize_t vlc_tls_WriteV(vlc_tls_t *, const struct iovec *iov,
+                               unsigned count);
+
 /**
  * Shuts a connection down.
  *
@@ -211,6 +211,118 @@ VLC_API int var_Get(vlc_object_t *obj, const char *name, vlc_value_t *valp);
 VLC_API int var_SetChecked( vlc_object_t *, const char *, int, vlc_value_t );
 VLC_API int var_GetChecked( vlc_object_t *, const char *, int, vlc_value_t * );
 
+/**
+ * \defgroup var_handle Variable handles
+ * Lookup-free access to a variable
+ *
+ * A variable can be resolved once to a handle, which can then be used to
+ * get or set its value without looking up its name again. This is meant for
+ * variables accessed very often, e.g. for every picture or audio buffer.
+ * @{
+ */
+
+/** Handle to a resolved variable (opaque) */
+typedef struct variable_t vlc_var_handle_t;
+
+/**
+ * Resolves a variable to a handle.
+ *
+ * The handle holds a reference to the variable, as var_Create() would, so
+ * that the variable remains valid until the handle is released. Callbacks
+ * are invoked as usual when the variable is set through the handle.
+ *
+ * \param obj Object holding the variable
+ * \param name Variable name
+ * \return a handle, or NULL if the variable does not exist
+ */
+VLC_API vlc_var_handle_t *var_Resolve(vlc_object_t *obj, const char *name)
+VLC_USED;
+
+/**
+ * Releases a variable handle.
+ *
+ * \warning Handles must be released before their object is deleted.
+ *
+ * \param obj Object holding the variable
+ * \param var Variable handle, from var_Resolve() on the same object
+ */
+VLC_API void var_ReleaseHandle(vlc_object_t *obj, vlc_var_handle_t *var);
+
+/**
+ * Sets the value of a resolved variable.
+ *
+ * \param obj Object holding the variable
+ * \param var Variable handle
+ * \param type expected variable type, or 0 for any type
+ * \param val Variable value to set
+ */
+VLC_API void var_SetHandle(vlc_object_t *obj, vlc_var_handle_t *var,
+                           int type, vlc_value_t val);
+
+/**
+ * Gets the value of a resolved variable.
+ *
+ * \param obj Object holding the variable
+ * \param var Variable handle
+ * \param type expected variable type, or 0 for any type
+ * \param valp Pointer to a \ref vlc_value_t object to hold the value [OUT]
+ */
+VLC_API void var_GetHandle(vlc_object_t *obj, vlc_var_handle_t *var,
+                           int type, vlc_value_t *valp);
+
+static inline void var_SetHandleInteger(vlc_object_t *obj,
+                                        vlc_var_handle_t *var, int64_t i)
+{
+    vlc_value_t val;
+    val.i_int = i;
+    var_SetHandle(obj, var, VLC_VAR_INTEGER, val);
+}
+
+static inline void var_SetHandleBool(vlc_object_t *obj,
+                                     vlc_var_handle_t *var, bool b)
+{
+    vlc_value_t val;
+    val.b_bool = b;
+    var_SetHandle(obj, var, VLC_VAR_BOOL, val);
+}
+
+static inline void var_SetHandleFloat(vlc_object_t *obj,
+                                      vlc_var_handle_t *var, float f)
+{
+    vlc_value_t val;
+    val.f_float = f;
+    var_SetHandle(obj, var, VLC_VAR_FLOAT, val);
+}
+
+VLC_USED
+static inline int64_t var_GetHandleInteger(vlc_object_t *obj,
+                                           vlc_var_handle_t *var)
+{
+    vlc_value_t val;
+    var_GetHandle(obj, var, VLC_VAR_INTEGER, &val);
+    return val.i_int;
+}
+
+VLC_USED
+static inline bool var_GetHandleBool(vlc_object_t *obj,
+                                     vlc_var_handle_t *var)
+{
+    vlc_value_t val;
+    var_GetHandle(obj, var, VLC_VAR_BOOL, &val);
+    return val.b_bool;
+}
+
+VLC_USED
+static inline float var_GetHandleFloat(vlc_object_t *obj,
+                                       vlc_var_handle_t *var)
+{
+    vlc_value_t val;
+    var_GetHandle(obj, var, VLC_VAR_FLOAT, &val);
+    return val.f_float;
+}
+
+/** @} */
+
 /**
  * Perform an atomic read-modify-write of a variable.
  *
@@ -807,6 +919,16 @@ VLC_API int var_LocationParse(vlc_object_t *obj, const char *mrl, const char *pr
 #define var_Get(a,b,c) var_Get(VLC_OBJECT(a), b, c)
 #define var_SetChecked(o,n,t,v) var_SetChecked(VLC_OBJECT(o), n, t, v)
 #define var_GetChecked(o,n,t,v) var_GetChecked(VLC_OBJECT(o), n, t, v)
+#define var_Resolve(o,n) var_Resolve(VLC_OBJECT(o), n)
+#define var_ReleaseHandle(o,v) var_ReleaseHandle(VLC_OBJECT(o), v)
+#define var_SetHandle(o,v,t,x) var_SetHandle(VLC_OBJECT(o), v, t, x)
+#define var_GetHandle(o,v,t,x) var_GetHandle(VLC_OBJECT(o), v, t, x)
+#define var_SetHandleInteger(o,v,i) var_SetHandleInteger(VLC_OBJECT(o), v, i)
+#define var_SetHandleBool(o,v,b) var_SetHandleBool(VLC_OBJECT(o), v, b)
+#define var_SetHandleFloat(o,v,f) var_SetHandleFloat(VLC_OBJECT(o), v, f)
+#define var_GetHandleInteger(o,v) var_GetHandleInteger(VLC_OBJECT(o), v)
+#define var_GetHandleBool(o,v) var_GetHandleBool(VLC_OBJECT(o), v)
+#define var_GetHandleFloat(o,v) var_GetHandleFloat(VLC_OBJECT(o), v)
 
 #define var_AddCallback(a,b,c,d) var_AddCallback(VLC_OBJECT(a), b, c, d)
 #define var_DelCallback(a,b,c,d) var_DelCallback(VLC_OBJECT(a), b, c, d)
@@ -130,6 +130,35 @@ VLC_API int vout_GetSnapshot( vout_thread_t *p_vout,
                               video_format_t *p_fmt,
                               const char *psz_format, vlc_tick_t i_timeout );
 
+/**
+ * Asynchronous snapshot completion callback.
+ *
+ * \param opaque the pointer given to vout_RequestSnapshot()
+ * \param image the encoded picture, to be released with block_Release(),
+ *              or NULL on error
+ * \param fmt the format used for the picture before encoding, or NULL on
+ *            error
+ */
+typedef void (*vout_snapshot_cb)(void *opaque, block_t *image,
+                                 const video_format_t *fmt);
+
+/**
+ * This function will request a snapshot without waiting.
+ *
+ * The next rendered picture is referenced, and encoded in psz_format format
+ * on threads shared by all the video outputs. The rendering is never
+ * delayed by the encoding.
+ *
+ * The callback is called exactly once, from one of those threads, including
+ * if the vout is closed before any picture was rendered.
+ *
+ * etval VLC_SUCCESS the callback will be called
+ * etval VLC_ENOMEM the request failed, the callback will not be called
+ */
+VLC_API int vout_RequestSnapshot( vout_thread_t *p_vout,
+                                  const char *psz_format,
+                                  vout_snapshot_cb cb, void *opaque );
+
 /* */
 VLC_API void vout_PutPicture( vout_thread_t *, picture_t * );
 
@@ -136,6 +136,9 @@ typedef struct vout_display_cfg {
  */
 typedef struct {
     const vlc_fourcc_t *subpicture_chromas; /* List of supported chromas for subpicture rendering. */
+    /** The display blends successive pictures (frame mixing): the current
+     * picture is displayed again on every display refresh. */
+    bool mixes_frames;
 } vout_display_info_t;
 
 /**
@@ -193,6 +196,21 @@ struct vout_display_owner_t {
      * from multiple threads.
      */
     void (*viewpoint_moved)(void *sys, const vlc_viewpoint_t *vp);
+
+    /* Presentation feedback
+     *
+     * Same rules as viewpoint_moved. The date is the system time at which
+     * the last displayed picture was (or will be) scanned out, and
+     * refresh_period the nominal duration of a display refresh, or 0 if it
+     * is unknown or variable (VRR).
+     */
+    void (*presented)(void *sys, vlc_tick_t date, vlc_tick_t refresh_period);
+
+    /* GPU render time of the last displayed picture
+     *
+     * Same rules as viewpoint_moved.
+     */
+    void (*rendered)(void *sys, vlc_tick_t gpu_time);
 };
 
 /**
@@ -502,6 +520,38 @@ static inline void vout_display_SendEventViewpointMoved(vout_display_t *vd,
         vd->owner.viewpoint_moved(vd->owner.sys, vp);
 }
 
+/**
+ * Reports when the last displayed picture reaches the screen.
+ *
+ * Displays that know the actual scan out time (presentation feedback, page
+ * flip events, frame statistics) should call this once per displayed
+ * picture, so that the video output can align pictures on the refreshes.
+ *
+ * \param date system time of the scan out
+ * \param refresh_period nominal refresh period, or 0 if unknown or variable
+ */
+static inline void vout_display_SendEventPresented(vout_display_t *vd,
+                                                   vlc_tick_t date,
+                                                   vlc_tick_t refresh_period)
+{
+    if (vd->owner.presented)
+        vd->owner.presented(vd->owner.sys, date, refresh_period);
+}
+
+/**
+ * Reports the time spent by the GPU rendering the last displayed picture.
+ *
+ * It is accounted in the video output statistics.
+ *
+ * \param gpu_time duration of the GPU work
+ */
+static inline void vout_display_SendEventRendered(vout_display_t *vd,
+                                                  vlc_tick_t gpu_time)
+{
+    if (vd->owner.rendered)
+        vd->owner.rendered(vd->owner.sys, gpu_time);
+}
+
 /**
  * Helper function that applies the necessary transforms to the mouse position
  * and then calls vout_display_SendEventMouseMoved.
@@ -81,6 +81,17 @@ VLC_API xml_reader_t * xml_ReaderCreate(vlc_object_t *, stream_t *) VLC_USED;
 #define xml_ReaderCreate( a, s ) xml_ReaderCreate(VLC_OBJECT(a), s)
 VLC_API void xml_ReaderDelete(xml_reader_t *);
 
+/**
+ * Moves to the next node.
+ *
+ * The reader does not copy the strings it returns. The names and namespaces
+ * of the elements are interned: they remain valid until the reader is
+ * deleted. The text of a text node remains valid until the next call.
+ *
+ * \param pval the element name or the text [OUT]
+ * \return the type of node, XML_READER_NONE at the end of the document, or
+ * XML_READER_ERROR on error
+ */
 static inline int xml_ReaderNextNode( xml_reader_t *reader, const char **pval )
 {
     return reader->pf_next_node( reader, pval, NULL );
@@ -93,6 +104,15 @@ static inline int xml_ReaderNextNodeNS( xml_reader_t *reader,
     return reader->pf_next_node( reader, pval, pnamespace );
 }
 
+/**
+ * Moves to the next attribute of the current element.
+ *
+ * The name is interned, as those of the elements. The value remains valid
+ * until the next attribute or node.
+ *
+ * \param pval the attribute value [OUT]
+ * \return the attribute name, or NULL if there are no more attributes
+ */
 static inline const char *xml_ReaderNextAttr( xml_reader_t *reader,
                                               const char **pval )
 {
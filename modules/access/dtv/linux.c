@@ -27,12 +27,15 @@
 #include <vlc_common.h>
 #include <vlc_fs.h>
 #include <vlc_interrupt.h>
+#include <vlc_list.h>
 
 #include <errno.h>
 #include <assert.h>
 #include <fcntl.h>
 #include <poll.h>
+#include <string.h>
 #include <unistd.h>
+#include <sys/eventfd.h>
 #include <sys/ioctl.h>
 #include <linux/dvb/version.h>
 #include <linux/dvb/frontend.h>
@@ -141,12 +144,40 @@ static int dvb_parse_fec (uint32_t fec)
 }
 
 
-struct dvb_device
+/* Several inputs can receive services from the same transponder: they share
+ * a session per frontend. The session reader thread dequeues the TS from the
+ * kernel and hands the same chunks to every input. Each input only gets the
+ * packets of the PIDs it asked for, and the demultiplexer of the device
+ * filters the union of those PIDs. */
+#define DVB_CHUNK_SIZE (100 * 188)
+#define DVB_QUEUE_MAX  256 /* chunks per input */
+#define DVB_PROPS_MAX  32
+
+struct dvb_chunk
 {
-    vlc_object_t *obj;
+    unsigned refs; /* protected by the session lock */
+    size_t size;
+    bool aligned; /* whole TS packets, can be filtered */
+    uint8_t data[];
+};
+
+struct dvb_props
+{
+    size_t count;
+    struct dtv_property props[DVB_PROPS_MAX];
+};
+
+struct dvb_session
+{
+    struct vlc_list node;
+    unsigned refs; /* protected by dvb_sessions_lock */
+    vlc_object_t *obj; /* outlives the inputs using the session */
+    uint8_t adapter;
+    uint8_t device;
     int dir;
     int demux;
     int frontend;
+    int wake; /* eventfd to wake the reader thread up */
 #ifndef USE_DMX
 # define MAX_PIDS 256
     struct
@@ -155,12 +186,43 @@ struct dvb_device
         uint16_t pid;
     } pids[MAX_PIDS];
 #endif
-    cam_t *cam;
-    uint8_t device;
+    uint16_t pid_refs[0x2000];
     bool budget;
-    //size_t buffer_size;
+
+    vlc_mutex_t cam_lock;
+    cam_t *cam;
+
+    vlc_mutex_t lock;
+    struct vlc_list clients;
+    dvb_device_t *owner; /* the input tuning the frontend */
+    struct dvb_props tuning; /* as set by the owner */
+    bool tuned;
+    bool eof;
+    bool exiting;
+    bool overflow;
+    vlc_thread_t thread;
 };
 
+struct dvb_device
+{
+    vlc_object_t *obj;
+    struct dvb_session *s;
+    struct vlc_list node;
+    int event; /* eventfd signaled when data is queued */
+    struct
+    {
+        struct dvb_chunk *chunks[DVB_QUEUE_MAX];
+        size_t head;
+        size_t count;
+        size_t offset; /* in the head chunk */
+    } queue;
+    struct dvb_props tuning; /* as requested by the input */
+    uint8_t pids[0x2000 / 8];
+};
+
+static vlc_mutex_t dvb_sessions_lock = VLC_STATIC_MUTEX;
+static struct vlc_list dvb_sessions = VLC_LIST_INITIALIZER(&dvb_sessions);
+
 /** Opens the device directory for the specified DVB adapter */
 static int dvb_open_adapter (uint8_t adapter)
 {
@@ -171,55 +233,250 @@ static int dvb_open_adapter (uint8_t adapter)
 }
 
 /** Opens the DVB device node of the specified type */
-static int dvb_open_node (dvb_device_t *d, const char *type, int flags)
+static int dvb_open_node (struct dvb_session *s, const char *type, int flags)
 {
     char path[strlen (type) + 4];
 
-    snprintf (path, sizeof (path), "%s%u", type, d->device);
-    return vlc_openat (d->dir, path, flags | O_NONBLOCK);
+    snprintf (path, sizeof (path), "%s%u", type, s->device);
+    return vlc_openat (s->dir, path, flags | O_NONBLOCK);
 }
 
-/**
- * Opens the DVB tuner
- */
-dvb_device_t *dvb_open (vlc_object_t *obj)
+static void dvb_wake (int fd)
 {
-    dvb_device_t *d = malloc (sizeof (*d));
-    if (unlikely(d == NULL))
-        return NULL;
+    uint64_t val = 1;
 
-    d->obj = obj;
+    if (write (fd, &val, sizeof (val)) < 0)
+        assert (errno == EAGAIN); /* already signaled */
+}
 
-    uint8_t adapter = var_InheritInteger (obj, "dvb-adapter");
-    d->device = var_InheritInteger (obj, "dvb-device");
+static void dvb_chunk_release (struct dvb_chunk *c)
+{
+    if (--c->refs == 0)
+        free (c);
+}
+
+static void dvb_frontend_status(vlc_object_t *obj, fe_status_t s)
+{
+    msg_Dbg(obj, "frontend status:");
+#define S(f) \
+    if (s & FE_ ## f) \
+        msg_Dbg(obj, "\t%s", #f);
+
+    S(HAS_SIGNAL);
+    S(HAS_CARRIER);
+    S(HAS_VITERBI);
+    S(HAS_SYNC);
+    S(HAS_LOCK);
+    S(TIMEDOUT);
+    S(REINIT);
+#undef S
+}
+
+/** Hands a chunk of TS over to every input of the session */
+static void dvb_session_deliver (struct dvb_session *s, struct dvb_chunk *c)
+{
+    dvb_device_t *d;
+
+    vlc_mutex_lock (&s->lock);
+    vlc_list_foreach (d, &s->clients, node)
+    {
+        if (d->queue.count == DVB_QUEUE_MAX)
+        {   /* the input does not keep up, do not hold the others back */
+            if (!s->overflow)
+                msg_Warn (d->obj, "cannot demux data fast enough!");
+            s->overflow = true;
+            continue;
+        }
+
+        size_t tail = (d->queue.head + d->queue.count) % DVB_QUEUE_MAX;
+        d->queue.chunks[tail] = c;
+        d->queue.count++;
+        c->refs++;
+        dvb_wake (d->event);
+    }
+    dvb_chunk_release (c);
+    vlc_mutex_unlock (&s->lock);
+}
+
+static void dvb_session_end (struct dvb_session *s)
+{
+    dvb_device_t *d;
+
+    vlc_mutex_lock (&s->lock);
+    s->eof = true;
+    vlc_list_foreach (d, &s->clients, node)
+        dvb_wake (d->event);
+    vlc_mutex_unlock (&s->lock);
+}
+
+static void *dvb_session_thread (void *data)
+{
+    struct dvb_session *s = data;
+    vlc_object_t *obj = s->obj;
+
+    vlc_thread_set_name ("vlc-dvb");
+
+    for (;;)
+    {
+        struct pollfd ufd[3];
+        int n = 2;
+
+        vlc_mutex_lock (&s->lock);
+        bool exiting = s->exiting;
+        int frontend = s->frontend;
+        vlc_mutex_unlock (&s->lock);
+        if (exiting)
+            break;
+
+        vlc_mutex_lock (&s->cam_lock);
+        if (s->cam != NULL)
+            en50221_Poll (s->cam);
+        vlc_mutex_unlock (&s->cam_lock);
+
+        ufd[0].fd = s->demux;
+        ufd[0].events = POLLIN;
+        ufd[1].fd = s->wake;
+        ufd[1].events = POLLIN;
+        if (frontend != -1)
+        {
+            ufd[2].fd = frontend;
+            ufd[2].events = POLLPRI;
+            n = 3;
+        }
+
+        if (poll (ufd, n, -1) < 0)
+            continue;
+
+        if (ufd[1].revents)
+        {
+            uint64_t val;
+
+            if (read (s->wake, &val, sizeof (val)) < 0)
+                assert (errno == EAGAIN);
+            continue; /* the exit flag or the frontend have changed */
+        }
+
+        if (n > 2 && ufd[2].revents)
+        {
+            struct dvb_frontend_event ev;
+
+            if (ioctl (frontend, FE_GET_EVENT, &ev) < 0)
+            {
+                if (errno == EOVERFLOW)
+                {
+                    msg_Err (obj, "cannot dequeue events fast enough!");
+                    continue;
+                }
+                msg_Err (obj, "cannot dequeue frontend event: %s",
+                         vlc_strerror_c(errno));
+                break;
+            }
+
+            dvb_frontend_status(obj, ev.status);
+        }
+
+        if (ufd[0].revents)
+        {
+            struct dvb_chunk *c = malloc (sizeof (*c) + DVB_CHUNK_SIZE);
+            if (unlikely(c == NULL))
+                continue;
+
+            ssize_t val = read (s->demux, c->data, DVB_CHUNK_SIZE);
+            if (val <= 0)
+            {
+                free (c);
+                if (val == -1 && errno == EOVERFLOW)
+                {
+                    msg_Err (obj, "cannot demux data fast enough!");
+                    continue;
+                }
+                if (val == -1 && (errno == EAGAIN || errno == EINTR))
+                    continue;
+                msg_Err (obj, "cannot demux: %s", vlc_strerror_c(errno));
+                break;
+            }
+
+            c->refs = 1;
+            c->size = val;
+            c->aligned = (val % 188) == 0 && c->data[0] == 0x47;
+            dvb_session_deliver (s, c);
+        }
+    }
+
+    dvb_session_end (s);
+    return NULL;
+}
+
+static void dvb_session_close (struct dvb_session *s)
+{
+    vlc_mutex_lock (&s->lock);
+    s->exiting = true;
+    vlc_mutex_unlock (&s->lock);
+    dvb_wake (s->wake);
+    vlc_join (s->thread, NULL);
+
+    assert (vlc_list_is_empty (&s->clients));
+#ifndef USE_DMX
+    if (!s->budget)
+    {
+        for (size_t i = 0; i < MAX_PIDS; i++)
+            if (s->pids[i].fd != -1)
+                vlc_close (s->pids[i].fd);
+    }
+#endif
+    if (s->cam != NULL)
+        en50221_End (s->cam);
+    if (s->frontend != -1)
+        vlc_close (s->frontend);
+    vlc_close (s->wake);
+    vlc_close (s->demux);
+    vlc_close (s->dir);
+    vlc_object_delete (s->obj);
+    free (s);
+}
+
+static struct dvb_session *dvb_session_open (vlc_object_t *obj,
+                                             uint8_t adapter, uint8_t device)
+{
+    struct dvb_session *s = malloc (sizeof (*s));
+    if (unlikely(s == NULL))
+        return NULL;
+
+    s->obj = vlc_object_create (vlc_object_instance (obj), sizeof (*s->obj));
+    if (unlikely(s->obj == NULL))
+    {
+        free (s);
+        return NULL;
+    }
 
-    d->dir = dvb_open_adapter (adapter);
-    if (d->dir == -1)
+    s->refs = 1;
+    s->adapter = adapter;
+    s->device = device;
+    s->dir = dvb_open_adapter (adapter);
+    if (s->dir == -1)
     {
         msg_Err (obj, "cannot access adapter %"PRIu8": %s", adapter,
                  vlc_strerror_c(errno));
-        free (d);
-        return NULL;
+        goto error;
     }
-    d->frontend = -1;
-    d->cam = NULL;
-    d->budget = var_InheritBool (obj, "dvb-budget-mode");
+    s->frontend = -1;
+    s->cam = NULL;
+    s->budget = var_InheritBool (obj, "dvb-budget-mode");
+    memset (s->pid_refs, 0, sizeof (s->pid_refs));
 
 #ifndef USE_DMX
-    if (d->budget)
+    if (s->budget)
 #endif
     {
-       d->demux = dvb_open_node (d, "demux", O_RDONLY);
-       if (d->demux == -1)
+       s->demux = dvb_open_node (s, "demux", O_RDONLY);
+       if (s->demux == -1)
        {
            msg_Err (obj, "cannot access demultiplexer: %s",
                     vlc_strerror_c(errno));
-           vlc_close (d->dir);
-           free (d);
-           return NULL;
+           goto error_dir;
        }
 
-       if (ioctl (d->demux, DMX_SET_BUFFER_SIZE, 1 << 20) < 0)
+       if (ioctl (s->demux, DMX_SET_BUFFER_SIZE, 1 << 20) < 0)
            msg_Warn (obj, "cannot expand demultiplexing buffer: %s",
                      vlc_strerror_c(errno));
 
@@ -227,173 +484,264 @@ dvb_device_t *dvb_open (vlc_object_t *obj)
         * cannot be configured otherwise. So add the PAT. */
         struct dmx_pes_filter_params param;
 
-        param.pid = d->budget ? 0x2000 : 0x000;
+        param.pid = s->budget ? 0x2000 : 0x000;
         param.input = DMX_IN_FRONTEND;
         param.output = DMX_OUT_TSDEMUX_TAP;
         param.pes_type = DMX_PES_OTHER;
         param.flags = DMX_IMMEDIATE_START;
-        if (ioctl (d->demux, DMX_SET_PES_FILTER, &param) < 0)
+        if (ioctl (s->demux, DMX_SET_PES_FILTER, &param) < 0)
         {
             msg_Err (obj, "cannot setup TS demultiplexer: %s",
                      vlc_strerror_c(errno));
-            goto error;
+            goto error_demux;
         }
 #ifndef USE_DMX
     }
     else
     {
         for (size_t i = 0; i < MAX_PIDS; i++)
-            d->pids[i].pid = d->pids[i].fd = -1;
-        d->demux = dvb_open_node (d, "dvr", O_RDONLY);
-        if (d->demux == -1)
+            s->pids[i].pid = s->pids[i].fd = -1;
+        s->demux = dvb_open_node (s, "dvr", O_RDONLY);
+        if (s->demux == -1)
         {
             msg_Err (obj, "cannot access DVR: %s", vlc_strerror_c(errno));
-            vlc_close (d->dir);
-            free (d);
-            return NULL;
+            goto error_dir;
         }
 #endif
     }
 
-    int ca = dvb_open_node (d, "ca", O_RDWR);
+    s->wake = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (s->wake == -1)
+        goto error_demux;
+
+    vlc_mutex_init (&s->cam_lock);
+    int ca = dvb_open_node (s, "ca", O_RDWR);
     if (ca != -1)
     {
-        d->cam = en50221_Init (obj, ca);
-        if (d->cam == NULL)
+        s->cam = en50221_Init (s->obj, ca);
+        if (s->cam == NULL)
             vlc_close (ca);
     }
     else
         msg_Dbg (obj, "conditional access module not available: %s",
                  vlc_strerror_c(errno));
-    return d;
 
+    vlc_mutex_init (&s->lock);
+    vlc_list_init (&s->clients);
+    s->owner = NULL;
+    s->tuning.count = 0;
+    s->tuned = false;
+    s->eof = false;
+    s->exiting = false;
+    s->overflow = false;
+
+    if (vlc_clone (&s->thread, dvb_session_thread, s))
+    {
+        if (s->cam != NULL)
+            en50221_End (s->cam);
+        vlc_close (s->wake);
+        goto error_demux;
+    }
+    return s;
+
+error_demux:
+    vlc_close (s->demux);
+error_dir:
+    vlc_close (s->dir);
 error:
-    dvb_close (d);
+    vlc_object_delete (s->obj);
+    free (s);
     return NULL;
 }
 
-void dvb_close (dvb_device_t *d)
+/**
+ * Opens the DVB tuner
+ */
+dvb_device_t *dvb_open (vlc_object_t *obj)
 {
-#ifndef USE_DMX
-    if (!d->budget)
+    dvb_device_t *d = malloc (sizeof (*d));
+    if (unlikely(d == NULL))
+        return NULL;
+
+    d->obj = obj;
+    d->event = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (d->event == -1)
     {
-        for (size_t i = 0; i < MAX_PIDS; i++)
-            if (d->pids[i].fd != -1)
-                vlc_close (d->pids[i].fd);
+        free (d);
+        return NULL;
     }
-#endif
-    if (d->cam != NULL)
-        en50221_End (d->cam);
-    if (d->frontend != -1)
-        vlc_close (d->frontend);
-    vlc_close (d->demux);
-    vlc_close (d->dir);
-    free (d);
-}
+    d->queue.head = d->queue.count = d->queue.offset = 0;
+    d->tuning.count = 0;
+    memset (d->pids, 0, sizeof (d->pids));
 
-static void dvb_frontend_status(vlc_object_t *obj, fe_status_t s)
-{
-    msg_Dbg(obj, "frontend status:");
-#define S(f) \
-    if (s & FE_ ## f) \
-        msg_Dbg(obj, "\t%s", #f);
+    uint8_t adapter = var_InheritInteger (obj, "dvb-adapter");
+    uint8_t device = var_InheritInteger (obj, "dvb-device");
+    struct dvb_session *s;
 
-    S(HAS_SIGNAL);
-    S(HAS_CARRIER);
-    S(HAS_VITERBI);
-    S(HAS_SYNC);
-    S(HAS_LOCK);
-    S(TIMEDOUT);
-    S(REINIT);
-#undef S
+    vlc_mutex_lock (&dvb_sessions_lock);
+    vlc_list_foreach (s, &dvb_sessions, node)
+        if (s->adapter == adapter && s->device == device)
+        {
+            msg_Dbg (obj, "sharing adapter %"PRIu8" device %"PRIu8,
+                     adapter, device);
+            s->refs++;
+            goto found;
+        }
+
+    s = dvb_session_open (obj, adapter, device);
+    if (s == NULL)
+    {
+        vlc_mutex_unlock (&dvb_sessions_lock);
+        vlc_close (d->event);
+        free (d);
+        return NULL;
+    }
+    vlc_list_append (&s->node, &dvb_sessions);
+found:
+    vlc_mutex_unlock (&dvb_sessions_lock);
+
+    d->s = s;
+    vlc_mutex_lock (&s->lock);
+    vlc_list_append (&d->node, &s->clients);
+    vlc_mutex_unlock (&s->lock);
+    return d;
 }
 
-/**
- * Reads TS data from the tuner.
- * @return number of bytes read, 0 on EOF, -1 if no data (yet).
- */
-ssize_t dvb_read (dvb_device_t *d, void *buf, size_t len, int ms)
+void dvb_close (dvb_device_t *d)
 {
-    struct pollfd ufd[2];
-    int n;
+    struct dvb_session *s = d->s;
 
-    if (d->cam != NULL)
-        en50221_Poll (d->cam);
+    for (unsigned pid = 0; pid < 0x2000; pid++)
+        if (d->pids[pid / 8] & (1 << (pid % 8)))
+            dvb_remove_pid (d, pid);
 
-    ufd[0].fd = d->demux;
-    ufd[0].events = POLLIN;
-    if (d->frontend != -1)
+    vlc_mutex_lock (&s->lock);
+    vlc_list_remove (&d->node);
+    if (s->owner == d)
+        s->owner = NULL;
+    while (d->queue.count > 0)
     {
-        ufd[1].fd = d->frontend;
-        ufd[1].events = POLLPRI;
-        n = 2;
+        dvb_chunk_release (d->queue.chunks[d->queue.head]);
+        d->queue.head = (d->queue.head + 1) % DVB_QUEUE_MAX;
+        d->queue.count--;
     }
-    else
-        n = 1;
+    vlc_mutex_unlock (&s->lock);
+    vlc_close (d->event);
+    free (d);
 
-    errno = 0;
-    n = vlc_poll_i11e (ufd, n, ms);
-    if (n == 0)
-        errno = EAGAIN;
-    if (n <= 0)
-        return -1;
+    vlc_mutex_lock (&dvb_sessions_lock);
+    bool last = --s->refs == 0;
+    if (last)
+        vlc_list_remove (&s->node);
+    vlc_mutex_unlock (&dvb_sessions_lock);
+
+    if (last)
+        dvb_session_close (s);
+}
+
+static bool dvb_has_pid (const dvb_device_t *d, uint16_t pid)
+{
+    return d->pids[pid / 8] & (1 << (pid % 8));
+}
 
-    if (d->frontend != -1 && ufd[1].revents)
+/** Copies the queued TS packets of the input PIDs, with the session lock */
+static size_t dvb_dequeue (dvb_device_t *d, uint8_t *buf, size_t len)
+{
+    size_t done = 0;
+
+    while (d->queue.count > 0)
     {
-        struct dvb_frontend_event ev;
+        struct dvb_chunk *c = d->queue.chunks[d->queue.head];
+        const uint8_t *p = c->data + d->queue.offset;
+        size_t left = c->size - d->queue.offset;
 
-        if (ioctl (d->frontend, FE_GET_EVENT, &ev) < 0)
+        if (d->s->budget || !c->aligned)
         {
-            if (errno == EOVERFLOW)
+            size_t copy = __MIN(left, len - done);
+
+            memcpy (buf + done, p, copy);
+            done += copy;
+            d->queue.offset += copy;
+        }
+        else
+        {
+            while (left >= 188 && len - done >= 188)
             {
-                msg_Err (d->obj, "cannot dequeue events fast enough!");
-                return -1;
+                if (dvb_has_pid (d, ((p[1] & 0x1f) << 8) | p[2]))
+                {
+                    memcpy (buf + done, p, 188);
+                    done += 188;
+                }
+                p += 188;
+                left -= 188;
+                d->queue.offset += 188;
             }
-            msg_Err (d->obj, "cannot dequeue frontend event: %s",
-                     vlc_strerror_c(errno));
-            return 0;
         }
 
-        dvb_frontend_status(d->obj, ev.status);
+        if (d->queue.offset < c->size)
+            break; /* the buffer is full */
+
+        dvb_chunk_release (c);
+        d->queue.head = (d->queue.head + 1) % DVB_QUEUE_MAX;
+        d->queue.count--;
+        d->queue.offset = 0;
     }
+    return done;
+}
+
+/**
+ * Reads TS data from the tuner.
+ * @return number of bytes read, 0 on EOF, -1 if no data (yet).
+ */
+ssize_t dvb_read (dvb_device_t *d, void *buf, size_t len, int ms)
+{
+    struct dvb_session *s = d->s;
 
-    if (ufd[0].revents)
+    for (;;)
     {
-        ssize_t val = read (d->demux, buf, len);
-        if (val == -1 && (errno != EAGAIN && errno != EINTR))
-        {
-            if (errno == EOVERFLOW)
-            {
-                msg_Err (d->obj, "cannot demux data fast enough!");
-                return -1;
-            }
-            msg_Err (d->obj, "cannot demux: %s", vlc_strerror_c(errno));
+        vlc_mutex_lock (&s->lock);
+        size_t val = dvb_dequeue (d, buf, len);
+        bool eof = s->eof && d->queue.count == 0;
+        vlc_mutex_unlock (&s->lock);
+
+        if (val > 0)
+            return val;
+        if (eof)
             return 0;
-        }
-        return val;
-    }
 
-    return -1;
+        struct pollfd ufd = { .fd = d->event, .events = POLLIN };
+        int n;
+
+        errno = 0;
+        n = vlc_poll_i11e (&ufd, 1, ms);
+        if (n == 0)
+            errno = EAGAIN;
+        if (n <= 0)
+            return -1;
+
+        uint64_t dummy;
+        if (read (d->event, &dummy, sizeof (dummy)) < 0)
+            assert (errno == EAGAIN);
+    }
 }
 
-int dvb_add_pid (dvb_device_t *d, uint16_t pid)
+/** Sets up the demultiplexer filter of a PID, with the session lock */
+static int dvb_filter_pid (struct dvb_session *s, uint16_t pid)
 {
-    if (d->budget)
-        return 0;
 #ifdef USE_DMX
-    if (pid == 0 || ioctl (d->demux, DMX_ADD_PID, &pid) >= 0)
+    if (pid == 0 || ioctl (s->demux, DMX_ADD_PID, &pid) >= 0)
         return 0;
 #else
     for (size_t i = 0; i < MAX_PIDS; i++)
     {
-        if (d->pids[i].pid == pid)
+        if (s->pids[i].pid == pid)
             return 0;
-        if (d->pids[i].fd != -1)
+        if (s->pids[i].fd != -1)
             continue;
 
-        int fd = dvb_open_node (d, "demux", O_RDONLY);
+        int fd = dvb_open_node (s, "demux", O_RDONLY);
         if (fd == -1)
-            goto error;
+            return -1;
 
        /* We need to filter at least one PID. The tap for TS demultiplexing
         * cannot be configured otherwise. So add the PAT. */
@@ -407,66 +755,103 @@ int dvb_add_pid (dvb_device_t *d, uint16_t pid)
         if (ioctl (fd, DMX_SET_PES_FILTER, &param) < 0)
         {
             vlc_close (fd);
-            goto error;
+            return -1;
         }
-        d->pids[i].fd = fd;
-        d->pids[i].pid = pid;
+        s->pids[i].fd = fd;
+        s->pids[i].pid = pid;
         return 0;
     }
     errno = EMFILE;
-error:
 #endif
-    msg_Err (d->obj, "cannot add PID 0x%04"PRIu16": %s", pid,
-             vlc_strerror_c(errno));
     return -1;
 }
 
-void dvb_remove_pid (dvb_device_t *d, uint16_t pid)
+static void dvb_unfilter_pid (struct dvb_session *s, uint16_t pid)
 {
-    if (d->budget)
-        return;
 #ifdef USE_DMX
     if (pid != 0)
-        ioctl (d->demux, DMX_REMOVE_PID, &pid);
+        ioctl (s->demux, DMX_REMOVE_PID, &pid);
 #else
     for (size_t i = 0; i < MAX_PIDS; i++)
     {
-        if (d->pids[i].pid == pid)
+        if (s->pids[i].pid == pid)
         {
-            vlc_close (d->pids[i].fd);
-            d->pids[i].pid = d->pids[i].fd = -1;
+            vlc_close (s->pids[i].fd);
+            s->pids[i].pid = s->pids[i].fd = -1;
             return;
         }
     }
 #endif
 }
 
-bool dvb_get_pid_state (const dvb_device_t *d, uint16_t pid)
+int dvb_add_pid (dvb_device_t *d, uint16_t pid)
 {
-    if (d->budget)
-        return true;
+    struct dvb_session *s = d->s;
+    int ret = 0;
 
-    for (size_t i = 0; i < MAX_PIDS; i++)
-        if (d->pids[i].pid == pid)
-            return true;
+    if (s->budget || dvb_has_pid (d, pid))
+        return 0;
 
-    return false;
+    vlc_mutex_lock (&s->lock);
+    if (s->pid_refs[pid] == 0)
+        ret = dvb_filter_pid (s, pid);
+    if (ret == 0)
+    {
+        s->pid_refs[pid]++;
+        d->pids[pid / 8] |= 1 << (pid % 8);
+    }
+    vlc_mutex_unlock (&s->lock);
+
+    if (ret)
+        msg_Err (d->obj, "cannot add PID 0x%04"PRIu16": %s", pid,
+                 vlc_strerror_c(errno));
+    return ret;
+}
+
+void dvb_remove_pid (dvb_device_t *d, uint16_t pid)
+{
+    struct dvb_session *s = d->s;
+
+    if (s->budget || !dvb_has_pid (d, pid))
+        return;
+
+    vlc_mutex_lock (&s->lock);
+    d->pids[pid / 8] &= ~(1 << (pid % 8));
+    assert (s->pid_refs[pid] > 0);
+    if (--s->pid_refs[pid] == 0)
+        dvb_unfilter_pid (s, pid);
+    vlc_mutex_unlock (&s->lock);
+}
+
+bool dvb_get_pid_state (const dvb_device_t *d, uint16_t pid)
+{
+    return d->s->budget || dvb_has_pid (d, pid);
 }
 
 /** Finds a frontend of the correct type */
 static int dvb_open_frontend (dvb_device_t *d)
 {
-    if (d->frontend != -1)
-        return 0;
-    int fd = dvb_open_node (d, "frontend", O_RDWR);
-    if (fd == -1)
+    struct dvb_session *s = d->s;
+    int ret = 0;
+
+    vlc_mutex_lock (&s->lock);
+    if (s->frontend == -1)
     {
-        msg_Err (d->obj, "cannot access frontend: %s", vlc_strerror_c(errno));
-        return -1;
+        int fd = dvb_open_node (s, "frontend", O_RDWR);
+        if (fd != -1)
+        {
+            s->frontend = fd;
+            dvb_wake (s->wake); /* to poll the frontend events */
+        }
+        else
+        {
+            msg_Err (d->obj, "cannot access frontend: %s",
+                     vlc_strerror_c(errno));
+            ret = -1;
+        }
     }
-
-    d->frontend = fd;
-    return 0;
+    vlc_mutex_unlock (&s->lock);
+    return ret;
 }
 #define dvb_find_frontend(d, sys) (dvb_open_frontend(d))
 
@@ -489,7 +874,7 @@ unsigned dvb_enum_systems (dvb_device_t *d)
         .props = prop
     };
 
-    if (ioctl (d->frontend, FE_GET_PROPERTY, &props) < 0)
+    if (ioctl (d->s->frontend, FE_GET_PROPERTY, &props) < 0)
     {
          msg_Err (d->obj, "cannot enumerate frontend systems: %s",
                   vlc_strerror_c(errno));
@@ -547,7 +932,7 @@ legacy:
         .props = prop
     };
 #endif
-    if (ioctl (d->frontend, FE_GET_PROPERTY, &props) < 0)
+    if (ioctl (d->s->frontend, FE_GET_PROPERTY, &props) < 0)
     {
         msg_Err (d->obj, "unsupported kernel DVB version 3 or older (%s)",
                  vlc_strerror_c(errno));
@@ -567,7 +952,7 @@ legacy:
         msg_Info (d->obj, "please recompile "PACKAGE_NAME" "PACKAGE_VERSION);
 #endif
     struct dvb_frontend_info info;
-    if (ioctl (d->frontend, FE_GET_INFO, &info) < 0)
+    if (ioctl (d->s->frontend, FE_GET_INFO, &info) < 0)
     {
         msg_Err (d->obj, "cannot get frontend info: %s",
                  vlc_strerror_c(errno));
@@ -617,8 +1002,8 @@ float dvb_get_signal_strength (dvb_device_t *d)
 {
     uint16_t strength;
 
-    if (d->frontend == -1
-     || ioctl (d->frontend, FE_READ_SIGNAL_STRENGTH, &strength) < 0)
+    if (d->s->frontend == -1
+     || ioctl (d->s->frontend, FE_READ_SIGNAL_STRENGTH, &strength) < 0)
         return 0.;
     return strength / 65535.;
 }
@@ -627,21 +1012,68 @@ float dvb_get_snr (dvb_device_t *d)
 {
     uint16_t snr;
 
-    if (d->frontend == -1 || ioctl (d->frontend, FE_READ_SNR, &snr) < 0)
+    if (d->s->frontend == -1 || ioctl (d->s->frontend, FE_READ_SNR, &snr) < 0)
         return 0.;
     return snr / 65535.;
 }
 
 bool dvb_set_ca_pmt (dvb_device_t *d, const en50221_capmt_info_t *p_capmtinfo)
 {
-    if (d->cam != NULL)
+    struct dvb_session *s = d->s;
+
+    if (s->cam != NULL)
     {
-        en50221_SetCAPMT (d->cam, p_capmtinfo);
+        vlc_mutex_lock (&s->cam_lock);
+        en50221_SetCAPMT (s->cam, p_capmtinfo);
+        vlc_mutex_unlock (&s->cam_lock);
         return true;
     }
     return false;
 }
 
+/** Keeps track of the tuning parameters, the last value of each wins */
+static void dvb_props_record (struct dvb_props *p,
+                              const struct dtv_property *props, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        const struct dtv_property *prop = props + i;
+        size_t j = 0;
+
+        if (prop->cmd == DTV_CLEAR)
+        {
+            p->count = 0;
+            continue;
+        }
+        if (prop->cmd == DTV_TUNE)
+            continue;
+
+        while (j < p->count && p->props[j].cmd != prop->cmd)
+            j++;
+        if (j == DVB_PROPS_MAX)
+            continue; /* cannot happen with the known properties */
+        if (j == p->count)
+            p->count++;
+        p->props[j] = *prop;
+    }
+}
+
+/**
+ * Elects the input that tunes the frontend of the session.
+ * The others can only share the frontend once it is tuned.
+ */
+static bool dvb_own_frontend (dvb_device_t *d)
+{
+    struct dvb_session *s = d->s;
+
+    vlc_mutex_lock (&s->lock);
+    if (s->owner == NULL && !s->tuned)
+        s->owner = d;
+    bool owner = s->owner == d;
+    vlc_mutex_unlock (&s->lock);
+    return owner;
+}
+
 static int dvb_vset_props (dvb_device_t *d, size_t n, va_list ap)
 {
     assert (n <= DTV_IOCTL_MAX_MSGS);
@@ -661,12 +1093,22 @@ static int dvb_vset_props (dvb_device_t *d, size_t n, va_list ap)
         n--;
     }
 
-    if (ioctl (d->frontend, FE_SET_PROPERTY, &props) < 0)
+    if (!dvb_own_frontend (d))
+    {   /* checked against the owner parameters by dvb_tune() */
+        dvb_props_record (&d->tuning, buf, props.num);
+        return 0;
+    }
+
+    if (ioctl (d->s->frontend, FE_SET_PROPERTY, &props) < 0)
     {
         msg_Err (d->obj, "cannot set frontend tuning parameters: %s",
                  vlc_strerror_c(errno));
         return -1;
     }
+
+    vlc_mutex_lock (&d->s->lock);
+    dvb_props_record (&d->s->tuning, buf, props.num);
+    vlc_mutex_unlock (&d->s->lock);
     return 0;
 }
 
@@ -699,13 +1141,49 @@ int dvb_set_inversion (dvb_device_t *d, int v)
 
 int dvb_tune (dvb_device_t *d)
 {
-    return dvb_set_prop (d, DTV_TUNE, 0 /* dummy */);
+    struct dvb_session *s = d->s;
+
+    if (dvb_own_frontend (d))
+    {
+        if (dvb_set_prop (d, DTV_TUNE, 0 /* dummy */))
+            return -1;
+
+        vlc_mutex_lock (&s->lock);
+        s->tuned = true;
+        vlc_mutex_unlock (&s->lock);
+        return 0;
+    }
+
+    /* Another input tuned the frontend, it must be on the same transponder */
+    bool same = true;
+
+    vlc_mutex_lock (&s->lock);
+    for (size_t i = 0; i < d->tuning.count && same; i++)
+    {
+        const struct dtv_property *prop = d->tuning.props + i;
+        size_t j = 0;
+
+        while (j < s->tuning.count && s->tuning.props[j].cmd != prop->cmd)
+            j++;
+        same = j < s->tuning.count && s->tuning.props[j].u.data == prop->u.data;
+    }
+    same = same && s->tuned;
+    vlc_mutex_unlock (&s->lock);
+
+    if (!same)
+    {
+        msg_Err (d->obj, "frontend already tuned to other parameters");
+        errno = EBUSY;
+        return -1;
+    }
+    msg_Dbg (d->obj, "sharing the tuned frontend");
+    return 0;
 }
 
 int dvb_fill_device_caps(dvb_device_t *d, dvb_device_caps_t *caps)
 {
     struct dvb_frontend_info info;
-    if (ioctl (d->frontend, FE_GET_INFO, &info) < 0)
+    if (ioctl (d->s->frontend, FE_GET_INFO, &info) < 0)
     {
         msg_Err (d->obj, "cannot get frontend info: %s",
                  vlc_strerror_c(errno));
@@ -758,10 +1236,13 @@ int dvb_set_sec (dvb_device_t *d, uint64_t freq_Hz, char pol,
                  uint32_t lowf, uint32_t highf, uint32_t switchf)
 {
     uint32_t freq = freq_Hz / 1000;
+    /* Only the owner of the frontend drives the LNB */
+    bool owner = dvb_own_frontend (d);
 
     /* Always try to configure high voltage, but only warn on enable failure */
     int val = var_InheritBool (d->obj, "dvb-high-voltage");
-    if (ioctl (d->frontend, FE_ENABLE_HIGH_LNB_VOLTAGE, &val) < 0 && val)
+    if (owner && ioctl (d->s->frontend, FE_ENABLE_HIGH_LNB_VOLTAGE, &val) < 0
+     && val)
         msg_Err (d->obj, "cannot enable high LNB voltage: %s",
                  vlc_strerror_c(errno));
 
@@ -818,7 +1299,7 @@ known:
         return -1;
 
     unsigned satno = var_InheritInteger (d->obj, "dvb-satno");
-    if (satno > 0)
+    if (satno > 0 && owner)
     {
 #undef vlc_tick_sleep /* we know what we are doing! */
 
@@ -856,7 +1337,7 @@ known:
                        | (tone == SEC_TONE_ON); /* option */
           uncmd.msg[4] = uncmd.msg[5] = 0; /* unused */
           uncmd.msg_len = 4; /* length */
-          if (ioctl (d->frontend, FE_DISEQC_SEND_MASTER_CMD, &uncmd) < 0)
+          if (ioctl (d->s->frontend, FE_DISEQC_SEND_MASTER_CMD, &uncmd) < 0)
           {
               msg_Err (d->obj, "cannot send uncommitted DiSEqC command: %s",
                        vlc_strerror_c(errno));
@@ -864,7 +1345,7 @@ known:
           }
           /* Repeat uncommitted command */
           uncmd.msg[0] = 0xE1; /* framing: master, no reply, repeated TX */
-          if (ioctl (d->frontend, FE_DISEQC_SEND_MASTER_CMD, &uncmd) < 0)
+          if (ioctl (d->s->frontend, FE_DISEQC_SEND_MASTER_CMD, &uncmd) < 0)
           {
               msg_Err (d->obj,
                        "cannot send repeated uncommitted DiSEqC command: %s",
@@ -873,7 +1354,7 @@ known:
           }
           vlc_tick_sleep(VLC_TICK_FROM_MS(125)); /* wait 125 ms before committed DiSEqC command */
         }
-        if (ioctl (d->frontend, FE_DISEQC_SEND_MASTER_CMD, &cmd) < 0)
+        if (ioctl (d->s->frontend, FE_DISEQC_SEND_MASTER_CMD, &cmd) < 0)
         {
             msg_Err (d->obj, "cannot send committed DiSEqC command: %s",
                      vlc_strerror_c(errno));
@@ -883,7 +1364,7 @@ known:
 
         /* Mini-DiSEqC */
         satno &= 1;
-        if (ioctl (d->frontend, FE_DISEQC_SEND_BURST,
+        if (ioctl (d->s->frontend, FE_DISEQC_SEND_BURST,
                    satno ? SEC_MINI_B : SEC_MINI_A) < 0)
         {
             msg_Err (d->obj, "cannot send Mini-DiSEqC tone burst: %s",
@@ -50,6 +50,9 @@
 #else
 #   include <unistd.h>
 #endif
+#ifdef HAVE_MMAP
+#   include <sys/mman.h>
+#endif
 
 #include <vlc_common.h>
 #include "fs.h"
@@ -66,6 +69,13 @@ typedef struct
     int fd;
 
     bool b_pace_control;
+#ifdef HAVE_LIBURING
+    struct file_uring *uring;
+#endif
+#ifdef HAVE_MMAP
+    uint64_t mmap_offset;
+    size_t mmap_window;
+#endif
 } access_sys_t;
 
 #if !defined (_WIN32) && !defined (__OS2__)
@@ -168,6 +178,14 @@ static bool IsRemote (const char *path)
 static ssize_t Read (stream_t *, void *, size_t);
 static int FileSeek (stream_t *, uint64_t);
 static int FileControl (stream_t *, int, va_list);
+#ifdef HAVE_LIBURING
+static block_t *UringBlock (stream_t *, bool *restrict);
+static int UringSeek (stream_t *, uint64_t);
+#endif
+#ifdef HAVE_MMAP
+static block_t *MmapBlock (stream_t *, bool *restrict);
+static int MmapSeek (stream_t *, uint64_t);
+#endif
 
 /*****************************************************************************
  * FileOpen: open the file
@@ -252,6 +270,9 @@ int FileOpen( vlc_object_t *p_this )
     p_access->pf_control = FileControl;
     p_access->p_sys = p_sys;
     p_sys->fd = fd;
+#ifdef HAVE_LIBURING
+    p_sys->uring = NULL;
+#endif
 
     if (S_ISREG (st.st_mode) || S_ISBLK (st.st_mode))
     {
@@ -262,6 +283,8 @@ int FileOpen( vlc_object_t *p_this )
         posix_fadvise (fd, 0, 4096, POSIX_FADV_WILLNEED);
         /* In most cases, we only read the file once. */
         posix_fadvise (fd, 0, 0, POSIX_FADV_NOREUSE);
+        /* Let the kernel read ahead aggressively. */
+        posix_fadvise (fd, 0, 0, POSIX_FADV_SEQUENTIAL);
 #ifdef F_NOCACHE
         fcntl (fd, F_NOCACHE, 0);
 #endif
@@ -270,6 +293,48 @@ int FileOpen( vlc_object_t *p_this )
             fcntl (fd, F_RDAHEAD, 0);
         else
             fcntl (fd, F_RDAHEAD, 1);
+#endif
+#ifdef HAVE_MMAP
+        if (S_ISREG (st.st_mode) && var_InheritBool (p_access, "file-mmap")
+         && !IsRemote(fd, p_access->psz_filepath))
+        {
+            /* Map the file window by window, so that files larger than the
+             * address space or the RAM can be played too. */
+            long page = sysconf (_SC_PAGESIZE);
+
+            off_t pos = lseek (fd, 0, SEEK_CUR);
+
+            p_sys->mmap_offset = (pos > 0) ? pos : 0;
+            p_sys->mmap_window = var_InheritInteger (p_access,
+                                                     "file-mmap-window")
+                                 * (size_t)(1024 * 1024);
+            if (page > 0 && p_sys->mmap_window > (size_t)page)
+            {
+                p_access->pf_read = NULL;
+                p_access->pf_block = MmapBlock;
+                p_access->pf_seek = MmapSeek;
+            }
+        }
+#endif
+#ifdef HAVE_LIBURING
+        if (p_access->pf_read != NULL && S_ISREG (st.st_mode)
+         && var_InheritBool (p_access, "file-uring")
+         && !IsRemote(fd, p_access->psz_filepath))
+        {
+            /* Only bypass the page cache of files opened here: the flag is
+             * shared with the other duplicates of a passed descriptor. */
+            int64_t direct = var_InheritInteger (p_access, "file-direct");
+            bool b_direct = direct > 0 && strcasecmp (p_access->psz_name, "fd")
+                         && st.st_size / (1024 * 1024) >= direct;
+
+            p_sys->uring = FileUringNew (p_access, fd, b_direct);
+            if (p_sys->uring != NULL)
+            {
+                p_access->pf_read = NULL;
+                p_access->pf_block = UringBlock;
+                p_access->pf_seek = UringSeek;
+            }
+        }
 #endif
     }
     else
@@ -292,7 +357,7 @@ void FileClose (vlc_object_t * p_this)
 {
     stream_t     *p_access = (stream_t*)p_this;
 
-    if (p_access->pf_read == NULL)
+    if (p_access->pf_read == NULL && p_access->pf_block == NULL)
     {
         DirClose (p_this);
         return;
@@ -300,6 +365,10 @@ void FileClose (vlc_object_t * p_this)
 
     access_sys_t *p_sys = p_access->p_sys;
 
+#ifdef HAVE_LIBURING
+    if (p_sys->uring != NULL)
+        FileUringDelete (p_sys->uring);
+#endif
     vlc_close (p_sys->fd);
 }
 
@@ -326,6 +395,80 @@ static ssize_t Read (stream_t *p_access, void *p_buffer, size_t i_len)
     return val;
 }
 
+#ifdef HAVE_LIBURING
+static block_t *UringBlock (stream_t *p_access, bool *restrict eof)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+
+    return FileUringBlock (p_access, p_sys->uring, eof);
+}
+
+static int UringSeek (stream_t *p_access, uint64_t i_pos)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+
+    FileUringSeek (p_sys->uring, i_pos);
+    return VLC_SUCCESS;
+}
+#endif
+
+#ifdef HAVE_MMAP
+static block_t *MmapBlock (stream_t *p_access, bool *restrict eof)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+    struct stat st;
+
+    /* The file may still be growing (e.g. recording in progress). */
+    if (fstat (p_sys->fd, &st))
+    {
+        msg_Err (p_access, "read error: %s", vlc_strerror_c(errno));
+        *eof = true;
+        return NULL;
+    }
+
+    if ((uint64_t)st.st_size <= p_sys->mmap_offset)
+    {
+        *eof = true;
+        return NULL;
+    }
+
+    /* Mappings must start on a page boundary */
+    size_t skew = p_sys->mmap_offset % (uint64_t)sysconf (_SC_PAGESIZE);
+    uint64_t start = p_sys->mmap_offset - skew;
+    size_t length = p_sys->mmap_window;
+
+    if ((uint64_t)st.st_size - start < length)
+        length = st.st_size - start;
+
+    void *addr = mmap (NULL, length, PROT_READ, MAP_SHARED, p_sys->fd, start);
+    if (addr == MAP_FAILED)
+    {
+        msg_Err (p_access, "cannot map file at %"PRIu64": %s", start,
+                 vlc_strerror_c(errno));
+        *eof = true;
+        return NULL;
+    }
+    madvise (addr, length, MADV_SEQUENTIAL);
+
+    block_t *block = block_mmap_Alloc (addr, length);
+    if (unlikely(block == NULL))
+        return NULL;
+
+    block->p_buffer += skew;
+    block->i_buffer -= skew;
+    p_sys->mmap_offset = start + length;
+    return block;
+}
+
+static int MmapSeek (stream_t *p_access, uint64_t i_pos)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+
+    p_sys->mmap_offset = i_pos;
+    return VLC_SUCCESS;
+}
+#endif
+
 /*****************************************************************************
  * Seek: seek to a specific location in a file
  *****************************************************************************/
@@ -0,0 +1,426 @@
+/*****************************************************************************
+ * file_uring.c: asynchronous file reads with io_uring
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <liburing.h>
+
+#include <vlc_common.h>
+#include <vlc_access.h>
+#include <vlc_block.h>
+#include <vlc_atomic.h>
+#include <vlc_interrupt.h>
+#include "fs.h"
+
+/* Number of reads in flight, each into its own registered buffer. The size
+ * and alignment are suitable for O_DIRECT. */
+#define URING_DEPTH     8
+#define URING_SLOT_SIZE (256 * 1024)
+#define URING_ALIGN     4096
+
+enum
+{
+    URING_SLOT_FREE,
+    URING_SLOT_QUEUED,  /* Read in flight or not handed out yet */
+    URING_SLOT_HELD,    /* Owned by a frame */
+};
+
+/* The buffers are shared with the frames, which may outlive the access */
+struct uring_pool
+{
+    vlc_atomic_rc_t rc;
+    vlc_mutex_t lock;
+    uint8_t *base;
+    uint8_t state[URING_DEPTH];
+};
+
+struct uring_frame
+{
+    block_t self;
+    struct uring_pool *pool;
+    unsigned slot;
+};
+
+struct file_uring
+{
+    struct io_uring ring;
+    struct uring_pool *pool;
+    int fd;
+
+    struct
+    {
+        uint64_t offset;
+        int res;
+        bool done;
+    } reads[URING_DEPTH];
+
+    /* Queued slots, in submission order */
+    unsigned queue[URING_DEPTH];
+    unsigned head;
+    unsigned count;
+
+    uint64_t pos;  /* Offset of the next byte to return */
+    uint64_t next; /* Offset of the next read to submit */
+    uint64_t end;  /* End of file, once known */
+};
+
+static inline uint8_t *UringSlotBuffer(struct uring_pool *pool, unsigned slot)
+{
+    return pool->base + (size_t)slot * URING_SLOT_SIZE;
+}
+
+static void UringPoolRelease(struct uring_pool *pool)
+{
+    if (!vlc_atomic_rc_dec(&pool->rc))
+        return;
+
+    free(pool->base);
+    free(pool);
+}
+
+static int UringPoolGet(struct uring_pool *pool)
+{
+    int slot = -1;
+
+    vlc_mutex_lock(&pool->lock);
+    for (unsigned i = 0; i < URING_DEPTH; i++)
+        if (pool->state[i] == URING_SLOT_FREE)
+        {
+            pool->state[i] = URING_SLOT_QUEUED;
+            slot = i;
+            break;
+        }
+    vlc_mutex_unlock(&pool->lock);
+    return slot;
+}
+
+static void UringPoolPut(struct uring_pool *pool, unsigned slot)
+{
+    vlc_mutex_lock(&pool->lock);
+    assert(pool->state[slot] != URING_SLOT_FREE);
+    pool->state[slot] = URING_SLOT_FREE;
+    vlc_mutex_unlock(&pool->lock);
+}
+
+static void UringFrameRelease(block_t *block)
+{
+    struct uring_frame *frame = container_of(block, struct uring_frame, self);
+    struct uring_pool *pool = frame->pool;
+
+    UringPoolPut(pool, frame->slot);
+    UringPoolRelease(pool);
+    free(frame);
+}
+
+static const struct vlc_frame_callbacks UringFrameCbs =
+{
+    UringFrameRelease,
+};
+
+static void UringSubmit(struct file_uring *u)
+{
+    unsigned submitted = 0;
+
+    while (u->count < URING_DEPTH && u->next < u->end)
+    {
+        int slot = UringPoolGet(u->pool);
+        if (slot < 0)
+            break; /* All the buffers are held downstream */
+
+        struct io_uring_sqe *sqe = io_uring_get_sqe(&u->ring);
+        if (unlikely(sqe == NULL))
+        {
+            UringPoolPut(u->pool, slot);
+            break;
+        }
+
+        io_uring_prep_read_fixed(sqe, u->fd, UringSlotBuffer(u->pool, slot),
+                                 URING_SLOT_SIZE, u->next, slot);
+        io_uring_sqe_set_data(sqe, (void *)(uintptr_t)slot);
+
+        u->reads[slot].offset = u->next;
+        u->reads[slot].done = false;
+        u->queue[(u->head + u->count) % URING_DEPTH] = slot;
+        u->count++;
+        u->next += URING_SLOT_SIZE;
+        submitted++;
+    }
+
+    if (submitted > 0)
+        io_uring_submit(&u->ring);
+}
+
+static int UringReap(struct file_uring *u, bool interruptible)
+{
+    struct io_uring_cqe *cqe;
+    int ret;
+
+    if (interruptible)
+    {
+        /* Poll for interruptions: io_uring waits are not interruptible */
+        struct __kernel_timespec ts = { .tv_sec = 0, .tv_nsec = 100000000 };
+
+        ret = io_uring_wait_cqe_timeout(&u->ring, &cqe, &ts);
+    }
+    else
+        ret = io_uring_wait_cqe(&u->ring, &cqe);
+
+    if (ret < 0)
+        return ret;
+
+    unsigned slot = (uintptr_t)io_uring_cqe_get_data(cqe);
+    assert(slot < URING_DEPTH);
+    u->reads[slot].res = cqe->res;
+    u->reads[slot].done = true;
+    io_uring_cqe_seen(&u->ring, cqe);
+    return 0;
+}
+
+static int UringWait(stream_t *access, struct file_uring *u, unsigned slot)
+{
+    while (!u->reads[slot].done)
+    {
+        int ret = UringReap(u, true);
+
+        if (ret == -ETIME || ret == -EINTR)
+        {
+            if (vlc_killed())
+                return VLC_EGENERIC;
+            continue;
+        }
+        if (ret < 0)
+        {
+            msg_Err(access, "completion error: %s", vlc_strerror_c(-ret));
+            return VLC_EGENERIC;
+        }
+    }
+    return VLC_SUCCESS;
+}
+
+/* Fallback when the consumer holds all the registered buffers */
+static block_t *UringReadCopy(stream_t *access, struct file_uring *u)
+{
+    const uint64_t offset = u->pos & ~(uint64_t)(URING_ALIGN - 1);
+    const size_t skip = u->pos - offset;
+    block_t *block = block_Alloc(URING_SLOT_SIZE + URING_ALIGN);
+
+    if (unlikely(block == NULL))
+        return NULL;
+
+    /* Keep the O_DIRECT alignment constraints */
+    uint8_t *buf = (uint8_t *)(((uintptr_t)block->p_buffer + URING_ALIGN - 1)
+                               & ~(uintptr_t)(URING_ALIGN - 1));
+    ssize_t val = pread(u->fd, buf, URING_SLOT_SIZE, offset);
+    if (val < 0 || (size_t)val <= skip)
+    {
+        if (val < 0 && errno != EINTR && errno != EAGAIN)
+            msg_Err(access, "read error: %s", vlc_strerror_c(errno));
+        if (val >= 0 || (errno != EINTR && errno != EAGAIN))
+            u->end = u->pos;
+        block_Release(block);
+        return NULL;
+    }
+
+    block->p_buffer = buf + skip;
+    block->i_buffer = val - skip;
+    u->pos += block->i_buffer;
+    return block;
+}
+
+block_t *FileUringBlock(stream_t *access, struct file_uring *u,
+                        bool *restrict eof)
+{
+    for (;;)
+    {
+        UringSubmit(u);
+
+        if (u->count == 0)
+        {
+            if (u->pos >= u->end)
+            {
+                *eof = true;
+                return NULL;
+            }
+            return UringReadCopy(access, u);
+        }
+
+        const unsigned slot = u->queue[u->head];
+        if (UringWait(access, u, slot))
+            return NULL;
+
+        u->head = (u->head + 1) % URING_DEPTH;
+        u->count--;
+
+        const uint64_t offset = u->reads[slot].offset;
+        const int res = u->reads[slot].res;
+
+        if (res < 0)
+        {
+            UringPoolPut(u->pool, slot);
+            if (res == -EAGAIN || res == -EINTR)
+            {   /* Read again from the current position */
+                u->next = u->pos & ~(uint64_t)(URING_ALIGN - 1);
+                continue;
+            }
+            msg_Err(access, "read error: %s", vlc_strerror_c(-res));
+            u->end = u->pos;
+            continue;
+        }
+
+        /* Regular files only return short reads at the end */
+        if ((size_t)res < URING_SLOT_SIZE && offset + res < u->end)
+            u->end = offset + res;
+
+        /* Discard reads issued before a seek */
+        if (u->pos < offset || u->pos >= offset + res)
+        {
+            UringPoolPut(u->pool, slot);
+            continue;
+        }
+
+        struct uring_frame *frame = malloc(sizeof (*frame));
+        if (unlikely(frame == NULL))
+        {
+            UringPoolPut(u->pool, slot);
+            return NULL;
+        }
+
+        const size_t skip = u->pos - offset;
+        block_Init(&frame->self, &UringFrameCbs,
+                   UringSlotBuffer(u->pool, slot) + skip, res - skip);
+        vlc_mutex_lock(&u->pool->lock);
+        u->pool->state[slot] = URING_SLOT_HELD;
+        vlc_mutex_unlock(&u->pool->lock);
+        vlc_atomic_rc_inc(&u->pool->rc);
+        frame->pool = u->pool;
+        frame->slot = slot;
+
+        u->pos = offset + res;
+        return &frame->self;
+    }
+}
+
+void FileUringSeek(struct file_uring *u, uint64_t pos)
+{
+    /* The reads in flight are discarded as they complete, unless they
+     * happen to cover the new position */
+    u->pos = pos;
+    u->next = pos & ~(uint64_t)(URING_ALIGN - 1);
+    u->end = UINT64_MAX;
+}
+
+struct file_uring *FileUringNew(stream_t *access, int fd, bool direct)
+{
+    struct file_uring *u = malloc(sizeof (*u));
+    if (unlikely(u == NULL))
+        return NULL;
+
+    struct uring_pool *pool = malloc(sizeof (*pool));
+    if (unlikely(pool == NULL))
+        goto error;
+
+    pool->base = aligned_alloc(URING_ALIGN, URING_DEPTH * URING_SLOT_SIZE);
+    if (unlikely(pool->base == NULL))
+    {
+        free(pool);
+        goto error;
+    }
+    vlc_atomic_rc_init(&pool->rc);
+    vlc_mutex_init(&pool->lock);
+    for (unsigned i = 0; i < URING_DEPTH; i++)
+        pool->state[i] = URING_SLOT_FREE;
+    u->pool = pool;
+
+    int ret = io_uring_queue_init(URING_DEPTH, &u->ring, 0);
+    if (ret < 0)
+    {
+        msg_Dbg(access, "io_uring not available: %s", vlc_strerror_c(-ret));
+        goto error_pool;
+    }
+
+    struct iovec iov[URING_DEPTH];
+    for (unsigned i = 0; i < URING_DEPTH; i++)
+    {
+        iov[i].iov_base = UringSlotBuffer(pool, i);
+        iov[i].iov_len = URING_SLOT_SIZE;
+    }
+
+    ret = io_uring_register_buffers(&u->ring, iov, URING_DEPTH);
+    if (ret < 0)
+    {
+        msg_Dbg(access, "cannot register buffers: %s", vlc_strerror_c(-ret));
+        io_uring_queue_exit(&u->ring);
+        goto error_pool;
+    }
+
+    if (direct)
+    {
+        int flags = fcntl(fd, F_GETFL);
+
+        if (flags == -1 || fcntl(fd, F_SETFL, flags | O_DIRECT))
+            msg_Warn(access, "cannot bypass the page cache: %s",
+                     vlc_strerror_c(errno));
+        else
+            msg_Dbg(access, "bypassing the page cache");
+    }
+
+    u->fd = fd;
+    u->head = 0;
+    u->count = 0;
+    u->pos = 0;
+    u->next = 0;
+    u->end = UINT64_MAX;
+    return u;
+
+error_pool:
+    UringPoolRelease(pool);
+error:
+    free(u);
+    return NULL;
+}
+
+void FileUringDelete(struct file_uring *u)
+{
+    /* The kernel writes to the buffers until the reads complete */
+    while (u->count > 0)
+    {
+        const unsigned slot = u->queue[u->head];
+
+        while (!u->reads[slot].done)
+            if (UringReap(u, false) < 0)
+                break;
+
+        UringPoolPut(u->pool, slot);
+        u->head = (u->head + 1) % URING_DEPTH;
+        u->count--;
+    }
+
+    io_uring_queue_exit(&u->ring);
+    UringPoolRelease(u->pool);
+    free(u);
+}
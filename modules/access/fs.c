@@ -37,6 +37,24 @@ vlc_module_begin ()
     set_capability( "access", 50 )
     add_shortcut( "file", "fd", "stream" )
     set_callbacks( FileOpen, FileClose )
+#ifdef HAVE_LIBURING
+    add_bool( "file-uring", true, N_("Asynchronous reads"),
+              N_("Read local files with several requests in flight "
+                 "(io_uring).") )
+    add_integer( "file-direct", 0, N_("Direct I/O threshold (MiB)"),
+                 N_("Bypass the page cache when reading files larger than "
+                    "this size asynchronously. 0 disables it.") )
+        change_integer_range( 0, 1024 * 1024 )
+#endif
+#ifdef HAVE_MMAP
+    add_bool( "file-mmap", false, N_("Memory-mapped reads"),
+              N_("Map local files in memory, so that demuxers can parse "
+                 "them in place. The file must not be truncated while it "
+                 "is being played.") )
+    add_integer( "file-mmap-window", 64, N_("Mapping window (MiB)"),
+                 N_("Size of the file chunks mapped in memory at once.") )
+        change_integer_range( 1, 1024 )
+#endif
 
     add_submodule()
     set_section( N_("Directory" ), NULL )
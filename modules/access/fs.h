@@ -23,6 +23,15 @@
 int FileOpen (vlc_object_t *);
 void FileClose (vlc_object_t *);
 
+#ifdef HAVE_LIBURING
+struct file_uring;
+
+struct file_uring *FileUringNew (stream_t *, int fd, bool direct);
+void FileUringDelete (struct file_uring *);
+block_t *FileUringBlock (stream_t *, struct file_uring *, bool *restrict eof);
+void FileUringSeek (struct file_uring *, uint64_t);
+#endif
+
 int DirOpen (vlc_object_t *);
 int DirInit (stream_t *p_access, vlc_DIR *handle);
 void DirClose (vlc_object_t *);
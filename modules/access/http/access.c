@@ -307,4 +307,9 @@ vlc_module_begin()
                   "e.g. \"FooBar/1.2.3\"."))
         change_safe()
         change_private()
+    add_integer("http2-window", 16384, N_("HTTP/2 receive window"),
+                N_("Maximum amount of data in kilobytes that an HTTP/2 "
+                   "server may send ahead on a stream. The window grows up "
+                   "to it with the measured bandwidth and round-trip time."))
+        change_integer_range(0, 2097151)
 vlc_module_end()
@@ -39,26 +39,33 @@
 ssize_t vlc_https_chunked_write(struct vlc_tls *tls, const void *base,
                                 size_t len, bool eos)
 {
+    char hdr[sizeof (size_t) * 2 + 3];
+    struct iovec iov[4];
+    unsigned count = 0;
+    size_t total = 0;
+
     if (len > 0)
     {
-        char hdr[sizeof (size_t) * 2 + 3];
         int hlen = snprintf(hdr, sizeof (hdr), "%zx\r\n", len);
 
-        /* TODO: use iovec */
-        if (vlc_tls_Write(tls, hdr, hlen) < hlen)
-            return -1;
-        if (vlc_tls_Write(tls, base, len) < (ssize_t)len)
-            return -1;
-        if (vlc_tls_Write(tls, "\r\n", 2) < 2)
-            return -1;
+        iov[count++] = (struct iovec){ .iov_base = hdr, .iov_len = hlen };
+        iov[count++] = (struct iovec){ .iov_base = (void *)base,
+                                       .iov_len = len };
+        iov[count++] = (struct iovec){ .iov_base = (void *)"\r\n",
+                                       .iov_len = 2 };
+        total += hlen + len + 2;
     }
 
     if (eos)
     {
-        if (vlc_tls_Write(tls, "0\r\n\r\n", 5) < 5)
-            return -1;
+        iov[count++] = (struct iovec){ .iov_base = (void *)"0\r\n\r\n",
+                                       .iov_len = 5 };
+        total += 5;
     }
 
+    if (vlc_tls_WriteV(tls, iov, count) < (ssize_t)total)
+        return -1;
+
     return len;
 }
 
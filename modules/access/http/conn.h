@@ -36,6 +36,7 @@ struct vlc_http_conn_cbs
                                            const struct vlc_http_msg *,
                                            bool has_data);
     void (*release)(struct vlc_http_conn *);
+    unsigned (*active)(struct vlc_http_conn *);
 };
 
 struct vlc_http_conn
@@ -56,6 +57,16 @@ static inline void vlc_http_conn_release(struct vlc_http_conn *conn)
     conn->cbs->release(conn);
 }
 
+/**
+ * Counts the streams currently open on a connection.
+ *
+ * This may be called from another thread than the streams users.
+ */
+static inline unsigned vlc_http_conn_active(struct vlc_http_conn *conn)
+{
+    return conn->cbs->active(conn);
+}
+
 void vlc_http_err(void *, const char *msg, ...) VLC_FORMAT(2, 3);
 void vlc_http_dbg(void *, const char *msg, ...) VLC_FORMAT(2, 3);
 
@@ -113,7 +124,15 @@ struct vlc_http_stream *vlc_h1_request(void *ctx, const char *hostname,
  * \defgroup h2 HTTP/2.0
  * @{
  */
-struct vlc_http_conn *vlc_h2_conn_create(void *ctx, struct vlc_tls *);
+/**
+ * Creates an HTTP/2 connection.
+ *
+ * \param window_max limit of the receive window of each stream in bytes,
+ *                   which grows with the measured bandwidth-delay product
+ *                   (0 to keep the initial window)
+ */
+struct vlc_http_conn *vlc_h2_conn_create(void *ctx, struct vlc_tls *,
+                                         uint_fast32_t window_max);
 
 /** @} */
 
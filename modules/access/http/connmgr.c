@@ -27,10 +27,14 @@
 #include <vlc_network.h>
 #include <vlc_tls.h>
 #include <vlc_url.h>
+#include <vlc_list.h>
+#include <vlc_threads.h>
+#include <vlc_tick.h>
 #include "transport.h"
 #include "conn.h"
 #include "connmgr.h"
 #include "message.h"
+#include "h2frame.h"
 
 #pragma GCC visibility push(default)
 
@@ -96,51 +100,178 @@ static char *vlc_http_proxy_find(const char *hostname, unsigned port,
 }
 
 
+/* Idle connections are closed after that delay */
+#define VLC_HTTP_MGR_IDLE_TIMEOUT VLC_TICK_FROM_SEC(30)
+/* Maximum number of idle connections kept per server */
+#define VLC_HTTP_MGR_MAX_IDLE 4
+
+struct vlc_http_mgr_conn
+{
+    struct vlc_list node;
+    struct vlc_http_conn *conn;
+    vlc_tick_t idle_date; /**< Last time the connection was seen in use */
+    bool multiplex; /**< Whether streams can share the connection (HTTP/2) */
+    bool idle;
+    bool secure;
+    unsigned port;
+    char host[];
+};
+
 struct vlc_http_mgr
 {
     struct vlc_logger *logger;
     vlc_object_t *obj;
     vlc_tls_client_t *creds;
     struct vlc_http_cookie_jar_t *jar;
-    struct vlc_http_conn *conn;
+    uint32_t h2_window; /**< HTTP/2 stream receive window limit */
+    vlc_mutex_t lock;
+    struct vlc_list conns; /**< Most recently used first */
 };
 
-static struct vlc_http_conn *vlc_http_mgr_find(struct vlc_http_mgr *mgr,
-                                               const char *host, unsigned port)
+static bool vlc_http_mgr_match(const struct vlc_http_mgr_conn *entry,
+                               const char *host, unsigned port, bool secure)
+{
+    return entry->secure == secure && entry->port == port
+        && !strcasecmp(entry->host, host);
+}
+
+static void vlc_http_mgr_remove(struct vlc_http_mgr_conn *entry)
+{
+    vlc_list_remove(&entry->node);
+    /* Open streams are not affected: the connection lives until they end */
+    vlc_http_conn_release(entry->conn);
+    free(entry);
+}
+
+/** Closes the connections that have been idle too long or in excess. */
+static void vlc_http_mgr_prune(struct vlc_http_mgr *mgr, vlc_tick_t now)
 {
-    (void) host; (void) port;
-    return mgr->conn;
+    struct vlc_http_mgr_conn *entry;
+
+    vlc_list_foreach(entry, &mgr->conns, node)
+    {
+        entry->idle = vlc_http_conn_active(entry->conn) == 0;
+        if (!entry->idle)
+        {
+            entry->idle_date = now;
+            continue;
+        }
+
+        if (now - entry->idle_date > VLC_HTTP_MGR_IDLE_TIMEOUT)
+        {
+            vlc_http_mgr_remove(entry);
+            continue;
+        }
+
+        /* Keep the most recently used ones, which are seen first */
+        const struct vlc_http_mgr_conn *other;
+        unsigned count = 0;
+
+        vlc_list_foreach_const(other, &mgr->conns, node)
+        {
+            if (other == entry)
+                break;
+            if (other->idle
+             && vlc_http_mgr_match(other, entry->host, entry->port,
+                                   entry->secure))
+                count++;
+        }
+
+        if (count >= VLC_HTTP_MGR_MAX_IDLE)
+            vlc_http_mgr_remove(entry);
+    }
+}
+
+static void vlc_http_mgr_add(struct vlc_http_mgr *mgr, const char *host,
+                             unsigned port, bool secure, bool multiplex,
+                             struct vlc_http_conn *conn)
+{
+    size_t len = strlen(host) + 1;
+    struct vlc_http_mgr_conn *entry = malloc(sizeof (*entry) + len);
+
+    if (unlikely(entry == NULL))
+    {   /* Not reusable, but the stream keeps working */
+        vlc_http_conn_release(conn);
+        return;
+    }
+
+    entry->conn = conn;
+    entry->idle_date = vlc_tick_now();
+    entry->multiplex = multiplex;
+    entry->idle = false;
+    entry->secure = secure;
+    entry->port = port;
+    memcpy(entry->host, host, len);
+
+    vlc_mutex_lock(&mgr->lock);
+    vlc_list_prepend(&entry->node, &mgr->conns);
+    vlc_mutex_unlock(&mgr->lock);
 }
 
 static void vlc_http_mgr_release(struct vlc_http_mgr *mgr,
                                  struct vlc_http_conn *conn)
 {
-    assert(mgr->conn == conn);
-    mgr->conn = NULL;
-
-    vlc_http_conn_release(conn);
+    struct vlc_http_mgr_conn *entry;
+
+    vlc_mutex_lock(&mgr->lock);
+    vlc_list_foreach(entry, &mgr->conns, node)
+        if (entry->conn == conn)
+        {
+            vlc_http_mgr_remove(entry);
+            break;
+        }
+    vlc_mutex_unlock(&mgr->lock);
 }
 
 static
 struct vlc_http_msg *vlc_http_mgr_reuse(struct vlc_http_mgr *mgr,
                                         const char *host, unsigned port,
+                                        bool secure,
                                         const struct vlc_http_msg *req,
                                         bool payload)
 {
-    struct vlc_http_conn *conn = vlc_http_mgr_find(mgr, host, port);
-    if (conn == NULL)
-        return NULL;
+    struct vlc_http_mgr_conn *entry;
+    struct vlc_http_conn *conn = NULL;
+    struct vlc_http_stream *stream = NULL;
+    vlc_tick_t now = vlc_tick_now();
 
-    struct vlc_http_stream *stream = vlc_http_stream_open(conn, req, payload);
-    if (stream != NULL)
+    vlc_mutex_lock(&mgr->lock);
+    vlc_http_mgr_prune(mgr, now);
+
+    vlc_list_foreach(entry, &mgr->conns, node)
     {
-        struct vlc_http_msg *m = vlc_http_msg_get_initial(stream);
-        if (m != NULL)
-            return m;
+        if (!vlc_http_mgr_match(entry, host, port, secure))
+            continue;
+        if (!entry->multiplex && !entry->idle)
+            continue; /* HTTP/1 connection busy with another stream */
+
+        /* The stream is opened with the lock held, so that no other thread
+         * can pick the same HTTP/1 connection. */
+        stream = vlc_http_stream_open(entry->conn, req, payload);
+        if (stream == NULL)
+        {   /* Get rid of closing or reset connection */
+            vlc_http_mgr_remove(entry);
+            continue;
+        }
+
+        conn = entry->conn;
+        entry->idle = false;
+        entry->idle_date = now;
+        /* Move to the front as the most recently used */
+        vlc_list_remove(&entry->node);
+        vlc_list_prepend(&entry->node, &mgr->conns);
+        break;
     }
-    /* Get rid of closing or reset connection */
-    vlc_http_mgr_release(mgr, conn);
-    return NULL;
+    vlc_mutex_unlock(&mgr->lock);
+
+    if (stream == NULL)
+        return NULL;
+
+    struct vlc_http_msg *m = vlc_http_msg_get_initial(stream);
+    if (m == NULL)
+        /* Get rid of closing or reset connection */
+        vlc_http_mgr_release(mgr, conn);
+    return m;
 }
 
 static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
@@ -148,18 +279,19 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
                                               const struct vlc_http_msg *req,
                                               bool idempotent, bool payload)
 {
+    vlc_tls_client_t *creds;
     vlc_tls_t *tls;
     bool http2 = true;
 
-    if (mgr->creds == NULL && mgr->conn != NULL)
-        return NULL; /* switch from HTTP to HTTPS not implemented */
-
+    vlc_mutex_lock(&mgr->lock);
     if (mgr->creds == NULL)
-    {   /* First TLS connection: load x509 credentials */
+        /* First TLS connection: load x509 credentials */
         mgr->creds = vlc_tls_ClientCreate(mgr->obj);
-        if (mgr->creds == NULL)
-            return NULL;
-    }
+    creds = mgr->creds;
+    vlc_mutex_unlock(&mgr->lock);
+
+    if (creds == NULL)
+        return NULL;
 
     if (idempotent)
     {   /* If the request is idempotent, try to reuse an existing connection.
@@ -167,8 +299,8 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
          * the nonidempotent request was processed if the connection fails
          * before the response is received.
          */
-        struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, host, port, req,
-                                                       payload);
+        struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, host, port, true,
+                                                       req, payload);
         if (resp != NULL)
             return resp; /* existing connection reused */
     }
@@ -176,12 +308,11 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
     char *proxy = vlc_http_proxy_find(host, port, true);
     if (proxy != NULL)
     {
-        tls = vlc_https_connect_proxy(mgr->creds, mgr->creds,
-                                      host, port, &http2, proxy);
+        tls = vlc_https_connect_proxy(creds, creds, host, port, &http2, proxy);
         free(proxy);
     }
     else
-        tls = vlc_https_connect(mgr->creds, host, port, &http2);
+        tls = vlc_https_connect(creds, host, port, &http2);
 
     if (tls == NULL)
         return NULL;
@@ -196,7 +327,7 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
      * NOTE: We do not enforce TLS version 1.2 for HTTP 2.0 explicitly.
      */
     if (http2)
-        conn = vlc_h2_conn_create(mgr->logger, tls);
+        conn = vlc_h2_conn_create(mgr->logger, tls, mgr->h2_window);
     else
         conn = vlc_h1_conn_create(mgr->logger, tls, false);
 
@@ -206,11 +337,19 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
         return NULL;
     }
 
-    if (mgr->conn != NULL)
-        vlc_http_mgr_release(mgr, mgr->conn);
+    struct vlc_http_stream *stream = vlc_http_stream_open(conn, req, payload);
+    struct vlc_http_msg *resp = NULL;
+
+    if (stream != NULL)
+        resp = vlc_http_msg_get_initial(stream);
+    if (resp == NULL)
+    {
+        vlc_http_conn_release(conn);
+        return NULL;
+    }
 
-    mgr->conn = conn;
-    return vlc_http_mgr_reuse(mgr, host, port, req, payload);
+    vlc_http_mgr_add(mgr, host, port, true, http2, conn);
+    return resp;
 }
 
 static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
@@ -218,13 +357,10 @@ static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
                                              const struct vlc_http_msg *req,
                                              bool idempotent, bool payload)
 {
-    if (mgr->creds != NULL && mgr->conn != NULL)
-        return NULL; /* switch from HTTPS to HTTP not implemented */
-
     if (idempotent)
     {
-        struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, host, port, req,
-                                                       payload);
+        struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, host, port, false,
+                                                       req, payload);
         if (resp != NULL)
             return resp;
     }
@@ -263,10 +399,7 @@ static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
         return NULL;
     }
 
-    if (mgr->conn != NULL)
-        vlc_http_mgr_release(mgr, mgr->conn);
-
-    mgr->conn = conn;
+    vlc_http_mgr_add(mgr, host, port, false, false, conn);
     return resp;
 }
 
@@ -298,14 +431,19 @@ struct vlc_http_mgr *vlc_http_mgr_create(vlc_object_t *obj,
     mgr->obj = obj;
     mgr->creds = NULL;
     mgr->jar = jar;
-    mgr->conn = NULL;
+    mgr->h2_window = VLC_CLIP(var_InheritInteger(obj, "http2-window"), 0,
+                              VLC_H2_MAX_WINDOW / 1024) * 1024;
+    vlc_mutex_init(&mgr->lock);
+    vlc_list_init(&mgr->conns);
     return mgr;
 }
 
 void vlc_http_mgr_destroy(struct vlc_http_mgr *mgr)
 {
-    if (mgr->conn != NULL)
-        vlc_http_mgr_release(mgr, mgr->conn);
+    struct vlc_http_mgr_conn *entry;
+
+    vlc_list_foreach(entry, &mgr->conns, node)
+        vlc_http_mgr_remove(entry);
     if (mgr->creds != NULL)
         vlc_tls_ClientDelete(mgr->creds);
     free(mgr);
@@ -60,7 +60,9 @@ struct vlc_http_cookie_jar_t *vlc_http_mgr_get_jar(struct vlc_http_mgr *);
 /**
  * Creates an HTTP connection manager
  *
- * Allocates an HTTP client connections manager.
+ * Allocates an HTTP client connections manager. The manager keeps a pool of
+ * connections per server, which can serve concurrent requests from several
+ * threads. HTTP/2 connections are shared by concurrent streams.
  *
  * @param obj parent VLC object
  * @param jar HTTP cookies jar (NULL to disable cookies)
@@ -72,7 +74,8 @@ struct vlc_http_mgr *vlc_http_mgr_create(vlc_object_t *obj,
  * Destroys an HTTP connection manager
  *
  * Deallocates an HTTP client connections manager created by
- * vlc_http_msg_destroy(). Any remaining connection is closed and destroyed.
+ * vlc_http_msg_destroy(). Any remaining idle connection is closed and
+ * destroyed, the others are destroyed once their streams are closed.
  */
 void vlc_http_mgr_destroy(struct vlc_http_mgr *mgr);
 
@@ -0,0 +1,370 @@
+/*****************************************************************************
+ * connmgr_test.c: HTTP connection manager test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_tick.h>
+#include <vlc_tls.h>
+#include "transport.h"
+#include "conn.h"
+#include "connmgr.h"
+#include "message.h"
+
+const char vlc_module_name[] = "test_http_connmgr";
+
+struct fake_conn
+{
+    struct vlc_http_conn conn;
+    unsigned streams;
+    bool multiplex;
+    bool released;
+    bool dead;
+};
+
+struct fake_stream
+{
+    struct vlc_http_stream stream;
+    struct fake_conn *conn;
+};
+
+static unsigned conn_count; /* connections established */
+static unsigned release_count; /* connections released by the manager */
+static bool fail_initial;
+static bool negotiate_h2;
+static vlc_tick_t now = VLC_TICK_0;
+
+static void fake_conn_destroy(struct fake_conn *conn)
+{
+    if (conn->released && conn->streams == 0)
+        free(conn);
+}
+
+static struct vlc_http_stream *fake_stream_open(struct vlc_http_conn *c,
+                                                const struct vlc_http_msg *req,
+                                                bool has_data)
+{
+    struct fake_conn *conn = container_of(c, struct fake_conn, conn);
+
+    assert(req != NULL);
+    (void) has_data;
+    assert(!conn->released);
+
+    if (conn->dead || (!conn->multiplex && conn->streams > 0))
+        return NULL;
+
+    struct fake_stream *s = malloc(sizeof (*s));
+    assert(s != NULL);
+    s->conn = conn;
+    conn->streams++;
+    return &s->stream;
+}
+
+static void fake_stream_close(struct vlc_http_msg *m)
+{
+    struct fake_stream *s = (struct fake_stream *)m;
+    struct fake_conn *conn = s->conn;
+
+    assert(conn->streams > 0);
+    conn->streams--;
+    free(s);
+    fake_conn_destroy(conn);
+}
+
+static void fake_conn_release(struct vlc_http_conn *c)
+{
+    struct fake_conn *conn = container_of(c, struct fake_conn, conn);
+
+    assert(!conn->released);
+    conn->released = true;
+    release_count++;
+    fake_conn_destroy(conn);
+}
+
+static unsigned fake_conn_active(struct vlc_http_conn *c)
+{
+    return container_of(c, struct fake_conn, conn)->streams;
+}
+
+static const struct vlc_http_conn_cbs fake_conn_cbs =
+{
+    fake_stream_open,
+    fake_conn_release,
+    fake_conn_active,
+};
+
+static struct vlc_http_conn *fake_conn_create(bool multiplex)
+{
+    struct fake_conn *conn = malloc(sizeof (*conn));
+    assert(conn != NULL);
+
+    conn->conn.cbs = &fake_conn_cbs;
+    conn->conn.tls = NULL;
+    conn->streams = 0;
+    conn->multiplex = multiplex;
+    conn->released = false;
+    conn->dead = false;
+    conn_count++;
+    return &conn->conn;
+}
+
+static struct vlc_http_msg *request(struct vlc_http_mgr *mgr, bool https,
+                                    const char *host)
+{
+    static const char dummy;
+    /* Only the pointer is used by the fake connections */
+    const struct vlc_http_msg *req = (const void *)&dummy;
+
+    return vlc_http_mgr_request(mgr, https, host, 0, req, true, false);
+}
+
+static struct fake_conn *msg_conn(struct vlc_http_msg *m)
+{
+    return ((struct fake_stream *)m)->conn;
+}
+
+int main(void)
+{
+    struct vlc_object_t obj = { .logger = NULL };
+    struct vlc_http_mgr *mgr = vlc_http_mgr_create(&obj, NULL);
+    struct vlc_http_msg *m, *m2, *ms[6];
+
+    assert(mgr != NULL);
+
+    /* Reuse of an idle HTTP/1 connection */
+    m = request(mgr, false, "www.example.com");
+    assert(m != NULL && conn_count == 1);
+    struct fake_conn *conn_a = msg_conn(m);
+    fake_stream_close(m);
+    m = request(mgr, false, "www.example.com");
+    assert(m != NULL && conn_count == 1 && msg_conn(m) == conn_a);
+    fake_stream_close(m);
+
+    /* Another server does not evict the first connection */
+    m = request(mgr, false, "www.example.org");
+    assert(m != NULL && conn_count == 2 && msg_conn(m) != conn_a);
+    fake_stream_close(m);
+    assert(release_count == 0);
+    m = request(mgr, false, "WWW.EXAMPLE.COM");
+    assert(m != NULL && conn_count == 2 && msg_conn(m) == conn_a);
+    fake_stream_close(m);
+
+    /* A busy HTTP/1 connection is neither used nor evicted */
+    m = request(mgr, false, "www.example.com");
+    assert(m != NULL && msg_conn(m) == conn_a);
+    m2 = request(mgr, false, "www.example.com");
+    assert(m2 != NULL && conn_count == 3 && msg_conn(m2) != conn_a);
+    assert(release_count == 0);
+    fake_stream_close(m);
+    fake_stream_close(m2);
+
+    /* HTTP and HTTPS connections are kept apart */
+    negotiate_h2 = false;
+    m = request(mgr, true, "www.example.com");
+    assert(m != NULL && conn_count == 4 && msg_conn(m) != conn_a);
+    assert(!msg_conn(m)->multiplex);
+    fake_stream_close(m);
+
+    /* Excess idle connections are closed */
+    for (size_t i = 0; i < ARRAY_SIZE(ms); i++)
+    {
+        ms[i] = request(mgr, false, "www.example.net");
+        assert(ms[i] != NULL);
+    }
+    assert(conn_count == 10);
+    for (size_t i = 0; i < ARRAY_SIZE(ms); i++)
+        fake_stream_close(ms[i]);
+    m = request(mgr, false, "www.example.net");
+    assert(m != NULL && conn_count == 10);
+    assert(release_count == ARRAY_SIZE(ms) - 4);
+    fake_stream_close(m);
+
+    /* Dead connections are replaced */
+    release_count = 0;
+    m = request(mgr, false, "www.example.org");
+    assert(m != NULL && conn_count == 10);
+    struct fake_conn *conn_b = msg_conn(m);
+    fake_stream_close(m);
+    conn_b->dead = true;
+    m = request(mgr, false, "www.example.org");
+    assert(m != NULL && conn_count == 11 && msg_conn(m) != conn_b);
+    assert(release_count == 1);
+    fake_stream_close(m);
+
+    /* So are connections failing to answer, and a new one is tried */
+    release_count = 0;
+    fail_initial = true;
+    m = request(mgr, false, "www.example.org");
+    assert(m == NULL && conn_count == 12 && release_count == 2);
+    fail_initial = false;
+
+    /* HTTP/2 connections are shared by concurrent streams */
+    negotiate_h2 = true;
+    m = request(mgr, true, "www.example.info");
+    assert(m != NULL && conn_count == 13 && msg_conn(m)->multiplex);
+    struct fake_conn *conn_c = msg_conn(m);
+    for (size_t i = 0; i < ARRAY_SIZE(ms); i++)
+    {
+        ms[i] = request(mgr, true, "www.example.info");
+        assert(ms[i] != NULL && msg_conn(ms[i]) == conn_c);
+    }
+    assert(conn_count == 13 && conn_c->streams == 1 + ARRAY_SIZE(ms));
+    fake_stream_close(m);
+    for (size_t i = 0; i < ARRAY_SIZE(ms); i++)
+        fake_stream_close(ms[i]);
+
+    /* Idle connections time out, busy ones do not */
+    release_count = 0;
+    m = request(mgr, false, "www.example.com");
+    assert(m != NULL && conn_count == 13);
+    struct fake_conn *conn_d = msg_conn(m);
+    now += VLC_TICK_FROM_SEC(60);
+    m2 = request(mgr, false, "www.example.org");
+    assert(m2 != NULL && conn_count == 14);
+    /* the other www.example.com, www.example.net and HTTPS connections */
+    assert(release_count == 1 + 4 + 2 && !conn_d->released);
+    fake_stream_close(m);
+    fake_stream_close(m2);
+    now += VLC_TICK_FROM_SEC(10);
+    m = request(mgr, false, "www.example.com");
+    assert(m != NULL && msg_conn(m) == conn_d && conn_count == 14);
+    fake_stream_close(m);
+
+    /* Open streams survive the manager */
+    m = request(mgr, true, "www.example.info");
+    assert(m != NULL);
+    vlc_http_mgr_destroy(mgr);
+    assert(msg_conn(m)->released);
+    fake_stream_close(m);
+    return 0;
+}
+
+/* Callback for vlc_http_mgr_request() */
+struct vlc_http_msg *vlc_http_msg_get_initial(struct vlc_http_stream *s)
+{
+    if (fail_initial)
+    {
+        fake_stream_close((struct vlc_http_msg *)s);
+        return NULL;
+    }
+    /* The fake stream stands for the response */
+    return (struct vlc_http_msg *)container_of(s, struct fake_stream, stream);
+}
+
+struct vlc_http_stream *vlc_h1_request(void *ctx, const char *hostname,
+                                       unsigned port, bool proxy,
+                                       const struct vlc_http_msg *req,
+                                       bool idempotent, bool has_data,
+                                       struct vlc_http_conn **restrict connp)
+{
+    assert(hostname != NULL);
+    assert(port == 80);
+    assert(!proxy);
+    (void) ctx; (void) idempotent;
+
+    struct vlc_http_conn *conn = fake_conn_create(false);
+    struct vlc_http_stream *s = vlc_http_stream_open(conn, req, has_data);
+
+    assert(s != NULL);
+    *connp = conn;
+    return s;
+}
+
+struct vlc_http_conn *vlc_h1_conn_create(void *ctx, vlc_tls_t *tls,
+                                         bool proxy)
+{
+    assert(tls != NULL);
+    assert(!proxy);
+    (void) ctx;
+    return fake_conn_create(false);
+}
+
+struct vlc_http_conn *vlc_h2_conn_create(void *ctx, vlc_tls_t *tls,
+                                         uint_fast32_t window_max)
+{
+    (void) window_max;
+    assert(tls != NULL);
+    (void) ctx;
+    return fake_conn_create(true);
+}
+
+static vlc_tls_t fake_tls;
+static int fake_creds;
+
+vlc_tls_client_t *vlc_tls_ClientCreate(vlc_object_t *obj)
+{
+    (void) obj;
+    return (vlc_tls_client_t *)&fake_creds;
+}
+
+void vlc_tls_ClientDelete(vlc_tls_client_t *creds)
+{
+    assert(creds == (vlc_tls_client_t *)&fake_creds);
+}
+
+vlc_tls_t *vlc_tls_SocketOpenTLS(vlc_tls_client_t *creds, const char *name,
+                                 unsigned port, const char *service,
+                                 const char *const *alpn, char **alp)
+{
+    assert(creds == (vlc_tls_client_t *)&fake_creds);
+    assert(name != NULL);
+    assert(port == 443);
+    (void) service; (void) alpn;
+
+    *alp = strdup(negotiate_h2 ? "h2" : "http/1.1");
+    return &fake_tls;
+}
+
+vlc_tls_t *vlc_https_connect_proxy(void *ctx, vlc_tls_client_t *creds,
+                                   const char *name, unsigned port,
+                                   bool *restrict two, const char *proxy)
+{
+    (void) ctx; (void) creds; (void) name; (void) port; (void) two;
+    (void) proxy;
+    assert(!"unexpected proxy");
+    return NULL;
+}
+
+char *vlc_getProxyUrl(const char *url)
+{
+    (void) url;
+    return NULL;
+}
+
+vlc_tick_t vlc_tick_now(void)
+{
+    return now;
+}
+
+int var_Inherit(vlc_object_t *obj, const char *name, int type,
+                vlc_value_t *val)
+{
+    (void) obj; (void) name; (void) type; (void) val;
+    return VLC_EGENERIC;
+}
@@ -26,6 +26,7 @@
 #include <errno.h>
 #include <inttypes.h>
 #include <stdbool.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -113,7 +114,7 @@ struct vlc_h1_conn
     struct vlc_http_stream stream;
     uintmax_t content_length;
     bool connection_close;
-    bool active;
+    atomic_bool active; /* also read by the connection manager */
     bool released;
     bool proxy;
     void *opaque;
@@ -340,10 +341,18 @@ static void vlc_h1_conn_release(struct vlc_http_conn *c)
         vlc_h1_conn_destroy(conn);
 }
 
+static unsigned vlc_h1_conn_active(struct vlc_http_conn *c)
+{
+    struct vlc_h1_conn *conn = container_of(c, struct vlc_h1_conn, conn);
+
+    return atomic_load(&conn->active);
+}
+
 static const struct vlc_http_conn_cbs vlc_h1_conn_callbacks =
 {
     vlc_h1_stream_open,
     vlc_h1_conn_release,
+    vlc_h1_conn_active,
 };
 
 struct vlc_http_conn *vlc_h1_conn_create(void *ctx, vlc_tls_t *tls, bool proxy)
@@ -355,7 +364,7 @@ struct vlc_http_conn *vlc_h1_conn_create(void *ctx, vlc_tls_t *tls, bool proxy)
     conn->conn.cbs = &vlc_h1_conn_callbacks;
     conn->conn.tls = tls;
     conn->stream.cbs = &vlc_h1_stream_callbacks;
-    conn->active = false;
+    atomic_init(&conn->active, false);
     conn->released = false;
     conn->proxy = proxy;
     conn->opaque = ctx;
@@ -377,7 +386,7 @@ struct vlc_http_stream *vlc_h1_request(void *ctx, const char *hostname,
 
     vlc_http_dbg(ctx, "resolving %s ...", hostname);
 
-    int val = vlc_getaddrinfo_i11e(hostname, port, &hints, &res);
+    int val = vlc_getaddrinfo_cached(hostname, port, &hints, &res);
     if (val != 0)
     {   /* TODO: C locale for gai_strerror() */
         vlc_http_err(ctx, "cannot resolve %s: %s", hostname,
@@ -412,7 +421,7 @@ struct vlc_http_stream *vlc_h1_request(void *ctx, const char *hostname,
             else
                 vlc_http_conn_release(conn);
 
-            freeaddrinfo(res);
+            vlc_freeaddrinfo_cached(res);
             return stream;
         }
 
@@ -423,6 +432,6 @@ struct vlc_http_stream *vlc_h1_request(void *ctx, const char *hostname,
     }
 
     /* All address info failed. */
-    freeaddrinfo(res);
+    vlc_freeaddrinfo_cached(res);
     return NULL;
 }
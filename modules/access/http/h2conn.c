@@ -47,6 +47,9 @@
 #define CO(c) ((c)->opaque)
 #define SO(s) CO((s)->conn)
 
+/* Opaque value of the pings measuring the bandwidth-delay product */
+#define VLC_H2_BDP_PING UINT64_C(0x564c432d42445000)
+
 /** HTTP/2 connection */
 struct vlc_h2_conn
 {
@@ -63,6 +66,18 @@ struct vlc_h2_conn
     uint64_t send_cwnd; /**< Send congestion window */
     vlc_cond_t send_wait;
 
+    /* The receive window of the streams grows to the measured
+     * bandwidth-delay product, so that the peer is not throttled on long
+     * fat links, but no larger than the given limit. */
+    uint32_t recv_window; /**< Current stream receive window size */
+    uint32_t recv_window_max; /**< Stream receive window size limit */
+    uint64_t bdp_bytes; /**< Data received since the BDP ping was sent */
+    uint64_t bdp_bw; /**< Highest measured bandwidth (bytes/s) */
+    vlc_tick_t bdp_date; /**< When the BDP ping was sent */
+    vlc_tick_t rtt; /**< Last measured round-trip time */
+    bool bdp_pending; /**< Whether a BDP ping is in flight */
+    unsigned stalls; /**< Times the streams exhausted their window */
+
     vlc_mutex_t lock; /**< State machine lock */
     vlc_thread_t thread; /**< Receive thread */
 };
@@ -84,6 +99,9 @@ struct vlc_h2_stream
     struct vlc_http_msg *recv_hdr; /**< Latest received headers (or NULL) */
 
     size_t recv_cwnd; /**< Free space in receive congestion window */
+    uint64_t recv_credit; /**< Total data the peer was allowed to send */
+    uint64_t recv_bytes; /**< Total data received */
+    unsigned recv_stalls; /**< Times the peer exhausted the window */
     struct vlc_h2_frame *recv_head; /**< Earliest pending received buffer */
     struct vlc_h2_frame **recv_tailp; /**< Tail of receive queue */
     vlc_cond_t recv_wait;
@@ -190,6 +208,25 @@ static int vlc_h2_stream_data(void *ctx, struct vlc_h2_frame *f)
     *(s->recv_tailp) = f;
     s->recv_tailp = &f->next;
     vlc_cond_signal(&s->recv_wait);
+
+    struct vlc_h2_conn *conn = s->conn;
+
+    s->recv_bytes += len;
+    if (s->recv_bytes >= s->recv_credit)
+    {   /* The peer cannot send more until the reader credits the window */
+        s->recv_stalls++;
+        conn->stalls++;
+    }
+
+    /* Measure the bandwidth-delay product over a round trip */
+    conn->bdp_bytes += len;
+    if (!conn->bdp_pending
+     && vlc_h2_conn_queue_prio(conn, vlc_h2_frame_ping(VLC_H2_BDP_PING)) == 0)
+    {
+        conn->bdp_pending = true;
+        conn->bdp_bytes = len;
+        conn->bdp_date = vlc_tick_now();
+    }
     return 0;
 }
 
@@ -413,10 +450,13 @@ static block_t *vlc_h2_stream_read(struct vlc_http_stream *stream)
     s->recv_cwnd -= len;
 
     /* Credit the receive window if missing credit exceeds 50%. */
-    uint_fast32_t credit = VLC_H2_INIT_WINDOW - s->recv_cwnd;
-    if (credit >= (VLC_H2_INIT_WINDOW / 2)
+    uint_fast32_t credit = conn->recv_window - s->recv_cwnd;
+    if (credit >= (conn->recv_window / 2)
      && !vlc_h2_conn_queue(conn, vlc_h2_frame_window_update(s->id, credit)))
+    {
         s->recv_cwnd += credit;
+        s->recv_credit += credit;
+    }
 
     vlc_h2_stream_unlock(s);
 
@@ -467,6 +507,11 @@ static void vlc_h2_stream_close(struct vlc_http_stream *stream, bool aborted)
         code = VLC_H2_CANCEL;
     (void) aborted;
 
+    if (s->recv_stalls > 0)
+        vlc_http_dbg(SO(s), "stream %"PRIu32" stalled %u time(s) by flow "
+                     "control over %"PRIu64" bytes", s->id, s->recv_stalls,
+                     s->recv_bytes);
+
     vlc_h2_stream_error(conn, s->id, code);
 
     if (s->recv_hdr != NULL)
@@ -521,6 +566,9 @@ static struct vlc_http_stream *vlc_h2_stream_open(struct vlc_http_conn *c,
     s->recv_err = 0;
     s->recv_hdr = NULL;
     s->recv_cwnd = VLC_H2_INIT_WINDOW;
+    s->recv_credit = VLC_H2_INIT_WINDOW;
+    s->recv_bytes = 0;
+    s->recv_stalls = 0;
     s->recv_head = NULL;
     s->recv_tailp = &s->recv_head;
     vlc_cond_init(&s->recv_wait);
@@ -545,6 +593,19 @@ static struct vlc_http_stream *vlc_h2_stream_open(struct vlc_http_conn *c,
 
     vlc_h2_conn_queue(conn, f);
 
+    /* Grant the window grown beyond the initial one at once */
+    if (conn->recv_window > VLC_H2_INIT_WINDOW)
+    {
+        uint_fast32_t credit = conn->recv_window - VLC_H2_INIT_WINDOW;
+
+        if (!vlc_h2_conn_queue(conn,
+                               vlc_h2_frame_window_update(s->id, credit)))
+        {
+            s->recv_cwnd += credit;
+            s->recv_credit += credit;
+        }
+    }
+
     s->older = conn->streams;
     if (s->older != NULL)
         s->older->newer = s;
@@ -613,6 +674,43 @@ static int vlc_h2_ping(void *ctx, uint_fast64_t opaque)
     return vlc_h2_conn_queue_prio(conn, vlc_h2_frame_pong(opaque));
 }
 
+/** Reports a ping acknowledged by the HTTP/2 peer */
+static void vlc_h2_pong(void *ctx, uint_fast64_t opaque)
+{
+    struct vlc_h2_conn *conn = ctx;
+
+    if (opaque != VLC_H2_BDP_PING || !conn->bdp_pending)
+        return;
+
+    vlc_tick_t rtt = vlc_tick_now() - conn->bdp_date;
+    uint64_t bytes = conn->bdp_bytes;
+
+    conn->bdp_pending = false;
+    conn->rtt = rtt;
+    if (rtt <= 0)
+        return;
+
+    /* Only grow the window if it looks like the limiting factor, that is to
+     * say if a large part of it was received within a single round trip,
+     * and while the bandwidth keeps increasing. */
+    uint64_t bw = bytes * CLOCK_FREQ / rtt;
+
+    if (bytes < (uint64_t)conn->recv_window * 2 / 3 || bw <= conn->bdp_bw)
+        return;
+
+    conn->bdp_bw = bw;
+
+    uint64_t window = __MIN(2 * bytes, conn->recv_window_max);
+    if (window <= conn->recv_window)
+        return;
+
+    vlc_http_dbg(CO(conn), "receive window: %"PRIu32" to %"PRIu64" bytes "
+                 "(RTT: %"PRId64" us, bandwidth: %"PRIu64" bytes/s)",
+                 conn->recv_window, window, US_FROM_VLC_TICK(rtt), bw);
+    /* The streams are credited the difference as they are read */
+    conn->recv_window = window;
+}
+
 /** Reports a local HTTP/2 connection failure */
 static void vlc_h2_error(void *ctx, uint_fast32_t code)
 {
@@ -680,6 +778,7 @@ static const struct vlc_h2_parser_cbs vlc_h2_parser_callbacks =
     vlc_h2_setting,
     vlc_h2_settings_done,
     vlc_h2_ping,
+    vlc_h2_pong,
     vlc_h2_error,
     vlc_h2_reset,
     vlc_h2_window_status,
@@ -837,6 +936,9 @@ static void vlc_h2_conn_destroy(struct vlc_h2_conn *conn)
 {
     assert(conn->streams == NULL);
 
+    vlc_http_dbg(CO(conn), "receive window: %"PRIu32" bytes, RTT: %"PRId64
+                 " us, flow control stalls: %u", conn->recv_window,
+                 US_FROM_VLC_TICK(conn->rtt), conn->stalls);
     vlc_h2_error(conn, VLC_H2_NO_ERROR);
 
     vlc_cancel(conn->thread);
@@ -865,13 +967,28 @@ static void vlc_h2_conn_release(struct vlc_http_conn *c)
         vlc_h2_conn_destroy(conn);
 }
 
+static unsigned vlc_h2_conn_active(struct vlc_http_conn *c)
+{
+    struct vlc_h2_conn *conn = container_of(c, struct vlc_h2_conn, conn);
+    unsigned count = 0;
+
+    vlc_mutex_lock(&conn->lock);
+    for (const struct vlc_h2_stream *s = conn->streams; s != NULL;
+         s = s->older)
+        count++;
+    vlc_mutex_unlock(&conn->lock);
+    return count;
+}
+
 static const struct vlc_http_conn_cbs vlc_h2_conn_callbacks =
 {
     vlc_h2_stream_open,
     vlc_h2_conn_release,
+    vlc_h2_conn_active,
 };
 
-struct vlc_http_conn *vlc_h2_conn_create(void *ctx, struct vlc_tls *tls)
+struct vlc_http_conn *vlc_h2_conn_create(void *ctx, struct vlc_tls *tls,
+                                         uint_fast32_t window_max)
 {
     struct vlc_h2_conn *conn = malloc(sizeof (*conn));
     if (unlikely(conn == NULL))
@@ -887,6 +1004,15 @@ struct vlc_http_conn *vlc_h2_conn_create(void *ctx, struct vlc_tls *tls)
     conn->max_send_frame = VLC_H2_DEFAULT_MAX_FRAME;
     conn->init_send_cwnd = VLC_H2_DEFAULT_INIT_WINDOW;
     conn->send_cwnd = VLC_H2_DEFAULT_INIT_WINDOW;
+    conn->recv_window = VLC_H2_INIT_WINDOW;
+    conn->recv_window_max = VLC_CLIP(window_max, VLC_H2_INIT_WINDOW,
+                                     VLC_H2_MAX_WINDOW);
+    conn->bdp_bytes = 0;
+    conn->bdp_bw = 0;
+    conn->bdp_date = VLC_TICK_INVALID;
+    conn->rtt = 0;
+    conn->bdp_pending = false;
+    conn->stalls = 0;
 
     if (unlikely(conn->out == NULL))
         goto error;
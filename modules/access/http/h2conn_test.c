@@ -76,9 +76,10 @@ static void conn_expect(uint_fast8_t wanted)
         assert(val == 9);
         assert(hdr[0] == 0);
 
-        /* Check type. We do not currently validate WINDOW_UPDATE. */
+        /* Check type. We do not currently validate WINDOW_UPDATE, nor the
+         * pings measuring the bandwidth-delay product. */
         got = hdr[3];
-        assert(wanted == got || WINDOW_UPDATE == got);
+        assert(wanted == got || WINDOW_UPDATE == got || PING == got);
 
         len = (hdr[1] << 8) | hdr[2];
         if (len > 0)
@@ -103,7 +104,7 @@ static void conn_create(void)
 
     external_tls = tlsv[0];
 
-    conn = vlc_h2_conn_create(NULL, tlsv[1]);
+    conn = vlc_h2_conn_create(NULL, tlsv[1], 0);
     assert(conn != NULL);
     conn_send(vlc_h2_frame_settings());
 
@@ -94,6 +94,7 @@ const char *vlc_h2_setting_name(uint_fast16_t);
 /* Protocol default settings */
 #define VLC_H2_DEFAULT_MAX_HEADER_TABLE  4096
 #define VLC_H2_DEFAULT_INIT_WINDOW      65535
+#define VLC_H2_MAX_WINDOW          2147483647
 #define VLC_H2_MIN_MAX_FRAME            16384
 #define VLC_H2_DEFAULT_MAX_FRAME        16384
 #define VLC_H2_MAX_MAX_FRAME         16777215
@@ -104,6 +105,7 @@ struct vlc_h2_parser_cbs
     void (*setting)(void *ctx, uint_fast16_t id, uint_fast32_t value);
     int  (*settings_done)(void *ctx);
     int  (*ping)(void *ctx, uint_fast64_t opaque);
+    void (*pong)(void *ctx, uint_fast64_t opaque);
     void (*error)(void *ctx, uint_fast32_t code);
     int  (*reset)(void *ctx, uint_fast32_t last_seq, uint_fast32_t code);
     void (*window_status)(void *ctx, uint32_t * restrict rcwd);
@@ -49,6 +49,12 @@
 #define AUTO_GUID_TEXT N_("Set NFS uid/guid automatically")
 #define AUTO_GUID_LONGTEXT N_("If uid/gid are not specified in " \
     "the url, VLC will automatically set a uid/gid.")
+#define READ_AHEAD_TEXT N_("Read-ahead requests")
+#define READ_AHEAD_LONGTEXT N_("Number of read requests kept in flight. " \
+    "More requests hide the latency of distant servers, but use more memory.")
+
+/* Largest read request, if the server allows it */
+#define NFS_READ_MAX_SIZE (1 << 20)
 
 static int Open(vlc_object_t *);
 static void Close(vlc_object_t *);
@@ -58,11 +64,24 @@ vlc_module_begin()
     set_description(N_("NFS input"))
     set_subcategory(SUBCAT_INPUT_ACCESS)
     add_bool("nfs-auto-guid", true, AUTO_GUID_TEXT, AUTO_GUID_LONGTEXT)
+    add_integer_with_range("nfs-read-ahead", 4, 1, 64,
+                           READ_AHEAD_TEXT, READ_AHEAD_LONGTEXT)
     set_capability("access", 0)
     add_shortcut("nfs")
     set_callbacks(Open, Close)
 vlc_module_end()
 
+struct nfs_read
+{
+    stream_t *p_access;
+    uint8_t *p_buf;
+    uint64_t i_offset;
+    size_t i_size; /* requested */
+    size_t i_len; /* read */
+    size_t i_pos; /* consumed */
+    bool b_done;
+};
+
 typedef struct
 {
     struct rpc_context *    p_mount; /* used to to get exports mount point */
@@ -78,21 +97,20 @@ typedef struct
     bool                    b_error;
     bool                    b_auto_guid;
 
+    /* Ring of read requests, in file order */
+    struct nfs_read *       p_reads;
+    unsigned                i_read_window;
+    unsigned                i_read_head;
+    unsigned                i_read_count;
+    size_t                  i_read_size;
+    uint64_t                i_read_offset; /* of the next request */
+
     union {
         struct
         {
             char **         ppsz_names;
             int             i_count;
         } exports;
-        struct
-        {
-            uint8_t *p_buf;
-            size_t i_len;
-        } read;
-        struct
-        {
-            bool b_done;
-        } seek;
     } res;
 } access_sys_t;
 
@@ -172,83 +190,181 @@ vlc_mount_mainloop(stream_t *p_access, bool (*pf_until_cb)(stream_t *))
     return vlc_rpc_mainloop(p_access, p_sys->p_mount, pf_until_cb);
 }
 
+/*
+ * Reads are pipelined: up to "nfs-read-ahead" requests are in flight, so that
+ * the throughput is not bound by the round trip time to the server. The
+ * requests are consumed in order.
+ */
 static void
 nfs_read_cb(int i_status, struct nfs_context *p_nfs, void *p_data,
             void *p_private_data)
 {
     VLC_UNUSED(p_nfs);
-    stream_t *p_access = p_private_data;
+    struct nfs_read *p_read = p_private_data;
+    stream_t *p_access = p_read->p_access;
     access_sys_t *p_sys = p_access->p_sys;
     assert(p_sys->p_nfs == p_nfs);
+
+    p_read->b_done = true;
     if (NFS_CHECK_STATUS(p_access, i_status, p_data))
         return;
 
-    if (i_status == 0)
-        p_sys->b_eof = true;
-    else
-    {
-        p_sys->res.read.i_len = i_status;
-        if (p_sys->res.read.p_buf != NULL && p_data != NULL)
-            memcpy(p_sys->res.read.p_buf, p_data, i_status);
-    }
+    p_read->i_len = i_status;
+#ifndef LIBNFS_API_V2
+    if (i_status > 0 && p_data != NULL)
+        memcpy(p_read->p_buf, p_data, i_status);
+#endif
 }
 
 static bool
 nfs_read_finished_cb(stream_t *p_access)
 {
     access_sys_t *p_sys = p_access->p_sys;
-    return p_sys->res.read.i_len > 0 || p_sys->b_eof;
+    return p_sys->p_reads[p_sys->i_read_head].b_done;
 }
 
-static ssize_t
-FileRead(stream_t *p_access, void *p_buf, size_t i_len)
+static int
+ReadAheadInit(stream_t *p_access)
 {
     access_sys_t *p_sys = p_access->p_sys;
+    uint64_t i_max_size = nfs_get_readmax(p_sys->p_nfs);
 
-    if (p_sys->b_eof)
-        return 0;
+    p_sys->i_read_window = var_InheritInteger(p_access, "nfs-read-ahead");
+    p_sys->i_read_size = i_max_size > 0 && i_max_size < NFS_READ_MAX_SIZE
+                       ? i_max_size : NFS_READ_MAX_SIZE;
+
+    p_sys->p_reads = vlc_obj_malloc(VLC_OBJECT(p_access),
+                            p_sys->i_read_window * sizeof (*p_sys->p_reads));
+    uint8_t *p_buf = vlc_obj_malloc(VLC_OBJECT(p_access),
+                            p_sys->i_read_window * p_sys->i_read_size);
+    if (unlikely(p_sys->p_reads == NULL || p_buf == NULL))
+    {
+        p_sys->p_reads = NULL;
+        return -1;
+    }
+
+    for (unsigned i = 0; i < p_sys->i_read_window; i++)
+    {
+        p_sys->p_reads[i].p_access = p_access;
+        p_sys->p_reads[i].p_buf = p_buf + i * p_sys->i_read_size;
+    }
+    msg_Dbg(p_access, "reading ahead %u requests of %zu bytes",
+            p_sys->i_read_window, p_sys->i_read_size);
+    return 0;
+}
+
+static void
+ReadAheadFill(stream_t *p_access)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+    uint64_t i_size = p_sys->stat.nfs_size;
+
+    /* Past the known size, the file may still be growing */
+    while (!p_sys->b_error && p_sys->i_read_count < p_sys->i_read_window
+        && (p_sys->i_read_offset < i_size || p_sys->i_read_count == 0))
+    {
+        unsigned i_idx = (p_sys->i_read_head + p_sys->i_read_count)
+                       % p_sys->i_read_window;
+        struct nfs_read *p_read = &p_sys->p_reads[i_idx];
+        uint64_t i_left = p_sys->i_read_offset < i_size
+                        ? i_size - p_sys->i_read_offset : p_sys->i_read_size;
+
+        p_read->i_offset = p_sys->i_read_offset;
+        p_read->i_size = __MIN(i_left, p_sys->i_read_size);
+        p_read->i_len = 0;
+        p_read->i_pos = 0;
+        p_read->b_done = false;
 
-    p_sys->res.read.i_len = 0;
 #ifdef LIBNFS_API_V2
-    p_sys->res.read.p_buf = NULL;
-    if (nfs_read_async(p_sys->p_nfs, p_sys->p_nfsfh, p_buf, i_len, nfs_read_cb,
-                       p_access) < 0)
+        if (nfs_pread_async(p_sys->p_nfs, p_sys->p_nfsfh, p_read->p_buf,
+                            p_read->i_size, p_read->i_offset, nfs_read_cb,
+                            p_read) < 0)
 #else
-    p_sys->res.read.p_buf = p_buf;
-    if (nfs_read_async(p_sys->p_nfs, p_sys->p_nfsfh, i_len, nfs_read_cb,
-                       p_access) < 0)
+        if (nfs_pread_async(p_sys->p_nfs, p_sys->p_nfsfh, p_read->i_offset,
+                            p_read->i_size, nfs_read_cb, p_read) < 0)
 #endif
-    {
-        msg_Err(p_access, "nfs_read_async failed");
-        return 0;
+        {
+            msg_Err(p_access, "nfs_pread_async failed");
+            return;
+        }
+        p_sys->i_read_offset += p_read->i_size;
+        p_sys->i_read_count++;
     }
+}
 
-    if (vlc_nfs_mainloop(p_access, nfs_read_finished_cb) < 0)
-        return 0;
+/* Wait for the oldest request, and forget it */
+static int
+ReadAheadPop(stream_t *p_access)
+{
+    access_sys_t *p_sys = p_access->p_sys;
 
-    return p_sys->res.read.i_len;
+    /* The request cannot be cancelled, and its buffer is about to be reused */
+    if (vlc_nfs_mainloop(p_access, nfs_read_finished_cb) < 0)
+    {
+        p_sys->i_read_count = 0;
+        return -1;
+    }
+    p_sys->i_read_head = (p_sys->i_read_head + 1) % p_sys->i_read_window;
+    p_sys->i_read_count--;
+    return 0;
 }
 
 static void
-nfs_seek_cb(int i_status, struct nfs_context *p_nfs, void *p_data,
-            void *p_private_data)
+ReadAheadDrain(stream_t *p_access)
 {
-    VLC_UNUSED(p_nfs);
-    stream_t *p_access = p_private_data;
     access_sys_t *p_sys = p_access->p_sys;
-    assert(p_sys->p_nfs == p_nfs);
-    (void) p_data;
-    if (NFS_CHECK_STATUS(p_access, i_status, p_data))
-        return;
 
-    p_sys->res.seek.b_done = true;
+    while (p_sys->i_read_count > 0 && ReadAheadPop(p_access) == 0);
 }
 
-static bool
-nfs_seek_finished_cb(stream_t *p_access)
+static ssize_t
+FileRead(stream_t *p_access, void *p_buf, size_t i_len)
 {
     access_sys_t *p_sys = p_access->p_sys;
-    return p_sys->res.seek.b_done;
+
+    if (p_sys->b_eof)
+        return 0;
+
+    if (p_sys->p_reads == NULL && ReadAheadInit(p_access))
+        return 0;
+
+    for (;;)
+    {
+        ReadAheadFill(p_access);
+        if (p_sys->i_read_count == 0)
+            return 0;
+
+        if (vlc_nfs_mainloop(p_access, nfs_read_finished_cb) < 0)
+        {
+            p_sys->i_read_count = 0;
+            return 0;
+        }
+
+        struct nfs_read *p_read = &p_sys->p_reads[p_sys->i_read_head];
+        if (p_read->i_pos < p_read->i_len)
+        {
+            i_len = __MIN(i_len, p_read->i_len - p_read->i_pos);
+            memcpy(p_buf, p_read->p_buf + p_read->i_pos, i_len);
+            p_read->i_pos += i_len;
+            return i_len;
+        }
+
+        uint64_t i_offset = p_read->i_offset + p_read->i_pos;
+        ReadAheadPop(p_access);
+
+        if (p_read->i_len == 0)
+        {
+            p_sys->b_eof = true;
+            ReadAheadDrain(p_access);
+            return 0;
+        }
+
+        if (p_read->i_len < p_read->i_size)
+        {   /* Short read, the next requests do not follow this one */
+            ReadAheadDrain(p_access);
+            p_sys->i_read_offset = i_offset;
+        }
+    }
 }
 
 static int
@@ -256,19 +372,24 @@ FileSeek(stream_t *p_access, uint64_t i_pos)
 {
     access_sys_t *p_sys = p_access->p_sys;
 
-    p_sys->res.seek.b_done = false;
-    if (nfs_lseek_async(p_sys->p_nfs, p_sys->p_nfsfh, i_pos, SEEK_SET,
-                        nfs_seek_cb, p_access) < 0)
-    {
-        msg_Err(p_access, "nfs_seek_async failed");
-        return VLC_EGENERIC;
-    }
+    p_sys->b_eof = false;
 
-    if (vlc_nfs_mainloop(p_access, nfs_seek_finished_cb) < 0)
-        return VLC_EGENERIC;
+    /* Keep the requests from the new position */
+    while (p_sys->i_read_count > 0)
+    {
+        struct nfs_read *p_read = &p_sys->p_reads[p_sys->i_read_head];
 
-    p_sys->b_eof = false;
+        if (i_pos >= p_read->i_offset
+         && i_pos - p_read->i_offset < p_read->i_size)
+        {
+            p_read->i_pos = i_pos - p_read->i_offset;
+            return VLC_SUCCESS;
+        }
+        if (ReadAheadPop(p_access))
+            return VLC_EGENERIC;
+    }
 
+    p_sys->i_read_offset = i_pos;
     return VLC_SUCCESS;
 }
 
@@ -764,7 +885,11 @@ Close(vlc_object_t *p_obj)
     access_sys_t *p_sys = p_access->p_sys;
 
     if (p_sys->p_nfsfh != NULL)
+    {
+        /* The buffers of the requests in flight are about to be freed */
+        ReadAheadDrain(p_access);
         nfs_close(p_sys->p_nfs, p_sys->p_nfsfh);
+    }
 
     if (p_sys->p_nfsdir != NULL)
         nfs_closedir(p_sys->p_nfs, p_sys->p_nfsdir);
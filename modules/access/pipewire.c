@@ -30,6 +30,7 @@
 #include <vlc_aout.h>
 #include <vlc_demux.h>
 #include <vlc_plugin.h>
+#include <spa/buffer/meta.h>
 #include <spa/param/audio/format-utils.h>
 #include <spa/param/props.h>
 #include <spa/param/video/format-utils.h>
@@ -61,6 +62,7 @@ struct demux_sys_t
     vlc_tick_t caching; /**< Caching value */
     vlc_tick_t interval;
     bool discontinuity; /**< The next frame will not follow the last one */
+    bool has_frame; /**< A video frame was sent */
     enum es_format_category_e media_type;
     uint8_t chans_table[AOUT_CHAN_MAX]; /**< Channels order table */
     uint8_t chans_to_reorder; /**< Number of channels to reorder */
@@ -264,6 +266,25 @@ static void on_stream_param_changed(void *data, uint32_t id, const struct spa_po
         }
 
         initialize_video_format(s, &fmt, format);
+
+        /* Ask for the damaged regions, screen casts only send them */
+        unsigned char buf[256];
+        struct spa_pod_builder builder = SPA_POD_BUILDER_INIT(buf, sizeof (buf));
+        const struct spa_pod *params[2];
+
+        params[0] = spa_pod_builder_add_object(&builder,
+                SPA_TYPE_OBJECT_ParamMeta, SPA_PARAM_Meta,
+                SPA_PARAM_META_type, SPA_POD_Id(SPA_META_Header),
+                SPA_PARAM_META_size,
+                    SPA_POD_Int(sizeof (struct spa_meta_header)));
+        params[1] = spa_pod_builder_add_object(&builder,
+                SPA_TYPE_OBJECT_ParamMeta, SPA_PARAM_Meta,
+                SPA_PARAM_META_type, SPA_POD_Id(SPA_META_VideoDamage),
+                SPA_PARAM_META_size, SPA_POD_CHOICE_RANGE_Int(
+                    sizeof (struct spa_meta_region) * 16,
+                    sizeof (struct spa_meta_region) * 1,
+                    sizeof (struct spa_meta_region) * 16));
+        pw_stream_update_params(s->stream, params, ARRAY_SIZE(params));
     }
 
     sys->es = es_out_Add (demux->out, &fmt);
@@ -315,6 +336,34 @@ static vlc_tick_t stream_update_latency(struct vlc_pw_stream *s, vlc_tick_t *now
  *
  * This consumes data from the server buffer.
  */
+/**
+ * Tells whether a video buffer holds a new frame.
+ *
+ * Screen casts leave the damage list empty when nothing changed on screen,
+ * there is no need to send the same frame again then.
+ */
+static bool video_buffer_changed(struct spa_buffer *buf)
+{
+    const struct spa_chunk *chunk = buf->datas[0].chunk;
+    const struct spa_meta_header *header =
+        spa_buffer_find_meta_data(buf, SPA_META_Header, sizeof (*header));
+
+    if (chunk->size == 0 || (chunk->flags & SPA_CHUNK_FLAG_CORRUPTED))
+        return false;
+    if (header != NULL && (header->flags & SPA_META_HEADER_FLAG_CORRUPTED))
+        return false;
+
+    struct spa_meta *damage = spa_buffer_find_meta(buf, SPA_META_VideoDamage);
+    if (damage == NULL)
+        return true;
+
+    struct spa_meta_region *region;
+    spa_meta_for_each(region, damage)
+        if (spa_meta_region_is_valid(region))
+            return true;
+    return false;
+}
+
 static void on_process(void *data)
 {
     struct vlc_pw_stream *s = data;
@@ -341,6 +390,9 @@ static void on_process(void *data)
     es_out_SetPCR(demux->out, pts);
     if (unlikely(sys->es == NULL))
         goto end;
+    if (sys->media_type == VIDEO_ES && sys->has_frame
+     && !video_buffer_changed(buf))
+        goto end;
 
     vlc_frame_t *frame = vlc_frame_Alloc(length);
     if (likely(frame != NULL))
@@ -354,6 +406,8 @@ static void on_process(void *data)
                                     sys->chans_to_reorder, sys->chans_table,
                                     sys->format);
         }
+        else
+            sys->has_frame = true;
         frame->i_dts = frame->i_pts = pts;
         if (sys->discontinuity)
         {
@@ -492,6 +546,7 @@ static int Open(vlc_object_t *obj)
     sys->stream = NULL;
     sys->es = NULL;
     sys->discontinuity = false;
+    sys->has_frame = false;
     sys->caching = VLC_TICK_FROM_MS( var_InheritInteger(obj, "live-caching") );
     sys->listener = (struct spa_hook){ };
     sys->media_type = AUDIO_ES;
@@ -78,6 +78,33 @@ static ssize_t vlc_datagram_Recv(struct vlc_dtls *dgs, struct iovec *iov,
     return ret;
 }
 
+#ifdef HAVE_RECVMMSG
+static int vlc_datagram_RecvBatch(struct vlc_dtls *dgs, struct iovec *iov,
+                                  size_t *restrict lens,
+                                  bool *restrict truncated, unsigned count)
+{
+    struct mmsghdr msgs[count];
+
+    for (unsigned i = 0; i < count; i++)
+        msgs[i].msg_hdr = (struct msghdr) {
+            .msg_iov = &iov[i],
+            .msg_iovlen = 1,
+        };
+
+    int fd = container_of(dgs, struct vlc_dgram_sock, s)->fd;
+    int val = recvmmsg(fd, msgs, count, MSG_WAITFORONE, NULL);
+
+    for (int i = 0; i < val; i++) {
+        lens[i] = msgs[i].msg_len;
+        truncated[i] = (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+    }
+
+    return val;
+}
+#else
+# define vlc_datagram_RecvBatch NULL
+#endif
+
 static ssize_t vlc_datagram_Send(struct vlc_dtls *dgs,
                                  const struct iovec *iov, unsigned iovlen)
 {
@@ -95,6 +122,7 @@ static const struct vlc_dtls_operations vlc_datagram_ops = {
     vlc_datagram_GetPollFD,
     vlc_datagram_Recv,
     vlc_datagram_Send,
+    vlc_datagram_RecvBatch,
 };
 
 struct vlc_dtls *vlc_datagram_CreateFD(int fd)
@@ -146,6 +174,7 @@ static const struct vlc_dtls_operations vlc_dccp_ops = {
     vlc_datagram_GetPollFD,
     vlc_dccp_Recv,
     vlc_datagram_Send,
+    NULL,
 };
 
 struct vlc_dtls *vlc_dccp_CreateFD(int fd)
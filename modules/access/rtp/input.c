@@ -51,6 +51,12 @@
 
 #define DEFAULT_MRU (1500u - (20 + 8))
 
+#ifdef HAVE_RECVMMSG
+# define RTP_BATCH 16
+#else
+# define RTP_BATCH 1
+#endif
+
 /**
  * Processes a packet received from the RTP socket.
  */
@@ -97,6 +103,15 @@ static int rtp_timeout (vlc_tick_t deadline)
     return t;
 }
 
+static void rtp_pool_release (void *data)
+{
+    block_t **pool = data;
+
+    for (unsigned i = 0; i < RTP_BATCH; i++)
+        if (pool[i] != NULL)
+            block_Release (pool[i]);
+}
+
 /**
  * RTP/RTCP session thread for datagram sockets
  */
@@ -105,9 +120,12 @@ void *rtp_dgram_thread (void *opaque)
     rtp_sys_t *sys = opaque;
     vlc_tick_t deadline = VLC_TICK_INVALID;
     struct vlc_dtls *rtp_sock = sys->input_sys.rtp_sock;
+    /* Receive buffers, those not filled by a batch are kept for the next */
+    block_t *pool[RTP_BATCH] = { NULL };
 
     vlc_thread_set_name("vlc-rtp");
 
+    vlc_cleanup_push (rtp_pool_release, pool);
     for (;;)
     {
         struct pollfd ufd[1];
@@ -125,32 +143,47 @@ void *rtp_dgram_thread (void *opaque)
 
         if (ufd[0].revents)
         {
-            block_t *block = block_Alloc(DEFAULT_MRU);
-            if (unlikely(block == NULL))
-                break; /* we are totallly screwed */
-
-            bool truncated;
-            ssize_t len = vlc_dtls_Recv(rtp_sock, block->p_buffer,
-                                       block->i_buffer, &truncated);
-            if (len >= 0) {
-                if (truncated) {
+            struct iovec iov[RTP_BATCH];
+            size_t lens[RTP_BATCH];
+            bool truncated[RTP_BATCH];
+
+            for (unsigned i = 0; i < RTP_BATCH; i++)
+            {
+                if (pool[i] == NULL)
+                {
+                    pool[i] = block_Alloc(DEFAULT_MRU);
+                    if (unlikely(pool[i] == NULL))
+                        goto error; /* we are totallly screwed */
+                }
+                iov[i].iov_base = pool[i]->p_buffer;
+                iov[i].iov_len = pool[i]->i_buffer;
+            }
+
+            int count = vlc_dtls_RecvBatch(rtp_sock, iov, lens, truncated,
+                                           RTP_BATCH);
+            if (count < 0)
+            {
+                if (errno == EPIPE)
+                    goto error; /* connection terminated */
+                vlc_warning (sys->logger, "RTP network error: %s",
+                          vlc_strerror_c(errno));
+            }
+
+            for (int i = 0; i < count; i++)
+            {
+                block_t *block = pool[i];
+
+                pool[i] = NULL;
+                if (truncated[i]) {
                     vlc_error (sys->logger, "packet truncated (MRU was %zu)",
                             block->i_buffer);
                     block->i_flags |= BLOCK_FLAG_CORRUPTED;
                 }
                 else
-                    block->i_buffer = len;
+                    block->i_buffer = lens[i];
 
                 rtp_process (sys->logger, &sys->input_sys, sys->session, block);
             }
-            else
-            {
-                if (errno == EPIPE)
-                    break; /* connection terminated */
-                vlc_warning (sys->logger, "RTP network error: %s",
-                          vlc_strerror_c(errno));
-                block_Release (block);
-            }
 
             n--;
         }
@@ -160,5 +193,8 @@ void *rtp_dgram_thread (void *opaque)
             deadline = VLC_TICK_INVALID;
         vlc_restorecancel (canc);
     }
+error:
+    vlc_cleanup_pop ();
+    rtp_pool_release (pool);
     return NULL;
 }
@@ -423,7 +423,9 @@ static int OpenSDP(vlc_object_t *obj)
     sys->session = rtp_session_create_custom(var_InheritInteger(obj, "rtp-max-dropout"),
                                              var_InheritInteger(obj, "rtp-max-misorder"),
                                              var_InheritInteger(obj, "rtp-max-src"),
-                                             vlc_tick_from_sec(var_InheritInteger(obj, "rtp-timeout")));
+                                             vlc_tick_from_sec(var_InheritInteger(obj, "rtp-timeout")),
+                                             VLC_TICK_FROM_MS(var_InheritInteger(obj, "rtp-min-delay")),
+                                             VLC_TICK_FROM_MS(var_InheritInteger(obj, "rtp-max-delay")));
     if (sys->session == NULL)
         goto error;
 
@@ -573,7 +575,9 @@ static int OpenURL(vlc_object_t *obj)
                         var_InheritInteger(obj, "rtp-max-dropout"),
                         var_InheritInteger(obj, "rtp-max-misorder"),
                         var_InheritInteger(obj, "rtp-max-src"),
-                        vlc_tick_from_sec(var_InheritInteger(obj, "rtp-timeout")) );
+                        vlc_tick_from_sec(var_InheritInteger(obj, "rtp-timeout")),
+                        VLC_TICK_FROM_MS(var_InheritInteger(obj, "rtp-min-delay")),
+                        VLC_TICK_FROM_MS(var_InheritInteger(obj, "rtp-max-delay")) );
     if (p_sys->session == NULL)
         goto error;
 
@@ -657,6 +661,17 @@ error:
     "RTP packets will be discarded if they are too far behind (i.e. in the " \
     "past) by this many packets from the last received packet." )
 
+#define RTP_MIN_DELAY_TEXT N_("Minimum RTP reordering delay (ms)")
+#define RTP_MIN_DELAY_LONGTEXT N_( \
+    "How long to wait at least for a missing RTP packet before giving up " \
+    "on it. Longer delays recover more misordered packets at the expense " \
+    "of latency." )
+
+#define RTP_MAX_DELAY_TEXT N_("Maximum RTP reordering delay (ms)")
+#define RTP_MAX_DELAY_LONGTEXT N_( \
+    "How long to wait at most for a missing RTP packet, whatever the " \
+    "measured jitter (0 for no limit)." )
+
 /*
  * Module descriptor
  */
@@ -694,6 +709,12 @@ vlc_module_begin()
     add_integer("rtp-max-misorder", RTP_MAX_MISORDER_DEFAULT, RTP_MAX_MISORDER_TEXT,
                 RTP_MAX_MISORDER_LONGTEXT)
         change_integer_range (0, 32767)
+    add_integer("rtp-min-delay", RTP_MIN_DELAY_DEFAULT, RTP_MIN_DELAY_TEXT,
+                RTP_MIN_DELAY_LONGTEXT)
+        change_integer_range (0, 60000)
+    add_integer("rtp-max-delay", RTP_MAX_DELAY_DEFAULT, RTP_MAX_DELAY_TEXT,
+                RTP_MAX_DELAY_LONGTEXT)
+        change_integer_range (0, 60000)
     add_obsolete_string("rtp-dynamic-pt") /* since 4.0.0 */
 
     /*add_shortcut ("sctp")*/
@@ -363,10 +363,14 @@ static inline uint8_t rtp_ptype (const block_t *block)
 #define RTP_MAX_DROPOUT_DEFAULT 3000
 #define RTP_MAX_TIMEOUT_DEFAULT 5
 #define RTP_MAX_MISORDER_DEFAULT 100
+#define RTP_MIN_DELAY_DEFAULT 25 /* ms */
+#define RTP_MAX_DELAY_DEFAULT 0 /* ms, no limit */
 
 rtp_session_t *rtp_session_create (void);
 rtp_session_t *rtp_session_create_custom (uint16_t max_dropout, uint16_t max_misorder,
-                                          uint8_t max_src, vlc_tick_t timeout);
+                                          uint8_t max_src, vlc_tick_t timeout,
+                                          vlc_tick_t min_delay,
+                                          vlc_tick_t max_delay);
 void rtp_session_destroy (struct vlc_logger *, rtp_session_t *);
 void rtp_queue (struct vlc_logger *, rtp_session_t *, block_t *);
 bool rtp_dequeue (struct vlc_logger *, const rtp_session_t *, vlc_tick_t, vlc_tick_t *);
@@ -35,6 +35,9 @@
 
 typedef struct rtp_source_t rtp_source_t;
 
+/** Size of the per-source reorder buffer (in packets), a power of two */
+#define RTP_REORDER_SIZE 1024
+
 /** State for a RTP session: */
 struct rtp_session_t
 {
@@ -44,23 +47,28 @@ struct rtp_session_t
     rtp_pt_t     **ptv;
     /* params */
     vlc_tick_t    timeout;
+    vlc_tick_t    min_delay; /**< Min wait for a missing packet */
+    vlc_tick_t    max_delay; /**< Max wait for a missing packet (0: none) */
     uint16_t      max_dropout; /**< Max packet forward misordering */
     uint16_t      max_misorder; /**< Max packet backward misordering */
     uint8_t       max_src; /**< Max simultaneous RTP sources */
 };
 
 static rtp_source_t *
-rtp_source_create (struct vlc_logger *, const rtp_session_t *, uint32_t, uint16_t);
+rtp_source_create (struct vlc_logger *, uint32_t, uint16_t);
 static void rtp_source_destroy(struct vlc_logger *, rtp_source_t *);
+static void rtp_source_flush(rtp_source_t *);
 
-static void rtp_decode (struct vlc_logger *, const rtp_session_t *, rtp_source_t *);
+static void rtp_decode (struct vlc_logger *, const rtp_session_t *,
+                        rtp_source_t *, block_t *);
 
 /**
  * Creates a new RTP session.
  */
 rtp_session_t *
 rtp_session_create_custom (uint16_t max_dropout, uint16_t max_misorder,
-                           uint8_t max_src, vlc_tick_t timeout)
+                           uint8_t max_src, vlc_tick_t timeout,
+                           vlc_tick_t min_delay, vlc_tick_t max_delay)
 {
     rtp_session_t *session = malloc (sizeof (*session));
     if (session == NULL)
@@ -71,6 +79,8 @@ rtp_session_create_custom (uint16_t max_dropout, uint16_t max_misorder,
     session->max_misorder = -1 * max_misorder;
     session->max_src = max_src;
     session->timeout = timeout;
+    session->min_delay = min_delay;
+    session->max_delay = max_delay;
 
     /* state variables */
     session->srcv = NULL;
@@ -87,7 +97,9 @@ rtp_session_create (void)
     return rtp_session_create_custom(RTP_MAX_DROPOUT_DEFAULT,
                                      RTP_MAX_MISORDER_DEFAULT,
                                      RTP_MAX_SRC_DEFAULT,
-                                     RTP_MAX_TIMEOUT_DEFAULT);
+                                     RTP_MAX_TIMEOUT_DEFAULT,
+                                     VLC_TICK_FROM_MS(RTP_MIN_DELAY_DEFAULT),
+                                     VLC_TICK_FROM_MS(RTP_MAX_DELAY_DEFAULT));
 }
 
 /**
@@ -139,24 +151,32 @@ struct rtp_source_t
     uint16_t bad_seq; /* tentatively next expected sequence for resync */
     uint16_t max_seq; /* next expected sequence */
 
-    uint16_t last_seq; /* sequence of the next dequeued packet */
-    block_t *blocks; /* re-ordered blocks queue */
+    uint16_t last_seq; /* sequence of the last dequeued packet */
+    unsigned queued; /* number of packets in the reorder buffer */
     struct {
         struct vlc_rtp_pt *instance; /* Per-source current payload format */
         void *opaque; /* Per-source payload format private data */
     } pt;
+    struct {
+        uint64_t received; /* packets queued */
+        uint64_t lost; /* packets given up on */
+        uint64_t late; /* packets received after being given up on */
+        uint64_t duplicate; /* packets received more than once */
+        uint64_t reordered; /* packets received out of order */
+    } stats;
+    /* reorder buffer, indexed by sequence number, starting after last_seq */
+    block_t *ring[RTP_REORDER_SIZE];
 };
 
 /**
  * Initializes a new RTP source within an RTP session.
  */
 static rtp_source_t *
-rtp_source_create (struct vlc_logger *logger, const rtp_session_t *session,
-                   uint32_t ssrc, uint16_t init_seq)
+rtp_source_create (struct vlc_logger *logger, uint32_t ssrc, uint16_t init_seq)
 {
     rtp_source_t *source;
 
-    source = malloc (sizeof (*source) + (sizeof (void *) * session->ptc));
+    source = calloc (1, sizeof (*source));
     if (source == NULL)
         return NULL;
 
@@ -166,22 +186,48 @@ rtp_source_create (struct vlc_logger *logger, const rtp_session_t *session,
     source->ref_ntp = UINT64_C (1) << 51;
     source->max_seq = source->bad_seq = init_seq;
     source->last_seq = init_seq - 1;
-    source->blocks = NULL;
+    source->queued = 0;
     source->pt.instance = NULL;
     vlc_debug (logger, "added RTP source (%08x)", ssrc);
     return source;
 }
 
 
+/**
+ * Discards all the packets of the reorder buffer.
+ */
+static void rtp_source_flush(rtp_source_t *source)
+{
+    for (unsigned i = 0; i < RTP_REORDER_SIZE && source->queued > 0; i++)
+        if (source->ring[i] != NULL)
+        {
+            block_Release (source->ring[i]);
+            source->ring[i] = NULL;
+            source->queued--;
+        }
+    assert (source->queued == 0);
+}
+
 /**
  * Destroys an RTP source and its associated streams.
  */
 static void rtp_source_destroy(struct vlc_logger *logger, rtp_source_t *source)
 {
-    vlc_debug (logger, "removing RTP source (%08x)", source->ssrc);
+    vlc_tick_t jitter = 0;
+
+    if (source->pt.instance != NULL)
+        jitter = vlc_tick_from_samples(source->jitter,
+                                       source->pt.instance->frequency);
+
+    vlc_debug (logger, "removing RTP source (%08x): %"PRIu64" packet(s) "
+               "received, %"PRIu64" lost, %"PRIu64" late, %"PRIu64" duplicate,"
+               " %"PRIu64" reordered, jitter %"PRId64" us", source->ssrc,
+               source->stats.received, source->stats.lost, source->stats.late,
+               source->stats.duplicate, source->stats.reordered,
+               US_FROM_VLC_TICK(jitter));
     if (source->pt.instance != NULL)
         vlc_rtp_pt_end(source->pt.instance, source->pt.opaque);
-    block_ChainRelease (source->blocks);
+    rtp_source_flush (source);
     free (source);
 }
 
@@ -191,6 +237,41 @@ static inline uint16_t rtp_seq (const block_t *block)
     return GetWBE (block->p_buffer + 2);
 }
 
+/**
+ * Returns the reorder buffer slot of the packet offset packets after the last
+ * dequeued one.
+ */
+static inline block_t **rtp_source_slot (rtp_source_t *src, uint16_t offset)
+{
+    assert (offset < RTP_REORDER_SIZE);
+    return &src->ring[(uint16_t)(src->last_seq + 1 + offset)
+                      % RTP_REORDER_SIZE];
+}
+
+/**
+ * Returns the offset of the first queued packet. There must be one.
+ */
+static uint16_t rtp_source_first (rtp_source_t *src)
+{
+    uint16_t offset = 0;
+
+    assert (src->queued > 0);
+    while (*rtp_source_slot (src, offset) == NULL)
+        offset++;
+    return offset;
+}
+
+static block_t *rtp_source_pop (rtp_source_t *src, uint16_t offset)
+{
+    block_t **slot = rtp_source_slot (src, offset);
+    block_t *block = *slot;
+
+    assert (block != NULL);
+    *slot = NULL;
+    src->queued--;
+    return block;
+}
+
 static inline uint32_t rtp_timestamp (const block_t *block)
 {
     assert (block->i_buffer >= 12);
@@ -277,7 +358,7 @@ rtp_queue (struct vlc_logger *logger, rtp_session_t *session, block_t *block)
             goto drop;
         session->srcv = tab;
 
-        src = rtp_source_create (logger, session, ssrc, seq);
+        src = rtp_source_create (logger, ssrc, seq);
         if (src == NULL)
             goto drop;
 
@@ -321,10 +402,10 @@ rtp_queue (struct vlc_logger *logger, rtp_session_t *session, block_t *block)
         if (seq == src->bad_seq)
         {
             src->max_seq = src->bad_seq = seq + 1;
-            src->last_seq = seq - 0x7fffe; /* hack for rtp_decode() */
+            src->last_seq = seq - 1;
             vlc_warning (logger, "sequence resynchronized");
-            block_ChainRelease (src->blocks);
-            src->blocks = NULL;
+            rtp_source_flush (src);
+            block->i_flags |= BLOCK_FLAG_DISCONTINUITY;
         }
         else
         {
@@ -336,23 +417,44 @@ rtp_queue (struct vlc_logger *logger, rtp_session_t *session, block_t *block)
     if (delta_seq.s >= 0)
         src->max_seq = seq + 1;
 
-    /* Queues the block in sequence order,
-     * hence there is a single queue for all payload types. */
-    block_t **pp = &src->blocks;
-    for (block_t *prev = *pp; prev != NULL; prev = *pp)
+    /* Stores the block at its sequence number in the reorder buffer,
+     * hence there is a single buffer for all payload types. */
+    uint16_t offset = seq - (uint16_t)(src->last_seq + 1);
+    if (offset >= 0x8000)
+    {   /* Trash too late packets (and PIM Assert duplicates) */
+        vlc_debug (logger, "ignoring late packet (sequence: %"PRIu16")", seq);
+        src->stats.late++;
+        goto drop;
+    }
+
+    /* Give up on the oldest missing packets if the buffer is too short */
+    while (offset >= RTP_REORDER_SIZE && src->queued > 0)
     {
-        delta_seq.u = seq - rtp_seq (prev);
-        if (delta_seq.s < 0)
-            break;
-        if (delta_seq.s == 0)
-        {
-            vlc_debug (logger, "duplicate packet (sequence: %"PRIu16")", seq);
-            goto drop; /* duplicate */
-        }
-        pp = &prev->p_next;
+        rtp_decode (logger, session, src,
+                    rtp_source_pop (src, rtp_source_first (src)));
+        offset = seq - (uint16_t)(src->last_seq + 1);
     }
-    block->p_next = *pp;
-    *pp = block;
+    if (offset >= RTP_REORDER_SIZE)
+    {
+        vlc_warning (logger, "%"PRIu16" packet(s) lost", offset);
+        src->stats.lost += offset;
+        src->last_seq = seq - 1;
+        offset = 0;
+        block->i_flags |= BLOCK_FLAG_DISCONTINUITY;
+    }
+
+    block_t **slot = rtp_source_slot (src, offset);
+    if (*slot != NULL)
+    {
+        vlc_debug (logger, "duplicate packet (sequence: %"PRIu16")", seq);
+        src->stats.duplicate++;
+        goto drop; /* duplicate */
+    }
+    if ((int16_t)(seq - src->max_seq) < -1)
+        src->stats.reordered++;
+    *slot = block;
+    src->queued++;
+    src->stats.received++;
 
     /*rtp_decode (demux, session, src);*/
     return;
@@ -403,14 +505,17 @@ bool rtp_dequeue (struct vlc_logger *logger, const rtp_session_t *session,
          * LibVLC E/S-out clock synchronization. Here, we need to bother about
          * re-ordering packets, as decoders can't cope with mis-ordered data.
          */
-        while (((block = src->blocks)) != NULL)
+        while (src->queued > 0)
         {
-            if ((int16_t)(rtp_seq (block) - (src->last_seq + 1)) <= 0)
-            {   /* Next (or earlier) block ready, no need to wait */
-                rtp_decode (logger, session, src);
+            if (*rtp_source_slot (src, 0) != NULL)
+            {   /* Next block ready, no need to wait */
+                rtp_decode (logger, session, src, rtp_source_pop (src, 0));
                 continue;
             }
 
+            uint16_t offset = rtp_source_first (src);
+            block = *rtp_source_slot (src, offset);
+
             /* Wait for 3 times the inter-arrival delay variance (about 99.7%
              * match for random gaussian jitter).
              */
@@ -421,9 +526,12 @@ bool rtp_dequeue (struct vlc_logger *logger, const rtp_session_t *session,
             else
                 deadline = 0; /* no jitter estimate with no frequency :( */
 
-            /* Make sure we wait at least for 25 msec */
-            if (deadline < VLC_TICK_FROM_MS(25))
-                deadline = VLC_TICK_FROM_MS(25);
+            /* Make sure we wait at least for the minimum delay, and not
+             * longer than the maximum one if any. */
+            if (deadline < session->min_delay)
+                deadline = session->min_delay;
+            if (session->max_delay > 0 && deadline > session->max_delay)
+                deadline = session->max_delay;
 
             /* Additionally, we implicitly wait for the packetization time
              * multiplied by the number of missing packets. block is the first
@@ -433,7 +541,7 @@ bool rtp_dequeue (struct vlc_logger *logger, const rtp_session_t *session,
             deadline += block->i_pts;
             if (now >= deadline)
             {
-                rtp_decode (logger, session, src);
+                rtp_decode (logger, session, src, rtp_source_pop (src, offset));
                 continue;
             }
             if (*deadlinep > deadline)
@@ -449,25 +557,16 @@ bool rtp_dequeue (struct vlc_logger *logger, const rtp_session_t *session,
  * Decodes one RTP packet.
  */
 static void
-rtp_decode (struct vlc_logger *logger, const rtp_session_t *session, rtp_source_t *src)
+rtp_decode (struct vlc_logger *logger, const rtp_session_t *session,
+            rtp_source_t *src, block_t *block)
 {
-    block_t *block = src->blocks;
-
-    assert (block);
-    src->blocks = block->p_next;
-    block->p_next = NULL;
-
     /* Discontinuity detection */
     uint16_t delta_seq = rtp_seq (block) - (src->last_seq + 1);
     if (delta_seq != 0)
     {
-        if (delta_seq >= 0x8000)
-        {   /* Trash too late packets (and PIM Assert duplicates) */
-            vlc_debug (logger, "ignoring late packet (sequence: %"PRIu16")",
-                      rtp_seq (block));
-            goto drop;
-        }
+        assert (delta_seq < RTP_REORDER_SIZE);
         vlc_warning (logger, "%"PRIu16" packet(s) lost", delta_seq);
+        src->stats.lost += delta_seq;
         block->i_flags |= BLOCK_FLAG_DISCONTINUITY;
     }
     src->last_seq = rtp_seq (block);
@@ -206,26 +206,14 @@ error:
 static int
 do_ctr_crypt (gcry_cipher_hd_t hd, const void *ctr, uint8_t *data, size_t len)
 {
-    const size_t ctrlen = 16;
-    div_t d = div (len, ctrlen);
-
-    if (gcry_cipher_setctr (hd, ctr, ctrlen)
-     || gcry_cipher_encrypt (hd, data, d.quot * ctrlen, NULL, 0))
+    /* Setting the counter discards the left-over key stream, and libgcrypt
+     * handles the truncated last block by itself. The whole packet is thus
+     * processed in place in a single call, with the accelerated AES
+     * implementation (AES-NI, ARMv8 CE...) wherever libgcrypt has one. */
+    if (gcry_cipher_setctr (hd, ctr, 16)
+     || gcry_cipher_encrypt (hd, data, len, NULL, 0))
         return -1;
 
-    if (d.rem)
-    {
-        /* Truncated last block */
-        uint8_t dummy[ctrlen];
-        data += d.quot * ctrlen;
-        memcpy (dummy, data, d.rem);
-        memset (dummy + d.rem, 0, ctrlen - d.rem);
-
-        if (gcry_cipher_encrypt (hd, dummy, ctrlen, data, ctrlen))
-            return -1;
-        memcpy (data, dummy, d.rem);
-    }
-
     return 0;
 }
 
@@ -436,6 +424,20 @@ static inline uint16_t rtp_seq (const uint8_t *buf)
 }
 
 
+/** Checks whether a RTP sequence was already received or is too old */
+static bool
+srtp_is_replay (const srtp_session_t *s, uint16_t seq)
+{
+    int16_t diff = seq - s->rtp_seq;
+
+    if (diff > 0)
+        return false; /* Sequence in the future, good */
+
+    diff = -diff;
+    return (diff >= 64) || ((s->rtp.window >> diff) & 1);
+}
+
+
 /** Message Authentication and Integrity for RTP */
 static const uint8_t *
 rtp_digest (gcry_md_hd_t md, const uint8_t *data, size_t len,
@@ -505,10 +507,9 @@ static int srtp_crypt (srtp_session_t *s, uint8_t *buf, size_t len)
     else
     {
         /* Sequence in the past/present, bad */
-        diff = -diff;
-        if ((diff >= 64) || ((s->rtp.window >> diff) & 1))
+        if (srtp_is_replay (s, seq))
             return EACCES; /* Replay attack */
-        s->rtp.window |= UINT64_C(1) << diff;
+        s->rtp.window |= UINT64_C(1) << -diff;
     }
 
     /* Encrypt/Decrypt */
@@ -654,6 +655,12 @@ srtp_recv (srtp_session_t *s, uint8_t *buf, size_t *lenp)
         if (len < (12u + roc_len + tag_len))
             return EINVAL;
         len -= roc_len + tag_len;
+        *lenp = len;
+
+        /* Replayed packets are rejected before computing the digest: the
+         * replay window is only updated once the packet is authenticated. */
+        if (srtp_is_replay (s, rtp_seq (buf)))
+            return EACCES;
 
         uint32_t roc = srtp_compute_roc (s, rtp_seq (buf)), rcc;
         if (roc_len)
@@ -684,7 +691,6 @@ srtp_recv (srtp_session_t *s, uint8_t *buf, size_t *lenp)
             s->rtp_roc += rcc - roc;
             assert (srtp_compute_roc (s, rtp_seq (buf)) == rcc);
         }
-        *lenp = len;
     }
 
     return srtp_crypt (s, buf, len);
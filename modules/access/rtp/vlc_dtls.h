@@ -37,6 +37,9 @@ struct vlc_dtls_operations {
     ssize_t (*readv)(struct vlc_dtls *, struct iovec *iov, unsigned len,
                      bool *restrict truncated);
     ssize_t (*writev)(struct vlc_dtls *, const struct iovec *iov, unsigned len);
+    /* optional */
+    int (*readm)(struct vlc_dtls *, struct iovec *iov, size_t *restrict lens,
+                 bool *restrict truncated, unsigned count);
 };
 
 static inline void vlc_dtls_Close(struct vlc_dtls *dgs)
@@ -57,6 +60,28 @@ static inline ssize_t vlc_dtls_Recv(struct vlc_dtls *dgs, void *buf, size_t len,
     return dgs->ops->readv(dgs, &iov, 1, truncated);
 }
 
+/**
+ * Receives up to count datagrams at once.
+ *
+ * Each datagram is received in its own buffer. Only the first one is waited
+ * for, the next ones are received only if they are already pending.
+ *
+ * @return the number of received datagrams, or -1 on error
+ */
+static inline int vlc_dtls_RecvBatch(struct vlc_dtls *dgs, struct iovec *iov,
+                                     size_t *restrict lens,
+                                     bool *restrict truncated, unsigned count)
+{
+    if (dgs->ops->readm != NULL)
+        return dgs->ops->readm(dgs, iov, lens, truncated, count);
+
+    ssize_t val = dgs->ops->readv(dgs, iov, 1, truncated);
+    if (val < 0)
+        return -1;
+    lens[0] = val;
+    return 1;
+}
+
 static inline ssize_t vlc_dtls_Send(struct vlc_dtls *dgs, const void *buf,
                                    size_t len)
 {
@@ -96,6 +96,10 @@ netbios_ns_interrupt_unregister(void)
 #include "smb_common.h"
 #include "cache.h"
 
+#define READ_AHEAD_TEXT N_("Read-ahead requests")
+#define READ_AHEAD_LONGTEXT N_("Number of read requests kept in flight. " \
+    "More requests hide the latency of distant servers, but use more memory.")
+
 static int Open(vlc_object_t *);
 static void Close(vlc_object_t *);
 
@@ -108,12 +112,19 @@ vlc_module_begin()
     add_string("smb-user", NULL, SMB_USER_TEXT, SMB_USER_LONGTEXT)
     add_password("smb-pwd", NULL, SMB_PASS_TEXT, SMB_PASS_LONGTEXT)
     add_string("smb-domain", NULL, SMB_DOMAIN_TEXT, SMB_DOMAIN_LONGTEXT)
+    add_integer_with_range("smb2-read-ahead", 4, 1, 64,
+                           READ_AHEAD_TEXT, READ_AHEAD_LONGTEXT)
     add_shortcut("smb", "smb2")
     set_callbacks(Open, Close)
 vlc_module_end()
 
 VLC_ACCESS_CACHE_REGISTER(smb2_cache);
 
+/* Largest read request, if the server allows it */
+#define SMB2_READ_MAX_SIZE (1 << 20)
+
+struct vlc_smb2_read;
+
 struct access_sys
 {
     struct smb2_context *   smb2;
@@ -130,6 +141,14 @@ struct access_sys
     bool                    smb2_connected;
 
     struct vlc_access_cache_entry *cache_entry;
+
+    /* Ring of read requests, in file order */
+    struct vlc_smb2_read *  reads;
+    unsigned                read_window;
+    unsigned                read_head;
+    unsigned                read_count;
+    size_t                  read_size;
+    uint64_t                read_offset; /* of the next request */
 };
 
 struct vlc_smb2_op
@@ -285,6 +304,108 @@ smb2_read_cb(struct smb2_context *smb2, int status, void *data,
     op->res.read.len = status;
 }
 
+/*
+ * Reads are pipelined: up to "smb2-read-ahead" requests are in flight, so
+ * that the throughput is not bound by the round trip time to the server.
+ * smb2_pread_async() completes only once the whole request is read, the
+ * requests are consumed in order.
+ */
+struct vlc_smb2_read
+{
+    struct vlc_smb2_op op;
+    uint8_t *buf;
+    uint64_t offset;
+    size_t size; /* requested */
+    size_t pos; /* consumed */
+};
+
+static int
+vlc_smb2_ReadAheadInit(stream_t *access)
+{
+    struct access_sys *sys = access->p_sys;
+    uint32_t max_size = smb2_get_max_read_size(sys->smb2);
+
+    sys->read_window = var_InheritInteger(access, "smb2-read-ahead");
+    sys->read_size = max_size > 0 && max_size < SMB2_READ_MAX_SIZE
+                   ? max_size : SMB2_READ_MAX_SIZE;
+
+    sys->reads = vlc_obj_malloc(VLC_OBJECT(access),
+                                sys->read_window * sizeof (*sys->reads));
+    uint8_t *buf = vlc_obj_malloc(VLC_OBJECT(access),
+                                  sys->read_window * sys->read_size);
+    if (unlikely(sys->reads == NULL || buf == NULL))
+    {
+        sys->reads = NULL;
+        return -1;
+    }
+
+    for (unsigned i = 0; i < sys->read_window; i++)
+        sys->reads[i].buf = buf + i * sys->read_size;
+    msg_Dbg(access, "reading ahead %u requests of %zu bytes",
+            sys->read_window, sys->read_size);
+    return 0;
+}
+
+static void
+vlc_smb2_ReadAheadFill(stream_t *access)
+{
+    struct access_sys *sys = access->p_sys;
+
+    /* Past the known size, the file may still be growing */
+    while (sys->smb2 != NULL && sys->read_count < sys->read_window
+        && (sys->read_offset < sys->smb2_size || sys->read_count == 0))
+    {
+        unsigned idx = (sys->read_head + sys->read_count) % sys->read_window;
+        struct vlc_smb2_read *read = &sys->reads[idx];
+        uint64_t left = sys->read_offset < sys->smb2_size
+                      ? sys->smb2_size - sys->read_offset : sys->read_size;
+
+        read->op = (struct vlc_smb2_op) VLC_SMB2_OP(access, &sys->smb2);
+        read->op.res.read.len = 0;
+        read->offset = sys->read_offset;
+        read->size = left < sys->read_size ? left : sys->read_size;
+        read->pos = 0;
+
+        int err = smb2_pread_async(sys->smb2, sys->smb2fh, read->buf,
+                                   read->size, read->offset, smb2_read_cb,
+                                   &read->op);
+        if (err < 0)
+        {
+            VLC_SMB2_SET_ERROR(&read->op, "smb2_pread_async", err);
+            sys->read_count = 0;
+            return;
+        }
+        sys->read_offset += read->size;
+        sys->read_count++;
+    }
+}
+
+/* Wait for the oldest request, and forget it */
+static int
+vlc_smb2_ReadAheadPop(stream_t *access)
+{
+    struct access_sys *sys = access->p_sys;
+    struct vlc_smb2_read *read = &sys->reads[sys->read_head];
+
+    /* The request cannot be cancelled, and its buffer is about to be reused */
+    if (vlc_smb2_mainloop(&read->op) < 0)
+    {
+        sys->read_count = 0;
+        return -1;
+    }
+    sys->read_head = (sys->read_head + 1) % sys->read_window;
+    sys->read_count--;
+    return 0;
+}
+
+static void
+vlc_smb2_ReadAheadDrain(stream_t *access)
+{
+    struct access_sys *sys = access->p_sys;
+
+    while (sys->read_count > 0 && vlc_smb2_ReadAheadPop(access) == 0);
+}
+
 static ssize_t
 FileRead(stream_t *access, void *buf, size_t len)
 {
@@ -293,30 +414,48 @@ FileRead(stream_t *access, void *buf, size_t len)
     if (sys->eof || sys->smb2 == NULL)
         return 0;
 
-    /* Limit the read size since smb2_read_async() will complete only after
-     * reading the whole requested data and not when whatever data is available
-     * (high read size means a faster I/O but a higher latency). */
-    if (len > 262144)
-        len = 262144;
-
-    struct vlc_smb2_op op = VLC_SMB2_OP(access, &sys->smb2);
-    op.res.read.len = 0;
+    if (sys->reads == NULL && vlc_smb2_ReadAheadInit(access))
+        return 0;
 
-    int err = smb2_read_async(sys->smb2, sys->smb2fh, buf, len,
-                              smb2_read_cb, &op);
-    if (err < 0)
+    for (;;)
     {
-        VLC_SMB2_SET_ERROR(&op, "smb2_read_async", err);
-        return 0;
-    }
+        vlc_smb2_ReadAheadFill(access);
+        if (sys->read_count == 0)
+            return 0;
 
-    if (vlc_smb2_mainloop(&op) < 0)
-        return 0;
+        struct vlc_smb2_read *read = &sys->reads[sys->read_head];
+        if (vlc_smb2_mainloop(&read->op) < 0)
+        {
+            sys->read_count = 0;
+            return 0;
+        }
 
-    if (op.res.read.len == 0)
-        sys->eof = true;
+        size_t read_len = read->op.res.read.len;
+        if (read->pos < read_len)
+        {
+            if (len > read_len - read->pos)
+                len = read_len - read->pos;
+            memcpy(buf, read->buf + read->pos, len);
+            read->pos += len;
+            return len;
+        }
 
-    return op.res.read.len;
+        uint64_t offset = read->offset + read->pos;
+        vlc_smb2_ReadAheadPop(access);
+
+        if (read_len == 0)
+        {
+            sys->eof = true;
+            vlc_smb2_ReadAheadDrain(access);
+            return 0;
+        }
+
+        if (read_len < read->size)
+        {   /* Short read, the next requests do not follow this one */
+            vlc_smb2_ReadAheadDrain(access);
+            sys->read_offset = offset;
+        }
+    }
 }
 
 static int
@@ -334,16 +473,23 @@ FileSeek(stream_t *access, uint64_t i_pos)
         return VLC_EGENERIC;
     }
 
-    struct vlc_smb2_op op = VLC_SMB2_OP(access, &sys->smb2);
+    sys->eof = false;
 
-    int64_t err = smb2_lseek(op.smb2, sys->smb2fh, i_pos, SEEK_SET, NULL);
-    if (err < 0)
+    /* Keep the requests from the new position */
+    while (sys->read_count > 0)
     {
-        VLC_SMB2_SET_ERROR(&op, "smb2_lseek", err);
-        return err;
+        struct vlc_smb2_read *read = &sys->reads[sys->read_head];
+
+        if (i_pos >= read->offset && i_pos - read->offset < read->size)
+        {
+            read->pos = i_pos - read->offset;
+            return VLC_SUCCESS;
+        }
+        if (vlc_smb2_ReadAheadPop(access))
+            return VLC_EGENERIC;
     }
-    sys->eof = false;
 
+    sys->read_offset = i_pos;
     return VLC_SUCCESS;
 }
 
@@ -1014,6 +1160,8 @@ Close(vlc_object_t *p_obj)
 
     if (sys->smb2fh != NULL)
     {
+        /* The context may be reused, no replies must be left behind */
+        vlc_smb2_ReadAheadDrain(access);
         if (sys->smb2)
             vlc_smb2_close_fh(access, &sys->smb2, sys->smb2fh);
     }
@@ -42,6 +42,7 @@ typedef struct
     char       *psz_host;
     int         i_port;
     int         i_chunks; /* Number of chunks to allocate in the next read */
+    vlc_tick_t  i_stats_date; /* Date of the last link statistics report */
 } stream_sys_t;
 
 
@@ -205,6 +206,7 @@ static bool srt_schedule_reconnect(stream_t *p_stream)
      * the stream may have changed.
      */
     p_sys->i_chunks = SRT_MIN_CHUNKS_TRYREAD;
+    p_sys->i_stats_date = VLC_TICK_INVALID;
 
 out:
     if (failed && p_sys->sock != SRT_INVALID_SOCK)
@@ -319,6 +321,8 @@ static block_t *BlockSRT(stream_t *p_stream, bool *restrict eof)
             }
         }
 
+        srt_log_stats( VLC_OBJECT(p_stream), p_sys->sock, false,
+                       &p_sys->i_stats_date );
         goto out;
     }
 
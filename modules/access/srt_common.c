@@ -168,3 +168,35 @@ int srt_set_socket_option(vlc_object_t *this, const char *srt_param,
     return stat;
 }
 
+void srt_log_stats(vlc_object_t *this, SRTSOCKET u, bool sender,
+        vlc_tick_t *restrict last)
+{
+    vlc_tick_t now = vlc_tick_now();
+
+    if (*last == VLC_TICK_INVALID) {
+        /* Start counting from the first call */
+        *last = now;
+        srt_bstats( u, &(SRT_TRACEBSTATS) { 0 }, 1 );
+        return;
+    }
+    if (now - *last < SRT_STATS_INTERVAL)
+        return;
+    *last = now;
+
+    SRT_TRACEBSTATS perf;
+    if (srt_bstats( u, &perf, 1 ) == SRT_ERROR)
+        return;
+
+    if (sender)
+        msg_Dbg( this, "[SRT-STATS]: sent %"PRId64", retransmitted %d, "
+                 "lost %d, dropped %d, rtt %.2fms, bandwidth %.2fMbps, "
+                 "send rate %.2fMbps", perf.pktSent, perf.pktRetrans,
+                 perf.pktSndLoss, perf.pktSndDrop, perf.msRTT,
+                 perf.mbpsBandwidth, perf.mbpsSendRate );
+    else
+        msg_Dbg( this, "[SRT-STATS]: received %"PRId64", lost %d, "
+                 "dropped %d, rtt %.2fms, bandwidth %.2fMbps, "
+                 "receive rate %.2fMbps", perf.pktRecv, perf.pktRcvLoss,
+                 perf.pktRcvDrop, perf.msRTT, perf.mbpsBandwidth,
+                 perf.mbpsRecvRate );
+}
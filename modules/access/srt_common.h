@@ -56,6 +56,8 @@
 /* The default latency which srt library uses internally */
 #define SRT_DEFAULT_LATENCY       SRT_LIVE_DEF_LATENCY_MS
 #define SRT_DEFAULT_PAYLOAD_SIZE  SRT_LIVE_DEF_PLSIZE
+/* Interval between two link statistics reports */
+#define SRT_STATS_INTERVAL VLC_TICK_FROM_SEC(5)
 /* Crypto key length in bytes. */
 #define SRT_KEY_LENGTH_TEXT N_("Crypto key length in bytes")
 #define SRT_DEFAULT_KEY_LENGTH 16
@@ -77,4 +79,9 @@ bool srt_parse_url(char* url, srt_params_t* params);
 int srt_set_socket_option(vlc_object_t *this, const char *srt_param,
         SRTSOCKET u, SRT_SOCKOPT opt, const void *optval, int optlen);
 
+/* Reports the link statistics of the socket at most every
+ * SRT_STATS_INTERVAL, the counters are those since the previous report. */
+void srt_log_stats(vlc_object_t *this, SRTSOCKET u, bool sender,
+        vlc_tick_t *restrict last);
+
 #endif
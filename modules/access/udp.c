@@ -47,19 +47,41 @@
 #ifdef HAVE_SYS_UIO_H
 # include <sys/uio.h>
 #endif
+#ifdef __linux__
+# include <netinet/udp.h>
+#endif
 
 /* Buffer can be max theoretical datagram content minus anticipated MTU.
  * IPv6 headers are larger than IPv4, ignore IPv6 jumbograms.
+ * This is also the largest payload of datagrams coalesced by GRO.
  */
 #define MRU 65507u
 
+#ifdef HAVE_RECVMMSG
+/* Datagrams received per system call */
+# define UDP_BATCH 16
+#else
+# define UDP_BATCH 1
+#endif
+
 typedef struct {
     int fd;
     int timeout;
 
+    /* Received datagrams not read yet */
+    unsigned count;
+    unsigned next;
+    size_t lengths[UDP_BATCH];
+
     size_t length;
     char *offset;
-    char buf[MRU];
+
+    uint32_t overflows; /* last kernel drop counter */
+    uint64_t dropped;
+
+    /* Each slot can hold a full datagram, or several coalesced by GRO. Only
+     * the pages that datagrams are written to are ever committed. */
+    char (*pool)[MRU];
 } access_sys_t;
 
 static int Control(stream_t *access, int query, va_list args)
@@ -77,25 +99,82 @@ static int Control(stream_t *access, int query, va_list args)
                 VLC_TICK_FROM_MS(var_InheritInteger(access, "network-caching"));
             break;
 
+        case STREAM_GET_DROPPED_PACKETS:
+        {
+            access_sys_t *sys = access->p_sys;
+            *va_arg(args, uint64_t *) = sys->dropped;
+            break;
+        }
+
         default:
             return VLC_EGENERIC;
     }
     return VLC_SUCCESS;
 }
 
-static ssize_t Read(stream_t *access, void *buf, size_t len)
+/* Copies out the received datagrams, they all belong to the byte stream */
+static size_t ReadPending(access_sys_t *sys, char *buf, size_t len)
 {
-    access_sys_t *sys = access->p_sys;
+    size_t total = 0;
+
+    while (len > 0) {
+        if (sys->length == 0) {
+            if (sys->next >= sys->count)
+                break;
+            sys->offset = sys->pool[sys->next];
+            sys->length = sys->lengths[sys->next];
+            sys->next++;
+            continue;
+        }
 
-    if (sys->length > 0) {
-        if (len > sys->length)
-            len = sys->length;
+        size_t copy = __MIN(len, sys->length);
 
-        memcpy(buf, sys->offset, len);
-        sys->offset += len;
-        sys->length -= len;
-        return len;
+        memcpy(buf, sys->offset, copy);
+        sys->offset += copy;
+        sys->length -= copy;
+        buf += copy;
+        len -= copy;
+        total += copy;
     }
+    return total;
+}
+
+/* Room for the drop counter and the GRO segment size */
+#if defined (SO_RXQ_OVFL) && defined (UDP_GRO)
+# define UDP_CMSG_SPACE (CMSG_SPACE(sizeof (uint32_t)) + CMSG_SPACE(sizeof (int)))
+#elif defined (SO_RXQ_OVFL)
+# define UDP_CMSG_SPACE CMSG_SPACE(sizeof (uint32_t))
+#else
+# define UDP_CMSG_SPACE 1
+#endif
+
+static void ParseControl(access_sys_t *sys, struct msghdr *msg)
+{
+#ifdef SO_RXQ_OVFL
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL;
+         cmsg = CMSG_NXTHDR(msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SO_RXQ_OVFL)
+            continue;
+
+        /* Count of the datagrams dropped since the option was set */
+        uint32_t overflows;
+
+        memcpy(&overflows, CMSG_DATA(cmsg), sizeof (overflows));
+        sys->dropped += (uint32_t)(overflows - sys->overflows);
+        sys->overflows = overflows;
+    }
+#else
+    VLC_UNUSED(sys); VLC_UNUSED(msg);
+#endif
+}
+
+static ssize_t Read(stream_t *access, void *buf, size_t len)
+{
+    access_sys_t *sys = access->p_sys;
+    size_t pending = ReadPending(sys, buf, len);
+
+    if (pending > 0)
+        return pending;
 
     struct pollfd ufd[1];
 
@@ -110,26 +189,72 @@ static ssize_t Read(stream_t *access, void *buf, size_t len)
             return -1;
     }
 
-    struct iovec iov[] = {
-        { .iov_base = buf,      .iov_len = len, },
-        { .iov_base = sys->buf, .iov_len = MRU, },
+    /* The first datagram is received directly in the caller buffer, with
+     * the excess in the first slot. The next ones go to the other slots. */
+    struct iovec iov[UDP_BATCH + 1] = {
+        { .iov_base = buf,          .iov_len = len, },
+        { .iov_base = sys->pool[0], .iov_len = MRU, },
     };
+    union {
+        char buf[UDP_CMSG_SPACE];
+        struct cmsghdr align;
+    } control[UDP_BATCH];
+#ifdef HAVE_RECVMMSG
+    struct mmsghdr msgs[UDP_BATCH];
+
+    for (unsigned i = 0; i < UDP_BATCH; i++) {
+        if (i > 0) {
+            iov[i + 1].iov_base = sys->pool[i];
+            iov[i + 1].iov_len = MRU;
+        }
+        msgs[i].msg_hdr = (struct msghdr) {
+            .msg_iov = (i > 0) ? &iov[i + 1] : iov,
+            .msg_iovlen = (i > 0) ? 1 : 2,
+            .msg_control = control[i].buf,
+            .msg_controllen = sizeof (control[i].buf),
+        };
+    }
+
+    /* Take whatever is queued, poll() said there is at least one */
+    int count = recvmmsg(sys->fd, msgs, UDP_BATCH, MSG_DONTWAIT, NULL);
+    if (count <= 0)
+        return -1;
+
+    for (int i = 0; i < count; i++) {
+        sys->lengths[i] = msgs[i].msg_len;
+        ParseControl(sys, &msgs[i].msg_hdr);
+    }
+#else
     struct msghdr msg = {
         .msg_iov = iov,
-        .msg_iovlen = ARRAY_SIZE(iov),
+        .msg_iovlen = 2,
+        .msg_control = control[0].buf,
+        .msg_controllen = sizeof (control[0].buf),
     };
-    ssize_t val = recvmsg(sys->fd, &msg, 0);
-
-    if (val <= 0) /* empty (0 bytes) payload does *not* mean EOF here */
+    ssize_t received = recvmsg(sys->fd, &msg, 0);
+    if (received < 0)
         return -1;
 
-    if (unlikely((size_t)val > len)) {
-        sys->offset = sys->buf;
+    sys->lengths[0] = received;
+    ParseControl(sys, &msg);
+
+    const int count = 1;
+#endif
+
+    size_t val = sys->lengths[0];
+
+    sys->count = count;
+    sys->next = 1;
+    sys->length = 0;
+    if (unlikely(val > len)) {
+        sys->offset = sys->pool[0];
         sys->length = val - len;
         val = len;
-    }
+    } else /* fill the rest of the caller buffer from the other datagrams */
+        val += ReadPending(sys, (char *)buf + val, len - val);
 
-    return val;
+    /* empty (0 bytes) payload does *not* mean EOF here */
+    return (val > 0) ? (ssize_t)val : -1;
 }
 
 /*****************************************************************************
@@ -147,7 +272,15 @@ static int Open( vlc_object_t *p_this )
     if( unlikely( sys == NULL ) )
         return VLC_ENOMEM;
 
+    sys->pool = vlc_obj_malloc( p_this, UDP_BATCH * sizeof (*sys->pool) );
+    if( unlikely( sys->pool == NULL ) )
+        return VLC_ENOMEM;
+
+    sys->count = 0;
+    sys->next = 0;
     sys->length = 0;
+    sys->overflows = 0;
+    sys->dropped = 0;
     p_access->p_sys = sys;
     p_access->pf_read = Read;
     p_access->pf_block = NULL;
@@ -213,6 +346,16 @@ static int Open( vlc_object_t *p_this )
         return VLC_EGENERIC;
     }
 
+#ifdef SO_RXQ_OVFL
+    /* Report the datagrams dropped by the kernel */
+    setsockopt( sys->fd, SOL_SOCKET, SO_RXQ_OVFL, &(int){ 1 }, sizeof (int) );
+#endif
+#ifdef UDP_GRO
+    /* Let the kernel coalesce the datagrams of the source: they are all
+     * appended to the byte stream anyway */
+    setsockopt( sys->fd, SOL_UDP, UDP_GRO, &(int){ 1 }, sizeof (int) );
+#endif
+
     sys->timeout = var_InheritInteger( p_access, "udp-timeout");
     if( sys->timeout > 0)
         sys->timeout *= 1000;
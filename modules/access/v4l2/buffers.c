@@ -201,7 +201,7 @@ struct vlc_v4l2_buffers *StartMmap(vlc_object_t *obj, int fd)
 {
     struct vlc_v4l2_buffers *pool;
     struct v4l2_requestbuffers req = {
-        .count = 16,
+        .count = var_InheritInteger(obj, CFG_PREFIX "buffers"),
         .type = V4L2_BUF_TYPE_VIDEO_CAPTURE,
         .memory = V4L2_MEMORY_MMAP,
     };
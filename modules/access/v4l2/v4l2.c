@@ -69,6 +69,12 @@
     "(if both width and height are strictly positive)." )
 #define FPS_TEXT N_( "Frame rate" )
 #define FPS_LONGTEXT N_( "Maximum frame rate to use (0 = no limits)." )
+#define BUFFERS_TEXT N_( "Capture buffers" )
+#define BUFFERS_LONGTEXT N_( \
+    "Number of memory-mapped buffers to request from the driver. " \
+    "Captured frames are passed on without copy while enough buffers " \
+    "remain queued, so more buffers avoid copies with deep pipelines, " \
+    "and fewer buffers save memory with many devices." )
 
 #define RADIO_DEVICE_TEXT N_( "Radio device" )
 #define RADIO_DEVICE_LONGTEXT N_("Radio tuner device node." )
@@ -308,6 +314,9 @@ vlc_module_begin ()
         change_safe()
     add_string( CFG_PREFIX "fps", "60", FPS_TEXT, FPS_LONGTEXT )
         change_safe()
+    add_integer( CFG_PREFIX "buffers", 16, BUFFERS_TEXT, BUFFERS_LONGTEXT )
+        change_integer_range( 2, 32 )
+        change_safe()
 
     set_section( N_( "Tuner" ), NULL )
     add_loadfile(CFG_PREFIX "radio-dev", "/dev/radio0",
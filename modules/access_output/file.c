@@ -35,6 +35,9 @@
 #include <errno.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#ifdef HAVE_SYS_UIO_H
+# include <sys/uio.h>
+#endif
 #ifdef __OS2__
 #   include <io.h>      /* setmode() */
 #endif
@@ -48,6 +51,8 @@
 #include <vlc_network.h>
 #include <vlc_strings.h>
 #include <vlc_dialog.h>
+#include <vlc_queue.h>
+#include <vlc_tick.h>
 
 #ifndef O_LARGEFILE
 #   define O_LARGEFILE 0
@@ -58,139 +63,276 @@
 
 #define SOUT_CFG_PREFIX "sout-file-"
 
+/* Maximum number of blocks written at once */
+#define FILE_IOV_MAX 64
+/* Write duration from which the disk is reported as too slow */
+#define FILE_SLOW_WRITE VLC_TICK_FROM_MS(500)
+
+typedef struct
+{
+    int fd;
+    uint64_t offset; /**< current file offset (regular files only) */
+    uint64_t allocated; /**< end of the preallocated space */
+    uint64_t prealloc; /**< preallocation size, 0 if disabled */
+
+    /* Asynchronous writing */
+    ssize_t (*write)(sout_access_out_t *, block_t *);
+    vlc_thread_t thread;
+    vlc_queue_t queue;
+    vlc_cond_t idle; /**< signaled when nothing is queued anymore */
+    size_t queued; /**< bytes queued or being written */
+    size_t queue_max;
+    uint64_t dropped; /**< bytes dropped since the last report */
+    bool dead;
+    bool failed;
+    bool async;
+} sout_access_out_sys_t;
+
 /*****************************************************************************
  * Read: standard read on a file descriptor.
  *****************************************************************************/
 static ssize_t Read( sout_access_out_t *p_access, block_t *p_buffer )
 {
-    int *fdp = p_access->p_sys, fd = *fdp;
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
     ssize_t val;
 
     do
-        val = read(fd, p_buffer->p_buffer, p_buffer->i_buffer);
+        val = read(p_sys->fd, p_buffer->p_buffer, p_buffer->i_buffer);
     while (val == -1 && errno == EINTR);
     return val;
 }
 
 /*****************************************************************************
- * Write: standard write on a file descriptor.
+ * WriteChain: vectored write of a block chain
  *****************************************************************************/
-static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
+static ssize_t WriteChain(sout_access_out_t *access, block_t *block,
+                          ssize_t (*writev_cb)(int, const struct iovec *, int))
 {
-    int *fdp = p_access->p_sys, fd = *fdp;
-    size_t i_write = 0;
+    sout_access_out_sys_t *sys = access->p_sys;
+    size_t total = 0;
 
-    while( p_buffer )
+    while (block != NULL)
     {
-        ssize_t val = write(fd, p_buffer->p_buffer, p_buffer->i_buffer);
-        if (val <= 0)
+        struct iovec iov[FILE_IOV_MAX];
+        int count = 0;
+
+        for (block_t *b = block; b != NULL && count < FILE_IOV_MAX;
+             b = b->p_next)
+            if (b->i_buffer > 0)
+            {
+                iov[count].iov_base = b->p_buffer;
+                iov[count].iov_len = b->i_buffer;
+                count++;
+            }
+
+        size_t len = 0;
+
+        if (count > 0)
         {
-            if (errno == EINTR)
-                continue;
-            block_ChainRelease (p_buffer);
-            msg_Err( p_access, "cannot write: %s", vlc_strerror_c(errno) );
-            return -1;
+            ssize_t val = writev_cb(sys->fd, iov, count);
+            if (val <= 0)
+            {   /* FIXME: errno is meaningless if val is zero */
+                if (val < 0 && errno == EINTR)
+                    continue;
+                block_ChainRelease(block);
+                msg_Err(access, "cannot write: %s", vlc_strerror_c(errno));
+                return -1;
+            }
+            len = val;
         }
+        total += len;
 
-        if ((size_t)val >= p_buffer->i_buffer)
+        /* Release the written blocks */
+        while (block != NULL && len >= block->i_buffer)
         {
-            block_t *p_next = p_buffer->p_next;
-            block_Release (p_buffer);
-            p_buffer = p_next;
+            block_t *next = block->p_next;
+
+            len -= block->i_buffer;
+            block_Release(block);
+            block = next;
         }
-        else
+
+        if (block != NULL)
         {
-            p_buffer->p_buffer += val;
-            p_buffer->i_buffer -= val;
+            block->p_buffer += len;
+            block->i_buffer -= len;
         }
-        i_write += val;
     }
-    return i_write;
+    return total;
 }
 
-static ssize_t WritePipe(sout_access_out_t *access, block_t *block)
+/*****************************************************************************
+ * Write: standard write on a file descriptor.
+ *****************************************************************************/
+static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
 {
-    int *fdp = access->p_sys, fd = *fdp;
-    ssize_t total = 0;
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
 
-    while (block != NULL)
+#ifdef FALLOC_FL_KEEP_SIZE
+    if (p_sys->prealloc > 0)
     {
-        if (block->i_buffer == 0)
-        {
-            block_t *next = block->p_next;
-            block_Release(block);
-            block = next;
-            continue;
+        size_t size;
+
+        block_ChainProperties(p_buffer, NULL, &size, NULL);
+        if (p_sys->offset + size > p_sys->allocated)
+        {   /* Reserve the disk space ahead, without changing the file size,
+             * to limit the fragmentation while recording. */
+            uint64_t end = p_sys->offset + size + p_sys->prealloc;
+
+            if (fallocate(p_sys->fd, FALLOC_FL_KEEP_SIZE, p_sys->offset,
+                          end - p_sys->offset) == 0)
+                p_sys->allocated = end;
+            else
+            {
+                msg_Dbg(p_access, "cannot preallocate: %s",
+                        vlc_strerror_c(errno));
+                p_sys->prealloc = 0;
+            }
         }
+    }
+#endif
 
-        /* TODO: vectorized I/O with writev() */
-        ssize_t val = vlc_write(fd, block->p_buffer, block->i_buffer);
-        if (val < 0)
-        {
-            if (errno == EINTR)
-                continue;
-
-            block_ChainRelease(block);
-            msg_Err(access, "cannot write: %s", vlc_strerror_c(errno));
-            total = -1;
-            break;
-        }
+    ssize_t val = WriteChain(p_access, p_buffer, writev);
+    if (val > 0)
+        p_sys->offset += val;
+    return val;
+}
 
-        total += val;
+static ssize_t WritePipe(sout_access_out_t *access, block_t *block)
+{
+    return WriteChain(access, block, vlc_writev);
+}
 
-        assert((size_t)val <= block->i_buffer);
-        block->p_buffer += val;
-        block->i_buffer -= val;
-    }
+#ifdef S_ISSOCK
+static ssize_t SendV(int fd, const struct iovec *iov, int count)
+{
+    const struct msghdr msg =
+    {
+        .msg_iov = (struct iovec *)iov,
+        .msg_iovlen = count,
+    };
 
-    return total;
+    return vlc_sendmsg(fd, &msg, 0);
 }
 
-#ifdef S_ISSOCK
 static ssize_t Send(sout_access_out_t *access, block_t *block)
 {
-    int *fdp = access->p_sys, fd = *fdp;
-    size_t total = 0;
+    return WriteChain(access, block, SendV);
+}
+#endif
 
-    while (block != NULL)
+/*****************************************************************************
+ * Seek: seek to a specific location in a file
+ *****************************************************************************/
+static int Seek( sout_access_out_t *p_access, uint64_t i_pos )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+
+    if (lseek(p_sys->fd, i_pos, SEEK_SET) == -1)
+        return -1;
+    p_sys->offset = i_pos;
+    return 0;
+}
+
+/*****************************************************************************
+ * Asynchronous writing: the blocks are queued, and written by a thread in as
+ * large batches as have accumulated, so that a slow disk does not stall the
+ * caller. Past the queue size, the data is dropped rather than waited for.
+ *****************************************************************************/
+static void *WriteThread(void *data)
+{
+    sout_access_out_t *access = data;
+    sout_access_out_sys_t *sys = access->p_sys;
+    bool slow = false;
+
+    vlc_thread_set_name("vlc-file-write");
+
+    for (;;)
     {
-        if (block->i_buffer == 0)
+        vlc_queue_Lock(&sys->queue);
+        while (vlc_queue_IsEmpty(&sys->queue) && !sys->dead)
+            vlc_queue_Wait(&sys->queue);
+        block_t *block = vlc_queue_DequeueAllUnlocked(&sys->queue);
+        vlc_queue_Unlock(&sys->queue);
+
+        if (block == NULL)
+            break;
+
+        size_t size;
+        block_ChainProperties(block, NULL, &size, NULL);
+
+        vlc_tick_t start = vlc_tick_now();
+        ssize_t val = sys->write(access, block);
+        vlc_tick_t elapsed = vlc_tick_now() - start;
+
+        if (elapsed >= FILE_SLOW_WRITE)
         {
-            block_t *next = block->p_next;
-            block_Release(block);
-            block = next;
-            continue;
+            if (!slow)
+                msg_Warn(access, "slow disk: %zu KiB written in %"PRId64" ms",
+                         size >> 10, MS_FROM_VLC_TICK(elapsed));
+            slow = true;
         }
+        else
+            slow = false;
 
-        /* TODO: vectorized I/O with sendmsg() */
-        ssize_t val = vlc_send(fd, block->p_buffer, block->i_buffer, 0);
-        if (val <= 0)
-        {   /* FIXME: errno is meaningless if val is zero */
-            if (errno == EINTR)
-                continue;
-            block_ChainRelease(block);
-            msg_Err(access, "cannot write: %s", vlc_strerror_c(errno));
-            return -1;
-        }
+        vlc_queue_Lock(&sys->queue);
+        sys->queued -= size;
+        if (val < 0)
+            sys->failed = true;
+        if (sys->queued == 0)
+            vlc_cond_broadcast(&sys->idle);
+        vlc_queue_Unlock(&sys->queue);
+    }
+    return NULL;
+}
+
+static ssize_t WriteAsync(sout_access_out_t *access, block_t *block)
+{
+    sout_access_out_sys_t *sys = access->p_sys;
+    size_t size;
 
-        total += val;
+    block_ChainProperties(block, NULL, &size, NULL);
 
-        assert((size_t)val <= block->i_buffer);
-        block->p_buffer += val;
-        block->i_buffer -= val;
+    vlc_queue_Lock(&sys->queue);
+    if (sys->failed)
+    {
+        vlc_queue_Unlock(&sys->queue);
+        block_ChainRelease(block);
+        return -1;
     }
-    return total;
+
+    if (sys->queued > 0 && sys->queued + size > sys->queue_max)
+    {
+        if (sys->dropped == 0)
+            msg_Warn(access, "disk too slow, dropping data");
+        sys->dropped += size;
+        vlc_queue_Unlock(&sys->queue);
+        block_ChainRelease(block);
+        return size;
+    }
+
+    if (sys->dropped > 0)
+    {
+        msg_Warn(access, "dropped %"PRIu64" KiB of data", sys->dropped >> 10);
+        sys->dropped = 0;
+    }
+    sys->queued += size;
+    vlc_queue_EnqueueUnlocked(&sys->queue, block);
+    vlc_queue_Unlock(&sys->queue);
+    return size;
 }
-#endif
 
-/*****************************************************************************
- * Seek: seek to a specific location in a file
- *****************************************************************************/
-static int Seek( sout_access_out_t *p_access, uint64_t i_pos )
+static int SeekAsync(sout_access_out_t *access, uint64_t pos)
 {
-    int *fdp = p_access->p_sys, fd = *fdp;
+    sout_access_out_sys_t *sys = access->p_sys;
 
-    return lseek(fd, i_pos, SEEK_SET);
+    /* The queued data belongs before the new position */
+    vlc_queue_Lock(&sys->queue);
+    while (sys->queued > 0)
+        vlc_cond_wait(&sys->idle, &sys->queue.lock);
+    vlc_queue_Unlock(&sys->queue);
+
+    return Seek(access, pos);
 }
 
 static int Control( sout_access_out_t *p_access, int i_query, va_list args )
@@ -219,8 +361,13 @@ static int Control( sout_access_out_t *p_access, int i_query, va_list args )
 
 static const char *const ppsz_sout_options[] = {
     "append",
+    "async",
     "format",
     "overwrite",
+#ifdef FALLOC_FL_KEEP_SIZE
+    "prealloc",
+#endif
+    "queue-size",
 #ifdef O_SYNC
     "sync",
 #endif
@@ -234,9 +381,9 @@ static int Open( vlc_object_t *p_this )
 {
     sout_access_out_t   *p_access = (sout_access_out_t*)p_this;
     int fd;
-    int *fdp = vlc_obj_malloc(p_this, sizeof (*fdp));
+    sout_access_out_sys_t *p_sys = vlc_obj_malloc(p_this, sizeof (*p_sys));
 
-    if (unlikely(fdp == NULL))
+    if (unlikely(p_sys == NULL))
         return VLC_ENOMEM;
 
     config_ChainParse( p_access, SOUT_CFG_PREFIX, ppsz_sout_options, p_access->p_cfg );
@@ -321,8 +468,11 @@ static int Open( vlc_object_t *p_this )
             return VLC_EGENERIC;
     }
 
-    *fdp = fd;
-    p_access->p_sys = fdp;
+    p_sys->fd = fd;
+    p_sys->offset = 0;
+    p_sys->allocated = 0;
+    p_sys->prealloc = 0;
+    p_access->p_sys = p_sys;
 
     struct stat st;
 
@@ -339,6 +489,11 @@ static int Open( vlc_object_t *p_this )
     {
         p_access->pf_write = Write;
         p_access->pf_seek  = Seek;
+#ifdef FALLOC_FL_KEEP_SIZE
+        if (S_ISREG(st.st_mode))
+            p_sys->prealloc = (uint64_t)var_GetInteger(p_access,
+                                           SOUT_CFG_PREFIX"prealloc") << 20;
+#endif
     }
 #ifdef S_ISSOCK
     else if (S_ISSOCK(st.st_mode))
@@ -356,7 +511,35 @@ static int Open( vlc_object_t *p_this )
 
     msg_Dbg( p_access, "file access output opened (%s)", p_access->psz_path );
     if (append)
-        lseek (fd, 0, SEEK_END);
+    {
+        off_t end = lseek (fd, 0, SEEK_END);
+        if (end > 0)
+            p_sys->offset = end;
+    }
+
+    p_sys->async = var_GetBool(p_access, SOUT_CFG_PREFIX"async");
+    if (p_sys->async)
+    {
+        p_sys->write = p_access->pf_write;
+        p_sys->queued = 0;
+        p_sys->queue_max = (size_t)var_GetInteger(p_access,
+                                          SOUT_CFG_PREFIX"queue-size") << 20;
+        p_sys->dropped = 0;
+        p_sys->dead = false;
+        p_sys->failed = false;
+        vlc_queue_Init(&p_sys->queue, offsetof (block_t, p_next));
+        vlc_cond_init(&p_sys->idle);
+
+        if (vlc_clone(&p_sys->thread, WriteThread, p_access))
+        {
+            vlc_close(fd);
+            return VLC_ENOMEM;
+        }
+
+        p_access->pf_write = WriteAsync;
+        if (p_access->pf_seek != NULL)
+            p_access->pf_seek = SeekAsync;
+    }
 
     return VLC_SUCCESS;
 }
@@ -367,9 +550,18 @@ static int Open( vlc_object_t *p_this )
 static void Close( vlc_object_t * p_this )
 {
     sout_access_out_t *p_access = (sout_access_out_t*)p_this;
-    int *fdp = p_access->p_sys, fd = *fdp;
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+
+    if (p_sys->async)
+    {   /* The thread writes whatever is still queued */
+        vlc_queue_Kill(&p_sys->queue, &p_sys->dead);
+        vlc_join(p_sys->thread, NULL);
+        if (p_sys->dropped > 0)
+            msg_Warn(p_access, "dropped %"PRIu64" KiB of data",
+                     p_sys->dropped >> 10);
+    }
 
-    vlc_close(fd);
+    vlc_close(p_sys->fd);
     msg_Dbg( p_access, "file access output closed" );
 }
 
@@ -384,6 +576,16 @@ static void Close( vlc_object_t * p_this )
     "on the file path")
 #define SYNC_TEXT N_("Synchronous writing")
 #define SYNC_LONGTEXT N_( "Open the file with synchronous writing.")
+#define ASYNC_TEXT N_("Asynchronous writing")
+#define ASYNC_LONGTEXT N_("Write from a separate thread, so that a slow " \
+    "disk does not stall the output. Data is dropped when the queue is full.")
+#define QUEUE_SIZE_TEXT N_("Asynchronous queue size (MiB)")
+#define QUEUE_SIZE_LONGTEXT N_("Amount of data waiting to be written " \
+    "beyond which further data is dropped.")
+#define PREALLOC_TEXT N_("Disk space preallocation (MiB)")
+#define PREALLOC_LONGTEXT N_( "Reserve the disk space ahead of the " \
+    "written data by chunks of this size, to reduce the fragmentation " \
+    "of recordings. 0 disables the preallocation.")
 
 vlc_module_begin ()
     set_description( N_("File stream output") )
@@ -395,8 +597,15 @@ vlc_module_begin ()
               OVERWRITE_LONGTEXT )
     add_bool( SOUT_CFG_PREFIX "append", false, APPEND_TEXT,APPEND_LONGTEXT )
     add_bool( SOUT_CFG_PREFIX "format", false, FORMAT_TEXT, FORMAT_LONGTEXT )
+#ifdef FALLOC_FL_KEEP_SIZE
+    add_integer_with_range( SOUT_CFG_PREFIX "prealloc", 0, 0, 1024,
+                            PREALLOC_TEXT, PREALLOC_LONGTEXT )
+#endif
 #ifdef O_SYNC
     add_bool( SOUT_CFG_PREFIX "sync", false, SYNC_TEXT,SYNC_LONGTEXT )
 #endif
+    add_bool( SOUT_CFG_PREFIX "async", false, ASYNC_TEXT, ASYNC_LONGTEXT )
+    add_integer_with_range( SOUT_CFG_PREFIX "queue-size", 64, 1, 1024,
+                            QUEUE_SIZE_TEXT, QUEUE_SIZE_LONGTEXT )
     set_callbacks( Open, Close )
 vlc_module_end ()
@@ -57,6 +57,11 @@ static void Close( vlc_object_t * );
 #define MIME_TEXT N_("Mime")
 #define MIME_LONGTEXT N_("MIME returned by the server (autodetected " \
                         "if not specified)." )
+#define BURST_TEXT N_("Burst on connect")
+#define BURST_LONGTEXT N_("New clients are sent at once the stream from " \
+                          "the last keyframe if it is at most that many " \
+                          "kilobytes behind, so that they start faster " \
+                          "(0 to wait for the next keyframe)." )
 #define METACUBE_TEXT N_("Metacube")
 #define METACUBE_LONGTEXT N_("Use the Metacube protocol. Needed for streaming " \
                              "to the Cubemap reflector.")
@@ -73,6 +78,8 @@ vlc_module_begin ()
     add_password(SOUT_CFG_PREFIX "pwd", "", PASS_TEXT, PASS_LONGTEXT)
     add_string( SOUT_CFG_PREFIX "mime", "",
                 MIME_TEXT, MIME_LONGTEXT )
+    add_integer( SOUT_CFG_PREFIX "burst", 2048, BURST_TEXT, BURST_LONGTEXT )
+        change_integer_range( 0, 4096 )
     add_bool( SOUT_CFG_PREFIX "metacube", false,
               METACUBE_TEXT, METACUBE_LONGTEXT )
     set_callbacks( Open, Close )
@@ -83,7 +90,7 @@ vlc_module_end ()
  * Exported prototypes
  *****************************************************************************/
 static const char *const ppsz_sout_options[] = {
-    "user", "pwd", "mime", "metacube", NULL
+    "user", "pwd", "mime", "burst", "metacube", NULL
 };
 
 static ssize_t Write( sout_access_out_t *, block_t * );
@@ -271,6 +278,10 @@ static int Open( vlc_object_t *p_this )
         return VLC_EGENERIC;
     }
 
+    httpd_StreamSetBurst( p_sys->p_httpd_stream,
+                          var_GetInteger( p_access, SOUT_CFG_PREFIX "burst" )
+                              * 1024 );
+
     if( p_sys->b_metacube )
     {
         const httpd_header headers[] = {
@@ -35,6 +35,9 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <unistd.h>
+#ifdef HAVE_SYS_UIO_H
+# include <sys/uio.h>
+#endif
 
 #include <vlc_common.h>
 #include <vlc_arrays.h>
@@ -59,6 +62,9 @@
 
 #define MAX_RENAME_RETRIES        10
 
+/* Maximum number of blocks written at once */
+#define LIVEHTTP_IOV_MAX          64
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -203,6 +209,8 @@ typedef struct
     uint8_t stuffing_bytes[16];
     ssize_t stuffing_size;
     vlc_array_t segments_t;
+    uint32_t i_index_segment; /* last segment in the index file, if known */
+    char *psz_index_key_uri; /* last key URI in the index file */
 } sout_access_out_sys_t;
 
 static int LoadCryptFile( sout_access_out_t *p_access);
@@ -552,130 +560,188 @@ static bool isFirstItemRemovable( sout_access_out_sys_t *p_sys, uint32_t i_first
 }
 
 /************************************************************************
- * updateIndexAndDel: If necessary, update index file & delete old segments
+ * writeIndexSegment: write the index lines of a segment
  ************************************************************************/
-static int updateIndexAndDel( sout_access_out_t *p_access, sout_access_out_sys_t *p_sys, bool b_isend )
+static int writeIndexSegment( FILE *fp, sout_access_out_sys_t *p_sys,
+                              const output_segment_t *segment,
+                              char **ppsz_current_uri )
 {
+    if( p_sys->key_uri &&
+        ( !*ppsz_current_uri || strcmp( *ppsz_current_uri, segment->psz_key_uri ) )
+      )
+    {
+        int ret = 0;
+        free( *ppsz_current_uri );
+        *ppsz_current_uri = strdup( segment->psz_key_uri );
+        if( p_sys->b_generate_iv )
+        {
+            unsigned long long iv_hi = segment->aes_ivs[0];
+            unsigned long long iv_lo = segment->aes_ivs[8];
+            for( unsigned short j = 1; j < 8; j++ )
+            {
+                iv_hi <<= 8;
+                iv_hi |= segment->aes_ivs[j] & 0xff;
+                iv_lo <<= 8;
+                iv_lo |= segment->aes_ivs[8+j] & 0xff;
+            }
+            ret = fprintf( fp, "#EXT-X-KEY:METHOD=AES-128,URI=\"%s\",IV=0X%16.16llx%16.16llx\n",
+                           segment->psz_key_uri, iv_hi, iv_lo );
 
-    uint32_t i_firstseg;
-    unsigned i_index_offset = 0;
+        } else {
+            ret = fprintf( fp, "#EXT-X-KEY:METHOD=AES-128,URI=\"%s\"\n", segment->psz_key_uri );
+        }
+        if( ret < 0 )
+            return -1;
+    }
 
-    if ( p_sys->i_numsegs == 0 ||
-         p_sys->i_segment < ( p_sys->i_numsegs + p_sys->i_initial_segment ) )
+    return fprintf( fp, "#EXTINF:%s,\n%s\n", segment->psz_duration, segment->psz_uri);
+}
+
+/************************************************************************
+ * appendIndex: add the last segment to an index without sliding window
+ ************************************************************************/
+static int appendIndex( sout_access_out_t *p_access, sout_access_out_sys_t *p_sys )
+{
+    output_segment_t *segment = vlc_array_item_at_index( &p_sys->segments_t, vlc_array_count( &p_sys->segments_t ) - 1 );
+
+    FILE *fp = vlc_fopen( p_sys->psz_indexPath, "at" );
+    if ( !fp )
+        return -1;
+
+    int val = writeIndexSegment( fp, p_sys, segment, &p_sys->psz_index_key_uri );
+    if ( fclose( fp ) || val < 0 )
     {
-        i_firstseg = p_sys->i_initial_segment;
+        msg_Warn( p_access, "cannot append to LiveHttp index file" );
+        return -1;
     }
-    else
+
+    p_sys->i_index_segment = p_sys->i_segment;
+    msg_Dbg( p_access, "LiveHttpIndexComplete: %s" , p_sys->psz_indexPath );
+    return 0;
+}
+
+/************************************************************************
+ * writeIndex: write the whole index file
+ ************************************************************************/
+static int writeIndex( sout_access_out_t *p_access, sout_access_out_sys_t *p_sys,
+                       uint32_t i_firstseg, unsigned i_index_offset, bool b_isend )
+{
+    int val;
+    FILE *fp;
+    char *psz_idxTmp;
+    if ( asprintf( &psz_idxTmp, "%s.tmp", p_sys->psz_indexPath ) < 0)
+        return -1;
+
+    fp = vlc_fopen( psz_idxTmp, "wt");
+    if ( !fp )
     {
-        unsigned numsegs = segmentAmountNeeded( p_sys );
-        i_firstseg = ( p_sys->i_segment - numsegs ) + 1;
-        i_index_offset = vlc_array_count( &p_sys->segments_t ) - numsegs;
+        msg_Err( p_access, "cannot open index file `%s'", psz_idxTmp );
+        free( psz_idxTmp );
+        return -1;
     }
 
-    // First update index
-    if ( p_sys->psz_indexPath )
+    if ( fprintf( fp, "#EXTM3U\n#EXT-X-TARGETDURATION:%.0f\n#EXT-X-VERSION:3\n#EXT-X-ALLOW-CACHE:%s"
+                      "%s\n#EXT-X-MEDIA-SEQUENCE:%"PRIu32"\n%s", ceil(secf_from_vlc_tick( p_sys->segment_max_length )) ,
+                      p_sys->b_caching ? "YES" : "NO",
+                      p_sys->i_numsegs > 0 ? "" : b_isend ? "\n#EXT-X-PLAYLIST-TYPE:VOD" : "\n#EXT-X-PLAYLIST-TYPE:EVENT",
+                      i_firstseg, ((p_sys->i_initial_segment > 1) && (p_sys->i_initial_segment == i_firstseg)) ? "#EXT-X-DISCONTINUITY\n" : ""
+                      ) < 0 )
     {
-        int val;
-        FILE *fp;
-        char *psz_idxTmp;
-        if ( asprintf( &psz_idxTmp, "%s.tmp", p_sys->psz_indexPath ) < 0)
-            return -1;
+        free( psz_idxTmp );
+        fclose( fp );
+        return -1;
+    }
+    char *psz_current_uri=NULL;
 
-        fp = vlc_fopen( psz_idxTmp, "wt");
-        if ( !fp )
+
+    for ( uint32_t i = i_firstseg; i <= p_sys->i_segment; i++ )
+    {
+        //scale to i_index_offset..numsegs + i_index_offset
+        uint32_t index = i - i_firstseg + i_index_offset;
+
+        output_segment_t *segment = vlc_array_item_at_index( &p_sys->segments_t, index );
+
+        val = writeIndexSegment( fp, p_sys, segment, &psz_current_uri );
+        if ( val < 0 )
         {
-            msg_Err( p_access, "cannot open index file `%s'", psz_idxTmp );
+            free( psz_current_uri );
             free( psz_idxTmp );
+            fclose( fp );
             return -1;
         }
+    }
 
-        if ( fprintf( fp, "#EXTM3U\n#EXT-X-TARGETDURATION:%.0f\n#EXT-X-VERSION:3\n#EXT-X-ALLOW-CACHE:%s"
-                          "%s\n#EXT-X-MEDIA-SEQUENCE:%"PRIu32"\n%s", ceil(secf_from_vlc_tick( p_sys->segment_max_length )) ,
-                          p_sys->b_caching ? "YES" : "NO",
-                          p_sys->i_numsegs > 0 ? "" : b_isend ? "\n#EXT-X-PLAYLIST-TYPE:VOD" : "\n#EXT-X-PLAYLIST-TYPE:EVENT",
-                          i_firstseg, ((p_sys->i_initial_segment > 1) && (p_sys->i_initial_segment == i_firstseg)) ? "#EXT-X-DISCONTINUITY\n" : ""
-                          ) < 0 )
+    if ( b_isend )
+    {
+        if ( fputs ( STR_ENDLIST, fp ) < 0)
         {
+            free( psz_current_uri );
             free( psz_idxTmp );
-            fclose( fp );
+            fclose( fp ) ;
             return -1;
         }
-        char *psz_current_uri=NULL;
-
 
-        for ( uint32_t i = i_firstseg; i <= p_sys->i_segment; i++ )
-        {
-            //scale to i_index_offset..numsegs + i_index_offset
-            uint32_t index = i - i_firstseg + i_index_offset;
+    }
+    fclose( fp );
 
-            output_segment_t *segment = vlc_array_item_at_index( &p_sys->segments_t, index );
-            if( p_sys->key_uri &&
-                ( !psz_current_uri ||  strcmp( psz_current_uri, segment->psz_key_uri ) )
-              )
-            {
-                int ret = 0;
-                free( psz_current_uri );
-                psz_current_uri = strdup( segment->psz_key_uri );
-                if( p_sys->b_generate_iv )
-                {
-                    unsigned long long iv_hi = segment->aes_ivs[0];
-                    unsigned long long iv_lo = segment->aes_ivs[8];
-                    for( unsigned short j = 1; j < 8; j++ )
-                    {
-                        iv_hi <<= 8;
-                        iv_hi |= segment->aes_ivs[j] & 0xff;
-                        iv_lo <<= 8;
-                        iv_lo |= segment->aes_ivs[8+j] & 0xff;
-                    }
-                    ret = fprintf( fp, "#EXT-X-KEY:METHOD=AES-128,URI=\"%s\",IV=0X%16.16llx%16.16llx\n",
-                                   segment->psz_key_uri, iv_hi, iv_lo );
-
-                } else {
-                    ret = fprintf( fp, "#EXT-X-KEY:METHOD=AES-128,URI=\"%s\"\n", segment->psz_key_uri );
-                }
-                if( ret < 0 )
-                {
-                    free( psz_current_uri );
-                    free( psz_idxTmp );
-                    fclose( fp );
-                    return -1;
-                }
-            }
+    val = vlc_rename ( psz_idxTmp, p_sys->psz_indexPath);
 
-            val = fprintf( fp, "#EXTINF:%s,\n%s\n", segment->psz_duration, segment->psz_uri);
-            if ( val < 0 )
-            {
-                free( psz_current_uri );
-                free( psz_idxTmp );
-                fclose( fp );
-                return -1;
-            }
-        }
+    if ( val < 0 )
+    {
+        vlc_unlink( psz_idxTmp );
+        msg_Err( p_access, "Error moving LiveHttp index file" );
         free( psz_current_uri );
+    }
+    else
+    {
+        msg_Dbg( p_access, "LiveHttpIndexComplete: %s" , p_sys->psz_indexPath );
 
-        if ( b_isend )
-        {
-            if ( fputs ( STR_ENDLIST, fp ) < 0)
-            {
-                free( psz_idxTmp );
-                fclose( fp ) ;
-                return -1;
-            }
+        /* Remember the index state for later appends */
+        p_sys->i_index_segment = b_isend ? 0 : p_sys->i_segment;
+        free( p_sys->psz_index_key_uri );
+        p_sys->psz_index_key_uri = psz_current_uri;
+    }
 
-        }
-        fclose( fp );
+    free( psz_idxTmp );
+    return 0;
+}
 
-        val = vlc_rename ( psz_idxTmp, p_sys->psz_indexPath);
+/************************************************************************
+ * updateIndexAndDel: If necessary, update index file & delete old segments
+ ************************************************************************/
+static int updateIndexAndDel( sout_access_out_t *p_access, sout_access_out_sys_t *p_sys, bool b_isend )
+{
 
-        if ( val < 0 )
+    uint32_t i_firstseg;
+    unsigned i_index_offset = 0;
+
+    if ( p_sys->i_numsegs == 0 ||
+         p_sys->i_segment < ( p_sys->i_numsegs + p_sys->i_initial_segment ) )
+    {
+        i_firstseg = p_sys->i_initial_segment;
+    }
+    else
+    {
+        unsigned numsegs = segmentAmountNeeded( p_sys );
+        i_firstseg = ( p_sys->i_segment - numsegs ) + 1;
+        i_index_offset = vlc_array_count( &p_sys->segments_t ) - numsegs;
+    }
+
+    // First update index
+    if ( p_sys->psz_indexPath )
+    {
+        /* Without sliding window, the index only grows until the end, where
+         * the playlist type changes. The new segment is just appended. */
+        bool b_append = p_sys->i_numsegs == 0 && !b_isend &&
+                        p_sys->i_index_segment > 0 &&
+                        p_sys->i_index_segment + 1 == p_sys->i_segment;
+
+        if ( !b_append || appendIndex( p_access, p_sys ) )
         {
-            vlc_unlink( psz_idxTmp );
-            msg_Err( p_access, "Error moving LiveHttp index file" );
+            if ( writeIndex( p_access, p_sys, i_firstseg, i_index_offset,
+                             b_isend ) )
+                return -1;
         }
-        else
-            msg_Dbg( p_access, "LiveHttpIndexComplete: %s" , p_sys->psz_indexPath );
-
-        free( psz_idxTmp );
     }
 
     // Then take care of deletion
@@ -813,6 +879,7 @@ static void Close( vlc_object_t * p_this )
         destroySegment( segment );
     }
 
+    free( p_sys->psz_index_key_uri );
     free( p_sys->psz_indexUrl );
     free( p_sys->psz_indexPath );
     free( p_sys );
@@ -945,64 +1012,94 @@ static ssize_t writeSegment( sout_access_out_t *p_access )
     vlc_tick_t current_length = 0;
     block_ChainProperties( output, NULL, NULL, &current_length );
 
-    ssize_t i_write=0;
-    bool encrypted = false;
     p_sys->current_segment_length = current_length;
-    while( output )
+
+    if( p_sys->key_uri )
     {
-        if( p_sys->key_uri && !encrypted )
+        /* Encrypt all the blocks first, so that they can be written at once */
+        for( block_t **pp = &output; *pp != NULL; pp = &(*pp)->p_next )
         {
+            block_t *block = *pp;
+
             if( p_sys->stuffing_size )
             {
-                output = block_Realloc( output, p_sys->stuffing_size, output->i_buffer );
-                if( unlikely(!output ) )
+                block_t *next = block->p_next;
+
+                block = block_Realloc( block, p_sys->stuffing_size, block->i_buffer );
+                if( unlikely(!block ) )
+                {
+                    *pp = next;
+                    block_ChainRelease( output );
                     return VLC_ENOMEM;
-                memcpy( output->p_buffer, p_sys->stuffing_bytes, p_sys->stuffing_size );
+                }
+                block->p_next = next;
+                *pp = block;
+                memcpy( block->p_buffer, p_sys->stuffing_bytes, p_sys->stuffing_size );
                 p_sys->stuffing_size = 0;
             }
-            size_t original = output->i_buffer;
-            size_t padded = (output->i_buffer + 15 ) & ~15;
+            size_t original = block->i_buffer;
+            size_t padded = (block->i_buffer + 15 ) & ~15;
             size_t pad = padded - original;
             if( pad )
             {
                 p_sys->stuffing_size = 16-pad;
-                output->i_buffer -= p_sys->stuffing_size;
-                memcpy(p_sys->stuffing_bytes, &output->p_buffer[output->i_buffer], p_sys->stuffing_size);
+                block->i_buffer -= p_sys->stuffing_size;
+                memcpy(p_sys->stuffing_bytes, &block->p_buffer[block->i_buffer], p_sys->stuffing_size);
             }
 
             gcry_error_t err = gcry_cipher_encrypt( p_sys->aes_ctx,
-                                output->p_buffer, output->i_buffer, NULL, 0 );
+                                block->p_buffer, block->i_buffer, NULL, 0 );
             if( err )
             {
                 msg_Err( p_access, "Encryption failure: %s ", gpg_strerror(err) );
+                block_ChainRelease( output );
                 return -1;
             }
-            encrypted=true;
-
         }
+    }
+
+    ssize_t i_write=0;
+    while( output )
+    {
+        struct iovec iov[LIVEHTTP_IOV_MAX];
+        int count = 0;
 
-        ssize_t val = vlc_write( p_sys->i_handle, output->p_buffer, output->i_buffer );
-        if ( val == -1 )
+        for( block_t *b = output; b != NULL && count < LIVEHTTP_IOV_MAX; b = b->p_next )
+            if( b->i_buffer > 0 )
+            {
+                iov[count].iov_base = b->p_buffer;
+                iov[count].iov_len = b->i_buffer;
+                count++;
+            }
+
+        size_t len = 0;
+
+        if( count > 0 )
         {
-           if ( errno == EINTR )
-              continue;
-           return -1;
+            ssize_t val = vlc_writev( p_sys->i_handle, iov, count );
+            if ( val == -1 )
+            {
+               if ( errno == EINTR )
+                  continue;
+               block_ChainRelease( output );
+               return -1;
+            }
+            len = val;
         }
+        i_write += len;
 
-
-        if ( (size_t)val >= output->i_buffer )
+        while( output && len >= output->i_buffer )
         {
            block_t *p_next = output->p_next;
+           len -= output->i_buffer;
            block_Release (output);
            output = p_next;
-           encrypted=false;
         }
-        else
+        if( output )
         {
-           output->p_buffer += val;
-           output->i_buffer -= val;
+           output->p_buffer += len;
+           output->i_buffer -= len;
         }
-        i_write += val;
     }
     return i_write;
 }
@@ -101,33 +101,40 @@ static int cb_stats(void *arg, const struct rist_stats *stats_container)
 static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
 {
     sout_access_out_sys_t *p_sys = p_access->p_sys;
-    int i_len = 0;
+
+    if( p_buffer == NULL )
+        return 0;
+
+    /* Aggregate the (usually one TS packet) blocks of the chain so that each
+     * RIST packet carries as much as allowed */
+    p_buffer = block_ChainGather( p_buffer );
+    if( unlikely(p_buffer == NULL) )
+        return -1;
 
     struct rist_data_block rist_buffer = { 0 };
     rist_buffer.virt_src_port = p_sys->gre_src_port;
     rist_buffer.virt_dst_port = p_sys->gre_dst_port;
 
-    while( p_buffer )
-    {
-        block_t *p_next;
+    ssize_t i_len = p_buffer->i_buffer;
+    const uint8_t *p_data = p_buffer->p_buffer;
+    size_t i_data = p_buffer->i_buffer;
 
-        i_len += p_buffer->i_buffer;
-
-        while( p_buffer->i_buffer )
+    while( i_data > 0 )
+    {
+        size_t i_write = __MIN( i_data, p_sys->i_max_packet_size );
+        rist_buffer.payload = p_data;
+        rist_buffer.payload_len = i_write;
+        if( rist_sender_data_write(p_sys->sender_ctx, &rist_buffer) < 0 )
         {
-            size_t i_write = __MIN( p_buffer->i_buffer, p_sys->i_max_packet_size );
-            rist_buffer.payload = p_buffer->p_buffer;
-            rist_buffer.payload_len = p_buffer->i_buffer;
-            rist_sender_data_write(p_sys->sender_ctx, &rist_buffer);
-            p_buffer->p_buffer += i_write;
-            p_buffer->i_buffer -= i_write;
+            msg_Err(p_access, "Failed to send %zu bytes of data", i_write);
+            i_len = -1;
+            break;
         }
-
-        p_next = p_buffer->p_next;
-        block_Release( p_buffer );
-        p_buffer = p_next;
-
+        p_data += i_write;
+        i_data -= i_write;
     }
+
+    block_Release( p_buffer );
     return i_len;
 }
 
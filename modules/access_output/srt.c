@@ -40,6 +40,7 @@ typedef struct
     vlc_mutex_t   lock;
     size_t        i_payload_size;
     block_bytestream_t block_stream;
+    vlc_tick_t    i_stats_date; /* Date of the last link statistics report */
 } sout_access_out_sys_t;
 
 static void srt_wait_interrupted(void *p_data)
@@ -199,6 +200,7 @@ static bool srt_schedule_reconnect(sout_access_out_t *p_access)
         goto out;
     }
     p_sys->i_payload_size = i_payload_size;
+    p_sys->i_stats_date = VLC_TICK_INVALID;
 
     /* set maximum bandwidth limit*/
     srt_set_socket_option( access_obj, SRT_PARAM_BANDWIDTH_OVERHEAD_LIMIT,
@@ -247,7 +249,6 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
     int i_poll_timeout = var_InheritInteger( p_access, SRT_PARAM_POLL_TIMEOUT );
     bool b_interrupted = false;
     ssize_t i_len = 0;
-    int chunk_size;
     uint8_t chunk[SRT_LIVE_MAX_PLSIZE];
 
     if ( p_buffer == NULL )
@@ -258,12 +259,7 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
 
     while( true )
     {
-        /* We can leave the remaining bytes less than i_payload_size for next
-         * Write() round, but it will add delay.
-         */
-        chunk_size = __MIN( block_BytestreamRemaining( &p_sys->block_stream ),
-                            p_sys->i_payload_size );
-        if ( chunk_size == 0 )
+        if ( block_BytestreamRemaining( &p_sys->block_stream ) == 0 )
             break;
 
         if ( vlc_killed() )
@@ -332,20 +328,34 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
         if ( readycnt > 0  && ready[0] == p_sys->sock
             && srt_getsockstate( p_sys->sock ) == SRTS_CONNECTED)
         {
-            if ( block_GetBytes( &p_sys->block_stream, chunk,
-                                 chunk_size ) != VLC_SUCCESS )
-                break;
-            if (srt_sendmsg2( p_sys->sock,
-                (char *)chunk, chunk_size, 0 ) == SRT_ERROR )
-            {
-                msg_Warn( p_access, "send error: %s", srt_getlasterror_str() );
-                i_len = VLC_EGENERIC;
-                goto out;
-            }
-            else
+            /* Send as many payloads as the socket accepts before waiting
+             * again. We can leave the remaining bytes less than
+             * i_payload_size for next Write() round, but it will add delay.
+             */
+            size_t chunk_size;
+            while ( ( chunk_size = __MIN(
+                        block_BytestreamRemaining( &p_sys->block_stream ),
+                        p_sys->i_payload_size ) ) > 0 )
             {
+                if ( block_PeekBytes( &p_sys->block_stream, chunk,
+                                      chunk_size ) != VLC_SUCCESS )
+                    break;
+                if ( srt_sendmsg2( p_sys->sock,
+                    (char *)chunk, chunk_size, 0 ) == SRT_ERROR )
+                {
+                    /* The send buffer is full, wait for room */
+                    if ( srt_getlasterror( NULL ) == SRT_EASYNCSND )
+                        break;
+                    msg_Warn( p_access, "send error: %s",
+                              srt_getlasterror_str() );
+                    i_len = VLC_EGENERIC;
+                    goto out;
+                }
+                block_SkipBytes( &p_sys->block_stream, chunk_size );
                 i_len += chunk_size;
             }
+            srt_log_stats( VLC_OBJECT(p_access), p_sys->sock, true,
+                           &p_sys->i_stats_date );
         }
     }
 
@@ -0,0 +1,502 @@
+/*****************************************************************************
+ * biquad.c : cascaded and parallel biquad filters for audio filters
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* The frames are processed by chunks copied in a buffer where each frame is
+ * padded to a whole number of SIMD vectors. Each section then runs over the
+ * chunk with its history held in registers. Coefficients are constant
+ * within a chunk and move linearly towards their target between chunks:
+ * the stability domain of a biquad is convex, so the filters in between
+ * two stable ones stay stable. */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+
+#if defined(CAN_COMPILE_SSE2) || defined(CAN_COMPILE_AVX2)
+# include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+# include <arm_neon.h>
+#endif
+
+#include "biquad.h"
+
+#define BIQUAD_CHUNK 32 /* frames */
+
+struct vlc_biquad_section
+{
+    vlc_biquad_coeffs cur;
+    vlc_biquad_coeffs target;
+    vlc_biquad_coeffs step;
+    unsigned ramp_left; /* chunks */
+    bool set;
+};
+
+struct vlc_biquad
+{
+    unsigned channels;
+    unsigned stride;      /* channels padded to the vector width */
+    unsigned ramp;        /* chunks */
+    unsigned sections;
+    void   (*run)( const float *, float *, bool, unsigned, unsigned,
+                   const vlc_biquad_coeffs *, float * );
+    float   *state;       /* x[n-1], x[n-2], y[n-1], y[n-2] per section */
+    float   *lanes;       /* padded input chunk */
+    float   *acc;         /* padded output chunk of the bank */
+    struct vlc_biquad_section s[];
+};
+
+/*****************************************************************************
+ * section: run one section over a padded chunk, in place or added to out
+ *****************************************************************************/
+static void section_c( const float *in, float *out, bool add,
+                       unsigned frames, unsigned stride,
+                       const vlc_biquad_coeffs *c, float *state )
+{
+    for( unsigned ch = 0; ch < stride; ch++ )
+    {
+        float x1 = state[ch], x2 = state[stride + ch];
+        float y1 = state[2 * stride + ch], y2 = state[3 * stride + ch];
+
+        for( unsigned i = 0; i < frames; i++ )
+        {
+            const float x = in[i * stride + ch];
+            const float y = c->b0 * x + c->b1 * x1 + c->b2 * x2
+                          - c->a1 * y1 - c->a2 * y2;
+            x2 = x1; x1 = x;
+            y2 = y1; y1 = y;
+            out[i * stride + ch] = add ? out[i * stride + ch] + y : y;
+        }
+
+        state[ch] = x1; state[stride + ch] = x2;
+        state[2 * stride + ch] = y1; state[3 * stride + ch] = y2;
+    }
+}
+
+#ifdef CAN_COMPILE_SSE2
+#define VLC_SSE2 __attribute__ ((__target__ ("sse2")))
+
+VLC_SSE2
+static void section_sse2( const float *in, float *out, bool add,
+                          unsigned frames, unsigned stride,
+                          const vlc_biquad_coeffs *c, float *state )
+{
+    const __m128 b0 = _mm_set1_ps( c->b0 ), b1 = _mm_set1_ps( c->b1 );
+    const __m128 b2 = _mm_set1_ps( c->b2 );
+    const __m128 a1 = _mm_set1_ps( c->a1 ), a2 = _mm_set1_ps( c->a2 );
+
+    for( unsigned ch = 0; ch < stride; ch += 4 )
+    {
+        __m128 x1 = _mm_loadu_ps( &state[ch] );
+        __m128 x2 = _mm_loadu_ps( &state[stride + ch] );
+        __m128 y1 = _mm_loadu_ps( &state[2 * stride + ch] );
+        __m128 y2 = _mm_loadu_ps( &state[3 * stride + ch] );
+
+        for( unsigned i = 0; i < frames; i++ )
+        {
+            const __m128 x = _mm_loadu_ps( &in[i * stride + ch] );
+            __m128 y = _mm_add_ps( _mm_mul_ps( b0, x ), _mm_mul_ps( b1, x1 ) );
+            y = _mm_add_ps( y, _mm_mul_ps( b2, x2 ) );
+            y = _mm_sub_ps( y, _mm_mul_ps( a1, y1 ) );
+            y = _mm_sub_ps( y, _mm_mul_ps( a2, y2 ) );
+            x2 = x1; x1 = x;
+            y2 = y1; y1 = y;
+            if( add )
+                y = _mm_add_ps( y, _mm_loadu_ps( &out[i * stride + ch] ) );
+            _mm_storeu_ps( &out[i * stride + ch], y );
+        }
+
+        _mm_storeu_ps( &state[ch], x1 );
+        _mm_storeu_ps( &state[stride + ch], x2 );
+        _mm_storeu_ps( &state[2 * stride + ch], y1 );
+        _mm_storeu_ps( &state[3 * stride + ch], y2 );
+    }
+}
+#endif
+
+#ifdef CAN_COMPILE_AVX2
+#define VLC_AVX2 __attribute__ ((__target__ ("avx2")))
+
+VLC_AVX2
+static void section_avx2( const float *in, float *out, bool add,
+                          unsigned frames, unsigned stride,
+                          const vlc_biquad_coeffs *c, float *state )
+{
+    const __m256 b0 = _mm256_set1_ps( c->b0 ), b1 = _mm256_set1_ps( c->b1 );
+    const __m256 b2 = _mm256_set1_ps( c->b2 );
+    const __m256 a1 = _mm256_set1_ps( c->a1 ), a2 = _mm256_set1_ps( c->a2 );
+
+    for( unsigned ch = 0; ch < stride; ch += 8 )
+    {
+        __m256 x1 = _mm256_loadu_ps( &state[ch] );
+        __m256 x2 = _mm256_loadu_ps( &state[stride + ch] );
+        __m256 y1 = _mm256_loadu_ps( &state[2 * stride + ch] );
+        __m256 y2 = _mm256_loadu_ps( &state[3 * stride + ch] );
+
+        for( unsigned i = 0; i < frames; i++ )
+        {
+            const __m256 x = _mm256_loadu_ps( &in[i * stride + ch] );
+            __m256 y = _mm256_add_ps( _mm256_mul_ps( b0, x ),
+                                      _mm256_mul_ps( b1, x1 ) );
+            y = _mm256_add_ps( y, _mm256_mul_ps( b2, x2 ) );
+            y = _mm256_sub_ps( y, _mm256_mul_ps( a1, y1 ) );
+            y = _mm256_sub_ps( y, _mm256_mul_ps( a2, y2 ) );
+            x2 = x1; x1 = x;
+            y2 = y1; y1 = y;
+            if( add )
+                y = _mm256_add_ps( y, _mm256_loadu_ps( &out[i * stride + ch] ) );
+            _mm256_storeu_ps( &out[i * stride + ch], y );
+        }
+
+        _mm256_storeu_ps( &state[ch], x1 );
+        _mm256_storeu_ps( &state[stride + ch], x2 );
+        _mm256_storeu_ps( &state[2 * stride + ch], y1 );
+        _mm256_storeu_ps( &state[3 * stride + ch], y2 );
+    }
+}
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+static void section_neon( const float *in, float *out, bool add,
+                          unsigned frames, unsigned stride,
+                          const vlc_biquad_coeffs *c, float *state )
+{
+    const float32x4_t b0 = vdupq_n_f32( c->b0 ), b1 = vdupq_n_f32( c->b1 );
+    const float32x4_t b2 = vdupq_n_f32( c->b2 );
+    const float32x4_t a1 = vdupq_n_f32( c->a1 ), a2 = vdupq_n_f32( c->a2 );
+
+    for( unsigned ch = 0; ch < stride; ch += 4 )
+    {
+        float32x4_t x1 = vld1q_f32( &state[ch] );
+        float32x4_t x2 = vld1q_f32( &state[stride + ch] );
+        float32x4_t y1 = vld1q_f32( &state[2 * stride + ch] );
+        float32x4_t y2 = vld1q_f32( &state[3 * stride + ch] );
+
+        for( unsigned i = 0; i < frames; i++ )
+        {
+            const float32x4_t x = vld1q_f32( &in[i * stride + ch] );
+            float32x4_t y = vmulq_f32( b0, x );
+            y = vfmaq_f32( y, b1, x1 );
+            y = vfmaq_f32( y, b2, x2 );
+            y = vfmsq_f32( y, a1, y1 );
+            y = vfmsq_f32( y, a2, y2 );
+            x2 = x1; x1 = x;
+            y2 = y1; y1 = y;
+            if( add )
+                y = vaddq_f32( y, vld1q_f32( &out[i * stride + ch] ) );
+            vst1q_f32( &out[i * stride + ch], y );
+        }
+
+        vst1q_f32( &state[ch], x1 );
+        vst1q_f32( &state[stride + ch], x2 );
+        vst1q_f32( &state[2 * stride + ch], y1 );
+        vst1q_f32( &state[3 * stride + ch], y2 );
+    }
+}
+#endif
+
+vlc_biquad *vlc_biquad_New( unsigned sections, unsigned channels,
+                            unsigned ramp )
+{
+    if( channels == 0 )
+        return NULL;
+
+    vlc_biquad *bq = malloc( sizeof(*bq) + sections * sizeof(bq->s[0]) );
+    if( unlikely(bq == NULL) )
+        return NULL;
+
+    unsigned lanes = 1;
+    bq->run = section_c;
+#ifdef CAN_COMPILE_SSE2
+    if( vlc_CPU_SSE2() )
+    {
+        bq->run = section_sse2;
+        lanes = 4;
+    }
+#endif
+#ifdef CAN_COMPILE_AVX2
+    /* Wider vectors would only add padding to stereo */
+    if( vlc_CPU_AVX2() && channels > 4 )
+    {
+        bq->run = section_avx2;
+        lanes = 8;
+    }
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    if( vlc_CPU_ARM_NEON() )
+    {
+        bq->run = section_neon;
+        lanes = 4;
+    }
+#endif
+
+    bq->channels = channels;
+    bq->stride = ( channels + lanes - 1 ) / lanes * lanes;
+    bq->ramp = ( ramp + BIQUAD_CHUNK - 1 ) / BIQUAD_CHUNK;
+    bq->sections = sections;
+
+    /* The padding lanes are only ever fed with zeros */
+    bq->state = calloc( ( 4 * sections + 2 * BIQUAD_CHUNK ) * bq->stride,
+                        sizeof(float) );
+    if( unlikely(bq->state == NULL) )
+    {
+        free( bq );
+        return NULL;
+    }
+    bq->lanes = bq->state + 4 * sections * bq->stride;
+    bq->acc = bq->lanes + BIQUAD_CHUNK * bq->stride;
+
+    for( unsigned i = 0; i < sections; i++ )
+    {
+        /* Pass through until the section is set */
+        bq->s[i].cur = bq->s[i].target = (vlc_biquad_coeffs) { .b0 = 1.f };
+        bq->s[i].ramp_left = 0;
+        bq->s[i].set = false;
+    }
+    return bq;
+}
+
+void vlc_biquad_Delete( vlc_biquad *bq )
+{
+    free( bq->state );
+    free( bq );
+}
+
+void vlc_biquad_SetCoeffs( vlc_biquad *bq, unsigned section,
+                           const vlc_biquad_coeffs *c )
+{
+    assert( section < bq->sections );
+    struct vlc_biquad_section *s = &bq->s[section];
+
+    s->target = *c;
+    if( !s->set || bq->ramp == 0 )
+    {
+        s->cur = *c;
+        s->ramp_left = 0;
+        s->set = true;
+        return;
+    }
+
+    const float r = 1.f / bq->ramp;
+    s->step = (vlc_biquad_coeffs) {
+        .b0 = ( c->b0 - s->cur.b0 ) * r,
+        .b1 = ( c->b1 - s->cur.b1 ) * r,
+        .b2 = ( c->b2 - s->cur.b2 ) * r,
+        .a1 = ( c->a1 - s->cur.a1 ) * r,
+        .a2 = ( c->a2 - s->cur.a2 ) * r,
+    };
+    s->ramp_left = bq->ramp;
+}
+
+void vlc_biquad_Reset( vlc_biquad *bq )
+{
+    memset( bq->state, 0, 4 * bq->sections * bq->stride * sizeof(float) );
+    for( unsigned i = 0; i < bq->sections; i++ )
+    {
+        bq->s[i].cur = bq->s[i].target;
+        bq->s[i].ramp_left = 0;
+    }
+}
+
+static void Ramp( vlc_biquad *bq )
+{
+    for( unsigned i = 0; i < bq->sections; i++ )
+    {
+        struct vlc_biquad_section *s = &bq->s[i];
+        if( s->ramp_left == 0 )
+            continue;
+
+        if( --s->ramp_left == 0 )
+            s->cur = s->target;
+        else
+        {
+            s->cur.b0 += s->step.b0;
+            s->cur.b1 += s->step.b1;
+            s->cur.b2 += s->step.b2;
+            s->cur.a1 += s->step.a1;
+            s->cur.a2 += s->step.a2;
+        }
+    }
+}
+
+static void Load( const vlc_biquad *bq, const float *in, unsigned frames )
+{
+    if( bq->stride == bq->channels )
+        memcpy( bq->lanes, in, frames * bq->channels * sizeof(float) );
+    else
+        for( unsigned i = 0; i < frames; i++ )
+            memcpy( &bq->lanes[i * bq->stride], &in[i * bq->channels],
+                    bq->channels * sizeof(float) );
+}
+
+static void Store( const vlc_biquad *bq, float *out, const float *lanes,
+                   unsigned frames )
+{
+    if( bq->stride == bq->channels )
+        memcpy( out, lanes, frames * bq->channels * sizeof(float) );
+    else
+        for( unsigned i = 0; i < frames; i++ )
+            memcpy( &out[i * bq->channels], &lanes[i * bq->stride],
+                    bq->channels * sizeof(float) );
+}
+
+void vlc_biquad_Cascade( vlc_biquad *bq, const float *in, float *out,
+                         unsigned frames )
+{
+    const unsigned state_size = 4 * bq->stride;
+
+    while( frames > 0 )
+    {
+        const unsigned n = __MIN( frames, BIQUAD_CHUNK );
+
+        Ramp( bq );
+        Load( bq, in, n );
+        for( unsigned i = 0; i < bq->sections; i++ )
+            bq->run( bq->lanes, bq->lanes, false, n, bq->stride,
+                     &bq->s[i].cur, &bq->state[i * state_size] );
+        Store( bq, out, bq->lanes, n );
+
+        in += n * bq->channels;
+        out += n * bq->channels;
+        frames -= n;
+    }
+}
+
+void vlc_biquad_Bank( vlc_biquad *bq, const float *in, float *out,
+                      unsigned frames )
+{
+    const unsigned state_size = 4 * bq->stride;
+
+    if( bq->sections == 0 )
+    {
+        memset( out, 0, frames * bq->channels * sizeof(float) );
+        return;
+    }
+
+    while( frames > 0 )
+    {
+        const unsigned n = __MIN( frames, BIQUAD_CHUNK );
+
+        Ramp( bq );
+        Load( bq, in, n );
+        for( unsigned i = 0; i < bq->sections; i++ )
+            bq->run( bq->lanes, bq->acc, i > 0, n, bq->stride,
+                     &bq->s[i].cur, &bq->state[i * state_size] );
+        Store( bq, out, bq->acc, n );
+
+        in += n * bq->channels;
+        out += n * bq->channels;
+        frames -= n;
+    }
+}
+
+/*****************************************************************************
+ * Designs, equations taken from RBJ audio EQ cookbook
+ * (http://www.musicdsp.org/files/Audio-EQ-Cookbook.txt)
+ *****************************************************************************/
+static void Normalize( vlc_biquad_coeffs *c, float b0, float b1, float b2,
+                       float a0, float a1, float a2 )
+{
+    c->b0 = b0 / a0;
+    c->b1 = b1 / a0;
+    c->b2 = b2 / a0;
+    c->a1 = a1 / a0;
+    c->a2 = a2 / a0;
+}
+
+void vlc_biquad_PeakEQ( vlc_biquad_coeffs *c, float f0, float Q, float gain,
+                        float rate )
+{
+    // Provide sane limits to avoid overflow
+    Q = VLC_CLIP( Q, 0.1f, 100.f );
+    f0 = __MIN( f0, rate / 2 * 0.95f );
+    gain = VLC_CLIP( gain, -40.f, 40.f );
+
+    const float A = powf( 10, gain / 40 );
+    const float w0 = 2 * (float) M_PI * f0 / rate;
+    const float alpha = sinf( w0 ) / ( 2 * Q );
+    const float cosw = cosf( w0 );
+
+    Normalize( c, 1 + alpha * A, -2 * cosw, 1 - alpha * A,
+                  1 + alpha / A, -2 * cosw, 1 - alpha / A );
+}
+
+static void Shelf( vlc_biquad_coeffs *c, float f0, float slope, float gain,
+                   bool high, float rate )
+{
+    // Provide sane limits to avoid overflow
+    f0 = __MIN( f0, rate / 2 * 0.95f );
+    gain = VLC_CLIP( gain, -40.f, 40.f );
+
+    const float A = powf( 10, gain / 40 );
+    const float w0 = 2 * (float) M_PI * f0 / rate;
+    const float alpha = sinf( w0 ) / 2
+                      * sqrtf( ( A + 1 / A ) * ( 1 / slope - 1 ) + 2 );
+    const float cosw = cosf( w0 );
+    const float sqa = 2 * sqrtf( A ) * alpha;
+
+    if( high )
+        Normalize( c,    A * ( ( A + 1 ) + ( A - 1 ) * cosw + sqa ),
+                    -2 * A * ( ( A - 1 ) + ( A + 1 ) * cosw ),
+                         A * ( ( A + 1 ) + ( A - 1 ) * cosw - sqa ),
+                               ( A + 1 ) - ( A - 1 ) * cosw + sqa,
+                           2 * ( ( A - 1 ) - ( A + 1 ) * cosw ),
+                               ( A + 1 ) - ( A - 1 ) * cosw - sqa );
+    else
+        Normalize( c,    A * ( ( A + 1 ) - ( A - 1 ) * cosw + sqa ),
+                     2 * A * ( ( A - 1 ) - ( A + 1 ) * cosw ),
+                         A * ( ( A + 1 ) - ( A - 1 ) * cosw - sqa ),
+                               ( A + 1 ) + ( A - 1 ) * cosw + sqa,
+                          -2 * ( ( A - 1 ) + ( A + 1 ) * cosw ),
+                               ( A + 1 ) + ( A - 1 ) * cosw - sqa );
+}
+
+void vlc_biquad_LowShelf( vlc_biquad_coeffs *c, float f0, float slope,
+                          float gain, float rate )
+{
+    Shelf( c, f0, slope, gain, false, rate );
+}
+
+void vlc_biquad_HighShelf( vlc_biquad_coeffs *c, float f0, float slope,
+                           float gain, float rate )
+{
+    Shelf( c, f0, slope, gain, true, rate );
+}
+
+void vlc_biquad_HighPass( vlc_biquad_coeffs *c, float f0, float Q,
+                          float rate )
+{
+    Q = VLC_CLIP( Q, 0.1f, 100.f );
+    f0 = __MIN( f0, rate / 2 * 0.95f );
+
+    const float w0 = 2 * (float) M_PI * f0 / rate;
+    const float alpha = sinf( w0 ) / ( 2 * Q );
+    const float cosw = cosf( w0 );
+
+    Normalize( c, ( 1 + cosw ) / 2, -( 1 + cosw ), ( 1 + cosw ) / 2,
+                  1 + alpha, -2 * cosw, 1 - alpha );
+}
@@ -0,0 +1,72 @@
+/*****************************************************************************
+ * biquad.h : cascaded and parallel biquad filters for audio filters
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_AUDIO_FILTER_BIQUAD_H
+#define VLC_AUDIO_FILTER_BIQUAD_H
+
+/* Direct form 1 biquad sections run on interleaved FL32 frames:
+ *   y = b0*x + b1*x[n-1] + b2*x[n-2] - a1*y[n-1] - a2*y[n-2]
+ * The channels of a frame are processed together in SIMD lanes. New
+ * coefficients are reached progressively over the ramp given at creation,
+ * so that they can be changed while playing without clicks. */
+typedef struct
+{
+    float b0, b1, b2, a1, a2;
+} vlc_biquad_coeffs;
+
+typedef struct vlc_biquad vlc_biquad;
+
+/* ramp is the number of frames to reach new coefficients, 0 to apply them
+ * immediately */
+vlc_biquad *vlc_biquad_New( unsigned sections, unsigned channels,
+                            unsigned ramp );
+void vlc_biquad_Delete( vlc_biquad * );
+
+/* The coefficients of a section are applied immediately the first time */
+void vlc_biquad_SetCoeffs( vlc_biquad *, unsigned section,
+                           const vlc_biquad_coeffs * );
+/* Clears the history and jumps to the target coefficients */
+void vlc_biquad_Reset( vlc_biquad * );
+
+/* Runs the input through each section in turn */
+void vlc_biquad_Cascade( vlc_biquad *, const float *in, float *out,
+                         unsigned frames );
+/* Runs the input through all the sections and sums their outputs */
+void vlc_biquad_Bank( vlc_biquad *, const float *in, float *out,
+                      unsigned frames );
+
+/* RBJ audio EQ cookbook designs, gains in dB */
+void vlc_biquad_PeakEQ( vlc_biquad_coeffs *, float f0, float Q, float gain,
+                        float rate );
+void vlc_biquad_LowShelf( vlc_biquad_coeffs *, float f0, float slope,
+                          float gain, float rate );
+void vlc_biquad_HighShelf( vlc_biquad_coeffs *, float f0, float slope,
+                           float gain, float rate );
+void vlc_biquad_HighPass( vlc_biquad_coeffs *, float f0, float Q,
+                          float rate );
+
+/* Scales the output of a section */
+static inline void vlc_biquad_Scale( vlc_biquad_coeffs *c, float gain )
+{
+    c->b0 *= gain;
+    c->b1 *= gain;
+    c->b2 *= gain;
+}
+
+#endif
@@ -163,6 +163,9 @@ static inline uint32_t CanonicaliseChannels( uint32_t i_physical_channels )
 
 /*****************************************************************************
  * Remap*: do remapping
+ *****************************************************************************
+ * The source frame is copied before writing the destination one, so that
+ * the remapping can be done in place when the output frames are not larger.
  *****************************************************************************/
 #define DEFINE_REMAP( name, type ) \
 static void RemapCopy##name( filter_t *p_filter, \
@@ -173,16 +176,17 @@ static void RemapCopy##name( filter_t *p_filter, \
     filter_sys_t *p_sys = p_filter->p_sys; \
     const type *p_src = p_srcorig; \
     type *p_dest = p_destorig; \
+    type frame[AOUT_CHAN_MAX]; \
  \
     for( int i = 0; i < i_nb_samples; i++ ) \
     { \
+        memcpy( frame, p_src, i_nb_in_channels * sizeof( type ) ); \
+        memset( p_dest, 0, i_nb_out_channels * sizeof( type ) ); \
         for( uint8_t in_ch = 0; in_ch < i_nb_in_channels; in_ch++ ) \
         { \
             int8_t out_ch = p_sys->map_ch[ in_ch ]; \
             if (out_ch < 0) continue; \
-            memcpy( p_dest + out_ch, \
-                    p_src  + in_ch, \
-                    sizeof( type ) ); \
+            p_dest[ out_ch ] = frame[ in_ch ]; \
         } \
         p_src  += i_nb_in_channels; \
         p_dest += i_nb_out_channels; \
@@ -197,17 +201,20 @@ static void RemapAdd##name( filter_t *p_filter, \
     filter_sys_t *p_sys = p_filter->p_sys; \
     const type *p_src = p_srcorig; \
     type *p_dest = p_destorig; \
+    type frame[AOUT_CHAN_MAX]; \
  \
     for( int i = 0; i < i_nb_samples; i++ ) \
     { \
+        memcpy( frame, p_src, i_nb_in_channels * sizeof( type ) ); \
+        memset( p_dest, 0, i_nb_out_channels * sizeof( type ) ); \
         for( uint8_t in_ch = 0; in_ch < i_nb_in_channels; in_ch++ ) \
         { \
             int8_t out_ch = p_sys->map_ch[ in_ch ]; \
             if (out_ch < 0) continue; \
             if( p_sys->b_normalize ) \
-                p_dest[ out_ch ] += p_src[ in_ch ] / p_sys->nb_in_ch[ out_ch ]; \
+                p_dest[ out_ch ] += frame[ in_ch ] / p_sys->nb_in_ch[ out_ch ]; \
             else \
-                p_dest[ out_ch ] += p_src[ in_ch ]; \
+                p_dest[ out_ch ] += frame[ in_ch ]; \
         } \
         p_src  += i_nb_in_channels; \
         p_dest += i_nb_out_channels; \
@@ -392,27 +399,32 @@ static block_t *Remap( filter_t *p_filter, block_t *p_block )
     size_t i_out_size = p_block->i_nb_samples *
         p_filter->fmt_out.audio.i_bytes_per_frame;
 
-    block_t *p_out = block_Alloc( i_out_size );
-    if( !p_out )
+    /* Remap in place unless the output frames are larger */
+    block_t *p_out = p_block;
+    if( i_out_size > p_block->i_buffer )
     {
-        msg_Warn( p_filter, "can't get output buffer" );
-        block_Release( p_block );
-        return NULL;
+        p_out = block_Alloc( i_out_size );
+        if( !p_out )
+        {
+            msg_Warn( p_filter, "can't get output buffer" );
+            block_Release( p_block );
+            return NULL;
+        }
+        p_out->i_nb_samples = p_block->i_nb_samples;
+        p_out->i_dts = p_block->i_dts;
+        p_out->i_pts = p_block->i_pts;
+        p_out->i_length = p_block->i_length;
     }
-    p_out->i_nb_samples = p_block->i_nb_samples;
-    p_out->i_dts = p_block->i_dts;
-    p_out->i_pts = p_block->i_pts;
-    p_out->i_length = p_block->i_length;
-
-    memset( p_out->p_buffer, 0, i_out_size );
 
     p_sys->pf_remap( p_filter,
                 (const void *)p_block->p_buffer, (void *)p_out->p_buffer,
                 p_block->i_nb_samples,
                 p_filter->fmt_in.audio.i_channels,
                 p_filter->fmt_out.audio.i_channels );
+    p_out->i_buffer = i_out_size;
 
-    block_Release( p_block );
+    if( p_out != p_block )
+        block_Release( p_block );
 
     return p_out;
 }
@@ -76,6 +76,9 @@ vlc_module_end()
 
 #define AMB_MAX_ORDER 3
 
+/* Period of the rendering load report */
+#define AMB_LOAD_PERIOD VLC_TICK_FROM_SEC(10)
+
 struct filter_spatialaudio
 {
     filter_spatialaudio()
@@ -83,6 +86,9 @@ struct filter_spatialaudio
         , i_inputPTS(0)
         , inBuf(NULL)
         , outBuf(NULL)
+        , b_vpChanged(false)
+        , i_renderTime(0)
+        , i_renderSamples(0)
     {}
     ~filter_spatialaudio()
     {
@@ -113,6 +119,12 @@ struct filter_spatialaudio
 
     CAmbisonicSpeaker *speakers;
 
+    /* Sound field of the current block, and of the same block with the
+     * previous orientation while the viewpoint changes */
+    CBFormat bformat;
+    CBFormat prevBformat;
+    std::vector<float> fadeBuf;
+
     std::vector<float> inputSamples;
     vlc_tick_t i_inputPTS;
     unsigned i_order;
@@ -129,6 +141,11 @@ struct filter_spatialaudio
     float f_phi;
     float f_roll;
     float f_zoom;
+    bool b_vpChanged;
+
+    /* Rendering load */
+    vlc_tick_t i_renderTime;
+    unsigned i_renderSamples;
 };
 
 static std::string getHRTFPath(filter_t *p_filter)
@@ -155,6 +172,71 @@ static std::string getHRTFPath(filter_t *p_filter)
     return HRTFPath;
 }
 
+static void UpdateOrientation(filter_spatialaudio *p_sys)
+{
+    Orientation ori(p_sys->f_teta, p_sys->f_phi, p_sys->f_roll);
+    p_sys->processor.SetOrientation(ori);
+    p_sys->processor.Refresh();
+
+    p_sys->zoomer.SetZoom(p_sys->f_zoom);
+    p_sys->zoomer.Refresh();
+}
+
+/* Rotates the sound field, crossfading from the previous orientation over
+ * the block when the viewpoint changed. The rotation is linear, so fading
+ * the B-format is the same as fading the rendered output, at the cost of a
+ * second rotation instead of a second binaural convolution. */
+static void RotateSoundField(filter_spatialaudio *p_sys, unsigned i_channels)
+{
+    if (p_sys->b_vpChanged)
+    {
+        for (unsigned i = 0; i < i_channels; ++i)
+            p_sys->prevBformat.InsertStream(p_sys->inBuf[i], i, AMB_BLOCK_TIME_LEN);
+        p_sys->processor.Process(&p_sys->prevBformat, AMB_BLOCK_TIME_LEN);
+        p_sys->zoomer.Process(&p_sys->prevBformat, AMB_BLOCK_TIME_LEN);
+
+        UpdateOrientation(p_sys);
+    }
+
+    p_sys->processor.Process(&p_sys->bformat, AMB_BLOCK_TIME_LEN);
+    p_sys->zoomer.Process(&p_sys->bformat, AMB_BLOCK_TIME_LEN);
+
+    if (!p_sys->b_vpChanged)
+        return;
+    p_sys->b_vpChanged = false;
+
+    float *p_prev = p_sys->fadeBuf.data();
+    float *p_cur = p_prev + AMB_BLOCK_TIME_LEN;
+    const float f_step = 1.f / AMB_BLOCK_TIME_LEN;
+    for (unsigned i = 0; i < i_channels; ++i)
+    {
+        p_sys->prevBformat.ExtractStream(p_prev, i, AMB_BLOCK_TIME_LEN);
+        p_sys->bformat.ExtractStream(p_cur, i, AMB_BLOCK_TIME_LEN);
+        for (unsigned j = 0; j < AMB_BLOCK_TIME_LEN; ++j)
+            p_cur[j] = p_prev[j] + (p_cur[j] - p_prev[j]) * (j * f_step);
+        p_sys->bformat.InsertStream(p_cur, i, AMB_BLOCK_TIME_LEN);
+    }
+}
+
+static void ReportLoad(filter_t *p_filter, vlc_tick_t i_time, unsigned i_samples)
+{
+    filter_spatialaudio *p_sys = reinterpret_cast<filter_spatialaudio *>(p_filter->p_sys);
+
+    p_sys->i_renderTime += i_time;
+    p_sys->i_renderSamples += i_samples;
+
+    const vlc_tick_t i_played =
+        vlc_tick_from_samples(p_sys->i_renderSamples, p_filter->fmt_in.audio.i_rate);
+    if (i_played < AMB_LOAD_PERIOD)
+        return;
+
+    const float f_load = 100.f * p_sys->i_renderTime / i_played;
+    msg_Dbg(p_filter, "rendering load: %.2f%% of a core, %.2f%% per input channel",
+            f_load, f_load / p_sys->i_inputNb);
+    p_sys->i_renderTime = 0;
+    p_sys->i_renderSamples = 0;
+}
+
 static block_t *Mix( filter_t *p_filter, block_t *p_buf )
 {
     filter_spatialaudio *p_sys = reinterpret_cast<filter_spatialaudio *>(p_filter->p_sys);
@@ -184,6 +266,7 @@ static block_t *Mix( filter_t *p_filter, block_t *p_buf )
 
     float *p_dest = (float *)p_out_buf->p_buffer;
     const float *p_src = (float *)p_sys->inputSamples.data();
+    const vlc_tick_t i_start = vlc_tick_now();
 
     for (unsigned b = 0; b < i_nbBlocks; ++b)
     {
@@ -205,25 +288,16 @@ static block_t *Mix( filter_t *p_filter, block_t *p_buf )
             case filter_spatialaudio::AMBISONICS_DECODER:
             case filter_spatialaudio::AMBISONICS_BINAURAL_DECODER:
             {
-                CBFormat inData;
-                inData.Configure(p_sys->i_order, true, AMB_BLOCK_TIME_LEN);
-
-                for (unsigned i = 0; i < p_sys->i_inputNb - p_sys->i_nondiegetic; ++i)
-                    inData.InsertStream(p_sys->inBuf[i], i, AMB_BLOCK_TIME_LEN);
+                const unsigned i_channels = p_sys->i_inputNb - p_sys->i_nondiegetic;
+                for (unsigned i = 0; i < i_channels; ++i)
+                    p_sys->bformat.InsertStream(p_sys->inBuf[i], i, AMB_BLOCK_TIME_LEN);
 
-                Orientation ori(p_sys->f_teta, p_sys->f_phi, p_sys->f_roll);
-                p_sys->processor.SetOrientation(ori);
-                p_sys->processor.Refresh();
-                p_sys->processor.Process(&inData, inData.GetSampleCount());
-
-                p_sys->zoomer.SetZoom(p_sys->f_zoom);
-                p_sys->zoomer.Refresh();
-                p_sys->zoomer.Process(&inData, inData.GetSampleCount());
+                RotateSoundField(p_sys, i_channels);
 
                 if (p_sys->mode == filter_spatialaudio::AMBISONICS_DECODER)
-                    p_sys->speakerDecoder.Process(&inData, inData.GetSampleCount(), p_sys->outBuf);
+                    p_sys->speakerDecoder.Process(&p_sys->bformat, AMB_BLOCK_TIME_LEN, p_sys->outBuf);
                 else
-                    p_sys->binauralDecoder.Process(&inData, p_sys->outBuf);
+                    p_sys->binauralDecoder.Process(&p_sys->bformat, p_sys->outBuf);
                 break;
             }
             default:
@@ -250,6 +324,9 @@ static block_t *Mix( filter_t *p_filter, block_t *p_buf )
         }
     }
 
+    if (i_nbBlocks > 0)
+        ReportLoad(p_filter, vlc_tick_now() - i_start, p_out_buf->i_nb_samples);
+
     p_sys->inputSamples.erase(p_sys->inputSamples.begin(),
                               p_sys->inputSamples.begin() + i_inputBlockSize * i_nbBlocks / sizeof(float));
 
@@ -275,6 +352,10 @@ static void ChangeViewpoint( filter_t *p_filter, const vlc_viewpoint_t *p_vp)
     float yaw, pitch, roll;
     vlc_viewpoint_to_euler(p_vp, &yaw, &pitch, &roll);
 
+    /* The rotation is only updated by the next block, so that it can fade
+     * from the current orientation */
+    p_sys->b_vpChanged = true;
+
 #define RAD(d) ((float) ((d) * M_PI / 180.f))
     p_sys->f_teta = -RAD(yaw);
     p_sys->f_phi = RAD(pitch);
@@ -545,6 +626,24 @@ static int Open(vlc_object_t *p_this)
         delete p_sys;
         return VLC_EGENERIC;
     }
+    UpdateOrientation(p_sys);
+
+    if (!p_sys->bformat.Configure(p_sys->i_order, true, AMB_BLOCK_TIME_LEN)
+     || !p_sys->prevBformat.Configure(p_sys->i_order, true, AMB_BLOCK_TIME_LEN))
+    {
+        delete p_sys;
+        return VLC_ENOMEM;
+    }
+
+    try
+    {
+        p_sys->fadeBuf.resize(2 * AMB_BLOCK_TIME_LEN);
+    }
+    catch (const std::bad_alloc &)
+    {
+        delete p_sys;
+        return VLC_ENOMEM;
+    }
 
     p_filter->p_sys = p_sys;
     p_filter->ops = &filter_ops.ops;
@@ -38,6 +38,8 @@
 #include <vlc_aout.h>
 #include <vlc_filter.h>
 
+#include "biquad.h"
+
 /*****************************************************************************
 * Local prototypes.
 *****************************************************************************/
@@ -105,6 +107,13 @@ typedef struct
     float f_ratio;
     float f_knee;
     float f_makeup_gain;
+    float f_sidechain_hpf;
+
+    /* High-pass filtered copy of the input driving the envelopes */
+    vlc_biquad *p_sidechain;
+    float f_sidechain_freq;
+    float *pf_sidechain;
+    unsigned i_sidechain_size;
 } filter_sys_t;
 
 typedef union
@@ -117,6 +126,7 @@ typedef union
 static int      Open            ( vlc_object_t * );
 static void     Close           ( filter_t * );
 static block_t *DoWork          ( filter_t *, block_t * );
+static const float *SidechainProcess( filter_t *, block_t *, float );
 
 static void     DbInit          ( filter_sys_t * );
 static float    Db2Lin          ( float, filter_sys_t * );
@@ -146,6 +156,8 @@ static int KneeCallback         ( vlc_object_t *, char const *, vlc_value_t,
                                   vlc_value_t, void * );
 static int MakeupGainCallback   ( vlc_object_t *, char const *, vlc_value_t,
                                   vlc_value_t, void * );
+static int SidechainHPFCallback ( vlc_object_t *, char const *, vlc_value_t,
+                                  vlc_value_t, void * );
 
 /*****************************************************************************
  * Module descriptor
@@ -172,6 +184,11 @@ static int MakeupGainCallback   ( vlc_object_t *, char const *, vlc_value_t,
 #define MAKEUP_GAIN_TEXT N_( "Makeup gain" )
 #define MAKEUP_GAIN_LONGTEXT N_( "Set the makeup gain in dB (0 ... 24)." )
 
+#define SIDECHAIN_HPF_TEXT N_( "Sidechain high-pass" )
+#define SIDECHAIN_HPF_LONGTEXT N_( "Set the cutoff frequency in Hz of " \
+    "the high-pass filter applied to the level detection, so that the " \
+    "bass does not drive the compression (0 to disable)." )
+
 vlc_module_begin()
     set_shortname( N_("Compressor") )
     set_description( N_("Dynamic range compressor") )
@@ -192,6 +209,8 @@ vlc_module_begin()
                KNEE_TEXT, KNEE_LONGTEXT )
     add_float_with_range( "compressor-makeup-gain", 7.0, 0.0, 24.0,
                MAKEUP_GAIN_TEXT, MAKEUP_GAIN_LONGTEXT )
+    add_float_with_range( "compressor-sidechain-hpf", 0.0, 0.0, 500.0,
+               SIDECHAIN_HPF_TEXT, SIDECHAIN_HPF_LONGTEXT )
     set_callback( Open )
     add_shortcut( "compressor" )
 vlc_module_end ()
@@ -229,6 +248,16 @@ static int Open( vlc_object_t *p_this )
     /* Initialize decibel lookup tables */
     DbInit( p_sys );
 
+    /* The sidechain filter moves to new frequencies within 20ms */
+    p_sys->p_sidechain =
+        vlc_biquad_New( 1, aout_FormatNbChannels( &p_filter->fmt_in.audio ),
+                        0.02f * f_sample_rate );
+    if( !p_sys->p_sidechain )
+    {
+        free( p_sys );
+        return VLC_ENOMEM;
+    }
+
     /* Restore the last saved settings */
     p_sys->f_rms_peak    = var_CreateGetFloat( p_aout, "compressor-rms-peak" );
     p_sys->f_attack      = var_CreateGetFloat( p_aout, "compressor-attack" );
@@ -238,6 +267,8 @@ static int Open( vlc_object_t *p_this )
     p_sys->f_knee        = var_CreateGetFloat( p_aout, "compressor-knee" );
     p_sys->f_makeup_gain =
            var_CreateGetFloat( p_aout, "compressor-makeup-gain" );
+    p_sys->f_sidechain_hpf =
+           var_CreateGetFloat( p_aout, "compressor-sidechain-hpf" );
 
     /* Initialize the mutex */
     vlc_mutex_init( &p_sys->lock );
@@ -250,6 +281,7 @@ static int Open( vlc_object_t *p_this )
     var_AddCallback( p_aout, "compressor-ratio", RatioCallback, p_sys );
     var_AddCallback( p_aout, "compressor-knee", KneeCallback, p_sys );
     var_AddCallback( p_aout, "compressor-makeup-gain", MakeupGainCallback, p_sys );
+    var_AddCallback( p_aout, "compressor-sidechain-hpf", SidechainHPFCallback, p_sys );
 
     /* Set the filter function */
     p_filter->fmt_in.audio.i_format = VLC_CODEC_FL32;
@@ -284,11 +316,58 @@ static void Close( filter_t *p_filter )
     var_DelCallback( p_aout, "compressor-ratio", RatioCallback, p_sys );
     var_DelCallback( p_aout, "compressor-knee", KneeCallback, p_sys );
     var_DelCallback( p_aout, "compressor-makeup-gain", MakeupGainCallback, p_sys );
+    var_DelCallback( p_aout, "compressor-sidechain-hpf", SidechainHPFCallback, p_sys );
 
     /* Destroy the filter parameter structure */
+    vlc_biquad_Delete( p_sys->p_sidechain );
+    free( p_sys->pf_sidechain );
     free( p_sys );
 }
 
+/*****************************************************************************
+ * SidechainProcess: high-pass the input for the level detection
+ *****************************************************************************/
+
+static const float *SidechainProcess( filter_t *p_filter, block_t *p_block,
+                                      float f_freq )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const float *pf_in = (const float *)p_block->p_buffer;
+    const unsigned i_samples = p_block->i_nb_samples;
+
+    if( f_freq <= 0.0f )
+    {
+        p_sys->f_sidechain_freq = 0.0f;
+        return pf_in;
+    }
+
+    if( i_samples > p_sys->i_sidechain_size )
+    {
+        float *pf_buf = vlc_reallocarray( p_sys->pf_sidechain, i_samples *
+                    aout_FormatNbChannels( &p_filter->fmt_in.audio ),
+                    sizeof(float) );
+        if( !pf_buf )
+            return pf_in;
+        p_sys->pf_sidechain = pf_buf;
+        p_sys->i_sidechain_size = i_samples;
+    }
+
+    if( f_freq != p_sys->f_sidechain_freq )
+    {
+        vlc_biquad_coeffs coeffs;
+        vlc_biquad_HighPass( &coeffs, f_freq, M_SQRT1_2,
+                             p_filter->fmt_in.audio.i_rate );
+        vlc_biquad_SetCoeffs( p_sys->p_sidechain, 0, &coeffs );
+        if( p_sys->f_sidechain_freq == 0.0f )
+            vlc_biquad_Reset( p_sys->p_sidechain );
+        p_sys->f_sidechain_freq = f_freq;
+    }
+
+    vlc_biquad_Cascade( p_sys->p_sidechain, pf_in, p_sys->pf_sidechain,
+                        i_samples );
+    return p_sys->pf_sidechain;
+}
+
 /*****************************************************************************
  * DoWork: process samples buffer
  *****************************************************************************/
@@ -312,9 +391,13 @@ static block_t * DoWork( filter_t * p_filter, block_t * p_in_buf )
     float f_ratio       = p_sys->f_ratio;        /* Ratio (n:1) */
     float f_knee        = p_sys->f_knee;         /* Knee radius (dB) */
     float f_makeup_gain = p_sys->f_makeup_gain;  /* Makeup gain (dB) */
+    float f_sidechain   = p_sys->f_sidechain_hpf;/* Sidechain cutoff (Hz) */
 
     vlc_mutex_unlock( &p_sys->lock );
 
+    /* Detect the level on the filtered sidechain if enabled */
+    const float *pf_lev = SidechainProcess( p_filter, p_in_buf, f_sidechain );
+
     /* Fetch the internal parameters */
     float f_amp      =  p_sys->f_amp;
     float *pf_as     =  p_sys->pf_as;
@@ -351,10 +434,10 @@ static block_t * DoWork( filter_t * p_filter, block_t * p_in_buf )
 
         /* Find the peak value of current sample.  This becomes the new delayed
          * buffer value that replaces the old one in the lookahead array */
-        f_lev_in_new = fabs( pf_buf[0] );
+        f_lev_in_new = fabs( pf_lev[0] );
         for( int i_chan = 1; i_chan < i_channels; i_chan++ )
         {
-            f_lev_in_new = Max( f_lev_in_new, fabs( pf_buf[i_chan] ) );
+            f_lev_in_new = Max( f_lev_in_new, fabs( pf_lev[i_chan] ) );
         }
         p_la->p_buf[p_la->i_pos].f_lev_in = f_lev_in_new;
 
@@ -427,6 +510,7 @@ static block_t * DoWork( filter_t * p_filter, block_t * p_in_buf )
         /* Write the resulting buffer to the output */
         BufferProcess( pf_buf, i_channels, f_gain, f_mug, p_la );
         pf_buf += i_channels;
+        pf_lev += i_channels;
     }
 
     /* Update the internal parameters */
@@ -725,3 +809,17 @@ static int MakeupGainCallback( vlc_object_t *p_this, char const *psz_cmd,
 
     return VLC_SUCCESS;
 }
+
+static int SidechainHPFCallback( vlc_object_t *p_this, char const *psz_cmd,
+                                 vlc_value_t oldval, vlc_value_t newval,
+                                 void * p_data )
+{
+    VLC_UNUSED(p_this); VLC_UNUSED(psz_cmd); VLC_UNUSED(oldval);
+    filter_sys_t *p_sys = p_data;
+
+    vlc_mutex_lock( &p_sys->lock );
+    p_sys->f_sidechain_hpf = Clamp( newval.f_float, 0.0f, 500.0f );
+    vlc_mutex_unlock( &p_sys->lock );
+
+    return VLC_SUCCESS;
+}
@@ -34,20 +34,32 @@
 #include <assert.h>
 
 #include <vlc_common.h>
+#include <vlc_cpu.h>
 #include <vlc_plugin.h>
 #include <vlc_aout.h>
 #include <vlc_block.h>
 #include <vlc_filter.h>
+#include <vlc_rand.h>
+
+#if defined(CAN_COMPILE_SSE2) || defined(CAN_COMPILE_AVX2)
+# include <immintrin.h>
+#endif
 
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
 static int  Open(vlc_object_t *);
 
+#define DITHER_TEXT N_("Dither to 16-bits")
+#define DITHER_LONGTEXT N_( \
+    "Add triangular noise when converting floating point samples to 16-bits " \
+    "integers, trading the quantization distortion for a constant noise floor.")
+
 vlc_module_begin()
     set_description(N_("Audio filter for PCM format conversion"))
     set_subcategory(SUBCAT_AUDIO_AFILTER)
     set_capability("audio converter", 1)
+    add_bool("audio-dither", false, DITHER_TEXT, DITHER_LONGTEXT)
     set_callback(Open)
 vlc_module_end()
 
@@ -57,6 +69,9 @@ vlc_module_end()
 
 typedef block_t *(*cvt_t)(filter_t *, block_t *);
 static const struct vlc_filter_operations *FindConversion(vlc_fourcc_t src, vlc_fourcc_t dst);
+static const struct vlc_filter_operations *FindOptimized(filter_t *,
+                                                         vlc_fourcc_t src,
+                                                         vlc_fourcc_t dst);
 
 static int Open(vlc_object_t *object)
 {
@@ -70,7 +85,10 @@ static int Open(vlc_object_t *object)
     if (src->i_codec == dst->i_codec)
         return VLC_EGENERIC;
 
-    const struct vlc_filter_operations *filter_ops = FindConversion(src->i_codec, dst->i_codec);
+    const struct vlc_filter_operations *filter_ops =
+        FindOptimized(filter, src->i_codec, dst->i_codec);
+    if (filter_ops == NULL)
+        filter_ops = FindConversion(src->i_codec, dst->i_codec);
     if (filter_ops == NULL)
         return VLC_EGENERIC;
 
@@ -485,3 +503,179 @@ static const struct vlc_filter_operations *FindConversion(vlc_fourcc_t src, vlc_
     }
     return NULL;
 }
+
+/*** Dithering ***/
+typedef struct
+{
+    uint32_t seed;
+} filter_sys_t;
+
+/* Triangular noise of one LSB amplitude, from two uniform draws */
+static inline float Dither(filter_sys_t *sys)
+{
+    uint32_t a = sys->seed = sys->seed * 1664525 + 1013904223;
+    uint32_t b = sys->seed = sys->seed * 1664525 + 1013904223;
+    return ((int_fast32_t)(a >> 16) - (int_fast32_t)(b >> 16)) * 0x1.p-16f;
+}
+
+static block_t *Fl32toS16Dither(filter_t *filter, block_t *b)
+{
+    filter_sys_t *sys = filter->p_sys;
+    float   *src = (float *)b->p_buffer;
+    int16_t *dst = (int16_t *)src;
+    for (size_t i = b->i_buffer / 4; i--;) {
+        const float v = *src++ * 32768.f + Dither(sys);
+        if (v >= 32767.f)
+            *dst++ = 32767;
+        else if (v < -32768.f)
+            *dst++ = -32768;
+        else
+            *dst++ = lrintf(v);
+    }
+    b->i_buffer /= 2;
+    return b;
+}
+
+static block_t *Fl64toS16Dither(filter_t *filter, block_t *b)
+{
+    filter_sys_t *sys = filter->p_sys;
+    double  *src = (double *)b->p_buffer;
+    int16_t *dst = (int16_t *)src;
+    for (size_t i = b->i_buffer / 8; i--;) {
+        const double v = *src++ * 32768. + Dither(sys);
+        if (v >= 32767.)
+            *dst++ = 32767;
+        else if (v < -32768.)
+            *dst++ = -32768;
+        else
+            *dst++ = lrint(v);
+    }
+    b->i_buffer /= 4;
+    return b;
+}
+
+static const struct vlc_filter_operations Fl32toS16Dither_ops = {
+    .filter_audio = Fl32toS16Dither,
+};
+
+static const struct vlc_filter_operations Fl64toS16Dither_ops = {
+    .filter_audio = Fl64toS16Dither,
+};
+
+/*** SIMD ***/
+/* The destination samples are never larger than the source ones, so that the
+ * output of a vector never overlaps the input samples not read yet. */
+#ifdef CAN_COMPILE_SSE2
+#define VLC_SSE2 __attribute__ ((__target__ ("sse2")))
+
+VLC_SSE2
+static block_t *Fl32toS16SSE2(filter_t *filter, block_t *b)
+{
+    VLC_UNUSED(filter);
+    const __m128 scale = _mm_set1_ps(32768.f);
+    const __m128 min = _mm_set1_ps(-32768.f), max = _mm_set1_ps(32767.f);
+    float   *src = (float *)b->p_buffer;
+    int16_t *dst = (int16_t *)src;
+    size_t n = b->i_buffer / 4, i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        /* Clamp first, out of range conversions yield INT32_MIN */
+        __m128 lo = _mm_mul_ps(_mm_loadu_ps(&src[i]), scale);
+        __m128 hi = _mm_mul_ps(_mm_loadu_ps(&src[i + 4]), scale);
+        lo = _mm_min_ps(_mm_max_ps(lo, min), max);
+        hi = _mm_min_ps(_mm_max_ps(hi, min), max);
+        _mm_storeu_si128((__m128i *)&dst[i],
+                         _mm_packs_epi32(_mm_cvtps_epi32(lo),
+                                         _mm_cvtps_epi32(hi)));
+    }
+    for (; i < n; i++) {
+        const float v = src[i] * 32768.f;
+        if (v >= 32767.f)
+            dst[i] = 32767;
+        else if (v < -32768.f)
+            dst[i] = -32768;
+        else
+            dst[i] = lrintf(v);
+    }
+    b->i_buffer /= 2;
+    return b;
+}
+
+static const struct vlc_filter_operations Fl32toS16SSE2_ops = {
+    .filter_audio = Fl32toS16SSE2,
+};
+#endif
+
+#ifdef CAN_COMPILE_AVX2
+#define VLC_AVX2 __attribute__ ((__target__ ("avx2")))
+
+VLC_AVX2
+static block_t *Fl32toS16AVX2(filter_t *filter, block_t *b)
+{
+    VLC_UNUSED(filter);
+    const __m256 scale = _mm256_set1_ps(32768.f);
+    const __m256 min = _mm256_set1_ps(-32768.f);
+    const __m256 max = _mm256_set1_ps(32767.f);
+    float   *src = (float *)b->p_buffer;
+    int16_t *dst = (int16_t *)src;
+    size_t n = b->i_buffer / 4, i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m256 lo = _mm256_mul_ps(_mm256_loadu_ps(&src[i]), scale);
+        __m256 hi = _mm256_mul_ps(_mm256_loadu_ps(&src[i + 8]), scale);
+        lo = _mm256_min_ps(_mm256_max_ps(lo, min), max);
+        hi = _mm256_min_ps(_mm256_max_ps(hi, min), max);
+        /* Packing works per 128-bits lane, restore the order */
+        const __m256i s = _mm256_packs_epi32(_mm256_cvtps_epi32(lo),
+                                             _mm256_cvtps_epi32(hi));
+        _mm256_storeu_si256((__m256i *)&dst[i],
+                            _mm256_permute4x64_epi64(s, 0xD8));
+    }
+    for (; i < n; i++) {
+        const float v = src[i] * 32768.f;
+        if (v >= 32767.f)
+            dst[i] = 32767;
+        else if (v < -32768.f)
+            dst[i] = -32768;
+        else
+            dst[i] = lrintf(v);
+    }
+    b->i_buffer /= 2;
+    return b;
+}
+
+static const struct vlc_filter_operations Fl32toS16AVX2_ops = {
+    .filter_audio = Fl32toS16AVX2,
+};
+#endif
+
+static const struct vlc_filter_operations *FindOptimized(filter_t *filter,
+                                                         vlc_fourcc_t src,
+                                                         vlc_fourcc_t dst)
+{
+    if (dst != VLC_CODEC_S16N)
+        return NULL;
+
+    if ((src == VLC_CODEC_FL32 || src == VLC_CODEC_FL64)
+     && var_InheritBool(filter, "audio-dither")) {
+        filter_sys_t *sys = vlc_obj_malloc(VLC_OBJECT(filter), sizeof (*sys));
+        if (unlikely(sys == NULL))
+            return NULL;
+        sys->seed = vlc_mrand48();
+        filter->p_sys = sys;
+        return src == VLC_CODEC_FL32 ? &Fl32toS16Dither_ops
+                                     : &Fl64toS16Dither_ops;
+    }
+
+    if (src != VLC_CODEC_FL32)
+        return NULL;
+#ifdef CAN_COMPILE_AVX2
+    if (vlc_CPU_AVX2())
+        return &Fl32toS16AVX2_ops;
+#endif
+#ifdef CAN_COMPILE_SSE2
+    if (vlc_CPU_SSE2())
+        return &Fl32toS16SSE2_ops;
+#endif
+    return NULL;
+}
@@ -38,9 +38,9 @@
 #include <vlc_filter.h>
 
 #include "equalizer_presets.h"
+#include "biquad.h"
 
 /* TODO:
- *  - optimize a bit (you can hardly do slower ;)
  *  - add tables for more bands (15 and 32 would be cool), maybe with auto coeffs
  *    computation (not too hard once the Q is found).
  *  - support for external preset
@@ -112,13 +112,9 @@ typedef struct
     float f_gamp;   /* Global preamp */
     bool b_2eqz;
 
-    /* Filter state */
-    float x[32][2];
-    float y[32][128][2];
-
-    /* Second filter state */
-    float x2[32][2];
-    float y2[32][128][2];
+    /* Filter banks, the bands and the direct path as last section */
+    vlc_biquad *p_bank;
+    vlc_biquad *p_bank2;
 
     vlc_mutex_t lock;
 } filter_sys_t;
@@ -126,7 +122,9 @@ typedef struct
 static block_t *DoWork( filter_t *, block_t * );
 
 #define EQZ_IN_FACTOR (0.25f)
+#define EQZ_RAMP      VLC_TICK_FROM_MS(20)
 static int  EqzInit( filter_t *, int );
+static void EqzUpdate( filter_sys_t * );
 static void EqzFilter( filter_t *, float *, float *, int, int );
 static void EqzClean( filter_t * );
 
@@ -280,7 +278,7 @@ static int EqzInit( filter_t *p_filter, int i_rate )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
     eqz_config_t cfg;
-    int i, ch;
+    int i;
     vlc_value_t val1, val2, val3;
     vlc_object_t *p_aout = vlc_object_parent(p_filter);
     int i_ret = VLC_ENOMEM;
@@ -293,6 +291,8 @@ static int EqzInit( filter_t *p_filter, int i_rate )
     p_sys->f_alpha = vlc_alloc( p_sys->i_band, sizeof(float) );
     p_sys->f_beta  = vlc_alloc( p_sys->i_band, sizeof(float) );
     p_sys->f_gamma = vlc_alloc( p_sys->i_band, sizeof(float) );
+    p_sys->f_amp   = NULL;
+    p_sys->p_bank  = p_sys->p_bank2 = NULL;
     if( !p_sys->f_alpha || !p_sys->f_beta || !p_sys->f_gamma )
         goto error;
 
@@ -316,21 +316,12 @@ static int EqzInit( filter_t *p_filter, int i_rate )
     }
 
     /* Filter state */
-    for( ch = 0; ch < 32; ch++ )
-    {
-        p_sys->x[ch][0]  =
-        p_sys->x[ch][1]  =
-        p_sys->x2[ch][0] =
-        p_sys->x2[ch][1] = 0.0f;
-
-        for( i = 0; i < p_sys->i_band; i++ )
-        {
-            p_sys->y[ch][i][0]  =
-            p_sys->y[ch][i][1]  =
-            p_sys->y2[ch][i][0] =
-            p_sys->y2[ch][i][1] = 0.0f;
-        }
-    }
+    unsigned i_channels = aout_FormatNbChannels( &p_filter->fmt_in.audio );
+    unsigned i_ramp = samples_from_vlc_tick( EQZ_RAMP, i_rate );
+    p_sys->p_bank  = vlc_biquad_New( p_sys->i_band + 1, i_channels, i_ramp );
+    p_sys->p_bank2 = vlc_biquad_New( p_sys->i_band + 1, i_channels, i_ramp );
+    if( !p_sys->p_bank || !p_sys->p_bank2 )
+        goto error;
 
     var_Create( p_aout, "equalizer-bands", VLC_VAR_STRING | VLC_VAR_DOINHERIT );
     var_Create( p_aout, "equalizer-preset", VLC_VAR_STRING | VLC_VAR_DOINHERIT );
@@ -350,13 +341,15 @@ static int EqzInit( filter_t *p_filter, int i_rate )
     free( val1.psz_string );
     BandsCallback(  VLC_OBJECT( p_aout ), NULL, val2, val2, p_sys );
     PreampCallback( VLC_OBJECT( p_aout ), NULL, val3, val3, p_sys );
+    /* Start with the initial values rather than ramping to them */
+    vlc_biquad_Reset( p_sys->p_bank );
+    vlc_biquad_Reset( p_sys->p_bank2 );
 
     /* Exit if we have no preset and no bands value */
     if (!val2.psz_string || !*val2.psz_string)
     {
         msg_Err(p_filter, "No preset selected");
         free( val2.psz_string );
-        free( p_sys->f_amp );
         i_ret = VLC_EGENERIC;
         goto error;
     }
@@ -379,72 +372,62 @@ static int EqzInit( filter_t *p_filter, int i_rate )
     return VLC_SUCCESS;
 
 error:
+    if( p_sys->p_bank )
+        vlc_biquad_Delete( p_sys->p_bank );
+    if( p_sys->p_bank2 )
+        vlc_biquad_Delete( p_sys->p_bank2 );
     free( p_sys->f_alpha );
     free( p_sys->f_beta );
     free( p_sys->f_gamma );
+    free( p_sys->f_amp );
     return i_ret;
 }
 
+/* Each band is a band-pass biquad scaled by its amp, the direct path is a
+ * section passing the input attenuated by EQZ_IN_FACTOR. The preamp is
+ * applied to the last pass. Must be called with the lock held. */
+static void EqzSetBank( filter_sys_t *p_sys, vlc_biquad *p_bank, float f_gain )
+{
+    for( int i = 0; i < p_sys->i_band; i++ )
+    {
+        vlc_biquad_coeffs c = {
+            .b0 =  p_sys->f_alpha[i],
+            .b1 =  0.0f,
+            .b2 = -p_sys->f_alpha[i],
+            .a1 = -p_sys->f_gamma[i],
+            .a2 =  p_sys->f_beta[i],
+        };
+        vlc_biquad_Scale( &c, p_sys->f_amp[i] * f_gain );
+        vlc_biquad_SetCoeffs( p_bank, i, &c );
+    }
+
+    const vlc_biquad_coeffs direct = { .b0 = EQZ_IN_FACTOR * f_gain };
+    vlc_biquad_SetCoeffs( p_bank, p_sys->i_band, &direct );
+}
+
+static void EqzUpdate( filter_sys_t *p_sys )
+{
+    if( p_sys->b_2eqz )
+    {
+        EqzSetBank( p_sys, p_sys->p_bank, 1.0f );
+        EqzSetBank( p_sys, p_sys->p_bank2, p_sys->f_gamp * p_sys->f_gamp );
+    }
+    else
+        EqzSetBank( p_sys, p_sys->p_bank, p_sys->f_gamp );
+}
+
 static void EqzFilter( filter_t *p_filter, float *out, float *in,
                        int i_samples, int i_channels )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
-    int i, ch, j;
+    VLC_UNUSED(i_channels);
 
     vlc_mutex_lock( &p_sys->lock );
-    for( i = 0; i < i_samples; i++ )
-    {
-        for( ch = 0; ch < i_channels; ch++ )
-        {
-            const float x = in[ch];
-            float o = 0.0f;
-
-            for( j = 0; j < p_sys->i_band; j++ )
-            {
-                float y = p_sys->f_alpha[j] * ( x - p_sys->x[ch][1] ) +
-                          p_sys->f_gamma[j] * p_sys->y[ch][j][0] -
-                          p_sys->f_beta[j]  * p_sys->y[ch][j][1];
-
-                p_sys->y[ch][j][1] = p_sys->y[ch][j][0];
-                p_sys->y[ch][j][0] = y;
-
-                o += y * p_sys->f_amp[j];
-            }
-            p_sys->x[ch][1] = p_sys->x[ch][0];
-            p_sys->x[ch][0] = x;
-
-            /* Second filter */
-            if( p_sys->b_2eqz )
-            {
-                const float x2 = EQZ_IN_FACTOR * x + o;
-                o = 0.0f;
-                for( j = 0; j < p_sys->i_band; j++ )
-                {
-                    float y = p_sys->f_alpha[j] * ( x2 - p_sys->x2[ch][1] ) +
-                              p_sys->f_gamma[j] * p_sys->y2[ch][j][0] -
-                              p_sys->f_beta[j]  * p_sys->y2[ch][j][1];
-
-                    p_sys->y2[ch][j][1] = p_sys->y2[ch][j][0];
-                    p_sys->y2[ch][j][0] = y;
-
-                    o += y * p_sys->f_amp[j];
-                }
-                p_sys->x2[ch][1] = p_sys->x2[ch][0];
-                p_sys->x2[ch][0] = x2;
-
-                /* We add source PCM + filtered PCM */
-                out[ch] = p_sys->f_gamp * p_sys->f_gamp *( EQZ_IN_FACTOR * x2 + o );
-            }
-            else
-            {
-                /* We add source PCM + filtered PCM */
-                out[ch] = p_sys->f_gamp *( EQZ_IN_FACTOR * x + o );
-            }
-        }
+    vlc_biquad_Bank( p_sys->p_bank, in, out, i_samples );
 
-        in  += i_channels;
-        out += i_channels;
-    }
+    /* Second filter */
+    if( p_sys->b_2eqz )
+        vlc_biquad_Bank( p_sys->p_bank2, out, out, i_samples );
     vlc_mutex_unlock( &p_sys->lock );
 }
 
@@ -458,6 +441,8 @@ static void EqzClean( filter_t *p_filter )
     var_DelCallback( p_aout, "equalizer-preamp", PreampCallback, p_sys );
     var_DelCallback( p_aout, "equalizer-2pass", TwoPassCallback, p_sys );
 
+    vlc_biquad_Delete( p_sys->p_bank );
+    vlc_biquad_Delete( p_sys->p_bank2 );
     free( p_sys->f_alpha );
     free( p_sys->f_beta );
     free( p_sys->f_gamma );
@@ -529,6 +514,7 @@ static int PreampCallback( vlc_object_t *p_this, char const *psz_cmd,
 
     vlc_mutex_lock( &p_sys->lock );
     p_sys->f_gamp = preamp;
+    EqzUpdate( p_sys );
     vlc_mutex_unlock( &p_sys->lock );
     return VLC_SUCCESS;
 }
@@ -559,6 +545,7 @@ static int BandsCallback( vlc_object_t *p_this, char const *psz_cmd,
     }
     while( i < p_sys->i_band )
         p_sys->f_amp[i++] = EqzConvertdB( 0.f );
+    EqzUpdate( p_sys );
     vlc_mutex_unlock( &p_sys->lock );
     return VLC_SUCCESS;
 }
@@ -569,7 +556,11 @@ static int TwoPassCallback( vlc_object_t *p_this, char const *psz_cmd,
     filter_sys_t *p_sys = p_data;
 
     vlc_mutex_lock( &p_sys->lock );
+    bool b_restart = newval.b_bool && !p_sys->b_2eqz;
     p_sys->b_2eqz = newval.b_bool;
+    EqzUpdate( p_sys );
+    if( b_restart )
+        vlc_biquad_Reset( p_sys->p_bank2 );
     vlc_mutex_unlock( &p_sys->lock );
     return VLC_SUCCESS;
 }
@@ -36,15 +36,13 @@
 #include <vlc_aout.h>
 #include <vlc_filter.h>
 
+#include "biquad.h"
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
 static int  Open ( vlc_object_t * );
 static void Close( filter_t * );
-static void CalcPeakEQCoeffs( float, float, float, float, float * );
-static void CalcShelfEQCoeffs( float, float, float, int, float, float * );
-static void ProcessEQ( const float *, float *, float *, unsigned, unsigned,
-                       const float *, unsigned );
 static block_t *DoWork( filter_t *, block_t * );
 
 vlc_module_begin ()
@@ -89,10 +87,8 @@ typedef struct
     float   f_f2, f_Q2, f_gain2;
     float   f_f3, f_Q3, f_gain3;
     float   f_highf, f_highgain;
-    /* Filter computed coeffs */
-    float   coeffs[5*5];
-    /* State */
-    float  *p_state;
+    /* Filter cascade */
+    vlc_biquad *p_biquad;
 } filter_sys_t;
 
 
@@ -138,19 +134,31 @@ static int Open( vlc_object_t *p_this )
     p_sys->f_gain3 = var_InheritFloat( p_this, "param-eq-gain3");
 
 
+    p_sys->p_biquad = vlc_biquad_New( 5, p_filter->fmt_in.audio.i_channels,
+                                      0 );
+    if( !p_sys->p_biquad )
+    {
+        free( p_sys );
+        return VLC_ENOMEM;
+    }
+
     i_samplerate = p_filter->fmt_in.audio.i_rate;
-    CalcPeakEQCoeffs(p_sys->f_f1, p_sys->f_Q1, p_sys->f_gain1,
-                     i_samplerate, p_sys->coeffs+0*5);
-    CalcPeakEQCoeffs(p_sys->f_f2, p_sys->f_Q2, p_sys->f_gain2,
-                     i_samplerate, p_sys->coeffs+1*5);
-    CalcPeakEQCoeffs(p_sys->f_f3, p_sys->f_Q3, p_sys->f_gain3,
-                     i_samplerate, p_sys->coeffs+2*5);
-    CalcShelfEQCoeffs(p_sys->f_lowf, 1, p_sys->f_lowgain, 0,
-                      i_samplerate, p_sys->coeffs+3*5);
-    CalcShelfEQCoeffs(p_sys->f_highf, 1, p_sys->f_highgain, 0,
-                      i_samplerate, p_sys->coeffs+4*5);
-    p_sys->p_state = (float*)calloc( p_filter->fmt_in.audio.i_channels*5*4,
-                                     sizeof(float) );
+    vlc_biquad_coeffs coeffs;
+    vlc_biquad_PeakEQ( &coeffs, p_sys->f_f1, p_sys->f_Q1, p_sys->f_gain1,
+                       i_samplerate );
+    vlc_biquad_SetCoeffs( p_sys->p_biquad, 0, &coeffs );
+    vlc_biquad_PeakEQ( &coeffs, p_sys->f_f2, p_sys->f_Q2, p_sys->f_gain2,
+                       i_samplerate );
+    vlc_biquad_SetCoeffs( p_sys->p_biquad, 1, &coeffs );
+    vlc_biquad_PeakEQ( &coeffs, p_sys->f_f3, p_sys->f_Q3, p_sys->f_gain3,
+                       i_samplerate );
+    vlc_biquad_SetCoeffs( p_sys->p_biquad, 2, &coeffs );
+    vlc_biquad_LowShelf( &coeffs, p_sys->f_lowf, 1, p_sys->f_lowgain,
+                         i_samplerate );
+    vlc_biquad_SetCoeffs( p_sys->p_biquad, 3, &coeffs );
+    vlc_biquad_HighShelf( &coeffs, p_sys->f_highf, 1, p_sys->f_highgain,
+                          i_samplerate );
+    vlc_biquad_SetCoeffs( p_sys->p_biquad, 4, &coeffs );
 
     return VLC_SUCCESS;
 }
@@ -158,7 +166,7 @@ static int Open( vlc_object_t *p_this )
 static void Close( filter_t *p_filter )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
-    free( p_sys->p_state );
+    vlc_biquad_Delete( p_sys->p_biquad );
     free( p_sys );
 }
 
@@ -170,156 +178,7 @@ static void Close( filter_t *p_filter )
 static block_t *DoWork( filter_t * p_filter, block_t * p_in_buf )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
-    ProcessEQ( (float*)p_in_buf->p_buffer, (float*)p_in_buf->p_buffer,
-               p_sys->p_state,
-               p_filter->fmt_in.audio.i_channels, p_in_buf->i_nb_samples,
-               p_sys->coeffs, 5 );
+    vlc_biquad_Cascade( p_sys->p_biquad, (float*)p_in_buf->p_buffer,
+                        (float*)p_in_buf->p_buffer, p_in_buf->i_nb_samples );
     return p_in_buf;
 }
-
-/*
- * Calculate direct form IIR coefficients for peaking EQ
- * coeffs[0] = b0
- * coeffs[1] = b1
- * coeffs[2] = b2
- * coeffs[3] = a1
- * coeffs[4] = a2
- *
- * Equations taken from RBJ audio EQ cookbook
- * (http://www.musicdsp.org/files/Audio-EQ-Cookbook.txt)
- */
-static void CalcPeakEQCoeffs( float f0, float Q, float gainDB, float Fs,
-                              float *coeffs )
-{
-    float A;
-    float w0;
-    float alpha;
-    float b0, b1, b2;
-    float a0, a1, a2;
-
-    // Provide sane limits to avoid overflow
-    if (Q < 0.1f) Q = 0.1f;
-    if (Q > 100) Q = 100;
-    if (f0 > Fs/2*0.95f) f0 = Fs/2*0.95f;
-    if (gainDB < -40) gainDB = -40;
-    if (gainDB > 40) gainDB = 40;
-
-    A = powf(10, gainDB/40);
-    w0 = 2*((float)M_PI)*f0/Fs;
-    alpha = sinf(w0)/(2*Q);
-
-    b0 = 1 + alpha*A;
-    b1 = -2*cosf(w0);
-    b2 = 1 - alpha*A;
-    a0 = 1 + alpha/A;
-    a1 = -2*cosf(w0);
-    a2 = 1 - alpha/A;
-
-    // Store values to coeffs and normalize by 1/a0
-    coeffs[0] = b0/a0;
-    coeffs[1] = b1/a0;
-    coeffs[2] = b2/a0;
-    coeffs[3] = a1/a0;
-    coeffs[4] = a2/a0;
-}
-
-/*
- * Calculate direct form IIR coefficients for low/high shelf EQ
- * coeffs[0] = b0
- * coeffs[1] = b1
- * coeffs[2] = b2
- * coeffs[3] = a1
- * coeffs[4] = a2
- *
- * Equations taken from RBJ audio EQ cookbook
- * (http://www.musicdsp.org/files/Audio-EQ-Cookbook.txt)
- */
-static void CalcShelfEQCoeffs( float f0, float slope, float gainDB, int high,
-                               float Fs, float *coeffs )
-{
-    float A;
-    float w0;
-    float alpha;
-    float b0, b1, b2;
-    float a0, a1, a2;
-
-    // Provide sane limits to avoid overflow
-    if (f0 > Fs/2*0.95f) f0 = Fs/2*0.95f;
-    if (gainDB < -40) gainDB = -40;
-    if (gainDB > 40) gainDB = 40;
-
-    A = powf(10, gainDB/40);
-    w0 = 2*3.141593f*f0/Fs;
-    alpha = sinf(w0)/2 * sqrtf( (A + 1/A)*(1/slope - 1) + 2 );
-
-    if (high)
-    {
-        b0 =    A*( (A+1) + (A-1)*cosf(w0) + 2*sqrtf(A)*alpha );
-        b1 = -2*A*( (A-1) + (A+1)*cosf(w0) );
-        b2 =    A*( (A+1) + (A-1)*cosf(w0) - 2*sqrtf(A)*alpha );
-        a0 =        (A+1) - (A-1)*cosf(w0) + 2*sqrtf(A)*alpha;
-        a1 =    2*( (A-1) - (A+1)*cosf(w0) );
-        a2 =        (A+1) - (A-1)*cosf(w0) - 2*sqrtf(A)*alpha;
-    }
-    else
-    {
-        b0 =    A*( (A+1) - (A-1)*cosf(w0) + 2*sqrtf(A)*alpha );
-        b1 =  2*A*( (A-1) - (A+1)*cosf(w0));
-        b2 =    A*( (A+1) - (A-1)*cosf(w0) - 2*sqrtf(A)*alpha );
-        a0 =        (A+1) + (A-1)*cosf(w0) + 2*sqrtf(A)*alpha;
-        a1 =   -2*( (A-1) + (A+1)*cosf(w0));
-        a2 =        (A+1) + (A-1)*cosf(w0) - 2*sqrtf(A)*alpha;
-    }
-    // Store values to coeffs and normalize by 1/a0
-    coeffs[0] = b0/a0;
-    coeffs[1] = b1/a0;
-    coeffs[2] = b2/a0;
-    coeffs[3] = a1/a0;
-    coeffs[4] = a2/a0;
-}
-
-/*
-  src is assumed to be interleaved
-  dest is assumed to be interleaved
-  size of state is 4*channels*eqCount
-  samples is not premultiplied by channels
-  size of coeffs is 5*eqCount
-*/
-void ProcessEQ( const float *src, float *dest, float *state,
-                unsigned channels, unsigned samples, const float *coeffs,
-                unsigned eqCount )
-{
-    unsigned i, chn, eq;
-    float   b0, b1, b2, a1, a2;
-    float   x, y = 0;
-    const float *src1 = src;
-    float *dest1 = dest;
-
-    for (i = 0; i < samples; i++)
-    {
-        float *state1 = state;
-        for (chn = 0; chn < channels; chn++)
-        {
-            const float *coeffs1 = coeffs;
-            x = *src1++;
-            /* Direct form 1 IIRs */
-            for (eq = 0; eq < eqCount; eq++)
-            {
-                b0 = coeffs1[0];
-                b1 = coeffs1[1];
-                b2 = coeffs1[2];
-                a1 = coeffs1[3];
-                a2 = coeffs1[4];
-                coeffs1 += 5;
-                y = x*b0 + state1[0]*b1 + state1[1]*b2 - state1[2]*a1 - state1[3]*a2;
-                state1[1] = state1[0];
-                state1[0] = x;
-                state1[3] = state1[2];
-                state1[2] = y;
-                x = y;
-                state1 += 4;
-            }
-            *dest1++ = y;
-        }
-    }
-}
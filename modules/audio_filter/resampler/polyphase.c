@@ -0,0 +1,498 @@
+/*****************************************************************************
+ * polyphase.c : polyphase windowed-sinc audio resampler
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* The filter is a Kaiser-windowed sinc sampled at PHASES fractional
+ * positions, coefficients in between are interpolated linearly. The position
+ * of the next output advances by a fixed point step computed from the rates
+ * of each block, so that the ratio can change continuously, as the audio
+ * output does for drift compensation, without resetting the history. */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_cpu.h>
+#include <vlc_filter.h>
+#include <vlc_plugin.h>
+
+#if defined(CAN_COMPILE_SSE2) || defined(CAN_COMPILE_AVX2)
+# include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+# include <arm_neon.h>
+#endif
+
+#define QUALITY_TEXT N_("Resampling quality")
+#define QUALITY_LONGTEXT N_( \
+    "Resampling quality, from the lowest latency to the best" )
+
+static int Open (vlc_object_t *);
+static int OpenResampler (vlc_object_t *);
+
+vlc_module_begin ()
+    set_shortname (N_("Polyphase"))
+    set_description (N_("Polyphase audio resampler"))
+    set_subcategory (SUBCAT_AUDIO_RESAMPLER)
+    add_integer ("polyphase-resampler-quality", 1,
+                 QUALITY_TEXT, QUALITY_LONGTEXT)
+        change_integer_range (0, 2)
+    set_capability ("audio converter", 3)
+    set_callback (Open)
+
+    add_submodule ()
+    set_capability ("audio resampler", 3)
+    set_callback (OpenResampler)
+    add_shortcut ("polyphase")
+vlc_module_end ()
+
+#define PHASES 256
+
+/* The number of taps must be a multiple of 8 for the SIMD dot products.
+ * The latency is half of the taps in input frames. */
+static const struct
+{
+    unsigned taps;
+    float rolloff; /* passband, relative to the Nyquist frequency */
+    float beta;    /* Kaiser window parameter */
+} qualities[] = {
+    {  8, 0.80f, 5.f },
+    { 16, 0.90f, 7.f },
+    { 32, 0.95f, 9.f },
+};
+
+typedef float (*dot_t)(const float *, const float *, unsigned);
+
+typedef struct
+{
+    dot_t dot;
+    unsigned taps;
+    float rolloff;
+    float beta;
+    float cutoff; /* of the table, relative to the input Nyquist */
+    float *table; /* (PHASES + 1) rows of taps coefficients */
+    float *coefs; /* interpolated coefficients of the current output */
+
+    unsigned channels;
+    float *planes[AOUT_CHAN_MAX];
+    size_t length;   /* buffered input frames per plane */
+    size_t capacity;
+    uint64_t pos;    /* next output position in the planes, 32.32 frames */
+    vlc_tick_t next_pts;
+} filter_sys_t;
+
+/*****************************************************************************
+ * Dot products
+ *****************************************************************************/
+static float DotC(const float *a, const float *b, unsigned n)
+{
+    float s = 0.f;
+    for (unsigned i = 0; i < n; i++)
+        s += a[i] * b[i];
+    return s;
+}
+
+#ifdef CAN_COMPILE_SSE2
+#define VLC_SSE2 __attribute__ ((__target__ ("sse2")))
+
+VLC_SSE2
+static float DotSSE2(const float *a, const float *b, unsigned n)
+{
+    __m128 s0 = _mm_setzero_ps(), s1 = _mm_setzero_ps();
+
+    for (unsigned i = 0; i < n; i += 8)
+    {
+        s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(&a[i]),
+                                       _mm_loadu_ps(&b[i])));
+        s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(&a[i + 4]),
+                                       _mm_loadu_ps(&b[i + 4])));
+    }
+    s0 = _mm_add_ps(s0, s1);
+    s0 = _mm_add_ps(s0, _mm_movehl_ps(s0, s0));
+    s0 = _mm_add_ss(s0, _mm_shuffle_ps(s0, s0, 1));
+    return _mm_cvtss_f32(s0);
+}
+#endif
+
+#ifdef CAN_COMPILE_AVX2
+#define VLC_AVX2 __attribute__ ((__target__ ("avx2")))
+
+VLC_AVX2
+static float DotAVX2(const float *a, const float *b, unsigned n)
+{
+    __m256 s = _mm256_setzero_ps();
+
+    for (unsigned i = 0; i < n; i += 8)
+        s = _mm256_add_ps(s, _mm256_mul_ps(_mm256_loadu_ps(&a[i]),
+                                           _mm256_loadu_ps(&b[i])));
+
+    __m128 h = _mm_add_ps(_mm256_castps256_ps128(s),
+                          _mm256_extractf128_ps(s, 1));
+    h = _mm_add_ps(h, _mm_movehl_ps(h, h));
+    h = _mm_add_ss(h, _mm_shuffle_ps(h, h, 1));
+    return _mm_cvtss_f32(h);
+}
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+static float DotNEON(const float *a, const float *b, unsigned n)
+{
+    float32x4_t s0 = vdupq_n_f32(0.f), s1 = vdupq_n_f32(0.f);
+
+    for (unsigned i = 0; i < n; i += 8)
+    {
+        s0 = vfmaq_f32(s0, vld1q_f32(&a[i]), vld1q_f32(&b[i]));
+        s1 = vfmaq_f32(s1, vld1q_f32(&a[i + 4]), vld1q_f32(&b[i + 4]));
+    }
+    return vaddvq_f32(vaddq_f32(s0, s1));
+}
+#endif
+
+static dot_t GetDot(void)
+{
+#ifdef CAN_COMPILE_AVX2
+    if (vlc_CPU_AVX2())
+        return DotAVX2;
+#endif
+#ifdef CAN_COMPILE_SSE2
+    if (vlc_CPU_SSE2())
+        return DotSSE2;
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    if (vlc_CPU_ARM_NEON())
+        return DotNEON;
+#endif
+    return DotC;
+}
+
+/*****************************************************************************
+ * Filter design
+ *****************************************************************************/
+static double BesselI0(double x)
+{
+    double sum = 1., term = 1.;
+
+    for (unsigned k = 1; k < 64; k++)
+    {
+        const double h = x / (2 * k);
+        term *= h * h;
+        sum += term;
+        if (term < 1e-12 * sum)
+            break;
+    }
+    return sum;
+}
+
+/* Computes the table for a cutoff frequency relative to the input Nyquist.
+ * Output frames are centered between the taps/2 - 1 and taps/2 taps. */
+static void BuildTable(filter_sys_t *sys, float cutoff)
+{
+    const unsigned taps = sys->taps;
+    const double half = taps / 2.;
+    const double norm = BesselI0(sys->beta);
+
+    for (unsigned p = 0; p <= PHASES; p++)
+    {
+        float *row = &sys->table[p * taps];
+        double sum = 0.;
+
+        for (unsigned k = 0; k < taps; k++)
+        {
+            const double x = (double)k - (half - 1.) - (double)p / PHASES;
+            const double r = x / half;
+            double h = 0.;
+
+            if (fabs(r) < 1.)
+            {
+                const double w = BesselI0(sys->beta * sqrt(1. - r * r)) / norm;
+                const double t = M_PI * cutoff * x;
+                h = w * (t != 0. ? sin(t) / t : 1.);
+            }
+            row[k] = h;
+            sum += h;
+        }
+
+        /* Unity gain at DC for every phase */
+        for (unsigned k = 0; k < taps; k++)
+            row[k] /= sum;
+    }
+    sys->cutoff = cutoff;
+}
+
+/* Rebuilds the table when the ratio requires a different anti-aliasing
+ * filter. Drift compensation stays far below the threshold. */
+static void UpdateTable(filter_sys_t *sys, unsigned irate, unsigned orate)
+{
+    float cutoff = sys->rolloff;
+    if (orate < irate)
+        cutoff *= (float)orate / irate;
+
+    if (fabsf(cutoff - sys->cutoff) > 0.02f * sys->cutoff)
+        BuildTable(sys, cutoff);
+}
+
+/*****************************************************************************
+ * Processing
+ *****************************************************************************/
+static void Reset(filter_sys_t *sys)
+{
+    /* Prime with silence, so that the first output is on the first input */
+    sys->length = sys->taps / 2 - 1;
+    for (unsigned c = 0; c < sys->channels; c++)
+        memset(sys->planes[c], 0, sys->length * sizeof (float));
+    sys->pos = 0;
+    sys->next_pts = VLC_TICK_INVALID;
+}
+
+static int Reserve(filter_sys_t *sys, size_t frames)
+{
+    if (sys->length + frames <= sys->capacity)
+        return VLC_SUCCESS;
+
+    size_t capacity = sys->length + frames;
+    for (unsigned c = 0; c < sys->channels; c++)
+    {
+        float *plane = realloc(sys->planes[c], capacity * sizeof (float));
+        if (unlikely(plane == NULL))
+            return VLC_ENOMEM;
+        sys->planes[c] = plane;
+    }
+    sys->capacity = capacity;
+    return VLC_SUCCESS;
+}
+
+static int Append(filter_sys_t *sys, const float *in, size_t frames)
+{
+    if (Reserve(sys, frames))
+        return VLC_ENOMEM;
+
+    const unsigned channels = sys->channels;
+    for (unsigned c = 0; c < channels; c++)
+    {
+        float *dst = &sys->planes[c][sys->length];
+        if (in != NULL)
+            for (size_t i = 0; i < frames; i++)
+                dst[i] = in[i * channels + c];
+        else
+            memset(dst, 0, frames * sizeof (float));
+    }
+    sys->length += frames;
+    return VLC_SUCCESS;
+}
+
+/* Outputs all the frames whose taps are buffered */
+static block_t *Run(filter_sys_t *sys, unsigned irate, unsigned orate)
+{
+    const unsigned taps = sys->taps;
+    const unsigned channels = sys->channels;
+    const uint64_t step = ((uint64_t)irate << 32) / orate;
+    size_t frames = 0;
+
+    if (sys->length >= taps)
+    {
+        const uint64_t last = (uint64_t)(sys->length - taps) << 32;
+        if (sys->pos <= last)
+            frames = (last - sys->pos) / step + 1;
+    }
+
+    block_t *out = block_Alloc(frames * channels * sizeof (float));
+    if (unlikely(out == NULL))
+        return NULL;
+
+    float *dst = (float *)out->p_buffer;
+    uint64_t pos = sys->pos;
+
+    if (step == (UINT64_C(1) << 32) && (uint32_t)pos == 0)
+    {
+        /* Same rate on a sample boundary: the center tap is the output */
+        const size_t center = (pos >> 32) + taps / 2 - 1;
+        for (size_t i = 0; i < frames; i++)
+            for (unsigned c = 0; c < channels; c++)
+                *(dst++) = sys->planes[c][center + i];
+        pos += frames * step;
+    }
+    else
+    for (size_t i = 0; i < frames; i++, pos += step)
+    {
+        const size_t idx = pos >> 32;
+        const uint32_t frac = pos;
+        const float *t0 = &sys->table[(frac >> 24) * taps];
+        const float *t1 = t0 + taps;
+        const float f = (frac & 0xFFFFFF) * 0x1.p-24f;
+
+        for (unsigned k = 0; k < taps; k++)
+            sys->coefs[k] = t0[k] + f * (t1[k] - t0[k]);
+        for (unsigned c = 0; c < channels; c++)
+            *(dst++) = sys->dot(sys->coefs, &sys->planes[c][idx], taps);
+    }
+
+    /* Drop the frames no further output needs */
+    size_t drop = pos >> 32;
+    if (drop > sys->length)
+        drop = sys->length;
+    sys->length -= drop;
+    for (unsigned c = 0; c < channels; c++)
+        memmove(sys->planes[c], &sys->planes[c][drop],
+                sys->length * sizeof (float));
+    sys->pos = pos - ((uint64_t)drop << 32);
+
+    out->i_nb_samples = frames;
+    return out;
+}
+
+static block_t *Resample(filter_t *filter, block_t *in)
+{
+    filter_sys_t *sys = filter->p_sys;
+    const unsigned irate = filter->fmt_in.audio.i_rate;
+    const unsigned orate = filter->fmt_out.audio.i_rate;
+
+    UpdateTable(sys, irate, orate);
+
+    /* Input frame of the next output, relative to the new block */
+    const double offset = sys->pos * 0x1.p-32 + (sys->taps / 2 - 1)
+                        - (double)sys->length;
+
+    block_t *out = NULL;
+    if (Append(sys, (const float *)in->p_buffer, in->i_nb_samples) == 0)
+        out = Run(sys, irate, orate);
+    if (unlikely(out == NULL))
+    {
+        msg_Err(filter, "cannot resample %u input frames", in->i_nb_samples);
+        goto out;
+    }
+
+    out->i_pts = in->i_pts + llround(offset * CLOCK_FREQ / irate);
+    out->i_length = vlc_tick_from_samples(out->i_nb_samples, orate);
+    sys->next_pts = out->i_pts + out->i_length;
+out:
+    block_Release(in);
+    return out;
+}
+
+static void Flush(filter_t *filter)
+{
+    Reset(filter->p_sys);
+}
+
+static block_t *Drain(filter_t *filter)
+{
+    filter_sys_t *sys = filter->p_sys;
+    block_t *out = NULL;
+
+    /* Output up to the last input frame, centered on the other taps */
+    if (sys->next_pts != VLC_TICK_INVALID
+     && Append(sys, NULL, sys->taps / 2) == 0)
+        out = Run(sys, filter->fmt_in.audio.i_rate,
+                  filter->fmt_out.audio.i_rate);
+    if (out != NULL)
+    {
+        out->i_pts = sys->next_pts;
+        out->i_length = vlc_tick_from_samples(out->i_nb_samples,
+                                              filter->fmt_out.audio.i_rate);
+    }
+    Reset(sys);
+    return out;
+}
+
+static void Release(filter_sys_t *sys)
+{
+    for (unsigned c = 0; c < sys->channels; c++)
+        free(sys->planes[c]);
+    free(sys->coefs);
+    free(sys->table);
+    free(sys);
+}
+
+static void Close(filter_t *filter)
+{
+    Release(filter->p_sys);
+}
+
+static int OpenResampler(vlc_object_t *obj)
+{
+    filter_t *filter = (filter_t *)obj;
+
+    /* Cannot convert format */
+    if (filter->fmt_in.audio.i_format != VLC_CODEC_FL32
+     || filter->fmt_out.audio.i_format != VLC_CODEC_FL32
+    /* Cannot remix */
+     || filter->fmt_in.audio.i_channels != filter->fmt_out.audio.i_channels
+     || filter->fmt_in.audio.i_channels == 0
+     || filter->fmt_in.audio.i_channels > AOUT_CHAN_MAX)
+        return VLC_EGENERIC;
+
+    filter_sys_t *sys = calloc(1, sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    unsigned q = var_InheritInteger(obj, "polyphase-resampler-quality");
+    if (unlikely(q >= ARRAY_SIZE(qualities)))
+        q = 1;
+
+    sys->dot = GetDot();
+    sys->taps = qualities[q].taps;
+    sys->rolloff = qualities[q].rolloff;
+    sys->beta = qualities[q].beta;
+    sys->channels = filter->fmt_in.audio.i_channels;
+    sys->table = vlc_alloc(PHASES + 1, sys->taps * sizeof (float));
+    sys->coefs = vlc_alloc(sys->taps, sizeof (float));
+    if (unlikely(sys->table == NULL || sys->coefs == NULL
+              || Reserve(sys, sys->taps)))
+    {
+        Release(sys);
+        return VLC_ENOMEM;
+    }
+
+    UpdateTable(sys, filter->fmt_in.audio.i_rate,
+                filter->fmt_out.audio.i_rate);
+    Reset(sys);
+
+    msg_Dbg(filter, "%u taps polyphase resampler from %uHz to %uHz",
+            sys->taps, filter->fmt_in.audio.i_rate,
+            filter->fmt_out.audio.i_rate);
+
+    static const struct vlc_filter_operations filter_ops =
+    {
+        .filter_audio = Resample,
+        .drain_audio = Drain,
+        .flush = Flush,
+        .close = Close,
+    };
+
+    filter->p_sys = sys;
+    filter->ops = &filter_ops;
+    return VLC_SUCCESS;
+}
+
+static int Open(vlc_object_t *obj)
+{
+    filter_t *filter = (filter_t *)obj;
+
+    /* Will change rate */
+    if (filter->fmt_in.audio.i_rate == filter->fmt_out.audio.i_rate)
+        return VLC_EGENERIC;
+    return OpenResampler(obj);
+}
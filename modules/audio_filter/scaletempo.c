@@ -28,6 +28,7 @@
 #endif
 
 #include <vlc_common.h>
+#include <vlc_cpu.h>
 #include <vlc_plugin.h>
 #include <vlc_aout.h>
 #include <vlc_filter.h>
@@ -37,6 +38,13 @@
 #include <string.h> /* for memset */
 #include <limits.h> /* form INT_MIN */
 
+#if defined(CAN_COMPILE_SSE2) || defined(CAN_COMPILE_AVX2)
+# include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+# include <arm_neon.h>
+#endif
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -87,6 +95,8 @@ vlc_module_end ()
  * Scaletempo smooths the overlap further by searching within the input buffer
  * for the best overlap position.  Scaletempo uses a statistical cross correlation
  * (roughly a dot-product).  Scaletempo consumes most of its CPU cycles here.
+ * The search runs on the sum of the channels, so that its cost does not
+ * depend on the channel count, and the offset applies to all of them.
  *
  * NOTE:
  * sample: a single audio sample for one channel
@@ -126,47 +136,133 @@ typedef struct
     /* best overlap */
     unsigned  frames_search;
     void     *buf_pre_corr;
+    void     *buf_mix;            /* downmixed search area */
     void     *table_window;
     unsigned(*best_overlap_offset)( filter_t *p_filter );
+    float   (*dot)( const float *, const float *, unsigned );
 #ifdef PITCH_SHIFTER
     /* pitch */
     filter_t * resampler;
+    bool       resampling;
     _Atomic float rate_shift;
 #endif
 } filter_sys_t;
 
+/*****************************************************************************
+ * dot: correlation of two windows
+ *****************************************************************************/
+static float dot_c( const float *a, const float *b, unsigned n )
+{
+    float corr = 0;
+    for( unsigned i = 0; i < n; i++ )
+        corr += a[i] * b[i];
+    return corr;
+}
+
+#ifdef CAN_COMPILE_SSE2
+#define VLC_SSE2 __attribute__ ((__target__ ("sse2")))
+
+VLC_SSE2
+static float dot_sse2( const float *a, const float *b, unsigned n )
+{
+    __m128 s0 = _mm_setzero_ps(), s1 = _mm_setzero_ps();
+    unsigned i = 0;
+
+    for( ; i + 8 <= n; i += 8 ) {
+        s0 = _mm_add_ps( s0, _mm_mul_ps( _mm_loadu_ps( &a[i] ),
+                                         _mm_loadu_ps( &b[i] ) ) );
+        s1 = _mm_add_ps( s1, _mm_mul_ps( _mm_loadu_ps( &a[i + 4] ),
+                                         _mm_loadu_ps( &b[i + 4] ) ) );
+    }
+    s0 = _mm_add_ps( s0, s1 );
+    s0 = _mm_add_ps( s0, _mm_movehl_ps( s0, s0 ) );
+    s0 = _mm_add_ss( s0, _mm_shuffle_ps( s0, s0, 1 ) );
+    return _mm_cvtss_f32( s0 ) + dot_c( &a[i], &b[i], n - i );
+}
+#endif
+
+#ifdef CAN_COMPILE_AVX2
+#define VLC_AVX2 __attribute__ ((__target__ ("avx2")))
+
+VLC_AVX2
+static float dot_avx2( const float *a, const float *b, unsigned n )
+{
+    __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps();
+    unsigned i = 0;
+
+    for( ; i + 16 <= n; i += 16 ) {
+        s0 = _mm256_add_ps( s0, _mm256_mul_ps( _mm256_loadu_ps( &a[i] ),
+                                               _mm256_loadu_ps( &b[i] ) ) );
+        s1 = _mm256_add_ps( s1, _mm256_mul_ps( _mm256_loadu_ps( &a[i + 8] ),
+                                               _mm256_loadu_ps( &b[i + 8] ) ) );
+    }
+    s0 = _mm256_add_ps( s0, s1 );
+
+    __m128 h = _mm_add_ps( _mm256_castps256_ps128( s0 ),
+                           _mm256_extractf128_ps( s0, 1 ) );
+    h = _mm_add_ps( h, _mm_movehl_ps( h, h ) );
+    h = _mm_add_ss( h, _mm_shuffle_ps( h, h, 1 ) );
+    return _mm_cvtss_f32( h ) + dot_c( &a[i], &b[i], n - i );
+}
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+static float dot_neon( const float *a, const float *b, unsigned n )
+{
+    float32x4_t s0 = vdupq_n_f32( 0.f ), s1 = vdupq_n_f32( 0.f );
+    unsigned i = 0;
+
+    for( ; i + 8 <= n; i += 8 ) {
+        s0 = vfmaq_f32( s0, vld1q_f32( &a[i] ), vld1q_f32( &b[i] ) );
+        s1 = vfmaq_f32( s1, vld1q_f32( &a[i + 4] ), vld1q_f32( &b[i + 4] ) );
+    }
+    return vaddvq_f32( vaddq_f32( s0, s1 ) ) + dot_c( &a[i], &b[i], n - i );
+}
+#endif
+
 /*****************************************************************************
  * best_overlap_offset: calculate best offset for overlap
  *****************************************************************************/
 static unsigned best_overlap_offset_float( filter_t *p_filter )
 {
     filter_sys_t *p = p_filter->p_sys;
-    float *pw, *po, *ppc, *search_start;
+    const unsigned channels = p->samples_per_frame;
+    const unsigned frames_corr = p->samples_overlap / channels - 1;
+    const float *pw = p->table_window;
+    const float *po = (const float *)p->buf_overlap + channels;
+    const float *pq = (const float *)p->buf_queue + channels;
+    float *ppc = p->buf_pre_corr;
+    const float *search_start;
     float best_corr = INT_MIN;
     unsigned best_off = 0;
-    unsigned i, off;
-
-    pw  = p->table_window;
-    po  = p->buf_overlap;
-    po += p->samples_per_frame;
-    ppc = p->buf_pre_corr;
-    for( i = p->samples_per_frame; i < p->samples_overlap; i++ ) {
-      *ppc++ = *pw++ * *po++;
+
+    if( channels == 1 ) {
+        for( unsigned i = 0; i < frames_corr; i++ )
+            ppc[i] = pw[i] * po[i];
+        search_start = pq;
+    } else {
+        float *pm = p->buf_mix;
+        for( unsigned i = 0; i < frames_corr; i++ ) {
+            float s = 0;
+            for( unsigned c = 0; c < channels; c++ )
+                s += *po++;
+            ppc[i] = pw[i] * s;
+        }
+        for( unsigned i = 0; i < p->frames_search + frames_corr; i++ ) {
+            float s = 0;
+            for( unsigned c = 0; c < channels; c++ )
+                s += *pq++;
+            pm[i] = s;
+        }
+        search_start = pm;
     }
 
-    search_start = (float *)p->buf_queue + p->samples_per_frame;
-    for( off = 0; off < p->frames_search; off++ ) {
-      float corr = 0;
-      float *ps = search_start;
-      ppc = p->buf_pre_corr;
-      for( i = p->samples_per_frame; i < p->samples_overlap; i++ ) {
-        corr += *ppc++ * *ps++;
-      }
-      if( corr > best_corr ) {
-        best_corr = corr;
-        best_off  = off;
-      }
-      search_start += p->samples_per_frame;
+    for( unsigned off = 0; off < p->frames_search; off++ ) {
+        float corr = p->dot( ppc, search_start + off, frames_corr );
+        if( corr > best_corr ) {
+            best_corr = corr;
+            best_off  = off;
+        }
     }
 
     return best_off * p->bytes_per_frame;
@@ -338,18 +434,34 @@ static int reinit_buffers( filter_t *p_filter )
     }
     else
     {
-        unsigned bytes_pre_corr = ( p->samples_overlap - p->samples_per_frame ) * 4; /* sizeof (int32|float) */
+        unsigned bytes_pre_corr = ( frames_overlap - 1 ) * 4; /* sizeof (int32|float) */
         p->buf_pre_corr = malloc( bytes_pre_corr );
         p->table_window = malloc( bytes_pre_corr );
         if( ! p->buf_pre_corr || ! p->table_window )
             return VLC_ENOMEM;
-        float *pw = p->table_window;
-        for( i = 1; i<frames_overlap; i++ )
+        if( p->samples_per_frame > 1 )
         {
-            float v = i * ( frames_overlap - i );
-            for( j = 0; j < p->samples_per_frame; j++ )
-                *pw++ = v;
+            p->buf_mix = vlc_alloc( p->frames_search + frames_overlap - 1, 4 );
+            if( ! p->buf_mix )
+                return VLC_ENOMEM;
         }
+        float *pw = p->table_window;
+        for( i = 1; i<frames_overlap; i++ )
+            *pw++ = i * ( frames_overlap - i );
+
+        p->dot = dot_c;
+#ifdef CAN_COMPILE_SSE2
+        if( vlc_CPU_SSE2() )
+            p->dot = dot_sse2;
+#endif
+#ifdef CAN_COMPILE_AVX2
+        if( vlc_CPU_AVX2() )
+            p->dot = dot_avx2;
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+        if( vlc_CPU_ARM_NEON() )
+            p->dot = dot_neon;
+#endif
         p->best_overlap_offset = best_overlap_offset_float;
     }
 
@@ -428,6 +540,7 @@ static int Open( vlc_object_t *p_this )
     p_sys->buf_overlap    = NULL;
     p_sys->table_blend    = NULL;
     p_sys->buf_pre_corr   = NULL;
+    p_sys->buf_mix        = NULL;
     p_sys->table_window   = NULL;
     p_sys->bytes_overlap  = 0;
     p_sys->bytes_queued   = 0;
@@ -512,6 +625,7 @@ static int OpenPitch( vlc_object_t *p_this )
     p_sys->resampler = ResamplerCreate(p_filter);
     if( !p_sys->resampler )
         return VLC_EGENERIC;
+    p_sys->resampling = true;
 
     static const struct vlc_filter_operations filter_ops =
     {
@@ -530,6 +644,7 @@ static void Close( filter_t *p_filter )
     free( p_sys->buf_overlap );
     free( p_sys->table_blend );
     free( p_sys->buf_pre_corr );
+    free( p_sys->buf_mix );
     free( p_sys->table_window );
     free( p_sys );
 }
@@ -574,7 +689,11 @@ static block_t *DoWork( filter_t * p_filter, block_t * p_in_buf )
                                    p_in_buf->i_buffer, 0 );
     if( i_outsize > 0 )
     {
-        p_out_buf = block_Alloc( i_outsize );
+        /* Once all the input is queued, its buffer can hold the output */
+        if( offset_in == p_in_buf->i_buffer && i_outsize <= p_in_buf->i_buffer )
+            p_out_buf = p_in_buf;
+        else
+            p_out_buf = block_Alloc( i_outsize );
         if( p_out_buf == NULL )
         {
             block_Release( p_in_buf );
@@ -597,7 +716,8 @@ static block_t *DoWork( filter_t * p_filter, block_t * p_in_buf )
                                                     p_filter->fmt_out.audio.i_rate);
     }
 
-    block_Release( p_in_buf );
+    if( p_out_buf != p_in_buf )
+        block_Release( p_in_buf );
     return p_out_buf;
 }
 
@@ -612,8 +732,22 @@ static block_t *DoPitchWork( filter_t * p_filter, block_t * p_in_buf )
     p->resampler->fmt_out.audio.i_rate = rate_shift;
     p_filter->fmt_in.audio.i_rate = rate_shift;
 
+    /* Without shift, skip the resampler rather than copying through it */
+    if( p->resampler->fmt_out.audio.i_rate == p->sample_rate )
+    {
+        if( p->resampling )
+        {
+            filter_Flush( p->resampler );
+            p->resampling = false;
+        }
+        return DoWork( p_filter, p_in_buf );
+    }
+    p->resampling = true;
+
     /* Change rate, thus changing pitch */
     p_in_buf = p->resampler->ops->filter_audio( p->resampler, p_in_buf );
+    if( p_in_buf == NULL )
+        return NULL;
 
     /* Change tempo while preserving shifted pitch */
     return DoWork( p_filter, p_in_buf );
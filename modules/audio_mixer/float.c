@@ -19,7 +19,6 @@
  * along with this program; if not, write to the Free Software Foundation,
  * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
  *****************************************************************************/
-
 /*****************************************************************************
  * Preamble
  *****************************************************************************/
@@ -30,10 +29,18 @@
 
 #include <stddef.h>
 #include <vlc_common.h>
+#include <vlc_cpu.h>
 #include <vlc_plugin.h>
 #include <vlc_aout.h>
 #include <vlc_aout_volume.h>
 
+#if defined(CAN_COMPILE_SSE2) || defined(CAN_COMPILE_AVX2)
+# include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+# include <arm_neon.h>
+#endif
+
 /*****************************************************************************
  * Local prototypes
  *****************************************************************************/
@@ -49,21 +56,170 @@ vlc_module_begin ()
     set_callback( Create )
 vlc_module_end ()
 
-/**
- * Mixes a new output buffer
- */
-static void FilterFL32( audio_volume_t *p_volume, block_t *p_buffer,
-                        float f_multiplier )
+/*****************************************************************************
+ * Kernels
+ *****************************************************************************
+ * Ramps interpolate the gain per sample from the previous one to the new one,
+ * the skew between the channels of a frame is negligible.
+ *****************************************************************************/
+static void AmplifyC( float *p, size_t n, float mult )
 {
-    if( f_multiplier == 1.f )
-        return; /* nothing to do */
+    for( size_t i = 0; i < n; i++ )
+        p[i] *= mult;
+}
 
-    float *p = (float *)p_buffer->p_buffer;
-    for( size_t i = p_buffer->i_buffer / sizeof(*p); i > 0; i-- )
-        *(p++) *= f_multiplier;
+static void RampC( float *p, size_t n, float from, float step )
+{
+    for( size_t i = 0; i < n; i++ )
+        p[i] *= from + step * i;
+}
 
-    (void) p_volume;
+#ifdef CAN_COMPILE_SSE2
+#define VLC_SSE2 __attribute__ ((__target__ ("sse2")))
+
+VLC_SSE2
+static void AmplifySSE2( float *p, size_t n, float mult )
+{
+    const __m128 vm = _mm_set1_ps( mult );
+    size_t i = 0;
+
+    for( ; i + 8 <= n; i += 8 )
+    {
+        __m128 a = _mm_loadu_ps( &p[i] );
+        __m128 b = _mm_loadu_ps( &p[i + 4] );
+        _mm_storeu_ps( &p[i], _mm_mul_ps( a, vm ) );
+        _mm_storeu_ps( &p[i + 4], _mm_mul_ps( b, vm ) );
+    }
+    AmplifyC( &p[i], n - i, mult );
+}
+
+VLC_SSE2
+static void RampSSE2( float *p, size_t n, float from, float step )
+{
+    const __m128 vstep = _mm_set1_ps( step );
+    const __m128 lanes = _mm_setr_ps( 0.f, 1.f, 2.f, 3.f );
+    size_t i = 0;
+
+    for( ; i + 4 <= n; i += 4 )
+    {
+        /* Computed from the index rather than accumulated, not to drift */
+        const __m128 idx = _mm_add_ps( _mm_set1_ps( i ), lanes );
+        const __m128 g = _mm_add_ps( _mm_set1_ps( from ),
+                                     _mm_mul_ps( idx, vstep ) );
+        _mm_storeu_ps( &p[i], _mm_mul_ps( _mm_loadu_ps( &p[i] ), g ) );
+    }
+    RampC( &p[i], n - i, from + step * i, step );
 }
+#endif
+
+#ifdef CAN_COMPILE_AVX2
+#define VLC_AVX2 __attribute__ ((__target__ ("avx2")))
+
+VLC_AVX2
+static void AmplifyAVX2( float *p, size_t n, float mult )
+{
+    const __m256 vm = _mm256_set1_ps( mult );
+    size_t i = 0;
+
+    for( ; i + 16 <= n; i += 16 )
+    {
+        __m256 a = _mm256_loadu_ps( &p[i] );
+        __m256 b = _mm256_loadu_ps( &p[i + 8] );
+        _mm256_storeu_ps( &p[i], _mm256_mul_ps( a, vm ) );
+        _mm256_storeu_ps( &p[i + 8], _mm256_mul_ps( b, vm ) );
+    }
+    AmplifyC( &p[i], n - i, mult );
+}
+
+VLC_AVX2
+static void RampAVX2( float *p, size_t n, float from, float step )
+{
+    const __m256 vstep = _mm256_set1_ps( step );
+    const __m256 lanes = _mm256_setr_ps( 0.f, 1.f, 2.f, 3.f,
+                                         4.f, 5.f, 6.f, 7.f );
+    size_t i = 0;
+
+    for( ; i + 8 <= n; i += 8 )
+    {
+        const __m256 idx = _mm256_add_ps( _mm256_set1_ps( i ), lanes );
+        const __m256 g = _mm256_add_ps( _mm256_set1_ps( from ),
+                                        _mm256_mul_ps( idx, vstep ) );
+        _mm256_storeu_ps( &p[i],
+                          _mm256_mul_ps( _mm256_loadu_ps( &p[i] ), g ) );
+    }
+    RampC( &p[i], n - i, from + step * i, step );
+}
+#endif
+
+/* 32-bits ARM has its own assembly volume plugin */
+#if defined(__ARM_NEON) && defined(__aarch64__)
+static void AmplifyNEON( float *p, size_t n, float mult )
+{
+    size_t i = 0;
+
+    for( ; i + 8 <= n; i += 8 )
+    {
+        float32x4_t a = vld1q_f32( &p[i] );
+        float32x4_t b = vld1q_f32( &p[i + 4] );
+        vst1q_f32( &p[i], vmulq_n_f32( a, mult ) );
+        vst1q_f32( &p[i + 4], vmulq_n_f32( b, mult ) );
+    }
+    AmplifyC( &p[i], n - i, mult );
+}
+
+static void RampNEON( float *p, size_t n, float from, float step )
+{
+    static const float lanes_init[4] = { 0.f, 1.f, 2.f, 3.f };
+    const float32x4_t lanes = vld1q_f32( lanes_init );
+    size_t i = 0;
+
+    for( ; i + 4 <= n; i += 4 )
+    {
+        const float32x4_t idx = vaddq_f32( vdupq_n_f32( i ), lanes );
+        const float32x4_t g = vmlaq_n_f32( vdupq_n_f32( from ), idx, step );
+        vst1q_f32( &p[i], vmulq_f32( vld1q_f32( &p[i] ), g ) );
+    }
+    RampC( &p[i], n - i, from + step * i, step );
+}
+#endif
+
+/**
+ * Mixes a new output buffer
+ */
+#define FILTER_FL32(isa) \
+static void FilterFL32##isa( audio_volume_t *p_volume, block_t *p_buffer, \
+                             float f_multiplier ) \
+{ \
+    if( f_multiplier == 1.f ) \
+        return; /* nothing to do */ \
+\
+    Amplify##isa( (float *)p_buffer->p_buffer, \
+                  p_buffer->i_buffer / sizeof(float), f_multiplier ); \
+    (void) p_volume; \
+} \
+\
+static void RampFL32##isa( audio_volume_t *p_volume, block_t *p_buffer, \
+                           float f_from, float f_to ) \
+{ \
+    const size_t i_samples = p_buffer->i_buffer / sizeof(float); \
+    if( i_samples == 0 ) \
+        return; \
+\
+    Ramp##isa( (float *)p_buffer->p_buffer, i_samples, f_from, \
+               ( f_to - f_from ) / i_samples ); \
+    (void) p_volume; \
+}
+
+FILTER_FL32(C)
+#ifdef CAN_COMPILE_SSE2
+FILTER_FL32(SSE2)
+#endif
+#ifdef CAN_COMPILE_AVX2
+FILTER_FL32(AVX2)
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+FILTER_FL32(NEON)
+#endif
 
 static void FilterFL64( audio_volume_t *p_volume, block_t *p_buffer,
                         float f_multiplier )
@@ -79,6 +235,19 @@ static void FilterFL64( audio_volume_t *p_volume, block_t *p_buffer,
     (void) p_volume;
 }
 
+static void RampFL64( audio_volume_t *p_volume, block_t *p_buffer,
+                      float f_from, float f_to )
+{
+    double *p = (double *)p_buffer->p_buffer;
+    const size_t i_samples = p_buffer->i_buffer / sizeof(*p);
+    const double step = ( (double)f_to - f_from ) / i_samples;
+
+    for( size_t i = 0; i < i_samples; i++ )
+        p[i] *= f_from + step * i;
+
+    (void) p_volume;
+}
+
 /**
  * Initializes the mixer
  */
@@ -89,10 +258,33 @@ static int Create( vlc_object_t *p_this )
     switch (p_volume->format)
     {
         case VLC_CODEC_FL32:
-            p_volume->amplify = FilterFL32;
+            p_volume->amplify = FilterFL32C;
+            p_volume->amplify_ramp = RampFL32C;
+#ifdef CAN_COMPILE_SSE2
+            if( vlc_CPU_SSE2() )
+            {
+                p_volume->amplify = FilterFL32SSE2;
+                p_volume->amplify_ramp = RampFL32SSE2;
+            }
+#endif
+#ifdef CAN_COMPILE_AVX2
+            if( vlc_CPU_AVX2() )
+            {
+                p_volume->amplify = FilterFL32AVX2;
+                p_volume->amplify_ramp = RampFL32AVX2;
+            }
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+            if( vlc_CPU_ARM_NEON() )
+            {
+                p_volume->amplify = FilterFL32NEON;
+                p_volume->amplify_ramp = RampFL32NEON;
+            }
+#endif
             break;
         case VLC_CODEC_FL64:
             p_volume->amplify = FilterFL64;
+            p_volume->amplify_ramp = RampFL64;
             break;
         default:
             return -1;
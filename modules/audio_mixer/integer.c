@@ -60,6 +60,32 @@ static void FilterS32N (audio_volume_t *vol, block_t *block, float volume)
     (void) vol;
 }
 
+/* The factor of ramps is interpolated with 16 more fractional bits */
+static void RampS32N (audio_volume_t *vol, block_t *block,
+                      float from, float to)
+{
+    int32_t *p = (int32_t *)block->p_buffer;
+    size_t n = block->i_buffer / sizeof (*p);
+    if (n == 0)
+        return;
+
+    int_fast64_t acc = (int_fast64_t)lroundf (from * 0x1.p24f) << 16;
+    const int_fast64_t step =
+        (((int_fast64_t)lroundf (to * 0x1.p24f) << 16) - acc) / (int_fast64_t)n;
+
+    for (; n > 0; n--, acc += step)
+    {
+        int_fast64_t s = (*p * (acc >> 16)) >> INT64_C(24);
+        if (s > INT32_MAX)
+            s = INT32_MAX;
+        else
+        if (s < INT32_MIN)
+            s = INT32_MIN;
+        *(p++) = s;
+    }
+    (void) vol;
+}
+
 static void FilterS16N (audio_volume_t *vol, block_t *block, float volume)
 {
     int16_t *p = (int16_t *)block->p_buffer;
@@ -81,6 +107,31 @@ static void FilterS16N (audio_volume_t *vol, block_t *block, float volume)
     (void) vol;
 }
 
+static void RampS16N (audio_volume_t *vol, block_t *block,
+                      float from, float to)
+{
+    int16_t *p = (int16_t *)block->p_buffer;
+    size_t n = block->i_buffer / sizeof (*p);
+    if (n == 0)
+        return;
+
+    int_fast64_t acc = (int_fast64_t)lroundf (from * 0x1.p8f) << 16;
+    const int_fast64_t step =
+        (((int_fast64_t)lroundf (to * 0x1.p8f) << 16) - acc) / (int_fast64_t)n;
+
+    for (; n > 0; n--, acc += step)
+    {
+        int_fast32_t s = (*p * (acc >> 8)) >> 16;
+        if (s > INT16_MAX)
+            s = INT16_MAX;
+        else
+        if (s < INT16_MIN)
+            s = INT16_MIN;
+        *(p++) = s;
+    }
+    (void) vol;
+}
+
 static void FilterU8 (audio_volume_t *vol, block_t *block, float volume)
 {
     uint8_t *p = (uint8_t *)block->p_buffer;
@@ -110,9 +161,11 @@ static int Activate (vlc_object_t *obj)
     {
         case VLC_CODEC_S32N:
             vol->amplify = FilterS32N;
+            vol->amplify_ramp = RampS32N;
             break;
         case VLC_CODEC_S16N:
             vol->amplify = FilterS16N;
+            vol->amplify_ramp = RampS16N;
             break;
         case VLC_CODEC_U8:
             vol->amplify = FilterU8;
@@ -115,6 +115,7 @@ typedef struct
     bool soft_mute;
     float soft_gain;
     char *device;
+    bool low_latency;
 
     vlc_thread_t thread;
     pb_state_t state;
@@ -407,6 +408,26 @@ static void Play(audio_output_t *aout, block_t *block, vlc_tick_t date)
         vlc_mutex_unlock(&sys->lock);
         return;
     }
+    if (sys->low_latency && sys->frame_chain == NULL
+     && sys->state == PLAYING && !sys->draining)
+    {   /* Fill the device from the calling thread, only what does not fit
+         * goes through the injection thread. Errors are recovered there. */
+        snd_pcm_sframes_t frames = snd_pcm_writei(sys->pcm, block->p_buffer,
+                                                  block->i_nb_samples);
+        if (frames > 0)
+        {
+            size_t bytes = snd_pcm_frames_to_bytes(sys->pcm, frames);
+            block->i_nb_samples -= frames;
+            block->p_buffer += bytes;
+            block->i_buffer -= bytes;
+        }
+        if (block->i_nb_samples == 0)
+        {
+            vlc_frame_Release(block);
+            vlc_mutex_unlock(&sys->lock);
+            return;
+        }
+    }
     if (sys->frame_chain == NULL)
         wake_poll(sys);
     vlc_frame_ChainLastAppend(&sys->frame_last, block);
@@ -891,8 +912,13 @@ static int Start (audio_output_t *aout, audio_sample_format_t *restrict fmt)
     }
     sys->rate = fmt->i_rate;
 
+    /* Low latency is pointless with large pass-through frames */
+    sys->low_latency = passthrough == PASSTHROUGH_NONE
+                    && var_InheritBool(aout, "audio-low-latency");
+
 #if 1 /* work-around for period-long latency outputs (e.g. PulseAudio): */
-    param = AOUT_MIN_PREPARE_TIME;
+    param = sys->low_latency ? AOUT_LOW_LATENCY_TIME / 4
+                             : AOUT_MIN_PREPARE_TIME;
     val = snd_pcm_hw_params_set_period_time_near (pcm, hw, &param, NULL);
     if (val)
     {
@@ -901,7 +927,7 @@ static int Start (audio_output_t *aout, audio_sample_format_t *restrict fmt)
     }
 #endif
     /* Set buffer size */
-    param = AOUT_MAX_ADVANCE_TIME;
+    param = sys->low_latency ? AOUT_LOW_LATENCY_TIME : AOUT_MAX_ADVANCE_TIME;
     val = snd_pcm_hw_params_set_buffer_time_near (pcm, hw, &param, NULL);
     if (val)
     {
@@ -943,7 +969,16 @@ static int Start (audio_output_t *aout, audio_sample_format_t *restrict fmt)
     Dump(log, "initial software parameters:\n", snd_pcm_sw_params_dump, sw);
 
     /* START REVISIT */
-    //snd_pcm_sw_params_set_avail_min( pcm, sw, i_period_size );
+    if (sys->low_latency)
+    {   /* Wake the injection thread up as soon as a period is free */
+        snd_pcm_uframes_t period_size;
+        val = snd_pcm_hw_params_get_period_size(hw, &period_size, NULL);
+        if (val == 0)
+            val = snd_pcm_sw_params_set_avail_min(pcm, sw, period_size);
+        if (val < 0)
+            msg_Warn(aout, "unable to set minimum available frames (%s)",
+                     snd_strerror(val));
+    }
     // FIXME: useful?
     val = snd_pcm_sw_params_set_start_threshold (pcm, sw, 1);
     if( val < 0 )
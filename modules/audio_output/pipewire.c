@@ -62,6 +62,7 @@ struct vlc_pw_stream {
     bool starting;
     bool draining;
     bool error;
+    bool low_latency;
 
     audio_output_t *aout;
 };
@@ -211,9 +212,12 @@ static void stream_process(void *data)
             vlc_tick_t audio_ts = vlc_tick_from_samples(s->time.injected, s->time.rate)
                                 + s->first_pts;
             aout_TimingReport(s->aout, now + delay, audio_ts);
-            /* Once we have enough points to initiate the clock we can delay the reports */
+            /* Once we have enough points to initiate the clock we can delay
+             * the reports, less so with small buffers as the drift is
+             * tolerated for a shorter time */
             if (now >= s->start + VLC_TICK_FROM_SEC(1))
-                s->time.next_update = now + VLC_TICK_FROM_SEC(1);
+                s->time.next_update = now + (s->low_latency ?
+                    VLC_TICK_FROM_MS(200) : VLC_TICK_FROM_SEC(1));
         }
 
         while ((block = s->queue.head) != NULL) {
@@ -588,6 +592,15 @@ static struct vlc_pw_stream *vlc_pw_stream_create(audio_output_t *aout,
         free(role);
     }
 
+    /* Low latency is pointless with large pass-through frames */
+    bool low_latency = encoding == SPA_AUDIO_IEC958_CODEC_PCM
+                    && var_InheritBool(aout, "audio-low-latency");
+    if (low_latency) /* Ask the graph for a small quantum */
+        pw_properties_setf(props, PW_KEY_NODE_LATENCY, "%u/%u",
+                           (unsigned) samples_from_vlc_tick(
+                               AOUT_LOW_LATENCY_TIME / 4, fmt->i_rate),
+                           fmt->i_rate);
+
     /* Create the stream */
     struct vlc_pw_stream *s = malloc(sizeof (*s));
     if (unlikely(s == NULL)) {
@@ -614,6 +627,7 @@ static struct vlc_pw_stream *vlc_pw_stream_create(audio_output_t *aout,
     s->starting = false;
     s->draining = false;
     s->error = false;
+    s->low_latency = low_latency;
     s->aout = aout;
 
     vlc_pw_lock(s->context);
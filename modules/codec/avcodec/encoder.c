@@ -45,6 +45,12 @@
 #include <libavcodec/avcodec.h>
 #include <libavutil/channel_layout.h>
 
+#ifdef HAVE_AVCODEC_VAAPI
+# include <libavutil/hwcontext.h>
+# include <libavutil/hwcontext_vaapi.h>
+# include "../../hw/vaapi/vlc_vaapi.h"
+#endif
+
 #include "avcodec.h"
 #include "avcommon.h"
 
@@ -303,6 +309,120 @@ static void add_av_option_float( encoder_t *p_enc, AVDictionary** pp_dict, const
         msg_Warn( p_enc, "Failed to set encoder option %s", psz_name );
 }
 
+#ifdef HAVE_AVCODEC_VAAPI
+static bool IsVaapiInput( const encoder_t *p_enc )
+{
+    /* The 10 and 12 bits surfaces would need a P010 or P012 frames pool */
+    return p_enc->fmt_in.i_cat == VIDEO_ES &&
+           p_enc->fmt_in.video.i_chroma == VLC_CODEC_VAAPI_420 &&
+           p_enc->vctx_in != NULL &&
+           vlc_video_context_GetType( p_enc->vctx_in ) == VLC_VIDEO_CONTEXT_VAAPI;
+}
+
+static bool IsVaapiEncoder( const AVCodec *p_codec )
+{
+    const char *psz_suffix = strrchr( p_codec->name, '_' );
+    return psz_suffix != NULL && !strcmp( psz_suffix, "_vaapi" );
+}
+
+static AVC_MAYBE_CONST AVCodec *FindVaapiEncoder( enum AVCodecID i_codec_id )
+{
+    const char *psz_name = avcodec_get_name( i_codec_id );
+    if( i_codec_id == AV_CODEC_ID_MPEG2VIDEO )
+        psz_name = "mpeg2";
+
+    char psz_encoder[32];
+    if( snprintf( psz_encoder, sizeof(psz_encoder), "%s_vaapi",
+                  psz_name ) >= (int)sizeof(psz_encoder) )
+        return NULL;
+    return avcodec_find_encoder_by_name( psz_encoder );
+}
+
+static void ReleaseVaapiDevice( AVHWDeviceContext *hwdev_ctx )
+{
+    vlc_decoder_device_Release( hwdev_ctx->user_opaque );
+}
+
+/* Creates a frames context on the display of the input pictures, so that
+ * their surfaces can be encoded directly */
+static AVBufferRef *CreateVaapiFrames( encoder_t *p_enc )
+{
+    vlc_decoder_device *dec_device =
+        vlc_video_context_HoldDevice( p_enc->vctx_in );
+    if( dec_device == NULL )
+        return NULL;
+
+    AVBufferRef *hwdev_ref = av_hwdevice_ctx_alloc( AV_HWDEVICE_TYPE_VAAPI );
+    if( hwdev_ref == NULL )
+    {
+        vlc_decoder_device_Release( dec_device );
+        return NULL;
+    }
+
+    AVHWDeviceContext *hwdev_ctx = (void *) hwdev_ref->data;
+    AVVAAPIDeviceContext *vadev_ctx = hwdev_ctx->hwctx;
+    vadev_ctx->display = dec_device->opaque;
+    /* The display must outlive the frames held by libavcodec */
+    hwdev_ctx->user_opaque = dec_device;
+    hwdev_ctx->free = ReleaseVaapiDevice;
+
+    if( av_hwdevice_ctx_init( hwdev_ref ) < 0 )
+    {
+        av_buffer_unref( &hwdev_ref );
+        return NULL;
+    }
+
+    AVBufferRef *hwframes_ref = av_hwframe_ctx_alloc( hwdev_ref );
+    av_buffer_unref( &hwdev_ref );
+    if( hwframes_ref == NULL )
+        return NULL;
+
+    AVHWFramesContext *hwframes_ctx = (void *) hwframes_ref->data;
+    hwframes_ctx->format = AV_PIX_FMT_VAAPI;
+    hwframes_ctx->sw_format = AV_PIX_FMT_NV12;
+    hwframes_ctx->width = p_enc->fmt_in.video.i_width;
+    hwframes_ctx->height = p_enc->fmt_in.video.i_height;
+    /* The surfaces come from the decoder or the filters */
+    hwframes_ctx->initial_pool_size = 0;
+
+    if( av_hwframe_ctx_init( hwframes_ref ) < 0 )
+    {
+        msg_Warn( p_enc, "cannot create the VAAPI frames context" );
+        av_buffer_unref( &hwframes_ref );
+        return NULL;
+    }
+    return hwframes_ref;
+}
+
+static void ReleaseVaapiPicture( void *opaque, uint8_t *data )
+{
+    VLC_UNUSED(data);
+    picture_Release( opaque );
+}
+
+/* References the surface of the picture, which stays alive as long as
+ * libavcodec holds the frame */
+static int WrapVaapiPicture( AVCodecContext *p_context, AVFrame *frame,
+                             picture_t *p_pict )
+{
+    frame->buf[0] = av_buffer_create( (uint8_t *) p_pict, sizeof(*p_pict),
+                                      ReleaseVaapiPicture, p_pict,
+                                      AV_BUFFER_FLAG_READONLY );
+    if( frame->buf[0] == NULL )
+        return VLC_ENOMEM;
+    picture_Hold( p_pict );
+
+    frame->hw_frames_ctx = av_buffer_ref( p_context->hw_frames_ctx );
+    if( frame->hw_frames_ctx == NULL )
+        return VLC_ENOMEM;
+
+    const struct vaapi_pic_context *pic_ctx =
+        container_of( p_pict->context, struct vaapi_pic_context, s );
+    frame->data[3] = (uint8_t *)(uintptr_t) pic_ctx->surface;
+    return VLC_SUCCESS;
+}
+#endif
+
 /*****************************************************************************
  * InitVideoEnc: probe the encoder
  *****************************************************************************/
@@ -388,6 +508,26 @@ int InitVideoEnc( vlc_object_t *p_this )
         }
     }
     free( psz_encoder );
+
+#ifdef HAVE_AVCODEC_VAAPI
+    /* Encode the hardware pictures without downloading them */
+    AVBufferRef *hw_frames = NULL;
+    if( IsVaapiInput( p_enc ) )
+    {
+        if( !p_codec )
+            p_codec = FindVaapiEncoder( i_codec_id );
+        if( p_codec && IsVaapiEncoder( p_codec ) )
+        {
+            hw_frames = CreateVaapiFrames( p_enc );
+            if( hw_frames == NULL )
+            {
+                msg_Warn( p_enc, "cannot encode the VAAPI surfaces with %s, "
+                          "using a software encoder", p_codec->name );
+                p_codec = NULL;
+            }
+        }
+    }
+#endif
     if( !p_codec )
         p_codec = avcodec_find_encoder( i_codec_id );
     if( !p_codec )
@@ -417,7 +557,12 @@ int InitVideoEnc( vlc_object_t *p_this )
 
     /* Allocate the memory needed to store the encoder's structure */
     if( ( p_sys = calloc( 1, sizeof(encoder_sys_t) ) ) == NULL )
+    {
+#ifdef HAVE_AVCODEC_VAAPI
+        av_buffer_unref( &hw_frames );
+#endif
         return VLC_ENOMEM;
+    }
     p_enc->p_sys = p_sys;
     p_sys->i_samples_delay = 0;
     p_sys->p_codec = p_codec;
@@ -431,10 +576,17 @@ int InitVideoEnc( vlc_object_t *p_this )
     p_context = avcodec_alloc_context3(p_codec);
     if( unlikely(p_context == NULL) )
     {
+#ifdef HAVE_AVCODEC_VAAPI
+        av_buffer_unref( &hw_frames );
+#endif
         free( p_sys );
         return VLC_ENOMEM;
     }
     p_sys->p_context = p_context;
+#ifdef HAVE_AVCODEC_VAAPI
+    /* Released with the context */
+    p_context->hw_frames_ctx = hw_frames;
+#endif
     p_sys->p_context->codec_id = p_sys->p_codec->id;
     p_context->thread_type = 0;
     p_context->debug = var_InheritInteger( p_enc, "avcodec-debug" );
@@ -619,6 +771,18 @@ int InitVideoEnc( vlc_object_t *p_this )
             p_enc->fmt_in.i_codec = p_enc->fmt_in.video.i_chroma;
         }
 
+#ifdef HAVE_AVCODEC_VAAPI
+        if( p_context->hw_frames_ctx != NULL )
+        {
+            /* Keep the VAAPI surfaces, no converter is needed upstream */
+            p_context->pix_fmt = AV_PIX_FMT_VAAPI;
+            p_enc->fmt_in.i_codec =
+            p_enc->fmt_in.video.i_chroma = VLC_CODEC_VAAPI_420;
+            msg_Dbg( p_enc, "encoding the VAAPI surfaces with %s",
+                     p_codec->name );
+        }
+#endif
+
 
         if ( p_sys->f_i_quant_factor != 0.f )
             p_context->i_quant_factor = p_sys->f_i_quant_factor;
@@ -1260,6 +1424,17 @@ static block_t *EncodeVideo( encoder_t *p_enc, picture_t *p_pict )
         frame = p_sys->frame;
         av_frame_unref( frame );
 
+#ifdef HAVE_AVCODEC_VAAPI
+        if( p_sys->p_context->hw_frames_ctx != NULL )
+        {
+            if( WrapVaapiPicture( p_sys->p_context, frame, p_pict ) )
+            {
+                av_frame_unref( frame );
+                return NULL;
+            }
+        }
+        else
+#endif
         for( i_plane = 0; i_plane < p_pict->i_planes; i_plane++ )
         {
             p_sys->frame->data[i_plane] = p_pict->p[i_plane].p_pixels;
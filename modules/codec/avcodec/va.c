@@ -38,6 +38,9 @@ bool vlc_va_MightDecode(enum AVPixelFormat hwfmt)
         case AV_PIX_FMT_DXVA2_VLD:
         case AV_PIX_FMT_D3D11VA_VLD:
         case AV_PIX_FMT_VDPAU:
+#if LIBAVUTIL_VERSION_CHECK(58, 29, 100)
+        case AV_PIX_FMT_VULKAN:
+#endif
             return true;
         default:
             return false;
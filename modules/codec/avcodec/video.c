@@ -70,6 +70,7 @@ struct frame_info_s
 #endif
     bool b_eos;
     bool b_display;
+    vlc_tick_t i_sent; /* when the packet was sent to the decoder */
 };
 
 /*****************************************************************************
@@ -114,6 +115,16 @@ typedef struct
     /* for direct rendering */
     bool        b_direct_rendering;
     bool        b_dr_failure; /* Protected by lock */
+    /* software decoded pictures, output directly or copied */
+    uint64_t    i_dr_frames;
+    uint64_t    i_copied_frames;
+    /* time between sending a packet and getting its frame */
+    vlc_tick_t  i_latency_sum;
+    vlc_tick_t  i_latency_max;
+    uint64_t    i_latency_count;
+
+    /* threads reserved from the CPU budget */
+    unsigned    i_budget_threads;
 
     /* Hack to force display of still pictures */
     bool b_first_frame;
@@ -622,12 +633,9 @@ static int InitVideoDecCommon( decoder_t *p_dec )
 
     int max_thread_count;
     int i_thread_count = p_sys->b_hardware_only ? 1 : var_InheritInteger( p_dec, "avcodec-threads" );
+    p_sys->i_budget_threads = 0;
     if( i_thread_count <= 0 )
     {
-        i_thread_count = vlc_GetCPUCount();
-        if( i_thread_count > 1 )
-            i_thread_count++;
-
         //FIXME: take in count the decoding time
         max_thread_count = p_codec->id == AV_CODEC_ID_HEVC ? 10 : 6;
 #if defined(_WIN32)
@@ -636,6 +644,11 @@ static int InitVideoDecCommon( decoder_t *p_dec )
         max_thread_count = 6 ;
 # endif
 #endif
+        /* Share the CPUs with the other decoders */
+        p_sys->i_budget_threads = vlc_CPUBudgetAcquire( max_thread_count );
+        i_thread_count = p_sys->i_budget_threads;
+        if( i_thread_count > 1 )
+            i_thread_count++;
     }
     else
         max_thread_count = p_codec->id == AV_CODEC_ID_HEVC ? 32 : 16;
@@ -694,6 +707,8 @@ static int InitVideoDecCommon( decoder_t *p_dec )
     /* ***** Open the codec ***** */
     if( OpenVideoCodec( p_dec ) < 0 )
     {
+        if( p_sys->i_budget_threads )
+            vlc_CPUBudgetRelease( p_sys->i_budget_threads );
         free( p_sys );
         avcodec_free_context( &p_context );
         return VLC_EGENERIC;
@@ -816,6 +831,9 @@ static const enum AVPixelFormat hwfmts[] =
 #endif
     AV_PIX_FMT_VAAPI,
     AV_PIX_FMT_VDPAU,
+#if LIBAVUTIL_VERSION_CHECK(58, 29, 100)
+    AV_PIX_FMT_VULKAN,
+#endif
     AV_PIX_FMT_NONE,
 };
 
@@ -1477,6 +1495,7 @@ static int DecodeBlock( decoder_t *p_dec, block_t **pp_block )
             const bool b_eos = p_block && (p_block->i_flags & BLOCK_FLAG_END_OF_SEQUENCE);
             p_frame_info->b_eos = b_eos;
             p_frame_info->b_display = b_need_output_picture;
+            p_frame_info->i_sent = vlc_tick_now();
 
             int ret = avcodec_send_packet(p_context, pkt);
             if( ret != 0 && ret != AVERROR(EAGAIN) )
@@ -1539,6 +1558,13 @@ static int DecodeBlock( decoder_t *p_dec, block_t **pp_block )
         struct frame_info_s *p_frame_info = FrameInfoGet( p_sys, frame );
         if( p_frame_info && p_frame_info->b_eos )
             p_sys->b_first_frame = true;
+        if( p_frame_info && p_frame_info->i_sent != 0 )
+        {
+            vlc_tick_t i_latency = vlc_tick_now() - p_frame_info->i_sent;
+            p_sys->i_latency_sum += i_latency;
+            p_sys->i_latency_max = __MAX( p_sys->i_latency_max, i_latency );
+            p_sys->i_latency_count++;
+        }
 
         vlc_mutex_lock(&p_sys->lock);
 
@@ -1634,9 +1660,13 @@ static int DecodeBlock( decoder_t *p_dec, block_t **pp_block )
                 picture_Release( p_pic );
                 break;
             }
+            p_sys->i_copied_frames++;
         }
         else
         {
+            if( p_sys->p_va == NULL )
+                p_sys->i_dr_frames++;
+
             /* Some codecs can return the same frame multiple times. By the
              * time that the same frame is returned a second time, it will be
              * too late to clone the underlying picture. So clone proactively.
@@ -1751,6 +1781,17 @@ void EndVideoDec( vlc_object_t *obj )
     cc_Flush( &p_sys->cc );
     avcodec_free_context( &ctx );
 
+    if( p_sys->i_budget_threads )
+        vlc_CPUBudgetRelease( p_sys->i_budget_threads );
+
+    if( p_sys->i_dr_frames || p_sys->i_copied_frames )
+        msg_Dbg( p_dec, "direct rendering: %"PRIu64" frames, copied: %"PRIu64" frames",
+                 p_sys->i_dr_frames, p_sys->i_copied_frames );
+    if( p_sys->i_latency_count )
+        msg_Dbg( p_dec, "decoding latency: average %"PRId64" us, max %"PRId64" us",
+                 US_FROM_VLC_TICK( p_sys->i_latency_sum / p_sys->i_latency_count ),
+                 US_FROM_VLC_TICK( p_sys->i_latency_max ) );
+
     if( p_sys->p_va )
         ffmpeg_CloseVa(p_dec, NULL);
 
@@ -1901,9 +1942,12 @@ static int lavc_dr_GetFrame(struct AVCodecContext *ctx, AVFrame *frame, int flag
 
     avcodec_align_dimensions2(ctx, &width, &height, aligns);
 
-    /* Check that the picture is suitable for libavcodec */
-    assert(pic->p[0].i_pitch >= width * pic->p[0].i_pixel_pitch);
-    assert(pic->p[0].i_lines >= height);
+    /* Check that the picture is suitable for libavcodec. In frame threading
+     * mode, pending frames can still request buffers of the previous format:
+     * only skip direct rendering for those. */
+    if (pic->p[0].i_pitch < width * pic->p[0].i_pixel_pitch ||
+        pic->p[0].i_lines < height)
+        goto error;
 
     for (int i = 0; i < pic->i_planes; i++)
     {
@@ -0,0 +1,338 @@
+/*****************************************************************************
+ * vulkan.c: Vulkan Video helpers for the libavcodec decoder
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_codec.h>
+#include <vlc_fourcc.h>
+#include <vlc_picture.h>
+
+#include <libavcodec/avcodec.h>
+#include <libavutil/hwcontext_vulkan.h>
+
+#include "avcodec.h"
+#include "va.h"
+#include "../../video_output/vulkan/device.h"
+
+struct vulkan_vctx
+{
+    AVBufferRef *hwframes_ref;
+};
+
+typedef struct {
+    struct vlc_vk_picture_context ctx;
+    AVFrame *avframe;
+    AVHWFramesContext *hwframes_ctx;
+} vulkan_dec_pic_context;
+
+static void LockFrame(struct vlc_vk_picture_context *context)
+{
+    vulkan_dec_pic_context *pic_ctx =
+        container_of(context, vulkan_dec_pic_context, ctx);
+    AVVulkanFramesContext *vkfc = pic_ctx->hwframes_ctx->hwctx;
+
+    vkfc->lock_frame(pic_ctx->hwframes_ctx,
+                     (AVVkFrame *) pic_ctx->avframe->data[0]);
+}
+
+static void UnlockFrame(struct vlc_vk_picture_context *context)
+{
+    vulkan_dec_pic_context *pic_ctx =
+        container_of(context, vulkan_dec_pic_context, ctx);
+    AVVulkanFramesContext *vkfc = pic_ctx->hwframes_ctx->hwctx;
+
+    vkfc->unlock_frame(pic_ctx->hwframes_ctx,
+                       (AVVkFrame *) pic_ctx->avframe->data[0]);
+}
+
+static void vulkan_dec_pic_context_destroy(picture_context_t *context)
+{
+    vulkan_dec_pic_context *pic_ctx =
+        container_of(context, vulkan_dec_pic_context, ctx.s);
+
+    av_frame_free(&pic_ctx->avframe);
+    free(pic_ctx);
+}
+
+static picture_context_t *vulkan_dec_pic_context_copy(picture_context_t *src)
+{
+    vulkan_dec_pic_context *src_ctx =
+        container_of(src, vulkan_dec_pic_context, ctx.s);
+    vulkan_dec_pic_context *pic_ctx = malloc(sizeof(*pic_ctx));
+    if (unlikely(pic_ctx == NULL))
+        return NULL;
+
+    *pic_ctx = *src_ctx;
+
+    pic_ctx->avframe = av_frame_clone(src_ctx->avframe);
+    if (!pic_ctx->avframe)
+    {
+        free(pic_ctx);
+        return NULL;
+    }
+
+    vlc_video_context_Hold(pic_ctx->ctx.s.vctx);
+    return &pic_ctx->ctx.s;
+}
+
+static int Get(vlc_va_t *va, picture_t *pic, AVCodecContext *ctx, AVFrame *frame)
+{
+    vlc_video_context *vctx = va->sys;
+
+    int ret = av_hwframe_get_buffer(ctx->hw_frames_ctx, frame, 0);
+    if (ret)
+    {
+        msg_Err(va, "vulkan_va: av_hwframe_get_buffer failed: %d", ret);
+        return ret;
+    }
+
+    vulkan_dec_pic_context *pic_ctx = malloc(sizeof(*pic_ctx));
+    if (unlikely(pic_ctx == NULL))
+        return VLC_ENOMEM;
+
+    pic_ctx->avframe = av_frame_clone(frame);
+    if (unlikely(pic_ctx->avframe == NULL))
+    {
+        free(pic_ctx);
+        return VLC_ENOMEM;
+    }
+#if LIBAVCODEC_VERSION_CHECK(61, 03, 100)
+    av_frame_side_data_free(&pic_ctx->avframe->side_data, &pic_ctx->avframe->nb_side_data);
+#endif
+    av_buffer_unref(&pic_ctx->avframe->opaque_ref);
+    pic_ctx->avframe->opaque = NULL;
+
+    pic_ctx->hwframes_ctx = (AVHWFramesContext *) ctx->hw_frames_ctx->data;
+    AVVulkanFramesContext *vkfc = pic_ctx->hwframes_ctx->hwctx;
+    AVVkFrame *vkf = (AVVkFrame *) frame->data[0];
+
+    pic_ctx->ctx.s = (picture_context_t) {
+        vulkan_dec_pic_context_destroy, vulkan_dec_pic_context_copy, vctx,
+    };
+    pic_ctx->ctx.image = vkf->img[0];
+    pic_ctx->ctx.format = vkfc->format[0];
+    pic_ctx->ctx.usage = vkfc->usage;
+    pic_ctx->ctx.width = pic_ctx->hwframes_ctx->width;
+    pic_ctx->ctx.height = pic_ctx->hwframes_ctx->height;
+    pic_ctx->ctx.layout = &vkf->layout[0];
+    pic_ctx->ctx.semaphore = vkf->sem[0];
+    pic_ctx->ctx.semaphore_value = &vkf->sem_value[0];
+    pic_ctx->ctx.lock = LockFrame;
+    pic_ctx->ctx.unlock = UnlockFrame;
+
+    pic->context = &pic_ctx->ctx.s;
+    vlc_video_context_Hold(vctx);
+
+    return VLC_SUCCESS;
+}
+
+static void Delete(vlc_va_t *va, AVCodecContext* ctx)
+{
+    if (ctx)
+        av_buffer_unref(&ctx->hw_frames_ctx);
+    vlc_video_context_Release(va->sys);
+}
+
+static void vulkan_ctx_destroy(void *priv)
+{
+    struct vulkan_vctx *vulkan_vctx = priv;
+
+    av_buffer_unref(&vulkan_vctx->hwframes_ref);
+}
+
+static const struct vlc_va_operations ops =
+{
+    .get = Get,
+    .close = Delete,
+};
+
+static const struct vlc_video_context_operations vulkan_ctx_ops =
+{
+    .destroy = vulkan_ctx_destroy,
+};
+
+static void LockQueue(AVHWDeviceContext *hwdev_ctx, uint32_t family,
+                      uint32_t index)
+{
+    vlc_vk_device_t *vk = hwdev_ctx->user_opaque;
+    vk->lock_queue(vk, family, index);
+}
+
+static void UnlockQueue(AVHWDeviceContext *hwdev_ctx, uint32_t family,
+                        uint32_t index)
+{
+    vlc_vk_device_t *vk = hwdev_ctx->user_opaque;
+    vk->unlock_queue(vk, family, index);
+}
+
+static int Create(vlc_va_t *va, struct vlc_va_cfg *cfg)
+{
+    AVCodecContext *ctx = cfg->avctx;
+    enum AVPixelFormat hwfmt = cfg->hwfmt;
+    vlc_decoder_device *dec_device = cfg->dec_device;
+    video_format_t *fmt_out = cfg->video_fmt_out;
+
+    if (hwfmt != AV_PIX_FMT_VULKAN || dec_device == NULL ||
+        dec_device->type != VLC_DECODER_DEVICE_VULKAN)
+        return VLC_EGENERIC;
+
+    vlc_vk_device_t *vk = dec_device->opaque;
+    if (vk->queue_decode.index < 0)
+    {
+        msg_Dbg(va, "Vulkan device without a video decode queue");
+        return VLC_EGENERIC;
+    }
+
+    AVBufferRef *hwdev_ref = av_hwdevice_ctx_alloc(AV_HWDEVICE_TYPE_VULKAN);
+    if (hwdev_ref == NULL)
+        return VLC_EGENERIC;
+
+    AVHWDeviceContext *hwdev_ctx = (void *) hwdev_ref->data;
+    AVVulkanDeviceContext *vkdev_ctx = hwdev_ctx->hwctx;
+
+    hwdev_ctx->user_opaque = vk;
+    vkdev_ctx->get_proc_addr = vk->get_proc_address;
+    vkdev_ctx->inst = vk->instance;
+    vkdev_ctx->phys_dev = vk->physical_device;
+    vkdev_ctx->act_dev = vk->device;
+    vkdev_ctx->device_features = *vk->features;
+    vkdev_ctx->enabled_inst_extensions = vk->instance_extensions;
+    vkdev_ctx->nb_enabled_inst_extensions = vk->num_instance_extensions;
+    vkdev_ctx->enabled_dev_extensions = vk->device_extensions;
+    vkdev_ctx->nb_enabled_dev_extensions = vk->num_device_extensions;
+    vkdev_ctx->queue_family_index = vk->queue_graphics.index;
+    vkdev_ctx->nb_graphics_queues = vk->queue_graphics.count;
+    vkdev_ctx->queue_family_tx_index = vk->queue_transfer.index;
+    vkdev_ctx->nb_tx_queues = vk->queue_transfer.count;
+    vkdev_ctx->queue_family_comp_index = vk->queue_compute.index;
+    vkdev_ctx->nb_comp_queues = vk->queue_compute.count;
+    vkdev_ctx->queue_family_decode_index = vk->queue_decode.index;
+    vkdev_ctx->nb_decode_queues = vk->queue_decode.count;
+    vkdev_ctx->queue_family_encode_index = -1;
+    vkdev_ctx->nb_encode_queues = 0;
+    vkdev_ctx->lock_queue = LockQueue;
+    vkdev_ctx->unlock_queue = UnlockQueue;
+
+    if (av_hwdevice_ctx_init(hwdev_ref) < 0)
+    {
+        av_buffer_unref(&hwdev_ref);
+        return VLC_EGENERIC;
+    }
+
+    AVBufferRef *hwframes_ref;
+    int ret = avcodec_get_hw_frames_parameters(ctx, hwdev_ref, hwfmt, &hwframes_ref);
+    av_buffer_unref(&hwdev_ref);
+    if (ret < 0)
+    {
+        msg_Err(va, "avcodec_get_hw_frames_parameters failed: %d", ret);
+        return VLC_EGENERIC;
+    }
+
+    AVHWFramesContext *hwframes_ctx = (AVHWFramesContext*)hwframes_ref->data;
+    AVVulkanFramesContext *vkfc = hwframes_ctx->hwctx;
+
+    if (hwframes_ctx->initial_pool_size)
+    {
+        // cf. ff_decode_get_hw_frames_ctx()
+        // We guarantee 4 base work surfaces. The function above guarantees 1
+        // (the absolute minimum), so add the missing count.
+        hwframes_ctx->initial_pool_size += 3;
+    }
+
+    // The renderer samples the decoded images directly
+    if (vkfc->usage)
+        vkfc->usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+
+    ret = av_hwframe_ctx_init(hwframes_ref);
+    if (ret < 0)
+    {
+        msg_Err(va, "av_hwframe_ctx_init failed: %d", ret);
+        av_buffer_unref(&hwframes_ref);
+        return VLC_EGENERIC;
+    }
+
+    int vlc_chroma = 0;
+    // Only single multi-planar images can be wrapped by the renderer
+    if (vkfc->format[1] == VK_FORMAT_UNDEFINED)
+    {
+        switch (hwframes_ctx->sw_format)
+        {
+            case AV_PIX_FMT_NV12:
+                vlc_chroma = VLC_CODEC_VULKAN_420;
+                break;
+            case AV_PIX_FMT_P010LE:
+                vlc_chroma = VLC_CODEC_VULKAN_420_10BPP;
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (vlc_chroma == 0)
+    {
+        msg_Warn(va, "ffmpeg chroma not compatible with vlc: hw: %s, sw: %s",
+                 av_get_pix_fmt_name(hwframes_ctx->format),
+                 av_get_pix_fmt_name(hwframes_ctx->sw_format));
+        av_buffer_unref(&hwframes_ref);
+        return VLC_EGENERIC;
+    }
+
+    ctx->hw_frames_ctx = av_buffer_ref(hwframes_ref);
+    if (!ctx->hw_frames_ctx)
+    {
+        av_buffer_unref(&hwframes_ref);
+        return VLC_EGENERIC;
+    }
+
+    vlc_video_context *vctx =
+        vlc_video_context_Create(dec_device, VLC_VIDEO_CONTEXT_VULKAN,
+                                 sizeof(struct vulkan_vctx), &vulkan_ctx_ops);
+    if (vctx == NULL)
+    {
+        av_buffer_unref(&hwframes_ref);
+        av_buffer_unref(&ctx->hw_frames_ctx);
+        return VLC_EGENERIC;
+    }
+
+    struct vulkan_vctx *vulkan_vctx =
+        vlc_video_context_GetPrivate(vctx, VLC_VIDEO_CONTEXT_VULKAN);
+    vulkan_vctx->hwframes_ref = hwframes_ref;
+
+    msg_Info(va, "Using Vulkan Video decoding");
+
+    fmt_out->i_chroma = vlc_chroma;
+
+    va->ops = &ops;
+    va->sys = vctx;
+    cfg->vctx_out = vctx;
+    cfg->use_hwframes = true;
+    return VLC_SUCCESS;
+}
+
+vlc_module_begin ()
+    set_description( N_("Vulkan Video decoder") )
+    set_va_callback( Create, 100 )
+    add_shortcut( "vulkan" )
+    set_subcategory( SUBCAT_INPUT_VCODEC )
+vlc_module_end ()
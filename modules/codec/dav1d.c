@@ -85,6 +85,11 @@ typedef struct
     Dav1dSettings s;
     Dav1dContext *c;
     cc_data_t cc;
+    unsigned budget_threads; /* threads taken from the shared CPU budget */
+    /* time between sending data and getting its picture */
+    vlc_tick_t latency_sum;
+    vlc_tick_t latency_max;
+    uint64_t latency_count;
 } decoder_sys_t;
 
 struct user_data_s
@@ -312,6 +317,9 @@ static int Decode(decoder_t *dec, block_t *block)
         }
 
         p_data->m.timestamp = block->i_pts == VLC_TICK_INVALID ? block->i_dts : block->i_pts;
+        /* the stream offset is not used otherwise, it is passed through to the
+         * picture as is: use it to measure the decoding latency */
+        p_data->m.offset = vlc_tick_now();
         if(block->i_dts != p_data->m.timestamp)
         {
             struct user_data_s *userdata = malloc(sizeof(*userdata));
@@ -373,6 +381,13 @@ static int Decode(decoder_t *dec, block_t *block)
                 }
                 pic->b_progressive = true; /* codec does not support interlacing */
                 pic->date = img.m.timestamp;
+                if (img.m.offset > 0)
+                {
+                    vlc_tick_t latency = vlc_tick_now() - img.m.offset;
+                    p_sys->latency_sum += latency;
+                    p_sys->latency_max = __MAX(p_sys->latency_max, latency);
+                    p_sys->latency_count++;
+                }
                 decoder_QueueVideo(dec, pic);
                 ExtractCaptions(dec, &img);
                 dav1d_picture_unref(&img);
@@ -433,10 +448,17 @@ static int OpenDecoder(vlc_object_t *p_this)
         return VLC_ENOMEM;
 
     dav1d_default_settings(&p_sys->s);
+    p_sys->budget_threads = 0;
+    p_sys->latency_sum = p_sys->latency_max = 0;
+    p_sys->latency_count = 0;
+    const bool low_delay = var_InheritBool(p_this, "low-delay");
 #if DAV1D_API_VERSION_MAJOR >= 6
     p_sys->s.n_threads = var_InheritInteger(p_this, "dav1d-thread-frames");
     if (p_sys->s.n_threads == 0)
-        p_sys->s.n_threads = __MAX(1, vlc_GetCPUCount());
+    {
+        p_sys->budget_threads = vlc_CPUBudgetAcquire(0);
+        p_sys->s.n_threads = p_sys->budget_threads;
+    }
 
 #if DAV1D_API_VERSION_MAJOR > 6 || DAV1D_API_VERSION_MINOR >= 7
     // after dav1d 1.0.0
@@ -457,6 +479,10 @@ static int OpenDecoder(vlc_object_t *p_this)
     else
         p_sys->s.max_frame_delay = fc_lut[p_sys->s.n_threads - 1];
 #endif
+    /* no frame threading latency, the threads are still used for tiles and
+     * in-frame tasks */
+    if (low_delay)
+        p_sys->s.max_frame_delay = 1;
 
 #else // before dav1d 1.0.0
     p_sys->s.n_tile_threads = var_InheritInteger(p_this, "dav1d-thread-tiles");
@@ -464,7 +490,12 @@ static int OpenDecoder(vlc_object_t *p_this)
         p_sys->s.n_tile_threads = VLC_CLIP(vlc_GetCPUCount(), 1, 4);
     p_sys->s.n_frame_threads = var_InheritInteger(p_this, "dav1d-thread-frames");
     if (p_sys->s.n_frame_threads == 0)
-        p_sys->s.n_frame_threads = __MAX(1, vlc_GetCPUCount());
+    {
+        p_sys->budget_threads = vlc_CPUBudgetAcquire(0);
+        p_sys->s.n_frame_threads = p_sys->budget_threads;
+    }
+    if (low_delay)
+        p_sys->s.n_frame_threads = 1;
 #endif
     p_sys->s.all_layers = var_InheritBool( p_this, "dav1d-all-layers" );
     p_sys->s.allocator.cookie = dec;
@@ -510,6 +541,7 @@ static int OpenDecoder(vlc_object_t *p_this)
     if (dav1d_open(&p_sys->c, &p_sys->s) < 0)
     {
         msg_Err(p_this, "Could not open the Dav1d decoder");
+        vlc_CPUBudgetRelease(p_sys->budget_threads);
         return VLC_EGENERIC;
     }
 
@@ -574,4 +606,10 @@ static void CloseDecoder(vlc_object_t *p_this)
     FlushDecoder(dec);
 
     dav1d_close(&p_sys->c);
+    vlc_CPUBudgetRelease(p_sys->budget_threads);
+
+    if (p_sys->latency_count)
+        msg_Dbg(dec, "decoding latency: average %"PRId64" us, max %"PRId64" us",
+                US_FROM_VLC_TICK(p_sys->latency_sum / p_sys->latency_count),
+                US_FROM_VLC_TICK(p_sys->latency_max));
 }
@@ -73,6 +73,15 @@ vlc_module_end ()
 static int DecodeBlock( decoder_t *, block_t * );
 static void Flush( decoder_t * );
 
+#define LIBASS_MAX_REGIONS 4
+
+/* A region already drawn, reused while its content is unchanged */
+typedef struct
+{
+    picture_t      *p_picture;
+    uint64_t       i_hash;
+} libass_region_cache_t;
+
 /* */
 typedef struct
 {
@@ -89,6 +98,10 @@ typedef struct
 
     /* */
     ASS_Track      *p_track;
+
+    /* regions of the last rendering */
+    libass_region_cache_t cache[LIBASS_MAX_REGIONS];
+    int            i_cache;
 } decoder_sys_t;
 static void DecSysRelease( decoder_sys_t *p_sys );
 static void DecSysHold( decoder_sys_t *p_sys );
@@ -113,6 +126,7 @@ typedef struct
 
 static int BuildRegions( rectangle_t *p_region, int i_max_region, ASS_Image *p_img_list, int i_width, int i_height );
 static void RegionDraw( subpicture_region_t *p_region, ASS_Image *p_img );
+static uint64_t RegionHash( const rectangle_t *p_region, const ASS_Image *p_img );
 static void OldEngineClunkyRollInfoPatch( decoder_t *p_dec, ASS_Track * );
 
 //#define DEBUG_REGION
@@ -143,6 +157,7 @@ static int Create( vlc_object_t *p_this )
     p_sys->p_library  = NULL;
     p_sys->p_renderer = NULL;
     p_sys->p_track    = NULL;
+    p_sys->i_cache    = 0;
 
     /* Create libass library */
     ASS_Library *p_library = p_sys->p_library = ass_library_init();
@@ -305,6 +320,8 @@ static void DecSysRelease( decoder_sys_t *p_sys )
     }
     vlc_mutex_unlock( &p_sys->lock );
 
+    for( int i = 0; i < p_sys->i_cache; i++ )
+        picture_Release( p_sys->cache[i].p_picture );
     if( p_sys->p_track )
         ass_free_track( p_sys->p_track );
     if( p_sys->p_renderer )
@@ -466,15 +483,12 @@ static void SubpictureUpdate( subpicture_t *p_subpic,
      * reinstanciate a lot the scaler, and as we do not support subpel blending
      * it looks ugly (text unaligned).
      */
-    const int i_max_region = 4;
+    const int i_max_region = LIBASS_MAX_REGIONS;
     rectangle_t region[i_max_region];
     const int i_region = BuildRegions( region, i_max_region, p_img, p_fmt_dst->i_width, p_fmt_dst->i_height );
 
-    if( i_region <= 0 )
-    {
-        vlc_mutex_unlock( &p_sys->lock );
-        return;
-    }
+    libass_region_cache_t cache[LIBASS_MAX_REGIONS];
+    int i_cache = 0;
 
     /* Allocate the regions and draw them */
     video_format_t fmt_region;
@@ -488,7 +502,7 @@ static void SubpictureUpdate( subpicture_t *p_subpic,
     fmt_region.color_range = COLOR_RANGE_FULL;
     for( int i = 0; i < i_region; i++ )
     {
-        subpicture_region_t *r;
+        subpicture_region_t *r = NULL;
 
         /* */
         fmt_region.i_width =
@@ -496,20 +510,47 @@ static void SubpictureUpdate( subpicture_t *p_subpic,
         fmt_region.i_height =
         fmt_region.i_visible_height = region[i].y1 - region[i].y0;
 
-        r = subpicture_region_New( &fmt_region );
-        if( !r )
-            break;
+        /* Most updates only move or change some of the lines, the other
+         * regions are already drawn by a previous update */
+        const uint64_t i_hash = RegionHash( &region[i], p_img );
+        for( int j = 0; j < p_sys->i_cache; j++ )
+        {
+            picture_t *p_pic = p_sys->cache[j].p_picture;
+            if( p_sys->cache[j].i_hash == i_hash &&
+                p_pic->format.i_width == fmt_region.i_width &&
+                p_pic->format.i_height == fmt_region.i_height )
+            {
+                r = subpicture_region_ForPicture( p_pic );
+                break;
+            }
+        }
+
+        if( r == NULL )
+        {
+            r = subpicture_region_New( &fmt_region );
+            if( !r )
+                break;
+            r->i_x = region[i].x0;
+            r->i_y = region[i].y0;
+            RegionDraw( r, p_img );
+        }
         r->b_absolute = true; r->b_in_window = false;
         r->i_x = region[i].x0;
         r->i_y = region[i].y0;
         r->i_align = SUBPICTURE_ALIGN_TOP | SUBPICTURE_ALIGN_LEFT;
 
-        /* */
-        RegionDraw( r, p_img );
+        cache[i_cache].p_picture = picture_Hold( r->p_picture );
+        cache[i_cache].i_hash = i_hash;
+        i_cache++;
 
         /* */
         vlc_spu_regions_push(&p_subpic->regions, r);
     }
+
+    for( int i = 0; i < p_sys->i_cache; i++ )
+        picture_Release( p_sys->cache[i].p_picture );
+    memcpy( p_sys->cache, cache, i_cache * sizeof(*cache) );
+    p_sys->i_cache = i_cache;
     vlc_mutex_unlock( &p_sys->lock );
 
 }
@@ -675,6 +716,51 @@ static int BuildRegions( rectangle_t *p_region, int i_max_region, ASS_Image *p_i
     return i_region;
 }
 
+/* Hash the images drawn in a region, relatively to the region position */
+static uint64_t RegionHash( const rectangle_t *p_region, const ASS_Image *p_img )
+{
+    const int i_width  = p_region->x1 - p_region->x0;
+    const int i_height = p_region->y1 - p_region->y0;
+    uint64_t i_hash = UINT64_C(0xcbf29ce484222325); /* FNV-1a */
+
+#define HASH( v ) i_hash = ( i_hash ^ (uint32_t)(v) ) * UINT64_C(0x100000001b3)
+    HASH( i_width );
+    HASH( i_height );
+    for( ; p_img != NULL; p_img = p_img->next )
+    {
+        /* Same selection as RegionDraw() */
+        int i_dst_x = p_img->dst_x - p_region->x0;
+        int i_dst_y = p_img->dst_y - p_region->y0;
+        if( p_img->w <= 0 || p_img->h <= 0 ||
+            i_dst_x < 0 || i_dst_x + p_img->w > i_width ||
+            i_dst_y < 0 || i_dst_y + p_img->h > i_height ||
+            ( ~p_img->color & 0xff ) == 0 )
+            continue;
+
+        HASH( i_dst_x );
+        HASH( i_dst_y );
+        HASH( p_img->w );
+        HASH( p_img->h );
+        HASH( p_img->color );
+
+        const uint8_t *row = p_img->bitmap;
+        for( int y = 0; y < p_img->h; y++, row += p_img->stride )
+        {
+            int x = 0;
+            for( ; x + 4 <= p_img->w; x += 4 )
+            {
+                uint32_t v;
+                memcpy( &v, &row[x], sizeof(v) );
+                HASH( v );
+            }
+            for( ; x < p_img->w; x++ )
+                HASH( row[x] );
+        }
+    }
+#undef HASH
+    return i_hash;
+}
+
 static void RegionDraw( subpicture_region_t *p_region, ASS_Image *p_img )
 {
     const plane_t *p = &p_region->p_picture->p[0];
@@ -718,7 +804,7 @@ static void RegionDraw( subpicture_region_t *p_region, ASS_Image *p_img )
                 {
                     unsigned i_an = a * opacity / 255U;
                     unsigned i_ao = dst[3];
-                    if( i_ao == 0 )
+                    if( i_ao == 0 || i_an == 255 )
                     {
                         dst[0] = r;
                         dst[1] = g;
@@ -902,6 +902,9 @@ static int Statistics(struct cli_client *cl, const char *const *args,
                    (float)(item->p_stats->i_read_bytes) / 1024.f);
         cli_printf(cl, _("| input bitrate    :   %6.0f kb/s"),
                    (float)(item->p_stats->f_input_bitrate) * 8000.f);
+        if (item->p_stats->i_read_dropped > 0)
+            cli_printf(cl, _("| packets dropped  :    %5"PRIi64),
+                       item->p_stats->i_read_dropped);
         cli_printf(cl, _("| demux bytes read : %8.0f KiB"),
                    (float)(item->p_stats->i_demux_read_bytes) / 1024.f);
         cli_printf(cl, _("| demux bitrate    :   %6.0f kb/s"),
@@ -910,6 +913,12 @@ static int Statistics(struct cli_client *cl, const char *const *args,
                    item->p_stats->i_demux_corrupted);
         cli_printf(cl, _("| discontinuities  :    %5"PRIi64),
                   item->p_stats->i_demux_discontinuity);
+        cli_printf(cl, _("| clock skew       :   %6.1f ppm"),
+                   item->p_stats->f_clock_skew);
+        cli_printf(cl, _("| clock jitter     :    %5"PRId64" ms"),
+                   MS_FROM_VLC_TICK(item->p_stats->i_clock_jitter));
+        cli_printf(cl, _("| seek latency     :    %5"PRId64" ms"),
+                   MS_FROM_VLC_TICK(item->p_stats->i_seek_latency));
         cli_printf(cl, "|");
 
         /* Video */
@@ -922,6 +931,37 @@ static int Statistics(struct cli_client *cl, const char *const *args,
                    item->p_stats->i_late_pictures);
         cli_printf(cl, _("| frames lost      :    %5"PRIi64),
                    item->p_stats->i_lost_pictures);
+        if (item->p_stats->i_render_time > 0
+         && item->p_stats->i_displayed_pictures > 0)
+            cli_printf(cl, _("| GPU time / frame :   %6.2f ms"),
+                       (float)item->p_stats->i_render_time
+                       / item->p_stats->i_displayed_pictures
+                       / VLC_TICK_FROM_MS(1));
+        const struct
+        {
+            const char *name;
+            const uint64_t *buckets;
+        } frame_latencies[] = {
+            { _("queued"), item->p_stats->i_frame_queue },
+            { _("rendered"), item->p_stats->i_frame_render },
+            { _("presented"), item->p_stats->i_frame_present },
+        };
+        for (size_t j = 0; j < ARRAY_SIZE(frame_latencies); j++)
+        {
+            const uint64_t *buckets = frame_latencies[j].buckets;
+            for (unsigned i = 0; i < INPUT_STATS_FRAME_LATENCY_BUCKETS; i++)
+            {
+                if (buckets[i] == 0)
+                    continue;
+                if (i + 1 < INPUT_STATS_FRAME_LATENCY_BUCKETS)
+                    cli_printf(cl, _("| %-9s < %3u ms :  %5"PRIu64),
+                               frame_latencies[j].name, 1u << i,
+                               buckets[i]);
+                else
+                    cli_printf(cl, _("| %-9s longer  :  %5"PRIu64),
+                               frame_latencies[j].name, buckets[i]);
+            }
+        }
         cli_printf(cl, "|");
 
         /* Audio*/
@@ -934,6 +974,25 @@ static int Statistics(struct cli_client *cl, const char *const *args,
                    item->p_stats->i_lost_abuffers);
         cli_printf(cl, "|");
 
+        /* Decoder queues */
+        cli_printf(cl, "%s", _("+-[Decoder Queues]"));
+        cli_printf(cl, _("| blocks queued    :    %5"PRIi64),
+                   item->p_stats->i_queued_blocks);
+        cli_printf(cl, _("| bytes queued     : %8.0f KiB"),
+                   (float)(item->p_stats->i_queued_bytes) / 1024.f);
+        cli_printf(cl, _("| blocks dropped   :    %5"PRIi64),
+                   item->p_stats->i_dropped_blocks);
+        for (unsigned i = 0; i < INPUT_STATS_QUEUE_LATENCY_BUCKETS; i++)
+        {
+            if (i + 1 < INPUT_STATS_QUEUE_LATENCY_BUCKETS)
+                cli_printf(cl, _("| waited < %4u ms :    %5"PRIi64),
+                           1u << (2 * i), item->p_stats->i_queue_latency[i]);
+            else
+                cli_printf(cl, _("| waited longer    :    %5"PRIi64),
+                           item->p_stats->i_queue_latency[i]);
+        }
+        cli_printf(cl, "|");
+
         vlc_mutex_unlock(&item->lock);
         cli_printf(cl,  "+----[ end of statistical info ]" );
     }
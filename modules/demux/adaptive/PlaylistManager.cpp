@@ -72,6 +72,7 @@ PlaylistManager::PlaylistManager( demux_t *p_demux_,
     b_buffering = false;
     b_canceled = false;
     b_preparsing = false;
+    b_faststart = var_InheritBool(p_demux, "adaptive-faststart");
     nextPlaylistupdate = 0;
     demux.pcr_syncpoint = TimestampSynchronizationPoint::RandomAccess;
     vlc_mutex_init(&demux.lock);
@@ -89,6 +90,8 @@ PlaylistManager::PlaylistManager( demux_t *p_demux_,
 
 PlaylistManager::~PlaylistManager   ()
 {
+    if(!b_preparsing)
+        statistics.dump(VLC_OBJECT(p_demux));
     delete streamFactory;
     unsetPeriod();
     delete playlist;
@@ -116,6 +119,8 @@ bool PlaylistManager::setupPeriod()
     if(!bufferingLogic && !(bufferingLogic = createBufferingLogic()))
         return false;
 
+    resources->getConnManager()->setLowLatency(bufferingLogic->isLowLatency(playlist));
+
     const std::vector<BaseAdaptationSet*> &sets = currentPeriod->getAdaptationSets();
     for(BaseAdaptationSet *set : sets)
     {
@@ -126,6 +131,8 @@ bool PlaylistManager::setupPeriod()
                                                          &synchronizationReferences);
             if(!tracker)
                 continue;
+            tracker->registerListener(&statistics);
+            tracker->setFastStart(b_faststart);
 
             AbstractStream *st = streamFactory->create(p_demux, set->getStreamFormat(),
                                                        tracker);
@@ -159,7 +166,19 @@ bool PlaylistManager::init(bool b_preparsing)
     nextPlaylistupdate = playlist->playbackStart.Get();
 
     if(b_preparsing)
+    {
         preparsePlaylist();
+    }
+    else
+    {
+        statistics.playbackStarting(vlc_tick_now());
+        /* Don't wait for each stream turn to request its first segments */
+        if(b_faststart)
+        {
+            for(AbstractStream *st : streams)
+                st->prefetch();
+        }
+    }
     updateControlsPosition();
 
     return true;
@@ -347,6 +366,7 @@ bool PlaylistManager::setPosition(vlc_tick_t mediatime, double pos, bool accurat
     bool ret = true;
     bool hasValidStream = false;
     StreamPosition streampos;
+    statistics.playbackReset();
     streampos.times = demux.firsttimes;
     if(streampos.times.continuous != VLC_TICK_INVALID)
         streampos.times.offsetBy(mediatime - streampos.times.segment.media);
@@ -515,6 +535,7 @@ int PlaylistManager::doDemux(vlc_tick_t increment)
         }
         break;
     case AbstractStream::Status::Buffering:
+        statistics.playbackStarved(vlc_tick_now());
         vlc_mutex_lock(&demux.lock);
         vlc_cond_timedwait(&demux.cond, &demux.lock, vlc_tick_now() + VLC_TICK_FROM_MS(50));
         vlc_mutex_unlock(&demux.lock);
@@ -528,6 +549,7 @@ int PlaylistManager::doDemux(vlc_tick_t increment)
         vlc_mutex_unlock(&demux.lock);
         break;
     case AbstractStream::Status::Demuxed:
+        statistics.playbackResumed(vlc_tick_now());
         vlc_mutex_lock(&demux.lock);
         if( demux.times.continuous != VLC_TICK_INVALID && barrier.continuous != demux.times.continuous )
         {
@@ -924,6 +946,13 @@ AbstractAdaptationLogic *PlaylistManager::createLogic(AbstractAdaptationLogic::L
         }
 
         logic->setMaxDeviceResolution(w, h);
+
+        char *psz_estimator = var_InheritString(p_demux, "adaptive-bw-estimator");
+        if(psz_estimator)
+        {
+            logic->setBandwidthEstimatorType(BandwidthEstimator::typeFromName(psz_estimator));
+            free(psz_estimator);
+        }
     }
 
     return logic;
@@ -940,6 +969,9 @@ AbstractBufferingLogic *PlaylistManager::createBufferingLogic() const
         v = var_InheritInteger(p_demux, "adaptive-maxbuffer");
         if(v)
             bl->setUserMaxBuffering(VLC_TICK_FROM_MS(v));
+        int lowlatency = var_InheritInteger(p_demux, "adaptive-lowlatency");
+        if(lowlatency != -1)
+            bl->setLowDelay(lowlatency == 1);
     }
     return bl;
 }
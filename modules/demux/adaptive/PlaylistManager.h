@@ -23,6 +23,7 @@
 #define PLAYLISTMANAGER_H_
 
 #include "logic/AbstractAdaptationLogic.h"
+#include "logic/AdaptationStatistics.hpp"
 #include "Streams.hpp"
 #include <vector>
 
@@ -104,12 +105,14 @@ namespace adaptive
             AbstractAdaptationLogic::LogicType  logicType;
             AbstractAdaptationLogic             *logic;
             AbstractBufferingLogic              *bufferingLogic;
+            AdaptationStatistics                 statistics;
             BasePlaylist                    *playlist;
             AbstractStreamFactory               *streamFactory;
             demux_t                             *p_demux;
             std::vector<AbstractStream *>        streams;
             BasePeriod                          *currentPeriod;
             bool                                 b_preparsing;
+            bool                                 b_faststart;
 
             enum class TimestampSynchronizationPoint
             {
@@ -31,6 +31,7 @@
 #include "playlist/SegmentChunk.hpp"
 #include "logic/AbstractAdaptationLogic.h"
 #include "logic/BufferingLogic.hpp"
+#include "logic/Representationselectors.hpp"
 
 #include <cassert>
 #include <limits>
@@ -137,6 +138,7 @@ SegmentTracker::SegmentTracker(SharedResources *res,
     resources = res;
     first = true;
     initializing = true;
+    faststart = false;
     bufferingLogic = bl;
     setAdaptationLogic(logic_);
     adaptationSet = adaptSet;
@@ -486,7 +488,19 @@ void SegmentTracker::setPosition(const Position &pos, bool restarted)
 SegmentTracker::Position SegmentTracker::getStartPosition() const
 {
     Position pos;
-    pos.rep = logic->getNextRepresentation(adaptationSet, nullptr);
+    if(faststart)
+    {
+        /* No bandwidth estimate yet, first segment is fastest at lowest */
+        RepresentationSelector selector(std::numeric_limits<int>::max(),
+                                        std::numeric_limits<int>::max());
+        pos.rep = selector.lowest(adaptationSet);
+        /* Handle HLS specific cases where the lowest is audio only. Try to pick first A+V */
+        BaseRepresentation *higher = pos.rep ? selector.higher(adaptationSet, pos.rep) : nullptr;
+        if(higher && higher != pos.rep &&
+           pos.rep->getCodecs().size() == 1 && higher->getCodecs().size() > 1)
+            pos.rep = higher;
+    }
+    else pos.rep = logic->getNextRepresentation(adaptationSet, nullptr);
     if(pos.rep)
     {
         /* Ensure ephemere content is updated/loaded */
@@ -499,6 +513,37 @@ SegmentTracker::Position SegmentTracker::getStartPosition() const
     return pos;
 }
 
+void SegmentTracker::setFastStart(bool b)
+{
+    faststart = b;
+}
+
+bool SegmentTracker::prefetchStartChunks()
+{
+    if(current.isValid() || !chunkssequence.empty() || !setStartPosition())
+        return false;
+
+    /* Queue init, index and first media segment, as creating
+       the chunks starts their download */
+    Position pos = next;
+    for(;;)
+    {
+        ChunkEntry entry = prepareChunk(false, pos);
+        if(!entry.isValid())
+        {
+            delete entry.chunk;
+            break;
+        }
+        chunkssequence.push_back(entry);
+        if(entry.pos.index_sent) /* media segment */
+            break;
+        pos = entry.pos;
+        ++pos;
+    }
+
+    return !chunkssequence.empty();
+}
+
 bool SegmentTracker::setStartPosition()
 {
     if(next.isValid())
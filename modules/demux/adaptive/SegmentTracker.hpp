@@ -227,6 +227,8 @@ namespace adaptive
             void setPosition(const Position &, bool);
             bool setStartPosition();
             Position getStartPosition() const;
+            void setFastStart(bool);
+            bool prefetchStartChunks();
             vlc_tick_t getPlaybackTime(bool = false) const; /* Current segment start time if selected */
             bool getMediaPlaybackRange(vlc_tick_t *, vlc_tick_t *, vlc_tick_t *) const;
             vlc_tick_t getMinAheadTime() const;
@@ -258,6 +260,7 @@ namespace adaptive
             void notify(const TrackerEvent &) const;
             bool first;
             bool initializing;
+            bool faststart;
             Position current;
             Position next;
             StreamFormat format;
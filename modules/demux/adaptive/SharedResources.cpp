@@ -25,16 +25,19 @@
 #include "http/AuthStorage.hpp"
 #include "http/HTTPConnectionManager.h"
 #include "http/HTTPConnection.hpp"
+#include "http/SegmentCache.hpp"
 #include "encryption/Keyring.hpp"
 
 using namespace adaptive;
 
 SharedResources::SharedResources(AuthStorage *auth, Keyring *ring,
-                                 AbstractConnectionManager *conn)
+                                 AbstractConnectionManager *conn,
+                                 SegmentCache *cache)
 {
     authStorage = auth;
     encryptionKeyring = ring;
     connManager = conn;
+    segmentCache = cache;
 }
 
 SharedResources::~SharedResources()
@@ -42,6 +45,8 @@ SharedResources::~SharedResources()
     delete connManager;
     delete encryptionKeyring;
     delete authStorage;
+    if(segmentCache)
+        segmentCache->release();
 }
 
 AuthStorage * SharedResources::getAuthStorage()
@@ -59,6 +64,11 @@ AbstractConnectionManager * SharedResources::getConnManager()
     return connManager;
 }
 
+SegmentCache * SharedResources::getSegmentCache()
+{
+    return segmentCache;
+}
+
 SharedResources * SharedResources::createDefault(vlc_object_t *obj,
                                                  const std::string & playlisturl)
 {
@@ -71,5 +81,13 @@ SharedResources * SharedResources::createDefault(vlc_object_t *obj,
     ConnectionParams params(playlisturl);
     if(params.isLocal())
         m->setLocalConnectionsAllowed();
-    return new SharedResources(auth, keyring, m);
+    /* shared with all other adaptive playbacks */
+    SegmentCache *cache = nullptr;
+    size_t cachesize = var_InheritInteger(obj, "adaptive-cache-size");
+    if(cachesize)
+    {
+        cache = SegmentCache::acquire(cachesize * 1024);
+        m->setSegmentCache(cache);
+    }
+    return new SharedResources(auth, keyring, m, cache);
 }
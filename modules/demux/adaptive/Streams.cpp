@@ -56,6 +56,7 @@ AbstractStream::AbstractStream(demux_t * demux_)
     segmentTracker = nullptr;
     demuxersource = nullptr;
     demuxer = nullptr;
+    sparedemuxer = nullptr;
     fakeesout = nullptr;
     notfound_sequence = 0;
     mightalwaysstartfromzero = false;
@@ -115,6 +116,7 @@ AbstractStream::~AbstractStream()
     delete segmentTracker;
 
     delete demuxer;
+    delete sparedemuxer;
     delete demuxersource;
     delete fakeesout;
 }
@@ -133,7 +135,12 @@ void AbstractStream::prepareRestart(bool b_discontinuity)
         fakeEsOut()->commandsQueue()->Commit();
         /* ignoring demuxer's own Del commands */
         fakeEsOut()->commandsQueue()->setDrop(true);
-        delete demuxer;
+        /* Keep the stopped demuxer, the next one is likely of the same format
+           (discontinuities, switches between non bitswitchable variants) */
+        delete sparedemuxer;
+        demuxer->destroy();
+        sparedemuxer = demuxer;
+        sparedemuxerformat = demuxerformat;
         fakeEsOut()->commandsQueue()->setDrop(false);
         demuxer = nullptr;
     }
@@ -723,6 +730,19 @@ bool AbstractStream::getMediaAdvanceAmount(vlc_tick_t *duration) const
     return true;
 }
 
+bool AbstractStream::prefetch()
+{
+    vlc_mutex_locker locker(&lock);
+    if(!segmentTracker || !valid || disabled || currentChunk)
+        return false;
+
+    /* don't waste bandwidth on streams not selected by default */
+    if(!segmentTracker->getStreamRole().autoSelectable())
+        return false;
+
+    return segmentTracker->prefetchStartChunks();
+}
+
 bool AbstractStream::runUpdates(bool)
 {
     if(!valid)
@@ -754,14 +774,30 @@ block_t *AbstractStream::checkBlock(block_t *p_block, bool)
 
 AbstractDemuxer * AbstractStream::createDemux(const StreamFormat &format)
 {
-    AbstractDemuxer *ret = newDemux( VLC_OBJECT(p_realdemux), format,
-                                     (es_out_t *)fakeEsOut(), demuxersource );
+    AbstractDemuxer *ret;
+    if(sparedemuxer && sparedemuxerformat == format)
+    {
+        /* same module and settings, only the demux instance is recreated */
+        ret = sparedemuxer;
+    }
+    else
+    {
+        delete sparedemuxer;
+        ret = newDemux( VLC_OBJECT(p_realdemux), format,
+                        (es_out_t *)fakeEsOut(), demuxersource );
+    }
+    sparedemuxer = nullptr;
+
     if(ret && !ret->create())
     {
         delete ret;
         ret = nullptr;
     }
-    else fakeEsOut()->commandsQueue()->Commit();
+    else
+    {
+        demuxerformat = format;
+        fakeEsOut()->commandsQueue()->Commit();
+    }
 
     return ret;
 }
@@ -101,6 +101,7 @@ namespace adaptive
         bool getMediaPlaybackTimes(vlc_tick_t *, vlc_tick_t *, vlc_tick_t *) const;
         bool getMediaAdvanceAmount(vlc_tick_t *) const;
         bool runUpdates(bool = false);
+        bool prefetch();
 
         /* Used by demuxers fake streams */
         block_t *readNextBlock() override;
@@ -148,6 +149,9 @@ namespace adaptive
         } currentrep;
 
         AbstractDemuxer *demuxer;
+        StreamFormat demuxerformat; /* format the demuxer was created for */
+        AbstractDemuxer *sparedemuxer; /* stopped on restart, for reuse */
+        StreamFormat sparedemuxerformat;
         AbstractSourceStream *demuxersource;
         FakeESOut::LockedFakeEsOut fakeEsOut();
         FakeESOut::LockedFakeEsOut fakeEsOut() const;
@@ -78,12 +78,30 @@ static void Close   (vlc_object_t *);
 
 #define ADAPT_LOGIC_TEXT N_("Adaptive Logic")
 
+#define ADAPT_ESTIMATOR_TEXT N_("Bandwidth estimator")
+#define ADAPT_ESTIMATOR_LONGTEXT N_("How the download rate samples are averaged " \
+                                    "by the bandwidth based adaptive logics")
+
 #define ADAPT_ACCESS_TEXT N_("Use regular HTTP modules")
 #define ADAPT_ACCESS_LONGTEXT N_("Connect using HTTP access instead of custom HTTP code")
 
 #define ADAPT_LOWLATENCY_TEXT N_("Low latency")
 #define ADAPT_LOWLATENCY_LONGTEXT N_("Overrides low latency parameters")
 
+#define ADAPT_DLWORKERS_TEXT N_("Concurrent segment downloads")
+#define ADAPT_DLWORKERS_LONGTEXT N_("Number of segments downloaded in parallel, " \
+                                    "the stream closest to run out of data first")
+
+#define ADAPT_DLPERSTREAM_TEXT N_("Concurrent segment downloads per stream")
+
+#define ADAPT_FASTSTART_TEXT N_("Fast start")
+#define ADAPT_FASTSTART_LONGTEXT N_("Request the first segments of all streams " \
+                                    "at once, starting at the lowest quality")
+
+#define ADAPT_CACHESIZE_TEXT N_("Segment cache size (KiB)")
+#define ADAPT_CACHESIZE_LONGTEXT N_("Memory for downloaded segments kept for " \
+                                    "reuse by all streams and playbacks, 0 to disable")
+
 static const AbstractAdaptationLogic::LogicType pi_logics[] = {
                                 AbstractAdaptationLogic::LogicType::Default,
                                 AbstractAdaptationLogic::LogicType::Predictive,
@@ -116,6 +134,20 @@ static_assert( ARRAY_SIZE( pi_logics ) == ARRAY_SIZE( ppsz_logics ),
 static_assert( ARRAY_SIZE( pi_logics ) == ARRAY_SIZE( ppsz_logics_values ),
     "pi_logics and ppsz_logics_values shall have the same number of elements" );
 
+static const char *const ppsz_estimators_values[] = {
+                                "",
+                                "vhf",
+                                "ewma",
+                                "harmonic"};
+
+static const char *const ppsz_estimators[] = { N_("Default"),
+                                               N_("Vertical Horizontal Filter"),
+                                               N_("Exponentially Weighted Moving Average"),
+                                               N_("Sliding Harmonic Mean")};
+
+static_assert( ARRAY_SIZE( ppsz_estimators ) == ARRAY_SIZE( ppsz_estimators_values ),
+    "ppsz_estimators and ppsz_estimators_values shall have the same number of elements" );
+
 static const int rgi_latency[] = { -1, 1, 0 };
 
 static const char *const ppsz_latency[] = { N_("Auto"),
@@ -129,6 +161,9 @@ vlc_module_begin ()
         set_subcategory( SUBCAT_INPUT_DEMUX )
         add_string( "adaptive-logic",  "", ADAPT_LOGIC_TEXT, nullptr )
             change_string_list( ppsz_logics_values, ppsz_logics )
+        add_string( "adaptive-bw-estimator", "", ADAPT_ESTIMATOR_TEXT,
+                    ADAPT_ESTIMATOR_LONGTEXT )
+            change_string_list( ppsz_estimators_values, ppsz_estimators )
         add_integer( "adaptive-maxwidth",  0,
                      ADAPT_WIDTH_TEXT,  nullptr )
         add_integer( "adaptive-maxheight", 0,
@@ -143,6 +178,14 @@ vlc_module_begin ()
                      ADAPT_MAXBUFFER_TEXT, nullptr )
         add_integer( "adaptive-lowlatency", -1, ADAPT_LOWLATENCY_TEXT, ADAPT_LOWLATENCY_LONGTEXT )
             change_integer_list(rgi_latency, ppsz_latency)
+        add_integer_with_range( "adaptive-dl-workers", 2, 1, 8,
+                                ADAPT_DLWORKERS_TEXT, ADAPT_DLWORKERS_LONGTEXT )
+        add_integer_with_range( "adaptive-dl-perstream", 1, 1, 4,
+                                ADAPT_DLPERSTREAM_TEXT, nullptr )
+        add_bool( "adaptive-faststart", false, ADAPT_FASTSTART_TEXT,
+                  ADAPT_FASTSTART_LONGTEXT )
+        add_integer( "adaptive-cache-size", 8192, ADAPT_CACHESIZE_TEXT,
+                     ADAPT_CACHESIZE_LONGTEXT )
         set_callbacks( Open, Close )
 vlc_module_end ()
 
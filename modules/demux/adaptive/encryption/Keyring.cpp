@@ -36,6 +36,7 @@ Keyring::Keyring(vlc_object_t *obj_)
 {
     obj = obj_;
     vlc_mutex_init(&lock);
+    vlc_cond_init(&fetched);
 }
 
 Keyring::~Keyring()
@@ -46,40 +47,57 @@ KeyringKey Keyring::getKey(SharedResources *resources, const std::string &uri)
 {
     KeyringKey key;
 
-    vlc_mutex_locker locker(&lock);
-    std::map<std::string, KeyringKey>::iterator it = keys.find(uri);
-    if(it == keys.end())
+    vlc_mutex_lock(&lock);
+    for(;;)
     {
-        /* Pretty bad inside the lock */
-        msg_Dbg(obj, "Retrieving AES key %s", uri.c_str());
-        block_t *p_block = Retrieve::HTTP(resources, http::ChunkType::Key, uri);
-        if(p_block)
+        std::map<std::string, KeyringKey>::iterator it = keys.find(uri);
+        if(it != keys.end())
         {
-            if(p_block->i_buffer == 16)
+            std::list<std::string>::iterator it2 = std::find(lru.begin(), lru.end(), uri);
+            if(it2 != lru.begin())
             {
-                key.resize(16);
-                memcpy(&key[0], p_block->p_buffer, 16);
-                keys.insert(std::pair<std::string, KeyringKey>(uri, key));
+                lru.erase(it2);
                 lru.push_front(uri);
-                if(lru.size() > Keyring::MAX_KEYS)
-                {
-                    keys.erase(keys.find(lru.back()));
-                    lru.pop_back();
-                }
             }
-            block_Release(p_block);
+            key = (*it).second;
+            vlc_mutex_unlock(&lock);
+            return key;
         }
+        /* Variants sharing the same key wait for the pending request */
+        if(fetching.find(uri) == fetching.end())
+            break;
+        vlc_cond_wait(&fetched, &lock);
     }
-    else
+    fetching.insert(uri);
+    vlc_mutex_unlock(&lock);
+
+    /* Don't block other keys retrieval or lookups during the request */
+    msg_Dbg(obj, "Retrieving AES key %s", uri.c_str());
+    block_t *p_block = Retrieve::HTTP(resources, http::ChunkType::Key, uri);
+    if(p_block)
+    {
+        if(p_block->i_buffer == 16)
+        {
+            key.resize(16);
+            memcpy(&key[0], p_block->p_buffer, 16);
+        }
+        block_Release(p_block);
+    }
+
+    vlc_mutex_lock(&lock);
+    fetching.erase(uri);
+    if(!key.empty())
     {
-        std::list<std::string>::iterator it2 = std::find(lru.begin(), lru.end(), uri);
-        if(it2 != lru.begin())
+        keys.insert(std::pair<std::string, KeyringKey>(uri, key));
+        lru.push_front(uri);
+        if(lru.size() > Keyring::MAX_KEYS)
         {
-            lru.erase(it2);
-            lru.push_front(uri);
+            keys.erase(keys.find(lru.back()));
+            lru.pop_back();
         }
-        key = (*it).second;
     }
+    vlc_cond_broadcast(&fetched);
+    vlc_mutex_unlock(&lock);
 
     return key;
 }
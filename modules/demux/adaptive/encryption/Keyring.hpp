@@ -25,6 +25,7 @@
 
 #include <map>
 #include <list>
+#include <set>
 #include <vector>
 #include <string>
 
@@ -47,8 +48,10 @@ namespace adaptive
                 static const int MAX_KEYS = 50;
                 std::map<std::string, KeyringKey> keys;
                 std::list<std::string> lru;
+                std::set<std::string> fetching; /* keys being retrieved */
                 vlc_object_t *obj;
                 vlc_mutex_t lock;
+                vlc_cond_t  fetched;
         };
     }
 }
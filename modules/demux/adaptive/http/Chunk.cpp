@@ -29,13 +29,16 @@
 #include "HTTPConnection.hpp"
 #include "HTTPConnectionManager.h"
 #include "Downloader.hpp"
+#include "../encryption/CommonEncryption.hpp"
 
 #include <vlc_common.h>
 #include <vlc_block.h>
 
 #include <algorithm>
+#include <cassert>
 
 using namespace adaptive::http;
+using namespace adaptive::encryption;
 using vlc::threads::mutex_locker;
 
 static std::string EmptyStr = "";
@@ -80,6 +83,11 @@ ChunkType AbstractChunkSource::getChunkType() const
     return type;
 }
 
+bool AbstractChunkSource::setEncryptionSession(CommonEncryptionSession *)
+{
+    return false;
+}
+
 AbstractChunk::AbstractChunk(AbstractChunkSource *source_)
 {
     bytesRead = 0;
@@ -338,11 +346,19 @@ HTTPChunkBufferedSource::HTTPChunkBufferedSource(const std::string& url, Abstrac
     HTTPChunkSource(url, manager, sourceid, type, range, access),
     p_head     (nullptr),
     pp_tail    (&p_head),
-    buffered     (0)
+    buffered     (0),
+    downloaded   (0)
 {
     done = false;
     eof = false;
     held = false;
+    waiting = 0;
+    lowlatency = false;
+    fromcache = false;
+    encryptionSession = nullptr;
+    p_pending = nullptr;
+    burst.size = 0;
+    burst.time = 0;
     p_read = nullptr;
     inblockreadoffset = 0;
 }
@@ -364,6 +380,9 @@ HTTPChunkBufferedSource::~HTTPChunkBufferedSource()
         p_read = nullptr;
         pp_tail = &p_head;
     }
+    if(p_pending)
+        block_Release(p_pending);
+    delete encryptionSession;
     buffered = 0;
 }
 
@@ -373,6 +392,32 @@ bool HTTPChunkBufferedSource::isDone() const
     return done;
 }
 
+bool HTTPChunkBufferedSource::isComplete() const
+{
+    mutex_locker locker {lock};
+    /* only fully received responses of known size */
+    return done && prepared && requeststatus == RequestStatus::Success &&
+           downloaded && downloaded == contentLength;
+}
+
+bool HTTPChunkBufferedSource::isStarted() const
+{
+    mutex_locker locker {lock};
+    return prepared && !done;
+}
+
+bool HTTPChunkBufferedSource::isStarving() const
+{
+    mutex_locker locker {lock};
+    return waiting > 0;
+}
+
+size_t HTTPChunkBufferedSource::getUnreadSize() const
+{
+    mutex_locker locker {lock};
+    return buffered - consumed;
+}
+
 void HTTPChunkBufferedSource::hold()
 {
     mutex_locker locker {lock};
@@ -386,6 +431,90 @@ void HTTPChunkBufferedSource::release()
     avail.signal();
 }
 
+void HTTPChunkBufferedSource::setCachedData(block_t *p_data, const std::string &type)
+{
+    mutex_locker locker {lock};
+    assert(p_head == nullptr);
+    block_ChainLastAppend(&pp_tail, p_data);
+    p_read = p_head;
+    inblockreadoffset = 0;
+    buffered = downloaded = contentLength = p_data->i_buffer;
+    requeststatus = RequestStatus::Success;
+    cachedContentType = type;
+    fromcache = true;
+    prepared = true;
+    done = true;
+}
+
+void HTTPChunkBufferedSource::setLowLatency(bool b)
+{
+    lowlatency = b;
+}
+
+bool HTTPChunkBufferedSource::setEncryptionSession(CommonEncryptionSession *s)
+{
+    mutex_locker locker {lock};
+    /* Cached and recycled data was stored decrypted */
+    if(fromcache || encryptionSession)
+    {
+        delete s;
+        return true;
+    }
+    /* Too late to decrypt on download */
+    if(prepared)
+        return false;
+    encryptionSession = s;
+    /* CBC needs whole cipher blocks, not partial chunked reads */
+    lowlatency = false;
+    return true;
+}
+
+/* Decryption runs on the downloader, overlapping with the demuxer reading
+   the previous blocks. Blocks are held back by one read so the padding of
+   the last one can be stripped. Returns the blocks ready to be queued. */
+block_t * HTTPChunkBufferedSource::decrypt(block_t *p_block, bool b_last)
+{
+    block_t *p_ready = nullptr;
+    block_t **pp_ready = &p_ready;
+    if(p_pending)
+    {
+        p_pending->i_buffer = encryptionSession->decrypt(p_pending->p_buffer,
+                                                         p_pending->i_buffer,
+                                                         b_last && !p_block);
+        block_ChainLastAppend(&pp_ready, p_pending);
+        p_pending = nullptr;
+    }
+    if(p_block)
+    {
+        if(b_last)
+        {
+            p_block->i_buffer = encryptionSession->decrypt(p_block->p_buffer,
+                                                           p_block->i_buffer, true);
+            block_ChainLastAppend(&pp_ready, p_block);
+        }
+        else p_pending = p_block;
+    }
+    if(b_last)
+        encryptionSession->close();
+    return p_ready;
+}
+
+void HTTPChunkBufferedSource::getDownloadRate(size_t *size, vlc_tick_t *time) const
+{
+    /* Bursts measure the link only if they carried most of the data,
+       otherwise the segment was not waited for and its time is accurate */
+    if(lowlatency && burst.time > 0 && burst.size >= downloaded / 2)
+    {
+        *size = burst.size;
+        *time = burst.time;
+    }
+    else
+    {
+        *size = downloaded;
+        *time = downloadEndTime - requestStartTime;
+    }
+}
+
 void HTTPChunkBufferedSource::bufferize(size_t readsize)
 {
     {
@@ -401,8 +530,8 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         if(readsize < HTTPChunkSource::CHUNK_SIZE)
             readsize = HTTPChunkSource::CHUNK_SIZE;
 
-        if(contentLength && readsize > contentLength - buffered)
-            readsize = contentLength - buffered;
+        if(contentLength && readsize > contentLength - downloaded)
+            readsize = contentLength - downloaded;
     }
 
     block_t *p_block = block_Alloc(readsize);
@@ -419,36 +548,52 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         vlc_tick_t latency;
     } rate = {0,0,0};
 
-    ssize_t ret = connection->read(p_block->p_buffer, readsize);
+    /* In low latency mode, the server sends the segment chunks as they are
+       encoded. Pass them as soon as received, and only account the reads
+       which did not wait for the next chunk to be produced. */
+    const vlc_tick_t readStart = vlc_tick_now();
+    ssize_t ret = lowlatency ? connection->readPartial(p_block->p_buffer, readsize)
+                             : connection->read(p_block->p_buffer, readsize);
+    const vlc_tick_t readTime = vlc_tick_now() - readStart;
     if(ret <= 0)
     {
         block_Release(p_block);
         p_block = nullptr;
+        if(encryptionSession)
+            p_block = decrypt(nullptr, true);
         mutex_locker locker {lock};
+        if(p_block)
+            enqueue(p_block);
         done = true;
         downloadEndTime = vlc_tick_now();
-        rate.size = buffered;
-        rate.time = downloadEndTime - requestStartTime;
+        getDownloadRate(&rate.size, &rate.time);
         rate.latency = responseTime - requestStartTime;
         avail.signal();
     }
     else
     {
-        p_block->i_buffer = (size_t) ret;
+        const size_t received = (size_t) ret;
+        p_block->i_buffer = received;
+        /* downloaded is only updated from the downloader */
+        const bool b_last = (contentLength && downloaded + received == contentLength) ||
+                            received < readsize;
+        if(encryptionSession)
+            p_block = decrypt(p_block, b_last);
         mutex_locker locker {lock};
-        buffered += p_block->i_buffer;
-        block_ChainLastAppend(&pp_tail, p_block);
-        if(p_read == nullptr)
+        downloaded += received;
+        if(p_block)
+            enqueue(p_block);
+        if(lowlatency && readTime < BURST_IDLE_THRESHOLD)
         {
-            p_read = p_block;
-            inblockreadoffset = 0;
+            burst.size += received;
+            burst.time += readTime;
         }
-        if((size_t) ret < readsize)
+        if(lowlatency ? (contentLength && downloaded == contentLength)
+                      : received < readsize)
         {
             done = true;
             downloadEndTime = vlc_tick_now();
-            rate.size = buffered;
-            rate.time = downloadEndTime - requestStartTime;
+            getDownloadRate(&rate.size, &rate.time);
             rate.latency = responseTime - requestStartTime;
         }
         avail.signal();
@@ -461,18 +606,36 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
     }
 }
 
+void HTTPChunkBufferedSource::enqueue(block_t *p_chain)
+{
+    for(const block_t *p = p_chain; p; p = p->p_next)
+        buffered += p->i_buffer;
+    block_ChainLastAppend(&pp_tail, p_chain);
+    if(p_read == nullptr)
+    {
+        p_read = p_chain;
+        inblockreadoffset = 0;
+    }
+}
+
 bool HTTPChunkBufferedSource::hasMoreData() const
 {
     mutex_locker locker {lock};
     return !eof;
 }
 
+const std::string & HTTPChunkBufferedSource::getContentType() const
+{
+    if(fromcache)
+        return cachedContentType;
+    return HTTPChunkSource::getContentType();
+}
+
 void HTTPChunkBufferedSource::recycle()
 {
     p_read = p_head;
     inblockreadoffset = 0;
     consumed = 0;
-    contentLength = buffered;
     connManager->recycleSource(this);
 }
 
@@ -482,8 +645,10 @@ block_t * HTTPChunkBufferedSource::readBlock()
 
     mutex_locker locker {lock};
 
+    waiting++;
     while(!p_read && !done)
         avail.wait(lock);
+    waiting--;
 
     if(!p_read && done)
     {
@@ -508,8 +673,10 @@ block_t * HTTPChunkBufferedSource::read(size_t readsize)
 {
     mutex_locker locker {lock};
 
+    waiting++;
     while(readsize > (buffered - consumed) && !done)
         avail.wait(lock);
+    waiting--;
 
     block_t *p_block = nullptr;
     if(!readsize || (buffered == consumed) || !(p_block = block_Alloc(readsize)) )
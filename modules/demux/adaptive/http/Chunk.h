@@ -38,6 +38,11 @@ typedef struct vlc_frame_t block_t;
 
 namespace adaptive
 {
+    namespace encryption
+    {
+        class CommonEncryptionSession;
+    }
+
     namespace http
     {
         class AbstractConnection;
@@ -79,6 +84,9 @@ namespace adaptive
                 const std::string & getContentType  () const override;
                 RequestStatus getRequestStatus() const override;
                 virtual void        recycle() = 0;
+                /* Takes ownership of the session when the source decrypts
+                   itself on download, returns false otherwise */
+                virtual bool        setEncryptionSession(encryption::CommonEncryptionSession *);
 
             protected:
                 AbstractChunkSource(ChunkType, const BytesRange & = BytesRange());
@@ -165,16 +173,24 @@ namespace adaptive
                 block_t *  readBlock       ()  override;
                 block_t *  read            (size_t)  override;
                 bool       hasMoreData     () const  override;
+                const std::string & getContentType() const override;
                 void        recycle() override;
+                bool        setEncryptionSession(encryption::CommonEncryptionSession *) override;
 
             protected:
                 HTTPChunkBufferedSource(const std::string &url, AbstractConnectionManager *,
                                         const ID &, ChunkType, const BytesRange &,
                                         bool = false);
                 void               bufferize(size_t);
+                void               setLowLatency(bool);
                 bool               isDone() const;
+                bool               isComplete() const;
+                bool               isStarted() const;
+                bool               isStarving() const;
+                size_t             getUnreadSize() const;
                 void               hold();
                 void               release();
+                void               setCachedData(block_t *, const std::string &);
 
             private:
                 block_t            *p_head; /* read cache buffer */
@@ -182,10 +198,26 @@ namespace adaptive
                 const block_t      *p_read;
                 size_t              inblockreadoffset;
                 size_t              buffered; /* read cache size */
+                size_t              downloaded; /* received bytes */
                 bool                done;
                 bool                eof;
                 vlc::threads::condition_variable avail;
                 bool                held;
+                unsigned            waiting; /* readers waiting for data */
+                bool                lowlatency; /* chunked live edge transfer */
+                bool                fromcache;
+                std::string         cachedContentType;
+                encryption::CommonEncryptionSession *encryptionSession;
+                block_t            *p_pending; /* received, not yet decrypted */
+                block_t *          decrypt(block_t *, bool);
+                void               enqueue(block_t *);
+                struct
+                {
+                    size_t size;
+                    vlc_tick_t time;
+                } burst; /* data received without waiting for the server */
+                void               getDownloadRate(size_t *, vlc_tick_t *) const;
+                static const vlc_tick_t BURST_IDLE_THRESHOLD = VLC_TICK_FROM_MS(50);
         };
 
         class HTTPChunk : public AbstractChunk
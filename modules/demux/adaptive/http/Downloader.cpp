@@ -25,26 +25,26 @@
 
 #include <vlc_threads.h>
 
-#include <atomic>
+#include <algorithm>
 
 using namespace adaptive::http;
 
-Downloader::Downloader()
+Downloader::Downloader(unsigned workers_, unsigned perstream)
 {
     killed = false;
-    thread_handle_valid = false;
-    current = nullptr;
-    cancel_current = false;
+    workers = workers_ ? workers_ : 1;
+    maxPerStream = perstream ? perstream : 1;
 }
 
 bool Downloader::start()
 {
-    if(!thread_handle_valid &&
-       vlc_clone(&thread_handle, downloaderThread, static_cast<void *>(this)))
+    while(thread_handles.size() < workers)
     {
-        return false;
+        vlc_thread_t th;
+        if(vlc_clone(&th, downloaderThread, static_cast<void *>(this)))
+            return !thread_handles.empty();
+        thread_handles.push_back(th);
     }
-    thread_handle_valid = true;
     return true;
 }
 
@@ -52,15 +52,15 @@ Downloader::~Downloader()
 {
     kill();
 
-    if(thread_handle_valid)
-        vlc_join(thread_handle, nullptr);
+    for(vlc_thread_t &th : thread_handles)
+        vlc_join(th, nullptr);
 }
 
 void Downloader::kill()
 {
     vlc::threads::mutex_locker locker {lock};
     killed = true;
-    wait_cond.signal();
+    wait_cond.broadcast();
 }
 
 void Downloader::schedule(HTTPChunkBufferedSource *source)
@@ -74,10 +74,11 @@ void Downloader::schedule(HTTPChunkBufferedSource *source)
 void Downloader::cancel(HTTPChunkBufferedSource *source)
 {
     vlc::threads::mutex_locker locker {lock};
-    while (current == source)
+    if(isCurrent(source))
     {
-        cancel_current = true;
-        updated_cond.wait(lock);
+        cancelled.push_back(source);
+        while(isCurrent(source))
+            updated_cond.wait(lock);
     }
 
     if(!source->isDone())
@@ -95,13 +96,60 @@ void * Downloader::downloaderThread(void *opaque)
     return nullptr;
 }
 
+bool Downloader::isCurrent(const HTTPChunkBufferedSource *source) const
+{
+    return std::find(current.begin(), current.end(), source) != current.end();
+}
+
+unsigned Downloader::getStartedCount(const ID &id) const
+{
+    unsigned count = 0;
+    for(const HTTPChunkBufferedSource *source : chunks)
+    {
+        if(source->sourceid == id && (isCurrent(source) || source->isStarted()))
+            count++;
+    }
+    return count;
+}
+
+HTTPChunkBufferedSource * Downloader::getNextChunk() const
+{
+    /* Serve first the chunks someone is waiting data from, then the
+     * ones with the least data not read yet, in scheduling order.
+     * A stream only gets new requests when below its in-flight limit. */
+    HTTPChunkBufferedSource *next = nullptr;
+    bool nextStarving = false;
+    size_t nextUnread = 0;
+    for(HTTPChunkBufferedSource *source : chunks)
+    {
+        if(isCurrent(source))
+            continue;
+        if(!source->isStarted() &&
+           getStartedCount(source->sourceid) >= maxPerStream)
+            continue;
+
+        const bool starving = source->isStarving();
+        const size_t unread = source->getUnreadSize();
+        if(next == nullptr ||
+           (starving && !nextStarving) ||
+           (starving == nextStarving && unread < nextUnread))
+        {
+            next = source;
+            nextStarving = starving;
+            nextUnread = unread;
+        }
+    }
+    return next;
+}
+
 void Downloader::Run()
 {
     while(1)
     {
         lock.lock();
 
-        while(chunks.empty() && !killed)
+        HTTPChunkBufferedSource *source;
+        while((source = getNextChunk()) == nullptr && !killed)
             wait_cond.wait(lock);
 
         if(killed)
@@ -110,18 +158,23 @@ void Downloader::Run()
             break;
         }
 
-        current = chunks.front();
+        current.push_back(source);
         lock.unlock();
-        current->bufferize(HTTPChunkSource::CHUNK_SIZE);
+        source->bufferize(HTTPChunkSource::CHUNK_SIZE);
         lock.lock();
-        if(current->isDone() || cancel_current)
+        auto it = std::find(cancelled.begin(), cancelled.end(), source);
+        const bool b_cancel = it != cancelled.end();
+        if(b_cancel)
+            cancelled.erase(it);
+        if(source->isDone() || b_cancel)
         {
-            chunks.pop_front();
-            current->release();
+            chunks.remove(source);
+            source->release();
         }
-        cancel_current = false;
-        current = nullptr;
-        updated_cond.signal();
+        current.remove(source);
+        updated_cond.broadcast();
+        /* the stream may now accept new requests */
+        wait_cond.broadcast();
         lock.unlock();
     }
 }
@@ -26,6 +26,7 @@
 #include <vlc_threads.h>
 #include <vlc_cxx_helpers.hpp>
 #include <list>
+#include <vector>
 
 namespace adaptive
 {
@@ -36,7 +37,7 @@ namespace adaptive
         class Downloader
         {
             public:
-                Downloader();
+                Downloader(unsigned workers = 1, unsigned perstream = 1);
                 ~Downloader();
                 bool start();
                 void schedule(HTTPChunkBufferedSource *);
@@ -46,15 +47,19 @@ namespace adaptive
                 static void * downloaderThread(void *);
                 void Run();
                 void kill();
-                vlc_thread_t thread_handle;
+                HTTPChunkBufferedSource * getNextChunk() const;
+                bool isCurrent(const HTTPChunkBufferedSource *) const;
+                unsigned getStartedCount(const ID &) const;
+                std::vector<vlc_thread_t> thread_handles;
+                unsigned     workers;
+                unsigned     maxPerStream;
                 vlc::threads::mutex lock;
                 vlc::threads::condition_variable wait_cond;
                 vlc::threads::condition_variable updated_cond;
-                bool         thread_handle_valid;
                 bool         killed;
-                bool         cancel_current;
                 std::list<HTTPChunkBufferedSource *> chunks;
-                HTTPChunkBufferedSource *current;
+                std::list<HTTPChunkBufferedSource *> current;
+                std::list<HTTPChunkBufferedSource *> cancelled;
         };
 
     }
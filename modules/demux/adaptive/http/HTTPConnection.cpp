@@ -30,6 +30,8 @@
 #include <vlc_stream.h>
 #include <vlc_keystore.h>
 
+#include <map>
+
 extern "C"
 {
     #include "access/http/resource.h"
@@ -63,6 +65,11 @@ bool AbstractConnection::prepare(const ConnectionParams &params_)
     return true;
 }
 
+ssize_t AbstractConnection::readPartial(void *p_buffer, size_t len)
+{
+    return read(p_buffer, len);
+}
+
 size_t AbstractConnection::getContentLength() const
 {
     return contentLength;
@@ -83,25 +90,70 @@ const ConnectionParams & AbstractConnection::getRedirection() const
     return locationparams;
 }
 
+/* One HTTP manager per HTTPS origin, shared by all the connections of the
+ * session: the manager keeps a single connection per origin, over which
+ * HTTP/2 multiplexes the concurrent segment requests.
+ * The managers are not thread-safe, so requests and resources teardown
+ * are serialized. Reading established streams does not need the lock. */
+class adaptive::http::LibVLCHTTPSharedManagers
+{
+    public:
+        LibVLCHTTPSharedManagers(struct vlc_http_cookie_jar_t *jar_)
+        {
+            jar = jar_;
+            vlc_mutex_init(&lock);
+        }
+        ~LibVLCHTTPSharedManagers()
+        {
+            for(auto &it : managers)
+                vlc_http_mgr_destroy(it.second);
+        }
+        struct vlc_http_mgr * get(vlc_object_t *p_object, const ConnectionParams &params)
+        {
+            const std::string origin = params.getHostname() + ":" +
+                                       std::to_string(params.getPort());
+            vlc_mutex_locker locker(&lock);
+            auto it = managers.find(origin);
+            if(it != managers.end())
+                return it->second;
+            struct vlc_http_mgr *mgr = vlc_http_mgr_create(p_object, jar);
+            if(mgr)
+                managers.insert(std::make_pair(origin, mgr));
+            return mgr;
+        }
+        vlc_mutex_t lock;
+
+    private:
+        struct vlc_http_cookie_jar_t *jar;
+        std::map<std::string, struct vlc_http_mgr *> managers;
+};
+
 class adaptive::http::LibVLCHTTPSource : public adaptive::AbstractSource
 {
      friend class LibVLCHTTPConnection;
 
      public:
-        LibVLCHTTPSource(vlc_object_t *p_object, struct vlc_http_cookie_jar_t *jar)
+        LibVLCHTTPSource(vlc_object_t *p_object_, struct vlc_http_cookie_jar_t *jar_,
+                         LibVLCHTTPSharedManagers *shared_)
         {
-            http_mgr = vlc_http_mgr_create(p_object, jar);
+            p_object = p_object_;
+            jar = jar_;
+            shared = shared_;
+            http_mgr = nullptr;
             http_res = nullptr;
+            res_shared = false;
             totalRead = 0;
         }
         virtual ~LibVLCHTTPSource()
         {
+            reset();
             if(http_mgr)
                 vlc_http_mgr_destroy(http_mgr);
         }
         block_t *readNextBlock() override
         {
-            if(http_res == nullptr)
+            /* never let the resource reopen the request from there */
+            if(http_res == nullptr || http_res->response == nullptr)
                 return nullptr;
             block_t *b = vlc_http_res_read(http_res);
             if(b == vlc_http_error)
@@ -114,12 +166,23 @@ class adaptive::http::LibVLCHTTPSource : public adaptive::AbstractSource
         {
             if(http_res)
             {
+                lock();
                 vlc_http_res_destroy(http_res);
+                unlock();
                 http_res = nullptr;
+                res_shared = false;
                 totalRead = 0;
             }
         }
 
+        int getStatus()
+        {
+            lock();
+            int status = vlc_http_res_get_status(http_res);
+            unlock();
+            return status;
+        }
+
     private:
         struct restuple
         {
@@ -183,16 +246,47 @@ class adaptive::http::LibVLCHTTPSource : public adaptive::AbstractSource
             return (*static_cast<LibVLCHTTPSource **>(opaque))->validateResponse(res, resp);
         }
 
+        void lock()
+        {
+            if(res_shared)
+                vlc_mutex_lock(&shared->lock);
+        }
+
+        void unlock()
+        {
+            if(res_shared)
+                vlc_mutex_unlock(&shared->lock);
+        }
+
         static const struct vlc_http_resource_cbs callbacks;
         size_t totalRead;
-        struct vlc_http_mgr *http_mgr;
+        vlc_object_t *p_object;
+        struct vlc_http_cookie_jar_t *jar;
+        LibVLCHTTPSharedManagers *shared;
+        struct vlc_http_mgr *http_mgr; /* own manager, for plain HTTP */
+        bool res_shared;
         BytesRange range;
 
     public:
         struct vlc_http_resource *http_res;
-        int create(const char *uri,const std::string &ua,
+        int create(const ConnectionParams &params, const std::string &ua,
                    const std::string &ref, const BytesRange &range)
         {
+            /* HTTP/2 is only negotiated over TLS */
+            struct vlc_http_mgr *mgr;
+            if(shared && params.getScheme() == "https")
+            {
+                mgr = shared->get(p_object, params);
+            }
+            else
+            {
+                if(http_mgr == nullptr)
+                    http_mgr = vlc_http_mgr_create(p_object, jar);
+                mgr = http_mgr;
+            }
+            if(mgr == nullptr)
+                return -1;
+
             auto *tpl = static_cast<struct restuple *>(
                 std::malloc(sizeof(struct restuple)));
             if (unlikely(tpl == nullptr))
@@ -200,7 +294,8 @@ class adaptive::http::LibVLCHTTPSource : public adaptive::AbstractSource
 
             tpl->source = this;
             this->range = range;
-            if (vlc_http_res_init(&tpl->resource, &this->callbacks, http_mgr, uri,
+            if (vlc_http_res_init(&tpl->resource, &this->callbacks, mgr,
+                                  params.getUrl().c_str(),
                                   ua.empty() ? nullptr : ua.c_str(),
                                   ref.empty() ? nullptr : ref.c_str()))
             {
@@ -208,6 +303,7 @@ class adaptive::http::LibVLCHTTPSource : public adaptive::AbstractSource
                 return -1;
             }
             http_res = &tpl->resource;
+            res_shared = mgr != http_mgr;
             return 0;
         }
 
@@ -221,7 +317,9 @@ class adaptive::http::LibVLCHTTPSource : public adaptive::AbstractSource
             free(http_res->password);
             http_res->password = pass ? strdup(pass) : nullptr;
 
+            lock();
             struct vlc_http_msg *resp = vlc_http_res_open(http_res, &http_res[1]);
+            unlock();
             if (resp == nullptr)
                 return -1;
 
@@ -239,10 +337,11 @@ const struct vlc_http_resource_cbs LibVLCHTTPSource::callbacks =
     LibVLCHTTPSource::validateresponse_handler,
 };
 
-LibVLCHTTPConnection::LibVLCHTTPConnection(vlc_object_t *p_object_, AuthStorage *auth)
+LibVLCHTTPConnection::LibVLCHTTPConnection(vlc_object_t *p_object_, AuthStorage *auth,
+                                           LibVLCHTTPSharedManagers *shared)
     : AbstractConnection( p_object_ )
 {
-    source = new adaptive::http::LibVLCHTTPSource(p_object_, auth->getJar());
+    source = new adaptive::http::LibVLCHTTPSource(p_object_, auth->getJar(), shared);
     sourceStream = new ChunksSourceStream(p_object, source);
     stream = nullptr;
     char *psz_useragent = var_InheritString(p_object_, "http-user-agent");
@@ -293,9 +392,6 @@ bool LibVLCHTTPConnection::canReuse(const ConnectionParams &params_) const
 RequestStatus LibVLCHTTPConnection::request(const std::string &path,
                                             const BytesRange &range)
 {
-    if(source->http_mgr == nullptr)
-        return RequestStatus::GenericError;
-
     reset();
 
     /* Set new path for this query */
@@ -307,7 +403,7 @@ RequestStatus LibVLCHTTPConnection::request(const std::string &path,
     else
         msg_Dbg(p_object, "Retrieving %s", params.getUrl().c_str());
 
-    if(source->create(params.getUrl().c_str(), useragent,referer, range))
+    if(source->create(params, useragent, referer, range))
         return RequestStatus::GenericError;
 
     struct vlc_credential crd;
@@ -328,7 +424,7 @@ RequestStatus LibVLCHTTPConnection::request(const std::string &path,
         return RequestStatus::GenericError;
     }
 
-    int status = vlc_http_res_get_status(source->http_res);
+    int status = source->getStatus();
     if (status < 0)
     {
         vlc_credential_clean(&crd);
@@ -357,7 +453,7 @@ RequestStatus LibVLCHTTPConnection::request(const std::string &path,
                     free(psz_realm);
                     return RequestStatus::Unauthorized;
                 }
-                status = vlc_http_res_get_status(source->http_res);
+                status = source->getStatus();
             }
         }
     }
@@ -424,6 +520,13 @@ ssize_t LibVLCHTTPConnection::read(void *p_buffer, size_t len)
     return read;
 }
 
+ssize_t LibVLCHTTPConnection::readPartial(void *p_buffer, size_t len)
+{
+    ssize_t read = vlc_stream_ReadPartial(stream, p_buffer, len);
+    bytesRead = source->totalRead;
+    return read;
+}
+
 void LibVLCHTTPConnection::setUsed( bool b )
 {
     available = !b;
@@ -511,6 +614,16 @@ RequestStatus StreamUrlConnection::request(const std::string &path,
 }
 
 ssize_t StreamUrlConnection::read(void *p_buffer, size_t len)
+{
+    return read(p_buffer, len, false);
+}
+
+ssize_t StreamUrlConnection::readPartial(void *p_buffer, size_t len)
+{
+    return read(p_buffer, len, true);
+}
+
+ssize_t StreamUrlConnection::read(void *p_buffer, size_t len, bool partial)
 {
     if( !p_streamurl )
         return VLC_EGENERIC;
@@ -525,11 +638,12 @@ ssize_t StreamUrlConnection::read(void *p_buffer, size_t len)
     if(len > toRead)
         len = toRead;
 
-    ssize_t ret = vlc_stream_Read(p_streamurl, p_buffer, len);
+    ssize_t ret = partial ? vlc_stream_ReadPartial(p_streamurl, p_buffer, len)
+                          : vlc_stream_Read(p_streamurl, p_buffer, len);
     if(ret >= 0)
         bytesRead += ret;
 
-    if(ret < 0 || (size_t)ret < len || /* set EOF */
+    if(ret < 0 || (partial ? ret == 0 : (size_t)ret < len) || /* set EOF */
        contentLength == bytesRead )
     {
         reset();
@@ -550,6 +664,12 @@ LibVLCHTTPConnectionFactory::LibVLCHTTPConnectionFactory( AuthStorage *auth )
     : AbstractConnectionFactory()
 {
     authStorage = auth;
+    sharedManagers = new LibVLCHTTPSharedManagers(auth->getJar());
+}
+
+LibVLCHTTPConnectionFactory::~LibVLCHTTPConnectionFactory()
+{
+    delete sharedManagers;
 }
 
 AbstractConnection * LibVLCHTTPConnectionFactory::createConnection(vlc_object_t *p_object,
@@ -558,7 +678,7 @@ AbstractConnection * LibVLCHTTPConnectionFactory::createConnection(vlc_object_t
     if((params.getScheme() != "http" && params.getScheme() != "https") ||
        params.getHostname().empty())
         return nullptr;
-    return new LibVLCHTTPConnection(p_object, authStorage);
+    return new LibVLCHTTPConnection(p_object, authStorage, sharedManagers);
 }
 
 StreamUrlConnectionFactory::StreamUrlConnectionFactory()
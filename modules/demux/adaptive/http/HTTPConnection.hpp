@@ -52,6 +52,8 @@ namespace adaptive
                 virtual RequestStatus request(const std::string& path,
                                               const BytesRange & = BytesRange()) = 0;
                 virtual ssize_t read        (void *p_buffer, size_t len) = 0;
+                /* returns as soon as some data is available, 0 on EOF */
+                virtual ssize_t readPartial (void *p_buffer, size_t len);
 
                 virtual size_t  getContentLength() const;
                 virtual size_t  getBytesRead() const;
@@ -71,16 +73,19 @@ namespace adaptive
         };
 
        class LibVLCHTTPSource;
+       class LibVLCHTTPSharedManagers;
 
        class LibVLCHTTPConnection : public AbstractConnection
        {
             public:
-               LibVLCHTTPConnection(vlc_object_t *, AuthStorage *);
+               LibVLCHTTPConnection(vlc_object_t *, AuthStorage *,
+                                    LibVLCHTTPSharedManagers * = nullptr);
                virtual ~LibVLCHTTPConnection();
                bool    canReuse     (const ConnectionParams &) const override;
                RequestStatus request(const std::string& path,
                                      const BytesRange & = BytesRange()) override;
                ssize_t read         (void *p_buffer, size_t len) override;
+               ssize_t readPartial  (void *p_buffer, size_t len) override;
                void    setUsed      ( bool ) override;
 
             private:
@@ -103,11 +108,13 @@ namespace adaptive
                 RequestStatus request(const std::string& path,
                                       const BytesRange & = BytesRange()) override;
                 ssize_t read        (void *p_buffer, size_t len) override;
+                ssize_t readPartial (void *p_buffer, size_t len) override;
 
                 void    setUsed( bool ) override;
 
             protected:
                 void reset();
+                ssize_t read(void *p_buffer, size_t len, bool partial);
                 stream_t *p_streamurl;
        };
 
@@ -123,10 +130,11 @@ namespace adaptive
        {
            public:
                LibVLCHTTPConnectionFactory( AuthStorage * );
-               virtual ~LibVLCHTTPConnectionFactory() = default;
+               virtual ~LibVLCHTTPConnectionFactory();
                AbstractConnection * createConnection(vlc_object_t *, const ConnectionParams &) override;
            private:
                AuthStorage *authStorage;
+               LibVLCHTTPSharedManagers *sharedManagers;
        };
 
        class StreamUrlConnectionFactory : public AbstractConnectionFactory
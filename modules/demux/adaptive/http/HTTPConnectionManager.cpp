@@ -29,6 +29,7 @@
 #include "HTTPConnection.hpp"
 #include "ConnectionParams.hpp"
 #include "Downloader.hpp"
+#include "SegmentCache.hpp"
 #include "../tools/Debug.hpp"
 #include <vlc_url.h>
 #include <vlc_http.h>
@@ -42,6 +43,7 @@ AbstractConnectionManager::AbstractConnectionManager(vlc_object_t *p_object_)
 {
     p_object = p_object_;
     rateObserver = nullptr;
+    lowLatency = false;
 }
 
 AbstractConnectionManager::~AbstractConnectionManager()
@@ -67,6 +69,11 @@ void AbstractConnectionManager::setDownloadRateObserver(IDownloadRateObserver *o
     rateObserver = obs;
 }
 
+void AbstractConnectionManager::setLowLatency(bool b)
+{
+    lowLatency = b;
+}
+
 void AbstractConnectionManager::deleteSource(AbstractChunkSource *source)
 {
     delete source;
@@ -77,12 +84,16 @@ HTTPConnectionManager::HTTPConnectionManager    (vlc_object_t *p_object_)
       localAllowed(false)
 {
     vlc_mutex_init(&lock);
-    downloader = new Downloader();
+    downloader = new Downloader(var_InheritInteger(p_object, "adaptive-dl-workers"),
+                                var_InheritInteger(p_object, "adaptive-dl-perstream"));
     downloaderhp = new Downloader();
     downloader->start();
     downloaderhp->start();
     cache_total = 0;
     cache_max = 1 << 19;
+    segmentCache = nullptr;
+    segmentCacheHits = 0;
+    segmentCacheMisses = 0;
 }
 
 HTTPConnectionManager::~HTTPConnectionManager   ()
@@ -99,6 +110,12 @@ HTTPConnectionManager::~HTTPConnectionManager   ()
     }
     delete downloader;
     delete downloaderhp;
+    if(segmentCache && (segmentCacheHits || segmentCacheMisses))
+    {
+        SegmentCache::Statistics stats = segmentCache->getStatistics();
+        msg_Dbg(p_object, "segment cache: %u hits, %u misses, shared usage %zu/%zu bytes",
+                segmentCacheHits, segmentCacheMisses, stats.size, stats.maxsize);
+    }
     this->closeAllConnections();
     while(!factories.empty())
     {
@@ -191,31 +208,65 @@ AbstractChunkSource *HTTPConnectionManager::makeSource(const std::string &url,
             }
             // fallthrough
         case ChunkType::Segment:
+            if(segmentCache)
+            {
+                std::string contentType;
+                block_t *p_data = segmentCache->get(storageid, &contentType);
+                if(p_data)
+                {
+                    HTTPChunkBufferedSource *s = new HTTPChunkBufferedSource(url, this, id, type, range);
+                    s->setCachedData(p_data, contentType);
+                    segmentCacheHits++;
+                    CacheDebug(msg_Dbg(p_object, "Segment cache HIT '%s'", storageid.c_str()));
+                    return s;
+                }
+                segmentCacheMisses++;
+            }
+            // fallthrough
         case ChunkType::Key:
         case ChunkType::Playlist:
         default:
-            return new HTTPChunkBufferedSource(url, this, id, type, range);
+        {
+            HTTPChunkBufferedSource *s = new HTTPChunkBufferedSource(url, this, id, type, range);
+            /* Live edge segments are sent in chunks as encoded */
+            if(type == ChunkType::Segment)
+                s->setLowLatency(lowLatency);
+            return s;
+        }
     }
 }
 
 void HTTPConnectionManager::recycleSource(AbstractChunkSource *source)
 {
     bool b_cacheable;
+    bool b_shareable;
     switch(source->getChunkType())
     {
         case ChunkType::Index:
         case ChunkType::Init:
             b_cacheable = true;
+            b_shareable = true;
+            break;
+        case ChunkType::Segment:
+            b_cacheable = false;
+            b_shareable = true;
             break;
         case ChunkType::Key:
         case ChunkType::Playlist:
-        case ChunkType::Segment:
         default:
             b_cacheable = false;
+            b_shareable = false;
             break;
     }
 
     HTTPChunkBufferedSource *buf = dynamic_cast<HTTPChunkBufferedSource *>(source);
+    if(buf)
+    {
+        if(segmentCache && b_shareable && !buf->fromcache && buf->isComplete())
+            segmentCache->put(buf->getStorageID(), buf->getContentType(), buf->p_head);
+        buf->contentLength = buf->buffered;
+    }
+
     if(buf && b_cacheable && !buf->getStorageID().empty() &&
        buf->contentLength && buf->contentLength < cache_max)
     {
@@ -272,6 +323,11 @@ void HTTPConnectionManager::setLocalConnectionsAllowed()
     localAllowed = true;
 }
 
+void HTTPConnectionManager::setSegmentCache(SegmentCache *cache)
+{
+    segmentCache = cache;
+}
+
 void HTTPConnectionManager::addFactory(AbstractConnectionFactory *factory)
 {
     factories.push_back(factory);
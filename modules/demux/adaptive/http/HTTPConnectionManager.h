@@ -45,6 +45,7 @@ namespace adaptive
         class Downloader;
         class AbstractChunkSource;
         class HTTPChunkBufferedSource;
+        class SegmentCache;
         enum class ChunkType;
 
         class AbstractConnectionManager : public IDownloadRateObserver
@@ -65,10 +66,12 @@ namespace adaptive
                 virtual void updateDownloadRate(const ID &, size_t,
                                                 vlc_tick_t, vlc_tick_t) override;
                 void setDownloadRateObserver(IDownloadRateObserver *);
+                void setLowLatency(bool);
 
             protected:
                 void deleteSource(AbstractChunkSource *);
                 vlc_object_t                                       *p_object;
+                bool                                                lowLatency;
 
             private:
                 IDownloadRateObserver                              *rateObserver;
@@ -90,6 +93,7 @@ namespace adaptive
                 void start(AbstractChunkSource *)  override;
                 void cancel(AbstractChunkSource *)  override;
                 void         setLocalConnectionsAllowed();
+                void         setSegmentCache(SegmentCache *);
                 void         addFactory(AbstractConnectionFactory *);
 
             private:
@@ -105,6 +109,9 @@ namespace adaptive
                 std::list<HTTPChunkBufferedSource *> cache;
                 size_t cache_total;
                 size_t cache_max;
+                SegmentCache *segmentCache;
+                unsigned segmentCacheHits;
+                unsigned segmentCacheMisses;
         };
     }
 }
@@ -0,0 +1,179 @@
+/*
+ * SegmentCache.cpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN and VLC authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "SegmentCache.hpp"
+
+#include <vlc_block.h>
+
+#include <cassert>
+#include <cstring>
+
+using namespace adaptive::http;
+
+static vlc::threads::mutex instance_lock;
+static SegmentCache *instance = nullptr;
+
+SegmentCache::SegmentCache(size_t maxsize)
+{
+    stats.hits = 0;
+    stats.misses = 0;
+    stats.evictions = 0;
+    stats.size = 0;
+    stats.maxsize = maxsize;
+    refcount = 1;
+}
+
+SegmentCache::~SegmentCache()
+{
+    for(Entry &entry : entries)
+        block_Release(entry.data);
+}
+
+SegmentCache * SegmentCache::acquire(size_t maxsize)
+{
+    vlc::threads::mutex_locker locker {instance_lock};
+    if(instance)
+    {
+        vlc::threads::mutex_locker locker2 {instance->lock};
+        instance->refcount++;
+        /* honor the largest requested budget */
+        if(maxsize > instance->stats.maxsize)
+            instance->stats.maxsize = maxsize;
+    }
+    else
+    {
+        instance = new (std::nothrow) SegmentCache(maxsize);
+    }
+    return instance;
+}
+
+void SegmentCache::release()
+{
+    vlc::threads::mutex_locker locker {instance_lock};
+    assert(instance == this);
+    {
+        vlc::threads::mutex_locker locker2 {lock};
+        if(--refcount > 0)
+            return;
+    }
+    instance = nullptr;
+    delete this;
+}
+
+block_t * SegmentCache::duplicate(const block_t *p_chain)
+{
+    size_t total = 0;
+    for(const block_t *p = p_chain; p; p = p->p_next)
+        total += p->i_buffer;
+
+    block_t *p_block = block_Alloc(total);
+    if(!p_block)
+        return nullptr;
+
+    size_t offset = 0;
+    for(const block_t *p = p_chain; p; p = p->p_next)
+    {
+        memcpy(&p_block->p_buffer[offset], p->p_buffer, p->i_buffer);
+        offset += p->i_buffer;
+    }
+    return p_block;
+}
+
+block_t * SegmentCache::get(const StorageID &id, std::string *contentType)
+{
+    vlc::threads::mutex_locker locker {lock};
+    auto it = index.find(id);
+    if(it == index.end())
+    {
+        stats.misses++;
+        return nullptr;
+    }
+
+    /* refresh */
+    entries.splice(entries.begin(), entries, it->second);
+    const Entry &entry = entries.front();
+    block_t *p_block = block_Duplicate(entry.data);
+    if(!p_block)
+        return nullptr;
+    if(contentType)
+        *contentType = entry.contentType;
+    stats.hits++;
+    return p_block;
+}
+
+void SegmentCache::evict(size_t needed)
+{
+    while(!entries.empty() && stats.size + needed > stats.maxsize)
+    {
+        Entry &entry = entries.back();
+        stats.size -= entry.size;
+        stats.evictions++;
+        index.erase(entry.id);
+        block_Release(entry.data);
+        entries.pop_back();
+    }
+}
+
+void SegmentCache::put(const StorageID &id, const std::string &contentType,
+                       const block_t *p_chain)
+{
+    if(id.empty() || !p_chain)
+        return;
+
+    {
+        vlc::threads::mutex_locker locker {lock};
+        if(index.find(id) != index.end())
+            return;
+    }
+
+    block_t *p_data = duplicate(p_chain);
+    if(!p_data)
+        return;
+
+    vlc::threads::mutex_locker locker {lock};
+    /* a single large chunk would flush everything else,
+       and it might have been stored while copying */
+    if(p_data->i_buffer == 0 || p_data->i_buffer > stats.maxsize / 4 ||
+       index.find(id) != index.end())
+    {
+        block_Release(p_data);
+        return;
+    }
+
+    evict(p_data->i_buffer);
+
+    Entry entry;
+    entry.id = id;
+    entry.contentType = contentType;
+    entry.data = p_data;
+    entry.size = p_data->i_buffer;
+    entries.push_front(entry);
+    index[id] = entries.begin();
+    stats.size += entry.size;
+}
+
+SegmentCache::Statistics SegmentCache::getStatistics() const
+{
+    vlc::threads::mutex_locker locker {lock};
+    return stats;
+}
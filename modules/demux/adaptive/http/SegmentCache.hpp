@@ -0,0 +1,85 @@
+/*
+ * SegmentCache.hpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN and VLC authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef SEGMENTCACHE_HPP
+#define SEGMENTCACHE_HPP
+
+#include <vlc_common.h>
+#include <vlc_threads.h>
+#include <vlc_cxx_helpers.hpp>
+
+#include <list>
+#include <string>
+#include <unordered_map>
+
+typedef struct vlc_frame_t block_t;
+
+namespace adaptive
+{
+    namespace http
+    {
+        using StorageID = std::string;
+
+        /* Bounded LRU store of completely downloaded chunks data, keyed on
+         * url and byte range. One instance is shared process wide by all
+         * streams and playback sessions. */
+        class SegmentCache
+        {
+            public:
+                struct Statistics
+                {
+                    unsigned hits;
+                    unsigned misses;
+                    unsigned evictions;
+                    size_t   size;
+                    size_t   maxsize;
+                };
+
+                SegmentCache(size_t);
+                ~SegmentCache();
+
+                static SegmentCache * acquire(size_t);
+                void release();
+
+                /* returns a copy of the stored data, or nullptr */
+                block_t * get(const StorageID &, std::string * = nullptr);
+                void put(const StorageID &, const std::string &, const block_t *);
+                Statistics getStatistics() const;
+
+            private:
+                struct Entry
+                {
+                    StorageID id;
+                    std::string contentType;
+                    block_t *data;
+                    size_t size;
+                };
+                void evict(size_t);
+                std::list<Entry> entries; /* most recently used first */
+                std::unordered_map<StorageID, std::list<Entry>::iterator> index;
+                Statistics stats;
+                unsigned refcount;
+                mutable vlc::threads::mutex lock;
+
+                static block_t * duplicate(const block_t *);
+        };
+    }
+}
+
+#endif // SEGMENTCACHE_HPP
@@ -36,6 +36,7 @@ AbstractAdaptationLogic::AbstractAdaptationLogic    (vlc_object_t *obj)
     p_obj = obj;
     maxwidth = std::numeric_limits<int>::max();
     maxheight = std::numeric_limits<int>::max();
+    estimatorType = BandwidthEstimator::Type::Default;
 }
 
 void AbstractAdaptationLogic::updateDownloadRate    (const adaptive::ID &, size_t,
@@ -48,3 +49,13 @@ void AbstractAdaptationLogic::setMaxDeviceResolution (int w, int h)
     maxwidth = (w > 0) ? w : std::numeric_limits<int>::max();
     maxheight = (h > 0) ? h : std::numeric_limits<int>::max();
 }
+
+void AbstractAdaptationLogic::setBandwidthEstimatorType(BandwidthEstimator::Type type)
+{
+    estimatorType = type;
+}
+
+BandwidthEstimator * AbstractAdaptationLogic::createBandwidthEstimator() const
+{
+    return BandwidthEstimator::create(estimatorType);
+}
@@ -26,6 +26,7 @@
 #define ABSTRACTADAPTATIONLOGIC_H_
 
 #include "IDownloadRateObserver.h"
+#include "BandwidthEstimators.hpp"
 #include "../SegmentTracker.hpp"
 
 namespace adaptive
@@ -53,6 +54,7 @@ namespace adaptive
                                                                     vlc_tick_t, vlc_tick_t) override;
                 void                        trackerEvent           (const TrackerEvent &) override {}
                 void                        setMaxDeviceResolution (int, int);
+                void                        setBandwidthEstimatorType(BandwidthEstimator::Type);
 
                 enum class LogicType
                 {
@@ -66,9 +68,11 @@ namespace adaptive
                 };
 
             protected:
+                BandwidthEstimator *        createBandwidthEstimator() const;
                 vlc_object_t *p_obj;
                 int maxwidth;
                 int maxheight;
+                BandwidthEstimator::Type estimatorType;
         };
     }
 }
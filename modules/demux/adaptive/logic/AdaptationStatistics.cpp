@@ -0,0 +1,128 @@
+/*
+ * AdaptationStatistics.cpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN and VLC authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "AdaptationStatistics.hpp"
+#include "../playlist/BaseRepresentation.h"
+
+using namespace adaptive::logic;
+
+AdaptationStatistics::AdaptationStatistics()
+{
+    upswitches = 0;
+    downswitches = 0;
+    stalls = 0;
+    stalled = 0;
+    stallstart = VLC_TICK_INVALID;
+    starttime = VLC_TICK_INVALID;
+    firstframe = 0;
+    b_playing = false;
+    vlc_mutex_init(&lock);
+}
+
+void AdaptationStatistics::trackerEvent(const TrackerEvent &ev)
+{
+    if(ev.getType() != TrackerEvent::Type::RepresentationSwitch)
+        return;
+
+    const RepresentationSwitchEvent &event =
+            static_cast<const RepresentationSwitchEvent &>(ev);
+    /* initial selection or stream removal */
+    if(!event.prev || !event.next || event.prev == event.next)
+        return;
+
+    vlc_mutex_locker locker(&lock);
+    if(event.next->getBandwidth() > event.prev->getBandwidth())
+        upswitches++;
+    else
+        downswitches++;
+}
+
+void AdaptationStatistics::playbackStarting(vlc_tick_t now)
+{
+    vlc_mutex_locker locker(&lock);
+    starttime = now;
+    firstframe = 0;
+}
+
+void AdaptationStatistics::playbackStarved(vlc_tick_t now)
+{
+    vlc_mutex_locker locker(&lock);
+    /* initial buffering is not a stall */
+    if(b_playing && stallstart == VLC_TICK_INVALID)
+        stallstart = now;
+}
+
+void AdaptationStatistics::playbackResumed(vlc_tick_t now)
+{
+    vlc_mutex_locker locker(&lock);
+    if(stallstart != VLC_TICK_INVALID)
+    {
+        stalls++;
+        stalled += now - stallstart;
+        stallstart = VLC_TICK_INVALID;
+    }
+    if(starttime != VLC_TICK_INVALID && firstframe == 0)
+        firstframe = now - starttime;
+    b_playing = true;
+}
+
+void AdaptationStatistics::playbackReset()
+{
+    vlc_mutex_locker locker(&lock);
+    stallstart = VLC_TICK_INVALID;
+    b_playing = false;
+}
+
+unsigned AdaptationStatistics::getSwitchesCount() const
+{
+    vlc_mutex_locker locker(&lock);
+    return upswitches + downswitches;
+}
+
+unsigned AdaptationStatistics::getStallsCount() const
+{
+    vlc_mutex_locker locker(&lock);
+    return stalls;
+}
+
+vlc_tick_t AdaptationStatistics::getStallsDuration() const
+{
+    vlc_mutex_locker locker(&lock);
+    return stalled;
+}
+
+vlc_tick_t AdaptationStatistics::getTimeToFirstFrame() const
+{
+    vlc_mutex_locker locker(&lock);
+    return firstframe;
+}
+
+void AdaptationStatistics::dump(vlc_object_t *obj) const
+{
+    vlc_mutex_locker locker(&lock);
+    msg_Dbg(obj, "session statistics: first frame after %" PRId64 " ms, "
+                 "%u switches (%u up, %u down), %u stalls for %" PRId64 " ms",
+            MS_FROM_VLC_TICK(firstframe),
+            upswitches + downswitches, upswitches, downswitches,
+            stalls, MS_FROM_VLC_TICK(stalled));
+}
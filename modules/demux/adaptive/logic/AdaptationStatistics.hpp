@@ -0,0 +1,65 @@
+/*
+ * AdaptationStatistics.hpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN and VLC authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef ADAPTATIONSTATISTICS_HPP
+#define ADAPTATIONSTATISTICS_HPP
+
+#include "../SegmentTracker.hpp"
+
+#include <vlc_threads.h>
+
+namespace adaptive
+{
+    namespace logic
+    {
+        /* Per session representation switches and playback stalls,
+         * to compare adaptation logics and bandwidth estimators */
+        class AdaptationStatistics : public SegmentTrackerListenerInterface
+        {
+            public:
+                AdaptationStatistics();
+                virtual ~AdaptationStatistics() = default;
+
+                void trackerEvent(const TrackerEvent &) override;
+                void playbackStarting(vlc_tick_t);
+                void playbackStarved(vlc_tick_t);
+                void playbackResumed(vlc_tick_t);
+                void playbackReset();
+                void dump(vlc_object_t *) const;
+
+                unsigned getSwitchesCount() const;
+                unsigned getStallsCount() const;
+                vlc_tick_t getStallsDuration() const;
+                vlc_tick_t getTimeToFirstFrame() const;
+
+            private:
+                unsigned upswitches;
+                unsigned downswitches;
+                unsigned stalls;
+                vlc_tick_t stalled;
+                vlc_tick_t stallstart;
+                vlc_tick_t starttime;
+                vlc_tick_t firstframe;
+                bool b_playing;
+                mutable vlc_mutex_t lock;
+        };
+    }
+}
+
+#endif // ADAPTATIONSTATISTICS_HPP
@@ -0,0 +1,137 @@
+/*
+ * BandwidthEstimators.cpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN and VLC authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "BandwidthEstimators.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <new>
+
+using namespace adaptive::logic;
+
+BandwidthEstimator * BandwidthEstimator::create(Type type)
+{
+    switch(type)
+    {
+        case Type::EWMA:
+            return new (std::nothrow) EWMABandwidthEstimator();
+        case Type::HarmonicMean:
+            return new (std::nothrow) HarmonicMeanBandwidthEstimator();
+        case Type::Default:
+        case Type::VHF:
+        default:
+            return new (std::nothrow) VHFBandwidthEstimator();
+    }
+}
+
+BandwidthEstimator::Type BandwidthEstimator::typeFromName(const std::string &name)
+{
+    if(name == "vhf")
+        return Type::VHF;
+    if(name == "ewma")
+        return Type::EWMA;
+    if(name == "harmonic")
+        return Type::HarmonicMean;
+    return Type::Default;
+}
+
+VHFBandwidthEstimator::VHFBandwidthEstimator()
+{
+    estimate = 0;
+}
+
+size_t VHFBandwidthEstimator::push(size_t bps, vlc_tick_t)
+{
+    estimate = average.push(bps);
+    return estimate;
+}
+
+size_t VHFBandwidthEstimator::get() const
+{
+    return estimate;
+}
+
+EWMABandwidthEstimator::Average::Average(vlc_tick_t h)
+{
+    halflife = (h > 0) ? secf_from_vlc_tick(h) : 1.0;
+    value = 0.0;
+    weights = 0.0;
+}
+
+void EWMABandwidthEstimator::Average::push(double v, vlc_tick_t duration)
+{
+    /* longer samples weight more */
+    const double alpha = std::pow(0.5, secf_from_vlc_tick(duration) / halflife);
+    value = alpha * value + (1.0 - alpha) * v;
+    weights = alpha * weights + (1.0 - alpha);
+}
+
+double EWMABandwidthEstimator::Average::get() const
+{
+    /* zero bias correction on start */
+    return (weights > 0.0) ? value / weights : 0.0;
+}
+
+EWMABandwidthEstimator::EWMABandwidthEstimator(vlc_tick_t fasthalflife,
+                                               vlc_tick_t slowhalflife)
+    : fast(fasthalflife), slow(slowhalflife)
+{
+}
+
+size_t EWMABandwidthEstimator::push(size_t bps, vlc_tick_t duration)
+{
+    if(duration <= 0)
+        duration = 1;
+    fast.push(bps, duration);
+    slow.push(bps, duration);
+    return get();
+}
+
+size_t EWMABandwidthEstimator::get() const
+{
+    return std::min(fast.get(), slow.get());
+}
+
+HarmonicMeanBandwidthEstimator::HarmonicMeanBandwidthEstimator(unsigned nbobs)
+{
+    maxobs = (nbobs > 0) ? nbobs : 1;
+    estimate = 0;
+}
+
+size_t HarmonicMeanBandwidthEstimator::push(size_t bps, vlc_tick_t)
+{
+    if(values.size() >= maxobs)
+        values.pop_front();
+    values.push_back(std::max(bps, (size_t)1));
+
+    double sum = 0.0;
+    for(size_t v : values)
+        sum += 1.0 / v;
+    estimate = values.size() / sum;
+    return estimate;
+}
+
+size_t HarmonicMeanBandwidthEstimator::get() const
+{
+    return estimate;
+}
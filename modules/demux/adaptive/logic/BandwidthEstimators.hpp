@@ -0,0 +1,114 @@
+/*
+ * BandwidthEstimators.hpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN and VLC authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef BANDWIDTHESTIMATORS_HPP
+#define BANDWIDTHESTIMATORS_HPP
+
+#include <vlc_common.h>
+#include <vlc_tick.h>
+
+#include "../tools/MovingAverage.hpp"
+
+#include <list>
+#include <string>
+
+namespace adaptive
+{
+    namespace logic
+    {
+        /* Turns download rate samples into a bandwidth estimate.
+         * One instance per measured stream, not thread safe. */
+        class BandwidthEstimator
+        {
+            public:
+                enum class Type
+                {
+                    Default = 0,
+                    VHF,
+                    EWMA,
+                    HarmonicMean,
+                };
+
+                virtual ~BandwidthEstimator() = default;
+                /* sample in bits per second over duration, returns estimate */
+                virtual size_t push(size_t, vlc_tick_t) = 0;
+                virtual size_t get() const = 0;
+
+                static BandwidthEstimator * create(Type);
+                static Type typeFromName(const std::string &);
+        };
+
+        /* Vertical Horizontal Filter moving average */
+        class VHFBandwidthEstimator : public BandwidthEstimator
+        {
+            public:
+                VHFBandwidthEstimator();
+                size_t push(size_t, vlc_tick_t) override;
+                size_t get() const override;
+
+            private:
+                MovingAverage<size_t> average;
+                size_t estimate;
+        };
+
+        /* Duration weighted fast and slow exponential averages,
+         * keeping the most pessimistic of both */
+        class EWMABandwidthEstimator : public BandwidthEstimator
+        {
+            public:
+                EWMABandwidthEstimator(vlc_tick_t = VLC_TICK_FROM_SEC(2),
+                                       vlc_tick_t = VLC_TICK_FROM_SEC(5));
+                size_t push(size_t, vlc_tick_t) override;
+                size_t get() const override;
+
+            private:
+                class Average
+                {
+                    public:
+                        Average(vlc_tick_t);
+                        void push(double, vlc_tick_t);
+                        double get() const;
+
+                    private:
+                        double halflife;
+                        double value;
+                        double weights;
+                };
+                Average fast;
+                Average slow;
+        };
+
+        /* Harmonic mean over a sliding window of samples,
+         * damping the effect of short bursts */
+        class HarmonicMeanBandwidthEstimator : public BandwidthEstimator
+        {
+            public:
+                HarmonicMeanBandwidthEstimator(unsigned = 5);
+                size_t push(size_t, vlc_tick_t) override;
+                size_t get() const override;
+
+            private:
+                std::list<size_t> values;
+                unsigned maxobs;
+                size_t estimate;
+        };
+    }
+}
+
+#endif // BANDWIDTHESTIMATORS_HPP
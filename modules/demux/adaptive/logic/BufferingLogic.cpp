@@ -114,7 +114,7 @@ vlc_tick_t DefaultBufferingLogic::getMinBuffering(const BasePlaylist *p) const
 vlc_tick_t DefaultBufferingLogic::getMaxBuffering(const BasePlaylist *p) const
 {
     if(isLowLatency(p))
-        return getMinBuffering(p);
+        return getLiveDelay(p);
 
     vlc_tick_t buffering = userMaxBuffering ? userMaxBuffering
                                             : DEFAULT_MAX_BUFFERING;
@@ -128,7 +128,13 @@ vlc_tick_t DefaultBufferingLogic::getMaxBuffering(const BasePlaylist *p) const
 vlc_tick_t DefaultBufferingLogic::getLiveDelay(const BasePlaylist *p) const
 {
     if(isLowLatency(p))
-        return getMinBuffering(p);
+    {
+        /* Service target latency, or stick to the edge */
+        vlc_tick_t delay = p->targetLatency.Get();
+        if(p->timeShiftBufferDepth.Get())
+            delay = std::min(delay, p->timeShiftBufferDepth.Get());
+        return std::max(delay, getMinBuffering(p));
+    }
     vlc_tick_t delay = userLiveDelay ? userLiveDelay
                                      : DEFAULT_LIVE_BUFFERING;
     if(p->suggestedPresentationDelay.Get())
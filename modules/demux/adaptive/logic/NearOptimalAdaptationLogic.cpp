@@ -106,14 +106,17 @@ BaseRepresentation *NearOptimalAdaptationLogic::getNextRepresentation(BaseAdapta
         vlc_mutex_unlock(&lock);
         return selector.lowest(adaptSet);
     }
-    NearOptimalContext ctxcopy = (*it).second;
+    const NearOptimalContext &ctx = (*it).second;
+    const vlc_tick_t buffering_min = ctx.buffering_min;
+    const vlc_tick_t buffering_level = ctx.buffering_level;
+    const vlc_tick_t buffering_target = ctx.buffering_target;
 
     const unsigned bps = getAvailableBw(currentBps, prevRep);
 
     vlc_mutex_unlock(&lock);
 
-    const float gammaP = 1.0 + (umax - umin) / ((float)ctxcopy.buffering_target / ctxcopy.buffering_min - 1.0);
-    const float Vd = (secf_from_vlc_tick(ctxcopy.buffering_min) - 1.0) / (umin + gammaP);
+    const float gammaP = 1.0 + (umax - umin) / ((float)buffering_target / buffering_min - 1.0);
+    const float Vd = (secf_from_vlc_tick(buffering_min) - 1.0) / (umin + gammaP);
 
     BaseRepresentation *m;
     if(prevRep == nullptr) /* Starting */
@@ -131,7 +134,7 @@ BaseRepresentation *NearOptimalAdaptationLogic::getNextRepresentation(BaseAdapta
     {
         /* noted m* */
         m = getNextQualityIndex(adaptSet, selector, gammaP - umin /* umin == Sm, utility = std::log(S/Sm) */,
-                                Vd, secf_from_vlc_tick(ctxcopy.buffering_level));
+                                Vd, secf_from_vlc_tick(buffering_level));
         if(m->getBandwidth() < prevRep->getBandwidth()) /* m*[n] < m*[n-1] */
         {
             BaseRepresentation *mp = selector.select(adaptSet, bps); /* m' */
@@ -152,7 +155,7 @@ BaseRepresentation *NearOptimalAdaptationLogic::getNextRepresentation(BaseAdapta
     }
 
     BwDebug( msg_Info(p_obj, "buffering level %.2f%% rep %" PRId64 " kBps %u kBps",
-             (float) 100 * ctxcopy.buffering_level / ctxcopy.buffering_target, m->getBandwidth()/8000, bps / 8000); );
+             (float) 100 * buffering_level / buffering_target, m->getBandwidth()/8000, bps / 8000); );
 
     return m;
 }
@@ -196,10 +199,13 @@ void NearOptimalAdaptationLogic::updateDownloadRate(const ID &id, size_t dlsize,
 {
     vlc_mutex_locker locker(&lock);
     std::map<ID, NearOptimalContext>::iterator it = streams.find(id);
-    if(it != streams.end())
+    if(it != streams.end() && time > 0)
     {
         NearOptimalContext &ctx = (*it).second;
-        ctx.last_download_rate = ctx.average.push(CLOCK_FREQ * dlsize * 8 / time);
+        if(!ctx.estimator)
+            ctx.estimator.reset(createBandwidthEstimator());
+        if(ctx.estimator)
+            ctx.last_download_rate = ctx.estimator->push(CLOCK_FREQ * dlsize * 8 / time, time);
     }
     currentBps = getMaxCurrentBw();
 }
@@ -230,10 +236,7 @@ void NearOptimalAdaptationLogic::trackerEvent(const TrackerEvent &ev)
             if(event.enabled)
             {
                 if(streams.find(id) == streams.end())
-                {
-                    NearOptimalContext ctx;
-                    streams.insert(std::pair<ID, NearOptimalContext>(id, ctx));
-                }
+                    streams.insert(std::make_pair(id, NearOptimalContext()));
             }
             else
             {
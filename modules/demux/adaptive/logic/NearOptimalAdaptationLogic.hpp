@@ -22,8 +22,8 @@
 
 #include "AbstractAdaptationLogic.h"
 #include "Representationselectors.hpp"
-#include "../tools/MovingAverage.hpp"
 #include <map>
+#include <memory>
 
 #include <vlc_threads.h>
 
@@ -43,7 +43,7 @@ namespace adaptive
                 vlc_tick_t buffering_level;
                 vlc_tick_t buffering_target;
                 unsigned last_download_rate;
-                MovingAverage<unsigned> average;
+                std::unique_ptr<BandwidthEstimator> estimator;
         };
 
         class NearOptimalAdaptationLogic : public AbstractAdaptationLogic
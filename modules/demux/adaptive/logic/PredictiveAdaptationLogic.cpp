@@ -154,10 +154,13 @@ void PredictiveAdaptationLogic::updateDownloadRate(const ID &id, size_t dlsize,
 {
     vlc_mutex_locker locker(&lock);
     std::map<ID, PredictiveStats>::iterator it = streams.find(id);
-    if(it != streams.end())
+    if(it != streams.end() && time > 0)
     {
         PredictiveStats &stats = (*it).second;
-        stats.last_download_rate = stats.average.push(CLOCK_FREQ * dlsize * 8 / time);
+        if(!stats.estimator)
+            stats.estimator.reset(createBandwidthEstimator());
+        if(stats.estimator)
+            stats.last_download_rate = stats.estimator->push(CLOCK_FREQ * dlsize * 8 / time, time);
     }
 }
 
@@ -200,10 +203,7 @@ void PredictiveAdaptationLogic::trackerEvent(const TrackerEvent &ev)
             if(event.enabled)
             {
                 if(streams.find(id) == streams.end())
-                {
-                    PredictiveStats stats;
-                    streams.insert(std::pair<ID, PredictiveStats>(id, stats));
-                }
+                    streams.insert(std::make_pair(id, PredictiveStats()));
             }
             else
             {
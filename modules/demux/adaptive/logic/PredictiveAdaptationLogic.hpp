@@ -21,8 +21,8 @@
 #define PREDICTIVEADAPTATIONLOGIC_HPP
 
 #include "AbstractAdaptationLogic.h"
-#include "../tools/MovingAverage.hpp"
 #include <map>
+#include <memory>
 #include <vlc_threads.h>
 
 namespace adaptive
@@ -43,7 +43,7 @@ namespace adaptive
                 vlc_tick_t buffering_target;
                 unsigned last_download_rate;
                 vlc_tick_t last_duration;
-                MovingAverage<unsigned> average;
+                std::unique_ptr<BandwidthEstimator> estimator;
         };
 
         class PredictiveAdaptationLogic : public AbstractAdaptationLogic
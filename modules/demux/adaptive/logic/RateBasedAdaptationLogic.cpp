@@ -86,7 +86,13 @@ void RateBasedAdaptationLogic::updateDownloadRate(const ID &, size_t size,
     const size_t bps = CLOCK_FREQ * dlsize * 8 / dllength;
 
     vlc_mutex_locker locker(&lock);
-    bpsAvg = average.push(bps);
+    if(!estimator)
+    {
+        estimator.reset(createBandwidthEstimator());
+        if(!estimator)
+            return;
+    }
+    bpsAvg = estimator->push(bps, dllength);
 
 //    BwDebug(msg_Dbg(p_obj, "alpha1 %lf alpha0 %lf dmax %ld ds %ld", alpha,
 //                    (double)deltamax / diffsum, deltamax, diffsum));
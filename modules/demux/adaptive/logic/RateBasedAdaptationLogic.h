@@ -26,9 +26,10 @@
 #define RATEBASEDADAPTATIONLOGIC_H_
 
 #include "AbstractAdaptationLogic.h"
-#include "../tools/MovingAverage.hpp"
 #include <vlc_threads.h>
 
+#include <memory>
+
 namespace adaptive
 {
     namespace logic
@@ -51,7 +52,7 @@ namespace adaptive
                 size_t                  currentBps;
                 size_t                  usedBps;
 
-                MovingAverage<size_t>   average;
+                std::unique_ptr<BandwidthEstimator> estimator;
 
                 size_t                  dlsize;
                 vlc_tick_t              dllength;
@@ -82,5 +82,9 @@ void SegmentChunk::setStreamFormat(const StreamFormat &f)
 void SegmentChunk::setEncryptionSession(CommonEncryptionSession *s)
 {
     delete encryptionSession;
+    encryptionSession = nullptr;
+    /* Prefer decrypting on download, out of the demux thread */
+    if(s && source->setEncryptionSession(s))
+        return;
     encryptionSession = s;
 }
@@ -232,6 +232,9 @@ void SegmentTimeline::updateWith(SegmentTimeline &other)
         return;
     }
 
+    /* update window start */
+    const stime_t oldest = other.elements.empty() ? 0 : other.elements.front()->t;
+
     Element *last = elements.back();
     while(other.elements.size())
     {
@@ -258,6 +261,10 @@ void SegmentTimeline::updateWith(SegmentTimeline &other)
             last = el;
         }
     }
+
+    /* prune what expired from the window */
+    if(oldest > elements.front()->t)
+        pruneBySequenceNumber(getElementNumberByScaledPlaybackTime(oldest));
 }
 
 void SegmentTimeline::debug(vlc_object_t *obj, int indent) const
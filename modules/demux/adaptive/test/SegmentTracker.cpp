@@ -731,6 +731,96 @@ static int SegmentTracker_check_HLSseeks(BaseAdaptationSet *adaptSet,
     return 0;
 }
 
+static int SegmentTracker_check_faststart(BaseAdaptationSet *adaptSet,
+                                          DummyLogic *logic,
+                                          SegmentTracker *tracker,
+                                          SegmentTrackerListener &events)
+{
+    const stime_t START = 1337;
+    Timescale timescale(100);
+
+    ChunkInterface *currentChunk = nullptr;
+    try
+    {
+        DummyRepresentation *reps[2];
+        for(int j=0; j<2; j++)
+        {
+            DummyRepresentation *rep = new DummyRepresentation(adaptSet);
+            adaptSet->addRepresentation(rep);
+            rep->setID(ID(std::to_string(j)));
+            rep->setBandwidth(2000 / (j + 1));
+            reps[j] = rep;
+
+            SegmentList *segmentList = nullptr;
+            try
+            {
+                segmentList = new SegmentList(rep);
+                segmentList->addAttribute(new TimescaleAttr(timescale));
+                for(int i=0; i<3; i++)
+                {
+                    Segment *seg = new Segment(rep);
+                    seg->setSequenceNumber(123 + i);
+                    seg->startTime.Set(START + 100 * i);
+                    seg->duration.Set(100);
+                    seg->setSourceUrl("sample/aac");
+                    segmentList->addSegment(seg);
+                }
+                InitSegment *initSegment = new InitSegment(rep);
+                initSegment->setSourceUrl("sample/aacinit");
+                segmentList->initialisationSegment.Set(initSegment);
+            } catch (...) {
+                delete segmentList;
+                std::rethrow_exception(std::current_exception());
+            }
+            rep->addAttribute(segmentList);
+        }
+
+        /* logic would pick highest, but start is on lowest */
+        logic->repindex = 0;
+        tracker->setFastStart(true);
+        SegmentTracker::Position pos = tracker->getStartPosition();
+        Expect(pos.isValid());
+        Expect(pos.rep == reps[1]);
+
+        /* init and first segment requested at once */
+        events.reset();
+        Expect(tracker->prefetchStartChunks() == true);
+        Expect(events.occured(TrackerEvent::Type::RepresentationSwitch) == false);
+        Expect(tracker->prefetchStartChunks() == false);
+
+        currentChunk = tracker->getNextChunk(true);
+        Expect(currentChunk);
+        Expect(events.occured(TrackerEvent::Type::RepresentationSwitch) == true);
+        Expect(events.representationchanged.next == reps[1]);
+        delete currentChunk;
+        currentChunk = nullptr;
+
+        events.reset();
+        currentChunk = tracker->getNextChunk(true);
+        Expect(currentChunk);
+        Expect(events.occured(TrackerEvent::Type::RepresentationSwitch) == false);
+        Expect(events.occured(TrackerEvent::Type::SegmentChange) == true);
+        Expect(events.segmentchanged.starttime == timescale.ToTime(START) + VLC_TICK_0);
+        delete currentChunk;
+        currentChunk = nullptr;
+
+        /* then follows the logic */
+        events.reset();
+        currentChunk = tracker->getNextChunk(true);
+        Expect(currentChunk);
+        Expect(events.occured(TrackerEvent::Type::RepresentationSwitch) == true);
+        Expect(events.representationchanged.next == reps[0]);
+        delete currentChunk;
+        currentChunk = nullptr;
+
+    } catch( ... ) {
+        delete currentChunk;
+        return 1;
+    }
+
+    return 0;
+}
+
 typedef decltype(SegmentTracker_check_formats) testfunc;
 
 static int Prepare_test(testfunc func)
@@ -786,5 +876,6 @@ int SegmentTracker_test()
         Prepare_test(SegmentTracker_check_seeks) ||
         Prepare_test(SegmentTracker_check_switches) ||
         Prepare_test(SegmentTracker_check_HLSseeks) ||
+        Prepare_test(SegmentTracker_check_faststart) ||
         0;
 }
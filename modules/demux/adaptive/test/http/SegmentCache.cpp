@@ -0,0 +1,116 @@
+/*****************************************************************************
+ *
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLabs, VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../http/SegmentCache.hpp"
+
+#include "../test.hpp"
+
+#include <vlc_block.h>
+
+#include <cstring>
+
+using namespace adaptive;
+using namespace adaptive::http;
+
+static block_t * makeChain(size_t size, uint8_t fill)
+{
+    block_t *p_chain = nullptr;
+    block_t **pp_tail = &p_chain;
+    for(size_t i=0; i<size; i+=100)
+    {
+        block_t *p_block = block_Alloc(std::min((size_t)100, size - i));
+        memset(p_block->p_buffer, fill, p_block->i_buffer);
+        block_ChainLastAppend(&pp_tail, p_block);
+    }
+    return p_chain;
+}
+
+int SegmentCache_test()
+{
+    SegmentCache *cache = nullptr;
+    block_t *p_chain = nullptr;
+    block_t *p_block = nullptr;
+    try
+    {
+        cache = SegmentCache::acquire(800);
+        Expect(cache);
+        Expect(SegmentCache::acquire(1000) == cache);
+        cache->release();
+        Expect(cache->getStatistics().maxsize == 1000);
+
+        Expect(cache->get("0100@http://a/seg1") == nullptr);
+        p_chain = makeChain(250, 0x42);
+        cache->put("0100@http://a/seg1", "video/mp4", p_chain);
+
+        std::string type;
+        p_block = cache->get("0100@http://a/seg1", &type);
+        Expect(p_block);
+        Expect(p_block->i_buffer == 250);
+        Expect(p_block->p_buffer[249] == 0x42);
+        Expect(type == "video/mp4");
+        block_Release(p_block);
+        p_block = nullptr;
+
+        /* least recently used goes first */
+        cache->put("http://a/seg2", "", p_chain);
+        cache->put("http://a/seg3", "", p_chain);
+        cache->put("http://a/seg4", "", p_chain);
+        p_block = cache->get("0100@http://a/seg1");
+        Expect(p_block);
+        block_Release(p_block);
+        p_block = nullptr;
+        cache->put("http://a/seg5", "", p_chain);
+        block_ChainRelease(p_chain);
+        p_chain = nullptr;
+        Expect(cache->get("http://a/seg2") == nullptr);
+        p_block = cache->get("0100@http://a/seg1");
+        Expect(p_block);
+        block_Release(p_block);
+        p_block = nullptr;
+
+        /* too large for the budget */
+        p_chain = makeChain(400, 0x01);
+        cache->put("http://a/big", "", p_chain);
+        block_ChainRelease(p_chain);
+        p_chain = nullptr;
+        Expect(cache->get("http://a/big") == nullptr);
+
+        SegmentCache::Statistics stats = cache->getStatistics();
+        Expect(stats.hits == 3);
+        Expect(stats.misses == 3);
+        Expect(stats.evictions == 1);
+        Expect(stats.size == 1000);
+
+        cache->release();
+    } catch(...) {
+        if(p_chain)
+            block_ChainRelease(p_chain);
+        if(p_block)
+            block_Release(p_block);
+        if(cache)
+            cache->release();
+        return 1;
+    }
+
+    return 0;
+}
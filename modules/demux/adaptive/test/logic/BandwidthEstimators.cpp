@@ -0,0 +1,80 @@
+/*****************************************************************************
+ *
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLabs, VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../logic/BandwidthEstimators.hpp"
+
+#include "../test.hpp"
+
+#include <memory>
+
+using namespace adaptive;
+using namespace logic;
+
+int BandwidthEstimators_test()
+{
+    try
+    {
+        Expect(BandwidthEstimator::typeFromName("ewma") == BandwidthEstimator::Type::EWMA);
+        Expect(BandwidthEstimator::typeFromName("harmonic") == BandwidthEstimator::Type::HarmonicMean);
+        Expect(BandwidthEstimator::typeFromName("foo") == BandwidthEstimator::Type::Default);
+
+        /* constant rate converges to itself */
+        for(auto type : { BandwidthEstimator::Type::VHF,
+                          BandwidthEstimator::Type::EWMA,
+                          BandwidthEstimator::Type::HarmonicMean })
+        {
+            std::unique_ptr<BandwidthEstimator> estimator(BandwidthEstimator::create(type));
+            Expect(estimator);
+            Expect(estimator->get() == 0);
+            size_t bps = 0;
+            for(int i=0; i<20; i++)
+                bps = estimator->push(1000000, VLC_TICK_FROM_SEC(1));
+            Expect(bps > 990000 && bps <= 1000000);
+            Expect(estimator->get() == bps);
+        }
+
+        /* EWMA has no zero start bias */
+        EWMABandwidthEstimator ewma;
+        Expect(ewma.push(800000, VLC_TICK_FROM_MS(500)) == 800000);
+        /* and keeps the most pessimistic average */
+        EWMABandwidthEstimator fastonly(VLC_TICK_FROM_SEC(2), VLC_TICK_FROM_SEC(2));
+        fastonly.push(800000, VLC_TICK_FROM_MS(500));
+        size_t fastslow = ewma.push(8000000, VLC_TICK_FROM_MS(500));
+        Expect(fastslow > 800000 && fastslow < fastonly.push(8000000, VLC_TICK_FROM_MS(500)));
+
+        /* harmonic mean damps bursts */
+        HarmonicMeanBandwidthEstimator harmonic(4);
+        harmonic.push(1000000, 1);
+        harmonic.push(1000000, 1);
+        harmonic.push(1000000, 1);
+        Expect(harmonic.push(9000000, 1) < 1400000);
+        /* window slides out */
+        for(int i=0; i<4; i++)
+            harmonic.push(2000000, 1);
+        Expect(harmonic.get() == 2000000);
+    } catch(...) {
+        return 1;
+    }
+
+    return 0;
+}
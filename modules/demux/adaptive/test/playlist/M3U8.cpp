@@ -579,6 +579,72 @@ int M3U8Playlist_test()
         return 1;
     }
 
+    /* Manifest 7: low latency, parts as ranges of the segment in progress */
+    const char manifest7[] =
+        "#EXTM3U\n"
+        "#EXT-X-TARGETDURATION:4\n"
+        "#EXT-X-PART-INF:PART-TARGET=1.0\n"
+        "#EXT-X-SERVER-CONTROL:CAN-BLOCK-RELOAD=YES,PART-HOLD-BACK=3.0\n"
+        "#EXT-X-MEDIA-SEQUENCE:10\n"
+        "#EXTINF:4,\n"
+        "seg10.mp4\n"
+        "#EXT-X-PART:DURATION=1.0,URI=\"seg11.mp4\",BYTERANGE=1000@0\n"
+        "#EXT-X-PART:DURATION=1.0,URI=\"seg11.mp4\",BYTERANGE=1000@1000\n"
+        "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"seg11.mp4\",BYTERANGE-START=2000\n";
+
+    m3u = ParseM3U8(obj, manifest7, sizeof(manifest7));
+    try
+    {
+        Expect(m3u);
+        Expect(m3u->isLive() == true);
+        Expect(m3u->isLowLatency() == true);
+        Expect(m3u->targetLatency.Get() == vlc_tick_from_sec(3));
+        BaseRepresentation *rep = m3u->getFirstPeriod()->getAdaptationSets().front()->
+                                  getRepresentations().front();
+        Expect(rep->getMediaSegment(10));
+        Segment *seg = rep->getMediaSegment(11);
+        Expect(seg);
+        Expect(seg->getUrlSegment().toString().find("seg11.mp4") != std::string::npos);
+        Expect(seg->getOffset() == 0);
+        Expect(!rep->getMediaSegment(12));
+        delete m3u;
+    }
+    catch (...)
+    {
+        delete m3u;
+        return 1;
+    }
+
+    /* Manifest 8: delta update, parts as separate resources */
+    const char manifest8[] =
+        "#EXTM3U\n"
+        "#EXT-X-TARGETDURATION:4\n"
+        "#EXT-X-PART-INF:PART-TARGET=1.0\n"
+        "#EXT-X-SERVER-CONTROL:CAN-BLOCK-RELOAD=YES,CAN-SKIP-UNTIL=24.0\n"
+        "#EXT-X-MEDIA-SEQUENCE:10\n"
+        "#EXT-X-SKIP:SKIPPED-SEGMENTS=5\n"
+        "#EXTINF:4,\n"
+        "seg15.mp4\n"
+        "#EXT-X-PART:DURATION=1.0,URI=\"seg16.0.mp4\"\n"
+        "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"seg16.1.mp4\"\n";
+
+    m3u = ParseM3U8(obj, manifest8, sizeof(manifest8));
+    try
+    {
+        Expect(m3u);
+        BaseRepresentation *rep = m3u->getFirstPeriod()->getAdaptationSets().front()->
+                                  getRepresentations().front();
+        Expect(!rep->getMediaSegment(14));
+        Expect(rep->getMediaSegment(15));
+        Expect(!rep->getMediaSegment(16));
+        delete m3u;
+    }
+    catch (...)
+    {
+        delete m3u;
+        return 1;
+    }
+
 
     return 0;
 }
@@ -158,10 +158,13 @@ int Timeline_test()
 
         delete timeline2;
         timeline2 = new SegmentTimeline(nullptr);
-        /* add 0 more times at 1 inside offset, should not change anything */
+        /* add 0 more times at 1 inside offset, should not add anything */
         timeline2->addElement(4+1, 2, 99-1, START+1000 + 2000 * 2 + 2 * 1);
         timeline->updateWith(*timeline2);
         Expect(timeline->maxElementNumber() == 4+99);
+        /* but prune what is before the updated window start */
+        Expect(timeline->minElementNumber() == 4+1);
+        Expect(timeline->getTotalLength() == 2 * 99);
 
         delete timeline2;
         timeline2 = new SegmentTimeline(nullptr);
@@ -47,6 +47,8 @@ int M3U8MasterPlaylist_test();
 int M3U8Playlist_test();
 int CommandsQueue_test();
 int BufferingLogic_test();
+int BandwidthEstimators_test();
+int SegmentCache_test();
 int FakeEsOut_test();
 int SegmentTracker_test();
 
@@ -28,7 +28,6 @@
 #include "DOMParser.h"
 
 #include <vector>
-#include <stack>
 #include <cstring>
 #include <vlc_xml.h>
 
@@ -37,6 +36,7 @@ using namespace adaptive::xml;
 DOMParser::DOMParser() :
     root( nullptr ),
     stream( nullptr ),
+    filter( nullptr ),
     vlc_reader( nullptr )
 {
 }
@@ -44,6 +44,7 @@ DOMParser::DOMParser() :
 DOMParser::DOMParser    (stream_t *stream) :
     root( nullptr ),
     stream( stream ),
+    filter( nullptr ),
     vlc_reader( nullptr )
 {
 }
@@ -91,11 +92,25 @@ bool DOMParser::reset(stream_t *s)
     return !!vlc_reader;
 }
 
+void DOMParser::setNodeFilter(NodeFilter *f)
+{
+    filter = f;
+}
+
+void DOMParser::attachNode(std::vector<Node *> &lifo, Node *node)
+{
+    /* Nodes are attached once complete, so the filter sees them whole */
+    if(filter && !filter->accept(lifo, node))
+        delete node;
+    else
+        lifo.back()->addSubNode(node);
+}
+
 Node* DOMParser::processNode(bool b_strict)
 {
     const char *data, *ns;
     int type;
-    std::stack<Node *> lifo;
+    std::vector<Node *> lifo;
 
     while( (type = xml_ReaderNextNodeNS(vlc_reader, &data, &ns)) > 0 )
     {
@@ -111,22 +126,24 @@ Node* DOMParser::processNode(bool b_strict)
                 Node *node = new (std::nothrow) Node(std::move(name), ptr);
                 if(node)
                 {
-                    if(!lifo.empty())
-                        lifo.top()->addSubNode(node);
-                    lifo.push(node);
+                    lifo.push_back(node);
 
                     addAttributesToNode(node);
                 }
 
                 if(empty && lifo.size() > 1)
-                    lifo.pop();
+                {
+                    Node *done = lifo.back();
+                    lifo.pop_back();
+                    attachNode(lifo, done);
+                }
                 break;
             }
 
             case XML_READER_TEXT:
             {
                 if(!lifo.empty())
-                    lifo.top()->setText(std::string(data));
+                    lifo.back()->setText(std::string(data));
                 break;
             }
 
@@ -135,10 +152,11 @@ Node* DOMParser::processNode(bool b_strict)
                 if(lifo.empty())
                     return nullptr;
 
-                Node *node = lifo.top();
-                lifo.pop();
+                Node *node = lifo.back();
+                lifo.pop_back();
                 if(lifo.empty())
                     return node;
+                attachNode(lifo, node);
             }
 
             default:
@@ -147,9 +165,13 @@ Node* DOMParser::processNode(bool b_strict)
     }
 
     while( lifo.size() > 1 )
-        lifo.pop();
+    {
+        Node *node = lifo.back();
+        lifo.pop_back();
+        lifo.back()->addSubNode(node);
+    }
 
-    Node *node = (!lifo.empty()) ? lifo.top() : nullptr;
+    Node *node = (!lifo.empty()) ? lifo.front() : nullptr;
 
     if(b_strict && node)
     {
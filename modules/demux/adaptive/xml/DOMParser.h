@@ -30,6 +30,8 @@
 
 #include "Node.h"
 
+#include <vector>
+
 namespace adaptive
 {
     namespace xml
@@ -37,6 +39,17 @@ namespace adaptive
         class DOMParser
         {
             public:
+                /* Streaming hook, allows dropping elements as soon as they
+                 * are parsed instead of keeping the whole document */
+                class NodeFilter
+                {
+                    public:
+                        virtual ~NodeFilter() {}
+                        /* ancestors from root, node is not yet attached */
+                        virtual bool accept(const std::vector<Node *> &ancestors,
+                                            Node *node) = 0;
+                };
+
                 DOMParser           ();
                 DOMParser           (stream_t *stream);
                 virtual ~DOMParser  ();
@@ -45,15 +58,18 @@ namespace adaptive
                 bool                reset       (stream_t *);
                 Node*               getRootNode ();
                 void                print       ();
+                void                setNodeFilter(NodeFilter *);
 
             private:
                 Namespaces          nss;
                 Node                *root;
                 stream_t            *stream;
+                NodeFilter          *filter;
 
                 xml_reader_t        *vlc_reader;
 
                 Node*   processNode             (bool);
+                void    attachNode              (std::vector<Node *> &, Node *);
                 void    addAttributesToNode     (Node *node);
                 void    print                   (Node *node, int offset);
         };
@@ -45,6 +45,8 @@ vlc_module_begin ()
     set_section( N_("Demuxer"), NULL )
     add_string( "avformat-format", NULL, FORMAT_TEXT, FORMAT_LONGTEXT )
     add_string( "avformat-options", NULL, AV_OPTIONS_TEXT, AV_OPTIONS_LONGTEXT )
+    add_integer_with_range( "avformat-iobuffer", 32, 4, 4096,
+                            IOBUFFER_TEXT, IOBUFFER_LONGTEXT )
 
 #ifdef ENABLE_SOUT
     /* mux submodule */
@@ -35,3 +35,6 @@ void avformat_CloseMux( vlc_object_t * );
 #define MUX_LONGTEXT N_("Force use of a specific avformat muxer.")
 #define FORMAT_TEXT N_( "Format name" )
 #define FORMAT_LONGTEXT N_( "Internal libavcodec format name" )
+#define IOBUFFER_TEXT N_( "I/O buffer size (KiB)" )
+#define IOBUFFER_LONGTEXT N_( "Size of the buffer through which " \
+    "libavformat reads the input. Larger buffers mean fewer, larger reads." )
@@ -92,8 +92,6 @@ typedef struct
     unsigned i_update;
 } demux_sys_t;
 
-#define AVFORMAT_IOBUFFER_SIZE 32768  /* FIXME */
-
 /*****************************************************************************
  * Local prototypes
  *****************************************************************************/
@@ -104,6 +102,7 @@ static int IORead( void *opaque, uint8_t *buf, int buf_size );
 static int64_t IOSeek( void *opaque, int64_t offset, int whence );
 
 static block_t *BuildSsaFrame( const AVPacket *p_pkt, unsigned i_order );
+static block_t *WrapPacket( AVPacket *p_pkt );
 static void UpdateSeekPoint( demux_t *p_demux, vlc_tick_t i_time );
 static void ResetTime( demux_t *p_demux, int64_t i_time );
 
@@ -404,7 +403,8 @@ int avformat_OpenDemux( vlc_object_t *p_this )
     p_sys->i_update = 0;
 
     /* Create I/O wrapper */
-    unsigned char * p_io_buffer = av_malloc( AVFORMAT_IOBUFFER_SIZE );
+    const int i_io_buffer = var_InheritInteger( p_demux, "avformat-iobuffer" ) * 1024;
+    unsigned char * p_io_buffer = av_malloc( i_io_buffer );
     if( !p_io_buffer )
     {
         avformat_CloseDemux( p_this );
@@ -420,7 +420,7 @@ int avformat_OpenDemux( vlc_object_t *p_this )
     }
 
     AVIOContext *pb = p_sys->ic->pb = avio_alloc_context( p_io_buffer,
-        AVFORMAT_IOBUFFER_SIZE, 0, p_demux, IORead, NULL, IOSeek );
+        i_io_buffer, 0, p_demux, IORead, NULL, IOSeek );
     if( !pb )
     {
         av_free( p_io_buffer );
@@ -896,7 +896,7 @@ static int Demux( demux_t *p_demux )
         memcpy( &p_frame->p_buffer[2], pkt.data, pkt.size );
         p_frame->p_buffer[p_frame->i_buffer - 1] = 0x3f;
     }
-    else
+    else if( ( p_frame = WrapPacket( &pkt ) ) == NULL )
     {
         if( ( p_frame = block_Alloc( pkt.size ) ) == NULL )
         {
@@ -1036,6 +1036,54 @@ static void ResetTime( demux_t *p_demux, int64_t i_time )
     }
 }
 
+typedef struct
+{
+    block_t self;
+    AVPacket *p_pkt;
+} demux_packet_t;
+
+static void PacketRelease( block_t *p_frame )
+{
+    demux_packet_t *p = container_of( p_frame, demux_packet_t, self );
+
+    av_packet_free( &p->p_pkt );
+    free( p );
+}
+
+static const struct vlc_block_callbacks packet_cbs =
+{
+    PacketRelease,
+};
+
+/* Hands the packet data over without copying it, when nobody else holds a
+ * reference to it, as the decoders are allowed to write to their input */
+static block_t *WrapPacket( AVPacket *p_pkt )
+{
+    if( p_pkt->buf == NULL || !av_buffer_is_writable( p_pkt->buf ) )
+        return NULL;
+
+    demux_packet_t *p = malloc( sizeof( *p ) );
+    if( unlikely(p == NULL) )
+        return NULL;
+
+    p->p_pkt = av_packet_alloc();
+    if( unlikely(p->p_pkt == NULL) )
+    {
+        free( p );
+        return NULL;
+    }
+    /* the caller still needs its timestamps */
+    av_packet_move_ref( p->p_pkt, p_pkt );
+    av_packet_copy_props( p_pkt, p->p_pkt );
+
+    /* The buffer includes the padding libavformat appended */
+    block_t *p_frame = block_Init( &p->self, &packet_cbs,
+                                   p->p_pkt->buf->data, p->p_pkt->buf->size );
+    p_frame->p_buffer = p->p_pkt->data;
+    p_frame->i_buffer = p->p_pkt->size;
+    return p_frame;
+}
+
 static block_t *BuildSsaFrame( const AVPacket *p_pkt, unsigned i_order )
 {
     if( p_pkt->size <= 0 )
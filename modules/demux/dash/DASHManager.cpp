@@ -41,14 +41,129 @@
 #include <vlc_meta.h>
 #include <vlc_block.h>
 #include "../adaptive/tools/Retrieve.hpp"
+#include "../adaptive/tools/Conversions.hpp"
 
 #include <algorithm>
 #include <ctime>
+#include <sstream>
 
 using namespace dash;
 using namespace dash::mpd;
 using namespace adaptive::logic;
 
+namespace
+{
+    /* Drops, while parsing a refresh, the SegmentTimeline S elements that
+     * were already known from the previous one. Only the window start and
+     * the new elements reach the merge, whatever the DVR window length. */
+    class TimelineUpdateFilter : public adaptive::xml::DOMParser::NodeFilter
+    {
+        public:
+            TimelineUpdateFilter(const std::map<std::string, stime_t> &known_)
+                : known(known_)
+            {
+                timeline = nullptr;
+                knownEnd = -1;
+                time = 0;
+                count = 0;
+                b_dropped = false;
+            }
+
+            bool accept(const std::vector<adaptive::xml::Node *> &ancestors,
+                        adaptive::xml::Node *node) override
+            {
+                if(ancestors.empty() || node->getName() != "S" ||
+                   ancestors.back()->getName() != "SegmentTimeline" ||
+                   !node->hasAttribute("d"))
+                    return true;
+
+                if(ancestors.back() != timeline)
+                {
+                    timeline = ancestors.back();
+                    key = makeKey(ancestors);
+                    auto it = known.find(key);
+                    knownEnd = (it != known.end()) ? it->second : -1;
+                    time = 0;
+                    count = 0;
+                    b_dropped = false;
+                }
+
+                const stime_t d = Integer<stime_t>(node->getAttributeValue("d"));
+                int64_t r = 0;
+                if(node->hasAttribute("r"))
+                    r = Integer<int64_t>(node->getAttributeValue("r"));
+                if(node->hasAttribute("t"))
+                    time = Integer<stime_t>(node->getAttributeValue("t"));
+                const stime_t start = time;
+
+                if(r < 0) /* open ended, can't track it */
+                {
+                    knownEnd = -1;
+                    ends.erase(key);
+                }
+                else
+                {
+                    time += d * (r + 1);
+                    ends[key] = time;
+                }
+
+                if(count++ == 0 || knownEnd < 0 || r < 0 || time > knownEnd)
+                {
+                    if(b_dropped && !node->hasAttribute("t"))
+                    {
+                        /* anchor it, as its predecessors are gone */
+                        std::ostringstream ss;
+                        ss.imbue(std::locale("C"));
+                        ss << start;
+                        for(const auto &attr : node->getAttributes())
+                        {
+                            if(attr.name == "d")
+                            {
+                                node->addAttribute("t", attr.ns, ss.str());
+                                break;
+                            }
+                        }
+                    }
+                    b_dropped = false;
+                    return true;
+                }
+
+                b_dropped = true;
+                return false;
+            }
+
+            const std::map<std::string, stime_t> & getEnds() const
+            {
+                return ends;
+            }
+
+        private:
+            static std::string makeKey(const std::vector<adaptive::xml::Node *> &ancestors)
+            {
+                std::string key;
+                for(size_t i = 0; i < ancestors.size(); i++)
+                {
+                    const adaptive::xml::Node *node = ancestors[i];
+                    key += "/" + node->getName();
+                    if(node->hasAttribute("id"))
+                        key += "#" + node->getAttributeValue("id");
+                    else if(i > 0) /* siblings are attached once complete */
+                        key += "@" + std::to_string(ancestors[i - 1]->getSubNodes().size());
+                }
+                return key;
+            }
+
+            const std::map<std::string, stime_t> &known;
+            std::map<std::string, stime_t> ends;
+            const adaptive::xml::Node *timeline;
+            std::string key;
+            stime_t knownEnd;
+            stime_t time;
+            unsigned count;
+            bool b_dropped;
+    };
+}
+
 DASHManager::DASHManager(demux_t *demux_,
                          SharedResources *res,
                          MPD *mpd,
@@ -104,7 +219,9 @@ bool DASHManager::updatePlaylist()
             return false;
         }
 
+        TimelineUpdateFilter filter(timelineEnds);
         xml::DOMParser parser(mpdstream);
+        parser.setNodeFilter(&filter);
         if(!parser.parse(true))
         {
             vlc_stream_Delete(mpdstream);
@@ -119,6 +236,7 @@ bool DASHManager::updatePlaylist()
         {
             playlist->updateWith(newmpd);
             delete newmpd;
+            timelineEnds = filter.getEnds();
         }
         vlc_stream_Delete(mpdstream);
         block_Release(p_block);
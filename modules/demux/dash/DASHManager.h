@@ -29,6 +29,9 @@
 #include "../adaptive/logic/AbstractAdaptationLogic.h"
 #include "mpd/MPD.h"
 
+#include <map>
+#include <string>
+
 namespace adaptive
 {
     namespace xml
@@ -59,6 +62,10 @@ namespace dash
 
         protected:
             int doControl(int, va_list) override;
+
+        private:
+            /* end time of each SegmentTimeline, by document location */
+            std::map<std::string, stime_t> timelineEnds;
     };
 
 }
@@ -24,6 +24,9 @@
 #include "IndexReader.hpp"
 #include "../mpd/Representation.h"
 #include "../mpd/MPD.h"
+#include "../../adaptive/logic/BufferingLogic.hpp"
+
+#include <algorithm>
 
 using namespace adaptive::mp4;
 using namespace dash::mp4;
@@ -45,19 +48,37 @@ bool IndexReader::parseIndex(block_t *p_block, BaseRepresentation *rep, uint64_t
         Representation::SplitPoint point;
         std::vector<Representation::SplitPoint> splitlist;
         MP4_Box_data_sidx_t *sidx = sidxbox->data.p_sidx;
-        /* sidx refers to offsets from end of sidx pos in the file + first offset */
-        point.offset = sidx->i_first_offset + i_fileoffset + sidxbox->i_pos + sidxbox->i_size;
-        point.time = 0;
         if(!sidx->i_timescale)
             return false;
+        const Timescale timescale(sidx->i_timescale);
+
+        /* Coalesce short subsegments into single range requests, while
+           keeping each request at less than half the minimum buffering */
+        const vlc_tick_t maxmerged =
+                std::max(rep->getPlaylist()->getMinBuffering(),
+                         logic::AbstractBufferingLogic::DEFAULT_MIN_BUFFERING) / 2;
+        const stime_t maxscaled = timescale.ToScaled(maxmerged);
+
+        /* sidx refers to offsets from end of sidx pos in the file + first offset */
+        size_t offset = sidx->i_first_offset + i_fileoffset + sidxbox->i_pos + sidxbox->i_size;
+        stime_t time = 0;
+        stime_t merged = 0;
         for(uint16_t i=0; i<sidx->i_reference_count; i++)
         {
-            splitlist.push_back(point);
-            point.offset += sidx->p_items[i].i_referenced_size;
-            point.duration = sidx->p_items[i].i_subsegment_duration;
-            point.time += point.duration;
+            const stime_t duration = sidx->p_items[i].i_subsegment_duration;
+            if(i == 0 || merged + duration > maxscaled)
+            {
+                point.offset = offset;
+                point.time = time;
+                point.duration = merged; /* of the previous split */
+                splitlist.push_back(point);
+                merged = 0;
+            }
+            merged += duration;
+            offset += sidx->p_items[i].i_referenced_size;
+            time += duration;
         }
-        rep->replaceAttribute(new TimescaleAttr(Timescale(sidx->i_timescale)));
+        rep->replaceAttribute(new TimescaleAttr(timescale));
         rep->SplitUsingIndex(splitlist);
         rep->getPlaylist()->debug();
     }
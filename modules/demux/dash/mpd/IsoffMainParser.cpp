@@ -98,6 +98,7 @@ MPD * IsoffMainParser::parse()
     {
         parseMPDAttributes(mpd, root);
         parseProgramInformation(DOMHelper::getFirstChildElementByName(root, "ProgramInformation", getDASHNamespace()), mpd);
+        parseServiceDescription(DOMHelper::getFirstChildElementByName(root, "ServiceDescription", getDASHNamespace()), mpd);
         parseMPDBaseUrl(mpd, root);
         parsePeriods(mpd, root);
         mpd->addAttribute(new StartnumberAttr(1));
@@ -581,6 +582,22 @@ void IsoffMainParser::parseProgramInformation(Node * node, MPD *mpd)
     }
 }
 
+void IsoffMainParser::parseServiceDescription(Node * node, MPD *mpd)
+{
+    if(!node)
+        return;
+
+    /* Only the latency target is used, playback rate bounds are left
+       to the input as the demuxer can't drive the playback speed */
+    Node *latency = DOMHelper::getFirstChildElementByName(node, "Latency", getDASHNamespace());
+    if(latency && latency->hasAttribute("target"))
+    {
+        int64_t target = Integer<int64_t>(latency->getAttributeValue("target"));
+        if(target > 0)
+            mpd->targetLatency.Set(VLC_TICK_FROM_MS(target));
+    }
+}
+
 Profile IsoffMainParser::getProfile() const
 {
     Profile res(Profile::Name::Unknown);
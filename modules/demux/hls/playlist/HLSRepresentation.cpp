@@ -32,6 +32,7 @@
 
 #include <ctime>
 #include <limits>
+#include <sstream>
 
 using namespace hls;
 using namespace hls::playlist;
@@ -44,6 +45,11 @@ HLSRepresentation::HLSRepresentation  ( BaseAdaptationSet *set ) :
     updateFailureCount = 0;
     lastUpdateTime = 0;
     targetDuration = 0;
+    partTarget = 0;
+    canSkipUntil = 0;
+    b_canBlockReload = false;
+    nextMediaSequence = 0;
+    nextPart = 0;
     streamFormat = StreamFormat::Type::Unknown;
     channels = 0;
 }
@@ -62,6 +68,11 @@ bool HLSRepresentation::isLive() const
     return b_live;
 }
 
+bool HLSRepresentation::isLowLatency() const
+{
+    return partTarget > 0;
+}
+
 bool HLSRepresentation::initialized() const
 {
     return b_loaded;
@@ -87,6 +98,33 @@ Url HLSRepresentation::getPlaylistUrl() const
     }
 }
 
+std::string HLSRepresentation::getUpdateUrl() const
+{
+    std::string url = getPlaylistUrl().toString();
+    if(!b_loaded || !isLive())
+        return url;
+
+    std::stringstream ss;
+    ss.imbue(std::locale("C"));
+    /* Have the server hold the request until the next part/segment is out */
+    if(b_canBlockReload)
+    {
+        ss << "_HLS_msn=" << nextMediaSequence;
+        if(isLowLatency())
+            ss << "&_HLS_part=" << nextPart;
+    }
+    /* Delta update, only while the skipped segments are still in our list */
+    if(canSkipUntil && vlc_tick_now() - lastUpdateTime < canSkipUntil / 2)
+    {
+        if(ss.tellp() > 0)
+            ss << '&';
+        ss << "_HLS_skip=YES";
+    }
+    if(ss.tellp() > 0)
+        url.append(url.find('?') == std::string::npos ? "?" : "&").append(ss.str());
+    return url;
+}
+
 void HLSRepresentation::debug(vlc_object_t *obj, int indent) const
 {
     BaseRepresentation::debug(obj, indent);
@@ -136,6 +174,9 @@ bool HLSRepresentation::needsUpdate(uint64_t number) const
         vlc_tick_t duration = targetDuration
                             ? vlc_tick_from_sec(targetDuration)
                             : VLC_TICK_FROM_SEC(2);
+        /* Low latency servers publish the playlist on each part */
+        if(isLowLatency())
+            duration = partTarget;
         if(updateFailureCount)
             duration /= 2;
         if(elapsed < duration)
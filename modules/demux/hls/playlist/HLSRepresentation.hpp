@@ -46,6 +46,7 @@ namespace hls
                 void setPlaylistUrl(const std::string &);
                 Url getPlaylistUrl() const;
                 bool isLive() const;
+                bool isLowLatency() const;
                 bool initialized() const;
                 void scheduleNextUpdate(uint64_t, bool) override;
                 bool needsUpdate(uint64_t) const override;
@@ -59,8 +60,15 @@ namespace hls
                 void setChannelsCount(unsigned);
 
             protected:
+                std::string getUpdateUrl() const;
                 time_t targetDuration;
                 Url playlistUrl;
+                /* Low latency extensions */
+                vlc_tick_t partTarget;
+                vlc_tick_t canSkipUntil;
+                bool b_canBlockReload;
+                uint64_t nextMediaSequence;
+                unsigned nextPart;
 
             private:
                 static const unsigned MAX_UPDATE_FAILED_UPDATE_COUNT = 3;
@@ -225,7 +225,7 @@ void M3U8Parser::fillAdaptsetFromMediainfo(const AttributesTag *mediatag,
 
 bool M3U8Parser::appendSegmentsFromPlaylistURI(vlc_object_t *p_obj, HLSRepresentation *rep)
 {
-    block_t *p_block = Retrieve::HTTP(resources, ChunkType::Playlist, rep->getPlaylistUrl().toString());
+    block_t *p_block = Retrieve::HTTP(resources, ChunkType::Playlist, rep->getUpdateUrl());
     if(p_block)
     {
         stream_t *substream = vlc_stream_MemoryNew(p_obj, p_block->p_buffer, p_block->i_buffer, true);
@@ -301,9 +301,59 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
     const SingleValueTag *ctx_byterange = nullptr;
     CommonEncryption encryption;
     const ValuesListTag *ctx_extinf = nullptr;
+    std::list<const AttributesTag *> ctx_parts; /* of the next segment */
+    const AttributesTag *ctx_preloadhint = nullptr;
 
     std::list<HLSSegment *> segmentstoappend;
 
+    auto appendSegment = [&](const std::string &uri) -> HLSSegment *
+    {
+        HLSSegment *segment = new (std::nothrow) HLSSegment(rep, sequenceNumber++);
+        if(!segment)
+            return nullptr;
+
+        segment->setSourceUrl(uri);
+
+        /* Need to use EXTXTARGETDURATION as default as some can't properly set segment one */
+        vlc_tick_t nzDuration = vlc_tick_from_sec(rep->targetDuration);
+        if(ctx_extinf)
+        {
+            const Attribute *durAttribute = ctx_extinf->getAttributeByName("DURATION");
+            if(durAttribute)
+                nzDuration = vlc_tick_from_sec(durAttribute->floatingPoint());
+            ctx_extinf = nullptr;
+        }
+        segment->duration.Set(timescale.ToScaled(nzDuration));
+        segment->startTime.Set(timescale.ToScaled(nzStartTime));
+        nzStartTime += nzDuration;
+        totalduration += nzDuration;
+        if(absReferenceTime != VLC_TICK_INVALID)
+        {
+            segment->setDisplayTime(absReferenceTime);
+            absReferenceTime += nzDuration;
+        }
+
+        segmentstoappend.push_back(segment);
+
+        if(ctx_byterange)
+        {
+            std::pair<std::size_t,std::size_t> range = ctx_byterange->getValue().getByteRange();
+            if(range.first == 0) /* first == size, second = offset */
+                range.first = prevbyterangeoffset;
+            prevbyterangeoffset = range.first + range.second;
+            segment->setByteRange(range.first, prevbyterangeoffset - 1);
+            ctx_byterange = nullptr;
+        }
+        segment->setDiscontinuitySequenceNumber(discontinuitySequence);
+        segment->discontinuity = discontinuity;
+        discontinuity = false;
+
+        if(encryption.method != CommonEncryption::Method::None)
+            segment->setEncryption(encryption);
+
+        return segment;
+    };
+
     std::list<Tag *>::const_iterator it;
     for(it = tagslist.begin(); it != tagslist.end(); ++it)
     {
@@ -326,6 +376,7 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
             case SingleValueTag::URI:
             {
                 const SingleValueTag *uritag = static_cast<const SingleValueTag *>(tag);
+                ctx_parts.clear();
                 if(uritag->getValue().value.empty())
                 {
                     ctx_extinf = nullptr;
@@ -333,48 +384,47 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
                     break;
                 }
 
-                HLSSegment *segment = new (std::nothrow) HLSSegment(rep, sequenceNumber++);
-                if(!segment)
-                    break;
+                appendSegment(uritag->getValue().value);
+            }
+            break;
 
-                segment->setSourceUrl(uritag->getValue().value);
+            case AttributesTag::EXTXPART:
+                ctx_parts.push_back(static_cast<const AttributesTag *>(tag));
+                break;
 
-                /* Need to use EXTXTARGETDURATION as default as some can't properly set segment one */
-                vlc_tick_t nzDuration = vlc_tick_from_sec(rep->targetDuration);
-                if(ctx_extinf)
-                {
-                    const Attribute *durAttribute = ctx_extinf->getAttributeByName("DURATION");
-                    if(durAttribute)
-                        nzDuration = vlc_tick_from_sec(durAttribute->floatingPoint());
-                    ctx_extinf = nullptr;
-                }
-                segment->duration.Set(timescale.ToScaled(nzDuration));
-                segment->startTime.Set(timescale.ToScaled(nzStartTime));
-                nzStartTime += nzDuration;
-                totalduration += nzDuration;
-                if(absReferenceTime != VLC_TICK_INVALID)
-                {
-                    segment->setDisplayTime(absReferenceTime);
-                    absReferenceTime += nzDuration;
-                }
+            case AttributesTag::EXTXPRELOADHINT:
+                ctx_preloadhint = static_cast<const AttributesTag *>(tag);
+                break;
 
-                segmentstoappend.push_back(segment);
+            case AttributesTag::EXTXPARTINF:
+            {
+                const Attribute *targetAttr = static_cast<const AttributesTag *>(tag)->
+                                              getAttributeByName("PART-TARGET");
+                if(targetAttr)
+                    rep->partTarget = vlc_tick_from_sec(targetAttr->floatingPoint());
+            }
+            break;
 
-                if(ctx_byterange)
-                {
-                    std::pair<std::size_t,std::size_t> range = ctx_byterange->getValue().getByteRange();
-                    if(range.first == 0) /* first == size, second = offset */
-                        range.first = prevbyterangeoffset;
-                    prevbyterangeoffset = range.first + range.second;
-                    segment->setByteRange(range.first, prevbyterangeoffset - 1);
-                    ctx_byterange = nullptr;
-                }
-                segment->setDiscontinuitySequenceNumber(discontinuitySequence);
-                segment->discontinuity = discontinuity;
-                discontinuity = false;
+            case AttributesTag::EXTXSERVERCONTROL:
+            {
+                const AttributesTag *ctrltag = static_cast<const AttributesTag *>(tag);
+                const Attribute *attr = ctrltag->getAttributeByName("CAN-BLOCK-RELOAD");
+                rep->b_canBlockReload = attr && attr->value == "YES";
+                attr = ctrltag->getAttributeByName("CAN-SKIP-UNTIL");
+                rep->canSkipUntil = attr ? vlc_tick_from_sec(attr->floatingPoint()) : 0;
+                attr = ctrltag->getAttributeByName("PART-HOLD-BACK");
+                if(attr)
+                    rep->getPlaylist()->targetLatency.Set(vlc_tick_from_sec(attr->floatingPoint()));
+            }
+            break;
 
-                if(encryption.method != CommonEncryption::Method::None)
-                    segment->setEncryption(encryption);
+            case AttributesTag::EXTXSKIP:
+            {
+                /* Delta update, the skipped segments are the ones we already have */
+                const Attribute *skippedAttr = static_cast<const AttributesTag *>(tag)->
+                                               getAttributeByName("SKIPPED-SEGMENTS");
+                if(skippedAttr)
+                    sequenceNumber += skippedAttr->decimal();
             }
             break;
 
@@ -451,6 +501,50 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
         }
     }
 
+    /* Where to resume blocking updates: next part of the segment in progress */
+    rep->nextMediaSequence = sequenceNumber;
+    rep->nextPart = ctx_parts.size();
+
+    /* The segment in progress can be played before completion when its parts
+     * and the preload hint are ranges of a single resource, as the server then
+     * delivers the whole resource as it is produced. */
+    if(!b_vod && (!ctx_parts.empty() || ctx_preloadhint))
+    {
+        std::string uri;
+        bool b_single = true;
+        for(const AttributesTag *part : ctx_parts)
+        {
+            const Attribute *uriAttr = part->getAttributeByName("URI");
+            if(!uriAttr || !part->getAttributeByName("BYTERANGE") ||
+               (!uri.empty() && uri != uriAttr->quotedString()))
+            {
+                b_single = false;
+                break;
+            }
+            uri = uriAttr->quotedString();
+        }
+        if(b_single && ctx_preloadhint)
+        {
+            const Attribute *typeAttr = ctx_preloadhint->getAttributeByName("TYPE");
+            const Attribute *uriAttr = ctx_preloadhint->getAttributeByName("URI");
+            const Attribute *startAttr = ctx_preloadhint->getAttributeByName("BYTERANGE-START");
+            if(typeAttr && typeAttr->value == "PART")
+            {
+                if(uriAttr && (uri.empty() ? (startAttr && startAttr->decimal() == 0)
+                                           : uri == uriAttr->quotedString()))
+                    uri = uriAttr->quotedString();
+                else
+                    b_single = false;
+            }
+        }
+        if(b_single && !uri.empty())
+        {
+            ctx_extinf = nullptr;
+            ctx_byterange = nullptr;
+            appendSegment(uri);
+        }
+    }
+
     for(HLSSegment *seg : segmentstoappend)
         segmentList->addSegment(seg);
     segmentstoappend.clear();
@@ -48,6 +48,7 @@ matroska_segment_c::matroska_segment_c( demux_sys_t & demuxer, matroska_iostream
     ,i_info_position(-1)
     ,i_chapters_position(-1)
     ,i_attachments_position(-1)
+    ,i_tags_position(-1)
     ,cluster(NULL)
     ,i_block_pos(0)
     ,p_segment_uid(NULL)
@@ -64,6 +65,8 @@ matroska_segment_c::matroska_segment_c( demux_sys_t & demuxer, matroska_iostream
     ,ep( EbmlParser(&estream, p_seg, &demuxer.demuxer ))
     ,b_preloaded(false)
     ,b_ref_external_segments(false)
+    ,b_attachments_loaded(false)
+    ,b_tags_loaded(false)
 {
 }
 
@@ -462,6 +465,9 @@ void matroska_segment_c::LoadTags( KaxTags *tags_ )
  *****************************************************************************/
 void matroska_segment_c::InformationCreate( )
 {
+    /* the segment title has precedence over the tags */
+    EnsureTags();
+
     if( !sys.meta )
         sys.meta = vlc_meta_New();
 
@@ -572,6 +578,18 @@ bool matroska_segment_c::SameFamily( const matroska_segment_c & of_segment ) con
     return false;
 }
 
+void matroska_segment_c::LoadSeekCache( const char *psz_cachedir, const char *psz_source )
+{
+    if( _seeker.load_cache( psz_cachedir, psz_source, segment->GetElementPosition() ) )
+        msg_Dbg( &sys.demuxer, "loaded seek cache with %zu clusters", _seeker._clusters.size() );
+}
+
+void matroska_segment_c::SaveSeekCache()
+{
+    if( !_seeker.save_cache() )
+        msg_Warn( &sys.demuxer, "cannot save seek cache" );
+}
+
 bool matroska_segment_c::Preload( )
 {
     if ( b_preloaded )
@@ -652,14 +670,11 @@ bool matroska_segment_c::Preload( )
             /* stop pre-parsing the stream */
             break;
         }
-        else if( MKV_CHECKED_PTR_DECL ( ka_ptr, KaxAttachments, el ) )
+        else if( MKV_IS_ID( el, KaxAttachments ) )
         {
             msg_Dbg( &sys.demuxer, "|   + Attachments" );
             if( i_attachments_position < 0 )
-            {
-                ParseAttachments( ka_ptr );
                 i_attachments_position = el->GetElementPosition();
-            }
         }
         else if( MKV_CHECKED_PTR_DECL ( chapters, KaxChapters, el ) )
         {
@@ -670,13 +685,11 @@ bool matroska_segment_c::Preload( )
                 i_chapters_position = el->GetElementPosition();
             }
         }
-        else if( MKV_CHECKED_PTR_DECL ( tags_, KaxTags, el ) )
+        else if( MKV_IS_ID( el, KaxTags ) )
         {
             msg_Dbg( &sys.demuxer, "|   + Tags" );
-            if(tags.empty ())
-            {
-                LoadTags( tags_ );
-            }
+            if( i_tags_position < 0 )
+                i_tags_position = el->GetElementPosition();
         }
         else if( MKV_IS_ID ( el, EbmlVoid ) )
             msg_Dbg( &sys.demuxer, "|   + Void" );
@@ -758,14 +771,11 @@ bool matroska_segment_c::LoadSeekHeadItem( const EbmlCallbacks & ClassInfos, int
             i_cues_position = i_element_position;
         }
     }
-    else if( MKV_CHECKED_PTR_DECL ( ka_ptr, KaxAttachments, el ) )
+    else if( MKV_IS_ID( el, KaxAttachments ) )
     {
         msg_Dbg( &sys.demuxer, "|   + Attachments" );
         if( i_attachments_position < 0 )
-        {
-            ParseAttachments( ka_ptr );
             i_attachments_position = i_element_position;
-        }
     }
     else if( MKV_CHECKED_PTR_DECL ( chapters, KaxChapters, el ) )
     {
@@ -776,13 +786,11 @@ bool matroska_segment_c::LoadSeekHeadItem( const EbmlCallbacks & ClassInfos, int
             i_chapters_position = i_element_position;
         }
     }
-    else if( MKV_CHECKED_PTR_DECL ( tags_, KaxTags, el ) )
+    else if( MKV_IS_ID( el, KaxTags ) )
     {
         msg_Dbg( &sys.demuxer, "|   + Tags" );
-        if(tags.empty ())
-        {
-            LoadTags( tags_ );
-        }
+        if( i_tags_position < 0 )
+            i_tags_position = i_element_position;
     }
     else
     {
@@ -794,6 +802,54 @@ bool matroska_segment_c::LoadSeekHeadItem( const EbmlCallbacks & ClassInfos, int
     return true;
 }
 
+/* Reads back an element skipped while preloading, the caller restores the
+ * file position */
+EbmlElement *matroska_segment_c::ReadDeferredElement( const EbmlCallbacks & ClassInfos, int64_t i_element_position )
+{
+    es.I_O().setFilePointer( i_element_position, seek_beginning );
+    EbmlElement *el = es.FindNextID( ClassInfos, 0xFFFFFFFFL );
+
+    if( el == nullptr || el->IsDummy() )
+    {
+        msg_Err( &sys.demuxer, "cannot load %s (broken file)", EBML_INFO_NAME(ClassInfos) );
+        delete el;
+        return nullptr;
+    }
+    return el;
+}
+
+void matroska_segment_c::EnsureAttachments()
+{
+    if( b_attachments_loaded || i_attachments_position < 0 )
+        return;
+    b_attachments_loaded = true;
+
+    uint64_t i_sav_position = es.I_O().getFilePointer();
+
+    EbmlElement *el = ReadDeferredElement( EBML_INFO(KaxAttachments), i_attachments_position );
+    if( MKV_CHECKED_PTR_DECL ( ka_ptr, KaxAttachments, el ) )
+        ParseAttachments( ka_ptr );
+    delete el;
+
+    es.I_O().setFilePointer( i_sav_position, seek_beginning );
+}
+
+void matroska_segment_c::EnsureTags()
+{
+    if( b_tags_loaded || i_tags_position < 0 )
+        return;
+    b_tags_loaded = true;
+
+    uint64_t i_sav_position = es.I_O().getFilePointer();
+
+    EbmlElement *el = ReadDeferredElement( EBML_INFO(KaxTags), i_tags_position );
+    if( MKV_CHECKED_PTR_DECL ( tags_, KaxTags, el ) )
+        LoadTags( tags_ );
+    delete el;
+
+    es.I_O().setFilePointer( i_sav_position, seek_beginning );
+}
+
 bool matroska_segment_c::Seek( demux_t &demuxer, vlc_tick_t i_absolute_mk_date, vlc_tick_t i_mk_time_offset, bool b_accurate )
 {
     SegmentSeeker::tracks_seekpoint_t seekpoints;
@@ -110,6 +110,7 @@ public:
     int64_t                 i_info_position;
     int64_t                 i_chapters_position;
     int64_t                 i_attachments_position;
+    int64_t                 i_tags_position;
 
     KaxCluster              *cluster;
     uint64_t                i_block_pos;
@@ -140,6 +141,8 @@ public:
     EbmlParser                     ep;
     bool                           b_preloaded;
     bool                           b_ref_external_segments;
+    bool                           b_attachments_loaded;
+    bool                           b_tags_loaded;
 
     bool Preload();
     bool PreloadFamily( const matroska_segment_c & segment );
@@ -160,10 +163,18 @@ public:
 
     bool SameFamily( const matroska_segment_c & of_segment ) const;
 
+    /* Attachments and Tags are only located while preloading */
+    void EnsureAttachments();
+    void EnsureTags();
+
+    void LoadSeekCache( const char *psz_cachedir, const char *psz_source );
+    void SaveSeekCache();
+
 private:
     void LoadCues( KaxCues *cues );
     void LoadTags( KaxTags *tags );
     bool LoadSeekHeadItem( const EbmlCallbacks & ClassInfos, int64_t i_element_position );
+    EbmlElement *ReadDeferredElement( const EbmlCallbacks & ClassInfos, int64_t i_element_position );
     void ParseInfo( KaxInfo *info );
     void ParseAttachments( KaxAttachments *attachments );
     void ParseChapters( KaxChapters *chapters );
@@ -28,8 +28,16 @@
 #include "util.hpp"
 #include "stream_io_callback.hpp"
 
+#include <vlc_fs.h>
+#include <vlc_hash.h>
+#include <vlc_threads.h>
+
 #include <sstream>
 #include <limits>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
 
 namespace {
     template<class It, class T>
@@ -46,6 +54,52 @@ namespace {
 
     template<class It> It prev_( It it ) { return --it; }
     template<class It> It next_( It it ) { return ++it; }
+
+    // below this distance, reading the blocks is cheaper than bisecting
+    const uint64_t BISECT_MIN_RANGE = 4 * 1024 * 1024;
+    const int      BISECT_MAX_STEPS = 32;
+
+    const char     CACHE_MAGIC[8] = { 'V','L','C','M','K','I','X','1' };
+    const uint32_t CACHE_MAX_ENTRIES = 1 << 22;
+
+    struct cache_header {
+        char     magic[8];
+        uint64_t i_size;
+        int64_t  i_mtime;
+        uint64_t i_segment_pos;
+        uint32_t i_ranges;
+        uint32_t i_positions;
+        uint32_t i_clusters;
+        uint32_t i_tracks;
+    };
+
+    struct cache_range     { uint64_t start, end; };
+    struct cache_cluster   { uint64_t fpos; int64_t pts, duration; uint64_t size; };
+    struct cache_track     { uint32_t id, count; };
+    struct cache_seekpoint { uint64_t fpos; int64_t pts; int32_t trust_level, unused; };
+
+    bool make_cache_header( cache_header& hdr, char const* psz_source, uint64_t segment_pos )
+    {
+        struct stat st;
+        if( vlc_stat( psz_source, &st ) || !S_ISREG( st.st_mode ) )
+            return false;
+
+        memset( &hdr, 0, sizeof( hdr ) );
+        memcpy( hdr.magic, CACHE_MAGIC, sizeof( hdr.magic ) );
+        hdr.i_size        = st.st_size;
+        hdr.i_mtime       = st.st_mtime;
+        hdr.i_segment_pos = segment_pos;
+        return true;
+    }
+
+    template<class T>
+    bool read_all( FILE* file, std::vector<T>& out, uint32_t count )
+    {
+        if( count > CACHE_MAX_ENTRIES )
+            return false;
+        out.resize( count );
+        return fread( out.data(), sizeof( T ), count, file ) == count;
+    }
 }
 
 namespace mkv {
@@ -310,6 +364,9 @@ SegmentSeeker::get_seekpoints( matroska_segment_c& ms, vlc_tick_t target_pts,
 
     for( vlc_tick_t needle_pts = target_pts; ; )
     {
+        if( !ms.b_cues && ms.sys.b_fastseekable )
+            bisect_clusters( ms, needle_pts );
+
         seekpoint_pair_t seekpoints = get_seekpoints_around( needle_pts, priority_tracks );
 
         Seekpoint const& start = seekpoints.first;
@@ -470,6 +527,232 @@ SegmentSeeker::get_search_areas( fptr_t start, fptr_t end ) const
     return areas_to_search;
 }
 
+void
+SegmentSeeker::bisect_clusters( matroska_segment_c& ms, vlc_tick_t target_pts )
+{
+    if( _clusters.empty() )
+        return;
+
+    fptr_t const segment_end = ms.segment->IsFiniteSize()
+        ? ms.segment->GetEndPosition()
+        : std::numeric_limits<fptr_t>::max();
+
+    for( int i = 0; i < BISECT_MAX_STEPS; ++i )
+    {
+        cluster_map_t::iterator it_after = _clusters.upper_bound( target_pts );
+        if( it_after == _clusters.begin() )
+            return;
+
+        Cluster const& before = prev_( it_after )->second;
+
+        if( before.duration != -1 && before.pts + before.duration > target_pts )
+            return; // we already know the cluster holding target_pts
+
+        fptr_t const low  = before.fpos + ( before.size != UINT64_MAX ? before.size : 1 );
+        fptr_t const high = it_after != _clusters.end() ? it_after->second.fpos : segment_end;
+
+        if( high == std::numeric_limits<fptr_t>::max() || high <= low ||
+            high - low < BISECT_MIN_RANGE )
+            return;
+
+        if( !probe_cluster( ms, low + ( high - low ) / 2, high ) )
+            return;
+    }
+}
+
+bool
+SegmentSeeker::probe_cluster( matroska_segment_c& ms, fptr_t start, fptr_t end )
+{
+    ms.es.I_O().setFilePointer( start );
+
+    EbmlElement * el = ms.es.FindNextID( EBML_INFO(KaxCluster), end - start );
+    if( el == NULL )
+        return false;
+
+    fptr_t const fpos = el->GetElementPosition();
+    bool const b_valid = !el->IsDummy() && el->IsFiniteSize() && el->GetEndPosition() <= end;
+    delete el;
+
+    if( !b_valid )
+        return false;
+
+    size_t const clusters_count = _clusters.size();
+    add_cluster_position( fpos );
+
+    mkv_jump_to( ms, fpos );
+
+    if( _clusters.size() > clusters_count )
+        return true;
+
+    // not a cluster after all
+    cluster_positions_t::iterator it = std::lower_bound(
+      _cluster_positions.begin(), _cluster_positions.end(), fpos );
+    if( it != _cluster_positions.end() && *it == fpos )
+        _cluster_positions.erase( it );
+    return false;
+}
+
+size_t
+SegmentSeeker::cache_entries() const
+{
+    size_t count = _ranges_searched.size() + _cluster_positions.size() + _clusters.size();
+
+    for( tracks_seekpoints_t::const_iterator it = _tracks_seekpoints.begin(); it != _tracks_seekpoints.end(); ++it )
+        count += it->second.size();
+
+    return count;
+}
+
+bool
+SegmentSeeker::load_cache( char const* psz_cachedir, char const* psz_source, fptr_t segment_pos )
+{
+    char psz_hash[VLC_HASH_MD5_DIGEST_HEX_SIZE];
+    vlc_hash_md5_t md5;
+
+    vlc_hash_md5_Init( &md5 );
+    vlc_hash_md5_Update( &md5, psz_source, strlen( psz_source ) );
+    vlc_hash_FinishHex( &md5, psz_hash );
+
+    std::ostringstream path;
+    path << psz_cachedir << DIR_SEP "mkvindex" DIR_SEP << psz_hash << '.' << segment_pos;
+
+    _cache_file        = path.str();
+    _cache_source      = psz_source;
+    _cache_segment_pos = segment_pos;
+
+    cache_header ref, hdr;
+    if( !make_cache_header( ref, psz_source, segment_pos ) )
+        return false;
+
+    FILE *file = vlc_fopen( _cache_file.c_str(), "rb" );
+    if( file == NULL )
+        return false;
+
+    std::vector<cache_range>     ranges;
+    std::vector<uint64_t>        positions;
+    std::vector<cache_cluster>   clusters;
+    tracks_seekpoints_t          tracks;
+
+    bool b_ok = fread( &hdr, sizeof( hdr ), 1, file ) == 1 &&
+                !memcmp( &hdr, &ref, offsetof( cache_header, i_ranges ) ) &&
+                hdr.i_tracks <= CACHE_MAX_ENTRIES &&
+                read_all( file, ranges, hdr.i_ranges ) &&
+                read_all( file, positions, hdr.i_positions ) &&
+                read_all( file, clusters, hdr.i_clusters );
+
+    for( uint32_t i = 0; b_ok && i < hdr.i_tracks; ++i )
+    {
+        cache_track track;
+        std::vector<cache_seekpoint> points;
+
+        b_ok = fread( &track, sizeof( track ), 1, file ) == 1 &&
+               read_all( file, points, track.count );
+        if( !b_ok )
+            break;
+
+        seekpoints_t& seekpoints = tracks[ track.id ];
+        for( size_t j = 0; b_ok && j < points.size(); ++j )
+        {
+            Seekpoint::TrustLevel trust = Seekpoint::TrustLevel( points[j].trust_level );
+
+            b_ok = ( trust == Seekpoint::TRUSTED || trust == Seekpoint::QUESTIONABLE ||
+                     trust == Seekpoint::DISABLED ) &&
+                   ( j == 0 || points[j - 1].pts <= points[j].pts );
+
+            seekpoints.push_back( Seekpoint( points[j].fpos, points[j].pts, trust ) );
+        }
+    }
+
+    fclose( file );
+
+    for( size_t i = 1; b_ok && i < positions.size(); ++i )
+        b_ok = positions[i - 1] < positions[i];
+
+    if( !b_ok )
+        return false;
+
+    _ranges_searched.clear();
+    for( size_t i = 0; i < ranges.size(); ++i )
+        _ranges_searched.push_back( Range( ranges[i].start, ranges[i].end ) );
+
+    _cluster_positions.assign( positions.begin(), positions.end() );
+
+    _clusters.clear();
+    for( size_t i = 0; i < clusters.size(); ++i )
+    {
+        Cluster cinfo = { clusters[i].fpos, clusters[i].pts, clusters[i].duration, clusters[i].size };
+        _clusters.insert( cluster_map_t::value_type( cinfo.pts, cinfo ) );
+    }
+
+    _tracks_seekpoints.swap( tracks );
+
+    _cache_loaded_entries = cache_entries();
+    return true;
+}
+
+bool
+SegmentSeeker::save_cache() const
+{
+    if( _cache_file.empty() || cache_entries() == _cache_loaded_entries )
+        return true;
+
+    cache_header hdr;
+    if( !make_cache_header( hdr, _cache_source.c_str(), _cache_segment_pos ) )
+        return false;
+
+    hdr.i_ranges    = _ranges_searched.size();
+    hdr.i_positions = _cluster_positions.size();
+    hdr.i_clusters  = _clusters.size();
+    hdr.i_tracks    = _tracks_seekpoints.size();
+
+    std::string dir = _cache_file.substr( 0, _cache_file.find_last_of( DIR_SEP_CHAR ) );
+    vlc_mkdir_parent( dir.c_str(), 0700 );
+
+    std::ostringstream tmp_path;
+    tmp_path << _cache_file << '.' << vlc_thread_id();
+    std::string const tmp = tmp_path.str();
+
+    FILE *file = vlc_fopen( tmp.c_str(), "wb" );
+    if( file == NULL )
+        return false;
+
+    bool b_ok = fwrite( &hdr, sizeof( hdr ), 1, file ) == 1;
+
+    for( ranges_t::const_iterator it = _ranges_searched.begin(); b_ok && it != _ranges_searched.end(); ++it )
+    {
+        cache_range range = { it->start, it->end };
+        b_ok = fwrite( &range, sizeof( range ), 1, file ) == 1;
+    }
+
+    if( b_ok && !_cluster_positions.empty() )
+        b_ok = fwrite( _cluster_positions.data(), sizeof( fptr_t ),
+                       _cluster_positions.size(), file ) == _cluster_positions.size();
+
+    for( cluster_map_t::const_iterator it = _clusters.begin(); b_ok && it != _clusters.end(); ++it )
+    {
+        cache_cluster cluster = { it->second.fpos, it->second.pts, it->second.duration, it->second.size };
+        b_ok = fwrite( &cluster, sizeof( cluster ), 1, file ) == 1;
+    }
+
+    for( tracks_seekpoints_t::const_iterator it = _tracks_seekpoints.begin(); b_ok && it != _tracks_seekpoints.end(); ++it )
+    {
+        cache_track track = { uint32_t( it->first ), uint32_t( it->second.size() ) };
+        b_ok = fwrite( &track, sizeof( track ), 1, file ) == 1;
+
+        for( seekpoints_t::const_iterator sp = it->second.begin(); b_ok && sp != it->second.end(); ++sp )
+        {
+            cache_seekpoint point = { sp->fpos, sp->pts, int32_t( sp->trust_level ), 0 };
+            b_ok = fwrite( &point, sizeof( point ), 1, file ) == 1;
+        }
+    }
+
+    if( fclose( file ) == 0 && b_ok && vlc_rename( tmp.c_str(), _cache_file.c_str() ) == 0 )
+        return true;
+
+    vlc_unlink( tmp.c_str() );
+    return false;
+}
+
 void
 SegmentSeeker::mkv_jump_to( matroska_segment_c& ms, fptr_t fpos )
 {
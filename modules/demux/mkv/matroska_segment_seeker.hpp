@@ -29,6 +29,7 @@
 #include <vector>
 #include <map>
 #include <limits>
+#include <string>
 
 namespace mkv {
 
@@ -119,11 +120,27 @@ class SegmentSeeker
         void mark_range_as_searched( Range );
         ranges_t get_search_areas( fptr_t start, fptr_t end ) const;
 
+        void bisect_clusters( matroska_segment_c&, vlc_tick_t target_pts );
+        bool probe_cluster( matroska_segment_c&, fptr_t start, fptr_t end );
+
+        // sidecar cache of everything found so far, keyed on the source file
+        // path, size and modification time, and the segment position
+        bool load_cache( char const* psz_cachedir, char const* psz_source, fptr_t segment_pos );
+        bool save_cache() const;
+
     public:
         ranges_t            _ranges_searched;
         tracks_seekpoints_t _tracks_seekpoints;
         cluster_positions_t _cluster_positions;
         cluster_map_t       _clusters;
+
+    private:
+        size_t cache_entries() const;
+
+        std::string _cache_file;
+        std::string _cache_source;
+        fptr_t      _cache_segment_pos = 0;
+        size_t      _cache_loaded_entries = 0;
 };
 
 } // namespace
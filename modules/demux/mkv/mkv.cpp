@@ -30,6 +30,8 @@
 #include "chapters.hpp"
 #include "Ebml_parser.hpp"
 
+#include <vlc_configuration.h>
+
 #include <new>
 #include <limits>
 
@@ -82,6 +84,10 @@ vlc_module_begin ()
             N_("Preload clusters"),
             N_("Find all cluster positions by jumping cluster-to-cluster before playback") )
 
+    add_bool( "mkv-seek-cache", true,
+            N_("Cache seek points"),
+            N_("Remember the cluster and keyframe positions found in local files without Cues, to seek faster next time.") )
+
     add_shortcut( "mka", "mkv" )
     add_file_extension("mka")
     add_file_extension("mks")
@@ -158,6 +164,21 @@ static int OpenInternal( demux_t *p_demux, bool trust_cues )
             b_need_preload = true;
     }
 
+    if( p_sys->b_fastseekable && p_demux->psz_filepath != NULL &&
+        !p_demux->b_preparsing && var_InheritBool( p_demux, "mkv-seek-cache" ) )
+    {
+        char *psz_cachedir = config_GetUserDir( VLC_CACHE_DIR );
+        if( psz_cachedir != NULL )
+        {
+            for (size_t i=0; i<p_stream->segments.size(); i++)
+            {
+                if( !p_stream->segments[i]->b_cues )
+                    p_stream->segments[i]->LoadSeekCache( psz_cachedir, p_demux->psz_filepath );
+            }
+            free( psz_cachedir );
+        }
+    }
+
     p_segment = p_stream->segments[0];
     if( p_segment->cluster == NULL && p_segment->stored_editions.size() == 0 )
     {
@@ -304,6 +325,12 @@ static void Close( vlc_object_t *p_this )
             p_segment->ESDestroy();
     }
 
+    if( !p_sys->streams.empty() )
+    {
+        for (size_t i=0; i<p_sys->streams[0]->segments.size(); i++)
+            p_sys->streams[0]->segments[i]->SaveSeekCache();
+    }
+
     delete p_sys;
 }
 
@@ -332,6 +359,9 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
             ppp_attach = va_arg( args, input_attachment_t*** );
             pi_int = va_arg( args, int * );
 
+            for( size_t i = 0; i < p_sys->opened_segments.size(); i++ )
+                p_sys->opened_segments[i]->EnsureAttachments();
+
             if( p_sys->stored_attachments.size() <= 0 )
                 return VLC_EGENERIC;
 
@@ -348,6 +378,12 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
 
         case DEMUX_GET_META:
             p_meta = va_arg( args, vlc_meta_t* );
+            /* the art URL comes from the attachments */
+            for( size_t i = 0; i < p_sys->opened_segments.size(); i++ )
+            {
+                p_sys->opened_segments[i]->EnsureTags();
+                p_sys->opened_segments[i]->EnsureAttachments();
+            }
             vlc_meta_Merge( p_meta, p_sys->meta );
             return VLC_SUCCESS;
 
@@ -37,6 +37,8 @@
 #include <vlc_dialog.h>
 #include <vlc_url.h>
 #include <vlc_replay_gain.h>
+#include <vlc_interrupt.h>
+#include <vlc_atomic.h>
 #include <assert.h>
 #include <limits.h>
 #include <math.h>
@@ -61,6 +63,11 @@ static void Close( vlc_object_t * );
 
 #define MP4_ELST_TEXT       N_("Handle edit list")
 
+#define MP4_FRAGSCAN_TEXT N_("Index fragments in background")
+#define MP4_FRAGSCAN_LONGTEXT N_( \
+    "Build the fragments time index of fragmented files without " \
+    "segment index while playing, so that seeking does not need a full scan.")
+
 #define HEIF_DURATION_TEXT N_("Duration in seconds")
 #define HEIF_DURATION_LONGTEXT N_( \
     "Duration in seconds before simulating an end of file. " \
@@ -78,6 +85,8 @@ vlc_module_begin ()
     add_file_extension("mov")
     add_file_extension("mp4")
 
+    add_bool( CFG_PREFIX"fragment-scan", true, MP4_FRAGSCAN_TEXT, MP4_FRAGSCAN_LONGTEXT )
+
     set_section("Hacks", NULL)
     add_bool( CFG_PREFIX"m4a-audioonly", false, MP4_M4A_TEXT, MP4_M4A_LONGTEXT )
     add_bool( CFG_PREFIX"editlist", true, MP4_ELST_TEXT, MP4_ELST_TEXT )
@@ -161,6 +170,16 @@ typedef struct
     } hacks;
 
     mp4_fragments_index_t *p_fragsindex;
+    MP4_Box_t *p_sidxroot;      /* nested sidx loaded while seeking */
+
+    struct
+    {
+        vlc_thread_t thread;
+        vlc_interrupt_t *p_interrupt;
+        mp4_fragments_index_t *p_index; /* owned by thread until joined */
+        atomic_bool b_done;
+        bool b_running;
+    } fragscan;
 
     ssize_t i_attachments;
     input_attachment_t **pp_attachments;
@@ -182,12 +201,14 @@ typedef struct
 static void MP4_TrackSetup( demux_t *, mp4_track_t *, const MP4_Box_t  *, bool, bool );
 static void MP4_TrackInit( mp4_track_t *, const MP4_Box_t * );
 static void MP4_TrackClean( es_out_t *, mp4_track_t * );
+static size_t TrackIndexSize( const mp4_track_t * );
 
 static void MP4_Block_Send( demux_t *, mp4_track_t *, block_t * );
 
 static void MP4_TrackSelect  ( demux_t *, mp4_track_t *, bool );
 static int  MP4_TrackSeek   ( demux_t *, mp4_track_t *, vlc_tick_t );
 
+static uint32_t MP4_TrackGetSampleSize( mp4_track_t *, uint32_t );
 static uint64_t MP4_TrackGetPos    ( mp4_track_t * );
 static uint32_t MP4_TrackGetReadSize( mp4_track_t *, uint32_t * );
 static int      MP4_TrackNextSample( demux_t *, mp4_track_t *, uint32_t );
@@ -207,6 +228,8 @@ static stime_t GetMoovTrackDuration( demux_sys_t *p_sys, unsigned i_track_ID );
 static int  ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented );
 static int  ProbeFragmentsChecked( demux_t *p_demux );
 static int  ProbeIndex( demux_t *p_demux );
+static void FragScanStart( demux_t *p_demux );
+static void FragScanJoin( demux_t *p_demux, bool b_wait );
 
 static int FragCreateTrunIndex( demux_t *, MP4_Box_t *, MP4_Box_t *, stime_t );
 
@@ -1055,6 +1078,8 @@ static int Open( vlc_object_t * p_this )
 
     p_demux->p_sys = p_sys;
 
+    const vlc_tick_t i_open_start = vlc_tick_now();
+
     if( LoadInitFrag( p_demux ) != VLC_SUCCESS )
         goto error;
 
@@ -1362,6 +1387,12 @@ static int Open( vlc_object_t * p_this )
         }
     }
 
+    size_t i_index_size = 0;
+    for( unsigned i = 0; i < p_sys->i_tracks; i++ )
+        i_index_size += TrackIndexSize( &p_sys->track[i] );
+    msg_Dbg( p_demux, "sample tables loaded in %"PRId64" ms, using %zu KiB",
+             MS_FROM_VLC_TICK( vlc_tick_now() - i_open_start ), i_index_size / 1024 );
+
     for( unsigned i = 0; i < p_sys->i_tracks; i++ ) /* PTS shift handling pass 2 */
     {
         mp4_track_t *p_track = &p_sys->track[i];
@@ -1448,6 +1479,11 @@ static int Open( vlc_object_t * p_this )
 
     p_sys->hacks.es_cat_filter = UNKNOWN_ES;
 
+    if( p_sys->b_fragmented && p_sys->b_fastseekable && !p_sys->b_fragments_probed &&
+        !MP4_BoxGet( p_sys->p_root, "sidx" ) && p_demux->psz_url &&
+        !p_demux->b_preparsing && var_InheritBool( p_demux, CFG_PREFIX"fragment-scan" ) )
+        FragScanStart( p_demux );
+
     return VLC_SUCCESS;
 
 error:
@@ -2092,6 +2128,8 @@ static int FragSeekToTime( demux_t *p_demux, vlc_tick_t i_nztime, bool b_accurat
 
     uint64_t i_backup_pos = vlc_stream_Tell( p_demux->s );
 
+    FragScanJoin( p_demux, false );
+
     if ( !p_sys->b_fragments_probed && !p_sys->b_index_probed && p_sys->b_seekable )
     {
         ProbeIndex( p_demux );
@@ -2122,9 +2160,14 @@ static int FragSeekToTime( demux_t *p_demux, vlc_tick_t i_nztime, bool b_accurat
         }
         else if( !p_sys->b_fragments_probed )
         {
-            int i_ret = ProbeFragmentsChecked( p_demux );
-            if( i_ret != VLC_SUCCESS )
-                return i_ret;
+            /* Waiting for the background scan is cheaper than starting over */
+            FragScanJoin( p_demux, true );
+            if( !p_sys->b_fragments_probed )
+            {
+                int i_ret = ProbeFragmentsChecked( p_demux );
+                if( i_ret != VLC_SUCCESS )
+                    return i_ret;
+            }
         }
 
         if( p_sys->b_fragments_probed && p_sys->p_fragsindex )
@@ -2464,9 +2507,16 @@ static void Close ( vlc_object_t * p_this )
 
     msg_Dbg( p_demux, "freeing all memory" );
 
+    if( p_sys->fragscan.b_running )
+    {
+        vlc_interrupt_kill( p_sys->fragscan.p_interrupt );
+        FragScanJoin( p_demux, true );
+    }
+
     FragResetContext( p_sys );
 
     MP4_BoxFree( p_sys->p_root );
+    MP4_BoxFree( p_sys->p_sidxroot );
 
     if( p_sys->p_title )
         vlc_input_title_Delete( p_sys->p_title );
@@ -2791,6 +2841,133 @@ static int xTTS_CountEntries( demux_t *p_demux, uint32_t *pi_entry /* out */,
     return VLC_SUCCESS;
 }
 
+/* The track chunks now hold their own copy of the time and offset tables:
+ * release the expanded box tables, which are large on long recordings. */
+static void TrackReleaseSampleTables( mp4_track_t *p_track )
+{
+    MP4_Box_t *p_box, *p_co64;
+
+    if( ( (p_co64 = MP4_BoxGet( p_track->p_stbl, "stco" )) ||
+          (p_co64 = MP4_BoxGet( p_track->p_stbl, "co64" )) ) && BOXDATA(p_co64) )
+    {
+        free( BOXDATA(p_co64)->i_chunk_offset );
+        BOXDATA(p_co64)->i_chunk_offset = NULL;
+        BOXDATA(p_co64)->i_entry_count = 0;
+    }
+
+    if( (p_box = MP4_BoxGet( p_track->p_stbl, "stts" )) && p_box->data.p_stts )
+    {
+        MP4_Box_data_stts_t *stts = p_box->data.p_stts;
+        free( stts->pi_sample_count );
+        free( stts->pi_sample_delta );
+        stts->pi_sample_count = stts->pi_sample_delta = NULL;
+        stts->i_entry_count = 0;
+    }
+
+    if( (p_box = MP4_BoxGet( p_track->p_stbl, "ctts" )) && p_box->data.p_ctts )
+    {
+        MP4_Box_data_ctts_t *ctts = p_box->data.p_ctts;
+        free( ctts->pi_sample_count );
+        free( ctts->pi_sample_offset );
+        ctts->pi_sample_count = NULL;
+        ctts->pi_sample_offset = NULL;
+        ctts->i_entry_count = 0;
+    }
+}
+
+/* Stores sample sizes as runs when there are at least four samples per run
+ * on average, as done by CBR audio or fixed size frames tracks using
+ * per-sample sizes. */
+static void TrackCompactSampleSizes( mp4_track_t *p_track )
+{
+    const uint32_t *p_sizes = p_track->p_sample_size;
+    const uint32_t i_samples = p_track->i_sample_count;
+    if( i_samples == 0 )
+        return;
+
+    uint32_t i_runs = 1;
+    for( uint32_t i = 1; i < i_samples; i++ )
+    {
+        if( p_sizes[i] != p_sizes[i - 1] && ++i_runs > i_samples / 4 )
+            return;
+    }
+
+    mp4_size_run_t *p_runs = vlc_alloc( i_runs, sizeof(*p_runs) );
+    if( !p_runs )
+        return;
+
+    uint32_t i_run = 0;
+    p_runs[0].i_first = 0;
+    p_runs[0].i_size = p_sizes[0];
+    for( uint32_t i = 1; i < i_samples; i++ )
+    {
+        if( p_sizes[i] != p_runs[i_run].i_size )
+        {
+            i_run++;
+            p_runs[i_run].i_first = i;
+            p_runs[i_run].i_size = p_sizes[i];
+        }
+    }
+
+    free( p_track->p_sample_size );
+    p_track->p_sample_size = NULL;
+    p_track->size_runs.p_runs = p_runs;
+    p_track->size_runs.i_count = i_runs;
+    p_track->size_runs.i_cursor = 0;
+}
+
+static uint32_t MP4_TrackGetSampleSize( mp4_track_t *p_track, uint32_t i_sample )
+{
+    if( p_track->i_sample_size )
+        return p_track->i_sample_size;
+    if( p_track->p_sample_size )
+        return p_track->p_sample_size[i_sample];
+
+    const mp4_size_run_t *p_runs = p_track->size_runs.p_runs;
+    const uint32_t i_count = p_track->size_runs.i_count;
+    uint32_t i_run = p_track->size_runs.i_cursor;
+
+    /* sequential reads stay in the current run or move to the next one */
+    if( i_run + 1 < i_count && i_sample >= p_runs[i_run + 1].i_first &&
+        ( i_run + 2 >= i_count || i_sample < p_runs[i_run + 2].i_first ) )
+        i_run++;
+    else if( i_sample < p_runs[i_run].i_first ||
+             ( i_run + 1 < i_count && i_sample >= p_runs[i_run + 1].i_first ) )
+    {
+        /* last run starting at or before i_sample */
+        uint32_t i_low = 0, i_high = i_count;
+        while( i_high - i_low > 1 )
+        {
+            uint32_t i_mid = i_low + (i_high - i_low) / 2;
+            if( p_runs[i_mid].i_first <= i_sample )
+                i_low = i_mid;
+            else
+                i_high = i_mid;
+        }
+        i_run = i_low;
+    }
+
+    p_track->size_runs.i_cursor = i_run;
+    return p_runs[i_run].i_size;
+}
+
+static size_t TrackIndexSize( const mp4_track_t *p_track )
+{
+    size_t i_size = p_track->i_chunk_count * sizeof(mp4_chunk_t);
+    if( p_track->p_sample_size )
+        i_size += p_track->i_sample_count * sizeof(uint32_t);
+    i_size += p_track->size_runs.i_count * sizeof(mp4_size_run_t);
+    for( uint32_t i = 0; i < p_track->i_chunk_count; i++ )
+    {
+        const mp4_chunk_t *ck = &p_track->chunk[i];
+        if( ck->i_entries_dts > MP4_CHUNK_SMALLBUF_ENTRIES )
+            i_size += ck->i_entries_dts * 2 * sizeof(uint32_t);
+        if( ck->i_entries_pts > MP4_CHUNK_SMALLBUF_ENTRIES )
+            i_size += ck->i_entries_pts * 2 * sizeof(uint32_t);
+    }
+    return i_size;
+}
+
 static int TrackCreateSamplesIndex( demux_t *p_demux,
                                     mp4_track_t *p_demux_track )
 {
@@ -2828,18 +3005,15 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     }
     else
     {
-        /* 2: each sample can have a different size */
+        /* 2: each sample can have a different size,
+         * take over the box table instead of copying it */
+        if( stsz->i_entry_size == NULL )
+            return VLC_EGENERIC;
         p_demux_track->i_sample_size = 0;
-        p_demux_track->p_sample_size =
-            calloc( p_demux_track->i_sample_count, sizeof( uint32_t ) );
-        if( p_demux_track->p_sample_size == NULL )
-            return VLC_ENOMEM;
+        p_demux_track->p_sample_size = stsz->i_entry_size;
+        stsz->i_entry_size = NULL;
 
-        for( uint32_t i_sample = 0; i_sample < p_demux_track->i_sample_count; i_sample++ )
-        {
-            p_demux_track->p_sample_size[i_sample] =
-                    stsz->i_entry_size[i_sample];
-        }
+        TrackCompactSampleSizes( p_demux_track );
     }
 
     if ( p_demux_track->i_chunk_count && p_demux_track->i_sample_size == 0 )
@@ -3972,6 +4146,7 @@ static void MP4_TrackSetup( demux_t *p_demux, mp4_track_t *p_track,
         msg_Err( p_demux, "cannot create chunks index" );
         return; /* cannot create chunks index */
     }
+    TrackReleaseSampleTables( p_track );
 
     p_track->i_next_dts = 0;
     p_track->i_next_delta = UNKNOWN_DELTA;
@@ -4075,8 +4250,8 @@ static void MP4_TrackClean( es_out_t *out, mp4_track_t *p_track )
     }
     free( p_track->chunk );
 
-    if( !p_track->i_sample_size )
-        free( p_track->p_sample_size );
+    free( p_track->p_sample_size );
+    free( p_track->size_runs.p_runs );
 
     ASFPacketTrackReset( &p_track->asfinfo );
 
@@ -4250,7 +4425,7 @@ static uint32_t MP4_TrackGetReadSize( mp4_track_t *p_track, uint32_t *pi_nb_samp
         *pi_nb_samples = 1;
 
         if( p_track->i_sample_size == 0 ) /* all sizes are different */
-            return p_track->p_sample_size[p_track->i_sample];
+            return MP4_TrackGetSampleSize( p_track, p_track->i_sample );
         else
             return p_track->i_sample_size;
     }
@@ -4288,7 +4463,7 @@ static uint32_t MP4_TrackGetReadSize( mp4_track_t *p_track, uint32_t *pi_nb_samp
         if( p_track->i_sample_size == 0 )
         {
             *pi_nb_samples = 1;
-            return p_track->p_sample_size[p_track->i_sample];
+            return MP4_TrackGetSampleSize( p_track, p_track->i_sample );
         }
 
         /* If we are compressed but not v2 LPCM frames extensions */
@@ -4298,7 +4473,7 @@ static uint32_t MP4_TrackGetReadSize( mp4_track_t *p_track, uint32_t *pi_nb_samp
             if ( p_track->i_sample_size )
                 return p_track->i_sample_size;
             else
-                return p_track->p_sample_size[p_track->i_sample];
+                return MP4_TrackGetSampleSize( p_track, p_track->i_sample );
         }
 
         /* More regular V0 cases */
@@ -4378,7 +4553,7 @@ static uint32_t MP4_TrackGetReadSize( mp4_track_t *p_track, uint32_t *pi_nb_samp
                  i<p_track->i_sample_count;
                  i++ )
             {
-                i_size += p_track->p_sample_size[i];
+                i_size += MP4_TrackGetSampleSize( p_track, i );
                 (*pi_nb_samples)++;
 
                 /* Try to detect compression in ISO */
@@ -4435,7 +4610,7 @@ static uint64_t MP4_TrackGetPos( mp4_track_t *p_track )
         for( i_sample = p_track->chunk[p_track->i_chunk].i_sample_first;
              i_sample < p_track->i_sample; i_sample++ )
         {
-            i_pos += p_track->p_sample_size[i_sample];
+            i_pos += MP4_TrackGetSampleSize( p_track, i_sample );
         }
     }
 
@@ -4776,6 +4951,67 @@ static bool GetMoofTrackDuration( MP4_Box_t *p_moov, MP4_Box_t *p_moof,
     return false;
 }
 
+static mp4_fragments_index_t * BuildFragmentsIndex( demux_sys_t *p_sys,
+                                                    const MP4_Box_t *p_vroot,
+                                                    unsigned i_moof )
+{
+    mp4_fragments_index_t *p_fragsindex = MP4_Fragments_Index_New( p_sys->i_tracks, i_moof );
+    if( !p_fragsindex )
+        return NULL;
+
+    stime_t *pi_track_times = calloc( p_sys->i_tracks, sizeof(*pi_track_times) );
+    if( !pi_track_times )
+    {
+        MP4_Fragments_Index_Delete( p_fragsindex );
+        return NULL;
+    }
+
+    unsigned index = 0;
+
+    for( MP4_Box_t *p_moof = p_vroot->p_first; p_moof; p_moof = p_moof->p_next )
+    {
+        if( p_moof->i_type != ATOM_moof )
+            continue;
+
+        for( unsigned i=0; i<p_sys->i_tracks; i++ )
+        {
+            MP4_Box_t *p_tfdt = NULL;
+            MP4_Box_t *p_traf = MP4_GetTrafByTrackID( p_moof, p_sys->track[i].i_track_ID );
+            if( p_traf )
+                p_tfdt = MP4_BoxGet( p_traf, "tfdt" );
+
+            if( p_tfdt && BOXDATA(p_tfdt) )
+            {
+                pi_track_times[i] = p_tfdt->data.p_tfdt->i_base_media_decode_time;
+            }
+            else if( index == 0 ) /* Set first fragment time offset from moov */
+            {
+                stime_t i_duration = GetMoovTrackDuration( p_sys, p_sys->track[i].i_track_ID );
+                pi_track_times[i] = MP4_rescale( i_duration, p_sys->i_timescale, p_sys->track[i].i_timescale );
+            }
+
+            stime_t i_movietime = MP4_rescale( pi_track_times[i], p_sys->track[i].i_timescale, p_sys->i_timescale );
+            p_fragsindex->p_times[index * p_sys->i_tracks + i] = i_movietime;
+
+            stime_t i_duration = 0;
+            if( GetMoofTrackDuration( p_sys->p_moov, p_moof, p_sys->track[i].i_track_ID, &i_duration ) )
+                pi_track_times[i] += i_duration;
+        }
+
+        p_fragsindex->pi_pos[index++] = p_moof->i_pos;
+    }
+
+    for( unsigned i=0; i<p_sys->i_tracks; i++ )
+    {
+        stime_t i_movietime = MP4_rescale( pi_track_times[i], p_sys->track[i].i_timescale, p_sys->i_timescale );
+        if( p_fragsindex->i_last_time < i_movietime )
+            p_fragsindex->i_last_time = i_movietime;
+    }
+
+    free( pi_track_times );
+    return p_fragsindex;
+}
+
 static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
@@ -4797,65 +5033,12 @@ static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
         if( i_moof )
         {
             *pb_fragmented = true;
-            p_sys->p_fragsindex = MP4_Fragments_Index_New( p_sys->i_tracks, i_moof );
+            p_sys->p_fragsindex = BuildFragmentsIndex( p_sys, p_vroot, i_moof );
             if( !p_sys->p_fragsindex )
             {
                 MP4_BoxFree( p_vroot );
                 return VLC_EGENERIC;
             }
-
-            stime_t *pi_track_times = calloc( p_sys->i_tracks, sizeof(*pi_track_times) );
-            if( !pi_track_times )
-            {
-                MP4_Fragments_Index_Delete( p_sys->p_fragsindex );
-                p_sys->p_fragsindex = NULL;
-                MP4_BoxFree( p_vroot );
-                return VLC_EGENERIC;
-            }
-
-            unsigned index = 0;
-
-            for( MP4_Box_t *p_moof = p_vroot->p_first; p_moof; p_moof = p_moof->p_next )
-            {
-                if( p_moof->i_type != ATOM_moof )
-                    continue;
-
-                for( unsigned i=0; i<p_sys->i_tracks; i++ )
-                {
-                    MP4_Box_t *p_tfdt = NULL;
-                    MP4_Box_t *p_traf = MP4_GetTrafByTrackID( p_moof, p_sys->track[i].i_track_ID );
-                    if( p_traf )
-                        p_tfdt = MP4_BoxGet( p_traf, "tfdt" );
-
-                    if( p_tfdt && BOXDATA(p_tfdt) )
-                    {
-                        pi_track_times[i] = p_tfdt->data.p_tfdt->i_base_media_decode_time;
-                    }
-                    else if( index == 0 ) /* Set first fragment time offset from moov */
-                    {
-                        stime_t i_duration = GetMoovTrackDuration( p_sys, p_sys->track[i].i_track_ID );
-                        pi_track_times[i] = MP4_rescale( i_duration, p_sys->i_timescale, p_sys->track[i].i_timescale );
-                    }
-
-                    stime_t i_movietime = MP4_rescale( pi_track_times[i], p_sys->track[i].i_timescale, p_sys->i_timescale );
-                    p_sys->p_fragsindex->p_times[index * p_sys->i_tracks + i] = i_movietime;
-
-                    stime_t i_duration = 0;
-                    if( GetMoofTrackDuration( p_sys->p_moov, p_moof, p_sys->track[i].i_track_ID, &i_duration ) )
-                        pi_track_times[i] += i_duration;
-                }
-
-                p_sys->p_fragsindex->pi_pos[index++] = p_moof->i_pos;
-            }
-
-            for( unsigned i=0; i<p_sys->i_tracks; i++ )
-            {
-                stime_t i_movietime = MP4_rescale( pi_track_times[i], p_sys->track[i].i_timescale, p_sys->i_timescale );
-                if( p_sys->p_fragsindex->i_last_time < i_movietime )
-                    p_sys->p_fragsindex->i_last_time = i_movietime;
-            }
-
-            free( pi_track_times );
 #ifdef MP4_VERBOSE
             MP4_Fragments_Index_Dump( VLC_OBJECT(p_demux), p_sys->p_fragsindex, p_sys->i_timescale );
 #endif
@@ -4926,6 +5109,93 @@ static int ProbeFragmentsChecked( demux_t *p_demux )
     return i_ret;
 }
 
+static void *FragScanThread( void *data )
+{
+    demux_t *p_demux = data;
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    vlc_thread_set_name( "vlc-mp4-frags" );
+    vlc_interrupt_set( p_sys->fragscan.p_interrupt );
+
+    /* Own stream handle, the demuxer keeps reading from its own */
+    stream_t *s = vlc_stream_NewURL( VLC_OBJECT(p_demux), p_demux->psz_url );
+    MP4_Box_t *p_vroot = MP4_BoxNew( ATOM_root );
+    if( s && p_vroot &&
+        vlc_stream_Seek( s, p_sys->p_moov->i_pos + p_sys->p_moov->i_size ) == VLC_SUCCESS )
+    {
+        /* Read moof by moof so we can be interrupted */
+        const uint32_t stoplist[] = { ATOM_moof, 0 };
+        while( !vlc_killed() )
+        {
+            const MP4_Box_t *p_last = p_vroot->p_last;
+            MP4_ReadBoxContainerChildren( s, p_vroot, stoplist );
+            if( p_vroot->p_last == p_last )
+                break;
+        }
+
+        const unsigned i_moof = MP4_BoxCount( p_vroot, "/moof" );
+        if( i_moof && !vlc_killed() )
+            p_sys->fragscan.p_index = BuildFragmentsIndex( p_sys, p_vroot, i_moof );
+    }
+
+    MP4_BoxFree( p_vroot );
+    if( s )
+        vlc_stream_Delete( s );
+
+    vlc_interrupt_set( NULL );
+    atomic_store_explicit( &p_sys->fragscan.b_done, true, memory_order_release );
+    return NULL;
+}
+
+static void FragScanStart( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    p_sys->fragscan.p_interrupt = vlc_interrupt_create();
+    if( !p_sys->fragscan.p_interrupt )
+        return;
+
+    atomic_init( &p_sys->fragscan.b_done, false );
+    if( vlc_clone( &p_sys->fragscan.thread, FragScanThread, p_demux ) )
+    {
+        vlc_interrupt_destroy( p_sys->fragscan.p_interrupt );
+        return;
+    }
+    p_sys->fragscan.b_running = true;
+    msg_Dbg( p_demux, "indexing fragments in background" );
+}
+
+/* Collects the background scan result, if done or if b_wait is set */
+static void FragScanJoin( demux_t *p_demux, bool b_wait )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !p_sys->fragscan.b_running ||
+        (!b_wait && !atomic_load_explicit( &p_sys->fragscan.b_done, memory_order_acquire )) )
+        return;
+
+    vlc_join( p_sys->fragscan.thread, NULL );
+    vlc_interrupt_destroy( p_sys->fragscan.p_interrupt );
+    p_sys->fragscan.b_running = false;
+
+    mp4_fragments_index_t *p_index = p_sys->fragscan.p_index;
+    p_sys->fragscan.p_index = NULL;
+    if( !p_index || p_sys->b_fragments_probed )
+    {
+        MP4_Fragments_Index_Delete( p_index );
+        return;
+    }
+
+    p_sys->p_fragsindex = p_index;
+    p_sys->b_fragments_probed = true;
+#ifdef MP4_VERBOSE
+    MP4_Fragments_Index_Dump( VLC_OBJECT(p_demux), p_sys->p_fragsindex, p_sys->i_timescale );
+#endif
+
+    if ( !MP4_BoxGet( p_sys->p_moov, "mvex/mehd") )
+        p_sys->i_cumulated_duration = GetCumulatedDuration( p_demux );
+}
+
 static void FragResetContext( demux_sys_t *p_sys )
 {
     if( p_sys->context.p_fragment_atom )
@@ -5385,38 +5655,107 @@ static int FragCreateTrunIndex( demux_t *p_demux, MP4_Box_t *p_moof,
     return VLC_SUCCESS;
 }
 
-static int FragGetMoofBySidxIndex( demux_t *p_demux, vlc_tick_t target_time,
-                                   uint64_t *pi_moof_pos, vlc_tick_t *pi_sampletime )
+/* Returns the sidx at i_pos, loading it if it is not a root one */
+static const MP4_Box_t * FragGetSidxAt( demux_t *p_demux, uint64_t i_pos )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
-    const MP4_Box_t *p_sidx = MP4_BoxGet( p_sys->p_root, "sidx" );
-    for( ; p_sidx ; p_sidx = p_sidx->p_next )
+
+    for( const MP4_Box_t *p_box = p_sys->p_root->p_first; p_box; p_box = p_box->p_next )
     {
-        if( p_sidx->i_type != ATOM_sidx )
-            continue;
+        if( p_box->i_type == ATOM_sidx && p_box->i_pos == i_pos )
+            return p_box;
+    }
 
-        const MP4_Box_data_sidx_t *p_data = BOXDATA(p_sidx);
-        if( !p_data || !p_data->i_timescale )
-            break;
+    if( !p_sys->p_sidxroot )
+    {
+        p_sys->p_sidxroot = MP4_BoxNew( ATOM_root );
+        if( !p_sys->p_sidxroot )
+            return NULL;
+    }
+    else
+    {
+        for( const MP4_Box_t *p_box = p_sys->p_sidxroot->p_first; p_box; p_box = p_box->p_next )
+        {
+            if( p_box->i_pos == i_pos )
+                return p_box;
+        }
+    }
+
+    const uint8_t *p_peek;
+    if( vlc_stream_Seek( p_demux->s, i_pos ) != VLC_SUCCESS ||
+        vlc_stream_Peek( p_demux->s, &p_peek, 8 ) < 8 ||
+        VLC_FOURCC( p_peek[4], p_peek[5], p_peek[6], p_peek[7] ) != ATOM_sidx )
+        return NULL;
+
+    const uint32_t stoplist[] = { ATOM_sidx, 0 };
+    const MP4_Box_t *p_last = p_sys->p_sidxroot->p_last;
+    MP4_ReadBoxContainerChildren( p_demux->s, p_sys->p_sidxroot, stoplist );
+    if( p_sys->p_sidxroot->p_last == p_last ||
+        p_sys->p_sidxroot->p_last->i_pos != i_pos )
+        return NULL;
+
+    return p_sys->p_sidxroot->p_last;
+}
+
+#define SIDX_MAX_DEPTH 8
 
-        stime_t i_target_time = MP4_rescale_qtime( target_time, p_data->i_timescale );
+static int FragGetMoofBySidx( demux_t *p_demux, const MP4_Box_t *p_sidx,
+                              vlc_tick_t i_basetime, vlc_tick_t target_time,
+                              unsigned i_depth,
+                              uint64_t *pi_moof_pos, vlc_tick_t *pi_sampletime )
+{
+    const MP4_Box_data_sidx_t *p_data = BOXDATA(p_sidx);
+    if( !p_data || !p_data->i_timescale )
+        return VLC_EGENERIC;
 
-        /* sidx refers to offsets from end of sidx pos in the file + first offset */
-        uint64_t i_pos = p_data->i_first_offset + p_sidx->i_pos + p_sidx->i_size;
-        stime_t i_time = 0;
-        for( uint16_t i=0; i<p_data->i_reference_count; i++ )
+    stime_t i_target_time = MP4_rescale_qtime( target_time - i_basetime, p_data->i_timescale );
+
+    /* sidx refers to offsets from end of sidx pos in the file + first offset */
+    uint64_t i_pos = p_data->i_first_offset + p_sidx->i_pos + p_sidx->i_size;
+    stime_t i_time = 0;
+    for( uint16_t i=0; i<p_data->i_reference_count; i++ )
+    {
+        const MP4_Box_sidx_item_t *p_item = &p_data->p_items[i];
+        if( i_time + p_item->i_subsegment_duration > i_target_time )
         {
-            if(p_data->p_items[i].b_reference_type != 0)
-                continue;
-            if( i_time + p_data->p_items[i].i_subsegment_duration > i_target_time )
+            vlc_tick_t i_start = i_basetime + MP4_rescale_mtime( i_time, p_data->i_timescale );
+            if( p_item->b_reference_type == 0 )
             {
-                *pi_sampletime = MP4_rescale_mtime( i_time, p_data->i_timescale );
+                *pi_sampletime = i_start;
                 *pi_moof_pos = i_pos;
                 return VLC_SUCCESS;
             }
-            i_pos += p_data->p_items[i].i_referenced_size;
-            i_time += p_data->p_items[i].i_subsegment_duration;
+
+            /* References a child sidx (hierarchical or daisy chained index) */
+            const MP4_Box_t *p_child = ( i_depth < SIDX_MAX_DEPTH )
+                                     ? FragGetSidxAt( p_demux, i_pos ) : NULL;
+            if( !p_child )
+                return VLC_EGENERIC;
+            return FragGetMoofBySidx( p_demux, p_child, i_start, target_time,
+                                      i_depth + 1, pi_moof_pos, pi_sampletime );
         }
+        i_pos += p_item->i_referenced_size;
+        i_time += p_item->i_subsegment_duration;
+    }
+    return VLC_EGENERIC;
+}
+
+static int FragGetMoofBySidxIndex( demux_t *p_demux, vlc_tick_t target_time,
+                                   uint64_t *pi_moof_pos, vlc_tick_t *pi_sampletime )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const MP4_Box_t *p_sidx = MP4_BoxGet( p_sys->p_root, "sidx" );
+    for( ; p_sidx ; p_sidx = p_sidx->p_next )
+    {
+        if( p_sidx->i_type != ATOM_sidx )
+            continue;
+
+        if( !BOXDATA(p_sidx) || !BOXDATA(p_sidx)->i_timescale )
+            break;
+
+        if( FragGetMoofBySidx( p_demux, p_sidx, 0, target_time, 0,
+                               pi_moof_pos, pi_sampletime ) == VLC_SUCCESS )
+            return VLC_SUCCESS;
     }
     return VLC_EGENERIC;
 }
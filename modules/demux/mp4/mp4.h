@@ -32,6 +32,13 @@
 
 #define MP4_CHUNK_SMALLBUF_ENTRIES 2
 
+/* Run of consecutive samples of the same size */
+typedef struct
+{
+    uint32_t i_first; /* first sample of the run */
+    uint32_t i_size;
+} mp4_size_run_t;
+
 /* Contain all information about a chunk */
 typedef struct
 {
@@ -155,6 +162,13 @@ typedef struct
     uint32_t         i_sample_size;
     uint32_t         *p_sample_size; /* XXX perhaps add file offset if take
 //                                    too much time to do sumations each time*/
+    /* replaces p_sample_size (then NULL) when sizes come in few runs */
+    struct
+    {
+        uint32_t        i_count;
+        uint32_t        i_cursor; /* last run used, for sequential reads */
+        mp4_size_run_t *p_runs;
+    } size_runs;
 
     const MP4_Box_t *p_track;
     const MP4_Box_t *p_stbl;  /* will contain all timing information */
@@ -40,6 +40,7 @@
 #include <vlc_codecs.h>
 #include <vlc_input.h>
 #include <vlc_replay_gain.h>
+#include <vlc_interrupt.h>
 
 #include "../../packetizer/a52.h"
 #include "../../packetizer/dts_header.h"
@@ -47,6 +48,7 @@
 #include "../../meta_engine/ID3Tag.h"
 #include "../../meta_engine/ID3Text.h"
 #include "../../meta_engine/ID3Meta.h"
+#include "ts_index.h"
 
 /*****************************************************************************
  * Module descriptor
@@ -55,6 +57,11 @@ static int  OpenAudio( vlc_object_t * );
 static int  OpenVideo( vlc_object_t * );
 static void Close    ( vlc_object_t * );
 
+#define SEEK_INDEX_TEXT N_("Build a seek index")
+#define SEEK_INDEX_LONGTEXT N_( \
+    "Record the position of audio frames while playing, and scan local " \
+    "files without seek table in background, for accurate seeking.")
+
 #define FPS_TEXT N_("Frames per Second")
 #define FPS_LONGTEXT N_("This is the frame rate used as a fallback when " \
     "playing MPEG video elementary streams.")
@@ -73,6 +80,8 @@ vlc_module_begin ()
                   "dts",
                   "mlp", "thd" )
 
+    add_bool( "es-seek-index", false, SEEK_INDEX_TEXT, SEEK_INDEX_LONGTEXT )
+
     add_submodule()
     set_description( N_("MPEG-4 video" ) )
     set_capability( "demux", 7 )
@@ -127,6 +136,19 @@ typedef struct
     seekpoint_t *p_seekpoint;
 } chap_entry_t;
 
+/* Tracks the block reads to find positions from which a frame can be
+ * decoded: a frame output after the previous output one started no earlier
+ * than the block read before that previous output. */
+typedef struct
+{
+    uint64_t i_block_pos;
+    uint64_t i_prev_pos;
+    uint64_t i_anchor_pos;
+} seek_cursor_t;
+
+#define SEEK_CURSOR_INVALID UINT64_MAX
+#define SEEK_SCAN_BLOCK 512
+
 /* Mpga specific */
 #define XING_FIELD_STREAMFRAMES    (1 << 0)
 #define XING_FIELD_STREAMBYTES     (1 << 1)
@@ -374,6 +396,18 @@ typedef struct
         size_t i_current;
         chap_entry_t *p_entry;
     } chapters;
+
+    struct
+    {
+        bool b_enabled;
+        bool b_valid; /* timestamps currently match the stream position */
+        seek_cursor_t cursor;
+        vlc_mutex_t lock;
+        ts_index_t index;
+        bool b_scanning;
+        vlc_thread_t thread;
+        vlc_interrupt_t *p_interrupt;
+    } seekindex;
 } demux_sys_t;
 
 static int MpgaProbe( demux_t *p_demux, uint64_t *pi_offset );
@@ -394,6 +428,9 @@ static int ThdProbe( demux_t *p_demux, uint64_t *pi_offset );
 static int MlpInit( demux_t *p_demux );
 
 static bool Parse( demux_t *p_demux, block_t **pp_output );
+static block_t *ReadBlock( stream_t *, const demux_sys_t *, size_t, uint64_t * );
+static void SeekIndexStart( demux_t *p_demux );
+static int SeekByIndex( demux_t *p_demux, vlc_tick_t i_time );
 static int SeekByMlltTable( sync_table_t *, vlc_tick_t *, uint64_t * );
 
 static const codec_t p_codecs[] = {
@@ -441,6 +478,14 @@ static int OpenCommon( demux_t *p_demux,
     p_sys->xing.f_radio_replay_gain = NAN;
     p_sys->xing.f_audiophile_replay_gain = NAN;
     TAB_INIT(p_sys->chapters.i_count, p_sys->chapters.p_entry);
+    p_sys->seekindex.b_enabled = i_cat == AUDIO_ES &&
+                                 var_InheritBool( p_demux, "es-seek-index" );
+    p_sys->seekindex.b_valid = true;
+    p_sys->seekindex.cursor.i_block_pos =
+    p_sys->seekindex.cursor.i_prev_pos =
+    p_sys->seekindex.cursor.i_anchor_pos = SEEK_CURSOR_INVALID;
+    vlc_mutex_init( &p_sys->seekindex.lock );
+    ts_index_Init( &p_sys->seekindex.index );
 
     if( vlc_stream_Seek( p_demux->s, p_sys->i_stream_offset ) )
     {
@@ -483,6 +528,9 @@ static int OpenCommon( demux_t *p_demux,
             break;
     }
 
+    if( p_sys->seekindex.b_enabled )
+        SeekIndexStart( p_demux );
+
     return VLC_SUCCESS;
 }
 static int OpenAudio( vlc_object_t *p_this )
@@ -608,6 +656,14 @@ static void Close( vlc_object_t * p_this )
     demux_t     *p_demux = (demux_t*)p_this;
     demux_sys_t *p_sys = p_demux->p_sys;
 
+    if( p_sys->seekindex.b_scanning )
+    {
+        vlc_interrupt_kill( p_sys->seekindex.p_interrupt );
+        vlc_join( p_sys->seekindex.thread, NULL );
+        vlc_interrupt_destroy( p_sys->seekindex.p_interrupt );
+    }
+    ts_index_Clean( &p_sys->seekindex.index );
+
     if( p_sys->p_packetized_data )
         block_ChainRelease( p_sys->p_packetized_data );
     for( size_t i=0; i< p_sys->chapters.i_count; i++ )
@@ -634,6 +690,11 @@ static void PostSeekCleanup( demux_sys_t *p_sys, vlc_tick_t i_time )
     /* Reset chapter if any */
     p_sys->chapters.i_current = 0;
     p_sys->i_demux_flags |= INPUT_UPDATE_SEEKPOINT;
+    /* Stop indexing until a seek lands on a known time */
+    p_sys->seekindex.b_valid = false;
+    p_sys->seekindex.cursor.i_block_pos =
+    p_sys->seekindex.cursor.i_prev_pos =
+    p_sys->seekindex.cursor.i_anchor_pos = SEEK_CURSOR_INVALID;
 }
 
 static int MovetoTimePos( demux_t *p_demux, vlc_tick_t i_time, uint64_t i_pos )
@@ -646,6 +707,141 @@ static int MovetoTimePos( demux_t *p_demux, vlc_tick_t i_time, uint64_t i_pos )
     return VLC_SUCCESS;
 }
 
+/*****************************************************************************
+ * Seek index:
+ *****************************************************************************/
+static void SeekCursorBlock( seek_cursor_t *p_cursor, uint64_t i_pos )
+{
+    p_cursor->i_prev_pos = p_cursor->i_block_pos;
+    p_cursor->i_block_pos = i_pos;
+}
+
+static uint64_t SeekCursorFrame( seek_cursor_t *p_cursor )
+{
+    uint64_t i_pos = p_cursor->i_anchor_pos;
+    p_cursor->i_anchor_pos = p_cursor->i_prev_pos;
+    return i_pos;
+}
+
+static int SeekByIndex( demux_t *p_demux, vlc_tick_t i_time )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    vlc_tick_t i_found;
+    uint64_t i_low, i_high;
+
+    if( !p_sys->seekindex.b_enabled || i_time == VLC_TICK_INVALID )
+        return VLC_EGENERIC;
+
+    vlc_mutex_lock( &p_sys->seekindex.lock );
+    bool b_found = ts_index_Lookup( &p_sys->seekindex.index, 0, i_time,
+                                    &i_found, &i_low, &i_high );
+    vlc_mutex_unlock( &p_sys->seekindex.lock );
+
+    /* Entries are dense where the index is known, anything farther away
+     * is outside of what has been indexed yet */
+    if( !b_found || i_time - i_found > 2 * TS_INDEX_INTERVAL )
+        return VLC_EGENERIC;
+
+    int i_ret = MovetoTimePos( p_demux, i_found, i_low );
+    p_sys->seekindex.b_valid = i_ret == VLC_SUCCESS;
+    return i_ret;
+}
+
+static void *SeekIndexThread( void *data )
+{
+    demux_t *p_demux = data;
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    vlc_thread_set_name( "vlc-es-index" );
+    vlc_interrupt_set( p_sys->seekindex.p_interrupt );
+
+    /* Own stream handle and packetizer, the demuxer keeps using its own */
+    decoder_t *p_packetizer = NULL;
+    stream_t *s = vlc_stream_NewURL( VLC_OBJECT(p_demux), p_demux->psz_url );
+    if( s )
+    {
+        es_format_t fmt;
+        es_format_Init( &fmt, AUDIO_ES, p_sys->codec.i_codec );
+        fmt.i_original_fourcc = p_sys->i_original;
+        p_packetizer = demux_PacketizerNew( VLC_OBJECT(p_demux), &fmt,
+                                            p_sys->codec.psz_name );
+    }
+
+    if( p_packetizer && vlc_stream_Seek( s, p_sys->i_stream_offset ) == VLC_SUCCESS )
+    {
+        seek_cursor_t cursor = {
+            .i_block_pos = SEEK_CURSOR_INVALID,
+            .i_prev_pos = SEEK_CURSOR_INVALID,
+            .i_anchor_pos = SEEK_CURSOR_INVALID,
+        };
+        bool b_start = true;
+
+        while( !vlc_killed() )
+        {
+            uint64_t i_block_pos;
+            block_t *p_block_in = ReadBlock( s, p_sys, SEEK_SCAN_BLOCK, &i_block_pos );
+            if( !p_block_in )
+                break;
+            /* Same time origin as Parse() */
+            p_block_in->i_pts =
+            p_block_in->i_dts = b_start ? VLC_TICK_0 : VLC_TICK_INVALID;
+            b_start = false;
+            SeekCursorBlock( &cursor, i_block_pos );
+
+            block_t *p_out;
+            while( ( p_out = p_packetizer->pf_packetize( p_packetizer, &p_block_in ) ) )
+            {
+                while( p_out )
+                {
+                    block_t *p_next = p_out->p_next;
+                    uint64_t i_pos = SeekCursorFrame( &cursor );
+                    if( i_pos != SEEK_CURSOR_INVALID && p_out->i_pts != VLC_TICK_INVALID )
+                    {
+                        vlc_mutex_lock( &p_sys->seekindex.lock );
+                        ts_index_Add( &p_sys->seekindex.index, 0,
+                                      p_out->i_pts - VLC_TICK_0, i_pos );
+                        vlc_mutex_unlock( &p_sys->seekindex.lock );
+                    }
+                    block_Release( p_out );
+                    p_out = p_next;
+                }
+            }
+        }
+    }
+
+    if( p_packetizer )
+        demux_PacketizerDestroy( p_packetizer );
+    if( s )
+        vlc_stream_Delete( s );
+
+    vlc_interrupt_set( NULL );
+    return NULL;
+}
+
+static void SeekIndexStart( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    bool b_fastseek = false;
+
+    /* Only scan local files which do not already have a seek table */
+    vlc_stream_Control( p_demux->s, STREAM_CAN_FASTSEEK, &b_fastseek );
+    if( !b_fastseek || p_demux->psz_filepath == NULL || p_demux->b_preparsing ||
+        p_sys->mllt.p_bits || p_sys->xing.rgi_toc[XING_TOC_COUNTBYTES - 1] )
+        return;
+
+    p_sys->seekindex.p_interrupt = vlc_interrupt_create();
+    if( !p_sys->seekindex.p_interrupt )
+        return;
+
+    if( vlc_clone( &p_sys->seekindex.thread, SeekIndexThread, p_demux ) )
+    {
+        vlc_interrupt_destroy( p_sys->seekindex.p_interrupt );
+        return;
+    }
+    p_sys->seekindex.b_scanning = true;
+    msg_Dbg( p_demux, "building seek index in background" );
+}
+
 /*****************************************************************************
  * Control:
  *****************************************************************************/
@@ -727,7 +923,15 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
 
             /* Try to use ID3 table */
             if( !SeekByMlltTable( &p_sys->mllt, &i_time, &i_offset ) )
-                return MovetoTimePos( p_demux, i_time, i_offset );
+            {
+                int i_ret = MovetoTimePos( p_demux, i_time, i_offset );
+                p_sys->seekindex.b_valid = i_ret == VLC_SUCCESS;
+                return i_ret;
+            }
+
+            /* Then our own index */
+            if( !SeekByIndex( p_demux, i_time ) )
+                return VLC_SUCCESS;
 
             if( p_sys->codec.i_codec == VLC_CODEC_MPGA )
             {
@@ -845,6 +1049,39 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
                                   p_sys->i_bitrate, 1, i_query, args );
 }
 
+/*****************************************************************************
+ * Reads a block of codec data, byte swapped to big endian if needed
+ *****************************************************************************/
+static block_t *ReadBlock( stream_t *s, const demux_sys_t *p_sys,
+                           size_t i_size, uint64_t *pi_pos )
+{
+    if( p_sys->codec.b_use_word )
+    {
+        /* Make sure we are word aligned */
+        int64_t i_pos = vlc_stream_Tell( s );
+        if( (i_pos & 1) && vlc_stream_Read( s, NULL, 1 ) != 1 )
+            return NULL;
+    }
+
+    *pi_pos = vlc_stream_Tell( s ) - p_sys->i_stream_offset;
+    block_t *p_block = vlc_stream_Block( s, i_size );
+
+    if( p_block && p_sys->codec.b_use_word && !p_sys->b_big_endian &&
+        p_block->i_buffer > 0 )
+    {
+        /* Convert to big endian */
+        block_t *old = p_block;
+        p_block = block_Alloc( p_block->i_buffer );
+        if( p_block )
+        {
+            block_CopyProperties( p_block, old );
+            swab( old->p_buffer, p_block->p_buffer, old->i_buffer );
+        }
+        block_Release( old );
+    }
+    return p_block;
+}
+
 /*****************************************************************************
  * Makes a link list of buffer of parsed data
  * Returns true if EOF
@@ -856,38 +1093,16 @@ static bool Parse( demux_t *p_demux, block_t **pp_output )
 
     *pp_output = NULL;
 
-    if( p_sys->codec.b_use_word )
-    {
-        /* Make sure we are word aligned */
-        int64_t i_pos = vlc_stream_Tell( p_demux->s );
-        if( (i_pos & 1) && vlc_stream_Read( p_demux->s, NULL, 1 ) != 1 )
-            return true;
-    }
-
-    p_block_in = vlc_stream_Block( p_demux->s, p_sys->i_packet_size );
+    uint64_t i_block_pos;
+    p_block_in = ReadBlock( p_demux->s, p_sys, p_sys->i_packet_size, &i_block_pos );
     bool b_eof = p_block_in == NULL;
 
     if( p_block_in )
     {
-        if( p_sys->codec.b_use_word && !p_sys->b_big_endian && p_block_in->i_buffer > 0 )
-        {
-            /* Convert to big endian */
-            block_t *old = p_block_in;
-            p_block_in = block_Alloc( p_block_in->i_buffer );
-            if( p_block_in )
-            {
-                block_CopyProperties( p_block_in, old );
-                swab( old->p_buffer, p_block_in->p_buffer, old->i_buffer );
-            }
-            block_Release( old );
-        }
-
-        if( p_block_in )
-        {
-            p_block_in->i_pts =
-            p_block_in->i_dts = (p_sys->b_start || p_sys->b_initial_sync_failed) ?
-                                 VLC_TICK_0 : VLC_TICK_INVALID;
-        }
+        p_block_in->i_pts =
+        p_block_in->i_dts = (p_sys->b_start || p_sys->b_initial_sync_failed) ?
+                             VLC_TICK_0 : VLC_TICK_INVALID;
+        SeekCursorBlock( &p_sys->seekindex.cursor, i_block_pos );
     }
     p_sys->b_initial_sync_failed = p_sys->b_start; /* Only try to resync once */
 
@@ -923,6 +1138,20 @@ static bool Parse( demux_t *p_demux, block_t **pp_output )
                 es_format_Clean( &fmt );
             }
 
+            if( p_sys->seekindex.b_enabled )
+            {
+                uint64_t i_pos = SeekCursorFrame( &p_sys->seekindex.cursor );
+                if( p_sys->seekindex.b_valid && i_pos != SEEK_CURSOR_INVALID &&
+                    p_block_out->i_pts != VLC_TICK_INVALID )
+                {
+                    vlc_mutex_lock( &p_sys->seekindex.lock );
+                    ts_index_Add( &p_sys->seekindex.index, 0,
+                                  p_block_out->i_pts - VLC_TICK_0 + p_sys->i_time_offset,
+                                  i_pos );
+                    vlc_mutex_unlock( &p_sys->seekindex.lock );
+                }
+            }
+
             block_t *p_next = p_block_out->p_next;
             p_block_out->p_next = NULL;
 
@@ -31,9 +31,11 @@
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_demux.h>
+#include <vlc_interrupt.h>
 
 #include "pes.h"
 #include "ps.h"
+#include "ts_index.h"
 
 /* TODO:
  *  - re-add pre-scanning.
@@ -45,6 +47,11 @@
     "to calculate position and duration. However sometimes this might not " \
     "be usable. Disable this option to calculate from the bitrate instead." )
 
+#define SEEK_INDEX_TEXT N_("Build a seek index")
+#define SEEK_INDEX_LONGTEXT N_( \
+    "Record the position of packs while playing, and scan local files " \
+    "in background, for accurate seeking by time.")
+
 #define PS_PACKET_PROBE 3
 #define CDXA_HEADER_SIZE 44
 #define CDXA_SECTOR_SIZE 2352
@@ -68,6 +75,7 @@ vlc_module_begin ()
     add_bool( "ps-trust-timestamps", true, TIME_TEXT,
                  TIME_LONGTEXT )
         change_safe ()
+    add_bool( "ps-seek-index", false, SEEK_INDEX_TEXT, SEEK_INDEX_LONGTEXT )
 
     add_submodule ()
     set_description( N_("MPEG-PS demuxer") )
@@ -113,6 +121,16 @@ typedef struct
     int         current_title;
     int         current_seekpoint;
     unsigned    updates;
+
+    struct
+    {
+        bool b_enabled;
+        vlc_mutex_t lock;
+        ts_index_t index; /* pack SCR, relative to the first one */
+        bool b_scanning;
+        vlc_thread_t thread;
+        vlc_interrupt_t *p_interrupt;
+    } seekindex;
 } demux_sys_t;
 
 static int Demux  ( demux_t *p_demux );
@@ -120,6 +138,10 @@ static int Control( demux_t *p_demux, int i_query, va_list args );
 
 static int      ps_pkt_resynch( stream_t *, int, bool );
 static block_t *ps_pkt_read   ( stream_t * );
+static int      ps_pkt_skip   ( stream_t *, bool, vlc_tick_t *, int * );
+
+static void SeekIndexStart( demux_t *p_demux );
+static void SeekIndexStop( demux_sys_t *p_sys );
 
 static void CreateOrUpdateES( demux_t*p_demux )
 {
@@ -255,11 +277,20 @@ static int OpenCommon( vlc_object_t *p_this, bool b_force )
 
     vlc_stream_Control( p_demux->s, STREAM_CAN_SEEK, &p_sys->b_seekable );
 
+    p_sys->seekindex.b_enabled = p_sys->b_seekable &&
+                                 var_InheritBool( p_demux, "ps-seek-index" );
+    p_sys->seekindex.b_scanning = false;
+    vlc_mutex_init( &p_sys->seekindex.lock );
+    ts_index_Init( &p_sys->seekindex.index );
+
     ps_psm_init( &p_sys->psm );
     ps_track_init( p_sys->tk );
 
     /* TODO prescanning of ES */
 
+    if( p_sys->seekindex.b_enabled )
+        SeekIndexStart( p_demux );
+
     return VLC_SUCCESS;
 }
 
@@ -294,6 +325,9 @@ static void Close( vlc_object_t *p_this )
 
     ps_psm_destroy( &p_sys->psm );
 
+    SeekIndexStop( p_sys );
+    ts_index_Clean( &p_sys->seekindex.index );
+
     free( p_sys );
 }
 
@@ -320,6 +354,22 @@ static int Probe( demux_t *p_demux, bool b_end )
     if( p_sys->b_lost_sync ) msg_Warn( p_demux, "found sync code" );
     p_sys->b_lost_sync = false;
 
+    vlc_tick_t i_scr; int dummy;
+    switch( ps_pkt_skip( p_demux->s, false, &i_scr, &dummy ) )
+    {
+    case -1:
+        return VLC_DEMUXER_EOF;
+    case PS_STREAM_ID_PACK_HEADER:
+        if( !b_end && i_scr != VLC_TICK_INVALID &&
+            p_sys->i_first_scr == VLC_TICK_INVALID )
+            p_sys->i_first_scr = i_scr;
+        p_sys->b_have_pack = true;
+        return VLC_DEMUXER_SUCCESS;
+    case PS_STREAM_ID_END_STREAM:
+    case PS_STREAM_ID_PADDING:
+        return VLC_DEMUXER_SUCCESS;
+    }
+
     if( ( p_pkt = ps_pkt_read( p_demux->s ) ) == NULL )
     {
         return VLC_DEMUXER_EOF;
@@ -344,7 +394,6 @@ static int Probe( demux_t *p_demux, bool b_end )
     }
     else if( i_id == PS_STREAM_ID_PACK_HEADER )
     {
-        vlc_tick_t i_scr; int dummy;
         if( !b_end && !ps_pkt_parse_pack( p_pkt->p_buffer, p_pkt->i_buffer,
                                           &i_scr, &dummy ) )
         {
@@ -429,9 +478,171 @@ static void CheckPCR( demux_sys_t *p_sys, es_out_t *out, vlc_tick_t i_scr )
         NotifyDiscontinuity( p_sys->tk, out );
 }
 
+/*****************************************************************************
+ * Seek index:
+ *****************************************************************************/
+static void SeekIndexAddPack( demux_sys_t *p_sys, uint64_t i_pos )
+{
+    /* A rejected SCR or a discontinuity breaks the time to position mapping */
+    if( p_sys->b_bad_scr ||
+        (p_sys->i_scr != VLC_TICK_INVALID &&
+         llabs( p_sys->i_scr - p_sys->i_pack_scr ) > VLC_TICK_FROM_SEC(1)) )
+    {
+        p_sys->seekindex.b_enabled = false;
+        SeekIndexStop( p_sys );
+        return;
+    }
+
+    vlc_mutex_lock( &p_sys->seekindex.lock );
+    ts_index_Add( &p_sys->seekindex.index, 0,
+                  p_sys->i_pack_scr - p_sys->i_first_scr, i_pos );
+    vlc_mutex_unlock( &p_sys->seekindex.lock );
+}
+
+static int SeekByIndex( demux_t *p_demux, vlc_tick_t i_time )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    vlc_tick_t i_found;
+    uint64_t i_low, i_high;
+
+    if( !p_sys->seekindex.b_enabled || p_sys->b_bad_scr )
+        return VLC_EGENERIC;
+
+    vlc_mutex_lock( &p_sys->seekindex.lock );
+    bool b_found = ts_index_Lookup( &p_sys->seekindex.index, 0, i_time,
+                                    &i_found, &i_low, &i_high );
+    vlc_mutex_unlock( &p_sys->seekindex.lock );
+
+    /* Entries are dense where the index is known, anything farther away
+     * is outside of what has been indexed yet */
+    if( !b_found || i_time - i_found > 2 * TS_INDEX_INTERVAL ||
+        vlc_stream_Seek( p_demux->s, i_low ) != VLC_SUCCESS )
+        return VLC_EGENERIC;
+
+    p_sys->i_current_pts = VLC_TICK_INVALID;
+    p_sys->i_scr = VLC_TICK_INVALID;
+    NotifyDiscontinuity( p_sys->tk, p_demux->out );
+    return VLC_SUCCESS;
+}
+
+static void *SeekIndexThread( void *data )
+{
+    demux_t *p_demux = data;
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    vlc_thread_set_name( "vlc-ps-index" );
+    vlc_interrupt_set( p_sys->seekindex.p_interrupt );
+
+    /* Own stream handle, the demuxer keeps reading from its own */
+    stream_t *s = vlc_stream_NewURL( VLC_OBJECT(p_demux), p_demux->psz_url );
+    if( s && vlc_stream_Seek( s, p_sys->i_start_byte ) == VLC_SUCCESS )
+    {
+        vlc_tick_t i_first_scr = VLC_TICK_INVALID;
+        vlc_tick_t i_last_scr = VLC_TICK_INVALID;
+
+        while( !vlc_killed() )
+        {
+            int i_ret = ps_pkt_resynch( s, p_sys->format, false );
+            if( i_ret < 0 )
+                break;
+            else if( i_ret == 0 )
+                continue;
+
+            /* Hop from packet to packet by their length, only the pack
+             * headers are looked at */
+            const uint64_t i_pos = vlc_stream_Tell( s );
+            vlc_tick_t i_scr;
+            int i_mux_rate;
+            i_ret = ps_pkt_skip( s, true, &i_scr, &i_mux_rate );
+            if( i_ret < 0 )
+                break;
+            if( i_ret == 0 )
+            {
+                /* No length, let the reader find the next start code */
+                block_t *p_pkt = ps_pkt_read( s );
+                if( !p_pkt )
+                    break;
+                block_Release( p_pkt );
+                continue;
+            }
+
+            if( i_ret == PS_STREAM_ID_PACK_HEADER && i_scr != VLC_TICK_INVALID )
+            {
+                /* Stop at the first discontinuity, as the demuxer does */
+                if( i_last_scr != VLC_TICK_INVALID &&
+                    llabs( i_scr - i_last_scr ) > VLC_TICK_FROM_SEC(1) )
+                    break;
+                if( i_first_scr == VLC_TICK_INVALID )
+                    i_first_scr = i_scr;
+                i_last_scr = i_scr;
+
+                vlc_mutex_lock( &p_sys->seekindex.lock );
+                ts_index_Add( &p_sys->seekindex.index, 0, i_scr - i_first_scr, i_pos );
+                vlc_mutex_unlock( &p_sys->seekindex.lock );
+            }
+        }
+    }
+
+    if( s )
+        vlc_stream_Delete( s );
+
+    vlc_interrupt_set( NULL );
+    return NULL;
+}
+
+static void SeekIndexStart( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    bool b_fastseek = false;
+
+    /* Only scan local files */
+    vlc_stream_Control( p_demux->s, STREAM_CAN_FASTSEEK, &b_fastseek );
+    if( !b_fastseek || p_demux->psz_filepath == NULL || p_demux->b_preparsing )
+        return;
+
+    p_sys->seekindex.p_interrupt = vlc_interrupt_create();
+    if( !p_sys->seekindex.p_interrupt )
+        return;
+
+    if( vlc_clone( &p_sys->seekindex.thread, SeekIndexThread, p_demux ) )
+    {
+        vlc_interrupt_destroy( p_sys->seekindex.p_interrupt );
+        return;
+    }
+    p_sys->seekindex.b_scanning = true;
+    msg_Dbg( p_demux, "building seek index in background" );
+}
+
+static void SeekIndexStop( demux_sys_t *p_sys )
+{
+    if( !p_sys->seekindex.b_scanning )
+        return;
+    vlc_interrupt_kill( p_sys->seekindex.p_interrupt );
+    vlc_join( p_sys->seekindex.thread, NULL );
+    vlc_interrupt_destroy( p_sys->seekindex.p_interrupt );
+    p_sys->seekindex.b_scanning = false;
+}
+
 /*****************************************************************************
  * Demux:
  *****************************************************************************/
+static void DemuxPack( demux_t *p_demux, int i_mux_rate, uint64_t i_pkt_pos )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( p_sys->i_first_scr == VLC_TICK_INVALID )
+        p_sys->i_first_scr = p_sys->i_pack_scr;
+    if( p_sys->seekindex.b_enabled )
+        SeekIndexAddPack( p_sys, i_pkt_pos );
+    CheckPCR( p_sys, p_demux->out, p_sys->i_pack_scr );
+    p_sys->i_scr = p_sys->i_pack_scr;
+    p_sys->i_lastpack_byte = vlc_stream_Tell( p_demux->s );
+    if( !p_sys->b_have_pack ) p_sys->b_have_pack = true;
+    /* done later on to work around bad vcd/svcd streams */
+    /* es_out_SetPCR( p_demux->out, p_sys->i_scr ); */
+    if( i_mux_rate > 0 ) p_sys->i_mux_rate = i_mux_rate;
+}
+
 static int Demux( demux_t *p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
@@ -465,6 +676,27 @@ static int Demux( demux_t *p_demux )
             return VLC_DEMUXER_EGENERIC;
     }
 
+    const uint64_t i_pkt_pos = vlc_stream_Tell( p_demux->s );
+
+    /* Most VOB sectors start with a pack header and end with padding, none
+     * of them need a block */
+    vlc_tick_t i_pack_scr;
+    switch( ps_pkt_skip( p_demux->s, false, &i_pack_scr, &i_mux_rate ) )
+    {
+    case -1:
+        return VLC_DEMUXER_EOF;
+    case PS_STREAM_ID_PACK_HEADER:
+        if( i_pack_scr != VLC_TICK_INVALID )
+        {
+            p_sys->i_pack_scr = i_pack_scr;
+            DemuxPack( p_demux, i_mux_rate, i_pkt_pos );
+        }
+        return VLC_DEMUXER_SUCCESS;
+    case PS_STREAM_ID_END_STREAM:
+    case PS_STREAM_ID_PADDING:
+        return VLC_DEMUXER_SUCCESS;
+    }
+
     if( ( p_pkt = ps_pkt_read( p_demux->s ) ) == NULL )
     {
         return VLC_DEMUXER_EOF;
@@ -487,17 +719,7 @@ static int Demux( demux_t *p_demux )
     case PS_STREAM_ID_PACK_HEADER:
         if( !ps_pkt_parse_pack( p_pkt->p_buffer, p_pkt->i_buffer,
                                 &p_sys->i_pack_scr, &i_mux_rate ) )
-        {
-            if( p_sys->i_first_scr == VLC_TICK_INVALID )
-                p_sys->i_first_scr = p_sys->i_pack_scr;
-            CheckPCR( p_sys, p_demux->out, p_sys->i_pack_scr );
-            p_sys->i_scr = p_sys->i_pack_scr;
-            p_sys->i_lastpack_byte = vlc_stream_Tell( p_demux->s );
-            if( !p_sys->b_have_pack ) p_sys->b_have_pack = true;
-            /* done later on to work around bad vcd/svcd streams */
-            /* es_out_SetPCR( p_demux->out, p_sys->i_scr ); */
-            if( i_mux_rate > 0 ) p_sys->i_mux_rate = i_mux_rate;
-        }
+            DemuxPack( p_demux, i_mux_rate, i_pkt_pos );
         block_Release( p_pkt );
         break;
 
@@ -799,10 +1021,13 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
 
         case DEMUX_SET_TIME:
         {
+            vlc_tick_t i_time = va_arg( args, vlc_tick_t );
+            if( SeekByIndex( p_demux, i_time ) == VLC_SUCCESS )
+                return VLC_SUCCESS;
+
             if( p_sys->i_time_track_index >= 0 && p_sys->i_current_pts != VLC_TICK_INVALID &&
                 p_sys->i_length > VLC_TICK_0)
             {
-                vlc_tick_t i_time = va_arg( args, vlc_tick_t );
                 i_time -= p_sys->tk[p_sys->i_time_track_index].i_first_pts;
                 return demux_SetPosition( p_demux, (double) i_time / p_sys->i_length, false );
             }
@@ -957,3 +1182,41 @@ static block_t *ps_pkt_read( stream_t *s )
 
     return NULL;
 }
+
+/* Consumes the next packet without putting it in a block, when the demuxer
+ * would only parse or drop it: pack headers, padding and end codes, and any
+ * packet with a length if b_all is set. Returns its stream id, 0 if it must
+ * be read or -1 on error. The SCR is invalid if the pack header is. */
+static int ps_pkt_skip( stream_t *s, bool b_all,
+                        vlc_tick_t *pi_scr, int *pi_mux_rate )
+{
+    const uint8_t *p_peek;
+    /* the largest pack header, with its stuffing */
+    ssize_t i_peek = vlc_stream_Peek( s, &p_peek, 14 + 7 );
+    if( i_peek < 4 )
+        return -1;
+
+    const int i_id = p_peek[3];
+    int i_size = ps_pkt_size( p_peek, i_peek );
+    switch( i_id )
+    {
+        case PS_STREAM_ID_PACK_HEADER:
+            if( i_size <= 0 || i_size > i_peek )
+                return 0;
+            if( ps_pkt_parse_pack( p_peek, i_size, pi_scr, pi_mux_rate ) )
+                *pi_scr = VLC_TICK_INVALID;
+            break;
+        case PS_STREAM_ID_END_STREAM:
+            break;
+        case PS_STREAM_ID_PADDING:
+            if( i_size <= 6 )
+                return 0;
+            break;
+        default:
+            if( !b_all || i_size <= 6 )
+                return 0;
+            break;
+    }
+
+    return vlc_stream_Read( s, NULL, i_size ) == i_size ? i_id : -1;
+}
@@ -30,6 +30,7 @@
 #endif
 
 #include <vlc_common.h>
+#include <vlc_configuration.h>
 #include <vlc_plugin.h>
 #include <vlc_access.h>    /* DVB-specific things */
 #include <vlc_demux.h>
@@ -39,6 +40,7 @@
 #include "ts_streams.h"
 #include "ts_streams_private.h"
 #include "ts_pes.h"
+#include "ts_sync.h"
 #include "ts_psi.h"
 #include "ts_si.h"
 #include "ts_psip.h"
@@ -114,6 +116,11 @@ static void Close ( vlc_object_t * );
     "Seek and position based on a percent byte position, not a PCR generated " \
     "time position. If seeking doesn't work property, turn on this option." )
 
+#define SEEK_INDEX_TEXT N_("Keep a seek index")
+#define SEEK_INDEX_LONGTEXT N_( \
+    "Save the PCR positions met while playing or seeking a local file, " \
+    "so that later seeks in that file are a single lookup." )
+
 #define CC_CHECK_TEXT       "Check packets continuity counter"
 #define CC_CHECK_LONGTEXT   "Detect discontinuities and drop packet duplicates. " \
                             "(bluRay sources are known broken and have false positives). "
@@ -157,6 +164,7 @@ vlc_module_begin ()
 
     add_bool( "ts-split-es", true, SPLIT_ES_TEXT, SPLIT_ES_LONGTEXT )
     add_bool( "ts-seek-percent", false, SEEK_PERCENT_TEXT, SEEK_PERCENT_LONGTEXT )
+    add_bool( "ts-seek-index", false, SEEK_INDEX_TEXT, SEEK_INDEX_LONGTEXT )
     add_bool( "ts-cc-check", true, CC_CHECK_TEXT, CC_CHECK_LONGTEXT )
     add_bool( "ts-pmtfix-waitdata", true, TS_SKIP_GHOST_PROGRAM_TEXT, NULL )
     add_bool( "ts-patfix", true, TS_PATFIX_TEXT, NULL )
@@ -401,6 +409,7 @@ static int Open( vlc_object_t *p_this )
     p_sys->b_broken_charset = false;
 
     ts_pid_list_Init( &p_sys->pids );
+    ts_index_Init( &p_sys->index );
 
     p_sys->i_packet_size = i_packet_size;
     p_sys->i_packet_header_size = i_packet_header_size;
@@ -537,6 +546,22 @@ static int Open( vlc_object_t *p_this )
     vlc_stream_Control( p_sys->stream, STREAM_CAN_FASTSEEK,
                         &p_sys->b_canfastseek );
 
+    if( p_sys->b_canfastseek && p_demux->psz_filepath != NULL &&
+        !p_demux->b_preparsing && var_InheritBool( p_demux, "ts-seek-index" ) )
+    {
+        char *psz_cachedir = config_GetUserDir( VLC_CACHE_DIR );
+        if( psz_cachedir != NULL )
+        {
+            p_sys->psz_index_file = ts_index_GetCachePath( psz_cachedir,
+                                                           p_demux->psz_filepath );
+            free( psz_cachedir );
+        }
+        if( p_sys->psz_index_file != NULL &&
+            ts_index_Load( &p_sys->index, p_sys->psz_index_file,
+                           p_demux->psz_filepath ) == VLC_SUCCESS )
+            msg_Dbg( p_demux, "loaded seek index of %zu entries", p_sys->index.i_count );
+    }
+
     if( !p_sys->b_access_control && var_CreateGetBool( p_demux, "ts-pmtfix-waitdata" ) )
         p_sys->es_creation = DELAY_ES;
     else
@@ -591,6 +616,13 @@ static void Close( vlc_object_t *p_this )
         p_sys->stream = p_demux->s;
     }
 
+    if( p_sys->psz_index_file != NULL && p_sys->index.b_dirty &&
+        ts_index_Save( &p_sys->index, p_sys->psz_index_file,
+                       p_demux->psz_filepath ) != VLC_SUCCESS )
+        msg_Warn( p_demux, "cannot save seek index to %s", p_sys->psz_index_file );
+    free( p_sys->psz_index_file );
+    ts_index_Clean( &p_sys->index );
+
     /* Release all non default pids */
     ts_pid_list_Release( p_demux, &p_sys->pids );
 
@@ -1802,6 +1834,27 @@ static block_t* ReadTSPacket( demux_t *p_demux )
 
     block_t     *p_pkt;
 
+    /* Check the sync bytes of a whole run of packets at once. Only done
+     * on fast seekable streams, as peeking ahead would add latency to
+     * live ones. */
+    const uint64_t i_pos = vlc_stream_Tell( p_sys->stream );
+    if( p_sys->synced.i_count == 0 || p_sys->synced.i_pos != i_pos )
+    {
+        p_sys->synced.i_count = 0;
+        const uint8_t *p_peek;
+        ssize_t i_peek;
+        if( p_sys->b_canfastseek &&
+            (i_peek = vlc_stream_Peek( p_sys->stream, &p_peek,
+                                       p_sys->i_packet_size * p_sys->i_ts_read )) > 0 )
+        {
+            p_sys->synced.i_count = ts_sync_Count( p_peek, i_peek, p_sys->i_packet_size,
+                                                   p_sys->i_packet_header_size );
+            p_sys->synced.i_pos = i_pos;
+        }
+    }
+
+    const bool b_synced = p_sys->synced.i_count > 0;
+
     /* Get a new TS packet */
     if( !( p_pkt = vlc_stream_Block( p_sys->stream, p_sys->i_packet_size ) ) )
     {
@@ -1826,43 +1879,42 @@ static block_t* ReadTSPacket( demux_t *p_demux )
     p_pkt->p_buffer += p_sys->i_packet_header_size;
     p_pkt->i_buffer -= p_sys->i_packet_header_size;
 
+    if( b_synced && p_pkt->i_buffer + p_sys->i_packet_header_size == p_sys->i_packet_size )
+    {
+        p_sys->synced.i_count--;
+        p_sys->synced.i_pos += p_sys->i_packet_size;
+        return p_pkt;
+    }
+    p_sys->synced.i_count = 0;
+
     /* Check sync byte and re-sync if needed */
-    if( p_pkt->p_buffer[0] != 0x47 )
+    if( p_pkt->p_buffer[0] != TS_SYNC_BYTE )
     {
         msg_Warn( p_demux, "lost synchro" );
         block_Release( p_pkt );
         for( ;; )
         {
             const uint8_t *p_peek;
-            int i_peek = 0;
-            unsigned i_skip = 0;
+            ssize_t i_peek = 0;
+            size_t i_skip = 0;
 
             i_peek = vlc_stream_Peek( p_sys->stream, &p_peek,
                     p_sys->i_packet_size * 10 );
-            if( i_peek < 0 || (unsigned)i_peek < p_sys->i_packet_size + 1 )
+            if( i_peek < 0 || (size_t)i_peek <= p_sys->i_packet_size + p_sys->i_packet_header_size )
             {
                 msg_Dbg( p_demux, "eof ?" );
                 return NULL;
             }
 
-            while( i_skip < i_peek - p_sys->i_packet_size )
-            {
-                if( p_peek[i_skip + p_sys->i_packet_header_size] == 0x47 &&
-                        p_peek[i_skip + p_sys->i_packet_header_size + p_sys->i_packet_size] == 0x47 )
-                {
-                    break;
-                }
-                i_skip++;
-            }
-            msg_Dbg( p_demux, "skipping %d bytes of garbage at %"PRIu64,
+            bool b_found = ts_sync_Find( p_peek, i_peek, p_sys->i_packet_size,
+                                         p_sys->i_packet_header_size, &i_skip );
+            msg_Dbg( p_demux, "skipping %zu bytes of garbage at %"PRIu64,
                      i_skip, vlc_stream_Tell( p_sys->stream ) );
-            if (vlc_stream_Read( p_sys->stream, NULL, i_skip ) != i_skip)
+            if( i_skip > 0 && vlc_stream_Read( p_sys->stream, NULL, i_skip ) != (ssize_t)i_skip )
                 return NULL;
 
-            if( i_skip < i_peek - p_sys->i_packet_size )
-            {
+            if( b_found )
                 break;
-            }
         }
         msg_Dbg( p_demux, "resynced at %" PRIu64, vlc_stream_Tell( p_sys->stream ) );
         if( !( p_pkt = vlc_stream_Block( p_sys->stream, p_sys->i_packet_size ) ) )
@@ -2016,6 +2068,20 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, vlc_tick_t i_see
     if( i_head_pos >= i_tail_pos )
         return VLC_EGENERIC;
 
+    /* Start from the indexed PCR positions surrounding the target */
+    vlc_tick_t i_indexed;
+    uint64_t i_low, i_high;
+    if( p_pmt->pcr.i_first != VLC_TICK_INVALID &&
+        ts_index_Lookup( &p_sys->index, p_pmt->i_number, i_seektime - p_pmt->pcr.i_first,
+                         &i_indexed, &i_low, &i_high ) && i_low < i_tail_pos )
+    {
+        if( i_seektime - p_pmt->pcr.i_first - i_indexed < VLC_TICK_FROM_MS(500) )
+            return vlc_stream_Seek( p_sys->stream, i_low );
+        i_head_pos = i_low;
+        if( i_high < i_tail_pos )
+            i_tail_pos = i_high;
+    }
+
     bool b_found = false;
     while( (i_head_pos + p_sys->i_packet_size) <= i_tail_pos && !b_found )
     {
@@ -2050,7 +2116,13 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, vlc_tick_t i_see
                     if( p_pkt->i_buffer >= 4 + 2 + 5 )
                     {
                         if( p_pmt->i_pid_pcr == i_pid )
+                        {
                             i_pktpcr = GetPCR( p_pkt );
+                            if( i_pktpcr != TS_90KHZ_INVALID && p_pmt->pcr.i_first != VLC_TICK_INVALID )
+                                ts_index_Add( &p_sys->index, p_pmt->i_number,
+                                              TimeStampWrapAround( p_pmt->pcr.i_first, FROM_SCALE(i_pktpcr) )
+                                              - p_pmt->pcr.i_first, i_pos - p_sys->i_packet_size );
+                        }
                         i_skip += 1 + __MIN(p_pkt->p_buffer[4], 182);
                     }
                 }
@@ -2467,6 +2539,13 @@ static void PCRHandle( demux_t *p_demux, ts_pid_t *pid, ts_90khz_t i_pcr )
                 /* We've found a target group for update */
                 PCRCheckDTS( p_demux, p_pmt, FROM_SCALE(i_pcr) );
                 ProgramSetPCR( p_demux, p_pmt, i_program_pcr );
+
+                if( p_sys->b_canfastseek && p_pmt->b_selected &&
+                    p_pmt->pcr.i_first != VLC_TICK_INVALID )
+                    ts_index_Add( &p_sys->index, p_pmt->i_number,
+                                  TimeStampWrapAround( p_pmt->pcr.i_first, FROM_SCALE(i_pcr) )
+                                  - p_pmt->pcr.i_first,
+                                  vlc_stream_Tell( p_sys->stream ) - p_sys->i_packet_size );
             }
         }
 
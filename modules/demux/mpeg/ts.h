@@ -22,6 +22,8 @@
 
 #include <vlc_arrays.h>
 
+#include "ts_index.h"
+
 #ifdef HAVE_ARIBB24
     typedef struct arib_instance_t arib_instance_t;
 #endif
@@ -66,6 +68,17 @@ struct demux_sys_t
     /* how many TS packet we read at once */
     unsigned    i_ts_read;
 
+    /* PCR positions for seeking, and its sidecar file if persisted */
+    ts_index_t  index;
+    char       *psz_index_file;
+
+    /* packets ahead of i_pos already checked for sync */
+    struct
+    {
+        uint64_t i_pos;
+        size_t   i_count;
+    } synced;
+
     bool        b_cc_check;
     bool        b_ignore_time_for_positions;
 
@@ -0,0 +1,255 @@
+/*****************************************************************************
+ * ts_index.c: MPEG TS seek index
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_fs.h>
+#include <vlc_hash.h>
+#include <vlc_strings.h>
+#include <vlc_threads.h>
+
+#include "ts_index.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define TS_INDEX_MAGIC   "VLCTSIX1"
+#define TS_INDEX_MAX     (1 << 22)
+
+void ts_index_Init( ts_index_t *p_index )
+{
+    p_index->i_program = -1;
+    p_index->b_dirty = false;
+    p_index->i_count = 0;
+    p_index->i_alloc = 0;
+    p_index->p_entries = NULL;
+}
+
+void ts_index_Clean( ts_index_t *p_index )
+{
+    free( p_index->p_entries );
+    ts_index_Init( p_index );
+}
+
+/* first entry with position greater or equal to i_pos */
+static size_t ts_index_FindPos( const ts_index_t *p_index, uint64_t i_pos )
+{
+    size_t i_low = 0, i_high = p_index->i_count;
+    while( i_low < i_high )
+    {
+        size_t i_mid = (i_low + i_high) / 2;
+        if( p_index->p_entries[i_mid].i_pos < i_pos )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+    return i_low;
+}
+
+void ts_index_Add( ts_index_t *p_index, int i_program, vlc_tick_t i_time, uint64_t i_pos )
+{
+    if( p_index->i_program == -1 )
+        p_index->i_program = i_program;
+    else if( p_index->i_program != i_program )
+        return;
+
+    if( i_time < 0 || p_index->i_count >= TS_INDEX_MAX )
+        return;
+
+    size_t i = ts_index_FindPos( p_index, i_pos );
+    if( i < p_index->i_count && p_index->p_entries[i].i_pos == i_pos )
+        return;
+
+    /* keep both time and position increasing, and entries spaced */
+    if( i > 0 && p_index->p_entries[i - 1].i_time + TS_INDEX_INTERVAL > i_time )
+        return;
+    if( i < p_index->i_count && p_index->p_entries[i].i_time < i_time + TS_INDEX_INTERVAL )
+        return;
+
+    if( p_index->i_count == p_index->i_alloc )
+    {
+        size_t i_alloc = p_index->i_alloc ? p_index->i_alloc * 2 : 256;
+        ts_index_entry_t *p_realloc = realloc( p_index->p_entries,
+                                               i_alloc * sizeof(*p_realloc) );
+        if( !p_realloc )
+            return;
+        p_index->p_entries = p_realloc;
+        p_index->i_alloc = i_alloc;
+    }
+
+    memmove( &p_index->p_entries[i + 1], &p_index->p_entries[i],
+             (p_index->i_count - i) * sizeof(*p_index->p_entries) );
+    p_index->p_entries[i].i_time = i_time;
+    p_index->p_entries[i].i_pos = i_pos;
+    p_index->i_count++;
+    p_index->b_dirty = true;
+}
+
+bool ts_index_Lookup( const ts_index_t *p_index, int i_program, vlc_tick_t i_time,
+                      vlc_tick_t *pi_found, uint64_t *pi_low, uint64_t *pi_high )
+{
+    if( p_index->i_program != i_program || p_index->i_count == 0 ||
+        p_index->p_entries[0].i_time > i_time )
+        return false;
+
+    /* last entry with time lower or equal to i_time */
+    size_t i_low = 0, i_high = p_index->i_count;
+    while( i_high - i_low > 1 )
+    {
+        size_t i_mid = (i_low + i_high) / 2;
+        if( p_index->p_entries[i_mid].i_time <= i_time )
+            i_low = i_mid;
+        else
+            i_high = i_mid;
+    }
+
+    *pi_found = p_index->p_entries[i_low].i_time;
+    *pi_low = p_index->p_entries[i_low].i_pos;
+    *pi_high = (i_high < p_index->i_count) ? p_index->p_entries[i_high].i_pos
+                                           : UINT64_MAX;
+    return true;
+}
+
+char * ts_index_GetCachePath( const char *psz_cachedir, const char *psz_source )
+{
+    char psz_hash[VLC_HASH_MD5_DIGEST_HEX_SIZE];
+    vlc_hash_md5_t md5;
+
+    vlc_hash_md5_Init( &md5 );
+    vlc_hash_md5_Update( &md5, psz_source, strlen( psz_source ) );
+    vlc_hash_FinishHex( &md5, psz_hash );
+
+    char *psz_path;
+    if( asprintf( &psz_path, "%s" DIR_SEP "tsindex" DIR_SEP "%s",
+                  psz_cachedir, psz_hash ) == -1 )
+        return NULL;
+    return psz_path;
+}
+
+struct ts_index_header
+{
+    char     magic[8];
+    uint64_t i_size;
+    int64_t  i_mtime;
+    int32_t  i_program;
+    uint32_t i_count;
+};
+
+static int ts_index_MakeHeader( struct ts_index_header *p_hdr, const char *psz_source )
+{
+    struct stat st;
+    if( vlc_stat( psz_source, &st ) || !S_ISREG( st.st_mode ) )
+        return VLC_EGENERIC;
+
+    memset( p_hdr, 0, sizeof(*p_hdr) );
+    memcpy( p_hdr->magic, TS_INDEX_MAGIC, sizeof(p_hdr->magic) );
+    p_hdr->i_size = st.st_size;
+    p_hdr->i_mtime = st.st_mtime;
+    return VLC_SUCCESS;
+}
+
+int ts_index_Load( ts_index_t *p_index, const char *psz_file, const char *psz_source )
+{
+    struct ts_index_header ref, hdr;
+    if( ts_index_MakeHeader( &ref, psz_source ) )
+        return VLC_EGENERIC;
+
+    FILE *file = vlc_fopen( psz_file, "rb" );
+    if( file == NULL )
+        return VLC_EGENERIC;
+
+    ts_index_entry_t *p_entries = NULL;
+    if( fread( &hdr, sizeof(hdr), 1, file ) != 1 ||
+        memcmp( hdr.magic, ref.magic, sizeof(hdr.magic) ) ||
+        hdr.i_size != ref.i_size || hdr.i_mtime != ref.i_mtime ||
+        hdr.i_count == 0 || hdr.i_count > TS_INDEX_MAX )
+        goto error;
+
+    p_entries = vlc_alloc( hdr.i_count, sizeof(*p_entries) );
+    if( !p_entries ||
+        fread( p_entries, sizeof(*p_entries), hdr.i_count, file ) != hdr.i_count )
+        goto error;
+    fclose( file );
+
+    for( size_t i = 1; i < hdr.i_count; i++ )
+    {
+        if( p_entries[i].i_pos <= p_entries[i - 1].i_pos ||
+            p_entries[i].i_time <= p_entries[i - 1].i_time )
+        {
+            free( p_entries );
+            return VLC_EGENERIC;
+        }
+    }
+
+    free( p_index->p_entries );
+    p_index->i_program = hdr.i_program;
+    p_index->p_entries = p_entries;
+    p_index->i_count = p_index->i_alloc = hdr.i_count;
+    p_index->b_dirty = false;
+    return VLC_SUCCESS;
+
+error:
+    free( p_entries );
+    fclose( file );
+    return VLC_EGENERIC;
+}
+
+int ts_index_Save( const ts_index_t *p_index, const char *psz_file, const char *psz_source )
+{
+    struct ts_index_header hdr;
+    if( p_index->i_count == 0 || ts_index_MakeHeader( &hdr, psz_source ) )
+        return VLC_EGENERIC;
+    hdr.i_program = p_index->i_program;
+    hdr.i_count = p_index->i_count;
+
+    char *psz_dir = strdup( psz_file );
+    if( !psz_dir )
+        return VLC_ENOMEM;
+    char *psz_sep = strrchr( psz_dir, DIR_SEP_CHAR );
+    if( psz_sep )
+    {
+        *psz_sep = '\0';
+        vlc_mkdir_parent( psz_dir, 0700 );
+    }
+    free( psz_dir );
+
+    char *psz_tmp;
+    if( asprintf( &psz_tmp, "%s.%lu", psz_file, vlc_thread_id() ) == -1 )
+        return VLC_ENOMEM;
+
+    int i_ret = VLC_EGENERIC;
+    FILE *file = vlc_fopen( psz_tmp, "wb" );
+    if( file )
+    {
+        bool b_ok = fwrite( &hdr, sizeof(hdr), 1, file ) == 1 &&
+                    fwrite( p_index->p_entries, sizeof(*p_index->p_entries),
+                            p_index->i_count, file ) == p_index->i_count;
+        if( fclose( file ) == 0 && b_ok && vlc_rename( psz_tmp, psz_file ) == 0 )
+            i_ret = VLC_SUCCESS;
+        else
+            vlc_unlink( psz_tmp );
+    }
+    free( psz_tmp );
+    return i_ret;
+}
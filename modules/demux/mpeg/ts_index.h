@@ -0,0 +1,62 @@
+/*****************************************************************************
+ * ts_index.h: MPEG TS seek index
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_TS_INDEX_H
+#define VLC_TS_INDEX_H
+
+#include <vlc_tick.h>
+
+/* minimum time between two index entries */
+#define TS_INDEX_INTERVAL VLC_TICK_FROM_SEC(1)
+
+typedef struct
+{
+    vlc_tick_t i_time; /* relative to the program first PCR */
+    uint64_t   i_pos;  /* byte offset of the packet carrying the PCR */
+} ts_index_entry_t;
+
+typedef struct
+{
+    int     i_program;
+    bool    b_dirty;
+    size_t  i_count;
+    size_t  i_alloc;
+    ts_index_entry_t *p_entries;
+} ts_index_t;
+
+void ts_index_Init( ts_index_t * );
+void ts_index_Clean( ts_index_t * );
+
+/* Records a PCR position. Only the first program seen is indexed, and
+ * entries not matching the time ordering of their neighbours are dropped. */
+void ts_index_Add( ts_index_t *, int i_program, vlc_tick_t i_time, uint64_t i_pos );
+
+/* Finds the closest entry at or before i_time. *pi_low is its position and
+ * *pi_high the position of the next entry, or UINT64_MAX. Returns false if
+ * there is none for that program. */
+bool ts_index_Lookup( const ts_index_t *, int i_program, vlc_tick_t i_time,
+                      vlc_tick_t *pi_found, uint64_t *pi_low, uint64_t *pi_high );
+
+/* Sidecar persistence, invalidated when the source file size or
+ * modification time changes */
+char * ts_index_GetCachePath( const char *psz_cachedir, const char *psz_source );
+int ts_index_Load( ts_index_t *, const char *psz_file, const char *psz_source );
+int ts_index_Save( const ts_index_t *, const char *psz_file, const char *psz_source );
+
+#endif
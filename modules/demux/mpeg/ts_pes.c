@@ -32,43 +32,6 @@
 
 #include <assert.h>
 
-/* Avoids largest memcpy */
-static bool block_Split( block_t **pp_block, block_t **pp_remain, size_t i_offset )
-{
-    block_t *p_block = *pp_block;
-    block_t *p_split = NULL;
-    *pp_remain = NULL;
-
-    size_t i_tocopy = p_block->i_buffer - i_offset;
-    if( i_tocopy > i_offset ) /* make new block for head */
-    {
-        if( i_offset > 0 )
-        {
-            p_split = block_Alloc( i_offset );
-            if( p_split == NULL )
-                return false;
-            memcpy( p_split->p_buffer, p_block->p_buffer, i_offset );
-            p_block->p_buffer += i_offset;
-            p_block->i_buffer -= i_offset;
-        }
-        *pp_remain = p_block;
-        *pp_block = p_split;
-    }
-    else /* other gets the tail of our split */
-    {
-        if( i_tocopy > 0 )
-        {
-            p_split = block_Alloc( i_tocopy );
-            if( p_split == NULL )
-                return false;
-            memcpy( p_split->p_buffer, &p_block->p_buffer[i_offset], i_tocopy );
-            p_block->i_buffer -= i_tocopy;
-        }
-        *pp_remain = p_split;
-    }
-    return true;
-}
-
 static const uint8_t pes_sync[] = { 0, 0, 1 };
 
 static bool MayHaveStartCodeOnEnd( const uint8_t *p_buf, size_t i_buf )
@@ -307,10 +270,12 @@ bool ts_pes_Gather( ts_pes_parse_callback *cb,
                 }
                 else /* p_pkt->i_buffer > i_remain */
                 {
-                    block_t *p_split;
-                    if( !block_Split( &p_pkt, &p_split, i_remain ) )
+                    /* Both parts share the packet buffer, nothing is copied */
+                    block_t *p_split = p_pkt;
+                    p_pkt = block_Split( &p_split, i_remain );
+                    if( !p_pkt )
                     {
-                        block_Release( p_pkt );
+                        block_Release( p_split );
                         return false;
                     }
                     p_pes->gather.i_block_flags |= BLOCK_FLAG_CORRUPTED;
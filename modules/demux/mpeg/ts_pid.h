@@ -95,10 +95,8 @@ struct ts_pid_list_t
     ts_pid_t **pp_all;
     int        i_all;
     int        i_all_alloc;
-    /* last recently used */
-    uint16_t   i_last_pid;
-    ts_pid_t  *p_last;
-
+    /* direct lookup by pid, NULL when not yet created */
+    ts_pid_t  *p_index[8192];
 };
 
 /* opacified pid list */
@@ -0,0 +1,92 @@
+/*****************************************************************************
+ * ts_sync.c: MPEG TS packet synchronization
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+
+#include "ts_sync.h"
+
+#include <string.h>
+
+#define TS_SYNC_BATCH 8
+
+size_t ts_sync_Count( const uint8_t *p_buf, size_t i_buf,
+                      unsigned i_packet_size, unsigned i_header_size )
+{
+    const size_t i_max = i_buf / i_packet_size;
+    const uint8_t *p = &p_buf[i_header_size];
+    size_t i_count = 0;
+
+    /* Check whole batches without branching on each packet, so that
+     * the compiler can vectorize the strided loads */
+    while( i_count + TS_SYNC_BATCH <= i_max )
+    {
+        unsigned i_bad = 0;
+        for( unsigned i = 0; i < TS_SYNC_BATCH; i++ )
+            i_bad |= p[i * i_packet_size] ^ TS_SYNC_BYTE;
+        if( i_bad )
+            break;
+        p += TS_SYNC_BATCH * i_packet_size;
+        i_count += TS_SYNC_BATCH;
+    }
+
+    while( i_count < i_max && *p == TS_SYNC_BYTE )
+    {
+        p += i_packet_size;
+        i_count++;
+    }
+
+    return i_count;
+}
+
+bool ts_sync_Find( const uint8_t *p_buf, size_t i_buf,
+                   unsigned i_packet_size, unsigned i_header_size,
+                   size_t *pi_skip )
+{
+    if( i_buf <= i_header_size + i_packet_size )
+    {
+        *pi_skip = 0;
+        return false;
+    }
+
+    /* last offset for which the next packet sync byte is in the buffer */
+    const size_t i_end = i_buf - i_header_size - i_packet_size;
+    const uint8_t *p = &p_buf[i_header_size];
+    size_t i_skip = 0;
+
+    while( i_skip < i_end )
+    {
+        const uint8_t *p_sync = memchr( &p[i_skip], TS_SYNC_BYTE, i_end - i_skip );
+        if( p_sync == NULL )
+            break;
+        i_skip = p_sync - p;
+        if( p[i_skip + i_packet_size] == TS_SYNC_BYTE )
+        {
+            *pi_skip = i_skip;
+            return true;
+        }
+        i_skip++;
+    }
+
+    *pi_skip = i_end;
+    return false;
+}
@@ -0,0 +1,37 @@
+/*****************************************************************************
+ * ts_sync.h: MPEG TS packet synchronization
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_TS_SYNC_H
+#define VLC_TS_SYNC_H
+
+#define TS_SYNC_BYTE 0x47
+
+/* Counts the packets at the start of the buffer carrying a sync byte,
+ * stopping at the first one that doesn't or at the last whole packet. */
+size_t ts_sync_Count( const uint8_t *p_buf, size_t i_buf,
+                      unsigned i_packet_size, unsigned i_header_size );
+
+/* Looks for the first offset where a sync byte is followed by another one
+ * a packet later. Sets *pi_skip to that offset and returns true, or to the
+ * number of bytes that can be dropped and returns false when none is found. */
+bool ts_sync_Find( const uint8_t *p_buf, size_t i_buf,
+                   unsigned i_packet_size, unsigned i_header_size,
+                   size_t *pi_skip );
+
+#endif
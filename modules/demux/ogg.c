@@ -2306,6 +2306,8 @@ static int Ogg_BeginningOfStream( demux_t *p_demux )
 
         /* initialise kframe index */
         p_stream->idx=NULL;
+        p_stream->pagecache=NULL;
+        p_stream->i_pagecache=0;
 
         if ( p_stream->fmt.i_bitrate == 0  &&
              ( p_stream->fmt.i_cat == VIDEO_ES ||
@@ -2415,6 +2417,7 @@ static void Ogg_LogicalStreamDelete( demux_t *p_demux, logical_stream_t *p_strea
     {
         oggseek_index_entries_free( p_stream->idx );
     }
+    oggseek_index_entries_free( p_stream->pagecache );
 
     Ogg_FreeSkeleton( p_stream->p_skel );
     p_stream->p_skel = NULL;
@@ -102,6 +102,11 @@ typedef struct logical_stream_s
     /* keyframe index for seeking, created as we discover keyframes */
     demux_index_entry_t *idx;
 
+    /* granule times of the pages met while seeking or probing the length,
+     * to narrow down subsequent searches */
+    demux_index_entry_t *pagecache;
+    unsigned i_pagecache;
+
     /* Skeleton data */
     ogg_skeleton_t *p_skel;
 
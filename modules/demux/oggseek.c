@@ -95,11 +95,10 @@ static demux_index_entry_t *index_entry_new( vlc_tick_t i_timestamp, int64_t i_p
 
 /* We insert into index, sorting by pagepos (as a page can match multiple
    time stamps) */
-const demux_index_entry_t *OggSeek_IndexAdd ( logical_stream_t *p_stream,
-                                             vlc_tick_t i_timestamp,
-                                             int64_t i_pagepos )
+static demux_index_entry_t *index_insert( demux_index_entry_t **pp_next,
+                                          vlc_tick_t i_timestamp,
+                                          int64_t i_pagepos )
 {
-    demux_index_entry_t **pp_next = &p_stream->idx;
     for( ; *pp_next; )
     {
         if( (*pp_next)->i_pagepos >= i_pagepos )
@@ -121,6 +120,24 @@ const demux_index_entry_t *OggSeek_IndexAdd ( logical_stream_t *p_stream,
     return ie;
 }
 
+const demux_index_entry_t *OggSeek_IndexAdd ( logical_stream_t *p_stream,
+                                             vlc_tick_t i_timestamp,
+                                             int64_t i_pagepos )
+{
+    return index_insert( &p_stream->idx, i_timestamp, i_pagepos );
+}
+
+/* Remember where a page of the stream ends at a given time, these are
+   not keyframe positions and only bound the searches */
+static void OggSeekCacheAdd( logical_stream_t *p_stream,
+                             vlc_tick_t i_timestamp, int64_t i_pagepos )
+{
+    if ( p_stream->i_pagecache >= OGGSEEK_PAGECACHE_MAX )
+        return;
+    if ( index_insert( &p_stream->pagecache, i_timestamp, i_pagepos ) )
+        p_stream->i_pagecache++;
+}
+
 static bool OggSeekIndexFind ( logical_stream_t *p_stream, vlc_tick_t i_timestamp,
                                int64_t *pi_pos_lower, int64_t *pi_pos_upper,
                                vlc_tick_t *pi_lower_timestamp )
@@ -270,6 +287,10 @@ void Oggseek_ProbeEnd( demux_t *p_demux )
                     {
                         /* We found at least a page with valid granule */
                         p_sys->i_length = __MAX( p_sys->i_length, i_length - VLC_TICK_0 );
+                        /* and the upper bound of any later search */
+                        OggSeekCacheAdd( p_sys->pp_stream[i], i_length,
+                                         i_pos - oy.fill + oy.returned
+                                         - page.header_len - page.body_len );
                     }
                     break;
                 }
@@ -627,6 +648,103 @@ restart:
     return i_result;
 }
 
+/* Probes the first page from i_pos, and caches it */
+static vlc_tick_t OggSeekProbe( demux_t *p_demux, logical_stream_t *p_stream,
+                                int64_t i_pos, int64_t i_pos_upper,
+                                int64_t *pi_pagepos )
+{
+    int64_t i_granule;
+
+    *pi_pagepos = find_first_page_granule( p_demux, i_pos, i_pos_upper,
+                                           p_stream, &i_granule );
+    if ( *pi_pagepos < 0 || i_granule <= 0 )
+        return VLC_TICK_INVALID;
+
+    vlc_tick_t i_time = Ogg_GranuleToTime( p_stream, i_granule,
+                                           !p_stream->b_contiguous, false );
+    if ( i_time != VLC_TICK_INVALID )
+        OggSeekCacheAdd( p_stream, i_time, *pi_pagepos );
+    return i_time;
+}
+
+/* Narrows the bisection bounds down using the cached pages, then by
+   guessing the position from the times at both ends */
+static void OggSeekNarrow( demux_t *p_demux, logical_stream_t *p_stream,
+                           vlc_tick_t i_targettime,
+                           int64_t *pi_pos_lower, int64_t *pi_pos_upper )
+{
+    int64_t i_lower = *pi_pos_lower, i_upper = *pi_pos_upper;
+    vlc_tick_t i_lower_time = VLC_TICK_INVALID, i_upper_time = VLC_TICK_INVALID;
+
+    for ( const demux_index_entry_t *idx = p_stream->pagecache;
+          idx != NULL; idx = idx->p_next )
+    {
+        if ( idx->i_pagepos < *pi_pos_lower || idx->i_pagepos >= *pi_pos_upper )
+            continue;
+        if ( idx->i_value <= i_targettime )
+        {
+            if ( i_upper_time != VLC_TICK_INVALID )
+                return; /* times are not monotonic, do not trust them */
+            i_lower = idx->i_pagepos;
+            i_lower_time = idx->i_value;
+        }
+        else if ( i_upper_time == VLC_TICK_INVALID )
+        {
+            i_upper = idx->i_pagepos;
+            i_upper_time = idx->i_value;
+        }
+    }
+
+    if ( i_lower_time == VLC_TICK_INVALID )
+    {
+        /* the first page is cached for the next searches */
+        int64_t i_pagepos;
+        vlc_tick_t i_time = OggSeekProbe( p_demux, p_stream, i_lower, i_upper,
+                                          &i_pagepos );
+        if ( i_time == VLC_TICK_INVALID || i_time > i_targettime )
+            return;
+        i_lower = i_pagepos;
+        i_lower_time = i_time;
+    }
+
+    *pi_pos_lower = i_lower;
+    if ( i_upper_time == VLC_TICK_INVALID )
+        return;
+    *pi_pos_upper = i_upper;
+
+    /* Probe both sides of the interpolated position: when the bitrate is
+       steady, the target is left with a small fraction of the range */
+    int64_t i_margin = __MAX( ( i_upper - i_lower ) / 32, OGGSEEK_BYTES_TO_READ );
+    if ( i_upper - i_lower <= 4 * i_margin || i_upper_time <= i_lower_time )
+        return;
+
+    double f = (double)( i_targettime - i_lower_time ) / ( i_upper_time - i_lower_time );
+    int64_t i_guess = i_lower + f * ( i_upper - i_lower );
+    int64_t i_probes[2] = { i_guess - i_margin, i_guess + i_margin };
+
+    for ( size_t i = 0; i < ARRAY_SIZE(i_probes); i++ )
+    {
+        int64_t i_pagepos;
+        if ( i_probes[i] <= i_lower || i_probes[i] >= i_upper )
+            continue;
+
+        vlc_tick_t i_time = OggSeekProbe( p_demux, p_stream, i_probes[i], i_upper,
+                                          &i_pagepos );
+        if ( i_time == VLC_TICK_INVALID || i_pagepos >= i_upper )
+            break;
+        if ( i_time <= i_targettime )
+            i_lower = i_pagepos;
+        else
+        {
+            i_upper = i_pagepos;
+            break;
+        }
+    }
+
+    *pi_pos_lower = i_lower;
+    *pi_pos_upper = i_upper;
+}
+
 /* returns pos */
 static int64_t OggBisectSearchByTime( demux_t *p_demux, logical_stream_t *p_stream,
             vlc_tick_t i_targettime, int64_t i_pos_lower, int64_t i_pos_upper, int64_t *pi_seek_time)
@@ -650,6 +768,8 @@ static int64_t OggBisectSearchByTime( demux_t *p_demux, logical_stream_t *p_stre
     i_pos_upper = __MIN( i_pos_upper, p_sys->i_total_bytes );
     if ( i_pos_upper < 0 ) i_pos_upper = p_sys->i_total_bytes;
 
+    OggSeekNarrow( p_demux, p_stream, i_targettime, &i_pos_lower, &i_pos_upper );
+
     i_start_pos = i_pos_lower;
     i_end_pos = i_pos_upper;
 
@@ -669,6 +789,8 @@ static int64_t OggBisectSearchByTime( demux_t *p_demux, logical_stream_t *p_stre
     {
         current.i_timestamp = Ogg_GranuleToTime( p_stream, current.i_granule,
                                                  !p_stream->b_contiguous, false );
+        if( current.i_timestamp != VLC_TICK_INVALID && current.i_granule > 0 )
+            OggSeekCacheAdd( p_stream, current.i_timestamp, current.i_pos );
         if( current.i_timestamp <= i_targettime )
             bestlower = current;
         else
@@ -712,6 +834,8 @@ static int64_t OggBisectSearchByTime( demux_t *p_demux, logical_stream_t *p_stre
         if ( current.i_pos != -1 && current.i_granule != -1 )
         {
             /* found a page */
+            if ( current.i_granule > 0 )
+                OggSeekCacheAdd( p_stream, current.i_timestamp, current.i_pos );
 
             if ( current.i_timestamp <= i_targettime )
             {
@@ -39,6 +39,7 @@
 
 #define OGGSEEK_BYTES_TO_READ 8500
 #define OGGSEEK_SERIALNO_MAX_LOOKUP_BYTES (OGGSEEK_BYTES_TO_READ * 25)
+#define OGGSEEK_PAGECACHE_MAX 4096
 
 /* this is typedefed to demux_index_entry_t in ogg.h */
 struct oggseek_index_entry
@@ -37,6 +37,9 @@
 
 #include "playlist.h"
 
+/* Entries added to the node at once */
+#define M3U_BATCH_SIZE 256
+
 /*****************************************************************************
  * Local prototypes
  *****************************************************************************/
@@ -220,16 +223,21 @@ static void entry_meta_Clean( struct entry_meta_s *e )
 
 static void parseEXTINF( char *, char *(*)(const char *), struct entry_meta_s * );
 
-static int CreateEntry( input_item_node_t *p_node, const struct entry_meta_s *meta )
+/* The group, shared by the following entries, is not duplicated for each */
+static input_item_t *CreateEntry( const struct entry_meta_s *meta,
+                                  const char *psz_group )
 {
     if( !meta->psz_mrl )
-        return VLC_EGENERIC;
+        return NULL;
 
     input_item_t *p_input =
         input_item_NewExt( meta->psz_mrl, meta->psz_name, meta->i_duration,
                            ITEM_TYPE_UNKNOWN, ITEM_NET_UNKNOWN );
     if( !p_input )
-        return VLC_EGENERIC;
+        return NULL;
+
+    const char *psz_grouptitle = meta->psz_grouptitle ? meta->psz_grouptitle
+                                                      : psz_group;
 
     input_item_AddOptions( p_input, meta->i_options, meta->ppsz_options, 0 );
 
@@ -242,16 +250,22 @@ static int CreateEntry( input_item_node_t *p_node, const struct entry_meta_s *me
         vlc_meta_SetWithPriority( p_input->p_meta, vlc_meta_ArtworkURL, meta->psz_album_art, meta->priority );
     if( meta->psz_language )
         vlc_meta_SetWithPriority( p_input->p_meta, vlc_meta_Language, meta->psz_language, meta->priority );
-    if( meta->psz_grouptitle )
-        vlc_meta_SetWithPriority( p_input->p_meta, vlc_meta_Publisher, meta->psz_grouptitle, meta->priority );
+    if( psz_grouptitle )
+        vlc_meta_SetWithPriority( p_input->p_meta, vlc_meta_Publisher, psz_grouptitle, meta->priority );
     vlc_mutex_unlock( &p_input->lock );
     if( meta->psz_tvgid )
         input_item_AddInfo( p_input, "XMLTV", "tvg-id", "%s", meta->psz_tvgid );
 
-    input_item_node_AppendItem( p_node, p_input );
-    input_item_Release( p_input );
+    return p_input;
+}
 
-    return VLC_SUCCESS;
+static void FlushEntries( input_item_node_t *p_node,
+                          input_item_t **pp_batch, size_t *pi_batch )
+{
+    input_item_node_AppendItems( p_node, pp_batch, *pi_batch );
+    for( size_t i = 0; i < *pi_batch; i++ )
+        input_item_Release( pp_batch[i] );
+    *pi_batch = 0;
 }
 
 static int ReadDir( stream_t *p_demux, input_item_node_t *p_subitems )
@@ -261,6 +275,8 @@ static int ReadDir( stream_t *p_demux, input_item_node_t *p_subitems )
     struct entry_meta_s meta;
     entry_meta_Init( &meta );
     char *    (*pf_dup) (const char *) = p_demux->p_sys;
+    input_item_t *batch[M3U_BATCH_SIZE];
+    size_t i_batch = 0;
 
     psz_line = vlc_stream_ReadLine( p_demux->s );
     while( psz_line )
@@ -340,13 +356,17 @@ static int ReadDir( stream_t *p_demux, input_item_node_t *p_subitems )
             if( !meta.psz_name && psz_parse )
                 /* Use filename as name for relative entries */
                 meta.psz_name = strdup( psz_parse );
-            if( psz_group && !meta.psz_grouptitle )
-                meta.psz_grouptitle = strdup( psz_group );
 
             meta.psz_mrl = ProcessMRL( psz_parse, p_demux->psz_url );
             free( psz_parse );
 
-            CreateEntry( p_subitems, &meta );
+            input_item_t *p_input = CreateEntry( &meta, psz_group );
+            if( p_input )
+            {
+                batch[i_batch++] = p_input;
+                if( i_batch == ARRAY_SIZE(batch) )
+                    FlushEntries( p_subitems, batch, &i_batch );
+            }
 
             /* Cleanup state after entry */
             entry_meta_Clean( &meta );
@@ -365,6 +385,7 @@ static int ReadDir( stream_t *p_demux, input_item_node_t *p_subitems )
             free( psz_group );
         }
     }
+    FlushEntries( p_subitems, batch, &i_batch );
     return VLC_SUCCESS; /* Needed for correct operation of go back */
 }
 
@@ -76,6 +76,7 @@ typedef struct
 {
     input_item_t **pp_tracklist;
     int i_tracklist_entries;
+    int i_tracklist_size; /* allocated entries */
     int i_track_id;
     char * psz_base;
 } xspf_sys_t;
@@ -129,6 +130,7 @@ static int ReadDir(stream_t *p_stream, input_item_node_t *p_subitems)
 
     sys->pp_tracklist = NULL;
     sys->i_tracklist_entries = 0;
+    sys->i_tracklist_size = 0;
     sys->i_track_id = -1;
     sys->psz_base = strdup(p_stream->psz_url);
 
@@ -157,14 +159,14 @@ static int ReadDir(stream_t *p_stream, input_item_node_t *p_subitems)
     i_ret = parse_playlist_node(p_stream, p_subitems,
                                  p_xml_reader, "playlist", false ) ? 0 : -1;
 
+    /* Add the tracks not referenced by a <vlc:item> all at once, in the
+     * order of their IDs */
+    int i_count = 0;
     for (int i = 0 ; i < sys->i_tracklist_entries ; i++)
-    {
-        input_item_t *p_new_input = sys->pp_tracklist[i];
-        if (p_new_input)
-        {
-            input_item_node_AppendItem(p_subitems, p_new_input);
-        }
-    }
+        if (sys->pp_tracklist[i])
+            sys->pp_tracklist[i_count++] = sys->pp_tracklist[i];
+    sys->i_tracklist_entries = i_count;
+    input_item_node_AppendItems(p_subitems, sys->pp_tracklist, i_count);
 
 end:
     if (p_xml_reader)
@@ -459,18 +461,25 @@ static bool parse_track_node COMPLEX_INTERFACE
         else
         {
             /* Extend array as needed */
-            if (p_sys->i_track_id >= p_sys->i_tracklist_entries)
-            {
+            if (p_sys->i_track_id >= p_sys->i_tracklist_size)
+            {   /* Grow geometrically, the IDs are mostly consecutive */
+                int i_size = p_sys->i_tracklist_size < INT_MAX / 2
+                           ? 2 * p_sys->i_tracklist_size : INT_MAX;
+                if (i_size <= p_sys->i_track_id)
+                    i_size = p_sys->i_track_id + 1;
+
                 input_item_t **pp;
-                pp = realloc(p_sys->pp_tracklist,
-                             (p_sys->i_track_id + 1) * sizeof(*pp));
+                pp = vlc_reallocarray(p_sys->pp_tracklist, i_size,
+                                      sizeof(*pp));
                 if (pp)
                 {
                     p_sys->pp_tracklist = pp;
-                    while (p_sys->i_track_id >= p_sys->i_tracklist_entries)
-                        pp[p_sys->i_tracklist_entries++] = NULL;
+                    p_sys->i_tracklist_size = i_size;
                 }
             }
+            while (p_sys->i_track_id >= p_sys->i_tracklist_entries
+                && p_sys->i_tracklist_entries < p_sys->i_tracklist_size)
+                p_sys->pp_tracklist[p_sys->i_tracklist_entries++] = NULL;
 
             if (p_sys->i_track_id < p_sys->i_tracklist_entries)
             {
@@ -42,6 +42,7 @@
 
 #include <vlc_demux.h>
 #include <vlc_charset.h>
+#include <vlc_interrupt.h>
 
 /*****************************************************************************
  * Module descriptor
@@ -111,9 +112,19 @@ typedef struct
     size_t  i_line_count;
     size_t  i_line;
     char    **line;
+
+    /* read line by line from this stream instead, if set */
+    stream_t *s;
+    char    *psz_line;
 } text_t;
 
+/* Larger SubRip files are not loaded at once */
+#define SUB_LAZY_MIN_SIZE (32 << 20)
+/* Cues between two entries of the seek index */
+#define SUB_INDEX_INTERVAL 64
+
 static int  TextLoad( text_t *, stream_t *s );
+static void TextOpenStream( text_t *, stream_t *s );
 static void TextUnload( text_t * );
 
 typedef struct
@@ -174,6 +185,32 @@ typedef struct
 
     vlc_tick_t  i_length;
 
+    /* Large files are parsed as they are played, while a background thread
+     * indexes where the cues start */
+    struct
+    {
+        bool b_enabled;
+        bool b_pending; /* next holds a parsed cue */
+        bool b_eof;
+        subtitle_t next;
+        text_t txt;
+        uint64_t i_start_pos;
+        int (*pf_read)( vlc_object_t *, subs_properties_t *, text_t *, subtitle_t *, size_t );
+
+        vlc_mutex_t lock;
+        struct
+        {
+            vlc_tick_t i_start;
+            uint64_t   i_pos;
+        } *p_index;
+        size_t i_index;
+        vlc_tick_t i_length;
+
+        bool b_scanning;
+        vlc_thread_t thread;
+        vlc_interrupt_t *p_interrupt;
+    } lazy;
+
     /* */
     subs_properties_t props;
 
@@ -237,6 +274,9 @@ static int Demux( demux_t * );
 static int Control( demux_t *, int, va_list );
 
 static void Fix( demux_t * );
+static int  LoadAll( demux_t *, int (*)( vlc_object_t *, subs_properties_t *, text_t *, subtitle_t *, size_t ) );
+static void LazyStart( demux_t *, int (*)( vlc_object_t *, subs_properties_t *, text_t *, subtitle_t *, size_t ) );
+static void LazyStop( demux_sys_t * );
 static char * get_language_from_filename( const char * );
 
 /*****************************************************************************
@@ -326,6 +366,9 @@ static int Open ( vlc_object_t *p_this )
     p_sys->subtitles.i_count  = 0;
     p_sys->subtitles.p_array  = NULL;
 
+    p_sys->lazy.b_enabled  = false;
+    p_sys->lazy.b_scanning = false;
+
     p_sys->props.psz_header         = NULL;
     p_sys->props.psz_lang           = NULL;
     p_sys->props.i_microsecperframe = VLC_TICK_FROM_MS(40);
@@ -634,8 +677,6 @@ static int Open ( vlc_object_t *p_this )
         }
     }
 
-    msg_Dbg( p_demux, "loading all subtitles..." );
-
     if( e_bom == UTF8BOM && /* skip BOM */
         vlc_stream_Read( p_demux->s, NULL, 3 ) != 3 )
     {
@@ -643,37 +684,27 @@ static int Open ( vlc_object_t *p_this )
         return VLC_EGENERIC;
     }
 
-    /* Load the whole file */
-    text_t txtlines;
-    TextLoad( &txtlines, p_demux->s );
-
-    /* Parse it */
-    for( size_t i_max = 0; i_max < SIZE_MAX - 500 * sizeof(subtitle_t); )
+    /* Only SubRip is known not to look back nor to keep a state between
+     * cues, and the UTF-16 conversion does not survive seeks */
+    bool b_fastseek = false;
+    if( p_sys->props.i_type == SUB_TYPE_SUBRIP &&
+        e_bom != UTF16LE && e_bom != UTF16BE &&
+        p_demux->psz_filepath != NULL && !p_demux->b_preparsing &&
+        vlc_stream_Control( p_demux->s, STREAM_CAN_FASTSEEK, &b_fastseek ) == VLC_SUCCESS &&
+        b_fastseek && stream_Size( p_demux->s ) > SUB_LAZY_MIN_SIZE )
     {
-        if( p_sys->subtitles.i_count >= i_max )
+        msg_Dbg( p_demux, "loading subtitles as they are played..." );
+        LazyStart( p_demux, pf_read );
+    }
+    else
+    {
+        msg_Dbg( p_demux, "loading all subtitles..." );
+        if( LoadAll( p_demux, pf_read ) )
         {
-            i_max += 500;
-            subtitle_t *p_realloc = realloc( p_sys->subtitles.p_array, sizeof(subtitle_t) * i_max );
-            if( p_realloc == NULL )
-            {
-                TextUnload( &txtlines );
-                Close( p_this );
-                return VLC_ENOMEM;
-            }
-            p_sys->subtitles.p_array = p_realloc;
+            Close( p_this );
+            return VLC_ENOMEM;
         }
-
-        if( pf_read( VLC_OBJECT(p_demux), &p_sys->props, &txtlines,
-                     &p_sys->subtitles.p_array[p_sys->subtitles.i_count],
-                     p_sys->subtitles.i_count ) )
-            break;
-
-        p_sys->subtitles.i_count++;
     }
-    /* Unload */
-    TextUnload( &txtlines );
-
-    msg_Dbg(p_demux, "loaded %zu subtitles", p_sys->subtitles.i_count );
 
     /* *** add subtitle ES *** */
     if( p_sys->props.i_type == SUB_TYPE_SSA1 ||
@@ -742,6 +773,9 @@ static void Close( vlc_object_t *p_this )
     demux_t *p_demux = (demux_t*)p_this;
     demux_sys_t *p_sys = p_demux->p_sys;
 
+    if( p_sys->lazy.b_enabled )
+        LazyStop( p_sys );
+
     for( size_t i = 0; i < p_sys->subtitles.i_count; i++ )
         free( p_sys->subtitles.p_array[i].psz_text );
     free( p_sys->subtitles.p_array );
@@ -750,10 +784,241 @@ static void Close( vlc_object_t *p_this )
     free( p_sys );
 }
 
+static int LoadAll( demux_t *p_demux,
+                    int (*pf_read)( vlc_object_t *, subs_properties_t *, text_t *, subtitle_t *, size_t ) )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    /* Load the whole file */
+    text_t txtlines;
+    TextLoad( &txtlines, p_demux->s );
+
+    /* Parse it */
+    for( size_t i_max = 0; i_max < SIZE_MAX - 500 * sizeof(subtitle_t); )
+    {
+        if( p_sys->subtitles.i_count >= i_max )
+        {
+            i_max += 500;
+            subtitle_t *p_realloc = realloc( p_sys->subtitles.p_array, sizeof(subtitle_t) * i_max );
+            if( p_realloc == NULL )
+            {
+                TextUnload( &txtlines );
+                return VLC_ENOMEM;
+            }
+            p_sys->subtitles.p_array = p_realloc;
+        }
+
+        if( pf_read( VLC_OBJECT(p_demux), &p_sys->props, &txtlines,
+                     &p_sys->subtitles.p_array[p_sys->subtitles.i_count],
+                     p_sys->subtitles.i_count ) )
+            break;
+
+        p_sys->subtitles.i_count++;
+    }
+    /* Unload */
+    TextUnload( &txtlines );
+
+    msg_Dbg(p_demux, "loaded %zu subtitles", p_sys->subtitles.i_count );
+    return VLC_SUCCESS;
+}
+
+static void *LazyIndexThread( void *data )
+{
+    demux_t *p_demux = data;
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    vlc_thread_set_name( "vlc-sub-index" );
+    vlc_interrupt_set( p_sys->lazy.p_interrupt );
+
+    /* Own stream handle, the demuxer keeps reading from its own */
+    stream_t *s = vlc_stream_NewURL( VLC_OBJECT(p_demux), p_demux->psz_url );
+    if( s && vlc_stream_Seek( s, p_sys->lazy.i_start_pos ) == VLC_SUCCESS )
+    {
+        subs_properties_t props = p_sys->props;
+        text_t txt;
+        vlc_tick_t i_length = 0;
+
+        TextOpenStream( &txt, s );
+        for( size_t i = 0; !vlc_killed(); i++ )
+        {
+            const uint64_t i_pos = vlc_stream_Tell( s );
+            subtitle_t sub;
+
+            if( p_sys->lazy.pf_read( VLC_OBJECT(p_demux), &props, &txt, &sub, i ) )
+                break;
+            free( sub.psz_text );
+            if( sub.i_stop > i_length )
+                i_length = sub.i_stop;
+            if( i % SUB_INDEX_INTERVAL )
+                continue;
+
+            vlc_mutex_lock( &p_sys->lazy.lock );
+            /* Out of order cues are found by parsing from an earlier entry */
+            if( p_sys->lazy.i_index == 0 ||
+                sub.i_start > p_sys->lazy.p_index[p_sys->lazy.i_index - 1].i_start )
+            {
+                void *p_realloc = realloc( p_sys->lazy.p_index,
+                                           (p_sys->lazy.i_index + 1) * sizeof(*p_sys->lazy.p_index) );
+                if( p_realloc )
+                {
+                    p_sys->lazy.p_index = p_realloc;
+                    p_sys->lazy.p_index[p_sys->lazy.i_index].i_start = sub.i_start;
+                    p_sys->lazy.p_index[p_sys->lazy.i_index].i_pos = i_pos;
+                    p_sys->lazy.i_index++;
+                }
+            }
+            p_sys->lazy.i_length = i_length;
+            vlc_mutex_unlock( &p_sys->lazy.lock );
+        }
+        TextUnload( &txt );
+
+        vlc_mutex_lock( &p_sys->lazy.lock );
+        p_sys->lazy.i_length = i_length;
+        vlc_mutex_unlock( &p_sys->lazy.lock );
+    }
+
+    if( s )
+        vlc_stream_Delete( s );
+
+    vlc_interrupt_set( NULL );
+    return NULL;
+}
+
+static void LazyStart( demux_t *p_demux,
+                       int (*pf_read)( vlc_object_t *, subs_properties_t *, text_t *, subtitle_t *, size_t ) )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    p_sys->lazy.b_enabled = true;
+    p_sys->lazy.b_pending = false;
+    p_sys->lazy.b_eof = false;
+    p_sys->lazy.i_start_pos = vlc_stream_Tell( p_demux->s );
+    p_sys->lazy.pf_read = pf_read;
+    TextOpenStream( &p_sys->lazy.txt, p_demux->s );
+    vlc_mutex_init( &p_sys->lazy.lock );
+    p_sys->lazy.p_index = NULL;
+    p_sys->lazy.i_index = 0;
+    p_sys->lazy.i_length = 0;
+
+    /* Without an index, seeking parses from the beginning */
+    p_sys->lazy.p_interrupt = vlc_interrupt_create();
+    if( !p_sys->lazy.p_interrupt )
+        return;
+
+    if( vlc_clone( &p_sys->lazy.thread, LazyIndexThread, p_demux ) )
+    {
+        vlc_interrupt_destroy( p_sys->lazy.p_interrupt );
+        return;
+    }
+    p_sys->lazy.b_scanning = true;
+}
+
+static void LazyStop( demux_sys_t *p_sys )
+{
+    if( p_sys->lazy.b_scanning )
+    {
+        vlc_interrupt_kill( p_sys->lazy.p_interrupt );
+        vlc_join( p_sys->lazy.thread, NULL );
+        vlc_interrupt_destroy( p_sys->lazy.p_interrupt );
+        p_sys->lazy.b_scanning = false;
+    }
+    if( p_sys->lazy.b_pending )
+        free( p_sys->lazy.next.psz_text );
+    TextUnload( &p_sys->lazy.txt );
+    free( p_sys->lazy.p_index );
+}
+
+/* Returns the next subtitle to send or NULL at the end */
+static const subtitle_t *PeekSubtitle( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !p_sys->lazy.b_enabled )
+    {
+        if( p_sys->subtitles.i_current >= p_sys->subtitles.i_count )
+            return NULL;
+        return &p_sys->subtitles.p_array[p_sys->subtitles.i_current];
+    }
+
+    if( !p_sys->lazy.b_pending && !p_sys->lazy.b_eof )
+    {
+        if( p_sys->lazy.pf_read( VLC_OBJECT(p_demux), &p_sys->props,
+                                 &p_sys->lazy.txt, &p_sys->lazy.next, 0 ) )
+            p_sys->lazy.b_eof = true;
+        else
+            p_sys->lazy.b_pending = true;
+    }
+    return p_sys->lazy.b_pending ? &p_sys->lazy.next : NULL;
+}
+
+static void NextSubtitle( demux_sys_t *p_sys )
+{
+    if( !p_sys->lazy.b_enabled )
+    {
+        p_sys->subtitles.i_current++;
+        return;
+    }
+
+    assert( p_sys->lazy.b_pending );
+    free( p_sys->lazy.next.psz_text );
+    p_sys->lazy.b_pending = false;
+}
+
+static vlc_tick_t GetLength( demux_sys_t *p_sys )
+{
+    if( !p_sys->lazy.b_enabled )
+        return p_sys->i_length;
+
+    vlc_mutex_lock( &p_sys->lazy.lock );
+    vlc_tick_t i_length = p_sys->lazy.i_length;
+    vlc_mutex_unlock( &p_sys->lazy.lock );
+    return i_length;
+}
+
+static void
+LazySeek( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const vlc_tick_t i_date = p_sys->i_next_demux_date;
+    uint64_t i_pos = p_sys->lazy.i_start_pos;
+
+    /* Last indexed cue starting before the date */
+    vlc_mutex_lock( &p_sys->lazy.lock );
+    size_t i_low = 0, i_high = p_sys->lazy.i_index;
+    while( i_low < i_high )
+    {
+        size_t i_mid = (i_low + i_high) / 2;
+        if( p_sys->lazy.p_index[i_mid].i_start * p_sys->f_rate <= i_date )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+    if( i_low > 0 )
+        i_pos = p_sys->lazy.p_index[i_low - 1].i_pos;
+    vlc_mutex_unlock( &p_sys->lazy.lock );
+
+    if( p_sys->lazy.b_pending )
+        NextSubtitle( p_sys );
+    p_sys->lazy.b_eof = vlc_stream_Seek( p_demux->s, i_pos ) != VLC_SUCCESS;
+
+    /* Skip the cues that are already over */
+    const subtitle_t *p_subtitle;
+    while( ( p_subtitle = PeekSubtitle( p_demux ) ) != NULL &&
+           p_subtitle->i_stop * p_sys->f_rate <= i_date )
+        NextSubtitle( p_sys );
+}
+
 static void
 ResetCurrentIndex( demux_t *p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( p_sys->lazy.b_enabled )
+    {
+        LazySeek( p_demux );
+        return;
+    }
+
     for( size_t i = 0; i < p_sys->subtitles.i_count; i++ )
     {
         if( p_sys->subtitles.p_array[i].i_start * p_sys->f_rate >
@@ -778,7 +1043,7 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
             return VLC_SUCCESS;
 
         case DEMUX_GET_LENGTH:
-            *va_arg( args, vlc_tick_t * ) = p_sys->i_length;
+            *va_arg( args, vlc_tick_t * ) = GetLength( p_sys );
             return VLC_SUCCESS;
 
         case DEMUX_GET_TIME:
@@ -794,30 +1059,36 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
         }
 
         case DEMUX_GET_POSITION:
+        {
             pf = va_arg( args, double * );
-            if( p_sys->subtitles.i_current >= p_sys->subtitles.i_count )
+            const vlc_tick_t i_length = GetLength( p_sys );
+            if( PeekSubtitle( p_demux ) == NULL )
             {
                 *pf = 1.0;
             }
-            else if( p_sys->subtitles.i_count > 0 && p_sys->i_length )
+            else if( i_length > 0 )
             {
                 *pf = p_sys->i_next_demux_date;
-                *pf /= p_sys->i_length;
+                *pf /= i_length;
             }
             else
             {
                 *pf = 0.0;
             }
             return VLC_SUCCESS;
+        }
 
         case DEMUX_SET_POSITION:
+        {
             f = va_arg( args, double );
-            if( p_sys->subtitles.i_count && p_sys->i_length )
+            const vlc_tick_t i_length = GetLength( p_sys );
+            if( i_length > 0 )
             {
-                vlc_tick_t i64 = VLC_TICK_0 + f * p_sys->i_length;
+                vlc_tick_t i64 = VLC_TICK_0 + f * i_length;
                 return demux_Control( p_demux, DEMUX_SET_TIME, i64 );
             }
             break;
+        }
 
         case DEMUX_CAN_CONTROL_RATE:
             *va_arg( args, bool * ) = true;
@@ -858,13 +1129,11 @@ static int Demux( demux_t *p_demux )
     demux_sys_t *p_sys = p_demux->p_sys;
 
     vlc_tick_t i_barrier = p_sys->i_next_demux_date;
+    const subtitle_t *p_subtitle;
 
-    while( p_sys->subtitles.i_current < p_sys->subtitles.i_count &&
-           ( p_sys->subtitles.p_array[p_sys->subtitles.i_current].i_start *
-             p_sys->f_rate ) <= i_barrier )
+    while( ( p_subtitle = PeekSubtitle( p_demux ) ) != NULL &&
+           ( p_subtitle->i_start * p_sys->f_rate ) <= i_barrier )
     {
-        const subtitle_t *p_subtitle = &p_sys->subtitles.p_array[p_sys->subtitles.i_current];
-
         if ( !p_sys->b_slave && p_sys->b_first_time )
         {
             es_out_SetPCR( p_demux->out, VLC_TICK_0 + i_barrier );
@@ -885,7 +1154,7 @@ static int Demux( demux_t *p_demux )
             }
         }
 
-        p_sys->subtitles.i_current++;
+        NextSubtitle( p_sys );
     }
 
     if ( !p_sys->b_slave )
@@ -894,7 +1163,7 @@ static int Demux( demux_t *p_demux )
         p_sys->i_next_demux_date += VLC_TICK_FROM_MS(125);
     }
 
-    if( p_sys->subtitles.i_current >= p_sys->subtitles.i_count )
+    if( PeekSubtitle( p_demux ) == NULL )
         return VLC_DEMUXER_EOF;
 
     return VLC_DEMUXER_SUCCESS;
@@ -927,6 +1196,8 @@ static int TextLoad( text_t *txt, stream_t *s )
     i_line_max          = 500;
     txt->i_line_count   = 0;
     txt->i_line         = 0;
+    txt->s              = NULL;
+    txt->psz_line       = NULL;
     txt->line           = calloc( i_line_max, sizeof( char * ) );
     if( !txt->line )
         return VLC_ENOMEM;
@@ -959,8 +1230,19 @@ static int TextLoad( text_t *txt, stream_t *s )
 
     return VLC_SUCCESS;
 }
+static void TextOpenStream( text_t *txt, stream_t *s )
+{
+    txt->i_line_count   = 0;
+    txt->i_line         = 0;
+    txt->line           = NULL;
+    txt->s              = s;
+    txt->psz_line       = NULL;
+}
+
 static void TextUnload( text_t *txt )
 {
+    free( txt->psz_line );
+    txt->psz_line = NULL;
     if( txt->i_line_count )
     {
         for( size_t i = 0; i < txt->i_line_count; i++ )
@@ -973,6 +1255,13 @@ static void TextUnload( text_t *txt )
 
 static char *TextGetLine( text_t *txt )
 {
+    /* the line is valid until the next one is read */
+    if( txt->s != NULL )
+    {
+        free( txt->psz_line );
+        return txt->psz_line = vlc_stream_ReadLine( txt->s );
+    }
+
     if( txt->i_line >= txt->i_line_count )
         return( NULL );
 
@@ -980,6 +1269,7 @@ static char *TextGetLine( text_t *txt )
 }
 static void TextPreviousLine( text_t *txt )
 {
+    assert( txt->s == NULL );
     if( txt->i_line > 0 )
         txt->i_line--;
 }
@@ -31,6 +31,7 @@
 #include <set>
 #include <QObject>
 #include <QSharedPointer>
+#include <vlc_diffutil.h>
 #include "listcacheloader.hpp"
 
 struct MLRange
@@ -111,7 +112,8 @@ signals:
  *
  * The cache will load data by chunk.
  * When data is invalidated, it will use a differentiation algorithm to provide
- * update events on data that changes
+ * update events on data that changes. The differences between large lists are
+ * computed on a worker thread, the previous data being shown meanwhile.
  *
  * All its public methods must be called from the UI thread.
  */
@@ -261,9 +263,15 @@ private:
     //this function must be specialized
     static bool compareItems(const ItemType& a, const ItemType& b);
 
+    static vlc_diffutil_changelist_t* buildChangeList(const CacheData* oldData,
+                                                      const CacheData* newData,
+                                                      bool useMove);
+
     void asyncFetchMore();
     void asyncCountAndLoad();
-    void partialUpdate();
+    void asyncPartialUpdate(uint64_t taskId, std::unique_ptr<CacheData>&& data);
+    void countAndLoadEnded();
+    void partialUpdate(vlc_diffutil_changelist_t* changes);
     size_t fixupIndexForMove(size_t index) const;
 
     bool m_useMove = false;
@@ -286,7 +294,8 @@ private:
     uint64_t m_countTask = 0;
 
     std::unique_ptr<CacheData> m_cachedData;
-    std::unique_ptr<CacheData> m_oldData;
+    //shared with the worker computing the changes, left untouched meanwhile
+    std::shared_ptr<CacheData> m_oldData;
 
     MLRange m_rangeRequested;
 
@@ -22,6 +22,13 @@
 #include "listcache.hpp"
 #include <vlc_diffutil.h>
 
+#include <QCoreApplication>
+#include <QPointer>
+#include <QThreadPool>
+
+//below this number of items, the changes are computed on the UI thread
+#define LISTCACHE_ASYNC_DIFF_MIN 1000
+
 //callbacks for the diff algorithm to access the data
 
 template<typename T>
@@ -426,26 +433,71 @@ void ListCache<T>::invalidate()
 }
 
 template<typename T>
-void ListCache<T>::partialUpdate()
+vlc_diffutil_changelist_t* ListCache<T>::buildChangeList(const CacheData* oldData,
+                                                         const CacheData* newData,
+                                                         bool useMove)
 {
     //compare the model the user have and the updated model
-    //and notify for changes
-
     vlc_diffutil_callback_t diffOp = {
         cacheDataLength,
         cacheDataLength,
         cacheDataCompare
     };
 
-    diffutil_snake_t* snake = vlc_diffutil_build_snake(&diffOp, m_oldData.get(), m_cachedData.get());
+    diffutil_snake_t* snake = vlc_diffutil_build_snake(&diffOp, oldData, newData);
     int diffutilFlags = VLC_DIFFUTIL_RESULT_AGGREGATE;
-    if (m_useMove)
+    if (useMove)
         diffutilFlags |= VLC_DIFFUTIL_RESULT_MOVE;
 
     vlc_diffutil_changelist_t* changes = vlc_diffutil_build_change_list(
-        snake, &diffOp, m_oldData.get(), m_cachedData.get(),
-        diffutilFlags);
+        snake, &diffOp, oldData, newData, diffutilFlags);
+    vlc_diffutil_free_snake(snake);
+    return changes;
+}
+
+template<typename T>
+void ListCache<T>::asyncPartialUpdate(uint64_t taskId, std::unique_ptr<CacheData>&& data)
+{
+    assert(m_oldData);
 
+    if (m_oldData->loadedCount + data->loadedCount < LISTCACHE_ASYNC_DIFF_MIN)
+    {
+        m_cachedData = std::move(data);
+        partialUpdate(buildChangeList(m_oldData.get(), m_cachedData.get(), m_useMove));
+        countAndLoadEnded();
+        return;
+    }
+
+    //m_countTask stays set until the changes are applied, so that the cache
+    //is not modified meanwhile, the old data being shown
+    std::shared_ptr<const CacheData> oldData = m_oldData;
+    std::shared_ptr<CacheData> newData = std::move(data);
+    QPointer<ListCacheBase> self = this;
+    bool useMove = m_useMove;
+
+    QThreadPool::globalInstance()->start([self, taskId, oldData, newData, useMove]() {
+        vlc_diffutil_changelist_t* changes =
+            buildChangeList(oldData.get(), newData.get(), useMove);
+
+        //the cache may be destroyed before the changes are applied
+        QMetaObject::invokeMethod(qApp, [self, taskId, newData, changes]() {
+            auto cache = static_cast<ListCache<T>*>(self.data());
+            if (!cache || cache->m_countTask != taskId)
+            {
+                vlc_diffutil_free_change_list(changes);
+                return;
+            }
+            cache->m_cachedData = std::make_unique<CacheData>(std::move(*newData));
+            cache->partialUpdate(changes);
+            cache->countAndLoadEnded();
+        }, Qt::QueuedConnection);
+    });
+}
+
+template<typename T>
+void ListCache<T>::partialUpdate(vlc_diffutil_changelist_t* changes)
+{
+    //notify the changes between the model the user have and the updated model
     m_partialIndex = 0;
     m_partialLoadedCount = m_oldData->loadedCount;
     size_t partialQueryCount = m_oldData->queryCount;
@@ -501,7 +553,6 @@ void ListCache<T>::partialUpdate()
         }
     }
     vlc_diffutil_free_change_list(changes);
-    vlc_diffutil_free_snake(snake);
 
     //ditch old model
     if (m_useMove)
@@ -554,49 +605,57 @@ void ListCache<T>::asyncCountAndLoad()
                 : maximumCount;
 
             //note: should we drop items past queryCount?
-            m_cachedData = std::make_unique<CacheData>(std::move(list),
-                                                       queryCount,
-                                                       maximumCount);
+            auto data = std::make_unique<CacheData>(std::move(list),
+                                                    queryCount,
+                                                    maximumCount);
 
             if (m_oldData)
             {
-                partialUpdate();
-            }
-            else
-            {
-                if (m_cachedData->queryCount > 0)
-                {
-                    //no previous data, we insert everything
-                    emit beginInsertRows(0, m_cachedData->queryCount - 1);
-                    emit endInsertRows();
-                    emit localSizeChanged(m_cachedData->queryCount, m_cachedData->maximumCount);
-                }
-                else
-                    emit localSizeChanged(0, m_cachedData->maximumCount);
+                asyncPartialUpdate(taskId, std::move(data));
+                return;
             }
 
-            m_countTask = 0;
-
-            if (m_needReload)
+            m_cachedData = std::move(data);
+            if (m_cachedData->queryCount > 0)
             {
-                m_needReload  = false;
-                m_oldData = std::move(m_cachedData);
-                m_partialX = 0;
-                asyncCountAndLoad();
-            }
-            else if (m_maxReferedIndex < m_cachedData->loadedCount)
-            {
-                m_maxReferedIndex = m_cachedData->loadedCount;
-            }
-            else if (m_maxReferedIndex > m_cachedData->loadedCount
-                && m_maxReferedIndex <= m_cachedData->queryCount)
-            {
-                asyncFetchMore();
+                //no previous data, we insert everything
+                emit beginInsertRows(0, m_cachedData->queryCount - 1);
+                emit endInsertRows();
+                emit localSizeChanged(m_cachedData->queryCount, m_cachedData->maximumCount);
             }
+            else
+                emit localSizeChanged(0, m_cachedData->maximumCount);
+
+            countAndLoadEnded();
         }
     );
 }
 
+template<typename T>
+void ListCache<T>::countAndLoadEnded()
+{
+    assert(m_cachedData);
+
+    m_countTask = 0;
+
+    if (m_needReload)
+    {
+        m_needReload  = false;
+        m_oldData = std::move(m_cachedData);
+        m_partialX = 0;
+        asyncCountAndLoad();
+    }
+    else if (m_maxReferedIndex < m_cachedData->loadedCount)
+    {
+        m_maxReferedIndex = m_cachedData->loadedCount;
+    }
+    else if (m_maxReferedIndex > m_cachedData->loadedCount
+        && m_maxReferedIndex <= m_cachedData->queryCount)
+    {
+        asyncFetchMore();
+    }
+}
+
 template<typename T>
 void ListCache<T>::asyncFetchMore()
 {
@@ -198,10 +198,21 @@ static picture_t *AllocPicture( filter_t *p_filter )
                               false, cfg);
 }
 
+static bool IsLevelDefault(const struct filter_level *p_level)
+{
+    return atomic_load(&p_level->level) == p_level->Range.Default;
+}
+
 static picture_t *Filter(filter_t *p_filter, picture_t *p_pic)
 {
     filter_sys_t *p_sys = p_filter->p_sys;
 
+    /* nothing to adjust: pass the decoder texture along untouched instead
+     * of copying it */
+    if (IsLevelDefault(&p_sys->Contrast) && IsLevelDefault(&p_sys->Brightness) &&
+        IsLevelDefault(&p_sys->Hue) && IsLevelDefault(&p_sys->Saturation))
+        return p_pic;
+
     picture_sys_d3d11_t *p_src_sys = ActiveD3D11PictureSys(p_pic);
     if (FAILED( D3D11_Assert_ProcessorInput(p_filter, &p_sys->d3d_proc, p_src_sys) ))
     {
@@ -1,120 +1,302 @@
-/*****************************************************************************
- * hw_pool.c: hw based picture pool
- *****************************************************************************
- * Copyright (C) 2019-2020 VLC authors and VideoLAN
- *
- * Authors: Jai Luthra <me@jailuthra.in>
- *          Quentin Chateau <quentin.chateau@deepskycorp.com>
- *          Steve Lhomme <robux4@videolabs.io>
- *
- * This program is free software; you can redistribute it and/or modify it
- * under the terms of the GNU Lesser General Public License as published by
- * the Free Software Foundation; either version 2.1 of the License, or
- * (at your option) any later version.
- *
- * This program is distributed in the hope that it will be useful,
- * but WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
- * GNU Lesser General Public License for more details.
- *
- * You should have received a copy of the GNU Lesser General Public License
- * along with this program; if not, write to the Free Software Foundation,
- * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
- *****************************************************************************/
-#ifdef HAVE_CONFIG_H
-# include "config.h"
-#endif
-
-#include <vlc_picture_pool.h>
-#include <vlc_atomic.h>
-#include "hw_pool.h"
-
-struct hw_pool_t {
-    vlc_video_context           *vctx;
-
-    hw_pool_owner_t             *owner;
-
-    void                        *res[64];
-    size_t                      pool_size;
-
-    picture_pool_t              *picture_pool;
-
-    vlc_atomic_rc_t             rc;
-};
-
-void hw_pool_AddRef(hw_pool_t *pool)
-{
-    vlc_atomic_rc_inc(&pool->rc);
-}
-
-void hw_pool_Release(hw_pool_t *pool)
-{
-    if (!vlc_atomic_rc_dec(&pool->rc))
-        return;
-
-    pool->owner->release_resources(pool->owner, pool->res, pool->pool_size);
-
-    picture_pool_Release(pool->picture_pool);
-    vlc_video_context_Release(pool->vctx);
-}
-
-hw_pool_t* hw_pool_Create(hw_pool_owner_t *owner,
-                          const video_format_t *fmt, vlc_video_context *vctx,
-                          void *buffers[], size_t pics_count)
-{
-    hw_pool_t *pool = calloc(1, sizeof(*pool));
-    if (unlikely(!pool))
-        return NULL;
-
-    picture_t *pics[pics_count];
-    for (size_t i=0; i < pics_count; i++)
-    {
-        pics[i] = picture_NewFromResource(fmt, &(picture_resource_t){ 0 });
-        if (!pics[i])
-        {
-            while (i--)
-                picture_Release(pics[i]);
-            goto error;
-        }
-        pool->res[i] = buffers[i];
-        pics[i]->p_sys = buffers[i];
-    }
-
-    pool->picture_pool = picture_pool_New(pics_count, pics);
-    if (!pool->picture_pool)
-        goto free_pool;
-
-    pool->owner = owner;
-    pool->vctx = vctx;
-    pool->pool_size = pics_count;
-    vlc_video_context_Hold(pool->vctx);
-
-    vlc_atomic_rc_init(&pool->rc);
-    return pool;
-
-free_pool:
-    for (size_t i=0; i < pics_count; i++)
-    {
-        if (pics[i] != NULL)
-            picture_Release(pics[i]);
-    }
-error:
-    free(pool);
-    return NULL;
-}
-
-picture_t* hw_pool_Wait(hw_pool_t *pool)
-{
-    picture_t *pic = picture_pool_Wait(pool->picture_pool);
-    if (!pic)
-        return NULL;
-
-    void *surface = pic->p_sys;
-    pic->p_sys = NULL;
-    pic->context = pool->owner->attach_picture(pool->owner, pool, surface);
-    if (likely(pic->context != NULL))
-        return pic;
-
-    picture_Release(pic);
-    return NULL;
-}
+/*****************************************************************************
+ * hw_pool.c: hw based picture pool
+ *****************************************************************************
+ * Copyright (C) 2019-2020 VLC authors and VideoLAN
+ *
+ * Authors: Jai Luthra <me@jailuthra.in>
+ *          Quentin Chateau <quentin.chateau@deepskycorp.com>
+ *          Steve Lhomme <robux4@videolabs.io>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <vlc_atomic.h>
+#include <vlc_threads.h>
+#include "hw_pool.h"
+
+#define HW_POOL_MAX_SIZE  64
+/* number of pictures requested between checks for unused surfaces */
+#define HW_POOL_SHRINK_PERIOD  64
+
+struct hw_pool_surface {
+    hw_pool_t                   *pool;
+    void                        *res; /* NULL if the slot is unused */
+};
+
+/* memory used by the surfaces of all the pools of the process */
+static struct {
+    vlc_mutex_t lock;
+    uint64_t    used;
+} hw_pool_memory = { VLC_STATIC_MUTEX, 0 };
+
+struct hw_pool_t {
+    vlc_video_context           *vctx;
+
+    hw_pool_owner_t             *owner;
+
+    video_format_t              fmt;
+
+    vlc_mutex_t                 lock;
+    vlc_cond_t                  wait;
+    struct hw_pool_surface      surfaces[HW_POOL_MAX_SIZE];
+    struct hw_pool_surface      *available[HW_POOL_MAX_SIZE];
+    size_t                      available_count;
+    size_t                      pool_size;
+    size_t                      min_size;
+    size_t                      max_size;
+    size_t                      surface_size;
+    uint64_t                    budget;
+
+    /* lowest count of available surfaces since the last check */
+    size_t                      available_low;
+    unsigned                    requests;
+    struct hw_pool_stats        stats;
+
+    vlc_atomic_rc_t             rc;
+};
+
+static bool MemoryReserve(size_t size, uint64_t budget)
+{
+    bool ok = true;
+
+    vlc_mutex_lock(&hw_pool_memory.lock);
+    if (budget != 0 && hw_pool_memory.used + size > budget)
+        ok = false;
+    else
+        hw_pool_memory.used += size;
+    vlc_mutex_unlock(&hw_pool_memory.lock);
+    return ok;
+}
+
+static void MemoryUnreserve(uint64_t size)
+{
+    vlc_mutex_lock(&hw_pool_memory.lock);
+    assert(hw_pool_memory.used >= size);
+    hw_pool_memory.used -= size;
+    vlc_mutex_unlock(&hw_pool_memory.lock);
+}
+
+void hw_pool_AddRef(hw_pool_t *pool)
+{
+    vlc_atomic_rc_inc(&pool->rc);
+}
+
+void hw_pool_Release(hw_pool_t *pool)
+{
+    if (!vlc_atomic_rc_dec(&pool->rc))
+        return;
+
+    /* all the pictures are back, every used slot is available */
+    assert(pool->available_count == pool->pool_size);
+
+    void *res[HW_POOL_MAX_SIZE];
+    size_t count = 0;
+    for (size_t i = 0; i < ARRAY_SIZE(pool->surfaces); i++)
+        if (pool->surfaces[i].res != NULL)
+            res[count++] = pool->surfaces[i].res;
+
+    pool->owner->release_resources(pool->owner, res, count);
+    MemoryUnreserve((uint64_t)count * pool->surface_size);
+
+    video_format_Clean(&pool->fmt);
+    vlc_video_context_Release(pool->vctx);
+    free(pool);
+}
+
+hw_pool_t* hw_pool_Create(hw_pool_owner_t *owner,
+                          const video_format_t *fmt, vlc_video_context *vctx,
+                          void *buffers[], size_t pics_count,
+                          const struct hw_pool_cfg *cfg)
+{
+    assert(pics_count > 0 && pics_count <= HW_POOL_MAX_SIZE);
+
+    hw_pool_t *pool = calloc(1, sizeof(*pool));
+    if (unlikely(!pool))
+        return NULL;
+
+    if (video_format_Copy(&pool->fmt, fmt) != VLC_SUCCESS)
+    {
+        free(pool);
+        return NULL;
+    }
+
+    for (size_t i=0; i < pics_count; i++)
+    {
+        pool->surfaces[i].pool = pool;
+        pool->surfaces[i].res = buffers[i];
+        pool->available[i] = &pool->surfaces[i];
+    }
+    for (size_t i=pics_count; i < HW_POOL_MAX_SIZE; i++)
+        pool->surfaces[i].pool = pool;
+
+    pool->available_count = pool->available_low = pics_count;
+    pool->pool_size = pool->min_size = pool->max_size = pics_count;
+    pool->stats.count = pool->stats.peak = pics_count;
+    if (cfg != NULL)
+    {
+        if (cfg->max_count > pics_count)
+            pool->max_size = __MIN(cfg->max_count, HW_POOL_MAX_SIZE);
+        pool->surface_size = cfg->surface_size;
+        pool->budget = cfg->budget;
+    }
+    /* the initial surfaces are always accounted for, even above the budget */
+    MemoryReserve(pics_count * pool->surface_size, 0);
+
+    vlc_mutex_init(&pool->lock);
+    vlc_cond_init(&pool->wait);
+    pool->owner = owner;
+    pool->vctx = vctx;
+    vlc_video_context_Hold(pool->vctx);
+
+    vlc_atomic_rc_init(&pool->rc);
+    return pool;
+}
+
+static struct hw_pool_surface *PoolGrow(hw_pool_t *pool)
+{
+    if (pool->pool_size >= pool->max_size || pool->owner->alloc_resource == NULL)
+        return NULL;
+
+    if (!MemoryReserve(pool->surface_size, pool->budget))
+    {
+        pool->stats.denied++;
+        return NULL;
+    }
+
+    void *res = pool->owner->alloc_resource(pool->owner);
+    if (res == NULL)
+    {
+        MemoryUnreserve(pool->surface_size);
+        /* don't try again */
+        pool->max_size = pool->pool_size;
+        return NULL;
+    }
+
+    struct hw_pool_surface *surface = NULL;
+    for (size_t i = 0; i < ARRAY_SIZE(pool->surfaces); i++)
+        if (pool->surfaces[i].res == NULL)
+        {
+            surface = &pool->surfaces[i];
+            break;
+        }
+    assert(surface != NULL);
+
+    surface->res = res;
+    pool->pool_size++;
+    pool->stats.count = pool->pool_size;
+    pool->stats.peak = __MAX(pool->stats.peak, pool->pool_size);
+    return surface;
+}
+
+static void PoolShrink(hw_pool_t *pool)
+{
+    pool->available_low = __MIN(pool->available_low, pool->available_count);
+    if (++pool->requests < HW_POOL_SHRINK_PERIOD)
+        return;
+
+    /* a surface was never used during the whole period: free it */
+    if (pool->available_low > 0 && pool->pool_size > pool->min_size
+     && pool->owner->free_resource != NULL)
+    {
+        struct hw_pool_surface *surface =
+            pool->available[--pool->available_count];
+
+        pool->owner->free_resource(pool->owner, surface->res);
+        surface->res = NULL;
+        pool->pool_size--;
+        pool->stats.count = pool->pool_size;
+        MemoryUnreserve(pool->surface_size);
+    }
+
+    pool->requests = 0;
+    pool->available_low = pool->available_count;
+}
+
+static void PoolPut(struct hw_pool_surface *surface)
+{
+    hw_pool_t *pool = surface->pool;
+
+    vlc_mutex_lock(&pool->lock);
+    pool->available[pool->available_count++] = surface;
+    vlc_cond_signal(&pool->wait);
+    vlc_mutex_unlock(&pool->lock);
+
+    hw_pool_Release(pool);
+}
+
+static void hw_pool_PictureDestroy(picture_t *pic)
+{
+    PoolPut(pic->p_sys);
+}
+
+picture_t* hw_pool_Wait(hw_pool_t *pool)
+{
+    struct hw_pool_surface *surface;
+    bool waited = false;
+
+    vlc_mutex_lock(&pool->lock);
+    for (;;)
+    {
+        if (pool->available_count > 0)
+        {
+            surface = pool->available[--pool->available_count];
+            break;
+        }
+
+        surface = PoolGrow(pool);
+        if (surface != NULL)
+            break;
+
+        if (!waited)
+        {
+            pool->stats.waits++;
+            waited = true;
+        }
+        vlc_cond_wait(&pool->wait, &pool->lock);
+    }
+    PoolShrink(pool);
+    vlc_mutex_unlock(&pool->lock);
+
+    hw_pool_AddRef(pool);
+
+    picture_resource_t resource = {
+        .p_sys = surface,
+        .pf_destroy = hw_pool_PictureDestroy,
+    };
+    picture_t *pic = picture_NewFromResource(&pool->fmt, &resource);
+    if (unlikely(pic == NULL))
+    {
+        PoolPut(surface);
+        return NULL;
+    }
+
+    pic->context = pool->owner->attach_picture(pool->owner, pool, surface->res);
+    if (likely(pic->context != NULL))
+        return pic;
+
+    picture_Release(pic);
+    return NULL;
+}
+
+void hw_pool_GetStats(hw_pool_t *pool, struct hw_pool_stats *stats)
+{
+    vlc_mutex_lock(&pool->lock);
+    *stats = pool->stats;
+    vlc_mutex_unlock(&pool->lock);
+}
@@ -1,53 +1,79 @@
-/*****************************************************************************
- * hw_pool.h: hw based picture pool
- *****************************************************************************
- * Copyright (C) 2019-2020 VLC authors and VideoLAN
- *
- * Authors: Jai Luthra <me@jailuthra.in>
- *          Quentin Chateau <quentin.chateau@deepskycorp.com>
- *          Steve Lhomme <robux4@videolabs.io>
- *
- * This program is free software; you can redistribute it and/or modify it
- * under the terms of the GNU Lesser General Public License as published by
- * the Free Software Foundation; either version 2.1 of the License, or
- * (at your option) any later version.
- *
- * This program is distributed in the hope that it will be useful,
- * but WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
- * GNU Lesser General Public License for more details.
- *
- * You should have received a copy of the GNU Lesser General Public License
- * along with this program; if not, write to the Free Software Foundation,
- * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
- *****************************************************************************/
-#ifndef HW_POOL_H
-#define HW_POOL_H
-
-#include <vlc_picture.h>
-#include <vlc_codec.h>
-
-typedef struct hw_pool_t  hw_pool_t;
-typedef struct hw_pool_owner  hw_pool_owner_t;
-
-struct hw_pool_owner
-{
-    void *sys;
-    void (*release_resources)(hw_pool_owner_t *, void *buffers[], size_t pics_count);
-    picture_context_t * (*attach_picture)(hw_pool_owner_t *, hw_pool_t *, void *surface);
-};
-
-hw_pool_t* hw_pool_Create(hw_pool_owner_t *,
-                          const video_format_t *, vlc_video_context *,
-                          void *buffers[], size_t pics_count);
-void hw_pool_AddRef(hw_pool_t *);
-void hw_pool_Release(hw_pool_t *);
-
-/**
- * Wait for a new picture to be available from the pool.
- *
- * The picture.p_sys is always NULL.
- */
-picture_t* hw_pool_Wait(hw_pool_t *);
-
-#endif // HW_POOL_H
+/*****************************************************************************
+ * hw_pool.h: hw based picture pool
+ *****************************************************************************
+ * Copyright (C) 2019-2020 VLC authors and VideoLAN
+ *
+ * Authors: Jai Luthra <me@jailuthra.in>
+ *          Quentin Chateau <quentin.chateau@deepskycorp.com>
+ *          Steve Lhomme <robux4@videolabs.io>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef HW_POOL_H
+#define HW_POOL_H
+
+#include <vlc_picture.h>
+#include <vlc_codec.h>
+
+typedef struct hw_pool_t  hw_pool_t;
+typedef struct hw_pool_owner  hw_pool_owner_t;
+
+struct hw_pool_owner
+{
+    void *sys;
+    void (*release_resources)(hw_pool_owner_t *, void *buffers[], size_t pics_count);
+    picture_context_t * (*attach_picture)(hw_pool_owner_t *, hw_pool_t *, void *surface);
+    /* optional, to grow and shrink the pool while the owner is alive */
+    void * (*alloc_resource)(hw_pool_owner_t *);
+    void (*free_resource)(hw_pool_owner_t *, void *surface);
+};
+
+struct hw_pool_cfg
+{
+    size_t max_count;       /**< maximum number of surfaces, 0 for the initial count */
+    size_t surface_size;    /**< size of a surface in bytes */
+    uint64_t budget;        /**< process-wide memory budget in bytes, 0 for none */
+};
+
+struct hw_pool_stats
+{
+    size_t count;           /**< number of surfaces currently allocated */
+    size_t peak;            /**< highest number of surfaces allocated */
+    uint64_t waits;         /**< number of times a picture had to be waited for */
+    uint64_t denied;        /**< number of times the budget prevented growing */
+};
+
+hw_pool_t* hw_pool_Create(hw_pool_owner_t *,
+                          const video_format_t *, vlc_video_context *,
+                          void *buffers[], size_t pics_count,
+                          const struct hw_pool_cfg *);
+void hw_pool_AddRef(hw_pool_t *);
+void hw_pool_Release(hw_pool_t *);
+
+/**
+ * Wait for a new picture to be available from the pool.
+ *
+ * If all the surfaces are in use, a new one is allocated when the owner
+ * supports it and the count and memory budget allow, otherwise it waits
+ * for a picture to be released. Surfaces left unused for a while are freed
+ * down to the initial count.
+ *
+ * The picture.p_sys is private to the pool.
+ */
+picture_t* hw_pool_Wait(hw_pool_t *);
+
+void hw_pool_GetStats(hw_pool_t *, struct hw_pool_stats *);
+
+#endif // HW_POOL_H
@@ -51,6 +51,11 @@ static const char *const ppsz_deinterlace_type[] =
     N_("Disable"), N_("Bob"), N_("Adaptive")
 };
 
+#define VRAM_BUDGET_TEXT N_("Output surfaces memory budget (MiB)")
+#define VRAM_BUDGET_LONGTEXT N_( \
+    "Maximum GPU memory used by the output surfaces of all the NVDEC " \
+    "decoders, beyond their initial surfaces (0 for no limit)." )
+
 static const int ppsi_deinterlace_type[] = {
     cudaVideoDeinterlaceMode_Weave,
     cudaVideoDeinterlaceMode_Bob,
@@ -65,6 +70,9 @@ vlc_module_begin ()
     add_integer( "nvdec-deint", cudaVideoDeinterlaceMode_Bob,
                  DEINTERLACE_MODULE_TEXT, DEINTERLACE_MODULE_LONGTEXT )
         change_integer_list( ppsi_deinterlace_type, ppsz_deinterlace_type )
+    add_integer( "nvdec-vram-budget", 0,
+                 VRAM_BUDGET_TEXT, VRAM_BUDGET_LONGTEXT )
+        change_integer_range( 0, INT_MAX )
     set_callbacks(OpenDecoder, CloseDecoder)
     add_submodule()
         set_callback_dec_device(DecoderContextOpen, 3)
@@ -74,7 +82,8 @@ vlc_module_end ()
 /* */
 #define MAX_HXXX_SURFACES (16 + 1)
 #define NVDEC_DISPLAY_SURFACES 1
-#define MAX_POOL_SIZE     4 // number of in-flight buffers, if more are needed the decoder waits
+#define MIN_POOL_SIZE     2 // number of in-flight buffers allocated upfront
+#define MAX_POOL_SIZE     16 // if more are needed the decoder waits
 
 #define OUTPUT_WIDTH_ALIGN   16
 
@@ -104,6 +113,7 @@ struct nvdec_ctx {
     size_t                      decoderHeight;
 
     unsigned int                outputPitch;
+    size_t                      outputSurfaceSize;
     hw_pool_t                   *out_pool;
     hw_pool_owner_t             pool_owner;
 
@@ -126,6 +136,30 @@ static void PoolRelease(hw_pool_owner_t *owner, void *buffers[], size_t pics_cou
     free(p_sys);
 }
 
+static void *PoolAllocSurface(hw_pool_owner_t *owner)
+{
+    decoder_t *p_dec = owner->sys;
+    nvdec_ctx_t *p_sys = container_of(owner, nvdec_ctx_t, pool_owner);
+    decoder_device_nvdec_t *devsys = p_sys->devsys;
+    CUdeviceptr surface = 0;
+
+    if (CALL_CUDA_DEC(cuCtxPushCurrent, devsys->cuCtx) != VLC_SUCCESS)
+        return NULL;
+    if (CALL_CUDA_DEC(cuMemAlloc, &surface, p_sys->outputSurfaceSize) != VLC_SUCCESS)
+        surface = 0;
+    CALL_CUDA_DEC(cuCtxPopCurrent, NULL);
+
+    if (surface != 0)
+        msg_Dbg(p_dec, "output pool grown");
+    return (void*)(uintptr_t)surface;
+}
+
+static void PoolFreeSurface(hw_pool_owner_t *owner, void *surface)
+{
+    nvdec_ctx_t *p_sys = container_of(owner, nvdec_ctx_t, pool_owner);
+    p_sys->devsys->cudaFunctions->cuMemFree( (CUdeviceptr)surface );
+}
+
 static void nvdec_picture_CtxDestroy(struct picture_context_t *picctx)
 {
     pic_pool_context_nvdec_t *srcpic = NVDEC_PICPOOLCTX_FROM_PICCTX(picctx);
@@ -357,12 +391,14 @@ static int CUDAAPI HandleVideoSequence(void *p_opaque, CUVIDEOFORMAT *p_format)
         if (ret != CUDA_SUCCESS)
             goto cuda_error;
 
-        CUdeviceptr outputDevicePtr[MAX_POOL_SIZE];
+        p_sys->outputSurfaceSize = ByteWidth * Height;
+
+        CUdeviceptr outputDevicePtr[MIN_POOL_SIZE];
         for (size_t i=0; i < ARRAY_SIZE(outputDevicePtr); i++)
         {
             ret = CALL_CUDA_DEC(cuMemAlloc,
                                 &outputDevicePtr[i],
-                                ByteWidth * Height);
+                                p_sys->outputSurfaceSize);
             if (ret != CUDA_SUCCESS || outputDevicePtr[i] == 0)
             {
                 while (i)
@@ -377,14 +413,21 @@ static int CUDAAPI HandleVideoSequence(void *p_opaque, CUVIDEOFORMAT *p_format)
         {
             p_sys->pool_owner = (hw_pool_owner_t) {
                 p_dec, PoolRelease, PoolAttachPicture,
+                PoolAllocSurface, PoolFreeSurface,
             };
 
+            const struct hw_pool_cfg pool_cfg = {
+                .max_count = MAX_POOL_SIZE,
+                .surface_size = p_sys->outputSurfaceSize,
+                .budget = (uint64_t)var_InheritInteger(p_dec, "nvdec-vram-budget") << 20,
+            };
             void *bufferPtr[ARRAY_SIZE(outputDevicePtr)];
             for (size_t i=0; i<ARRAY_SIZE(outputDevicePtr); i++)
                 bufferPtr[i] = (void*)(uintptr_t)outputDevicePtr[i];
             p_sys->out_pool = hw_pool_Create(&p_sys->pool_owner,
                                              &p_dec->fmt_out.video, p_sys->vctx_out,
-                                             bufferPtr, ARRAY_SIZE(outputDevicePtr));
+                                             bufferPtr, ARRAY_SIZE(outputDevicePtr),
+                                             &pool_cfg);
             if (p_sys->out_pool == NULL)
                 PoolRelease(&p_sys->pool_owner, bufferPtr, ARRAY_SIZE(outputDevicePtr));
         }
@@ -1061,7 +1104,14 @@ static void CloseDecoder(vlc_object_t *p_this)
     if (p_sys->b_is_hxxx)
         hxxx_helper_clean(&p_sys->hh);
     if (p_sys->out_pool)
+    {
+        struct hw_pool_stats stats;
+        hw_pool_GetStats(p_sys->out_pool, &stats);
+        msg_Dbg(p_dec, "output pool: %zu surfaces (peak %zu), waited %"PRIu64
+                " times, %"PRIu64" times over budget",
+                stats.count, stats.peak, stats.waits, stats.denied);
         hw_pool_Release(p_sys->out_pool);
+    }
     else
     {
         cuvid_free_functions(&p_sys->cuvidFunctions);
@@ -1115,6 +1115,174 @@ error:
     return VLC_EGENERIC;
 }
 
+/*******************
+ * Scale functions *
+ *******************/
+
+static picture_t *
+Scale(filter_t * filter, picture_t * src)
+{
+    filter_sys_t *const filter_sys = filter->p_sys;
+    VABufferID          pipeline_buf = VA_INVALID_ID;
+    picture_t *const    dest = picture_pool_Wait(filter_sys->dest_pics);
+    if (!dest)
+        goto error;
+
+    vlc_vaapi_PicAttachContext(dest);
+    picture_CopyProperties(dest, src);
+
+    video_format_t const *const fmt_in = &filter->fmt_in.video;
+    video_format_t const *const fmt_out = &filter->fmt_out.video;
+    VARectangle const   surface_region = {
+        .x = fmt_in->i_x_offset, .y = fmt_in->i_y_offset,
+        .width = fmt_in->i_visible_width, .height = fmt_in->i_visible_height,
+    };
+    VARectangle const   output_region = {
+        .x = fmt_out->i_x_offset, .y = fmt_out->i_y_offset,
+        .width = fmt_out->i_visible_width, .height = fmt_out->i_visible_height,
+    };
+
+    /* No filter, the pipeline only scales */
+    VAProcPipelineParameterBuffer pipeline_params = {
+        .surface = vlc_vaapi_PicGetSurface(src),
+        .surface_region = &surface_region,
+        .output_region = &output_region,
+    };
+    if (filter_sys->b_pipeline_fast)
+        pipeline_params.pipeline_flags = VA_PROC_PIPELINE_FAST;
+
+    pipeline_buf =
+        vlc_vaapi_CreateBuffer(VLC_OBJECT(filter),
+                               filter_sys->va.dpy, filter_sys->va.ctx,
+                               VAProcPipelineParameterBufferType,
+                               sizeof(pipeline_params), 1, &pipeline_params);
+    if (pipeline_buf == VA_INVALID_ID)
+        goto error;
+
+    if (vlc_vaapi_BeginPicture(VLC_OBJECT(filter),
+                               filter_sys->va.dpy, filter_sys->va.ctx,
+                               vlc_vaapi_PicGetSurface(dest))
+     || vlc_vaapi_RenderPicture(VLC_OBJECT(filter),
+                                filter_sys->va.dpy, filter_sys->va.ctx,
+                                &pipeline_buf, 1)
+     || vlc_vaapi_EndPicture(VLC_OBJECT(filter),
+                             filter_sys->va.dpy, filter_sys->va.ctx))
+        goto error;
+
+    picture_Release(src);
+    return dest;
+
+error:
+    if (pipeline_buf != VA_INVALID_ID)
+        vlc_vaapi_DestroyBuffer(VLC_OBJECT(filter),
+                                filter_sys->va.dpy, pipeline_buf);
+    if (dest)
+        picture_Release(dest);
+    picture_Release(src);
+    return NULL;
+}
+
+static void
+CloseScale(filter_t *filter)
+{
+    filter_sys_t *const filter_sys = filter->p_sys;
+    vlc_object_t * obj = VLC_OBJECT(filter);
+
+    picture_pool_Release(filter_sys->dest_pics);
+    vlc_vaapi_DestroyContext(obj, filter_sys->va.dpy, filter_sys->va.ctx);
+    vlc_vaapi_DestroyConfig(obj, filter_sys->va.dpy, filter_sys->va.conf);
+    vlc_decoder_device_Release(filter_sys->va.dec_device);
+    vlc_video_context_Release(filter->vctx_out);
+    free(filter_sys);
+}
+
+static const struct vlc_filter_operations Scale_ops = {
+    .filter_video = Scale, .close = CloseScale,
+};
+
+/* Scales the surfaces on the GPU, so that they can be encoded without being
+ * downloaded */
+static int
+OpenScale(filter_t *filter)
+{
+    video_format_t const *const fmt_in = &filter->fmt_in.video;
+    video_format_t const *const fmt_out = &filter->fmt_out.video;
+
+    if (filter->vctx_in == NULL ||
+        vlc_video_context_GetType(filter->vctx_in) != VLC_VIDEO_CONTEXT_VAAPI ||
+        !vlc_vaapi_IsChromaOpaque(fmt_in->i_chroma) ||
+        fmt_in->i_chroma != fmt_out->i_chroma ||
+        fmt_in->orientation != fmt_out->orientation ||
+        (fmt_in->i_visible_width == fmt_out->i_visible_width &&
+         fmt_in->i_visible_height == fmt_out->i_visible_height))
+        return VLC_EGENERIC;
+
+    filter_sys_t *const filter_sys = calloc(1, sizeof(*filter_sys));
+    if (!filter_sys)
+        return VLC_ENOMEM;
+
+    filter_sys->va.conf = VA_INVALID_ID;
+    filter_sys->va.ctx = VA_INVALID_ID;
+    filter_sys->va.buf = VA_INVALID_ID;
+    filter_sys->va.dec_device = vlc_video_context_HoldDevice(filter->vctx_in);
+    assert(filter_sys->va.dec_device);
+    filter_sys->va.dpy = filter_sys->va.dec_device->opaque;
+
+    filter_sys->dest_pics =
+        vlc_vaapi_PoolNew(VLC_OBJECT(filter), filter->vctx_in,
+                          filter_sys->va.dpy, DEST_PICS_POOL_SZ,
+                          &filter_sys->va.surface_ids, fmt_out);
+    if (!filter_sys->dest_pics)
+        goto error;
+
+    filter_sys->va.conf =
+        vlc_vaapi_CreateConfigChecked(VLC_OBJECT(filter), filter_sys->va.dpy,
+                                      VAProfileNone, VAEntrypointVideoProc,
+                                      fmt_out->i_chroma);
+    if (filter_sys->va.conf == VA_INVALID_ID)
+        goto error;
+
+    filter_sys->va.ctx =
+        vlc_vaapi_CreateContext(VLC_OBJECT(filter),
+                                filter_sys->va.dpy, filter_sys->va.conf,
+                                fmt_out->i_width, fmt_out->i_height,
+                                0, filter_sys->va.surface_ids,
+                                DEST_PICS_POOL_SZ);
+    if (filter_sys->va.ctx == VA_INVALID_ID)
+        goto error;
+
+    VAProcPipelineCaps pipeline_caps;
+    if (vlc_vaapi_QueryVideoProcPipelineCaps(VLC_OBJECT(filter),
+                                             filter_sys->va.dpy,
+                                             filter_sys->va.ctx,
+                                             NULL, 0, &pipeline_caps))
+        goto error;
+    filter_sys->b_pipeline_fast =
+        pipeline_caps.pipeline_flags & VA_PROC_PIPELINE_FAST;
+
+    msg_Dbg(filter, "scaling %ux%u to %ux%u", fmt_in->i_visible_width,
+            fmt_in->i_visible_height, fmt_out->i_visible_width,
+            fmt_out->i_visible_height);
+
+    filter->p_sys = filter_sys;
+    filter->vctx_out = vlc_video_context_Hold(filter->vctx_in);
+    filter->ops = &Scale_ops;
+    return VLC_SUCCESS;
+
+error:
+    if (filter_sys->va.ctx != VA_INVALID_ID)
+        vlc_vaapi_DestroyContext(VLC_OBJECT(filter),
+                                 filter_sys->va.dpy, filter_sys->va.ctx);
+    if (filter_sys->va.conf != VA_INVALID_ID)
+        vlc_vaapi_DestroyConfig(VLC_OBJECT(filter),
+                                filter_sys->va.dpy, filter_sys->va.conf);
+    if (filter_sys->dest_pics)
+        picture_pool_Release(filter_sys->dest_pics);
+    vlc_decoder_device_Release(filter_sys->va.dec_device);
+    free(filter_sys);
+    return VLC_EGENERIC;
+}
+
 /*********************
  * Module descriptor *
  *********************/
@@ -1155,6 +1323,9 @@ vlc_module_begin()
     add_submodule()
     set_callback_video_converter(vlc_vaapi_OpenChroma, 10)
 
+    add_submodule()
+    set_callback_video_converter(OpenScale, 10)
+
     add_submodule()
         set_callback_chroma_conv_probe(ProbeChroma)
 vlc_module_end()
@@ -29,6 +29,10 @@
 
 void merge8_arm64(void *, const void *, const void *, size_t);
 void merge16_arm64(void *, const void *, const void *, size_t);
+void yadif_filter_line_arm64(uint8_t *, uint8_t *, uint8_t *, uint8_t *,
+                             int, int, int, int, int);
+void bwdif_filter_line_arm64(uint8_t *, const uint8_t *, const uint8_t *,
+                             const uint8_t *, int, ptrdiff_t, int);
 
 static void Probe(void *data)
 {
@@ -37,6 +41,8 @@ static void Probe(void *data)
 
         f->merges[0] = merge8_arm64;
         f->merges[1] = merge16_arm64;
+        f->yadif = yadif_filter_line_arm64;
+        f->bwdif = bwdif_filter_line_arm64;
     }
 }
 
@@ -0,0 +1,189 @@
+/*****************************************************************************
+ * yuv_rgb.c : AArch64 Advanced SIMD YUV to RGB conversions
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+#include <vlc_chroma_probe.h>
+#include <vlc_cpu.h>
+
+typedef void (*yuv_rgb_func)(void *, const void *, const void *, const void *,
+                             size_t);
+
+void yuv420_xrgb_arm64(void *, const void *, const void *, const void *,
+                       size_t);
+void yuv420_rgbx_arm64(void *, const void *, const void *, const void *,
+                       size_t);
+void yuv420_bgrx_arm64(void *, const void *, const void *, const void *,
+                       size_t);
+void yuv420_xbgr_arm64(void *, const void *, const void *, const void *,
+                       size_t);
+void yuv420_rgb24_arm64(void *, const void *, const void *, const void *,
+                        size_t);
+void yuv420_bgr24_arm64(void *, const void *, const void *, const void *,
+                        size_t);
+void yuv420_rgb565_arm64(void *, const void *, const void *, const void *,
+                         size_t);
+
+/* Pixels converted at once by the assembly functions */
+#define BLOCK 16
+
+static int Open(filter_t *);
+
+static void ProbeChroma(vlc_chroma_conv_vec *vec)
+{
+#define OUT_CHROMAS VLC_CODEC_XRGB, VLC_CODEC_RGBX, VLC_CODEC_BGRX, \
+    VLC_CODEC_XBGR, VLC_CODEC_RGB24, VLC_CODEC_BGR24, VLC_CODEC_RGB565LE
+    vlc_chroma_conv_add_in_outlist(vec, 0.75, VLC_CODEC_I420, OUT_CHROMAS);
+    vlc_chroma_conv_add_in_outlist(vec, 0.75, VLC_CODEC_YV12, OUT_CHROMAS);
+}
+
+vlc_module_begin ()
+    set_description(N_("AArch64 AdvSIMD video chroma YUV->RGB"))
+    set_callback_video_converter(Open, 250)
+    add_submodule()
+        set_callback_chroma_conv_probe(ProbeChroma)
+vlc_module_end ()
+
+typedef struct
+{
+    yuv_rgb_func convert;
+    unsigned pixel_size;
+    bool swap_uv;
+} filter_sys_t;
+
+static void Convert(filter_t *filter, picture_t *src, picture_t *dst)
+{
+    const filter_sys_t *sys = filter->p_sys;
+    const size_t width = filter->fmt_in.video.i_x_offset
+                       + filter->fmt_in.video.i_visible_width;
+    const unsigned height = filter->fmt_in.video.i_y_offset
+                          + filter->fmt_in.video.i_visible_height;
+    const plane_t *yp = &src->p[Y_PLANE];
+    const plane_t *up = &src->p[sys->swap_uv ? V_PLANE : U_PLANE];
+    const plane_t *vp = &src->p[sys->swap_uv ? U_PLANE : V_PLANE];
+    const size_t tail = width % BLOCK;
+
+    for (unsigned i = 0; i < height; i++)
+    {
+        const uint8_t *py = yp->p_pixels + i * yp->i_pitch;
+        const uint8_t *pu = up->p_pixels + (i / 2) * up->i_pitch;
+        const uint8_t *pv = vp->p_pixels + (i / 2) * vp->i_pitch;
+        uint8_t *out = dst->p->p_pixels + i * dst->p->i_pitch;
+
+        sys->convert(out, py, pu, pv, width - tail);
+
+        /* Convert the remaining pixels again with the last block.
+         * The width is even, so the chroma samples stay aligned. */
+        if (tail)
+        {
+            const size_t x = width - BLOCK;
+
+            sys->convert(out + x * sys->pixel_size, py + x, pu + x / 2,
+                         pv + x / 2, BLOCK);
+        }
+    }
+}
+
+VIDEO_FILTER_WRAPPER_CLOSE(Convert, Close)
+
+static void Close(filter_t *filter)
+{
+    free(filter->p_sys);
+}
+
+static int Open(filter_t *filter)
+{
+    const video_format_t *in = &filter->fmt_in.video;
+    const video_format_t *out = &filter->fmt_out.video;
+
+    if (!vlc_CPU_ARM_NEON())
+        return VLC_EGENERIC;
+
+    if (in->i_chroma != VLC_CODEC_I420 && in->i_chroma != VLC_CODEC_YV12)
+        return VLC_EGENERIC;
+
+    if (((in->i_x_offset + in->i_visible_width) & 1)
+     || in->i_x_offset + in->i_visible_width < BLOCK
+     || in->i_x_offset != out->i_x_offset
+     || in->i_y_offset != out->i_y_offset
+     || in->i_visible_width != out->i_visible_width
+     || in->i_visible_height != out->i_visible_height
+     || in->orientation != out->orientation)
+        return VLC_EGENERIC;
+
+    yuv_rgb_func convert;
+    unsigned pixel_size;
+
+    switch (out->i_chroma)
+    {
+        case VLC_CODEC_XRGB:
+            convert = yuv420_xrgb_arm64;
+            pixel_size = 4;
+            break;
+        case VLC_CODEC_RGBX:
+            convert = yuv420_rgbx_arm64;
+            pixel_size = 4;
+            break;
+        case VLC_CODEC_BGRX:
+            convert = yuv420_bgrx_arm64;
+            pixel_size = 4;
+            break;
+        case VLC_CODEC_XBGR:
+            convert = yuv420_xbgr_arm64;
+            pixel_size = 4;
+            break;
+        case VLC_CODEC_RGB24:
+            convert = yuv420_rgb24_arm64;
+            pixel_size = 3;
+            break;
+        case VLC_CODEC_BGR24:
+            convert = yuv420_bgr24_arm64;
+            pixel_size = 3;
+            break;
+        case VLC_CODEC_RGB565LE:
+            convert = yuv420_rgb565_arm64;
+            pixel_size = 2;
+            break;
+        default:
+            return VLC_EGENERIC;
+    }
+
+    filter_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    sys->convert = convert;
+    sys->pixel_size = pixel_size;
+    sys->swap_uv = in->i_chroma == VLC_CODEC_YV12;
+    filter->p_sys = sys;
+    filter->ops = &Convert_ops;
+
+    msg_Dbg(filter, "%4.4s(%ux%u) to %4.4s(%ux%u)",
+            (char *)&in->i_chroma, in->i_visible_width, in->i_visible_height,
+            (char *)&out->i_chroma, out->i_visible_width,
+            out->i_visible_height);
+    return VLC_SUCCESS;
+}
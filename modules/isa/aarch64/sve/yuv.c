@@ -0,0 +1,226 @@
+/*****************************************************************************
+ * yuv.c: AArch64 SVE packed YUV conversions
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+#include <vlc_chroma_probe.h>
+#include <vlc_cpu.h>
+
+typedef void (*pack_func)(void *, const void *, const void *, const void *,
+                          size_t);
+typedef void (*unpack_func)(const void *, void *, void *, void *, size_t);
+typedef void (*luma_func)(void *, const void *, size_t);
+
+void yuv_yuyv_arm_sve(void *, const void *, const void *, const void *, size_t);
+void yuv_uyvy_arm_sve(void *, const void *, const void *, const void *, size_t);
+void yuv_yvyu_arm_sve(void *, const void *, const void *, const void *, size_t);
+void yuyv_yuv_arm_sve(const void *, void *, void *, void *, size_t);
+void uyvy_yuv_arm_sve(const void *, void *, void *, void *, size_t);
+void yvyu_yuv_arm_sve(const void *, void *, void *, void *, size_t);
+void yuyv_y_arm_sve(void *, const void *, size_t);
+void uyvy_y_arm_sve(void *, const void *, size_t);
+
+static int Open(filter_t *);
+
+static void ProbeChroma(vlc_chroma_conv_vec *vec)
+{
+#define PACKED_CHROMAS VLC_CODEC_YUYV, VLC_CODEC_YVYU, VLC_CODEC_UYVY
+    vlc_chroma_conv_add_in_outlist(vec, 0.75, VLC_CODEC_I420, PACKED_CHROMAS);
+    vlc_chroma_conv_add_in_outlist(vec, 0.75, VLC_CODEC_YV12, PACKED_CHROMAS);
+    vlc_chroma_conv_add_in_outlist(vec, 0.75, VLC_CODEC_YUYV, VLC_CODEC_I420,
+                                   VLC_CODEC_YV12);
+    vlc_chroma_conv_add_in_outlist(vec, 0.75, VLC_CODEC_YVYU, VLC_CODEC_I420,
+                                   VLC_CODEC_YV12);
+    vlc_chroma_conv_add_in_outlist(vec, 0.75, VLC_CODEC_UYVY, VLC_CODEC_I420,
+                                   VLC_CODEC_YV12);
+}
+
+vlc_module_begin ()
+    set_description(N_("AArch64 SVE video chroma YUV conversions"))
+    set_callback_video_converter(Open, 250)
+    add_submodule()
+        set_callback_chroma_conv_probe(ProbeChroma)
+vlc_module_end ()
+
+typedef struct
+{
+    union
+    {
+        pack_func pack;
+        struct
+        {
+            unpack_func unpack;
+            luma_func luma;
+        };
+    };
+    bool swap_uv;
+} filter_sys_t;
+
+static void GetSize(filter_t *filter, size_t *width, unsigned *height)
+{
+    *width = filter->fmt_in.video.i_x_offset
+           + filter->fmt_in.video.i_visible_width;
+    *height = filter->fmt_in.video.i_y_offset
+            + filter->fmt_in.video.i_visible_height;
+}
+
+/* planar 4:2:0 to packed 4:2:2, each chroma line is used twice */
+static void Pack(filter_t *filter, picture_t *src, picture_t *dst)
+{
+    const filter_sys_t *sys = filter->p_sys;
+    const plane_t *yp = &src->p[Y_PLANE];
+    const plane_t *up = &src->p[sys->swap_uv ? V_PLANE : U_PLANE];
+    const plane_t *vp = &src->p[sys->swap_uv ? U_PLANE : V_PLANE];
+    size_t width;
+    unsigned height;
+
+    GetSize(filter, &width, &height);
+
+    for (unsigned i = 0; i < height; i++)
+        sys->pack(dst->p->p_pixels + i * dst->p->i_pitch,
+                  yp->p_pixels + i * yp->i_pitch,
+                  up->p_pixels + (i / 2) * up->i_pitch,
+                  vp->p_pixels + (i / 2) * vp->i_pitch, width);
+}
+
+/* packed 4:2:2 to planar 4:2:0, the chroma of the odd lines is dropped */
+static void Unpack(filter_t *filter, picture_t *src, picture_t *dst)
+{
+    const filter_sys_t *sys = filter->p_sys;
+    const plane_t *yp = &dst->p[Y_PLANE];
+    const plane_t *up = &dst->p[sys->swap_uv ? V_PLANE : U_PLANE];
+    const plane_t *vp = &dst->p[sys->swap_uv ? U_PLANE : V_PLANE];
+    size_t width;
+    unsigned height;
+
+    GetSize(filter, &width, &height);
+
+    for (unsigned i = 0; i < height; i++)
+    {
+        const uint8_t *in = src->p->p_pixels + i * src->p->i_pitch;
+        uint8_t *py = yp->p_pixels + i * yp->i_pitch;
+
+        if (i & 1)
+            sys->luma(py, in, width);
+        else
+            sys->unpack(in, py, up->p_pixels + (i / 2) * up->i_pitch,
+                        vp->p_pixels + (i / 2) * vp->i_pitch, width);
+    }
+}
+
+static void Close(filter_t *filter)
+{
+    free(filter->p_sys);
+}
+
+VIDEO_FILTER_WRAPPER_CLOSE(Pack, Close)
+VIDEO_FILTER_WRAPPER_CLOSE(Unpack, Close)
+
+static int Open(filter_t *filter)
+{
+    const video_format_t *in = &filter->fmt_in.video;
+    const video_format_t *out = &filter->fmt_out.video;
+
+    if (!vlc_CPU_ARM_SVE())
+        return VLC_EGENERIC;
+
+    /* the chroma is subsampled by 2 in both ways on one side */
+    if (((in->i_x_offset + in->i_visible_width) & 1)
+     || ((in->i_y_offset + in->i_visible_height) & 1)
+     || in->i_x_offset + in->i_visible_width == 0
+     || in->i_x_offset != out->i_x_offset
+     || in->i_y_offset != out->i_y_offset
+     || in->i_visible_width != out->i_visible_width
+     || in->i_visible_height != out->i_visible_height
+     || in->orientation != out->orientation)
+        return VLC_EGENERIC;
+
+    filter_sys_t sys = { .swap_uv = false };
+    const struct vlc_filter_operations *ops;
+
+    switch (in->i_chroma)
+    {
+        case VLC_CODEC_YV12:
+            sys.swap_uv = true;
+            /* fall through */
+        case VLC_CODEC_I420:
+            switch (out->i_chroma)
+            {
+                case VLC_CODEC_YUYV:
+                    sys.pack = yuv_yuyv_arm_sve;
+                    break;
+                case VLC_CODEC_UYVY:
+                    sys.pack = yuv_uyvy_arm_sve;
+                    break;
+                case VLC_CODEC_YVYU:
+                    sys.pack = yuv_yvyu_arm_sve;
+                    break;
+                default:
+                    return VLC_EGENERIC;
+            }
+            ops = &Pack_ops;
+            break;
+
+        case VLC_CODEC_YUYV:
+        case VLC_CODEC_UYVY:
+        case VLC_CODEC_YVYU:
+            if (out->i_chroma == VLC_CODEC_YV12)
+                sys.swap_uv = true;
+            else if (out->i_chroma != VLC_CODEC_I420)
+                return VLC_EGENERIC;
+
+            if (in->i_chroma == VLC_CODEC_UYVY)
+            {
+                sys.unpack = uyvy_yuv_arm_sve;
+                sys.luma = uyvy_y_arm_sve;
+            }
+            else
+            {
+                sys.unpack = in->i_chroma == VLC_CODEC_YUYV ? yuyv_yuv_arm_sve
+                                                            : yvyu_yuv_arm_sve;
+                sys.luma = yuyv_y_arm_sve; /* same luma positions */
+            }
+            ops = &Unpack_ops;
+            break;
+
+        default:
+            return VLC_EGENERIC;
+    }
+
+    filter_sys_t *p_sys = malloc(sizeof (*p_sys));
+    if (unlikely(p_sys == NULL))
+        return VLC_ENOMEM;
+
+    *p_sys = sys;
+    filter->p_sys = p_sys;
+    filter->ops = ops;
+
+    msg_Dbg(filter, "%4.4s(%ux%u) to %4.4s(%ux%u)",
+            (char *)&in->i_chroma, in->i_visible_width, in->i_visible_height,
+            (char *)&out->i_chroma, out->i_visible_width,
+            out->i_visible_height);
+    return VLC_SUCCESS;
+}
@@ -0,0 +1,451 @@
+/*****************************************************************************
+ * chrome.c: binary tracer plugin with Chrome trace export
+ *****************************************************************************
+ * Copyright © 2024 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Traces are recorded in binary form into preallocated ring buffers, and only
+ * converted to text when the tracer is closed. The output file uses the
+ * Chrome trace event JSON format, which can be opened with Perfetto
+ * (ui.perfetto.dev) or chrome://tracing.
+ *
+ * Each thread is mapped to one of several buffers, so that threads do not
+ * contend on a single lock. Keys and string values are interned in a
+ * per-buffer string table: string values are usually identifiers that do
+ * not outlive the traced objects, so they cannot be kept by reference.
+ * When a buffer is full, the oldest records are overwritten.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_configuration.h>
+#include <vlc_plugin.h>
+#include <vlc_fs.h>
+#include <vlc_charset.h>
+#include <vlc_tracer.h>
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+
+#define CHROME_FILENAME "vlc-trace.json"
+
+#define CHROME_BUFFERS 16 /* must be a power of two */
+#define CHROME_FIELDS 8
+#define CHROME_STRINGS 4096 /* per buffer, must be a power of two */
+#define CHROME_NO_STRING UINT32_MAX
+
+struct chrome_field
+{
+    uint32_t key;
+    uint32_t type;
+    union {
+        int64_t integer;
+        uint64_t uinteger;
+        double double_;
+        uint32_t string;
+    };
+};
+
+struct chrome_record
+{
+    vlc_tick_t ts;
+    unsigned long tid;
+    unsigned count;
+    struct chrome_field fields[CHROME_FIELDS];
+};
+
+struct chrome_buffer
+{
+    vlc_mutex_t lock;
+    size_t next; /* total count of records written */
+    uint64_t dropped_strings;
+    struct chrome_record *records;
+    /* String table */
+    uint32_t string_count;
+    uint32_t string_index[CHROME_STRINGS]; /* open addressing, hash to id */
+    char *strings[CHROME_STRINGS];
+};
+
+typedef struct
+{
+    FILE *stream;
+    size_t capacity; /* records per buffer */
+    struct chrome_buffer buffers[CHROME_BUFFERS];
+} vlc_tracer_sys_t;
+
+static uint32_t Hash(const char *str)
+{
+    /* FNV-1a */
+    uint32_t hash = 2166136261u;
+
+    for (const unsigned char *p = (const unsigned char *)str; *p; p++)
+        hash = (hash ^ *p) * 16777619u;
+    return hash;
+}
+
+static uint32_t Intern(struct chrome_buffer *buf, const char *str)
+{
+    uint32_t mask = CHROME_STRINGS - 1;
+
+    for (uint32_t i = Hash(str) & mask;; i = (i + 1) & mask)
+    {
+        uint32_t id = buf->string_index[i];
+
+        if (id == CHROME_NO_STRING)
+        {   /* Not found: add it, keeping the table at most half full */
+            if (buf->string_count >= CHROME_STRINGS / 2)
+                break;
+
+            char *dup = strdup(str);
+            if (unlikely(dup == NULL))
+                break;
+
+            id = buf->string_count++;
+            buf->strings[id] = dup;
+            buf->string_index[i] = id;
+            return id;
+        }
+
+        if (strcmp(buf->strings[id], str) == 0)
+            return id;
+    }
+
+    buf->dropped_strings++;
+    return CHROME_NO_STRING;
+}
+
+static void TraceChrome(void *opaque, vlc_tick_t ts,
+                        const struct vlc_tracer_trace *trace)
+{
+    vlc_tracer_sys_t *sys = opaque;
+    unsigned long tid = vlc_thread_id();
+    struct chrome_buffer *buf = &sys->buffers[tid & (CHROME_BUFFERS - 1)];
+
+    vlc_mutex_lock(&buf->lock);
+
+    struct chrome_record *rec = &buf->records[buf->next % sys->capacity];
+    unsigned count = 0;
+
+    rec->ts = ts;
+    rec->tid = tid;
+
+    for (const struct vlc_tracer_entry *entry = trace->entries;
+         entry->key != NULL && count < CHROME_FIELDS; entry++)
+    {
+        struct chrome_field *field = &rec->fields[count];
+
+        field->key = Intern(buf, entry->key);
+        if (field->key == CHROME_NO_STRING)
+            continue;
+
+        field->type = entry->type;
+        switch (entry->type)
+        {
+            case VLC_TRACER_INT:
+                field->integer = entry->value.integer;
+                break;
+            case VLC_TRACER_UINT:
+                field->uinteger = entry->value.uinteger;
+                break;
+            case VLC_TRACER_DOUBLE:
+                field->double_ = entry->value.double_;
+                break;
+            case VLC_TRACER_STRING:
+                field->string = Intern(buf, entry->value.string != NULL
+                                            ? entry->value.string : "");
+                break;
+            default:
+                vlc_assert_unreachable();
+        }
+        count++;
+    }
+
+    rec->count = count;
+    buf->next++;
+    vlc_mutex_unlock(&buf->lock);
+}
+
+static void JsonPrintString(FILE *stream, const char *str)
+{
+    if (str == NULL || !IsUTF8(str))
+    {
+        fputs("\"?\"", stream);
+        return;
+    }
+
+    fputc('\"', stream);
+    for (const unsigned char *p = (const unsigned char *)str; *p; p++)
+    {
+        if (*p == '\"' || *p == '\\')
+            fprintf(stream, "\\%c", *p);
+        else if (*p <= 0x1F || *p == 0x7F)
+            fprintf(stream, "\\u%04x", *p);
+        else
+            fputc(*p, stream);
+    }
+    fputc('\"', stream);
+}
+
+struct chrome_event
+{
+    const struct chrome_buffer *buf;
+    const struct chrome_record *rec;
+};
+
+static int EventCmp(const void *a, const void *b)
+{
+    const struct chrome_event *ea = a, *eb = b;
+
+    return (ea->rec->ts > eb->rec->ts) - (ea->rec->ts < eb->rec->ts);
+}
+
+static const char *FieldString(const struct chrome_buffer *buf,
+                               const struct chrome_field *field)
+{
+    if (field->type != VLC_TRACER_STRING || field->string == CHROME_NO_STRING)
+        return NULL;
+    return buf->strings[field->string];
+}
+
+static const char *RecordLookup(const struct chrome_buffer *buf,
+                                const struct chrome_record *rec,
+                                const char *key)
+{
+    for (unsigned i = 0; i < rec->count; i++)
+        if (strcmp(buf->strings[rec->fields[i].key], key) == 0)
+            return FieldString(buf, &rec->fields[i]);
+    return NULL;
+}
+
+static void WriteEvent(FILE *stream, const struct chrome_buffer *buf,
+                       const struct chrome_record *rec)
+{
+    const char *cat = RecordLookup(buf, rec, "type");
+    const char *name = RecordLookup(buf, rec, "event");
+    const char *id = RecordLookup(buf, rec, "id");
+
+    if (cat == NULL)
+        cat = "trace";
+    if (name == NULL)
+        name = cat;
+
+    fputs("{\"name\":", stream);
+    if (id != NULL)
+    {
+        char *full;
+        if (asprintf(&full, "%s %s", id, name) >= 0)
+        {
+            JsonPrintString(stream, full);
+            free(full);
+        }
+        else
+            JsonPrintString(stream, name);
+    }
+    else
+        JsonPrintString(stream, name);
+
+    fputs(",\"cat\":", stream);
+    JsonPrintString(stream, cat);
+    fprintf(stream, ",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%lu,"
+            "\"ts\":%"PRId64",\"args\":{", rec->tid, US_FROM_VLC_TICK(rec->ts));
+
+    for (unsigned i = 0; i < rec->count; i++)
+    {
+        const struct chrome_field *field = &rec->fields[i];
+
+        if (i > 0)
+            fputc(',', stream);
+        JsonPrintString(stream, buf->strings[field->key]);
+        fputc(':', stream);
+
+        switch (field->type)
+        {
+            case VLC_TRACER_INT:
+                fprintf(stream, "%"PRId64, field->integer);
+                break;
+            case VLC_TRACER_UINT:
+                fprintf(stream, "%"PRIu64, field->uinteger);
+                break;
+            case VLC_TRACER_DOUBLE:
+                vlc_fprintf_c(stream, "%.17g", field->double_);
+                break;
+            case VLC_TRACER_STRING:
+                JsonPrintString(stream, FieldString(buf, field));
+                break;
+        }
+    }
+    fputs("}}", stream);
+}
+
+static void Dump(vlc_tracer_sys_t *sys)
+{
+    size_t total = 0;
+
+    for (size_t i = 0; i < CHROME_BUFFERS; i++)
+    {
+        size_t next = sys->buffers[i].next;
+        total += (next < sys->capacity) ? next : sys->capacity;
+    }
+
+    struct chrome_event *events = vlc_alloc(total, sizeof (*events));
+    if (unlikely(events == NULL))
+        return;
+
+    size_t n = 0;
+    uint64_t overwritten = 0, dropped_strings = 0;
+
+    for (size_t i = 0; i < CHROME_BUFFERS; i++)
+    {
+        const struct chrome_buffer *buf = &sys->buffers[i];
+        size_t first = 0;
+
+        if (buf->next > sys->capacity)
+        {
+            first = buf->next - sys->capacity;
+            overwritten += first;
+        }
+        dropped_strings += buf->dropped_strings;
+
+        for (size_t j = first; j < buf->next; j++)
+        {
+            events[n].buf = buf;
+            events[n].rec = &buf->records[j % sys->capacity];
+            n++;
+        }
+    }
+    assert(n == total);
+
+    qsort(events, n, sizeof (*events), EventCmp);
+
+    fputs("{\"traceEvents\":[\n", sys->stream);
+    for (size_t i = 0; i < n; i++)
+    {
+        if (i > 0)
+            fputs(",\n", sys->stream);
+        WriteEvent(sys->stream, events[i].buf, events[i].rec);
+    }
+    fprintf(sys->stream, "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{"
+            "\"overwritten\":%"PRIu64",\"dropped_strings\":%"PRIu64"}}\n",
+            overwritten, dropped_strings);
+    free(events);
+}
+
+static void Close(void *opaque)
+{
+    vlc_tracer_sys_t *sys = opaque;
+
+    Dump(sys);
+    fclose(sys->stream);
+
+    for (size_t i = 0; i < CHROME_BUFFERS; i++)
+    {
+        struct chrome_buffer *buf = &sys->buffers[i];
+
+        for (uint32_t j = 0; j < buf->string_count; j++)
+            free(buf->strings[j]);
+        free(buf->records);
+    }
+    free(sys);
+}
+
+static const struct vlc_tracer_operations chrome_ops =
+{
+    TraceChrome,
+    Close
+};
+
+static const struct vlc_tracer_operations *Open(vlc_object_t *obj,
+                                               void **restrict sysp)
+{
+    vlc_tracer_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return NULL;
+
+    int64_t size = var_InheritInteger(obj, "chrome-tracer-size");
+    sys->capacity = (size * 1024 * 1024)
+                  / (CHROME_BUFFERS * sizeof (struct chrome_record));
+    if (sys->capacity == 0)
+        sys->capacity = 1;
+
+    for (size_t i = 0; i < CHROME_BUFFERS; i++)
+    {
+        struct chrome_buffer *buf = &sys->buffers[i];
+
+        vlc_mutex_init(&buf->lock);
+        buf->next = 0;
+        buf->dropped_strings = 0;
+        buf->string_count = 0;
+        memset(buf->string_index, 0xFF, sizeof (buf->string_index));
+        buf->records = vlc_alloc(sys->capacity, sizeof (*buf->records));
+        if (unlikely(buf->records == NULL))
+        {
+            while (i > 0)
+                free(sys->buffers[--i].records);
+            free(sys);
+            return NULL;
+        }
+    }
+
+    const char *filename = CHROME_FILENAME;
+    char *path = var_InheritString(obj, "chrome-tracer-file");
+    if (path != NULL)
+        filename = path;
+
+    msg_Dbg(obj, "opening trace file `%s'", filename);
+    sys->stream = vlc_fopen(filename, "wt");
+    if (sys->stream == NULL)
+    {
+        msg_Err(obj, "error opening trace file `%s': %s", filename,
+                vlc_strerror_c(errno));
+        free(path);
+        for (size_t i = 0; i < CHROME_BUFFERS; i++)
+            free(sys->buffers[i].records);
+        free(sys);
+        return NULL;
+    }
+    free(path);
+
+    *sysp = sys;
+    return &chrome_ops;
+}
+
+#define TRACEFILE_NAME_TEXT N_("Trace filename")
+#define TRACEFILE_NAME_LONGTEXT N_("Specify the trace filename.")
+#define TRACE_SIZE_TEXT N_("Trace buffer size (MiB)")
+#define TRACE_SIZE_LONGTEXT N_( \
+    "Memory allocated to record traces. When full, the oldest traces are " \
+    "overwritten.")
+
+vlc_module_begin()
+    set_shortname(N_("Chrome tracer"))
+    set_description(N_("Binary tracer with Chrome trace export"))
+    set_subcategory(SUBCAT_ADVANCED_MISC)
+    set_capability("tracer", 0)
+    set_callback(Open)
+
+    add_savefile("chrome-tracer-file", NULL, TRACEFILE_NAME_TEXT,
+                 TRACEFILE_NAME_LONGTEXT)
+    add_integer_with_range("chrome-tracer-size", 64, 1, 4096,
+                           TRACE_SIZE_TEXT, TRACE_SIZE_LONGTEXT)
+vlc_module_end()
@@ -15,11 +15,23 @@
 // along with this program; if not, write to the Free Software Foundation,
 // Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
 
-use std::{cell::UnsafeCell, sync::Mutex};
+use std::{
+    sync::atomic::{AtomicU64, Ordering},
+    sync::mpsc::{self, Receiver, RecvTimeoutError, SyncSender, TrySendError},
+    thread::JoinHandle,
+    time::{Duration, Instant},
+};
 use telegraf::{Client, IntoFieldData};
 use vlcrs_core::tracer::{TraceValue, TracerCapability, TracerModuleLoader};
 use vlcrs_macros::module;
 
+/// Points waiting to be sent, the traces are dropped beyond.
+const QUEUE_SIZE: usize = 4096;
+/// Points sent at once to the endpoint.
+const BATCH_SIZE: usize = 256;
+/// Longest delay before the queued points are sent.
+const FLUSH_INTERVAL: Duration = Duration::from_secs(1);
+
 struct TraceValueWrapper<'a>(TraceValue<'a>);
 
 impl<'a> IntoFieldData for TraceValueWrapper<'a> {
@@ -33,8 +45,57 @@ impl<'a> IntoFieldData for TraceValueWrapper<'a> {
     }
 }
 
+fn report_error(err: telegraf::TelegrafError) {
+    match err {
+        telegraf::TelegrafError::IoError(e) => eprintln!("telegraf tracer: IO error: {}", e),
+        telegraf::TelegrafError::ConnectionError(s) => {
+            eprintln!("telegraf tracer: connection error: {}", s)
+        }
+        telegraf::TelegrafError::BadProtocol(s) => {
+            eprintln!("telegraf tracer: bad protocol: {}", s)
+        }
+    }
+}
+
+/// Sends the queued points by batches, until the tracer is destroyed.
+fn run(mut client: Client, points: Receiver<telegraf::Point>) {
+    let mut batch = Vec::with_capacity(BATCH_SIZE);
+    let mut deadline = Instant::now() + FLUSH_INTERVAL;
+
+    loop {
+        let timeout = deadline.saturating_duration_since(Instant::now());
+        let done = match points.recv_timeout(timeout) {
+            Ok(point) => {
+                batch.push(point);
+                if batch.len() < BATCH_SIZE {
+                    continue;
+                }
+                false
+            }
+            Err(RecvTimeoutError::Timeout) => false,
+            Err(RecvTimeoutError::Disconnected) => true,
+        };
+
+        if !batch.is_empty() {
+            if let Err(err) = client.write_points(&batch) {
+                report_error(err);
+            }
+            batch.clear();
+        }
+
+        if done {
+            return;
+        }
+        deadline = Instant::now() + FLUSH_INTERVAL;
+    }
+}
+
 struct TelegrafTracer {
-    endpoint: Mutex<UnsafeCell<telegraf::Client>>,
+    /// Trace types to forward, all of them if empty.
+    types: Vec<String>,
+    queue: Option<SyncSender<telegraf::Point>>,
+    worker: Option<JoinHandle<()>>,
+    dropped: AtomicU64,
 }
 
 impl TracerCapability for TelegrafTracer {
@@ -44,22 +105,54 @@ impl TracerCapability for TelegrafTracer {
     {
         let endpoint_address =
             std::env::var("VLC_TELEGRAF_ENDPOINT").unwrap_or(String::from("tcp://localhost:8094"));
-        let endpoint = Client::new(&endpoint_address)
-            .map(UnsafeCell::new)
-            .map(Mutex::new)
-            .unwrap();
-        Some(Self { endpoint })
+        /* e.g. "STATS,MODULE" to only publish the periodic metrics */
+        let types = std::env::var("VLC_TELEGRAF_TYPES")
+            .map(|list| {
+                list.split(',')
+                    .filter(|t| !t.is_empty())
+                    .map(String::from)
+                    .collect()
+            })
+            .unwrap_or_default();
+
+        let client = match Client::new(&endpoint_address) {
+            Ok(client) => client,
+            Err(err) => {
+                report_error(err);
+                return None;
+            }
+        };
+
+        let (queue, points) = mpsc::sync_channel(QUEUE_SIZE);
+        let worker = std::thread::Builder::new()
+            .name(String::from("vlc-telegraf"))
+            .spawn(move || run(client, points))
+            .ok()?;
+
+        Some(Self {
+            types,
+            queue: Some(queue),
+            worker: Some(worker),
+            dropped: AtomicU64::new(0),
+        })
     }
 
     fn trace(&self, _tick: vlcrs_core::tracer::Tick, trace: &vlcrs_core::tracer::Trace) {
+        let mut measurement = None;
         let (tags, records) = trace.entries().fold(
             (Vec::new(), Vec::new()),
             |(mut tags, mut records), entry| {
-                let name = String::from(entry.key);
                 if let TraceValue::String(value) = entry.value {
-                    let value = String::from(value);
-                    tags.push(telegraf::protocol::Tag { name, value });
+                    /* The trace type names the series */
+                    if entry.key == "type" && measurement.is_none() {
+                        measurement = Some(String::from(value));
+                    } else {
+                        let name = String::from(entry.key);
+                        let value = String::from(value);
+                        tags.push(telegraf::protocol::Tag { name, value });
+                    }
                 } else {
+                    let name = String::from(entry.key);
                     let value = TraceValueWrapper(entry.value).field_data();
                     records.push(telegraf::protocol::Field { name, value });
                 }
@@ -73,22 +166,37 @@ impl TracerCapability for TelegrafTracer {
             return;
         }
 
+        let measurement = measurement.unwrap_or_else(|| String::from("measurement"));
+        if !self.types.is_empty() && !self.types.contains(&measurement) {
+            return;
+        }
+
         let p = telegraf::Point {
-            measurement: String::from("measurement"),
+            measurement,
             tags,
             fields: records,
             timestamp: None, //Some(tick.0 as u64),
         };
 
-        let mut endpoint = self.endpoint.lock().unwrap();
-        if let Err(err) = endpoint.get_mut().write_point(&p) {
-            match err {
-                telegraf::TelegrafError::IoError(e) => eprintln!("TelegrafTracer: IO Error: {}", e),
-                telegraf::TelegrafError::ConnectionError(s) => {
-                    eprintln!("telegraf tracer: connection error: {}", s)
-                }
-                telegraf::TelegrafError::BadProtocol(_) => todo!(),
-            }
+        /* Never block the traced thread on the network */
+        let queue = self.queue.as_ref().unwrap();
+        if let Err(TrySendError::Full(_)) = queue.try_send(p) {
+            self.dropped.fetch_add(1, Ordering::Relaxed);
+        }
+    }
+}
+
+impl Drop for TelegrafTracer {
+    fn drop(&mut self) {
+        /* Closing the queue makes the worker send the last points */
+        drop(self.queue.take());
+        if let Some(worker) = self.worker.take() {
+            let _ = worker.join();
+        }
+
+        let dropped = self.dropped.load(Ordering::Relaxed);
+        if dropped > 0 {
+            eprintln!("telegraf tracer: {} points dropped", dropped);
         }
     }
 }
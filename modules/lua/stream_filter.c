@@ -33,6 +33,7 @@
 
 #include <vlc_common.h>
 #include <vlc_access.h>
+#include <vlc_url.h>
 
 #include "vlc.h"
 #include "libs.h"
@@ -46,6 +47,7 @@ struct vlclua_playlist
     char *filename;
     char *access;
     const char *path;
+    char *host;
 };
 
 static int vlclua_demux_peek( lua_State *L )
@@ -109,6 +111,10 @@ static int probe_luascript(vlc_object_t *obj, const char *filename,
     stream_t *s = (stream_t *)obj;
     struct vlclua_playlist *sys = s->p_sys;
 
+    /* Skip the scripts handling other hosts */
+    if (!vlclua_script_MayProbe(filename, sys->host))
+        return VLC_EGENERIC;
+
     /* Initialise Lua state structure */
     lua_State *L = luaL_newstate();
     if( !L )
@@ -162,6 +168,7 @@ static int probe_luascript(vlc_object_t *obj, const char *filename,
                  lua_tostring(L, lua_gettop(L)));
         goto error;
     }
+    vlclua_script_SetHosts(L, filename);
 
     lua_getglobal( L, "probe" );
     if( !lua_isfunction( L, -1 ) )
@@ -282,9 +289,16 @@ int Import_LuaPlaylist(vlc_object_t *obj)
     s->p_sys = sys;
     sys->access = NULL;
     sys->path = NULL;
+    sys->host = NULL;
 
     if (s->psz_url != NULL)
-    {   /* Backward compatibility hack: Lua scripts expect the URI scheme and
+    {
+        vlc_url_t url;
+
+        if (vlc_UrlParse(&url, s->psz_url) == 0 && url.psz_host != NULL)
+            sys->host = strdup(url.psz_host);
+        vlc_UrlClean(&url);
+   /* Backward compatibility hack: Lua scripts expect the URI scheme and
          * the rest of the URI separately. */
         const char *p = strstr(s->psz_url, "://");
         if (p != NULL)
@@ -298,6 +312,7 @@ int Import_LuaPlaylist(vlc_object_t *obj)
                                            probe_luascript, NULL);
     if (ret != VLC_SUCCESS)
     {
+        free(sys->host);
         free(sys->access);
         free(sys);
         return ret;
@@ -316,6 +331,7 @@ void Close_LuaPlaylist(vlc_object_t *obj)
     free(sys->filename);
     assert(sys->L != NULL);
     lua_close(sys->L);
+    free(sys->host);
     free(sys->access);
     free(sys);
 }
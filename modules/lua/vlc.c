@@ -42,6 +42,7 @@
 #include <vlc_fs.h>
 #include <vlc_services_discovery.h>
 #include <vlc_stream.h>
+#include <vlc_memstream.h>
 
 /*****************************************************************************
  * Module descriptor
@@ -596,20 +597,237 @@ int vlclua_add_modules_path( lua_State *L, const char *psz_filename )
     return 0;
 }
 
-/** Replacement for luaL_dofile, using VLC's input capabilities */
-int vlclua_dofile( vlc_object_t *p_this, lua_State *L, const char *curi )
+/*****************************************************************************
+ * Compiled scripts cache.
+ * Each script run gets its own Lua state, the local scripts are compiled once
+ * and their bytecode is loaded afterwards, as long as they are not modified.
+ *****************************************************************************/
+struct vlclua_chunk
 {
-    char *uri = ToLocaleDup( curi );
-    if( !strstr( uri, "://" ) ) {
-        int ret = luaL_dofile( L, uri );
-        free( uri );
-        return ret;
+    struct vlclua_chunk *next;
+    char *path;
+    time_t mtime;
+    off_t size;
+    void *code;
+    size_t length;
+    char **hosts; /* NULL-terminated probe_hosts of the script */
+    bool hosts_known;
+};
+
+static vlc_mutex_t chunks_lock = VLC_STATIC_MUTEX;
+static struct vlclua_chunk *chunks = NULL;
+
+static void vlclua_chunk_FreeHosts( struct vlclua_chunk *chunk )
+{
+    if( chunk->hosts != NULL )
+        for( char **host = chunk->hosts; *host != NULL; host++ )
+            free( *host );
+    free( chunk->hosts );
+    chunk->hosts = NULL;
+    chunk->hosts_known = false;
+}
+
+/* Must be called with chunks_lock held */
+static struct vlclua_chunk *vlclua_chunk_Find( const char *path )
+{
+    for( struct vlclua_chunk *chunk = chunks; chunk != NULL;
+         chunk = chunk->next )
+        if( !strcmp( chunk->path, path ) )
+            return chunk;
+    return NULL;
+}
+
+static int vlclua_chunk_Writer( lua_State *L, const void *p, size_t size,
+                                void *data )
+{
+    (void) L;
+    vlc_memstream_write( data, p, size );
+    return 0;
+}
+
+static void vlclua_chunk_Store( lua_State *L, const char *path,
+                                const struct stat *st )
+{
+    struct vlc_memstream stream;
+
+    /* The compiled function is on top of the stack */
+    vlc_memstream_open( &stream );
+#if LUA_VERSION_NUM >= 503
+    lua_dump( L, vlclua_chunk_Writer, &stream, 0 );
+#else
+    lua_dump( L, vlclua_chunk_Writer, &stream );
+#endif
+    if( vlc_memstream_close( &stream ) )
+        return;
+
+    vlc_mutex_lock( &chunks_lock );
+    struct vlclua_chunk *chunk = vlclua_chunk_Find( path );
+    if( chunk == NULL )
+    {
+        chunk = malloc( sizeof (*chunk) );
+        if( unlikely(chunk == NULL) || !(chunk->path = strdup( path )) )
+        {
+            vlc_mutex_unlock( &chunks_lock );
+            free( chunk );
+            free( stream.ptr );
+            return;
+        }
+        chunk->code = NULL;
+        chunk->hosts = NULL;
+        chunk->hosts_known = false;
+        chunk->next = chunks;
+        chunks = chunk;
     }
-    if( !strncasecmp( uri, "file://", 7 ) ) {
-        int ret = luaL_dofile( L, uri + 7 );
-        free( uri );
+    free( chunk->code );
+    vlclua_chunk_FreeHosts( chunk );
+    chunk->mtime = st->st_mtime;
+    chunk->size = st->st_size;
+    chunk->code = stream.ptr;
+    chunk->length = stream.length;
+    vlc_mutex_unlock( &chunks_lock );
+}
+
+static int vlclua_loadfile( lua_State *L, const char *path )
+{
+    struct stat st;
+    char *lpath = ToLocaleDup( path );
+
+    if( unlikely(lpath == NULL) )
+        return LUA_ERRMEM;
+
+    if( vlc_stat( path, &st ) )
+    {
+        int ret = luaL_loadfile( L, lpath ); /* let Lua report the error */
+        free( lpath );
         return ret;
     }
+
+    char *name;
+    if( asprintf( &name, "@%s", lpath ) < 0 )
+    {
+        free( lpath );
+        return LUA_ERRMEM;
+    }
+
+    int ret = -1;
+    vlc_mutex_lock( &chunks_lock );
+    struct vlclua_chunk *chunk = vlclua_chunk_Find( path );
+    if( chunk != NULL && chunk->mtime == st.st_mtime
+     && chunk->size == st.st_size )
+        ret = luaL_loadbuffer( L, chunk->code, chunk->length, name );
+    vlc_mutex_unlock( &chunks_lock );
+    free( name );
+
+    if( ret == -1 )
+    {
+        ret = luaL_loadfile( L, lpath );
+        if( ret == 0 )
+            vlclua_chunk_Store( L, path, &st );
+    }
+    free( lpath );
+    return ret;
+}
+
+static int vlclua_dofile_local( lua_State *L, const char *path )
+{
+    int ret = vlclua_loadfile( L, path );
+    if( ret == 0 )
+        ret = lua_pcall( L, 0, LUA_MULTRET, 0 );
+    return ret;
+}
+
+void vlclua_script_SetHosts( lua_State *L, const char *path )
+{
+    char **hosts = NULL;
+
+    lua_getglobal( L, "probe_hosts" );
+    if( lua_istable( L, -1 ) )
+    {
+        size_t count = lua_objlen( L, -1 );
+
+        hosts = vlc_alloc( count + 1, sizeof (*hosts) );
+        if( unlikely(hosts == NULL) )
+        {
+            lua_pop( L, 1 );
+            return;
+        }
+
+        size_t n = 0;
+        for( size_t i = 1; i <= count; i++ )
+        {
+            lua_rawgeti( L, -1, i );
+            const char *host = lua_tostring( L, -1 );
+            if( host != NULL && (hosts[n] = strdup( host )) != NULL )
+                n++;
+            lua_pop( L, 1 );
+        }
+        hosts[n] = NULL;
+    }
+    lua_pop( L, 1 );
+
+    vlc_mutex_lock( &chunks_lock );
+    struct vlclua_chunk *chunk = vlclua_chunk_Find( path );
+    if( chunk != NULL && !chunk->hosts_known )
+    {
+        chunk->hosts = hosts;
+        chunk->hosts_known = true;
+        hosts = NULL;
+    }
+    vlc_mutex_unlock( &chunks_lock );
+
+    if( hosts != NULL )
+    {
+        for( char **host = hosts; *host != NULL; host++ )
+            free( *host );
+        free( hosts );
+    }
+}
+
+static bool vlclua_host_Matches( const char *host, const char *domain )
+{
+    size_t hlen = strlen( host ), dlen = strlen( domain );
+
+    if( hlen < dlen || vlc_ascii_strcasecmp( host + hlen - dlen, domain ) )
+        return false;
+    /* the same host or a sub-domain */
+    return hlen == dlen || host[hlen - dlen - 1] == '.';
+}
+
+bool vlclua_script_MayProbe( const char *path, const char *host )
+{
+    bool ret = true;
+    struct stat st;
+
+    if( vlc_stat( path, &st ) )
+        return true;
+
+    vlc_mutex_lock( &chunks_lock );
+    struct vlclua_chunk *chunk = vlclua_chunk_Find( path );
+    if( chunk != NULL && chunk->hosts_known && chunk->hosts != NULL
+     && chunk->mtime == st.st_mtime && chunk->size == st.st_size )
+    {
+        ret = false;
+        if( host != NULL )
+            for( char **domain = chunk->hosts; *domain != NULL; domain++ )
+                if( vlclua_host_Matches( host, *domain ) )
+                {
+                    ret = true;
+                    break;
+                }
+    }
+    vlc_mutex_unlock( &chunks_lock );
+    return ret;
+}
+
+/** Replacement for luaL_dofile, using VLC's input capabilities */
+int vlclua_dofile( vlc_object_t *p_this, lua_State *L, const char *curi )
+{
+    if( !strstr( curi, "://" ) )
+        return vlclua_dofile_local( L, curi );
+    if( !strncasecmp( curi, "file://", 7 ) )
+        return vlclua_dofile_local( L, curi + 7 );
+
+    char *uri = ToLocaleDup( curi );
     stream_t *s = vlc_stream_NewURL( p_this, uri );
     if( !s )
     {
@@ -174,6 +174,14 @@ char *vlclua_find_file( const char *psz_luadirname, const char *psz_name );
  *****************************************************************************/
 int vlclua_dofile( vlc_object_t *p_this, lua_State *L, const char *url );
 
+/*****************************************************************************
+ * Hosts a local script handles, declared in its probe_hosts table.
+ * SetHosts records them once the script has been run with vlclua_dofile().
+ * MayProbe returns false if the script declared hosts that do not match.
+ *****************************************************************************/
+void vlclua_script_SetHosts( lua_State *L, const char *path );
+bool vlclua_script_MayProbe( const char *path, const char *host );
+
 /*****************************************************************************
  * Playlist and meta data internal utilities.
  *****************************************************************************/
@@ -41,11 +41,16 @@
 
 #include <gnutls/gnutls.h>
 #include <gnutls/x509.h>
+#if defined(__linux__) && GNUTLS_VERSION_NUMBER >= 0x030703
+# include <gnutls/socket.h>
+# define HAVE_GNUTLS_KTLS 1
+#endif
 
 typedef struct vlc_tls_gnutls
 {
     vlc_tls_t tls;
     gnutls_session_t session;
+    vlc_tls_t *sock;
     vlc_object_t *obj;
 } vlc_tls_gnutls_t;
 
@@ -130,9 +135,8 @@ static ssize_t vlc_gnutls_writev(gnutls_transport_ptr_t ptr,
 static int gnutls_GetFD(vlc_tls_t *tls, short *restrict events)
 {
     vlc_tls_gnutls_t *priv = (vlc_tls_gnutls_t *)tls;
-    vlc_tls_t *sock = gnutls_transport_get_ptr(priv->session);
 
-    return vlc_tls_GetPollFD(sock, events);
+    return vlc_tls_GetPollFD(priv->sock, events);
 }
 
 static ssize_t gnutls_Recv(vlc_tls_t *tls, struct iovec *iov, unsigned count)
@@ -291,11 +295,26 @@ static vlc_tls_gnutls_t *gnutls_SessionOpen(vlc_object_t *obj, int type,
         free (protv);
     }
 
-    gnutls_transport_set_ptr(session, sock);
-    gnutls_transport_set_vec_push_function(session, vlc_gnutls_writev);
-    gnutls_transport_set_pull_function(session, vlc_gnutls_read);
+#ifdef HAVE_GNUTLS_KTLS
+    int fd = -1;
+
+    /* Kernel TLS needs GnuTLS to own the socket descriptor. That is only
+     * possible if the session is layered directly on top of a socket. */
+    if (sock->p == NULL && var_InheritBool(obj, "gnutls-ktls"))
+        fd = vlc_tls_GetFD(sock);
+
+    if (fd >= 0)
+        gnutls_transport_set_int(session, fd);
+    else
+#endif
+    {
+        gnutls_transport_set_ptr(session, sock);
+        gnutls_transport_set_vec_push_function(session, vlc_gnutls_writev);
+        gnutls_transport_set_pull_function(session, vlc_gnutls_read);
+    }
 
     priv->session = session;
+    priv->sock = sock;
     priv->obj = obj;
 
     vlc_tls_t *tls = &priv->tls;
@@ -354,6 +373,15 @@ static int gnutls_Handshake(vlc_tls_t *tls, char **restrict alp)
         msg_Dbg(obj, " - encrypt then MAC (RFC7366) enabled");
     if (flags & GNUTLS_SFLAGS_FALSE_START)
         msg_Dbg(obj, " - false start (RFC7918) enabled");
+#ifdef HAVE_GNUTLS_KTLS
+    static const char *const ktls_modes[] = {
+        "disabled", "receive only", "send only", "enabled",
+    };
+    /* Also requires ktls = true in the GnuTLS system configuration */
+    msg_Dbg(obj, " - kernel TLS offload %s",
+            ktls_modes[gnutls_transport_is_ktls_enabled(session)
+                       & GNUTLS_KTLS_DUPLEX]);
+#endif
 
     if (alp != NULL)
     {
@@ -735,6 +763,12 @@ error:
 #define PRIORITIES_LONGTEXT N_("Ciphers, key exchange methods, " \
     "hash functions and compression methods can be selected. " \
     "Refer to GNU TLS documentation for detailed syntax.")
+
+#define KTLS_TEXT N_("Kernel TLS offload")
+#define KTLS_LONGTEXT N_( \
+    "Let the operating system encrypt and decrypt the TLS records " \
+    "when supported. This also needs to be enabled in the GnuTLS " \
+    "system configuration.")
 static const char *const priorities_values[] = {
     "PERFORMANCE",
     "NORMAL",
@@ -761,6 +795,9 @@ vlc_module_begin ()
     add_string ("gnutls-priorities", "NORMAL", PRIORITIES_TEXT,
                 PRIORITIES_LONGTEXT)
         change_string_list (priorities_values, priorities_text)
+#ifdef HAVE_GNUTLS_KTLS
+    add_bool("gnutls-ktls", true, KTLS_TEXT, KTLS_LONGTEXT)
+#endif
 #ifdef ENABLE_SOUT
     add_submodule ()
         set_description( N_("GNU TLS server") )
@@ -28,6 +28,8 @@
 #include <vlc_hash.h>
 #include <vlc_fs.h>
 
+#include <stdexcept>
+
 EmbeddedThumbnail::EmbeddedThumbnail( input_attachment_t* a, vlc_fourcc_t fcc )
     : m_attachment( vlc_input_attachment_Hold( a ) )
     , m_fcc( fcc )
@@ -86,19 +88,43 @@ std::string EmbeddedThumbnail::extension() const
 }
 
 MetadataExtractor::MetadataExtractor( vlc_object_t* parent )
-    : m_currentCtx( nullptr )
-    , m_obj( parent )
+    : m_obj( parent )
+    , m_preparser( nullptr, &vlc_preparser_Delete )
+    , m_nbExtracted( 0 )
+    , m_nbFailed( 0 )
+    , m_nbTimedOut( 0 )
+    , m_totalTime( 0 )
 {
+    const struct vlc_preparser_cfg cfg = [parent]{
+        struct vlc_preparser_cfg cfg{};
+        cfg.types = VLC_PREPARSER_TYPE_PARSE;
+        cfg.timeout = VLC_TICK_FROM_SEC( 5 );
+        cfg.max_parser_threads =
+            var_InheritInteger( parent, "preparse-threads" );
+        return cfg;
+    }();
+    m_preparser.reset( vlc_preparser_New( parent, &cfg ) );
+    if ( unlikely( m_preparser == nullptr ) )
+        throw std::runtime_error( "Failed to instantiate a vlc_preparser_t" );
+}
+
+MetadataExtractor::~MetadataExtractor()
+{
+    if ( m_nbExtracted + m_nbFailed == 0 )
+        return;
+    msg_Dbg( m_obj, "Extracted the metadata of %u items in %" PRId64 " ms "
+             "(%u failures, %u timeouts)", m_nbExtracted,
+             MS_FROM_VLC_TICK( m_totalTime ), m_nbFailed, m_nbTimedOut );
 }
 
 void MetadataExtractor::onParserEnded( ParseContext& ctx, int status )
 {
     vlc::threads::mutex_locker lock( ctx.mde->m_mutex );
 
-    // We need to probe the item now, but not from the input thread
-    ctx.success = status == VLC_SUCCESS;
+    // We need to probe the item now, but not from the preparser thread
+    ctx.status = status;
     ctx.needsProbing = true;
-    ctx.mde->m_cond.signal();
+    ctx.mde->m_cond.broadcast();
 }
 
 void MetadataExtractor::populateItem( medialibrary::parser::IItem& item, input_item_t* inputItem )
@@ -234,40 +260,40 @@ medialibrary::parser::Status MetadataExtractor::run( medialibrary::parser::IItem
         &MetadataExtractor::onAttachmentsAdded,
     };
 
-    const struct input_item_parser_cfg cfg= {
-        .cbs = &cbs,
-        .cbs_data = std::addressof( ctx ),
-        .subitems = true,
-        .interact = false,
-    };
-    m_currentCtx = &ctx;
-    ctx.inputParser = {
-        input_item_Parse( m_obj, ctx.inputItem.get(), &cfg ),
-        &input_item_parser_id_Release
-    };
-    if ( ctx.inputParser == nullptr )
-    {
-        m_currentCtx = nullptr;
+    auto start = vlc_tick_now();
+    auto id = vlc_preparser_Push( m_preparser.get(), ctx.inputItem.get(),
+                                  VLC_PREPARSER_TYPE_PARSE |
+                                  VLC_PREPARSER_OPTION_SUBITEMS,
+                                  &cbs, std::addressof( ctx ) );
+    if ( id == VLC_PREPARSER_REQ_ID_INVALID )
         return medialibrary::parser::Status::Fatal;
-    }
 
     {
+        // The preparser always ends the request, be it on time out or when
+        // stopped, and does not call back afterwards
         vlc::threads::mutex_locker lock( m_mutex );
-        auto deadline = vlc_tick_now() + VLC_TICK_FROM_SEC( 5 );
-        while ( ctx.needsProbing == false && ctx.inputParser != nullptr )
+        while ( ctx.needsProbing == false )
+            m_cond.wait( m_mutex );
+
+        auto elapsed = vlc_tick_now() - start;
+        m_totalTime += elapsed;
+        if ( ctx.status == VLC_SUCCESS )
+            m_nbExtracted++;
+        else
         {
-            auto res = m_cond.timedwait( m_mutex, deadline );
-            if ( res != 0 )
+            m_nbFailed++;
+            if ( ctx.status == VLC_ETIMEOUT )
             {
+                m_nbTimedOut++;
                 msg_Dbg( m_obj, "Timed out while extracting %s metadata",
                          item.mrl().c_str() );
-                break;
             }
         }
-        m_currentCtx = nullptr;
+        msg_Dbg( m_obj, "Extracted %s metadata in %" PRId64 " ms",
+                 item.mrl().c_str(), MS_FROM_VLC_TICK( elapsed ) );
     }
 
-    if ( !ctx.success || ctx.inputParser == nullptr )
+    if ( ctx.status != VLC_SUCCESS )
         return medialibrary::parser::Status::Fatal;
 
     if ( item.fileType() == medialibrary::IFile::Type::Playlist &&
@@ -304,7 +330,5 @@ void MetadataExtractor::onRestarted()
 
 void MetadataExtractor::stop()
 {
-    vlc::threads::mutex_locker lock{ m_mutex };
-    if ( m_currentCtx != nullptr )
-        input_item_parser_id_Interrupt( m_currentCtx->inputParser.get() );
+    vlc_preparser_Cancel( m_preparser.get(), VLC_PREPARSER_REQ_ID_INVALID );
 }
@@ -81,6 +81,9 @@ bool Thumbnailer::generate( const medialibrary::IMedia&, const std::string& mrl,
                                 &input_item_Release );
     if ( unlikely( item == nullptr ) )
         return false;
+    /* A thumbnail is downscaled anyway, the deblocking is not worth it */
+    input_item_AddOption( item.get(), "avcodec-skiploopfilter=4",
+                          VLC_INPUT_OPTION_TRUSTED );
 
     ctx.done = false;
     ctx.thumbnailer = this;
@@ -35,7 +35,9 @@
 #include <vlc_cxx_helpers.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdlib>
 #include <medialibrary/filesystem/Errors.h>
 #include <sys/stat.h>
 #include <system_error>
@@ -45,6 +47,10 @@ using InputItemPtr = vlc_shared_data_ptr_type(input_item_t,
                                               input_item_Hold,
                                               input_item_Release);
 
+/* Number of subdirectories read at once. Listing a directory mostly waits
+ * for the file system, especially over the network. */
+#define SD_DIRECTORY_READERS 4
+
 namespace vlc {
   namespace medialibrary {
 
@@ -75,9 +81,29 @@ SDDirectory::dirs() const
 {
     if ( !m_read_done )
         read();
+    if ( !m_dirs_read )
+    {
+        /* The subdirectories are about to be browsed */
+        readDirs();
+        m_dirs_read = true;
+    }
     return m_dirs;
 }
 
+void
+SDDirectory::prefetch() const
+{
+    try
+    {
+        if ( !m_read_done )
+            read();
+    }
+    catch ( ... )
+    {
+        /* read() will be called again, and throw, from the browsing thread */
+    }
+}
+
 std::shared_ptr<IDevice>
 SDDirectory::device() const
 {
@@ -110,6 +136,20 @@ bool SDDirectory::contains(const std::string& fileName) const
                          }) != cend( fs );
 }
 
+struct prefetch_request {
+    const std::vector<std::shared_ptr<fs::IDirectory>> *dirs;
+    std::atomic<size_t> next;
+};
+
+static void readDirectories( prefetch_request *req )
+{
+    for ( size_t i; ( i = req->next++ ) < req->dirs->size(); )
+    {
+        auto dir = static_cast<const SDDirectory*>( (*req->dirs)[i].get() );
+        dir->prefetch();
+    }
+}
+
 struct metadata_request {
     vlc::threads::mutex lock;
     vlc::threads::condition_variable cond;
@@ -124,6 +164,15 @@ struct metadata_request {
 
 extern "C" {
 
+static void *readDirectoriesThread( void *data )
+{
+    auto req = static_cast<vlc::medialibrary::prefetch_request*>( data );
+
+    vlc_thread_set_name( "vlc-ml-readdir" );
+    vlc::medialibrary::readDirectories( req );
+    return nullptr;
+}
+
 static void onParserEnded( input_item_t *, int status, void *data )
 {
     auto req = static_cast<vlc::medialibrary::metadata_request*>( data );
@@ -195,6 +244,20 @@ static bool request_metadata_sync( libvlc_int_t *libvlc, input_item_t *media,
     return req.success;
 }
 
+static bool getItemStat( input_item_t *item, uint64_t *size, time_t *mtime )
+{
+    auto sizeStr = vlc::wrap_cptr( input_item_GetInfo( item, ".stat", "size" ) );
+    auto mtimeStr = vlc::wrap_cptr( input_item_GetInfo( item, ".stat", "mtime" ) );
+
+    if ( sizeStr == nullptr || mtimeStr == nullptr ||
+         *sizeStr == '\0' || *mtimeStr == '\0' )
+        return false;
+
+    *size = strtoull( sizeStr.get(), nullptr, 10 );
+    *mtime = strtoll( mtimeStr.get(), nullptr, 10 );
+    return true;
+}
+
 void
 SDDirectory::read() const
 {
@@ -214,17 +277,29 @@ SDDirectory::read() const
         throw medialibrary::fs::errors::System(
             EIO, "Failed to browse directory: Unknown error" );
 
+    /* Fill the lists only once the whole directory is read, so that a failed
+     * read can be tried again */
+    std::vector<std::shared_ptr<fs::IFile>> files;
+    std::vector<std::shared_ptr<fs::IDirectory>> dirs;
+
     for ( const InputItemPtr& m : children )
     {
         const char* mrl = m.get()->psz_uri;
         enum input_item_type_e type = m->i_type;
         if ( type == ITEM_TYPE_DIRECTORY )
         {
-            m_dirs.push_back( std::make_shared<SDDirectory>( mrl, m_fs ) );
+            dirs.push_back( std::make_shared<SDDirectory>( mrl, m_fs ) );
         }
         else if ( type == ITEM_TYPE_FILE )
         {
-            addFile( mrl, IFile::LinkedFileType::None, {} );
+            /* The directory access already got the file information while
+             * listing, most of the time */
+            uint64_t size;
+            time_t mtime;
+            if ( !getItemStat( m.get(), &size, &mtime ) )
+                size = mtime = 0;
+
+            addFile( files, mrl, IFile::LinkedFileType::None, {}, size, mtime );
             for ( auto i = 0; i < m->i_slaves; ++i )
             {
                 const auto* slave = m->pp_slaves[i];
@@ -232,21 +307,50 @@ SDDirectory::read() const
                                              ? IFile::LinkedFileType::SoundTrack
                                              : IFile::LinkedFileType::Subtitles;
 
-                addFile( slave->psz_uri, linked_type, mrl );
+                addFile( files, slave->psz_uri, linked_type, mrl, 0, 0 );
             }
         }
     }
 
+    m_files = std::move( files );
+    m_dirs = std::move( dirs );
     m_read_done = true;
 }
 
 void
-SDDirectory::addFile(std::string mrl, IFile::LinkedFileType fType, std::string linkedFile) const
+SDDirectory::readDirs() const
 {
-    time_t lastModificationDate = 0;
-    uint64_t fileSize = 0;
+    if ( m_dirs.size() < 2 )
+        return;
+
+    prefetch_request req;
+    req.dirs = &m_dirs;
+    req.next = 0;
 
-    if ( m_fs.isNetworkFileSystem() == false )
+    vlc_thread_t threads[SD_DIRECTORY_READERS - 1];
+    size_t count = 0;
+
+    /* This thread reads too */
+    while ( count < ARRAY_SIZE( threads ) && count + 1 < m_dirs.size() )
+    {
+        if ( vlc_clone( &threads[count], readDirectoriesThread, &req ) != 0 )
+            break;
+        count++;
+    }
+
+    readDirectories( &req );
+
+    for ( size_t i = 0; i < count; ++i )
+        vlc_join( threads[i], nullptr );
+}
+
+void
+SDDirectory::addFile(std::vector<std::shared_ptr<fs::IFile>> &files,
+                     std::string mrl, IFile::LinkedFileType fType,
+                     std::string linkedFile, uint64_t fileSize,
+                     time_t lastModificationDate) const
+{
+    if ( lastModificationDate == 0 && m_fs.isNetworkFileSystem() == false )
     {
         const auto path = vlc::wrap_cptr( vlc_uri2path( mrl.c_str() ) );
         struct stat stat;
@@ -263,12 +367,12 @@ SDDirectory::addFile(std::string mrl, IFile::LinkedFileType fType, std::string l
 
     if ( fType == IFile::LinkedFileType::None )
     {
-        m_files.push_back(
+        files.push_back(
             std::make_shared<SDFile>( std::move( mrl ), fileSize, lastModificationDate ) );
     }
     else
     {
-        m_files.push_back( std::make_shared<SDFile>(
+        files.push_back( std::make_shared<SDFile>(
             std::move( mrl ), fType, std::move( linkedFile ), fileSize, lastModificationDate ) );
     }
 }
@@ -42,14 +42,22 @@ public:
     std::shared_ptr<fs::IFile> file( const std::string& mrl ) const override;
     bool contains( const std::string& file ) const override;
 
+    /* Read the directory ahead of time, from any thread. The errors are
+     * reported when its content is requested. */
+    void prefetch() const;
+
 private:
     void read() const;
-    void addFile( std::string mrl, fs::IFile::LinkedFileType, std::string linkedWith ) const;
+    void readDirs() const;
+    void addFile( std::vector<std::shared_ptr<fs::IFile>> &files, std::string mrl,
+                  fs::IFile::LinkedFileType, std::string linkedWith,
+                  uint64_t size, time_t mtime ) const;
 
     std::string m_mrl;
     SDFileSystemFactory &m_fs;
 
     mutable bool m_read_done = false;
+    mutable bool m_dirs_read = false;
     mutable std::vector<std::shared_ptr<fs::IFile>> m_files;
     mutable std::vector<std::shared_ptr<fs::IDirectory>> m_dirs;
     mutable std::shared_ptr<IDevice> m_device;
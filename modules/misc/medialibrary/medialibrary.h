@@ -66,27 +66,23 @@ private:
     {
         ParseContext( MetadataExtractor* mde, medialibrary::parser::IItem& item )
             : needsProbing( false )
-            , success( false )
+            , status( VLC_EGENERIC )
             , mde( mde )
             , item( item )
             , inputItem( nullptr, &input_item_Release )
-            , inputParser( nullptr, &input_item_parser_id_Release )
         {
         }
 
         bool needsProbing;
-        bool success;
+        int status;
         MetadataExtractor* mde;
         medialibrary::parser::IItem& item;
         std::unique_ptr<input_item_t, decltype(&input_item_Release)> inputItem;
-        // Needs to be last to be destroyed first, otherwise a late callback
-        // could use some already destroyed fields
-        std::unique_ptr<input_item_parser_id_t, decltype(&input_item_parser_id_Release)> inputParser;
     };
 
 public:
     MetadataExtractor( vlc_object_t* parent );
-    virtual ~MetadataExtractor() = default;
+    virtual ~MetadataExtractor();
 
     // All methods are meant to be accessed through IParserService, not directly
     // hence they are all private
@@ -113,8 +109,16 @@ private:
 private:
     vlc::threads::condition_variable m_cond;
     vlc::threads::mutex m_mutex;
-    ParseContext* m_currentCtx;
     vlc_object_t* m_obj;
+    // Shared by the parser threads of the media library, so that several
+    // items can be extracted at once
+    std::unique_ptr<vlc_preparser_t, decltype(&vlc_preparser_Delete)> m_preparser;
+
+    // Statistics, protected by m_mutex
+    unsigned m_nbExtracted;
+    unsigned m_nbFailed;
+    unsigned m_nbTimedOut;
+    vlc_tick_t m_totalTime;
 };
 
 class Thumbnailer : public medialibrary::IThumbnailer
@@ -116,8 +116,6 @@ static void ReaderErrorHandler( void *p_arg, const char *p_msg,
 typedef struct
 {
     xmlTextReaderPtr xml;
-    char *node;
-    char *namespace;
 } xml_reader_sys_t;
 
 static int ReaderUseDTD ( xml_reader_t *p_reader )
@@ -140,11 +138,6 @@ static int ReaderNextNode( xml_reader_t *p_reader, const char **pval,
     int ret;
 
     skip:
-    free( p_sys->node );
-    free( p_sys->namespace );
-    p_sys->node = NULL;
-    p_sys->namespace = NULL;
-
     switch( xmlTextReaderRead( p_sys->xml ) )
     {
         case 0: /* EOF */
@@ -183,14 +176,13 @@ static int ReaderNextNode( xml_reader_t *p_reader, const char **pval,
     if( unlikely(node == NULL) )
         return XML_READER_ERROR;
 
-    p_sys->node = strdup( (const char *) node );
-    if( namespace )
-        p_sys->namespace = strdup( (const char *) namespace );
+    /* No copies: the names come from the dictionary of the reader, and the
+     * text stays in the current node until the next xmlTextReaderRead() */
     if( pval != NULL )
-        *pval = p_sys->node;
+        *pval = (const char *) node;
     if( pnamespace != NULL )
-        *pnamespace = p_sys->namespace;
-    return likely(p_sys->node != NULL) ? ret : XML_READER_ERROR;
+        *pnamespace = (const char *) namespace;
+    return ret;
 }
 
 static const char *ReaderNextAttr( xml_reader_t *p_reader, const char **pval,
@@ -257,8 +249,6 @@ static int ReaderOpen( vlc_object_t *p_this )
                                   ReaderErrorHandler, p_reader );
 
     p_sys->xml = p_libxml_reader;
-    p_sys->node = NULL;
-    p_sys->namespace = NULL;
     p_reader->p_sys = p_sys;
     p_reader->pf_next_node = ReaderNextNode;
     p_reader->pf_next_attr = ReaderNextAttr;
@@ -274,8 +264,6 @@ static void ReaderClose( vlc_object_t *p_this )
     xml_reader_sys_t *p_sys = p_reader->p_sys;
 
     xmlFreeTextReader( p_sys->xml );
-    free( p_sys->node );
-    free( p_sys->namespace );
     free( p_sys );
 
     /* /!\
@@ -58,6 +58,14 @@
     "\"Fast Start\" files are optimized for downloads and allow the user " \
     "to start previewing the file while it is downloading.")
 
+#define MOOVSPACE_TEXT N_("Space reserved for the index (KiB)")
+#define MOOVSPACE_LONGTEXT N_(\
+    "With \"Fast Start\", reserve this space at the beginning of the file " \
+    "for the index. When the index fits at the end, it is written there " \
+    "instead of moving all the data, which avoids rewriting the whole " \
+    "file. Count about 3 MiB per hour of audio and video. " \
+    "0 disables the reservation.")
+
 static int  Open   (vlc_object_t *);
 static void Close  (vlc_object_t *);
 static void CloseFrag  (vlc_object_t *);
@@ -71,6 +79,8 @@ vlc_module_begin ()
 
     add_bool(SOUT_CFG_PREFIX "faststart", false,
               FASTSTART_TEXT, FASTSTART_LONGTEXT)
+    add_integer_with_range(SOUT_CFG_PREFIX "moov-space", 0, 0, 64 * 1024,
+                           MOOVSPACE_TEXT, MOOVSPACE_LONGTEXT)
     set_capability("sout mux", 5)
     add_shortcut("mp4", "mov", "3gp")
     set_callbacks(Open, Close)
@@ -89,7 +99,7 @@ vlc_module_end ()
  * Exported prototypes
  *****************************************************************************/
 static const char *const ppsz_sout_options[] = {
-    "faststart", NULL
+    "faststart", "moov-space", NULL
 };
 
 static int Control(sout_mux_t *, int, va_list);
@@ -165,6 +175,9 @@ typedef struct
 
     uint64_t i_mdat_pos;
     uint64_t i_pos;
+    /* free space reserved for the moov, before the mdat */
+    uint64_t i_moov_space_pos;
+    uint64_t i_moov_space;
     vlc_tick_t  i_read_duration;
     vlc_tick_t  i_start_dts;
 
@@ -265,6 +278,24 @@ static int WriteSlowStartHeader(sout_mux_t *p_mux)
         box_send(p_mux, box);
     }
 
+    /* Reserve the moov space as a free box, filled if it fits at close */
+    const uint64_t i_space = var_GetInteger(p_mux, SOUT_CFG_PREFIX "moov-space") * 1024;
+    if (i_space > 0 && var_GetBool(p_mux, SOUT_CFG_PREFIX "faststart"))
+    {
+        block_t *p_free = block_Alloc(i_space);
+        if (!p_free)
+            return VLC_ENOMEM;
+        memset(p_free->p_buffer, 0, i_space);
+        SetDWBE(p_free->p_buffer, i_space);
+        memcpy(&p_free->p_buffer[4], "free", 4);
+
+        p_sys->i_moov_space_pos = p_sys->i_pos;
+        p_sys->i_moov_space = i_space;
+        p_sys->i_pos += i_space;
+        p_sys->i_mdat_pos = p_sys->i_pos;
+        sout_AccessOutWrite(p_mux->p_access, p_free);
+    }
+
     /* Now add mdat header */
     box = box_new("mdat");
     if(!box)
@@ -310,6 +341,8 @@ static int Open(vlc_object_t *p_this)
     p_sys->i_nb_streams = 0;
     p_sys->pp_streams   = NULL;
     p_sys->i_mdat_pos   = 0;
+    p_sys->i_moov_space_pos = 0;
+    p_sys->i_moov_space = 0;
     p_sys->b_header_sent = false;
 
     p_sys->i_read_duration   = 0;
@@ -377,6 +410,33 @@ static void Close(vlc_object_t *p_this)
 
     /* Check we need to create "fast start" files */
     p_sys->b_fast_start = var_GetBool(p_this, SOUT_CFG_PREFIX "faststart");
+
+    /* The moov fits in the reserved space, nothing to move. The leftover
+     * space, if any, must be large enough for a free box header. */
+    if (p_sys->b_fast_start && moov && moov->b &&
+        (bo_size(moov) == p_sys->i_moov_space ||
+         bo_size(moov) + 8 <= p_sys->i_moov_space))
+    {
+        const uint64_t i_left = p_sys->i_moov_space - bo_size(moov);
+        msg_Dbg(p_this, "Writing moov in reserved space (%"PRIu64" left)", i_left);
+        sout_AccessOutSeek(p_mux->p_access, p_sys->i_moov_space_pos);
+        box_send(p_mux, moov);
+        moov = NULL;
+        if (i_left > 0)
+        {
+            bo_t *p_free = box_new("free");
+            if (p_free)
+            {
+                box_fix(p_free, i_left);
+                box_send(p_mux, p_free);
+            }
+        }
+        goto cleanup;
+    }
+    else if (p_sys->b_fast_start && p_sys->i_moov_space > 0)
+        msg_Warn(p_this, "Reserved space is too small for the moov, "
+                 "moving the data instead");
+
     while (p_sys->b_fast_start && moov && moov->b)
     {
         /* Move data to the end of the file so we can fit the moov header
@@ -0,0 +1,78 @@
+/*****************************************************************************
+ * cbr.c: constant mux rate scheduling
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <vlc_common.h>
+#include <vlc_tick.h>
+
+#include "cbr.h"
+
+#define TS_PACKET_BITS (188 * 8)
+
+/* n * freq / rate without overflowing on long runs */
+static uint64_t Scale( uint64_t i_bits, uint64_t i_freq, uint64_t i_rate )
+{
+    return i_bits / i_rate * i_freq + i_bits % i_rate * i_freq / i_rate;
+}
+
+void ts_cbr_Init( ts_cbr_t *cbr, uint64_t i_rate )
+{
+    assert( i_rate > 0 );
+    cbr->i_rate = i_rate;
+    ts_cbr_Reset( cbr );
+}
+
+void ts_cbr_Reset( ts_cbr_t *cbr )
+{
+    cbr->i_start = VLC_TICK_INVALID;
+    cbr->i_packets = 0;
+}
+
+uint64_t ts_cbr_Slots( ts_cbr_t *cbr, vlc_tick_t i_start, vlc_tick_t i_end )
+{
+    if( cbr->i_start == VLC_TICK_INVALID )
+        cbr->i_start = i_start;
+    if( i_end <= cbr->i_start )
+        return 0;
+
+    /* packets whose departure is strictly before the end: the smallest
+     * n with n * TS_PACKET_BITS * CLOCK_FREQ >= elapsed * rate */
+    const uint64_t i_elapsed = i_end - cbr->i_start;
+    const uint64_t i_div = TS_PACKET_BITS * CLOCK_FREQ;
+    const uint64_t i_total = i_elapsed / i_div * cbr->i_rate
+        + ( i_elapsed % i_div * cbr->i_rate + i_div - 1 ) / i_div;
+    return i_total > cbr->i_packets ? i_total - cbr->i_packets : 0;
+}
+
+vlc_tick_t ts_cbr_Date( const ts_cbr_t *cbr, uint64_t i_packet )
+{
+    return cbr->i_start + Scale( i_packet * TS_PACKET_BITS, CLOCK_FREQ,
+                                 cbr->i_rate );
+}
+
+uint64_t ts_cbr_PCR( const ts_cbr_t *cbr, uint64_t i_packet )
+{
+    return Scale( i_packet * TS_PACKET_BITS, 27000000, cbr->i_rate );
+}
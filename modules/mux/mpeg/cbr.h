@@ -0,0 +1,52 @@
+/*****************************************************************************
+ * cbr.h: constant mux rate scheduling
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_MPEG_CBR_H_
+#define VLC_MPEG_CBR_H_
+
+/* Departure times of the TS packets of a constant rate multiplex. Packet n
+ * leaves at start + n * 1504 bits / rate, computed from the start each time
+ * so that the rounding never accumulates. */
+typedef struct
+{
+    uint64_t   i_rate;    /* bits per second */
+    vlc_tick_t i_start;   /* departure of the first packet */
+    uint64_t   i_packets; /* packets scheduled since the start */
+} ts_cbr_t;
+
+void ts_cbr_Init( ts_cbr_t *, uint64_t i_rate );
+/* Restarts the schedule from the next period, after a discontinuity */
+void ts_cbr_Reset( ts_cbr_t * );
+
+/* Returns how many packets can still leave before i_end. The schedule
+ * starts at i_start on the first period. */
+uint64_t ts_cbr_Slots( ts_cbr_t *, vlc_tick_t i_start, vlc_tick_t i_end );
+/* Schedules the next packet and returns its index */
+static inline uint64_t ts_cbr_Next( ts_cbr_t *cbr )
+{
+    return cbr->i_packets++;
+}
+
+/* Departure date of a packet */
+vlc_tick_t ts_cbr_Date( const ts_cbr_t *, uint64_t i_packet );
+/* Departure of a packet since the start, in 27 MHz units for the PCR */
+uint64_t ts_cbr_PCR( const ts_cbr_t *, uint64_t i_packet );
+
+#endif
@@ -38,6 +38,11 @@ struct csa_t
 {
     bool    use_odd;
     struct dvbcsa_key_s *keys[2];
+
+    /* bitsliced keys, scrambling a batch of packets at once */
+    struct dvbcsa_bs_key_s *bs_keys[2];
+    unsigned i_batch_size;
+    struct dvbcsa_bs_batch_s *batch; /* i_batch_size + 1 for the terminator */
 };
 
 /*****************************************************************************
@@ -46,18 +51,24 @@ struct csa_t
 csa_t *csa_New( void )
 {
     csa_t *csa = calloc( 1, sizeof( csa_t ) );
-    if(csa)
+    if( !csa )
+        return NULL;
+
+    csa->keys[0] = dvbcsa_key_alloc();
+    csa->keys[1] = dvbcsa_key_alloc();
+    csa->bs_keys[0] = dvbcsa_bs_key_alloc();
+    csa->bs_keys[1] = dvbcsa_bs_key_alloc();
+    /* 32, 64 or 128 packets depending on the SIMD libdvbcsa was built for */
+    csa->i_batch_size = dvbcsa_bs_batch_size();
+    csa->batch = vlc_alloc( csa->i_batch_size + 1, sizeof(*csa->batch) );
+
+    if( !csa->keys[0] || !csa->keys[1] ||
+        !csa->bs_keys[0] || !csa->bs_keys[1] || !csa->batch )
     {
-        csa->keys[0] = dvbcsa_key_alloc();
-        if(csa->keys[0])
-            csa->keys[1] = dvbcsa_key_alloc();
-        if(csa->keys[1])
-            return csa;
-        else
-            dvbcsa_key_free(csa->keys[0]);
+        csa_Delete( csa );
+        return NULL;
     }
-    free(csa);
-    return NULL;
+    return csa;
 }
 
 /*****************************************************************************
@@ -65,8 +76,15 @@ csa_t *csa_New( void )
  *****************************************************************************/
 void csa_Delete( csa_t *c )
 {
-    dvbcsa_key_free( c->keys[0] );
-    dvbcsa_key_free( c->keys[1] );
+    if( c->keys[0] )
+        dvbcsa_key_free( c->keys[0] );
+    if( c->keys[1] )
+        dvbcsa_key_free( c->keys[1] );
+    if( c->bs_keys[0] )
+        dvbcsa_bs_key_free( c->bs_keys[0] );
+    if( c->bs_keys[1] )
+        dvbcsa_bs_key_free( c->bs_keys[1] );
+    free( c->batch );
     free( c );
 }
 
@@ -104,6 +122,7 @@ int csa_SetCW( vlc_object_t *p_caller, csa_t *c, char *psz_ck, bool set_odd )
 # endif
 
         dvbcsa_key_set( ck, c->keys[set_odd ? 1 : 0] );
+        dvbcsa_bs_key_set( ck, c->bs_keys[set_odd ? 1 : 0] );
 
         return VLC_SUCCESS;
     }
@@ -158,44 +177,75 @@ void csa_Decrypt( csa_t *c, uint8_t *pkt, int i_pkt_size )
     dvbcsa_decrypt( key, &pkt[i_hdr], i_pkt_size - i_hdr );
 }
 
-/*****************************************************************************
- * csa_Encrypt:
- *****************************************************************************/
-void csa_Encrypt( csa_t *c, uint8_t *pkt, int i_pkt_size )
+/* Sets the transport scrambling control of a packet about to be scrambled
+ * and returns its header length, or 0 if it has no payload to scramble */
+static int EncryptHeader( csa_t *c, uint8_t *pkt, int i_pkt_size )
 {
-    int i_hdr = 4; /* hdr len */
-    int n;
-
     /* set transport scrambling control */
     pkt[3] |= 0x80;
-
-    struct dvbcsa_key_s *key;
     if( c->use_odd )
-    {
         pkt[3] |= 0x40;
-        key = c->keys[1];
-    }
-    else
-    {
-        key = c->keys[0];
-    }
 
     /* hdr len */
-    i_hdr = 4;
+    int i_hdr = 4;
     if( pkt[3]&0x20 )
     {
         /* skip adaption field */
         i_hdr += pkt[4] + 1;
     }
-    n = (i_pkt_size - i_hdr) / 8;
 
-    if( n <= 0 )
+    if( (i_pkt_size - i_hdr) / 8 <= 0 )
     {
         pkt[3] &= 0x3f;
-        return;
+        return 0;
     }
+    return i_hdr;
+}
+
+/*****************************************************************************
+ * csa_Encrypt:
+ *****************************************************************************/
+void csa_Encrypt( csa_t *c, uint8_t *pkt, int i_pkt_size )
+{
+    int i_hdr = EncryptHeader( c, pkt, i_pkt_size );
+    if( i_hdr == 0 )
+        return;
+
+    dvbcsa_encrypt( c->keys[c->use_odd ? 1 : 0], &pkt[i_hdr],
+                    i_pkt_size - i_hdr );
+}
+
+/*****************************************************************************
+ * csa_EncryptBatch: scrambles the packets with the bitsliced cipher
+ *****************************************************************************/
+void csa_EncryptBatch( csa_t *c, uint8_t *const *pkts, size_t i_count,
+                       int i_pkt_size )
+{
+    const struct dvbcsa_bs_key_s *key = c->bs_keys[c->use_odd ? 1 : 0];
+    /* the payload is at most 184 bytes, already a multiple of 8 */
+    const unsigned i_maxlen = (i_pkt_size - 4 + 7) & ~7;
+    unsigned i_batch = 0;
+
+    for( size_t i = 0; i < i_count; i++ )
+    {
+        int i_hdr = EncryptHeader( c, pkts[i], i_pkt_size );
+        if( i_hdr == 0 )
+            continue;
 
-    dvbcsa_encrypt(key, &pkt[i_hdr], i_pkt_size - i_hdr);
+        c->batch[i_batch].data = &pkts[i][i_hdr];
+        c->batch[i_batch].len = i_pkt_size - i_hdr;
+        if( ++i_batch == c->i_batch_size )
+        {
+            c->batch[i_batch].data = NULL;
+            dvbcsa_bs_encrypt( key, c->batch, i_maxlen );
+            i_batch = 0;
+        }
+    }
+    if( i_batch > 0 )
+    {
+        c->batch[i_batch].data = NULL;
+        dvbcsa_bs_encrypt( key, c->batch, i_maxlen );
+    }
 }
 #else
 
@@ -239,4 +289,13 @@ void csa_Encrypt( csa_t *c, uint8_t *pkt, int i_pkt_size )
     VLC_UNUSED(i_pkt_size);
 }
 
+void csa_EncryptBatch( csa_t *c, uint8_t *const *pkts, size_t i_count,
+                       int i_pkt_size )
+{
+    VLC_UNUSED(c);
+    VLC_UNUSED(pkts);
+    VLC_UNUSED(i_count);
+    VLC_UNUSED(i_pkt_size);
+}
+
 #endif
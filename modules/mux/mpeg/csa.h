@@ -33,5 +33,9 @@ void   csa_UseKey( vlc_object_t *p_caller, csa_t *, bool use_odd );
 
 void   csa_Decrypt( csa_t *, uint8_t *pkt, int i_pkt_size );
 void   csa_Encrypt( csa_t *, uint8_t *pkt, int i_pkt_size );
+/* Same result as csa_Encrypt() on each packet, but the packets are scrambled
+ * together by the bitsliced cipher, which is several times faster */
+void   csa_EncryptBatch( csa_t *, uint8_t *const *pkts, size_t i_count,
+                         int i_pkt_size );
 
 #endif /* _CSA_H */
@@ -47,6 +47,7 @@
 #include "bits.h"
 #include "pes.h"
 #include "csa.h"
+#include "cbr.h"
 #include "tsutil.h"
 #include "streams.h"
 
@@ -161,6 +162,13 @@ static const char *const ts_standards_list_text[] =
   "stream, compared to the PCRs. This allows for some buffering inside " \
   "the client decoder.")
 
+#define MUXRATE_TEXT N_("Constant mux rate (bits/s)")
+#define MUXRATE_LONGTEXT N_("Output a constant bitrate multiplex, padded " \
+  "with null packets, for transmission equipment requiring strict CBR. " \
+  "Packets are dated at their departure time for the access output to " \
+  "pace them. The rate must be above the peak rate of the programs " \
+  "within a shaping period. 0 keeps the variable rate.")
+
 #define ACRYPT_TEXT N_("Crypt audio")
 #define ACRYPT_LONGTEXT N_("Crypt audio using CSA")
 #define VCRYPT_TEXT N_("Crypt video")
@@ -222,6 +230,8 @@ vlc_module_begin ()
 
     add_integer( SOUT_CFG_PREFIX "pcr", 70, PCR_TEXT, PCR_LONGTEXT)
     add_integer( SOUT_CFG_PREFIX "dts-delay", 400, DTS_TEXT, DTS_LONGTEXT)
+    add_integer_with_range( SOUT_CFG_PREFIX "muxrate", 0, 0, 1000000000,
+                            MUXRATE_TEXT, MUXRATE_LONGTEXT )
 
     add_obsolete_integer( "sout-ts-bmin" ) /* since 4.0.0 */
     add_obsolete_integer( "sout-ts-bmax" ) /* since 4.0.0 */
@@ -245,7 +255,7 @@ static const char *const ppsz_sout_options[] = {
     "netid", "sdtdesc",
     "es-id-pid", "shaping", "pcr", "use-key-frames",
     "dts-delay", "csa-ck", "csa2-ck", "csa-use", "csa-pkt", "crypt-audio", "crypt-video",
-    "muxpmt", "program-pmt", "alignment",
+    "muxpmt", "program-pmt", "alignment", "muxrate",
     NULL
 };
 
@@ -362,6 +372,11 @@ typedef struct
 
     vlc_tick_t      i_pcr;  /* last PCR emitted */
 
+    /* constant mux rate, if i_mux_rate is not 0 */
+    uint64_t        i_mux_rate;
+    ts_cbr_t        cbr;
+    bool            b_cbr_overflow;
+
     csa_t           *csa;
     int             i_csa_pkt_size;
     bool            b_crypt_audio;
@@ -463,6 +478,7 @@ static void GetPMT( sout_mux_t *p_mux, sout_buffer_chain_t *c );
 
 static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream, bool b_pcr );
 static void TSSetPCR( block_t *p_ts, vlc_tick_t i_dts );
+static void TSSetPCR27( block_t *p_ts, uint64_t i_pcr );
 
 static void csaSetup( vlc_object_t *p_this )
 {
@@ -708,6 +724,14 @@ static int Open( vlc_object_t *p_this )
 
     p_sys->b_use_key_frames = var_GetBool( p_mux, SOUT_CFG_PREFIX "use-key-frames" );
 
+    p_sys->i_mux_rate = var_GetInteger( p_mux, SOUT_CFG_PREFIX "muxrate" );
+    p_sys->b_cbr_overflow = false;
+    if( p_sys->i_mux_rate > 0 )
+    {
+        ts_cbr_Init( &p_sys->cbr, p_sys->i_mux_rate );
+        msg_Dbg( p_mux, "constant mux rate %"PRIu64" bits/s", p_sys->i_mux_rate );
+    }
+
     p_mux->p_sys        = p_sys;
 
     csaSetup( p_this );
@@ -1723,12 +1747,125 @@ static int TSSchedule( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
     return VLC_SUCCESS;
 }
 
+/* Enough for a few batches of the widest bitsliced CSA */
+#define TS_CSA_BATCH_MAX 512
+
+static void TSEncrypt( sout_mux_sys_t *p_sys, uint8_t *const *pp_pkts,
+                       size_t i_count )
+{
+    vlc_mutex_lock( &p_sys->csa_lock );
+    csa_EncryptBatch( p_sys->csa, pp_pkts, i_count, p_sys->i_csa_pkt_size );
+    vlc_mutex_unlock( &p_sys->csa_lock );
+}
+
+static block_t *TSNull( void )
+{
+    block_t *p_ts = block_Alloc( 188 );
+    if( likely(p_ts) )
+    {
+        memset( p_ts->p_buffer, 0xff, 188 );
+        p_ts->p_buffer[0] = 0x47;
+        p_ts->p_buffer[1] = 0x1f; /* PID 0x1fff */
+        p_ts->p_buffer[2] = 0xff;
+        p_ts->p_buffer[3] = 0x10;
+    }
+    return p_ts;
+}
+
+/* Dates the packets on the slots of the constant rate multiplex until the
+ * end of the period, filling the free slots with null packets */
+static int TSDateCBR( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
+                      vlc_tick_t i_pcr_length, vlc_tick_t i_pcr_dts )
+{
+    sout_mux_sys_t *p_sys = p_mux->p_sys;
+    ts_cbr_t *cbr = &p_sys->cbr;
+    const uint64_t i_count = p_chain_ts->i_depth;
+    const vlc_tick_t i_end = i_pcr_dts + i_pcr_length;
+
+    uint64_t i_slots = ts_cbr_Slots( cbr, i_pcr_dts, i_end );
+    /* A second of padding more than a shaping period: the input jumped or
+     * stalled */
+    const uint64_t i_max_padding = p_sys->i_mux_rate / (188 * 8)
+        * secf_from_vlc_tick( p_sys->i_shaping_delay + VLC_TICK_FROM_SEC(1) );
+    if( i_slots > i_count + i_max_padding )
+    {
+        msg_Warn( p_mux, "discontinuity, restarting the constant mux rate" );
+        ts_cbr_Reset( cbr );
+        i_slots = ts_cbr_Slots( cbr, i_pcr_dts, i_end );
+    }
+    if( i_slots < i_count )
+    {
+        if( !p_sys->b_cbr_overflow )
+            msg_Warn( p_mux, "mux rate too low, %"PRIu64" packets late",
+                      i_count - i_slots );
+        p_sys->b_cbr_overflow = true;
+        i_slots = i_count;
+    }
+    else
+        p_sys->b_cbr_overflow = false;
+
+    const uint64_t i_pcr_offset = ( cbr->i_start - p_sys->first_dts )
+                                * ( 27000000 / CLOCK_FREQ );
+    block_t *p_list = NULL;
+    block_t **pp_last = &p_list;
+    uint8_t *pp_scrambled[TS_CSA_BATCH_MAX];
+    size_t i_scrambled = 0;
+    uint64_t i_data = 0;
+    for( uint64_t i = 0; i < i_slots; i++ )
+    {
+        block_t *p_ts;
+        /* spread the data evenly over the period */
+        if( i_data < i_count && i_data * i_slots <= i * i_count )
+        {
+            p_ts = BufferChainGet( p_chain_ts );
+            i_data++;
+        }
+        else
+        {
+            p_ts = TSNull();
+            if( unlikely(p_ts == NULL) )
+                continue;
+        }
+
+        const uint64_t i_packet = ts_cbr_Next( cbr );
+        p_ts->i_dts = ts_cbr_Date( cbr, i_packet );
+        p_ts->i_length = ts_cbr_Date( cbr, i_packet + 1 ) - p_ts->i_dts;
+
+        if( p_ts->i_flags & BLOCK_FLAG_FOR_PCR )
+            TSSetPCR27( p_ts, i_pcr_offset + ts_cbr_PCR( cbr, i_packet ) );
+        if( p_ts->i_flags & BLOCK_FLAG_SCRAMBLED )
+        {
+            pp_scrambled[i_scrambled++] = p_ts->p_buffer;
+            if( i_scrambled == TS_CSA_BATCH_MAX )
+            {
+                TSEncrypt( p_sys, pp_scrambled, i_scrambled );
+                i_scrambled = 0;
+            }
+        }
+
+        /* latency */
+        p_ts->i_dts += p_sys->i_shaping_delay * 3 / 2;
+
+        block_ChainLastAppend( &pp_last, p_ts );
+    }
+    if( i_scrambled > 0 )
+        TSEncrypt( p_sys, pp_scrambled, i_scrambled );
+
+    ssize_t written = 0;
+    if ( p_list != NULL )
+        written = sout_AccessOutWrite( p_mux->p_access, p_list );
+    return ( written == -1 ) ? VLC_EGENERIC : VLC_SUCCESS;
+}
+
 static int TSDate( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
                    vlc_tick_t i_pcr_length, vlc_tick_t i_pcr_dts )
 {
     sout_mux_sys_t  *p_sys = p_mux->p_sys;
     int i_packet_count = p_chain_ts->i_depth;
 
+    if( p_sys->i_mux_rate > 0 )
+        return TSDateCBR( p_mux, p_chain_ts, i_pcr_length, i_pcr_dts );
+
     if ( unlikely(i_pcr_length / 1000 <= 0) )
     {
         /* This shouldn't happen, but happens in some rare heavy load
@@ -1739,6 +1876,9 @@ static int TSDate( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
     /* msg_Dbg( p_mux, "real pck=%d", i_packet_count ); */
     block_t *p_list = NULL;
     block_t **pp_last = &p_list;
+    /* scrambled packets are encrypted together, once dated */
+    uint8_t *pp_scrambled[TS_CSA_BATCH_MAX];
+    size_t i_scrambled = 0;
     for (int i = 0; i < i_packet_count; i++ )
     {
         block_t *p_ts = BufferChainGet( p_chain_ts );
@@ -1754,9 +1894,12 @@ static int TSDate( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
         }
         if( p_ts->i_flags & BLOCK_FLAG_SCRAMBLED )
         {
-            vlc_mutex_lock( &p_sys->csa_lock );
-            csa_Encrypt( p_sys->csa, p_ts->p_buffer, p_sys->i_csa_pkt_size );
-            vlc_mutex_unlock( &p_sys->csa_lock );
+            pp_scrambled[i_scrambled++] = p_ts->p_buffer;
+            if( i_scrambled == TS_CSA_BATCH_MAX )
+            {
+                TSEncrypt( p_sys, pp_scrambled, i_scrambled );
+                i_scrambled = 0;
+            }
         }
 
         /* latency */
@@ -1764,6 +1907,9 @@ static int TSDate( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
 
         block_ChainLastAppend( &pp_last, p_ts );
     }
+    if( i_scrambled > 0 )
+        TSEncrypt( p_sys, pp_scrambled, i_scrambled );
+
     ssize_t written = 0;
     if ( p_list != NULL )
         written = sout_AccessOutWrite( p_mux->p_access, p_list );
@@ -1875,15 +2021,23 @@ static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream,
 
 static void TSSetPCR( block_t *p_ts, vlc_tick_t i_dts )
 {
-    ts_90khz_t i_pcr = TO_SCALE_NZ(i_dts);
+    /* no PCR extension at the 90 kHz precision */
+    TSSetPCR27( p_ts, TO_SCALE_NZ(i_dts) * 300 );
+}
+
+/* Sets the full precision PCR, in 27 MHz units */
+static void TSSetPCR27( block_t *p_ts, uint64_t i_pcr27 )
+{
+    const uint64_t i_pcr = i_pcr27 / 300;
+    const unsigned i_ext = i_pcr27 % 300;
 
     p_ts->p_buffer[6]  = ( i_pcr >> 25 )&0xff;
     p_ts->p_buffer[7]  = ( i_pcr >> 17 )&0xff;
     p_ts->p_buffer[8]  = ( i_pcr >> 9  )&0xff;
     p_ts->p_buffer[9]  = ( i_pcr >> 1  )&0xff;
     p_ts->p_buffer[10] = ( i_pcr << 7  )&0x80;
-    p_ts->p_buffer[10] |= 0x7e;
-    p_ts->p_buffer[11] = 0; /* we don't set PCR extension */
+    p_ts->p_buffer[10] |= 0x7e | ( ( i_ext >> 8 )&0x01 );
+    p_ts->p_buffer[11] = i_ext&0xff;
 }
 
 void GetPAT( sout_mux_t *p_mux, sout_buffer_chain_t *c )
@@ -273,17 +273,27 @@ static int Mux( sout_mux_t *p_mux )
     {
         p_sys->i_data += p_block->i_buffer;
 
-        /* Do the channel reordering */
-        if( p_sys->i_chans_to_reorder )
-            aout_ChannelReorder( p_block->p_buffer, p_block->i_buffer,
-                                 p_sys->i_chans_to_reorder,
-                                 p_sys->pi_chan_table, p_input->p_fmt->i_codec );
-
         /* We should not pass whole blockchain to accessoutwrite, as we only handled
            current block channel reordering, so mark next as empty and handle next block separately
            */
         block_t *p_next_block = p_block->p_next;
         p_block->p_next = NULL;
+
+        /* Do the channel reordering, the data may be shared with other
+         * outputs */
+        if( p_sys->i_chans_to_reorder )
+        {
+            p_block = block_MakeWritable( p_block );
+            if( unlikely(p_block == NULL) )
+            {
+                block_ChainRelease( p_next_block );
+                return VLC_ENOMEM;
+            }
+            aout_ChannelReorder( p_block->p_buffer, p_block->i_buffer,
+                                 p_sys->i_chans_to_reorder,
+                                 p_sys->pi_chan_table, p_input->p_fmt->i_codec );
+        }
+
         sout_AccessOutWrite( p_mux->p_access, p_block );
         p_block = p_next_block;
     }
@@ -494,10 +494,18 @@ static block_t *PacketizeOBU(decoder_t *p_dec, block_t **pp_block)
         }
         else
         {
-            p_obublock = block_Alloc(i_obu);
-            memcpy(p_obublock->p_buffer, p_frag->p_buffer, i_obu);
-            p_frag->i_buffer -= i_obu;
-            p_frag->p_buffer += i_obu;
+            /* OBUs share the fragment buffer, and are joined back without
+             * copy when output in the same order */
+            block_t *p_next = p_frag->p_next;
+            p_frag->p_next = NULL;
+            p_obublock = block_Split(&p_frag, i_obu);
+            p_frag->p_next = p_next;
+            if(!p_obublock)
+                break;
+            /* remaining part can be a new block */
+            p_sys->obus.p_chain = p_frag;
+            if(p_next == NULL)
+                p_sys->obus.pp_chain_last = &p_frag->p_next;
             p_obublock->i_dts = p_frag->i_dts;
             p_obublock->i_pts = p_frag->i_pts;
             p_obublock->i_flags = p_frag->i_flags;
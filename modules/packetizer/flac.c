@@ -222,6 +222,38 @@ static uint16_t flac_crc16(uint16_t crc, uint8_t byte)
 {
     return (crc << 8) ^ flac_crc16_table[(crc >> 8) ^ byte];
 }
+
+/* Slice-by-8: flac_crc16_slices[k][b] is the CRC of b followed by k + 1 zero
+ * bytes, so that 8 bytes are folded into the CRC with independent lookups */
+static uint16_t flac_crc16_slices[7][256];
+static vlc_once_t flac_crc16_once = VLC_STATIC_ONCE;
+
+static void flac_crc16_init(void *data)
+{
+    VLC_UNUSED(data);
+    for (unsigned b = 0; b < 256; b++)
+    {
+        uint16_t crc = flac_crc16_table[b];
+        for (unsigned k = 0; k < 7; k++)
+        {
+            crc = (crc << 8) ^ flac_crc16_table[crc >> 8];
+            flac_crc16_slices[k][b] = crc;
+        }
+    }
+}
+
+static uint16_t flac_crc16_buf(uint16_t crc, const uint8_t *p, size_t len)
+{
+    for (; len >= 8; p += 8, len -= 8)
+        crc = flac_crc16_slices[6][p[0] ^ (crc >> 8)] ^
+              flac_crc16_slices[5][p[1] ^ (crc & 0xff)] ^
+              flac_crc16_slices[4][p[2]] ^ flac_crc16_slices[3][p[3]] ^
+              flac_crc16_slices[2][p[4]] ^ flac_crc16_slices[1][p[5]] ^
+              flac_crc16_slices[0][p[6]] ^ flac_crc16_table[p[7]];
+    while (len--)
+        crc = flac_crc16(crc, *p++);
+    return crc;
+}
 #if 0
 /* Gives the previous CRC value, before hashing last_byte through it */
 static uint16_t flac_crc16_undo(uint16_t crc, const uint8_t last_byte)
@@ -399,6 +431,12 @@ static block_t *Packetize(decoder_t *p_dec, block_t **pp_block)
 
     case STATE_NEXT_SYNC:
     {
+        /* No frame is shorter than the stream minimum, do not scan and check
+         * the candidates before it */
+        if( pp_block != NULL && p_sys->b_stream_info &&
+            p_sys->stream_info.min_framesize > p_sys->i_offset )
+            p_sys->i_offset = p_sys->stream_info.min_framesize;
+
         /* First Sync is on bytestream head, offset will be the position
          * of the next sync code candidate */
         if(block_FindStartcodeFromOffset(&p_sys->bytestream, &p_sys->i_offset,
@@ -493,8 +531,10 @@ static block_t *Packetize(decoder_t *p_dec, block_t **pp_block)
                                     p_sys->i_offset - p_sys->i_buf_offset );
 
             /* update crc to include this data chunk */
-            for( size_t i = p_sys->i_buf_offset; i < p_sys->i_offset - 2; i++ )
-                p_sys->crc = flac_crc16( p_sys->crc, p_sys->p_buf[i] );
+            if( p_sys->i_offset - 2 > p_sys->i_buf_offset )
+                p_sys->crc = flac_crc16_buf( p_sys->crc,
+                                             &p_sys->p_buf[p_sys->i_buf_offset],
+                                             p_sys->i_offset - 2 - p_sys->i_buf_offset );
 
             uint16_t stream_crc = GetWBE(&p_sys->p_buf[p_sys->i_offset - 2]);
             if( stream_crc != p_sys->crc )
@@ -584,6 +624,7 @@ static int Open(vlc_object_t *p_this)
     if (p_dec->fmt_in->i_codec != VLC_CODEC_FLAC)
         return VLC_EGENERIC;
 
+    vlc_once(&flac_crc16_once, flac_crc16_init, NULL);
 
     /* */
     p_dec->p_sys = p_sys = malloc(sizeof(*p_sys));
@@ -626,7 +626,8 @@ static block_t *ParseNALBlock( decoder_t *p_dec, bool *pb_ts_used, block_t *p_fr
                         if( (p_sei->i_flags & BLOCK_FLAG_PRIVATE_SEI) == 0 )
                             continue;
                         HxxxParse_AnnexB_SEI( p_sei->p_buffer, p_sei->i_buffer,
-                                              1 /* nal header */, ParseSeiCallback, p_dec );
+                                              1 /* nal header */, !p_dec->b_packetize_only,
+                                              ParseSeiCallback, p_dec );
                     }
 
                     if( p_sys->p_slice )
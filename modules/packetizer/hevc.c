@@ -695,7 +695,8 @@ static void ParseStoredSEI( decoder_t *p_dec )
         if( hevc_getNALType(&p_nal->p_buffer[4]) == HEVC_NAL_PREF_SEI )
         {
             HxxxParse_AnnexB_SEI( p_nal->p_buffer, p_nal->i_buffer,
-                                  2 /* nal header */, ParseSEICallback, p_dec );
+                                  2 /* nal header */, !p_dec->b_packetize_only,
+                                  ParseSEICallback, p_dec );
         }
     }
 }
@@ -860,7 +861,8 @@ static block_t * ParseAUTail(decoder_t *p_dec, uint8_t i_nal_type, block_t *p_na
 
         case HEVC_NAL_SUFF_SEI:
             HxxxParse_AnnexB_SEI( p_nalb->p_buffer, p_nalb->i_buffer,
-                                  2 /* nal header */, ParseSEICallback, p_dec );
+                                  2 /* nal header */, !p_dec->b_packetize_only,
+                                  ParseSEICallback, p_dec );
             break;
     }
 
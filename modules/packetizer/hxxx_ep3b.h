@@ -19,11 +19,35 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
  *****************************************************************************/
 #include <vlc_bits.h>
+#include <string.h>
+
+/* Minimum forward size for looking up the next escape candidate */
+#define HXXX_EP3B_SCAN_MIN 16
 
 static inline uint8_t *hxxx_ep3b_to_rbsp( uint8_t *p, uint8_t *end, unsigned *pi_prev, size_t i_count )
 {
     for( size_t i=0; i<i_count; i++ )
     {
+        /* An escape needs two zero bytes before it: unless the current and
+         * previous ones are, jump over the bytes before the next zero */
+        if( i_count - i >= HXXX_EP3B_SCAN_MIN && (*pi_prev & 0x03) != 0x03 &&
+            p + 1 < end )
+        {
+            size_t i_scan = end - p - 1;
+            if( i_scan > i_count - i )
+                i_scan = i_count - i;
+            const uint8_t *p_zero = memchr( p + 1, 0, i_scan );
+            const size_t i_skip = p_zero ? (size_t)(p_zero - (p + 1)) : i_scan;
+            if( i_skip > 0 )
+            {
+                p += i_skip;
+                i += i_skip;
+                *pi_prev = 0; /* last skipped byte is not zero */
+                if( i == i_count )
+                    break;
+            }
+        }
+
         if( ++p >= end )
             return p;
 
@@ -30,14 +30,16 @@
 #include "hxxx_ep3b.h"
 
 void HxxxParse_AnnexB_SEI(const uint8_t *p_buf, size_t i_buf,
-                          uint8_t i_header, pf_hxxx_sei_callback cb, void *cbdata)
+                          uint8_t i_header, bool b_user_data,
+                          pf_hxxx_sei_callback cb, void *cbdata)
 {
     if( hxxx_strip_AnnexB_startcode( &p_buf, &i_buf ) )
-        HxxxParseSEI(p_buf, i_buf, i_header, cb, cbdata);
+        HxxxParseSEI(p_buf, i_buf, i_header, b_user_data, cb, cbdata);
 }
 
 void HxxxParseSEI(const uint8_t *p_buf, size_t i_buf,
-                  uint8_t i_header, pf_hxxx_sei_callback pf_callback, void *cbdata)
+                  uint8_t i_header, bool b_user_data,
+                  pf_hxxx_sei_callback pf_callback, void *cbdata)
 {
     bs_t s;
     bool b_continue = true;
@@ -100,6 +102,9 @@ void HxxxParseSEI(const uint8_t *p_buf, size_t i_buf,
             /* Look for user_data_registered_itu_t_t35 */
             case HXXX_SEI_USER_DATA_REGISTERED_ITU_T_T35:
             {
+                if( !b_user_data )
+                    break;
+
                 size_t i_t35;
                 uint8_t *p_t35 = malloc( i_size );
                 if( !p_t35 )
@@ -89,7 +89,9 @@ typedef struct
 } hxxx_sei_data_t;
 
 typedef bool (*pf_hxxx_sei_callback)(const hxxx_sei_data_t *, void *);
-void HxxxParseSEI(const uint8_t *, size_t, uint8_t, pf_hxxx_sei_callback, void *);
-void HxxxParse_AnnexB_SEI(const uint8_t *, size_t, uint8_t, pf_hxxx_sei_callback, void *);
+/* When user data is not wanted, registered user data (closed captions) payloads
+ * are skipped without being read */
+void HxxxParseSEI(const uint8_t *, size_t, uint8_t, bool, pf_hxxx_sei_callback, void *);
+void HxxxParse_AnnexB_SEI(const uint8_t *, size_t, uint8_t, bool, pf_hxxx_sei_callback, void *);
 
 #endif
@@ -34,6 +34,11 @@
 #  endif
 #endif
 
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#  include <arm_neon.h>
+#  define STARTCODE_HAS_NEON
+#endif
+
 /* Looks up efficiently for an AnnexB startcode 0x00 0x00 0x01
  * by using a 4 times faster trick than single byte lookup. */
 
@@ -119,6 +124,97 @@ static inline const uint8_t * startcode_FindAnnexB_SSE2( const uint8_t *p, const
 
 #endif
 
+#ifdef CAN_COMPILE_AVX2
+
+__attribute__ ((__target__ ("avx2")))
+static inline const uint8_t * startcode_FindAnnexB_AVX2( const uint8_t *p, const uint8_t *end )
+{
+    /* First align to 32 */
+    const uint8_t *alignedend = p + 32 - ((intptr_t)p & 31);
+    for (end -= 3; p < alignedend && p <= end; p++) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+            return p;
+    }
+
+    if( p == end )
+        return NULL;
+
+    alignedend = end - ((intptr_t) end & 31);
+    for( ; p < alignedend; p += 32)
+    {
+        uint32_t match;
+        asm volatile(
+            "vmovdqa   0(%[v]),   %%ymm0\n"
+            "vpxor     %%ymm1,    %%ymm1, %%ymm1\n"
+            "vpcmpeqb  %%ymm1,    %%ymm0, %%ymm0\n"
+            "vpmovmskb %%ymm0,    %[match]\n" /* mask will be in reversed match order */
+            "vzeroupper\n"
+            : [match]"=r"(match)
+            : [v]"r"(p)
+            : "ymm0", "ymm1"
+        );
+        if( match == 0 )
+            continue;
+        for( unsigned i = 0; i < 32; i += 4 )
+        {
+            if( match & (0xFU << i) )
+                TRY_MATCH(p, i);
+        }
+    }
+
+    for (; p <= end; p++) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+            return p;
+    }
+
+    return NULL;
+}
+
+#endif
+
+#ifdef STARTCODE_HAS_NEON
+
+static inline const uint8_t * startcode_FindAnnexB_NEON( const uint8_t *p, const uint8_t *end )
+{
+    /* First align to 16 */
+    const uint8_t *alignedend = p + 16 - ((intptr_t)p & 15);
+    for (end -= 3; p < alignedend && p <= end; p++) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+            return p;
+    }
+
+    if( p == end )
+        return NULL;
+
+    alignedend = end - ((intptr_t) end & 15);
+    for( ; p < alignedend; p += 16)
+    {
+        const uint8x16_t zeros = vceqq_u8(vld1q_u8(p), vdupq_n_u8(0));
+        /* narrow to 4 bits per byte, as there's no movemask */
+        const uint64_t match = vget_lane_u64(vreinterpret_u64_u8(
+                                   vshrn_n_u16(vreinterpretq_u16_u8(zeros), 4)), 0);
+        if( match == 0 )
+            continue;
+        if( match & 0x000000000000FFFFULL )
+            TRY_MATCH(p, 0);
+        if( match & 0x00000000FFFF0000ULL )
+            TRY_MATCH(p, 4);
+        if( match & 0x0000FFFF00000000ULL )
+            TRY_MATCH(p, 8);
+        if( match & 0xFFFF000000000000ULL )
+            TRY_MATCH(p, 12);
+    }
+
+    for (; p <= end; p++) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+            return p;
+    }
+
+    return NULL;
+}
+
+#endif
+
 /* That code is adapted from libav's ff_avc_find_startcode_internal
  * and i believe the trick originated from
  * https://graphics.stanford.edu/~seander/bithacks.html#ZeroInWord
@@ -151,14 +247,22 @@ static inline const uint8_t * startcode_FindAnnexB_Bits( const uint8_t *p, const
 }
 #undef TRY_MATCH
 
-#ifdef CAN_COMPILE_SSE2
+#if defined(CAN_COMPILE_SSE2) || defined(CAN_COMPILE_AVX2)
 static inline const uint8_t * startcode_FindAnnexB( const uint8_t *p, const uint8_t *end )
 {
+#  ifdef CAN_COMPILE_AVX2
+    if (vlc_CPU_AVX2())
+        return startcode_FindAnnexB_AVX2(p, end);
+#  endif
+#  ifdef CAN_COMPILE_SSE2
     if (vlc_CPU_SSE2())
         return startcode_FindAnnexB_SSE2(p, end);
-    else
-        return startcode_FindAnnexB_Bits(p, end);
+#  endif
+    return startcode_FindAnnexB_Bits(p, end);
 }
+#elif defined(STARTCODE_HAS_NEON)
+    /* NEON is part of the aarch64 baseline */
+    #define startcode_FindAnnexB startcode_FindAnnexB_NEON
 #else
     #define startcode_FindAnnexB startcode_FindAnnexB_Bits
 #endif
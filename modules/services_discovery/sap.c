@@ -83,10 +83,21 @@
 /* Link-local SAP address */
 #define SAP_V4_LINK_ADDRESS     "224.0.0.255"
 #define ADD_SESSION 1
+/* Maximum number of announcements waiting to be parsed, the others are
+ * dropped until they are sent again */
+#define SAP_MAX_PENDING 512
 
 typedef struct
 {
     vlc_thread_t thread;
+    vlc_thread_t parser;
+
+    /* Protects the announces and the pending packets */
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    struct vlc_list packets; /* new announcements to parse */
+    unsigned i_pending;
+    bool b_closing;
 
     /* Socket descriptors */
     int i_fd;
@@ -219,8 +230,18 @@ typedef struct sap_announce_t
     uint32_t    i_source[4];
 
     input_item_t * p_item;
+    input_item_t * p_cat; /* not held, categories live as long as the SD */
 } sap_announce_t;
 
+/* New announcement, queued by the network thread for the parser thread */
+struct sap_packet
+{
+    struct vlc_list node;
+    uint16_t i_hash;
+    uint32_t i_source[4];
+    char psz_sdp[];
+};
+
 static sap_announce_t *CreateAnnounce(services_discovery_t *p_sd,
                                       const uint32_t *i_source,
                                       uint16_t i_hash, const char *psz_sdp)
@@ -248,7 +269,7 @@ static sap_announce_t *CreateAnnounce(services_discovery_t *p_sd,
     p_sap->i_hash = i_hash;
     memcpy (p_sap->i_source, i_source, sizeof(p_sap->i_source));
 
-    /* Released in RemoveAnnounce */
+    /* Released in DeleteAnnounce */
     p_input = input_item_NewStream(uri, p_sdp->name,
                                    INPUT_DURATION_INDEFINITE);
     free(uri);
@@ -285,9 +306,8 @@ static sap_announce_t *CreateAnnounce(services_discovery_t *p_sd,
         /* backward compatibility with VLC 0.7.3-2.0.0 senders */
         psz_value = vlc_sdp_attr_value(p_sdp, "x-plgroup");
     }
-    input_item_t *cat = psz_value == NULL ? NULL : AddCategory(p_sd, psz_value);
+    p_sap->p_cat = psz_value == NULL ? NULL : AddCategory(p_sd, psz_value);
     free(str);
-    services_discovery_AddSubItem(p_sd, cat, p_input);
 
     vlc_sdp_free(p_sdp);
     return p_sap;
@@ -297,21 +317,142 @@ error:
     return NULL;
 }
 
-static int RemoveAnnounce( services_discovery_t *p_sd,
-                           sap_announce_t *p_announce )
+static void DeleteAnnounce( sap_announce_t *p_announce )
 {
-    if( p_announce->p_item )
+    input_item_Release( p_announce->p_item );
+    free( p_announce );
+}
+
+/* Must be called with the lock held */
+static sap_announce_t *FindAnnounce( services_discovery_sys_t *p_sys,
+                                     uint16_t i_hash,
+                                     const uint32_t *i_source )
+{
+    for( int i = 0 ; i < p_sys->i_announces ; i++ )
     {
-        services_discovery_RemoveItem( p_sd, p_announce->p_item );
-        input_item_Release( p_announce->p_item );
-        p_announce->p_item = NULL;
+        sap_announce_t * p_announce = p_sys->pp_announces[i];
+        /* FIXME: slow */
+        if (p_announce->i_hash == i_hash
+         && memcmp(p_announce->i_source, i_source,
+                   sizeof (p_announce->i_source)) == 0)
+            return p_announce;
     }
+    return NULL;
+}
+
+/* Must be called with the lock held */
+static bool IsPending( services_discovery_sys_t *p_sys, uint16_t i_hash,
+                       const uint32_t *i_source )
+{
+    struct sap_packet *packet;
+
+    vlc_list_foreach( packet, &p_sys->packets, node )
+        if (packet->i_hash == i_hash
+         && memcmp(packet->i_source, i_source,
+                   sizeof (packet->i_source)) == 0)
+            return true;
+    return false;
+}
+
+/* Removes announces already taken out of the table at once */
+static void RemoveAnnounces( services_discovery_t *p_sd,
+                             sap_announce_t **announces, int count )
+{
+    input_item_t *items[count];
+
+    for( int i = 0; i < count; i++ )
+        items[i] = announces[i]->p_item;
+    services_discovery_RemoveItems( p_sd, items, count );
+
+    for( int i = 0; i < count; i++ )
+        DeleteAnnounce( announces[i] );
+}
 
+/* Adds the parsed announces, grouped by category */
+static void AddAnnounces( services_discovery_t *p_sd,
+                          sap_announce_t **announces, size_t count )
+{
     services_discovery_sys_t *p_sys = p_sd->p_sys;
-    TAB_REMOVE(p_sys->i_announces, p_sys->pp_announces, p_announce);
-    free( p_announce );
+    input_item_t *items[count];
+    input_item_t *cat = NULL;
+    size_t n = 0;
 
-    return VLC_SUCCESS;
+    vlc_mutex_lock( &p_sys->lock );
+    for( size_t i = 0; i < count; i++ )
+    {
+        sap_announce_t *p_announce = announces[i];
+
+        /* The announcement might have been queued again meanwhile */
+        if( FindAnnounce( p_sys, p_announce->i_hash,
+                          p_announce->i_source ) != NULL )
+        {
+            DeleteAnnounce( p_announce );
+            continue;
+        }
+
+        if( n > 0 && p_announce->p_cat != cat )
+        {
+            services_discovery_AddSubItems( p_sd, cat, items, n );
+            n = 0;
+        }
+        cat = p_announce->p_cat;
+        items[n++] = p_announce->p_item;
+        TAB_APPEND(p_sys->i_announces, p_sys->pp_announces, p_announce);
+    }
+    if( n > 0 )
+        services_discovery_AddSubItems( p_sd, cat, items, n );
+    vlc_mutex_unlock( &p_sys->lock );
+}
+
+/*****************************************************************************
+ * RunParser: SAP announcements parsing thread
+ *****************************************************************************
+ * Parses the SDP of the new announcements off the network thread, and adds
+ * all the ones received meanwhile at once.
+ *****************************************************************************/
+static void *RunParser( void *data )
+{
+    vlc_thread_set_name("vlc-sap-parser");
+
+    services_discovery_t *p_sd = data;
+    services_discovery_sys_t *p_sys = p_sd->p_sys;
+
+    vlc_mutex_lock( &p_sys->lock );
+    for (;;)
+    {
+        while( vlc_list_is_empty( &p_sys->packets ) && !p_sys->b_closing )
+            vlc_cond_wait( &p_sys->wait, &p_sys->lock );
+        if( p_sys->b_closing )
+            break;
+
+        struct vlc_list packets;
+        unsigned count = p_sys->i_pending;
+
+        vlc_list_replace( &p_sys->packets, &packets );
+        vlc_list_init( &p_sys->packets );
+        p_sys->i_pending = 0;
+        vlc_mutex_unlock( &p_sys->lock );
+
+        sap_announce_t *announces[count];
+        struct sap_packet *packet;
+        size_t n = 0;
+
+        vlc_list_foreach( packet, &packets, node )
+        {
+            sap_announce_t *sap = CreateAnnounce( p_sd, packet->i_source,
+                                                  packet->i_hash,
+                                                  packet->psz_sdp );
+            if( sap != NULL )
+                announces[n++] = sap;
+            free( packet );
+        }
+
+        if( n > 0 )
+            AddAnnounces( p_sd, announces, n );
+        vlc_mutex_lock( &p_sys->lock );
+    }
+    vlc_mutex_unlock( &p_sys->lock );
+    return NULL;
 }
 
 static int InitSocket( services_discovery_t *p_sd, const char *psz_address,
@@ -425,42 +566,48 @@ static int ParseSAP( services_discovery_t *p_sd, const uint8_t *buf,
         psz_sdp += clen;
     }
 
-    for( int i = 0 ; i < p_sys->i_announces ; i++ )
+    vlc_mutex_lock( &p_sys->lock );
+    sap_announce_t *p_announce = FindAnnounce( p_sys, i_hash, i_source );
+    if( p_announce != NULL )
     {
-        sap_announce_t * p_announce = p_sys->pp_announces[i];
-        /* FIXME: slow */
-        if (p_announce->i_hash == i_hash
-         && memcmp(p_announce->i_source, i_source, sizeof (i_source)) == 0)
+        /* We don't support delete announcement as they can easily
+         * Be used to hijack an announcement by a third party.
+         * Instead we cleverly implement Implicit Announcement removal.
+         *
+         * if( b_need_delete )
+         *    RemoveAnnounces( p_sd, &p_announce, 1 );
+         * else
+         */
+
+        if( !b_need_delete )
         {
-            /* We don't support delete announcement as they can easily
-             * Be used to hijack an announcement by a third party.
-             * Instead we cleverly implement Implicit Announcement removal.
-             *
-             * if( b_need_delete )
-             *    RemoveAnnounce( p_sd, p_sys->pp_announces[i]);
-             * else
-             */
-
-            if( !b_need_delete )
-            {
-                /* No need to go after six, as we start to trust the
-                 * average period at six */
-                if( p_announce->i_period_trust <= 5 )
-                    p_announce->i_period_trust++;
-
-                /* Compute the average period */
-                vlc_tick_t now = vlc_tick_now();
-                p_announce->i_period = ( p_announce->i_period * (p_announce->i_period_trust-1) + (now - p_announce->i_last) ) / p_announce->i_period_trust;
-                p_announce->i_last = now;
-            }
-            free (decomp);
-            return VLC_SUCCESS;
+            /* No need to go after six, as we start to trust the
+             * average period at six */
+            if( p_announce->i_period_trust <= 5 )
+                p_announce->i_period_trust++;
+
+            /* Compute the average period */
+            vlc_tick_t now = vlc_tick_now();
+            p_announce->i_period = ( p_announce->i_period * (p_announce->i_period_trust-1) + (now - p_announce->i_last) ) / p_announce->i_period_trust;
+            p_announce->i_last = now;
         }
     }
-
-    sap_announce_t *sap = CreateAnnounce(p_sd, i_source, i_hash, psz_sdp);
-    if (sap != NULL)
-        TAB_APPEND(p_sys->i_announces, p_sys->pp_announces, sap);
+    else if( p_sys->i_pending < SAP_MAX_PENDING
+          && !IsPending( p_sys, i_hash, i_source ) )
+    {
+        /* The SDP is parsed by the parser thread */
+        struct sap_packet *packet = malloc( sizeof (*packet) + len + 1 );
+        if( likely(packet != NULL) )
+        {
+            packet->i_hash = i_hash;
+            memcpy( packet->i_source, i_source, sizeof (i_source) );
+            memcpy( packet->psz_sdp, psz_sdp, len + 1 );
+            vlc_list_append( &packet->node, &p_sys->packets );
+            p_sys->i_pending++;
+            vlc_cond_signal( &p_sys->wait );
+        }
+    }
+    vlc_mutex_unlock( &p_sys->lock );
 
     free (decomp);
     return VLC_SUCCESS;
@@ -599,7 +746,12 @@ static void *Run( void *data )
          * This timeout is tuned in the following loop. */
         timeout = 1000 * 60 * 60;
 
+        vlc_mutex_lock( &p_sys->lock );
+
         /* Check for items that need deletion */
+        sap_announce_t *expired[p_sys->i_announces + 1];
+        int i_expired = 0, i_kept = 0;
+
         for( int i = 0; i < p_sys->i_announces; i++ )
         {
             sap_announce_t * p_announce = p_sys->pp_announces[i];
@@ -611,25 +763,49 @@ static void *Run( void *data )
             if( ( p_announce->i_period_trust > 5 && i_last_period > 10 * p_announce->i_period ) ||
                 i_last_period > p_sys->i_timeout )
             {
-                RemoveAnnounce( p_sd, p_announce );
+                expired[i_expired++] = p_announce;
             }
             else
             {
+                p_sys->pp_announces[i_kept++] = p_announce;
+
                 /* Compute next timeout */
                 if( p_announce->i_period_trust > 5 )
                     timeout = __MIN(MS_FROM_VLC_TICK(10 * p_announce->i_period - i_last_period), timeout);
                 timeout = __MIN(MS_FROM_VLC_TICK(p_sys->i_timeout - i_last_period), timeout);
             }
         }
+        p_sys->i_announces = i_kept;
+
+        if( i_expired > 0 )
+            RemoveAnnounces( p_sd, expired, i_expired );
 
+        /* Announcements being parsed are only in the table later, so this
+         * thread cannot poll indefinitely anymore. */
         if( !p_sys->i_announces )
-            timeout = -1; /* We can safely poll indefinitely. */
+            timeout = MS_FROM_VLC_TICK(p_sys->i_timeout);
         else if( timeout < 200 )
             timeout = 200; /* Don't wakeup too fast. */
+
+        vlc_mutex_unlock( &p_sys->lock );
     }
     vlc_assert_unreachable ();
 }
 
+static void StopParser( services_discovery_sys_t *p_sys )
+{
+    struct sap_packet *packet;
+
+    vlc_mutex_lock( &p_sys->lock );
+    p_sys->b_closing = true;
+    vlc_cond_signal( &p_sys->wait );
+    vlc_mutex_unlock( &p_sys->lock );
+    vlc_join( p_sys->parser, NULL );
+
+    vlc_list_foreach( packet, &p_sys->packets, node )
+        free( packet );
+}
+
 /*****************************************************************************
  * Open: initialize and create stuff
  *****************************************************************************/
@@ -652,9 +828,23 @@ static int Open( vlc_object_t *p_this )
     p_sys->i_announces = 0;
     p_sys->pp_announces = NULL;
     p_sys->root_cat = NULL;
+
+    vlc_mutex_init( &p_sys->lock );
+    vlc_cond_init( &p_sys->wait );
+    vlc_list_init( &p_sys->packets );
+    p_sys->i_pending = 0;
+    p_sys->b_closing = false;
+
+    if (vlc_clone (&p_sys->parser, RunParser, p_sd))
+    {
+        free (p_sys);
+        return VLC_EGENERIC;
+    }
+
     /* TODO: create sockets here, and fix racy sockets table */
     if (vlc_clone (&p_sys->thread, Run, p_sd))
     {
+        StopParser (p_sys);
         free (p_sys);
         return VLC_EGENERIC;
     }
@@ -673,6 +863,7 @@ static void Close( vlc_object_t *p_this )
 
     vlc_cancel (p_sys->thread);
     vlc_join (p_sys->thread, NULL);
+    StopParser (p_sys);
 
     for( i = p_sys->i_fd-1 ; i >= 0 ; i-- )
     {
@@ -680,10 +871,8 @@ static void Close( vlc_object_t *p_this )
     }
     FREENULL( p_sys->pi_fd );
 
-    for( i = p_sys->i_announces  - 1;  i>= 0; i-- )
-    {
-        RemoveAnnounce( p_sd, p_sys->pp_announces[i] );
-    }
+    if( p_sys->i_announces > 0 )
+        RemoveAnnounces( p_sd, p_sys->pp_announces, p_sys->i_announces );
     FREENULL( p_sys->pp_announces );
     tdestroy(p_sys->root_cat, DestroyCategory);
 
@@ -56,6 +56,14 @@ static int MosaicCallback   ( vlc_object_t *, char const *, vlc_value_t,
 /*****************************************************************************
  * filter_sys_t : filter descriptor
  *****************************************************************************/
+typedef struct
+{
+    const bridged_es_t *p_es; /* Only compared, it may be gone */
+    picture_t *p_source;      /* Last picture converted for this substream */
+    picture_t *p_converted;
+    bool b_used;              /* Seen during the last Filter() call */
+} mosaic_tile_t;
+
 typedef struct
 {
     vlc_mutex_t lock;         /* Internal filter lock */
@@ -80,6 +88,9 @@ typedef struct
     int i_offsets_length;
 
     vlc_tick_t i_delay;
+
+    mosaic_tile_t *p_tiles;   /* Converted pictures, by substream */
+    int i_tiles;
 } filter_sys_t;
 
 /*****************************************************************************
@@ -302,6 +313,9 @@ static int CreateFilter( filter_t *p_filter )
 
     p_filter->ops = &filter_ops;
 
+    p_sys->p_tiles = NULL;
+    p_sys->i_tiles = 0;
+
     vlc_mutex_init( &p_sys->lock );
     vlc_mutex_lock( &p_sys->lock );
 
@@ -385,6 +399,91 @@ static int CreateFilter( filter_t *p_filter )
     return VLC_SUCCESS;
 }
 
+/*****************************************************************************
+ * Tiles: the substreams pictures, once converted
+ *****************************************************************************
+ * A substream picture is displayed until the next one is bridged, that is
+ * several times when the substream frame rate is lower than the background
+ * one. Only the new pictures are scaled and converted.
+ *****************************************************************************/
+static void TileClean( mosaic_tile_t *p_tile )
+{
+    if( p_tile->p_source != NULL )
+        picture_Release( p_tile->p_source );
+    if( p_tile->p_converted != NULL )
+        picture_Release( p_tile->p_converted );
+}
+
+static picture_t *ConvertTile( filter_t *p_filter, const bridged_es_t *p_es,
+                               picture_t *p_pic, const video_format_t *p_fmt_in,
+                               video_format_t *p_fmt_out )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    mosaic_tile_t *p_tile = NULL;
+
+    for( int i = 0; i < p_sys->i_tiles; i++ )
+        if( p_sys->p_tiles[i].p_es == p_es )
+        {
+            p_tile = &p_sys->p_tiles[i];
+            break;
+        }
+
+    if( p_tile == NULL )
+    {
+        mosaic_tile_t *p_tiles = realloc( p_sys->p_tiles,
+                                          ( p_sys->i_tiles + 1 )
+                                          * sizeof( *p_tiles ) );
+        if( unlikely(p_tiles == NULL) )
+            return image_Convert( p_sys->p_image, p_pic, p_fmt_in,
+                                  p_fmt_out );
+        p_sys->p_tiles = p_tiles;
+        p_tile = &p_tiles[p_sys->i_tiles++];
+        p_tile->p_es = p_es;
+        p_tile->p_source = NULL;
+        p_tile->p_converted = NULL;
+    }
+    p_tile->b_used = true;
+
+    if( p_tile->p_source == p_pic
+     && p_tile->p_converted->format.i_chroma == p_fmt_out->i_chroma
+     && p_tile->p_converted->format.i_width == p_fmt_out->i_width
+     && p_tile->p_converted->format.i_height == p_fmt_out->i_height )
+        return picture_Hold( p_tile->p_converted );
+
+    picture_t *p_converted = image_Convert( p_sys->p_image, p_pic, p_fmt_in,
+                                            p_fmt_out );
+    TileClean( p_tile );
+    p_tile->p_source = NULL;
+    p_tile->p_converted = NULL;
+    if( p_converted == NULL )
+        return NULL;
+
+    /* The source is held so that its address cannot be reused meanwhile */
+    p_tile->p_source = picture_Hold( p_pic );
+    p_tile->p_converted = picture_Hold( p_converted );
+    return p_converted;
+}
+
+/* Forget the substreams that are not displayed anymore */
+static void PurgeTiles( filter_sys_t *p_sys )
+{
+    int i_kept = 0;
+
+    for( int i = 0; i < p_sys->i_tiles; i++ )
+    {
+        mosaic_tile_t *p_tile = &p_sys->p_tiles[i];
+
+        if( p_tile->b_used )
+        {
+            p_tile->b_used = false;
+            p_sys->p_tiles[i_kept++] = *p_tile;
+        }
+        else
+            TileClean( p_tile );
+    }
+    p_sys->i_tiles = i_kept;
+}
+
 /*****************************************************************************
  * DestroyFilter: destroy mosaic video filter
  *****************************************************************************/
@@ -413,6 +512,10 @@ static void DestroyFilter( filter_t *p_filter )
     DEL_CB( order );
 #undef DEL_CB
 
+    for( int i = 0; i < p_sys->i_tiles; i++ )
+        TileClean( &p_sys->p_tiles[i] );
+    free( p_sys->p_tiles );
+
     if( !p_sys->b_keep )
     {
         image_HandlerDelete( p_sys->p_image );
@@ -632,8 +735,8 @@ static subpicture_t *Filter( filter_t *p_filter, vlc_tick_t date )
             fmt_out.i_visible_width = fmt_out.i_width;
             fmt_out.i_visible_height = fmt_out.i_height;
 
-            p_converted = image_Convert( p_sys->p_image, p_converted,
-                                         &fmt_in, &fmt_out );
+            p_converted = ConvertTile( p_filter, p_es, p_converted,
+                                       &fmt_in, &fmt_out );
             video_format_Clean( &fmt_in );
             video_format_Clean( &fmt_out );
             if( !p_converted )
@@ -712,6 +815,7 @@ static subpicture_t *Filter( filter_t *p_filter, vlc_tick_t date )
         vlc_spu_regions_push(&p_spu->regions, p_region);
     }
 
+    PurgeTiles( p_sys );
     vlc_global_unlock( VLC_MOSAIC_MUTEX );
     vlc_mutex_unlock( &p_sys->lock );
 
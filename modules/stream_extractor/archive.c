@@ -76,9 +76,13 @@ struct private_sys_t
     uint64_t i_offset;
 
     uint8_t buffer[ 8192 ];
+    uint64_t i_buffer_offset; /* offset of the buffer in the source */
     bool b_seekable_source;
     bool b_seekable_archive;
 
+    bool b_direct; /* stored entry, read straight from the source */
+    uint64_t i_direct_offset; /* offset of the entry data in the source */
+
     libarchive_callback_t** pp_callback_data;
     size_t i_callback_data;
 
@@ -190,6 +194,8 @@ static la_ssize_t libarchive_read_cb( libarchive_t* p_arc, void* p_obj,
     stream_t*  p_source = p_cb->p_source;
     private_sys_t* p_sys = p_cb->p_sys;
 
+    p_sys->i_buffer_offset = vlc_stream_Tell( p_source );
+
     ssize_t i_ret = vlc_stream_Read( p_source, p_sys->buffer,
                                      sizeof( p_sys->buffer ) );
 
@@ -386,6 +392,69 @@ static int archive_seek_subentry( private_sys_t* p_sys, char const* psz_subentry
     return VLC_SUCCESS;
 }
 
+/* Stored entries of single volume archives are contiguous in the source, they
+ * can be read from it directly, and seeking within them is free */
+static void archive_probe_direct( stream_extractor_t* p_extractor )
+{
+    private_sys_t* p_sys = p_extractor->p_sys;
+    libarchive_t* p_arc = p_sys->p_archive;
+    struct archive_entry* p_entry = p_sys->p_entry;
+
+    if( !p_sys->b_seekable_source || p_sys->i_callback_data != 1
+     || archive_filter_code( p_arc, 0 ) != ARCHIVE_FILTER_NONE
+     || !archive_entry_size_is_set( p_entry )
+     || archive_entry_sparse_count( p_entry ) > 0
+#if ARCHIVE_VERSION_NUMBER >= 3002000
+     || archive_entry_is_data_encrypted( p_entry )
+#endif
+      )
+        return;
+
+    /* formats storing the data of each entry in one piece */
+    switch( archive_format( p_arc ) & ARCHIVE_FORMAT_BASE_MASK )
+    {
+        case ARCHIVE_FORMAT_TAR:
+        case ARCHIVE_FORMAT_CPIO:
+        case ARCHIVE_FORMAT_ZIP:
+        case ARCHIVE_FORMAT_AR:
+            break;
+        default:
+            return;
+    }
+
+    const void *arcbuf;
+    size_t arcsize;
+    la_int64_t arcoffset;
+
+    if( archive_read_data_block( p_arc, &arcbuf, &arcsize,
+                                 &arcoffset ) != ARCHIVE_OK )
+        return;
+
+    /* keep the block for Read() if the entry cannot be read directly */
+    p_sys->last_arcbuf = arcbuf;
+    p_sys->last_arcsize = arcsize;
+
+    /* the data was not decoded, nor copied, if it lies in the read buffer */
+    const uint8_t *p_data = arcbuf;
+    if( arcoffset != 0 || p_data < p_sys->buffer
+     || p_data + arcsize > p_sys->buffer + sizeof( p_sys->buffer ) )
+        return;
+
+    uint64_t i_offset = p_sys->i_buffer_offset + ( p_data - p_sys->buffer );
+    uint64_t i_size;
+
+    if( vlc_stream_GetSize( p_sys->source, &i_size )
+     || i_offset + archive_entry_size( p_entry ) > i_size )
+        return;
+
+    msg_Dbg( p_extractor, "stored entry at offset %" PRIu64
+             ", reading it directly", i_offset );
+    p_sys->b_direct = true;
+    p_sys->i_direct_offset = i_offset;
+    p_sys->last_arcbuf = NULL;
+    p_sys->last_arcsize = 0;
+}
+
 static int archive_extractor_reset( stream_extractor_t* p_extractor )
 {
     private_sys_t* p_sys = p_extractor->p_sys;
@@ -494,7 +563,7 @@ static int Control( stream_extractor_t* p_extractor, int i_query, va_list args )
     switch( i_query )
     {
         case STREAM_CAN_FASTSEEK:
-            *va_arg( args, bool* ) = false;
+            *va_arg( args, bool* ) = p_sys->b_direct;
             break;
 
         case STREAM_CAN_SEEK:
@@ -598,6 +667,27 @@ static ssize_t Read( stream_extractor_t *p_extractor, void* p_data, size_t i_siz
     if( p_sys->b_eof )
         return 0;
 
+    if( p_sys->b_direct )
+    {
+        uint64_t i_entry_size = archive_entry_size( p_sys->p_entry );
+
+        if( p_sys->i_offset >= i_entry_size )
+            return 0;
+        if( i_size > i_entry_size - p_sys->i_offset )
+            i_size = i_entry_size - p_sys->i_offset;
+
+        if( vlc_stream_Seek( p_sys->source,
+                             p_sys->i_direct_offset + p_sys->i_offset ) )
+            return 0;
+
+        i_ret = vlc_stream_Read( p_sys->source, p_data, i_size );
+        if( i_ret <= 0 )
+            return 0;
+
+        p_sys->i_offset += i_ret;
+        return i_ret;
+    }
+
     const void *arcbuf = NULL;
     size_t arcsize = 0;
     la_int64_t arcoffset = 0;
@@ -686,6 +776,13 @@ static int Seek( stream_extractor_t* p_extractor, uint64_t i_req )
     }
 
     p_sys->b_eof = false;
+
+    if( p_sys->b_direct )
+    {   /* the next Read() seeks the source */
+        p_sys->i_offset = i_req;
+        return VLC_SUCCESS;
+    }
+
     int ret = VLC_SUCCESS;
 
     if( !p_sys->b_seekable_archive || p_sys->b_dead
@@ -819,6 +916,8 @@ static int ExtractorOpen( vlc_object_t* p_obj )
     }
 
     p_extractor->p_sys = p_sys;
+    archive_probe_direct( p_extractor );
+
     p_extractor->pf_read = Read;
     p_extractor->pf_control = Control;
     p_extractor->pf_seek = Seek;
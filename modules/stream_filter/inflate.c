@@ -33,14 +33,16 @@
 typedef struct
 {
     z_stream zstream;
+    bool gzip;
+    bool member_end; /* a gzip member ended, another one may follow */
+    unsigned members; /* decompressed gzip members */
     bool eof;
-    unsigned char buffer[16384];
+    unsigned char buffer[65536];
 } stream_sys_t;
 
 static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
 {
     stream_sys_t *sys = stream->p_sys;
-    ssize_t val;
 
     if (sys->eof || unlikely(buflen == 0))
         return 0;
@@ -48,50 +50,65 @@ static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
     sys->zstream.next_out = buf;
     sys->zstream.avail_out = buflen;
 
-    if (sys->zstream.avail_in == 0)
-        sys->zstream.next_in = sys->buffer;
-
-    val = (sys->buffer + sizeof (sys->buffer))
-        - (sys->zstream.next_in + sys->zstream.avail_in);
-
-    if (val > 0)
-    {   /* Fill input buffer if there is space left */
-        val = vlc_stream_Read(stream->s,
-                          sys->zstream.next_in + sys->zstream.avail_in, val);
-        if (val >= 0)
-            sys->zstream.avail_in += val;
-    }
-
-    if (sys->zstream.avail_in == 0)
+    /* Decompress straight into the caller buffer, as much as possible */
+    do
     {
-        msg_Err(stream, "unexpected end of stream");
-        return 0;
-    }
-
-    val = inflate(&sys->zstream, Z_SYNC_FLUSH);
-    switch (val)
-    {
-        case Z_STREAM_END:
-            msg_Dbg(stream, "end of stream");
-            sys->eof = true;
-            /* fall through */
-        case Z_OK:
-            return buflen - sys->zstream.avail_out;
-        case Z_DATA_ERROR:
-            msg_Err(stream, "corrupt stream");
-            sys->eof = true;
-            return -1;
-        case Z_BUF_ERROR:
-            if (sys->zstream.next_in == sys->buffer)
+        if (sys->zstream.avail_in == 0)
+        {
+            ssize_t val = vlc_stream_Read(stream->s, sys->buffer,
+                                          sizeof (sys->buffer));
+            if (val <= 0)
+            {
+                if (sys->member_end)
+                    msg_Dbg(stream, "end of stream");
+                else
+                    msg_Err(stream, "unexpected end of stream");
+                sys->eof = true;
                 break;
-
-            memmove(sys->buffer, sys->zstream.next_in, sys->zstream.avail_in);
+            }
             sys->zstream.next_in = sys->buffer;
-            return Read(stream, buf, buflen);
+            sys->zstream.avail_in = val;
+        }
+
+        if (sys->member_end)
+        {   /* Concatenated gzip files are valid gzip files (RFC1952) */
+            inflateReset(&sys->zstream);
+            sys->member_end = false;
+        }
+
+        int val = inflate(&sys->zstream, Z_NO_FLUSH);
+        switch (val)
+        {
+            case Z_STREAM_END:
+                if (sys->gzip)
+                {
+                    sys->members++;
+                    sys->member_end = true;
+                    break;
+                }
+                msg_Dbg(stream, "end of stream");
+                sys->eof = true;
+                return buflen - sys->zstream.avail_out;
+            case Z_OK:
+            case Z_BUF_ERROR: /* more input needed */
+                break;
+            case Z_DATA_ERROR:
+                sys->eof = true;
+                if (sys->members > 0 && sys->zstream.total_out == 0)
+                {   /* not another member, ignore it like gzip does */
+                    msg_Warn(stream, "trailing garbage ignored");
+                    return buflen - sys->zstream.avail_out;
+                }
+                msg_Err(stream, "corrupt stream");
+                return -1;
+            default:
+                msg_Err(stream, "unhandled decompression error (%d)", val);
+                return -1;
+        }
     }
+    while (sys->zstream.avail_out == buflen);
 
-    msg_Err(stream, "unhandled decompression error (%zd)", val);
-    return -1;
+    return buflen - sys->zstream.avail_out;
 }
 
 static int Seek(stream_t *stream, uint64_t offset)
@@ -161,6 +178,9 @@ static int Open(vlc_object_t *obj)
     sys->zstream.zalloc = Z_NULL;
     sys->zstream.zfree = Z_NULL;
     sys->zstream.opaque = Z_NULL;
+    sys->gzip = bits > 15;
+    sys->member_end = false;
+    sys->members = 0;
     sys->eof = false;
 
     int ret = inflateInit2(&sys->zstream, bits);
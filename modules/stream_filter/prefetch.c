@@ -49,6 +49,16 @@ struct stream_ctrl
     };
 };
 
+/* Cached range of the stream, as a circular buffer */
+struct prefetch_range
+{
+    uint64_t     offset;   /* Stream offset of the first byte in the buffer */
+    size_t       length;   /* Number of bytes in the buffer */
+    char        *buffer;
+    uint64_t     last_use; /* For least recently used replacement */
+    bool         eof;      /* The end of stream is at offset + length */
+};
+
 typedef struct
 {
     vlc_mutex_t  lock;
@@ -57,7 +67,6 @@ typedef struct
     vlc_thread_t thread;
     vlc_interrupt_t *interrupt;
 
-    bool         eof;
     bool         error;
     bool         paused;
 
@@ -69,13 +78,21 @@ typedef struct
     vlc_tick_t   pts_delay;
     char        *content_type;
 
-    uint64_t     buffer_offset;
     uint64_t     stream_offset;
-    size_t       buffer_length;
-    size_t       buffer_size;
+    uint64_t     upstream_offset;
+    size_t       buffer_size; /* Per range */
     char        *buffer;
     size_t       seek_threshold;
 
+    struct prefetch_range *ranges;
+    unsigned     range_count;
+    unsigned     active;       /* Range serving the stream offset */
+    unsigned     previous;     /* Previously active range */
+    unsigned     alternations; /* Consecutive switches back and forth */
+    uint64_t     use_count;
+
+    struct vlc_stream_cache_stats stats;
+
     struct stream_ctrl *controls;
 } stream_sys_t;
 
@@ -89,6 +106,11 @@ static ssize_t ThreadRead(stream_t *stream, void *buf, size_t length)
     ssize_t val = vlc_stream_ReadPartial(stream->s, buf, length);
 
     vlc_mutex_lock(&sys->lock);
+    if (val > 0)
+    {
+        sys->upstream_offset += val;
+        sys->stats.upstream_bytes += val;
+    }
     return val;
 }
 
@@ -103,8 +125,12 @@ static int ThreadSeek(stream_t *stream, uint64_t seek_offset)
         msg_Err(stream, "cannot seek (to offset %"PRIu64")", seek_offset);
 
     vlc_mutex_lock(&sys->lock);
+    sys->stats.upstream_seeks++;
+    if (val != VLC_SUCCESS)
+        return -1;
 
-    return (val == VLC_SUCCESS) ? 0 : -1;
+    sys->upstream_offset = seek_offset;
+    return 0;
 }
 
 static int ThreadControl(stream_t *stream, int query, ...)
@@ -163,15 +189,16 @@ static void *Thread(void *data)
         }
 
         uint_fast64_t stream_offset = sys->stream_offset;
+        struct prefetch_range *range = &sys->ranges[sys->active];
 
-        if (stream_offset < sys->buffer_offset)
+        if (stream_offset < range->offset)
         {   /* Need to seek backward */
             if (ThreadSeek(stream, stream_offset) == 0)
             {
-                sys->buffer_offset = stream_offset;
-                sys->buffer_length = 0;
+                range->offset = stream_offset;
+                range->length = 0;
                 assert(!sys->error);
-                sys->eof = false;
+                range->eof = false;
             }
             else
             {
@@ -181,33 +208,52 @@ static void *Thread(void *data)
             continue;
         }
 
-        if (sys->eof)
-        {   /* Do not attempt to read at EOF - would busy loop */
-            vlc_cond_wait(&sys->wait_space, &sys->lock);
-            continue;
-        }
-
-        assert(stream_offset >= sys->buffer_offset);
+        assert(stream_offset >= range->offset);
 
         /* As long as there is space, the buffer will retain already read
          * ("historical") data. The data can be used if/when seeking backward.
          * Unread data is however given precedence if the buffer is full. */
-        uint64_t history = stream_offset - sys->buffer_offset;
+        uint64_t history = stream_offset - range->offset;
+        struct prefetch_range *ahead = NULL;
+
+        /* When the demuxer alternates between far apart ranges, fill the
+         * one it will come back to while the active range is full enough,
+         * rather than seeking upstream back and forth on every read. */
+        if (sys->alternations >= 2)
+        {
+            struct prefetch_range *other = &sys->ranges[sys->previous];
+            uint64_t level = range->length > history ? range->length - history
+                                                     : 0;
+
+            if (!other->eof && other->length < sys->buffer_size
+             && level >= sys->buffer_size / 2
+             && (range->length == sys->buffer_size
+              || sys->upstream_offset == other->offset + other->length))
+                ahead = other;
+        }
+
+        if (ahead != NULL)
+            range = ahead;
+        else if (range->eof)
+        {   /* Do not attempt to read at EOF - would busy loop */
+            vlc_cond_wait(&sys->wait_space, &sys->lock);
+            continue;
+        }
 
         /* If upstream supports seeking and if the downstream offset is far
          * beyond the upstream offset, then attempt to skip forward.
          * If it fails, assume upstream is well-behaved such that the failed
          * seek is a no-op, and continue as if seeking was not supported.
          * WARNING: Except problems with misbehaving access plug-ins. */
-        if (sys->can_seek
-         && history >= (sys->buffer_length + sys->seek_threshold))
+        if (ahead == NULL && sys->can_seek
+         && history >= (range->length + sys->seek_threshold))
         {
             if (ThreadSeek(stream, stream_offset) == 0)
             {
-                sys->buffer_offset = stream_offset;
-                sys->buffer_length = 0;
+                range->offset = stream_offset;
+                range->length = 0;
                 assert(!sys->error);
-                assert(!sys->eof);
+                range->eof = false;
             }
             else
             {   /* Seek failure is not necessarily fatal here. We could read
@@ -221,9 +267,9 @@ static void *Thread(void *data)
             continue;
         }
 
-        assert(sys->buffer_size >= sys->buffer_length);
+        assert(sys->buffer_size >= range->length);
 
-        size_t len = sys->buffer_size - sys->buffer_length;
+        size_t len = sys->buffer_size - range->length;
         if (len == 0)
         {   /* Buffer is full */
             if (history == 0)
@@ -233,32 +279,43 @@ static void *Thread(void *data)
             }
 
             /* Discard some historical data to make room. */
-            len = history > sys->buffer_length ? sys->buffer_length : history;
+            len = history > range->length ? range->length : history;
+
+            range->offset += len;
+            range->length -= len;
+        }
 
-            sys->buffer_offset += len;
-            sys->buffer_length -= len;
+        /* Ranges may be filled alternately */
+        uint64_t end = range->offset + range->length;
+        if (sys->upstream_offset != end)
+        {
+            if (ThreadSeek(stream, end))
+            {
+                sys->error = true;
+                vlc_cond_signal(&sys->wait_data);
+            }
+            continue;
         }
 
-        size_t offset = (sys->buffer_offset + sys->buffer_length)
-                        % sys->buffer_size;
+        size_t offset = end % sys->buffer_size;
          /* Do not step past the sharp edge of the circular buffer */
         if (offset + len > sys->buffer_size)
             len = sys->buffer_size - offset;
 
-        ssize_t val = ThreadRead(stream, sys->buffer + offset, len);
+        ssize_t val = ThreadRead(stream, range->buffer + offset, len);
         if (val < 0)
             continue;
         if (val == 0)
         {
             assert(len > 0);
             msg_Dbg(stream, "end of stream");
-            sys->eof = true;
+            range->eof = true;
         }
 
         assert((size_t)val <= len);
-        sys->buffer_length += val;
-        assert(sys->buffer_length <= sys->buffer_size);
-        //msg_Dbg(stream, "buffer: %zu/%zu", sys->buffer_length,
+        range->length += val;
+        assert(range->length <= sys->buffer_size);
+        //msg_Dbg(stream, "buffer: %zu/%zu", range->length,
         //        sys->buffer_size);
         vlc_cond_signal(&sys->wait_data);
     }
@@ -269,11 +326,61 @@ static void *Thread(void *data)
     return NULL;
 }
 
+static void SelectRange(stream_sys_t *sys, uint64_t offset)
+{
+    unsigned selected = sys->active;
+    unsigned oldest = sys->active;
+    bool hit = false, near = false;
+
+    for (unsigned i = 0; i < sys->range_count; i++)
+    {
+        const struct prefetch_range *range = &sys->ranges[i];
+        uint64_t end = range->offset + range->length;
+
+        if (offset >= range->offset && offset <= end)
+        {   /* Cached (or to be read next) */
+            if (!hit || i == sys->active)
+                selected = i;
+            hit = true;
+        }
+        else if (!hit && !near && offset > end
+              && offset - end < sys->seek_threshold)
+        {   /* Close enough to keep reading forward */
+            selected = i;
+            near = true;
+        }
+
+        if (range->last_use < sys->ranges[oldest].last_use)
+            oldest = i;
+    }
+
+    if (hit)
+        sys->stats.hits++;
+    else
+    {
+        sys->stats.misses++;
+        if (!near)
+            selected = oldest;
+    }
+
+    if (selected != sys->active)
+    {
+        if (selected == sys->previous)
+            sys->alternations++;
+        else
+            sys->alternations = 0;
+        sys->previous = sys->active;
+        sys->active = selected;
+    }
+    sys->ranges[selected].last_use = ++sys->use_count;
+}
+
 static int Seek(stream_t *stream, uint64_t offset)
 {
     stream_sys_t *sys = stream->p_sys;
 
     vlc_mutex_lock(&sys->lock);
+    SelectRange(sys, offset);
     sys->stream_offset = offset;
     sys->error = false;
     vlc_cond_signal(&sys->wait_space);
@@ -284,17 +391,18 @@ static int Seek(stream_t *stream, uint64_t offset)
 static size_t BufferLevel(const stream_t *stream, bool *eof)
 {
     stream_sys_t *sys = stream->p_sys;
+    const struct prefetch_range *range = &sys->ranges[sys->active];
 
     *eof = false;
 
-    if (sys->stream_offset < sys->buffer_offset)
+    if (sys->stream_offset < range->offset)
         return 0;
-    if ((sys->stream_offset - sys->buffer_offset) >= sys->buffer_length)
+    if ((sys->stream_offset - range->offset) >= range->length)
     {
-        *eof = sys->eof;
+        *eof = range->eof;
         return 0;
     }
-    return sys->buffer_offset + sys->buffer_length - sys->stream_offset;
+    return range->offset + range->length - sys->stream_offset;
 }
 
 static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
@@ -336,7 +444,7 @@ static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
     if (offset + copy > sys->buffer_size)
         copy = sys->buffer_size - offset;
 
-    memcpy(buf, sys->buffer + offset, copy);
+    memcpy(buf, sys->ranges[sys->active].buffer + offset, copy);
     sys->stream_offset += copy;
     vlc_cond_signal(&sys->wait_space);
     vlc_mutex_unlock(&sys->lock);
@@ -388,6 +496,16 @@ static int Control(stream_t *stream, int query, va_list args)
         case STREAM_GET_TAGS:
         case STREAM_GET_TYPE:
             return VLC_EGENERIC;
+        case STREAM_GET_CACHE_STATS:
+        {
+            struct vlc_stream_cache_stats *stats = va_arg(args,
+                                              struct vlc_stream_cache_stats *);
+            vlc_mutex_lock(&sys->lock);
+            *stats = sys->stats;
+            stats->alternating = sys->alternations >= 2;
+            vlc_mutex_unlock(&sys->lock);
+            break;
+        }
         case STREAM_SET_PAUSE_STATE:
         {
             bool paused = va_arg(args, unsigned);
@@ -464,15 +582,22 @@ static int Open(vlc_object_t *obj)
     if (vlc_stream_GetContentType(stream->s, &sys->content_type) != VLC_SUCCESS)
         sys->content_type = NULL;
 
-    sys->eof = false;
     sys->error = false;
     sys->paused = false;
-    sys->buffer_offset = 0;
     sys->stream_offset = 0;
-    sys->buffer_length = 0;
+    sys->upstream_offset = 0;
     sys->buffer_size = var_InheritInteger(obj, "prefetch-buffer-size") << 10u;
     sys->seek_threshold = var_InheritInteger(obj, "prefetch-seek-threshold");
     sys->controls = NULL;
+    sys->ranges = NULL;
+
+    /* Each range gets a share of the buffer, down to 64 KiB */
+    unsigned count = var_InheritInteger(obj, "prefetch-ranges");
+    if (!sys->can_seek)
+        count = 1;
+    if (count > sys->buffer_size >> 16)
+        count = __MAX(sys->buffer_size >> 16, 1);
+    sys->buffer_size /= count;
 
     uint64_t size = stream_Size(stream->s);
     if (size > 0)
@@ -481,10 +606,29 @@ static int Open(vlc_object_t *obj)
             sys->buffer_size = size;
     }
 
-    sys->buffer = malloc(sys->buffer_size);
-    if (sys->buffer == NULL)
+    sys->buffer = vlc_alloc(count, sys->buffer_size);
+    sys->ranges = vlc_alloc(count, sizeof (*sys->ranges));
+    if (sys->buffer == NULL || sys->ranges == NULL)
         goto error;
 
+    for (unsigned i = 0; i < count; i++)
+    {
+        struct prefetch_range *range = &sys->ranges[i];
+
+        range->offset = 0;
+        range->length = 0;
+        range->buffer = sys->buffer + i * sys->buffer_size;
+        range->last_use = 0;
+        range->eof = false;
+    }
+    sys->range_count = count;
+    sys->active = 0;
+    sys->previous = 0;
+    sys->alternations = 0;
+    sys->use_count = 0;
+    memset(&sys->stats, 0, sizeof (sys->stats));
+    sys->stats.ranges = count;
+
     sys->interrupt = vlc_interrupt_create();
     if (unlikely(sys->interrupt == NULL))
         goto error;
@@ -501,13 +645,15 @@ static int Open(vlc_object_t *obj)
         goto error;
     }
 
-    msg_Dbg(stream, "using %zu bytes buffer", sys->buffer_size);
+    msg_Dbg(stream, "using %u x %zu bytes buffer", sys->range_count,
+            sys->buffer_size);
     stream->pf_read = Read;
     stream->pf_seek = Seek;
     stream->pf_control = Control;
     return VLC_SUCCESS;
 
 error:
+    free(sys->ranges);
     free(sys->buffer);
     free(sys->content_type);
     free(sys);
@@ -537,6 +683,10 @@ static void Close (vlc_object_t *obj)
         sys->controls = ctrl->next;
         free(ctrl);
     }
+    msg_Dbg(stream, "%"PRIu64" seek hits, %"PRIu64" misses, %"PRIu64
+            " upstream seeks", sys->stats.hits, sys->stats.misses,
+            sys->stats.upstream_seeks);
+    free(sys->ranges);
     free(sys->buffer);
     free(sys->content_type);
     free(sys);
@@ -556,4 +706,9 @@ vlc_module_begin()
     add_integer("prefetch-seek-threshold", 1 << 14, N_("Seek threshold"),
                 N_("Prefetch forward seek threshold (bytes)"))
         change_integer_range(0, UINT64_C(1) << 60)
+    add_integer("prefetch-ranges", 1, N_("Cached ranges"),
+                N_("Number of distinct ranges of the stream kept in the "
+                   "buffer, for formats read at far apart offsets. "
+                   "The buffer size is shared between them."))
+        change_integer_range(1, 16)
 vlc_module_end()
@@ -32,10 +32,23 @@
 #include <vlc_plugin.h>
 
 #include <assert.h>
+#include <fcntl.h>
 #include <vlc_stream.h>
 #include <vlc_input_item.h>
+#include <vlc_block.h>
+#include <vlc_sout.h>
 #include <vlc_fs.h>
 
+/* Size of the batches handed to the writer thread */
+#define RECORD_BATCH_SIZE (256 * 1024)
+
+/* Write from a separate thread, and reserve the disk space by 16 MiB chunks */
+#ifdef FALLOC_FL_KEEP_SIZE
+# define RECORD_ACCESS "file{no-append,no-format,overwrite,async,prealloc=16}"
+#else
+# define RECORD_ACCESS "file{no-append,no-format,overwrite,async}"
+#endif
+
 
 /*****************************************************************************
  * Module descriptor
@@ -55,7 +68,8 @@ vlc_module_end()
  *****************************************************************************/
 typedef struct
 {
-    FILE *f;        /* TODO it could be replaced by access_output_t one day */
+    sout_access_out_t *p_out;
+    block_t *p_batch; /* data not handed to the access output yet */
     bool b_error;
 } stream_sys_t;
 
@@ -70,6 +84,7 @@ static int  Control( stream_t *, int i_query, va_list );
 static int  Start  ( stream_t *, const char *dir_path, const char *psz_extension );
 static int  Stop   ( stream_t * );
 static void Write  ( stream_t *, const uint8_t *p_buffer, size_t i_buffer );
+static void Flush  ( stream_t * );
 
 /****************************************************************************
  * Open
@@ -84,7 +99,8 @@ static int Open ( vlc_object_t *p_this )
     if( !p_sys )
         return VLC_ENOMEM;
 
-    p_sys->f = NULL;
+    p_sys->p_out = NULL;
+    p_sys->p_batch = NULL;
 
     /* */
     s->pf_read = Read;
@@ -102,7 +118,7 @@ static void Close( vlc_object_t *p_this )
     stream_t *s = (stream_t*)p_this;
     stream_sys_t *p_sys = s->p_sys;
 
-    if( p_sys->f )
+    if( p_sys->p_out )
         Stop( s );
 
     free( p_sys );
@@ -118,7 +134,7 @@ static ssize_t Read( stream_t *s, void *p_read, size_t i_read )
     const ssize_t i_record = vlc_stream_Read( s->s, p_record, i_read );
 
     /* Dump read data */
-    if( p_sys->f )
+    if( p_sys->p_out )
     {
         if( p_record && i_record > 0 )
             Write( s, p_record, i_record );
@@ -146,7 +162,7 @@ static int Control( stream_t *s, int i_query, va_list args )
         psz_extension = va_arg( args, const char* );
     }
 
-    if( !sys->f == !b_active )
+    if( !sys->p_out == !b_active )
         return VLC_SUCCESS;
 
     if( b_active )
@@ -175,7 +191,7 @@ static int Start( stream_t *s, const char *dir_path, const char *psz_extension )
     stream_sys_t *p_sys = s->p_sys;
 
     char *psz_file;
-    FILE *f;
+    sout_access_out_t *p_out;
 
     /* */
     if( !psz_extension )
@@ -204,8 +220,9 @@ static int Start( stream_t *s, const char *dir_path, const char *psz_extension )
     if( !psz_file )
         return VLC_ENOMEM;
 
-    f = vlc_fopen( psz_file, "wb" );
-    if( !f )
+    /* The data is written from a separate thread, not to block the input */
+    p_out = sout_AccessOutNew( s, RECORD_ACCESS, psz_file );
+    if( !p_out )
     {
         free( psz_file );
         return VLC_EGENERIC;
@@ -218,7 +235,8 @@ static int Start( stream_t *s, const char *dir_path, const char *psz_extension )
     free( psz_file );
 
     /* */
-    p_sys->f = f;
+    p_sys->p_out = p_out;
+    p_sys->p_batch = NULL;
     p_sys->b_error = false;
     return VLC_SUCCESS;
 }
@@ -226,31 +244,62 @@ static int Stop( stream_t *s )
 {
     stream_sys_t *p_sys = s->p_sys;
 
-    assert( p_sys->f );
+    assert( p_sys->p_out );
 
+    Flush( s );
+    /* Waits for the queued data to be written */
+    sout_AccessOutDelete( p_sys->p_out );
+    p_sys->p_out = NULL;
     msg_Dbg( s, "Recording completed" );
-    fclose( p_sys->f );
-    p_sys->f = NULL;
     return VLC_SUCCESS;
 }
 
+static void Flush( stream_t *s )
+{
+    stream_sys_t *p_sys = s->p_sys;
+    block_t *p_batch = p_sys->p_batch;
+
+    if( !p_batch )
+        return;
+    p_sys->p_batch = NULL;
+
+    const bool b_previous_error = p_sys->b_error;
+    p_sys->b_error = sout_AccessOutWrite( p_sys->p_out, p_batch ) < 0;
+
+    /* TODO maybe a intf_UserError or something like that ? */
+    if( p_sys->b_error && !b_previous_error )
+        msg_Err( s, "Failed to record data (begin)" );
+    else if( !p_sys->b_error && b_previous_error )
+        msg_Err( s, "Failed to record data (end)" );
+}
+
 static void Write( stream_t *s, const uint8_t *p_buffer, size_t i_buffer )
 {
     stream_sys_t *p_sys = s->p_sys;
 
-    assert( p_sys->f );
+    assert( p_sys->p_out );
 
-    if( i_buffer > 0 )
+    /* Gather the reads, often small, into large writes */
+    while( i_buffer > 0 )
     {
-        const bool b_previous_error = p_sys->b_error;
-        const size_t i_written = fwrite( p_buffer, 1, i_buffer, p_sys->f );
+        block_t *p_batch = p_sys->p_batch;
+
+        if( !p_batch )
+        {
+            p_batch = block_Alloc( RECORD_BATCH_SIZE );
+            if( !p_batch )
+                return;
+            p_batch->i_buffer = 0;
+            p_sys->p_batch = p_batch;
+        }
 
-        p_sys->b_error = i_written != i_buffer;
+        size_t i_copy = __MIN( i_buffer, RECORD_BATCH_SIZE - p_batch->i_buffer );
+        memcpy( &p_batch->p_buffer[p_batch->i_buffer], p_buffer, i_copy );
+        p_batch->i_buffer += i_copy;
+        p_buffer += i_copy;
+        i_buffer -= i_copy;
 
-        /* TODO maybe a intf_UserError or something like that ? */
-        if( p_sys->b_error && !b_previous_error )
-            msg_Err( s, "Failed to record data (begin)" );
-        else if( !p_sys->b_error && b_previous_error )
-            msg_Err( s, "Failed to record data (end)" );
+        if( p_batch->i_buffer == RECORD_BATCH_SIZE )
+            Flush( s );
     }
 }
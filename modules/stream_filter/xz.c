@@ -0,0 +1,207 @@
+/*****************************************************************************
+ * xz.c: xz decompression module for VLC
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <lzma.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_stream.h>
+
+/* Blocks are decoded in parallel if the encoder was multi-threaded too */
+#define XZ_MAX_THREADS 8
+
+typedef struct
+{
+    lzma_stream lzma;
+    lzma_action action;
+    unsigned threads; /* reserved from the CPU budget */
+    bool eof;
+    uint8_t buffer[65536];
+} stream_sys_t;
+
+static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
+{
+    stream_sys_t *sys = stream->p_sys;
+
+    if (sys->eof || unlikely(buflen == 0))
+        return 0;
+
+    sys->lzma.next_out = buf;
+    sys->lzma.avail_out = buflen;
+
+    do
+    {
+        if (sys->lzma.avail_in == 0 && sys->action == LZMA_RUN)
+        {
+            ssize_t val = vlc_stream_Read(stream->s, sys->buffer,
+                                          sizeof (sys->buffer));
+            if (val > 0)
+            {
+                sys->lzma.next_in = sys->buffer;
+                sys->lzma.avail_in = val;
+            }
+            else /* flush the decoder threads */
+                sys->action = LZMA_FINISH;
+        }
+
+        lzma_ret ret = lzma_code(&sys->lzma, sys->action);
+        switch (ret)
+        {
+            case LZMA_OK:
+                break;
+            case LZMA_STREAM_END:
+                msg_Dbg(stream, "end of stream");
+                sys->eof = true;
+                return buflen - sys->lzma.avail_out;
+            case LZMA_BUF_ERROR:
+                msg_Err(stream, "unexpected end of stream");
+                sys->eof = true;
+                return buflen - sys->lzma.avail_out;
+            case LZMA_DATA_ERROR:
+            case LZMA_FORMAT_ERROR:
+                msg_Err(stream, "corrupt stream");
+                sys->eof = true;
+                return -1;
+            case LZMA_MEM_ERROR:
+            case LZMA_MEMLIMIT_ERROR:
+                msg_Err(stream, "out of memory");
+                sys->eof = true;
+                return -1;
+            default:
+                msg_Err(stream, "unhandled decompression error (%d)", ret);
+                sys->eof = true;
+                return -1;
+        }
+    }
+    while (sys->lzma.avail_out == buflen);
+
+    return buflen - sys->lzma.avail_out;
+}
+
+static int Seek(stream_t *stream, uint64_t offset)
+{
+    (void) stream; (void) offset;
+    return -1;
+}
+
+static int Control(stream_t *stream, int query, va_list args)
+{
+    switch (query)
+    {
+        case STREAM_CAN_SEEK:
+        case STREAM_CAN_FASTSEEK:
+            *va_arg(args, bool *) = false;
+            break;
+        case STREAM_CAN_PAUSE:
+        case STREAM_CAN_CONTROL_PACE:
+        case STREAM_GET_PTS_DELAY:
+        case STREAM_GET_META:
+        case STREAM_GET_CONTENT_TYPE:
+        case STREAM_GET_SIGNAL:
+        case STREAM_SET_PAUSE_STATE:
+        case STREAM_GET_MTIME:
+            return vlc_stream_vaControl(stream->s, query, args);
+        case STREAM_GET_SIZE:
+        case STREAM_GET_TITLE_INFO:
+        case STREAM_GET_TITLE:
+        case STREAM_GET_SEEKPOINT:
+        case STREAM_SET_TITLE:
+        case STREAM_SET_SEEKPOINT:
+        case STREAM_SET_PRIVATE_ID_STATE:
+        case STREAM_SET_PRIVATE_ID_CA:
+        case STREAM_GET_PRIVATE_ID_STATE:
+            return VLC_EGENERIC;
+        default:
+            msg_Err(stream, "unimplemented query (%d) in control", query);
+            return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+static int Open(vlc_object_t *obj)
+{
+    stream_t *stream = (stream_t *)obj;
+    const uint8_t *peek;
+
+    /* xz stream header magic bytes */
+    if (vlc_stream_Peek(stream->s, &peek, 6) < 6)
+        return VLC_EGENERIC;
+    if (memcmp(peek, "\xFD" "7zXZ\x00", 6))
+        return VLC_EGENERIC;
+
+    stream_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    sys->lzma = (lzma_stream)LZMA_STREAM_INIT;
+    sys->action = LZMA_RUN;
+    sys->threads = vlc_CPUBudgetAcquire(XZ_MAX_THREADS);
+    sys->eof = false;
+
+    /* Same threading memory limit as the xz tool: a quarter of the RAM. The
+     * decoder falls back to a single thread rather than failing above it. */
+    uint64_t memlimit = lzma_physmem() / 4;
+    const lzma_mt mt = {
+        .flags = LZMA_CONCATENATED,
+        .threads = sys->threads,
+        .memlimit_threading = memlimit ? memlimit : (UINT64_C(1) << 30),
+        .memlimit_stop = UINT64_MAX,
+    };
+
+    lzma_ret ret = lzma_stream_decoder_mt(&sys->lzma, &mt);
+    if (ret != LZMA_OK)
+    {
+        vlc_CPUBudgetRelease(sys->threads);
+        free(sys);
+        return (ret == LZMA_MEM_ERROR) ? VLC_ENOMEM : VLC_EGENERIC;
+    }
+
+    msg_Dbg(obj, "detected xz compressed stream (%u threads)", sys->threads);
+    stream->p_sys = sys;
+    stream->pf_read = Read;
+    stream->pf_seek = Seek;
+    stream->pf_control = Control;
+    return VLC_SUCCESS;
+}
+
+static void Close(vlc_object_t *obj)
+{
+    stream_t *stream = (stream_t *)obj;
+    stream_sys_t *sys = stream->p_sys;
+
+    lzma_end(&sys->lzma);
+    vlc_CPUBudgetRelease(sys->threads);
+    free(sys);
+}
+
+vlc_module_begin()
+    set_subcategory(SUBCAT_INPUT_STREAM_FILTER)
+    /* above the decomp module, which pipes through the xzcat tool */
+    set_capability("stream_filter", 325)
+
+    set_description(N_("xz decompression filter"))
+    set_callbacks(Open, Close)
+vlc_module_end()
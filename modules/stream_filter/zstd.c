@@ -0,0 +1,347 @@
+/*****************************************************************************
+ * zstd.c: Zstandard decompression module for VLC
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <zstd.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_stream.h>
+
+/* Seekable format, see contrib/seekable_format in the zstd sources */
+#define SKIPPABLE_MAGIC 0x184D2A5E
+#define SEEKABLE_MAGIC  0x8F92EAB1
+#define SEEK_TABLE_FOOTER_SIZE 9
+#define SEEK_TABLE_MAX_FRAMES 0x8000000
+
+struct zstd_frame
+{
+    uint64_t offset; /* in the compressed stream */
+    uint64_t pos; /* in the decompressed stream */
+};
+
+typedef struct
+{
+    ZSTD_DStream *zds;
+    ZSTD_inBuffer in;
+    size_t pending; /* 0 at the end of a frame */
+    uint64_t pos; /* decompressed bytes read */
+    bool can_seek;
+    bool eof;
+
+    /* Seek table, with a last entry for the end of the stream */
+    struct zstd_frame *frames;
+    size_t frame_count;
+
+    uint8_t *buffer;
+    size_t buffer_size;
+} stream_sys_t;
+
+static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
+{
+    stream_sys_t *sys = stream->p_sys;
+    ZSTD_outBuffer out = { .dst = buf, .size = buflen, .pos = 0 };
+
+    if (sys->eof || unlikely(buflen == 0))
+        return 0;
+
+    /* Decompress straight into the caller buffer */
+    do
+    {
+        if (sys->in.pos == sys->in.size)
+        {
+            ssize_t val = vlc_stream_Read(stream->s, sys->buffer,
+                                          sys->buffer_size);
+            if (val <= 0)
+            {
+                if (sys->pending != 0)
+                    msg_Err(stream, "unexpected end of stream");
+                else
+                    msg_Dbg(stream, "end of stream");
+                sys->eof = true;
+                break;
+            }
+            sys->in.src = sys->buffer;
+            sys->in.size = val;
+            sys->in.pos = 0;
+        }
+
+        /* Concatenated and skippable frames are handled by this call */
+        size_t ret = ZSTD_decompressStream(sys->zds, &out, &sys->in);
+        if (ZSTD_isError(ret))
+        {
+            msg_Err(stream, "decompression error: %s", ZSTD_getErrorName(ret));
+            sys->eof = true;
+            return -1;
+        }
+        sys->pending = ret;
+    }
+    while (out.pos == 0);
+
+    sys->pos += out.pos;
+    return out.pos;
+}
+
+static int Skip(stream_t *stream, uint64_t offset)
+{
+    stream_sys_t *sys = stream->p_sys;
+    uint8_t buf[4096];
+
+    while (sys->pos < offset)
+    {
+        size_t len = __MIN(offset - sys->pos, sizeof (buf));
+        ssize_t val = Read(stream, buf, len);
+
+        if (val < 0)
+            return -1;
+        if (val == 0)
+            break; /* past the end */
+    }
+    return 0;
+}
+
+static int Seek(stream_t *stream, uint64_t offset)
+{
+    stream_sys_t *sys = stream->p_sys;
+    struct zstd_frame start = { 0, 0 };
+
+    if (sys->frames != NULL)
+    {   /* Find the last frame starting before the offset */
+        size_t lo = 0, hi = sys->frame_count;
+
+        while (hi - lo > 1)
+        {
+            size_t mid = (lo + hi) / 2;
+
+            if (sys->frames[mid].pos <= offset)
+                lo = mid;
+            else
+                hi = mid;
+        }
+        start = sys->frames[lo];
+
+        /* Within the current frame and ahead, keep on decompressing */
+        if (start.pos <= sys->pos && sys->pos <= offset && !sys->eof)
+            return Skip(stream, offset);
+    }
+    else if (offset >= sys->pos)
+        return Skip(stream, offset);
+
+    if (!sys->can_seek || vlc_stream_Seek(stream->s, start.offset))
+        return -1;
+
+    ZSTD_DCtx_reset(sys->zds, ZSTD_reset_session_only);
+    sys->in.size = sys->in.pos = 0;
+    sys->pending = 0;
+    sys->pos = start.pos;
+    sys->eof = false;
+    return Skip(stream, offset);
+}
+
+/* Loads the seek table from the skippable frame at the end of the stream */
+static void LoadSeekTable(stream_t *stream)
+{
+    stream_sys_t *sys = stream->p_sys;
+    uint64_t size;
+    uint8_t hdr[SEEK_TABLE_FOOTER_SIZE];
+    bool fast;
+
+    /* Not worth extra round trips over the network */
+    if (!sys->can_seek
+     || vlc_stream_Control(stream->s, STREAM_CAN_FASTSEEK, &fast) || !fast
+     || vlc_stream_GetSize(stream->s, &size)
+     || size < 8 + SEEK_TABLE_FOOTER_SIZE)
+        return;
+
+    if (vlc_stream_Seek(stream->s, size - SEEK_TABLE_FOOTER_SIZE)
+     || vlc_stream_Read(stream->s, hdr, SEEK_TABLE_FOOTER_SIZE)
+            != SEEK_TABLE_FOOTER_SIZE
+     || GetDWLE(hdr + 5) != SEEKABLE_MAGIC
+     || (hdr[4] & 0x7C) /* reserved bits */)
+        goto out;
+
+    uint32_t count = GetDWLE(hdr);
+    size_t entry_size = (hdr[4] & 0x80) ? 12 : 8; /* with checksums */
+    uint64_t table_size = (uint64_t)count * entry_size
+                        + SEEK_TABLE_FOOTER_SIZE;
+
+    if (count == 0 || count > SEEK_TABLE_MAX_FRAMES
+     || table_size + 8 > size)
+        goto out;
+
+    uint8_t *table = malloc(table_size - SEEK_TABLE_FOOTER_SIZE + 8);
+    struct zstd_frame *frames = vlc_alloc(count + 1, sizeof (*frames));
+    if (unlikely(table == NULL || frames == NULL))
+        goto error;
+
+    uint64_t table_offset = size - table_size - 8;
+    size_t len = table_size - SEEK_TABLE_FOOTER_SIZE + 8;
+
+    if (vlc_stream_Seek(stream->s, table_offset)
+     || (size_t)vlc_stream_Read(stream->s, table, len) != len
+     || GetDWLE(table) != SKIPPABLE_MAGIC
+     || GetDWLE(table + 4) != table_size)
+        goto error;
+
+    uint64_t offset = 0, pos = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const uint8_t *entry = table + 8 + i * entry_size;
+
+        frames[i].offset = offset;
+        frames[i].pos = pos;
+        offset += GetDWLE(entry);
+        pos += GetDWLE(entry + 4);
+    }
+    frames[count].offset = offset;
+    frames[count].pos = pos;
+
+    /* The frames must end where the seek table starts */
+    if (offset != table_offset)
+        goto error;
+
+    free(table);
+    sys->frames = frames;
+    sys->frame_count = count + 1;
+    msg_Dbg(stream, "seek table of %"PRIu32" frames", count);
+    goto out;
+
+error:
+    free(frames);
+    free(table);
+out:
+    if (vlc_stream_Seek(stream->s, 0))
+        sys->can_seek = false;
+}
+
+static int Control(stream_t *stream, int query, va_list args)
+{
+    stream_sys_t *sys = stream->p_sys;
+
+    switch (query)
+    {
+        case STREAM_CAN_SEEK:
+            *va_arg(args, bool *) = sys->can_seek;
+            break;
+        case STREAM_CAN_FASTSEEK:
+            *va_arg(args, bool *) = sys->frames != NULL;
+            break;
+        case STREAM_GET_SIZE:
+            if (sys->frames == NULL)
+                return VLC_EGENERIC;
+            *va_arg(args, uint64_t *) = sys->frames[sys->frame_count - 1].pos;
+            break;
+        case STREAM_CAN_PAUSE:
+        case STREAM_CAN_CONTROL_PACE:
+        case STREAM_GET_PTS_DELAY:
+        case STREAM_GET_META:
+        case STREAM_GET_CONTENT_TYPE:
+        case STREAM_GET_SIGNAL:
+        case STREAM_SET_PAUSE_STATE:
+        case STREAM_GET_MTIME:
+            return vlc_stream_vaControl(stream->s, query, args);
+        case STREAM_GET_TITLE_INFO:
+        case STREAM_GET_TITLE:
+        case STREAM_GET_SEEKPOINT:
+        case STREAM_SET_TITLE:
+        case STREAM_SET_SEEKPOINT:
+        case STREAM_SET_PRIVATE_ID_STATE:
+        case STREAM_SET_PRIVATE_ID_CA:
+        case STREAM_GET_PRIVATE_ID_STATE:
+            return VLC_EGENERIC;
+        default:
+            msg_Err(stream, "unimplemented query (%d) in control", query);
+            return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+static int Open(vlc_object_t *obj)
+{
+    stream_t *stream = (stream_t *)obj;
+    const uint8_t *peek;
+
+    /* (Try to) parse the Zstd frame header (minimum size is 6 bytes) */
+    if (vlc_stream_Peek(stream->s, &peek, 6) < 6)
+        return VLC_EGENERIC;
+    if (memcmp(peek, "\x28\xb5\x2f\xfd", 4)) /* magic number */
+        return VLC_EGENERIC;
+    if (peek[4] & 0x08) /* reserved bit */
+        return VLC_EGENERIC;
+
+    stream_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    sys->zds = ZSTD_createDStream();
+    sys->buffer_size = ZSTD_DStreamInSize();
+    sys->buffer = malloc(sys->buffer_size);
+    if (unlikely(sys->zds == NULL || sys->buffer == NULL))
+    {
+        ZSTD_freeDStream(sys->zds);
+        free(sys->buffer);
+        free(sys);
+        return VLC_ENOMEM;
+    }
+
+    sys->in.src = sys->buffer;
+    sys->in.size = sys->in.pos = 0;
+    sys->pending = 0;
+    sys->pos = 0;
+    sys->eof = false;
+    sys->frames = NULL;
+    sys->frame_count = 0;
+    if (vlc_stream_Control(stream->s, STREAM_CAN_SEEK, &sys->can_seek))
+        sys->can_seek = false;
+
+    stream->p_sys = sys;
+    LoadSeekTable(stream);
+
+    msg_Dbg(obj, "detected zstd compressed stream");
+    stream->pf_read = Read;
+    stream->pf_seek = Seek;
+    stream->pf_control = Control;
+    return VLC_SUCCESS;
+}
+
+static void Close(vlc_object_t *obj)
+{
+    stream_t *stream = (stream_t *)obj;
+    stream_sys_t *sys = stream->p_sys;
+
+    ZSTD_freeDStream(sys->zds);
+    free(sys->frames);
+    free(sys->buffer);
+    free(sys);
+}
+
+vlc_module_begin()
+    set_subcategory(SUBCAT_INPUT_STREAM_FILTER)
+    /* above the decomp module, which pipes through the zstdcat tool */
+    set_capability("stream_filter", 325)
+
+    set_description(N_("Zstandard decompression filter"))
+    set_callbacks(Open, Close)
+vlc_module_end()
@@ -31,6 +31,7 @@
 #endif
 
 #include "../renderer_common.hpp"
+#include "../../packetizer/h264_nal.h"
 #include "chromecast.h"
 #include <vlc_configuration.h>
 #include <vlc_dialog.h>
@@ -770,6 +771,11 @@ bool sout_stream_sys_t::canDecodeVideo( const es_format_t *es ) const
     switch( es->i_codec )
     {
         case VLC_CODEC_H264:
+            /* No receiver decodes the 10 bits, 4:2:2 or 4:4:4 profiles: do not
+             * wait for the load to fail before transcoding */
+            if( es->i_profile > PROFILE_H264_HIGH )
+                return false;
+            return true;
         case VLC_CODEC_HEVC:
             return true;
         case VLC_CODEC_VP8:
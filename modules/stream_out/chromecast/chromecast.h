@@ -205,6 +205,7 @@ private:
     bool isStateError() const;
     bool isStatePlaying() const;
     bool isStateReady() const;
+    void launchApp();
     void tryLoad();
     void doStop();
 
@@ -367,6 +367,16 @@ void intf_sys_t::prepareHttpArtwork()
     vlc_meta_Set( m_meta, vlc_meta_ArtworkURL, ss.str().c_str() );
 }
 
+void intf_sys_t::launchApp()
+{
+    assert( m_communication );
+    assert( m_state == Connected );
+    msg_Dbg( m_module, "Starting the media receiver application" );
+    // Don't use setState as we don't want to signal the condition in this case.
+    m_state = Launching;
+    m_communication->msgReceiverLaunchApp();
+}
+
 void intf_sys_t::tryLoad()
 {
     if( !m_request_load )
@@ -380,13 +390,7 @@ void intf_sys_t::tryLoad()
             m_request_load = false;
         }
         else if( m_state == Connected )
-        {
-            assert( m_communication );
-            msg_Dbg( m_module, "Starting the media receiver application" );
-            // Don't use setState as we don't want to signal the condition in this case.
-            m_state = Launching;
-            m_communication->msgReceiverLaunchApp();
-        }
+            launchApp();
         return;
     }
 
@@ -791,6 +795,11 @@ bool intf_sys_t::processReceiverMessage( const castchannel::CastMessage& msg , c
             else
             {
                 setState( Connected );
+                // Launch the application right away, in parallel with the
+                // setup of the stream output, rather than once the content
+                // is ready to load.
+                if ( m_state == Connected )
+                    launchApp();
             }
             break;
         case Launching:
@@ -58,6 +58,20 @@ static inline void hls_block_chain_Reset(hls_block_chain_t *chain)
     chain->last_header = NULL;
 }
 
+/**
+ * Published state of a playlist, answering the blocking playlist reloads.
+ */
+struct hls_playlist_manifest
+{
+    struct hls_storage *storage;
+    bool can_block_reload;
+    /** Media sequence number of the segment being built. */
+    unsigned int segment_count;
+    /** Parts already published of the segment being built. */
+    unsigned int part_count;
+    bool ended;
+};
+
 /**
  * Represent one HLS playlist as in RFC 8216 section 4.
  */
@@ -91,7 +105,7 @@ typedef struct hls_playlist
     /**
      * Current playlist manifest as in RFC 8216 section 4.3.3.
      */
-    struct hls_storage *manifest;
+    struct hls_playlist_manifest *manifest;
     httpd_url_t *http_manifest;
 
     bool ended;
@@ -101,6 +115,23 @@ typedef struct hls_playlist
      */
     vlc_tick_t muxed_duration;
 
+    /**
+     * Low-latency partial segments cut from the muxed output.
+     *
+     * The segment being built is made of the published parts, from the
+     * beginning of the muxed output up to `last`, and of the part being built
+     * up to `tail`.
+     */
+    struct
+    {
+        block_t *last;
+        block_t *tail;
+        vlc_tick_t length;
+        vlc_tick_t segment_length;
+        vlc_tick_t gop_length;
+        unsigned int count;
+    } part;
+
     struct vlc_list node;
 } hls_playlist_t;
 
@@ -200,6 +231,87 @@ static int HTTPCallback(httpd_callback_sys_t *sys,
     return VLC_SUCCESS;
 }
 
+/** Holds the requests of a part until it is published. */
+static int HTTPPendingCallback(httpd_callback_sys_t *sys,
+                               httpd_client_t *client,
+                               httpd_message_t *answer,
+                               const httpd_message_t *query)
+{
+    if (answer == NULL || query == NULL || client == NULL)
+        return VLC_SUCCESS;
+    return -EAGAIN;
+    (void)sys;
+}
+
+static bool GetQueryNumber(const char *args, const char *name, unsigned *value)
+{
+    const size_t len = strlen(name);
+    for (const char *it = args; it != NULL; it = strchr(it, '&'))
+    {
+        if (*it == '&')
+            ++it;
+        if (strncmp(it, name, len) == 0 && it[len] == '=')
+            return sscanf(it + len + 1, "%u", value) == 1;
+    }
+    return false;
+}
+
+/**
+ * Serves the playlist manifest, holding the blocking playlist reloads until
+ * the requested segment or part is published.
+ */
+static int PlaylistHTTPCallback(httpd_callback_sys_t *sys,
+                                httpd_client_t *client,
+                                httpd_message_t *answer,
+                                const httpd_message_t *query)
+{
+    if (answer == NULL || query == NULL || client == NULL)
+        return VLC_SUCCESS;
+
+    const struct hls_playlist_manifest *manifest =
+        (const struct hls_playlist_manifest *)sys;
+    const char *args = (const char *)query->psz_args;
+
+    unsigned msn;
+    if (manifest->can_block_reload && !manifest->ended && args != NULL &&
+        GetQueryNumber(args, "_HLS_msn", &msn))
+    {
+        if (msn > manifest->segment_count + 1)
+        {
+            answer->i_proto = HTTPD_PROTO_HTTP;
+            answer->i_version = 0;
+            answer->i_type = HTTPD_MSG_ANSWER;
+            answer->i_status = 400;
+            httpd_MsgAdd(answer, "Content-Length", "0");
+            return VLC_SUCCESS;
+        }
+
+        unsigned part;
+        const bool available =
+            msn < manifest->segment_count ||
+            (msn == manifest->segment_count &&
+             GetQueryNumber(args, "_HLS_part", &part) &&
+             part < manifest->part_count);
+        if (!available)
+            return -EAGAIN;
+    }
+
+    return HTTPCallback(
+        (httpd_callback_sys_t *)manifest->storage, client, answer, query);
+}
+
+static void DestroyPlaylistManifest(struct hls_playlist_manifest *manifest)
+{
+    hls_storage_Destroy(manifest->storage);
+    free(manifest);
+}
+
+static inline bool IsLowLatency(const hls_playlist_t *playlist)
+{
+    return playlist->config->part_length != 0 &&
+           playlist->type == HLS_PLAYLIST_TYPE_TS;
+}
+
 typedef struct VLC_VECTOR(const es_format_t *) es_format_vec_t;
 
 static inline bool IsCodecAlreadyDescribed(const es_format_vec_t *vec,
@@ -419,6 +531,22 @@ GeneratePlaylistManifest(const hls_playlist_t *playlist)
     // First version adding CMAF fragments support.
     MANIFEST_ADD_TAG("#EXT-X-VERSION:7");
 
+    const bool low_latency = IsLowLatency(playlist);
+    const double part_duration =
+        secf_from_vlc_tick(playlist->config->part_length);
+    if (low_latency)
+    {
+        /* The hold back must be at least twice the part target. */
+        if (playlist->http_manifest != NULL)
+            MANIFEST_ADD_TAG("#EXT-X-SERVER-CONTROL:CAN-BLOCK-RELOAD=YES,"
+                             "PART-HOLD-BACK=%.3f",
+                             3. * part_duration);
+        else
+            MANIFEST_ADD_TAG("#EXT-X-SERVER-CONTROL:PART-HOLD-BACK=%.3f",
+                             3. * part_duration);
+        MANIFEST_ADD_TAG("#EXT-X-PART-INF:PART-TARGET=%.3f", part_duration);
+    }
+
     const bool will_destroy_segments = playlist->config->max_segments == 0;
     if (playlist->ended)
         MANIFEST_ADD_TAG("#EXT-X-PLAYLIST-TYPE:VOD");
@@ -429,13 +557,37 @@ GeneratePlaylistManifest(const hls_playlist_t *playlist)
     MANIFEST_ADD_TAG("#EXT-X-MEDIA-SEQUENCE:%u",
                      (first_seg == NULL) ? 0u : first_seg->id);
 
+#define MANIFEST_ADD_PARTS(list)                                               \
+    do                                                                         \
+    {                                                                          \
+        const hls_part_t *part;                                                \
+        hls_part_Foreach_const(list, part)                                     \
+        {                                                                      \
+            MANIFEST_ADD_TAG("#EXT-X-PART:DURATION=%.3f,URI=\"%s\"%s",         \
+                             secf_from_vlc_tick(part->length),                 \
+                             part->url,                                        \
+                             part->independent ? ",INDEPENDENT=YES" : "");     \
+        }                                                                      \
+    } while (0)
+
     const hls_segment_t *segment;
     hls_segment_queue_Foreach_const(&playlist->segments, segment)
     {
+        MANIFEST_ADD_PARTS(&segment->parts);
         MANIFEST_ADD_TAG("#EXTINF:%.2f,", secf_from_vlc_tick(segment->length));
         MANIFEST_ADD_TAG("%s", segment->url);
     }
 
+    if (low_latency && !playlist->ended)
+    {
+        MANIFEST_ADD_PARTS(&playlist->segments.parts);
+        if (playlist->segments.hint != NULL)
+            MANIFEST_ADD_TAG("#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"%s\"",
+                             playlist->segments.hint->url);
+    }
+
+#undef MANIFEST_ADD_PARTS
+
     if (playlist->ended)
         MANIFEST_ADD_TAG("#EXT-X-ENDLIST");
 
@@ -457,20 +609,32 @@ error:
 
 static int UpdatePlaylistManifest(hls_playlist_t *playlist)
 {
-    struct hls_storage *new_manifest = GeneratePlaylistManifest(playlist);
+    struct hls_playlist_manifest *new_manifest =
+        malloc(sizeof(*new_manifest));
     if (unlikely(new_manifest == NULL))
+        return VLC_ENOMEM;
+
+    new_manifest->storage = GeneratePlaylistManifest(playlist);
+    if (unlikely(new_manifest->storage == NULL))
+    {
+        free(new_manifest);
         return VLC_EGENERIC;
+    }
+    new_manifest->can_block_reload = IsLowLatency(playlist);
+    new_manifest->segment_count = playlist->segments.total_segments;
+    new_manifest->part_count = playlist->part.count;
+    new_manifest->ended = playlist->ended;
 
     if (playlist->http_manifest != NULL)
     {
         httpd_UrlCatch(playlist->http_manifest,
                        HTTPD_MSG_GET,
-                       HTTPCallback,
+                       PlaylistHTTPCallback,
                        (httpd_callback_sys_t *)new_manifest);
     }
 
     if (playlist->manifest != NULL)
-        hls_storage_Destroy(playlist->manifest);
+        DestroyPlaylistManifest(playlist->manifest);
     playlist->manifest = new_manifest;
     return VLC_SUCCESS;
 }
@@ -542,9 +706,34 @@ static hls_block_chain_t ExtractSubtitleSegment(hls_block_chain_t *muxed_output,
     return segment;
 }
 
+/* The parts of the segment have already been cut, take all of them. */
+static hls_block_chain_t ExtractPartsSegment(hls_playlist_t *playlist)
+{
+    hls_block_chain_t *muxed_output = &playlist->muxed_output;
+    hls_block_chain_t segment = {.length = playlist->part.segment_length};
+
+    block_t *last = playlist->part.last;
+    if (last != NULL)
+    {
+        segment.begin = muxed_output->begin;
+        muxed_output->begin = last->p_next;
+        if (muxed_output->begin == NULL)
+            muxed_output->end = &muxed_output->begin;
+        last->p_next = NULL;
+        muxed_output->length -= segment.length;
+    }
+
+    playlist->part.last = NULL;
+    playlist->part.segment_length = 0;
+    playlist->part.count = 0;
+    return segment;
+}
+
 static hls_block_chain_t ExtractSegment(hls_playlist_t *playlist)
 {
     const vlc_tick_t seglen = playlist->config->segment_length;
+    if (IsLowLatency(playlist))
+        return ExtractPartsSegment(playlist);
     if (playlist->type == HLS_PLAYLIST_TYPE_WEBVTT)
         return ExtractSubtitleSegment(&playlist->muxed_output, seglen);
     return ExtractCommonSegment(&playlist->muxed_output, seglen);
@@ -610,6 +799,109 @@ static int ExtractAndAddSegment(hls_playlist_t *playlist,
     return UpdatePlaylistManifest(playlist);
 }
 
+static int PublishPart(hls_playlist_t *playlist)
+{
+    block_t *first = (playlist->part.last != NULL)
+                         ? playlist->part.last->p_next
+                         : playlist->muxed_output.begin;
+    block_t *tail = playlist->part.tail;
+    assert(first != NULL && tail != NULL);
+
+    /* The segment keeps the blocks, the part gets its own copy. */
+    block_t *content = NULL;
+    block_t **content_end = &content;
+    for (const block_t *it = first;; it = it->p_next)
+    {
+        block_t *copy = block_Duplicate(it);
+        if (unlikely(copy == NULL))
+        {
+            block_ChainRelease(content);
+            return VLC_ENOMEM;
+        }
+        block_ChainLastAppend(&content_end, copy);
+        if (it == tail)
+            break;
+    }
+
+    const vlc_tick_t length = playlist->part.length;
+    const int status =
+        hls_segment_queue_NewPart(&playlist->segments,
+                                  content,
+                                  length,
+                                  first->i_flags & BLOCK_FLAG_HEADER);
+    if (unlikely(status != VLC_SUCCESS))
+    {
+        vlc_error(playlist->logger,
+                  "Part '%u' creation failed",
+                  playlist->segments.total_parts);
+        return status;
+    }
+
+    playlist->part.last = tail;
+    playlist->part.tail = NULL;
+    playlist->part.segment_length += length;
+    playlist->part.length = 0;
+    ++playlist->part.count;
+
+    return UpdatePlaylistManifest(playlist);
+}
+
+/**
+ * Cut the newly muxed blocks into parts, and the parts into segments.
+ *
+ * Parts are cut before each synchronization frame so that segments can start
+ * on any of them. Since the segment boundary has to be known when publishing
+ * its first part, a segment ends before the synchronization frame if another
+ * GOP as long as the previous one would not fit.
+ */
+static int AddParts(hls_playlist_t *playlist, sout_stream_sys_t *sys)
+{
+    const vlc_tick_t part_length = playlist->config->part_length;
+    const vlc_tick_t seglen = playlist->config->segment_length;
+
+    block_t *it;
+    if (playlist->part.tail != NULL)
+        it = playlist->part.tail->p_next;
+    else if (playlist->part.last != NULL)
+        it = playlist->part.last->p_next;
+    else
+        it = playlist->muxed_output.begin;
+
+    for (; it != NULL; it = it->p_next)
+    {
+        const bool sync = it->i_flags & BLOCK_FLAG_HEADER;
+        const vlc_tick_t segment_length =
+            playlist->part.segment_length + playlist->part.length;
+
+        const bool end_segment =
+            segment_length > 0 &&
+            (segment_length + it->i_length > seglen ||
+             (sync && segment_length + playlist->part.gop_length > seglen));
+
+        if (playlist->part.tail != NULL &&
+            (sync || end_segment ||
+             playlist->part.length + it->i_length > part_length))
+        {
+            if (PublishPart(playlist) != VLC_SUCCESS)
+                return VLC_EGENERIC;
+        }
+
+        if (end_segment && ExtractAndAddSegment(playlist, sys) != VLC_SUCCESS)
+            return VLC_EGENERIC;
+
+        if (sync)
+            playlist->part.gop_length = 0;
+        playlist->part.gop_length += it->i_length;
+        playlist->part.length += it->i_length;
+        playlist->part.tail = it;
+
+        if (playlist->part.length >= part_length &&
+            PublishPart(playlist) != VLC_SUCCESS)
+            return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
 static bool IsSegmentReady(enum hls_playlist_type type,
                            hls_block_chain_t *buffer,
                            vlc_tick_t seglen)
@@ -658,8 +950,15 @@ static ssize_t AccessOutWrite(sout_access_out_t *access, block_t *block)
             it->muxed_output.length += length;
             if (block->i_flags & BLOCK_FLAG_HEADER)
                 it->muxed_output.last_header = block;
+
+            if (IsLowLatency(it) && AddParts(it, sys) != VLC_SUCCESS)
+                return -1;
         }
 
+        /* Low-latency playlists are segmented as soon as muxed. */
+        if (IsLowLatency(it))
+            continue;
+
         if (!IsSegmentReady(
                 it->type, &it->muxed_output, sys->config.segment_length))
             segments_ready = false;
@@ -670,6 +969,9 @@ static ssize_t AccessOutWrite(sout_access_out_t *access, block_t *block)
     {
         hls_playlists_foreach (it)
         {
+            if (IsLowLatency(it))
+                continue;
+
             while (IsSegmentReady(it->type,
                                   &it->muxed_output,
                                   sys->config.segment_length) &&
@@ -756,6 +1058,12 @@ static hls_playlist_t *CreatePlaylist(sout_stream_t *stream,
     playlist->config = &sys->config;
     playlist->ended = false;
     playlist->muxed_duration = 0;
+    playlist->part.last = NULL;
+    playlist->part.tail = NULL;
+    playlist->part.length = 0;
+    playlist->part.segment_length = 0;
+    playlist->part.gop_length = 0;
+    playlist->part.count = 0;
 
     playlist->url = FormatPlaylistManifestURL(playlist);
     if (unlikely(playlist->url == NULL))
@@ -772,6 +1080,7 @@ static hls_playlist_t *CreatePlaylist(sout_stream_t *stream,
         .playlist_type = type,
         .httpd_ref = sys->http_host,
         .httpd_callback = HTTPCallback,
+        .httpd_pending_callback = HTTPPendingCallback,
     };
     hls_segment_queue_Init(&playlist->segments, &config, &sys->config);
 
@@ -823,7 +1132,7 @@ static void DeletePlaylist(hls_playlist_t *playlist)
         httpd_UrlDelete(playlist->http_manifest);
 
     if (playlist->manifest != NULL)
-        hls_storage_Destroy(playlist->manifest);
+        DestroyPlaylistManifest(playlist->manifest);
 
     block_ChainRelease(playlist->muxed_output.begin);
     hls_segment_queue_Clear(&playlist->segments);
@@ -941,6 +1250,8 @@ static void Del(sout_stream_t *stream, void *id)
             map->playlist_ref = NULL;
 
         track->playlist_ref->ended = true;
+        if (track->playlist_ref->part.tail != NULL)
+            PublishPart(track->playlist_ref);
         ExtractAndAddSegment(track->playlist_ref, sys);
         UpdatePlaylistManifest(track->playlist_ref);
 
@@ -1054,6 +1365,7 @@ static int Open(vlc_object_t *this)
                                           "num-seg",
                                           "out-dir",
                                           "pace",
+                                          "part-len",
                                           "seg-len",
                                           "variants",
                                           NULL};
@@ -1069,6 +1381,15 @@ static int Open(vlc_object_t *this)
         VLC_TICK_FROM_SEC(var_GetInteger(stream, SOUT_CFG_PREFIX "seg-len"));
     sys->config.max_memory =
         BYTES_FROM_KB(var_GetInteger(stream, SOUT_CFG_PREFIX "max-memory"));
+    sys->config.part_length =
+        VLC_TICK_FROM_MS(var_GetInteger(stream, SOUT_CFG_PREFIX "part-len"));
+    if (sys->config.part_length >= sys->config.segment_length)
+    {
+        msg_Warn(stream,
+                 "Parts must be shorter than the segments, disabling the "
+                 "low-latency parts");
+        sys->config.part_length = 0;
+    }
 
     int status = VLC_EINVAL;
 
@@ -1173,6 +1494,12 @@ variant_error:
 #define PACE_LONGTEXT                                                          \
     N_("Enable input pacing, the media will play at playback rate")
 #define PACE_TEXT N_("Enable pacing")
+#define PARTLEN_LONGTEXT                                                       \
+    N_("Length of the low-latency partial segments in milliseconds. The "     \
+       "parts are published as soon as muxed, and the internal HTTP server "   \
+       "holds the blocking playlist reloads until they are. 0 disables the "   \
+       "partial segments")
+#define PARTLEN_TEXT N_("Partial segment length (ms)")
 #define SEGLEN_LONGTEXT N_("Length of segments in seconds")
 #define SEGLEN_TEXT N_("Segment length (sec)")
 
@@ -1192,6 +1519,8 @@ vlc_module_begin()
     add_string(SOUT_CFG_PREFIX "out-dir", NULL, OUTDIR_TEXT, OUTDIR_LONGTEXT)
     add_bool(SOUT_CFG_PREFIX "pace", false, PACE_TEXT, PACE_LONGTEXT)
     add_integer(SOUT_CFG_PREFIX "seg-len", 4, SEGLEN_TEXT, SEGLEN_LONGTEXT)
+    add_integer(SOUT_CFG_PREFIX "part-len", 0, PARTLEN_TEXT, PARTLEN_LONGTEXT)
+        change_integer_range(0, 10000)
 
     set_callback(Open)
 vlc_module_end()
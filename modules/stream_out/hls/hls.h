@@ -33,6 +33,8 @@ struct hls_config
     unsigned int max_segments;
     bool pace;
     vlc_tick_t segment_length;
+    /** Low-latency partial segments length, 0 if disabled. */
+    vlc_tick_t part_length;
     size_t max_memory;
 };
 
@@ -25,6 +25,7 @@
 
 #include <vlc_common.h>
 
+#include <vlc_block.h>
 #include <vlc_httpd.h>
 #include <vlc_list.h>
 #include <vlc_tick.h>
@@ -33,8 +34,32 @@
 #include "segments.h"
 #include "storage.h"
 
+/* Number of most recent segments keeping their parts in the playlist. */
+#define HLS_PARTS_MAX_SEGMENTS 2
+
+static void hls_part_Destroy(hls_part_t *part)
+{
+    if (part->http_url != NULL)
+        httpd_UrlDelete(part->http_url);
+    if (part->storage != NULL)
+        hls_storage_Destroy(part->storage);
+    free(part->url);
+    free(part);
+}
+
+static void hls_parts_Clear(struct vlc_list *parts)
+{
+    hls_part_t *it;
+    vlc_list_foreach (it, parts, priv_node)
+    {
+        vlc_list_remove(&it->priv_node);
+        hls_part_Destroy(it);
+    }
+}
+
 static void hls_segment_Destroy(hls_segment_t *segment)
 {
+    hls_parts_Clear(&segment->parts);
     if (segment->http_url != NULL)
         httpd_UrlDelete(segment->http_url);
     hls_storage_Destroy(segment->storage);
@@ -65,6 +90,7 @@ void hls_segment_queue_Init(hls_segment_queue_t *queue,
 
     queue->httpd_ref = config->httpd_ref;
     queue->httpd_callback = config->httpd_callback;
+    queue->httpd_pending_callback = config->httpd_pending_callback;
 
     queue->file_extension =
         hls_segment_queue_GetFileExtension(config->playlist_type);
@@ -72,12 +98,20 @@ void hls_segment_queue_Init(hls_segment_queue_t *queue,
     queue->hls_config = hls_config;
 
     vlc_list_init(&queue->segments);
+
+    queue->total_parts = 0;
+    vlc_list_init(&queue->parts);
+    queue->hint = NULL;
 }
 
 void hls_segment_queue_Clear(hls_segment_queue_t *queue)
 {
     hls_segment_t *it;
     hls_segment_queue_Foreach(queue, it) { hls_segment_Destroy(it); }
+
+    hls_parts_Clear(&queue->parts);
+    if (queue->hint != NULL)
+        hls_part_Destroy(queue->hint);
 }
 
 int hls_segment_queue_NewSegment(hls_segment_queue_t *queue,
@@ -126,6 +160,22 @@ int hls_segment_queue_NewSegment(hls_segment_queue_t *queue,
     else
         segment->http_url = NULL;
 
+    /* The parts published so far make up the new segment. */
+    vlc_list_init(&segment->parts);
+    hls_part_t *part;
+    vlc_list_foreach (part, &queue->parts, priv_node)
+    {
+        vlc_list_remove(&part->priv_node);
+        vlc_list_append(&part->priv_node, &segment->parts);
+    }
+
+    hls_segment_t *it;
+    hls_segment_queue_Foreach(queue, it)
+    {
+        if (it->id + HLS_PARTS_MAX_SEGMENTS <= segment->id)
+            hls_parts_Clear(&it->parts);
+    }
+
     if (hls_segment_queue_IsAtMaxCapacity(queue))
     {
         hls_segment_t *old = hls_segment_GetFirst(queue);
@@ -144,3 +194,89 @@ nomem:
     free(segment);
     return VLC_ENOMEM;
 }
+
+static hls_part_t *hls_part_New(hls_segment_queue_t *queue)
+{
+    hls_part_t *part = malloc(sizeof(*part));
+    if (unlikely(part == NULL))
+        return NULL;
+
+    part->id = queue->total_parts;
+    part->storage = NULL;
+    part->http_url = NULL;
+
+    if (asprintf(&part->url,
+                 "%s/playlist-%u-part-%u.%s",
+                 queue->hls_config->base_url,
+                 queue->playlist_id,
+                 part->id,
+                 queue->file_extension) == -1)
+    {
+        free(part);
+        return NULL;
+    }
+
+    if (queue->httpd_ref != NULL)
+    {
+        part->http_url = httpd_UrlNew(queue->httpd_ref, part->url, NULL, NULL);
+        if (part->http_url == NULL)
+        {
+            free(part->url);
+            free(part);
+            return NULL;
+        }
+
+        /* Requests of the hinted part are held until it is complete. */
+        httpd_UrlCatch(part->http_url,
+                       HTTPD_MSG_GET,
+                       queue->httpd_pending_callback,
+                       NULL);
+    }
+    return part;
+}
+
+int hls_segment_queue_NewPart(hls_segment_queue_t *queue,
+                              block_t *content,
+                              vlc_tick_t length,
+                              bool independent)
+{
+    hls_part_t *part = queue->hint;
+    if (part == NULL)
+    {
+        part = hls_part_New(queue);
+        if (unlikely(part == NULL))
+        {
+            block_ChainRelease(content);
+            return VLC_ENOMEM;
+        }
+    }
+    queue->hint = NULL;
+
+    part->length = length;
+    part->independent = independent;
+
+    const struct hls_storage_config storage_conf = {
+        .name = part->url + strlen(queue->hls_config->base_url) + 1,
+        .mime = "video/MP2T",
+    };
+    part->storage =
+        hls_storage_FromBlocks(content, &storage_conf, queue->hls_config);
+    if (unlikely(part->storage == NULL))
+    {
+        hls_part_Destroy(part);
+        return VLC_ENOMEM;
+    }
+
+    if (part->http_url != NULL)
+        httpd_UrlCatch(part->http_url,
+                       HTTPD_MSG_GET,
+                       queue->httpd_callback,
+                       (httpd_callback_sys_t *)part->storage);
+
+    ++queue->total_parts;
+    vlc_list_append(&part->priv_node, &queue->parts);
+
+    /* A missing hint is not fatal, the next part will create its URL. */
+    queue->hint = hls_part_New(queue);
+    return VLC_SUCCESS;
+}
@@ -23,6 +23,25 @@
 struct hls_storage;
 struct hls_config;
 
+/**
+ * Partial segment as in the low-latency HLS extension (EXT-X-PART).
+ */
+typedef struct hls_part
+{
+    char *url;
+    /** Playlist-wide part number, the URL of the next part is predictable. */
+    unsigned int id;
+    vlc_tick_t length;
+    bool independent;
+
+    /** NULL until the part is complete, while advertised as a preload hint. */
+    struct hls_storage *storage;
+
+    httpd_url_t *http_url;
+
+    struct vlc_list priv_node;
+} hls_part_t;
+
 typedef struct hls_segment
 {
     char *url;
@@ -33,6 +52,9 @@ typedef struct hls_segment
 
     httpd_url_t *http_url;
 
+    /** Parts of the segment, only kept for the most recent segments. */
+    struct vlc_list parts;
+
     struct vlc_list priv_node;
 } hls_segment_t;
 
@@ -43,6 +65,8 @@ struct hls_segment_queue_config
 
     httpd_host_t *httpd_ref;
     httpd_callback_t httpd_callback;
+    /** Answers the requests of the preload hinted part. */
+    httpd_callback_t httpd_pending_callback;
 };
 
 typedef struct
@@ -52,12 +76,19 @@ typedef struct
 
     httpd_host_t *httpd_ref;
     httpd_callback_t httpd_callback;
+    httpd_callback_t httpd_pending_callback;
 
     const char *file_extension;
 
     const struct hls_config *hls_config;
 
     struct vlc_list segments;
+
+    unsigned int total_parts;
+    /** Parts of the segment being built. */
+    struct vlc_list parts;
+    /** Next part, advertised before being complete. */
+    hls_part_t *hint;
 } hls_segment_queue_t;
 
 #define hls_segment_queue_Foreach(queue, it)                                   \
@@ -66,6 +97,8 @@ typedef struct
     vlc_list_foreach_const (it, &(queue)->segments, priv_node)
 #define hls_segment_GetFirst(queue)                                            \
     vlc_list_first_entry_or_null(&(queue)->segments, hls_segment_t, priv_node);
+#define hls_part_Foreach_const(list, it)                                       \
+    vlc_list_foreach_const (it, list, priv_node)
 
 void hls_segment_queue_Init(hls_segment_queue_t *,
                             const struct hls_segment_queue_config *,
@@ -88,6 +121,25 @@ int hls_segment_queue_NewSegment(hls_segment_queue_t *,
                                  block_t *content,
                                  vlc_tick_t length);
 
+/**
+ * Add a new part to the segment being built.
+ *
+ * The parts added since the last call to \ref hls_segment_queue_NewSegment
+ * are attached to the next segment. The URL of the following part is then
+ * reserved as a preload hint.
+ *
+ * \param content A chain of block containing part's data.
+ * \param length The media time size of the part.
+ * \param independent Whether the part starts with a synchronization frame.
+ *
+ * \retval VLC_SUCCESS on success.
+ * \retval VLC_ENOMEM on internal allocation failure.
+ */
+int hls_segment_queue_NewPart(hls_segment_queue_t *,
+                              block_t *content,
+                              vlc_tick_t length,
+                              bool independent);
+
 static inline bool
 hls_segment_queue_IsAtMaxCapacity(const hls_segment_queue_t *queue)
 {
@@ -28,6 +28,7 @@
 # include "config.h"
 #endif
 
+#include <fcntl.h>
 #include <limits.h>
 
 #include <vlc_common.h>
@@ -53,6 +54,13 @@ static int      Open    ( vlc_object_t * );
 
 #define SOUT_CFG_PREFIX "sout-record-"
 
+/* Write from a separate thread, and reserve the disk space by 16 MiB chunks */
+#ifdef FALLOC_FL_KEEP_SIZE
+# define RECORD_ACCESS_OPTIONS "async,prealloc=16"
+#else
+# define RECORD_ACCESS_OPTIONS "async"
+#endif
+
 vlc_module_begin ()
     set_description( N_("Record stream output") )
     set_capability( "sout output", 0 )
@@ -356,7 +364,8 @@ static int OutputNew( sout_stream_t *p_stream,
     free( psz_tmp );
 
     if( asprintf( &psz_output,
-                  "std{access=file{no-append,no-format,no-overwrite},"
+                  "std{access=file{no-append,no-format,no-overwrite,"
+                  RECORD_ACCESS_OPTIONS "},"
                   "mux=%s,dst='%s'}", psz_muxer, psz_file ) < 0 )
     {
         psz_output = NULL;
@@ -29,8 +29,12 @@
 
 #include <cassert>
 #include <map>
+#include <set>
 #include <sstream>
 
+#include <vlc_threads.h>
+#include <vlc_cxx_helpers.hpp>
+
 #include "renderer_common.hpp"
 
 std::string
@@ -53,6 +57,16 @@ std::string GetVencAvcodecVTOption( sout_stream_t * /* p_stream */,
                                            const video_format_t * p_vid,
                                            int i_quality );
 #endif
+#ifdef _WIN32
+std::string GetVencMFTH264Option( sout_stream_t * /* p_stream */,
+                                  const video_format_t * /* p_vid */,
+                                  int i_quality );
+#endif
+#ifdef __linux__
+std::string GetVencOMXILH264Option( sout_stream_t * /* p_stream */,
+                                    const video_format_t * /* p_vid */,
+                                    int i_quality );
+#endif
 
 struct venc_options
 {
@@ -65,6 +79,12 @@ std::map<vlc_fourcc_t, std::vector<venc_options>> opts = {
         {
         #ifdef __APPLE__
             { GetVencAvcodecVTOption },
+        #endif
+        #ifdef _WIN32
+            { GetVencMFTH264Option },
+        #endif
+        #ifdef __linux__
+            { GetVencOMXILH264Option },
         #endif
             { GetVencQSVH264Option },
             { GetVencX264Option },
@@ -79,6 +99,11 @@ std::map<vlc_fourcc_t, std::vector<venc_options>> opts = {
     },
 };
 
+/* Encoders which could not be opened: probing them again would only delay
+ * the start of the next conversion */
+static vlc::threads::mutex venc_failed_lock;
+static std::set<const venc_options *> venc_failed;
+
 std::string
 GetVencOption( sout_stream_t *p_stream, std::vector<vlc_fourcc_t> codecs,
         vlc_fourcc_t *out_codec, const video_format_t *p_vid, int i_quality )
@@ -89,6 +114,12 @@ GetVencOption( sout_stream_t *p_stream, std::vector<vlc_fourcc_t> codecs,
             break;
         for (const auto& venc_opt : opt->second)
         {
+            {
+                vlc::threads::mutex_locker locker(venc_failed_lock);
+                if (venc_failed.count(&venc_opt) > 0)
+                    continue;
+            }
+
             std::stringstream ssout, ssvenc;
             char fourcc[5];
             ssvenc << "vcodec=";
@@ -137,6 +168,9 @@ GetVencOption( sout_stream_t *p_stream, std::vector<vlc_fourcc_t> codecs,
                     return ssvenc.str();
                 }
             }
+
+            vlc::threads::mutex_locker locker(venc_failed_lock);
+            venc_failed.insert(&venc_opt);
         }
     }
 
@@ -261,6 +295,42 @@ std::string GetVencX264Option( sout_stream_t * /* p_stream */,
     return ssout.str();
 }
 
+#if defined(_WIN32) || defined(__linux__)
+static const char *GetVencHWBitrate( int i_quality )
+{
+    switch ( i_quality )
+    {
+        case CONVERSION_QUALITY_HIGH:
+        case CONVERSION_QUALITY_MEDIUM:
+            return "vb=8000000";
+        default:
+            return "vb=3000000";
+    }
+}
+#endif
+
+#ifdef _WIN32
+std::string GetVencMFTH264Option( sout_stream_t * /* p_stream */,
+                                  const video_format_t * /* p_vid */,
+                                  int i_quality )
+{
+    std::stringstream ssout;
+    ssout << "venc=mft," << GetVencHWBitrate( i_quality );
+    return ssout.str();
+}
+#endif
+
+#ifdef __linux__
+std::string GetVencOMXILH264Option( sout_stream_t * /* p_stream */,
+                                    const video_format_t * /* p_vid */,
+                                    int i_quality )
+{
+    std::stringstream ssout;
+    ssout << "venc=omxil," << GetVencHWBitrate( i_quality );
+    return ssout.str();
+}
+#endif
+
 #ifdef __APPLE__
 std::string GetVencAvcodecVTOption( sout_stream_t * /* p_stream */,
                                            const video_format_t * /* p_vid */,
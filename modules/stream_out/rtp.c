@@ -132,6 +132,17 @@
     "Default caching value for outbound RTP streams. This " \
     "value should be set in milliseconds." )
 
+#define PACE_RATE_TEXT N_("Pacing rate (kb/s)")
+#define PACE_RATE_LONGTEXT N_( \
+    "Maximum rate at which the packets of each elementary stream are sent. " \
+    "Large frames are spread out instead of being sent in bursts that " \
+    "network switches may drop. 0 disables pacing." )
+
+#define PACE_BURST_TEXT N_("Pacing burst (packets)")
+#define PACE_BURST_LONGTEXT N_( \
+    "Number of full-sized packets that can be sent back to back when " \
+    "pacing. Small values make a narrow sender." )
+
 #define PROTO_TEXT N_("Transport protocol")
 #define PROTO_LONGTEXT N_( \
     "This selects which transport protocol to use for RTP." )
@@ -218,6 +229,10 @@ vlc_module_begin ()
               RTCP_MUX_TEXT, RTCP_MUX_LONGTEXT )
     add_integer( SOUT_CFG_PREFIX "caching", MS_FROM_VLC_TICK(DEFAULT_PTS_DELAY),
                  CACHING_TEXT, CACHING_LONGTEXT )
+    add_integer_with_range( SOUT_CFG_PREFIX "pace-rate", 0, 0, 10000000,
+                            PACE_RATE_TEXT, PACE_RATE_LONGTEXT )
+    add_integer_with_range( SOUT_CFG_PREFIX "pace-burst", 4, 1, 1024,
+                            PACE_BURST_TEXT, PACE_BURST_LONGTEXT )
     add_integer( "rtsp-timeout", 60, RTSP_TIMEOUT_TEXT,
                  RTSP_TIMEOUT_LONGTEXT )
     add_string( "sout-rtsp-user", "",
@@ -243,6 +258,7 @@ vlc_module_end ()
 static const char *const ppsz_sout_options[] = {
     "dst", "name", "cat", "port", "port-audio", "port-video", "*sdp", "ttl",
     "mux", "sap", "description", "proto", "rtcp-mux", "caching",
+    "pace-rate", "pace-burst",
 #ifdef HAVE_SRTP
     "key", "salt",
 #endif
@@ -317,6 +333,11 @@ typedef struct rtp_sink_t
 {
     int rtp_fd;
     rtcp_sender_t *rtcp;
+
+    /* Send statistics */
+    uint64_t packets;
+    uint64_t bytes;
+    uint64_t lost;
 } rtp_sink_t;
 
 struct sout_stream_id_sys_t
@@ -357,6 +378,15 @@ struct sout_stream_id_sys_t
     } listen;
 
     vlc_tick_t        i_caching;
+
+    /* Token bucket pacing, owned by the send thread */
+    struct {
+        unsigned      rate; /* bytes per second, 0 if disabled */
+        uint64_t      burst; /* bytes */
+        vlc_tick_t    start;
+        uint64_t      sent; /* bytes since start */
+        uint64_t      late;
+    } pacer;
 };
 
 static int Control(sout_stream_t *stream, int query, va_list args)
@@ -955,6 +985,17 @@ static void *Add( sout_stream_t *p_stream, const es_format_t *p_fmt, const char
     id->i_caching =
         VLC_TICK_FROM_MS(var_GetInteger( p_stream, SOUT_CFG_PREFIX "caching"));
 
+    id->pacer.rate = var_GetInteger( p_stream, SOUT_CFG_PREFIX "pace-rate" )
+                   * 1000 / 8;
+    id->pacer.burst = var_GetInteger( p_stream, SOUT_CFG_PREFIX "pace-burst" )
+                    * (uint64_t)id->i_mtu;
+    id->pacer.start = VLC_TICK_INVALID;
+    id->pacer.sent = 0;
+    id->pacer.late = 0;
+    if( id->pacer.rate > 0 )
+        msg_Dbg( p_stream, "pacing at %u bytes/s, %"PRIu64" bytes bursts",
+                 id->pacer.rate, id->pacer.burst );
+
     vlc_rand_bytes (&id->i_sequence, sizeof (id->i_sequence));
     vlc_rand_bytes (id->ssrc, sizeof (id->ssrc));
 
@@ -1345,10 +1386,6 @@ static int  HttpCallback( httpd_file_sys_t *p_args,
 /****************************************************************************
  * RTP send
  ****************************************************************************/
-static void* ThreadSend( void *data )
-{
-    vlc_thread_set_name("vlc-rt-send");
-
 #ifdef _WIN32
 # undef ENOBUFS
 # define ENOBUFS      WSAENOBUFS
@@ -1357,70 +1394,263 @@ static void* ThreadSend( void *data )
 # undef EWOULDBLOCK
 # define EWOULDBLOCK  WSAEWOULDBLOCK
 #endif
-    sout_stream_id_sys_t *id = data;
-    vlc_tick_t i_caching = id->i_caching;
-    block_t *out;
 
-    while ((out = vlc_queue_DequeueKillable(&id->queue, &id->dead)) != NULL)
+/* Packets sent to each sink per system call */
+#define RTP_BATCH 32
+
+/* Handles a failed send, returns false if the sink is broken */
+static bool SendError( rtp_sink_t *sink, const block_t *out )
+{
+    if( net_errno == EAGAIN || net_errno == EWOULDBLOCK
+     || net_errno == ENOBUFS || net_errno == ENOMEM )
     {
-#ifdef HAVE_SRTP
-        if( id->srtp )
-        {   /* FIXME: this is awfully inefficient */
-            size_t len = out->i_buffer;
-            out = block_Realloc( out, 0, len + 10 );
-            out->i_buffer = len;
-
-            int val = srtp_send( id->srtp, out->p_buffer, &len, len + 10 );
-            if( val )
-            {
-                msg_Dbg( id->p_stream, "SRTP sending error: %s",
-                         vlc_strerror_c(val) );
-                block_Release( out );
-                continue;
-            }
-            out->i_buffer = len;
+        sink->lost++;
+        return true;
+    }
+
+    int type;
+    getsockopt( sink->rtp_fd, SOL_SOCKET, SO_TYPE,
+                &type, &(socklen_t){ sizeof(type) });
+    if( type != SOCK_DGRAM )
+        /* Broken connection */
+        return false;
+
+    /* ICMP soft error: ignore and retry */
+    if( send( sink->rtp_fd, out->p_buffer, out->i_buffer, 0 ) == -1 )
+        sink->lost++;
+    else
+    {
+        sink->packets++;
+        sink->bytes += out->i_buffer;
+    }
+    return true;
+}
+
+/* Sends packets to a sink, returns false if the sink is broken */
+static bool SendSink( rtp_sink_t *sink, block_t *const *outv, unsigned outc )
+{
+#ifdef HAVE_SENDMMSG
+    struct iovec iov[RTP_BATCH];
+    struct mmsghdr msgs[RTP_BATCH];
+
+    assert( outc <= RTP_BATCH );
+    for( unsigned i = 0; i < outc; i++ )
+    {
+        iov[i].iov_base = outv[i]->p_buffer;
+        iov[i].iov_len = outv[i]->i_buffer;
+        msgs[i].msg_hdr = (struct msghdr) {
+            .msg_iov = &iov[i],
+            .msg_iovlen = 1,
+        };
+    }
+
+    for( unsigned i = 0; i < outc; )
+    {
+        int val = sendmmsg( sink->rtp_fd, msgs + i, outc - i, 0 );
+        if( val <= 0 )
+        {
+            /* The first packet failed, skip it */
+            if( !SendError( sink, outv[i] ) )
+                return false;
+            i++;
+            continue;
+        }
+
+        for( int j = 0; j < val; j++ )
+        {
+            sink->packets++;
+            sink->bytes += outv[i + j]->i_buffer;
+        }
+        i += val;
+    }
+#else
+    for( unsigned i = 0; i < outc; i++ )
+    {
+        if( send( sink->rtp_fd, outv[i]->p_buffer, outv[i]->i_buffer,
+                  0 ) == -1 )
+        {
+            if( !SendError( sink, outv[i] ) )
+                return false;
+            continue;
         }
+        sink->packets++;
+        sink->bytes += outv[i]->i_buffer;
+    }
 #endif
-        vlc_tick_wait (out->i_dts + i_caching);
+    return true;
+}
 
-        ssize_t len = out->i_buffer;
+static void SendPackets( sout_stream_id_sys_t *id, block_t *const *outv,
+                         unsigned outc )
+{
+    vlc_mutex_lock( &id->lock_sink );
+    unsigned deadc = 0; /* How many dead sockets? */
+    int deadv[id->sinkc ? id->sinkc : 1]; /* Dead sockets list */
 
-        vlc_mutex_lock( &id->lock_sink );
-        unsigned deadc = 0; /* How many dead sockets? */
-        int deadv[id->sinkc ? id->sinkc : 1]; /* Dead sockets list */
+    for( int i = 0; i < id->sinkc; i++ )
+    {
+#ifdef HAVE_SRTP
+        if( !id->srtp ) /* FIXME: SRTCP support */
+#endif
+            for( unsigned j = 0; j < outc; j++ )
+                SendRTCP( id->sinkv[i].rtcp, outv[j] );
 
-        for( int i = 0; i < id->sinkc; i++ )
-        {
+        if( !SendSink( &id->sinkv[i], outv, outc ) )
+            deadv[deadc++] = id->sinkv[i].rtp_fd;
+    }
+    id->i_seq_sent_next = ntohs(((uint16_t *) outv[outc - 1]->p_buffer)[1]) + 1;
+    vlc_mutex_unlock( &id->lock_sink );
+
+    for( unsigned i = 0; i < deadc; i++ )
+    {
+        msg_Dbg( id->p_stream, "removing socket %d", deadv[i] );
+        rtp_del_sink( id, deadv[i] );
+    }
+}
+
+/* Date at which the next packet can be sent: once the bytes sent before it,
+ * minus the burst, have drained from the bucket at the pacing rate */
+static vlc_tick_t PaceDate( const sout_stream_id_sys_t *id )
+{
+    if( id->pacer.sent <= id->pacer.burst )
+        return id->pacer.start;
+    return id->pacer.start
+         + vlc_tick_from_samples( id->pacer.sent - id->pacer.burst,
+                                  id->pacer.rate );
+}
+
+/**
+ * Waits until the pacer lets the first packet go, and returns how many
+ * packets can be sent back to back from then on.
+ */
+static unsigned Pace( sout_stream_id_sys_t *id, block_t *const *outv,
+                      unsigned outc, vlc_tick_t deadline )
+{
+    if( id->pacer.rate == 0 )
+        return outc;
+
+    vlc_tick_t now = vlc_tick_now();
+
+    /* The bucket is full again after an idle period */
+    if( id->pacer.start
+        + vlc_tick_from_samples( id->pacer.sent, id->pacer.rate ) < now )
+    {
+        id->pacer.start = now;
+        id->pacer.sent = 0;
+    }
+
+    vlc_tick_t date = PaceDate( id );
+
+    /* Do not delay packets when the rate is too low for the stream, this
+     * would only increase the latency without bound */
+    if( date > deadline + id->i_caching )
+    {
+        id->pacer.late++;
+        id->pacer.start = now;
+        id->pacer.sent = 0;
+    }
+    else if( date > now )
+    {
+        vlc_tick_wait( date );
+        now = date;
+    }
+
+    unsigned count = 0;
+    do
+        id->pacer.sent += outv[count++]->i_buffer;
+    while( count < outc && PaceDate( id ) <= now );
+    return count;
+}
+
+static block_t *Protect( sout_stream_id_sys_t *id, block_t *out )
+{
 #ifdef HAVE_SRTP
-            if( !id->srtp ) /* FIXME: SRTCP support */
+    if( id->srtp )
+    {   /* FIXME: this is awfully inefficient */
+        size_t len = out->i_buffer;
+        out = block_Realloc( out, 0, len + 10 );
+        out->i_buffer = len;
+
+        int val = srtp_send( id->srtp, out->p_buffer, &len, len + 10 );
+        if( val )
+        {
+            msg_Dbg( id->p_stream, "SRTP sending error: %s",
+                     vlc_strerror_c(val) );
+            block_Release( out );
+            return NULL;
+        }
+        out->i_buffer = len;
+    }
+#else
+    VLC_UNUSED(id);
 #endif
-                SendRTCP( id->sinkv[i].rtcp, out );
+    return out;
+}
+
+static void* ThreadSend( void *data )
+{
+    vlc_thread_set_name("vlc-rt-send");
+
+    sout_stream_id_sys_t *id = data;
+    vlc_tick_t i_caching = id->i_caching;
+    block_t *next = NULL;
+
+    for( ;; )
+    {
+        block_t *outv[RTP_BATCH];
+        unsigned outc = 0;
+        block_t *out = next;
+
+        next = NULL;
+        if( out == NULL )
+            out = vlc_queue_DequeueKillable(&id->queue, &id->dead);
+        if( out == NULL )
+            break;
 
-            if( send( id->sinkv[i].rtp_fd, out->p_buffer, len, 0 ) == -1
-             && net_errno != EAGAIN && net_errno != EWOULDBLOCK
-             && net_errno != ENOBUFS && net_errno != ENOMEM )
+        const vlc_tick_t deadline = out->i_dts + i_caching;
+        out = Protect( id, out );
+        if( out == NULL )
+            continue;
+
+        vlc_tick_wait( deadline );
+        outv[outc++] = out;
+
+        /* Packetizers queue all the packets of a frame at once: send the
+         * ones that are due together */
+        while( outc < RTP_BATCH )
+        {
+            vlc_queue_Lock( &id->queue );
+            out = vlc_queue_DequeueUnlocked( &id->queue );
+            vlc_queue_Unlock( &id->queue );
+            if( out == NULL )
+                break;
+            if( out->i_dts + i_caching > vlc_tick_now() )
             {
-                int type;
-                getsockopt( id->sinkv[i].rtp_fd, SOL_SOCKET, SO_TYPE,
-                            &type, &(socklen_t){ sizeof(type) });
-                if( type == SOCK_DGRAM )
-                    /* ICMP soft error: ignore and retry */
-                    send( id->sinkv[i].rtp_fd, out->p_buffer, len, 0 );
-                else
-                    /* Broken connection */
-                    deadv[deadc++] = id->sinkv[i].rtp_fd;
+                next = out;
+                break;
             }
+            out = Protect( id, out );
+            if( out != NULL )
+                outv[outc++] = out;
         }
-        id->i_seq_sent_next = ntohs(((uint16_t *) out->p_buffer)[1]) + 1;
-        vlc_mutex_unlock( &id->lock_sink );
-        block_Release( out );
 
-        for( unsigned i = 0; i < deadc; i++ )
+        for( unsigned i = 0; i < outc; )
         {
-            msg_Dbg( id->p_stream, "removing socket %d", deadv[i] );
-            rtp_del_sink( id, deadv[i] );
+            unsigned count = Pace( id, outv + i, outc - i, deadline );
+
+            SendPackets( id, outv + i, count );
+            i += count;
         }
+
+        for( unsigned i = 0; i < outc; i++ )
+            block_Release( outv[i] );
     }
+
+    if( next != NULL )
+        block_Release( next );
+    if( id->pacer.late > 0 )
+        msg_Warn( id->p_stream, "pacing rate exceeded %"PRIu64" times",
+                  id->pacer.late );
     return NULL;
 }
 
@@ -1467,6 +1697,7 @@ int rtp_add_sink( sout_stream_id_sys_t *id, int fd, bool rtcp_mux, uint16_t *seq
 void rtp_del_sink( sout_stream_id_sys_t *id, int fd )
 {
     rtp_sink_t sink = { fd, NULL };
+    bool found = false;
 
     /* NOTE: must be safe to use if fd is not included */
     vlc_mutex_lock( &id->lock_sink );
@@ -1476,11 +1707,17 @@ void rtp_del_sink( sout_stream_id_sys_t *id, int fd )
         {
             sink = id->sinkv[i];
             TAB_ERASE(id->sinkc, id->sinkv, i);
+            found = true;
             break;
         }
     }
     vlc_mutex_unlock( &id->lock_sink );
 
+    if( found )
+        msg_Dbg( id->p_stream, "socket %d: %"PRIu64" packets (%"PRIu64
+                 " bytes) sent, %"PRIu64" lost", fd, sink.packets,
+                 sink.bytes, sink.lost );
+
     CloseRTCP( sink.rtcp );
     net_Close( sink.rtp_fd );
 }
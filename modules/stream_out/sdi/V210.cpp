@@ -28,11 +28,12 @@
 
 using namespace sdi;
 
-static inline unsigned clip(unsigned a)
+/* Keeps the samples out of the reserved timing reference codes. Branchless,
+ * so that the packing loop does not mispredict on noisy pictures. */
+static inline uint32_t clip(uint32_t a)
 {
-    if      (a < 4) return 4;
-    else if (a > 1019) return 1019;
-    else               return a;
+    a = (a < 4) ? 4 : a;
+    return (a > 1019) ? 1019 : a;
 }
 
 static inline void put_le32(uint8_t **p, uint32_t d)
@@ -50,9 +51,9 @@ void V210::Convert(const picture_t *pic, unsigned dst_stride, void *frame_bytes)
     unsigned h, w;
     uint8_t *dst = (uint8_t*)frame_bytes;
 
-    const uint16_t *y = (const uint16_t*)pic->p[0].p_pixels;
-    const uint16_t *u = (const uint16_t*)pic->p[1].p_pixels;
-    const uint16_t *v = (const uint16_t*)pic->p[2].p_pixels;
+    const uint16_t *__restrict y = (const uint16_t*)pic->p[0].p_pixels;
+    const uint16_t *__restrict u = (const uint16_t*)pic->p[1].p_pixels;
+    const uint16_t *__restrict v = (const uint16_t*)pic->p[2].p_pixels;
 
 #define WRITE_PIXELS(a, b, c)           \
     do {                                \
@@ -64,11 +65,19 @@ void V210::Convert(const picture_t *pic, unsigned dst_stride, void *frame_bytes)
 
     for (h = 0; h < height; h++) {
         uint32_t val = 0;
+        /* 6 pixels in 4 words per iteration, without carrying any state */
         for (w = 0; w + 5 < width; w += 6) {
-            WRITE_PIXELS(u, y, v);
-            WRITE_PIXELS(y, u, y);
-            WRITE_PIXELS(v, y, u);
-            WRITE_PIXELS(y, v, y);
+            SetDWLE(dst, clip(u[0]) | (clip(y[0]) << 10) | (clip(v[0]) << 20));
+            SetDWLE(dst + 4,
+                    clip(y[1]) | (clip(u[1]) << 10) | (clip(y[2]) << 20));
+            SetDWLE(dst + 8,
+                    clip(v[1]) | (clip(y[3]) << 10) | (clip(u[2]) << 20));
+            SetDWLE(dst + 12,
+                    clip(y[4]) | (clip(v[2]) << 10) | (clip(y[5]) << 20));
+            dst += 16;
+            y += 6;
+            u += 3;
+            v += 3;
         }
         if (w + 1 < width) {
             WRITE_PIXELS(u, y, v);
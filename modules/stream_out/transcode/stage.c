@@ -0,0 +1,220 @@
+/*****************************************************************************
+ * stage.c: transcode pipeline stage
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_threads.h>
+#include <vlc_tick.h>
+
+#include "stage.h"
+
+struct stage_entry
+{
+    void *item;
+    vlc_tick_t date; /**< date of the push */
+};
+
+struct transcode_stage
+{
+    vlc_object_t *obj;
+    const char *psz_name;
+    const transcode_stage_callbacks_t *cbs;
+    void *opaque;
+
+    vlc_thread_t thread;
+    vlc_mutex_t lock;
+    vlc_cond_t wait_item; /**< signaled when an item is pushed */
+    vlc_cond_t wait_room; /**< signaled when an item is popped or done */
+
+    bool b_busy;
+    bool b_closing;
+    unsigned head;
+    unsigned count;
+    unsigned depth;
+
+    struct
+    {
+        uint64_t items;
+        uint64_t depth_sum; /**< queue depth seen by each push */
+        unsigned depth_max;
+        vlc_tick_t wait_sum;
+        vlc_tick_t wait_max;
+        vlc_tick_t process_sum;
+        vlc_tick_t process_max;
+    } stats;
+
+    struct stage_entry entries[];
+};
+
+static void *StageThread( void *data )
+{
+    transcode_stage_t *stage = data;
+
+    vlc_thread_set_name( "vlc-transcode" );
+
+    vlc_mutex_lock( &stage->lock );
+    for( ;; )
+    {
+        while( stage->count == 0 && !stage->b_closing )
+            vlc_cond_wait( &stage->wait_item, &stage->lock );
+
+        if( stage->count == 0 )
+            break;
+
+        struct stage_entry entry = stage->entries[stage->head];
+        stage->head = ( stage->head + 1 ) % stage->depth;
+        stage->count--;
+        stage->b_busy = true;
+        vlc_cond_signal( &stage->wait_room );
+        vlc_mutex_unlock( &stage->lock );
+
+        const vlc_tick_t start = vlc_tick_now();
+        stage->cbs->process( stage->opaque, entry.item );
+        const vlc_tick_t end = vlc_tick_now();
+
+        vlc_mutex_lock( &stage->lock );
+        stage->b_busy = false;
+        /* Drain and Flush wait on the same condition as Push */
+        vlc_cond_broadcast( &stage->wait_room );
+
+        const vlc_tick_t wait = start - entry.date;
+        const vlc_tick_t process = end - start;
+        stage->stats.items++;
+        stage->stats.wait_sum += wait;
+        stage->stats.process_sum += process;
+        if( wait > stage->stats.wait_max )
+            stage->stats.wait_max = wait;
+        if( process > stage->stats.process_max )
+            stage->stats.process_max = process;
+    }
+    vlc_mutex_unlock( &stage->lock );
+
+    return NULL;
+}
+
+transcode_stage_t *transcode_stage_New( vlc_object_t *obj, const char *psz_name,
+                                        unsigned depth,
+                                        const transcode_stage_callbacks_t *cbs,
+                                        void *opaque )
+{
+    assert( depth > 0 );
+
+    transcode_stage_t *stage =
+        malloc( sizeof(*stage) + depth * sizeof(stage->entries[0]) );
+    if( unlikely(stage == NULL) )
+        return NULL;
+
+    stage->obj = obj;
+    stage->psz_name = psz_name;
+    stage->cbs = cbs;
+    stage->opaque = opaque;
+    vlc_mutex_init( &stage->lock );
+    vlc_cond_init( &stage->wait_item );
+    vlc_cond_init( &stage->wait_room );
+    stage->b_busy = false;
+    stage->b_closing = false;
+    stage->head = 0;
+    stage->count = 0;
+    stage->depth = depth;
+    memset( &stage->stats, 0, sizeof(stage->stats) );
+
+    if( vlc_clone( &stage->thread, StageThread, stage ) )
+    {
+        free( stage );
+        return NULL;
+    }
+    return stage;
+}
+
+void transcode_stage_Delete( transcode_stage_t *stage )
+{
+    vlc_mutex_lock( &stage->lock );
+    stage->b_closing = true;
+    vlc_cond_signal( &stage->wait_item );
+    vlc_mutex_unlock( &stage->lock );
+
+    vlc_join( stage->thread, NULL );
+
+    if( stage->stats.items > 0 )
+    {
+        const uint64_t items = stage->stats.items;
+        msg_Dbg( stage->obj, "%s stage: %"PRIu64" items, queue depth "
+                 "avg %.1f max %u/%u, wait avg %"PRId64" max %"PRId64" us, "
+                 "process avg %"PRId64" max %"PRId64" us", stage->psz_name,
+                 items, (double) stage->stats.depth_sum / items,
+                 stage->stats.depth_max, stage->depth,
+                 US_FROM_VLC_TICK( stage->stats.wait_sum / items ),
+                 US_FROM_VLC_TICK( stage->stats.wait_max ),
+                 US_FROM_VLC_TICK( stage->stats.process_sum / items ),
+                 US_FROM_VLC_TICK( stage->stats.process_max ) );
+    }
+
+    free( stage );
+}
+
+void transcode_stage_Push( transcode_stage_t *stage, void *item )
+{
+    vlc_mutex_lock( &stage->lock );
+    while( stage->count == stage->depth )
+        vlc_cond_wait( &stage->wait_room, &stage->lock );
+
+    const unsigned tail = ( stage->head + stage->count ) % stage->depth;
+    stage->entries[tail] = (struct stage_entry) {
+        .item = item,
+        .date = vlc_tick_now(),
+    };
+    stage->count++;
+
+    stage->stats.depth_sum += stage->count;
+    if( stage->count > stage->stats.depth_max )
+        stage->stats.depth_max = stage->count;
+
+    vlc_cond_signal( &stage->wait_item );
+    vlc_mutex_unlock( &stage->lock );
+}
+
+void transcode_stage_Drain( transcode_stage_t *stage )
+{
+    vlc_mutex_lock( &stage->lock );
+    while( stage->count > 0 || stage->b_busy )
+        vlc_cond_wait( &stage->wait_room, &stage->lock );
+    vlc_mutex_unlock( &stage->lock );
+}
+
+void transcode_stage_Flush( transcode_stage_t *stage )
+{
+    vlc_mutex_lock( &stage->lock );
+    while( stage->count > 0 )
+    {
+        stage->cbs->release( stage->entries[stage->head].item );
+        stage->head = ( stage->head + 1 ) % stage->depth;
+        stage->count--;
+    }
+    vlc_cond_broadcast( &stage->wait_room );
+
+    while( stage->b_busy )
+        vlc_cond_wait( &stage->wait_room, &stage->lock );
+    vlc_mutex_unlock( &stage->lock );
+}
@@ -0,0 +1,83 @@
+/*****************************************************************************
+ * stage.h: transcode pipeline stage
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef TRANSCODE_STAGE_H
+#define TRANSCODE_STAGE_H
+
+#include <vlc_common.h>
+
+/**
+ * A pipeline stage runs a processing step in its own thread, fed through a
+ * bounded queue.
+ *
+ * Items are processed in order. Pushing to a full queue waits for the stage
+ * to catch up, so that a slow stage throttles the previous ones instead of
+ * buffering without limit.
+ *
+ * The queue depth, the time spent by the items in the queue and the
+ * processing time are measured and reported when the stage is deleted.
+ */
+typedef struct transcode_stage transcode_stage_t;
+
+typedef struct
+{
+    /** Processes an item, called from the stage thread. */
+    void (*process)( void *opaque, void *item );
+    /** Releases an item that was flushed before being processed. */
+    void (*release)( void *item );
+} transcode_stage_callbacks_t;
+
+/**
+ * Creates a stage and starts its thread.
+ *
+ * \param psz_name the name of the stage, used for the thread and the logs
+ * \param depth the maximum number of queued items
+ * \return the stage or NULL on error
+ */
+transcode_stage_t *transcode_stage_New( vlc_object_t *, const char *psz_name,
+                                        unsigned depth,
+                                        const transcode_stage_callbacks_t *,
+                                        void *opaque );
+
+/**
+ * Processes the queued items, stops the thread and deletes the stage.
+ */
+void transcode_stage_Delete( transcode_stage_t * );
+
+/**
+ * Queues an item, waiting for room if the queue is full.
+ */
+void transcode_stage_Push( transcode_stage_t *, void *item );
+
+/**
+ * Waits until all the queued items have been processed.
+ *
+ * \warning Must not be called from the stage thread.
+ */
+void transcode_stage_Drain( transcode_stage_t * );
+
+/**
+ * Releases the queued items and waits for the item being processed, if any.
+ *
+ * \warning Must not be called from the stage thread.
+ */
+void transcode_stage_Flush( transcode_stage_t * );
+
+#endif
@@ -80,6 +80,12 @@
 #define VFILTER_LONGTEXT N_( \
     "Video filters will be applied to the video streams (after overlays " \
     "are applied). You can enter a colon-separated list of filters." )
+#define LADDER_TEXT N_("Video renditions")
+#define LADDER_LONGTEXT N_( \
+    "Additional renditions encoded from the same decoded and filtered " \
+    "video, each one scaled from the previous one, ordered from the " \
+    "largest to the smallest (eg: 1280x720:3000,640x360:800). Their " \
+    "ES ids are the one of the video followed by /1, /2, etc." )
 
 #define AENC_TEXT N_("Audio encoder")
 #define AENC_LONGTEXT N_( \
@@ -132,6 +138,12 @@
 #define POOL_TEXT N_("Picture pool size")
 #define POOL_LONGTEXT N_( "Defines how many pictures we allow to be in pool "\
     "between decoder/encoder threads when threads > 0" )
+#define PIPELINE_TEXT N_("Pipeline depth")
+#define PIPELINE_LONGTEXT N_( \
+    "Decodes each audio and video stream in its own thread, and filters " \
+    "the video in another one, with at most this many frames queued " \
+    "between them. 0 transcodes all the streams in the stream output " \
+    "thread." )
 #define FORWARD_PCR_TEXT N_( "Forward PCR" )
 #define FORWARD_PCR_LONGTEXT N_( \
     "Enable PCR events forwarding to the next stream." )
@@ -186,6 +198,8 @@ vlc_module_begin ()
                  MAXHEIGHT_LONGTEXT )
     add_module_list(SOUT_CFG_PREFIX "vfilter", "video filter", NULL,
                     VFILTER_TEXT, VFILTER_LONGTEXT)
+    add_string( SOUT_CFG_PREFIX "ladder", NULL, LADDER_TEXT,
+                LADDER_LONGTEXT )
 
     set_section( N_("Audio"), NULL )
     add_module(SOUT_CFG_PREFIX "aenc", "audio encoder", "none",
@@ -220,6 +234,9 @@ vlc_module_begin ()
         change_integer_range( 0, 32 )
     add_integer( SOUT_CFG_PREFIX "pool-size", 10, POOL_TEXT, POOL_LONGTEXT )
         change_integer_range( 1, 1000 )
+    add_integer( SOUT_CFG_PREFIX "pipeline", 0, PIPELINE_TEXT,
+                 PIPELINE_LONGTEXT )
+        change_integer_range( 0, 64 )
     add_obsolete_bool( SOUT_CFG_PREFIX "high-priority" ) // Since 4.0.0
     add_bool( SOUT_CFG_PREFIX "forward-pcr", true, FORWARD_PCR_TEXT,
               FORWARD_PCR_LONGTEXT )
@@ -232,7 +249,7 @@ static const char *const ppsz_sout_options[] = {
     "deinterlace-module", "threads", "aenc", "acodec", "ab", "alang",
     "afilter", "samplerate", "channels", "senc", "scodec", "soverlay",
     "sfilter", "high-priority", "maxwidth", "maxheight", "pool-size",
-    "forward-pcr", NULL
+    "forward-pcr", "pipeline", "ladder", NULL
 };
 
 /*****************************************************************************
@@ -332,6 +349,44 @@ static void SetVideoEncoderConfig( sout_stream_t *p_stream, transcode_encoder_co
     p_cfg->video.threads.pool_size = var_GetInteger( p_stream, SOUT_CFG_PREFIX "pool-size" );
 }
 
+static void SetVideoLadderConfig( sout_stream_t *p_stream, sout_stream_sys_t *p_sys )
+{
+    char *psz_string = var_GetNonEmptyString( p_stream, SOUT_CFG_PREFIX "ladder" );
+    if( psz_string == NULL )
+        return;
+
+    for( const char *psz = psz_string; *psz != '\0'; )
+    {
+        transcode_rung_t rung;
+        int i_read;
+        if( sscanf( psz, "%ux%u:%u%n", &rung.i_width, &rung.i_height,
+                    &rung.i_bitrate, &i_read ) != 3 ||
+            rung.i_width == 0 || rung.i_height == 0 ||
+            ( psz[i_read] != ',' && psz[i_read] != '\0' ) )
+        {
+            msg_Warn( p_stream, "invalid video rendition \"%s\"", psz );
+            break;
+        }
+        if( rung.i_bitrate < 16000 )
+            rung.i_bitrate *= 1000;
+
+        transcode_rung_t *p_ladder = realloc( p_sys->p_ladder,
+                                              ( p_sys->i_ladder + 1 ) * sizeof(rung) );
+        if( unlikely(p_ladder == NULL) )
+            break;
+        p_ladder[p_sys->i_ladder++] = rung;
+        p_sys->p_ladder = p_ladder;
+
+        msg_Dbg( p_stream, "video rendition %zu: %ux%u %ukb/s", p_sys->i_ladder,
+                 rung.i_width, rung.i_height, rung.i_bitrate / 1000 );
+
+        psz += i_read;
+        if( *psz == ',' )
+            psz++;
+    }
+    free( psz_string );
+}
+
 static void SetSPUEncoderConfig( sout_stream_t *p_stream, transcode_encoder_config_t *p_cfg )
 {
     char *psz_string = var_GetString( p_stream, SOUT_CFG_PREFIX "senc" );
@@ -381,6 +436,8 @@ static void Flush( sout_stream_t *p_stream, void *_id)
 {
     VLC_UNUSED(p_stream);
     sout_stream_id_sys_t *id = (sout_stream_id_sys_t *)_id;
+    if( id->stage != NULL )
+        transcode_stage_Flush( id->stage );
     enum es_format_category_e i_cat = id->b_transcode && id->p_decoder != NULL ?
                                       id->p_decoder->fmt_in->i_cat : UNKNOWN_ES;
     if( i_cat == VIDEO_ES )
@@ -431,6 +488,9 @@ static int Open( vlc_object_t *p_this )
     p_sys->first_pcr_sent = false;
     p_sys->pcr_sync_has_input = false;
     p_sys->transcoded_stream_nb = 0u;
+    p_sys->i_pipeline_depth =
+        var_GetInteger( p_stream, SOUT_CFG_PREFIX "pipeline" );
+    vlc_mutex_init( &p_sys->output_lock );
 
     /* Audio transcoding parameters */
     transcode_encoder_config_init( &p_sys->aenc_cfg );
@@ -458,6 +518,7 @@ static int Open( vlc_object_t *p_this )
                  p_sys->venc_cfg.video.i_height,
                  p_sys->venc_cfg.video.f_scale,
                  p_sys->venc_cfg.video.i_bitrate / 1000 );
+        SetVideoLadderConfig( p_stream, p_sys );
     }
 
     /* Video Filter Parameters */
@@ -517,6 +578,7 @@ static void Close( sout_stream_t *p_stream )
 
     transcode_encoder_config_clean( &p_sys->venc_cfg );
     sout_filters_config_clean( &p_sys->vfilters_cfg );
+    free( p_sys->p_ladder );
 
     transcode_encoder_config_clean( &p_sys->aenc_cfg );
     sout_filters_config_clean( &p_sys->afilters_cfg );
@@ -566,7 +628,12 @@ static vlc_tick_t GetMasterDrift( void *cbdata )
     vlc_mutex_lock( &p_sys->lock );
     vlc_tick_t drift = 0;
     if( p_sys->id_master_sync )
+    {
+        /* Written by the audio decoding thread when pipelined */
+        vlc_mutex_lock( &p_sys->id_master_sync->fifo.lock );
         drift = p_sys->id_master_sync->i_drift;
+        vlc_mutex_unlock( &p_sys->id_master_sync->fifo.lock );
+    }
     vlc_mutex_unlock( &p_sys->lock );
     return drift;
 }
@@ -613,6 +680,97 @@ static void *transcode_downstream_Add( sout_stream_t *p_stream,
     return downstream;
 }
 
+static int Process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
+                    block_t *p_buffer )
+{
+    sout_stream_sys_t *sys = p_stream->p_sys;
+    block_t *p_out = NULL;
+
+    int i_ret;
+    switch( id->p_decoder->fmt_in->i_cat )
+    {
+    case AUDIO_ES:
+        i_ret = transcode_audio_process( p_stream, id, p_buffer, &p_out );
+        break;
+
+    case VIDEO_ES:
+        i_ret = transcode_video_process( p_stream, id, p_buffer, &p_out );
+        break;
+
+    case SPU_ES:
+        i_ret = transcode_spu_process( p_stream, id, p_buffer, &p_out );
+        break;
+
+    default:
+        if( p_buffer )
+            block_Release( p_buffer );
+        return VLC_EGENERIC;
+    }
+
+    /* Keep the PCR consistent with the blocks of the other streams */
+    vlc_mutex_lock( &sys->output_lock );
+    for( block_t *it = p_out; it != NULL; )
+    {
+        block_t *next = it->p_next;
+        it->p_next = NULL;
+
+        vlc_tick_t pcr = VLC_TICK_INVALID;
+        if( sys->pcr_forwarding_enabled )
+        {
+            const int status = transcode_track_pcr_helper_SignalLeavingFrame(
+                id->pcr_helper, it, &pcr );
+            if( status != VLC_SUCCESS )
+            {
+                msg_Err( p_stream,
+                         "Failed to match transcode input with encoder output. "
+                         "Disabling PCR forwarding..." );
+                sys->pcr_forwarding_enabled = false;
+            }
+        }
+
+        if( sout_StreamIdSend( p_stream->p_next, id->downstream_id, it ) != VLC_SUCCESS )
+        {
+            vlc_mutex_unlock( &sys->output_lock );
+            block_ChainRelease( next );
+            return VLC_EGENERIC;
+        }
+
+        if( pcr != VLC_TICK_INVALID )
+        {
+            sout_StreamSetPCR( p_stream->p_next, pcr );
+        }
+
+        it = next;
+    }
+    vlc_mutex_unlock( &sys->output_lock );
+
+    if (i_ret != VLC_SUCCESS)
+        id->b_error = true;
+
+    return i_ret;
+}
+
+static void ProcessQueued( void *opaque, void *item )
+{
+    sout_stream_id_sys_t *id = opaque;
+    block_t *p_buffer = item;
+
+    if( id->b_error )
+        block_Release( p_buffer );
+    else
+        Process( dec_get_owner( id->p_decoder )->p_stream, id, p_buffer );
+}
+
+static void ReleaseQueued( void *item )
+{
+    block_Release( item );
+}
+
+static const transcode_stage_callbacks_t stage_cbs = {
+    .process = ProcessQueued,
+    .release = ReleaseQueued,
+};
+
 static void *
 Add( sout_stream_t *p_stream, const es_format_t *p_fmt, const char *es_id )
 {
@@ -721,6 +879,20 @@ Add( sout_stream_t *p_stream, const es_format_t *p_fmt, const char *es_id )
         id->pcr_helper = NULL;
     }
 
+    if( p_sys->i_pipeline_depth > 0 && p_fmt->i_cat != SPU_ES )
+    {
+        /* Subtitles are cheap to transcode and are blended by the video
+         * thread, keep them in the stream output thread */
+        id->stage = transcode_stage_New( VLC_OBJECT(p_stream),
+                                         p_fmt->i_cat == AUDIO_ES ? "audio"
+                                                                  : "video",
+                                         p_sys->i_pipeline_depth,
+                                         &stage_cbs, id );
+        if( id->stage == NULL )
+            msg_Warn( p_stream, "cannot start the %4.4s decoding thread",
+                      (char *)&p_fmt->i_codec );
+    }
+
     return id;
 
 error:
@@ -736,6 +908,13 @@ static void Del( sout_stream_t *p_stream, void *_id )
 
     if( id->b_transcode )
     {
+        /* Process the queued blocks, the remaining calls are synchronous */
+        if( id->stage != NULL )
+        {
+            transcode_stage_Delete( id->stage );
+            id->stage = NULL;
+        }
+
         int i_cat = id->p_decoder ? id->p_decoder->fmt_in->i_cat : UNKNOWN_ES;
         switch( i_cat )
         {
@@ -758,7 +937,7 @@ static void Del( sout_stream_t *p_stream, void *_id )
             if( id == p_sys->id_video )
                 p_sys->id_video = NULL;
             vlc_mutex_unlock( &p_sys->lock );
-            transcode_video_clean( id );
+            transcode_video_clean( p_stream, id );
             break;
         case SPU_ES:
             dec_Delete( id->p_decoder );
@@ -782,10 +961,6 @@ static void Del( sout_stream_t *p_stream, void *_id )
 static int Send( sout_stream_t *p_stream, void *_id, block_t *p_buffer )
 {
     sout_stream_id_sys_t *id = (sout_stream_id_sys_t *)_id;
-    block_t *p_out = NULL;
-
-    if( id->b_error )
-        goto error;
 
     if( !id->b_transcode )
     {
@@ -795,77 +970,39 @@ static int Send( sout_stream_t *p_stream, void *_id, block_t *p_buffer )
             goto error;
     }
 
-    sout_stream_sys_t *sys = p_stream->p_sys;
-    if( p_buffer != NULL && sys->pcr_forwarding_enabled )
-    {
-        if( !sys->pcr_sync_has_input )
-            sys->pcr_sync_has_input = true;
-
-        vlc_tick_t dropped_frame_ts;
-        transcode_track_pcr_helper_SignalEnteringFrame( id->pcr_helper, p_buffer,
-                                                       &dropped_frame_ts );
-        if (dropped_frame_ts != VLC_TICK_INVALID)
-        {
-            sout_StreamSetPCR( p_stream->p_next, dropped_frame_ts );
-        }
-    }
-
-    int i_ret;
-    switch( id->p_decoder->fmt_in->i_cat )
-    {
-    case AUDIO_ES:
-        i_ret = transcode_audio_process( p_stream, id, p_buffer, &p_out );
-        break;
-
-    case VIDEO_ES:
-        i_ret = transcode_video_process( p_stream, id, p_buffer, &p_out );
-        break;
-
-    case SPU_ES:
-        i_ret = transcode_spu_process( p_stream, id, p_buffer, &p_out );
-        break;
-
-    default:
+    /* The decoding thread checks for errors itself */
+    if( id->stage == NULL && id->b_error )
         goto error;
-    }
 
-    for( block_t *it = p_out; it != NULL; )
+    sout_stream_sys_t *sys = p_stream->p_sys;
+    if( p_buffer != NULL )
     {
-        block_t *next = it->p_next;
-        it->p_next = NULL;
-
-        vlc_tick_t pcr = VLC_TICK_INVALID;
+        vlc_mutex_lock( &sys->output_lock );
         if( sys->pcr_forwarding_enabled )
         {
-            const int status = transcode_track_pcr_helper_SignalLeavingFrame(
-                id->pcr_helper, it, &pcr );
-            if( status != VLC_SUCCESS )
+            if( !sys->pcr_sync_has_input )
+                sys->pcr_sync_has_input = true;
+
+            vlc_tick_t dropped_frame_ts;
+            transcode_track_pcr_helper_SignalEnteringFrame( id->pcr_helper, p_buffer,
+                                                           &dropped_frame_ts );
+            if (dropped_frame_ts != VLC_TICK_INVALID)
             {
-                msg_Err( p_stream,
-                         "Failed to match transcode input with encoder output. "
-                         "Disabling PCR forwarding..." );
-                sys->pcr_forwarding_enabled = false;
+                sout_StreamSetPCR( p_stream->p_next, dropped_frame_ts );
             }
         }
+        vlc_mutex_unlock( &sys->output_lock );
 
-        if( sout_StreamIdSend( p_stream->p_next, id->downstream_id, it ) != VLC_SUCCESS )
+        if( id->stage != NULL )
         {
-            p_buffer = next;
-            goto error;
+            transcode_stage_Push( id->stage, p_buffer );
+            return VLC_SUCCESS;
         }
-
-        if( pcr != VLC_TICK_INVALID )
-        {
-            sout_StreamSetPCR( p_stream->p_next, pcr );
-        }
-
-        it = next;
     }
+    else if( id->stage != NULL )
+        transcode_stage_Drain( id->stage );
 
-    if (i_ret != VLC_SUCCESS)
-        id->b_error = true;
-
-    return i_ret;
+    return Process( p_stream, id, p_buffer );
 error:
     if( p_buffer )
         block_Release( p_buffer );
@@ -876,13 +1013,14 @@ static void SetPCR( sout_stream_t *stream, vlc_tick_t pcr )
 {
     sout_stream_sys_t *sys = stream->p_sys;
 
+    vlc_mutex_lock( &sys->output_lock );
     if( !sys->pcr_forwarding_enabled )
-        return;
+        goto out;
 
     if( sys->transcoded_stream_nb == 0)
     {
         sout_StreamSetPCR( stream->p_next, pcr );
-        return;
+        goto out;
     }
 
     const int status = vlc_pcr_sync_SignalPCR( sys->pcr_sync, pcr );
@@ -910,4 +1048,6 @@ static void SetPCR( sout_stream_t *stream, vlc_tick_t pcr )
             sout_StreamSetPCR( stream->p_next, pcr );
         }
     }
+out:
+    vlc_mutex_unlock( &sys->output_lock );
 }
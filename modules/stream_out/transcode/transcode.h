@@ -4,6 +4,7 @@
 #include <vlc_codec.h>
 #include "encoder/encoder.h"
 #include "pcr_helper.h"
+#include "stage.h"
 
 /*100ms is around the limit where people are noticing lipsync issues*/
 #define MASTER_SYNC_MAX_DRIFT VLC_TICK_FROM_MS(100)
@@ -43,6 +44,23 @@ void sout_filters_config_clean( sout_filters_config_t *p_cfg )
 
 typedef struct sout_stream_id_sys_t sout_stream_id_sys_t;
 
+/* Additional video rendition, encoded from the same decoded pictures */
+typedef struct
+{
+    unsigned int i_width, i_height;
+    unsigned int i_bitrate;
+} transcode_rung_t;
+
+struct transcode_rendition
+{
+    transcode_encoder_config_t cfg; /**< borrows the strings of venc_cfg */
+    transcode_encoder_t *encoder;
+    filter_chain_t  *p_conv; /**< scaler from the previous rendition */
+    void            *downstream_id;
+    char            *psz_es_id;
+    block_t         *p_out; /**< protected by the output fifo lock */
+};
+
 typedef struct
 {
     bool                  b_soverlay;
@@ -54,6 +72,8 @@ typedef struct
     /* Video */
     transcode_encoder_config_t venc_cfg;
     sout_filters_config_t vfilters_cfg;
+    transcode_rung_t *p_ladder; /**< renditions below the main one */
+    size_t          i_ladder;
 
     /* SPU */
     transcode_encoder_config_t senc_cfg;
@@ -71,6 +91,10 @@ typedef struct
     bool first_pcr_sent;
     bool pcr_sync_has_input;
     unsigned int transcoded_stream_nb;
+
+    /* Pipeline */
+    unsigned        i_pipeline_depth; /**< 0 if not pipelined */
+    vlc_mutex_t     output_lock; /**< serializes the outputs and the PCR */
 } sout_stream_sys_t;
 
 struct aout_filters;
@@ -91,6 +115,7 @@ struct sout_stream_id_sys_t
 
     /* Decoder */
     decoder_t       *p_decoder;
+    transcode_stage_t *stage; /**< decoding thread if pipelined */
 
     struct
     {
@@ -130,6 +155,9 @@ struct sout_stream_id_sys_t
              filter_chain_t  *p_f_chain; /**< deinterlace & fps video filters */
              filter_chain_t  *p_uf_chain; /**< User-specified video filters */
              filter_chain_t  *p_final_conv_static; /**< converter to adapt filtered pics to the encoder */
+             transcode_stage_t *filter_stage; /**< filtering thread if pipelined */
+             struct transcode_rendition *p_renditions; /**< ABR ladder */
+             size_t          i_renditions;
              vlc_blender_t   *p_spu_blender;
              spu_t           *p_spu;
              vlc_decoder_device *dec_dev;
@@ -225,7 +253,7 @@ int  transcode_audio_init   ( sout_stream_t *, const es_format_t *,
 
 /* VIDEO */
 
-void transcode_video_clean  ( sout_stream_id_sys_t * );
+void transcode_video_clean  ( sout_stream_t *, sout_stream_id_sys_t * );
 int  transcode_video_process( sout_stream_t *, sout_stream_id_sys_t *,
                                      block_t *, block_t ** );
 void transcode_video_flush  ( sout_stream_id_sys_t * );
@@ -114,11 +114,20 @@ static int transcode_video_filters_init( sout_stream_t *p_stream,
                                          const es_format_t *p_dst,
                                          sout_stream_id_sys_t *id );
 
+static void transcode_video_renditions_init( sout_stream_t *p_stream,
+                                             sout_stream_id_sys_t *id,
+                                             const es_format_t *p_src,
+                                             vlc_video_context *vctx );
+
 static int video_update_format_decoder( decoder_t *p_dec, vlc_video_context *vctx )
 {
     struct decoder_owner *p_owner = dec_get_owner( p_dec );
     sout_stream_id_sys_t *id = p_owner->id;
 
+    /* The filters and the encoder are reconfigured below */
+    if( id->filter_stage != NULL )
+        transcode_stage_Drain( id->filter_stage );
+
     vlc_mutex_lock(&id->fifo.lock);
     if( id->encoder != NULL && transcode_encoder_opened( id->encoder ) )
     {
@@ -216,9 +225,15 @@ static int video_update_format_decoder( decoder_t *p_dec, vlc_video_context *vct
                encoder_fmt);
          if( filter_chain_AppendConverter( id->p_final_conv_static, NULL ) != VLC_SUCCESS )
              goto error;
+         enc_vctx = filter_chain_GetVideoCtxOut( id->p_final_conv_static );
     }
     vlc_mutex_unlock(&id->fifo.lock);
 
+    /* The main encoder input does not change once opened */
+    if( id->p_renditions == NULL )
+        transcode_video_renditions_init( p_owner->p_stream, id,
+                                         encoder_fmt, enc_vctx );
+
     if( !id->downstream_id )
         id->downstream_id =
             id->pf_transcode_downstream_add( p_owner->p_stream,
@@ -252,10 +267,10 @@ static picture_t *video_new_buffer_encoder( transcode_encoder_t *p_enc )
 static int transcode_process_picture( sout_stream_id_sys_t *id,
                                       picture_t *p_pic, block_t **out);
 
-static void decoder_queue_video( decoder_t *p_dec, picture_t *p_pic )
+static void transcode_queue_picture( void *opaque, void *item )
 {
-    struct decoder_owner *p_owner = dec_get_owner( p_dec );
-    sout_stream_id_sys_t *id = p_owner->id;
+    sout_stream_id_sys_t *id = opaque;
+    picture_t *p_pic = item;
 
     block_t *p_block = NULL;
     int ret = transcode_process_picture( id, p_pic, &p_block );
@@ -264,7 +279,8 @@ static void decoder_queue_video( decoder_t *p_dec, picture_t *p_pic )
         return;
 
     vlc_fifo_Lock( id->output_fifo );
-    id->b_error |= ret != VLC_SUCCESS;
+    if( ret != VLC_SUCCESS )
+        id->b_error = true;
     if( id->b_error )
     {
         vlc_fifo_Unlock( id->output_fifo );
@@ -276,6 +292,149 @@ static void decoder_queue_video( decoder_t *p_dec, picture_t *p_pic )
     vlc_fifo_Unlock( id->output_fifo );
 }
 
+static void transcode_release_picture( void *item )
+{
+    picture_Release( item );
+}
+
+static const transcode_stage_callbacks_t filter_stage_cbs = {
+    .process = transcode_queue_picture,
+    .release = transcode_release_picture,
+};
+
+static void decoder_queue_video( decoder_t *p_dec, picture_t *p_pic )
+{
+    struct decoder_owner *p_owner = dec_get_owner( p_dec );
+    sout_stream_id_sys_t *id = p_owner->id;
+
+    if( id->filter_stage != NULL )
+        transcode_stage_Push( id->filter_stage, p_pic );
+    else
+        transcode_queue_picture( id, p_pic );
+}
+
+static int transcode_video_rendition_open( sout_stream_t *p_stream,
+                                           sout_stream_id_sys_t *id,
+                                           struct transcode_rendition *p_rend,
+                                           const es_format_t *p_src,
+                                           vlc_video_context *vctx )
+{
+    struct encoder_owner *p_enc_owner =
+       (struct encoder_owner *)sout_EncoderCreate( VLC_OBJECT(p_stream), sizeof(struct encoder_owner) );
+    if ( unlikely(p_enc_owner == NULL))
+        return VLC_EGENERIC;
+
+    p_rend->encoder = transcode_encoder_new( &p_enc_owner->enc, p_src );
+    if( !p_rend->encoder )
+    {
+        vlc_object_delete( &p_enc_owner->enc );
+        return VLC_EGENERIC;
+    }
+    p_enc_owner->id = id;
+    p_enc_owner->enc.cbs = &encoder_video_transcode_cbs;
+
+    transcode_encoder_update_format_in( p_rend->encoder, p_src, &p_rend->cfg );
+    transcode_encoder_video_configure( VLC_OBJECT(p_stream),
+               &id->p_decoder->fmt_out.video, &p_rend->cfg,
+               &p_src->video, vctx, p_rend->encoder );
+    if( transcode_encoder_open( p_rend->encoder, &p_rend->cfg ) != VLC_SUCCESS )
+        return VLC_EGENERIC;
+
+    const es_format_t *encoder_fmt = transcode_encoder_format_in( p_rend->encoder );
+    if( !video_format_IsSimilar( &encoder_fmt->video, &p_src->video ) )
+    {
+        filter_owner_t chain_owner = {
+           .video = &transcode_filter_video_cbs,
+           .sys = id,
+        };
+
+        p_rend->p_conv = filter_chain_NewVideo( p_stream, false, &chain_owner );
+        if( !p_rend->p_conv )
+            return VLC_EGENERIC;
+        filter_chain_Reset( p_rend->p_conv, p_src, vctx, encoder_fmt );
+        if( filter_chain_AppendConverter( p_rend->p_conv, NULL ) != VLC_SUCCESS )
+            return VLC_EGENERIC;
+    }
+
+    p_rend->downstream_id =
+        id->pf_transcode_downstream_add( p_stream, id->p_decoder->fmt_in,
+                                         transcode_encoder_format_out( p_rend->encoder ),
+                                         p_rend->psz_es_id );
+    return p_rend->downstream_id ? VLC_SUCCESS : VLC_EGENERIC;
+}
+
+static void transcode_video_rendition_clean( sout_stream_t *p_stream,
+                                             struct transcode_rendition *p_rend )
+{
+    if( p_rend->encoder )
+        transcode_encoder_delete( p_rend->encoder );
+    transcode_remove_filters( &p_rend->p_conv );
+    block_ChainRelease( p_rend->p_out );
+    if( p_rend->downstream_id )
+        sout_StreamIdDel( p_stream->p_next, p_rend->downstream_id );
+    free( p_rend->psz_es_id );
+}
+
+static void transcode_video_renditions_init( sout_stream_t *p_stream,
+                                             sout_stream_id_sys_t *id,
+                                             const es_format_t *p_src,
+                                             vlc_video_context *vctx )
+{
+    const sout_stream_sys_t *p_sys = p_stream->p_sys;
+    if( p_sys->i_ladder == 0 )
+        return;
+
+    struct transcode_rendition *p_renditions =
+        vlc_alloc( p_sys->i_ladder, sizeof(*p_renditions) );
+    if( unlikely(p_renditions == NULL) )
+        return;
+
+    /* Each rendition is scaled from the previous one, sharing the
+     * decoding and the filters of the main one */
+    size_t i_renditions = 0;
+    for( size_t i = 0; i < p_sys->i_ladder; i++ )
+    {
+        struct transcode_rendition *p_rend = &p_renditions[i_renditions];
+        memset( p_rend, 0, sizeof(*p_rend) );
+        p_rend->cfg = *id->p_enccfg;
+        p_rend->cfg.video.f_scale = 0.f;
+        p_rend->cfg.video.i_width = p_sys->p_ladder[i].i_width;
+        p_rend->cfg.video.i_height = p_sys->p_ladder[i].i_height;
+        p_rend->cfg.video.i_maxwidth = 0;
+        p_rend->cfg.video.i_maxheight = 0;
+        p_rend->cfg.video.i_bitrate = p_sys->p_ladder[i].i_bitrate;
+
+        if( asprintf( &p_rend->psz_es_id, "%s/%zu", id->es_id, i + 1 ) < 0 )
+        {
+            p_rend->psz_es_id = NULL;
+            break;
+        }
+
+        if( transcode_video_rendition_open( p_stream, id, p_rend,
+                                            p_src, vctx ) != VLC_SUCCESS )
+        {
+            msg_Warn( p_stream, "cannot encode the %ux%u video rendition",
+                      p_rend->cfg.video.i_width, p_rend->cfg.video.i_height );
+            transcode_video_rendition_clean( p_stream, p_rend );
+            continue;
+        }
+
+        p_src = transcode_encoder_format_in( p_rend->encoder );
+        if( p_rend->p_conv )
+            vctx = filter_chain_GetVideoCtxOut( p_rend->p_conv );
+        i_renditions++;
+    }
+
+    if( i_renditions == 0 )
+    {
+        free( p_renditions );
+        return;
+    }
+
+    id->p_renditions = p_renditions;
+    id->i_renditions = i_renditions;
+}
+
 int transcode_video_init( sout_stream_t *p_stream, const es_format_t *p_fmt,
                           sout_stream_id_sys_t *id )
 {
@@ -287,6 +446,19 @@ int transcode_video_init( sout_stream_t *p_stream, const es_format_t *p_fmt,
     if( id->output_fifo == NULL )
         return VLC_ENOMEM;
 
+    /* Filter and encode while the next pictures are decoded */
+    const sout_stream_sys_t *p_sys = p_stream->p_sys;
+    id->filter_stage = NULL;
+    if( p_sys->i_pipeline_depth > 0 )
+    {
+        id->filter_stage = transcode_stage_New( VLC_OBJECT(p_stream),
+                                                "video filter",
+                                                p_sys->i_pipeline_depth,
+                                                &filter_stage_cbs, id );
+        if( id->filter_stage == NULL )
+            msg_Warn( p_stream, "cannot start the video filtering thread" );
+    }
+
     id->b_transcode = true;
     es_format_Init( &id->decoder_out, VIDEO_ES, 0 );
 
@@ -313,6 +485,9 @@ int transcode_video_init( sout_stream_t *p_stream, const es_format_t *p_fmt,
     if( !id->p_decoder->p_module )
     {
         msg_Err( p_stream, "cannot find video decoder" );
+        if( id->filter_stage != NULL )
+            transcode_stage_Delete( id->filter_stage );
+        block_FifoRelease( id->output_fifo );
         es_format_Clean( &id->decoder_out );
         return VLC_EGENERIC;
     }
@@ -396,16 +571,29 @@ static int transcode_video_filters_init( sout_stream_t *p_stream,
 
 void transcode_video_flush( sout_stream_id_sys_t *id )
 {
+    if ( id->filter_stage != NULL )
+        transcode_stage_Flush( id->filter_stage );
     if ( id->p_f_chain != NULL )
         filter_chain_VideoFlush( id->p_f_chain );
     if ( id->p_uf_chain != NULL )
         filter_chain_VideoFlush( id->p_uf_chain );
     if ( id->p_final_conv_static != NULL )
         filter_chain_VideoFlush( id->p_final_conv_static );
+    for ( size_t i = 0; i < id->i_renditions; i++ )
+        if ( id->p_renditions[i].p_conv != NULL )
+            filter_chain_VideoFlush( id->p_renditions[i].p_conv );
 }
 
-void transcode_video_clean( sout_stream_id_sys_t *id )
+void transcode_video_clean( sout_stream_t *p_stream, sout_stream_id_sys_t *id )
 {
+    /* Encode the pictures still queued for filtering */
+    if ( id->filter_stage != NULL )
+        transcode_stage_Delete( id->filter_stage );
+
+    for ( size_t i = 0; i < id->i_renditions; i++ )
+        transcode_video_rendition_clean( p_stream, &id->p_renditions[i] );
+    free( id->p_renditions );
+
     /* Close encoder, but only if one was opened. */
     if ( id->encoder )
         transcode_encoder_delete( id->encoder );
@@ -429,12 +617,17 @@ void transcode_video_clean( sout_stream_id_sys_t *id )
 void transcode_video_push_spu( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
                                subpicture_t *p_subpicture )
 {
+    /* The pictures are blended by the filtering thread when pipelined */
+    vlc_mutex_lock( &id->fifo.lock );
     if( !id->p_spu )
         id->p_spu = spu_Create( p_stream, NULL );
-    if( !id->p_spu )
+    spu_t *p_spu = id->p_spu;
+    vlc_mutex_unlock( &id->fifo.lock );
+
+    if( !p_spu )
         subpicture_Delete( p_subpicture );
     else
-        spu_PutSubpicture( id->p_spu, p_subpicture );
+        spu_PutSubpicture( p_spu, p_subpicture );
 }
 
 int transcode_video_get_output_dimensions( sout_stream_id_sys_t *id,
@@ -449,12 +642,16 @@ int transcode_video_get_output_dimensions( sout_stream_id_sys_t *id,
 
 static picture_t * RenderSubpictures( sout_stream_id_sys_t *id, picture_t *p_pic )
 {
-    if( !id->p_spu )
+    vlc_mutex_lock( &id->fifo.lock );
+    spu_t *p_spu = id->p_spu;
+    if( !p_spu )
+    {
+        vlc_mutex_unlock( &id->fifo.lock );
         return p_pic;
+    }
 
     /* Check if we have a subpicture to overlay */
     video_format_t fmt, outfmt;
-    vlc_mutex_lock( &id->fifo.lock );
     video_format_Copy( &outfmt, &id->decoder_out.video );
     vlc_mutex_unlock( &id->fifo.lock );
     video_format_Copy( &fmt, &p_pic->format );
@@ -467,7 +664,7 @@ static picture_t * RenderSubpictures( sout_stream_id_sys_t *id, picture_t *p_pic
     }
     fmt.i_sar_den = fmt.i_sar_num = 1;
 
-    vlc_render_subpicture *p_subpic = spu_Render( id->p_spu, NULL, &fmt,
+    vlc_render_subpicture *p_subpic = spu_Render( p_spu, NULL, &fmt,
                                          &outfmt, false, NULL, vlc_tick_now(), p_pic->date,
                                          false );
 
@@ -487,7 +684,7 @@ static picture_t * RenderSubpictures( sout_stream_id_sys_t *id, picture_t *p_pic
             }
         }
         if( unlikely( !id->p_spu_blender ) )
-            id->p_spu_blender = filter_NewBlend( VLC_OBJECT( id->p_spu ), &fmt );
+            id->p_spu_blender = filter_NewBlend( VLC_OBJECT( p_spu ), &fmt );
         if( likely( id->p_spu_blender ) )
             picture_BlendSubpicture( p_pic, id->p_spu_blender, p_subpic );
         vlc_render_subpicture_Delete( p_subpic );
@@ -509,6 +706,68 @@ static void tag_last_block_with_flag( block_t **out, int i_flag )
     }
 }
 
+static void transcode_encode_renditions( sout_stream_id_sys_t *id,
+                                        picture_t *p_pic )
+{
+    picture_t *p_src = picture_Hold( p_pic );
+    for( size_t i = 0; i < id->i_renditions && p_src; i++ )
+    {
+        struct transcode_rendition *p_rend = &id->p_renditions[i];
+
+        /* The scaled picture is the source of the next rendition */
+        picture_t *p_scaled = p_rend->p_conv ?
+            filter_chain_VideoFilter( p_rend->p_conv, p_src ) : p_src;
+        if( !p_scaled )
+            return;
+
+        block_t *p_encoded = transcode_encoder_encode( p_rend->encoder, p_scaled );
+        if( p_encoded )
+        {
+            vlc_fifo_Lock( id->output_fifo );
+            block_ChainAppend( &p_rend->p_out, p_encoded );
+            vlc_fifo_Unlock( id->output_fifo );
+        }
+        p_src = p_scaled;
+    }
+    if( p_src )
+        picture_Release( p_src );
+}
+
+static void transcode_send_renditions( sout_stream_t *p_stream,
+                                       sout_stream_id_sys_t *id,
+                                       bool b_drain, bool b_eos )
+{
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+
+    for( size_t i = 0; i < id->i_renditions; i++ )
+    {
+        struct transcode_rendition *p_rend = &id->p_renditions[i];
+
+        vlc_fifo_Lock( id->output_fifo );
+        block_t *p_out = p_rend->p_out;
+        p_rend->p_out = NULL;
+        vlc_fifo_Unlock( id->output_fifo );
+
+        if( b_drain )
+            transcode_encoder_drain( p_rend->encoder, &p_out );
+        if( b_eos )
+            tag_last_block_with_flag( &p_out, BLOCK_FLAG_END_OF_SEQUENCE );
+        if( p_out == NULL )
+            continue;
+
+        /* The PCR is driven by the main rendition */
+        vlc_mutex_lock( &p_sys->output_lock );
+        while( p_out )
+        {
+            block_t *p_next = p_out->p_next;
+            p_out->p_next = NULL;
+            sout_StreamIdSend( p_stream->p_next, p_rend->downstream_id, p_out );
+            p_out = p_next;
+        }
+        vlc_mutex_unlock( &p_sys->output_lock );
+    }
+}
+
 static int transcode_process_picture( sout_stream_id_sys_t *id,
                                       picture_t *p_pic, block_t **out)
 {
@@ -543,6 +802,9 @@ static int transcode_process_picture( sout_stream_id_sys_t *id,
             /* Blend subpictures */
             p_in = RenderSubpictures( id, p_in );
 
+            if( p_in && id->i_renditions > 0 )
+                transcode_encode_renditions( id, p_in );
+
             if( p_in )
             {
                 /* If a packetizer is used, multiple blocks might be returned, in w */
@@ -567,6 +829,10 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
     if( ret != VLCDEC_SUCCESS )
         return VLC_EGENERIC;
 
+    /* Wait for the pictures decoded up to the end of the sequence */
+    if( id->filter_stage != NULL && ( in == NULL || b_eos ) )
+        transcode_stage_Drain( id->filter_stage );
+
     /*
      * Encoder creation depends on decoder's update_format which is only
      * created once a few frames have been passed to the decoder.
@@ -594,5 +860,8 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
     if( b_eos )
         tag_last_block_with_flag( out, BLOCK_FLAG_END_OF_SEQUENCE );
 
+    if( !has_error )
+        transcode_send_renditions( p_stream, id, in == NULL, b_eos );
+
     return has_error ? VLC_EGENERIC : VLC_SUCCESS;
 }
@@ -22,6 +22,7 @@
 # include "config.h"
 #endif
 
+#include <assert.h>
 #include <errno.h>
 #include <stdlib.h>
 #include <string.h>
@@ -29,6 +30,9 @@
 #ifdef HAVE_ARPA_INET_H
 #include <arpa/inet.h>
 #endif
+#ifdef __linux__
+#include <netinet/udp.h>
+#endif
 
 #include <vlc_common.h>
 #include <vlc_configuration.h>
@@ -38,6 +42,8 @@
 
 #include <vlc_network.h>
 #include <vlc_memstream.h>
+#include <vlc_queue.h>
+#include <vlc_threads.h>
 #include "sdp_helper.h"
 
 struct sout_stream_udp
@@ -47,6 +53,14 @@ struct sout_stream_udp
     session_descriptor_t *sap;
     int fd;
     uint_fast16_t mtu;
+    bool gso;
+
+    /* departure time pacing */
+    bool pace;
+    vlc_tick_t caching;
+    vlc_queue_t queue;
+    bool dead;
+    vlc_thread_t thread;
 };
 
 static void *
@@ -144,39 +158,197 @@ static int Control(sout_stream_t *stream, int query, va_list args)
     return VLC_SUCCESS;
 }
 
-static ssize_t AccessOutWrite(sout_access_out_t *access, block_t *block)
+#define UDP_DATAGRAM_IOV 16
+/* Datagrams sent per system call, also the kernel limit of segments */
+#define UDP_BATCH_MAX 64
+#define UDP_BATCH_IOV (UDP_BATCH_MAX * 8)
+/* Largest UDP payload with an IPv6 header */
+#define UDP_GSO_MAX_LENGTH (65535 - 8 - 40)
+
+typedef struct
+{
+    unsigned iov; /* index of the first iovec */
+    unsigned iovlen;
+    size_t length;
+} udp_datagram_t;
+
+static ssize_t SendPlain(sout_access_out_t *access, struct iovec *iov,
+                         const udp_datagram_t *dgrams, unsigned count)
 {
     struct sout_stream_udp *sys = access->p_sys;
     ssize_t total = 0;
 
-    while (block != NULL) {
-        struct iovec iov[16];
-        block_t *unsent = block;
-        unsigned iovlen = 0;
-        size_t tosend = 0;
+#ifdef HAVE_SENDMMSG
+    struct mmsghdr msgs[UDP_BATCH_MAX];
 
-        /* Count how many blocks to gather */
-        do {
-            if (iovlen >= ARRAY_SIZE(iov))
-                break;
-            if (unsent->i_buffer + tosend > sys->mtu && likely(iovlen > 0))
-                break;
+    assert(count <= ARRAY_SIZE(msgs));
+    for (unsigned i = 0; i < count; i++)
+        msgs[i] = (struct mmsghdr) {
+            .msg_hdr = {
+                .msg_iov = iov + dgrams[i].iov,
+                .msg_iovlen = dgrams[i].iovlen,
+            },
+        };
 
-            iov[iovlen].iov_base = unsent->p_buffer;
-            iov[iovlen].iov_len = unsent->i_buffer;
-            iovlen++;
-            tosend += unsent->i_buffer;
-            unsent = unsent->p_next;
-        } while (unsent != NULL);
+    for (unsigned i = 0; i < count;) {
+        int val = sendmmsg(sys->fd, msgs + i, count - i, 0);
 
-        /* Send */
-        struct msghdr hdr = { .msg_iov = iov, .msg_iovlen = iovlen };
+        if (val < 0) {
+            /* Skip the datagram that failed */
+            msg_Err(access, "send error: %s", vlc_strerror_c(errno));
+            i++;
+            continue;
+        }
+
+        for (int j = 0; j < val; j++)
+            total += msgs[i + j].msg_len;
+        i += val;
+    }
+#else
+    for (unsigned i = 0; i < count; i++) {
+        struct msghdr hdr = {
+            .msg_iov = iov + dgrams[i].iov,
+            .msg_iovlen = dgrams[i].iovlen,
+        };
         ssize_t val = sendmsg(sys->fd, &hdr, 0);
 
         if (val < 0)
             msg_Err(access, "send error: %s", vlc_strerror_c(errno));
         else
             total += val;
+    }
+#endif
+    return total;
+}
+
+#ifdef UDP_SEGMENT
+static ssize_t SendSegmented(sout_access_out_t *access, struct iovec *iov,
+                             unsigned iovlen, size_t segment)
+{
+    struct sout_stream_udp *sys = access->p_sys;
+    union {
+        char buf[CMSG_SPACE(sizeof (uint16_t))];
+        struct cmsghdr align;
+    } control;
+    struct msghdr hdr = {
+        .msg_iov = iov,
+        .msg_iovlen = iovlen,
+        .msg_control = control.buf,
+        .msg_controllen = sizeof (control.buf),
+    };
+
+    memset(&control, 0, sizeof (control));
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&hdr);
+    uint16_t size = segment;
+
+    cmsg->cmsg_level = SOL_UDP;
+    cmsg->cmsg_type = UDP_SEGMENT;
+    cmsg->cmsg_len = CMSG_LEN(sizeof (size));
+    memcpy(CMSG_DATA(cmsg), &size, sizeof (size));
+
+    return sendmsg(sys->fd, &hdr, 0);
+}
+#endif
+
+static ssize_t SendBatch(sout_access_out_t *access, struct iovec *iov,
+                         const udp_datagram_t *dgrams, unsigned count)
+{
+    struct sout_stream_udp *sys = access->p_sys;
+    ssize_t total = 0;
+    unsigned i = 0;
+
+#ifdef UDP_SEGMENT
+    while (sys->gso && i < count) {
+        /* The kernel splits the payload in segments of the same size, only
+         * the last one can be shorter */
+        const size_t segment = dgrams[i].length;
+        size_t length = segment;
+        unsigned n = 1;
+
+        while (i + n < count && dgrams[i + n].length <= segment
+            && length + dgrams[i + n].length <= UDP_GSO_MAX_LENGTH) {
+            length += dgrams[i + n].length;
+            if (dgrams[i + n++].length < segment)
+                break;
+        }
+
+        if (n == 1) {
+            total += SendPlain(access, iov, dgrams + i, 1);
+            i++;
+            continue;
+        }
+
+        const udp_datagram_t *last = &dgrams[i + n - 1];
+        ssize_t val = SendSegmented(access, iov + dgrams[i].iov,
+                                    last->iov + last->iovlen - dgrams[i].iov,
+                                    segment);
+        if (val < 0) {
+            int err = errno;
+
+            if (err == EIO || err == EINVAL || err == ENOPROTOOPT
+             || err == EOPNOTSUPP) {
+                /* No segmentation offload on this path, send the datagrams
+                 * of this batch and the next ones one by one */
+                msg_Warn(access, "UDP segmentation offload unavailable: %s",
+                         vlc_strerror_c(err));
+                sys->gso = false;
+                break;
+            }
+            msg_Err(access, "send error: %s", vlc_strerror_c(err));
+        }
+        else
+            total += val;
+        i += n;
+    }
+#endif
+
+    if (i < count)
+        total += SendPlain(access, iov, dgrams + i, count - i);
+    return total;
+}
+
+static ssize_t SendChain(sout_access_out_t *access, block_t *block)
+{
+    struct sout_stream_udp *sys = access->p_sys;
+    ssize_t total = 0;
+
+    /* The muxer outputs the packets due at the same time in one chain: they
+     * are sent together with as few system calls as possible, the pacing is
+     * done by the stream output. */
+    while (block != NULL) {
+        struct iovec iov[UDP_BATCH_IOV];
+        udp_datagram_t dgrams[UDP_BATCH_MAX];
+        block_t *unsent = block;
+        unsigned iovlen = 0, count = 0;
+
+        /* Count how many blocks to gather in each datagram */
+        while (unsent != NULL && count < ARRAY_SIZE(dgrams)
+            && iovlen + UDP_DATAGRAM_IOV <= ARRAY_SIZE(iov)) {
+            udp_datagram_t *dgram = &dgrams[count++];
+
+            dgram->iov = iovlen;
+            dgram->iovlen = 0;
+            dgram->length = 0;
+
+            do {
+                if (dgram->iovlen >= UDP_DATAGRAM_IOV)
+                    break;
+                if (unsent->i_buffer + dgram->length > sys->mtu
+                 && likely(dgram->iovlen > 0))
+                    break;
+
+                iov[iovlen].iov_base = unsent->p_buffer;
+                iov[iovlen].iov_len = unsent->i_buffer;
+                iovlen++;
+                dgram->iovlen++;
+                dgram->length += unsent->i_buffer;
+                unsent = unsent->p_next;
+            } while (unsent != NULL);
+        }
+
+        /* Send */
+        total += SendBatch(access, iov, dgrams, count);
 
         /* Free */
         do {
@@ -190,6 +362,61 @@ static ssize_t AccessOutWrite(sout_access_out_t *access, block_t *block)
     return total;
 }
 
+/* Sends each datagram at the departure time of its first packet, as dated
+ * by the muxer */
+static void *PaceThread(void *data)
+{
+    sout_access_out_t *access = data;
+    struct sout_stream_udp *sys = access->p_sys;
+    block_t *next = NULL;
+
+    vlc_thread_set_name("vlc-udp-pace");
+
+    for (;;) {
+        block_t *block = next;
+
+        if (block == NULL)
+            block = vlc_queue_DequeueKillable(&sys->queue, &sys->dead);
+        if (block == NULL)
+            break;
+
+        /* Gather the already queued packets fitting in the datagram */
+        block_t **pp = &block->p_next;
+        size_t length = block->i_buffer;
+        bool dead;
+
+        vlc_queue_Lock(&sys->queue);
+        while ((next = vlc_queue_DequeueUnlocked(&sys->queue)) != NULL
+            && length + next->i_buffer <= sys->mtu) {
+            length += next->i_buffer;
+            *pp = next;
+            pp = &next->p_next;
+        }
+        dead = sys->dead;
+        vlc_queue_Unlock(&sys->queue);
+
+        /* Do not wait anymore once closing */
+        if (block->i_dts != VLC_TICK_INVALID && !dead)
+            vlc_tick_wait(block->i_dts + sys->caching);
+        SendChain(access, block);
+    }
+    return NULL;
+}
+
+static ssize_t AccessOutWrite(sout_access_out_t *access, block_t *block)
+{
+    struct sout_stream_udp *sys = access->p_sys;
+
+    if (!sys->pace)
+        return SendChain(access, block);
+
+    size_t total = 0;
+    for (block_t *b = block; b != NULL; b = b->p_next)
+        total += b->i_buffer;
+    vlc_queue_Enqueue(&sys->queue, block);
+    return total;
+}
+
 static void Close(sout_stream_t *stream)
 {
     struct sout_stream_udp *sys = stream->p_sys;
@@ -198,6 +425,10 @@ static void Close(sout_stream_t *stream)
         sout_AnnounceUnRegister(stream, sys->sap);
 
     sout_MuxDelete(sys->mux);
+    if (sys->pace) {
+        vlc_queue_Kill(&sys->queue, &sys->dead);
+        vlc_join(sys->thread, NULL);
+    }
     sout_AccessOutDelete(sys->access);
     net_Close(sys->fd);
     free(sys);
@@ -213,7 +444,7 @@ static const struct sout_stream_operations ops = {
 };
 
 static const char *const chain_options[] = {
-    "avformat", "dst", "sap", "name", "description", NULL
+    "avformat", "dst", "sap", "name", "description", "pace", "caching", NULL
 };
 
 #define DEFAULT_PORT 1234
@@ -292,6 +523,7 @@ static int Open(vlc_object_t *obj)
         ret = VLC_ENOMEM;
         goto error;
     }
+    sys->pace = false;
 
     access = vlc_object_create(stream, sizeof (*access));
     if (unlikely(access == NULL)) {
@@ -311,6 +543,27 @@ static int Open(vlc_object_t *obj)
     sys->access = access;
     sys->fd = fd;
     sys->mtu = var_InheritInteger(stream, "mtu");
+#ifdef UDP_SEGMENT
+    int segment;
+    socklen_t segmentlen = sizeof (segment);
+
+    /* Older kernels don't know the option */
+    sys->gso = getsockopt(fd, SOL_UDP, UDP_SEGMENT, &segment,
+                          &segmentlen) == 0;
+#else
+    sys->gso = false;
+#endif
+
+    sys->pace = var_GetBool(stream, SOUT_CFG_PREFIX "pace");
+    sys->caching = VLC_TICK_FROM_MS(var_GetInteger(stream,
+                                                   SOUT_CFG_PREFIX "caching"));
+    vlc_queue_Init(&sys->queue, offsetof (block_t, p_next));
+    sys->dead = false;
+    if (sys->pace && vlc_clone(&sys->thread, PaceThread, access)) {
+        sys->pace = false;
+        ret = VLC_ENOMEM;
+        goto error;
+    }
 
     sout_mux_t *mux = sout_MuxNew(access, muxmod);
     if (mux == NULL) {
@@ -329,6 +582,10 @@ static int Open(vlc_object_t *obj)
     return VLC_SUCCESS;
 
 error:
+    if (sys != NULL && sys->pace) {
+        vlc_queue_Kill(&sys->queue, &sys->dead);
+        vlc_join(sys->thread, NULL);
+    }
     if (access != NULL)
         sout_AccessOutDelete(access);
     free(sys);
@@ -346,6 +603,14 @@ error:
 #define NAME_TEXT N_("SAP name")
 #define NAME_LONGTEXT N_( \
     "Name of the stream that will be announced with SAP.")
+#define PACE_TEXT N_("Pace the packets")
+#define PACE_LONGTEXT N_( \
+    "Send each datagram at the departure time given by the muxer, " \
+    "instead of as soon as it is muxed. Use with a constant mux rate.")
+#define CACHING_TEXT N_("Caching value (ms)")
+#define CACHING_LONGTEXT N_( \
+    "Delay of the paced departures, to absorb the irregularities " \
+    "of the input.")
 #define DESC_TEXT N_("SAP description")
 #define DESC_LONGTEXT N_( \
     "Short description of the stream that will be announced with SAP.")
@@ -362,6 +627,9 @@ vlc_module_begin()
     add_bool(SOUT_CFG_PREFIX "sap", false, SAP_TEXT, SAP_LONGTEXT)
     add_string(SOUT_CFG_PREFIX "name", "", NAME_TEXT, NAME_LONGTEXT)
     add_string(SOUT_CFG_PREFIX "description", "", DESC_TEXT, DESC_LONGTEXT)
+    add_bool(SOUT_CFG_PREFIX "pace", false, PACE_TEXT, PACE_LONGTEXT)
+    add_integer(SOUT_CFG_PREFIX "caching", MS_FROM_VLC_TICK(DEFAULT_PTS_DELAY),
+                CACHING_TEXT, CACHING_LONGTEXT)
 
     set_callback(Open)
 vlc_module_end()
@@ -0,0 +1,230 @@
+/*****************************************************************************
+ * atlas.c : Process-wide glyph bitmap cache for freetype2
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_atomic.h>
+#include <vlc_threads.h>
+
+/* Freetype */
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_GLYPH_H
+
+#include "atlas.h"
+#include "lru.h"
+
+#define FTATLAS_MAX_GLYPHS 4096
+
+struct vlc_ftatlas_t
+{
+    vlc_mutex_t lock;
+    vlc_lru    *glyphs_lrucache;
+    unsigned    refs;
+};
+
+struct vlc_ftatlas_entry_t
+{
+    vlc_atomic_rc_t rc;
+    FT_Int          left;  /* relative to the snapped pen */
+    FT_Int          top;
+    FT_Bitmap       bitmap;
+    unsigned char   pixels[];
+};
+
+static vlc_mutex_t atlas_lock = VLC_STATIC_MUTEX;
+static vlc_ftatlas_t *atlas_instance = NULL;
+
+static void EntryRelease( vlc_ftatlas_entry_t *entry )
+{
+    if( vlc_atomic_rc_dec( &entry->rc ) )
+        free( entry );
+}
+
+static void LRUEntryRelease( void *priv, void *v )
+{
+    VLC_UNUSED(priv);
+    EntryRelease( v );
+}
+
+vlc_ftatlas_t * vlc_ftatlas_Hold( void )
+{
+    vlc_mutex_lock( &atlas_lock );
+    vlc_ftatlas_t *atlas = atlas_instance;
+    if( atlas )
+        atlas->refs++;
+    else
+    {
+        atlas = malloc( sizeof(*atlas) );
+        if( atlas )
+        {
+            atlas->glyphs_lrucache = vlc_lru_New( FTATLAS_MAX_GLYPHS,
+                                                  LRUEntryRelease, NULL );
+            if( atlas->glyphs_lrucache )
+            {
+                vlc_mutex_init( &atlas->lock );
+                atlas->refs = 1;
+                atlas_instance = atlas;
+            }
+            else
+            {
+                free( atlas );
+                atlas = NULL;
+            }
+        }
+    }
+    vlc_mutex_unlock( &atlas_lock );
+    return atlas;
+}
+
+void vlc_ftatlas_Release( vlc_ftatlas_t *atlas )
+{
+    vlc_mutex_lock( &atlas_lock );
+    assert( atlas == atlas_instance && atlas->refs );
+    if( --atlas->refs == 0 )
+    {
+        vlc_lru_Release( atlas->glyphs_lrucache );
+        free( atlas );
+        atlas_instance = NULL;
+    }
+    vlc_mutex_unlock( &atlas_lock );
+}
+
+void vlc_ftatlas_Glyph_Init( vlc_ftatlas_glyph_t *g )
+{
+    g->entry = NULL;
+}
+
+void vlc_ftatlas_Glyph_Release( vlc_ftatlas_glyph_t *g )
+{
+    if( g->entry )
+    {
+        EntryRelease( g->entry );
+        g->entry = NULL;
+    }
+}
+
+static vlc_ftatlas_entry_t * Rasterize( FT_Glyph source, FT_Vector origin )
+{
+    FT_Glyph glyph = source;
+    if( FT_Glyph_To_Bitmap( &glyph, FT_RENDER_MODE_NORMAL, &origin, 0 ) )
+        return NULL;
+
+    /* Already bitmap glyphs are returned as is */
+    const FT_BitmapGlyph bitmap = (FT_BitmapGlyph) glyph;
+    const size_t size = (size_t) bitmap->bitmap.rows
+                      * (size_t) abs( bitmap->bitmap.pitch );
+
+    vlc_ftatlas_entry_t *entry = malloc( sizeof(*entry) + size );
+    if( entry )
+    {
+        vlc_atomic_rc_init( &entry->rc );
+        entry->left = bitmap->left;
+        entry->top = bitmap->top;
+        entry->bitmap = bitmap->bitmap;
+        entry->bitmap.buffer = entry->pixels;
+        if( size )
+            memcpy( entry->pixels, bitmap->bitmap.buffer, size );
+    }
+
+    if( glyph != source )
+        FT_Done_Glyph( glyph );
+    return entry;
+}
+
+int vlc_ftatlas_Render( vlc_ftatlas_t *atlas, const vlc_ftatlas_key_t *key,
+                        FT_Glyph source, const FT_Vector *pen,
+                        vlc_ftatlas_glyph_t *g )
+{
+    /* Snap the pen so that a glyph has at most 16 bitmaps per size */
+    const FT_Vector snapped = {
+        .x = ( pen->x + 8 ) & ~(FT_Pos) 15,
+        .y = ( pen->y + 8 ) & ~(FT_Pos) 15,
+    };
+    const FT_Vector phase = { .x = snapped.x & 63, .y = snapped.y & 63 };
+
+    /* Fonts from attachments or font streams are private to a renderer */
+    const bool b_shared = key->faceid->psz_filename[0] != ':';
+    vlc_ftatlas_entry_t *entry = NULL;
+    char *psz_key = NULL;
+
+    if( b_shared )
+    {
+        if( asprintf( &psz_key, "%s#%u#%u#%d,%d#%x#%d#%ld,%ld",
+                      key->faceid->psz_filename, key->faceid->idx, key->index,
+                      key->metrics.width_px, key->metrics.height_px,
+                      key->synthesis, key->outline_radius,
+                      (long) phase.x, (long) phase.y ) < 0 )
+            return VLC_ENOMEM;
+
+        vlc_mutex_lock( &atlas->lock );
+        entry = vlc_lru_Get( atlas->glyphs_lrucache, psz_key );
+        if( entry )
+            vlc_atomic_rc_inc( &entry->rc );
+        vlc_mutex_unlock( &atlas->lock );
+    }
+
+    if( !entry )
+    {
+        /* Rasterize without the lock, other renderers keep drawing */
+        entry = Rasterize( source, phase );
+        if( !entry )
+        {
+            free( psz_key );
+            return VLC_EGENERIC;
+        }
+
+        if( b_shared )
+        {
+            vlc_mutex_lock( &atlas->lock );
+            vlc_ftatlas_entry_t *other = vlc_lru_Get( atlas->glyphs_lrucache,
+                                                      psz_key );
+            if( other )
+            {
+                /* Another renderer was faster */
+                vlc_atomic_rc_inc( &other->rc );
+                EntryRelease( entry );
+                entry = other;
+            }
+            else
+            {
+                vlc_atomic_rc_inc( &entry->rc );
+                vlc_lru_Insert( atlas->glyphs_lrucache, psz_key, entry );
+            }
+            vlc_mutex_unlock( &atlas->lock );
+        }
+    }
+    free( psz_key );
+
+    g->entry = entry;
+    g->bitmap.root = (FT_GlyphRec) {
+        .format = FT_GLYPH_FORMAT_BITMAP,
+        .advance = source->advance,
+    };
+    g->bitmap.left = entry->left + ( snapped.x >> 6 );
+    g->bitmap.top = entry->top + ( snapped.y >> 6 );
+    g->bitmap.bitmap = entry->bitmap;
+    return VLC_SUCCESS;
+}
@@ -0,0 +1,73 @@
+/*****************************************************************************
+ * atlas.h : Process-wide glyph bitmap cache for freetype2
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef FTATLAS_H
+#define FTATLAS_H
+
+#include FT_GLYPH_H
+
+#include "ftcache.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The atlas is shared by all the renderer instances of the process, so that
+ * the same glyph is only rasterized once whatever the number of videos
+ * showing text. Pens are snapped to a quarter of pixel. */
+typedef struct vlc_ftatlas_t vlc_ftatlas_t;
+typedef struct vlc_ftatlas_entry_t vlc_ftatlas_entry_t;
+
+vlc_ftatlas_t * vlc_ftatlas_Hold( void );
+void vlc_ftatlas_Release( vlc_ftatlas_t * );
+
+#define VLC_FTATLAS_EMBOLDEN 0x1
+#define VLC_FTATLAS_OBLIQUE  0x2
+
+typedef struct
+{
+    const vlc_face_id_t *faceid;
+    FT_UInt index;
+    vlc_ftcache_metrics_t metrics;
+    unsigned synthesis;  /* VLC_FTATLAS_* styles applied to the outline */
+    int outline_radius;  /* stroker radius, 0 for the glyph itself */
+} vlc_ftatlas_key_t;
+
+/* Bitmap glyph sharing the pixels of an atlas entry. The bitmap is only
+ * positioned for its user and must not be passed to FT_Done_Glyph. */
+typedef struct
+{
+    FT_BitmapGlyphRec bitmap;
+    vlc_ftatlas_entry_t *entry;
+} vlc_ftatlas_glyph_t;
+
+void vlc_ftatlas_Glyph_Init( vlc_ftatlas_glyph_t * );
+void vlc_ftatlas_Glyph_Release( vlc_ftatlas_glyph_t * );
+
+/* Returns the bitmap of the source glyph drawn at the pen position,
+ * rasterizing it if no other renderer did already */
+int vlc_ftatlas_Render( vlc_ftatlas_t *, const vlc_ftatlas_key_t *,
+                        FT_Glyph source, const FT_Vector *pen,
+                        vlc_ftatlas_glyph_t * );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
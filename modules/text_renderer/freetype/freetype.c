@@ -1204,6 +1204,10 @@ static int Create( filter_t *p_filter )
     if( !p_sys->ftcache )
         goto error;
 
+    p_sys->atlas = vlc_ftatlas_Hold();
+    if( !p_sys->atlas )
+        goto error;
+
     p_sys->i_scale = 100;
 
     /* default style to apply to incomplete segments styles */
@@ -1270,6 +1274,9 @@ static void Destroy( filter_t *p_filter )
         DumpFamilies( p_sys->fs );
 #endif
 
+    if( p_sys->atlas )
+        vlc_ftatlas_Release( p_sys->atlas );
+
     if( p_sys->ftcache )
         vlc_ftcache_Delete( p_sys->ftcache );
 
@@ -120,6 +120,9 @@ typedef struct glyph_bitmaps_t
     vlc_ftcache_glyph_t cglyph;
     vlc_ftcache_custom_glyph_t coutline;
     FT_Glyph p_shadow;
+    FT_UInt  i_glyph_index;
+    unsigned i_synthesis;      /* VLC_FTATLAS_* styles applied to cglyph */
+    int      i_outline_radius;
     FT_BBox  glyph_bbox;
     FT_BBox  outline_bbox;
     FT_BBox  shadow_bbox;
@@ -164,11 +167,9 @@ static void FreeLine( line_desc_t *p_line )
     for( int i = 0; i < p_line->i_character_count; i++ )
     {
         line_character_t *ch = &p_line->p_character[i];
-        FT_Done_Glyph( (FT_Glyph)ch->p_glyph );
-        if( ch->p_outline )
-            FT_Done_Glyph( (FT_Glyph)ch->p_outline );
-        if( ch->p_shadow && ch->p_shadow != ch->p_glyph )
-            FT_Done_Glyph( (FT_Glyph)ch->p_shadow );
+        vlc_ftatlas_Glyph_Release( &ch->glyph );
+        vlc_ftatlas_Glyph_Release( &ch->outline );
+        vlc_ftatlas_Glyph_Release( &ch->shadow );
     }
 
 //    if( p_line->p_ruby )
@@ -265,6 +266,15 @@ static int RubyBaseAdvance( const line_desc_t *p_line, int i_start, int *pi_coun
     return i_total;
 }
 
+/* Same as FT_Glyph_Get_CBox( FT_GLYPH_BBOX_PIXELS ) for bitmap glyphs */
+static void GetBitmapBBox( const FT_BitmapGlyph glyph, FT_BBox *p_bbox )
+{
+    p_bbox->xMin = glyph->left;
+    p_bbox->xMax = glyph->left + (FT_Pos) glyph->bitmap.width;
+    p_bbox->yMax = glyph->top;
+    p_bbox->yMin = glyph->top - (FT_Pos) glyph->bitmap.rows;
+}
+
 static void FixGlyph( FT_Glyph glyph, FT_BBox *p_bbox,
                       FT_Pos i_x_advance, FT_Pos i_y_advance,
                       const FT_Vector *p_pen )
@@ -967,6 +977,7 @@ static void ReleaseGlyphBitMaps(filter_t *p_filter, glyph_bitmaps_t *p_bitmaps)
         p_bitmaps->p_shadow != p_bitmaps->cglyph.p_glyph &&
         p_bitmaps->p_shadow != p_bitmaps->coutline.p_glyph )
         FT_Done_Glyph( p_bitmaps->p_shadow );
+    p_bitmaps->p_shadow = NULL;
     vlc_ftcache_Custom_Glyph_Release( &p_bitmaps->coutline );
     vlc_ftcache_Glyph_Release( p_sys->ftcache, &p_bitmaps->cglyph );
 }
@@ -1104,6 +1115,9 @@ static int LoadGlyphs( filter_t *p_filter, paragraph_t *p_paragraph,
                                    !( style_flags & FT_STYLE_FLAG_BOLD );
             const bool b_oblique = ( p_style->i_style_flags & STYLE_ITALIC ) &&
                                    !( style_flags & FT_STYLE_FLAG_ITALIC );
+            p_bitmaps->i_glyph_index = i_glyph_index;
+            p_bitmaps->i_synthesis = 0;
+            p_bitmaps->i_outline_radius = 0;
             /* Apply missing style by modifying the outline */
             if( (b_embolden || b_oblique) &&
                 p_bitmaps->cglyph.p_glyph->format == FT_GLYPH_FORMAT_OUTLINE )
@@ -1117,9 +1131,13 @@ static int LoadGlyphs( filter_t *p_filter, paragraph_t *p_paragraph,
                         FT_Matrix matrix = { .xx = 0x10000L, .xy = 0.12 * 0x10000L,
                                              .yy = 0x10000L, .yx = 0 };
                         FT_Glyph_Transform( transformed, &matrix, 0 );
+                        p_bitmaps->i_synthesis |= VLC_FTATLAS_OBLIQUE;
                     }
                     if( b_embolden )
+                    {
                         FT_Outline_Embolden( &((FT_OutlineGlyph)transformed)->outline, 1<<6 );
+                        p_bitmaps->i_synthesis |= VLC_FTATLAS_EMBOLDEN;
+                    }
                     vlc_ftcache_Glyph_Release( p_sys->ftcache, &p_bitmaps->cglyph );
                     p_bitmaps->cglyph.p_glyph = transformed;
                 }
@@ -1134,6 +1152,7 @@ static int LoadGlyphs( filter_t *p_filter, paragraph_t *p_paragraph,
                                                   p_bitmaps->cglyph.p_glyph,
                                                   CreateOutlinedGlyph, p_filter,
                                                   &p_bitmaps->coutline.ref );
+                p_bitmaps->i_outline_radius = i_stroker_radius;
             }
 
             if( p_style->i_shadow_alpha != STYLE_ALPHA_TRANSPARENT )
@@ -1245,57 +1264,64 @@ static int LayoutLine( filter_t *p_filter,
             .y = pen_new.y + p_sys->f_shadow_vector_y * ( metrics.height_px << 6 )
         };
 
-        /* Shadow being a reference to main glyph, it must be processed first */
-        if( p_bitmaps->p_shadow &&
-            FT_Glyph_To_Bitmap( &p_bitmaps->p_shadow, FT_RENDER_MODE_NORMAL,
-                                &pen_shadow, 0 ) )
-        {
-            p_bitmaps->p_shadow = 0;
-        }
+        /* The bitmaps come from the atlas shared by all the renderers */
+        const vlc_ftatlas_key_t glyph_key = {
+            .faceid = p_run->p_faceid,
+            .index = p_bitmaps->i_glyph_index,
+            .metrics = metrics,
+            .synthesis = p_bitmaps->i_synthesis,
+        };
+        vlc_ftatlas_key_t outline_key = glyph_key;
+        outline_key.outline_radius = p_bitmaps->i_outline_radius;
+
+        vlc_ftatlas_Glyph_Init( &p_ch->glyph );
+        vlc_ftatlas_Glyph_Init( &p_ch->outline );
+        vlc_ftatlas_Glyph_Init( &p_ch->shadow );
 
-        /* Ensure we don't release reference */
-        FT_Glyph bitmapglyph = p_bitmaps->cglyph.p_glyph;
-        if( FT_Glyph_To_Bitmap( &bitmapglyph,
-                                FT_RENDER_MODE_NORMAL,
-                                &pen_new, 0 ) )
+        if( vlc_ftatlas_Render( p_sys->atlas, &glyph_key,
+                                p_bitmaps->cglyph.p_glyph, &pen_new,
+                                &p_ch->glyph ) )
         {
             ReleaseGlyphBitMaps( p_filter, p_bitmaps );
             continue;
         }
+        p_ch->p_glyph = &p_ch->glyph.bitmap;
+        p_ch->p_outline = NULL;
+        p_ch->p_shadow = NULL;
 
-        /* release the source glyph or reference */
-        vlc_ftcache_Glyph_Release( p_sys->ftcache, &p_bitmaps->cglyph );
-        p_bitmaps->cglyph.p_glyph = bitmapglyph;
-
-        if( p_bitmaps->coutline.p_glyph )
-        {
-            bitmapglyph = p_bitmaps->coutline.p_glyph;
-            if( FT_Glyph_To_Bitmap( &bitmapglyph,
-                                    FT_RENDER_MODE_NORMAL,
-                                    &pen_new, 0 ) )
-                bitmapglyph = NULL;
-            vlc_ftcache_Custom_Glyph_Release( &p_bitmaps->coutline );
-            p_bitmaps->coutline.p_glyph = bitmapglyph;
-        }
+        if( p_bitmaps->coutline.p_glyph &&
+            !vlc_ftatlas_Render( p_sys->atlas, &outline_key,
+                                 p_bitmaps->coutline.p_glyph, &pen_new,
+                                 &p_ch->outline ) )
+            p_ch->p_outline = &p_ch->outline.bitmap;
 
-        FT_Glyph_Get_CBox( p_bitmaps->cglyph.p_glyph, FT_GLYPH_BBOX_PIXELS,
-                           &p_bitmaps->glyph_bbox );
-        FixGlyph( p_bitmaps->cglyph.p_glyph, &p_bitmaps->glyph_bbox,
+        /* The shadow is a reference to the outline or the main glyph */
+        if( p_bitmaps->p_shadow &&
+            !vlc_ftatlas_Render( p_sys->atlas,
+                                 p_bitmaps->p_shadow == p_bitmaps->coutline.p_glyph
+                                 ? &outline_key : &glyph_key,
+                                 p_bitmaps->p_shadow, &pen_shadow,
+                                 &p_ch->shadow ) )
+            p_ch->p_shadow = &p_ch->shadow.bitmap;
+
+        /* release the source glyphs or references */
+        ReleaseGlyphBitMaps( p_filter, p_bitmaps );
+
+        GetBitmapBBox( p_ch->p_glyph, &p_bitmaps->glyph_bbox );
+        FixGlyph( (FT_Glyph) p_ch->p_glyph, &p_bitmaps->glyph_bbox,
                   p_bitmaps->i_x_advance, p_bitmaps->i_y_advance,
                   &pen_new );
-        if( p_bitmaps->coutline.p_glyph )
+        if( p_ch->p_outline )
         {
-            FT_Glyph_Get_CBox( p_bitmaps->coutline.p_glyph, FT_GLYPH_BBOX_PIXELS,
-                               &p_bitmaps->outline_bbox );
-            FixGlyph( p_bitmaps->coutline.p_glyph, &p_bitmaps->outline_bbox,
+            GetBitmapBBox( p_ch->p_outline, &p_bitmaps->outline_bbox );
+            FixGlyph( (FT_Glyph) p_ch->p_outline, &p_bitmaps->outline_bbox,
                       p_bitmaps->i_x_advance, p_bitmaps->i_y_advance,
                       &pen_new );
         }
-        if( p_bitmaps->p_shadow )
+        if( p_ch->p_shadow )
         {
-            FT_Glyph_Get_CBox( p_bitmaps->p_shadow, FT_GLYPH_BBOX_PIXELS,
-                               &p_bitmaps->shadow_bbox );
-            FixGlyph( p_bitmaps->p_shadow, &p_bitmaps->shadow_bbox,
+            GetBitmapBBox( p_ch->p_shadow, &p_bitmaps->shadow_bbox );
+            FixGlyph( (FT_Glyph) p_ch->p_shadow, &p_bitmaps->shadow_bbox,
                       p_bitmaps->i_x_advance, p_bitmaps->i_y_advance,
                       &pen_shadow );
         }
@@ -1342,18 +1368,14 @@ static int LayoutLine( filter_t *p_filter,
             }
         }
 
-        p_ch->p_glyph = ( FT_BitmapGlyph ) p_bitmaps->cglyph.p_glyph;
-        p_ch->p_outline = ( FT_BitmapGlyph ) p_bitmaps->coutline.p_glyph;
-        p_ch->p_shadow = ( FT_BitmapGlyph ) p_bitmaps->p_shadow;
-
         p_ch->i_line_thickness = i_line_thickness;
         p_ch->i_line_offset = i_line_offset;
 
         /* Compute bounding box for all glyphs */
         p_ch->bbox = p_bitmaps->glyph_bbox;
-        if( p_bitmaps->coutline.p_glyph )
+        if( p_ch->p_outline )
             BBoxEnlarge( &p_ch->bbox, &p_bitmaps->outline_bbox );
-        if( p_bitmaps->p_shadow )
+        if( p_ch->p_shadow )
             BBoxEnlarge( &p_ch->bbox, &p_bitmaps->shadow_bbox );
 
         BBoxEnlarge( &p_line->bbox, &p_ch->bbox );
@@ -40,6 +40,9 @@ typedef struct
     FT_BitmapGlyph p_glyph;
     FT_BitmapGlyph p_outline;
     FT_BitmapGlyph p_shadow;
+    vlc_ftatlas_glyph_t glyph;          /* storage of the above bitmaps */
+    vlc_ftatlas_glyph_t outline;
+    vlc_ftatlas_glyph_t shadow;
     FT_BBox        bbox;
     const text_style_t *p_style;
     const ruby_block_t *p_ruby;
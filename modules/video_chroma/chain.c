@@ -301,10 +301,98 @@ static int AppendChromaChain( filter_t *p_filter, const vlc_fourcc_t *chromas,
     return VLC_SUCCESS;
 }
 
-static int BuildChromaChain( filter_t *p_filter )
+/* Last chroma chains that could be opened, per conversion. They are tried
+ * first next time instead of going through all the probed candidates. */
+#define CHROMA_CACHE_SIZE 16
+
+static struct
+{
+    vlc_mutex_t lock;
+    struct vlc_chroma_conv_result entries[CHROMA_CACHE_SIZE];
+    size_t count;
+    size_t next; /* entry replaced when full */
+} chroma_cache = { .lock = VLC_STATIC_MUTEX };
+
+static bool ChromaCacheFind( vlc_fourcc_t in, vlc_fourcc_t out,
+                             struct vlc_chroma_conv_result *res )
+{
+    bool found = false;
+
+    vlc_mutex_lock( &chroma_cache.lock );
+    for( size_t i = 0; i < chroma_cache.count; ++i )
+    {
+        const struct vlc_chroma_conv_result *entry = &chroma_cache.entries[i];
+        if( entry->chain[0] == in && entry->chain[entry->chain_count - 1] == out )
+        {
+            *res = *entry;
+            found = true;
+            break;
+        }
+    }
+    vlc_mutex_unlock( &chroma_cache.lock );
+    return found;
+}
+
+static void ChromaCacheStore( const struct vlc_chroma_conv_result *res )
+{
+    const vlc_fourcc_t in = res->chain[0];
+    const vlc_fourcc_t out = res->chain[res->chain_count - 1];
+
+    vlc_mutex_lock( &chroma_cache.lock );
+    size_t i;
+    for( i = 0; i < chroma_cache.count; ++i )
+    {
+        const struct vlc_chroma_conv_result *entry = &chroma_cache.entries[i];
+        if( entry->chain[0] == in && entry->chain[entry->chain_count - 1] == out )
+            break;
+    }
+    if( i == chroma_cache.count )
+    {
+        if( chroma_cache.count < CHROMA_CACHE_SIZE )
+            chroma_cache.count++;
+        else
+        {
+            i = chroma_cache.next;
+            chroma_cache.next = (chroma_cache.next + 1) % CHROMA_CACHE_SIZE;
+        }
+    }
+    chroma_cache.entries[i] = *res;
+    vlc_mutex_unlock( &chroma_cache.lock );
+}
+
+static int TryChromaChain( filter_t *p_filter,
+                           const struct vlc_chroma_conv_result *res )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
+
+    filter_chain_Reset( p_sys->p_chain, &p_filter->fmt_in, p_filter->vctx_in,
+                        &p_filter->fmt_out );
+
+    int i_ret = AppendChromaChain( p_filter, &res->chain[1], res->chain_count - 1);
+    if( i_ret == VLC_SUCCESS )
+        p_filter->vctx_out = filter_chain_GetVideoCtxOut( p_sys->p_chain );
+    return i_ret;
+}
+
+static int BuildChromaChain( filter_t *p_filter )
+{
     int i_ret = VLC_EGENERIC;
+    const vlc_fourcc_t in = p_filter->fmt_in.video.i_chroma;
+    const vlc_fourcc_t out = p_filter->fmt_out.video.i_chroma;
+
+    struct vlc_chroma_conv_result cached;
+    bool has_cached = ChromaCacheFind( in, out, &cached );
+    if( has_cached )
+    {
+        char *res_str = vlc_chroma_conv_result_ToString( &cached );
+        if( res_str != NULL )
+        {
+            msg_Dbg( p_filter, "Trying to use cached chroma_chain: %s...", res_str);
+            free(res_str);
+        }
+        if( TryChromaChain( p_filter, &cached ) == VLC_SUCCESS )
+            return VLC_SUCCESS;
+    }
 
     size_t res_count;
     struct vlc_chroma_conv_result *results =
@@ -320,6 +408,12 @@ static int BuildChromaChain( filter_t *p_filter )
     for( size_t i = 0; i < res_count; ++i )
     {
         const struct vlc_chroma_conv_result *res = &results[i];
+        /* already tried */
+        if( has_cached && res->chain_count == cached.chain_count &&
+            memcmp( res->chain, cached.chain,
+                    res->chain_count * sizeof(*res->chain) ) == 0 )
+            continue;
+
         char *res_str = vlc_chroma_conv_result_ToString( res );
         if( res_str == NULL )
         {
@@ -329,13 +423,10 @@ static int BuildChromaChain( filter_t *p_filter )
         msg_Info( p_filter, "Trying to use chroma_chain: %s...", res_str);
         free(res_str);
 
-        filter_chain_Reset( p_sys->p_chain, &p_filter->fmt_in, p_filter->vctx_in,
-                            &p_filter->fmt_out );
-
-        i_ret = AppendChromaChain( p_filter, &res->chain[1], res->chain_count - 1);
+        i_ret = TryChromaChain( p_filter, res );
         if( i_ret == VLC_SUCCESS )
         {
-            p_filter->vctx_out = filter_chain_GetVideoCtxOut( p_sys->p_chain );
+            ChromaCacheStore( res );
             msg_Info( p_filter, "success");
             break;
         }
@@ -34,6 +34,11 @@
 #include <vlc_cpu.h>
 #include <assert.h>
 
+#if defined (__aarch64__) && defined (__ARM_NEON) && !defined (COPY_TEST_NOOPTIM)
+# include <arm_neon.h>
+# define COPY_NEON
+#endif
+
 #include "copy.h"
 static void CopyPlane(uint8_t *dst, size_t dst_pitch,
                       const uint8_t *src, size_t src_pitch,
@@ -130,8 +135,262 @@ void CopyCleanCache(copy_cache_t *cache)
 # define vlc_CPU_SSSE3() (0)
 # undef vlc_CPU_SSE2
 # define vlc_CPU_SSE2() (0)
+# undef vlc_CPU_AVX2
+# define vlc_CPU_AVX2() (0)
 #endif
 
+#ifdef CAN_COMPILE_AVX2
+/* AVX2 versions of the USWC copy and of the cache to destination stages.
+ * Rows in our cache are only 16 bytes aligned, hence the unaligned loads. */
+
+#define COPY32_AVX2_SHIFTR(x) \
+    "vpsrlw "x", %%ymm1, %%ymm1\n"
+#define COPY32_AVX2_SHIFTL(x) \
+    "vpsllw "x", %%ymm1, %%ymm1\n"
+
+#define COPY32_AVX2_S(dstp, srcp, load, store, shiftstr) \
+    asm volatile (                      \
+        load "  0(%[src]), %%ymm1\n"    \
+        shiftstr                        \
+        store " %%ymm1,    0(%[dst])\n" \
+        : : [dst]"r"(dstp), [src]"r"(srcp) : "memory", "ymm1")
+
+#define COPY128_AVX2_SHIFTR(x) \
+    "vpsrlw "x", %%ymm1, %%ymm1\n" \
+    "vpsrlw "x", %%ymm2, %%ymm2\n" \
+    "vpsrlw "x", %%ymm3, %%ymm3\n" \
+    "vpsrlw "x", %%ymm4, %%ymm4\n"
+#define COPY128_AVX2_SHIFTL(x) \
+    "vpsllw "x", %%ymm1, %%ymm1\n" \
+    "vpsllw "x", %%ymm2, %%ymm2\n" \
+    "vpsllw "x", %%ymm3, %%ymm3\n" \
+    "vpsllw "x", %%ymm4, %%ymm4\n"
+
+#define COPY128_AVX2_S(dstp, srcp, load, store, shiftstr) \
+    asm volatile (                      \
+        load "   0(%[src]), %%ymm1\n"   \
+        load "  32(%[src]), %%ymm2\n"   \
+        load "  64(%[src]), %%ymm3\n"   \
+        load "  96(%[src]), %%ymm4\n"   \
+        shiftstr                        \
+        store " %%ymm1,    0(%[dst])\n" \
+        store " %%ymm2,   32(%[dst])\n" \
+        store " %%ymm3,   64(%[dst])\n" \
+        store " %%ymm4,   96(%[dst])\n" \
+        : : [dst]"r"(dstp), [src]"r"(srcp) \
+        : "memory", "ymm1", "ymm2", "ymm3", "ymm4")
+
+#define COPY64_AVX2(dstp, srcp, store) \
+    asm volatile (                      \
+        "vmovdqu  0(%[src]), %%ymm1\n"  \
+        "vmovdqu 32(%[src]), %%ymm2\n"  \
+        store " %%ymm1,  0(%[dst])\n"   \
+        store " %%ymm2, 32(%[dst])\n"   \
+        : : [dst]"r"(dstp), [src]"r"(srcp) : "memory", "ymm1", "ymm2")
+
+VLC_AVX
+static void AVX2_CopyFromUswc(uint8_t *dst, size_t dst_pitch,
+                              const uint8_t *src, size_t src_pitch,
+                              unsigned width, unsigned height, int bitshift)
+{
+    asm volatile ("mfence");
+
+#define AVX2_USWC_COPY(shiftstr32, shiftstr128) \
+    for (unsigned y = 0; y < height; y++) { \
+        const unsigned unaligned = (-(uintptr_t)src) & 0x1f; \
+        unsigned x = 0; \
+        if (!unaligned) { \
+            for (; x+127 < width; x += 128) \
+                COPY128_AVX2_S(&dst[x], &src[x], "vmovntdqa", "vmovdqu", shiftstr128); \
+        } else if (width >= 32) { \
+            COPY32_AVX2_S(dst, src, "vmovdqu", "vmovdqu", shiftstr32); \
+            for (x = unaligned; x+127 < width; x += 128) \
+                COPY128_AVX2_S(&dst[x], &src[x], "vmovntdqa", "vmovdqu", shiftstr128); \
+        } \
+        if (x < width) \
+            CopyPlane(&dst[x], dst_pitch - x, &src[x], src_pitch - x, 1, bitshift); \
+        src += src_pitch; \
+        dst += dst_pitch; \
+    }
+
+    switch (bitshift)
+    {
+        case 0:
+            AVX2_USWC_COPY("", "")
+            break;
+        case -6:
+            AVX2_USWC_COPY(COPY32_AVX2_SHIFTL("$6"), COPY128_AVX2_SHIFTL("$6"))
+            break;
+        case 6:
+            AVX2_USWC_COPY(COPY32_AVX2_SHIFTR("$6"), COPY128_AVX2_SHIFTR("$6"))
+            break;
+        case 2:
+            AVX2_USWC_COPY(COPY32_AVX2_SHIFTR("$2"), COPY128_AVX2_SHIFTR("$2"))
+            break;
+        case -2:
+            AVX2_USWC_COPY(COPY32_AVX2_SHIFTL("$2"), COPY128_AVX2_SHIFTL("$2"))
+            break;
+        case 4:
+            AVX2_USWC_COPY(COPY32_AVX2_SHIFTR("$4"), COPY128_AVX2_SHIFTR("$4"))
+            break;
+        case -4:
+            AVX2_USWC_COPY(COPY32_AVX2_SHIFTL("$4"), COPY128_AVX2_SHIFTL("$4"))
+            break;
+        default:
+            vlc_assert_unreachable();
+    }
+#undef AVX2_USWC_COPY
+
+    asm volatile ("mfence\n"
+                  "vzeroupper");
+}
+
+VLC_AVX
+static void AVX2_Copy2d(uint8_t *dst, size_t dst_pitch,
+                        const uint8_t *src, size_t src_pitch,
+                        unsigned width, unsigned height)
+{
+    for (unsigned y = 0; y < height; y++) {
+        unsigned x = 0;
+
+        bool unaligned = ((intptr_t)dst & 0x1f) != 0;
+        if (!unaligned) {
+            for (; x+63 < width; x += 64)
+                COPY64_AVX2(&dst[x], &src[x], "vmovntdq");
+        } else {
+            for (; x+63 < width; x += 64)
+                COPY64_AVX2(&dst[x], &src[x], "vmovdqu");
+        }
+
+        for (; x < width; x++)
+            dst[x] = src[x];
+
+        src += src_pitch;
+        dst += dst_pitch;
+    }
+    asm volatile ("sfence\n"
+                  "vzeroupper");
+}
+
+VLC_AVX
+static void
+AVX2_InterleaveUV(uint8_t *dst, size_t dst_pitch,
+                  uint8_t *srcu, size_t srcu_pitch,
+                  uint8_t *srcv, size_t srcv_pitch,
+                  unsigned int width, unsigned int height, uint8_t pixel_size)
+{
+    assert(pixel_size == 1 || pixel_size == 2);
+
+    for (unsigned int y = 0; y < height; ++y)
+    {
+        unsigned int    x;
+
+        /* Interleave within each 128-bits lane, then put the lanes back in
+         * order */
+#define INTERLEAVE64(unpackl, unpackh)                  \
+    asm volatile (                                      \
+        "vmovdqu (%[src1]), %%ymm0\n"                   \
+        "vmovdqu (%[src2]), %%ymm1\n"                   \
+        unpackl " %%ymm1, %%ymm0, %%ymm2\n"             \
+        unpackh " %%ymm1, %%ymm0, %%ymm3\n"             \
+        "vperm2i128 $0x20, %%ymm3, %%ymm2, %%ymm0\n"    \
+        "vperm2i128 $0x31, %%ymm3, %%ymm2, %%ymm1\n"    \
+        "vmovdqu %%ymm0,  0(%[dst])\n"                  \
+        "vmovdqu %%ymm1, 32(%[dst])\n"                  \
+        : : [dst]"r"(dst+2*x),                          \
+            [src1]"r"(srcu+x), [src2]"r"(srcv+x)        \
+        : "memory", "ymm0", "ymm1", "ymm2", "ymm3")
+
+        if (pixel_size == 1)
+        {
+            for (x = 0; x < (width & ~31); x += 32)
+                INTERLEAVE64("vpunpcklbw", "vpunpckhbw");
+            for (; x < width; x++) {
+                dst[2*x+0] = srcu[x];
+                dst[2*x+1] = srcv[x];
+            }
+        }
+        else
+        {
+            for (x = 0; x < (width & ~31); x += 32)
+                INTERLEAVE64("vpunpcklwd", "vpunpckhwd");
+            for (; x < width; x+= 2) {
+                dst[2*x+0] = srcu[x];
+                dst[2*x+1] = srcu[x + 1];
+                dst[2*x+2] = srcv[x];
+                dst[2*x+3] = srcv[x + 1];
+            }
+        }
+#undef INTERLEAVE64
+        srcu += srcu_pitch;
+        srcv += srcv_pitch;
+        dst += dst_pitch;
+    }
+    asm volatile ("vzeroupper");
+}
+
+VLC_AVX
+static void AVX2_SplitUV(uint8_t *dstu, size_t dstu_pitch,
+                         uint8_t *dstv, size_t dstv_pitch,
+                         const uint8_t *src, size_t src_pitch,
+                         unsigned width, unsigned height, uint8_t pixel_size)
+{
+    assert(pixel_size == 1 || pixel_size == 2);
+
+    /* Same shuffles as SSE_SplitUV, once per 128-bits lane */
+    static const uint8_t shuffle_8[] = { 0, 2, 4, 6, 8, 10, 12, 14,
+                                         1, 3, 5, 7, 9, 11, 13, 15,
+                                         0, 2, 4, 6, 8, 10, 12, 14,
+                                         1, 3, 5, 7, 9, 11, 13, 15 };
+    static const uint8_t shuffle_16[] = {  0,  1,  4,  5,  8,  9, 12, 13,
+                                           2,  3,  6,  7, 10, 11, 14, 15,
+                                           0,  1,  4,  5,  8,  9, 12, 13,
+                                           2,  3,  6,  7, 10, 11, 14, 15 };
+    const uint8_t *shuffle = pixel_size == 1 ? shuffle_8 : shuffle_16;
+
+    for (unsigned y = 0; y < height; y++) {
+        unsigned x = 0;
+        for (; x < (width & ~31); x += 32) {
+            asm volatile (
+                "vmovdqu (%[shuffle]), %%ymm7\n"
+                "vmovdqu  0(%[src]), %%ymm0\n"
+                "vmovdqu 32(%[src]), %%ymm1\n"
+                "vpshufb %%ymm7, %%ymm0, %%ymm0\n"
+                "vpshufb %%ymm7, %%ymm1, %%ymm1\n"
+                /* [U0 V0 U1 V1] -> [U0 U1 V0 V1] (64-bits units) */
+                "vpermq $0xd8, %%ymm0, %%ymm0\n"
+                "vpermq $0xd8, %%ymm1, %%ymm1\n"
+                "vperm2i128 $0x20, %%ymm1, %%ymm0, %%ymm2\n"
+                "vperm2i128 $0x31, %%ymm1, %%ymm0, %%ymm3\n"
+                "vmovdqu %%ymm2, (%[dst1])\n"
+                "vmovdqu %%ymm3, (%[dst2])\n"
+                : : [dst1]"r"(&dstu[x]), [dst2]"r"(&dstv[x]), [src]"r"(&src[2*x]), [shuffle]"r"(shuffle) : "memory", "ymm0", "ymm1", "ymm2", "ymm3", "ymm7");
+        }
+        if (pixel_size == 1)
+        {
+            for (; x < width; x++) {
+                dstu[x] = src[2*x+0];
+                dstv[x] = src[2*x+1];
+            }
+        }
+        else
+        {
+            for (; x < width; x+= 2) {
+                dstu[x] = src[2*x+0];
+                dstu[x+1] = src[2*x+1];
+                dstv[x] = src[2*x+2];
+                dstv[x+1] = src[2*x+3];
+            }
+        }
+        src  += src_pitch;
+        dstu += dstu_pitch;
+        dstv += dstv_pitch;
+    }
+    asm volatile ("vzeroupper");
+}
+#undef COPY64_AVX2
+#endif /* CAN_COMPILE_AVX2 */
+
 /* Optimized copy from "Uncacheable Speculative Write Combining" memory
  * as used by some video surface.
  * XXX It is really efficient only when SSE4.1 is available.
@@ -143,6 +402,12 @@ static void CopyFromUswc(uint8_t *dst, size_t dst_pitch,
 {
     assert(((intptr_t)dst & 0x0f) == 0 && (dst_pitch & 0x0f) == 0);
 
+#ifdef CAN_COMPILE_AVX2
+    if (vlc_CPU_AVX2())
+        return AVX2_CopyFromUswc(dst, dst_pitch, src, src_pitch,
+                                 width, height, bitshift);
+#endif
+
     asm volatile ("mfence");
 
 #define SSE_USWC_COPY(shiftstr16, shiftstr64) \
@@ -196,7 +461,7 @@ static void CopyFromUswc(uint8_t *dst, size_t dst_pitch,
             SSE_USWC_COPY(COPY16_SHIFTR("$4"), COPY64_SHIFTR("$4"))
             break;
         case -4:
-            SSE_USWC_COPY(COPY16_SHIFTL("$2"), COPY64_SHIFTL("$2"))
+            SSE_USWC_COPY(COPY16_SHIFTL("$4"), COPY64_SHIFTL("$4"))
             break;
         default:
             vlc_assert_unreachable();
@@ -483,7 +748,12 @@ static void SSE_CopyPlane(uint8_t *dst, size_t dst_pitch,
         CopyFromUswc(cache, w16, src, src_pitch, cache_width, hblock, bitshift);
 
         /* Copy from our cache to the destination */
-        Copy2d(dst, dst_pitch, cache, w16, copy_pitch, hblock);
+#ifdef CAN_COMPILE_AVX2
+        if (vlc_CPU_AVX2())
+            AVX2_Copy2d(dst, dst_pitch, cache, w16, copy_pitch, hblock);
+        else
+#endif
+            Copy2d(dst, dst_pitch, cache, w16, copy_pitch, hblock);
 
         /* */
         src += src_pitch * hblock;
@@ -516,9 +786,16 @@ SSE_InterleavePlanes(uint8_t *dst, size_t dst_pitch,
                      cachev_width, hblock, bitshift);
 
         /* Copy from our cache to the destination */
-        SSE_InterleaveUV(dst, dst_pitch, cache, w16,
-                         cache + w16 * hblock, w16,
-                         copy_pitch, hblock, pixel_size);
+#ifdef CAN_COMPILE_AVX2
+        if (vlc_CPU_AVX2())
+            AVX2_InterleaveUV(dst, dst_pitch, cache, w16,
+                              cache + w16 * hblock, w16,
+                              copy_pitch, hblock, pixel_size);
+        else
+#endif
+            SSE_InterleaveUV(dst, dst_pitch, cache, w16,
+                             cache + w16 * hblock, w16,
+                             copy_pitch, hblock, pixel_size);
 
         /* */
         srcu += hblock * srcu_pitch;
@@ -546,8 +823,14 @@ static void SSE_SplitPlanes(uint8_t *dstu, size_t dstu_pitch,
         CopyFromUswc(cache, w16, src, src_pitch, cache_width, hblock, bitshift);
 
         /* Copy from our cache to the destination */
-        SSE_SplitUV(dstu, dstu_pitch, dstv, dstv_pitch,
-                    cache, w16, copy_pitch, hblock, pixel_size);
+#ifdef CAN_COMPILE_AVX2
+        if (vlc_CPU_AVX2())
+            AVX2_SplitUV(dstu, dstu_pitch, dstv, dstv_pitch,
+                         cache, w16, copy_pitch, hblock, pixel_size);
+        else
+#endif
+            SSE_SplitUV(dstu, dstu_pitch, dstv, dstv_pitch,
+                        cache, w16, copy_pitch, hblock, pixel_size);
 
         /* */
         src  += src_pitch  * hblock;
@@ -736,6 +1019,84 @@ static void SplitPlanes16(uint8_t *dstu, size_t dstu_pitch,
         SPLIT_PLANES_SHIFTL(uint16_t, 4, (-bitshift) & 0xf);
 }
 
+#ifdef COPY_NEON
+static void NEON_SplitPlanes(uint8_t *dstu, size_t dstu_pitch,
+                             uint8_t *dstv, size_t dstv_pitch,
+                             const uint8_t *src, size_t src_pitch,
+                             unsigned height)
+{
+    size_t copy_pitch = __MIN(__MIN(src_pitch / 2, dstu_pitch), dstv_pitch);
+    for (unsigned y = 0; y < height; y++) {
+        size_t x = 0;
+        for (; x + 16 <= copy_pitch; x += 16) {
+            const uint8x16x2_t uv = vld2q_u8(&src[2*x]);
+            vst1q_u8(&dstu[x], uv.val[0]);
+            vst1q_u8(&dstv[x], uv.val[1]);
+        }
+        for (; x < copy_pitch; x++) {
+            dstu[x] = src[2*x+0];
+            dstv[x] = src[2*x+1];
+        }
+        src  += src_pitch;
+        dstu += dstu_pitch;
+        dstv += dstv_pitch;
+    }
+}
+
+static void NEON_SplitPlanes16(uint8_t *dstu, size_t dstu_pitch,
+                               uint8_t *dstv, size_t dstv_pitch,
+                               const uint8_t *src, size_t src_pitch,
+                               unsigned height, int bitshift)
+{
+    size_t copy_pitch = __MIN(__MIN(src_pitch / 4, dstu_pitch), dstv_pitch);
+    /* A negative count shifts right */
+    const int16x8_t shift = vdupq_n_s16(-bitshift);
+    for (unsigned y = 0; y < height; y++) {
+        const uint16_t *src16 = (const uint16_t *) src;
+        uint16_t *dstu16 = (uint16_t *) dstu, *dstv16 = (uint16_t *) dstv;
+        size_t x = 0;
+        for (; x + 8 <= copy_pitch; x += 8) {
+            const uint16x8x2_t uv = vld2q_u16(&src16[2*x]);
+            vst1q_u16(&dstu16[x], vshlq_u16(uv.val[0], shift));
+            vst1q_u16(&dstv16[x], vshlq_u16(uv.val[1], shift));
+        }
+        for (; x < copy_pitch; x++) {
+            if (bitshift >= 0) {
+                dstu16[x] = src16[2*x+0] >> bitshift;
+                dstv16[x] = src16[2*x+1] >> bitshift;
+            } else {
+                dstu16[x] = src16[2*x+0] << -bitshift;
+                dstv16[x] = src16[2*x+1] << -bitshift;
+            }
+        }
+        src  += src_pitch;
+        dstu += dstu_pitch;
+        dstv += dstv_pitch;
+    }
+}
+#endif
+
+#ifdef COPY_RVV
+void rvv_split_uv(uint8_t *, uint8_t *, const uint8_t *, size_t);
+void rvv_interleave_uv(uint8_t *, const uint8_t *, const uint8_t *, size_t);
+
+static void RVV_SplitPlanes(uint8_t *dstu, size_t dstu_pitch,
+                            uint8_t *dstv, size_t dstv_pitch,
+                            const uint8_t *src, size_t src_pitch,
+                            unsigned height)
+{
+    size_t copy_pitch = __MIN(__MIN(src_pitch / 2, dstu_pitch), dstv_pitch);
+    if (copy_pitch == 0)
+        return;
+    for (unsigned y = 0; y < height; y++) {
+        rvv_split_uv(dstu, dstv, src, copy_pitch);
+        src  += src_pitch;
+        dstu += dstu_pitch;
+        dstv += dstv_pitch;
+    }
+}
+#endif
+
 void Copy420_SP_to_P(picture_t *dst, const uint8_t *src[static 2],
                      const size_t src_pitch[static 2], unsigned height,
                      const copy_cache_t *cache)
@@ -750,6 +1111,18 @@ void Copy420_SP_to_P(picture_t *dst, const uint8_t *src[static 2],
 
     CopyPlane(dst->p[0].p_pixels, dst->p[0].i_pitch,
               src[0], src_pitch[0], height, 0);
+#ifdef COPY_NEON
+    if (vlc_CPU_ARM_NEON())
+        return NEON_SplitPlanes(dst->p[1].p_pixels, dst->p[1].i_pitch,
+                                dst->p[2].p_pixels, dst->p[2].i_pitch,
+                                src[1], src_pitch[1], (height+1)/2);
+#endif
+#ifdef COPY_RVV
+    if (vlc_CPU_RV_V())
+        return RVV_SplitPlanes(dst->p[1].p_pixels, dst->p[1].i_pitch,
+                               dst->p[2].p_pixels, dst->p[2].i_pitch,
+                               src[1], src_pitch[1], (height+1)/2);
+#endif
     SplitPlanes(dst->p[1].p_pixels, dst->p[1].i_pitch,
                 dst->p[2].p_pixels, dst->p[2].i_pitch,
                 src[1], src_pitch[1], (height+1)/2);
@@ -771,6 +1144,13 @@ void Copy420_16_SP_to_P(picture_t *dst, const uint8_t *src[static 2],
 
     CopyPlane(dst->p[0].p_pixels, dst->p[0].i_pitch,
               src[0], src_pitch[0], height, bitshift);
+#ifdef COPY_NEON
+    if (vlc_CPU_ARM_NEON())
+        return NEON_SplitPlanes16(dst->p[1].p_pixels, dst->p[1].i_pitch,
+                                  dst->p[2].p_pixels, dst->p[2].i_pitch,
+                                  src[1], src_pitch[1], (height+1)/2,
+                                  bitshift);
+#endif
     SplitPlanes16(dst->p[1].p_pixels, dst->p[1].i_pitch,
                   dst->p[2].p_pixels, dst->p[2].i_pitch,
                   src[1], src_pitch[1], (height+1)/2, bitshift);
@@ -812,6 +1192,81 @@ void Copy420_16_SP_to_P(picture_t *dst, const uint8_t *src[static 2],
     } \
 }while(0)
 
+#ifdef COPY_NEON
+static void NEON_InterleavePlanes(uint8_t *dst, size_t dst_pitch,
+                                  const uint8_t *srcu, size_t srcu_pitch,
+                                  const uint8_t *srcv, size_t srcv_pitch,
+                                  size_t copy_pitch, unsigned lines)
+{
+    for (unsigned y = 0; y < lines; y++) {
+        size_t x = 0;
+        for (; x + 16 <= copy_pitch; x += 16) {
+            const uint8x16x2_t uv = { { vld1q_u8(&srcu[x]), vld1q_u8(&srcv[x]) } };
+            vst2q_u8(&dst[2*x], uv);
+        }
+        for (; x < copy_pitch; x++) {
+            dst[2*x+0] = srcu[x];
+            dst[2*x+1] = srcv[x];
+        }
+        dst  += dst_pitch;
+        srcu += srcu_pitch;
+        srcv += srcv_pitch;
+    }
+}
+
+static void NEON_InterleavePlanes16(uint8_t *dst, size_t dst_pitch,
+                                    const uint8_t *srcu, size_t srcu_pitch,
+                                    const uint8_t *srcv, size_t srcv_pitch,
+                                    size_t copy_pitch, unsigned lines,
+                                    int bitshift)
+{
+    /* A negative count shifts right */
+    const int16x8_t shift = vdupq_n_s16(-bitshift);
+    for (unsigned y = 0; y < lines; y++) {
+        const uint16_t *srcu16 = (const uint16_t *) srcu;
+        const uint16_t *srcv16 = (const uint16_t *) srcv;
+        uint16_t *dst16 = (uint16_t *) dst;
+        size_t x = 0;
+        for (; x + 8 <= copy_pitch; x += 8) {
+            const uint16x8x2_t uv = { {
+                vshlq_u16(vld1q_u16(&srcu16[x]), shift),
+                vshlq_u16(vld1q_u16(&srcv16[x]), shift),
+            } };
+            vst2q_u16(&dst16[2*x], uv);
+        }
+        for (; x < copy_pitch; x++) {
+            if (bitshift >= 0) {
+                dst16[2*x+0] = srcu16[x] >> bitshift;
+                dst16[2*x+1] = srcv16[x] >> bitshift;
+            } else {
+                dst16[2*x+0] = srcu16[x] << -bitshift;
+                dst16[2*x+1] = srcv16[x] << -bitshift;
+            }
+        }
+        dst  += dst_pitch;
+        srcu += srcu_pitch;
+        srcv += srcv_pitch;
+    }
+}
+#endif
+
+#ifdef COPY_RVV
+static void RVV_InterleavePlanes(uint8_t *dst, size_t dst_pitch,
+                                 const uint8_t *srcu, size_t srcu_pitch,
+                                 const uint8_t *srcv, size_t srcv_pitch,
+                                 size_t copy_pitch, unsigned lines)
+{
+    if (copy_pitch == 0)
+        return;
+    for (unsigned y = 0; y < lines; y++) {
+        rvv_interleave_uv(dst, srcu, srcv, copy_pitch);
+        dst  += dst_pitch;
+        srcu += srcu_pitch;
+        srcv += srcv_pitch;
+    }
+}
+#endif
+
 void Copy420_P_to_SP(picture_t *dst, const uint8_t *src[static 3],
                      const size_t src_pitch[static 3], unsigned height,
                      const copy_cache_t *cache)
@@ -832,6 +1287,21 @@ void Copy420_P_to_SP(picture_t *dst, const uint8_t *src[static 3],
     if (copy_pitch > (size_t)dst->p[1].i_pitch / 2)
         copy_pitch = dst->p[1].i_pitch / 2;
 
+#ifdef COPY_NEON
+    if (vlc_CPU_ARM_NEON())
+        return NEON_InterleavePlanes(dst->p[1].p_pixels, dst->p[1].i_pitch,
+                                     src[U_PLANE], src_pitch[U_PLANE],
+                                     src[V_PLANE], src_pitch[V_PLANE],
+                                     copy_pitch, copy_lines);
+#endif
+#ifdef COPY_RVV
+    if (vlc_CPU_RV_V())
+        return RVV_InterleavePlanes(dst->p[1].p_pixels, dst->p[1].i_pitch,
+                                    src[U_PLANE], src_pitch[U_PLANE],
+                                    src[V_PLANE], src_pitch[V_PLANE],
+                                    copy_pitch, copy_lines);
+#endif
+
     const int i_extra_pitch_uv = dst->p[1].i_pitch - 2 * copy_pitch;
     const int i_extra_pitch_u  = src_pitch[U_PLANE] - copy_pitch;
     const int i_extra_pitch_v  = src_pitch[V_PLANE] - copy_pitch;
@@ -861,6 +1331,14 @@ void Copy420_16_P_to_SP(picture_t *dst, const uint8_t *src[static 3],
     const unsigned copy_lines = (height+1) / 2;
     const unsigned copy_pitch = src_pitch[1] / 2;
 
+#ifdef COPY_NEON
+    if (vlc_CPU_ARM_NEON())
+        return NEON_InterleavePlanes16(dst->p[1].p_pixels, dst->p[1].i_pitch,
+                                       src[U_PLANE], src_pitch[U_PLANE],
+                                       src[V_PLANE], src_pitch[V_PLANE],
+                                       copy_pitch, copy_lines, bitshift);
+#endif
+
     const int i_extra_pitch_uv = dst->p[1].i_pitch / 2 - 2 * copy_pitch;
     const int i_extra_pitch_u  = src_pitch[U_PLANE] / 2 - copy_pitch;
     const int i_extra_pitch_v  = src_pitch[V_PLANE] / 2 - copy_pitch;
@@ -1105,16 +1583,100 @@ cleanup:
     return NULL;
 }
 
+static void convert(const struct test_dst *test_dst, picture_t *dst,
+                    const picture_t *src, const copy_cache_t *cache)
+{
+    const uint8_t * src_planes[3] = { src->p[Y_PLANE].p_pixels,
+                                      src->p[U_PLANE].p_pixels,
+                                      src->p[V_PLANE].p_pixels };
+    const size_t    src_pitches[3] = { src->p[Y_PLANE].i_pitch,
+                                       src->p[U_PLANE].i_pitch,
+                                       src->p[V_PLANE].i_pitch };
+
+    if (test_dst->bitshift == 0)
+        test_dst->conv(dst, src_planes, src_pitches,
+                       src->format.i_visible_height, cache);
+    else
+        test_dst->conv16(dst, src_planes, src_pitches,
+                         src->format.i_visible_height, test_dst->bitshift,
+                         cache);
+}
+
+/* Throughput of each conversion on the largest tested size, in GB/s of
+ * source data. Only run when COPY_BENCH is set in the environment. */
+static void bench(void)
+{
+    const struct test_size *size = &sizes[NB_SIZES - 1];
+    const unsigned loops = 50;
+
+    for (size_t i = 0; i < NB_CONVS; ++i)
+    {
+        const struct test_conv *conv = &convs[i];
+        const vlc_chroma_description_t *src_dsc =
+            vlc_fourcc_GetChromaDescription(conv->src_chroma);
+        assert(src_dsc);
+
+        video_format_t fmt;
+        video_format_Init(&fmt, 0);
+        video_format_Setup(&fmt, conv->src_chroma,
+                           size->i_width, size->i_height,
+                           size->i_visible_width, size->i_visible_height,
+                           1, 1);
+        picture_t *src = pic_new_unaligned(&fmt);
+        assert(src);
+        piccheck(src, src_dsc, true);
+
+        size_t bytes = 0;
+        for (int p = 0; p < src->i_planes; ++p)
+            bytes += (size_t) src->p[p].i_pitch * src->p[p].i_visible_lines;
+
+        copy_cache_t cache;
+        int ret = CopyInitCache(&cache, src->format.i_width
+                                * src_dsc->pixel_size);
+        assert(ret == VLC_SUCCESS);
+
+        for (size_t f = 0; conv->dsts[f].chroma != 0; ++f)
+        {
+            const struct test_dst *test_dst = &conv->dsts[f];
+
+            fmt.i_chroma = test_dst->chroma;
+            picture_t *dst = picture_NewFromFormat(&fmt);
+            assert(dst);
+
+            convert(test_dst, dst, src, &cache);
+
+            vlc_tick_t start = vlc_tick_now();
+            for (unsigned n = 0; n < loops; ++n)
+                convert(test_dst, dst, src, &cache);
+            vlc_tick_t elapsed = vlc_tick_now() - start;
+
+            fprintf(stderr, "bench: %u x %u %4.4s -> %4.4s: %.2f GB/s\n",
+                    size->i_visible_width, size->i_visible_height,
+                    (const char *) &src->format.i_chroma,
+                    (const char *) &dst->format.i_chroma,
+                    elapsed > 0 ? (double) bytes * loops
+                                  / secf_from_vlc_tick(elapsed) / 1e9 : 0.);
+            picture_Release(dst);
+        }
+        picture_Release(src);
+        CopyCleanCache(&cache);
+    }
+}
+
 int main(void)
 {
     alarm(10);
 
 #ifndef COPY_TEST_NOOPTIM
-#ifdef CAN_COMPILE_SSE2
+#if defined (CAN_COMPILE_SSE2)
     if (!vlc_CPU_SSE2())
+#elif defined (COPY_NEON)
+    if (!vlc_CPU_ARM_NEON())
+#elif defined (COPY_RVV)
+    if (!vlc_CPU_RV_V())
 #endif
     {
-        fprintf(stderr, "WARNING: could not test SSE\n");
+        fprintf(stderr, "WARNING: could not test SIMD\n");
         return 77;
     }
 #endif
@@ -1157,25 +1719,12 @@ int main(void)
                 picture_t *dst = picture_NewFromFormat(&fmt);
                 assert(dst);
 
-                const uint8_t * src_planes[3] = { src->p[Y_PLANE].p_pixels,
-                                                  src->p[U_PLANE].p_pixels,
-                                                  src->p[V_PLANE].p_pixels };
-                const size_t    src_pitches[3] = { src->p[Y_PLANE].i_pitch,
-                                                   src->p[U_PLANE].i_pitch,
-                                                   src->p[V_PLANE].i_pitch };
-
                 fprintf(stderr, "testing: %u x %u (vis: %u x %u) %4.4s -> %4.4s\n",
                         size->i_width, size->i_height,
                         size->i_visible_width, size->i_visible_height,
                         (const char *) &src->format.i_chroma,
                         (const char *) &dst->format.i_chroma);
-                if (test_dst->bitshift == 0)
-                    test_dst->conv(dst, src_planes, src_pitches,
-                                   src->format.i_visible_height, &cache);
-                else
-                    test_dst->conv16(dst, src_planes, src_pitches,
-                                   src->format.i_visible_height, test_dst->bitshift,
-                                   &cache);
+                convert(test_dst, dst, src, &cache);
                 piccheck(dst, dst_dsc, false);
                 picture_Release(dst);
             }
@@ -1183,6 +1732,12 @@ int main(void)
             CopyCleanCache(&cache);
         }
     }
+
+    if (getenv("COPY_BENCH") != NULL)
+    {
+        alarm(0);
+        bench();
+    }
     return 0;
 }
 
@@ -0,0 +1,351 @@
+/*****************************************************************************
+ * i420_rgb_avx2.c : AVX2 YUV to RGB conversion module for vlc
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <string.h>
+#include <immintrin.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+#include <vlc_chroma_probe.h>
+#include <vlc_cpu.h>
+
+#define VLC_TARGET __attribute__ ((__target__ ("avx2")))
+
+static int Open(filter_t *);
+
+static void ProbeChroma(vlc_chroma_conv_vec *vec)
+{
+#define OUT_CHROMAS VLC_CODEC_XRGB, VLC_CODEC_RGBX, VLC_CODEC_BGRX, \
+    VLC_CODEC_XBGR, VLC_CODEC_RGB24, VLC_CODEC_BGR24, VLC_CODEC_RGB565LE
+    vlc_chroma_conv_add_in_outlist(vec, 0.5, VLC_CODEC_I420, OUT_CHROMAS);
+    vlc_chroma_conv_add_in_outlist(vec, 0.5, VLC_CODEC_YV12, OUT_CHROMAS);
+}
+
+vlc_module_begin ()
+    set_description(N_("AVX2 I420,YV12 to RV16,RV24,RV32 conversions"))
+    set_callback_video_converter(Open, 130)
+    add_submodule()
+        set_callback_chroma_conv_probe(ProbeChroma)
+vlc_module_end ()
+
+/* BT.601 limited range, with 6 bits of fractional precision */
+#define COEF_SHIFT 6
+#define COEF_Y     74
+#define COEF_RV   102
+#define COEF_GU    25
+#define COEF_GV    52
+#define COEF_BU   129
+
+/* Pixels converted at once */
+#define BLOCK 32
+
+VLC_TARGET
+static inline __m256i Clip(__m256i lo, __m256i hi)
+{
+    const __m256i round = _mm256_set1_epi16(1 << (COEF_SHIFT - 1));
+
+    lo = _mm256_srai_epi16(_mm256_adds_epi16(lo, round), COEF_SHIFT);
+    hi = _mm256_srai_epi16(_mm256_adds_epi16(hi, round), COEF_SHIFT);
+    return _mm256_packus_epi16(lo, hi);
+}
+
+/**
+ * Converts 32 pixels to one register per RGB component.
+ *
+ * The luma is unpacked per 128-bits lane, so the low half holds the pixels
+ * 0-7 and 16-23 and the high half the pixels 8-15 and 24-31. The chroma
+ * samples line up with the same unpacking, and packing back restores the
+ * pixel order.
+ */
+VLC_TARGET
+static inline void YUVToRGB(const uint8_t *py, const uint8_t *pu,
+                            const uint8_t *pv, __m256i *r, __m256i *g,
+                            __m256i *b)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i bias = _mm256_set1_epi16(128);
+    const __m256i y = _mm256_loadu_si256((const __m256i *)py);
+    const __m256i u = _mm256_sub_epi16(
+        _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)pu)), bias);
+    const __m256i v = _mm256_sub_epi16(
+        _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)pv)), bias);
+
+    const __m256i cy = _mm256_set1_epi16(COEF_Y);
+    const __m256i yoff = _mm256_set1_epi16(16 * COEF_Y);
+    const __m256i ylo = _mm256_sub_epi16(
+        _mm256_mullo_epi16(_mm256_unpacklo_epi8(y, zero), cy), yoff);
+    const __m256i yhi = _mm256_sub_epi16(
+        _mm256_mullo_epi16(_mm256_unpackhi_epi8(y, zero), cy), yoff);
+
+    const __m256i cr = _mm256_mullo_epi16(v, _mm256_set1_epi16(COEF_RV));
+    const __m256i cg = _mm256_add_epi16(
+        _mm256_mullo_epi16(u, _mm256_set1_epi16(COEF_GU)),
+        _mm256_mullo_epi16(v, _mm256_set1_epi16(COEF_GV)));
+    const __m256i cb = _mm256_mullo_epi16(u, _mm256_set1_epi16(COEF_BU));
+
+    *r = Clip(_mm256_adds_epi16(ylo, _mm256_unpacklo_epi16(cr, cr)),
+              _mm256_adds_epi16(yhi, _mm256_unpackhi_epi16(cr, cr)));
+    *g = Clip(_mm256_subs_epi16(ylo, _mm256_unpacklo_epi16(cg, cg)),
+              _mm256_subs_epi16(yhi, _mm256_unpackhi_epi16(cg, cg)));
+    *b = Clip(_mm256_adds_epi16(ylo, _mm256_unpacklo_epi16(cb, cb)),
+              _mm256_adds_epi16(yhi, _mm256_unpackhi_epi16(cb, cb)));
+}
+
+/* Interleaves four components, every register holds eight 32-bits pixels
+ * from each half: 0-3 and 16-19 in p[0], up to 12-15 and 28-31 in p[3] */
+VLC_TARGET
+static inline void Interleave4(__m256i c0, __m256i c1, __m256i c2,
+                               __m256i c3, __m256i p[4])
+{
+    const __m256i lo01 = _mm256_unpacklo_epi8(c0, c1);
+    const __m256i hi01 = _mm256_unpackhi_epi8(c0, c1);
+    const __m256i lo23 = _mm256_unpacklo_epi8(c2, c3);
+    const __m256i hi23 = _mm256_unpackhi_epi8(c2, c3);
+
+    p[0] = _mm256_unpacklo_epi16(lo01, lo23);
+    p[1] = _mm256_unpackhi_epi16(lo01, lo23);
+    p[2] = _mm256_unpacklo_epi16(hi01, hi23);
+    p[3] = _mm256_unpackhi_epi16(hi01, hi23);
+}
+
+VLC_TARGET
+static inline void Store32(uint8_t *dst, __m256i c0, __m256i c1, __m256i c2,
+                           __m256i c3)
+{
+    __m256i p[4];
+
+    Interleave4(c0, c1, c2, c3, p);
+    _mm256_storeu_si256((__m256i *)dst,
+                        _mm256_permute2x128_si256(p[0], p[1], 0x20));
+    _mm256_storeu_si256((__m256i *)(dst + 32),
+                        _mm256_permute2x128_si256(p[2], p[3], 0x20));
+    _mm256_storeu_si256((__m256i *)(dst + 64),
+                        _mm256_permute2x128_si256(p[0], p[1], 0x31));
+    _mm256_storeu_si256((__m256i *)(dst + 96),
+                        _mm256_permute2x128_si256(p[2], p[3], 0x31));
+}
+
+VLC_TARGET
+static inline void Store12(uint8_t *dst, __m128i x)
+{
+    uint32_t last = _mm_extract_epi32(x, 2);
+
+    _mm_storel_epi64((__m128i *)dst, x);
+    memcpy(dst + 8, &last, sizeof (last));
+}
+
+VLC_TARGET
+static inline void Store24(uint8_t *dst, __m256i c0, __m256i c1, __m256i c2)
+{
+    const __m256i pack = _mm256_setr_epi8(
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    __m256i p[4];
+
+    Interleave4(c0, c1, c2, _mm256_setzero_si256(), p);
+    for (size_t i = 0; i < 4; i++)
+    {
+        const __m256i x = _mm256_shuffle_epi8(p[i], pack);
+
+        Store12(dst + 12 * i, _mm256_castsi256_si128(x));
+        Store12(dst + 12 * (i + 4), _mm256_extracti128_si256(x, 1));
+    }
+}
+
+VLC_TARGET
+static inline void Store16(uint8_t *dst, __m256i r, __m256i g, __m256i b)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i rmask = _mm256_set1_epi16(0xF8);
+    const __m256i gmask = _mm256_set1_epi16(0xFC);
+    __m256i lo, hi;
+
+    lo = _mm256_or_si256(
+        _mm256_slli_epi16(_mm256_and_si256(_mm256_unpacklo_epi8(r, zero),
+                                           rmask), 8),
+        _mm256_slli_epi16(_mm256_and_si256(_mm256_unpacklo_epi8(g, zero),
+                                           gmask), 3));
+    lo = _mm256_or_si256(lo,
+        _mm256_srli_epi16(_mm256_unpacklo_epi8(b, zero), 3));
+    hi = _mm256_or_si256(
+        _mm256_slli_epi16(_mm256_and_si256(_mm256_unpackhi_epi8(r, zero),
+                                           rmask), 8),
+        _mm256_slli_epi16(_mm256_and_si256(_mm256_unpackhi_epi8(g, zero),
+                                           gmask), 3));
+    hi = _mm256_or_si256(hi,
+        _mm256_srli_epi16(_mm256_unpackhi_epi8(b, zero), 3));
+
+    _mm256_storeu_si256((__m256i *)dst,
+                        _mm256_permute2x128_si256(lo, hi, 0x20));
+    _mm256_storeu_si256((__m256i *)(dst + 32),
+                        _mm256_permute2x128_si256(lo, hi, 0x31));
+}
+
+#define BLOCK_FUNC(name, store) \
+VLC_TARGET \
+static void name(uint8_t *dst, const uint8_t *py, const uint8_t *pu, \
+                 const uint8_t *pv) \
+{ \
+    const __m256i x = _mm256_set1_epi8(-1); \
+    __m256i r, g, b; \
+\
+    YUVToRGB(py, pu, pv, &r, &g, &b); \
+    store; \
+    (void) x; \
+}
+
+BLOCK_FUNC(BlockXRGB, Store32(dst, x, r, g, b))
+BLOCK_FUNC(BlockRGBX, Store32(dst, r, g, b, x))
+BLOCK_FUNC(BlockBGRX, Store32(dst, b, g, r, x))
+BLOCK_FUNC(BlockXBGR, Store32(dst, x, b, g, r))
+BLOCK_FUNC(BlockRGB24, Store24(dst, r, g, b))
+BLOCK_FUNC(BlockBGR24, Store24(dst, b, g, r))
+BLOCK_FUNC(BlockRGB16, Store16(dst, r, g, b))
+
+typedef void (*block_func)(uint8_t *, const uint8_t *, const uint8_t *,
+                           const uint8_t *);
+
+typedef struct
+{
+    block_func block;
+    unsigned pixel_size;
+    bool swap_uv;
+} filter_sys_t;
+
+static void Convert(filter_t *filter, picture_t *src, picture_t *dst)
+{
+    const filter_sys_t *sys = filter->p_sys;
+    const unsigned width = filter->fmt_in.video.i_x_offset
+                         + filter->fmt_in.video.i_visible_width;
+    const unsigned height = filter->fmt_in.video.i_y_offset
+                          + filter->fmt_in.video.i_visible_height;
+    const plane_t *yp = &src->p[Y_PLANE];
+    const plane_t *up = &src->p[sys->swap_uv ? V_PLANE : U_PLANE];
+    const plane_t *vp = &src->p[sys->swap_uv ? U_PLANE : V_PLANE];
+
+    for (unsigned i = 0; i < height; i++)
+    {
+        const uint8_t *py = yp->p_pixels + i * yp->i_pitch;
+        const uint8_t *pu = up->p_pixels + (i / 2) * up->i_pitch;
+        const uint8_t *pv = vp->p_pixels + (i / 2) * vp->i_pitch;
+        uint8_t *out = dst->p->p_pixels + i * dst->p->i_pitch;
+        unsigned x = 0;
+
+        for (; x + BLOCK <= width; x += BLOCK)
+            sys->block(out + x * sys->pixel_size, py + x, pu + x / 2,
+                       pv + x / 2);
+
+        /* Convert the remaining pixels again with the previous block.
+         * The width is even, so the chroma samples stay aligned. */
+        if (x < width)
+        {
+            x = width - BLOCK;
+            sys->block(out + x * sys->pixel_size, py + x, pu + x / 2,
+                       pv + x / 2);
+        }
+    }
+}
+
+VIDEO_FILTER_WRAPPER_CLOSE(Convert, Close)
+
+static void Close(filter_t *filter)
+{
+    free(filter->p_sys);
+}
+
+static int Open(filter_t *filter)
+{
+    const video_format_t *in = &filter->fmt_in.video;
+    const video_format_t *out = &filter->fmt_out.video;
+
+    if (!vlc_CPU_AVX2())
+        return VLC_EGENERIC;
+
+    if (in->i_chroma != VLC_CODEC_I420 && in->i_chroma != VLC_CODEC_YV12)
+        return VLC_EGENERIC;
+
+    if (((in->i_x_offset + in->i_visible_width) & 1)
+     || in->i_x_offset + in->i_visible_width < BLOCK
+     || in->i_x_offset != out->i_x_offset
+     || in->i_y_offset != out->i_y_offset
+     || in->i_visible_width != out->i_visible_width
+     || in->i_visible_height != out->i_visible_height
+     || in->orientation != out->orientation)
+        return VLC_EGENERIC;
+
+    block_func block;
+    unsigned pixel_size;
+
+    switch (out->i_chroma)
+    {
+        case VLC_CODEC_XRGB:
+            block = BlockXRGB;
+            pixel_size = 4;
+            break;
+        case VLC_CODEC_RGBX:
+            block = BlockRGBX;
+            pixel_size = 4;
+            break;
+        case VLC_CODEC_BGRX:
+            block = BlockBGRX;
+            pixel_size = 4;
+            break;
+        case VLC_CODEC_XBGR:
+            block = BlockXBGR;
+            pixel_size = 4;
+            break;
+        case VLC_CODEC_RGB24:
+            block = BlockRGB24;
+            pixel_size = 3;
+            break;
+        case VLC_CODEC_BGR24:
+            block = BlockBGR24;
+            pixel_size = 3;
+            break;
+        case VLC_CODEC_RGB565LE:
+            block = BlockRGB16;
+            pixel_size = 2;
+            break;
+        default:
+            return VLC_EGENERIC;
+    }
+
+    filter_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    sys->block = block;
+    sys->pixel_size = pixel_size;
+    sys->swap_uv = in->i_chroma == VLC_CODEC_YV12;
+    filter->p_sys = sys;
+    filter->ops = &Convert_ops;
+
+    msg_Dbg(filter, "%4.4s(%ux%u) to %4.4s(%ux%u)",
+            (char *)&in->i_chroma, in->i_visible_width, in->i_visible_height,
+            (char *)&out->i_chroma, out->i_visible_width,
+            out->i_visible_height);
+    return VLC_SUCCESS;
+}
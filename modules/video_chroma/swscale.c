@@ -39,6 +39,13 @@
 #include <libswscale/swscale.h>
 #include <libswscale/version.h>
 
+/* libswscale can slice the scaling across its own threads since 6.1 */
+#if LIBSWSCALE_VERSION_INT >= AV_VERSION_INT(6, 1, 100)
+# define SWSCALE_THREADS 1
+# include <libavutil/frame.h>
+# include <libavutil/opt.h>
+#endif
+
 #ifdef __APPLE__
 # include <TargetConditionals.h>
 #endif
@@ -54,6 +61,10 @@ static void CloseScaler( filter_t * );
 #define SCALEMODE_TEXT N_("Scaling mode")
 #define SCALEMODE_LONGTEXT NULL
 
+#define THREADS_TEXT N_("Threads")
+#define THREADS_LONGTEXT N_( \
+    "Number of threads used to scale each picture (0 for automatic)." )
+
 static const int pi_mode_values[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
 static const char *const ppsz_mode_descriptions[] =
 { N_("Fast bilinear"), N_("Bilinear"), N_("Bicubic (good quality)"),
@@ -119,6 +130,8 @@ vlc_module_begin ()
     set_callback_video_converter( OpenScaler, 150 )
     add_integer( "swscale-mode", 2, SCALEMODE_TEXT, SCALEMODE_LONGTEXT )
         change_integer_list( pi_mode_values, ppsz_mode_descriptions )
+    add_integer( "swscale-threads", 0, THREADS_TEXT, THREADS_LONGTEXT )
+        change_integer_range( 0, 64 )
     add_submodule()
         set_callback_chroma_conv_probe(ProbeChroma)
 vlc_module_end ()
@@ -128,6 +141,20 @@ vlc_module_end ()
  * Local prototypes
  ****************************************************************************/
 
+/**
+ * Parameters a scaling context was created with.
+ */
+typedef struct
+{
+    int i_src_width, i_src_height, i_src_fmt;
+    int i_dst_width, i_dst_height, i_dst_fmt;
+    int i_flags;
+    int i_threads;
+} scaler_key_t;
+
+/* contexts kept from previous formats, to switch back without rebuilding */
+#define SCALER_CACHE_SIZE 4
+
 /**
  * Internal swscale filter structure.
  */
@@ -135,6 +162,7 @@ typedef struct
 {
     SwsFilter *p_filter;
     int i_sws_flags;
+    unsigned i_threads;
 
     video_format_t fmt_in;
     video_format_t fmt_out;
@@ -143,6 +171,19 @@ typedef struct
 
     struct SwsContext *ctx;
     struct SwsContext *ctxA;
+    scaler_key_t key;
+    scaler_key_t keyA;
+    struct
+    {
+        scaler_key_t key;
+        struct SwsContext *ctx;
+    } cache[SCALER_CACHE_SIZE];
+    unsigned i_cache_next;
+#ifdef SWSCALE_THREADS
+    AVFrame *p_frame_src;
+    AVFrame *p_frame_dst;
+    AVBufferRef *p_frame_buf;
+#endif
     picture_t *p_src_a;
     picture_t *p_dst_a;
     int i_extend_factor;
@@ -240,6 +281,95 @@ static void SetColorspace( filter_sys_t *p_sys )
                               brightness, contrast, saturation );
 }
 
+#ifdef SWSCALE_THREADS
+static void NoFree( void *opaque, uint8_t *data )
+{
+    VLC_UNUSED(opaque); VLC_UNUSED(data);
+}
+#endif
+
+static void FreeFrames( filter_sys_t *p_sys )
+{
+#ifdef SWSCALE_THREADS
+    av_frame_free( &p_sys->p_frame_src );
+    av_frame_free( &p_sys->p_frame_dst );
+    av_buffer_unref( &p_sys->p_frame_buf );
+#else
+    VLC_UNUSED(p_sys);
+#endif
+}
+
+static struct SwsContext *CreateContext( filter_sys_t *p_sys,
+                                         const scaler_key_t *key )
+{
+#ifdef SWSCALE_THREADS
+    if( key->i_threads > 1 )
+    {
+        struct SwsContext *ctx = sws_alloc_context();
+        if( ctx == NULL )
+            return NULL;
+
+        av_opt_set_int( ctx, "srcw", key->i_src_width, 0 );
+        av_opt_set_int( ctx, "srch", key->i_src_height, 0 );
+        av_opt_set_int( ctx, "src_format", key->i_src_fmt, 0 );
+        av_opt_set_int( ctx, "dstw", key->i_dst_width, 0 );
+        av_opt_set_int( ctx, "dsth", key->i_dst_height, 0 );
+        av_opt_set_int( ctx, "dst_format", key->i_dst_fmt, 0 );
+        av_opt_set_int( ctx, "sws_flags", key->i_flags, 0 );
+        av_opt_set_int( ctx, "threads", key->i_threads, 0 );
+        if( sws_init_context( ctx, p_sys->p_filter, NULL ) < 0 )
+        {
+            sws_freeContext( ctx );
+            return NULL;
+        }
+        return ctx;
+    }
+#endif
+    return sws_getContext( key->i_src_width, key->i_src_height, key->i_src_fmt,
+                           key->i_dst_width, key->i_dst_height, key->i_dst_fmt,
+                           key->i_flags, p_sys->p_filter, NULL, 0 );
+}
+
+/* Gets a context from the cache, or creates a new one */
+static struct SwsContext *GetContext( filter_sys_t *p_sys,
+                                      const scaler_key_t *key )
+{
+    for( size_t i = 0; i < SCALER_CACHE_SIZE; i++ )
+    {
+        if( p_sys->cache[i].ctx != NULL &&
+            !memcmp( &p_sys->cache[i].key, key, sizeof(*key) ) )
+        {
+            struct SwsContext *ctx = p_sys->cache[i].ctx;
+            p_sys->cache[i].ctx = NULL;
+            return ctx;
+        }
+    }
+    return CreateContext( p_sys, key );
+}
+
+/* Keeps a context no longer used for the current format */
+static void PutContext( filter_sys_t *p_sys, const scaler_key_t *key,
+                        struct SwsContext *ctx )
+{
+    unsigned i = p_sys->i_cache_next;
+
+    p_sys->i_cache_next = (i + 1) % SCALER_CACHE_SIZE;
+    if( p_sys->cache[i].ctx != NULL )
+        sws_freeContext( p_sys->cache[i].ctx );
+    p_sys->cache[i].key = *key;
+    p_sys->cache[i].ctx = ctx;
+}
+
+static void FlushContexts( filter_sys_t *p_sys )
+{
+    for( size_t i = 0; i < SCALER_CACHE_SIZE; i++ )
+    {
+        if( p_sys->cache[i].ctx != NULL )
+            sws_freeContext( p_sys->cache[i].ctx );
+        p_sys->cache[i].ctx = NULL;
+    }
+}
+
 /*****************************************************************************
  * OpenScaler: probe the filter and return score
  *****************************************************************************/
@@ -276,6 +406,29 @@ static int OpenScaler( filter_t *p_filter )
     default: p_sys->i_sws_flags = SWS_BICUBIC; i_sws_mode = 2; break;
     }
 
+    p_sys->i_threads = var_InheritInteger( p_filter, "swscale-threads" );
+    if( p_sys->i_threads == 0 )
+        p_sys->i_threads = __MIN( vlc_GetCPUCount(), 8 );
+#ifdef SWSCALE_THREADS
+    if( p_sys->i_threads > 1 )
+    {
+        /* the frames only wrap the pictures planes, nothing to free */
+        static uint8_t dummy;
+        p_sys->p_frame_src = av_frame_alloc();
+        p_sys->p_frame_dst = av_frame_alloc();
+        p_sys->p_frame_buf = av_buffer_create( &dummy, 1, NoFree, NULL,
+                                               AV_BUFFER_FLAG_READONLY );
+        if( !p_sys->p_frame_src || !p_sys->p_frame_dst || !p_sys->p_frame_buf )
+        {
+            FreeFrames( p_sys );
+            free( p_sys );
+            return VLC_ENOMEM;
+        }
+    }
+#else
+    p_sys->i_threads = 1;
+#endif
+
     /* Misc init */
     memset( &p_sys->fmt_in,  0, sizeof(p_sys->fmt_in) );
     memset( &p_sys->fmt_out, 0, sizeof(p_sys->fmt_out) );
@@ -284,6 +437,8 @@ static int OpenScaler( filter_t *p_filter )
     {
         if( p_sys->p_filter )
             sws_freeFilter( p_sys->p_filter );
+        FlushContexts( p_sys );
+        FreeFrames( p_sys );
         free( p_sys );
         return VLC_EGENERIC;
     }
@@ -299,6 +454,8 @@ static int OpenScaler( filter_t *p_filter )
              p_filter->fmt_out.video.i_width, p_filter->fmt_out.video.i_height,
              (char *)&p_filter->fmt_out.video.i_chroma, GetColorspaceName( p_filter->fmt_out.video.space ),
              ppsz_mode_descriptions[i_sws_mode] );
+    if( p_sys->i_threads > 1 )
+        msg_Dbg( p_filter, "scaling with %u threads", p_sys->i_threads );
 
     return VLC_SUCCESS;
 }
@@ -311,6 +468,8 @@ static void CloseScaler( filter_t *p_filter )
     filter_sys_t *p_sys = p_filter->p_sys;
 
     Clean( p_filter );
+    FlushContexts( p_sys );
+    FreeFrames( p_sys );
     if( p_sys->p_filter )
         sws_freeFilter( p_sys->p_filter );
     free( p_sys );
@@ -473,18 +632,28 @@ static int Init( filter_t *p_filter )
     const unsigned i_fmto_visible_width = p_fmto->i_visible_width * p_sys->i_extend_factor;
     for( int n = 0; n < (cfg.b_has_a ? 2 : 1); n++ )
     {
-        const int i_fmti = n == 0 ? cfg.i_fmti : AV_PIX_FMT_GRAY8;
-        const int i_fmto = n == 0 ? cfg.i_fmto : AV_PIX_FMT_GRAY8;
-        struct SwsContext *ctx;
-
-        ctx = sws_getContext( i_fmti_visible_width, p_fmti->i_visible_height, i_fmti,
-                              i_fmto_visible_width, p_fmto->i_visible_height, i_fmto,
-                              cfg.i_sws_flags,
-                              p_sys->p_filter, NULL, 0 );
+        const scaler_key_t key = {
+            .i_src_width = i_fmti_visible_width,
+            .i_src_height = p_fmti->i_visible_height,
+            .i_src_fmt = n == 0 ? cfg.i_fmti : AV_PIX_FMT_GRAY8,
+            .i_dst_width = i_fmto_visible_width,
+            .i_dst_height = p_fmto->i_visible_height,
+            .i_dst_fmt = n == 0 ? cfg.i_fmto : AV_PIX_FMT_GRAY8,
+            .i_flags = cfg.i_sws_flags,
+            /* the alpha plane is scaled on the filter thread */
+            .i_threads = n == 0 ? p_sys->i_threads : 1,
+        };
+        struct SwsContext *ctx = GetContext( p_sys, &key );
         if( n == 0 )
+        {
             p_sys->ctx = ctx;
+            p_sys->key = key;
+        }
         else
+        {
             p_sys->ctxA = ctx;
+            p_sys->keyA = key;
+        }
     }
     if( p_sys->ctxA )
     {
@@ -558,10 +727,10 @@ static void Clean( filter_t *p_filter )
         picture_Release( p_sys->p_dst_a );
 
     if( p_sys->ctxA )
-        sws_freeContext( p_sys->ctxA );
+        PutContext( p_sys, &p_sys->keyA, p_sys->ctxA );
 
     if( p_sys->ctx )
-        sws_freeContext( p_sys->ctx );
+        PutContext( p_sys, &p_sys->key, p_sys->ctx );
 
     /* We have to set it to null has we call be called again :( */
     p_sys->ctx = NULL;
@@ -659,7 +828,45 @@ static void SwapUV( picture_t *p_dst, const picture_t *p_src )
     picture_CopyPixels( p_dst, &tmp );
 }
 
+#ifdef SWSCALE_THREADS
+static void WrapFrame( filter_sys_t *p_sys, AVFrame *frame, int i_format,
+                       int i_width, int i_height,
+                       uint8_t *const pixels[4], const int pitches[4] )
+{
+    frame->format = i_format;
+    frame->width = i_width;
+    frame->height = i_height;
+    for( size_t i = 0; i < 4; i++ )
+    {
+        frame->data[i] = pixels[i];
+        frame->linesize[i] = pitches[i];
+    }
+    /* swscale references the frames, they must look refcounted */
+    frame->buf[0] = av_buffer_ref( p_sys->p_frame_buf );
+}
+
+static int ScaleThreaded( filter_sys_t *p_sys, struct SwsContext *ctx,
+                          const scaler_key_t *key,
+                          uint8_t *const src[4], const int src_stride[4],
+                          uint8_t *const dst[4], const int dst_stride[4] )
+{
+    WrapFrame( p_sys, p_sys->p_frame_src, key->i_src_fmt,
+               key->i_src_width, key->i_src_height, src, src_stride );
+    WrapFrame( p_sys, p_sys->p_frame_dst, key->i_dst_fmt,
+               key->i_dst_width, key->i_dst_height, dst, dst_stride );
+
+    int ret = VLC_ENOMEM;
+    if( likely(p_sys->p_frame_src->buf[0] && p_sys->p_frame_dst->buf[0]) )
+        ret = sws_scale_frame( ctx, p_sys->p_frame_dst, p_sys->p_frame_src );
+
+    av_frame_unref( p_sys->p_frame_src );
+    av_frame_unref( p_sys->p_frame_dst );
+    return ret;
+}
+#endif
+
 static void Convert( filter_t *p_filter, struct SwsContext *ctx,
+                     const scaler_key_t *key,
                      picture_t *p_dst, picture_t *p_src, int i_height,
                      int i_plane_count, bool b_swap_uvi, bool b_swap_uvo )
 {
@@ -707,6 +914,14 @@ static void Convert( filter_t *p_filter, struct SwsContext *ctx,
     GetPixels( dst, dst_stride, p_sys->desc_out, &p_filter->fmt_out.video,
                p_dst, i_plane_count, b_swap_uvo );
 
+#ifdef SWSCALE_THREADS
+    if( key->i_threads > 1 &&
+        ScaleThreaded( p_sys, ctx, key, src, src_stride, dst, dst_stride ) >= 0 )
+        return;
+#else
+    VLC_UNUSED(key);
+#endif
+
     for (size_t i = 0; i < ARRAY_SIZE(src); i++)
         csrc[i] = src[i];
 
@@ -766,7 +981,7 @@ static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
         /* Even if alpha is unused, swscale expects the pointer to be set */
         const int n_planes = !p_sys->ctxA && (p_src->i_planes == 4 ||
                              p_dst->i_planes == 4) ? 4 : 3;
-        Convert( p_filter, p_sys->ctx, p_dst, p_src, p_fmti->i_visible_height,
+        Convert( p_filter, p_sys->ctx, &p_sys->key, p_dst, p_src, p_fmti->i_visible_height,
                  n_planes, p_sys->b_swap_uvi, p_sys->b_swap_uvo );
     }
     if( p_sys->ctxA )
@@ -779,7 +994,7 @@ static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
         else
             plane_CopyPixels( p_sys->p_src_a->p, p_src->p+A_PLANE );
 
-        Convert( p_filter, p_sys->ctxA, p_sys->p_dst_a, p_sys->p_src_a,
+        Convert( p_filter, p_sys->ctxA, &p_sys->keyA, p_sys->p_dst_a, p_sys->p_src_a,
                  p_fmti->i_visible_height, 1, false, false );
         if( p_fmto->i_chroma == VLC_CODEC_RGBA || p_fmto->i_chroma == VLC_CODEC_BGRA )
             InjectA( p_dst, p_sys->p_dst_a, OFFSET_A );
@@ -144,6 +144,7 @@ static int Create( filter_t *p_filter )
     if( p_sys == NULL )
         return VLC_ENOMEM;
     p_filter->p_sys = p_sys;
+    p_filter->b_in_place = true;
 
     /* Choose Planar/Packed function and pointer to a Hue/Saturation processing
      * function*/
@@ -32,6 +32,7 @@
 #include <vlc_filter.h>
 #include <vlc_picture.h>
 #include "filter_picture.h"
+#include "blend_lines.h"
 
 /*****************************************************************************
  * Module descriptor
@@ -604,6 +605,114 @@ void Blend(const CPicture &dst_data, const CPicture &src_data,
     }
 }
 
+namespace {
+
+/* Direct access to the 8-bits planes, for the line blending functions */
+class CPicturePlanes : public CPicture {
+public:
+    CPicturePlanes(const CPicture &cfg) : CPicture(cfg)
+    {
+    }
+    uint8_t *getLine(unsigned plane, unsigned dy, unsigned ry = 1) const
+    {
+        const plane_t *p = &picture->p[plane];
+        return &p->p_pixels[(y + dy) / ry * p->i_pitch];
+    }
+    unsigned getX() const
+    {
+        return x;
+    }
+    unsigned getY() const
+    {
+        return y;
+    }
+};
+
+static const blend_line_functions &GetLineFunctions()
+{
+    static const struct LineFunctionsInitializer {
+        blend_line_functions funcs;
+        LineFunctionsInitializer()
+        {
+            BlendLineFunctionsInit(&funcs);
+        }
+    } initializer;
+    return initializer.funcs;
+}
+
+} // namespace
+
+/**
+ * Blends YUVA onto 8-bits 4:2:0 pictures, one line at a time.
+ * It gives the same result as Blend<CPictureI420_8, CPictureYUVA, ...>.
+ */
+template <bool semi_planar, bool swap_uv>
+void BlendYUVA420(const CPicture &dst_data, const CPicture &src_data,
+                  unsigned width, unsigned height, int alpha)
+{
+    const CPicturePlanes src(src_data);
+    const CPicturePlanes dst(dst_data);
+    const blend_line_functions &funcs = GetLineFunctions();
+
+    /* The chroma is blended from the source pixels that are on the top-left
+     * of each destination chroma sample */
+    const unsigned x = dst.getX();
+    const unsigned sx = src.getX();
+    const unsigned first = x & 1;
+    const unsigned chroma_count = (width - first + 1) / 2;
+
+    for (unsigned y = 0; y < height; y++) {
+        const uint8_t *sy = src.getLine(0, y) + sx;
+        const uint8_t *su = src.getLine(swap_uv ? 2 : 1, y) + sx + first;
+        const uint8_t *sv = src.getLine(swap_uv ? 1 : 2, y) + sx + first;
+        const uint8_t *sa = src.getLine(3, y) + sx;
+
+        funcs.plane(dst.getLine(0, y) + x, sy, sa, alpha, width);
+
+        if (((dst.getY() + y) % 2) != 0 || chroma_count == 0)
+            continue;
+
+        const unsigned cx = (x + first) / 2;
+        if (semi_planar)
+            funcs.chroma_semi(dst.getLine(1, y, 2) + 2 * cx, su, sv,
+                              sa + first, alpha, chroma_count);
+        else
+            funcs.chroma(dst.getLine(1, y, 2) + cx, dst.getLine(2, y, 2) + cx,
+                         su, sv, sa + first, alpha, chroma_count);
+    }
+}
+
+/**
+ * Blends RGBA onto 32-bits RGB pictures without alpha, one line at a time.
+ * Like Blend<CPictureRGB32, CPictureRGBA, ...>, the source alpha is replaced
+ * by an opaque one.
+ */
+static void BlendRGBAToRGBX(const CPicture &dst_data, const CPicture &src_data,
+                            unsigned width, unsigned height, int alpha)
+{
+    const CPicturePlanes src(src_data);
+    const CPicturePlanes dst(dst_data);
+    const blend_line_functions &funcs = GetLineFunctions();
+    int src_r, src_g, src_b, src_a;
+    int dst_r, dst_g, dst_b, dst_a;
+
+    if (GetPackedRgbIndexes(src_data.getFormat()->i_chroma,
+                            &src_r, &src_g, &src_b, &src_a) != VLC_SUCCESS
+     || GetPackedRgbIndexes(dst_data.getFormat()->i_chroma,
+                            &dst_r, &dst_g, &dst_b, &dst_a) != VLC_SUCCESS)
+        return;
+
+    int8_t map[4] = { -1, -1, -1, -1 };
+    map[dst_r] = src_r;
+    map[dst_g] = src_g;
+    map[dst_b] = src_b;
+
+    for (unsigned y = 0; y < height; y++)
+        funcs.rgbx(dst.getLine(0, y) + 4 * dst.getX(),
+                   src.getLine(0, y) + 4 * src.getX(), map,
+                   div255(alpha * 255), width);
+}
+
 typedef void (*blend_function_t)(const CPicture &dst_data, const CPicture &src_data,
                                  unsigned width, unsigned height, int alpha);
 
@@ -683,6 +792,16 @@ static const struct {
     YUV(VLC_CODEC_YVYU,     CPictureYVYU,     convertNone),
     YUV(VLC_CODEC_VYUY,     CPictureVYUY,     convertNone),
 
+    /* Line based paths, they override the generic ones */
+    { VLC_CODEC_I420, VLC_CODEC_YUVA, BlendYUVA420<false, false> },
+    { VLC_CODEC_YV12, VLC_CODEC_YUVA, BlendYUVA420<false, true> },
+    { VLC_CODEC_NV12, VLC_CODEC_YUVA, BlendYUVA420<true, false> },
+    { VLC_CODEC_NV21, VLC_CODEC_YUVA, BlendYUVA420<true, true> },
+    { VLC_CODEC_RGBX, VLC_CODEC_RGBA, BlendRGBAToRGBX },
+    { VLC_CODEC_XRGB, VLC_CODEC_RGBA, BlendRGBAToRGBX },
+    { VLC_CODEC_BGRX, VLC_CODEC_RGBA, BlendRGBAToRGBX },
+    { VLC_CODEC_XBGR, VLC_CODEC_RGBA, BlendRGBAToRGBX },
+
 #undef RGB
 #undef YUV
 };
@@ -0,0 +1,562 @@
+/*****************************************************************************
+ * blend_lines.c: optimized 8-bits alpha blending lines
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+
+#if defined(CAN_COMPILE_SSE4_1) || defined(CAN_COMPILE_AVX2)
+# include <immintrin.h>
+#endif
+#if defined(__ARM_NEON)
+# include <arm_neon.h>
+#endif
+
+#include "blend_lines.h"
+
+static inline unsigned div255(unsigned v)
+{
+    return ((v >> 8) + v + 1) >> 8;
+}
+
+static inline void merge(uint8_t *dst, unsigned src, unsigned f)
+{
+    *dst = div255((255 - f) * *dst + src * f);
+}
+
+/*****************************************************************************
+ * C
+ *****************************************************************************/
+static void PlaneC(uint8_t *dst, const uint8_t *src, const uint8_t *a,
+                   unsigned alpha, unsigned count)
+{
+    for (unsigned x = 0; x < count; x++) {
+        const unsigned f = div255(alpha * a[x]);
+        if (f != 0)
+            merge(&dst[x], src[x], f);
+    }
+}
+
+static void ChromaC(uint8_t *du, uint8_t *dv, const uint8_t *su,
+                    const uint8_t *sv, const uint8_t *a,
+                    unsigned alpha, unsigned count)
+{
+    for (unsigned x = 0; x < count; x++) {
+        const unsigned f = div255(alpha * a[2 * x]);
+        if (f != 0) {
+            merge(&du[x], su[2 * x], f);
+            merge(&dv[x], sv[2 * x], f);
+        }
+    }
+}
+
+static void ChromaSemiC(uint8_t *duv, const uint8_t *su, const uint8_t *sv,
+                        const uint8_t *a, unsigned alpha, unsigned count)
+{
+    for (unsigned x = 0; x < count; x++) {
+        const unsigned f = div255(alpha * a[2 * x]);
+        if (f != 0) {
+            merge(&duv[2 * x + 0], su[2 * x], f);
+            merge(&duv[2 * x + 1], sv[2 * x], f);
+        }
+    }
+}
+
+static void RGBXC(uint8_t *dst, const uint8_t *src, const int8_t map[4],
+                  unsigned alpha, unsigned count)
+{
+    for (unsigned x = 0; x < count; x++, dst += 4, src += 4)
+        for (unsigned i = 0; i < 4; i++)
+            if (map[i] >= 0)
+                merge(&dst[i], src[map[i]], alpha);
+}
+
+/*****************************************************************************
+ * SSE4.1
+ *****************************************************************************/
+#ifdef CAN_COMPILE_SSE4_1
+#define VLC_SSE4_1 __attribute__ ((__target__ ("sse4.1")))
+
+VLC_SSE4_1
+static inline __m128i Div255SSE4_1(__m128i v)
+{
+    v = _mm_add_epi16(v, _mm_srli_epi16(v, 8));
+    v = _mm_add_epi16(v, _mm_set1_epi16(1));
+    return _mm_srli_epi16(v, 8);
+}
+
+/* d, s and f are 16-bits lanes holding 8-bits values */
+VLC_SSE4_1
+static inline __m128i MergeSSE4_1(__m128i d, __m128i s, __m128i f)
+{
+    const __m128i nf = _mm_sub_epi16(_mm_set1_epi16(255), f);
+
+    return Div255SSE4_1(_mm_add_epi16(_mm_mullo_epi16(d, nf),
+                                      _mm_mullo_epi16(s, f)));
+}
+
+VLC_SSE4_1
+static void PlaneSSE4_1(uint8_t *dst, const uint8_t *src, const uint8_t *a,
+                        unsigned alpha, unsigned count)
+{
+    const __m128i va = _mm_set1_epi16(alpha);
+    const __m128i zero = _mm_setzero_si128();
+    unsigned x = 0;
+
+    for (; x + 16 <= count; x += 16) {
+        const __m128i am = _mm_loadu_si128((const __m128i *)&a[x]);
+        if (_mm_testz_si128(am, am))
+            continue;
+
+        const __m128i s = _mm_loadu_si128((const __m128i *)&src[x]);
+        const __m128i d = _mm_loadu_si128((const __m128i *)&dst[x]);
+        const __m128i flo =
+            Div255SSE4_1(_mm_mullo_epi16(_mm_unpacklo_epi8(am, zero), va));
+        const __m128i fhi =
+            Div255SSE4_1(_mm_mullo_epi16(_mm_unpackhi_epi8(am, zero), va));
+        const __m128i lo = MergeSSE4_1(_mm_unpacklo_epi8(d, zero),
+                                       _mm_unpacklo_epi8(s, zero), flo);
+        const __m128i hi = MergeSSE4_1(_mm_unpackhi_epi8(d, zero),
+                                       _mm_unpackhi_epi8(s, zero), fhi);
+
+        _mm_storeu_si128((__m128i *)&dst[x], _mm_packus_epi16(lo, hi));
+    }
+    PlaneC(&dst[x], &src[x], &a[x], alpha, count - x);
+}
+
+VLC_SSE4_1
+static void ChromaSSE4_1(uint8_t *du, uint8_t *dv, const uint8_t *su,
+                         const uint8_t *sv, const uint8_t *a,
+                         unsigned alpha, unsigned count)
+{
+    const __m128i va = _mm_set1_epi16(alpha);
+    const __m128i even = _mm_set1_epi16(0xFF);
+    unsigned x = 0;
+
+    for (; x + 8 < count; x += 8) {
+        const __m128i am = _mm_loadu_si128((const __m128i *)&a[2 * x]);
+        if (_mm_testz_si128(am, even))
+            continue;
+
+        const __m128i f = Div255SSE4_1(_mm_mullo_epi16(_mm_and_si128(am, even),
+                                                       va));
+        const __m128i u = _mm_and_si128(
+            _mm_loadu_si128((const __m128i *)&su[2 * x]), even);
+        const __m128i v = _mm_and_si128(
+            _mm_loadu_si128((const __m128i *)&sv[2 * x]), even);
+        const __m128i ru = MergeSSE4_1(
+            _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)&du[x])), u, f);
+        const __m128i rv = MergeSSE4_1(
+            _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)&dv[x])), v, f);
+
+        _mm_storel_epi64((__m128i *)&du[x], _mm_packus_epi16(ru, ru));
+        _mm_storel_epi64((__m128i *)&dv[x], _mm_packus_epi16(rv, rv));
+    }
+    ChromaC(&du[x], &dv[x], &su[2 * x], &sv[2 * x], &a[2 * x], alpha,
+            count - x);
+}
+
+VLC_SSE4_1
+static void ChromaSemiSSE4_1(uint8_t *duv, const uint8_t *su,
+                             const uint8_t *sv, const uint8_t *a,
+                             unsigned alpha, unsigned count)
+{
+    const __m128i va = _mm_set1_epi16(alpha);
+    const __m128i even = _mm_set1_epi16(0xFF);
+    const __m128i zero = _mm_setzero_si128();
+    unsigned x = 0;
+
+    for (; x + 8 < count; x += 8) {
+        const __m128i am = _mm_loadu_si128((const __m128i *)&a[2 * x]);
+        if (_mm_testz_si128(am, even))
+            continue;
+
+        const __m128i f = Div255SSE4_1(_mm_mullo_epi16(_mm_and_si128(am, even),
+                                                       va));
+        /* Interleave the even U and V samples, like the destination */
+        const __m128i s = _mm_or_si128(
+            _mm_and_si128(_mm_loadu_si128((const __m128i *)&su[2 * x]), even),
+            _mm_slli_epi16(_mm_loadu_si128((const __m128i *)&sv[2 * x]), 8));
+        const __m128i d = _mm_loadu_si128((const __m128i *)&duv[2 * x]);
+        const __m128i lo = MergeSSE4_1(_mm_unpacklo_epi8(d, zero),
+                                       _mm_unpacklo_epi8(s, zero),
+                                       _mm_unpacklo_epi16(f, f));
+        const __m128i hi = MergeSSE4_1(_mm_unpackhi_epi8(d, zero),
+                                       _mm_unpackhi_epi8(s, zero),
+                                       _mm_unpackhi_epi16(f, f));
+
+        _mm_storeu_si128((__m128i *)&duv[2 * x], _mm_packus_epi16(lo, hi));
+    }
+    ChromaSemiC(&duv[2 * x], &su[2 * x], &sv[2 * x], &a[2 * x], alpha,
+                count - x);
+}
+
+VLC_SSE4_1
+static void RGBXSSE4_1(uint8_t *dst, const uint8_t *src, const int8_t map[4],
+                       unsigned alpha, unsigned count)
+{
+    int8_t shuf[16];
+    int16_t fs[4];
+
+    for (unsigned i = 0; i < 16; i++)
+        shuf[i] = map[i % 4] >= 0 ? (int8_t)(i - i % 4 + map[i % 4]) : -1;
+    for (unsigned i = 0; i < 4; i++)
+        fs[i] = map[i] >= 0 ? alpha : 0;
+
+    const __m128i perm = _mm_loadu_si128((const __m128i *)shuf);
+    const __m128i f = _mm_set_epi16(fs[3], fs[2], fs[1], fs[0],
+                                    fs[3], fs[2], fs[1], fs[0]);
+    const __m128i zero = _mm_setzero_si128();
+    unsigned x = 0;
+
+    for (; x + 4 <= count; x += 4) {
+        const __m128i s = _mm_shuffle_epi8(
+            _mm_loadu_si128((const __m128i *)&src[4 * x]), perm);
+        const __m128i d = _mm_loadu_si128((const __m128i *)&dst[4 * x]);
+        const __m128i lo = MergeSSE4_1(_mm_unpacklo_epi8(d, zero),
+                                       _mm_unpacklo_epi8(s, zero), f);
+        const __m128i hi = MergeSSE4_1(_mm_unpackhi_epi8(d, zero),
+                                       _mm_unpackhi_epi8(s, zero), f);
+
+        _mm_storeu_si128((__m128i *)&dst[4 * x], _mm_packus_epi16(lo, hi));
+    }
+    RGBXC(&dst[4 * x], &src[4 * x], map, alpha, count - x);
+}
+#endif
+
+/*****************************************************************************
+ * AVX2
+ *****************************************************************************/
+#ifdef CAN_COMPILE_AVX2
+#define VLC_AVX2 __attribute__ ((__target__ ("avx2")))
+
+VLC_AVX2
+static inline __m256i Div255AVX2(__m256i v)
+{
+    v = _mm256_add_epi16(v, _mm256_srli_epi16(v, 8));
+    v = _mm256_add_epi16(v, _mm256_set1_epi16(1));
+    return _mm256_srli_epi16(v, 8);
+}
+
+VLC_AVX2
+static inline __m256i MergeAVX2(__m256i d, __m256i s, __m256i f)
+{
+    const __m256i nf = _mm256_sub_epi16(_mm256_set1_epi16(255), f);
+
+    return Div255AVX2(_mm256_add_epi16(_mm256_mullo_epi16(d, nf),
+                                       _mm256_mullo_epi16(s, f)));
+}
+
+/* Packs two vectors of 16-bits lanes back into 32 bytes in order */
+VLC_AVX2
+static inline __m256i PackAVX2(__m256i lo, __m256i hi)
+{
+    return _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xD8);
+}
+
+VLC_AVX2
+static inline __m256i LoAVX2(__m256i v)
+{
+    return _mm256_cvtepu8_epi16(_mm256_castsi256_si128(v));
+}
+
+VLC_AVX2
+static inline __m256i HiAVX2(__m256i v)
+{
+    return _mm256_cvtepu8_epi16(_mm256_extracti128_si256(v, 1));
+}
+
+VLC_AVX2
+static void PlaneAVX2(uint8_t *dst, const uint8_t *src, const uint8_t *a,
+                      unsigned alpha, unsigned count)
+{
+    const __m256i va = _mm256_set1_epi16(alpha);
+    unsigned x = 0;
+
+    for (; x + 32 <= count; x += 32) {
+        const __m256i am = _mm256_loadu_si256((const __m256i *)&a[x]);
+        if (_mm256_testz_si256(am, am))
+            continue;
+
+        const __m256i s = _mm256_loadu_si256((const __m256i *)&src[x]);
+        const __m256i d = _mm256_loadu_si256((const __m256i *)&dst[x]);
+        const __m256i lo = MergeAVX2(LoAVX2(d), LoAVX2(s),
+            Div255AVX2(_mm256_mullo_epi16(LoAVX2(am), va)));
+        const __m256i hi = MergeAVX2(HiAVX2(d), HiAVX2(s),
+            Div255AVX2(_mm256_mullo_epi16(HiAVX2(am), va)));
+
+        _mm256_storeu_si256((__m256i *)&dst[x], PackAVX2(lo, hi));
+    }
+    PlaneC(&dst[x], &src[x], &a[x], alpha, count - x);
+}
+
+VLC_AVX2
+static void ChromaAVX2(uint8_t *du, uint8_t *dv, const uint8_t *su,
+                       const uint8_t *sv, const uint8_t *a,
+                       unsigned alpha, unsigned count)
+{
+    const __m256i va = _mm256_set1_epi16(alpha);
+    const __m256i even = _mm256_set1_epi16(0xFF);
+    unsigned x = 0;
+
+    for (; x + 16 < count; x += 16) {
+        const __m256i am = _mm256_loadu_si256((const __m256i *)&a[2 * x]);
+        if (_mm256_testz_si256(am, even))
+            continue;
+
+        const __m256i f = Div255AVX2(
+            _mm256_mullo_epi16(_mm256_and_si256(am, even), va));
+        const __m256i u = _mm256_and_si256(
+            _mm256_loadu_si256((const __m256i *)&su[2 * x]), even);
+        const __m256i v = _mm256_and_si256(
+            _mm256_loadu_si256((const __m256i *)&sv[2 * x]), even);
+        const __m256i ru = MergeAVX2(_mm256_cvtepu8_epi16(
+            _mm_loadu_si128((const __m128i *)&du[x])), u, f);
+        const __m256i rv = MergeAVX2(_mm256_cvtepu8_epi16(
+            _mm_loadu_si128((const __m128i *)&dv[x])), v, f);
+
+        _mm_storeu_si128((__m128i *)&du[x],
+                         _mm256_castsi256_si128(PackAVX2(ru, ru)));
+        _mm_storeu_si128((__m128i *)&dv[x],
+                         _mm256_castsi256_si128(PackAVX2(rv, rv)));
+    }
+    ChromaC(&du[x], &dv[x], &su[2 * x], &sv[2 * x], &a[2 * x], alpha,
+            count - x);
+}
+
+VLC_AVX2
+static void ChromaSemiAVX2(uint8_t *duv, const uint8_t *su, const uint8_t *sv,
+                           const uint8_t *a, unsigned alpha, unsigned count)
+{
+    const __m256i va = _mm256_set1_epi16(alpha);
+    const __m256i even = _mm256_set1_epi16(0xFF);
+    unsigned x = 0;
+
+    for (; x + 16 < count; x += 16) {
+        const __m256i am = _mm256_loadu_si256((const __m256i *)&a[2 * x]);
+        if (_mm256_testz_si256(am, even))
+            continue;
+
+        /* Reorder the factors so that the in-lane unpacking duplicates
+         * them in order */
+        const __m256i f = _mm256_permute4x64_epi64(Div255AVX2(
+            _mm256_mullo_epi16(_mm256_and_si256(am, even), va)), 0xD8);
+        const __m256i s = _mm256_or_si256(
+            _mm256_and_si256(
+                _mm256_loadu_si256((const __m256i *)&su[2 * x]), even),
+            _mm256_slli_epi16(
+                _mm256_loadu_si256((const __m256i *)&sv[2 * x]), 8));
+        const __m256i d = _mm256_loadu_si256((const __m256i *)&duv[2 * x]);
+        const __m256i lo = MergeAVX2(LoAVX2(d), LoAVX2(s),
+                                     _mm256_unpacklo_epi16(f, f));
+        const __m256i hi = MergeAVX2(HiAVX2(d), HiAVX2(s),
+                                     _mm256_unpackhi_epi16(f, f));
+
+        _mm256_storeu_si256((__m256i *)&duv[2 * x], PackAVX2(lo, hi));
+    }
+    ChromaSemiC(&duv[2 * x], &su[2 * x], &sv[2 * x], &a[2 * x], alpha,
+                count - x);
+}
+
+VLC_AVX2
+static void RGBXAVX2(uint8_t *dst, const uint8_t *src, const int8_t map[4],
+                     unsigned alpha, unsigned count)
+{
+    int8_t shuf[16];
+    int16_t fs[4];
+
+    for (unsigned i = 0; i < 16; i++)
+        shuf[i] = map[i % 4] >= 0 ? (int8_t)(i - i % 4 + map[i % 4]) : -1;
+    for (unsigned i = 0; i < 4; i++)
+        fs[i] = map[i] >= 0 ? alpha : 0;
+
+    const __m256i perm = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *)shuf));
+    const __m256i f = _mm256_set_epi16(fs[3], fs[2], fs[1], fs[0],
+                                       fs[3], fs[2], fs[1], fs[0],
+                                       fs[3], fs[2], fs[1], fs[0],
+                                       fs[3], fs[2], fs[1], fs[0]);
+    unsigned x = 0;
+
+    for (; x + 8 <= count; x += 8) {
+        const __m256i s = _mm256_shuffle_epi8(
+            _mm256_loadu_si256((const __m256i *)&src[4 * x]), perm);
+        const __m256i d = _mm256_loadu_si256((const __m256i *)&dst[4 * x]);
+        const __m256i lo = MergeAVX2(LoAVX2(d), LoAVX2(s), f);
+        const __m256i hi = MergeAVX2(HiAVX2(d), HiAVX2(s), f);
+
+        _mm256_storeu_si256((__m256i *)&dst[4 * x], PackAVX2(lo, hi));
+    }
+    RGBXC(&dst[4 * x], &src[4 * x], map, alpha, count - x);
+}
+#endif
+
+/*****************************************************************************
+ * Advanced SIMD
+ *****************************************************************************/
+#if defined(__ARM_NEON)
+static inline bool IsZeroNEON(uint8x16_t v)
+{
+    const uint8x8_t r = vorr_u8(vget_low_u8(v), vget_high_u8(v));
+
+    return vget_lane_u64(vreinterpret_u64_u8(r), 0) == 0;
+}
+
+static inline uint8x8_t Div255NEON(uint16x8_t v)
+{
+    v = vaddq_u16(vsraq_n_u16(v, v, 8), vdupq_n_u16(1));
+    return vshrn_n_u16(v, 8);
+}
+
+static inline uint8x8_t MergeNEON(uint8x8_t d, uint8x8_t s, uint8x8_t f)
+{
+    return Div255NEON(vmlal_u8(vmull_u8(d, vmvn_u8(f)), s, f));
+}
+
+static inline uint8x16_t MergeQNEON(uint8x16_t d, uint8x16_t s, uint8x16_t f)
+{
+    return vcombine_u8(MergeNEON(vget_low_u8(d), vget_low_u8(s),
+                                 vget_low_u8(f)),
+                       MergeNEON(vget_high_u8(d), vget_high_u8(s),
+                                 vget_high_u8(f)));
+}
+
+static inline uint8x16_t FactorNEON(uint8x16_t a, uint8x8_t alpha)
+{
+    return vcombine_u8(Div255NEON(vmull_u8(vget_low_u8(a), alpha)),
+                       Div255NEON(vmull_u8(vget_high_u8(a), alpha)));
+}
+
+static void PlaneNEON(uint8_t *dst, const uint8_t *src, const uint8_t *a,
+                      unsigned alpha, unsigned count)
+{
+    const uint8x8_t va = vdup_n_u8(alpha);
+    unsigned x = 0;
+
+    for (; x + 16 <= count; x += 16) {
+        const uint8x16_t am = vld1q_u8(&a[x]);
+        if (IsZeroNEON(am))
+            continue;
+
+        vst1q_u8(&dst[x], MergeQNEON(vld1q_u8(&dst[x]), vld1q_u8(&src[x]),
+                                     FactorNEON(am, va)));
+    }
+    PlaneC(&dst[x], &src[x], &a[x], alpha, count - x);
+}
+
+static void ChromaNEON(uint8_t *du, uint8_t *dv, const uint8_t *su,
+                       const uint8_t *sv, const uint8_t *a,
+                       unsigned alpha, unsigned count)
+{
+    const uint8x8_t va = vdup_n_u8(alpha);
+    unsigned x = 0;
+
+    for (; x + 16 < count; x += 16) {
+        const uint8x16_t am = vld2q_u8(&a[2 * x]).val[0];
+        if (IsZeroNEON(am))
+            continue;
+
+        const uint8x16_t f = FactorNEON(am, va);
+
+        vst1q_u8(&du[x], MergeQNEON(vld1q_u8(&du[x]),
+                                    vld2q_u8(&su[2 * x]).val[0], f));
+        vst1q_u8(&dv[x], MergeQNEON(vld1q_u8(&dv[x]),
+                                    vld2q_u8(&sv[2 * x]).val[0], f));
+    }
+    ChromaC(&du[x], &dv[x], &su[2 * x], &sv[2 * x], &a[2 * x], alpha,
+            count - x);
+}
+
+static void ChromaSemiNEON(uint8_t *duv, const uint8_t *su, const uint8_t *sv,
+                           const uint8_t *a, unsigned alpha, unsigned count)
+{
+    const uint8x8_t va = vdup_n_u8(alpha);
+    unsigned x = 0;
+
+    for (; x + 16 < count; x += 16) {
+        const uint8x16_t am = vld2q_u8(&a[2 * x]).val[0];
+        if (IsZeroNEON(am))
+            continue;
+
+        const uint8x16_t f = FactorNEON(am, va);
+        uint8x16x2_t d = vld2q_u8(&duv[2 * x]);
+
+        d.val[0] = MergeQNEON(d.val[0], vld2q_u8(&su[2 * x]).val[0], f);
+        d.val[1] = MergeQNEON(d.val[1], vld2q_u8(&sv[2 * x]).val[0], f);
+        vst2q_u8(&duv[2 * x], d);
+    }
+    ChromaSemiC(&duv[2 * x], &su[2 * x], &sv[2 * x], &a[2 * x], alpha,
+                count - x);
+}
+
+static void RGBXNEON(uint8_t *dst, const uint8_t *src, const int8_t map[4],
+                     unsigned alpha, unsigned count)
+{
+    const uint8x16_t f = vdupq_n_u8(alpha);
+    unsigned x = 0;
+
+    for (; x + 16 <= count; x += 16) {
+        const uint8x16x4_t s = vld4q_u8(&src[4 * x]);
+        uint8x16x4_t d = vld4q_u8(&dst[4 * x]);
+
+        for (unsigned i = 0; i < 4; i++)
+            if (map[i] >= 0)
+                d.val[i] = MergeQNEON(d.val[i], s.val[map[i]], f);
+        vst4q_u8(&dst[4 * x], d);
+    }
+    RGBXC(&dst[4 * x], &src[4 * x], map, alpha, count - x);
+}
+#endif
+
+void BlendLineFunctionsInit(struct blend_line_functions *f)
+{
+    f->plane = PlaneC;
+    f->chroma = ChromaC;
+    f->chroma_semi = ChromaSemiC;
+    f->rgbx = RGBXC;
+
+#ifdef CAN_COMPILE_SSE4_1
+    if (vlc_CPU_SSE4_1()) {
+        f->plane = PlaneSSE4_1;
+        f->chroma = ChromaSSE4_1;
+        f->chroma_semi = ChromaSemiSSE4_1;
+        f->rgbx = RGBXSSE4_1;
+    }
+#endif
+#ifdef CAN_COMPILE_AVX2
+    if (vlc_CPU_AVX2()) {
+        f->plane = PlaneAVX2;
+        f->chroma = ChromaAVX2;
+        f->chroma_semi = ChromaSemiAVX2;
+        f->rgbx = RGBXAVX2;
+    }
+#endif
+#if defined(__ARM_NEON)
+    if (vlc_CPU_ARM_NEON()) {
+        f->plane = PlaneNEON;
+        f->chroma = ChromaNEON;
+        f->chroma_semi = ChromaSemiNEON;
+        f->rgbx = RGBXNEON;
+    }
+#endif
+}
@@ -0,0 +1,64 @@
+/*****************************************************************************
+ * blend_lines.h: optimized 8-bits alpha blending lines
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_BLEND_LINES_H
+#define VLC_BLEND_LINES_H 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Line blending functions.
+ *
+ * They all compute, for each sample, the same result as the generic blender:
+ * f = div255(alpha * a) and dst = div255((255 - f) * dst + src * f).
+ * Spans of fully transparent samples are skipped without touching dst.
+ */
+struct blend_line_functions
+{
+    /** Blends count samples of src weighted by a into dst */
+    void (*plane)(uint8_t *dst, const uint8_t *src, const uint8_t *a,
+                  unsigned alpha, unsigned count);
+    /** Blends count chroma samples into two planes, using the even samples
+     * of su, sv and a (4:4:4 source onto a horizontally subsampled plane) */
+    void (*chroma)(uint8_t *du, uint8_t *dv, const uint8_t *su,
+                   const uint8_t *sv, const uint8_t *a,
+                   unsigned alpha, unsigned count);
+    /** Same as chroma, into an interleaved (NV12) chroma plane */
+    void (*chroma_semi)(uint8_t *duv, const uint8_t *su, const uint8_t *sv,
+                        const uint8_t *a, unsigned alpha, unsigned count);
+    /** Blends count 32-bits pixels with a constant alpha. Byte i of each
+     * destination pixel is blended with byte map[i] of the source pixel,
+     * and left untouched if map[i] is negative. */
+    void (*rgbx)(uint8_t *dst, const uint8_t *src, const int8_t map[4],
+                 unsigned alpha, unsigned count);
+};
+
+/**
+ * Selects the fastest line blending functions for the running CPU.
+ */
+void BlendLineFunctionsInit(struct blend_line_functions *);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -41,6 +41,17 @@
  * Internal functions
  *****************************************************************************/
 
+/**
+ * Parameters of DarkenField(), shared by all slices.
+ */
+struct darken_slice
+{
+    picture_t *p_dst;
+    int i_field;
+    int i_strength;
+    bool process_chroma;
+};
+
 /**
  * Internal helper function: dims (darkens) the given field
  * of the given picture.
@@ -57,16 +68,22 @@
  *     filter strengths, especially for pixels whose U and/or V values are
  *     far away from the origin (which is at 128 in uint8 format).
  *
- * @param p_dst Input/output picture. Will be modified in-place.
- * @param i_field Darken which field? 0 = top, 1 = bottom.
- * @param i_strength Strength of effect: 1, 2 or 3 (division by 2, 4 or 8).
+ * This processes one slice of the field lines of each plane,
+ * see RenderSlices().
+ *
+ * @param opaque Darkening parameters (struct darken_slice).
+ * @param i_slice Slice index.
+ * @param i_slices Number of slices.
  * @see RenderPhosphor()
  * @see ComposeFrame()
  */
-static void DarkenField( picture_t *p_dst,
-                         const int i_field, const int i_strength,
-                         bool process_chroma )
+static void DarkenField( void *opaque, unsigned i_slice, unsigned i_slices )
 {
+    const struct darken_slice *ctx = opaque;
+    picture_t *p_dst = ctx->p_dst;
+    const int i_field = ctx->i_field;
+    const int i_strength = ctx->i_strength;
+
     assert( p_dst != NULL );
     assert( i_field == 0 || i_field == 1 );
     assert( i_strength >= 1 && i_strength <= 3 );
@@ -86,18 +103,19 @@ static void DarkenField( picture_t *p_dst,
     */
     int i_plane = Y_PLANE;
     uint8_t *p_out, *p_out_end;
+    int i_start, i_end;
     int w = p_dst->p[i_plane].i_visible_pitch;
-    p_out = p_dst->p[i_plane].p_pixels;
-    p_out_end = p_out + p_dst->p[i_plane].i_pitch
-                      * p_dst->p[i_plane].i_visible_lines;
+    int i_pitch = p_dst->p[i_plane].i_pitch;
 
-    /* skip first line for bottom field */
-    if( i_field == 1 )
-        p_out += p_dst->p[i_plane].i_pitch;
+    /* this slice of the field lines; bottom field skips the first line */
+    GetSliceLines( (p_dst->p[i_plane].i_visible_lines - i_field + 1) / 2,
+                   i_slice, i_slices, &i_start, &i_end );
+    p_out = p_dst->p[i_plane].p_pixels + (i_field + 2 * i_start) * i_pitch;
+    p_out_end = p_dst->p[i_plane].p_pixels + (i_field + 2 * i_end) * i_pitch;
 
     int wm8 = w % 8;   /* remainder */
     int w8  = w - wm8; /* part of width that is divisible by 8 */
-    for( ; p_out < p_out_end ; p_out += 2*p_dst->p[i_plane].i_pitch )
+    for( ; p_out < p_out_end ; p_out += 2*i_pitch )
     {
         uint64_t *po = (uint64_t *)p_out;
         int x = 0;
@@ -117,22 +135,24 @@ static void DarkenField( picture_t *p_dst,
        The chroma processing is a bit more complicated than luma,
        and needs SIMD for vectorization.
     */
-    if( process_chroma )
+    if( ctx->process_chroma )
     {
         for( i_plane++ /* luma already handled*/;
              i_plane < p_dst->i_planes;
              i_plane++ )
         {
             w = p_dst->p[i_plane].i_visible_pitch;
-            p_out = p_dst->p[i_plane].p_pixels;
-            p_out_end = p_out + p_dst->p[i_plane].i_pitch
-                              * p_dst->p[i_plane].i_visible_lines;
+            i_pitch = p_dst->p[i_plane].i_pitch;
 
-            /* skip first line for bottom field */
-            if( i_field == 1 )
-                p_out += p_dst->p[i_plane].i_pitch;
+            /* this slice of the field lines; bottom skips the first line */
+            GetSliceLines( (p_dst->p[i_plane].i_visible_lines + 1 - i_field)
+                           / 2, i_slice, i_slices, &i_start, &i_end );
+            p_out = p_dst->p[i_plane].p_pixels
+                  + (i_field + 2 * i_start) * i_pitch;
+            p_out_end = p_dst->p[i_plane].p_pixels
+                      + (i_field + 2 * i_end) * i_pitch;
 
-            for( ; p_out < p_out_end ; p_out += 2*p_dst->p[i_plane].i_pitch )
+            for( ; p_out < p_out_end ; p_out += 2*i_pitch )
             {
                 /* Handle the width remainder */
                 uint8_t *po = p_out;
@@ -229,9 +249,16 @@ int RenderPhosphor( filter_t *p_filter,
     */
     if( p_sys->phosphor.i_dimmer_strength > 0 )
     {
-            DarkenField( p_dst, !i_field, p_sys->phosphor.i_dimmer_strength,
+        struct darken_slice ctx = {
+            .p_dst = p_dst,
+            .i_field = !i_field,
+            .i_strength = p_sys->phosphor.i_dimmer_strength,
+            .process_chroma =
                 p_sys->chroma->p[1].h.num == p_sys->chroma->p[1].h.den &&
-                p_sys->chroma->p[2].h.num == p_sys->chroma->p[2].h.den );
+                p_sys->chroma->p[2].h.num == p_sys->chroma->p[2].h.den,
+        };
+
+        RenderSlices( p_filter, DarkenField, &ctx );
     }
     return VLC_SUCCESS;
 }
@@ -31,6 +31,7 @@
 #include <vlc_picture.h>
 
 #include "deinterlace.h" /* filter_sys_t */
+#include "helpers.h"     /* RenderSlices() */
 
 #include "algo_x.h"
 
@@ -295,9 +296,17 @@ static inline void XDeintBand8x8C( uint8_t *dst, int i_dst,
  * Public functions
  *****************************************************************************/
 
-int RenderX( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
+struct x_slice
+{
+    picture_t *p_outpic;
+    picture_t *p_pic;
+};
+
+static void RenderXSlice( void *opaque, unsigned i_slice, unsigned i_slices )
 {
-    VLC_UNUSED(p_filter);
+    const struct x_slice *ctx = opaque;
+    picture_t *p_outpic = ctx->p_outpic;
+    picture_t *p_pic = ctx->p_pic;
     int i_plane;
 
     /* Copy image and skip lines */
@@ -312,9 +321,12 @@ int RenderX( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
         const int i_dst = p_outpic->p[i_plane].i_pitch;
         const int i_src = p_pic->p[i_plane].i_pitch;
 
-        int y, x;
+        int y, x, y_start, y_end;
+
+        /* Each slice gets whole bands of 8 lines, the last band included */
+        GetSliceLines( i_mby + 1, i_slice, i_slices, &y_start, &y_end );
 
-        for( y = 0; y < i_mby; y++ )
+        for( y = y_start; y < y_end && y < i_mby; y++ )
         {
             uint8_t *dst = &p_outpic->p[i_plane].p_pixels[8*y*i_dst];
             uint8_t *src = &p_pic->p[i_plane].p_pixels[8*y*i_src];
@@ -323,7 +335,7 @@ int RenderX( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
         }
 
         /* Last line (C only)*/
-        if( i_mody )
+        if( i_mody && y == i_mby && y < y_end )
         {
             uint8_t *dst = &p_outpic->p[i_plane].p_pixels[8*y*i_dst];
             uint8_t *src = &p_pic->p[i_plane].p_pixels[8*y*i_src];
@@ -340,6 +352,12 @@ int RenderX( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
                 XDeintNxN( dst, i_dst, src, i_src, i_modx, i_mody );
         }
     }
+}
+
+int RenderX( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
+{
+    struct x_slice ctx = { p_outpic, p_pic };
 
+    RenderSlices( p_filter, RenderXSlice, &ctx );
     return VLC_SUCCESS;
 }
@@ -35,6 +35,8 @@
 
 #include "deinterlace.h" /* filter_sys_t  */
 #include "common.h"      /* FFMIN3 et al. */
+#include "helpers.h"     /* RenderSlices() */
+#include "merge.h"       /* yadif_cb, bwdif_cb */
 
 #include "algo_yadif.h"
 
@@ -46,16 +48,156 @@
    Necessary preprocessor macros are defined in common.h. */
 #include "yadif.h"
 
-int RenderYadifSingle( filter_t *p_filter, picture_t *p_dst, picture_t *p_src )
+/* bwdif.h comes from vf_bwdif.c of FFmpeg project. */
+#include "bwdif.h"
+
+/**
+ * Per-picture state shared by the slices of RenderYadif() and RenderBwdif().
+ */
+struct yadif_slice
 {
-    return RenderYadif( p_filter, p_dst, p_src, 0, 0 );
+    picture_t *p_dst;
+    picture_t *p_prev;
+    picture_t *p_cur;
+    picture_t *p_next;
+    int i_field;
+    int i_parity;
+    unsigned i_pixel_size;
+    int i_clip_max;
+    yadif_cb pf_yadif;
+    bwdif_cb pf_bwdif;
+};
+
+static void RenderYadifSlice( void *opaque, unsigned i_slice,
+                              unsigned i_slices )
+{
+    const struct yadif_slice *ctx = opaque;
+    picture_t *p_dst = ctx->p_dst;
+
+    for( int n = 0; n < p_dst->i_planes; n++ )
+    {
+        const plane_t *prevp = &ctx->p_prev->p[n];
+        const plane_t *curp  = &ctx->p_cur->p[n];
+        const plane_t *nextp = &ctx->p_next->p[n];
+        plane_t *dstp        = &p_dst->p[n];
+        const int w = dstp->i_visible_pitch / ctx->i_pixel_size;
+        int y_start, y_end;
+
+        /* The first and last lines are duplicated from their neighbours */
+        GetSliceLines( dstp->i_visible_lines - 2, i_slice, i_slices,
+                       &y_start, &y_end );
+
+        for( int y = 1 + y_start; y < 1 + y_end; y++ )
+        {
+            if( (y % 2) == ctx->i_field  ||  ctx->i_parity == 2 )
+            {
+                memcpy( &dstp->p_pixels[y * dstp->i_pitch],
+                            &curp->p_pixels[y * curp->i_pitch], dstp->i_visible_pitch );
+            }
+            else
+            {
+                int mode;
+                /* Spatial checks only when enough data */
+                mode = (y >= 2 && y < dstp->i_visible_lines - 2) ? 0 : 2;
+
+                assert( prevp->i_pitch == curp->i_pitch && curp->i_pitch == nextp->i_pitch );
+                ctx->pf_yadif( &dstp->p_pixels[y * dstp->i_pitch],
+                               &prevp->p_pixels[y * prevp->i_pitch],
+                               &curp->p_pixels[y * curp->i_pitch],
+                               &nextp->p_pixels[y * nextp->i_pitch],
+                               w,
+                               y < dstp->i_visible_lines - 2  ? curp->i_pitch : -curp->i_pitch,
+                               y  - 1  ?  -curp->i_pitch : curp->i_pitch,
+                               ctx->i_parity,
+                               mode );
+            }
+
+            /* We duplicate the first and last lines */
+            if( y == 1 )
+                memcpy(&dstp->p_pixels[(y-1) * dstp->i_pitch],
+                           &dstp->p_pixels[ y    * dstp->i_pitch],
+                           dstp->i_pitch);
+            else if( y == dstp->i_visible_lines - 2 )
+                memcpy(&dstp->p_pixels[(y+1) * dstp->i_pitch],
+                           &dstp->p_pixels[ y    * dstp->i_pitch],
+                           dstp->i_pitch);
+        }
+    }
 }
 
-int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
-                 int i_order, int i_field )
+static void RenderBwdifSlice( void *opaque, unsigned i_slice,
+                              unsigned i_slices )
 {
-    VLC_UNUSED(p_src);
+    const struct yadif_slice *ctx = opaque;
+    picture_t *p_dst = ctx->p_dst;
+
+    for( int n = 0; n < p_dst->i_planes; n++ )
+    {
+        const plane_t *prevp = &ctx->p_prev->p[n];
+        const plane_t *curp  = &ctx->p_cur->p[n];
+        const plane_t *nextp = &ctx->p_next->p[n];
+        plane_t *dstp        = &p_dst->p[n];
+        const int w = dstp->i_visible_pitch / ctx->i_pixel_size;
+        const int h = dstp->i_visible_lines;
+        /* Line offsets in pixels, as expected by the C filters */
+        const int refs = curp->i_pitch / ctx->i_pixel_size;
+        int y_start, y_end;
+
+        assert( prevp->i_pitch == curp->i_pitch && curp->i_pitch == nextp->i_pitch );
+        GetSliceLines( h, i_slice, i_slices, &y_start, &y_end );
+
+        for( int y = y_start; y < y_end; y++ )
+        {
+            uint8_t *dst        = &dstp->p_pixels[y * dstp->i_pitch];
+            const uint8_t *prev = &prevp->p_pixels[y * prevp->i_pitch];
+            const uint8_t *cur  = &curp->p_pixels[y * curp->i_pitch];
+            const uint8_t *next = &nextp->p_pixels[y * nextp->i_pitch];
+
+            if( (y % 2) == ctx->i_field  ||  ctx->i_parity == 2 )
+                memcpy( dst, cur, dstp->i_visible_pitch );
+            else if( y < 4 || y + 5 > h )
+            {
+                /* Not enough lines around for the full filter */
+                const int prefs = y + 1 < h ? refs : -refs;
+                const int mrefs = y > 0 ? -refs : refs;
+                const int spat  = !(y < 2 || y + 3 > h);
+
+                if( ctx->i_pixel_size == 1 )
+                    bwdif_filter_edge_c_8( dst, prev, cur, next, w,
+                                           prefs, mrefs, 2 * refs, -2 * refs,
+                                           ctx->i_parity, ctx->i_clip_max,
+                                           spat );
+                else
+                    bwdif_filter_edge_c_16( dst, prev, cur, next, w,
+                                            prefs, mrefs, 2 * refs, -2 * refs,
+                                            ctx->i_parity, ctx->i_clip_max,
+                                            spat );
+            }
+            else if( ctx->pf_bwdif != NULL )
+                ctx->pf_bwdif( dst, prev, cur, next, w, curp->i_pitch,
+                               ctx->i_parity );
+            else if( ctx->i_pixel_size == 1 )
+                bwdif_filter_line_c_8( dst, prev, cur, next, w,
+                                       refs, -refs, 2 * refs, -2 * refs,
+                                       3 * refs, -3 * refs, 4 * refs, -4 * refs,
+                                       ctx->i_parity, ctx->i_clip_max );
+            else
+                bwdif_filter_line_c_16( dst, prev, cur, next, w,
+                                        refs, -refs, 2 * refs, -2 * refs,
+                                        3 * refs, -3 * refs, 4 * refs, -4 * refs,
+                                        ctx->i_parity, ctx->i_clip_max );
+        }
+    }
+}
 
+/**
+ * Common part of RenderYadif() and RenderBwdif(): history and field
+ * repeat handling, CPU specific line filters selection, then rendering
+ * in slices.
+ */
+static int RenderMotionAdaptive( filter_t *p_filter, picture_t *p_dst,
+                                 int i_order, int i_field, bool b_bwdif )
+{
     filter_sys_t *p_sys = p_filter->p_sys;
 
     /* */
@@ -108,67 +250,49 @@ int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
     /* Filter if we have all the pictures we need */
     if( p_prev && p_cur && p_next )
     {
-        /* */
-        void (*filter)(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next,
-                       int w, int prefs, int mrefs, int parity, int mode);
+        struct yadif_slice ctx = {
+            .p_dst = p_dst,
+            .p_prev = p_prev,
+            .p_cur = p_cur,
+            .p_next = p_next,
+            .i_field = i_field,
+            .i_parity = yadif_parity,
+            .i_pixel_size = p_sys->chroma->pixel_size,
+            .i_clip_max = (1 << p_sys->chroma->pixel_bits) - 1,
+        };
 
+#if defined(CAN_COMPILE_AVX2)
+        if( vlc_CPU_AVX2() )
+        {
+            ctx.pf_yadif = yadif_filter_line_avx2;
+            ctx.pf_bwdif = bwdif_filter_line_avx2;
+        }
+        else
+#endif
 #if defined(HAVE_X86ASM)
         if( vlc_CPU_SSSE3() )
-            filter = vlcpriv_yadif_filter_line_ssse3;
+            ctx.pf_yadif = vlcpriv_yadif_filter_line_ssse3;
         else
         if( vlc_CPU_SSE2() )
-            filter = vlcpriv_yadif_filter_line_sse2;
+            ctx.pf_yadif = vlcpriv_yadif_filter_line_sse2;
         else
 #endif
-            filter = yadif_filter_line_c;
+        {
+            ctx.pf_yadif = p_sys->pf_yadif;
+            ctx.pf_bwdif = p_sys->pf_bwdif;
+        }
+        if( ctx.pf_yadif == NULL )
+            ctx.pf_yadif = yadif_filter_line_c;
 
         if( p_sys->chroma->pixel_size == 2 )
-            filter = yadif_filter_line_c_16bit;
-
-        for( int n = 0; n < p_dst->i_planes; n++ )
         {
-            const plane_t *prevp = &p_prev->p[n];
-            const plane_t *curp  = &p_cur->p[n];
-            const plane_t *nextp = &p_next->p[n];
-            plane_t *dstp        = &p_dst->p[n];
-
-            for( int y = 1; y < dstp->i_visible_lines - 1; y++ )
-            {
-                if( (y % 2) == i_field  ||  yadif_parity == 2 )
-                {
-                    memcpy( &dstp->p_pixels[y * dstp->i_pitch],
-                                &curp->p_pixels[y * curp->i_pitch], dstp->i_visible_pitch );
-                }
-                else
-                {
-                    int mode;
-                    /* Spatial checks only when enough data */
-                    mode = (y >= 2 && y < dstp->i_visible_lines - 2) ? 0 : 2;
-
-                    assert( prevp->i_pitch == curp->i_pitch && curp->i_pitch == nextp->i_pitch );
-                    filter( &dstp->p_pixels[y * dstp->i_pitch],
-                            &prevp->p_pixels[y * prevp->i_pitch],
-                            &curp->p_pixels[y * curp->i_pitch],
-                            &nextp->p_pixels[y * nextp->i_pitch],
-                            dstp->i_visible_pitch,
-                            y < dstp->i_visible_lines - 2  ? curp->i_pitch : -curp->i_pitch,
-                            y  - 1  ?  -curp->i_pitch : curp->i_pitch,
-                            yadif_parity,
-                            mode );
-                }
-
-                /* We duplicate the first and last lines */
-                if( y == 1 )
-                    memcpy(&dstp->p_pixels[(y-1) * dstp->i_pitch],
-                               &dstp->p_pixels[ y    * dstp->i_pitch],
-                               dstp->i_pitch);
-                else if( y == dstp->i_visible_lines - 2 )
-                    memcpy(&dstp->p_pixels[(y+1) * dstp->i_pitch],
-                               &dstp->p_pixels[ y    * dstp->i_pitch],
-                               dstp->i_pitch);
-            }
+            ctx.pf_yadif = yadif_filter_line_c_16bit;
+            ctx.pf_bwdif = NULL;
         }
 
+        RenderSlices( p_filter, b_bwdif ? RenderBwdifSlice : RenderYadifSlice,
+                      &ctx );
+
         p_sys->context.i_frame_offset = 1; /* p_cur will be rendered at next frame, too */
 
         return VLC_SUCCESS;
@@ -189,3 +313,27 @@ int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
         return VLC_EGENERIC;
     }
 }
+
+int RenderYadifSingle( filter_t *p_filter, picture_t *p_dst, picture_t *p_src )
+{
+    return RenderYadif( p_filter, p_dst, p_src, 0, 0 );
+}
+
+int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
+                 int i_order, int i_field )
+{
+    VLC_UNUSED(p_src);
+    return RenderMotionAdaptive( p_filter, p_dst, i_order, i_field, false );
+}
+
+int RenderBwdifSingle( filter_t *p_filter, picture_t *p_dst, picture_t *p_src )
+{
+    return RenderBwdif( p_filter, p_dst, p_src, 0, 0 );
+}
+
+int RenderBwdif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
+                 int i_order, int i_field )
+{
+    VLC_UNUSED(p_src);
+    return RenderMotionAdaptive( p_filter, p_dst, i_order, i_field, true );
+}
@@ -26,8 +26,9 @@
 
 /**
  * \file
- * Adapter to fit the Yadif (Yet Another DeInterlacing Filter) algorithm
- * from FFmpeg into VLC. The algorithm itself is implemented in yadif.h.
+ * Adapter to fit the Yadif (Yet Another DeInterlacing Filter) and Bwdif
+ * algorithms from FFmpeg into VLC. The algorithms themselves are implemented
+ * in yadif.h and bwdif.h.
  */
 
 /* Forward declarations */
@@ -90,4 +91,30 @@ int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
  */
 int RenderYadifSingle( filter_t *p_filter, picture_t *p_dst, picture_t *p_src );
 
+/**
+ * Bwdif (BobWeaver DeInterlacing Filter) from FFmpeg.
+ *
+ * This is a variant of Yadif using the interpolation filters of the Weston
+ * 3-field deinterlacer, and a simpler spatial check. It is used in exactly
+ * the same way as RenderYadif(), with the same frame history, startup and
+ * soft field repeat handling.
+ *
+ * @param p_filter The filter instance. Must be non-NULL.
+ * @param p_dst Output frame. Must be allocated by caller.
+ * @param p_src Input frame. Must exist.
+ * @param i_order Temporal field number: 0 = first, 1 = second, 2 = rep. first.
+ * @param i_field Keep which field? 0 = top field, 1 = bottom field.
+ * @return VLC error code (int).
+ * @retval VLC_SUCCESS The requested field was rendered into p_dst.
+ * @retval VLC_EGENERIC Frame dropped; only occurs at the second frame after start.
+ * @see RenderYadif()
+ */
+int RenderBwdif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
+                 int i_order, int i_field );
+
+/**
+ * Same as RenderBwdif() but with no temporal references
+ */
+int RenderBwdifSingle( filter_t *p_filter, picture_t *p_dst, picture_t *p_src );
+
 #endif
@@ -282,6 +282,10 @@ static int Mouse( filter_t *p_filter,
                                     "Best simulation, but requires more CPU "\
                                     "and memory bandwidth.")
 
+#define THREADS_TEXT N_("Threads")
+#define THREADS_LONGTEXT N_("Number of threads used by the X, Yadif, " \
+                            "Bwdif and Phosphor modes (0 = automatic).")
+
 #define PHOSPHOR_DIMMER_TEXT N_("Phosphor old field dimmer strength")
 #define PHOSPHOR_DIMMER_LONGTEXT N_("This controls the strength of the "\
                                     "darkening filter that simulates CRT TV "\
@@ -298,6 +302,9 @@ vlc_module_begin ()
                 SOUT_MODE_LONGTEXT )
         change_string_list( mode_list, mode_list_text )
         change_safe ()
+    add_integer_with_range( FILTER_CFG_PREFIX "threads", 0,
+                            0, DEINTERLACE_MAX_THREADS,
+                            THREADS_TEXT, THREADS_LONGTEXT )
     add_integer( FILTER_CFG_PREFIX "phosphor-chroma", 2, PHOSPHOR_CHROMA_TEXT,
                 PHOSPHOR_CHROMA_LONGTEXT )
         change_integer_list( phosphor_chroma_list, phosphor_chroma_list_text )
@@ -320,7 +327,7 @@ vlc_module_end ()
  * and reading logic for them implemented in Open().
  */
 static const char *const ppsz_filter_options[] = {
-    "mode", "phosphor-chroma", "phosphor-dimmer",
+    "mode", "threads", "phosphor-chroma", "phosphor-dimmer",
     NULL
 };
 
@@ -339,6 +346,7 @@ struct filter_mode_t
     deinterlace_algo     settings;
     bool                 can_pack;         /**< can handle packed pixel */
     bool                 b_high_bit_depth; /**< can handle high bit depth */
+    bool                 can_slice;        /**< renders in parallel slices */
 };
 static struct filter_mode_t filter_mode [] = {
     { "discard", .pf_render_single_pic = RenderDiscard,
@@ -354,13 +362,17 @@ static struct filter_mode_t filter_mode [] = {
     { "blend", .pf_render_single_pic = RenderBlend,
                  { false, false, false, false }, true, true },
     { "yadif", .pf_render_single_pic = RenderYadifSingle,
-                 { false, true, false, false }, false, true },
+                 { false, true, false, false }, false, true, true },
     { "yadif2x", .pf_render_ordered = RenderYadif,
-                 { true, true, false, false }, false, true },
+                 { true, true, false, false }, false, true, true },
+    { "bwdif", .pf_render_single_pic = RenderBwdifSingle,
+                 { false, true, false, false }, false, true, true },
+    { "bwdif2x", .pf_render_ordered = RenderBwdif,
+                 { true, true, false, false }, false, true, true },
     { "x", .pf_render_single_pic = RenderX,
-                 { false, false, false, false }, false, false },
+                 { false, false, false, false }, false, false, true },
     { "phosphor", .pf_render_ordered = RenderPhosphor,
-                 { true, true, false, false }, false, false },
+                 { true, true, false, false }, false, false, true },
     { "ivtc", .pf_render_single_pic = RenderIVTC,
                  { false, true, true, false }, false, false },
 };
@@ -372,9 +384,12 @@ static struct filter_mode_t filter_mode [] = {
  *
  * @param p_filter The filter instance.
  * @param mode Desired method. See mode_list for available choices.
+ * @param pack Whether the input is a packed format.
+ * @param[out] can_slice Whether the method renders in parallel slices.
  * @see mode_list
  */
-static int SetFilterMethod( filter_t *p_filter, const char *mode, bool pack )
+static int SetFilterMethod( filter_t *p_filter, const char *mode, bool pack,
+                            bool *can_slice )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
 
@@ -389,18 +404,19 @@ static int SetFilterMethod( filter_t *p_filter, const char *mode, bool pack )
             {
                 msg_Err( p_filter, "unknown or incompatible deinterlace mode \"%s\""
                         " for packed format", mode );
-                return SetFilterMethod( p_filter, "blend", pack );
+                return SetFilterMethod( p_filter, "blend", pack, can_slice );
             }
             if( p_sys->chroma->pixel_size > 1 && !filter_mode[i].b_high_bit_depth )
             {
                 msg_Err( p_filter, "unknown or incompatible deinterlace mode \"%s\""
                         " for high depth format", mode );
-                return SetFilterMethod( p_filter, "blend", pack );
+                return SetFilterMethod( p_filter, "blend", pack, can_slice );
             }
 
             msg_Dbg( p_filter, "using %s deinterlace method", mode );
             p_sys->context.settings = filter_mode[i].settings;
             p_sys->context.pf_render_ordered = filter_mode[i].pf_render_ordered;
+            *can_slice = filter_mode[i].can_slice;
             return VLC_SUCCESS;
         }
     }
@@ -479,8 +495,13 @@ int Mouse( filter_t *p_filter,
  */
 static void Close( filter_t *p_filter )
 {
+    filter_sys_t *p_sys = p_filter->p_sys;
+
     Flush( p_filter );
-    free( p_filter->p_sys );
+    if( p_sys->executor != NULL )
+        vlc_executor_Delete( p_sys->executor );
+    vlc_CPUBudgetRelease( p_sys->i_budget );
+    free( p_sys );
 }
 
 static const struct vlc_filter_operations filter_ops = {
@@ -491,7 +512,7 @@ static const struct vlc_filter_operations filter_ops = {
 };
 
 static struct deinterlace_functions funcs = {
-    { Merge8BitGeneric, Merge16BitGeneric, },
+    { Merge8BitGeneric, Merge16BitGeneric, }, NULL, NULL,
 };
 
 /*****************************************************************************
@@ -538,13 +559,17 @@ notsupp:
         return VLC_ENOMEM;
 
     p_sys->chroma = chroma;
+    p_sys->executor = NULL;
+    p_sys->i_slices = 1;
+    p_sys->i_budget = 0;
 
     InitDeinterlacingContext( &p_sys->context );
 
     config_ChainParse( p_filter, FILTER_CFG_PREFIX, ppsz_filter_options,
                        p_filter->p_cfg );
     char *psz_mode = var_InheritString( p_filter, FILTER_CFG_PREFIX "mode" );
-    int ret = SetFilterMethod( p_filter, psz_mode, packed );
+    bool can_slice;
+    int ret = SetFilterMethod( p_filter, psz_mode, packed, &can_slice );
     if (ret != VLC_SUCCESS)
     {
         free(psz_mode);
@@ -554,6 +579,34 @@ notsupp:
 
     IVTCClearState( p_filter );
 
+    /* Render in slices on worker threads, the filter thread included */
+    if( can_slice )
+    {
+        unsigned i_threads = var_GetInteger( p_filter,
+                                             FILTER_CFG_PREFIX "threads" );
+        if( i_threads == 0 )
+        {
+            p_sys->i_budget = vlc_CPUBudgetAcquire( DEINTERLACE_MAX_THREADS );
+            i_threads = p_sys->i_budget;
+        }
+        if( i_threads > DEINTERLACE_MAX_THREADS )
+            i_threads = DEINTERLACE_MAX_THREADS;
+
+        if( i_threads > 1 )
+        {
+            p_sys->executor = vlc_executor_New( i_threads - 1 );
+            if( p_sys->executor != NULL )
+                p_sys->i_slices = i_threads;
+            else
+                msg_Warn( p_filter, "cannot create worker threads" );
+        }
+        msg_Dbg( p_filter, "rendering in %u slice(s)", p_sys->i_slices );
+    }
+
+    vlc_CPU_functions_init_once("deinterlace functions", &funcs);
+    p_sys->pf_yadif = funcs.yadif;
+    p_sys->pf_bwdif = funcs.bwdif;
+
 #if defined(CAN_COMPILE_C_ALTIVEC)
     if( pixel_size == 1 && vlc_CPU_ALTIVEC() )
         p_sys->pf_merge = MergeAltivec;
@@ -568,7 +621,6 @@ notsupp:
     else
 #endif
     {
-        vlc_CPU_functions_init_once("deinterlace functions", &funcs);
         p_sys->pf_merge = funcs.merges[stdc_trailing_zeros(pixel_size)];
 #if defined(__i386__) || defined(__x86_64__)
         p_sys->pf_end_merge = NULL;
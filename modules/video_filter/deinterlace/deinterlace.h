@@ -34,6 +34,7 @@ struct vlc_object_t;
 
 #include <vlc_common.h>
 #include <vlc_mouse.h>
+#include <vlc_executor.h>
 
 /* Local algorithm headers */
 #include "algo_basic.h"
@@ -50,12 +51,16 @@ struct vlc_object_t;
 /** Available deinterlace modes. */
 static const char *const mode_list[] = {
     "discard", "blend", "mean", "bob", "linear", "x",
-    "yadif", "yadif2x", "phosphor", "ivtc" };
+    "yadif", "yadif2x", "bwdif", "bwdif2x", "phosphor", "ivtc" };
 
 /** User labels for the available deinterlace modes. */
 static const char *const mode_list_text[] = {
     N_("Discard"), N_("Blend"), N_("Mean"), N_("Bob"), N_("Linear"), "X",
-    "Yadif", "Yadif (2x)", N_("Phosphor"), N_("Film NTSC (IVTC)") };
+    "Yadif", "Yadif (2x)", "Bwdif", "Bwdif (2x)", N_("Phosphor"),
+    N_("Film NTSC (IVTC)") };
+
+/** Maximum number of slices rendered in parallel. */
+#define DEINTERLACE_MAX_THREADS 16
 
 /*****************************************************************************
  * Data structures
@@ -74,6 +79,16 @@ typedef struct
     /** Merge finalization routine for SSE */
     void (*pf_end_merge) ( void );
 #endif
+    /** Yadif and Bwdif line routines from CPU plugins, or NULL */
+    void (*pf_yadif) ( uint8_t *, uint8_t *, uint8_t *, uint8_t *,
+                       int, int, int, int, int );
+    void (*pf_bwdif) ( uint8_t *, const uint8_t *, const uint8_t *,
+                       const uint8_t *, int, ptrdiff_t, int );
+
+    /** Worker threads for the sliced algorithms, or NULL */
+    vlc_executor_t *executor;
+    unsigned i_slices; /**< Number of slices per picture */
+    unsigned i_budget; /**< Threads taken from the CPU budget */
 
     struct deinterlace_ctx   context;
 
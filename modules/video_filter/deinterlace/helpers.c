@@ -452,3 +452,53 @@ int CalculateInterlaceScore( const picture_t* p_pic_top,
     return i_score;
 }
 #undef T
+
+/*****************************************************************************
+ * Slice threading
+ *****************************************************************************/
+
+struct slice_task
+{
+    struct vlc_runnable runnable;
+    void (*pf_slice)( void *opaque, unsigned i_slice, unsigned i_slices );
+    void *opaque;
+    unsigned i_slice;
+    unsigned i_slices;
+};
+
+static void RunSlice( void *data )
+{
+    struct slice_task *task = data;
+
+    task->pf_slice( task->opaque, task->i_slice, task->i_slices );
+}
+
+/* See header for function doc. */
+void RenderSlices( filter_t *p_filter,
+                   void (*pf_slice)( void *opaque, unsigned i_slice,
+                                     unsigned i_slices ),
+                   void *opaque )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const unsigned i_slices = p_sys->executor != NULL ? p_sys->i_slices : 1;
+    struct slice_task tasks[DEINTERLACE_MAX_THREADS];
+
+    assert( i_slices >= 1 && i_slices <= DEINTERLACE_MAX_THREADS );
+
+    /* The calling thread renders the first slice itself */
+    for( unsigned i = 1; i < i_slices; i++ )
+    {
+        tasks[i].runnable.run = RunSlice;
+        tasks[i].runnable.userdata = &tasks[i];
+        tasks[i].pf_slice = pf_slice;
+        tasks[i].opaque = opaque;
+        tasks[i].i_slice = i;
+        tasks[i].i_slices = i_slices;
+        vlc_executor_Submit( p_sys->executor, &tasks[i].runnable );
+    }
+
+    pf_slice( opaque, 0, i_slices );
+
+    if( i_slices > 1 )
+        vlc_executor_WaitIdle( p_sys->executor );
+}
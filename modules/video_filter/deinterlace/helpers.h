@@ -165,4 +165,42 @@ int EstimateNumBlocksWithMotion( const picture_t* p_prev,
 int CalculateInterlaceScore( const picture_t* p_pic_top,
                              const picture_t* p_pic_bot );
 
+/**
+ * Helper function: renders a picture in horizontal slices.
+ *
+ * The callback is invoked once for each slice, with the slice index and the
+ * total number of slices. It must only write the lines belonging to its
+ * slice. The slices run in parallel on the worker threads of the filter,
+ * if any; the function returns once all of them are done.
+ *
+ * @param p_filter The filter instance.
+ * @param pf_slice Slice rendering callback.
+ * @param opaque Data for the callback.
+ * @see RenderX()
+ * @see RenderYadif()
+ */
+void RenderSlices( filter_t *p_filter,
+                   void (*pf_slice)( void *opaque, unsigned i_slice,
+                                     unsigned i_slices ),
+                   void *opaque );
+
+/**
+ * Helper function: computes the lines of a slice.
+ *
+ * Splits i_lines lines in i_slices slices of about the same size.
+ *
+ * @param i_lines Number of lines to split.
+ * @param i_slice Slice index.
+ * @param i_slices Number of slices.
+ * @param[out] pi_start First line of the slice.
+ * @param[out] pi_end Line after the last line of the slice.
+ */
+static inline void GetSliceLines( int i_lines, unsigned i_slice,
+                                  unsigned i_slices,
+                                  int *pi_start, int *pi_end )
+{
+    *pi_start = (int64_t)i_lines * i_slice / i_slices;
+    *pi_end   = (int64_t)i_lines * (i_slice + 1) / i_slices;
+}
+
 #endif
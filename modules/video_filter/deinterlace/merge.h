@@ -49,6 +49,46 @@
 
 typedef void (*merge_cb)(void *d, const void *s1, const void *s2, size_t len);
 
+/**
+ * Interpolate one 8-bit line with Yadif.
+ *
+ * This callback shall behave exactly as the C filter from yadif.h.
+ * It may process the line in whole vectors, and thus write some pixels past
+ * the given width, within the padding of the picture.
+ *
+ * \param dst Output line
+ * \param prev Same line of the previous frame
+ * \param cur Same line of the current frame
+ * \param next Same line of the next frame
+ * \param w width in pixels
+ * \param prefs offset in bytes to the line below
+ * \param mrefs offset in bytes to the line above
+ * \param parity which fields to use for temporal prediction
+ * \param mode 0 for full spatial checks, 2 near the picture edges
+ */
+typedef void (*yadif_cb)(uint8_t *dst, uint8_t *prev, uint8_t *cur,
+                         uint8_t *next, int w, int prefs, int mrefs,
+                         int parity, int mode);
+
+/**
+ * Interpolate one 8-bit line with Bwdif.
+ *
+ * This callback shall behave exactly as the C filter from bwdif.h, for a
+ * line with at least 4 lines above and below it. The same padding rules as
+ * for \ref yadif_cb apply.
+ *
+ * \param dst Output line
+ * \param prev Same line of the previous frame
+ * \param cur Same line of the current frame
+ * \param next Same line of the next frame
+ * \param w width in pixels
+ * \param stride offset in bytes between two lines
+ * \param parity which fields to use for temporal prediction
+ */
+typedef void (*bwdif_cb)(uint8_t *dst, const uint8_t *prev,
+                         const uint8_t *cur, const uint8_t *next, int w,
+                         ptrdiff_t stride, int parity);
+
 /**
  * Deinterlacing optimisation callbacks.
  */
@@ -58,6 +98,10 @@ struct deinterlace_functions {
      * The first array entries are indexed by the binary order of magnitude
      * of the element size in bytes: 0 for 8-bit, 1 for 16-bit. */
     merge_cb merges[2];
+    /** Yadif line interpolation, NULL for the C version */
+    yadif_cb yadif;
+    /** Bwdif line interpolation, NULL for the C version */
+    bwdif_cb bwdif;
 };
 
 /*****************************************************************************
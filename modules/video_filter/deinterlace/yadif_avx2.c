@@ -0,0 +1,308 @@
+/*****************************************************************************
+ * yadif_avx2.c : AVX2 Yadif and Bwdif line filters
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <immintrin.h>
+
+#include <vlc_common.h>
+
+#define VLC_TARGET __attribute__ ((__target__ ("avx2")))
+
+/* The filters work on 16 pixels at a time, widened to 16-bit (or 32-bit for
+ * Bwdif) so that no lane crossing shuffle is needed. They behave exactly as
+ * the C filters from yadif.h and bwdif.h, but process the lines in blocks of
+ * 32 pixels (16 for Bwdif), writing past the width into the picture padding
+ * like the SSE2 version. */
+
+VLC_TARGET
+static inline __m256i Load16(const uint8_t *p)
+{
+    return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)p));
+}
+
+VLC_TARGET
+static inline __m256i AbsDiff16(__m256i a, __m256i b)
+{
+    return _mm256_abs_epi16(_mm256_sub_epi16(a, b));
+}
+
+VLC_TARGET
+static inline __m256i Avg16(__m256i a, __m256i b)
+{
+    return _mm256_srli_epi16(_mm256_add_epi16(a, b), 1);
+}
+
+/* Packs two vectors of 16 words to 32 bytes, in order */
+VLC_TARGET
+static inline __m256i Pack16(__m256i lo, __m256i hi)
+{
+    return _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi),
+                                    _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+/*****************************************************************************
+ * Yadif
+ *****************************************************************************/
+
+/**
+ * Spatial check with the offset j: updates the score and prediction
+ * in the lanes where the score is lower, and returns these lanes.
+ */
+VLC_TARGET
+static inline __m256i YadifCheck(const uint8_t *cur, int mrefs, int prefs,
+                                 int j, __m256i *score, __m256i *pred,
+                                 __m256i mask)
+{
+    __m256i s = _mm256_add_epi16(
+        _mm256_add_epi16(AbsDiff16(Load16(cur + mrefs - 1 + j),
+                                   Load16(cur + prefs - 1 - j)),
+                         AbsDiff16(Load16(cur + mrefs + j),
+                                   Load16(cur + prefs - j))),
+        AbsDiff16(Load16(cur + mrefs + 1 + j), Load16(cur + prefs + 1 - j)));
+    __m256i p = Avg16(Load16(cur + mrefs + j), Load16(cur + prefs - j));
+
+    mask = _mm256_and_si256(mask, _mm256_cmpgt_epi16(*score, s));
+    *score = _mm256_blendv_epi8(*score, s, mask);
+    *pred = _mm256_blendv_epi8(*pred, p, mask);
+    return mask;
+}
+
+VLC_TARGET
+static inline __m256i Yadif16(const uint8_t *prev, const uint8_t *cur,
+                              const uint8_t *next, const uint8_t *prev2,
+                              const uint8_t *next2, int prefs, int mrefs,
+                              int mode)
+{
+    const __m256i ones = _mm256_set1_epi16(-1);
+    __m256i c = Load16(cur + mrefs);
+    __m256i e = Load16(cur + prefs);
+    __m256i p2 = Load16(prev2);
+    __m256i n2 = Load16(next2);
+    __m256i d = Avg16(p2, n2);
+
+    __m256i td0 = AbsDiff16(p2, n2);
+    __m256i td1 = _mm256_srli_epi16(
+        _mm256_add_epi16(AbsDiff16(Load16(prev + mrefs), c),
+                         AbsDiff16(Load16(prev + prefs), e)), 1);
+    __m256i td2 = _mm256_srli_epi16(
+        _mm256_add_epi16(AbsDiff16(Load16(next + mrefs), c),
+                         AbsDiff16(Load16(next + prefs), e)), 1);
+    __m256i diff = _mm256_max_epi16(_mm256_srli_epi16(td0, 1),
+                                    _mm256_max_epi16(td1, td2));
+
+    __m256i pred = Avg16(c, e);
+    __m256i score = _mm256_add_epi16(
+        _mm256_add_epi16(AbsDiff16(Load16(cur + mrefs - 1),
+                                   Load16(cur + prefs - 1)),
+                         AbsDiff16(c, e)),
+        _mm256_add_epi16(AbsDiff16(Load16(cur + mrefs + 1),
+                                   Load16(cur + prefs + 1)), ones));
+    __m256i mask;
+
+    mask = YadifCheck(cur, mrefs, prefs, -1, &score, &pred, ones);
+    YadifCheck(cur, mrefs, prefs, -2, &score, &pred, mask);
+    mask = YadifCheck(cur, mrefs, prefs, 1, &score, &pred, ones);
+    YadifCheck(cur, mrefs, prefs, 2, &score, &pred, mask);
+
+    if (mode < 2)
+    {
+        __m256i b = Avg16(Load16(prev2 + 2 * mrefs), Load16(next2 + 2 * mrefs));
+        __m256i f = Avg16(Load16(prev2 + 2 * prefs), Load16(next2 + 2 * prefs));
+        __m256i bc = _mm256_sub_epi16(b, c);
+        __m256i fe = _mm256_sub_epi16(f, e);
+        __m256i de = _mm256_sub_epi16(d, e);
+        __m256i dc = _mm256_sub_epi16(d, c);
+        __m256i max = _mm256_max_epi16(_mm256_max_epi16(de, dc),
+                                       _mm256_min_epi16(bc, fe));
+        __m256i min = _mm256_min_epi16(_mm256_min_epi16(de, dc),
+                                       _mm256_max_epi16(bc, fe));
+
+        diff = _mm256_max_epi16(diff, _mm256_max_epi16(min,
+                                       _mm256_sub_epi16(_mm256_setzero_si256(),
+                                                        max)));
+    }
+
+    pred = _mm256_max_epi16(pred, _mm256_sub_epi16(d, diff));
+    return _mm256_min_epi16(pred, _mm256_add_epi16(d, diff));
+}
+
+VLC_TARGET
+void yadif_filter_line_avx2(uint8_t *dst, uint8_t *prev, uint8_t *cur,
+                            uint8_t *next, int w, int prefs, int mrefs,
+                            int parity, int mode)
+{
+    const uint8_t *prev2 = parity ? prev : cur;
+    const uint8_t *next2 = parity ? cur : next;
+
+    for (int x = 0; x < w; x += 32)
+    {
+        __m256i lo = Yadif16(prev + x, cur + x, next + x, prev2 + x,
+                             next2 + x, prefs, mrefs, mode);
+        __m256i hi = Yadif16(prev + x + 16, cur + x + 16, next + x + 16,
+                             prev2 + x + 16, next2 + x + 16, prefs, mrefs,
+                             mode);
+
+        _mm256_storeu_si256((__m256i *)(dst + x), Pack16(lo, hi));
+    }
+}
+
+/*****************************************************************************
+ * Bwdif
+ *****************************************************************************/
+
+/* Filter coefficients, see bwdif.h */
+#define COEF_LF0 4309
+#define COEF_LF1  213
+#define COEF_HF0 5570
+#define COEF_HF1 3801
+#define COEF_HF2 1016
+#define COEF_SP0 5077
+#define COEF_SP1  981
+
+/* Sum of the same pixels of two lines, as 32-bit integers */
+VLC_TARGET
+static inline __m256i Sum32(const uint8_t *a, const uint8_t *b)
+{
+    __m256i va = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)a));
+    __m256i vb = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)b));
+
+    return _mm256_add_epi32(va, vb);
+}
+
+/* Interpolations of 8 pixels, packed to 16-bit */
+VLC_TARGET
+static inline __m256i BwdifInterpolate8(const uint8_t *cur,
+                                        const uint8_t *prev2,
+                                        const uint8_t *next2,
+                                        ptrdiff_t stride, __m256i *spatial)
+{
+    const ptrdiff_t s = stride;
+    __m256i ce = Sum32(cur - s, cur + s);
+    __m256i cur3 = Sum32(cur - 3 * s, cur + 3 * s);
+    __m256i hf = _mm256_sub_epi32(
+        _mm256_mullo_epi32(Sum32(prev2, next2), _mm256_set1_epi32(COEF_HF0)),
+        _mm256_mullo_epi32(_mm256_add_epi32(Sum32(prev2 - 2 * s,
+                                                  next2 - 2 * s),
+                                            Sum32(prev2 + 2 * s,
+                                                  next2 + 2 * s)),
+                           _mm256_set1_epi32(COEF_HF1)));
+
+    hf = _mm256_add_epi32(hf,
+        _mm256_mullo_epi32(_mm256_add_epi32(Sum32(prev2 - 4 * s,
+                                                  next2 - 4 * s),
+                                            Sum32(prev2 + 4 * s,
+                                                  next2 + 4 * s)),
+                           _mm256_set1_epi32(COEF_HF2)));
+    hf = _mm256_add_epi32(_mm256_srai_epi32(hf, 2),
+        _mm256_sub_epi32(_mm256_mullo_epi32(ce, _mm256_set1_epi32(COEF_LF0)),
+                         _mm256_mullo_epi32(cur3,
+                                            _mm256_set1_epi32(COEF_LF1))));
+    hf = _mm256_srai_epi32(hf, 13);
+
+    __m256i sp = _mm256_sub_epi32(
+        _mm256_mullo_epi32(ce, _mm256_set1_epi32(COEF_SP0)),
+        _mm256_mullo_epi32(cur3, _mm256_set1_epi32(COEF_SP1)));
+    sp = _mm256_srai_epi32(sp, 13);
+
+    /* Both results are in range of signed words */
+    *spatial = _mm256_permute4x64_epi64(_mm256_packs_epi32(sp, sp),
+                                        _MM_SHUFFLE(3, 1, 2, 0));
+    return _mm256_permute4x64_epi64(_mm256_packs_epi32(hf, hf),
+                                    _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+VLC_TARGET
+static inline __m256i Bwdif16(const uint8_t *prev, const uint8_t *cur,
+                              const uint8_t *next, const uint8_t *prev2,
+                              const uint8_t *next2, ptrdiff_t stride)
+{
+    const ptrdiff_t s = stride;
+    __m256i c = Load16(cur - s);
+    __m256i e = Load16(cur + s);
+    __m256i p2 = Load16(prev2);
+    __m256i n2 = Load16(next2);
+    __m256i d = Avg16(p2, n2);
+
+    __m256i td0 = AbsDiff16(p2, n2);
+    __m256i td1 = _mm256_srli_epi16(
+        _mm256_add_epi16(AbsDiff16(Load16(prev - s), c),
+                         AbsDiff16(Load16(prev + s), e)), 1);
+    __m256i td2 = _mm256_srli_epi16(
+        _mm256_add_epi16(AbsDiff16(Load16(next - s), c),
+                         AbsDiff16(Load16(next + s), e)), 1);
+    __m256i diff = _mm256_max_epi16(_mm256_srli_epi16(td0, 1),
+                                    _mm256_max_epi16(td1, td2));
+    __m256i still = _mm256_cmpeq_epi16(diff, _mm256_setzero_si256());
+
+    /* Spatial check */
+    __m256i b = _mm256_sub_epi16(Avg16(Load16(prev2 - 2 * s),
+                                       Load16(next2 - 2 * s)), c);
+    __m256i f = _mm256_sub_epi16(Avg16(Load16(prev2 + 2 * s),
+                                       Load16(next2 + 2 * s)), e);
+    __m256i dc = _mm256_sub_epi16(d, c);
+    __m256i de = _mm256_sub_epi16(d, e);
+    __m256i max = _mm256_max_epi16(_mm256_max_epi16(de, dc),
+                                   _mm256_min_epi16(b, f));
+    __m256i min = _mm256_min_epi16(_mm256_min_epi16(de, dc),
+                                   _mm256_max_epi16(b, f));
+
+    diff = _mm256_max_epi16(diff, _mm256_max_epi16(min,
+                                   _mm256_sub_epi16(_mm256_setzero_si256(),
+                                                    max)));
+
+    /* Temporal and spatial or spatial only interpolation */
+    __m256i sp_lo, sp_hi;
+    __m256i hf_lo = BwdifInterpolate8(cur, prev2, next2, s, &sp_lo);
+    __m256i hf_hi = BwdifInterpolate8(cur + 8, prev2 + 8, next2 + 8, s,
+                                      &sp_hi);
+    __m256i hf = _mm256_permute2x128_si256(hf_lo, hf_hi, 0x20);
+    __m256i sp = _mm256_permute2x128_si256(sp_lo, sp_hi, 0x20);
+    __m256i interpol = _mm256_blendv_epi8(sp, hf,
+                                          _mm256_cmpgt_epi16(AbsDiff16(c, e),
+                                                             td0));
+
+    interpol = _mm256_max_epi16(interpol, _mm256_sub_epi16(d, diff));
+    interpol = _mm256_min_epi16(interpol, _mm256_add_epi16(d, diff));
+    return _mm256_blendv_epi8(interpol, d, still);
+}
+
+VLC_TARGET
+void bwdif_filter_line_avx2(uint8_t *dst, const uint8_t *prev,
+                            const uint8_t *cur, const uint8_t *next, int w,
+                            ptrdiff_t stride, int parity)
+{
+    const uint8_t *prev2 = parity ? prev : cur;
+    const uint8_t *next2 = parity ? cur : next;
+
+    for (int x = 0; x < w; x += 16)
+    {
+        __m256i v = Bwdif16(prev + x, cur + x, next + x, prev2 + x,
+                            next2 + x, stride);
+
+        /* The saturation provides the final clipping to 8 bits */
+        v = Pack16(v, v);
+        _mm_storeu_si128((__m128i *)(dst + x), _mm256_castsi256_si128(v));
+    }
+}
@@ -0,0 +1,297 @@
+/*****************************************************************************
+ * gladjust.c: OpenGL image properties filter
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_configuration.h>
+#include <vlc_picture.h>
+#include <vlc_plugin.h>
+#include <vlc_modules.h>
+#include <vlc_opengl.h>
+#include <vlc_opengl_filter.h>
+#include <vlc_filter.h>
+
+#include "video_output/opengl/gl_api.h"
+#include "video_output/opengl/gl_common.h"
+#include "video_output/opengl/gl_util.h"
+#include "video_output/opengl/sampler.h"
+
+static const char *const filter_options[] = {
+    "contrast", "brightness", "hue", "saturation", "gamma", NULL
+};
+
+struct sys {
+    struct vlc_gl_sampler *sampler;
+
+    GLuint program_id;
+
+    GLuint vbo;
+
+    struct {
+        GLint vertex_pos;
+        GLint tex_coords_in;
+        GLint contrast;
+        GLint brightness;
+        GLint hue;
+        GLint saturation;
+        GLint gamma;
+    } loc;
+};
+
+static int
+Draw(struct vlc_gl_filter *filter, const struct vlc_gl_picture *pic,
+     const struct vlc_gl_input_meta *meta)
+{
+    (void) meta;
+
+    struct sys *sys = filter->sys;
+
+    const opengl_vtable_t *vt = &filter->api->vt;
+
+    vt->UseProgram(sys->program_id);
+
+    struct vlc_gl_sampler *sampler = sys->sampler;
+    vlc_gl_sampler_Update(sampler, pic);
+    vlc_gl_sampler_Load(sampler);
+
+    vt->BindBuffer(GL_ARRAY_BUFFER, sys->vbo);
+
+    if (pic->mtx_has_changed)
+    {
+        float coords[] = {
+            0, 1,
+            0, 0,
+            1, 1,
+            1, 0,
+        };
+
+        /* Transform coordinates in place */
+        vlc_gl_picture_ToTexCoords(pic, 4, coords, coords);
+
+        const float data[] = {
+            -1,  1, coords[0], coords[1],
+            -1, -1, coords[2], coords[3],
+             1,  1, coords[4], coords[5],
+             1, -1, coords[6], coords[7],
+        };
+        vt->BufferData(GL_ARRAY_BUFFER, sizeof(data), data, GL_STATIC_DRAW);
+    }
+
+    const GLsizei stride = 4 * sizeof(float);
+
+    vt->EnableVertexAttribArray(sys->loc.vertex_pos);
+    vt->VertexAttribPointer(sys->loc.vertex_pos, 2, GL_FLOAT, GL_FALSE, stride,
+                            (const void *) 0);
+
+    intptr_t offset = 2 * sizeof(float);
+    vt->EnableVertexAttribArray(sys->loc.tex_coords_in);
+    vt->VertexAttribPointer(sys->loc.tex_coords_in, 2, GL_FLOAT, GL_FALSE,
+                            stride, (const void *) offset);
+
+    /* The properties may be changed while playing */
+    vt->Uniform1f(sys->loc.contrast, var_InheritFloat(filter, "contrast"));
+    vt->Uniform1f(sys->loc.brightness,
+                  var_InheritFloat(filter, "brightness"));
+    vt->Uniform1f(sys->loc.hue,
+                  var_InheritFloat(filter, "hue") * (float)(M_PI / 180.));
+    vt->Uniform1f(sys->loc.saturation,
+                  var_InheritFloat(filter, "saturation"));
+    vt->Uniform1f(sys->loc.gamma, 1.f / var_InheritFloat(filter, "gamma"));
+
+    vt->Clear(GL_COLOR_BUFFER_BIT);
+    vt->DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+    return VLC_SUCCESS;
+}
+
+static void
+Close(struct vlc_gl_filter *filter)
+{
+    struct sys *sys = filter->sys;
+
+    vlc_gl_sampler_Delete(sys->sampler);
+
+    const opengl_vtable_t *vt = &filter->api->vt;
+    vt->DeleteProgram(sys->program_id);
+    vt->DeleteBuffers(1, &sys->vbo);
+
+    free(sys);
+}
+
+static int
+Open(struct vlc_gl_filter *filter, const config_chain_t *config,
+     const struct vlc_gl_format *glfmt, struct vlc_gl_tex_size *size_out)
+{
+    (void) size_out;
+
+    /* Without explicit options, inherit them from the video filter wrapping
+     * this one, so that changing them while playing is taken into account */
+    if (config != NULL)
+        config_ChainParse(filter, "", filter_options, config);
+
+    static const struct vlc_gl_filter_ops ops = {
+        .draw = Draw,
+        .close = Close,
+    };
+    filter->ops = &ops;
+
+    struct vlc_gl_sampler *sampler =
+        vlc_gl_sampler_New(filter->gl, filter->api, glfmt, false);
+    if (!sampler)
+        return VLC_EGENERIC;
+
+    struct sys *sys = filter->sys = malloc(sizeof(*sys));
+    if (!sys)
+    {
+        vlc_gl_sampler_Delete(sampler);
+        return VLC_EGENERIC;
+    }
+
+    sys->sampler = sampler;
+
+    static const char *const VERTEX_SHADER =
+        "attribute vec2 vertex_pos;\n"
+        "attribute vec2 tex_coords_in;\n"
+        "varying vec2 tex_coords;\n"
+        "void main() {\n"
+        "  gl_Position = vec4(vertex_pos, 0.0, 1.0);\n"
+        "  tex_coords = tex_coords_in;\n"
+        "}\n";
+
+    /* Same operations as the CPU filter, in BT.709 YCbCr space since the
+     * sampler returns RGB samples */
+    static const char *const FRAGMENT_SHADER =
+        "varying vec2 tex_coords;\n"
+        "uniform float contrast;\n"
+        "uniform float brightness;\n"
+        "uniform float hue;\n"
+        "uniform float saturation;\n"
+        "uniform float gamma;\n"
+        "const mat3 to_yuv = mat3(0.2126, -0.1146,  0.5,\n"
+        "                         0.7152, -0.3854, -0.4542,\n"
+        "                         0.0722,  0.5,    -0.0458);\n"
+        "const mat3 to_rgb = mat3(1.0,     1.0,     1.0,\n"
+        "                         0.0,    -0.1873,  1.8556,\n"
+        "                         1.5748, -0.4681,  0.0);\n"
+        "void main() {\n"
+        "  vec4 pix = vlc_texture(tex_coords);\n"
+        "  vec3 yuv = to_yuv * pix.rgb;\n"
+        "  float y = (yuv.x - 0.5) * contrast + brightness - 0.5;\n"
+        "  y = pow(clamp(y, 0.0, 1.0), gamma);\n"
+        "  float c = cos(hue);\n"
+        "  float s = sin(hue);\n"
+        "  vec2 uv = mat2(c, -s, s, c) * yuv.yz * saturation;\n"
+        "  vec3 rgb = to_rgb * vec3(y, uv);\n"
+        "  gl_FragColor = vec4(clamp(rgb, 0.0, 1.0), pix.a);\n"
+        "}\n";
+
+    const char *extensions = sampler->shader.extensions
+                           ? sampler->shader.extensions : "";
+
+    const opengl_vtable_t *vt = &filter->api->vt;
+
+    const char *vertex_shader[] = { sampler->shader.version, VERTEX_SHADER };
+    const char *fragment_shader[] = {
+        sampler->shader.version,
+        extensions,
+        sampler->shader.precision,
+        sampler->shader.body,
+        FRAGMENT_SHADER,
+    };
+
+    GLuint program_id =
+        vlc_gl_BuildProgram(VLC_OBJECT(filter), vt,
+                            ARRAY_SIZE(vertex_shader), vertex_shader,
+                            ARRAY_SIZE(fragment_shader), fragment_shader);
+
+    if (!program_id)
+        goto error;
+
+    vlc_gl_sampler_FetchLocations(sampler, program_id);
+
+    sys->program_id = program_id;
+
+    sys->loc.vertex_pos = vt->GetAttribLocation(program_id, "vertex_pos");
+    assert(sys->loc.vertex_pos != -1);
+
+    sys->loc.tex_coords_in = vt->GetAttribLocation(program_id, "tex_coords_in");
+    assert(sys->loc.tex_coords_in != -1);
+
+    static const char *const uniforms[] = {
+        "contrast", "brightness", "hue", "saturation", "gamma",
+    };
+    GLint *const locs[] = {
+        &sys->loc.contrast, &sys->loc.brightness, &sys->loc.hue,
+        &sys->loc.saturation, &sys->loc.gamma,
+    };
+    for (size_t i = 0; i < ARRAY_SIZE(uniforms); ++i)
+    {
+        *locs[i] = vt->GetUniformLocation(program_id, uniforms[i]);
+        assert(*locs[i] != -1);
+    }
+
+    vt->GenBuffers(1, &sys->vbo);
+
+    return VLC_SUCCESS;
+
+error:
+    vlc_gl_sampler_Delete(sampler);
+    free(sys);
+    return VLC_EGENERIC;
+}
+
+static int OpenVideoFilter(filter_t *filter)
+{
+    /* Software pictures are better handled by the CPU filter, which does
+     * not need to upload and read back every picture. */
+    if (filter->vctx_in == NULL)
+        return VLC_EGENERIC;
+
+    module_t *module = vlc_gl_WrapOpenGLFilter(filter, "gladjust");
+    if (module == NULL)
+        return VLC_EGENERIC;
+
+    /* Read by the OpenGL filter on every picture */
+    config_ChainParse(filter, "", filter_options, filter->p_cfg);
+    for (size_t i = 0; filter_options[i] != NULL; ++i)
+        var_Create(filter, filter_options[i],
+                   VLC_VAR_FLOAT | VLC_VAR_DOINHERIT | VLC_VAR_ISCOMMAND);
+
+    return VLC_SUCCESS;
+}
+
+vlc_module_begin()
+    set_shortname("adjust")
+    set_description("OpenGL image properties filter")
+    set_subcategory(SUBCAT_VIDEO_VFILTER)
+
+    /* Replaces the CPU adjust filter for hardware pictures */
+    set_capability("video filter", 10)
+    set_callback(OpenVideoFilter)
+    add_shortcut("adjust", "gladjust")
+
+    add_submodule()
+        set_capability("opengl filter", 0)
+        set_callback_opengl_filter(Open)
+        add_shortcut("gladjust")
+vlc_module_end()
@@ -33,6 +33,8 @@
 #include <vlc_plugin.h>
 #include <vlc_filter.h>
 #include <vlc_picture.h>
+#include <vlc_cpu.h>
+#include <vlc_executor.h>
 #include "filter_picture.h"
 
 
@@ -58,6 +60,10 @@ static int DenoiseCallback( vlc_object_t *p_this, char const *psz_var,
 #define CHROMA_SPAT_TEXT        N_("Spatial chroma strength (0-254)")
 #define LUMA_TEMP_TEXT          N_("Temporal luma strength (0-254)")
 #define CHROMA_TEMP_TEXT        N_("Temporal chroma strength (0-254)")
+#define THREADS_TEXT            N_("Threads")
+#define THREADS_LONGTEXT        N_("Number of threads (0 = automatic).")
+
+#define HQDN3D_MAX_THREADS 16
 
 vlc_module_begin()
     set_shortname(N_("HQ Denoiser 3D"))
@@ -72,6 +78,8 @@ vlc_module_begin()
             LUMA_TEMP_TEXT, NULL)
     add_float_with_range(FILTER_PREFIX "chroma-temp", 4.5, 0.0, 254.0,
             CHROMA_TEMP_TEXT, NULL)
+    add_integer_with_range(FILTER_PREFIX "threads", 0, 0, HQDN3D_MAX_THREADS,
+            THREADS_TEXT, THREADS_LONGTEXT)
 
     add_shortcut("hqdn3d")
 
@@ -79,7 +87,7 @@ vlc_module_begin()
 vlc_module_end()
 
 static const char *const filter_options[] = {
-    "luma-spat", "chroma-spat", "luma-temp", "chroma-temp", NULL
+    "luma-spat", "chroma-spat", "luma-temp", "chroma-temp", "threads", NULL
 };
 
 /*****************************************************************************
@@ -94,6 +102,11 @@ typedef struct
     bool   b_recalc_coefs;
     vlc_mutex_t coefs_mutex;
     float  luma_spat, luma_temp, chroma_spat, chroma_temp;
+
+    void (*pf_vertical)(const struct hqdn3d_plane *, int, int);
+    vlc_executor_t *executor; /* NULL if single-threaded */
+    unsigned slices;
+    unsigned budget;
 } filter_sys_t;
 
 /*****************************************************************************
@@ -106,7 +119,6 @@ static int Open(filter_t *filter)
     const video_format_t *fmt_in  = &filter->fmt_in.video;
     const video_format_t *fmt_out = &filter->fmt_out.video;
     const vlc_fourcc_t fourcc_in  = fmt_in->i_chroma;
-    int wmax = 0;
 
     if ( !video_format_IsSameChroma( fmt_in, fmt_out ) ) {
         msg_Err(filter, "Input and output chromas don't match");
@@ -116,7 +128,7 @@ static int Open(filter_t *filter)
     const vlc_chroma_description_t *chroma =
             vlc_fourcc_GetChromaDescription(fourcc_in);
     assert( chroma != NULL );
-    if (chroma->plane_count != 3 || chroma->pixel_size != 1) {
+    if (chroma->plane_count != 3 || chroma->pixel_size > 2) {
         msg_Err(filter, "Unsupported chroma (%4.4s)", (char*)&fourcc_in);
         return VLC_EGENERIC;
     }
@@ -132,18 +144,44 @@ static int Open(filter_t *filter)
 
     for (int i = 0; i < 3; ++i) {
         sys->w[i] = fmt_in->i_width  * chroma->p[i].w.num / chroma->p[i].w.den;
-        if (sys->w[i] > wmax) wmax = sys->w[i];
         sys->h[i] = fmt_out->i_height * chroma->p[i].h.num / chroma->p[i].h.den;
-    }
-    cfg->Line = malloc(wmax*sizeof(unsigned int));
-    if (!cfg->Line) {
-        free(sys);
-        return VLC_ENOMEM;
+        cfg->Spatial[i] = vlc_alloc(sys->w[i] * sys->h[i],
+                                    sizeof(unsigned int));
+        if (!cfg->Spatial[i]) {
+            for (int j = 0; j < i; ++j)
+                free(cfg->Spatial[j]);
+            free(sys);
+            return VLC_ENOMEM;
+        }
     }
 
     config_ChainParse(filter, FILTER_PREFIX, filter_options,
                       filter->p_cfg);
 
+    /* Denoise in bands on worker threads, the filter thread included */
+    unsigned threads = var_InheritInteger(filter, FILTER_PREFIX "threads");
+    if (threads == 0) {
+        sys->budget = vlc_CPUBudgetAcquire(HQDN3D_MAX_THREADS);
+        threads = sys->budget;
+    }
+    if (threads > HQDN3D_MAX_THREADS)
+        threads = HQDN3D_MAX_THREADS;
+    sys->slices = 1;
+    if (threads > 1) {
+        sys->executor = vlc_executor_New(threads - 1);
+        if (sys->executor != NULL)
+            sys->slices = threads;
+        else
+            msg_Warn(filter, "cannot create worker threads");
+    }
+    msg_Dbg(filter, "denoising in %u band(s)", sys->slices);
+
+    sys->pf_vertical = deNoiseVertical;
+#ifdef CAN_COMPILE_AVX2
+    if (vlc_CPU_AVX2())
+        sys->pf_vertical = deNoiseVertical_avx2;
+#endif
+
 
     vlc_mutex_init( &sys->coefs_mutex );
     sys->b_recalc_coefs = true;
@@ -181,13 +219,79 @@ static void Close(filter_t *filter)
     var_DelCallback( filter, FILTER_PREFIX "luma-temp", DenoiseCallback, sys );
     var_DelCallback( filter, FILTER_PREFIX "chroma-temp", DenoiseCallback, sys );
 
+    if (sys->executor != NULL)
+        vlc_executor_Delete(sys->executor);
+    vlc_CPUBudgetRelease(sys->budget);
+
     for (int i = 0; i < 3; ++i) {
         free(cfg->Frame[i]);
+        free(cfg->Spatial[i]);
     }
-    free(cfg->Line);
     free(sys);
 }
 
+/*****************************************************************************
+ * Band threading
+ *****************************************************************************/
+struct denoise_task
+{
+    struct vlc_runnable runnable;
+    const struct hqdn3d_plane *planes;
+    void (*pf_vertical)(const struct hqdn3d_plane *, int, int);
+    bool vertical;
+    unsigned slice;
+    unsigned slices;
+};
+
+static void DenoiseSlice(void *data)
+{
+    const struct denoise_task *task = data;
+
+    for (int i = 0; i < 3; ++i) {
+        const struct hqdn3d_plane *p = &task->planes[i];
+
+        if (task->vertical) {
+            /* Columns in blocks of 8, for the SIMD version */
+            int blocks = (p->W + 7) / 8;
+            int x0 = 8 * (blocks * task->slice / task->slices);
+            int x1 = 8 * (blocks * (task->slice + 1) / task->slices);
+            task->pf_vertical(p, x0, __MIN(x1, p->W));
+        } else {
+            int y0 = p->H * task->slice / task->slices;
+            int y1 = p->H * (task->slice + 1) / task->slices;
+            deNoiseHorizontal(p, y0, y1);
+        }
+    }
+}
+
+/* Runs one pass over the bands of the three planes, returns once all the
+ * bands are done */
+static void DenoisePass(filter_sys_t *sys, const struct hqdn3d_plane *planes,
+                        bool vertical)
+{
+    struct denoise_task tasks[HQDN3D_MAX_THREADS];
+
+    for (unsigned i = 0; i < sys->slices; ++i) {
+        tasks[i] = (struct denoise_task) {
+            .runnable = { .run = DenoiseSlice, .userdata = &tasks[i] },
+            .planes = planes,
+            .pf_vertical = sys->pf_vertical,
+            .vertical = vertical,
+            .slice = i,
+            .slices = sys->slices,
+        };
+    }
+
+    /* The calling thread processes the first band itself */
+    for (unsigned i = 1; i < sys->slices; ++i)
+        vlc_executor_Submit(sys->executor, &tasks[i].runnable);
+
+    DenoiseSlice(&tasks[0]);
+
+    if (sys->slices > 1)
+        vlc_executor_WaitIdle(sys->executor);
+}
+
 /*****************************************************************************
  * Filter
  *****************************************************************************/
@@ -220,32 +324,48 @@ static picture_t *Filter(filter_t *filter, picture_t *src)
     }
     vlc_mutex_unlock( &sys->coefs_mutex );
 
-    deNoise(src->p[0].p_pixels, dst->p[0].p_pixels,
-            cfg->Line, &cfg->Frame[0], sys->w[0], sys->h[0],
-            src->p[0].i_pitch, dst->p[0].i_pitch,
-            cfg->Coefs[0],
-            cfg->Coefs[0],
-            cfg->Coefs[1]);
-    deNoise(src->p[1].p_pixels, dst->p[1].p_pixels,
-            cfg->Line, &cfg->Frame[1], sys->w[1], sys->h[1],
-            src->p[1].i_pitch, dst->p[1].i_pitch,
-            cfg->Coefs[2],
-            cfg->Coefs[2],
-            cfg->Coefs[3]);
-    deNoise(src->p[2].p_pixels, dst->p[2].p_pixels,
-            cfg->Line, &cfg->Frame[2], sys->w[2], sys->h[2],
-            src->p[2].i_pitch, dst->p[2].i_pitch,
-            cfg->Coefs[2],
-            cfg->Coefs[2],
-            cfg->Coefs[3]);
-
-    if(unlikely(!cfg->Frame[0] || !cfg->Frame[1] || !cfg->Frame[2]))
-    {
-        picture_Release( src );
-        picture_Release( dst );
-        return NULL;
+    const unsigned pixel_size = sys->chroma->pixel_size;
+    const unsigned shift = 24 - (pixel_size == 1 ? 8 : sys->chroma->pixel_bits);
+    struct hqdn3d_plane planes[3];
+
+    for (int i = 0; i < 3; ++i) {
+        int w = sys->w[i], h = sys->h[i];
+
+        /* The first picture is its own previous picture */
+        if (!cfg->Frame[i]) {
+            cfg->Frame[i] = vlc_alloc(w * h, sizeof(unsigned short));
+            if (unlikely(!cfg->Frame[i])) {
+                picture_Release( src );
+                picture_Release( dst );
+                return NULL;
+            }
+            for (long y = 0; y < h; y++) {
+                const uint8_t *line = src->p[i].p_pixels + y * src->p[i].i_pitch;
+                for (long x = 0; x < w; x++)
+                    cfg->Frame[i][y * w + x] =
+                        ReadSample(line, x, pixel_size, shift) >> 8;
+            }
+        }
+
+        int *spat = cfg->Coefs[i == 0 ? 0 : 2];
+        int *temp = cfg->Coefs[i == 0 ? 1 : 3];
+        planes[i] = (struct hqdn3d_plane) {
+            .Frame = src->p[i].p_pixels,
+            .FrameDest = dst->p[i].p_pixels,
+            .Spatial = cfg->Spatial[i],
+            .FrameAnt = cfg->Frame[i],
+            .W = w, .H = h,
+            .sStride = src->p[i].i_pitch,
+            .dStride = dst->p[i].i_pitch,
+            .PixelSize = pixel_size,
+            .Shift = shift,
+            .Horizontal = spat, .Vertical = spat, .Temporal = temp,
+        };
     }
 
+    DenoisePass(sys, planes, false);
+    DenoisePass(sys, planes, true);
+
     return CopyInfoAndRelease(dst, src);
 }
 
@@ -266,9 +386,9 @@ static int DenoiseCallback( vlc_object_t *p_this, char const *psz_var,
     else if( !strcmp( psz_var, FILTER_PREFIX "luma-temp") )
         sys->luma_temp = newval.f_float;
     else if( !strcmp( psz_var, FILTER_PREFIX "chroma-temp") )
-        sys->chroma_spat = newval.f_float;
-    else if( !strcmp( psz_var, FILTER_PREFIX "chroma-spat") )
         sys->chroma_temp = newval.f_float;
+    else if( !strcmp( psz_var, FILTER_PREFIX "chroma-spat") )
+        sys->chroma_spat = newval.f_float;
     sys->b_recalc_coefs = true;
     vlc_mutex_unlock( &sys->coefs_mutex );
 
@@ -23,6 +23,9 @@
 #include <string.h>
 #include <inttypes.h>
 #include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #define PARAM1_DEFAULT 4.0
 #define PARAM2_DEFAULT 3.0
@@ -32,148 +35,245 @@
 
 struct vf_priv_s {
         int Coefs[4][512*16];
-        unsigned int *Line;
+        unsigned int *Spatial[3];
         unsigned short *Frame[3];
 };
 
+/* One plane to denoise. The spatial filter is done in two passes: the
+ * horizontal pass only depends on the line, and the vertical and temporal
+ * pass only on the column, so each can be split in independent bands.
+ * Whatever the bit depth, samples are scaled to the 8.16 fixed point values
+ * the coefficient tables are made for. */
+struct hqdn3d_plane {
+        const uint8_t *Frame;        // source plane
+        uint8_t *FrameDest;          // destination plane
+        unsigned int *Spatial;       // W*H spatially filtered samples
+        unsigned short *FrameAnt;    // W*H previous frame, 8.8 fixed point
+        int W, H;
+        ptrdiff_t sStride, dStride;  // in bytes
+        unsigned PixelSize;          // 1 or 2 bytes
+        unsigned Shift;              // 24 - bits per sample
+        int *Horizontal, *Vertical, *Temporal;
+};
 
 /***************************************************************************/
 
-static /*inline*/ unsigned int LowPassMul(unsigned int PrevMul, unsigned int CurrMul, int* Coef){
+static inline unsigned int LowPassMul(unsigned int PrevMul, unsigned int CurrMul, int* Coef){
 //    int dMul= (PrevMul&0xFFFFFF)-(CurrMul&0xFFFFFF);
     int dMul= PrevMul-CurrMul;
     unsigned int d=((dMul+0x10007FF)>>12);
     return CurrMul + Coef[d];
 }
 
-static void deNoiseTemporal(
-                    unsigned char *Frame,        // mpi->planes[x]
-                    unsigned char *FrameDest,    // dmpi->planes[x]
-                    unsigned short *FrameAnt,
-                    int W, int H, int sStride, int dStride,
-                    int *Temporal)
+static inline unsigned int ReadSample(const uint8_t *Line, long X,
+                                      unsigned PixelSize, unsigned Shift)
 {
-    unsigned int PixelDst;
+    if (PixelSize == 1)
+        return Line[X] << Shift;
+    return ((const uint16_t *)Line)[X] << Shift;
+}
 
-    for (long Y = 0; Y < H; Y++){
-        for (long X = 0; X < W; X++){
-            PixelDst = LowPassMul(FrameAnt[X]<<8, Frame[X]<<16, Temporal);
-            FrameAnt[X] = ((PixelDst+0x1000007F)>>8);
-            FrameDest[X]= ((PixelDst+0x10007FFF)>>16);
-        }
-        Frame += sStride;
-        FrameDest += dStride;
-        FrameAnt += W;
-    }
+static inline void WriteSample(uint8_t *Line, long X, unsigned int PixelDst,
+                               unsigned PixelSize, unsigned Shift)
+{
+    /* The offset keeps the value positive, and is masked out */
+    unsigned int v = (PixelDst + 0x10000000 + (1u << (Shift - 1)) - 1) >> Shift;
+    if (PixelSize == 1)
+        Line[X] = v;
+    else
+        ((uint16_t *)Line)[X] = v & ((1u << (24 - Shift)) - 1);
 }
 
-static void deNoiseSpacial(
-                    unsigned char *Frame,        // mpi->planes[x]
-                    unsigned char *FrameDest,    // dmpi->planes[x]
-                    unsigned int *LineAnt,       // vf->priv->Line (width bytes)
-                    int W, int H, int sStride, int dStride,
-                    int *Horizontal, int *Vertical)
+static inline bool IsSpatial(const struct hqdn3d_plane *p)
 {
-    long sLineOffs = 0, dLineOffs = 0;
-    unsigned int PixelAnt;
-    unsigned int PixelDst;
-
-    /* First pixel has no left nor top neighbor. */
-    PixelDst = LineAnt[0] = PixelAnt = Frame[0]<<16;
-    FrameDest[0]= ((PixelDst+0x10007FFF)>>16);
-
-    /* First line has no top neighbor, only left. */
-    for (long X = 1; X < W; X++){
-        PixelDst = LineAnt[X] = LowPassMul(PixelAnt, Frame[X]<<16, Horizontal);
-        FrameDest[X]= ((PixelDst+0x10007FFF)>>16);
-    }
+    return p->Horizontal[0] || p->Vertical[0];
+}
+
+static inline bool IsTemporal(const struct hqdn3d_plane *p)
+{
+    /* Without spatial filtering, only the temporal filter is applied, even
+     * with a null strength */
+    return p->Temporal[0] || !IsSpatial(p);
+}
+
+static inline void deNoiseHorizontalPx(const struct hqdn3d_plane *p,
+                                       int Y0, int Y1, unsigned PixelSize)
+{
+    for (long Y = Y0; Y < Y1; Y++){
+        const uint8_t *Frame = p->Frame + Y * p->sStride;
+        unsigned int *LineDst = &p->Spatial[Y * p->W];
 
-    for (long Y = 1; Y < H; Y++){
-        sLineOffs += sStride, dLineOffs += dStride;
         /* First pixel on each line doesn't have previous pixel */
-        PixelAnt = Frame[sLineOffs]<<16;
-        PixelDst = LineAnt[0] = LowPassMul(LineAnt[0], PixelAnt, Vertical);
-        FrameDest[dLineOffs]= ((PixelDst+0x10007FFF)>>16);
-
-        for (long X = 1; X < W; X++){
-            /* The rest are normal */
-            PixelAnt = LowPassMul(PixelAnt, Frame[sLineOffs+X]<<16, Horizontal);
-            PixelDst = LineAnt[X] = LowPassMul(LineAnt[X], PixelAnt, Vertical);
-            FrameDest[dLineOffs+X]= ((PixelDst+0x10007FFF)>>16);
-        }
+        unsigned int PixelAnt = LineDst[0] =
+            ReadSample(Frame, 0, PixelSize, p->Shift);
+        for (long X = 1; X < p->W; X++)
+            PixelAnt = LineDst[X] =
+                LowPassMul(PixelAnt, ReadSample(Frame, X, PixelSize, p->Shift),
+                           p->Horizontal);
     }
 }
 
-static void deNoise(unsigned char *Frame,        // mpi->planes[x]
-                    unsigned char *FrameDest,    // dmpi->planes[x]
-                    unsigned int *LineAnt,      // vf->priv->Line (width bytes)
-                    unsigned short **FrameAntPtr,
-                    int W, int H, int sStride, int dStride,
-                    int *Horizontal, int *Vertical, int *Temporal)
+/* Horizontal low-pass of the lines Y0 to Y1 (excluded) */
+static void deNoiseHorizontal(const struct hqdn3d_plane *p, int Y0, int Y1)
+{
+    if (!IsSpatial(p))
+        return;
+    if (p->PixelSize == 1)
+        deNoiseHorizontalPx(p, Y0, Y1, 1);
+    else
+        deNoiseHorizontalPx(p, Y0, Y1, 2);
+}
+
+static inline void deNoiseVerticalPx(const struct hqdn3d_plane *p,
+                                     int X0, int X1, unsigned PixelSize)
 {
-    long sLineOffs = 0, dLineOffs = 0;
-    unsigned int PixelAnt;
-    unsigned int PixelDst;
-    unsigned short* FrameAnt=(*FrameAntPtr);
-
-    if(!FrameAnt){
-        (*FrameAntPtr)=FrameAnt=malloc(W*H*sizeof(unsigned short));
-        if(!FrameAnt)
-            return;
-        for (long Y = 0; Y < H; Y++){
-            unsigned short* dst=&FrameAnt[Y*W];
-            unsigned char* src=Frame+Y*sStride;
-            for (long X = 0; X < W; X++) dst[X]=src[X]<<8;
+    const bool spatial = IsSpatial(p);
+    const bool temporal = IsTemporal(p);
+
+    for (long Y = 0; Y < p->H; Y++){
+        const uint8_t *Frame = p->Frame + Y * p->sStride;
+        uint8_t *FrameDest = p->FrameDest + Y * p->dStride;
+        unsigned int *LineAnt = &p->Spatial[Y * p->W];
+        unsigned short *LinePrev = &p->FrameAnt[Y * p->W];
+
+        for (long X = X0; X < X1; X++){
+            unsigned int PixelDst;
+
+            if (spatial){
+                /* First line has no top neighbor */
+                if (Y > 0)
+                    LineAnt[X] = LowPassMul(LineAnt[X - p->W], LineAnt[X],
+                                            p->Vertical);
+                PixelDst = LineAnt[X];
+            }
+            else
+                PixelDst = ReadSample(Frame, X, PixelSize, p->Shift);
+
+            if (temporal){
+                PixelDst = LowPassMul(LinePrev[X]<<8, PixelDst, p->Temporal);
+                LinePrev[X] = ((PixelDst+0x1000007F)>>8);
+            }
+            WriteSample(FrameDest, X, PixelDst, PixelSize, p->Shift);
         }
     }
+}
 
-    if(!Horizontal[0] && !Vertical[0]){
-        deNoiseTemporal(Frame, FrameDest, FrameAnt,
-                        W, H, sStride, dStride, Temporal);
-        return;
-    }
-    if(!Temporal[0]){
-        deNoiseSpacial(Frame, FrameDest, LineAnt,
-                       W, H, sStride, dStride, Horizontal, Vertical);
-        return;
-    }
+/* Vertical and temporal low-pass of the columns X0 to X1 (excluded), after
+ * deNoiseHorizontal() has processed all the lines */
+static void deNoiseVertical(const struct hqdn3d_plane *p, int X0, int X1)
+{
+    if (p->PixelSize == 1)
+        deNoiseVerticalPx(p, X0, X1, 1);
+    else
+        deNoiseVerticalPx(p, X0, X1, 2);
+}
 
-    /* First pixel has no left nor top neighbor. Only previous frame */
-    LineAnt[0] = PixelAnt = Frame[0]<<16;
-    PixelDst = LowPassMul(FrameAnt[0]<<8, PixelAnt, Temporal);
-    FrameAnt[0] = ((PixelDst+0x1000007F)>>8);
-    FrameDest[0]= ((PixelDst+0x10007FFF)>>16);
-
-    /* First line has no top neighbor. Only left one for each pixel and
-     * last frame */
-    for (long X = 1; X < W; X++){
-        LineAnt[X] = PixelAnt = LowPassMul(PixelAnt, Frame[X]<<16, Horizontal);
-        PixelDst = LowPassMul(FrameAnt[X]<<8, PixelAnt, Temporal);
-        FrameAnt[X] = ((PixelDst+0x1000007F)>>8);
-        FrameDest[X]= ((PixelDst+0x10007FFF)>>16);
-    }
+#ifdef CAN_COMPILE_AVX2
+# include <immintrin.h>
+# define VLC_AVX2 __attribute__ ((__target__ ("avx2")))
 
-    for (long Y = 1; Y < H; Y++){
-        unsigned short* LinePrev=&FrameAnt[Y*W];
-        sLineOffs += sStride, dLineOffs += dStride;
-        /* First pixel on each line doesn't have previous pixel */
-        PixelAnt = Frame[sLineOffs]<<16;
-        LineAnt[0] = LowPassMul(LineAnt[0], PixelAnt, Vertical);
-        PixelDst = LowPassMul(LinePrev[0]<<8, LineAnt[0], Temporal);
-        LinePrev[0] = ((PixelDst+0x1000007F)>>8);
-        FrameDest[dLineOffs]= ((PixelDst+0x10007FFF)>>16);
-
-        for (long X = 1; X < W; X++){
-            /* The rest are normal */
-            PixelAnt = LowPassMul(PixelAnt, Frame[sLineOffs+X]<<16, Horizontal);
-            LineAnt[X] = LowPassMul(LineAnt[X], PixelAnt, Vertical);
-            PixelDst = LowPassMul(LinePrev[X]<<8, LineAnt[X], Temporal);
-            LinePrev[X] = ((PixelDst+0x1000007F)>>8);
-            FrameDest[dLineOffs+X]= ((PixelDst+0x10007FFF)>>16);
+/* Same as LowPassMul() on 8 samples, the table lookups being gathers */
+VLC_AVX2
+static inline __m256i LowPassMul_avx2(__m256i PrevMul, __m256i CurrMul,
+                                      const int *Coef)
+{
+    __m256i d = _mm256_srli_epi32(_mm256_add_epi32(
+                    _mm256_sub_epi32(PrevMul, CurrMul),
+                    _mm256_set1_epi32(0x10007FF)), 12);
+    return _mm256_add_epi32(CurrMul, _mm256_i32gather_epi32(Coef, d, 4));
+}
+
+VLC_AVX2
+static inline __m256i ReadSamples_avx2(const uint8_t *Line, long X,
+                                       unsigned PixelSize, __m128i Shift)
+{
+    __m256i v;
+    if (PixelSize == 1)
+        v = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)&Line[X]));
+    else
+        v = _mm256_cvtepu16_epi32(
+                _mm_loadu_si128((const __m128i *)&Line[2 * X]));
+    return _mm256_sll_epi32(v, Shift);
+}
+
+/* Packs 8 dwords of at most 16 bits to words, in order */
+VLC_AVX2
+static inline __m128i Pack32_avx2(__m256i v)
+{
+    v = _mm256_packus_epi32(v, v);
+    v = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(3, 1, 2, 0));
+    return _mm256_castsi256_si128(v);
+}
+
+VLC_AVX2
+static inline void deNoiseVerticalPx_avx2(const struct hqdn3d_plane *p,
+                                          int X0, int X1, unsigned PixelSize)
+{
+    const bool spatial = IsSpatial(p);
+    const bool temporal = IsTemporal(p);
+    const __m128i Shift = _mm_cvtsi32_si128(p->Shift);
+    const __m256i Round = _mm256_set1_epi32(0x10000000 + (1u << (p->Shift - 1)) - 1);
+    const __m256i Mask = _mm256_set1_epi32((1u << (24 - p->Shift)) - 1);
+    const __m256i RoundAnt = _mm256_set1_epi32(0x1000007F);
+    const __m256i MaskAnt = _mm256_set1_epi32(0xFFFF);
+    const long X8 = X0 + ((X1 - X0) & ~7);
+
+    for (long Y = 0; Y < p->H; Y++){
+        const uint8_t *Frame = p->Frame + Y * p->sStride;
+        uint8_t *FrameDest = p->FrameDest + Y * p->dStride;
+        unsigned int *LineAnt = &p->Spatial[Y * p->W];
+        unsigned short *LinePrev = &p->FrameAnt[Y * p->W];
+
+        for (long X = X0; X < X8; X += 8){
+            __m256i PixelDst;
+
+            if (spatial){
+                PixelDst = _mm256_loadu_si256((const __m256i *)&LineAnt[X]);
+                if (Y > 0){
+                    __m256i Top = _mm256_loadu_si256(
+                                      (const __m256i *)&LineAnt[X - p->W]);
+                    PixelDst = LowPassMul_avx2(Top, PixelDst, p->Vertical);
+                    _mm256_storeu_si256((__m256i *)&LineAnt[X], PixelDst);
+                }
+            }
+            else
+                PixelDst = ReadSamples_avx2(Frame, X, PixelSize, Shift);
+
+            if (temporal){
+                __m256i Ant = _mm256_cvtepu16_epi32(
+                    _mm_loadu_si128((const __m128i *)&LinePrev[X]));
+                PixelDst = LowPassMul_avx2(_mm256_slli_epi32(Ant, 8),
+                                           PixelDst, p->Temporal);
+                Ant = _mm256_and_si256(_mm256_srli_epi32(
+                          _mm256_add_epi32(PixelDst, RoundAnt), 8), MaskAnt);
+                _mm_storeu_si128((__m128i *)&LinePrev[X], Pack32_avx2(Ant));
+            }
+
+            __m256i v = _mm256_and_si256(_mm256_srl_epi32(
+                            _mm256_add_epi32(PixelDst, Round), Shift), Mask);
+            __m128i w = Pack32_avx2(v);
+            if (PixelSize == 1)
+                _mm_storel_epi64((__m128i *)&FrameDest[X],
+                                 _mm_packus_epi16(w, w));
+            else
+                _mm_storeu_si128((__m128i *)&FrameDest[2 * X], w);
         }
     }
+
+    /* Remaining columns */
+    if (X8 < X1)
+        deNoiseVerticalPx(p, X8, X1, PixelSize);
 }
 
+VLC_AVX2
+static void deNoiseVertical_avx2(const struct hqdn3d_plane *p, int X0, int X1)
+{
+    if (p->PixelSize == 1)
+        deNoiseVerticalPx_avx2(p, X0, X1, 1);
+    else
+        deNoiseVerticalPx_avx2(p, X0, X1, 2);
+}
+#endif
 
 //===========================================================================//
 
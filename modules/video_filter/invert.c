@@ -73,6 +73,7 @@ static int Create( filter_t *p_filter )
         return VLC_EGENERIC;
 
     p_filter->ops = &Filter_ops;
+    p_filter->b_in_place = true;
     return VLC_SUCCESS;
 }
 
@@ -92,9 +93,10 @@ static void Filter( filter_t *p_filter, picture_t *p_pic, picture_t *p_outpic )
     {
         /* We don't want to invert the alpha plane */
         i_planes = p_pic->i_planes - 1;
-        memcpy(
-            p_outpic->p[A_PLANE].p_pixels, p_pic->p[A_PLANE].p_pixels,
-            p_pic->p[A_PLANE].i_pitch *  p_pic->p[A_PLANE].i_lines );
+        if( p_outpic != p_pic )
+            memcpy(
+                p_outpic->p[A_PLANE].p_pixels, p_pic->p[A_PLANE].p_pixels,
+                p_pic->p[A_PLANE].i_pitch *  p_pic->p[A_PLANE].i_lines );
     }
     else
     {
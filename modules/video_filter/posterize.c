@@ -99,13 +99,13 @@ static int Create( filter_t *p_filter )
     switch( p_filter->fmt_in.video.i_chroma )
     {
         CASE_PLANAR_YUV_SQUARE
+            /* Each chroma line is read twice, it cannot be overwritten */
             break;
         CASE_PACKED_YUV_422
-            break;
         case VLC_CODEC_RGB24:
         case VLC_CODEC_BGR24:
-            break;
         CASE_PACKED_RGB32
+            p_filter->b_in_place = true;
             break;
         default:
             msg_Err( p_filter, "Unsupported input chroma (%4.4s)",
@@ -148,6 +148,7 @@ static int Create( filter_t *p_filter )
     var_AddCallback( p_filter, CFG_PREFIX "intensity", FilterCallback, NULL );
 
     p_filter->ops = &Filter_ops;
+    p_filter->b_in_place = true;
 
     return VLC_SUCCESS;
 }
@@ -30,7 +30,10 @@
 # include "config.h"
 #endif
 
+#include <atomic>
 #include <cinttypes>
+#include <new>
+#include <vector>
 
 #include <vlc_common.h>
 #include <vlc_plugin.h>
@@ -184,6 +187,81 @@ static_assert(ARRAY_SIZE(rgi_ar_values) == ARRAY_SIZE(rgsz_ar_text), "afd arrays
 
 namespace {
 
+/* Recycles the video frames once they have been played out, and counts the
+ * ones the card could not play on time. */
+class FramePool : public IDeckLinkVideoOutputCallback
+{
+public:
+    FramePool() : late(0), dropped(0) {}
+
+    ~FramePool()
+    {
+        for (IDeckLinkMutableVideoFrame *frame : frames)
+            frame->Release();
+    }
+
+    IDeckLinkMutableVideoFrame *Get()
+    {
+        vlc::threads::mutex_locker locker(lock);
+        if (frames.empty())
+            return NULL;
+
+        IDeckLinkMutableVideoFrame *frame = frames.back();
+        frames.pop_back();
+        return frame;
+    }
+
+    void Put(IDeckLinkMutableVideoFrame *frame)
+    {
+        vlc::threads::mutex_locker locker(lock);
+        try {
+            frames.push_back(frame);
+        } catch (const std::bad_alloc &) {
+            frame->Release();
+        }
+    }
+
+    virtual HRESULT STDMETHODCALLTYPE QueryInterface(REFIID, LPVOID *)
+    {
+        return E_NOINTERFACE;
+    }
+
+    virtual ULONG STDMETHODCALLTYPE AddRef()
+    {
+        return 1;
+    }
+
+    virtual ULONG STDMETHODCALLTYPE Release()
+    {
+        return 1;
+    }
+
+    virtual HRESULT STDMETHODCALLTYPE ScheduledFrameCompleted(
+        IDeckLinkVideoFrame *frame, BMDOutputFrameCompletionResult result)
+    {
+        if (result == bmdOutputFrameDisplayedLate)
+            late++;
+        else if (result == bmdOutputFrameDropped)
+            dropped++;
+
+        /* All the scheduled frames were created by CreateVideoFrame() */
+        Put(static_cast<IDeckLinkMutableVideoFrame *>(frame));
+        return S_OK;
+    }
+
+    virtual HRESULT STDMETHODCALLTYPE ScheduledPlaybackHasStopped()
+    {
+        return S_OK;
+    }
+
+    std::atomic<unsigned> late;
+    std::atomic<unsigned> dropped;
+
+private:
+    vlc::threads::mutex lock;
+    std::vector<IDeckLinkMutableVideoFrame *> frames;
+};
+
 /* Only one audio output module and one video output module
  * can be used per process.
  * We use a static mutex in audio/video submodules entry points.  */
@@ -223,6 +301,8 @@ struct decklink_sys_t
         uint8_t afd, ar;
         int nosignal_delay;
         picture_t *pic_nosignal;
+        FramePool *pool;
+        unsigned late, dropped; /* as last reported */
     } video;
 };
 
@@ -317,6 +397,7 @@ static decklink_sys_t *HoldDLSys(vlc_object_t *obj, int i_cat)
         sys = (decklink_sys_t*)malloc(sizeof(*sys));
         if (sys) {
             sys->p_output = NULL;
+            sys->video.pool = NULL;
             sys->offset = 0;
             sys->users = 1;
             sys->b_videomodule = (i_cat == VIDEO_ES);
@@ -350,8 +431,10 @@ static void ReleaseDLSys(vlc_object_t *obj, int i_cat)
             sys->p_output->StopScheduledPlayback(0, NULL, 0);
             sys->p_output->DisableVideoOutput();
             sys->p_output->DisableAudioOutput();
+            sys->p_output->SetScheduledFrameCompletionCallback(NULL);
             sys->p_output->Release();
         }
+        delete sys->video.pool;
 
         /* Clean video specific */
         if (sys->video.pic_nosignal)
@@ -577,6 +660,9 @@ static int OpenDecklink(vout_display_t *vd, decklink_sys_t *sys, video_format_t
         result = sys->p_output->EnableVideoOutput(mode.id, flags);
         CHECK("Could not enable video output");
 
+        result = sys->p_output->SetScheduledFrameCompletionCallback(sys->video.pool);
+        CHECK("Could not set frame completion callback");
+
         video_format_Copy(fmt, vd->source);
         fmt->i_width = fmt->i_visible_width = p_display_mode->GetWidth();
         fmt->i_height = fmt->i_visible_height = p_display_mode->GetHeight();
@@ -650,22 +736,28 @@ static void PrepareVideo(vout_display_t *vd, picture_t *picture, const vlc_rende
         if (sys->video.pic_nosignal) {
             picture = sys->video.pic_nosignal;
         } else {
+            /* Fill the first line, then copy it over the others */
             if (sys->video.tenbits) { // I422_10L
                 plane_t *y = &picture->p[0];
                 memset(y->p_pixels, 0x0, y->i_lines * y->i_pitch);
                 for (int i = 1; i < picture->i_planes; i++) {
                     plane_t *p = &picture->p[i];
-                    size_t len = p->i_lines * p->i_pitch / 2;
                     int16_t *data = (int16_t*)p->p_pixels;
-                    for (size_t j = 0; j < len; j++) // XXX: SIMD
+                    for (int j = 0; j < p->i_pitch / 2; j++)
                         data[j] = 0x200;
+                    for (int j = 1; j < p->i_lines; j++)
+                        memcpy(p->p_pixels + j * p->i_pitch, p->p_pixels,
+                               p->i_pitch);
                 }
             } else { // UYVY
-                size_t len = picture->p[0].i_lines * picture->p[0].i_pitch;
-                for (size_t i = 0; i < len; i+= 2) { // XXX: SIMD
-                    picture->p[0].p_pixels[i+0] = 0x80;
-                    picture->p[0].p_pixels[i+1] = 0;
+                plane_t *p = &picture->p[0];
+                for (int i = 0; i < p->i_pitch; i += 2) {
+                    p->p_pixels[i+0] = 0x80;
+                    p->p_pixels[i+1] = 0;
                 }
+                for (int j = 1; j < p->i_lines; j++)
+                    memcpy(p->p_pixels + j * p->i_pitch, p->p_pixels,
+                           p->i_pitch);
             }
         }
         date = now;
@@ -676,15 +768,30 @@ static void PrepareVideo(vout_display_t *vd, picture_t *picture, const vlc_rende
     w = vd->fmt->i_width;
     h = vd->fmt->i_height;
 
+    /* Report the frames the card played late or dropped since last time */
+    unsigned late, dropped;
+    late = sys->video.pool->late;
+    dropped = sys->video.pool->dropped;
+    if (late != sys->video.late || dropped != sys->video.dropped) {
+        msg_Warn(vd, "%u late and %u dropped frames",
+                 late - sys->video.late, dropped - sys->video.dropped);
+        sys->video.late = late;
+        sys->video.dropped = dropped;
+    }
+
+    /* Reuse the frames that were played out */
     IDeckLinkMutableVideoFrame *pDLVideoFrame;
-    result = sys->p_output->CreateVideoFrame(w, h, w*3,
-        sys->video.tenbits ? bmdFormat10BitYUV : bmdFormat8BitYUV,
-        bmdFrameFlagDefault, &pDLVideoFrame);
+    pDLVideoFrame = sys->video.pool->Get();
+    if (pDLVideoFrame == NULL) {
+        result = sys->p_output->CreateVideoFrame(w, h, w*3,
+            sys->video.tenbits ? bmdFormat10BitYUV : bmdFormat8BitYUV,
+            bmdFrameFlagDefault, &pDLVideoFrame);
 
-    if (result != S_OK) {
-        msg_Err(vd, "Failed to create video frame:0x%" PRIHR, result);
-        pDLVideoFrame = NULL;
-        goto end;
+        if (result != S_OK) {
+            msg_Err(vd, "Failed to create video frame:0x%" PRIHR, result);
+            pDLVideoFrame = NULL;
+            goto end;
+        }
     }
 
     void *frame_bytes;
@@ -741,6 +848,8 @@ static void PrepareVideo(vout_display_t *vd, picture_t *picture, const vlc_rende
         msg_Err(vd, "Dropped Video frame %" PRId64 ":0x%" PRIHR, date, result);
         goto end;
     }
+    /* The frame comes back through the completion callback */
+    pDLVideoFrame = NULL;
 
     now = vlc_tick_now() - sys->offset;
 
@@ -756,7 +865,7 @@ static void PrepareVideo(vout_display_t *vd, picture_t *picture, const vlc_rende
 
 end:
     if (pDLVideoFrame)
-        pDLVideoFrame->Release();
+        sys->video.pool->Put(pDLVideoFrame);
 }
 
 static int ControlVideo(vout_display_t *vd, int query)
@@ -800,6 +909,14 @@ static int OpenVideo(vout_display_t *vd,
         sys->video.afd = var_InheritInteger(vd, VIDEO_CFG_PREFIX "afd");
         sys->video.ar = var_InheritInteger(vd, VIDEO_CFG_PREFIX "ar");
         sys->video.pic_nosignal = NULL;
+        sys->video.late = sys->video.dropped = 0;
+        if (sys->video.pool == NULL)
+            sys->video.pool = new (std::nothrow) FramePool;
+        if (sys->video.pool == NULL)
+        {
+            CloseVideo(vd);
+            return VLC_ENOMEM;
+        }
 
         if (OpenDecklink(vd, sys, fmtp) != VLC_SUCCESS)
         {
@@ -44,6 +44,8 @@
 #include <vlc_vout_display.h>
 #include <vlc_picture.h>
 #include <vlc_window.h>
+#include <vlc_subpicture.h>
+#include <vlc_vector.h>
 #include "vlc_drm.h"
 
 #include <assert.h>
@@ -54,6 +56,9 @@
 
 #define DRM_CHROMA_TEXT "Image format used by DRM"
 #define DRM_CHROMA_LONGTEXT "Chroma fourcc override for DRM framebuffer format selection"
+#define DRM_OVERLAY_TEXT N_("Subpictures on an overlay plane")
+#define DRM_OVERLAY_LONGTEXT N_("Show subtitles and on-screen display on a " \
+    "separate DRM plane instead of blending them into the video.")
 
 /*
  * how many hw buffers are allocated for page flipping. I think
@@ -61,16 +66,68 @@
  */
 #define   MAXHWBUF 3
 
+/* Plane properties set by atomic commits, in drm_mode_set_plane order */
+enum {
+    PLANE_PROP_FB_ID,
+    PLANE_PROP_CRTC_ID,
+    PLANE_PROP_CRTC_X,
+    PLANE_PROP_CRTC_Y,
+    PLANE_PROP_CRTC_W,
+    PLANE_PROP_CRTC_H,
+    PLANE_PROP_SRC_X,
+    PLANE_PROP_SRC_Y,
+    PLANE_PROP_SRC_W,
+    PLANE_PROP_SRC_H,
+    PLANE_PROP_COUNT
+};
+
+/* What a drawn subpicture region looks like, to detect changes */
+struct spu_region_key {
+    const uint8_t *pixels;
+    unsigned x_offset, y_offset, width, height;
+    vout_display_place_t place;
+    int alpha;
+};
+
 typedef struct vout_display_sys_t {
     picture_t       *buffers[MAXHWBUF];
 
     unsigned int    front_buf;
+#ifdef HAVE_VAAPI
+/*
+ * zero-copy VA-API pictures: prepared and currently scanned out
+ */
+    bool            zero_copy;
+    picture_t      *next_pic;
+    uint32_t        next_fb;
+    picture_t      *front_pic;
+    uint32_t        front_fb;
+#endif
 /*
  * modeset information
  */
     uint32_t        plane_id;
+    uint32_t        vblank_type;
+    vlc_tick_t      refresh_period;
+/*
+ * atomic commits of the video and subpicture planes together
+ */
+    bool            atomic;
+    uint32_t        plane_props[PLANE_PROP_COUNT];
+    uint32_t        spu_plane_props[PLANE_PROP_COUNT];
+/*
+ * subpicture overlay plane
+ */
+    uint32_t        spu_plane_id;
+    picture_t      *spu_buffers[2];
+    unsigned int    spu_back_buf;
+    bool            spu_visible;
+    bool            spu_changed;
+    struct VLC_VECTOR(struct spu_region_key) spu_regions;
 } vout_display_sys_t;
 
+static const vlc_fourcc_t spu_chromas[] = { VLC_CODEC_BGRA, 0 };
+
 static int Control(vout_display_t *vd, int query)
 {
     (void) vd;
@@ -84,28 +141,250 @@ static int Control(vout_display_t *vd, int query)
     return VLC_EGENERIC;
 }
 
+#ifdef HAVE_VAAPI
+static void ReleaseFrameBuffer(vout_display_t *vd, picture_t **pic,
+                               uint32_t *fb_id)
+{
+    if (*fb_id != 0) {
+        int fd = vd->cfg->window->display.drm_fd;
+
+        vlc_drm_ioctl(fd, DRM_IOCTL_MODE_RMFB, fb_id);
+        *fb_id = 0;
+    }
+    if (*pic != NULL) {
+        picture_Release(*pic);
+        *pic = NULL;
+    }
+}
+#endif
+
+/**
+ * Draws a subpicture region over the overlay buffer.
+ *
+ * The region is scaled with the nearest sample to its place, and composed
+ * with premultiplied alpha, which is what the planes expect by default.
+ */
+static void DrawRegion(picture_t *dst,
+                       const struct subpicture_region_rendered *r)
+{
+    const picture_t *src = r->p_picture;
+    const video_format_t *fmt = &src->format;
+    const plane_t *sp = &src->p[0];
+    plane_t *dp = &dst->p[0];
+
+    if (fmt->i_chroma != VLC_CODEC_BGRA || r->place.width <= 0
+     || r->place.height <= 0)
+        return;
+
+    const int x0 = __MAX(r->place.x, 0);
+    const int y0 = __MAX(r->place.y, 0);
+    const int x1 = __MIN(r->place.x + (int)r->place.width,
+                         (int)dst->format.i_visible_width);
+    const int y1 = __MIN(r->place.y + (int)r->place.height,
+                         (int)dst->format.i_visible_height);
+
+    for (int y = y0; y < y1; y++) {
+        const unsigned sy = fmt->i_y_offset + (uint64_t)(y - r->place.y)
+                          * fmt->i_visible_height / r->place.height;
+        const uint8_t *srow = &sp->p_pixels[sy * sp->i_pitch];
+        uint8_t *drow = &dp->p_pixels[y * dp->i_pitch];
+
+        for (int x = x0; x < x1; x++) {
+            const unsigned sx = fmt->i_x_offset + (uint64_t)(x - r->place.x)
+                              * fmt->i_visible_width / r->place.width;
+            const uint8_t *s = &srow[4 * sx];
+            uint8_t *d = &drow[4 * x];
+            const unsigned a = s[3] * r->i_alpha / 255;
+
+            if (a == 0)
+                continue;
+            for (int i = 0; i < 3; i++)
+                d[i] = (s[i] * a + d[i] * (255 - a)) / 255;
+            d[3] = a + d[3] * (255 - a) / 255;
+        }
+    }
+}
+
+/**
+ * Redraws the subpicture overlay if the regions changed.
+ */
+static void PrepareOverlay(vout_display_t *vd,
+                           const struct vlc_render_subpicture *subpic)
+{
+    vout_display_sys_t *sys = vd->sys;
+    const struct subpicture_region_rendered *r;
+    size_t count = subpic != NULL ? subpic->regions.size : 0;
+    bool changed = count != sys->spu_regions.size;
+
+    for (size_t i = 0; i < count && !changed; i++) {
+        const struct spu_region_key *key = &sys->spu_regions.data[i];
+
+        r = subpic->regions.data[i];
+        changed = key->pixels != r->p_picture->p[0].p_pixels
+               || key->x_offset != r->p_picture->format.i_x_offset
+               || key->y_offset != r->p_picture->format.i_y_offset
+               || key->width != r->p_picture->format.i_visible_width
+               || key->height != r->p_picture->format.i_visible_height
+               || memcmp(&key->place, &r->place, sizeof (key->place))
+               || key->alpha != r->i_alpha;
+    }
+
+    if (!changed)
+        return;
+
+    sys->spu_changed = true;
+    sys->spu_regions.size = 0;
+    sys->spu_visible = count > 0;
+    if (count == 0)
+        return;
+
+    picture_t *buf = sys->spu_buffers[sys->spu_back_buf];
+    plane_t *p = &buf->p[0];
+
+    memset(p->p_pixels, 0, p->i_pitch * p->i_lines);
+
+    vlc_vector_foreach(r, &subpic->regions) {
+        struct spu_region_key key = {
+            .pixels = r->p_picture->p[0].p_pixels,
+            .x_offset = r->p_picture->format.i_x_offset,
+            .y_offset = r->p_picture->format.i_y_offset,
+            .width = r->p_picture->format.i_visible_width,
+            .height = r->p_picture->format.i_visible_height,
+            .place = r->place,
+            .alpha = r->i_alpha,
+        };
+
+        DrawRegion(buf, r);
+        if (!vlc_vector_push(&sys->spu_regions, key))
+            sys->spu_regions.size = 0; /* redraw next time */
+    }
+}
+
+/**
+ * Sets planes, in a single atomic commit if supported.
+ */
+static int CommitPlanes(vout_display_t *vd,
+                        const struct drm_mode_set_plane *planes,
+                        const uint32_t *const *props, size_t count)
+{
+    vout_display_sys_t *sys = vd->sys;
+    int fd = vd->cfg->window->display.drm_fd;
+
+    if (!sys->atomic) {
+        for (size_t i = 0; i < count; i++)
+            if (vlc_drm_ioctl(fd, DRM_IOCTL_MODE_SETPLANE,
+                              (void *)&planes[i]) < 0)
+                return -1;
+        return 0;
+    }
+
+    uint32_t objs[2], counts[2];
+    uint32_t ids[2 * PLANE_PROP_COUNT];
+    uint64_t values[2 * PLANE_PROP_COUNT];
+
+    assert(count <= ARRAY_SIZE(objs));
+
+    for (size_t i = 0; i < count; i++) {
+        const struct drm_mode_set_plane *sp = &planes[i];
+        uint64_t *v = &values[i * PLANE_PROP_COUNT];
+
+        objs[i] = sp->plane_id;
+        counts[i] = PLANE_PROP_COUNT;
+        memcpy(&ids[i * PLANE_PROP_COUNT], props[i],
+               PLANE_PROP_COUNT * sizeof (*ids));
+        v[PLANE_PROP_FB_ID] = sp->fb_id;
+        v[PLANE_PROP_CRTC_ID] = sp->fb_id ? sp->crtc_id : 0;
+        v[PLANE_PROP_CRTC_X] = sp->crtc_x;
+        v[PLANE_PROP_CRTC_Y] = sp->crtc_y;
+        v[PLANE_PROP_CRTC_W] = sp->crtc_w;
+        v[PLANE_PROP_CRTC_H] = sp->crtc_h;
+        v[PLANE_PROP_SRC_X] = sp->src_x;
+        v[PLANE_PROP_SRC_Y] = sp->src_y;
+        v[PLANE_PROP_SRC_W] = sp->src_w;
+        v[PLANE_PROP_SRC_H] = sp->src_h;
+    }
+
+    struct drm_mode_atomic atomic = {
+        .count_objs = count,
+        .objs_ptr = (uintptr_t)(void *)objs,
+        .count_props_ptr = (uintptr_t)(void *)counts,
+        .props_ptr = (uintptr_t)(void *)ids,
+        .prop_values_ptr = (uintptr_t)(void *)values,
+    };
+
+    return vlc_drm_ioctl(fd, DRM_IOCTL_MODE_ATOMIC, &atomic);
+}
+
 static void Prepare(vout_display_t *vd, picture_t *pic,
                     const struct vlc_render_subpicture *subpic,
                     vlc_tick_t date)
 {
-    VLC_UNUSED(subpic); VLC_UNUSED(date);
+    VLC_UNUSED(date);
     vout_display_sys_t *sys = vd->sys;
 
+    if (sys->spu_plane_id != 0)
+        PrepareOverlay(vd, subpic);
+
+#ifdef HAVE_VAAPI
+    if (sys->zero_copy) {
+        int fd = vd->cfg->window->display.drm_fd;
+
+        ReleaseFrameBuffer(vd, &sys->next_pic, &sys->next_fb);
+        sys->next_fb = vlc_drm_vaapi_import(VLC_OBJECT(vd), fd, pic);
+        if (sys->next_fb != 0)
+            sys->next_pic = picture_Hold(pic);
+        return;
+    }
+#endif
     picture_Copy(sys->buffers[sys->front_buf], pic);
 }
 
+/**
+ * Reports the refresh following the last vertical blank as scan out time.
+ */
+static void ReportPresented(vout_display_t *vd)
+{
+    vout_display_sys_t *sys = vd->sys;
+    union drm_wait_vblank vbl = {
+        .request = {
+            .type = _DRM_VBLANK_RELATIVE | sys->vblank_type,
+            .sequence = 0,
+        },
+    };
+
+    if (sys->refresh_period == 0)
+        return;
+    if (vlc_drm_ioctl(vd->cfg->window->display.drm_fd, DRM_IOCTL_WAIT_VBLANK,
+                      &vbl) < 0)
+        return;
+
+    vlc_tick_t date = vlc_tick_from_sec(vbl.reply.tval_sec)
+                    + VLC_TICK_FROM_US(vbl.reply.tval_usec);
+    vout_display_SendEventPresented(vd, date + sys->refresh_period,
+                                    sys->refresh_period);
+}
+
 static void Display(vout_display_t *vd, picture_t *picture)
 {
     VLC_UNUSED(picture);
     vout_display_sys_t *sys = vd->sys;
     vlc_window_t *wnd = vd->cfg->window;
     const video_format_t *fmt = vd->fmt;
-    picture_t *pic = sys->buffers[sys->front_buf];
+    uint32_t fb_id;
+
+#ifdef HAVE_VAAPI
+    if (sys->zero_copy) {
+        if (sys->next_fb == 0)
+            return; /* import failed */
+        fb_id = sys->next_fb;
+    } else
+#endif
+        fb_id = vlc_drm_dumb_get_fb_id(sys->buffers[sys->front_buf]);
 
     struct drm_mode_set_plane sp = {
         .plane_id = sys->plane_id,
         .crtc_id = wnd->handle.crtc,
-        .fb_id = vlc_drm_dumb_get_fb_id(pic),
+        .fb_id = fb_id,
         .crtc_x = vd->place->x,
         .crtc_y = vd->place->y,
         .crtc_w = vd->place->width,
@@ -116,12 +395,56 @@ static void Display(vout_display_t *vd, picture_t *picture)
         .src_w = fmt->i_visible_width << 16,
         .src_h = fmt->i_visible_height << 16,
     };
+    struct drm_mode_set_plane planes[2] = { sp };
+    const uint32_t *props[2] = { sys->plane_props, sys->spu_plane_props };
+    size_t count = 1;
+
+    if (sys->spu_changed) {
+        /* The overlay covers the whole display */
+        const unsigned w = sys->spu_buffers[0]->format.i_visible_width;
+        const unsigned h = sys->spu_buffers[0]->format.i_visible_height;
+        picture_t *buf = sys->spu_buffers[sys->spu_back_buf];
+
+        planes[count++] = (struct drm_mode_set_plane) {
+            .plane_id = sys->spu_plane_id,
+            .crtc_id = wnd->handle.crtc,
+            .fb_id = sys->spu_visible ? vlc_drm_dumb_get_fb_id(buf) : 0,
+            .crtc_w = w,
+            .crtc_h = h,
+            .src_w = w << 16,
+            .src_h = h << 16,
+        };
+    }
 
-    if (vlc_drm_ioctl(wnd->display.drm_fd, DRM_IOCTL_MODE_SETPLANE, &sp) < 0) {
+    if (CommitPlanes(vd, planes, props, count) < 0) {
         msg_Err(vd, "DRM plane setting error: %s", vlc_strerror_c(errno));
+#ifdef HAVE_VAAPI
+        if (sys->zero_copy)
+            ReleaseFrameBuffer(vd, &sys->next_pic, &sys->next_fb);
+#endif
+        return;
+    }
+
+    if (sys->spu_changed) {
+        sys->spu_changed = false;
+        if (sys->spu_visible)
+            sys->spu_back_buf ^= 1;
+    }
+
+#ifdef HAVE_VAAPI
+    if (sys->zero_copy) {
+        /* The previous surface is not scanned out anymore */
+        ReleaseFrameBuffer(vd, &sys->front_pic, &sys->front_fb);
+        sys->front_pic = sys->next_pic;
+        sys->front_fb = sys->next_fb;
+        sys->next_pic = NULL;
+        sys->next_fb = 0;
+        ReportPresented(vd);
         return;
     }
+#endif
 
+    ReportPresented(vd);
     sys->front_buf++;
     if (sys->front_buf == MAXHWBUF)
         sys->front_buf = 0;
@@ -134,6 +457,23 @@ static void Close(vout_display_t *vd)
 {
     vout_display_sys_t *sys = vd->sys;
 
+    if (sys->spu_plane_id != 0) {
+        struct drm_mode_set_plane sp = { .plane_id = sys->spu_plane_id };
+        const uint32_t *props[] = { sys->spu_plane_props };
+
+        CommitPlanes(vd, &sp, props, 1);
+        for (size_t i = 0; i < ARRAY_SIZE(sys->spu_buffers); i++)
+            picture_Release(sys->spu_buffers[i]);
+    }
+    vlc_vector_destroy(&sys->spu_regions);
+
+#ifdef HAVE_VAAPI
+    if (sys->zero_copy) {
+        ReleaseFrameBuffer(vd, &sys->next_pic, &sys->next_fb);
+        ReleaseFrameBuffer(vd, &sys->front_pic, &sys->front_fb);
+        return;
+    }
+#endif
     for (size_t i = 0; i < ARRAY_SIZE(sys->buffers); i++)
         picture_Release(sys->buffers[i]);
 }
@@ -145,6 +485,83 @@ static const struct vlc_display_operations ops = {
     .control = Control,
 };
 
+static bool GetPlaneProps(int fd, uint_fast32_t plane, uint32_t *props)
+{
+    static const char names[PLANE_PROP_COUNT][8] = {
+        [PLANE_PROP_FB_ID] = "FB_ID",
+        [PLANE_PROP_CRTC_ID] = "CRTC_ID",
+        [PLANE_PROP_CRTC_X] = "CRTC_X",
+        [PLANE_PROP_CRTC_Y] = "CRTC_Y",
+        [PLANE_PROP_CRTC_W] = "CRTC_W",
+        [PLANE_PROP_CRTC_H] = "CRTC_H",
+        [PLANE_PROP_SRC_X] = "SRC_X",
+        [PLANE_PROP_SRC_Y] = "SRC_Y",
+        [PLANE_PROP_SRC_W] = "SRC_W",
+        [PLANE_PROP_SRC_H] = "SRC_H",
+    };
+
+    for (size_t i = 0; i < PLANE_PROP_COUNT; i++) {
+        props[i] = vlc_drm_get_plane_prop_id(fd, plane, names[i]);
+        if (props[i] == 0)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Sets up the subpicture overlay plane and atomic commits, if available.
+ *
+ * Subpictures are otherwise blended into the video by the core.
+ */
+static void OpenOverlay(vout_display_t *vd, int crtc_index)
+{
+    vout_display_sys_t *sys = vd->sys;
+    int fd = vd->cfg->window->display.drm_fd;
+    video_format_t fmt;
+
+    if (!var_InheritBool(vd, "kms-drm-overlay"))
+        return;
+
+    sys->spu_plane_id = vlc_drm_get_crtc_overlay_plane(fd, crtc_index,
+                                                       spu_chromas[0],
+                                                       sys->plane_id);
+    if (sys->spu_plane_id == 0) {
+        msg_Dbg(vd, "no DRM overlay plane for subpictures");
+        return;
+    }
+
+    video_format_Init(&fmt, spu_chromas[0]);
+    video_format_Setup(&fmt, spu_chromas[0],
+                       vd->cfg->display.width, vd->cfg->display.height,
+                       vd->cfg->display.width, vd->cfg->display.height, 1, 1);
+
+    for (size_t i = 0; i < ARRAY_SIZE(sys->spu_buffers); i++) {
+        sys->spu_buffers[i] = vlc_drm_dumb_alloc_fb(vd->obj.logger, fd, &fmt);
+        if (sys->spu_buffers[i] == NULL) {
+            while (i > 0)
+                picture_Release(sys->spu_buffers[--i]);
+            sys->spu_plane_id = 0;
+            return;
+        }
+    }
+
+    msg_Dbg(vd, "using DRM plane ID %"PRIu32" for subpictures",
+            sys->spu_plane_id);
+    vd->info.subpicture_chromas = spu_chromas;
+
+    /* Update both planes at once, so subtitles cannot show up over the
+     * wrong picture */
+    struct drm_set_client_cap cap = {
+        .capability = DRM_CLIENT_CAP_ATOMIC,
+        .value = 1,
+    };
+
+    sys->atomic = vlc_drm_ioctl(fd, DRM_IOCTL_SET_CLIENT_CAP, &cap) >= 0
+               && GetPlaneProps(fd, sys->plane_id, sys->plane_props)
+               && GetPlaneProps(fd, sys->spu_plane_id, sys->spu_plane_props);
+    msg_Dbg(vd, "atomic commits %s", sys->atomic ? "enabled" : "disabled");
+}
+
 /**
  * This function allocates and initializes a KMS vout method.
  */
@@ -165,6 +582,12 @@ static int Open(vout_display_t *vd,
     if (unlikely(sys == NULL))
         return VLC_ENOMEM;
 
+    sys->atomic = false;
+    sys->spu_plane_id = 0;
+    sys->spu_back_buf = 0;
+    sys->spu_visible = sys->spu_changed = false;
+    vlc_vector_init(&sys->spu_regions);
+
     char *chroma = var_InheritString(vd, "kms-drm-chroma");
     if (chroma) {
         memcpy(&drm_fourcc, chroma, strnlen(chroma, sizeof (drm_fourcc)));
@@ -195,6 +618,70 @@ static int Open(vout_display_t *vd,
 
     msg_Dbg(vd, "using DRM plane ID %"PRIu32, sys->plane_id);
 
+    /* Vertical blank timestamps are used as presentation feedback */
+    if (crtc_index > 1)
+        sys->vblank_type = (crtc_index << _DRM_VBLANK_HIGH_CRTC_SHIFT)
+                           & _DRM_VBLANK_HIGH_CRTC_MASK;
+    else
+        sys->vblank_type = crtc_index ? _DRM_VBLANK_SECONDARY : 0;
+
+    struct drm_mode_crtc crtc = { .crtc_id = wnd->handle.crtc };
+
+    sys->refresh_period = 0;
+    if (vlc_drm_ioctl(fd, DRM_IOCTL_MODE_GETCRTC, &crtc) >= 0
+     && crtc.mode_valid && crtc.mode.clock != 0) {
+        /* The pixel clock is in kHz */
+        sys->refresh_period = VLC_TICK_FROM_US(
+            UINT64_C(1000) * crtc.mode.htotal * crtc.mode.vtotal
+            / crtc.mode.clock);
+        msg_Dbg(vd, "refresh period: %"PRId64" us",
+                US_FROM_VLC_TICK(sys->refresh_period));
+    }
+
+#ifdef HAVE_VAAPI
+    sys->zero_copy = false;
+    if (drm_fourcc == 0 && context != NULL
+     && vlc_video_context_GetType(context) == VLC_VIDEO_CONTEXT_VAAPI
+     && vd->source->orientation == ORIENT_NORMAL) {
+        /* Scan the decoded surfaces out directly if the plane can take them,
+         * otherwise let the converter read them back */
+        vlc_fourcc_t sw_chroma = 0;
+
+        switch (vd->source->i_chroma) {
+            case VLC_CODEC_VAAPI_420:
+                sw_chroma = VLC_CODEC_NV12;
+                break;
+            case VLC_CODEC_VAAPI_420_10BPP:
+                sw_chroma = VLC_CODEC_P010;
+                break;
+        }
+
+        uint_fast32_t plane_id = 0;
+
+        if (sw_chroma != 0) {
+            if (vlc_drm_find_best_format(fd, sys->plane_id, nfmt, sw_chroma)
+                    == vlc_drm_fourcc(sw_chroma))
+                plane_id = sys->plane_id;
+            else /* Scan out on a YUV overlay plane instead */
+                plane_id = vlc_drm_get_crtc_overlay_plane(fd, crtc_index,
+                                                          sw_chroma, 0);
+        }
+
+        if (plane_id != 0) {
+            msg_Dbg(vd, "using zero-copy VA-API surfaces on plane ID %"
+                    PRIuFAST32, plane_id);
+            sys->plane_id = plane_id;
+            sys->zero_copy = true;
+            sys->next_pic = sys->front_pic = NULL;
+            sys->next_fb = sys->front_fb = 0;
+            vd->sys = sys;
+            vd->ops = &ops;
+            OpenOverlay(vd, crtc_index);
+            return VLC_SUCCESS;
+        }
+    }
+#endif
+
     if (drm_fourcc == 0) {
         drm_fourcc = vlc_drm_find_best_format(fd, sys->plane_id, nfmt,
                                               vd->source->i_chroma);
@@ -231,6 +718,7 @@ static int Open(vout_display_t *vd,
     *fmtp = fmt;
     vd->sys = sys;
     vd->ops = &ops;
+    OpenOverlay(vd, crtc_index);
 
     (void) context;
     return VLC_SUCCESS;
@@ -247,6 +735,7 @@ vlc_module_begin ()
 
     add_obsolete_string("kms-vlc-chroma") /* since 4.0.0 */
     add_string( "kms-drm-chroma", NULL, DRM_CHROMA_TEXT, DRM_CHROMA_LONGTEXT)
+    add_bool( "kms-drm-overlay", true, DRM_OVERLAY_TEXT, DRM_OVERLAY_LONGTEXT)
     set_description("Direct rendering management video output")
     set_callback_display(Open, 30)
 vlc_module_end ()
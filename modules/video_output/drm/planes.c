@@ -79,7 +79,8 @@ static bool vlc_drm_prop_match(int fd, uint_fast32_t pid, const char *name)
 }
 
 static int vlc_drm_get_prop(int fd, uint_fast32_t oid, uint_fast32_t tid,
-                            const char *name, uint64_t *restrict valp)
+                            const char *name, uint32_t *restrict idp,
+                            uint64_t *restrict valp)
 {
     struct drm_mode_obj_get_properties counter = {
         .obj_id = oid,
@@ -122,6 +123,8 @@ static int vlc_drm_get_prop(int fd, uint_fast32_t oid, uint_fast32_t tid,
     /* NOTE: if more than one property is needed, rethink this function */
     for (size_t i = 0; i < props.count_props; i++) {
         if (vlc_drm_prop_match(fd, ids[i], name)) {
+            if (idp != NULL)
+                *idp = ids[i];
             *valp = values[i];
             ret = 0;
             goto out;
@@ -137,7 +140,20 @@ out:
 static int vlc_drm_get_plane_prop(int fd, uint_fast32_t plane,
                                   const char *name, uint64_t *restrict valp)
 {
-    return vlc_drm_get_prop(fd, plane, DRM_MODE_OBJECT_PLANE, name, valp);
+    return vlc_drm_get_prop(fd, plane, DRM_MODE_OBJECT_PLANE, name, NULL,
+                            valp);
+}
+
+uint_fast32_t vlc_drm_get_plane_prop_id(int fd, uint_fast32_t plane,
+                                        const char *name)
+{
+    uint32_t id;
+    uint64_t value;
+
+    if (vlc_drm_get_prop(fd, plane, DRM_MODE_OBJECT_PLANE, name, &id,
+                         &value))
+        return 0;
+    return id;
 }
 
 static ssize_t vlc_drm_get_planes(int fd, uint32_t **restrict listp)
@@ -200,6 +216,44 @@ out:
     return ret;
 }
 
+uint_fast32_t vlc_drm_get_crtc_overlay_plane(int fd, unsigned int idx,
+                                             vlc_fourcc_t chroma,
+                                             uint_fast32_t exclude)
+{
+    assert(idx < 32); /* Don't mix up object IDs and indices! */
+
+    uint32_t *planes;
+    ssize_t count = vlc_drm_get_planes(fd, &planes);
+    if (count < 0)
+        return 0;
+
+    const uint_fast32_t drm_fourcc = vlc_drm_fourcc(chroma);
+    uint_fast32_t ret = 0;
+
+    for (ssize_t i = 0; i < count; i++) {
+        struct drm_mode_get_plane plane = {
+            .plane_id = planes[i],
+        };
+        uint64_t planetype;
+
+        if (planes[i] != exclude
+         && vlc_drm_ioctl(fd, DRM_IOCTL_MODE_GETPLANE, &plane) >= 0
+         && ((plane.possible_crtcs >> idx) & 1)
+         && vlc_drm_get_plane_prop(fd, planes[i], "type", &planetype) == 0
+         && planetype == VLC_DRM_PLANE_TYPE_OVERLAY
+         && drm_fourcc != 0
+         && vlc_drm_find_best_format(fd, planes[i], plane.count_format_types,
+                                     chroma) == drm_fourcc) {
+            ret = planes[i];
+            goto out;
+        }
+    }
+    errno = ENXIO;
+out:
+    free(planes);
+    return ret;
+}
+
 static uint_fast32_t vlc_drm_find_format(vlc_fourcc_t vlc_fourcc, size_t n,
                                          const uint32_t *restrict drm_fourccs)
 {
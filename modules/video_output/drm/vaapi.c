@@ -0,0 +1,131 @@
+/**
+ * @file vaapi.c
+ * @brief DRM frame buffers from VA-API surfaces
+ */
+/*****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <unistd.h>
+#ifndef HAVE_LIBDRM
+# include <drm/drm_fourcc.h>
+# include <drm/drm_mode.h>
+#else
+# include <drm_fourcc.h>
+# include <drm_mode.h>
+#endif
+#include <vlc_common.h>
+#include <vlc_picture.h>
+#include "vlc_drm.h"
+#include "../../hw/vaapi/vlc_vaapi.h"
+#include <va/va_drmcommon.h>
+
+#if VA_CHECK_VERSION(1, 1, 0)
+uint32_t vlc_drm_vaapi_import(vlc_object_t *obj, int fd, picture_t *pic)
+{
+    VADisplay dpy = vlc_vaapi_PicGetDisplay(pic);
+    VASurfaceID surface = vlc_vaapi_PicGetSurface(pic);
+    VADRMPRIMESurfaceDescriptor desc;
+    uint32_t handles[ARRAY_SIZE(desc.objects)] = { 0 };
+    uint32_t fb_id = 0;
+
+    VAStatus status = vaSyncSurface(dpy, surface);
+    if (status != VA_STATUS_SUCCESS) {
+        msg_Err(obj, "vaSyncSurface: %s", vaErrorStr(status));
+        return 0;
+    }
+
+    /* A single layer with all the planes, as expected by ADDFB2 */
+    if (vlc_vaapi_ExportSurfaceHandle(obj, dpy, surface,
+                                      VA_SURFACE_ATTRIB_MEM_TYPE_DRM_PRIME_2,
+                                      VA_EXPORT_SURFACE_READ_ONLY |
+                                      VA_EXPORT_SURFACE_COMPOSED_LAYERS,
+                                      &desc))
+        return 0;
+
+    if (desc.num_layers != 1) {
+        msg_Err(obj, "unsupported surface layout (%"PRIu32" layers)",
+                desc.num_layers);
+        goto out;
+    }
+
+    for (uint32_t i = 0; i < desc.num_objects; i++) {
+        struct drm_prime_handle prime = {
+            .fd = desc.objects[i].fd,
+        };
+
+        if (vlc_drm_ioctl(fd, DRM_IOCTL_PRIME_FD_TO_HANDLE, &prime) < 0) {
+            msg_Err(obj, "DRM PRIME import error: %s", vlc_strerror_c(errno));
+            goto out;
+        }
+        handles[i] = prime.handle;
+    }
+
+    struct drm_mode_fb_cmd2 cmd = {
+        .width = desc.width,
+        .height = desc.height,
+        .pixel_format = desc.layers[0].drm_format,
+    };
+
+    for (uint32_t i = 0; i < desc.layers[0].num_planes; i++) {
+        uint32_t idx = desc.layers[0].object_index[i];
+        uint64_t modifier = desc.objects[idx].drm_format_modifier;
+
+        cmd.handles[i] = handles[idx];
+        cmd.pitches[i] = desc.layers[0].pitch[i];
+        cmd.offsets[i] = desc.layers[0].offset[i];
+        cmd.modifier[i] = modifier;
+        if (modifier != DRM_FORMAT_MOD_INVALID)
+            cmd.flags = DRM_MODE_FB_MODIFIERS;
+    }
+
+    if (vlc_drm_ioctl(fd, DRM_IOCTL_MODE_ADDFB2, &cmd) < 0)
+        msg_Err(obj, "DRM frame buffer error: %s", vlc_strerror_c(errno));
+    else
+        fb_id = cmd.fb_id;
+out:
+    /* The frame buffer keeps its own references to the buffer objects */
+    for (uint32_t i = 0; i < desc.num_objects; i++) {
+        bool dup = false;
+
+        for (uint32_t j = 0; j < i; j++)
+            if (handles[j] == handles[i])
+                dup = true;
+
+        if (handles[i] != 0 && !dup) {
+            struct drm_gem_close gc = {
+                .handle = handles[i],
+            };
+
+            vlc_drm_ioctl(fd, DRM_IOCTL_GEM_CLOSE, &gc);
+        }
+        close(desc.objects[i].fd);
+    }
+    return fb_id;
+}
+#else
+uint32_t vlc_drm_vaapi_import(vlc_object_t *obj, int fd, picture_t *pic)
+{
+    VLC_UNUSED(fd); VLC_UNUSED(pic);
+    msg_Err(obj, "VA-API surface export not supported");
+    return 0;
+}
+#endif
@@ -71,6 +71,22 @@ picture_t *vlc_drm_dumb_alloc_fb(struct vlc_logger *, int fd,
 
 uint32_t vlc_drm_dumb_get_fb_id(const picture_t *pic);
 
+#ifdef HAVE_VAAPI
+/**
+ * Imports a VA-API surface as a DRM frame buffer.
+ *
+ * The surface is exported as DMA-BUF objects, with their format modifiers,
+ * and wrapped into a frame buffer without any copy.
+ * The frame buffer must be removed with DRM_IOCTL_MODE_RMFB after use.
+ *
+ * \param fd DRM device file descriptor
+ * \param pic VA-API picture
+ * 
+eturn the frame buffer object ID, or zero on error.
+ */
+uint32_t vlc_drm_vaapi_import(vlc_object_t *, int fd, picture_t *pic);
+#endif
+
 /**
  * Finds the index of a CRTC.
  *
@@ -95,6 +111,30 @@ int vlc_drm_get_crtc_index(int fd, uint_fast32_t crtc_id);
 uint_fast32_t vlc_drm_get_crtc_primary_plane(int fd, unsigned int idx,
                                              size_t *nfmts);
 
+/**
+ * Finds an overlay plane of a CRTC.
+ *
+ * \param fd DRM device file descriptor
+ * \param idx CRTC object index (as returned by vlc_drm_get_crtc_index())
+ * \param chroma VLC pixel format that the plane must support exactly
+ * \param exclude plane object ID to skip (e.g. already in use), or zero
+ * \return the overlay plane object ID or zero on error
+ */
+uint_fast32_t vlc_drm_get_crtc_overlay_plane(int fd, unsigned int idx,
+                                             vlc_fourcc_t chroma,
+                                             uint_fast32_t exclude);
+
+/**
+ * Finds a plane property.
+ *
+ * \param fd DRM device file descriptor
+ * \param plane DRM plane object ID
+ * \param name property name
+ * \return the property object ID or zero on error
+ */
+uint_fast32_t vlc_drm_get_plane_prop_id(int fd, uint_fast32_t plane,
+                                        const char *name);
+
 /**
  * Finds the best matching DRM format.
  *
@@ -30,6 +30,7 @@
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_vout_display.h>
+#include <vlc_codec.h>
 #include <vlc_fs.h>
 #include <vlc_subpicture.h>
 
@@ -39,6 +40,7 @@
 #include <libplacebo/renderer.h>
 #include <libplacebo/utils/upload.h>
 #include <libplacebo/swapchain.h>
+#include <libplacebo/utils/frame_queue.h>
 #include <libplacebo/shaders/lut.h>
 
 typedef struct vout_display_sys_t
@@ -76,8 +78,26 @@ typedef struct vout_display_sys_t
     char *hook_path;
 
     struct pl_dovi_metadata dovi_metadata;
+
+    // Frame mixing, NULL unless enabled
+    pl_queue queue;
+    vlc_tick_t queued_pts;      // stream date of the last queued picture
+    vlc_tick_t queued_date;     // system date of the last queued picture
+    vlc_tick_t frame_duration;
+    vlc_tick_t last_date;       // system date of the last rendering
+    vlc_tick_t vsync_duration;
+
+    uint64_t gpu_time; // GPU time of the current rendering, in ns
 } vout_display_sys_t;
 
+// Picture held by the frame queue
+struct queued_picture
+{
+    vout_display_t *vd;
+    picture_t *pic;
+    struct pl_dovi_metadata dovi_metadata;
+};
+
 // Display callbacks
 static void PictureRender(vout_display_t *, picture_t *, const vlc_render_subpicture *, vlc_tick_t);
 static void PictureDisplay(vout_display_t *, picture_t *);
@@ -105,9 +125,13 @@ static int Open(vout_display_t *vd,
     if (unlikely(sys == NULL))
         return VLC_ENOMEM;
 
+    vlc_decoder_device *dec_device = context ?
+        vlc_video_context_HoldDevice(context) : NULL;
     char *name = var_InheritString(vd, "pl-gpu");
-    sys->pl = vlc_placebo_Create(vd->cfg, name);
+    sys->pl = vlc_placebo_Create(vd->cfg, dec_device, name);
     free(name);
+    if (dec_device != NULL)
+        vlc_decoder_device_Release(dec_device);
     if (sys->pl == NULL)
         return VLC_EGENERIC;
 
@@ -133,8 +157,16 @@ static int Open(vout_display_t *vd,
 
     vlc_placebo_ReleaseCurrent(sys->pl);
 
-    // Attempt using the input format as the display format
-    if (vlc_placebo_FormatSupported(gpu, vd->source->i_chroma)) {
+    if (context != NULL
+     && vlc_video_context_GetType(context) == VLC_VIDEO_CONTEXT_VULKAN) {
+        // Decoded images can only be rendered on the decoder's device
+        if (sys->pl->ops->map_picture == NULL) {
+            msg_Err(vd, "GPU instance not shared with the decoder");
+            goto error;
+        }
+        fmt->i_chroma = vd->source->i_chroma;
+    } else if (vlc_placebo_FormatSupported(gpu, vd->source->i_chroma)) {
+        // Attempt using the input format as the display format
         fmt->i_chroma = vd->source->i_chroma;
     } else {
         fmt->i_chroma = 0;
@@ -176,7 +208,31 @@ static int Open(vout_display_t *vd,
     vd->ops = &ops;
 
     UpdateParams(vd);
-    (void) context;
+
+    if (sys->params.frame_mixer != NULL) {
+        if (context != NULL
+         && vlc_video_context_GetType(context) == VLC_VIDEO_CONTEXT_VULKAN) {
+            // The decoder images cannot be held for several refreshes
+            msg_Warn(vd, "Frame mixing is not available for decoder images");
+            sys->params.frame_mixer = NULL;
+        } else {
+            sys->queue = pl_queue_create(gpu);
+        }
+    }
+
+    if (sys->queue != NULL) {
+        sys->queued_pts = VLC_TICK_INVALID;
+        sys->queued_date = VLC_TICK_INVALID;
+        sys->last_date = VLC_TICK_INVALID;
+        sys->frame_duration = vd->source->i_frame_rate_base != 0
+            ? vlc_tick_from_samples(vd->source->i_frame_rate_base,
+                                    vd->source->i_frame_rate)
+            : VLC_TICK_FROM_MS(40);
+        sys->vsync_duration = sys->frame_duration;
+        vd->info.mixes_frames = true;
+    } else {
+        sys->params.frame_mixer = NULL;
+    }
     return VLC_SUCCESS;
 
 error:
@@ -186,12 +242,24 @@ error:
     return VLC_EGENERIC;
 }
 
+/* Vulkan decoder images can only be rendered here */
+static int OpenVulkan(vout_display_t *vd,
+                      video_format_t *fmt, vlc_video_context *context)
+{
+    if (context == NULL
+     || vlc_video_context_GetType(context) != VLC_VIDEO_CONTEXT_VULKAN)
+        return VLC_EGENERIC;
+
+    return Open(vd, fmt, context);
+}
+
 static void Close(vout_display_t *vd)
 {
     vout_display_sys_t *sys = vd->sys;
     pl_gpu gpu = sys->pl->gpu;
 
     if (vlc_placebo_MakeCurrent(sys->pl) == VLC_SUCCESS) {
+        pl_queue_destroy(&sys->queue);
         for (int i = 0; i < 4; i++)
             pl_tex_destroy(gpu, &sys->plane_tex[i]);
         for (int i = 0; i < sys->num_overlays; i++)
@@ -215,32 +283,14 @@ static void Close(vout_display_t *vd)
     vlc_placebo_Release(sys->pl);
 }
 
-static void PictureRender(vout_display_t *vd, picture_t *pic,
-                          const vlc_render_subpicture *subpicture,
-                          vlc_tick_t date)
+// Describes a picture as a libplacebo frame, without its planes
+static void FrameFromPicture(vout_display_t *vd, picture_t *pic,
+                             struct pl_dovi_metadata *dovi_metadata,
+                             struct pl_frame *img)
 {
-    VLC_UNUSED(date);
     vout_display_sys_t *sys = vd->sys;
-    pl_gpu gpu = sys->pl->gpu;
-    bool failed = false;
-
-    if (vlc_placebo_MakeCurrent(sys->pl) != VLC_SUCCESS)
-        return;
-
-    struct pl_swapchain_frame frame;
-    if (!pl_swapchain_start_frame(sys->pl->swapchain, &frame)) {
-        vlc_placebo_ReleaseCurrent(sys->pl);
-        return; // Probably benign error, ignore it
-    }
-    sys->fbo = frame.fbo;
-
-#if PL_API_VER >= 199
-    bool need_vflip = false;
-#else
-    bool need_vflip = frame.flipped;
-#endif
 
-    struct pl_frame img = {
+    *img = (struct pl_frame) {
         .num_planes = pic->i_planes,
         .color      = vlc_placebo_ColorSpace(vd->fmt),
         .repr       = vlc_placebo_ColorRepr(vd->fmt),
@@ -252,23 +302,76 @@ static void PictureRender(vout_display_t *vd, picture_t *pic,
         },
     };
 
-    vlc_placebo_frame_DoviMetadata(&img, pic, &sys->dovi_metadata);
+    vlc_placebo_frame_DoviMetadata(img, pic, dovi_metadata);
 
     struct vlc_ancillary *iccp = picture_GetAncillary(pic, VLC_ANCILLARY_ID_ICC);
     if (iccp) {
         vlc_icc_profile_t *icc = vlc_ancillary_GetData(iccp);
-        img.profile.data = icc->data;
-        img.profile.len = icc->size;
-        pl_icc_profile_compute_signature(&img.profile);
+        img->profile.data = icc->data;
+        img->profile.len = icc->size;
+        pl_icc_profile_compute_signature(&img->profile);
     }
 
     struct vlc_ancillary *hdrplus = picture_GetAncillary(pic, VLC_ANCILLARY_ID_HDR10PLUS);
     if (hdrplus) {
         vlc_video_hdr_dynamic_metadata_t *hdm = vlc_ancillary_GetData(hdrplus);
-        vlc_placebo_HdrMetadata(hdm, &img.color.hdr);
+        vlc_placebo_HdrMetadata(hdm, &img->color.hdr);
+    }
+
+#define SWAP(a, b) { float _tmp = (a); (a) = (b); (b) = _tmp; }
+    switch (vd->fmt->orientation) {
+    case ORIENT_HFLIPPED:
+        SWAP(img->crop.x0, img->crop.x1);
+        break;
+    case ORIENT_VFLIPPED:
+        SWAP(img->crop.y0, img->crop.y1);
+        break;
+    case ORIENT_ROTATED_90:
+        img->rotation = PL_ROTATION_90;
+        break;
+    case ORIENT_ROTATED_180:
+        img->rotation = PL_ROTATION_180;
+        break;
+    case ORIENT_ROTATED_270:
+        img->rotation = PL_ROTATION_270;
+        break;
+    case ORIENT_TRANSPOSED:
+        img->rotation = PL_ROTATION_90;
+        SWAP(img->crop.y0, img->crop.y1);
+        break;
+    case ORIENT_ANTI_TRANSPOSED:
+        img->rotation = PL_ROTATION_90;
+        SWAP(img->crop.x0, img->crop.x1);
+    default:
+        break;
     }
+#undef SWAP
+
+    if (sys->lut_mode == LUT_DECODING) {
+        img->lut_type = PL_LUT_CONVERSION;
+        img->lut = sys->lut;
+    }
+}
+
+// Matches only the chroma planes, never luma or alpha
+static void ShiftChromaPlanes(vout_display_sys_t *sys, struct pl_frame *img)
+{
+    if (sys->yuv_chroma_loc == PL_CHROMA_UNKNOWN)
+        return;
+
+    for (int i = 1; i < __MIN(img->num_planes, 3); i++)
+        pl_chroma_location_offset(sys->yuv_chroma_loc,
+                                  &img->planes[i].shift_x,
+                                  &img->planes[i].shift_y);
+}
+
+// Uploads the image data for each plane
+static bool UploadPicture(vout_display_t *vd, picture_t *pic, pl_tex tex[4],
+                          struct pl_frame *img)
+{
+    vout_display_sys_t *sys = vd->sys;
+    pl_gpu gpu = sys->pl->gpu;
 
-    // Upload the image data for each plane
     struct pl_plane_data data[4];
     if (!vlc_placebo_PlaneData(pic, data)) {
         // This should never happen, in theory
@@ -276,18 +379,113 @@ static void PictureRender(vout_display_t *vd, picture_t *pic,
     }
 
     for (int i = 0; i < pic->i_planes; i++) {
-        struct pl_plane *plane = &img.planes[i];
-        if (!pl_upload_plane(gpu, plane, &sys->plane_tex[i], &data[i])) {
+        if (!pl_upload_plane(gpu, &img->planes[i], &tex[i], &data[i])) {
             msg_Err(vd, "Failed uploading image data!");
-            failed = true;
-            goto done;
+            return false;
+        }
+    }
+
+    ShiftChromaPlanes(sys, img);
+    return true;
+}
+
+// Frame queue callbacks, the pictures are uploaded when first needed
+static bool MapQueuedPicture(pl_gpu gpu, pl_tex *tex,
+                             const struct pl_source_frame *src,
+                             struct pl_frame *out)
+{
+    struct queued_picture *qp = src->frame_data;
+    VLC_UNUSED(gpu);
+
+    FrameFromPicture(qp->vd, qp->pic, &qp->dovi_metadata, out);
+    return UploadPicture(qp->vd, qp->pic, tex, out);
+}
+
+static void DiscardQueuedPicture(const struct pl_source_frame *src)
+{
+    struct queued_picture *qp = src->frame_data;
+
+    picture_Release(qp->pic);
+    free(qp);
+}
+
+static void UnmapQueuedPicture(pl_gpu gpu, struct pl_frame *frame,
+                               const struct pl_source_frame *src)
+{
+    VLC_UNUSED(gpu); VLC_UNUSED(frame);
+    DiscardQueuedPicture(src);
+}
+
+static void QueuePicture(vout_display_t *vd, picture_t *pic, vlc_tick_t date)
+{
+    vout_display_sys_t *sys = vd->sys;
+
+    if (pic->date == sys->queued_pts)
+        return; // displayed again, already queued
+
+    if (sys->queued_date != VLC_TICK_INVALID) {
+        if (date <= sys->queued_date) {
+            // Discontinuity (seek, rate change...)
+            pl_queue_reset(sys->queue);
+        } else {
+            sys->frame_duration = date - sys->queued_date;
         }
+    }
+
+    struct queued_picture *qp = malloc(sizeof (*qp));
+    if (unlikely(qp == NULL))
+        return;
+    qp->vd = vd;
+    qp->pic = picture_Hold(pic);
+
+    pl_queue_push(sys->queue, &(struct pl_source_frame) {
+        .pts        = secf_from_vlc_tick(date),
+        .frame_data = qp,
+        .map        = MapQueuedPicture,
+        .unmap      = UnmapQueuedPicture,
+        .discard    = DiscardQueuedPicture,
+    });
+
+    sys->queued_pts = pic->date;
+    sys->queued_date = date;
+}
+
+#if PL_API_VER >= 200
+static void RenderInfo(void *priv, const struct pl_render_info *info)
+{
+    vout_display_sys_t *sys = priv;
 
-        // Matches only the chroma planes, never luma or alpha
-        if (sys->yuv_chroma_loc != PL_CHROMA_UNKNOWN && i != 0 && i != 3)
-            pl_chroma_location_offset(sys->yuv_chroma_loc, &plane->shift_x,
-                                      &plane->shift_y);
+    // Timer queries are asynchronous: this is the last known duration
+    sys->gpu_time += info->pass->last;
+}
+#endif
+
+static void PictureRender(vout_display_t *vd, picture_t *pic,
+                          const vlc_render_subpicture *subpicture,
+                          vlc_tick_t date)
+{
+    vout_display_sys_t *sys = vd->sys;
+    pl_gpu gpu = sys->pl->gpu;
+    bool failed = false;
+    bool mapped = false;
+    struct pl_frame img;
+
+    if (vlc_placebo_MakeCurrent(sys->pl) != VLC_SUCCESS)
+        return;
+
+    struct pl_swapchain_frame frame;
+    if (!pl_swapchain_start_frame(sys->pl->swapchain, &frame)) {
+        vlc_placebo_ReleaseCurrent(sys->pl);
+        return; // Probably benign error, ignore it
     }
+    sys->fbo = frame.fbo;
+    sys->gpu_time = 0;
+
+#if PL_API_VER >= 199
+    bool need_vflip = false;
+#else
+    bool need_vflip = frame.flipped;
+#endif
 
     struct pl_frame target;
     pl_frame_from_swapchain(&target, &frame);
@@ -309,38 +507,9 @@ static void PictureRender(vout_display_t *vd, picture_t *pic,
         place.height = -place.height;
     }
 
-#define SWAP(a, b) { float _tmp = (a); (a) = (b); (b) = _tmp; }
-    switch (vd->fmt->orientation) {
-    case ORIENT_HFLIPPED:
-        SWAP(img.crop.x0, img.crop.x1);
-        break;
-    case ORIENT_VFLIPPED:
-        SWAP(img.crop.y0, img.crop.y1);
-        break;
-    case ORIENT_ROTATED_90:
-        img.rotation = PL_ROTATION_90;
-        break;
-    case ORIENT_ROTATED_180:
-        img.rotation = PL_ROTATION_180;
-        break;
-    case ORIENT_ROTATED_270:
-        img.rotation = PL_ROTATION_270;
-        break;
-    case ORIENT_TRANSPOSED:
-        img.rotation = PL_ROTATION_90;
-        SWAP(img.crop.y0, img.crop.y1);
-        break;
-    case ORIENT_ANTI_TRANSPOSED:
-        img.rotation = PL_ROTATION_90;
-        SWAP(img.crop.x0, img.crop.x1);
-    default:
-        break;
-    }
-
     target.crop = (struct pl_rect2df) {
         place.x, place.y, place.x + place.width, place.y + place.height,
     };
-
     // Override the target colorimetry only if the user requests it
     if (sys->target.primaries)
         target.color.primaries = sys->target.primaries;
@@ -428,15 +597,54 @@ static void PictureRender(vout_display_t *vd, picture_t *pic,
         pl_tex_clear(gpu, frame.fbo, (float[4]){ 0.0, 0.0, 0.0, 0.0 });
     // }
 
-    switch (sys->lut_mode) {
-    case LUT_DECODING:
-        img.lut_type = PL_LUT_CONVERSION;
-        img.lut = sys->lut;
-        break;
-    case LUT_ENCODING:
+    if (sys->lut_mode == LUT_ENCODING) {
         target.lut_type = PL_LUT_CONVERSION;
         target.lut = sys->lut;
-        break;
+    }
+
+    if (sys->queue != NULL) {
+        // Estimate the refresh period from the redisplays
+        if (sys->last_date != VLC_TICK_INVALID && date > sys->last_date
+         && date - sys->last_date < sys->frame_duration)
+            sys->vsync_duration = (3 * sys->vsync_duration
+                                   + date - sys->last_date) / 4;
+        sys->last_date = date;
+
+        QueuePicture(vd, pic, date);
+
+        // Render one frame behind, the next frame is needed for mixing
+        struct pl_frame_mix mix;
+        enum pl_queue_status status =
+            pl_queue_update(sys->queue, &mix, &(struct pl_queue_params) {
+                .pts            = secf_from_vlc_tick(date - sys->frame_duration),
+                .radius         = pl_frame_mix_radius(&sys->params),
+                .vsync_duration = secf_from_vlc_tick(sys->vsync_duration),
+            });
+
+        if (status == PL_QUEUE_OK) {
+            if (!pl_render_image_mix(sys->renderer, &mix, &target, &sys->params)) {
+                msg_Err(vd, "Failed rendering frame!");
+                failed = true;
+            }
+            goto done;
+        }
+        // Not enough frames yet, render the picture on its own
+    }
+
+    FrameFromPicture(vd, pic, &sys->dovi_metadata, &img);
+
+    if (pic->context != NULL && sys->pl->ops->map_picture != NULL) {
+        // Render the decoded image in place
+        if (sys->pl->ops->map_picture(sys->pl, pic, &img) != VLC_SUCCESS) {
+            msg_Err(vd, "Failed mapping image data!");
+            failed = true;
+            goto done;
+        }
+        mapped = true;
+        ShiftChromaPlanes(sys, &img);
+    } else if (!UploadPicture(vd, pic, sys->plane_tex, &img)) {
+        failed = true;
+        goto done;
     }
 
     // Dispatch the actual image rendering with the pre-configured parameters
@@ -451,9 +659,15 @@ done:
     if (failed)
         pl_tex_clear(gpu, frame.fbo, (float[4]){ 1.0, 0.0, 0.0, 1.0 });
 
+    if (mapped)
+        sys->pl->ops->unmap_picture(sys->pl, pic, &img);
+
     pl_gpu_flush(gpu);
 
     vlc_placebo_ReleaseCurrent(sys->pl);
+
+    if (sys->gpu_time > 0)
+        vout_display_SendEventRendered(vd, VLC_TICK_FROM_NS(sys->gpu_time));
 }
 
 static void PictureDisplay(vout_display_t *vd, picture_t *pic)
@@ -685,6 +899,9 @@ vlc_module_begin ()
             LUT_ENTRIES_TEXT, LUT_ENTRIES_LONGTEXT)
     add_float_with_range("pl-antiringing", 0.0,
             0.0, 1.0, ANTIRING_TEXT, ANTIRING_LONGTEXT)
+    add_integer("pl-frame-mixer", MIXER_NONE,
+            FRAME_MIXER_TEXT, FRAME_MIXER_LONGTEXT)
+            change_integer_list(frame_mixer_values, frame_mixer_text)
     add_bool("pl-sigmoid", !!pl_render_default_params.sigmoid_params,
             SIGMOID_TEXT, SIGMOID_LONGTEXT)
     add_float_with_range("pl-sigmoid-center", pl_sigmoid_default_params.center,
@@ -782,6 +999,9 @@ vlc_module_begin ()
     add_bool("pl-force-general", false, FORCE_GENERAL_TEXT, FORCE_GENERAL_LONGTEXT)
     add_bool("pl-delayed-peak", false, DELAYED_PEAK_TEXT, DELAYED_PEAK_LONGTEXT)
 
+    add_submodule ()
+    set_callback_display(OpenVulkan, 290)
+
 vlc_module_end ()
 
 // Update the renderer settings based on the current configuration.
@@ -825,6 +1045,11 @@ static void UpdateParams(vout_display_t *vd)
     sys->params.polar_cutoff = var_InheritFloat(vd, "pl-polar-cutoff");
     sys->params.disable_linear_scaling = var_InheritBool(vd, "pl-disable-linear");
     sys->params.disable_builtin_scalers = var_InheritBool(vd, "pl-force-general");
+    sys->params.frame_mixer = frame_mixer_config[var_InheritInteger(vd, "pl-frame-mixer")];
+#if PL_API_VER >= 200
+    sys->params.info_callback = RenderInfo;
+    sys->params.info_priv = sys;
+#endif
 
     sys->peak_detect.smoothing_period = var_InheritFloat(vd, "pl-peak-period");
     sys->peak_detect.scene_threshold_low = var_InheritFloat(vd, "pl-scene-threshold-low");
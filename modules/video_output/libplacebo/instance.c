@@ -36,11 +36,13 @@
 
 static int vlc_placebo_start(void *func, bool forced, va_list ap)
 {
-    int (*activate)(vlc_placebo_t *, const vout_display_cfg_t *) = func;
+    int (*activate)(vlc_placebo_t *, const vout_display_cfg_t *,
+                    vlc_decoder_device *) = func;
     vlc_placebo_t *pl = va_arg(ap, vlc_placebo_t *);
     const vout_display_cfg_t *cfg = va_arg(ap, const vout_display_cfg_t *);
+    vlc_decoder_device *dec_device = va_arg(ap, vlc_decoder_device *);
 
-    int ret = activate(pl, cfg);
+    int ret = activate(pl, cfg, dec_device);
     /* TODO: vlc_objres_clear, which is not in the public API. */
     (void)forced;
     return ret;
@@ -67,10 +69,13 @@ static FILE *vlc_placebo_OpenCache(const char *mode)
  * Creates a libplacebo context, and swapchain, tied to a window
  *
  * @param cfg vout display cfg to use as the swapchain source
+ * @param dec_device decoder device to share with the decoder (or NULL)
  * @param name module name for libplacebo GPU provider (or NULL for auto)
  * @return a new context, or NULL on failure
  */
-vlc_placebo_t *vlc_placebo_Create(const vout_display_cfg_t *cfg, const char *name)
+vlc_placebo_t *vlc_placebo_Create(const vout_display_cfg_t *cfg,
+                                  vlc_decoder_device *dec_device,
+                                  const char *name)
 {
     vlc_object_t *parent = VLC_OBJECT(cfg->window);
     vlc_placebo_t *pl = vlc_object_create(parent, sizeof (*pl));
@@ -85,7 +90,8 @@ vlc_placebo_t *vlc_placebo_Create(const vout_display_cfg_t *cfg, const char *nam
 
     module_t *module = vlc_module_load(vlc_object_logger(parent), "libplacebo gpu",
                                        name, false,
-                                       vlc_placebo_start, pl, cfg);
+                                       vlc_placebo_start, pl, cfg,
+                                       dec_device);
     if (module == NULL)
         goto delete_log;
 
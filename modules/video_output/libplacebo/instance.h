@@ -27,6 +27,7 @@
 #include <libplacebo/swapchain.h>
 #include <libplacebo/log.h>
 #include <libplacebo/gpu.h>
+#include <libplacebo/renderer.h>
 
 struct vlc_placebo_t;
 struct vlc_placebo_operations
@@ -36,6 +37,12 @@ struct vlc_placebo_operations
     // For acquiring/releasing the context on the current thread. (Optional)
     int (*make_current)(struct vlc_placebo_t *);
     void (*release_current)(struct vlc_placebo_t *);
+
+    // For rendering hardware pictures of the decoder device given to
+    // vlc_placebo_Create without any copy. The planes of the frame are
+    // filled, and must be unmapped once rendered. (Optional)
+    int (*map_picture)(struct vlc_placebo_t *, picture_t *, struct pl_frame *);
+    void (*unmap_picture)(struct vlc_placebo_t *, picture_t *, struct pl_frame *);
 };
 
 typedef struct vlc_placebo_system_t vlc_placebo_system_t;
@@ -57,7 +64,8 @@ typedef struct vlc_placebo_t
     const struct vlc_placebo_operations *ops;
 } vlc_placebo_t;
 
-vlc_placebo_t *vlc_placebo_Create(const vout_display_cfg_t *, const char*) VLC_USED;
+vlc_placebo_t *vlc_placebo_Create(const vout_display_cfg_t *,
+                                  vlc_decoder_device *, const char*) VLC_USED;
 void vlc_placebo_Release(vlc_placebo_t *);
 
 // Needed around every `pl_gpu` / `pl_swapchain` operation
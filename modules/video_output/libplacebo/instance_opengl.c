@@ -33,7 +33,8 @@
 #include "instance.h"
 #include "utils.h"
 
-static int InitInstance(vlc_placebo_t *pl, const vout_display_cfg_t *cfg);
+static int InitInstance(vlc_placebo_t *pl, const vout_display_cfg_t *cfg,
+                        vlc_decoder_device *dec_device);
 static void CloseInstance(vlc_placebo_t *pl);
 static int MakeCurrent(vlc_placebo_t *pl);
 static void ReleaseCurrent(vlc_placebo_t *pl);
@@ -96,8 +97,11 @@ static pl_voidfunc_t get_proc_addr_wrapper(void *ctx, const char *procname)
 }
 #endif
 
-static int InitInstance(vlc_placebo_t *pl, const vout_display_cfg_t *cfg)
+static int InitInstance(vlc_placebo_t *pl, const vout_display_cfg_t *cfg,
+                        vlc_decoder_device *dec_device)
 {
+    VLC_UNUSED(dec_device);
+
     vlc_placebo_system_t *sys = pl->sys =
         vlc_obj_calloc(VLC_OBJECT(pl), 1, sizeof (*sys));
     if (unlikely(sys == NULL))
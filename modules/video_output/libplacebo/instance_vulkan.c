@@ -24,89 +24,282 @@
 # include <config.h>
 #endif
 
+#include <assert.h>
+
 #include <vlc_common.h>
 #include <vlc_plugin.h>
+#include <vlc_codec.h>
 
 #include <libplacebo/vulkan.h>
 
 #include "../vulkan/platform.h"
+#include "../vulkan/device.h"
 #include "instance.h"
 #include "utils.h"
 
-struct vlc_placebo_system_t {
+#if PL_API_VER >= 278 && defined(VK_KHR_video_decode_queue)
+# define HAVE_VK_VIDEO_DECODE 1
+#endif
+
+// Vulkan objects tied to a window
+struct vlc_vk_context {
     vlc_vk_platform_t *platform;
     VkSurfaceKHR surface;
     pl_vk_inst instance;
     pl_vulkan vulkan;
 };
 
-static void CloseInstance(vlc_placebo_t *pl);
-static const struct vlc_placebo_operations instance_opts =
-{
-    .close = CloseInstance,
+struct vlc_placebo_system_t {
+    struct vlc_vk_context vk;
+    vlc_decoder_device *dec_device; // owner of the shared context, or NULL
+    pl_tex mapped; // wrapped decoder image
 };
 
-static int InitInstance(vlc_placebo_t *pl, const vout_display_cfg_t *cfg)
+#ifdef HAVE_VK_VIDEO_DECODE
+struct vlc_vk_decoder_device {
+    pl_log log;
+    struct vlc_vk_context vk;
+    vlc_vk_device_t device;
+};
+
+static const char *const video_decode_extensions[] = {
+    VK_KHR_VIDEO_QUEUE_EXTENSION_NAME,
+    VK_KHR_VIDEO_DECODE_QUEUE_EXTENSION_NAME,
+    VK_KHR_VIDEO_DECODE_H264_EXTENSION_NAME,
+    VK_KHR_VIDEO_DECODE_H265_EXTENSION_NAME,
+#ifdef VK_KHR_video_decode_av1
+    VK_KHR_VIDEO_DECODE_AV1_EXTENSION_NAME,
+#endif
+#ifdef VK_KHR_video_maintenance1
+    VK_KHR_VIDEO_MAINTENANCE_1_EXTENSION_NAME,
+#endif
+};
+#endif
+
+static void DestroyContext(struct vlc_vk_context *vk)
 {
-    vlc_placebo_system_t *sys = pl->sys =
-        vlc_obj_calloc(VLC_OBJECT(pl), 1, sizeof (*sys));
-    if (unlikely(sys == NULL))
-        return VLC_ENOMEM;
+    if (vk->surface) {
+        vlc_vk_instance_t inst = {
+            .instance = vk->instance->instance,
+            .get_proc_address = vk->instance->get_proc_addr,
+        };
+        vlc_vk_DestroySurface(&inst, vk->surface);
+        vk->surface = VK_NULL_HANDLE;
+    }
+
+    pl_vulkan_destroy(&vk->vulkan);
+    pl_vk_inst_destroy(&vk->instance);
+
+    if (vk->platform != NULL) {
+        vlc_vk_platform_Release(vk->platform);
+        vk->platform = NULL;
+    }
+}
 
-    char *platform_name = var_InheritString(pl, "vk-platform");
-    sys->platform = vlc_vk_platform_Create(cfg->window, platform_name);
+static int CreateContext(vlc_object_t *obj, pl_log log, vlc_window_t *window,
+                         bool video_decode, struct vlc_vk_context *vk)
+{
+    char *platform_name = var_InheritString(obj, "vk-platform");
+    vk->platform = vlc_vk_platform_Create(window, platform_name);
     free(platform_name);
-    if (!sys->platform)
+    if (!vk->platform)
         goto error;
 
-    sys->instance = pl_vk_inst_create(pl->log, &(struct pl_vk_inst_params) {
-        .debug = var_InheritBool(pl, "vk-debug"),
+    vk->instance = pl_vk_inst_create(log, &(struct pl_vk_inst_params) {
+        .debug = var_InheritBool(obj, "vk-debug"),
         .extensions = (const char *[]) {
             VK_KHR_SURFACE_EXTENSION_NAME,
-            sys->platform->platform_ext,
+            vk->platform->platform_ext,
         },
         .num_extensions = 2,
     });
-    if (!sys->instance)
+    if (!vk->instance)
         goto error;
 
     vlc_vk_instance_t inst = {
-        .instance = sys->instance->instance,
-        .get_proc_address = sys->instance->get_proc_addr,
+        .instance = vk->instance->instance,
+        .get_proc_address = vk->instance->get_proc_addr,
     };
 
     // Create the platform-specific surface object
-    if (vlc_vk_CreateSurface(sys->platform, &inst, &sys->surface) != VLC_SUCCESS)
+    if (vlc_vk_CreateSurface(vk->platform, &inst, &vk->surface) != VLC_SUCCESS)
         goto error;
 
+    struct pl_vulkan_params params = {
+        .instance = vk->instance->instance,
+        .surface = vk->surface,
+        .allow_software = var_InheritBool(obj, "vk-allow-sw"),
+        .async_transfer = var_InheritBool(obj, "vk-async-xfer"),
+        .async_compute = var_InheritBool(obj, "vk-async-comp"),
+        .queue_count = var_InheritInteger(obj, "vk-queue-count"),
+    };
+
+#ifdef HAVE_VK_VIDEO_DECODE
+    if (video_decode) {
+        // Also enable what the hardware decoder needs on the same device
+        params.extra_queues = VK_QUEUE_VIDEO_DECODE_BIT_KHR;
+        params.opt_extensions = video_decode_extensions;
+        params.num_opt_extensions = ARRAY_SIZE(video_decode_extensions);
+        params.features = &pl_vulkan_recommended_features;
+    }
+#else
+    VLC_UNUSED(video_decode);
+#endif
+
     // Create vulkan device
-    char *device_name = var_InheritString(pl, "vk-device");
-    sys->vulkan = pl_vulkan_create(pl->log, &(struct pl_vulkan_params) {
-        .instance = sys->instance->instance,
-        .surface = sys->surface,
-        .device_name = device_name,
-        .allow_software = var_InheritBool(pl, "vk-allow-sw"),
-        .async_transfer = var_InheritBool(pl, "vk-async-xfer"),
-        .async_compute = var_InheritBool(pl, "vk-async-comp"),
-        .queue_count = var_InheritInteger(pl, "vk-queue-count"),
-    });
+    char *device_name = var_InheritString(obj, "vk-device");
+    params.device_name = device_name;
+    vk->vulkan = pl_vulkan_create(log, &params);
     free(device_name);
-    if (!sys->vulkan)
+    if (!vk->vulkan)
+        goto error;
+
+    return VLC_SUCCESS;
+
+error:
+    DestroyContext(vk);
+    return VLC_EGENERIC;
+}
+
+static void CloseInstance(vlc_placebo_t *pl);
+static const struct vlc_placebo_operations instance_opts =
+{
+    .close = CloseInstance,
+};
+
+#ifdef HAVE_VK_VIDEO_DECODE
+static int MapPicture(vlc_placebo_t *pl, picture_t *pic, struct pl_frame *frame)
+{
+    vlc_placebo_system_t *sys = pl->sys;
+    struct vlc_vk_picture_context *ctx = vlc_vk_picture_GetContext(pic);
+
+    assert(sys->mapped == NULL);
+    ctx->lock(ctx);
+
+    sys->mapped = pl_vulkan_wrap(pl->gpu, pl_vulkan_wrap_params(
+        .image = ctx->image,
+        .width = ctx->width,
+        .height = ctx->height,
+        .format = ctx->format,
+        .usage = ctx->usage,
+    ));
+    if (sys->mapped == NULL) {
+        ctx->unlock(ctx);
+        return VLC_EGENERIC;
+    }
+
+    // Take the image over from the decoder, once it is done writing it
+    pl_vulkan_release_ex(pl->gpu, pl_vulkan_release_params(
+        .tex = sys->mapped,
+        .layout = *ctx->layout,
+        .qf = VK_QUEUE_FAMILY_IGNORED,
+        .semaphore = {
+            .sem = ctx->semaphore,
+            .value = *ctx->semaphore_value,
+        },
+    ));
+
+    pl_fmt fmt = sys->mapped->params.format;
+    int comp = 0;
+
+    frame->num_planes = fmt->num_planes;
+    for (int i = 0; i < fmt->num_planes; i++) {
+        struct pl_plane *plane = &frame->planes[i];
+        pl_tex tex = sys->mapped->planes[i];
+
+        plane->texture = tex;
+        plane->components = tex->params.format->num_components;
+        for (int c = 0; c < plane->components; c++)
+            plane->component_mapping[c] = comp++;
+    }
+
+    // The samples are normalized by the texture format, whatever the number
+    // of significant bits
+    int depth = sys->mapped->planes[0]->params.format->component_depth[0];
+    frame->repr.bits = (struct pl_bit_encoding) {
+        .sample_depth = depth,
+        .color_depth = depth,
+    };
+    return VLC_SUCCESS;
+}
+
+static void UnmapPicture(vlc_placebo_t *pl, picture_t *pic,
+                         struct pl_frame *frame)
+{
+    vlc_placebo_system_t *sys = pl->sys;
+    struct vlc_vk_picture_context *ctx = vlc_vk_picture_GetContext(pic);
+
+    // Give the image back, signaled once the rendering is done with it
+    pl_vulkan_hold_ex(pl->gpu, pl_vulkan_hold_params(
+        .tex = sys->mapped,
+        .out_layout = ctx->layout,
+        .qf = VK_QUEUE_FAMILY_IGNORED,
+        .semaphore = {
+            .sem = ctx->semaphore,
+            .value = *ctx->semaphore_value + 1,
+        },
+    ));
+    (*ctx->semaphore_value)++;
+    ctx->unlock(ctx);
+
+    pl_tex_destroy(pl->gpu, &sys->mapped);
+    VLC_UNUSED(frame);
+}
+
+static const struct vlc_placebo_operations shared_instance_opts =
+{
+    .close = CloseInstance,
+    .map_picture = MapPicture,
+    .unmap_picture = UnmapPicture,
+};
+
+static const struct vlc_decoder_device_operations decoder_device_ops;
+#endif
+
+static int InitInstance(vlc_placebo_t *pl, const vout_display_cfg_t *cfg,
+                        vlc_decoder_device *dec_device)
+{
+    vlc_placebo_system_t *sys = pl->sys =
+        vlc_obj_calloc(VLC_OBJECT(pl), 1, sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    const struct vlc_vk_context *vk = &sys->vk;
+
+#ifdef HAVE_VK_VIDEO_DECODE
+    if (dec_device != NULL && dec_device->ops == &decoder_device_ops) {
+        // Render on the device the decoder uses
+        struct vlc_vk_decoder_device *dec_sys = dec_device->sys;
+
+        sys->dec_device = vlc_decoder_device_Hold(dec_device);
+        vk = &dec_sys->vk;
+    }
+#else
+    VLC_UNUSED(dec_device);
+#endif
+
+    if (sys->dec_device == NULL
+     && CreateContext(VLC_OBJECT(pl), pl->log, cfg->window, false,
+                      &sys->vk) != VLC_SUCCESS)
         goto error;
 
     // Create swapchain for this surface
     struct pl_vulkan_swapchain_params swap_params = {
-        .surface = sys->surface,
+        .surface = vk->surface,
         .present_mode = var_InheritInteger(pl, "vk-present-mode"),
         .swapchain_depth = var_InheritInteger(pl, "vk-queue-depth"),
     };
 
-    pl->swapchain = pl_vulkan_create_swapchain(sys->vulkan, &swap_params);
+    pl->swapchain = pl_vulkan_create_swapchain(vk->vulkan, &swap_params);
     if (!pl->swapchain)
         goto error;
 
-    pl->gpu = sys->vulkan->gpu;
+    pl->gpu = vk->vulkan->gpu;
     pl->ops = &instance_opts;
+#ifdef HAVE_VK_VIDEO_DECODE
+    if (sys->dec_device != NULL)
+        pl->ops = &shared_instance_opts;
+#endif
     return VLC_SUCCESS;
 
 error:
@@ -120,23 +313,137 @@ static void CloseInstance(vlc_placebo_t *pl)
 
     pl_swapchain_destroy(&pl->swapchain);
 
-    if (sys->surface) {
-        vlc_vk_instance_t inst = {
-            .instance = sys->instance->instance,
-            .get_proc_address = sys->instance->get_proc_addr,
-        };
-        vlc_vk_DestroySurface(&inst, sys->surface);
+    if (sys->dec_device != NULL)
+        vlc_decoder_device_Release(sys->dec_device);
+    else
+        DestroyContext(&sys->vk);
+
+    vlc_obj_free(VLC_OBJECT(pl), sys);
+    pl->sys = NULL;
+}
+
+#ifdef HAVE_VK_VIDEO_DECODE
+static void LockQueue(vlc_vk_device_t *device, uint32_t family, uint32_t index)
+{
+    pl_vulkan vulkan = device->opaque;
+
+    vulkan->lock_queue(vulkan, family, index);
+}
+
+static void UnlockQueue(vlc_vk_device_t *device, uint32_t family,
+                        uint32_t index)
+{
+    pl_vulkan vulkan = device->opaque;
+
+    vulkan->unlock_queue(vulkan, family, index);
+}
+
+static struct vlc_vk_queue_family FindDecodeQueue(const struct vlc_vk_context *vk)
+{
+    struct vlc_vk_queue_family found = { .index = -1 };
+    PFN_vkGetPhysicalDeviceQueueFamilyProperties GetQueueFamilyProperties =
+        (PFN_vkGetPhysicalDeviceQueueFamilyProperties)
+        vk->instance->get_proc_addr(vk->instance->instance,
+                                    "vkGetPhysicalDeviceQueueFamilyProperties");
+    uint32_t count = 0;
+
+    GetQueueFamilyProperties(vk->vulkan->phys_device, &count, NULL);
+
+    VkQueueFamilyProperties *props = vlc_alloc(count, sizeof (*props));
+    if (unlikely(props == NULL))
+        return found;
+
+    GetQueueFamilyProperties(vk->vulkan->phys_device, &count, props);
+
+    // Only the queues that libplacebo actually created can be used
+    for (int i = 0; i < vk->vulkan->num_queues; i++) {
+        const struct pl_vulkan_queue *q = &vk->vulkan->queues[i];
+
+        if ((uint32_t)q->index < count
+         && (props[q->index].queueFlags & VK_QUEUE_VIDEO_DECODE_BIT_KHR)) {
+            found.index = q->index;
+            found.count = q->count;
+            break;
+        }
     }
 
-    pl_vulkan_destroy(&sys->vulkan);
-    pl_vk_inst_destroy(&sys->instance);
+    free(props);
+    return found;
+}
 
-    if (sys->platform != NULL)
-        vlc_vk_platform_Release(sys->platform);
+static void CloseDecoderDevice(vlc_decoder_device *device)
+{
+    struct vlc_vk_decoder_device *sys = device->sys;
 
-    vlc_obj_free(VLC_OBJECT(pl), sys);
-    pl->sys = NULL;
+    DestroyContext(&sys->vk);
+    pl_log_destroy(&sys->log);
+}
+
+static const struct vlc_decoder_device_operations decoder_device_ops =
+{
+    .close = CloseDecoderDevice,
+};
+
+static int OpenDecoderDevice(vlc_decoder_device *device, vlc_window_t *window)
+{
+    if (window == NULL)
+        return VLC_EGENERIC;
+
+    struct vlc_vk_decoder_device *sys =
+        vlc_obj_calloc(VLC_OBJECT(device), 1, sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    sys->log = vlc_placebo_CreateLog(VLC_OBJECT(device));
+    if (sys->log == NULL)
+        return VLC_EGENERIC;
+
+    if (CreateContext(VLC_OBJECT(device), sys->log, window, true,
+                      &sys->vk) != VLC_SUCCESS) {
+        pl_log_destroy(&sys->log);
+        return VLC_EGENERIC;
+    }
+
+    pl_vulkan vulkan = sys->vk.vulkan;
+    struct vlc_vk_queue_family decode = FindDecodeQueue(&sys->vk);
+    if (decode.index < 0) {
+        msg_Dbg(device, "no Vulkan video decode queue");
+        CloseDecoderDevice(device);
+        return VLC_EGENERIC;
+    }
+
+    sys->device = (vlc_vk_device_t) {
+        .instance = vulkan->instance,
+        .get_proc_address = vulkan->get_proc_addr,
+        .instance_extensions = sys->vk.instance->extensions,
+        .num_instance_extensions = sys->vk.instance->num_extensions,
+        .physical_device = vulkan->phys_device,
+        .device = vulkan->device,
+        .features = vulkan->features,
+        .device_extensions = vulkan->extensions,
+        .num_device_extensions = vulkan->num_extensions,
+        .queue_graphics = {
+            vulkan->queue_graphics.index, vulkan->queue_graphics.count,
+        },
+        .queue_compute = {
+            vulkan->queue_compute.index, vulkan->queue_compute.count,
+        },
+        .queue_transfer = {
+            vulkan->queue_transfer.index, vulkan->queue_transfer.count,
+        },
+        .queue_decode = decode,
+        .lock_queue = LockQueue,
+        .unlock_queue = UnlockQueue,
+        .opaque = (void *)vulkan,
+    };
+
+    device->ops = &decoder_device_ops;
+    device->type = VLC_DECODER_DEVICE_VULKAN;
+    device->sys = sys;
+    device->opaque = &sys->device;
+    return VLC_SUCCESS;
 }
+#endif
 
 #define PROVIDER_TEXT N_("Vulkan platform module")
 #define PROVIDER_LONGTEXT N_( \
@@ -207,4 +514,12 @@ vlc_module_begin()
     add_integer("vk-present-mode", VK_PRESENT_MODE_FIFO_KHR,
             PRESENT_MODE_TEXT, PRESENT_MODE_LONGTEXT)
             change_integer_list(present_values, present_text)
+
+#ifdef HAVE_VK_VIDEO_DECODE
+    add_submodule()
+        set_description(N_("Vulkan video decoder device"))
+        /* Only on request (--dec-dev=vulkan): only libplacebo can display */
+        set_callback_dec_device(OpenDecoderDevice, 0)
+        add_shortcut("vulkan")
+#endif
 vlc_module_end()
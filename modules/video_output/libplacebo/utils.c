@@ -428,8 +428,10 @@ struct pl_color_repr vlc_placebo_ColorRepr(const video_format_t *fmt)
         sys = PL_COLOR_SYSTEM_RGB;
     }
 
+    // Opaque hardware formats have no description, the bit depth is then
+    // taken from the mapped textures.
     const struct fmt_desc *desc = FindDesc(fmt->i_chroma);
-    int sample_depth = desc->planes[0].comp_bits[0]; // just use first component
+    int sample_depth = desc ? desc->planes[0].comp_bits[0] : 8; // just use first component
 
     return (struct pl_color_repr) {
         .sys        = sys,
@@ -439,7 +441,7 @@ struct pl_color_repr vlc_placebo_ColorRepr(const video_format_t *fmt)
                         : PL_COLOR_LEVELS_TV,
         .bits = {
             .sample_depth   = sample_depth,
-            .color_depth    = desc->color_bits ? desc->color_bits : sample_depth,
+            .color_depth    = desc && desc->color_bits ? desc->color_bits : sample_depth,
             .bit_shift      = 0,
         },
     };
@@ -493,6 +493,33 @@ static const struct pl_filter_config *const scale_config[] = {
 #define ANTIRING_TEXT "Anti-ringing strength"
 #define ANTIRING_LONGTEXT "Enables anti-ringing for non-polar filters. A value of 1.0 completely removes ringing, a value of 0.0 is a no-op."
 
+enum {
+    MIXER_NONE = 0,
+    MIXER_OVERSAMPLE,
+    MIXER_MITCHELL_CLAMP,
+};
+
+static const int frame_mixer_values[] = {
+    MIXER_NONE,
+    MIXER_OVERSAMPLE,
+    MIXER_MITCHELL_CLAMP,
+};
+
+static const char * const frame_mixer_text[] = {
+    "Disabled",
+    "Oversample (sharp, recommended)",
+    "Mitchell-Netravali (smooth, blurry)",
+};
+
+static const struct pl_filter_config *const frame_mixer_config[] = {
+    [MIXER_NONE]            = NULL,
+    [MIXER_OVERSAMPLE]      = &pl_filter_oversample,
+    [MIXER_MITCHELL_CLAMP]  = &pl_filter_mitchell_clamp,
+};
+
+#define FRAME_MIXER_TEXT "Frame mixing"
+#define FRAME_MIXER_LONGTEXT "Blends successive frames on every display refresh, which removes the judder when the frame rate does not match the refresh rate. This delays the video by one frame, and does not apply to pictures decoded on the GPU."
+
 enum {
     FILTER_NONE = 0,
     FILTER_BOX,
@@ -35,12 +35,20 @@
 #include "gl_util.h"
 #include "interop.h"
 
-#define PBO_DISPLAY_COUNT 2 /* Double buffering */
+#define PBO_DISPLAY_COUNT 3 /* Triple buffering by default */
+#define PBO_DISPLAY_MAX 8
+
+/* Maximum time to wait for the GPU to release a buffer (ns) */
+#define PBO_FENCE_TIMEOUT UINT64_C(100000000)
+
 typedef struct
 {
     PFNGLDELETEBUFFERSPROC DeleteBuffers;
+    PFNGLDELETESYNCPROC DeleteSync;
     GLuint      buffers[PICTURE_PLANE_MAX];
     size_t      bytes[PICTURE_PLANE_MAX];
+    void       *mapped[PICTURE_PLANE_MAX]; /* persistently mapped storage */
+    GLsync      fence; /* last upload from the buffers */
 } picture_sys_t;
 
 struct priv
@@ -53,8 +61,10 @@ struct priv
     void * texture_temp_buf;
     size_t texture_temp_buf_size;
     struct {
-        picture_t *display_pics[PBO_DISPLAY_COUNT];
+        picture_t *display_pics[PBO_DISPLAY_MAX];
+        size_t display_count;
         size_t display_idx;
+        bool persistent;
     } pbo;
 
 #define OPENGL_VTABLE_F(X) \
@@ -74,9 +84,18 @@ struct priv
         X(PFNGLGENBUFFERSPROC,      GenBuffers) \
         X(PFNGLPIXELSTOREIPROC,     PixelStorei) \
         X(PFNGLTEXPARAMETERIPROC,   TexParameteri)
+
+/* Buffer storage and synchronization, may be NULL */
+#define OPENGL_VTABLE_OPTIONAL_F(X) \
+        X(PFNGLBUFFERSTORAGEPROC,   BufferStorage) \
+        X(PFNGLMAPBUFFERRANGEPROC,  MapBufferRange) \
+        X(PFNGLFENCESYNCPROC,       FenceSync) \
+        X(PFNGLCLIENTWAITSYNCPROC,  ClientWaitSync) \
+        X(PFNGLDELETESYNCPROC,      DeleteSync)
     struct {
 #define DECLARE_SYMBOL(type, name) type name;
         OPENGL_VTABLE_F(DECLARE_SYMBOL)
+        OPENGL_VTABLE_OPTIONAL_F(DECLARE_SYMBOL)
     } gl;
 };
 
@@ -85,6 +104,9 @@ pbo_picture_destroy(picture_t *pic)
 {
     picture_sys_t *picsys = pic->p_sys;
 
+    if (picsys->fence != NULL)
+        picsys->DeleteSync(picsys->fence);
+    /* Deleting the buffers also unmaps them */
     picsys->DeleteBuffers(pic->i_planes, picsys->buffers);
 
     free(picsys);
@@ -111,6 +133,7 @@ pbo_picture_create(const struct vlc_gl_interop *interop)
 
     priv->gl.GenBuffers(pic->i_planes, picsys->buffers);
     picsys->DeleteBuffers = priv->gl.DeleteBuffers;
+    picsys->DeleteSync = priv->gl.DeleteSync;
 
     /* XXX: needed since picture_NewFromResource override pic planes */
     if (picture_Setup(pic, &interop->fmt_out))
@@ -148,13 +171,25 @@ pbo_data_alloc(const struct vlc_gl_interop *interop, picture_t *pic)
     for (int i = 0; i < pic->i_planes; ++i)
     {
         priv->gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, picsys->buffers[i]);
-        priv->gl.BufferData(GL_PIXEL_UNPACK_BUFFER, picsys->bytes[i], NULL,
-                                GL_DYNAMIC_DRAW);
+        if (priv->pbo.persistent)
+        {
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT
+                                   | GL_MAP_COHERENT_BIT;
+
+            priv->gl.BufferStorage(GL_PIXEL_UNPACK_BUFFER, picsys->bytes[i],
+                                   NULL, flags);
+            picsys->mapped[i] =
+                priv->gl.MapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0,
+                                        picsys->bytes[i], flags);
+        }
+        else
+            priv->gl.BufferData(GL_PIXEL_UNPACK_BUFFER, picsys->bytes[i], NULL,
+                                GL_STREAM_DRAW);
 
-        if (priv->gl.GetError() != GL_NO_ERROR)
+        if (priv->gl.GetError() != GL_NO_ERROR
+         || (priv->pbo.persistent && picsys->mapped[i] == NULL))
         {
             msg_Err(interop->gl, "could not alloc PBO buffers");
-            priv->gl.DeleteBuffers(i, picsys->buffers);
             return VLC_EGENERIC;
         }
     }
@@ -165,7 +200,7 @@ static int
 pbo_pics_alloc(const struct vlc_gl_interop *interop)
 {
     struct priv *priv = interop->priv;
-    for (size_t i = 0; i < PBO_DISPLAY_COUNT; ++i)
+    for (size_t i = 0; i < priv->pbo.display_count; ++i)
     {
         picture_t *pic = priv->pbo.display_pics[i] =
             pbo_picture_create(interop);
@@ -181,11 +216,36 @@ pbo_pics_alloc(const struct vlc_gl_interop *interop)
 
     return VLC_SUCCESS;
 error:
-    for (size_t i = 0; i < PBO_DISPLAY_COUNT && priv->pbo.display_pics[i]; ++i)
+    priv->gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    for (size_t i = 0; i < priv->pbo.display_count && priv->pbo.display_pics[i]; ++i)
+    {
         picture_Release(priv->pbo.display_pics[i]);
+        priv->pbo.display_pics[i] = NULL;
+    }
     return VLC_EGENERIC;
 }
 
+/**
+ * Waits until the GPU is done reading a persistently mapped buffer.
+ */
+static void
+pbo_wait_idle(const struct vlc_gl_interop *interop, picture_sys_t *p_sys)
+{
+    const struct priv *priv = interop->priv;
+
+    if (p_sys->fence == NULL)
+        return;
+
+    /* With enough buffers in the ring, the fence is already signaled */
+    GLenum ret = priv->gl.ClientWaitSync(p_sys->fence,
+                                         GL_SYNC_FLUSH_COMMANDS_BIT,
+                                         PBO_FENCE_TIMEOUT);
+    if (ret == GL_WAIT_FAILED)
+        msg_Warn(interop->gl, "PBO fence wait failed");
+    priv->gl.DeleteSync(p_sys->fence);
+    p_sys->fence = NULL;
+}
+
 static int
 tc_pbo_update(const struct vlc_gl_interop *interop, uint32_t textures[],
               const int32_t tex_width[], const int32_t tex_height[],
@@ -196,15 +256,28 @@ tc_pbo_update(const struct vlc_gl_interop *interop, uint32_t textures[],
 
     picture_t *display_pic = priv->pbo.display_pics[priv->pbo.display_idx];
     picture_sys_t *p_sys = display_pic->p_sys;
-    priv->pbo.display_idx = (priv->pbo.display_idx + 1) % PBO_DISPLAY_COUNT;
+    priv->pbo.display_idx = (priv->pbo.display_idx + 1) % priv->pbo.display_count;
+
+    if (priv->pbo.persistent)
+        pbo_wait_idle(interop, p_sys);
 
     for (int i = 0; i < pic->i_planes; i++)
     {
         GLsizeiptr size = pic->p[i].i_lines * pic->p[i].i_pitch;
         const GLvoid *data = pic->p[i].p_pixels;
+        assert((size_t) size <= p_sys->bytes[i]);
         priv->gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER,
                            p_sys->buffers[i]);
-        priv->gl.BufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, size, data);
+        if (priv->pbo.persistent)
+            memcpy(p_sys->mapped[i], data, size);
+        else
+        {
+            /* Orphan the previous storage rather than waiting for the GPU
+             * to be done with it */
+            priv->gl.BufferData(GL_PIXEL_UNPACK_BUFFER, p_sys->bytes[i], NULL,
+                                GL_STREAM_DRAW);
+            priv->gl.BufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, size, data);
+        }
 
         priv->gl.ActiveTexture(GL_TEXTURE0 + i);
         priv->gl.BindTexture(interop->tex_target, textures[i]);
@@ -230,6 +303,9 @@ tc_pbo_update(const struct vlc_gl_interop *interop, uint32_t textures[],
                                interop->texs[1].format, interop->texs[1].type, NULL);
         priv->gl.PixelStorei(GL_UNPACK_ROW_LENGTH, 0);
     }
+
+    if (priv->pbo.persistent)
+        p_sys->fence = priv->gl.FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
     GL_ASSERT_NOERROR(&priv->gl);
 
     /* turn off pbo */
@@ -749,7 +825,7 @@ static void
 opengl_interop_generic_deinit(struct vlc_gl_interop *interop)
 {
     struct priv *priv = interop->priv;
-    for (size_t i = 0; i < PBO_DISPLAY_COUNT && priv->pbo.display_pics[i]; ++i)
+    for (size_t i = 0; i < priv->pbo.display_count && priv->pbo.display_pics[i]; ++i)
         picture_Release(priv->pbo.display_pics[i]);
     free(priv->texture_temp_buf);
     free(priv);
@@ -770,6 +846,13 @@ opengl_interop_generic_init(struct vlc_gl_interop *interop, bool allow_dr)
     assert(priv->gl.name != NULL);
 
     OPENGL_VTABLE_F(LOAD_SYMBOL);
+#undef LOAD_SYMBOL
+
+#define LOAD_OPTIONAL_SYMBOL(type, name) \
+    priv->gl.name = vlc_gl_GetProcAddress(interop->gl, "gl" # name);
+
+    OPENGL_VTABLE_OPTIONAL_F(LOAD_OPTIONAL_SYMBOL);
+#undef LOAD_OPTIONAL_SYMBOL
 
     struct vlc_gl_extension_vt extension_vt;
     vlc_gl_LoadExtensionFunctions(interop->gl, &extension_vt);
@@ -886,7 +969,30 @@ interop_init:
 
         const bool supports_pbo = has_pbo && priv->gl.BufferData
             && priv->gl.BufferSubData;
-        if (supports_pbo && pbo_pics_alloc(interop) == VLC_SUCCESS)
+
+        /* Persistently mapped buffers need OpenGL 4.4, or buffer storage
+         * and fence sync (OpenGL ES 3.0) extensions */
+        const bool has_storage =
+            (interop->gl->api_type == VLC_OPENGL
+              && (strverscmp((const char *)ogl_version, "4.4") >= 0
+               || vlc_gl_HasExtension(&extension_vt, "GL_ARB_buffer_storage")))
+         || vlc_gl_HasExtension(&extension_vt, "GL_EXT_buffer_storage");
+        priv->pbo.persistent = has_storage && priv->gl.BufferStorage
+            && priv->gl.MapBufferRange && priv->gl.FenceSync
+            && priv->gl.ClientWaitSync && priv->gl.DeleteSync;
+
+        int64_t count = var_InheritInteger(interop->gl, "gl-pbo-buffers");
+        priv->pbo.display_count = VLC_CLIP(count, 2, PBO_DISPLAY_MAX);
+
+        if (supports_pbo && priv->pbo.persistent
+         && pbo_pics_alloc(interop) != VLC_SUCCESS)
+        {
+            msg_Warn(interop->gl, "persistent PBO mapping failed");
+            priv->pbo.persistent = false;
+        }
+
+        if (supports_pbo && (priv->pbo.display_pics[0] != NULL
+                          || pbo_pics_alloc(interop) == VLC_SUCCESS))
         {
             static const struct vlc_gl_interop_ops pbo_ops = {
                 .allocate_textures = tc_common_allocate_textures,
@@ -894,7 +1000,9 @@ interop_init:
                 .close = opengl_interop_generic_deinit,
             };
             interop->ops = &pbo_ops;
-            msg_Dbg(interop->gl, "PBO support enabled");
+            msg_Dbg(interop->gl, "PBO support enabled (%zu %s buffers)",
+                    priv->pbo.display_count,
+                    priv->pbo.persistent ? "persistent" : "streamed");
         }
     }
 
@@ -916,6 +1024,11 @@ static int OpenInteropDirectRendering(struct vlc_gl_interop *interop)
     return opengl_interop_generic_init(interop, true);
 }
 
+#define PBO_BUFFERS_TEXT N_("Pixel buffers")
+#define PBO_BUFFERS_LONGTEXT N_( \
+    "Number of pixel buffer objects used to upload pictures. More buffers " \
+    "make it less likely to wait for the GPU, at the expense of memory.")
+
 vlc_module_begin ()
     set_description("Software OpenGL interop")
     set_capability("opengl sw interop", 1)
@@ -927,4 +1040,7 @@ vlc_module_begin ()
     set_callback(OpenInteropDirectRendering)
     set_capability("opengl sw interop", 2)
     add_shortcut("pbo")
+    add_integer_with_range("gl-pbo-buffers", PBO_DISPLAY_COUNT,
+                           2, PBO_DISPLAY_MAX, PBO_BUFFERS_TEXT,
+                           PBO_BUFFERS_LONGTEXT)
 vlc_module_end ()
@@ -0,0 +1,88 @@
+/*****************************************************************************
+ * device.h: Vulkan device and images shared with hardware decoders
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_VULKAN_DEVICE_H
+#define VLC_VULKAN_DEVICE_H
+
+#include <vlc_common.h>
+#include <vlc_picture.h>
+#include <vulkan/vulkan.h>
+
+struct vlc_vk_queue_family
+{
+    int index; // -1 if the device has no such queue family
+    int count;
+};
+
+// Opaque pointer of VLC_DECODER_DEVICE_VULKAN decoder devices
+typedef struct vlc_vk_device_t
+{
+    VkInstance instance;
+    PFN_vkGetInstanceProcAddr get_proc_address;
+    const char * const *instance_extensions;
+    int num_instance_extensions;
+
+    VkPhysicalDevice physical_device;
+    VkDevice device;
+    const VkPhysicalDeviceFeatures2 *features;
+    const char * const *device_extensions;
+    int num_device_extensions;
+
+    struct vlc_vk_queue_family queue_graphics;
+    struct vlc_vk_queue_family queue_compute;
+    struct vlc_vk_queue_family queue_transfer;
+    struct vlc_vk_queue_family queue_decode;
+
+    // The queues are shared with the renderer, any submission to them must
+    // happen with the queue locked
+    void (*lock_queue)(struct vlc_vk_device_t *, uint32_t family, uint32_t index);
+    void (*unlock_queue)(struct vlc_vk_device_t *, uint32_t family, uint32_t index);
+    void *opaque;
+} vlc_vk_device_t;
+
+// Picture context of VLC_VIDEO_CONTEXT_VULKAN pictures
+//
+// The image belongs to the decoder, which keeps accessing it as a reference
+// frame. Its layout and semaphore value are only stable between
+// lock() and unlock(), and must be updated by whoever uses it in between.
+struct vlc_vk_picture_context
+{
+    picture_context_t s;
+
+    VkImage image; // single image with all the planes
+    VkFormat format;
+    VkImageUsageFlags usage;
+    unsigned width, height;
+
+    VkImageLayout *layout;
+    VkSemaphore semaphore; // timeline semaphore
+    uint64_t *semaphore_value;
+
+    void (*lock)(struct vlc_vk_picture_context *);
+    void (*unlock)(struct vlc_vk_picture_context *);
+};
+
+static inline struct vlc_vk_picture_context *
+vlc_vk_picture_GetContext(const picture_t *pic)
+{
+    return container_of(pic->context, struct vlc_vk_picture_context, s);
+}
+
+#endif // VLC_VULKAN_DEVICE_H
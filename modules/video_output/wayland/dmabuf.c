@@ -0,0 +1,769 @@
+/**
+ * @file dmabuf.c
+ * @brief Wayland DMA-BUF zero-copy video output module for VLC media player
+ */
+/*****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sys/mman.h>
+#include <unistd.h>
+#ifndef HAVE_LIBDRM
+# include <drm/drm_fourcc.h>
+#else
+# include <drm_fourcc.h>
+#endif
+
+#include <wayland-client.h>
+#include "viewporter-client-protocol.h"
+#include "linux-dmabuf-client-protocol.h"
+#include "registry.h"
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_vout_display.h>
+#include <vlc_vector.h>
+#include <vlc_fs.h>
+
+#include "../../hw/vaapi/vlc_vaapi.h"
+#include <va/va_drmcommon.h>
+
+/** Entry of the feedback format table, as laid out by the compositor */
+struct dmabuf_table_entry
+{
+    uint32_t format;
+    uint32_t padding;
+    uint64_t modifier;
+};
+
+struct dmabuf_format
+{
+    uint32_t format;
+    uint64_t modifier;
+    bool scanout;
+};
+
+typedef struct VLC_VECTOR(struct dmabuf_format) dmabuf_format_vec;
+
+typedef struct vout_display_sys_t
+{
+    vlc_window_t *embed; /* VLC window */
+    struct wl_event_queue *eventq;
+    struct wl_compositor *compositor;
+    struct wl_subcompositor *subcompositor;
+    struct wp_viewporter *viewporter;
+    struct zwp_linux_dmabuf_v1 *dmabuf;
+    struct zwp_linux_dmabuf_feedback_v1 *feedback;
+
+    /* Video sub-surface */
+    struct wl_surface *surface;
+    struct wl_subsurface *subsurface;
+    struct wp_viewport *viewport;
+
+    /* Black background on the window surface */
+    struct wp_viewport *background_viewport;
+    struct wl_buffer *background;
+
+    struct {
+        const struct dmabuf_table_entry *table;
+        size_t table_size;
+        size_t table_bytes;
+        uint32_t flags;
+        dmabuf_format_vec pending;
+    } tranche;
+    dmabuf_format_vec formats;
+
+    uint32_t drm_format;
+    uint64_t modifier; /* modifier of the last presented surface */
+    int scanout; /* last reported state: -1 unknown, 0 no, 1 yes */
+    bool rejected;
+
+    size_t active_buffers;
+} vout_display_sys_t;
+
+struct buffer_data
+{
+    picture_t *picture;
+    size_t *counter;
+};
+
+static const struct dmabuf_format *FindFormat(vout_display_sys_t *sys,
+                                              uint32_t format,
+                                              uint64_t modifier)
+{
+    const struct dmabuf_format *found = NULL;
+
+    for (size_t i = 0; i < sys->formats.size; i++)
+    {
+        const struct dmabuf_format *f = &sys->formats.data[i];
+
+        if (f->format != format || f->modifier != modifier)
+            continue;
+        /* The same pair can be listed in several tranches */
+        if (found == NULL || f->scanout)
+            found = f;
+    }
+    return found;
+}
+
+static void ReportScanout(vout_display_t *vd)
+{
+    vout_display_sys_t *sys = vd->sys;
+    const struct dmabuf_format *f = FindFormat(sys, sys->drm_format,
+                                               sys->modifier);
+    int scanout = f != NULL && f->scanout;
+
+    if (scanout == sys->scanout)
+        return;
+
+    if (scanout)
+        msg_Dbg(vd, "surfaces can be scanned out directly");
+    else
+        msg_Dbg(vd, "surfaces are not scan-out capable, "
+                "the compositor will composite them");
+    sys->scanout = scanout;
+}
+
+static void buffer_release_cb(void *data, struct wl_buffer *buffer)
+{
+    struct buffer_data *d = data;
+
+    picture_Release(d->picture);
+    (*(d->counter))--;
+    free(d);
+    wl_buffer_destroy(buffer);
+}
+
+static const struct wl_buffer_listener buffer_cbs =
+{
+    buffer_release_cb,
+};
+
+static struct wl_buffer *ImportSurface(vout_display_t *vd, picture_t *pic)
+{
+    vout_display_sys_t *sys = vd->sys;
+    VADisplay dpy = vlc_vaapi_PicGetDisplay(pic);
+    VASurfaceID surface = vlc_vaapi_PicGetSurface(pic);
+    VADRMPRIMESurfaceDescriptor desc;
+    struct wl_buffer *buf = NULL;
+
+    VAStatus status = vaSyncSurface(dpy, surface);
+    if (status != VA_STATUS_SUCCESS)
+    {
+        msg_Err(vd, "vaSyncSurface: %s", vaErrorStr(status));
+        return NULL;
+    }
+
+    /* A single layer with all the planes, as expected by the protocol */
+    if (vlc_vaapi_ExportSurfaceHandle(VLC_OBJECT(vd), dpy, surface,
+                                      VA_SURFACE_ATTRIB_MEM_TYPE_DRM_PRIME_2,
+                                      VA_EXPORT_SURFACE_READ_ONLY |
+                                      VA_EXPORT_SURFACE_COMPOSED_LAYERS,
+                                      &desc))
+        return NULL;
+
+    if (desc.num_layers != 1)
+    {
+        msg_Err(vd, "unsupported surface layout (%"PRIu32" layers)",
+                desc.num_layers);
+        goto out;
+    }
+
+    const uint32_t format = desc.layers[0].drm_format;
+    const uint64_t modifier =
+        desc.objects[desc.layers[0].object_index[0]].drm_format_modifier;
+
+    /* A buffer with parameters that the compositor did not advertise would
+     * be a fatal protocol error, rather than a composition fallback. */
+    if (FindFormat(sys, format, modifier) == NULL)
+    {
+        if (!sys->rejected)
+            msg_Err(vd, "surface format %4.4s modifier 0x%016"PRIx64
+                    " not supported by the compositor",
+                    (const char *)&format, modifier);
+        sys->rejected = true;
+        goto out;
+    }
+
+    if (format != sys->drm_format || modifier != sys->modifier)
+    {
+        msg_Dbg(vd, "surface format %4.4s modifier 0x%016"PRIx64,
+                (const char *)&format, modifier);
+        sys->drm_format = format;
+        sys->modifier = modifier;
+        ReportScanout(vd);
+    }
+
+    struct zwp_linux_buffer_params_v1 *params =
+        zwp_linux_dmabuf_v1_create_params(sys->dmabuf);
+    if (params == NULL)
+        goto out;
+
+    for (uint32_t i = 0; i < desc.layers[0].num_planes; i++)
+    {
+        const uint32_t obj = desc.layers[0].object_index[i];
+
+        zwp_linux_buffer_params_v1_add(params, desc.objects[obj].fd, i,
+                                       desc.layers[0].offset[i],
+                                       desc.layers[0].pitch[i],
+                                       modifier >> 32,
+                                       modifier & 0xffffffff);
+    }
+
+    buf = zwp_linux_buffer_params_v1_create_immed(params, desc.width,
+                                                  desc.height, format, 0);
+    zwp_linux_buffer_params_v1_destroy(params);
+out:
+    /* The file descriptors were duplicated when the requests were queued */
+    for (uint32_t i = 0; i < desc.num_objects; i++)
+        vlc_close(desc.objects[i].fd);
+    return buf;
+}
+
+static void Prepare(vout_display_t *vd, picture_t *pic,
+                    const struct vlc_render_subpicture *subpic,
+                    vlc_tick_t date)
+{
+    VLC_UNUSED(date);
+    vout_display_sys_t *sys = vd->sys;
+    struct wl_display *display = sys->embed->display.wl;
+
+    struct buffer_data *d = malloc(sizeof (*d));
+    if (unlikely(d == NULL))
+        return;
+
+    struct wl_buffer *buf = ImportSurface(vd, pic);
+    if (buf == NULL)
+    {
+        free(d);
+        return;
+    }
+
+    d->picture = picture_Hold(pic);
+    d->counter = &sys->active_buffers;
+
+    wl_buffer_add_listener(buf, &buffer_cbs, d);
+    wl_surface_attach(sys->surface, buf, 0, 0);
+    wl_surface_damage(sys->surface, 0, 0, INT32_MAX, INT32_MAX);
+    wl_display_flush(display);
+
+    sys->active_buffers++;
+
+    (void) subpic;
+}
+
+static void Display(vout_display_t *vd, picture_t *pic)
+{
+    vout_display_sys_t *sys = vd->sys;
+    struct wl_display *display = sys->embed->display.wl;
+
+    /* The sub-surface is desynchronized: this does not wait for the window */
+    wl_surface_commit(sys->surface);
+    wl_display_roundtrip_queue(display, sys->eventq);
+
+    (void) pic;
+}
+
+static void UpdateViewport(vout_display_t *vd)
+{
+    vout_display_sys_t *sys = vd->sys;
+    video_format_t fmt;
+
+    video_format_ApplyRotation(&fmt, vd->source);
+
+    wp_viewport_set_source(sys->viewport,
+                    wl_fixed_from_int(fmt.i_x_offset),
+                    wl_fixed_from_int(fmt.i_y_offset),
+                    wl_fixed_from_int(fmt.i_visible_width),
+                    wl_fixed_from_int(fmt.i_visible_height));
+    wp_viewport_set_destination(sys->viewport,
+                                vd->place->width, vd->place->height);
+    wl_surface_commit(sys->surface);
+
+    /* The sub-surface position and the background size are part of the
+     * window surface state. */
+    wl_subsurface_set_position(sys->subsurface, vd->place->x, vd->place->y);
+    wp_viewport_set_destination(sys->background_viewport,
+                                vd->cfg->display.width,
+                                vd->cfg->display.height);
+    wl_surface_commit(sys->embed->handle.wl);
+    wl_display_flush(sys->embed->display.wl);
+}
+
+static int SetDisplaySize(vout_display_t *vd, unsigned width, unsigned height)
+{
+    VLC_UNUSED(width); VLC_UNUSED(height);
+    UpdateViewport(vd);
+    return VLC_SUCCESS;
+}
+
+static int Control(vout_display_t *vd, int query)
+{
+    switch (query)
+    {
+        case VOUT_DISPLAY_CHANGE_SOURCE_ASPECT:
+        case VOUT_DISPLAY_CHANGE_SOURCE_CROP:
+        case VOUT_DISPLAY_CHANGE_SOURCE_PLACE:
+            UpdateViewport(vd);
+            return VLC_SUCCESS;
+        default:
+             msg_Err(vd, "unknown request %d", query);
+             return VLC_EGENERIC;
+    }
+}
+
+static void dmabuf_format_cb(void *data, struct zwp_linux_dmabuf_v1 *dmabuf,
+                             uint32_t format)
+{
+    /* Deprecated: always followed by modifier events since version 3 */
+    (void) data; (void) dmabuf; (void) format;
+}
+
+static void dmabuf_modifier_cb(void *data, struct zwp_linux_dmabuf_v1 *dmabuf,
+                               uint32_t format, uint32_t hi, uint32_t lo)
+{
+    vout_display_t *vd = data;
+    vout_display_sys_t *sys = vd->sys;
+    struct dmabuf_format f = {
+        .format = format,
+        .modifier = ((uint64_t)hi << 32) | lo,
+        .scanout = false, /* unknown without feedback */
+    };
+
+    if (!vlc_vector_push(&sys->formats, f))
+        msg_Err(vd, "cannot record format %4.4s", (const char *)&format);
+    (void) dmabuf;
+}
+
+static const struct zwp_linux_dmabuf_v1_listener dmabuf_cbs =
+{
+    dmabuf_format_cb,
+    dmabuf_modifier_cb,
+};
+
+static void feedback_done_cb(void *data,
+                             struct zwp_linux_dmabuf_feedback_v1 *feedback)
+{
+    vout_display_t *vd = data;
+    vout_display_sys_t *sys = vd->sys;
+    dmabuf_format_vec old = sys->formats;
+
+    /* Each round of feedback replaces the previous one entirely */
+    sys->formats = sys->tranche.pending;
+    vlc_vector_init(&sys->tranche.pending);
+    vlc_vector_clear(&old);
+    msg_Dbg(vd, "%zu format/modifier pair(s) advertised", sys->formats.size);
+
+    if (sys->modifier != DRM_FORMAT_MOD_INVALID)
+        ReportScanout(vd);
+    (void) feedback;
+}
+
+static void feedback_format_table_cb(void *data,
+                                 struct zwp_linux_dmabuf_feedback_v1 *feedback,
+                                 int32_t fd, uint32_t size)
+{
+    vout_display_t *vd = data;
+    vout_display_sys_t *sys = vd->sys;
+
+    if (sys->tranche.table != NULL)
+        munmap((void *)sys->tranche.table, sys->tranche.table_bytes);
+    sys->tranche.table = NULL;
+    sys->tranche.table_size = 0;
+
+    void *table = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    vlc_close(fd);
+
+    if (table == MAP_FAILED)
+    {
+        msg_Err(vd, "cannot map format table: %s", vlc_strerror_c(errno));
+        return;
+    }
+
+    sys->tranche.table = table;
+    sys->tranche.table_size = size / sizeof (*sys->tranche.table);
+    sys->tranche.table_bytes = size;
+    (void) feedback;
+}
+
+static void feedback_main_device_cb(void *data,
+                                 struct zwp_linux_dmabuf_feedback_v1 *feedback,
+                                 struct wl_array *device)
+{
+    /* VA-API surfaces are already allocated on the decoding device */
+    (void) data; (void) feedback; (void) device;
+}
+
+static void feedback_tranche_done_cb(void *data,
+                                 struct zwp_linux_dmabuf_feedback_v1 *feedback)
+{
+    vout_display_t *vd = data;
+    vout_display_sys_t *sys = vd->sys;
+
+    sys->tranche.flags = 0;
+    (void) feedback;
+}
+
+static void feedback_tranche_target_device_cb(void *data,
+                                 struct zwp_linux_dmabuf_feedback_v1 *feedback,
+                                 struct wl_array *device)
+{
+    (void) data; (void) feedback; (void) device;
+}
+
+static void feedback_tranche_formats_cb(void *data,
+                                 struct zwp_linux_dmabuf_feedback_v1 *feedback,
+                                 struct wl_array *indices)
+{
+    vout_display_t *vd = data;
+    vout_display_sys_t *sys = vd->sys;
+    const uint16_t *index;
+    const bool scanout = (sys->tranche.flags
+                  & ZWP_LINUX_DMABUF_FEEDBACK_V1_TRANCHE_FLAGS_SCANOUT) != 0;
+
+    wl_array_for_each(index, indices)
+    {
+        if (*index >= sys->tranche.table_size)
+            continue;
+
+        const struct dmabuf_table_entry *e = &sys->tranche.table[*index];
+        struct dmabuf_format f = {
+            .format = e->format,
+            .modifier = e->modifier,
+            .scanout = scanout,
+        };
+
+        if (!vlc_vector_push(&sys->tranche.pending, f))
+            break;
+    }
+    (void) feedback;
+}
+
+static void feedback_tranche_flags_cb(void *data,
+                                 struct zwp_linux_dmabuf_feedback_v1 *feedback,
+                                 uint32_t flags)
+{
+    vout_display_t *vd = data;
+    vout_display_sys_t *sys = vd->sys;
+
+    /* The flags are sent before the formats of the tranche */
+    sys->tranche.flags = flags;
+    (void) feedback;
+}
+
+static const struct zwp_linux_dmabuf_feedback_v1_listener feedback_cbs =
+{
+    feedback_done_cb,
+    feedback_format_table_cb,
+    feedback_main_device_cb,
+    feedback_tranche_done_cb,
+    feedback_tranche_target_device_cb,
+    feedback_tranche_formats_cb,
+    feedback_tranche_flags_cb,
+};
+
+static struct wl_buffer *CreateBackground(vout_display_t *vd,
+                                          struct wl_shm *shm)
+{
+    int fd = vlc_memfd();
+    if (fd == -1)
+        return NULL;
+
+    struct wl_buffer *buf = NULL;
+    static const uint32_t black = 0xff000000;
+
+    if (write(fd, &black, sizeof (black)) == sizeof (black))
+    {
+        struct wl_shm_pool *pool = wl_shm_create_pool(shm, fd,
+                                                      sizeof (black));
+        if (pool != NULL)
+        {
+            buf = wl_shm_pool_create_buffer(pool, 0, 1, 1, sizeof (black),
+                                            WL_SHM_FORMAT_XRGB8888);
+            wl_shm_pool_destroy(pool);
+        }
+    }
+    vlc_close(fd);
+
+    if (buf == NULL)
+        msg_Err(vd, "cannot create background buffer");
+    return buf;
+}
+
+static void Close(vout_display_t *vd)
+{
+    vout_display_sys_t *sys = vd->sys;
+    struct wl_display *display = sys->embed->display.wl;
+    struct wl_surface *parent = sys->embed->handle.wl;
+
+    wl_surface_attach(sys->surface, NULL, 0, 0);
+    wl_surface_commit(sys->surface);
+
+    /* Wait until all picture buffers are released by the server */
+    while (sys->active_buffers > 0) {
+        msg_Dbg(vd, "%zu buffer(s) still active", sys->active_buffers);
+        wl_display_roundtrip_queue(display, sys->eventq);
+    }
+    msg_Dbg(vd, "no active buffers left");
+
+    wl_subsurface_destroy(sys->subsurface);
+    wp_viewport_destroy(sys->viewport);
+    if (sys->feedback != NULL)
+        zwp_linux_dmabuf_feedback_v1_destroy(sys->feedback);
+    wl_surface_destroy(sys->surface);
+
+    wp_viewport_destroy(sys->background_viewport);
+    wl_surface_attach(parent, NULL, 0, 0);
+    wl_surface_commit(parent);
+    wl_buffer_destroy(sys->background);
+
+    zwp_linux_dmabuf_v1_destroy(sys->dmabuf);
+    wp_viewporter_destroy(sys->viewporter);
+    wl_subcompositor_destroy(sys->subcompositor);
+    wl_compositor_destroy(sys->compositor);
+    wl_display_flush(display);
+    wl_event_queue_destroy(sys->eventq);
+
+    if (sys->tranche.table != NULL)
+        munmap((void *)sys->tranche.table, sys->tranche.table_bytes);
+    vlc_vector_clear(&sys->tranche.pending);
+    vlc_vector_clear(&sys->formats);
+    free(sys);
+}
+
+static const struct vlc_display_operations ops = {
+    .close = Close,
+    .prepare = Prepare,
+    .display = Display,
+    .set_display_size = SetDisplaySize,
+    .control = Control,
+};
+
+static int Open(vout_display_t *vd,
+                video_format_t *fmtp, vlc_video_context *context)
+{
+    if (vd->cfg->window->type != VLC_WINDOW_TYPE_WAYLAND)
+        return VLC_EGENERIC;
+
+    if (context == NULL
+     || vlc_video_context_GetType(context) != VLC_VIDEO_CONTEXT_VAAPI)
+    {
+        msg_Dbg(vd, "no VA-API surfaces, not using DMA-BUF output");
+        return VLC_EGENERIC;
+    }
+
+    uint32_t drm_format;
+
+    switch (fmtp->i_chroma)
+    {
+        case VLC_CODEC_VAAPI_420:
+            drm_format = DRM_FORMAT_NV12;
+            break;
+        case VLC_CODEC_VAAPI_420_10BPP:
+            drm_format = DRM_FORMAT_P010;
+            break;
+        default:
+            return VLC_EGENERIC;
+    }
+
+    vout_display_sys_t *sys = calloc(1, sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    vd->sys = sys;
+    sys->embed = vd->cfg->window;
+    sys->drm_format = drm_format;
+    sys->modifier = DRM_FORMAT_MOD_INVALID;
+    sys->scanout = -1;
+    vlc_vector_init(&sys->tranche.pending);
+    vlc_vector_init(&sys->formats);
+
+    struct wl_display *display = sys->embed->display.wl;
+    struct wl_surface *parent = sys->embed->handle.wl;
+    struct vlc_wl_registry *registry = NULL;
+    struct wl_shm *shm = NULL;
+
+    sys->eventq = wl_display_create_queue(display);
+    if (sys->eventq == NULL)
+        goto error;
+
+    registry = vlc_wl_registry_get(display, sys->eventq);
+    if (registry == NULL)
+        goto error;
+
+    uint32_t version = 4;
+
+    sys->dmabuf = (struct zwp_linux_dmabuf_v1 *)
+                  vlc_wl_interface_bind(registry, "zwp_linux_dmabuf_v1",
+                                        &zwp_linux_dmabuf_v1_interface,
+                                        &version);
+    if (sys->dmabuf == NULL || version < 3)
+    {
+        msg_Dbg(vd, "compositor lacks DMA-BUF modifiers support");
+        goto error;
+    }
+
+    sys->compositor = vlc_wl_compositor_get(registry);
+    sys->subcompositor = (struct wl_subcompositor *)
+                  vlc_wl_interface_bind(registry, "wl_subcompositor",
+                                        &wl_subcompositor_interface, NULL);
+    sys->viewporter = (struct wp_viewporter *)
+                  vlc_wl_interface_bind(registry, "wp_viewporter",
+                                        &wp_viewporter_interface, NULL);
+    shm = vlc_wl_shm_get(registry);
+    if (sys->compositor == NULL || sys->subcompositor == NULL
+     || sys->viewporter == NULL || shm == NULL)
+    {
+        msg_Dbg(vd, "compositor lacks sub-surface or viewport support");
+        goto error;
+    }
+
+    sys->surface = wl_compositor_create_surface(sys->compositor);
+    if (sys->surface == NULL)
+        goto error;
+
+    if (version >= 4)
+    {
+        /* Per-surface feedback tells which formats can skip composition */
+        sys->feedback = zwp_linux_dmabuf_v1_get_surface_feedback(sys->dmabuf,
+                                                                 sys->surface);
+        if (sys->feedback != NULL)
+            zwp_linux_dmabuf_feedback_v1_add_listener(sys->feedback,
+                                                      &feedback_cbs, vd);
+    }
+    else
+    {
+        msg_Dbg(vd, "no DMA-BUF feedback, scan-out support unknown");
+        zwp_linux_dmabuf_v1_add_listener(sys->dmabuf, &dmabuf_cbs, vd);
+    }
+    wl_display_roundtrip_queue(display, sys->eventq);
+
+    bool supported = false;
+
+    for (size_t i = 0; i < sys->formats.size; i++)
+        if (sys->formats.data[i].format == drm_format)
+            supported = true;
+
+    if (!supported)
+    {
+        msg_Dbg(vd, "compositor does not accept %4.4s DMA-BUF",
+                (const char *)&drm_format);
+        goto error;
+    }
+
+    sys->background = CreateBackground(vd, shm);
+    if (sys->background == NULL)
+        goto error;
+    wl_shm_destroy(shm);
+    shm = NULL;
+
+    sys->subsurface = wl_subcompositor_get_subsurface(sys->subcompositor,
+                                                      sys->surface, parent);
+    sys->viewport = wp_viewporter_get_viewport(sys->viewporter,
+                                               sys->surface);
+    sys->background_viewport = wp_viewporter_get_viewport(sys->viewporter,
+                                                          parent);
+    if (sys->subsurface == NULL || sys->viewport == NULL
+     || sys->background_viewport == NULL)
+        goto error;
+
+    wl_subsurface_set_desync(sys->subsurface);
+    wl_surface_attach(parent, sys->background, 0, 0);
+    wl_surface_damage(parent, 0, 0, INT32_MAX, INT32_MAX);
+
+    static const enum wl_output_transform transforms[8] = {
+        [ORIENT_TOP_LEFT] = WL_OUTPUT_TRANSFORM_NORMAL,
+        [ORIENT_TOP_RIGHT] = WL_OUTPUT_TRANSFORM_FLIPPED,
+        [ORIENT_BOTTOM_LEFT] = WL_OUTPUT_TRANSFORM_FLIPPED_180,
+        [ORIENT_BOTTOM_RIGHT] = WL_OUTPUT_TRANSFORM_180,
+        [ORIENT_LEFT_TOP] = WL_OUTPUT_TRANSFORM_FLIPPED_270,
+        [ORIENT_LEFT_BOTTOM] = WL_OUTPUT_TRANSFORM_90,
+        [ORIENT_RIGHT_TOP] = WL_OUTPUT_TRANSFORM_270,
+        [ORIENT_RIGHT_BOTTOM] = WL_OUTPUT_TRANSFORM_FLIPPED_90,
+    };
+
+    if (vlc_wl_interface_get_version(registry, "wl_compositor") >= 2)
+        wl_surface_set_buffer_transform(sys->surface,
+                                        transforms[fmtp->orientation]);
+    else if (fmtp->orientation != ORIENT_NORMAL)
+    {
+        msg_Dbg(vd, "compositor cannot rotate buffers");
+        goto error;
+    }
+
+    vlc_wl_registry_destroy(registry);
+    vd->ops = &ops;
+    UpdateViewport(vd);
+    msg_Dbg(vd, "presenting VA-API surfaces on a sub-surface");
+    return VLC_SUCCESS;
+
+error:
+    if (sys->background_viewport != NULL)
+        wp_viewport_destroy(sys->background_viewport);
+    if (sys->viewport != NULL)
+        wp_viewport_destroy(sys->viewport);
+    if (sys->subsurface != NULL)
+        wl_subsurface_destroy(sys->subsurface);
+    if (sys->background != NULL)
+    {
+        wl_surface_attach(parent, NULL, 0, 0);
+        wl_buffer_destroy(sys->background);
+    }
+    if (sys->feedback != NULL)
+        zwp_linux_dmabuf_feedback_v1_destroy(sys->feedback);
+    if (sys->surface != NULL)
+        wl_surface_destroy(sys->surface);
+    if (shm != NULL)
+        wl_shm_destroy(shm);
+    if (sys->viewporter != NULL)
+        wp_viewporter_destroy(sys->viewporter);
+    if (sys->subcompositor != NULL)
+        wl_subcompositor_destroy(sys->subcompositor);
+    if (sys->compositor != NULL)
+        wl_compositor_destroy(sys->compositor);
+    if (sys->dmabuf != NULL)
+        zwp_linux_dmabuf_v1_destroy(sys->dmabuf);
+
+    if (registry != NULL)
+        vlc_wl_registry_destroy(registry);
+
+    if (sys->eventq != NULL)
+        wl_event_queue_destroy(sys->eventq);
+    if (sys->tranche.table != NULL)
+        munmap((void *)sys->tranche.table, sys->tranche.table_bytes);
+    vlc_vector_clear(&sys->tranche.pending);
+    vlc_vector_clear(&sys->formats);
+    free(sys);
+    return VLC_EGENERIC;
+}
+
+vlc_module_begin()
+    set_shortname(N_("WL DMA-BUF"))
+    set_description(N_("Wayland DMA-BUF zero-copy video output"))
+    set_subcategory(SUBCAT_VIDEO_VOUT)
+    set_callback_display(Open, 280)
+    add_shortcut("wl-dmabuf")
+vlc_module_end()
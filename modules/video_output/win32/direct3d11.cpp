@@ -143,6 +143,12 @@ typedef struct vout_display_sys_t
 
     bool                     use_staging_texture = false;
     picture_sys_d3d11_t      stagingSys = {};
+    // pictures rendered from their own texture or copied first
+    struct {
+        uint64_t             direct;
+        uint64_t             gpu_copies;
+        uint64_t             cpu_uploads;
+    } stats = {};
     plane_t                  stagingPlanes[PICTURE_PLANE_MAX];
 
     // NV12/P010 to RGB for D3D11 < 11.1
@@ -862,6 +868,7 @@ static void PreparePicture(vout_display_t *vd, picture_t *picture,
         {
             for (i = 0; i < picture->i_planes; i++)
                 plane_CopyPixels(&sys->stagingPlanes[i], &picture->p[i]);
+            sys->stats.cpu_uploads++;
 
             for (i = 0; i < picture->i_planes; i++)
                 sys->d3d_dev->d3dcontext->Unmap(sys->stagingSys.resource[i], 0);
@@ -892,6 +899,7 @@ static void PreparePicture(vout_display_t *vd, picture_t *picture,
             }
 
             sys->d3d_dev->d3dcontext->Unmap(sys->stagingSys.resource[0], 0);
+            sys->stats.cpu_uploads++;
         }
     }
     else
@@ -932,6 +940,7 @@ static void PreparePicture(vout_display_t *vd, picture_t *picture,
                     sys->old_feature.d3dvidctx->VideoProcessorBlt(sys->old_feature.processor.Get(),
                                                                   sys->old_feature.outputView.Get(),
                                                                   0, 1, &stream);
+                    sys->stats.gpu_copies++;
                 }
             }
             else
@@ -949,10 +958,13 @@ static void PreparePicture(vout_display_t *vd, picture_t *picture,
                                                         0, 0, 0, 0,
                                                         p_sys->resource[KNOWN_DXGI_INDEX],
                                                         p_sys->slice_index, &box);
+                sys->stats.gpu_copies++;
             }
         }
         else
         {
+            // sample the decoder texture (array slice) directly
+            sys->stats.direct++;
             if (srcDesc.BindFlags & D3D11_BIND_SHADER_RESOURCE)
             {
                 /* for performance reason we don't want to allocate this during
@@ -1507,7 +1519,9 @@ static void Direct3D11Close(vout_display_t *vd)
     if (sys->d3d_dev && sys->d3d_dev == &sys->local_d3d_dev->d3d_dev)
         D3D11_ReleaseDevice( sys->local_d3d_dev );
 
-    msg_Dbg(vd, "Direct3D11 display adapter closed");
+    msg_Dbg(vd, "Direct3D11 display adapter closed (pictures: %" PRIu64 " direct, "
+            "%" PRIu64 " copied on the GPU, %" PRIu64 " uploaded)",
+            sys->stats.direct, sys->stats.gpu_copies, sys->stats.cpu_uploads);
 }
 
 /* TODO : handle errors better
@@ -693,6 +693,14 @@ static void Close( vlc_object_t *p_this )
     free( p_sys );
 }
 
+static bool IsUnfiltered( const panoramix_filter_t *p_filter )
+{
+    return !p_filter->black.i_left && !p_filter->black.i_right &&
+           !p_filter->black.i_top && !p_filter->black.i_bottom &&
+           !p_filter->attenuate.i_left && !p_filter->attenuate.i_right &&
+           !p_filter->attenuate.i_top && !p_filter->attenuate.i_bottom;
+}
+
 /**
  * It creates multiples pictures from the source one
  */
@@ -700,12 +708,6 @@ static int Filter( video_splitter_t *p_splitter, picture_t *pp_dst[], picture_t
 {
     video_splitter_sys_t *p_sys = p_splitter->p_sys;
 
-    if( video_splitter_NewPicture( p_splitter, pp_dst ) )
-    {
-        picture_Release( p_src );
-        return VLC_EGENERIC;
-    }
-
     for( int y = 0; y < p_sys->i_row; y++ )
     {
         for( int x = 0; x < p_sys->i_col; x++ )
@@ -714,11 +716,31 @@ static int Filter( video_splitter_t *p_splitter, picture_t *pp_dst[], picture_t
             if( !p_output->b_active )
                 continue;
 
-            /* */
-            picture_t *p_dst = pp_dst[p_output->i_output];
+            /* Share the source pixels of the outputs without borders nor
+             * blending */
+            const video_format_t *p_fmt =
+                &p_splitter->p_output[p_output->i_output].fmt;
+            picture_t *p_dst = NULL;
+            if( IsUnfiltered( &p_output->filter ) )
+                p_dst = picture_NewView( p_src, p_fmt, p_output->i_src_x,
+                                         p_output->i_src_y );
+            const bool b_view = p_dst != NULL;
+            if( !b_view )
+                p_dst = picture_NewFromFormat( p_fmt );
+            if( p_dst == NULL )
+            {
+                for( int i = 0; i < p_output->i_output; i++ )
+                    picture_Release( pp_dst[i] );
+                msg_Warn( p_splitter, "can't get output pictures" );
+                picture_Release( p_src );
+                return VLC_EGENERIC;
+            }
+            pp_dst[p_output->i_output] = p_dst;
 
             /* */
             picture_CopyProperties( p_dst, p_src );
+            if( b_view )
+                continue;
 
             /* */
             for( int i_plane = 0; i_plane < p_src->i_planes; i_plane++ )
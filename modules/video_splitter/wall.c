@@ -247,15 +247,41 @@ static void Close( vlc_object_t *p_this )
     free( p_sys );
 }
 
-static int Filter( video_splitter_t *p_splitter, picture_t *pp_dst[], picture_t *p_src )
+static picture_t *NewOutputPicture( video_splitter_t *p_splitter,
+                                    const wall_output_t *p_output,
+                                    picture_t *p_src )
 {
-    video_splitter_sys_t *p_sys = p_splitter->p_sys;
+    const video_format_t *p_fmt =
+        &p_splitter->p_output[p_output->i_output].fmt;
+
+    /* Share the source pixels when possible */
+    picture_t *p_dst = picture_NewView( p_src, p_fmt, p_output->i_left,
+                                        p_output->i_top );
+    if( p_dst != NULL )
+        return p_dst;
 
-    if( video_splitter_NewPicture( p_splitter, pp_dst ) )
+    p_dst = picture_NewFromFormat( p_fmt );
+    if( p_dst == NULL )
+        return NULL;
+
+    for( int i = 0; i < p_src->i_planes; i++ )
     {
-        picture_Release( p_src );
-        return VLC_EGENERIC;
+        const plane_t *p0 = p_src->p;
+        plane_t p = p_src->p[i];
+        const int i_y = p_output->i_top  * p.i_visible_pitch
+                                           / p0->i_visible_pitch;
+        const int i_x = p_output->i_left * p.i_visible_lines
+                                           / p0->i_visible_lines;
+
+        p.p_pixels += i_y * p.i_pitch + i_x * p.i_pixel_pitch;
+        plane_CopyPixels(p_dst->p + i, &p);
     }
+    return p_dst;
+}
+
+static int Filter( video_splitter_t *p_splitter, picture_t *pp_dst[], picture_t *p_src )
+{
+    video_splitter_sys_t *p_sys = p_splitter->p_sys;
 
     for( int y = 0; y < p_sys->i_row; y++ )
     {
@@ -265,22 +291,17 @@ static int Filter( video_splitter_t *p_splitter, picture_t *pp_dst[], picture_t
             if( !p_output->b_active )
                 continue;
 
-            picture_t *p_dst = pp_dst[p_output->i_output];
-
-            /* */
-            for( int i = 0; i < p_src->i_planes; i++ )
+            picture_t *p_dst = NewOutputPicture( p_splitter, p_output, p_src );
+            if( p_dst == NULL )
             {
-                const plane_t *p0 = p_src->p;
-                plane_t p = p_src->p[i];
-                const int i_y = p_output->i_top  * p.i_visible_pitch
-                                                   / p0->i_visible_pitch;
-                const int i_x = p_output->i_left * p.i_visible_lines
-                                                   / p0->i_visible_lines;
-
-                p.p_pixels += i_y * p.i_pitch + i_x * p.i_pixel_pitch;
-                plane_CopyPixels(p_dst->p + i, &p);
+                for( int i = 0; i < p_output->i_output; i++ )
+                    picture_Release( pp_dst[i] );
+                msg_Warn( p_splitter, "can't get output pictures" );
+                picture_Release( p_src );
+                return VLC_EGENERIC;
             }
             picture_CopyProperties(p_dst, p_src);
+            pp_dst[p_output->i_output] = p_dst;
         }
     }
 
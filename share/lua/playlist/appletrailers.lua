@@ -19,6 +19,8 @@
  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
 --]]
 
+probe_hosts = { "trailers.apple.com" }
+
 -- Probe function
 function probe()
     return (vlc.access == "http" or vlc.access == "https")
@@ -21,6 +21,8 @@
 
 local simplexml = require "simplexml"
 
+probe_hosts = { "api.jamendo.com" }
+
 -- Probe function.
 function probe()
     return vlc.access == "http"
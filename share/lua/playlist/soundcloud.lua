@@ -20,6 +20,8 @@
  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
 --]]
 
+probe_hosts = { "soundcloud.com" }
+
 -- Probe function.
 function probe()
     local path = vlc.path
@@ -20,6 +20,8 @@ Resolve Twitch channel and video URLs to the actual stream URL
  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
 --]]
 
+probe_hosts = { "twitch.tv" }
+
 -- Probe function
 function probe()
     return (vlc.access == "http" or vlc.access == "https")
@@ -780,6 +780,8 @@ function assemble_stream_url( pick, js )
     return url
 end
 
+probe_hosts = { "youtube.com" }
+
 -- Probe function.
 function probe()
     return ( ( vlc.access == "http" or vlc.access == "https" ) and (
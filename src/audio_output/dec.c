@@ -591,11 +591,9 @@ static void stream_Silence (vlc_aout_stream *stream, vlc_tick_t length, vlc_tick
     block->i_length = length;
 
     const vlc_tick_t system_now = vlc_tick_now();
-    vlc_clock_Lock(stream->sync.clock);
     const vlc_tick_t system_pts =
-       vlc_clock_ConvertToSystem(stream->sync.clock, system_now, pts,
-                                 stream->sync.rate, NULL);
-    vlc_clock_Unlock(stream->sync.clock);
+       vlc_clock_ConvertToSystemUnlocked(stream->sync.clock, system_now, pts,
+                                         stream->sync.rate, NULL);
     stream->timing.played_samples += block->i_nb_samples;
     aout->play(aout, block, system_pts);
 }
@@ -611,6 +609,13 @@ static void stream_HandleDrift(vlc_aout_stream *stream, vlc_tick_t drift,
     if (owner->bitexact)
         return;
 
+    /* Small output buffers give accurate timings, do not wait for the
+     * drift to be audible */
+    const vlc_tick_t max_delay = owner->low_latency ?
+        AOUT_LOW_LATENCY_TIME / 2 : AOUT_MAX_PTS_DELAY;
+    const vlc_tick_t max_advance = owner->low_latency ?
+        AOUT_LOW_LATENCY_TIME / 2 : AOUT_MAX_PTS_ADVANCE;
+
     struct vlc_tracer *tracer = aout_stream_tracer(stream);
     if (tracer != NULL)
         vlc_tracer_Trace(tracer, VLC_TRACE("type", "RENDER"),
@@ -631,7 +636,7 @@ static void stream_HandleDrift(vlc_aout_stream *stream, vlc_tick_t drift,
      * where supported. The other alternative is to flush the buffers
      * completely. */
     if (drift > (stream->sync.played ?
-                 lroundf(+3 * AOUT_MAX_PTS_DELAY / rate) : 0))
+                 lroundf(+3 * max_delay / rate) : 0))
     {
         if (tracer != NULL)
             vlc_tracer_TraceEvent(tracer, "RENDER", stream->str_id, "late_flush");
@@ -651,7 +656,7 @@ static void stream_HandleDrift(vlc_aout_stream *stream, vlc_tick_t drift,
     /* Early audio output.
      * This is rare except at startup when the buffers are still empty. */
     if (drift < (stream->sync.played ?
-                 lroundf(-3 * AOUT_MAX_PTS_ADVANCE / rate) : 0))
+                 lroundf(-3 * max_advance / rate) : 0))
     {
         if (stream->sync.played)
         {
@@ -671,7 +676,7 @@ static void stream_HandleDrift(vlc_aout_stream *stream, vlc_tick_t drift,
         return;
 
     /* Resampling */
-    if (drift > +AOUT_MAX_PTS_DELAY
+    if (drift > +max_delay
      && stream->sync.resamp_type != AOUT_RESAMPLING_UP)
     {
         if (tracer != NULL)
@@ -681,7 +686,7 @@ static void stream_HandleDrift(vlc_aout_stream *stream, vlc_tick_t drift,
         stream->sync.resamp_type = AOUT_RESAMPLING_UP;
         stream->sync.resamp_start_drift = +drift;
     }
-    if (drift < -AOUT_MAX_PTS_ADVANCE
+    if (drift < -max_advance
      && stream->sync.resamp_type != AOUT_RESAMPLING_DOWN)
     {
         if (tracer != NULL)
@@ -850,11 +855,9 @@ static vlc_tick_t stream_ClockConvert(vlc_aout_stream *stream,
 {
     uint32_t clock_id;
 
-    vlc_clock_Lock(stream->sync.clock);
     vlc_tick_t play_date =
-        vlc_clock_ConvertToSystem(stream->sync.clock, system_now, pts,
-                                  stream->sync.rate, &clock_id);
-    vlc_clock_Unlock(stream->sync.clock);
+        vlc_clock_ConvertToSystemUnlocked(stream->sync.clock, system_now, pts,
+                                          stream->sync.rate, &clock_id);
 
     if (clock_id != stream->sync.clock_id && stream->sync.played)
     {
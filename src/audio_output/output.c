@@ -403,6 +403,7 @@ audio_output_t *aout_New (vlc_object_t *parent)
     var_Create (aout, "equalizer-preset", VLC_VAR_STRING | doinherit);
 
     owner->bitexact = var_InheritBool (aout, "audio-bitexact");
+    owner->low_latency = var_InheritBool (aout, "audio-low-latency");
 
     return aout;
 }
@@ -41,6 +41,7 @@ struct aout_volume
     audio_replay_gain_t replay_gain;
     _Atomic float gain_factor;
     _Atomic float output_factor;
+    float applied_factor; /**< last applied factor, NAN if none */
     module_t *module;
 };
 
@@ -61,6 +62,7 @@ aout_volume_t *aout_volume_New(vlc_object_t *parent,
     vol->module = NULL;
     atomic_init(&vol->gain_factor, 1.f);
     atomic_init(&vol->output_factor, 1.f);
+    vol->applied_factor = NAN;
 
     //audio_volume_t *obj = &vol->object;
 
@@ -95,6 +97,8 @@ int aout_volume_SetFormat(aout_volume_t *vol, vlc_fourcc_t format)
     }
 
     obj->format = format;
+    obj->amplify_ramp = NULL;
+    vol->applied_factor = NAN;
     vol->module = module_need(obj, "audio volume", NULL, false);
     if (vol->module == NULL)
         return -1;
@@ -131,7 +135,13 @@ int aout_volume_Amplify(aout_volume_t *vol, block_t *block)
     float amp = atomic_load_explicit(&vol->output_factor, memory_order_relaxed)
               * atomic_load_explicit(&vol->gain_factor, memory_order_relaxed);
 
-    vol->object.amplify(&vol->object, block, amp);
+    /* Ramp from the previous factor to avoid a step on volume changes */
+    if (vol->object.amplify_ramp != NULL && !isnan(vol->applied_factor)
+     && vol->applied_factor != amp)
+        vol->object.amplify_ramp(&vol->object, block, vol->applied_factor, amp);
+    else
+        vol->object.amplify(&vol->object, block, amp);
+    vol->applied_factor = amp;
     return 0;
 }
 
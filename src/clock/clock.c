@@ -27,6 +27,7 @@
 
 #include <vlc_common.h>
 #include <vlc_aout.h>
+#include <vlc_atomic.h>
 #include <assert.h>
 #include <limits.h>
 #include <vlc_tracer.h>
@@ -95,6 +96,24 @@ struct vlc_clock_main_t
 
     struct VLC_VECTOR(vlc_clock_listener_id *) listeners;
     struct vlc_list prev_contexts;
+
+    /**
+     * Copy of the main context parameters, published with a sequence lock
+     * each time the lock is released, for the lock-free conversions
+     * (cf. vlc_clock_ConvertToSystemUnlocked()). It is only valid when
+     * there is a single context with a master reference point.
+     */
+    struct
+    {
+        atomic_uint seq; /* odd while being published */
+        _Atomic bool valid;
+        _Atomic uint32_t clock_id;
+        _Atomic double coeff;
+        _Atomic double rate;
+        _Atomic vlc_tick_t stream;
+        _Atomic vlc_tick_t system; /* offset + start system */
+        _Atomic vlc_tick_t delay;
+    } snapshot;
 };
 
 struct vlc_clock_ops
@@ -138,7 +157,12 @@ struct vlc_clock_t
 
     struct vlc_clock_context *context;
 
-    vlc_tick_t last_conversion;
+    _Atomic vlc_tick_t last_conversion;
+
+    /* Copies of the delay and of the role of the clock, written with the
+     * lock held, for the lock-free conversions */
+    _Atomic vlc_tick_t conv_delay;
+    _Atomic bool conv_slave;
 };
 
 vlc_clock_listener_id *
@@ -335,7 +359,8 @@ context_get_closest(vlc_clock_t *clock, struct vlc_clock_context *ctx,
     vlc_tick_t converted =
         clock->ops->to_system(clock, ctx, system_now, ts, 1.0);
 
-    vlc_tick_t diff = converted - clock->last_conversion;
+    vlc_tick_t diff = converted
+        - atomic_load_explicit(&clock->last_conversion, memory_order_relaxed);
 
     if (diff < 0)
         diff = -diff;
@@ -807,8 +832,10 @@ vlc_clock_output_start(vlc_clock_t *clock,
     vlc_clock_main_t *main_clock = clock->owner;
     vlc_mutex_assert(&main_clock->lock);
 
-    if (clock->last_conversion == VLC_TICK_INVALID)
-        clock->last_conversion = start_date;
+    if (atomic_load_explicit(&clock->last_conversion,
+                             memory_order_relaxed) == VLC_TICK_INVALID)
+        atomic_store_explicit(&clock->last_conversion, start_date,
+                              memory_order_relaxed);
 
     /* Attach to the correct context in case of reset */
     struct vlc_clock_context *context
@@ -902,6 +929,61 @@ vlc_clock_output_start(vlc_clock_t *clock,
     context->wait_sync_ref = clock_point_Create(start_date + delay, first_ts);
 }
 
+static void vlc_clock_main_publish(vlc_clock_main_t *main_clock)
+{
+    vlc_mutex_assert(&main_clock->lock);
+    const struct vlc_clock_context *ctx = main_clock->context;
+
+    /* Other cases need the context selection or the monotonic fallback */
+    const bool valid = ctx->last.system != VLC_TICK_INVALID
+                    && vlc_list_is_empty(&main_clock->prev_contexts);
+    const vlc_tick_t system = ctx->offset + ctx->start_time.system;
+
+#define SNAPSHOT_GET(field) \
+    atomic_load_explicit(&main_clock->snapshot.field, memory_order_relaxed)
+#define SNAPSHOT_SET(field, value) \
+    atomic_store_explicit(&main_clock->snapshot.field, value, \
+                          memory_order_relaxed)
+
+    /* Don't disturb the readers when nothing changed */
+    if (valid == SNAPSHOT_GET(valid)
+     && (!valid || (ctx->clock_id == SNAPSHOT_GET(clock_id)
+                 && ctx->coeff == SNAPSHOT_GET(coeff)
+                 && ctx->rate == SNAPSHOT_GET(rate)
+                 && ctx->start_time.stream == SNAPSHOT_GET(stream)
+                 && system == SNAPSHOT_GET(system)
+                 && main_clock->delay == SNAPSHOT_GET(delay))))
+        return;
+
+    unsigned seq = SNAPSHOT_GET(seq);
+    SNAPSHOT_SET(seq, seq + 1);
+    atomic_thread_fence(memory_order_release);
+
+    SNAPSHOT_SET(valid, valid);
+    SNAPSHOT_SET(clock_id, ctx->clock_id);
+    SNAPSHOT_SET(coeff, ctx->coeff);
+    SNAPSHOT_SET(rate, ctx->rate);
+    SNAPSHOT_SET(stream, ctx->start_time.stream);
+    SNAPSHOT_SET(system, system);
+    SNAPSHOT_SET(delay, main_clock->delay);
+
+    atomic_store_explicit(&main_clock->snapshot.seq, seq + 2,
+                          memory_order_release);
+#undef SNAPSHOT_SET
+#undef SNAPSHOT_GET
+}
+
+static void vlc_clock_publish_delay(vlc_clock_t *clock)
+{
+    vlc_mutex_assert(&clock->owner->lock);
+
+    atomic_store_explicit(&clock->conv_delay, clock->delay,
+                          memory_order_relaxed);
+    atomic_store_explicit(&clock->conv_slave,
+                          clock->ops->to_system == vlc_clock_slave_to_system,
+                          memory_order_relaxed);
+}
+
 void vlc_clock_Lock(vlc_clock_t *clock)
 {
     vlc_clock_main_t *main_clock = clock->owner;
@@ -911,6 +993,7 @@ void vlc_clock_Lock(vlc_clock_t *clock)
 void vlc_clock_Unlock(vlc_clock_t *clock)
 {
     vlc_clock_main_t *main_clock = clock->owner;
+    vlc_clock_main_publish(main_clock);
     vlc_mutex_unlock(&main_clock->lock);
 }
 
@@ -985,6 +1068,15 @@ vlc_clock_main_t *vlc_clock_main_New(struct vlc_logger *parent_logger, struct vl
     vlc_vector_init(&main_clock->listeners);
     vlc_list_init(&main_clock->prev_contexts);
 
+    atomic_init(&main_clock->snapshot.seq, 0);
+    atomic_init(&main_clock->snapshot.valid, false);
+    atomic_init(&main_clock->snapshot.clock_id, ctx->clock_id);
+    atomic_init(&main_clock->snapshot.coeff, ctx->coeff);
+    atomic_init(&main_clock->snapshot.rate, ctx->rate);
+    atomic_init(&main_clock->snapshot.stream, VLC_TICK_INVALID);
+    atomic_init(&main_clock->snapshot.system, VLC_TICK_INVALID);
+    atomic_init(&main_clock->snapshot.delay, 0);
+
     return main_clock;
 }
 
@@ -1103,7 +1195,7 @@ void vlc_clock_main_Lock(vlc_clock_main_t *main_clock)
 
 void vlc_clock_main_Unlock(vlc_clock_main_t *main_clock)
 {
-    vlc_mutex_assert(&main_clock->lock);
+    vlc_clock_main_publish(main_clock);
     vlc_mutex_unlock(&main_clock->lock);
 }
 
@@ -1144,12 +1236,15 @@ void vlc_clock_Reset(vlc_clock_t *clock)
 {
     AssertLocked(clock);
     clock->ops->reset(clock);
+    vlc_clock_publish_delay(clock);
 }
 
 vlc_tick_t vlc_clock_SetDelay(vlc_clock_t *clock, vlc_tick_t delay)
 {
     AssertLocked(clock);
-    return clock->ops->set_delay(clock, delay);
+    vlc_tick_t ret = clock->ops->set_delay(clock, delay);
+    vlc_clock_publish_delay(clock);
+    return ret;
 }
 
 vlc_tick_t vlc_clock_ConvertToSystem(vlc_clock_t *clock,
@@ -1162,9 +1257,84 @@ vlc_tick_t vlc_clock_ConvertToSystem(vlc_clock_t *clock,
     if (clock_id != NULL)
         *clock_id = ctx->clock_id;
 
-    clock->last_conversion =
-        clock->ops->to_system(clock, ctx, system_now, ts, rate);
-    return clock->last_conversion;
+    vlc_tick_t system = clock->ops->to_system(clock, ctx, system_now, ts, rate);
+    atomic_store_explicit(&clock->last_conversion, system,
+                          memory_order_relaxed);
+
+    vlc_clock_main_t *main_clock = clock->owner;
+    if (main_clock->tracer != NULL && clock->track_str_id != NULL &&
+        system != VLC_TICK_MAX)
+        vlc_tracer_TraceWithTs(main_clock->tracer, system_now,
+                               VLC_TRACE("type", "CLOCK"),
+                               VLC_TRACE("id", clock->track_str_id),
+                               VLC_TRACE("event", "convert"),
+                               VLC_TRACE("clock_id", (int64_t)ctx->clock_id),
+                               VLC_TRACE_TICK_NS("ts", ts),
+                               VLC_TRACE_TICK_NS("system_ts", system),
+                               VLC_TRACE_END);
+    return system;
+}
+
+static bool vlc_clock_convert_snapshot(vlc_clock_t *clock, vlc_tick_t ts,
+                                       double rate, vlc_tick_t *system,
+                                       uint32_t *clock_id)
+{
+    vlc_clock_main_t *main_clock = clock->owner;
+
+    unsigned seq = atomic_load_explicit(&main_clock->snapshot.seq,
+                                        memory_order_acquire);
+    if (seq & 1)
+        return false; /* A writer holds the lock, don't spin */
+
+#define SNAPSHOT_GET(field) \
+    atomic_load_explicit(&main_clock->snapshot.field, memory_order_relaxed)
+    const bool valid = SNAPSHOT_GET(valid);
+    const uint32_t id = SNAPSHOT_GET(clock_id);
+    const double coeff = SNAPSHOT_GET(coeff);
+    const double ctx_rate = SNAPSHOT_GET(rate);
+    const vlc_tick_t start_stream = SNAPSHOT_GET(stream);
+    const vlc_tick_t start_system = SNAPSHOT_GET(system);
+    const vlc_tick_t main_delay = SNAPSHOT_GET(delay);
+#undef SNAPSHOT_GET
+
+    atomic_thread_fence(memory_order_acquire);
+    if (!valid || atomic_load_explicit(&main_clock->snapshot.seq,
+                                       memory_order_relaxed) != seq)
+        return false;
+
+    /* Same as context_stream_to_system() and the slave delay adjustment */
+    vlc_tick_t converted =
+        ((vlc_tick_t) ((ts - start_stream) * coeff / ctx_rate)) + start_system;
+    if (atomic_load_explicit(&clock->conv_slave, memory_order_relaxed))
+        converted += (atomic_load_explicit(&clock->conv_delay,
+                                           memory_order_relaxed)
+                      - main_delay) * rate;
+
+    atomic_store_explicit(&clock->last_conversion, converted,
+                          memory_order_relaxed);
+    if (clock_id != NULL)
+        *clock_id = id;
+    *system = converted;
+    return true;
+}
+
+vlc_tick_t vlc_clock_ConvertToSystemUnlocked(vlc_clock_t *clock,
+                                             vlc_tick_t system_now,
+                                             vlc_tick_t ts, double rate,
+                                             uint32_t *clock_id)
+{
+    vlc_clock_main_t *main_clock = clock->owner;
+    vlc_tick_t system;
+
+    /* Traced conversions always go through the lock */
+    if ((main_clock->tracer == NULL || clock->track_str_id == NULL)
+     && vlc_clock_convert_snapshot(clock, ts, rate, &system, clock_id))
+        return system;
+
+    vlc_clock_Lock(clock);
+    system = vlc_clock_ConvertToSystem(clock, system_now, ts, rate, clock_id);
+    vlc_clock_Unlock(clock);
+    return system;
 }
 
 static const struct vlc_clock_ops master_ops = {
@@ -1216,7 +1386,9 @@ static vlc_clock_t *vlc_clock_main_Create(vlc_clock_main_t *main_clock,
     clock->cbs_data = cbs_data;
     clock->priority = priority;
     assert(!cbs || cbs->on_update);
-    clock->last_conversion = VLC_TICK_INVALID;
+    atomic_init(&clock->last_conversion, VLC_TICK_INVALID);
+    atomic_init(&clock->conv_delay, 0);
+    atomic_init(&clock->conv_slave, false);
 
     if (input)
     {
@@ -1254,6 +1426,7 @@ vlc_clock_t *vlc_clock_main_CreateMaster(vlc_clock_main_t *main_clock,
         clock->ops = &master_ops;
     else
         clock->ops = &slave_ops;
+    vlc_clock_publish_delay(clock);
 
     main_clock->master = clock;
     main_clock->rc++;
@@ -1280,9 +1453,13 @@ vlc_clock_t *vlc_clock_main_CreateInputMaster(vlc_clock_main_t *main_clock)
 
     /* Override the master ES clock if it exists */
     if (main_clock->master != NULL)
+    {
         main_clock->master->ops = &slave_ops;
+        vlc_clock_publish_delay(main_clock->master);
+    }
 
     clock->ops = &input_master_ops;
+    vlc_clock_publish_delay(clock);
     main_clock->input_master = clock;
     main_clock->rc++;
 
@@ -1300,6 +1477,7 @@ vlc_clock_t *vlc_clock_main_CreateInputSlave(vlc_clock_main_t *main_clock)
         return NULL;
 
     clock->ops = &input_slave_ops;
+    vlc_clock_publish_delay(clock);
     main_clock->rc++;
 
     return clock;
@@ -1336,6 +1514,7 @@ vlc_clock_t *vlc_clock_main_CreateSlave(vlc_clock_main_t *main_clock,
         return NULL;
 
     clock->ops = &slave_ops;
+    vlc_clock_publish_delay(clock);
     main_clock->rc++;
 
     return clock;
@@ -1369,6 +1548,7 @@ void vlc_clock_Delete(vlc_clock_t *clock)
         main_clock->master = NULL;
     }
     main_clock->rc--;
+    vlc_clock_main_publish(main_clock);
     vlc_mutex_unlock(&main_clock->lock);
     free(clock);
 }
@@ -330,6 +330,23 @@ vlc_tick_t vlc_clock_ConvertToSystem(vlc_clock_t *clock,
                                      vlc_tick_t system_now, vlc_tick_t ts,
                                      double rate, uint32_t *clock_id);
 
+/**
+ * This function converts a timestamp from stream to system without locking
+ *
+ * In the common case (one timeline driven by a master reference point), the
+ * conversion is done against a snapshot of the clock parameters published
+ * when the clock lock is released. Otherwise, it behaves like
+ * vlc_clock_ConvertToSystem() with the lock taken internally.
+ *
+ * @param clock the unlocked clock used by the source
+ * @param clock_id pointer to the clock id used for conversion. Can be NULL.
+ * @return the valid system time
+ */
+vlc_tick_t vlc_clock_ConvertToSystemUnlocked(vlc_clock_t *clock,
+                                             vlc_tick_t system_now,
+                                             vlc_tick_t ts, double rate,
+                                             uint32_t *clock_id);
+
 /**
  * Starts a new clock based on the given clock point, accounting for
  * previous updates.
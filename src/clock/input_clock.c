@@ -66,6 +66,14 @@
  *
  * It is a very important matter if you want to avoid underflow or overflow
  * in all the FIFOs, but it may be not enough.
+ *
+ * The network can delay a packet but never deliver it early, so the jitter
+ * is not centered and bursty sources bias a mean. Instead, the minimum of
+ * the drift is kept for each window of CR_ENVELOPE_WINDOW, and a line is
+ * fitted through these minima: it follows the lower envelope of the drift
+ * and its slope is the skew between the 2 clocks. Windows whose minimum is
+ * above the line by more than the jitter tolerance (all their packets were
+ * delayed) are not used for the fit.
  */
 
 /* i_cr_average : Maximum number of samples used to compute the
@@ -101,6 +109,17 @@
 /* */
 #define INPUT_CLOCK_LATE_COUNT (3)
 
+/* Duration of a window of the drift lower envelope */
+#define CR_ENVELOPE_WINDOW VLC_TICK_FROM_MS(500)
+/* Maximum number of windows used to estimate the drift */
+#define CR_ENVELOPE_MAX (64)
+
+typedef struct
+{
+    vlc_tick_t system;
+    vlc_tick_t drift;
+} drift_point_t;
+
 /* */
 struct input_clock_t
 {
@@ -118,8 +137,26 @@ struct input_clock_t
     vlc_tick_t i_buffering_duration;
 
     /* Clock drift */
-    vlc_tick_t i_next_drift_update;
-    average_t drift;
+    struct
+    {
+        /* Minimum of each past window, from the oldest to the newest */
+        drift_point_t points[CR_ENVELOPE_MAX];
+        unsigned count;
+        unsigned index; /* next point to write */
+        unsigned size; /* number of windows used for the estimation */
+
+        /* Minimum of the current window */
+        drift_point_t min;
+        vlc_tick_t window_end;
+
+        /* drift(system) = intercept + slope * (system - origin) in seconds */
+        vlc_tick_t origin;
+        double intercept;
+        double slope;
+
+        average_t jitter; /* distance of the points above the envelope */
+        vlc_tick_t tolerance;
+    } drift;
 
     /* Late statistics */
     struct
@@ -146,13 +183,18 @@ static vlc_tick_t ClockSystemToStream( input_clock_t *, vlc_tick_t i_system );
 
 static vlc_tick_t ClockGetTsOffset( input_clock_t * );
 
+static void DriftReset( input_clock_t * );
+static void DriftUpdate( input_clock_t *, vlc_tick_t i_system, vlc_tick_t i_drift );
+static void DriftShift( input_clock_t *, vlc_tick_t i_offset );
+static vlc_tick_t DriftGet( const input_clock_t * );
+
 static void UpdateListener( input_clock_t *cl, bool discontinuity )
 {
     if (cl->listener.cbs == NULL)
         return;
 
     const vlc_tick_t system_expected =
-        ClockStreamToSystem( cl, cl->last.stream + AvgGet( &cl->drift ) ) +
+        ClockStreamToSystem( cl, cl->last.stream + DriftGet( cl ) ) +
         cl->i_pts_delay + ClockGetTsOffset( cl );
 
     /* The returned drift value is ignored for now since a different
@@ -181,8 +223,10 @@ input_clock_t *input_clock_New(struct vlc_logger *logger, float rate)
 
     cl->i_buffering_duration = 0;
 
-    cl->i_next_drift_update = VLC_TICK_INVALID;
-    AvgInit( &cl->drift, 10 );
+    cl->drift.size = 10;
+    cl->drift.tolerance = 0;
+    AvgInit( &cl->drift.jitter, 10 );
+    DriftReset( cl );
 
     cl->late.i_index = 0;
     for( int i = 0; i < INPUT_CLOCK_LATE_COUNT; i++ )
@@ -201,7 +245,7 @@ input_clock_t *input_clock_New(struct vlc_logger *logger, float rate)
  *****************************************************************************/
 void input_clock_Delete( input_clock_t *cl )
 {
-    AvgClean( &cl->drift );
+    AvgClean( &cl->drift.jitter );
     free( cl );
 }
 
@@ -273,8 +317,7 @@ vlc_tick_t input_clock_Update( input_clock_t *cl,
     /* */
     if( b_reset_reference )
     {
-        cl->i_next_drift_update = VLC_TICK_INVALID;
-        AvgReset( &cl->drift );
+        DriftReset( cl );
 
         /* Feed synchro with a new reference point. */
         cl->b_has_reference = true;
@@ -283,13 +326,11 @@ vlc_tick_t input_clock_Update( input_clock_t *cl,
 
     /* Compute the drift between the stream clock and the system clock
      * when we don't control the source pace */
-    if( !b_can_pace_control && cl->i_next_drift_update < i_ck_system )
+    if( !b_can_pace_control )
     {
         const vlc_tick_t i_converted = ClockSystemToStream( cl, i_ck_system );
 
-        AvgUpdate( &cl->drift, i_converted - i_ck_stream );
-
-        cl->i_next_drift_update = i_ck_system + VLC_TICK_FROM_MS(200); /* FIXME why that */
+        DriftUpdate( cl, i_ck_system, i_converted - i_ck_stream );
     }
 
     /* Update the extra buffering value */
@@ -315,7 +356,7 @@ vlc_tick_t input_clock_Update( input_clock_t *cl,
 
     /* It does not take the decoder latency into account but it is not really
      * the goal of the clock here */
-    const vlc_tick_t i_system_expected = ClockStreamToSystem( cl, i_ck_stream + AvgGet( &cl->drift ) );
+    const vlc_tick_t i_system_expected = ClockStreamToSystem( cl, i_ck_stream + DriftGet( cl ) );
     const vlc_tick_t i_late = (i_ck_system - cl->i_pts_delay ) - i_system_expected;
     if( i_late > 0 )
     {
@@ -356,6 +397,8 @@ void input_clock_ChangeRate( input_clock_t *cl, float rate )
          * from the start */
         cl->ref.system = cl->last.system
             - (vlc_tick_t) ((cl->last.system - cl->ref.system) / rate * oldrate);
+        /* The drift points were measured at the old rate */
+        DriftReset( cl );
 
         UpdateListener( cl, false );
     }
@@ -376,6 +419,7 @@ void input_clock_ChangePause( input_clock_t *cl, bool b_paused, vlc_tick_t i_dat
         {
             cl->ref.system += i_duration;
             cl->last.system += i_duration;
+            DriftShift( cl, i_duration );
 
             UpdateListener( cl, false );
         }
@@ -393,7 +437,7 @@ vlc_tick_t input_clock_GetWakeup( input_clock_t *cl )
 
     /* Synchronized, we can wait */
     if( cl->b_has_reference )
-        i_wakeup = ClockStreamToSystem( cl, cl->last.stream + AvgGet( &cl->drift ) - cl->i_buffering_duration );
+        i_wakeup = ClockStreamToSystem( cl, cl->last.stream + DriftGet( cl ) - cl->i_buffering_duration );
 
     return i_wakeup;
 }
@@ -456,6 +500,7 @@ void input_clock_ChangeSystemOrigin( input_clock_t *cl, vlc_tick_t i_system )
 
     cl->ref.system += i_offset;
     cl->last.system += i_offset;
+    DriftShift( cl, i_offset );
 
     UpdateListener( cl, false );
 }
@@ -492,8 +537,32 @@ void input_clock_SetJitter( input_clock_t *cl,
     if( i_cr_average < 10 )
         i_cr_average = 10;
 
-    if( cl->drift.range != i_cr_average )
-        AvgRescale( &cl->drift, i_cr_average );
+    /* i_cr_average used to count drift samples taken every 200ms */
+    unsigned size = i_cr_average * VLC_TICK_FROM_MS(200) / CR_ENVELOPE_WINDOW;
+    cl->drift.size = VLC_CLIP( size, 4, CR_ENVELOPE_MAX );
+    if( cl->drift.count > cl->drift.size )
+        cl->drift.count = cl->drift.size;
+
+    if( cl->drift.jitter.range != i_cr_average )
+        AvgRescale( &cl->drift.jitter, i_cr_average );
+}
+
+void input_clock_SetJitterTolerance( input_clock_t *cl, vlc_tick_t i_tolerance )
+{
+    assert( i_tolerance >= 0 );
+    cl->drift.tolerance = i_tolerance;
+}
+
+int input_clock_GetDrift( input_clock_t *cl,
+                          double *pf_skew, vlc_tick_t *pi_jitter )
+{
+    if( !cl->b_has_reference || cl->drift.count < 2 )
+        return VLC_EGENERIC;
+
+    /* ticks of drift per second of system time */
+    *pf_skew = cl->drift.slope * 1000000. / CLOCK_FREQ;
+    *pi_jitter = AvgGet( &cl->drift.jitter );
+    return VLC_SUCCESS;
 }
 
 vlc_tick_t input_clock_GetJitter( input_clock_t *cl )
@@ -544,3 +613,141 @@ static vlc_tick_t ClockGetTsOffset( input_clock_t *cl )
     return cl->i_pts_delay * ( 1.0f / cl->rate - 1.0f );
 }
 
+
+/*****************************************************************************
+ * Drift lower envelope
+ *****************************************************************************/
+static void DriftReset( input_clock_t *cl )
+{
+    cl->drift.count = 0;
+    cl->drift.index = 0;
+    cl->drift.window_end = VLC_TICK_INVALID;
+    cl->drift.origin = VLC_TICK_INVALID;
+    cl->drift.intercept = 0.;
+    cl->drift.slope = 0.;
+    AvgReset( &cl->drift.jitter );
+}
+
+static const drift_point_t *DriftPoint( const input_clock_t *cl, unsigned i )
+{
+    /* 0 is the newest point */
+    assert( i < cl->drift.count );
+    return &cl->drift.points[(cl->drift.index + CR_ENVELOPE_MAX - 1 - i)
+                             % CR_ENVELOPE_MAX];
+}
+
+static double DriftAt( const input_clock_t *cl, vlc_tick_t i_system )
+{
+    return cl->drift.intercept + cl->drift.slope *
+           secf_from_vlc_tick( i_system - cl->drift.origin );
+}
+
+/**
+ * Least square fit of the window minima. If b_robust, the minima above the
+ * current fit by more than the tolerance are not used.
+ *
+ * It returns the number of minima used.
+ */
+static unsigned DriftFit( input_clock_t *cl, bool b_robust )
+{
+    double sx = 0., sy = 0., sxx = 0., sxy = 0.;
+    unsigned n = 0;
+
+    for( unsigned i = 0; i < cl->drift.count; i++ )
+    {
+        const drift_point_t *p = DriftPoint( cl, i );
+        if( b_robust && p->drift - DriftAt( cl, p->system ) > cl->drift.tolerance )
+            continue;
+
+        const double x = secf_from_vlc_tick( p->system - cl->drift.origin );
+        sx += x;
+        sy += p->drift;
+        sxx += x * x;
+        sxy += x * p->drift;
+        n++;
+    }
+
+    if( n < 2 )
+        return n; /* keep the current fit */
+
+    const double det = n * sxx - sx * sx;
+    cl->drift.slope = det > 0. ? ( n * sxy - sx * sy ) / det : 0.;
+    cl->drift.intercept = ( sy - cl->drift.slope * sx ) / n;
+    return n;
+}
+
+static void DriftUpdate( input_clock_t *cl, vlc_tick_t i_system, vlc_tick_t i_drift )
+{
+    if( cl->drift.window_end != VLC_TICK_INVALID
+     && i_system < cl->drift.window_end )
+    {
+        if( i_drift < cl->drift.min.drift )
+            cl->drift.min = (drift_point_t) { i_system, i_drift };
+    }
+    else
+    {
+        if( cl->drift.window_end != VLC_TICK_INVALID )
+        {
+            /* Close the window and move the fit to the newest point */
+            const bool b_had_fit = cl->drift.count >= 2;
+            if( b_had_fit )
+                cl->drift.intercept = DriftAt( cl, cl->drift.min.system );
+            cl->drift.origin = cl->drift.min.system;
+
+            cl->drift.points[cl->drift.index] = cl->drift.min;
+            cl->drift.index = ( cl->drift.index + 1 ) % CR_ENVELOPE_MAX;
+            if( cl->drift.count < cl->drift.size )
+                cl->drift.count++;
+
+            if( cl->drift.tolerance == 0 || !b_had_fit )
+                DriftFit( cl, false );
+
+            if( cl->drift.tolerance > 0 )
+            {
+                /* Reject the congested windows against the previous fit,
+                 * then against the new one */
+                DriftFit( cl, true );
+                if( DriftFit( cl, true ) * 2 < cl->drift.count )
+                    DriftFit( cl, false ); /* the source clock moved */
+            }
+        }
+        cl->drift.min = (drift_point_t) { i_system, i_drift };
+        cl->drift.window_end = i_system + CR_ENVELOPE_WINDOW;
+    }
+
+    if( cl->drift.count >= 2 )
+        AvgUpdate( &cl->drift.jitter, i_drift - DriftAt( cl, i_system ) );
+}
+
+static void DriftShift( input_clock_t *cl, vlc_tick_t i_offset )
+{
+    /* The drift does not change when both the reference and the points are
+     * moved */
+    for( unsigned i = 0; i < cl->drift.count; i++ )
+        cl->drift.points[(cl->drift.index + CR_ENVELOPE_MAX - 1 - i)
+                         % CR_ENVELOPE_MAX].system += i_offset;
+    if( cl->drift.window_end != VLC_TICK_INVALID )
+    {
+        cl->drift.min.system += i_offset;
+        cl->drift.window_end += i_offset;
+    }
+    if( cl->drift.origin != VLC_TICK_INVALID )
+        cl->drift.origin += i_offset;
+}
+
+/**
+ * It returns the drift at the last point, following the lower envelope
+ */
+static vlc_tick_t DriftGet( const input_clock_t *cl )
+{
+    if( cl->drift.count >= 2 )
+        return DriftAt( cl, cl->last.system );
+
+    if( cl->drift.window_end == VLC_TICK_INVALID )
+        return 0;
+
+    vlc_tick_t i_drift = cl->drift.min.drift;
+    if( cl->drift.count == 1 )
+        i_drift = __MIN( i_drift, DriftPoint( cl, 0 )->drift );
+    return i_drift;
+}
@@ -187,4 +187,22 @@ void input_clock_SetJitter( input_clock_t *,
  */
 vlc_tick_t input_clock_GetJitter( input_clock_t * );
 
+/**
+ * This function sets how much later than the estimated source clock the
+ * reference points of a whole estimation window may arrive before the
+ * window is ignored for the drift estimation (0 to use all the windows).
+ */
+void input_clock_SetJitterTolerance( input_clock_t *, vlc_tick_t i_tolerance );
+
+/**
+ * This function returns the drift statistics or VLC_EGENERIC if the drift
+ * is not estimated (the source pace is controlled, or not enough points).
+ *
+ * \param pf_skew skew of the system clock against the source clock in ppm,
+ * positive when the source clock is slower
+ * \param pi_jitter mean delay of the reference points above the estimated
+ * source clock
+ */
+int input_clock_GetDrift( input_clock_t *, double *pf_skew, vlc_tick_t *pi_jitter );
+
 #endif
@@ -81,6 +81,63 @@ static void test_clock_update(void)
     input_clock_Delete(clock);
 }
 
+static vlc_tick_t drift_listener_update(void *opaque, vlc_tick_t ck_system,
+                                        vlc_tick_t ck_stream, double rate,
+                                        bool discontinuity)
+{
+    (void)ck_stream; (void)rate;
+    assert(!discontinuity);
+    vlc_tick_t *system_expected = opaque;
+    *system_expected = ck_system;
+    return 0;
+}
+
+static const struct vlc_input_clock_cbs drift_listener_cbs = {
+    .update = drift_listener_update,
+};
+
+static void test_clock_drift(void)
+{
+    /* The source clock is 100ppm faster, the clock references are delayed by
+     * up to 30ms, and by 150ms more for 1s every 7s. */
+    input_clock_t *clock = input_clock_New(&logger, 1.f);
+    assert(clock != NULL);
+
+    vlc_tick_t system_expected = VLC_TICK_INVALID;
+    input_clock_AttachListener(clock, &drift_listener_cbs, &system_expected);
+    input_clock_SetJitter(clock, 0, 40);
+    input_clock_SetJitterTolerance(clock, VLC_TICK_FROM_MS(20));
+
+    unsigned seed = 1;
+    vlc_tick_t system = VLC_TICK_0;
+    for (int i = 0; i < 4500; i++)
+    {
+        system = VLC_TICK_0 + i * VLC_TICK_FROM_MS(10);
+        vlc_tick_t stream = VLC_TICK_0 + i * VLC_TICK_FROM_MS(10) * 10001 / 10000;
+
+        seed = seed * 1103515245 + 12345;
+        vlc_tick_t jitter = (seed >> 16) % VLC_TICK_FROM_MS(30);
+        if ((i / 100) % 7 == 3)
+            jitter += VLC_TICK_FROM_MS(150);
+
+        input_clock_Update(clock, false, false, false, stream, system + jitter);
+    }
+
+    /* The expected date follows the earliest arrivals, not the mean */
+    fprintf(stderr, "system_expected=%" PRId64 " system=%" PRId64 "\n",
+            system_expected, system);
+    assert(llabs(system_expected - system) < VLC_TICK_FROM_MS(5));
+
+    double skew;
+    vlc_tick_t jitter;
+    assert(input_clock_GetDrift(clock, &skew, &jitter) == VLC_SUCCESS);
+    fprintf(stderr, "skew=%f ppm jitter=%" PRId64 "\n", skew, jitter);
+    assert(skew > -1000. && skew < 1000.);
+    assert(jitter > 0 && jitter < VLC_TICK_FROM_MS(30));
+
+    input_clock_Delete(clock);
+}
+
 static void clock_update_abort(
     vlc_tick_t system_ts, vlc_tick_t ts, double rate,
     unsigned frame_rate, unsigned frame_rate_base, void *data)
@@ -147,5 +204,7 @@ int main(void)
 {
     fprintf(stderr, "test_clock_update:\n");
     test_clock_update();
+    fprintf(stderr, "test_clock_drift:\n");
+    test_clock_drift();
     return 0;
 }
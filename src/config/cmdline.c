@@ -173,16 +173,47 @@ int config_LoadCmdLine( libvlc_int_t *p_this, int i_argc,
     const module_config_t *pp_shortopts[256] = { NULL };
     char *psz_shortopts;
 
+    /*
+     * Look for options before generating the tables out of all the options
+     * of all the plugins. Front-ends usually pass a few, or none at all.
+     */
+    bool b_options = false, b_negated = false;
+    for( int i = 1; i < i_argc; i++ )
+    {
+        const char *arg = ppsz_argv[i];
+
+        if( arg[0] != '-' || arg[1] == '\0' )
+            continue; /* not an option */
+        b_options = true;
+        if( strcmp( arg, "--" ) == 0 )
+            break; /* early terminator */
+        /* --nofoo and --no-foo, or an abbreviation thereof */
+        if( strncmp( arg, "--n", 3 ) == 0 )
+            b_negated = true;
+    }
+
+    if( !b_options )
+    {
+        /* where getopt would have stopped */
+        if( pindex != NULL )
+            *pindex = 1;
+        return 0;
+    }
+
     /*
      * Generate the longopts and shortopts structures used by getopt_long
      */
 
     i_opts = 0;
     for (const vlc_plugin_t *p = vlc_plugins; p != NULL; p = p->next)
+    {
         /* count the number of exported configuration options (to allocate
          * longopts). We also need to allocate space for two options when
          * dealing with boolean to allow for --foo and --no-foo */
-        i_opts += p->conf.count + 2 * p->conf.booleans;
+        i_opts += p->conf.count;
+        if( b_negated )
+            i_opts += 2 * p->conf.booleans;
+    }
 
     p_longopts = vlc_alloc( i_opts + 1, sizeof(*p_longopts)  );
     if( p_longopts == NULL )
@@ -213,9 +244,9 @@ int config_LoadCmdLine( libvlc_int_t *p_this, int i_argc,
             if( !CONFIG_ITEM(p_item->i_type) )
                 continue;
 
-            /* Add item to long options */
-            p_longopts[i_index].name = strdup( p_item->psz_name );
-            if( p_longopts[i_index].name == NULL ) continue;
+            /* Add item to long options, the names of the plugins outlive
+             * the table */
+            p_longopts[i_index].name = p_item->psz_name;
             p_longopts[i_index].flag = &flag;
             p_longopts[i_index].val = 0;
             p_longopts[i_index].is_obsolete = param->obsolete;
@@ -223,6 +254,9 @@ int config_LoadCmdLine( libvlc_int_t *p_this, int i_argc,
             if( CONFIG_CLASS(p_item->i_type) != CONFIG_ITEM_BOOL )
                 p_longopts[i_index].has_arg = true;
             else
+            if( !b_negated )
+                p_longopts[i_index].has_arg = false;
+            else
             /* Booleans also need --no-foo and --nofoo options */
             {
                 char *psz_name;
@@ -413,7 +447,7 @@ int config_LoadCmdLine( libvlc_int_t *p_this, int i_argc,
                 float jw_filter = 0.8f, best_metric = jw_filter, metric;
                 const char *best = NULL;
                 const char *jw_a = ppsz_argv[state.ind-1] + 2;
-                for (size_t i = 0; i < (size_t)i_opts; i++) {
+                for (size_t i = 0; p_longopts[i].name != NULL; i++) {
                     if (p_longopts[i].is_obsolete)
                         continue;
                     const char *jw_b = p_longopts[i].name;
@@ -441,7 +475,8 @@ int config_LoadCmdLine( libvlc_int_t *p_this, int i_argc,
 out:
     /* Free allocated resources */
     for( i_index = 0; p_longopts[i_index].name; i_index++ )
-        free( (char *)p_longopts[i_index].name );
+        if( p_longopts[i_index].val ) /* --nofoo and --no-foo */
+            free( (char *)p_longopts[i_index].name );
     free( p_longopts );
     free( psz_shortopts );
     return ret;
@@ -383,28 +383,27 @@ error:
     return -1;
 }
 
-static int confcmp (const void *a, const void *b)
+static struct
 {
-    const struct vlc_param *const *ca = a, *const *cb = b;
-
-    return strcmp ((*ca)->item.psz_name, (*cb)->item.psz_name);
-}
+    struct vlc_param **table;
+    size_t mask; /**< number of buckets minus one, a power of 2 minus one */
+} config = { NULL, 0 };
 
-static int confnamecmp (const void *key, const void *elem)
+static size_t confhash(const char *name)
 {
-    const struct vlc_param *const *conf = elem;
+    /* FNV-1a, the names are short and mostly lower case ASCII */
+    size_t h = 2166136261u;
 
-    return strcmp (key, (*conf)->item.psz_name);
+    for (const unsigned char *p = (const unsigned char *)name; *p; p++)
+        h = (h ^ *p) * 16777619u;
+    return h;
 }
 
-static struct
-{
-    struct vlc_param **list;
-    size_t count;
-} config = { NULL, 0 };
-
 /**
  * Index the configuration items by name for faster lookups.
+ *
+ * The items are hashed into an open-addressed table. The names are those of
+ * the plugins (possibly the mapped plugins cache) and are not copied.
  */
 int config_SortConfig (void)
 {
@@ -414,11 +413,15 @@ int config_SortConfig (void)
     for (p = vlc_plugins; p != NULL; p = p->next)
         nconf += p->conf.count;
 
-    struct vlc_param **clist = vlc_alloc(nconf, sizeof (*clist));
-    if (unlikely(clist == NULL))
+    /* Keep the load factor under one half */
+    size_t buckets = 64;
+    while (buckets < 2 * nconf)
+        buckets *= 2;
+
+    struct vlc_param **table = calloc(buckets, sizeof (*table));
+    if (unlikely(table == NULL))
         return VLC_ENOMEM;
 
-    size_t index = 0;
     for (p = vlc_plugins; p != NULL; p = p->next)
     {
         for (size_t i = 0; i < p->conf.size; i++)
@@ -428,36 +431,48 @@ int config_SortConfig (void)
 
             if (!CONFIG_ITEM(item->i_type))
                 continue; /* ignore hints */
-            assert(index < nconf);
-            clist[index++] = param;
+
+            size_t h = confhash(item->psz_name) & (buckets - 1);
+            while (table[h] != NULL)
+            {
+                /* the first definition wins */
+                if (strcmp(table[h]->item.psz_name, item->psz_name) == 0)
+                    break;
+                h = (h + 1) & (buckets - 1);
+            }
+            if (table[h] == NULL)
+                table[h] = param;
         }
     }
 
-    qsort (clist, nconf, sizeof (*clist), confcmp);
-
-    config.list = clist;
-    config.count = nconf;
+    config.table = table;
+    config.mask = buckets - 1;
     return VLC_SUCCESS;
 }
 
 void config_UnsortConfig (void)
 {
-    struct vlc_param **clist;
+    struct vlc_param **table;
 
-    clist = config.list;
-    config.list = NULL;
-    config.count = 0;
+    table = config.table;
+    config.table = NULL;
+    config.mask = 0;
 
-    free (clist);
+    free (table);
 }
 
 struct vlc_param *vlc_param_Find(const char *name)
 {
-    struct vlc_param *const *p;
-
     assert(name != NULL);
-    p = bsearch (name, config.list, config.count, sizeof (*p), confnamecmp);
-    return (p != NULL) ? *p : NULL;
+
+    if (config.table == NULL)
+        return NULL;
+
+    for (size_t h = confhash(name) & config.mask; config.table[h] != NULL;
+         h = (h + 1) & config.mask)
+        if (strcmp(config.table[h]->item.psz_name, name) == 0)
+            return config.table[h];
+    return NULL;
 }
 
 module_config_t *config_FindConfig(const char *name)
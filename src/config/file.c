@@ -227,7 +227,7 @@ int config_LoadConfigFile( libvlc_int_t *p_this )
                     msg_Warn (p_this, "Integer value (%s) for %s: %s",
                               psz_option_value, psz_option_name,
                               vlc_strerror_c(errno));
-                else
+                else if (l != item->value.i) /* skip unchanged values */
                 {
                     atomic_store_explicit(&param->value.i, l,
                                           memory_order_relaxed);
@@ -242,6 +242,8 @@ int config_LoadConfigFile( libvlc_int_t *p_this )
                     break;                    /* ignore empty option */
 
                 float f = (float)atof(psz_option_value);
+                if (f == item->value.f)
+                    break;
                 atomic_store_explicit(&param->value.f, f,
                                       memory_order_relaxed);
                 item->value.f = f;
@@ -249,8 +251,16 @@ int config_LoadConfigFile( libvlc_int_t *p_this )
             }
 
             default:
+            {
+                /* an empty value stands for NULL, see vlc_param_SetString() */
+                const char *cur = item->value.psz;
+
+                if (cur == NULL ? psz_option_value[0] == '\0'
+                                : strcmp(cur, psz_option_value) == 0)
+                    break;
                 vlc_param_SetString(param, psz_option_value);
                 break;
+            }
         }
     }
     config_Unlock();
@@ -206,6 +206,23 @@ int access_vaDirectoryControlHelper( stream_t *p_access, int i_query, va_list ar
      return VLC_SUCCESS;
 }
 
+static void AStreamAccount(stream_t *s, size_t size)
+{
+    struct vlc_access_stream_private *priv = vlc_stream_Private(s);
+    struct input_stats *stats =
+        priv->input ? input_priv(priv->input)->stats : NULL;
+    if (stats == NULL)
+        return;
+
+    input_rate_Add(&stats->input_bitrate, size);
+
+    /* Datagram accesses report the packets the kernel discarded */
+    uint64_t dropped;
+    if (vlc_stream_GetDroppedPackets(s->p_sys, &dropped) == VLC_SUCCESS)
+        atomic_store_explicit(&stats->input_dropped, dropped,
+                              memory_order_relaxed);
+}
+
 /* Block access */
 static block_t *AStreamReadBlock(stream_t *s, bool *restrict eof)
 {
@@ -223,13 +240,7 @@ static block_t *AStreamReadBlock(stream_t *s, bool *restrict eof)
     block = vlc_stream_ReadBlock(access);
 
     if (block != NULL)
-    {
-        struct vlc_access_stream_private *priv = vlc_stream_Private(s);
-        struct input_stats *stats =
-            priv->input ? input_priv(priv->input)->stats : NULL;
-        if (stats != NULL)
-            input_rate_Add(&stats->input_bitrate, block->i_buffer);
-    }
+        AStreamAccount(s, block->i_buffer);
 
     return block;
 }
@@ -247,13 +258,7 @@ static ssize_t AStreamReadStream(stream_t *s, void *buf, size_t len)
     ssize_t val = vlc_stream_ReadPartial(access, buf, len);
 
     if (val > 0)
-    {
-        struct vlc_access_stream_private *priv = vlc_stream_Private(s);
-        struct input_stats *stats =
-            priv->input ? input_priv(priv->input)->stats : NULL;
-        if (stats != NULL)
-            input_rate_Add(&stats->input_bitrate, val);
-    }
+        AStreamAccount(s, val);
 
     return val;
 }
@@ -56,6 +56,7 @@
 #include "../libvlc.h"
 
 #include "../video_output/vout_internal.h"
+#include "../video_output/statistic.h"
 
 
 /**
@@ -114,6 +115,13 @@ enum reload
     RELOAD_DECODER_AOUT /* Stop the aout and reload the decoder module */
 };
 
+struct decoder_queue_entry
+{
+    vlc_tick_t date; /* enqueue date */
+    vlc_tick_t ts;   /* frame timestamp, DTS or PTS */
+    size_t size;
+};
+
 struct vlc_input_decoder_t
 {
     decoder_t        dec;
@@ -127,6 +135,14 @@ struct vlc_input_decoder_t
     const struct vlc_input_decoder_callbacks *cbs;
     void *cbs_userdata;
 
+    /* Per-module accounting, NULL when disabled */
+    struct input_stats *stats;
+    struct input_stats_module *dec_stats;
+    struct input_stats_module *pktz_stats;
+    struct input_stats_module *sout_stats;
+    struct input_stats_module *filters_stats;
+    struct input_stats_module *display_stats;
+
     ssize_t          i_spu_channel;
     int64_t          i_spu_order;
 
@@ -152,6 +168,21 @@ struct vlc_input_decoder_t
     /* fifo */
     block_fifo_t *p_fifo;
 
+    /* Accounting of the frames queued in the fifo, guarded by the fifo lock */
+    struct
+    {
+        struct decoder_queue_entry *entries; /* circular, in fifo order */
+        size_t size;
+        size_t head;
+        size_t count;
+        size_t bytes;
+
+        /* Backpressure policy */
+        size_t max_bytes;
+        vlc_tick_t max_duration;
+        bool throttle;
+    } queue;
+
     /* Lock for communication with decoder thread */
     vlc_cond_t  wait_request;
     vlc_cond_t  wait_acknowledge;
@@ -196,6 +227,11 @@ struct vlc_input_decoder_t
 #define PREROLL_NONE   VLC_TICK_MIN
 #define PREROLL_FORCED VLC_TICK_MAX
 
+    /* Date of the last flush request (fifo lock), then the one being waited
+     * for by the decoder thread until it queues a picture */
+    vlc_tick_t flush_date;
+    vlc_tick_t seek_date;
+
     /* Pause & Rate */
     vlc_tick_t pause_date;
     vlc_tick_t delay, output_delay;
@@ -211,6 +247,14 @@ struct vlc_input_decoder_t
     bool b_has_data;
     bool out_started;
 
+    /* Loudness measurement (INPUT_TYPE_LOUDNESS) */
+    struct
+    {
+        bool enabled;
+        struct vlc_audio_meter meter;
+        struct vlc_audio_meter_plugin_owner owner;
+    } loudness;
+
     /* Flushing */
     bool flushing;
     bool b_draining;
@@ -266,6 +310,103 @@ static inline vlc_input_decoder_t *dec_get_owner( decoder_t *p_dec )
     return container_of( p_dec, vlc_input_decoder_t, dec );
 }
 
+static bool DecoderQueuePush(vlc_input_decoder_t *p_owner,
+                             const vlc_frame_t *frame, vlc_tick_t now)
+{
+    vlc_fifo_Assert(p_owner->p_fifo);
+
+    if (p_owner->queue.count == p_owner->queue.size)
+    {
+        size_t size = p_owner->queue.size ? p_owner->queue.size * 2 : 16;
+        struct decoder_queue_entry *entries =
+            vlc_alloc(size, sizeof (*entries));
+        if (unlikely(entries == NULL))
+            return false;
+
+        /* Unwrap the entries at the start of the new array */
+        for (size_t i = 0; i < p_owner->queue.count; i++)
+            entries[i] = p_owner->queue.entries[(p_owner->queue.head + i)
+                                                % p_owner->queue.size];
+        free(p_owner->queue.entries);
+        p_owner->queue.entries = entries;
+        p_owner->queue.size = size;
+        p_owner->queue.head = 0;
+    }
+
+    struct decoder_queue_entry *entry =
+        &p_owner->queue.entries[(p_owner->queue.head + p_owner->queue.count)
+                                % p_owner->queue.size];
+    entry->date = now;
+    entry->ts = frame->i_dts != VLC_TICK_INVALID ? frame->i_dts : frame->i_pts;
+    entry->size = frame->i_buffer;
+    p_owner->queue.count++;
+    p_owner->queue.bytes += frame->i_buffer;
+    return true;
+}
+
+static void DecoderQueuePop(vlc_input_decoder_t *p_owner)
+{
+    vlc_fifo_Assert(p_owner->p_fifo);
+
+    /* Frames queued behind our back (closed captions) are not accounted */
+    if (p_owner->queue.count == 0)
+        return;
+
+    const struct decoder_queue_entry *entry =
+        &p_owner->queue.entries[p_owner->queue.head];
+    vlc_tick_t latency = vlc_tick_now() - entry->date;
+    size_t size = entry->size;
+
+    p_owner->queue.head = (p_owner->queue.head + 1) % p_owner->queue.size;
+    p_owner->queue.count--;
+    p_owner->queue.bytes -= size;
+
+    struct vlc_tracer *tracer = vlc_object_get_tracer(&p_owner->dec.obj);
+    if (tracer != NULL)
+        vlc_tracer_Trace(tracer, VLC_TRACE("id", p_owner->psz_id),
+                         VLC_TRACE_TICK_NS("queue_latency", latency),
+                         VLC_TRACE_END);
+
+    decoder_Notify(p_owner, on_new_queue_stats, -1, -(ssize_t)size, latency,
+                   0);
+}
+
+/* Forget every accounted frame, once the fifo was emptied */
+static void DecoderQueueReset(vlc_input_decoder_t *p_owner, bool dropped)
+{
+    vlc_fifo_Assert(p_owner->p_fifo);
+
+    if (p_owner->queue.count == 0)
+        return;
+
+    ssize_t count = p_owner->queue.count;
+    ssize_t bytes = p_owner->queue.bytes;
+
+    p_owner->queue.head = 0;
+    p_owner->queue.count = 0;
+    p_owner->queue.bytes = 0;
+
+    decoder_Notify(p_owner, on_new_queue_stats, -count, -bytes,
+                   VLC_TICK_INVALID, dropped ? count : 0);
+}
+
+static bool DecoderQueueIsFull(const vlc_input_decoder_t *p_owner)
+{
+    if (p_owner->queue.bytes > p_owner->queue.max_bytes)
+        return true;
+
+    if (p_owner->queue.max_duration == 0 || p_owner->queue.count < 2)
+        return false;
+
+    const struct decoder_queue_entry *first =
+        &p_owner->queue.entries[p_owner->queue.head];
+    const struct decoder_queue_entry *last =
+        &p_owner->queue.entries[(p_owner->queue.head + p_owner->queue.count - 1)
+                                % p_owner->queue.size];
+    return first->ts != VLC_TICK_INVALID && last->ts != VLC_TICK_INVALID
+        && last->ts - first->ts > p_owner->queue.max_duration;
+}
+
 /**
  * When the input decoder is being used only for packetizing (happen in stream output
  * configuration.), there's no need to spawn a decoder thread. The input_decoder is then considered
@@ -410,6 +551,16 @@ static int LoadDecoder(decoder_t *p_dec, bool b_packetizer, es_format_t *fmt_in)
     return 0;
 }
 
+static struct input_stats_module *
+DecoderGetModuleStats( vlc_input_decoder_t *p_owner, const char *kind,
+                       const decoder_t *p_dec )
+{
+    if( p_owner->stats == NULL || p_dec->p_module == NULL )
+        return NULL;
+    return input_stats_GetModule( p_owner->stats, kind,
+                                  module_get_object( p_dec->p_module ) );
+}
+
 static int DecoderThread_Reload( vlc_input_decoder_t *p_owner,
                                  const es_format_t *restrict p_fmt,
                                  enum reload reload )
@@ -451,10 +602,12 @@ static int DecoderThread_Reload( vlc_input_decoder_t *p_owner,
     if (LoadDecoder(p_dec, false, &p_owner->dec_fmt_in))
     {
         vlc_fifo_Lock(p_owner->p_fifo);
+        p_owner->dec_stats = NULL;
         p_owner->error = true;
         es_format_Clean( &fmt_in );
         return VLC_EGENERIC;
     }
+    p_owner->dec_stats = DecoderGetModuleStats( p_owner, "decoder", p_dec );
     vlc_fifo_Lock(p_owner->p_fifo);
     es_format_Clean( &fmt_in );
     return VLC_SUCCESS;
@@ -853,7 +1006,10 @@ static picture_t *ModuleThread_NewVideoBuffer( decoder_t *p_dec )
 
     picture_t *pic = picture_pool_Wait( p_owner->out_pool );
     if (pic)
+    {
         picture_Reset( pic );
+        input_stats_ModuleAdd( p_owner->dec_stats, 0, 0, 1 );
+    }
     return pic;
 }
 
@@ -979,11 +1135,8 @@ static vlc_tick_t ModuleThread_GetDisplayDate( decoder_t *p_dec,
     if( !p_owner->p_clock || i_ts == VLC_TICK_INVALID )
         return i_ts;
 
-    vlc_clock_Lock( p_owner->p_clock );
-    vlc_tick_t conv_ts =
-        vlc_clock_ConvertToSystem( p_owner->p_clock, system_now, i_ts, rate, NULL );
-    vlc_clock_Unlock( p_owner->p_clock );
-    return conv_ts;
+    return vlc_clock_ConvertToSystemUnlocked( p_owner->p_clock, system_now,
+                                              i_ts, rate, NULL );
 }
 
 static float ModuleThread_GetDisplayRate( decoder_t *p_dec )
@@ -1129,6 +1282,17 @@ static void DecoderSendSubstream(vlc_input_decoder_t *p_owner)
     }
 }
 
+static vlc_frame_t *DecoderThread_Packetize( decoder_t *p_packetizer,
+                                             struct input_stats_module *stats,
+                                             vlc_frame_t **ppframe )
+{
+    vlc_tick_t start = input_stats_ModuleStart( stats );
+    vlc_frame_t *frame = p_packetizer->pf_packetize( p_packetizer, ppframe );
+
+    input_stats_ModuleStop( stats, start );
+    return frame;
+}
+
 /* This function process a frame for sout
  */
 static void DecoderThread_ProcessSout( vlc_input_decoder_t *p_owner, vlc_frame_t *frame )
@@ -1138,7 +1302,7 @@ static void DecoderThread_ProcessSout( vlc_input_decoder_t *p_owner, vlc_frame_t
     vlc_frame_t **ppframe = frame ? &frame : NULL;
 
     while( ( sout_frame =
-                 p_dec->pf_packetize( p_dec, ppframe ) ) )
+                 DecoderThread_Packetize( p_dec, p_owner->dec_stats, ppframe ) ) )
     {
         if( p_owner->p_sout_input == NULL )
         {
@@ -1181,8 +1345,11 @@ static void DecoderThread_ProcessSout( vlc_input_decoder_t *p_owner, vlc_frame_t
             DecoderSendSubstream( p_owner );
 
             /* FIXME --VLC_TICK_INVALID inspect stream_output*/
-            if ( sout_InputSendBuffer( p_owner->p_sout, p_owner->p_sout_input, sout_frame ) ==
-                 VLC_EGENERIC )
+            vlc_tick_t start = input_stats_ModuleStart( p_owner->sout_stats );
+            int ret = sout_InputSendBuffer( p_owner->p_sout,
+                                            p_owner->p_sout_input, sout_frame );
+            input_stats_ModuleStop( p_owner->sout_stats, start );
+            if ( ret == VLC_EGENERIC )
             {
                 msg_Err( p_dec, "cannot continue streaming due to errors with codec %4.4s",
                                 (char *)&p_owner->fmt.i_codec );
@@ -1394,6 +1561,18 @@ static int ModuleThread_PlayVideo( vlc_input_decoder_t *p_owner, picture_t *p_pi
     }
     vout_PutPicture( p_vout, p_picture );
 
+    if( unlikely(p_owner->seek_date != VLC_TICK_INVALID) )
+    {
+        vlc_tick_t latency = vlc_tick_now() - p_owner->seek_date;
+
+        msg_Dbg( p_dec, "first picture after flush in %"PRId64" ms",
+                 MS_FROM_VLC_TICK(latency) );
+        if( p_owner->stats != NULL )
+            atomic_store_explicit( &p_owner->stats->seek_latency, latency,
+                                   memory_order_relaxed );
+        p_owner->seek_date = VLC_TICK_INVALID;
+    }
+
     return VLC_SUCCESS;
 }
 
@@ -1416,16 +1595,31 @@ static void ModuleThread_QueueVideo( decoder_t *p_dec, picture_t *p_pic )
     unsigned displayed = 0;
     unsigned vout_lost = 0;
     unsigned vout_late = 0;
+    vlc_tick_t render_time = 0;
+    struct vout_statistic_latency latency = { 0 };
     if( p_owner->p_vout != NULL )
     {
-        vout_GetResetStatistic( p_owner->p_vout, &displayed, &vout_lost, &vout_late );
+        vout_GetResetStatistic( p_owner->p_vout, &displayed, &vout_lost,
+                                &vout_late, &render_time, &latency );
     }
     if (success != VLC_SUCCESS)
         vout_lost++;
 
     vlc_fifo_Unlock(p_owner->p_fifo);
 
-    decoder_Notify(p_owner, on_new_video_stats, 1, vout_lost, displayed, vout_late);
+    if( p_owner->filters_stats != NULL && p_owner->p_vout != NULL )
+    {
+        vlc_tick_t filter_time, display_time;
+
+        vout_GetResetCpuTime( p_owner->p_vout, &filter_time, &display_time );
+        input_stats_ModuleAdd( p_owner->filters_stats, filter_time,
+                               displayed, 0 );
+        input_stats_ModuleAdd( p_owner->display_stats, display_time,
+                               displayed, 0 );
+    }
+
+    decoder_Notify(p_owner, on_new_video_stats, 1, vout_lost, displayed,
+                   vout_late, render_time, &latency);
 }
 
 static vlc_decoder_device * thumbnailer_get_device( decoder_t *p_dec )
@@ -1468,6 +1662,60 @@ static void ModuleThread_QueueThumbnail( decoder_t *p_dec, picture_t *p_pic )
 
 }
 
+static void loudness_on_measure( vlc_tick_t date,
+                                 const struct vlc_audio_loudness *loudness,
+                                 void *data )
+{
+    vlc_input_decoder_t *p_owner = data;
+    VLC_UNUSED(date);
+
+    decoder_Notify(p_owner, on_loudness, loudness);
+}
+
+static int loudness_UpdateAudioFormat( decoder_t *p_dec )
+{
+    vlc_input_decoder_t *p_owner = dec_get_owner( p_dec );
+
+    p_dec->fmt_out.audio.i_format = p_dec->fmt_out.i_codec;
+    if( AOUT_FMTS_IDENTICAL(&p_dec->fmt_out.audio, &p_owner->fmt.audio) )
+        return 0;
+
+    /* Report what was measured with the previous format, the meter state
+     * does not survive a reload */
+    vlc_audio_meter_Flush( &p_owner->loudness.meter );
+
+    vlc_fifo_Lock(p_owner->p_fifo);
+    DecoderUpdateFormatLocked( p_owner );
+    aout_FormatPrepare( &p_owner->fmt.audio );
+    p_dec->fmt_out.audio.i_bytes_per_frame =
+        p_owner->fmt.audio.i_bytes_per_frame;
+    p_dec->fmt_out.audio.i_frame_length =
+        p_owner->fmt.audio.i_frame_length;
+    vlc_fifo_Unlock(p_owner->p_fifo);
+
+    if( vlc_audio_meter_Reset( &p_owner->loudness.meter,
+                               &p_owner->fmt.audio ) != VLC_SUCCESS )
+    {
+        msg_Err( p_dec, "cannot measure the loudness of `%4.4s' samples",
+                 (const char *)&p_owner->fmt.audio.i_format );
+        return -1;
+    }
+    return 0;
+}
+
+static void loudness_QueueAudio( decoder_t *p_dec, vlc_frame_t *p_audio )
+{
+    vlc_input_decoder_t *p_owner = dec_get_owner( p_dec );
+
+    /* No output: measure the samples as soon as they are decoded */
+    if( p_audio->i_pts != VLC_TICK_INVALID )
+        vlc_audio_meter_Process( &p_owner->loudness.meter, p_audio,
+                                 p_audio->i_pts );
+    block_Release( p_audio );
+
+    decoder_Notify(p_owner, on_new_audio_stats, 1, 0, 0);
+}
+
 static int ModuleThread_PlayAudio( vlc_input_decoder_t *p_owner, vlc_frame_t *p_audio )
 {
     decoder_t *p_dec = &p_owner->dec;
@@ -1561,6 +1809,7 @@ static void ModuleThread_QueueAudio( decoder_t *p_dec, vlc_frame_t *p_aout_buf )
 
     vlc_fifo_Unlock(p_owner->p_fifo);
 
+    input_stats_ModuleAdd( p_owner->dec_stats, 0, 0, 1 );
     decoder_Notify(p_owner, on_new_audio_stats, 1, aout_lost, played);
 }
 
@@ -1623,13 +1872,26 @@ static void DecoderThread_DecodeBlock( vlc_input_decoder_t *p_owner, vlc_frame_t
 
     vlc_fifo_Unlock(p_owner->p_fifo);
 
+    vlc_tick_t start = VLC_TICK_INVALID;
     if ( tracer != NULL && frame != NULL )
     {
         vlc_tracer_TraceStreamDTS( tracer, "DEC", p_owner->psz_id, "IN",
                             frame->i_pts, frame->i_dts );
+        start = vlc_tick_now();
     }
 
+    vlc_tick_t cpu_start = input_stats_ModuleStart( p_owner->dec_stats );
     int ret = p_dec->pf_decode( p_dec, frame );
+    input_stats_ModuleStop( p_owner->dec_stats, cpu_start );
+
+    if ( start != VLC_TICK_INVALID )
+        vlc_tracer_TraceWithTs( tracer, start,
+                                VLC_TRACE("type", "DEC"),
+                                VLC_TRACE("id", p_owner->psz_id),
+                                VLC_TRACE("event", "decode"),
+                                VLC_TRACE_TICK_NS("duration",
+                                                  vlc_tick_now() - start),
+                                VLC_TRACE_END );
 
     vlc_fifo_Lock(p_owner->p_fifo);
     switch( ret )
@@ -1711,7 +1973,8 @@ static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, vlc_frame_
         decoder_t *p_packetizer = p_owner->p_packetizer;
 
         while( (packetized_frame =
-                p_packetizer->pf_packetize( p_packetizer, ppframe ) ) )
+                DecoderThread_Packetize( p_packetizer, p_owner->pktz_stats,
+                                         ppframe ) ) )
         {
             if( !es_format_IsSimilar( p_dec->fmt_in, &p_packetizer->fmt_out ) )
             {
@@ -1820,6 +2083,7 @@ static void *DecoderThread( void *p_data )
             p_owner->flushing = false;
             p_owner->out_started = false;
             p_owner->i_preroll_end = PREROLL_NONE;
+            p_owner->seek_date = p_owner->flush_date;
             continue;
         }
 
@@ -1853,7 +2117,9 @@ static void *DecoderThread( void *p_data )
         vlc_cond_signal( &p_owner->wait_fifo );
 
         vlc_frame_t *frame = vlc_fifo_DequeueUnlocked( p_owner->p_fifo );
-        if( frame == NULL )
+        if( frame != NULL )
+            DecoderQueuePop( p_owner );
+        else
         {
             if( likely(!p_owner->b_draining) )
             {   /* Wait for a block to decode (or a request to drain) */
@@ -1874,6 +2140,14 @@ static void *DecoderThread( void *p_data )
 
         if( p_owner->b_draining && frame == NULL )
         {
+            if( p_owner->loudness.enabled )
+            {   /* Send the final measurement before the decoder is seen as
+                 * empty and the input reports its end */
+                vlc_fifo_Unlock( p_owner->p_fifo );
+                vlc_audio_meter_Flush( &p_owner->loudness.meter );
+                vlc_fifo_Lock( p_owner->p_fifo );
+            }
+
             p_owner->b_draining = false;
 
             if( p_owner->dec.fmt_in->i_cat == AUDIO_ES && p_owner->p_astream != NULL )
@@ -1920,6 +2194,18 @@ static const struct decoder_owner_callbacks dec_audio_cbs =
     },
     .get_attachments = InputThread_GetInputAttachments,
 };
+static const struct decoder_owner_callbacks dec_loudness_cbs =
+{
+    .audio = {
+        .format_update = loudness_UpdateAudioFormat,
+        .queue = loudness_QueueAudio,
+    },
+    .get_attachments = InputThread_GetInputAttachments,
+};
+static const struct vlc_audio_meter_cbs loudness_meter_cbs =
+{
+    .on_loudness = loudness_on_measure,
+};
 static const struct decoder_owner_callbacks dec_spu_cbs =
 {
     .spu = {
@@ -1956,10 +2242,14 @@ CreateDecoder( vlc_object_t *p_parent, const struct vlc_input_decoder_cfg *cfg )
     p_owner->psz_id = cfg->str_id;
     p_owner->p_clock = cfg->clock;
     p_owner->i_preroll_end = PREROLL_NONE;
+    p_owner->flush_date = p_owner->seek_date = VLC_TICK_INVALID;
     p_owner->p_resource = cfg->resource;
     p_owner->hw_dec = cfg->hw_dec;
     p_owner->cbs = cfg->cbs;
     p_owner->cbs_userdata = cfg->cbs_data;
+    p_owner->stats = cfg->stats;
+    p_owner->dec_stats = p_owner->pktz_stats = p_owner->sout_stats = NULL;
+    p_owner->filters_stats = p_owner->display_stats = NULL;
     p_owner->p_aout = NULL;
     p_owner->p_astream = NULL;
     p_owner->p_vout = NULL;
@@ -1986,6 +2276,8 @@ CreateDecoder( vlc_object_t *p_parent, const struct vlc_input_decoder_cfg *cfg )
 
     p_owner->error = false;
 
+    p_owner->loudness.enabled = false;
+
     p_owner->flushing = false;
     p_owner->b_draining = false;
     atomic_init( &p_owner->reload, RELOAD_NO_REQUEST );
@@ -2004,6 +2296,17 @@ CreateDecoder( vlc_object_t *p_parent, const struct vlc_input_decoder_cfg *cfg )
         return NULL;
     }
 
+    p_owner->queue.entries = NULL;
+    p_owner->queue.size = 0;
+    p_owner->queue.head = 0;
+    p_owner->queue.count = 0;
+    p_owner->queue.bytes = 0;
+    p_owner->queue.max_bytes =
+        (size_t)var_InheritInteger( p_dec, "decoder-queue-size" ) << 20;
+    p_owner->queue.max_duration =
+        VLC_TICK_FROM_MS( var_InheritInteger( p_dec, "decoder-queue-duration" ) );
+    p_owner->queue.throttle = var_InheritBool( p_dec, "decoder-queue-throttle" );
+
     vlc_mutex_init( &p_owner->mouse_lock );
     vlc_cond_init( &p_owner->wait_request );
     vlc_cond_init( &p_owner->wait_acknowledge );
@@ -2026,6 +2329,9 @@ CreateDecoder( vlc_object_t *p_parent, const struct vlc_input_decoder_cfg *cfg )
             {
                 p_owner->p_packetizer->fmt_out.b_packetized = true;
                 fmt = &p_owner->p_packetizer->fmt_out;
+                p_owner->pktz_stats =
+                    DecoderGetModuleStats( p_owner, "packetizer",
+                                           p_owner->p_packetizer );
             }
         }
     }
@@ -2036,10 +2342,37 @@ CreateDecoder( vlc_object_t *p_parent, const struct vlc_input_decoder_cfg *cfg )
             if( cfg->input_type == INPUT_TYPE_THUMBNAILING )
                 p_dec->cbs = &dec_thumbnailer_cbs;
             else
+            {
                 p_dec->cbs = &dec_video_cbs;
+                if( cfg->sout == NULL )
+                {
+                    p_owner->filters_stats =
+                        input_stats_GetModule( cfg->stats, "vout", "filters" );
+                    p_owner->display_stats =
+                        input_stats_GetModule( cfg->stats, "vout", "display" );
+                }
+            }
             break;
         case AUDIO_ES:
-            p_dec->cbs = &dec_audio_cbs;
+            if( cfg->input_type == INPUT_TYPE_LOUDNESS )
+            {
+                p_owner->loudness.owner = (struct vlc_audio_meter_plugin_owner) {
+                    .cbs = &loudness_meter_cbs,
+                    .sys = p_owner,
+                };
+                vlc_audio_meter_Init( &p_owner->loudness.meter, p_dec );
+                p_owner->loudness.enabled = true;
+                if( vlc_audio_meter_AddPlugin( &p_owner->loudness.meter,
+                                               "ebur128{mode=4}",
+                                               &p_owner->loudness.owner ) == NULL )
+                {
+                    msg_Err( p_dec, "cannot add the loudness meter" );
+                    return p_owner;
+                }
+                p_dec->cbs = &dec_loudness_cbs;
+            }
+            else
+                p_dec->cbs = &dec_audio_cbs;
             break;
         case SPU_ES:
             p_dec->cbs = &dec_spu_cbs;
@@ -2051,9 +2384,21 @@ CreateDecoder( vlc_object_t *p_parent, const struct vlc_input_decoder_cfg *cfg )
 
     /* Find a suitable decoder/packetizer module */
     decoder_Init(p_dec, &p_owner->dec_fmt_in, fmt);
+    /* Stream output only needs the packets */
+    p_dec->b_packetize_only = cfg->sout != NULL;
     if (LoadDecoder(p_dec, cfg->sout != NULL, &p_owner->dec_fmt_in))
         return p_owner;
 
+    if( cfg->sout != NULL )
+    {
+        p_owner->dec_stats = DecoderGetModuleStats( p_owner, "packetizer",
+                                                    p_dec );
+        p_owner->sout_stats = input_stats_GetModule( cfg->stats, "sout",
+                                                     cfg->sout->psz_name );
+    }
+    else
+        p_owner->dec_stats = DecoderGetModuleStats( p_owner, "decoder", p_dec );
+
     assert( p_dec->fmt_in->i_cat == p_dec->fmt_out.i_cat && fmt->i_cat == p_dec->fmt_in->i_cat);
 
     /* Copy ourself the input replay gain */
@@ -2124,6 +2469,8 @@ static void DeleteDecoder( vlc_input_decoder_t *p_owner, enum es_format_category
                 vlc_aout_stream_Delete( p_owner->p_astream );
                 input_resource_PutAout( p_owner->p_resource, p_owner->p_aout );
             }
+            if( p_owner->loudness.enabled )
+                vlc_audio_meter_Destroy( &p_owner->loudness.meter );
             break;
         case VIDEO_ES: {
             vout_thread_t *vout = p_owner->p_vout;
@@ -2170,6 +2517,10 @@ static void DeleteDecoder( vlc_input_decoder_t *p_owner, enum es_format_category
     if( p_owner->p_description )
         vlc_meta_Delete( p_owner->p_description );
 
+    vlc_fifo_Lock( p_owner->p_fifo );
+    DecoderQueueReset( p_owner, false );
+    vlc_fifo_Unlock( p_owner->p_fifo );
+    free( p_owner->queue.entries );
     block_FifoRelease( p_owner->p_fifo );
     decoder_Destroy( p_owner->p_packetizer );
     decoder_Destroy( &p_owner->dec );
@@ -2431,29 +2782,50 @@ void vlc_input_decoder_DecodeWithStatus(vlc_input_decoder_t *p_owner, vlc_frame_
     }
 
     vlc_fifo_Lock( p_owner->p_fifo );
-    if( !b_do_pace )
-    {
-        /* FIXME: ideally we would check the time amount of data
-         * in the FIFO instead of its size. */
-        /* 400 MiB, i.e. ~ 50mb/s for 60s */
-        if( vlc_fifo_GetBytes( p_owner->p_fifo ) > 400*1024*1024 )
-        {
-            msg_Warn( &p_owner->dec, "decoder/packetizer fifo full (data not "
-                      "consumed quickly enough), resetting fifo!" );
-            block_ChainRelease( vlc_fifo_DequeueAllUnlocked( p_owner->p_fifo ) );
-            frame->i_flags |= BLOCK_FLAG_DISCONTINUITY;
-        }
-    }
-    else
     if( !p_owner->b_waiting )
     {   /* The FIFO is not consumed when waiting, so pacing would deadlock VLC.
          * Locking is not necessary as b_waiting is only read, not written by
-         * the decoder thread. */
-        while( vlc_fifo_GetCount( p_owner->p_fifo ) >= 10 )
+         * the decoder thread. Likewise, do not throttle a paused decoder. */
+        while( ( b_do_pace && vlc_fifo_GetCount( p_owner->p_fifo ) >= 10 )
+            || ( p_owner->queue.throttle && !p_owner->paused
+              && DecoderQueueIsFull( p_owner ) ) )
             vlc_fifo_WaitCond( p_owner->p_fifo, &p_owner->wait_fifo );
     }
 
-    vlc_fifo_QueueUnlocked( p_owner->p_fifo, frame );
+    if( !b_do_pace && DecoderQueueIsFull( p_owner ) )
+    {
+        msg_Warn( &p_owner->dec, "decoder/packetizer fifo full (data not "
+                  "consumed quickly enough), resetting fifo!" );
+        block_ChainRelease( vlc_fifo_DequeueAllUnlocked( p_owner->p_fifo ) );
+        DecoderQueueReset( p_owner, true );
+        frame->i_flags |= BLOCK_FLAG_DISCONTINUITY;
+    }
+
+    const vlc_tick_t now = vlc_tick_now();
+    size_t count = 0, bytes = 0;
+    for( vlc_frame_t **pp = &frame; *pp != NULL; )
+    {
+        vlc_frame_t *f = *pp;
+        if( unlikely(!DecoderQueuePush( p_owner, f, now )) )
+        {   /* Cannot account for it, drop it */
+            *pp = f->p_next;
+            block_Release( f );
+            decoder_Notify(p_owner, on_new_queue_stats, 0, 0,
+                           VLC_TICK_INVALID, 1);
+            continue;
+        }
+        count++;
+        bytes += f->i_buffer;
+        pp = &f->p_next;
+    }
+    if( count > 0 )
+    {
+        decoder_Notify(p_owner, on_new_queue_stats, count, bytes,
+                       VLC_TICK_INVALID, 0);
+    }
+
+    if( frame != NULL )
+        vlc_fifo_QueueUnlocked( p_owner->p_fifo, frame );
     if (status != NULL)
         GetStatusLocked(p_owner, status);
 
@@ -2529,6 +2901,7 @@ void vlc_input_decoder_Flush( vlc_input_decoder_t *p_owner )
 
     /* Empty the fifo */
     block_ChainRelease( vlc_fifo_DequeueAllUnlocked( p_owner->p_fifo ) );
+    DecoderQueueReset( p_owner, false );
 
     /* Don't need to wait for the DecoderThread to flush. Indeed, if called a
      * second time, this function will clear the FIFO again before anything was
@@ -2536,6 +2909,8 @@ void vlc_input_decoder_Flush( vlc_input_decoder_t *p_owner )
      * a row. */
     p_owner->flushing = true;
     p_owner->b_draining = false;
+    if( cat == VIDEO_ES )
+        p_owner->flush_date = vlc_tick_now();
 
     /* Flush video/spu decoder when paused: increment frames_countdown in order
      * to display one frame/subtitle */
@@ -29,6 +29,9 @@
 #include <vlc_mouse.h>
 
 struct vlc_clock_t;
+struct vout_statistic_latency;
+struct vlc_audio_loudness;
+struct input_stats;
 
 struct vlc_input_decoder_callbacks {
     /* notifications */
@@ -39,12 +42,24 @@ struct vlc_input_decoder_callbacks {
                             void *userdata);
     void (*on_thumbnail_ready)(vlc_input_decoder_t *decoder, picture_t *pic,
                                void *userdata);
+    /* loudness of the decoded audio, only for INPUT_TYPE_LOUDNESS inputs */
+    void (*on_loudness)(vlc_input_decoder_t *decoder,
+                        const struct vlc_audio_loudness *loudness,
+                        void *userdata);
 
     void (*on_new_video_stats)(vlc_input_decoder_t *decoder, unsigned decoded,
                                unsigned lost, unsigned displayed, unsigned late,
+                               vlc_tick_t render_time,
+                               const struct vout_statistic_latency *latency,
                                void *userdata);
     void (*on_new_audio_stats)(vlc_input_decoder_t *decoder, unsigned decoded,
                                unsigned lost, unsigned played, void *userdata);
+    /* count and bytes are the changes of the input queue size, latency is the
+     * time spent in the queue by a dequeued frame (or VLC_TICK_INVALID) and
+     * dropped the number of frames discarded from the queue */
+    void (*on_new_queue_stats)(vlc_input_decoder_t *decoder, ssize_t count,
+                               ssize_t bytes, vlc_tick_t latency,
+                               unsigned dropped, void *userdata);
 
     /* requests */
     int (*get_attachments)(vlc_input_decoder_t *decoder,
@@ -64,6 +79,7 @@ struct vlc_input_decoder_cfg
     unsigned cc_decoder;
     const struct vlc_input_decoder_callbacks *cbs;
     void *cbs_data;
+    struct input_stats *stats; /**< per-module accounting (or NULL) */
 };
 
 vlc_input_decoder_t *
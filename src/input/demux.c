@@ -70,6 +70,67 @@ static const char *demux_NameFromMimeType(const char *mime)
     return (type != NULL) ? type->name : "any";
 }
 
+/** Number of leading bytes read once for the signature checks */
+#define DEMUX_SNIFF_SIZE 4096
+
+typedef const struct
+{
+    unsigned char const offset;
+    unsigned char const length;
+    char const magic[6];
+    char const name[6];
+} demux_signature;
+
+/**
+ * Guesses the demux from well-known leading signatures.
+ *
+ * This is much cheaper than probing each demux module in turn, and as the
+ * leading bytes remain in the stream peek buffer, the subsequent probes do not
+ * need to read them again.
+ */
+static const char *demux_NameFromSignature(stream_t *s)
+{
+    static demux_signature signatures[] =
+    {
+        { 0, 4, "\x1A\x45\xDF\xA3", "mkv"  },
+        { 4, 4, "ftyp",                "mp4"  },
+        { 8, 4, "AVI ",                "avi"  },
+        { 8, 4, "WAVE",                "wav"  },
+        { 0, 4, "OggS",                "ogg"  },
+        { 0, 4, "fLaC",                "flac" },
+        { 0, 4, "\x00\x00\x01\xBA", "ps"   },
+    };
+    const uint8_t *peek;
+    ssize_t len = vlc_stream_Peek(s, &peek, DEMUX_SNIFF_SIZE);
+
+    if (len < 12)
+        return NULL;
+
+    for (size_t i = 0; i < ARRAY_SIZE(signatures); i++)
+    {
+        demux_signature *sig = &signatures[i];
+
+        if (!memcmp(peek + sig->offset, sig->magic, sig->length))
+        {
+            if (sig->offset == 8 && memcmp(peek, "RIFF", 4))
+                continue;
+            return sig->name;
+        }
+    }
+
+    /* MPEG-TS: sync bytes every 188 bytes (192 for M2TS) */
+    for (size_t hdr = 0; hdr <= 4; hdr += 4)
+    {
+        size_t size = 188 + hdr;
+
+        if ((size_t)len >= hdr + 2 * size + 1
+         && peek[hdr] == 0x47 && peek[hdr + size] == 0x47
+         && peek[hdr + 2 * size] == 0x47)
+            return "ts";
+    }
+    return NULL;
+}
+
 demux_t *demux_New( vlc_object_t *p_obj, const char *module, const char *url,
                     stream_t *s, es_out_t *out )
 {
@@ -98,6 +159,7 @@ static int demux_Probe(void *func, bool forced, va_list ap)
 {
     int (*probe)(vlc_object_t *) = func;
     demux_t *demux = va_arg(ap, demux_t *);
+    bool sniffed = va_arg(ap, int);
 
     /* Restore input stream offset (in case previous probed demux failed to
      * to do so). */
@@ -107,7 +169,8 @@ static int demux_Probe(void *func, bool forced, va_list ap)
         return VLC_EGENERIC;
     }
 
-    demux->obj.force = forced;
+    /* A signature match is only a hint: the module still checks the data. */
+    demux->obj.force = forced && !sniffed;
 
     int ret = probe(VLC_OBJECT(demux));
     if (ret)
@@ -193,10 +256,32 @@ demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_input,
         strict = false;
     }
 
-    priv->module = vlc_module_load(vlc_object_logger(p_demux), "demux", module,
-                                   strict, demux_Probe, p_demux);
+    vlc_tick_t start = vlc_tick_now();
+
+    priv->module = NULL;
+    if (!strict)
+    {
+        const char *sniffed = demux_NameFromSignature(s);
+
+        if (sniffed != NULL)
+        {
+            msg_Dbg(p_demux, "signature matches demux \"%s\"", sniffed);
+            priv->module = vlc_module_load(vlc_object_logger(p_demux),
+                                           "demux", sniffed, true,
+                                           demux_Probe, p_demux, true);
+        }
+    }
+
+    if (priv->module == NULL)
+        priv->module = vlc_module_load(vlc_object_logger(p_demux), "demux",
+                                       module, strict, demux_Probe, p_demux,
+                                       false);
     free(modbuf);
 
+    if (!b_preparsing)
+        msg_Dbg(p_demux, "demux probing took %"PRId64" us",
+                US_FROM_VLC_TICK(vlc_tick_now() - start));
+
     if (priv->module == NULL)
         goto error;
 
@@ -58,13 +58,16 @@
 #include "item.h"
 
 #include "../stream_output/stream_output.h"
+#include "../video_output/statistic.h"
 
 #include <vlc_iso_lang.h>
 
 /*****************************************************************************
  * Local prototypes
  *****************************************************************************/
-typedef struct
+#define ES_OUT_PROGRAM_BUCKETS 64
+
+typedef struct es_out_pgrm_t
 {
     /* Program context */
     input_source_t *source;
@@ -93,6 +96,7 @@ typedef struct
 
     vlc_meta_t *p_meta;
     struct vlc_list node;
+    struct es_out_pgrm_t *hash_next; /* in es_out_sys_t.program_hash */
 } es_out_pgrm_t;
 
 
@@ -189,6 +193,9 @@ typedef struct
 
     /* all programs */
     struct vlc_list programs;
+    /* the same programs, hashed by source and group, since they are looked
+     * up for every PCR, EPG and meta update of TS streams */
+    es_out_pgrm_t *program_hash[ES_OUT_PROGRAM_BUCKETS];
     es_out_pgrm_t *p_pgrm;  /* Master program */
 
     enum vlc_clock_master_source user_clock_source;
@@ -433,9 +440,33 @@ decoder_on_thumbnail_ready(vlc_input_decoder_t *decoder, picture_t *pic, void *u
     input_SendEvent(p_sys->p_input, &event);
 }
 
+static void
+decoder_on_loudness(vlc_input_decoder_t *decoder,
+                    const struct vlc_audio_loudness *loudness, void *userdata)
+{
+    (void) decoder;
+
+    es_out_id_t *id = userdata;
+    struct vlc_input_es_out *out = id->out;
+    es_out_sys_t *p_sys = PRIV(&out->out);
+
+    if (!p_sys->p_input)
+        return;
+
+    struct vlc_input_event event = {
+        .type = INPUT_EVENT_LOUDNESS,
+        .loudness = loudness,
+    };
+
+    input_SendEvent(p_sys->p_input, &event);
+}
+
 static void
 decoder_on_new_video_stats(vlc_input_decoder_t *decoder, unsigned decoded, unsigned lost,
-                           unsigned displayed, unsigned late, void *userdata)
+                           unsigned displayed, unsigned late,
+                           vlc_tick_t render_time,
+                           const struct vout_statistic_latency *latency,
+                           void *userdata)
 {
     (void) decoder;
 
@@ -458,6 +489,17 @@ decoder_on_new_video_stats(vlc_input_decoder_t *decoder, unsigned decoded, unsig
                               memory_order_relaxed);
     atomic_fetch_add_explicit(&stats->late_pictures, late,
                               memory_order_relaxed);
+    atomic_fetch_add_explicit(&stats->render_time, render_time,
+                              memory_order_relaxed);
+    for (size_t i = 0; i < INPUT_STATS_FRAME_LATENCY_BUCKETS; i++)
+    {
+        atomic_fetch_add_explicit(&stats->frame_queue[i], latency->queue[i],
+                                  memory_order_relaxed);
+        atomic_fetch_add_explicit(&stats->frame_render[i], latency->render[i],
+                                  memory_order_relaxed);
+        atomic_fetch_add_explicit(&stats->frame_present[i],
+                                  latency->present[i], memory_order_relaxed);
+    }
 }
 
 static void
@@ -485,6 +527,35 @@ decoder_on_new_audio_stats(vlc_input_decoder_t *decoder, unsigned decoded, unsig
                               memory_order_relaxed);
 }
 
+static void
+decoder_on_new_queue_stats(vlc_input_decoder_t *decoder, ssize_t count,
+                           ssize_t bytes, vlc_tick_t latency, unsigned dropped,
+                           void *userdata)
+{
+    (void) decoder;
+
+    es_out_id_t *id = userdata;
+    struct vlc_input_es_out *out = id->out;
+    es_out_sys_t *p_sys = PRIV(&out->out);
+
+    if (!p_sys->p_input)
+        return;
+
+    struct input_stats *stats = input_priv(p_sys->p_input)->stats;
+    if (!stats)
+        return;
+
+    /* Unsigned wrap-around takes care of the negative changes */
+    atomic_fetch_add_explicit(&stats->queued_blocks, (uintmax_t)count,
+                              memory_order_relaxed);
+    atomic_fetch_add_explicit(&stats->queued_bytes, (uintmax_t)bytes,
+                              memory_order_relaxed);
+    atomic_fetch_add_explicit(&stats->dropped_blocks, dropped,
+                              memory_order_relaxed);
+    if (latency != VLC_TICK_INVALID)
+        input_stats_AddQueueLatency(stats, latency);
+}
+
 static int
 decoder_get_attachments(vlc_input_decoder_t *decoder,
                         input_attachment_t ***ppp_attachment,
@@ -506,8 +577,10 @@ static const struct vlc_input_decoder_callbacks decoder_cbs = {
     .on_vout_started = decoder_on_vout_started,
     .on_vout_stopped = decoder_on_vout_stopped,
     .on_thumbnail_ready = decoder_on_thumbnail_ready,
+    .on_loudness = decoder_on_loudness,
     .on_new_video_stats = decoder_on_new_video_stats,
     .on_new_audio_stats = decoder_on_new_audio_stats,
+    .on_new_queue_stats = decoder_on_new_queue_stats,
     .get_attachments = decoder_get_attachments,
 };
 
@@ -626,6 +699,29 @@ static void EsHold(es_out_id_t *es)
     vlc_atomic_rc_inc(&es->rc);
 }
 
+static es_out_pgrm_t **EsOutProgramBucket(es_out_sys_t *p_sys,
+                                          const input_source_t *source,
+                                          int i_group)
+{
+    uintptr_t key = ((uintptr_t)source >> 4) ^ (unsigned)i_group;
+    size_t hash = (key * UINT64_C(0x9e3779b97f4a7c15)) >> 32;
+
+    return &p_sys->program_hash[hash % ES_OUT_PROGRAM_BUCKETS];
+}
+
+static void EsOutProgramUnhash(es_out_sys_t *p_sys, es_out_pgrm_t *p_pgrm)
+{
+    es_out_pgrm_t **pp = EsOutProgramBucket(p_sys, p_pgrm->source,
+                                            p_pgrm->i_id);
+
+    while (*pp != p_pgrm)
+    {
+        assert(*pp != NULL);
+        pp = &(*pp)->hash_next;
+    }
+    *pp = p_pgrm->hash_next;
+}
+
 static void EsOutDelete(es_out_t *out)
 {
     es_out_sys_t *p_sys = PRIV(out);
@@ -677,6 +773,7 @@ static void EsOutTerminate(es_out_sys_t *p_sys)
     vlc_list_foreach(p_pgrm, &p_sys->programs, node)
     {
         vlc_list_remove(&p_pgrm->node);
+        EsOutProgramUnhash(p_sys, p_pgrm);
         input_SendEventProgramDel( p_sys->p_input, p_pgrm->i_id );
         ProgramDelete(p_pgrm);
     }
@@ -869,6 +966,7 @@ static int EsOutSetRecord(es_out_sys_t *p_sys, bool b_record, const char *dir_pa
             .cc_decoder = p_sys->cc_decoder,
             .cbs = &decoder_cbs,
             .cbs_data = p_es,
+            .stats = input_priv(p_input)->stats,
         };
 
         p_es->p_dec_record = vlc_input_decoder_New(VLC_OBJECT(p_input), &cfg);
@@ -1579,6 +1677,8 @@ static es_out_pgrm_t *EsOutProgramAdd(es_out_sys_t *p_sys, input_source_t *sourc
     const vlc_tick_t pts_delay = p_sys->i_pts_delay + p_sys->i_pts_jitter
                                + p_sys->i_tracks_pts_delay;
     input_clock_SetJitter( p_pgrm->p_input_clock, pts_delay, p_sys->i_cr_average );
+    input_clock_SetJitterTolerance( p_pgrm->p_input_clock,
+                                    input_priv(p_input)->i_jitter_tolerance );
 
     vlc_clock_main_Lock(p_pgrm->clocks.main);
     vlc_clock_main_SetInputDejitter(p_pgrm->clocks.main, pts_delay );
@@ -1592,6 +1692,9 @@ static es_out_pgrm_t *EsOutProgramAdd(es_out_sys_t *p_sys, input_source_t *sourc
 
     /* Append it */
     vlc_list_append(&p_pgrm->node, &p_sys->programs);
+    es_out_pgrm_t **pp = EsOutProgramBucket(p_sys, source, i_group);
+    p_pgrm->hash_next = *pp;
+    *pp = p_pgrm;
 
     /* Update "program" variable */
     input_SendEventProgramAdd( p_input, i_group, NULL );
@@ -1609,9 +1712,8 @@ static es_out_pgrm_t *EsOutProgramAdd(es_out_sys_t *p_sys, input_source_t *sourc
 static es_out_pgrm_t *EsOutProgramSearch(es_out_sys_t *p_sys, input_source_t *source,
                                          int i_group)
 {
-    es_out_pgrm_t *pgrm;
-
-    vlc_list_foreach(pgrm, &p_sys->programs, node)
+    for (es_out_pgrm_t *pgrm = *EsOutProgramBucket(p_sys, source, i_group);
+         pgrm != NULL; pgrm = pgrm->hash_next)
         if (pgrm->i_id == i_group && pgrm->source == source)
             return pgrm;
 
@@ -1661,6 +1763,7 @@ static int EsOutProgramDel(es_out_sys_t *p_sys, input_source_t *source, int i_gr
     }
 
     vlc_list_remove(&p_pgrm->node);
+    EsOutProgramUnhash(p_sys, p_pgrm);
 
     /* If program is selected we need to unselect it */
     if( p_sys->p_pgrm == p_pgrm )
@@ -1883,10 +1986,15 @@ static void EsOutProgramEpg(es_out_sys_t *p_sys, input_source_t *source,
     epg = *p_epg;
     epg.psz_name = EsOutProgramGetProgramName( p_pgrm );
 
-    input_item_SetEpg( p_item, &epg, p_sys->p_pgrm && (p_epg->i_source_id == p_sys->p_pgrm->i_id) );
-    input_SendEventMetaEpg( p_sys->p_input );
-
+    bool b_changed = input_item_SetEpg( p_item, &epg,
+                                         p_sys->p_pgrm && (p_epg->i_source_id == p_sys->p_pgrm->i_id) );
     free( epg.psz_name );
+    if( !b_changed )
+    {
+        free( psz_cat );
+        return; /* nothing new to tell */
+    }
+    input_SendEventMetaEpg( p_sys->p_input );
 
     /* Update now playing */
     if( p_epg->b_present && p_pgrm->p_meta &&
@@ -2367,6 +2475,7 @@ static void EsOutCreateDecoder(es_out_sys_t *p_sys, es_out_id_t *p_es)
         .cc_decoder = p_sys->cc_decoder,
         .cbs = &decoder_cbs,
         .cbs_data = p_es,
+        .stats = priv->stats,
     };
     if (p_es->p_master != NULL)
     {
@@ -2400,6 +2509,7 @@ static void EsOutCreateDecoder(es_out_sys_t *p_sys, es_out_id_t *p_es)
                 .cc_decoder = p_sys->cc_decoder,
                 .cbs = &decoder_cbs,
                 .cbs_data = p_es,
+                .stats = priv->stats,
             };
             p_es->p_dec_record = vlc_input_decoder_New( VLC_OBJECT(p_input), &rec_cfg );
 
@@ -2476,6 +2586,7 @@ static void EsOutSelectEs(es_out_sys_t *p_sys, es_out_id_t *es, bool b_force, en
 {
     input_thread_t *p_input = p_sys->p_input;
     bool b_thumbnailing = p_sys->input_type == INPUT_TYPE_THUMBNAILING;
+    bool b_loudness = p_sys->input_type == INPUT_TYPE_LOUDNESS;
 
     if( EsIsSelected( es ) )
     {
@@ -2493,7 +2604,8 @@ static void EsOutSelectEs(es_out_sys_t *p_sys, es_out_id_t *es, bool b_force, en
     {
         if( es->fmt.i_cat == VIDEO_ES || es->fmt.i_cat == SPU_ES )
         {
-            if( !var_GetBool( p_input, b_sout ? "sout-video" : "video" ) )
+            if( b_loudness
+             || !var_GetBool( p_input, b_sout ? "sout-video" : "video" ) )
             {
                 msg_Dbg( p_input, "video is disabled, not selecting ES 0x%x",
                          es->fmt.i_id );
@@ -3435,6 +3547,18 @@ static int EsOutVaControlLocked(es_out_sys_t *p_sys, input_source_t *source,
         if( !p_sys->p_pgrm )
             return VLC_SUCCESS;
 
+        double f_skew;
+        vlc_tick_t i_jitter;
+        if( p_pgrm == p_sys->p_pgrm && priv->stats != NULL
+         && input_clock_GetDrift( p_pgrm->p_input_clock, &f_skew,
+                                  &i_jitter ) == VLC_SUCCESS )
+        {
+            atomic_store_explicit( &priv->stats->clock_skew, f_skew,
+                                   memory_order_relaxed );
+            atomic_store_explicit( &priv->stats->clock_jitter,
+                                   __MAX( i_jitter, 0 ), memory_order_relaxed );
+        }
+
         if( p_sys->b_buffering )
         {
             /* Check buffering state on master clock update */
@@ -4038,6 +4162,9 @@ static int EsOutVaPrivControlLocked(es_out_sys_t *p_sys, input_source_t *source,
         }
         return ret;
     }
+    case ES_OUT_PRIV_SEEK_TIMESHIFT:
+        /* Nothing is buffered at this level */
+        return VLC_EGENERIC;
     default: vlc_assert_unreachable();
     }
 
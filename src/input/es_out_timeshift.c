@@ -29,6 +29,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <assert.h>
 #include <errno.h>
 #if defined (_WIN32)
@@ -36,6 +37,15 @@
 #endif
 #include <sys/stat.h>
 #include <unistd.h>
+#include <fcntl.h>
+
+/* Map the storage files where the address space is large enough for hours of
+ * timeshift, and where the file blocks can be reserved up front: writing to a
+ * sparse mapping would fault with SIGBUS once the disk is full. */
+#if defined (HAVE_MMAP) && defined (HAVE_POSIX_FALLOCATE) && SIZE_MAX > UINT32_MAX
+#  define TS_STORAGE_MMAP 1
+#  include <sys/mman.h>
+#endif
 
 #include <vlc_common.h>
 #include <vlc_arrays.h>
@@ -43,6 +53,7 @@
 #include <vlc_mouse.h>
 #include <vlc_es_out.h>
 #include <vlc_block.h>
+#include <vlc_atomic.h>
 #include "input_internal.h"
 #ifdef _WIN32
 #  include <vlc_charset.h> // FromWide
@@ -190,6 +201,44 @@ static_assert(offsetof(ts_cmd_t, header) == offsetof(ts_cmd_send_t, header), "in
 static_assert(offsetof(ts_cmd_t, header) == offsetof(ts_cmd_control_t, header), "invalid packing");
 static_assert(offsetof(ts_cmd_t, header) == offsetof(ts_cmd_privcontrol_t, header), "invalid packing");
 
+#ifdef TS_STORAGE_MMAP
+/* Mapping of a storage file, shared by the storage and the blocks read from
+ * it, which point directly into the mapped pages */
+typedef struct
+{
+    vlc_atomic_rc_t rc;
+    uint8_t *p_base;
+    size_t   i_size;
+} ts_storage_map_t;
+
+typedef struct
+{
+    vlc_tick_t i_dts;
+    vlc_tick_t i_pts;
+    vlc_tick_t i_length;
+    uint32_t   i_flags;
+    unsigned   i_nb_samples;
+    size_t     i_buffer;
+} ts_storage_header_t;
+
+typedef struct
+{
+    block_t self;
+    ts_storage_map_t *p_map;
+} ts_storage_block_t;
+#endif
+
+/* Random access point of the recorded commands */
+typedef struct
+{
+    vlc_tick_t i_time;  /* Estimated stream time */
+    vlc_tick_t i_date;  /* Command date */
+    uint64_t   i_cmd;   /* Command sequence number */
+} ts_index_entry_t;
+
+/* Minimal distance between two index entries */
+#define TS_INDEX_INTERVAL VLC_TICK_FROM_MS(500)
+
 typedef struct ts_storage_t ts_storage_t;
 struct ts_storage_t
 {
@@ -201,8 +250,12 @@ struct ts_storage_t
 #endif
     size_t  i_file_max; /* Max size in bytes */
     int64_t i_file_size;/* Current size in bytes */
+#ifdef TS_STORAGE_MMAP
+    ts_storage_map_t *p_map; /* Preallocated file mapping */
+#else
     FILE    *p_filew;   /* FILE handle for data writing */
     FILE    *p_filer;   /* FILE handle for data reading */
+#endif
 
     /* */
     uint8_t *p_cmd_r;
@@ -245,6 +298,24 @@ typedef struct
 
     vlc_tick_t     i_cmd_delay;
 
+    /* Command sequence numbers */
+    uint64_t       i_cmd_push;
+    uint64_t       i_cmd_pop;
+
+    /* Sparse index of the random access points still buffered, sorted by
+     * sequence number: [i_index_first, i_index_count[ */
+    ts_index_entry_t *p_index;
+    size_t         i_index_first;
+    size_t         i_index_count;
+    size_t         i_index_size;
+    bool           b_index_keyframe; /* Keyframes seen, ignore PCR points */
+    vlc_tick_t     i_index_time;     /* Last stream time recorded */
+    vlc_tick_t     i_index_time_date;
+
+    /* Pending seek: skip up to this sequence number */
+    bool           b_seek;
+    uint64_t       i_seek_cmd;
+
 } ts_thread_t;
 
 struct es_out_id_t
@@ -293,6 +364,7 @@ static bool         TsHasCmd( ts_thread_t * );
 static bool         TsIsUnused( ts_thread_t * );
 static int          TsChangePause( ts_thread_t *, bool b_source_paused, bool b_paused, vlc_tick_t i_date );
 static int          TsChangeRate( ts_thread_t *, float src_rate, float rate );
+static int          TsSeek( ts_thread_t *, vlc_tick_t i_time );
 
 static void         *TsRun( void * );
 
@@ -799,6 +871,14 @@ static int PrivControlLocked(struct vlc_input_es_out *p_tsout,
     }
     case ES_OUT_PRIV_GET_GROUP_FORCED:
         return es_out_in_vaPrivControl( p_sys->p_out, in, i_query, args );
+    case ES_OUT_PRIV_SEEK_TIMESHIFT:
+    {
+        const vlc_tick_t i_time = va_arg( args, vlc_tick_t );
+
+        if( !p_sys->b_delayed )
+            return VLC_EGENERIC;
+        return TsSeek( p_sys->p_ts, i_time );
+    }
     /* Invalid queries for this es_out level */
     case ES_OUT_PRIV_SET_ES:
     case ES_OUT_PRIV_UNSET_ES:
@@ -947,6 +1027,7 @@ input_EsOutTimeshiftNew(input_thread_t *p_input,
  *****************************************************************************/
 static void TsDestroy( ts_thread_t *p_ts )
 {
+    free( p_ts->p_index );
     free( p_ts );
 }
 static int TsStart(struct es_out_timeshift *p_sys)
@@ -980,6 +1061,16 @@ static int TsStart(struct es_out_timeshift *p_sys)
     p_ts->i_cmd_delay = 0;
     p_ts->p_storage_r = NULL;
     p_ts->p_storage_w = NULL;
+    p_ts->i_cmd_push = 0;
+    p_ts->i_cmd_pop = 0;
+    p_ts->p_index = NULL;
+    p_ts->i_index_first = 0;
+    p_ts->i_index_count = 0;
+    p_ts->i_index_size = 0;
+    p_ts->b_index_keyframe = false;
+    p_ts->i_index_time = VLC_TICK_INVALID;
+    p_ts->i_index_time_date = VLC_TICK_INVALID;
+    p_ts->b_seek = false;
 
     p_sys->b_delayed = true;
     if( vlc_clone( &p_ts->thread, TsRun, p_ts ) )
@@ -1031,6 +1122,74 @@ static void TsStop( ts_thread_t *p_ts )
 
     TsDestroy( p_ts );
 }
+static bool TsIndexIsRandomAccess( ts_thread_t *p_ts, const ts_cmd_t *p_cmd )
+{
+    switch( p_cmd->header.i_type )
+    {
+    case C_SEND:
+        if( !(p_cmd->send.p_block->i_flags & BLOCK_FLAG_TYPE_I) )
+            return false;
+        p_ts->b_index_keyframe = true;
+        return true;
+    case C_CONTROL:
+        /* Decoding of streams without keyframes (audio) can start at any
+         * clock reference */
+        return !p_ts->b_index_keyframe &&
+               ( p_cmd->control.i_query == ES_OUT_SET_PCR ||
+                 p_cmd->control.i_query == ES_OUT_SET_GROUP_PCR );
+    case C_PRIVCONTROL:
+        if( p_cmd->privcontrol.i_query == ES_OUT_PRIV_SET_TIMES &&
+            p_cmd->privcontrol.u.times.i_time != VLC_TICK_INVALID )
+        {
+            p_ts->i_index_time = p_cmd->privcontrol.u.times.i_time;
+            p_ts->i_index_time_date = p_cmd->header.i_date;
+        }
+        return false;
+    default:
+        return false;
+    }
+}
+static void TsIndexAddLocked( ts_thread_t *p_ts, const ts_cmd_t *p_cmd )
+{
+    vlc_mutex_assert( &p_ts->lock );
+
+    if( !TsIndexIsRandomAccess( p_ts, p_cmd ) ||
+        p_ts->i_index_time == VLC_TICK_INVALID )
+        return;
+
+    if( p_ts->i_index_count > p_ts->i_index_first &&
+        p_cmd->header.i_date - p_ts->p_index[p_ts->i_index_count - 1].i_date < TS_INDEX_INTERVAL )
+        return;
+
+    if( p_ts->i_index_count >= p_ts->i_index_size )
+    {
+        if( p_ts->i_index_first > 0 )
+        {
+            /* Reuse the space of the entries already played */
+            p_ts->i_index_count -= p_ts->i_index_first;
+            memmove( p_ts->p_index, &p_ts->p_index[p_ts->i_index_first],
+                     p_ts->i_index_count * sizeof(*p_ts->p_index) );
+            p_ts->i_index_first = 0;
+        }
+        if( p_ts->i_index_count >= p_ts->i_index_size )
+        {
+            size_t i_size = __MAX( 2 * p_ts->i_index_size, 64 );
+            ts_index_entry_t *p_index = vlc_reallocarray( p_ts->p_index, i_size,
+                                                         sizeof(*p_index) );
+            if( !p_index )
+                return;
+            p_ts->p_index = p_index;
+            p_ts->i_index_size = i_size;
+        }
+    }
+
+    /* The stream time is only updated periodically, extrapolate it */
+    ts_index_entry_t *p_entry = &p_ts->p_index[p_ts->i_index_count++];
+    p_entry->i_time = p_ts->i_index_time +
+                      p_cmd->header.i_date - p_ts->i_index_time_date;
+    p_entry->i_date = p_cmd->header.i_date;
+    p_entry->i_cmd = p_ts->i_cmd_push;
+}
 static void TsPushCmd( ts_thread_t *p_ts, ts_cmd_t *p_cmd )
 {
     vlc_mutex_lock( &p_ts->lock );
@@ -1059,8 +1218,11 @@ static void TsPushCmd( ts_thread_t *p_ts, ts_cmd_t *p_cmd )
         }
     }
 
+    TsIndexAddLocked( p_ts, p_cmd );
+
     /* TODO return error and warn the user (but only once) */
     TsStoragePushCmd( p_ts->p_storage_w, p_cmd, p_ts->p_storage_r == p_ts->p_storage_w );
+    p_ts->i_cmd_push++;
 
     vlc_cond_signal( &p_ts->wait );
 
@@ -1074,6 +1236,11 @@ static int TsPopCmdLocked( ts_thread_t *p_ts, ts_cmd_t *p_cmd, bool b_flush )
         return VLC_EGENERIC;
 
     TsStoragePopCmd( p_ts->p_storage_r, p_cmd, b_flush );
+    p_ts->i_cmd_pop++;
+
+    while( p_ts->i_index_first < p_ts->i_index_count &&
+           p_ts->p_index[p_ts->i_index_first].i_cmd < p_ts->i_cmd_pop )
+        p_ts->i_index_first++;
 
     while( TsStorageIsEmpty( p_ts->p_storage_r ) )
     {
@@ -1159,6 +1326,98 @@ static int TsChangeRate( ts_thread_t *p_ts, float src_rate, float rate )
     return i_ret;
 }
 
+static int TsSeek( ts_thread_t *p_ts, vlc_tick_t i_time )
+{
+    vlc_mutex_lock( &p_ts->lock );
+
+    /* Find the last random access point not after the requested time */
+    size_t i_low = p_ts->i_index_first;
+    size_t i_high = p_ts->i_index_count;
+    while( i_low < i_high )
+    {
+        const size_t i_mid = i_low + (i_high - i_low) / 2;
+        if( p_ts->p_index[i_mid].i_time <= i_time )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+
+    /* Already played commands are not kept, only seek forward */
+    if( i_low == p_ts->i_index_first )
+    {
+        vlc_mutex_unlock( &p_ts->lock );
+        return VLC_EGENERIC;
+    }
+
+    const ts_index_entry_t *p_entry = &p_ts->p_index[i_low - 1];
+    msg_Dbg( p_ts->p_input, "es out timeshift: seeking to %"PRId64" (skipping %"PRIu64" commands)",
+             p_entry->i_time, p_entry->i_cmd - p_ts->i_cmd_pop );
+
+    p_ts->b_seek = true;
+    p_ts->i_seek_cmd = p_entry->i_cmd;
+    vlc_cond_signal( &p_ts->wait );
+    vlc_mutex_unlock( &p_ts->lock );
+
+    return VLC_SUCCESS;
+}
+
+static void TsRunSeekLocked( ts_thread_t *p_ts )
+{
+    vlc_tick_t i_first_date = VLC_TICK_INVALID;
+    vlc_tick_t i_last_date = VLC_TICK_INVALID;
+    ts_cmd_t cmd;
+
+    /* Drop the data up to the random access point but keep the ES and
+     * programs state up to date */
+    while( p_ts->b_seek && p_ts->i_cmd_pop < p_ts->i_seek_cmd &&
+           !TsPopCmdLocked( p_ts, &cmd, true ) )
+    {
+        if( i_first_date == VLC_TICK_INVALID )
+            i_first_date = cmd.header.i_date;
+        i_last_date = cmd.header.i_date;
+
+        vlc_mutex_unlock( &p_ts->lock );
+        switch( cmd.header.i_type )
+        {
+        case C_ADD:
+            CmdExecuteAdd(p_ts->ts, &cmd.add);
+            CmdCleanAdd( &cmd.add );
+            break;
+        case C_SEND:
+            CmdCleanSend( &cmd.send );
+            break;
+        case C_CONTROL:
+            if( cmd.control.i_query != ES_OUT_SET_PCR &&
+                cmd.control.i_query != ES_OUT_SET_GROUP_PCR )
+                CmdExecuteControl(p_ts->ts, &cmd.control);
+            CmdCleanControl( &cmd.control );
+            break;
+        case C_PRIVCONTROL:
+            CmdExecutePrivControl(p_ts->ts, &cmd.privcontrol);
+            CmdCleanPrivControl( &cmd.privcontrol );
+            break;
+        case C_DEL:
+            CmdExecuteDel(p_ts->ts, &cmd.del);
+            break;
+        default:
+            vlc_assert_unreachable();
+            break;
+        }
+        vlc_mutex_lock( &p_ts->lock );
+    }
+    p_ts->b_seek = false;
+
+    /* Reset the decoders and the clock */
+    es_out_in_Control( p_ts->p_out, NULL, ES_OUT_RESET_PCR );
+
+    /* Play the random access point right away */
+    p_ts->i_cmd_delay += p_ts->i_rate_delay;
+    p_ts->i_rate_date = -1;
+    p_ts->i_rate_delay = 0;
+    if( i_first_date != VLC_TICK_INVALID )
+        p_ts->i_cmd_delay -= i_last_date - i_first_date;
+}
+
 static void *TsRun( void *p_data )
 {
     vlc_thread_set_name("vlc-timeshift");
@@ -1172,6 +1431,12 @@ static void *TsRun( void *p_data )
         ts_cmd_t cmd;
         vlc_tick_t  i_deadline;
 
+        if( p_ts->b_seek )
+        {
+            TsRunSeekLocked( p_ts );
+            continue;
+        }
+
         /* Pop a command to execute */
         bool b_buffering = es_out_GetBuffering( p_ts->p_out );
 
@@ -1284,6 +1549,89 @@ static const size_t TsStorageSizeofCommand[] =
     [C_PRIVCONTROL] = sizeof(ts_cmd_privcontrol_t)
 };
 
+#ifdef TS_STORAGE_MMAP
+/* Blocks are stored as a header followed by the payload, both aligned */
+#define TS_STORAGE_ALIGN(x) (((x) + 15) & ~(size_t)15)
+#define TS_STORAGE_HEADER_SIZE TS_STORAGE_ALIGN(sizeof(ts_storage_header_t))
+
+static size_t TsStorageSizeofBlock( const block_t *p_block )
+{
+    return TS_STORAGE_HEADER_SIZE + TS_STORAGE_ALIGN(p_block->i_buffer);
+}
+
+static void TsStorageMapRelease( ts_storage_map_t *p_map )
+{
+    if( vlc_atomic_rc_dec( &p_map->rc ) )
+    {
+        munmap( p_map->p_base, p_map->i_size );
+        free( p_map );
+    }
+}
+
+static void TsStorageBlockRelease( block_t *p_block )
+{
+    ts_storage_block_t *p_sblock = container_of( p_block, ts_storage_block_t, self );
+
+    TsStorageMapRelease( p_sblock->p_map );
+    free( p_sblock );
+}
+
+static const struct vlc_frame_callbacks TsStorageBlockCbs =
+{
+    TsStorageBlockRelease,
+};
+
+static int TsStorageOpen( ts_storage_t *p_storage, int fd )
+{
+    /* Reserve the whole file at once, so that the data written through the
+     * mapping cannot fail */
+    if( posix_fallocate( fd, 0, p_storage->i_file_max ) != 0 )
+        return VLC_EGENERIC;
+
+    ts_storage_map_t *p_map = malloc( sizeof (*p_map) );
+    if( unlikely(p_map == NULL) )
+        return VLC_ENOMEM;
+
+    p_map->p_base = mmap( NULL, p_storage->i_file_max, PROT_READ | PROT_WRITE,
+                          MAP_SHARED, fd, 0 );
+    if( p_map->p_base == MAP_FAILED )
+    {
+        free( p_map );
+        return VLC_EGENERIC;
+    }
+    p_map->i_size = p_storage->i_file_max;
+    vlc_atomic_rc_init( &p_map->rc );
+#ifdef MADV_SEQUENTIAL
+    /* Written once and read once, both in order */
+    madvise( p_map->p_base, p_map->i_size, MADV_SEQUENTIAL );
+#endif
+
+    p_storage->p_map = p_map;
+    vlc_close( fd );
+    return VLC_SUCCESS;
+}
+#else
+static size_t TsStorageSizeofBlock( const block_t *p_block )
+{
+    return sizeof(*p_block) + p_block->i_buffer;
+}
+
+static int TsStorageOpen( ts_storage_t *p_storage, int fd, const char *psz_file )
+{
+    p_storage->p_filew = fdopen( fd, "w+b" );
+    if( p_storage->p_filew == NULL )
+        return VLC_EGENERIC;
+
+    p_storage->p_filer = vlc_fopen( psz_file, "rb" );
+    if( p_storage->p_filer == NULL )
+    {
+        fclose( p_storage->p_filew );
+        return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+#endif
+
 static ts_storage_t *TsStorageNew( const char *psz_tmp_path, int64_t i_tmp_size_max )
 {
     ts_storage_t *p_storage = malloc( sizeof (*p_storage) );
@@ -1298,21 +1646,26 @@ static ts_storage_t *TsStorageNew( const char *psz_tmp_path, int64_t i_tmp_size_
         return NULL;
     }
 
-    p_storage->p_filew = fdopen( fd, "w+b" );
-    if( p_storage->p_filew == NULL )
+    /* */
+    p_storage->i_file_max = i_tmp_size_max;
+    p_storage->i_file_size = 0;
+
+#ifdef TS_STORAGE_MMAP
+    if( TsStorageOpen( p_storage, fd ) )
     {
         vlc_close( fd );
         vlc_unlink( psz_file );
         goto error;
     }
-
-    p_storage->p_filer = vlc_fopen( psz_file, "rb" );
-    if( p_storage->p_filer == NULL )
+#else
+    if( TsStorageOpen( p_storage, fd, psz_file ) )
     {
-        fclose( p_storage->p_filew );
+        if( p_storage->p_filew == NULL )
+            vlc_close( fd );
         vlc_unlink( psz_file );
         goto error;
     }
+#endif
 
 #ifndef _WIN32
     vlc_unlink( psz_file );
@@ -1322,10 +1675,6 @@ static ts_storage_t *TsStorageNew( const char *psz_tmp_path, int64_t i_tmp_size_
 #endif
     p_storage->p_next = NULL;
 
-    /* */
-    p_storage->i_file_max = i_tmp_size_max;
-    p_storage->i_file_size = 0;
-
     /* */
     p_storage->p_cmd_buf = vlc_alloc( TS_STORAGE_COMMAND_PREALLOC, MAX_COMMAND_SIZE );
     p_storage->i_cmd_buf = TS_STORAGE_COMMAND_PREALLOC * MAX_COMMAND_SIZE;
@@ -1357,8 +1706,12 @@ static void TsStorageDelete( ts_storage_t *p_storage )
     }
     free( p_storage->p_cmd_buf );
 
+#ifdef TS_STORAGE_MMAP
+    TsStorageMapRelease( p_storage->p_map );
+#else
     fclose( p_storage->p_filer );
     fclose( p_storage->p_filew );
+#endif
 #ifdef _WIN32
     vlc_unlink( p_storage->psz_file );
     free( p_storage->psz_file );
@@ -1387,7 +1740,7 @@ static bool TsStorageIsFull( ts_storage_t *p_storage, const ts_cmd_t *p_cmd )
 {
     if( p_cmd && p_cmd->header.i_type == C_SEND && p_storage->p_cmd_w )
     {
-        size_t i_size = sizeof(*p_cmd->send.p_block) + p_cmd->send.p_block->i_buffer;
+        size_t i_size = TsStorageSizeofBlock( p_cmd->send.p_block );
 
         if( p_storage->i_file_size + i_size >= p_storage->i_file_max )
             return true;
@@ -1411,6 +1764,33 @@ static void TsStoragePushCmd( ts_storage_t *p_storage, const ts_cmd_t *p_cmd, bo
         block_t *p_block = cmd.send.p_block;
 
         cmd.send.p_block = NULL;
+#ifdef TS_STORAGE_MMAP
+        (void) b_flush;
+
+        size_t i_size = TsStorageSizeofBlock( p_block );
+        if( p_storage->i_file_size + i_size > p_storage->i_file_max )
+        {   /* Larger than a whole storage file */
+            block_Release( p_block );
+            return;
+        }
+        cmd.send.i_offset = p_storage->i_file_size;
+
+        uint8_t *p_data = p_storage->p_map->p_base + cmd.send.i_offset;
+        const ts_storage_header_t header = {
+            .i_dts = p_block->i_dts,
+            .i_pts = p_block->i_pts,
+            .i_length = p_block->i_length,
+            .i_flags = p_block->i_flags,
+            .i_nb_samples = p_block->i_nb_samples,
+            .i_buffer = p_block->i_buffer,
+        };
+        memcpy( p_data, &header, sizeof(header) );
+        if( p_block->i_buffer > 0 )
+            memcpy( &p_data[TS_STORAGE_HEADER_SIZE], p_block->p_buffer,
+                    p_block->i_buffer );
+        p_storage->i_file_size += i_size;
+        block_Release( p_block );
+#else
         cmd.send.i_offset = ftell( p_storage->p_filew );
 
         if( fwrite( p_block, sizeof(*p_block), 1, p_storage->p_filew ) != 1 )
@@ -1432,6 +1812,7 @@ static void TsStoragePushCmd( ts_storage_t *p_storage, const ts_cmd_t *p_cmd, bo
 
         if( b_flush )
             fflush( p_storage->p_filew );
+#endif
     }
     size_t i_cmdsize = TsStorageSizeofCommand[ cmd.header.i_type ];
     memcpy( p_storage->p_cmd_w, &cmd, i_cmdsize );
@@ -1449,6 +1830,35 @@ static void TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_fl
 
     if( p_cmd->header.i_type == C_SEND )
     {
+#ifdef TS_STORAGE_MMAP
+        ts_storage_block_t *p_sblock = NULL;
+
+        /* Hand out the stored data without copying it */
+        if( !b_flush )
+            p_sblock = malloc( sizeof (*p_sblock) );
+        if( p_sblock != NULL )
+        {
+            ts_storage_map_t *p_map = p_storage->p_map;
+            uint8_t *p_data = p_map->p_base + p_cmd->send.i_offset;
+            ts_storage_header_t header;
+
+            memcpy( &header, p_data, sizeof(header) );
+            block_t *p_block = block_Init( &p_sblock->self, &TsStorageBlockCbs,
+                                           &p_data[TS_STORAGE_HEADER_SIZE],
+                                           header.i_buffer );
+            p_block->i_dts      = header.i_dts;
+            p_block->i_pts      = header.i_pts;
+            p_block->i_flags    = header.i_flags;
+            p_block->i_length   = header.i_length;
+            p_block->i_nb_samples = header.i_nb_samples;
+
+            vlc_atomic_rc_inc( &p_map->rc );
+            p_sblock->p_map = p_map;
+            p_cmd->send.p_block = p_block;
+        }
+        else
+            p_cmd->send.p_block = block_Alloc( 1 );
+#else
         block_t block;
 
         if( !b_flush &&
@@ -1472,6 +1882,7 @@ static void TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_fl
             //perror( "TsStoragePopCmd" );
             p_cmd->send.p_block = block_Alloc( 1 );
         }
+#endif
     }
 }
 
@@ -57,6 +57,7 @@
 #include <vlc_stream_extractor.h>
 #include <vlc_renderer_discovery.h>
 #include <vlc_hash.h>
+#include <vlc_tracer.h>
 
 /*****************************************************************************
  * Local prototypes
@@ -238,6 +239,9 @@ input_thread_t * input_Create( vlc_object_t *p_parent, input_item_t *p_item,
         case INPUT_TYPE_THUMBNAILING:
             type_str = "thumbnailing ";
             break;
+        case INPUT_TYPE_LOUDNESS:
+            type_str = "loudness measurement ";
+            break;
         default:
             type_str = "playback";
             break;
@@ -278,7 +282,8 @@ input_thread_t * input_Create( vlc_object_t *p_parent, input_item_t *p_item,
     priv->rate = 1.f;
     TAB_INIT( priv->i_attachment, priv->attachment );
     priv->p_sout   = NULL;
-    priv->b_out_pace_control = priv->type == INPUT_TYPE_THUMBNAILING;
+    priv->b_out_pace_control = priv->type == INPUT_TYPE_THUMBNAILING
+                            || priv->type == INPUT_TYPE_LOUDNESS;
     priv->p_renderer = cfg->renderer && priv->type == INPUT_TYPE_PLAYBACK ?
                 vlc_renderer_item_hold( cfg->renderer ) : NULL;
 
@@ -338,6 +343,8 @@ input_thread_t * input_Create( vlc_object_t *p_parent, input_item_t *p_item,
 
     priv->b_low_delay = var_InheritBool( p_input, "low-delay" );
     priv->i_jitter_max = VLC_TICK_FROM_MS(var_InheritInteger( p_input, "clock-jitter" ));
+    priv->i_jitter_tolerance =
+        VLC_TICK_FROM_MS(var_InheritInteger( p_input, "clock-jitter-tolerance" ));
 
     /* Remove 'Now playing' info as it is probably outdated */
     input_item_SetNowPlaying( p_item, NULL );
@@ -345,7 +352,8 @@ input_thread_t * input_Create( vlc_object_t *p_parent, input_item_t *p_item,
 
     /* */
     if( priv->type == INPUT_TYPE_PLAYBACK && var_InheritBool( p_input, "stats" ) )
-        priv->stats = input_stats_Create();
+        priv->stats = input_stats_Create( var_InheritBool( p_input,
+                                                           "stats-modules" ) );
     else
         priv->stats = NULL;
 
@@ -458,6 +466,15 @@ bool input_Stopped( input_thread_t *input )
  * Main loop: Fill buffers from access, and demux
  *****************************************************************************/
 
+static int InputSourceDemux( input_source_t *in )
+{
+    vlc_tick_t start = input_stats_ModuleStart( in->demux_stats );
+    int i_ret = demux_Demux( in->p_demux );
+
+    input_stats_ModuleStop( in->demux_stats, start );
+    return i_ret;
+}
+
 /**
  * MainLoopDemux
  * It asks the demuxer to demux some data
@@ -481,7 +498,7 @@ static void MainLoopDemux( input_thread_t *p_input, bool *pb_changed )
     }
 
     if( i_ret == VLC_DEMUXER_SUCCESS )
-        i_ret = demux_Demux( p_demux );
+        i_ret = InputSourceDemux( p_priv->master );
 
     i_ret = i_ret > 0 ? VLC_DEMUXER_SUCCESS : ( i_ret < 0 ? VLC_DEMUXER_EGENERIC : VLC_DEMUXER_EOF);
 
@@ -593,6 +610,80 @@ static void InputSourceStatistics(input_source_t *source, input_item_t *item,
     es_out_SetTimes( out, f_position, i_time, i_normal_time, i_length );
 }
 
+/* Upper bound in ms of the bucket holding the 95th percentile of a latency
+ * histogram, whose n-th bucket counts the values under 2^n ms */
+static uint64_t StatsLatencyP95(const uint64_t *histogram)
+{
+    uint64_t total = 0, count = 0;
+
+    for (size_t i = 0; i < INPUT_STATS_FRAME_LATENCY_BUCKETS; i++)
+        total += histogram[i];
+    if (total == 0)
+        return 0;
+
+    for (size_t i = 0; i < INPUT_STATS_FRAME_LATENCY_BUCKETS; i++)
+    {
+        count += histogram[i];
+        if (count * 100 >= total * 95)
+            return UINT64_C(1) << i;
+    }
+    return 0;
+}
+
+/**
+ * Publish the statistics as traces, for the metrics sinks
+ */
+static void TraceStatistics(struct vlc_tracer *tracer,
+                            const struct input_stats_t *st)
+{
+    /* The rates are in bytes per tick */
+    double input_kbps = st->f_input_bitrate * 8000.;
+    double demux_kbps = st->f_demux_bitrate * 8000.;
+
+    vlc_tracer_Trace(tracer, VLC_TRACE("type", "STATS"),
+                     VLC_TRACE("input_kbps", input_kbps),
+                     VLC_TRACE("read_bytes", st->i_read_bytes),
+                     VLC_TRACE("read_dropped", st->i_read_dropped),
+                     VLC_TRACE("demux_kbps", demux_kbps),
+                     VLC_TRACE("demux_corrupted", st->i_demux_corrupted),
+                     VLC_TRACE("demux_discontinuity",
+                               st->i_demux_discontinuity),
+                     VLC_TRACE("decoded_video", st->i_decoded_video),
+                     VLC_TRACE("decoded_audio", st->i_decoded_audio),
+                     VLC_TRACE("displayed_pictures", st->i_displayed_pictures),
+                     VLC_TRACE("late_pictures", st->i_late_pictures),
+                     VLC_TRACE("lost_pictures", st->i_lost_pictures),
+                     VLC_TRACE("played_abuffers", st->i_played_abuffers),
+                     VLC_TRACE("lost_abuffers", st->i_lost_abuffers),
+                     VLC_TRACE("queued_blocks", st->i_queued_blocks),
+                     VLC_TRACE("queued_bytes", st->i_queued_bytes),
+                     VLC_TRACE("dropped_blocks", st->i_dropped_blocks),
+                     VLC_TRACE_TICK_NS("render_time", st->i_render_time),
+                     VLC_TRACE("frame_queue_p95_ms",
+                               StatsLatencyP95(st->i_frame_queue)),
+                     VLC_TRACE("frame_render_p95_ms",
+                               StatsLatencyP95(st->i_frame_render)),
+                     VLC_TRACE("frame_present_p95_ms",
+                               StatsLatencyP95(st->i_frame_present)),
+                     VLC_TRACE("clock_skew", (double)st->f_clock_skew),
+                     VLC_TRACE_TICK_NS("clock_jitter", st->i_clock_jitter),
+                     VLC_TRACE_TICK_NS("seek_latency", st->i_seek_latency),
+                     VLC_TRACE_END);
+
+    for (size_t i = 0; i < st->i_modules; i++)
+    {
+        const struct input_stats_module_t *m = &st->modules[i];
+
+        vlc_tracer_Trace(tracer, VLC_TRACE("type", "MODULE"),
+                         VLC_TRACE("kind", (const char *)m->psz_kind),
+                         VLC_TRACE("name", (const char *)m->psz_name),
+                         VLC_TRACE_TICK_NS("cpu_time", m->i_cpu_time),
+                         VLC_TRACE("calls", m->i_calls),
+                         VLC_TRACE("allocs", m->i_allocs),
+                         VLC_TRACE_END);
+    }
+}
+
 /**
  * Update timing infos and statistics.
  */
@@ -618,6 +709,10 @@ static void MainLoopStatistics( input_thread_t *p_input )
         vlc_mutex_unlock(&priv->p_item->lock);
 
         input_SendEventStatistics(p_input, &new_stats);
+
+        struct vlc_tracer *tracer = vlc_object_get_tracer(VLC_OBJECT(p_input));
+        if (tracer != NULL)
+            TraceStatistics(tracer, &new_stats);
     }
 }
 
@@ -1301,6 +1396,12 @@ static int Init( input_thread_t * p_input )
         var_SetString( p_input, "sub-file", "" );
         var_SetBool( p_input, "sub-autodetect-file", false );
     }
+    else if( priv->type == INPUT_TYPE_THUMBNAILING )
+    {
+        /* Subtitles are not rendered in thumbnails, do not open them */
+        var_SetString( p_input, "sub-file", "" );
+        var_SetBool( p_input, "sub-autodetect-file", false );
+    }
 
     if( InitSout( p_input ) )
         goto error;
@@ -1983,6 +2084,15 @@ static bool Control( input_thread_t *p_input,
                 break;
             }
 
+            /* Jump inside the timeshift buffer when the target is already
+             * recorded, the demuxer is not able to seek anyway */
+            if( !es_out_SeekTimeshift( priv->p_es_out,
+                                       priv->i_start + param.time.i_val ) )
+            {
+                b_force_update = true;
+                break;
+            }
+
             /* Reset the decoders states and clock sync (before calling the demuxer */
             es_out_Control(&priv->p_es_out->out, ES_OUT_RESET_PCR);
 
@@ -2754,6 +2864,11 @@ static int InputSourceInit( input_source_t *in, input_thread_t *p_input,
         }
     }
 
+    char *psz_module = var_GetString( in->p_demux, "module-name" );
+    in->demux_stats = input_stats_GetModule( input_priv(p_input)->stats,
+                                             "demux", psz_module );
+    free( psz_module );
+
     /* Get infos from (access_)demux */
     if( demux_Control( in->p_demux, DEMUX_CAN_CONTROL_PACE,
                        &in->b_can_pace_control ) )
@@ -2949,13 +3064,13 @@ static void SlaveDemux( input_thread_t *p_input )
                     break;
                 }
 
-                if( ( i_ret = demux_Demux( in->p_demux ) ) <= 0 )
+                if( ( i_ret = InputSourceDemux( in ) ) <= 0 )
                     break;
             }
         }
         else
         {
-            i_ret = demux_Demux( in->p_demux );
+            i_ret = InputSourceDemux( in );
         }
 
         if( i_ret <= 0 )
@@ -53,6 +53,7 @@ enum input_type {
     INPUT_TYPE_PLAYBACK,
     INPUT_TYPE_PREPARSING,
     INPUT_TYPE_THUMBNAILING,
+    INPUT_TYPE_LOUDNESS,
 };
 
 /**
@@ -145,6 +146,9 @@ typedef enum input_event_type_e
     /* Thumbnail generation */
     INPUT_EVENT_THUMBNAIL_READY,
 
+    /* Loudness measurement */
+    INPUT_EVENT_LOUDNESS,
+
     /* Attachments */
     INPUT_EVENT_ATTACHMENTS,
 
@@ -324,6 +328,8 @@ struct vlc_input_event
         float subs_fps;
         /* INPUT_EVENT_THUMBNAIL_READY */
         picture_t *thumbnail;
+        /* INPUT_EVENT_LOUDNESS */
+        const struct vlc_audio_loudness *loudness;
         /* INPUT_EVENT_ATTACHMENTS */
         struct vlc_input_event_attachments attachments;
         /* INPUT_EVENT_NAV_FAILED */
@@ -479,6 +485,7 @@ typedef struct input_thread_private_t
     /* Delays */
     bool        b_low_delay;
     vlc_tick_t  i_jitter_max;
+    vlc_tick_t  i_jitter_tolerance;
 
     /* Output */
     bool            b_out_pace_control; /* XXX Move it ot es_sout ? */
@@ -718,8 +725,18 @@ typedef struct input_rate_t
     } samples[2];
 } input_rate_t;
 
+/* Resources used by one module, written by the threads calling the module */
+struct input_stats_module {
+    char kind[16];
+    char name[32];
+    atomic_uintmax_t cpu_time;
+    atomic_uintmax_t calls;
+    atomic_uintmax_t allocs;
+};
+
 struct input_stats {
     input_rate_t input_bitrate;
+    atomic_uintmax_t input_dropped;
     input_rate_t demux_bitrate;
     atomic_uintmax_t demux_corrupted;
     atomic_uintmax_t demux_discontinuity;
@@ -730,11 +747,41 @@ struct input_stats {
     atomic_uintmax_t displayed_pictures;
     atomic_uintmax_t late_pictures;
     atomic_uintmax_t lost_pictures;
+    atomic_uintmax_t render_time;
+    atomic_uintmax_t frame_queue[INPUT_STATS_FRAME_LATENCY_BUCKETS];
+    atomic_uintmax_t frame_render[INPUT_STATS_FRAME_LATENCY_BUCKETS];
+    atomic_uintmax_t frame_present[INPUT_STATS_FRAME_LATENCY_BUCKETS];
+    atomic_uintmax_t queued_blocks;
+    atomic_uintmax_t queued_bytes;
+    atomic_uintmax_t dropped_blocks;
+    atomic_uintmax_t queue_latency[INPUT_STATS_QUEUE_LATENCY_BUCKETS];
+    _Atomic float clock_skew;
+    _Atomic vlc_tick_t clock_jitter;
+    _Atomic vlc_tick_t seek_latency;
+
+    /* Per-module accounting, only with --stats-modules */
+    bool per_module;
+    vlc_mutex_t modules_lock; /* serializes the registrations */
+    atomic_size_t module_count;
+    struct input_stats_module modules[INPUT_STATS_MAX_MODULES];
 };
 
-struct input_stats *input_stats_Create(void);
+struct input_stats *input_stats_Create(bool per_module);
 void input_stats_Destroy(struct input_stats *);
+
+/* Returns the accounting of a module, registering it on first use, or NULL
+ * if the module is not accounted */
+struct input_stats_module *input_stats_GetModule(struct input_stats *,
+                                                 const char *kind,
+                                                 const char *name);
+/* Returns the CPU time to pass to input_stats_ModuleStop() once the module
+ * returns, VLC_TICK_INVALID if the module is NULL */
+vlc_tick_t input_stats_ModuleStart(const struct input_stats_module *);
+void input_stats_ModuleStop(struct input_stats_module *, vlc_tick_t start);
+void input_stats_ModuleAdd(struct input_stats_module *, vlc_tick_t cpu_time,
+                           uintmax_t calls, uintmax_t allocs);
 void input_rate_Add(input_rate_t *, uintmax_t);
+void input_stats_AddQueueLatency(struct input_stats *, vlc_tick_t);
 void input_stats_Compute(struct input_stats *, input_stats_t*);
 
 #endif
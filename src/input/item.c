@@ -182,13 +182,10 @@ void input_item_CopyOptions( input_item_t *p_child,
 bool input_item_MetaMatch( input_item_t *p_i,
                            vlc_meta_type_t meta_type, const char *psz )
 {
-    vlc_mutex_lock( &p_i->lock );
-
-    const char *psz_meta = vlc_meta_Get( p_i->p_meta, meta_type );
+    char *psz_meta = input_item_GetMeta( p_i, meta_type );
     bool b_ret = psz_meta && strcasestr( psz_meta, psz );
 
-    vlc_mutex_unlock( &p_i->lock );
-
+    free( psz_meta );
     return b_ret;
 }
 
@@ -200,12 +197,95 @@ const char *input_item_GetMetaLocked(input_item_t *item,
     return vlc_meta_Get(item->p_meta, meta_type);
 }
 
+static void input_item_MetaCopyDelete( struct input_item_meta_copy *copy )
+{
+    if( copy == NULL )
+        return;
+    for( int i = 0; i < VLC_META_TYPE_COUNT; i++ )
+        free( copy->values[i] );
+    free( copy );
+}
+
+/* Take a copy of the whole table under the item lock */
+static struct input_item_meta_copy *input_item_MetaCopyNew( input_item_t *item )
+{
+    struct input_item_meta_copy *copy = malloc( sizeof( *copy ) );
+    if( unlikely(copy == NULL) )
+        return NULL;
+
+    vlc_mutex_lock( &item->lock );
+    copy->generation = vlc_meta_GetGeneration( item->p_meta );
+    for( int i = 0; i < VLC_META_TYPE_COUNT; i++ )
+    {
+        const char *value = vlc_meta_Get( item->p_meta, i );
+
+        copy->values[i] = NULL;
+        if( value != NULL && unlikely((copy->values[i] = strdup( value )) == NULL) )
+        {
+            vlc_mutex_unlock( &item->lock );
+            input_item_MetaCopyDelete( copy );
+            return NULL;
+        }
+    }
+    vlc_mutex_unlock( &item->lock );
+    return copy;
+}
+
+static bool input_item_MetaCopyIsCurrent( input_item_t *item,
+                                          const struct input_item_meta_copy *copy )
+{
+    /* p_meta is allocated with the item and never replaced */
+    return copy != NULL
+        && copy->generation == vlc_meta_GetGeneration( item->p_meta );
+}
+
+/*
+ * The meta are read far more often (by the interfaces, the playlist and the
+ * media library) than they are written, and they are written from the input
+ * thread, which holds the item lock for the whole update. The readers get the
+ * values from a copy of the table instead, behind a lock of their own, and only
+ * wait on the item lock when the table changed since the last copy.
+ */
 char *input_item_GetMeta( input_item_t *p_i, vlc_meta_type_t meta_type )
 {
-    vlc_mutex_lock( &p_i->lock );
-    const char *value = input_item_GetMetaLocked( p_i, meta_type );
-    char *psz = value ? strdup( value ) : NULL;
-    vlc_mutex_unlock( &p_i->lock );
+    input_item_owner_t *owner = item_owner(p_i);
+    char *psz = NULL;
+
+    vlc_mutex_lock( &owner->meta_lock );
+    struct input_item_meta_copy *copy = owner->meta_copy;
+    if( input_item_MetaCopyIsCurrent( p_i, copy ) )
+    {
+        if( copy->values[meta_type] != NULL )
+            psz = strdup( copy->values[meta_type] );
+        vlc_mutex_unlock( &owner->meta_lock );
+        return psz;
+    }
+    vlc_mutex_unlock( &owner->meta_lock );
+
+    copy = input_item_MetaCopyNew( p_i );
+    if( unlikely(copy == NULL) )
+    {
+        vlc_mutex_lock( &p_i->lock );
+        const char *value = input_item_GetMetaLocked( p_i, meta_type );
+        psz = value ? strdup( value ) : NULL;
+        vlc_mutex_unlock( &p_i->lock );
+        return psz;
+    }
+
+    if( copy->values[meta_type] != NULL )
+        psz = strdup( copy->values[meta_type] );
+
+    /* Another reader may have published a newer copy meanwhile */
+    vlc_mutex_lock( &owner->meta_lock );
+    struct input_item_meta_copy *old = owner->meta_copy;
+    if( !input_item_MetaCopyIsCurrent( p_i, old ) )
+    {
+        owner->meta_copy = copy;
+        copy = old;
+    }
+    vlc_mutex_unlock( &owner->meta_lock );
+
+    input_item_MetaCopyDelete( copy );
     return psz;
 }
 
@@ -449,6 +529,7 @@ void input_item_Release( input_item_t *p_item )
         input_item_slave_Delete( p_item->pp_slaves[i] );
     TAB_CLEAN( p_item->i_slaves, p_item->pp_slaves );
 
+    input_item_MetaCopyDelete( owner->meta_copy );
     free( owner );
 }
 
@@ -838,12 +919,80 @@ static int InputItemAddInfo( input_item_t *p_i,
 }
 #endif
 
-void input_item_SetEpg( input_item_t *p_item, const vlc_epg_t *p_update, bool b_current_source )
+/* Finds the event of the previous version of a table matching an event of
+ * the update, in practice at the same position if there is one */
+static vlc_epg_event_t **EpgFindEvent( vlc_epg_t *p_old, size_t i_hint,
+                                       const vlc_epg_event_t *p_evt )
+{
+    if( i_hint < p_old->i_event && p_old->pp_event[i_hint] != NULL &&
+        vlc_epg_event_Equals( p_old->pp_event[i_hint], p_evt ) )
+        return &p_old->pp_event[i_hint];
+
+    for( size_t i = 0; i < p_old->i_event; i++ )
+        if( p_old->pp_event[i] != NULL &&
+            vlc_epg_event_Equals( p_old->pp_event[i], p_evt ) )
+            return &p_old->pp_event[i];
+    return NULL;
+}
+
+static bool EpgEquals( const vlc_epg_t *a, const vlc_epg_t *b )
+{
+    if( a->i_event != b->i_event || a->b_present != b->b_present ||
+        (a->psz_name == NULL) != (b->psz_name == NULL) ||
+        (a->psz_name != NULL && strcmp( a->psz_name, b->psz_name )) )
+        return false;
+
+    for( size_t i = 0; i < a->i_event; i++ )
+    {
+        if( !vlc_epg_event_Equals( a->pp_event[i], b->pp_event[i] ) )
+            return false;
+        if( (a->p_current == a->pp_event[i]) !=
+            (b->p_current == b->pp_event[i]) )
+            return false;
+    }
+    return true;
+}
+
+/* Builds the new version of a table, taking over the unchanged events of
+ * the previous one instead of duplicating them */
+static vlc_epg_t *EpgUpdate( vlc_epg_t *p_old, const vlc_epg_t *p_update )
 {
-    vlc_epg_t *p_epg = vlc_epg_Duplicate( p_update );
+    vlc_epg_t *p_epg = vlc_epg_New( p_update->i_id, p_update->i_source_id );
     if( !p_epg )
-        return;
+        return NULL;
+
+    if( p_update->psz_name )
+        p_epg->psz_name = strdup( p_update->psz_name );
+    p_epg->b_present = p_update->b_present;
 
+    for( size_t i = 0; i < p_update->i_event; i++ )
+    {
+        const vlc_epg_event_t *p_src = p_update->pp_event[i];
+        vlc_epg_event_t **pp_old = p_old ? EpgFindEvent( p_old, i, p_src )
+                                         : NULL;
+        vlc_epg_event_t *p_evt;
+
+        if( pp_old )
+        {
+            p_evt = *pp_old;
+            *pp_old = NULL;
+        }
+        else
+        {
+            p_evt = vlc_epg_event_Duplicate( p_src );
+            if( !p_evt )
+                continue;
+        }
+
+        if( p_update->p_current == p_src )
+            p_epg->p_current = p_evt;
+        TAB_APPEND( p_epg->i_event, p_epg->pp_event, p_evt );
+    }
+    return p_epg;
+}
+
+bool input_item_SetEpg( input_item_t *p_item, const vlc_epg_t *p_update, bool b_current_source )
+{
     vlc_mutex_lock( &p_item->lock );
 
     /* */
@@ -858,12 +1007,35 @@ void input_item_SetEpg( input_item_t *p_item, const vlc_epg_t *p_update, bool b_
         }
     }
 
+    /* The EIT tables are repeated all the time, mostly unchanged */
+    if( pp_epg && EpgEquals( *pp_epg, p_update ) )
+    {
+        if( b_current_source && (*pp_epg)->b_present )
+            p_item->p_epg_table = *pp_epg;
+        vlc_mutex_unlock( &p_item->lock );
+        return false;
+    }
+
+    vlc_epg_t *p_epg = EpgUpdate( pp_epg ? *pp_epg : NULL, p_update );
+    if( !p_epg )
+    {
+        vlc_mutex_unlock( &p_item->lock );
+        return false;
+    }
+
     /* replace with new version */
     if( pp_epg )
     {
-        vlc_epg_Delete( *pp_epg );
-        if( *pp_epg == p_item->p_epg_table ) /* current table can have changed */
+        vlc_epg_t *p_old = *pp_epg;
+
+        /* release the events that were not taken over */
+        for( size_t i = 0; i < p_old->i_event; i++ )
+            if( p_old->pp_event[i] != NULL )
+                vlc_epg_event_Delete( p_old->pp_event[i] );
+        p_old->i_event = 0;
+        if( p_old == p_item->p_epg_table ) /* current table can have changed */
             p_item->p_epg_table = NULL;
+        vlc_epg_Delete( p_old );
         *pp_epg = p_epg;
     }
     else
@@ -879,7 +1051,7 @@ void input_item_SetEpg( input_item_t *p_item, const vlc_epg_t *p_update, bool b_
 #ifdef EPG_DEBUG
     char *psz_epg;
     if( asprintf( &psz_epg, "EPG %s", p_epg->psz_name ? p_epg->psz_name : "unknown" ) < 0 )
-        return;
+        return true;
 
     input_item_DelInfo( p_item, psz_epg, NULL );
 
@@ -910,6 +1082,7 @@ void input_item_SetEpg( input_item_t *p_item, const vlc_epg_t *p_update, bool b_
     vlc_mutex_unlock( &p_item->lock );
     free( psz_epg );
 #endif
+    return true;
 }
 
 void input_item_ChangeEPGSource( input_item_t *p_item, int i_source_id )
@@ -990,6 +1163,8 @@ input_item_NewExt( const char *psz_uri, const char *psz_name,
     }
 
     vlc_mutex_init( &p_input->lock );
+    vlc_mutex_init( &owner->meta_lock );
+    owner->meta_copy = NULL;
 
     p_input->psz_name = NULL;
     if( psz_name )
@@ -1202,6 +1377,31 @@ input_item_node_t *input_item_node_AppendItem( input_item_node_t *p_node, input_
     return p_new_child;
 }
 
+int input_item_node_AppendItems( input_item_node_t *p_node,
+                                 input_item_t *const *pp_items, size_t i_count )
+{
+    if( i_count == 0 )
+        return VLC_SUCCESS;
+    if( i_count > (size_t)(INT_MAX - p_node->i_children) )
+        return VLC_ENOMEM;
+
+    input_item_node_t **pp_children =
+        vlc_reallocarray( p_node->pp_children, p_node->i_children + i_count,
+                          sizeof( *pp_children ) );
+    if( unlikely(pp_children == NULL) )
+        return VLC_ENOMEM;
+    p_node->pp_children = pp_children;
+
+    for( size_t i = 0; i < i_count; i++ )
+    {
+        input_item_node_t *p_child = input_item_node_Create( pp_items[i] );
+        if( unlikely(p_child == NULL) )
+            return i > 0 ? VLC_SUCCESS : VLC_ENOMEM;
+        pp_children[p_node->i_children++] = p_child;
+    }
+    return VLC_SUCCESS;
+}
+
 void input_item_node_AppendNode( input_item_node_t *p_parent,
                                  input_item_node_t *p_child )
 {
@@ -29,10 +29,22 @@
 void input_item_UpdateTracksInfo( input_item_t *item, const es_format_t *fmt,
                                   const char *es_id, bool stable );
 
+unsigned vlc_meta_GetGeneration( const vlc_meta_t *meta );
+
+/* copy of the meta table, read without the item lock */
+struct input_item_meta_copy
+{
+    unsigned generation;
+    char *values[VLC_META_TYPE_COUNT];
+};
+
 typedef struct input_item_owner
 {
     input_item_t item;
     vlc_atomic_rc_t rc;
+
+    vlc_mutex_t meta_lock; /* never held while taking the item lock */
+    struct input_item_meta_copy *meta_copy; /* lazily refreshed */
 } input_item_owner_t;
 
 # define item_owner(item) ((struct input_item_owner *)(item))
@@ -26,6 +26,7 @@
 #endif
 
 #include <assert.h>
+#include <stdatomic.h>
 
 #include <vlc_common.h>
 #include <vlc_url.h>
@@ -33,6 +34,7 @@
 #include <vlc_modules.h>
 
 #include "input_internal.h"
+#include "item.h"
 #include "../preparser/art.h"
 #include <vlc_charset.h>
 
@@ -49,6 +51,7 @@ struct vlc_meta_t
     vlc_dictionary_t extra_tags;
 
     int i_status;
+    atomic_uint generation; /**< bumped before the table changes */
 };
 
 const char *vlc_meta_TypeToString(vlc_meta_type_t meta_type)
@@ -111,6 +114,7 @@ vlc_meta_t *vlc_meta_New( void )
         m->meta[i].priority = VLC_META_PRIORITY_BASIC;
     }
     m->i_status = 0;
+    atomic_init( &m->generation, 0 );
     vlc_dictionary_init( &m->extra_tags, 0 );
     return m;
 }
@@ -152,6 +156,7 @@ void vlc_meta_Delete( vlc_meta_t *m )
 
 void vlc_meta_SetWithPriority( vlc_meta_t *p_meta, vlc_meta_type_t meta_type, const char *psz_val, vlc_meta_priority_t priority )
 {
+    atomic_fetch_add_explicit( &p_meta->generation, 1, memory_order_release );
     free( p_meta->meta[meta_type].value );
     assert( psz_val == NULL || IsUTF8( psz_val ) );
     p_meta->meta[meta_type].value = psz_val ? strdup( psz_val ) : NULL;
@@ -163,6 +168,18 @@ const char *vlc_meta_Get( const vlc_meta_t *p_meta, vlc_meta_type_t meta_type )
     return p_meta->meta[meta_type].value;
 }
 
+/**
+ * Tell whether the table of meta changed, without reading it.
+ *
+ * The counter is bumped before any value of the table is replaced, the values
+ * read after a given generation are thus still current as long as the
+ * generation is unchanged.
+ */
+unsigned vlc_meta_GetGeneration( const vlc_meta_t *p_meta )
+{
+    return atomic_load_explicit( &p_meta->generation, memory_order_acquire );
+}
+
 void vlc_meta_SetExtraWithPriority( vlc_meta_t *m, const char *psz_name, const char *psz_value, vlc_meta_priority_t priority )
 {
     assert( psz_name );
@@ -214,6 +231,8 @@ void vlc_meta_Merge( vlc_meta_t *dst, const vlc_meta_t *src )
     if( !dst || !src )
         return;
 
+    atomic_fetch_add_explicit( &dst->generation, 1, memory_order_release );
+
     for( int i = 0; i < VLC_META_TYPE_COUNT; i++ )
     {
         /* overwrite metadata only when priority of src is 
@@ -260,7 +279,7 @@ void input_ExtractAttachmentAndCacheArt( input_thread_t *p_input,
     {   /* XXX Weird, we should not end up with attachment:// art URL
          * unless there is a race condition */
         msg_Warn( p_input, "art already fetched" );
-        if( likely(input_FindArtInCache( p_item ) == VLC_SUCCESS) )
+        if( likely(input_FindArtInCache( p_item, NULL ) == VLC_SUCCESS) )
             return;
     }
 
@@ -283,7 +302,8 @@ void input_ExtractAttachmentAndCacheArt( input_thread_t *p_input,
         psz_type = ".pct";
 
     input_SaveArt( VLC_OBJECT(p_input), p_item,
-                   p_attachment->p_data, p_attachment->i_data, psz_type );
+                   p_attachment->p_data, p_attachment->i_data, psz_type,
+                   NULL );
     vlc_input_attachment_Release( p_attachment );
 }
 
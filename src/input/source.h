@@ -36,6 +36,7 @@ struct input_source_t
     vlc_atomic_rc_t rc;
 
     demux_t  *p_demux; /**< Demux object (most downstream) */
+    struct input_stats_module *demux_stats; /**< Demux accounting, or NULL */
     struct vlc_input_es_out *p_slave_es_out; /**< Slave es out */
 
     char *str_id;
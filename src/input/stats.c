@@ -29,6 +29,7 @@
 
 #include <vlc_common.h>
 #include "input/input_internal.h"
+#include "misc/threads.h"
 
 /**
  * Create a statistics counter
@@ -51,13 +52,14 @@ static float stats_GetRate(const input_rate_t *rate)
         / (float)(rate->samples[0].date - rate->samples[1].date);
 }
 
-struct input_stats *input_stats_Create(void)
+struct input_stats *input_stats_Create(bool per_module)
 {
     struct input_stats *stats = malloc(sizeof (*stats));
     if (unlikely(stats == NULL))
         return NULL;
 
     input_rate_Init(&stats->input_bitrate);
+    atomic_init(&stats->input_dropped, 0);
     input_rate_Init(&stats->demux_bitrate);
     atomic_init(&stats->demux_corrupted, 0);
     atomic_init(&stats->demux_discontinuity, 0);
@@ -68,6 +70,24 @@ struct input_stats *input_stats_Create(void)
     atomic_init(&stats->displayed_pictures, 0);
     atomic_init(&stats->late_pictures, 0);
     atomic_init(&stats->lost_pictures, 0);
+    atomic_init(&stats->render_time, 0);
+    for (size_t i = 0; i < INPUT_STATS_FRAME_LATENCY_BUCKETS; i++)
+    {
+        atomic_init(&stats->frame_queue[i], 0);
+        atomic_init(&stats->frame_render[i], 0);
+        atomic_init(&stats->frame_present[i], 0);
+    }
+    atomic_init(&stats->queued_blocks, 0);
+    atomic_init(&stats->queued_bytes, 0);
+    atomic_init(&stats->dropped_blocks, 0);
+    for (size_t i = 0; i < INPUT_STATS_QUEUE_LATENCY_BUCKETS; i++)
+        atomic_init(&stats->queue_latency[i], 0);
+    atomic_init(&stats->clock_skew, 0.f);
+    atomic_init(&stats->clock_jitter, 0);
+    atomic_init(&stats->seek_latency, 0);
+    stats->per_module = per_module;
+    vlc_mutex_init(&stats->modules_lock);
+    atomic_init(&stats->module_count, 0);
     return stats;
 }
 
@@ -76,6 +96,75 @@ void input_stats_Destroy(struct input_stats *stats)
     free(stats);
 }
 
+struct input_stats_module *input_stats_GetModule(struct input_stats *stats,
+                                                 const char *kind,
+                                                 const char *name)
+{
+    if (stats == NULL || !stats->per_module || name == NULL)
+        return NULL;
+
+    struct input_stats_module *module = NULL;
+
+    vlc_mutex_lock(&stats->modules_lock);
+    size_t count = atomic_load_explicit(&stats->module_count,
+                                        memory_order_relaxed);
+    for (size_t i = 0; i < count; i++)
+        if (!strcmp(stats->modules[i].kind, kind)
+         && !strncmp(stats->modules[i].name, name,
+                     sizeof (stats->modules[i].name) - 1))
+        {
+            module = &stats->modules[i];
+            goto out;
+        }
+
+    if (count < ARRAY_SIZE(stats->modules))
+    {
+        module = &stats->modules[count];
+        strlcpy(module->kind, kind, sizeof (module->kind));
+        strlcpy(module->name, name, sizeof (module->name));
+        atomic_init(&module->cpu_time, 0);
+        atomic_init(&module->calls, 0);
+        atomic_init(&module->allocs, 0);
+        /* Publish the entry to input_stats_Compute() */
+        atomic_store_explicit(&stats->module_count, count + 1,
+                              memory_order_release);
+    }
+out:
+    vlc_mutex_unlock(&stats->modules_lock);
+    return module;
+}
+
+vlc_tick_t input_stats_ModuleStart(const struct input_stats_module *module)
+{
+    return module != NULL ? vlc_thread_cputime() : VLC_TICK_INVALID;
+}
+
+void input_stats_ModuleStop(struct input_stats_module *module, vlc_tick_t start)
+{
+    if (module == NULL)
+        return;
+
+    input_stats_ModuleAdd(module, vlc_thread_cputime() - start, 1, 0);
+}
+
+void input_stats_ModuleAdd(struct input_stats_module *module,
+                           vlc_tick_t cpu_time, uintmax_t calls,
+                           uintmax_t allocs)
+{
+    if (module == NULL)
+        return;
+
+    if (cpu_time > 0)
+        atomic_fetch_add_explicit(&module->cpu_time, cpu_time,
+                                  memory_order_relaxed);
+    if (calls > 0)
+        atomic_fetch_add_explicit(&module->calls, calls,
+                                  memory_order_relaxed);
+    if (allocs > 0)
+        atomic_fetch_add_explicit(&module->allocs, allocs,
+                                  memory_order_relaxed);
+}
+
 void input_stats_Compute(struct input_stats *stats, input_stats_t *st)
 {
     /* Input */
@@ -84,6 +173,8 @@ void input_stats_Compute(struct input_stats *stats, input_stats_t *st)
     st->i_read_bytes = stats->input_bitrate.value;
     st->f_input_bitrate = stats_GetRate(&stats->input_bitrate);
     vlc_mutex_unlock(&stats->input_bitrate.lock);
+    st->i_read_dropped = atomic_load_explicit(&stats->input_dropped,
+                                              memory_order_relaxed);
 
     vlc_mutex_lock(&stats->demux_bitrate.lock);
     st->i_demux_read_bytes = stats->demux_bitrate.value;
@@ -111,6 +202,73 @@ void input_stats_Compute(struct input_stats *stats, input_stats_t *st)
                                                     memory_order_relaxed);
     st->i_lost_pictures = atomic_load_explicit(&stats->lost_pictures,
                                                memory_order_relaxed);
+    st->i_render_time = atomic_load_explicit(&stats->render_time,
+                                             memory_order_relaxed);
+    for (size_t i = 0; i < INPUT_STATS_FRAME_LATENCY_BUCKETS; i++)
+    {
+        st->i_frame_queue[i] = atomic_load_explicit(&stats->frame_queue[i],
+                                                    memory_order_relaxed);
+        st->i_frame_render[i] = atomic_load_explicit(&stats->frame_render[i],
+                                                     memory_order_relaxed);
+        st->i_frame_present[i] = atomic_load_explicit(&stats->frame_present[i],
+                                                      memory_order_relaxed);
+    }
+
+    /* Decoder queues */
+    st->i_queued_blocks = atomic_load_explicit(&stats->queued_blocks,
+                                               memory_order_relaxed);
+    st->i_queued_bytes = atomic_load_explicit(&stats->queued_bytes,
+                                              memory_order_relaxed);
+    st->i_dropped_blocks = atomic_load_explicit(&stats->dropped_blocks,
+                                                memory_order_relaxed);
+    for (size_t i = 0; i < INPUT_STATS_QUEUE_LATENCY_BUCKETS; i++)
+        st->i_queue_latency[i] = atomic_load_explicit(&stats->queue_latency[i],
+                                                      memory_order_relaxed);
+
+    /* Input clock */
+    st->f_clock_skew = atomic_load_explicit(&stats->clock_skew,
+                                            memory_order_relaxed);
+    st->i_clock_jitter = atomic_load_explicit(&stats->clock_jitter,
+                                              memory_order_relaxed);
+
+    /* Seek */
+    st->i_seek_latency = atomic_load_explicit(&stats->seek_latency,
+                                              memory_order_relaxed);
+
+    /* Modules */
+    st->i_modules = atomic_load_explicit(&stats->module_count,
+                                         memory_order_acquire);
+    for (size_t i = 0; i < st->i_modules; i++)
+    {
+        const struct input_stats_module *module = &stats->modules[i];
+        struct input_stats_module_t *m = &st->modules[i];
+
+        strcpy(m->psz_kind, module->kind);
+        strcpy(m->psz_name, module->name);
+        m->i_cpu_time = atomic_load_explicit(&module->cpu_time,
+                                             memory_order_relaxed);
+        m->i_calls = atomic_load_explicit(&module->calls,
+                                          memory_order_relaxed);
+        m->i_allocs = atomic_load_explicit(&module->allocs,
+                                           memory_order_relaxed);
+    }
+}
+
+/**
+ * Account the time spent by a block in a decoder queue
+ */
+void input_stats_AddQueueLatency(struct input_stats *stats, vlc_tick_t latency)
+{
+    size_t i = 0;
+    vlc_tick_t bound = VLC_TICK_FROM_MS(1);
+
+    while (i < INPUT_STATS_QUEUE_LATENCY_BUCKETS - 1 && latency >= bound)
+    {
+        bound *= 4;
+        i++;
+    }
+    atomic_fetch_add_explicit(&stats->queue_latency[i], 1,
+                              memory_order_relaxed);
 }
 
 /** Update a counter element with new values
@@ -441,6 +441,22 @@ static ssize_t vlc_stream_CopyBlock(block_t **restrict pp,
     return likely(len > 0) ? (ssize_t)len : -1;
 }
 
+static block_t *vlc_stream_SplitBlock(block_t **restrict pp, size_t len)
+{
+    block_t *block = *pp;
+
+    if (block == NULL || block->i_buffer < len)
+        return NULL;
+
+    block = block_Split(pp, len);
+    if (block != NULL && (*pp)->i_buffer == 0)
+    {
+        block_Release(*pp);
+        *pp = NULL;
+    }
+    return block;
+}
+
 static ssize_t vlc_stream_ReadRaw(stream_t *s, void *buf, size_t len)
 {
     stream_priv_t *priv = stream_priv(s);
@@ -872,6 +888,19 @@ int vlc_stream_vaControl(stream_t *s, int cmd, va_list args)
                 return s->ops->get_type(s, type);
             }
             return VLC_EGENERIC;
+        case STREAM_GET_CACHE_STATS:
+            if (s->ops->stream.get_cache_stats != NULL) {
+                struct vlc_stream_cache_stats *stats =
+                    va_arg(args, struct vlc_stream_cache_stats *);
+                return s->ops->stream.get_cache_stats(s, stats);
+            }
+            return VLC_EGENERIC;
+        case STREAM_GET_DROPPED_PACKETS:
+            if (s->ops->stream.get_dropped_packets != NULL) {
+                uint64_t *dropped = va_arg(args, uint64_t *);
+                return s->ops->stream.get_dropped_packets(s, dropped);
+            }
+            return VLC_EGENERIC;
         case STREAM_GET_PRIVATE_ID_STATE:
             if (s->ops->stream.get_private_id_state != NULL) {
                 int priv_data = va_arg(args, int);
@@ -926,10 +955,45 @@ int vlc_stream_vaControl(stream_t *s, int cmd, va_list args)
  */
 block_t *vlc_stream_Block( stream_t *s, size_t size )
 {
+    stream_priv_t *priv = stream_priv(s);
+    block_t *block = NULL;
+
     if( unlikely(size > SSIZE_MAX) )
         return NULL;
 
-    block_t *block = block_Alloc( size );
+    /* Hand over a slice of the buffered block without copying, if the
+     * requested range lies entirely within it. */
+    if( size > 0 )
+    {
+        if( priv->peek != NULL )
+            block = vlc_stream_SplitBlock( &priv->peek, size );
+        else
+        {
+            if( priv->block == NULL && !vlc_killed()
+             && ((s->ops != NULL && s->ops->stream.block != NULL)
+              || (s->ops == NULL && s->pf_block != NULL)) )
+            {
+                bool eof = false;
+
+                priv->block = (s->ops != NULL ? s->ops->stream.block
+                                              : s->pf_block)( s, &eof );
+                if( priv->block == NULL && eof )
+                {
+                    priv->eof = true;
+                    return NULL;
+                }
+            }
+            block = vlc_stream_SplitBlock( &priv->block, size );
+        }
+
+        if( block != NULL )
+        {
+            priv->offset += size;
+            return block;
+        }
+    }
+
+    block = block_Alloc( size );
     if( unlikely(block == NULL) )
         return NULL;
 
@@ -95,6 +95,8 @@ static void player_on_state_changed(vlc_player_t *player,
             {
                 vlc_mutex_lock(&p_vlm->lock);
                 instance->finished = true;
+                p_media->finished = true;
+                p_vlm->finished = true;
                 vlc_mutex_unlock(&p_vlm->lock);
             }
 
@@ -148,6 +150,8 @@ vlm_t *vlm_New( libvlc_int_t *libvlc, const char *psz_vlmconf )
     vlc_cond_init( &p_vlm->wait_manage );
     p_vlm->users = 1;
     p_vlm->input_state_changed = false;
+    p_vlm->schedule_changed = false;
+    p_vlm->finished = false;
     p_vlm->exiting = false;
     p_vlm->i_id = 1;
     TAB_INIT( p_vlm->i_media, p_vlm->media );
@@ -250,8 +254,8 @@ static void* Manage( void* p_object )
     vlc_thread_set_name("vlc-vlm");
 
     vlm_t *vlm = (vlm_t*)p_object;
-    time_t lastcheck;
-    bool exiting;
+    time_t lastcheck, nextschedule = 0;
+    bool exiting = false, rescan = true;
 
     time(&lastcheck);
 
@@ -260,12 +264,17 @@ static void* Manage( void* p_object )
         char **ppsz_scheduled_commands = NULL;
         int    i_scheduled_commands = 0;
 
-        /* destroy the inputs that wants to die, and launch the next input */
+        /* destroy the inputs that wants to die, and launch the next input,
+         * only visiting the media whose instances finished */
         vlc_mutex_lock( &vlm->lock );
-        for( int i = 0; i < vlm->i_media; i++ )
+        for( int i = 0; vlm->finished && i < vlm->i_media; i++ )
         {
             vlm_media_sys_t *p_media = vlm->media[i];
 
+            if( !p_media->finished )
+                continue;
+            p_media->finished = false;
+
             for( int j = 0; j < p_media->i_instance; )
             {
                 vlm_media_instance_sys_t *p_instance = p_media->instance[j];
@@ -274,6 +283,9 @@ static void* Manage( void* p_object )
                 {
                     int i_new_input_index;
 
+                    /* handled once, even if restarting fails */
+                    p_instance->finished = false;
+
                     /* */
                     i_new_input_index = p_instance->i_index + 1;
                     if( p_media->cfg.broadcast.b_loop && i_new_input_index >= p_media->cfg.i_input )
@@ -292,12 +304,18 @@ static void* Manage( void* p_object )
                 }
             }
         }
+        vlm->finished = false;
 
-        /* scheduling */
-        time_t now, nextschedule = 0;
+        /* scheduling, the schedules are only visited when one of them is due
+         * or when they changed */
+        time_t now;
 
         time(&now);
 
+        if( !rescan && (nextschedule == 0 || now < nextschedule) )
+            goto wait;
+        nextschedule = 0;
+
         for( int i = 0; i < vlm->i_schedule; i++ )
         {
             time_t real_date = vlm->schedule[i]->date;
@@ -313,14 +331,14 @@ static void* Manage( void* p_object )
                 }
                 else if( vlm->schedule[i]->period != 0 )
                 {
-                    int j = 0;
-                    while( ((vlm->schedule[i]->date + j *
-                             vlm->schedule[i]->period) <= lastcheck) &&
-                           ( vlm->schedule[i]->i_repeat > j ||
-                             vlm->schedule[i]->i_repeat < 0 ) )
-                    {
-                        j++;
-                    }
+                    /* the first occurrence after the last check */
+                    time_t j = 0;
+                    if( vlm->schedule[i]->date <= lastcheck )
+                        j = (lastcheck - vlm->schedule[i]->date)
+                            / vlm->schedule[i]->period + 1;
+                    if( vlm->schedule[i]->i_repeat >= 0
+                     && j > vlm->schedule[i]->i_repeat )
+                        j = vlm->schedule[i]->i_repeat;
 
                     real_date = vlm->schedule[i]->date + j *
                         vlm->schedule[i]->period;
@@ -360,11 +378,13 @@ static void* Manage( void* p_object )
         }
 
         lastcheck = now;
+wait:
         vlc_mutex_unlock( &vlm->lock );
 
         vlc_mutex_lock( &vlm->lock_manage );
 
-        while( !vlm->input_state_changed && !(exiting = vlm->exiting) )
+        while( !vlm->input_state_changed && !vlm->schedule_changed
+            && !(exiting = vlm->exiting) )
         {
             if( nextschedule )
             {
@@ -377,6 +397,8 @@ static void* Manage( void* p_object )
                 vlc_cond_wait( &vlm->wait_manage, &vlm->lock_manage );
         }
         vlm->input_state_changed = false;
+        rescan = vlm->schedule_changed;
+        vlm->schedule_changed = false;
         vlc_mutex_unlock( &vlm->lock_manage );
     }
     while( !exiting );
@@ -487,6 +509,7 @@ static int vlm_ControlMediaAdd( vlm_t *p_vlm, vlm_media_t *p_cfg, int64_t *p_id
     /* FIXME do we do something here if enabled is true ? */
 
     TAB_INIT( p_media->i_instance, p_media->instance );
+    p_media->finished = false;
 
     /* */
     TAB_APPEND( p_vlm->i_media, p_vlm->media, p_media );
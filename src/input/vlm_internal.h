@@ -50,6 +50,7 @@ typedef struct
     /* actual input instances */
     int                      i_instance;
     vlm_media_instance_sys_t **instance;
+    bool finished; /* one of the instances finished */
 } vlm_media_sys_t;
 
 typedef struct
@@ -84,7 +85,10 @@ struct vlm_t
 
     /* tell vlm thread there is work to do */
     bool         input_state_changed;
+    bool         schedule_changed;
     bool         exiting;
+    /* one of the media has finished instances, protected by lock */
+    bool         finished;
     /* */
     int64_t        i_id;
 
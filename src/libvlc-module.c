@@ -109,6 +109,12 @@ static const char *const ppsz_snap_formats[] =
     "This enables colorization of the messages sent to the console. " \
     "Your terminal needs Linux color support for this to work.")
 
+#define LOG_ASYNC_TEXT N_("Asynchronous logging")
+#define LOG_ASYNC_LONGTEXT N_( \
+    "Pass log messages to the logger modules from a background thread, " \
+    "so that verbose logging does not delay the threads emitting messages. " \
+    "Messages are dropped if they are emitted faster than they are logged.")
+
 #define INTERACTION_TEXT N_("Interface interaction")
 #define INTERACTION_LONGTEXT N_( \
     "When this is enabled, the interface will show a dialog box each time " \
@@ -136,6 +142,12 @@ static const char *const ppsz_snap_formats[] =
 #define ROLE_TEXT N_("Media role")
 #define ROLE_LONGTEXT N_("Media (player) role for operating system policy.")
 
+#define AUDIO_LOW_LATENCY_TEXT N_("Low latency audio output")
+#define AUDIO_LOW_LATENCY_LONGTEXT N_( \
+    "Request small buffers from the audio output and correct the audio " \
+    "drift earlier. This is meant for live monitoring and may cause " \
+    "glitches on loaded systems.")
+
 #define AUDIO_BITEXACT_TEXT N_("Enable bit-exact mode (pure mode)")
 #define AUDIO_BITEXACT_LONGTEXT N_( \
     "This will disable all audio filters, even audio converters. " \
@@ -379,13 +391,13 @@ static const char * const  ppsz_deinterlace_text[] = {
     "Deinterlace method to use for video processing.")
 static const char * const ppsz_deinterlace_mode[] = {
     "auto", "discard", "blend", "mean", "bob",
-    "linear", "x", "yadif", "yadif2x", "phosphor",
-    "ivtc"
+    "linear", "x", "yadif", "yadif2x", "bwdif", "bwdif2x",
+    "phosphor", "ivtc"
 };
 static const char * const ppsz_deinterlace_mode_text[] = {
     N_("Auto"), N_("Discard"), N_("Blend"), N_("Mean"), N_("Bob"),
-    N_("Linear"), "X", "Yadif", "Yadif (2x)", N_("Phosphor"),
-    N_("Film NTSC (IVTC)")
+    N_("Linear"), "X", "Yadif", "Yadif (2x)", "Bwdif", "Bwdif (2x)",
+    N_("Phosphor"), N_("Film NTSC (IVTC)")
 };
 
 #define DEINTERLACE_FILTER_TEXT N_("Deinterlace filter")
@@ -532,6 +544,13 @@ static const char *const fit_descriptions[] = {
     "This drops frames that are late (arrive to the video output after " \
     "their intended display date)." )
 
+#define DISPLAY_PACING_TEXT N_("Align frames on display refreshes")
+#define DISPLAY_PACING_LONGTEXT N_( \
+    "When the video output reports when frames reach the screen, this " \
+    "schedules each frame for the closest display refresh, which avoids " \
+    "irregular frame durations. It has no effect with variable refresh " \
+    "rates." )
+
 #define KEYBOARD_EVENTS_TEXT N_("Key press events")
 #define KEYBOARD_EVENTS_LONGTEXT N_( \
     "This enables VLC hotkeys from the (non-embedded) video window." )
@@ -582,6 +601,13 @@ static const char *const fit_descriptions[] = {
     "This defines the maximum input delay jitter that the synchronization " \
     "algorithms should try to compensate (in milliseconds)." )
 
+#define CLOCK_JITTER_TOLERANCE_TEXT N_("Clock jitter tolerance")
+#define CLOCK_JITTER_TOLERANCE_LONGTEXT N_( \
+    "When estimating the drift of a network source clock, the periods " \
+    "where all the clock references arrive later than this (in " \
+    "milliseconds) are considered as congestion and ignored. 0 uses all " \
+    "the periods." )
+
 #define CLOCK_MASTER_TEXT N_("Clock master source")
 #define CLOCK_MASTER_LONGTEXT N_( "Select the clock master source:\n" \
     "auto: best clock source, input if the access can't be paced " \
@@ -916,6 +942,11 @@ static const char* const ppsz_restore_playback_desc[] = {
 #define TIMEOUT_LONGTEXT N_( \
     "Default TCP connection timeout (in milliseconds)." )
 
+#define DNS_CACHE_TEXT N_("Host name resolution cache lifetime")
+#define DNS_CACHE_LONGTEXT N_( \
+    "Time during which the addresses a host name resolves to are kept " \
+    "to be reused by later connections (in seconds). 0 disables the cache.")
+
 #define HTTP_HOST_TEXT N_( "HTTP server address" )
 #define HOST_LONGTEXT N_( \
     "By default, the server will listen on any local IP address. " \
@@ -951,6 +982,21 @@ static const char* const ppsz_restore_playback_desc[] = {
     "However allocation of port numbers below 1025 is usually restricted " \
     "by the operating system." )
 
+#define HTTP_WORKERS_TEXT N_("HTTP server threads")
+#define HTTP_WORKERS_LONGTEXT N_( \
+    "Number of threads serving the clients of a HTTP, HTTPS or RTSP " \
+    "server (0 to choose from the number of CPUs)." )
+
+#define HTTP_MAX_CLIENTS_TEXT N_("HTTP server maximum clients")
+#define HTTP_MAX_CLIENTS_LONGTEXT N_( \
+    "New connections are refused once this number of clients is " \
+    "connected to a server (0 for no limit)." )
+
+#define HTTP_IDLE_TIMEOUT_TEXT N_("HTTP server idle timeout")
+#define HTTP_IDLE_TIMEOUT_LONGTEXT N_( \
+    "Idle HTTP and HTTPS connections are closed after this delay " \
+    "(in seconds, 0 to keep them open)." )
+
 #define HTTP_CERT_TEXT N_("HTTP/TLS server certificate")
 #define CERT_LONGTEXT N_( \
    "This X.509 certificate file (PEM format) is used for server-side TLS. " \
@@ -1035,6 +1081,20 @@ static const char* const ppsz_restore_playback_desc[] = {
 #define DEC_DEV_TEXT N_("Preferred decoder hardware device")
 #define DEC_DEV_LONGTEXT N_("This allows hardware decoding when available.")
 
+#define DEC_QUEUE_SIZE_TEXT N_("Decoder queue size limit (MiB)")
+#define DEC_QUEUE_SIZE_LONGTEXT N_( \
+    "Maximum amount of data waiting in the queue of a decoder." )
+
+#define DEC_QUEUE_DURATION_TEXT N_("Decoder queue duration limit (ms)")
+#define DEC_QUEUE_DURATION_LONGTEXT N_( \
+    "Maximum duration of the data waiting in the queue of a decoder, " \
+    "0 for no limit." )
+
+#define DEC_QUEUE_THROTTLE_TEXT N_("Throttle the input on full decoder queues")
+#define DEC_QUEUE_THROTTLE_LONGTEXT N_( \
+    "When a decoder queue reaches its size or duration limit, make the " \
+    "input wait for the decoder instead of discarding the queued data." )
+
 /*****************************************************************************
  * Sout
  ****************************************************************************/
@@ -1143,6 +1203,11 @@ static const char* const ppsz_restore_playback_desc[] = {
 #define STATS_LONGTEXT N_( \
      "Collect miscellaneous local statistics about the playing media.")
 
+#define STATS_MODULES_TEXT N_("Per-module statistics")
+#define STATS_MODULES_LONGTEXT N_( \
+     "Account the CPU time and the buffer allocations of each module of " \
+     "the playback pipeline. This has a small cost on every decoded frame.")
+
 #define STATSFREQ_TEXT N_("Statistics collection frequency")
 #define STATSFREQ_LONGTEXT N_( \
      "Collection frequency of the statistics in ms.")
@@ -1171,6 +1236,12 @@ static const char* const ppsz_restore_playback_desc[] = {
     "all the processor time and render the whole system unresponsive which " \
     "might require a reboot of your machine.")
 
+#define FRAME_POOL_TEXT N_("Recycle data frames")
+#define FRAME_POOL_LONGTEXT N_( \
+    "Keep released data frames on per-size free lists and reuse them for " \
+    "later allocations. This reduces memory allocator overhead with many " \
+    "concurrent inputs, at the cost of some memory kept in reserve.")
+
 #define CLOCK_SOURCE_TEXT N_("Clock source")
 #ifdef _WIN32
 static const char *const clock_sources[] = {
@@ -1284,6 +1355,11 @@ static const char *const psz_recursive_list_text[] = {
 #define SP_LONGTEXT N_( \
     "Pause each item in the playlist on the first frame." )
 
+#define GAPLESS_PRELOAD_TEXT N_("Preload the next item")
+#define GAPLESS_PRELOAD_LONGTEXT N_( \
+    "Open the next item of the playlist this many milliseconds before the " \
+    "current one ends, so that it starts without a gap (0 to disable)." )
+
 #define AUTOSTART_TEXT N_( "Auto start" )
 #define AUTOSTART_LONGTEXT N_( "Automatically start playing the playlist " \
                 "content once it's loaded." )
@@ -1651,6 +1727,8 @@ vlc_module_begin ()
         change_short('A')
     add_string( "role", "video", ROLE_TEXT, ROLE_LONGTEXT )
         change_string_list( ppsz_roles, ppsz_roles_text )
+    add_bool( "audio-low-latency", false, AUDIO_LOW_LATENCY_TEXT,
+              AUDIO_LOW_LATENCY_LONGTEXT )
 
     set_subcategory( SUBCAT_AUDIO_AFILTER )
         add_bool( "audio-bitexact", false, AUDIO_BITEXACT_TEXT,
@@ -1684,6 +1762,8 @@ vlc_module_begin ()
         change_private ()
     add_bool( "drop-late-frames", true, DROP_LATE_FRAMES_TEXT,
               DROP_LATE_FRAMES_LONGTEXT )
+    add_bool( "display-pacing", true, DISPLAY_PACING_TEXT,
+              DISPLAY_PACING_LONGTEXT )
     /* Used in vout_synchro */
     add_obsolete_bool( "skip-frames" ) /* since 4.0.0 */
     add_obsolete_bool( "quiet-synchro" ) /* since 4.0.0 */
@@ -1939,6 +2019,8 @@ vlc_module_begin ()
     add_integer( "ipv4-timeout", 5 * 1000, TIMEOUT_TEXT,
                  TIMEOUT_LONGTEXT )
         change_integer_range( 0, INT_MAX )
+    add_integer( "dns-cache-ttl", 60, DNS_CACHE_TEXT, DNS_CACHE_LONGTEXT )
+        change_integer_range( 0, 86400 )
 
     add_string( "http-host", NULL, HTTP_HOST_TEXT, HOST_LONGTEXT )
     add_integer( "http-port", 8080, HTTP_PORT_TEXT, HTTP_PORT_LONGTEXT )
@@ -1948,6 +2030,15 @@ vlc_module_begin ()
     add_string( "rtsp-host", NULL, RTSP_HOST_TEXT, RTSP_HOST_LONGTEXT )
     add_integer( "rtsp-port", 554, RTSP_PORT_TEXT, RTSP_PORT_LONGTEXT )
         change_integer_range( 1, 65535 )
+    add_integer( "http-workers", 0, HTTP_WORKERS_TEXT,
+                 HTTP_WORKERS_LONGTEXT )
+        change_integer_range( 0, 16 )
+    add_integer( "http-max-clients", 0, HTTP_MAX_CLIENTS_TEXT,
+                 HTTP_MAX_CLIENTS_LONGTEXT )
+        change_integer_range( 0, INT_MAX )
+    add_integer( "http-idle-timeout", 10, HTTP_IDLE_TIMEOUT_TEXT,
+                 HTTP_IDLE_TIMEOUT_LONGTEXT )
+        change_integer_range( 0, 86400 )
     add_loadfile("http-cert", NULL, HTTP_CERT_TEXT, CERT_LONGTEXT)
     add_loadfile("http-key", NULL, HTTP_KEY_TEXT, KEY_LONGTEXT)
     add_obsolete_string( "http-ca" ) /* since 3.0.0 */
@@ -2025,6 +2116,10 @@ vlc_module_begin ()
     add_integer( "clock-jitter", 5000, CLOCK_JITTER_TEXT,
               CLOCK_JITTER_LONGTEXT )
         change_safe()
+    add_integer( "clock-jitter-tolerance", 20, CLOCK_JITTER_TOLERANCE_TEXT,
+                 CLOCK_JITTER_TOLERANCE_LONGTEXT )
+        change_integer_range( 0, 1000 )
+        change_safe()
     add_string( "clock-master", "auto",
                  CLOCK_MASTER_TEXT, CLOCK_MASTER_LONGTEXT )
         change_string_list( ppsz_clock_master_values, ppsz_clock_master_descriptions )
@@ -2059,6 +2154,13 @@ vlc_module_begin ()
     add_bool( "hw-dec", true, HW_DEC_TEXT, HW_DEC_LONGTEXT )
     add_obsolete_string( "encoder" ) /* since 4.0.0 */
     add_module("dec-dev", "decoder device", "any", DEC_DEV_TEXT, DEC_DEV_LONGTEXT)
+    add_integer_with_range( "decoder-queue-size", 400, 1, 4096,
+                            DEC_QUEUE_SIZE_TEXT, DEC_QUEUE_SIZE_LONGTEXT )
+    add_integer_with_range( "decoder-queue-duration", 0, 0, 3600000,
+                            DEC_QUEUE_DURATION_TEXT,
+                            DEC_QUEUE_DURATION_LONGTEXT )
+    add_bool( "decoder-queue-throttle", false, DEC_QUEUE_THROTTLE_TEXT,
+              DEC_QUEUE_THROTTLE_LONGTEXT )
 
     //set_subcategory( SUBCAT_INPUT_SCODEC )
     set_subcategory( SUBCAT_INPUT_STREAM_FILTER )
@@ -2127,6 +2229,8 @@ vlc_module_begin ()
 
     set_section( N_("Performance options"), NULL )
 
+    add_bool( "frame-pool", false, FRAME_POOL_TEXT, FRAME_POOL_LONGTEXT )
+
 #if defined (LIBVLC_USE_PTHREAD)
     add_obsolete_bool( "rt-priority" ) /* since 4.0.0 */
     add_obsolete_integer( "rt-offset" ) /* since 4.0.0 */
@@ -2164,6 +2268,8 @@ vlc_module_begin ()
     add_bool( "play-and-pause", false, PAP_TEXT, PAP_LONGTEXT )
         change_safe()
     add_bool( "start-paused", false, SP_TEXT, SP_LONGTEXT )
+    add_integer( "gapless-preload", 0, GAPLESS_PRELOAD_TEXT,
+                 GAPLESS_PRELOAD_LONGTEXT )
     add_bool( "playlist-autostart", true,
               AUTOSTART_TEXT, AUTOSTART_LONGTEXT )
     add_bool( "playlist-cork", true, CORK_TEXT, CORK_LONGTEXT )
@@ -2253,11 +2359,14 @@ vlc_module_begin ()
 #endif
 
     add_bool( "color", true, COLOR_TEXT, COLOR_LONGTEXT )
+    add_bool( "log-async", false, LOG_ASYNC_TEXT, LOG_ASYNC_LONGTEXT )
     add_obsolete_bool( "advanced" ) /* since 4.0.0 */
     add_bool( "interact", true, INTERACTION_TEXT,
               INTERACTION_LONGTEXT )
 
     add_bool ( "stats", true, STATS_TEXT, STATS_LONGTEXT )
+    add_bool( "stats-modules", false, STATS_MODULES_TEXT,
+              STATS_MODULES_LONGTEXT )
     add_integer( "stats-min-report-interval", 250,
                         STATSFREQ_TEXT, STATSFREQ_LONGTEXT );
         change_integer_range( 0, INT32_MAX )
@@ -63,6 +63,7 @@
 #include <vlc_modules.h>
 #include <vlc_media_library.h>
 #include <vlc_tracer.h>
+#include <vlc_executor.h>
 #include "player/player.h"
 
 #include "libvlc.h"
@@ -96,6 +97,9 @@ libvlc_int_t * libvlc_InternalCreate( void )
     priv->main_playlist = NULL;
     priv->p_vlm = NULL;
     priv->media_source_provider = NULL;
+    priv->snapshot_executor = NULL;
+    priv->frame_pool = false;
+    priv->gai_cache = false;
 
     vlc_ExitInit( &priv->exit );
 
@@ -119,6 +123,21 @@ static void libvlc_AddInterfaces(libvlc_int_t *libvlc, const char *varname)
     free(str);
 }
 
+/**
+ * Logs the duration of a startup phase.
+ *
+ * \param last date of the end of the previous phase [IN/OUT]
+ */
+static void StartupPhase(libvlc_int_t *p_libvlc, vlc_tick_t *last,
+                         const char *phase)
+{
+    vlc_tick_t now = vlc_tick_now();
+
+    msg_Dbg(p_libvlc, "startup: %s took %"PRId64" us", phase,
+            US_FROM_VLC_TICK(now - *last));
+    *last = now;
+}
+
 /**
  * Initialize a libvlc instance
  * This function initializes a previously allocated libvlc instance:
@@ -133,6 +152,8 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
     libvlc_priv_t *priv = libvlc_priv (p_libvlc);
     char        *psz_val;
     int          i_ret = VLC_EGENERIC;
+    const vlc_tick_t start = vlc_tick_now();
+    vlc_tick_t last = start;
 
     if (unlikely(vlc_LogPreinit(p_libvlc)))
         return VLC_ENOMEM;
@@ -152,6 +173,7 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
     config_CmdLineEarlyScan( p_libvlc, i_argc, ppsz_argv );
 
     vlc_threads_setup (p_libvlc);
+    StartupPhase(p_libvlc, &last, "core initialization");
 
     /*
      * Load plugin data into the module bank.
@@ -160,6 +182,7 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
      * saved settings handling can function properly.
      */
     module_LoadPlugins (p_libvlc);
+    StartupPhase(p_libvlc, &last, "plug-ins loading");
 
     /*
      * Fully process command line settings.
@@ -179,6 +202,7 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
         else
             config_LoadConfigFile( p_libvlc );
     }
+    StartupPhase(p_libvlc, &last, "configuration parsing");
 
     vlc_LogInit(p_libvlc);
 
@@ -186,6 +210,13 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
     priv->tracer = vlc_tracer_Create(VLC_OBJECT(p_libvlc), tracer_name);
     free(tracer_name);
 
+    priv->frame_pool = var_InheritBool(p_libvlc, "frame-pool");
+    if (priv->frame_pool)
+        vlc_frame_pool_Init();
+    vlc_getaddrinfo_cache_Init(p_libvlc);
+    priv->gai_cache = true;
+    StartupPhase(p_libvlc, &last, "logger and tracer loading");
+
     /*
      * Support for gettext
      */
@@ -234,6 +265,7 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
     priv->media_source_provider = vlc_media_source_provider_New( VLC_OBJECT( p_libvlc ) );
     if( !priv->media_source_provider )
         goto error;
+    StartupPhase(p_libvlc, &last, "core services initialization");
 
     /* variables for signalling creation of new files */
     var_Create( p_libvlc, "snapshot-file", VLC_VAR_STRING );
@@ -280,6 +312,7 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
      */
     libvlc_AddInterfaces(p_libvlc, "extraintf");
     libvlc_AddInterfaces(p_libvlc, "control");
+    StartupPhase(p_libvlc, &last, "interfaces loading");
 
 #ifdef __APPLE__
     var_Create( p_libvlc, "drawable-view-top", VLC_VAR_INTEGER );
@@ -324,6 +357,8 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
     /* Create a variable for showing the main interface */
     var_Create(p_libvlc, "intf-show", VLC_VAR_VOID);
 
+    msg_Dbg(p_libvlc, "startup: total %"PRId64" us",
+            US_FROM_VLC_TICK(vlc_tick_now() - start));
     return VLC_SUCCESS;
 
 error:
@@ -372,6 +407,12 @@ void libvlc_InternalCleanup( libvlc_int_t *p_libvlc )
     if( priv->media_source_provider )
         vlc_media_source_provider_Delete( priv->media_source_provider );
 
+    if( priv->snapshot_executor )
+    {
+        vlc_executor_WaitIdle( priv->snapshot_executor );
+        vlc_executor_Delete( priv->snapshot_executor );
+    }
+
     libvlc_InternalDialogClean( p_libvlc );
     libvlc_InternalKeystoreClean( p_libvlc );
     libvlc_InternalActionsClean( p_libvlc );
@@ -380,6 +421,12 @@ void libvlc_InternalCleanup( libvlc_int_t *p_libvlc )
     if( !var_InheritBool( p_libvlc, "ignore-config" ) )
         config_AutoSaveConfigFile( p_libvlc );
 
+    if (priv->frame_pool)
+        vlc_frame_pool_Deinit(VLC_OBJECT(p_libvlc));
+    if (priv->gai_cache)
+        vlc_getaddrinfo_cache_Deinit();
+
+    module_LogStats(VLC_OBJECT(p_libvlc));
     vlc_LogDestroy(p_libvlc->obj.logger);
     if (priv->tracer != NULL)
         vlc_tracer_Destroy(priv->tracer);
@@ -531,3 +578,21 @@ libvlc_GetMainPlaylist(libvlc_int_t *libvlc)
 
     return playlist;
 }
+
+vlc_executor_t *
+libvlc_GetSnapshotExecutor(libvlc_int_t *libvlc)
+{
+    libvlc_priv_t *priv = libvlc_priv(libvlc);
+
+    vlc_mutex_lock(&priv->lock);
+    if (priv->snapshot_executor == NULL)
+    {
+        /* Encoding is CPU bound, leave some cores to the playback */
+        unsigned threads = vlc_GetCPUCount() / 2;
+        priv->snapshot_executor = vlc_executor_New(threads > 0 ? threads : 1);
+    }
+    vlc_executor_t *executor = priv->snapshot_executor;
+    vlc_mutex_unlock(&priv->lock);
+
+    return executor;
+}
@@ -62,6 +62,36 @@ typedef struct vlc_tracer vlc_tracer_t;
 int vlc_LogPreinit(libvlc_int_t *) VLC_USED;
 void vlc_LogInit(libvlc_int_t *);
 
+/*
+ * Frame recycling pool
+ */
+void vlc_frame_pool_Init(void);
+void vlc_frame_pool_Deinit(vlc_object_t *);
+
+/*
+ * Networking
+ */
+void vlc_getaddrinfo_cache_Init(libvlc_int_t *);
+void vlc_getaddrinfo_cache_Deinit(void);
+
+struct addrinfo;
+/**
+ * Connects a socket to one of the addresses of a list.
+ *
+ * The attempts overlap as per RFC 8305 (Happy Eyeballs): the next address,
+ * alternating the address families, is tried without waiting for the
+ * previous attempt to complete after a short delay.
+ *
+ * \return a connected socket, or -1 on error.
+ */
+int net_ConnectAddrInfo(vlc_object_t *, const struct addrinfo *);
+
+/**
+ * Connects a transport layer socket with net_ConnectAddrInfo().
+ */
+struct vlc_tls *vlc_tls_SocketConnectAddrInfo(vlc_object_t *,
+                                              const struct addrinfo *);
+
 /*
  * LibVLC exit event handling
  */
@@ -187,6 +217,9 @@ typedef struct libvlc_priv_t
     vlc_actions_t *actions; ///< Hotkeys handler
     struct vlc_medialibrary_t *p_media_library; ///< Media library instance
     struct vlc_tracer *tracer; ///< Tracer callbacks
+    struct vlc_executor *snapshot_executor; ///< Snapshots encoder (or NULL)
+    bool frame_pool; ///< Whether this instance holds the frame pool
+    bool gai_cache; ///< Whether this instance holds the resolution cache
 
     /* Exit callback */
     vlc_exit_t       exit;
@@ -204,6 +237,14 @@ void intf_DestroyAll( libvlc_int_t * );
 vlc_playlist_t *
 libvlc_GetMainPlaylist(libvlc_int_t *libvlc);
 
+/**
+ * Gets the executor shared by the video outputs to encode the snapshots.
+ *
+ * It is created on first use, and lives as long as the instance.
+ */
+struct vlc_executor *
+libvlc_GetSnapshotExecutor(libvlc_int_t *libvlc);
+
 /*
  * Variables stuff
  */
@@ -99,9 +99,54 @@ services_discovery_item_removed(services_discovery_t *sd, input_item_t *media)
     }
 }
 
+static void
+services_discovery_items_added(services_discovery_t *sd, input_item_t *parent,
+                               input_item_t *const medias[], size_t count)
+{
+    vlc_media_source_t *ms = sd->owner.sys;
+    vlc_media_tree_t *tree = ms->tree;
+
+    msg_Dbg(sd, "adding %zu items", count);
+
+    vlc_media_tree_Lock(tree);
+
+    input_item_node_t *parent_node = &tree->root;
+    if (parent && !vlc_media_tree_Find(tree, parent, &parent_node, NULL))
+    {
+        vlc_media_tree_Unlock(tree);
+        msg_Err(sd, "adding items to a parent not added"); /* SD plugin bug */
+        return;
+    }
+
+    size_t added = vlc_media_tree_AddItems(tree, parent_node, medias, count);
+    if (unlikely(added < count))
+        msg_Err(sd, "could not allocate media tree nodes");
+
+    vlc_media_tree_Unlock(tree);
+}
+
+static void
+services_discovery_items_removed(services_discovery_t *sd,
+                                 input_item_t *const medias[], size_t count)
+{
+    vlc_media_source_t *ms = sd->owner.sys;
+    vlc_media_tree_t *tree = ms->tree;
+
+    msg_Dbg(sd, "removing %zu items", count);
+
+    vlc_media_tree_Lock(tree);
+    size_t removed = vlc_media_tree_RemoveItems(tree, medias, count);
+    vlc_media_tree_Unlock(tree);
+
+    if (unlikely(removed < count))
+        msg_Err(sd, "removing items not added"); /* SD plugin bug */
+}
+
 static const struct services_discovery_callbacks sd_cbs = {
     .item_added = services_discovery_item_added,
     .item_removed = services_discovery_item_removed,
+    .items_added = services_discovery_items_added,
+    .items_removed = services_discovery_items_removed,
 };
 
 static vlc_media_source_t *
@@ -25,6 +25,7 @@
 #include <vlc_media_source.h>
 
 #include <assert.h>
+#include <limits.h>
 #include <vlc_common.h>
 #include <vlc_arrays.h>
 #include <vlc_atomic.h>
@@ -293,6 +294,38 @@ vlc_media_tree_Add(vlc_media_tree_t *tree, input_item_node_t *parent,
     return node;
 }
 
+size_t
+vlc_media_tree_AddItems(vlc_media_tree_t *tree, input_item_node_t *parent,
+                        input_item_t *const medias[], size_t count)
+{
+    vlc_media_tree_AssertLocked(tree);
+
+    if (count == 0 || count > (size_t) (INT_MAX - parent->i_children))
+        return 0;
+
+    /* grow the children array once for all */
+    input_item_node_t **children =
+        vlc_reallocarray(parent->pp_children, parent->i_children + count,
+                         sizeof (*children));
+    if (unlikely(!children))
+        return 0;
+    parent->pp_children = children;
+
+    input_item_node_t **added = &children[parent->i_children];
+    size_t n = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        input_item_node_t *node = input_item_node_Create(medias[i]);
+        if (likely(node))
+            added[n++] = node;
+    }
+    parent->i_children += n;
+
+    if (n > 0)
+        vlc_media_tree_Notify(tree, on_children_added, parent, added, n);
+    return n;
+}
+
 bool
 vlc_media_tree_Find(vlc_media_tree_t *tree, const input_item_t *media,
                     input_item_node_t **result,
@@ -322,6 +355,60 @@ vlc_media_tree_Remove(vlc_media_tree_t *tree, input_item_t *media)
     return true;
 }
 
+static void
+vlc_media_tree_NotifyRemoved(vlc_media_tree_t *tree, input_item_node_t *parent,
+                             input_item_node_t **nodes, size_t count)
+{
+    if (count == 0)
+        return;
+
+    vlc_media_tree_Notify(tree, on_children_removed, parent, nodes, count);
+    for (size_t i = 0; i < count; ++i)
+        input_item_node_Delete(nodes[i]);
+}
+
+size_t
+vlc_media_tree_RemoveItems(vlc_media_tree_t *tree,
+                           input_item_t *const medias[], size_t count)
+{
+    vlc_media_tree_AssertLocked(tree);
+
+    input_item_node_t **nodes = vlc_alloc(count, sizeof (*nodes));
+    if (unlikely(!nodes))
+    {
+        size_t removed = 0;
+        for (size_t i = 0; i < count; ++i)
+            removed += vlc_media_tree_Remove(tree, medias[i]);
+        return removed;
+    }
+
+    input_item_node_t *run_parent = NULL;
+    size_t removed = 0, run = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        input_item_node_t *node;
+        input_item_node_t *parent;
+        if (!vlc_media_tree_FindNodeByMedia(&tree->root, medias[i], &node,
+                                            &parent))
+            continue;
+
+        if (parent != run_parent)
+        {
+            /* the nodes of the run are detached, but not their parent */
+            vlc_media_tree_NotifyRemoved(tree, run_parent, nodes, run);
+            run_parent = parent;
+            run = 0;
+        }
+        input_item_node_RemoveNode(parent, node);
+        nodes[run++] = node;
+        removed++;
+    }
+    vlc_media_tree_NotifyRemoved(tree, run_parent, nodes, run);
+
+    free(nodes);
+    return removed;
+}
+
 static const input_item_parser_cbs_t preparser_callbacks = {
     .on_ended = media_subtree_preparse_ended,
     .on_subtree_added = media_subtree_changed,
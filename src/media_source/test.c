@@ -264,6 +264,80 @@ static void test_media_tree_callbacks(void)
     vlc_media_tree_Release(tree);
 }
 
+static void test_media_tree_batch(void)
+{
+    struct vlc_media_tree_callbacks cbs = {
+        .on_children_added = on_children_added,
+        .on_children_removed = on_children_removed,
+    };
+
+    vlc_media_tree_t *tree = vlc_media_tree_New();
+    struct callback_ctx ctx = CALLBACK_CTX_INITIALIZER;
+    vlc_media_tree_listener_id *listener =
+            vlc_media_tree_AddListener(tree, &cbs, &ctx, false);
+    assert(listener);
+
+    vlc_media_tree_Lock(tree);
+
+    input_item_t *medias[4];
+    for (size_t i = 0; i < ARRAY_SIZE(medias); ++i)
+    {
+        medias[i] = input_item_New("vlc://item", "aaa");
+        assert(medias[i]);
+    }
+
+    size_t added = vlc_media_tree_AddItems(tree, &tree->root, medias, 3);
+    assert(added == 3);
+    assert(tree->root.i_children == 3);
+    for (size_t i = 0; i < 3; ++i)
+        assert(tree->root.pp_children[i]->p_item == medias[i]);
+
+    /* a single notification for all the items */
+    assert(ctx.vec_children_added.size == 1);
+    assert(ctx.vec_children_added.data[0].node == &tree->root);
+    assert(ctx.vec_children_added.data[0].first_media == medias[0]);
+    assert(ctx.vec_children_added.data[0].count == 3);
+
+    input_item_node_t *node = tree->root.pp_children[1];
+    added = vlc_media_tree_AddItems(tree, node, &medias[3], 1);
+    assert(added == 1);
+    assert(node->i_children == 1);
+
+    callback_ctx_reset(&ctx);
+
+    /* one notification per run of items sharing the same parent */
+    input_item_t *removed_medias[] = { medias[0], medias[2], medias[3] };
+    size_t removed = vlc_media_tree_RemoveItems(tree, removed_medias,
+                                                ARRAY_SIZE(removed_medias));
+    assert(removed == 3);
+    assert(tree->root.i_children == 1);
+    assert(tree->root.pp_children[0] == node);
+    assert(node->i_children == 0);
+
+    assert(ctx.vec_children_added.size == 0);
+    assert(ctx.vec_children_removed.size == 2);
+    assert(ctx.vec_children_removed.data[0].node == &tree->root);
+    assert(ctx.vec_children_removed.data[0].first_media == medias[0]);
+    assert(ctx.vec_children_removed.data[0].count == 2);
+    assert(ctx.vec_children_removed.data[1].node == node);
+    assert(ctx.vec_children_removed.data[1].first_media == medias[3]);
+    assert(ctx.vec_children_removed.data[1].count == 1);
+
+    /* already removed */
+    removed = vlc_media_tree_RemoveItems(tree, removed_medias, 1);
+    assert(removed == 0);
+
+    vlc_media_tree_Unlock(tree);
+
+    for (size_t i = 0; i < ARRAY_SIZE(medias); ++i)
+        input_item_Release(medias[i]);
+
+    vlc_media_tree_RemoveListener(tree, listener);
+    callback_ctx_destroy(&ctx);
+
+    vlc_media_tree_Release(tree);
+}
+
 static void
 test_media_tree_callbacks_on_add_listener(void)
 {
@@ -310,6 +384,7 @@ int main(void)
 {
     test_media_tree();
     test_media_tree_callbacks();
+    test_media_tree_batch();
     test_media_tree_callbacks_on_add_listener();
     return 0;
 }
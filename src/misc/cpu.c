@@ -157,6 +157,46 @@ unsigned vlc_CPU(void)
     return flags;
 }
 
+static struct
+{
+    vlc_mutex_t lock;
+    unsigned used;
+    unsigned users;
+} cpu_budget = { VLC_STATIC_MUTEX, 0, 0 };
+
+unsigned vlc_CPUBudgetAcquire(unsigned max)
+{
+    const unsigned total = __MAX(1, vlc_GetCPUCount());
+
+    if (max == 0 || max > total)
+        max = total;
+
+    vlc_mutex_lock(&cpu_budget.lock);
+    /* Grants are not revoked: give what is left, but at least a fair share
+     * with the current users so that the last ones are not starved */
+    unsigned left = total > cpu_budget.used ? total - cpu_budget.used : 0;
+    unsigned share = total / (cpu_budget.users + 1);
+    unsigned count = __MAX(1, __MIN(max, __MAX(left, share)));
+
+    cpu_budget.used += count;
+    cpu_budget.users++;
+    vlc_mutex_unlock(&cpu_budget.lock);
+
+    return count;
+}
+
+void vlc_CPUBudgetRelease(unsigned count)
+{
+    if (count == 0)
+        return;
+
+    vlc_mutex_lock(&cpu_budget.lock);
+    assert(cpu_budget.users > 0 && cpu_budget.used >= count);
+    cpu_budget.used -= count;
+    cpu_budget.users--;
+    vlc_mutex_unlock(&cpu_budget.lock);
+}
+
 void vlc_CPU_dump (vlc_object_t *obj)
 {
     struct vlc_memstream stream;
@@ -112,6 +112,32 @@ vlc_epg_event_t * vlc_epg_event_Duplicate( const vlc_epg_event_t *p_src )
     return p_evt;
 }
 
+static bool streq( const char *a, const char *b )
+{
+    return (a == NULL || b == NULL) ? a == b : !strcmp( a, b );
+}
+
+bool vlc_epg_event_Equals( const vlc_epg_event_t *a, const vlc_epg_event_t *b )
+{
+    if( a->i_id != b->i_id || a->i_start != b->i_start ||
+        a->i_duration != b->i_duration || a->i_rating != b->i_rating ||
+        a->i_description_items != b->i_description_items )
+        return false;
+
+    if( !streq( a->psz_name, b->psz_name ) ||
+        !streq( a->psz_short_description, b->psz_short_description ) ||
+        !streq( a->psz_description, b->psz_description ) )
+        return false;
+
+    for( int i = 0; i < a->i_description_items; i++ )
+        if( !streq( a->description_items[i].psz_key,
+                    b->description_items[i].psz_key ) ||
+            !streq( a->description_items[i].psz_value,
+                    b->description_items[i].psz_value ) )
+            return false;
+    return true;
+}
+
 static void vlc_epg_Init( vlc_epg_t *p_epg, uint32_t i_id, uint16_t i_source_id )
 {
     p_epg->i_id = i_id;
@@ -29,17 +29,21 @@
 #include <vlc_threads.h>
 #include "../libvlc.h"
 
+#define PRIORITY_COUNT (VLC_EXECUTOR_PRIORITY_HIGH + 1)
+
+typedef struct vlc_executor_group vlc_executor_group_t;
+
 /**
  * An executor can spawn several threads.
  *
  * This structure contains the data specific to one thread.
  */
 struct vlc_executor_thread {
-    /** Node of vlc_executor.threads list */
+    /** Node of vlc_executor_group.threads list */
     struct vlc_list node;
 
-    /** The executor owning the thread */
-    vlc_executor_t *owner;
+    /** The executor group owning the thread */
+    vlc_executor_group_t *owner;
 
     /** The system thread */
     vlc_thread_t thread;
@@ -49,13 +53,12 @@ struct vlc_executor_thread {
 };
 
 /**
- * The executor (also vlc_executor_t, exposed as opaque type in the public
- * header).
+ * A set of threads shared by one or more executors.
  */
-struct vlc_executor {
+struct vlc_executor_group {
     vlc_mutex_t lock;
 
-    /** Maximum number of threads to run the tasks */
+    /** Maximum number of threads (sum of the executors maximum) */
     unsigned max_threads;
 
     /** List of active vlc_executor_thread */
@@ -64,101 +67,185 @@ struct vlc_executor {
     /** Thread count (in a separate field to quickly compare to max_threads) */
     unsigned nthreads;
 
+    /* Number of tasks requested but not finished, from all executors */
+    unsigned unfinished;
+
+    /** Executors sharing the threads, in round-robin order */
+    struct vlc_list executors;
+
+    /** Wait for a queue to be non-empty */
+    vlc_cond_t queue_wait;
+
+    /** True if the last executor has been deleted */
+    bool closing;
+};
+
+/**
+ * The executor (also vlc_executor_t, exposed as opaque type in the public
+ * header).
+ */
+struct vlc_executor {
+    /** Node of vlc_executor_group.executors list */
+    struct vlc_list node;
+
+    /** The threads executing the tasks (locked by its mutex) */
+    vlc_executor_group_t *group;
+
+    /** Maximum number of tasks from this executor running concurrently */
+    unsigned max_threads;
+
     /* Number of tasks requested but not finished. */
     unsigned unfinished;
 
     /** Wait for the executor to be idle (i.e. unfinished == 0) */
     vlc_cond_t idle_wait;
 
-    /** Queue of vlc_runnable */
-    struct vlc_list queue;
+    /** Queues of vlc_runnable, by priority */
+    struct vlc_list queues[PRIORITY_COUNT];
 
-    /** Wait for the queue to be non-empty */
-    vlc_cond_t queue_wait;
+    struct vlc_executor_stats stats;
 
     /** True if executor deletion is requested */
     bool closing;
 };
 
 static void
-QueuePush(vlc_executor_t *executor, struct vlc_runnable *runnable)
+QueuePush(vlc_executor_t *executor, struct vlc_runnable *runnable,
+          enum vlc_executor_priority priority)
 {
-    vlc_mutex_assert(&executor->lock);
+    vlc_executor_group_t *group = executor->group;
+    vlc_mutex_assert(&group->lock);
+
+    assert((unsigned)priority < PRIORITY_COUNT);
+    runnable->submitted = vlc_tick_now();
+    vlc_list_append(&runnable->node, &executor->queues[priority]);
 
-    vlc_list_append(&runnable->node, &executor->queue);
-    vlc_cond_signal(&executor->queue_wait);
+    if (++executor->stats.queued > executor->stats.max_queued)
+        executor->stats.max_queued = executor->stats.queued;
+
+    if (executor->stats.running < executor->max_threads)
+        vlc_cond_signal(&group->queue_wait);
+}
+
+static struct vlc_runnable *
+QueueFind(vlc_executor_group_t *group, vlc_executor_t **owner)
+{
+    vlc_mutex_assert(&group->lock);
+
+    for (int prio = PRIORITY_COUNT - 1; prio >= 0; prio--)
+    {
+        vlc_executor_t *executor;
+        vlc_list_foreach(executor, &group->executors, node)
+        {
+            if (executor->stats.running >= executor->max_threads)
+                continue;
+
+            struct vlc_runnable *runnable =
+                vlc_list_first_entry_or_null(&executor->queues[prio],
+                                             struct vlc_runnable, node);
+            if (runnable != NULL)
+            {
+                /* Round-robin: serve the other executors first next time */
+                vlc_list_remove(&executor->node);
+                vlc_list_append(&executor->node, &group->executors);
+                *owner = executor;
+                return runnable;
+            }
+        }
+    }
+
+    return NULL;
 }
 
 static struct vlc_runnable *
-QueueTake(vlc_executor_t *executor)
+QueueTake(vlc_executor_group_t *group, vlc_executor_t **owner)
 {
-    vlc_mutex_assert(&executor->lock);
+    vlc_mutex_assert(&group->lock);
 
-    while (!executor->closing && vlc_list_is_empty(&executor->queue))
-        vlc_cond_wait(&executor->queue_wait, &executor->lock);
+    struct vlc_runnable *runnable;
+    while (!group->closing && (runnable = QueueFind(group, owner)) == NULL)
+        vlc_cond_wait(&group->queue_wait, &group->lock);
 
-    if (executor->closing)
+    if (group->closing)
         return NULL;
 
-    struct vlc_runnable *runnable =
-        vlc_list_first_entry_or_null(&executor->queue, struct vlc_runnable,
-                                     node);
-    assert(runnable);
+    vlc_executor_t *executor = *owner;
     vlc_list_remove(&runnable->node);
 
     /* Set links to NULL to know that it has been taken by a thread in
      * vlc_executor_Cancel() */
     runnable->node.prev = runnable->node.next = NULL;
 
+    vlc_tick_t wait = vlc_tick_now() - runnable->submitted;
+    executor->stats.total_wait += wait;
+    if (wait > executor->stats.max_wait)
+        executor->stats.max_wait = wait;
+    executor->stats.queued--;
+    executor->stats.running++;
+    executor->stats.started++;
+
     return runnable;
 }
 
+static void
+TaskEnded(vlc_executor_t *executor)
+{
+    vlc_executor_group_t *group = executor->group;
+    vlc_mutex_assert(&group->lock);
+
+    assert(executor->unfinished > 0);
+    assert(group->unfinished > 0);
+    --group->unfinished;
+    if (!--executor->unfinished)
+        vlc_cond_broadcast(&executor->idle_wait);
+}
+
 static void *
 ThreadRun(void *userdata)
 {
     struct vlc_executor_thread *thread = userdata;
-    vlc_executor_t *executor = thread->owner;
+    vlc_executor_group_t *group = thread->owner;
 
     vlc_thread_set_name("vlc-exec-runner");
 
-    vlc_mutex_lock(&executor->lock);
+    vlc_mutex_lock(&group->lock);
 
     struct vlc_runnable *runnable;
-    /* When the executor is closing, QueueTake() returns NULL */
-    while ((runnable = QueueTake(executor)))
+    vlc_executor_t *executor;
+    /* When the group is closing, QueueTake() returns NULL */
+    while ((runnable = QueueTake(group, &executor)))
     {
         thread->current_task = runnable;
-        vlc_mutex_unlock(&executor->lock);
+        vlc_mutex_unlock(&group->lock);
 
         /* Execute the user-provided runnable, without the executor lock */
         runnable->run(runnable->userdata);
 
-        vlc_mutex_lock(&executor->lock);
+        vlc_mutex_lock(&group->lock);
         thread->current_task = NULL;
 
         vlc_thread_set_name("vlc-exec-runner");
 
-        assert(executor->unfinished > 0);
-        --executor->unfinished;
-        if (!executor->unfinished)
-            vlc_cond_signal(&executor->idle_wait);
+        assert(executor->stats.running > 0);
+        executor->stats.running--;
+        TaskEnded(executor);
     }
 
-    vlc_mutex_unlock(&executor->lock);
+    vlc_mutex_unlock(&group->lock);
 
     return NULL;
 }
 
 static int
-SpawnThread(vlc_executor_t *executor)
+SpawnThread(vlc_executor_group_t *group)
 {
-    assert(executor->nthreads < executor->max_threads);
+    assert(group->nthreads < group->max_threads);
 
     struct vlc_executor_thread *thread = malloc(sizeof(*thread));
     if (!thread)
         return VLC_ENOMEM;
 
-    thread->owner = executor;
+    thread->owner = group;
     thread->current_task = NULL;
 
     if (vlc_clone(&thread->thread, ThreadRun, thread))
@@ -167,66 +254,121 @@ SpawnThread(vlc_executor_t *executor)
         return VLC_EGENERIC;
     }
 
-    executor->nthreads++;
-    vlc_list_append(&thread->node, &executor->threads);
+    group->nthreads++;
+    vlc_list_append(&thread->node, &group->threads);
 
     return VLC_SUCCESS;
 }
 
-vlc_executor_t *
-vlc_executor_New(unsigned max_threads)
+static vlc_executor_t *
+ExecutorNew(vlc_executor_group_t *group, unsigned max_threads)
 {
-    assert(max_threads);
     vlc_executor_t *executor = malloc(sizeof(*executor));
     if (!executor)
         return NULL;
 
-    vlc_mutex_init(&executor->lock);
-
+    executor->group = group;
     executor->max_threads = max_threads;
-    executor->nthreads = 0;
     executor->unfinished = 0;
-
-    vlc_list_init(&executor->threads);
-    vlc_list_init(&executor->queue);
+    executor->closing = false;
 
     vlc_cond_init(&executor->idle_wait);
-    vlc_cond_init(&executor->queue_wait);
+    for (size_t i = 0; i < ARRAY_SIZE(executor->queues); i++)
+        vlc_list_init(&executor->queues[i]);
 
-    executor->closing = false;
+    executor->stats = (struct vlc_executor_stats) { 0 };
+
+    return executor;
+}
+
+vlc_executor_t *
+vlc_executor_New(unsigned max_threads)
+{
+    assert(max_threads);
+    vlc_executor_group_t *group = malloc(sizeof(*group));
+    if (!group)
+        return NULL;
+
+    vlc_mutex_init(&group->lock);
+
+    group->max_threads = max_threads;
+    group->nthreads = 0;
+    group->unfinished = 0;
+
+    vlc_list_init(&group->threads);
+    vlc_list_init(&group->executors);
+
+    vlc_cond_init(&group->queue_wait);
+
+    group->closing = false;
+
+    vlc_executor_t *executor = ExecutorNew(group, max_threads);
+    if (!executor)
+    {
+        free(group);
+        return NULL;
+    }
+    vlc_list_append(&executor->node, &group->executors);
 
     /* Create one thread on init so that vlc_executor_Submit() may never fail */
-    int ret = SpawnThread(executor);
+    int ret = SpawnThread(group);
     if (ret != VLC_SUCCESS)
     {
         free(executor);
+        free(group);
         return NULL;
     }
 
     return executor;
 }
 
+vlc_executor_t *
+vlc_executor_NewShared(vlc_executor_t *other, unsigned max_threads)
+{
+    assert(max_threads);
+    vlc_executor_group_t *group = other->group;
+
+    vlc_executor_t *executor = ExecutorNew(group, max_threads);
+    if (!executor)
+        return NULL;
+
+    vlc_mutex_lock(&group->lock);
+    assert(!group->closing);
+    group->max_threads += max_threads;
+    vlc_list_append(&executor->node, &group->executors);
+    vlc_mutex_unlock(&group->lock);
+
+    return executor;
+}
+
 void
-vlc_executor_Submit(vlc_executor_t *executor, struct vlc_runnable *runnable)
+vlc_executor_SubmitPriority(vlc_executor_t *executor,
+                            struct vlc_runnable *runnable,
+                            enum vlc_executor_priority priority)
 {
-    vlc_mutex_lock(&executor->lock);
+    vlc_executor_group_t *group = executor->group;
+
+    vlc_mutex_lock(&group->lock);
 
     assert(!executor->closing);
 
-    QueuePush(executor, runnable);
+    QueuePush(executor, runnable, priority);
 
-    if (++executor->unfinished > executor->nthreads
-            && executor->nthreads < executor->max_threads)
+    executor->unfinished++;
+    if (++group->unfinished > group->nthreads
+            && group->nthreads < group->max_threads)
         /* If it fails, this is not an error, there is at least one thread */
-        SpawnThread(executor);
+        SpawnThread(group);
 
-    vlc_mutex_unlock(&executor->lock);
+    vlc_mutex_unlock(&group->lock);
 }
 
 bool
 vlc_executor_Cancel(vlc_executor_t *executor, struct vlc_runnable *runnable)
 {
-    vlc_mutex_lock(&executor->lock);
+    vlc_executor_group_t *group = executor->group;
+
+    vlc_mutex_lock(&group->lock);
 
     /* Either both prev and next are set, either both are NULL */
     assert(!runnable->node.prev == !runnable->node.next);
@@ -236,13 +378,13 @@ vlc_executor_Cancel(vlc_executor_t *executor, struct vlc_runnable *runnable)
     {
         vlc_list_remove(&runnable->node);
 
-        assert(executor->unfinished > 0);
-        --executor->unfinished;
-        if (!executor->unfinished)
-            vlc_cond_signal(&executor->idle_wait);
+        assert(executor->stats.queued > 0);
+        executor->stats.queued--;
+        executor->stats.canceled++;
+        TaskEnded(executor);
     }
 
-    vlc_mutex_unlock(&executor->lock);
+    vlc_mutex_unlock(&group->lock);
 
     return in_queue;
 }
@@ -250,43 +392,73 @@ vlc_executor_Cancel(vlc_executor_t *executor, struct vlc_runnable *runnable)
 void
 vlc_executor_WaitIdle(vlc_executor_t *executor)
 {
-    vlc_mutex_lock(&executor->lock);
+    vlc_executor_group_t *group = executor->group;
+
+    vlc_mutex_lock(&group->lock);
     while (executor->unfinished)
-        vlc_cond_wait(&executor->idle_wait, &executor->lock);
-    vlc_mutex_unlock(&executor->lock);
+        vlc_cond_wait(&executor->idle_wait, &group->lock);
+    vlc_mutex_unlock(&group->lock);
+}
+
+void
+vlc_executor_GetStats(vlc_executor_t *executor,
+                      struct vlc_executor_stats *stats)
+{
+    vlc_executor_group_t *group = executor->group;
+
+    vlc_mutex_lock(&group->lock);
+    *stats = executor->stats;
+    vlc_mutex_unlock(&group->lock);
 }
 
 void
 vlc_executor_Delete(vlc_executor_t *executor)
 {
-    vlc_mutex_lock(&executor->lock);
+    vlc_executor_group_t *group = executor->group;
+
+    vlc_mutex_lock(&group->lock);
 
     executor->closing = true;
 
     /* All the tasks must be canceled on delete */
-    assert(vlc_list_is_empty(&executor->queue));
+    assert(executor->stats.queued == 0);
+
+    /* Wait for the running tasks to complete */
+    while (executor->unfinished)
+        vlc_cond_wait(&executor->idle_wait, &group->lock);
+
+    vlc_list_remove(&executor->node);
+    group->max_threads -= executor->max_threads;
+
+    bool last = vlc_list_is_empty(&group->executors);
+    if (last)
+    {
+        group->closing = true;
 
-    /* "closing" is now true, this will wake up threads */
-    vlc_cond_broadcast(&executor->queue_wait);
+        /* "closing" is now true, this will wake up threads */
+        vlc_cond_broadcast(&group->queue_wait);
+    }
+
+    vlc_mutex_unlock(&group->lock);
+
+    free(executor);
 
-    vlc_mutex_unlock(&executor->lock);
+    if (!last)
+        return;
 
     /* The threads list may not be written at this point, so it is safe to read
      * it without mutex locked (the mutex must be released to join the
      * threads). */
 
     struct vlc_executor_thread *thread;
-    vlc_list_foreach(thread, &executor->threads, node)
+    vlc_list_foreach(thread, &group->threads, node)
     {
         vlc_join(thread->thread, NULL);
         free(thread);
     }
 
-    /* The queue must still be empty (no runnable submitted a new runnable) */
-    assert(vlc_list_is_empty(&executor->queue));
-
-    /* There are no tasks anymore */
-    assert(!executor->unfinished);
+    /* There are no tasks anymore (no runnable submitted a new runnable) */
+    assert(!group->unfinished);
 
-    free(executor);
+    free(group);
 }
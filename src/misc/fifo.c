@@ -26,9 +26,12 @@
 #endif
 
 #include <assert.h>
+#include <stdatomic.h>
+#include <stdbit.h>
 #include <stdlib.h>
 
 #include <vlc_common.h>
+#include <vlc_atomic.h>
 #include <vlc_block.h>
 #include "../libvlc.h"
 
@@ -141,3 +144,144 @@ block_t *vlc_fifo_Show( block_fifo_t *p_fifo )
 
     return b;
 }
+
+/**
+ * Internal state for single-producer single-consumer frame rings
+ */
+struct vlc_frame_ring
+{
+    size_t mask;
+    atomic_size_t head; /**< Next slot to dequeue (written by the consumer) */
+    atomic_size_t tail; /**< Next slot to enqueue (written by the producer) */
+    atomic_size_t bytes;
+    atomic_uint seq; /**< Wake-up sequence, for vlc_atomic_wait() */
+    atomic_bool waiting; /**< Whether the consumer is (about to be) waiting */
+    vlc_frame_t *slots[];
+};
+
+static size_t vlc_frame_ChainBytes(const vlc_frame_t *frame)
+{
+    size_t bytes = 0;
+
+    for (const vlc_frame_t *f = frame; f != NULL; f = f->p_next)
+        bytes += f->i_buffer;
+    return bytes;
+}
+
+vlc_frame_ring_t *vlc_frame_ring_New(size_t capacity)
+{
+    if (capacity == 0)
+        capacity = 1;
+    if (unlikely(capacity > (SIZE_MAX / 2) / sizeof (vlc_frame_t *)))
+        return NULL;
+    capacity = stdc_bit_ceil(capacity);
+
+    vlc_frame_ring_t *ring = malloc(sizeof (*ring)
+                                    + capacity * sizeof (ring->slots[0]));
+    if (unlikely(ring == NULL))
+        return NULL;
+
+    ring->mask = capacity - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->bytes, 0);
+    atomic_init(&ring->seq, 0);
+    atomic_init(&ring->waiting, false);
+    return ring;
+}
+
+void vlc_frame_ring_Delete(vlc_frame_ring_t *ring)
+{
+    vlc_frame_t *frames[16];
+    size_t count;
+
+    while ((count = vlc_frame_ring_Dequeue(ring, frames,
+                                           ARRAY_SIZE(frames))) > 0)
+        for (size_t i = 0; i < count; i++)
+            vlc_frame_ChainRelease(frames[i]);
+    free(ring);
+}
+
+size_t vlc_frame_ring_Enqueue(vlc_frame_ring_t *ring,
+                              vlc_frame_t *const *frames, size_t count)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    size_t room = ring->mask + 1 - (tail - head);
+    size_t bytes = 0;
+
+    if (count > room)
+        count = room;
+    if (count == 0)
+        return 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        ring->slots[(tail + i) & ring->mask] = frames[i];
+        bytes += vlc_frame_ChainBytes(frames[i]);
+    }
+
+    atomic_fetch_add_explicit(&ring->bytes, bytes, memory_order_relaxed);
+    /* Sequentially consistent: pairs with the consumer in
+     * vlc_frame_ring_Wait(), so that either side sees the other. */
+    atomic_store(&ring->tail, tail + count);
+
+    if (atomic_load(&ring->waiting))
+        vlc_frame_ring_Signal(ring);
+    return count;
+}
+
+size_t vlc_frame_ring_Dequeue(vlc_frame_ring_t *ring,
+                              vlc_frame_t **frames, size_t max)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    size_t count = tail - head;
+    size_t bytes = 0;
+
+    if (count > max)
+        count = max;
+    if (count == 0)
+        return 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        frames[i] = ring->slots[(head + i) & ring->mask];
+        bytes += vlc_frame_ChainBytes(frames[i]);
+    }
+
+    assert(atomic_load_explicit(&ring->bytes, memory_order_relaxed) >= bytes);
+    atomic_fetch_sub_explicit(&ring->bytes, bytes, memory_order_relaxed);
+    atomic_store_explicit(&ring->head, head + count, memory_order_release);
+    return count;
+}
+
+void vlc_frame_ring_Wait(vlc_frame_ring_t *ring)
+{
+    unsigned seq = atomic_load(&ring->seq);
+
+    atomic_store(&ring->waiting, true);
+    if (atomic_load(&ring->tail) == atomic_load_explicit(&ring->head,
+                                                         memory_order_relaxed))
+        vlc_atomic_wait(&ring->seq, seq);
+    atomic_store_explicit(&ring->waiting, false, memory_order_relaxed);
+}
+
+void vlc_frame_ring_Signal(vlc_frame_ring_t *ring)
+{
+    atomic_fetch_add(&ring->seq, 1);
+    vlc_atomic_notify_one(&ring->seq);
+}
+
+size_t vlc_frame_ring_GetCount(const vlc_frame_ring_t *ring)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    return tail - head;
+}
+
+size_t vlc_frame_ring_GetBytes(const vlc_frame_ring_t *ring)
+{
+    return atomic_load_explicit(&ring->bytes, memory_order_relaxed);
+}
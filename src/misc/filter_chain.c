@@ -124,6 +124,7 @@ typedef struct chained_filter_t
     struct vlc_list node;
     vlc_mouse_t mouse;
     vlc_picture_chain_t pending;
+    picture_t *in_place; /**< Input picture the filter may write over */
 } chained_filter_t;
 
 /* */
@@ -175,13 +176,38 @@ filter_chain_t *filter_chain_NewSPU( vlc_object_t *obj, const char *cap )
     return filter_chain_NewInner( obj, cap, NULL, false, SPU_ES );
 }
 
+/**
+ * Checks if the input picture of a filter can be used as its output picture:
+ * nobody else may see the input pixels change, and the picture must have the
+ * output format.
+ */
+static bool filter_chain_CanReuse( const filter_t *filter, picture_t *pic )
+{
+    const video_format_t *fmt = &filter->fmt_out.video;
+
+    return vlc_atomic_rc_get( &pic->refs ) == 1 && pic->context == NULL
+        && pic->format.i_chroma == fmt->i_chroma
+        && pic->format.i_width == fmt->i_width
+        && pic->format.i_height == fmt->i_height;
+}
+
 /** Chained filter picture allocator function */
 static picture_t *filter_chain_VideoBufferNew( filter_t *filter )
 {
     picture_t *pic;
     chained_filter_t *chained = container_of(filter, chained_filter_t, filter);
     filter_chain_t *chain = filter->owner.sys;
-    if( !vlc_list_is_last( &chained->node, &chain->filter_list ) )
+    bool last = vlc_list_is_last( &chained->node, &chain->filter_list );
+
+    /* Only the first output picture of a call may replace the input. The
+     * owner wants the last filter output from its own allocator, if any. */
+    pic = chained->in_place;
+    chained->in_place = NULL;
+    if( pic != NULL && filter_chain_CanReuse( filter, pic )
+     && ( !last || chain->parent_video_owner.video == NULL ) )
+        return picture_Hold( pic );
+
+    if( !last )
     {
         // HACK as intermediate filters may not have the same video format as
         // the last one handled by the owner
@@ -493,7 +519,10 @@ vlc_video_context *filter_chain_GetVideoCtxOut(const filter_chain_t *p_chain)
 static picture_t *FilterSingleChainedFilter( chained_filter_t *f, picture_t *p_pic )
 {
     filter_t *p_filter = &f->filter;
+
+    f->in_place = p_filter->b_in_place ? p_pic : NULL;
     p_pic = p_filter->ops->filter_video( p_filter, p_pic );
+    f->in_place = NULL;
     if( !p_pic )
         return NULL;
 
@@ -1254,6 +1254,12 @@ static const staticentry_t p_list_video[] = {
     B(VLC_CODEC_VAAPI_420_12BPP, "4:2:0 12bits VAAPI opaque"),
         A("VAO2"),
 
+    B(VLC_CODEC_VULKAN_420, "4:2:0 Vulkan opaque"),
+        A("VKOP"),
+
+    B(VLC_CODEC_VULKAN_420_10BPP, "4:2:0 10bits Vulkan opaque"),
+        A("VKO0"),
+
     B(VLC_CODEC_ANDROID_OPAQUE, "Android opaque"),
         A("ANOP"),
 
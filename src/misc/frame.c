@@ -28,6 +28,7 @@
 #include <sys/stat.h>
 #include <assert.h>
 #include <errno.h>
+#include <stdbit.h>
 #include <unistd.h>
 #include <fcntl.h>
 #ifdef _WIN32
@@ -40,6 +41,7 @@
 #include <vlc_fs.h>
 
 #include <vlc_ancillary.h>
+#include "../libvlc.h"
 
 #ifndef NDEBUG
 static void vlc_frame_Check (vlc_frame_t *frame)
@@ -116,6 +118,218 @@ vlc_frame_t *vlc_frame_Init(vlc_frame_t *restrict f, const struct vlc_frame_call
 # define VLC_FRAME_PADDING      32 /* Avoid <= 32 bytes reallocs */
 #endif
 
+/*
+ * Recycling pool
+ *
+ * When enabled, vlc_frame_Alloc() rounds allocations up to a power-of-two
+ * size class, and frames of a given class are put back on a free list when
+ * released, instead of going back to the heap. This avoids allocator round
+ * trips (and page faults) for steady-state packet flow.
+ */
+#define VLC_FRAME_POOL_MIN_SHIFT 10 /* 1 KiB */
+#define VLC_FRAME_POOL_MAX_SHIFT 21 /* 2 MiB */
+#define VLC_FRAME_POOL_CLASSES \
+    (VLC_FRAME_POOL_MAX_SHIFT - VLC_FRAME_POOL_MIN_SHIFT + 1)
+/** Upper bound of memory kept on the free list of each size class. */
+#define VLC_FRAME_POOL_CLASS_BYTES (1 << 22)
+
+struct vlc_frame_pooled
+{
+    vlc_frame_t frame;
+    struct vlc_frame_pooled *next;
+    unsigned class;
+};
+
+struct vlc_frame_pool_class
+{
+    vlc_mutex_t lock;
+    struct vlc_frame_pooled *head;
+    size_t count;
+};
+
+static struct
+{
+    vlc_once_t once;
+    atomic_uint users;
+    atomic_size_t hits;
+    atomic_size_t misses;
+    atomic_size_t drops;
+    struct vlc_frame_pool_class classes[VLC_FRAME_POOL_CLASSES];
+} vlc_frame_pool = { .once = VLC_STATIC_ONCE };
+
+static size_t vlc_frame_pool_ClassSize(unsigned cls)
+{
+    return ((size_t)1) << (cls + VLC_FRAME_POOL_MIN_SHIFT);
+}
+
+/**
+ * Finds the size class for a given buffer capacity.
+ *
+ * \return the class index, or VLC_FRAME_POOL_CLASSES if the pool is disabled
+ * or if the capacity is too large to be recycled.
+ */
+static unsigned vlc_frame_pool_Class(size_t capacity)
+{
+    if (atomic_load_explicit(&vlc_frame_pool.users,
+                             memory_order_relaxed) == 0)
+        return VLC_FRAME_POOL_CLASSES;
+    if (capacity > vlc_frame_pool_ClassSize(VLC_FRAME_POOL_CLASSES - 1))
+        return VLC_FRAME_POOL_CLASSES;
+
+    unsigned shift = stdc_bit_width(capacity - 1);
+    if (shift < VLC_FRAME_POOL_MIN_SHIFT)
+        shift = VLC_FRAME_POOL_MIN_SHIFT;
+    return shift - VLC_FRAME_POOL_MIN_SHIFT;
+}
+
+static void vlc_frame_pool_Free(struct vlc_frame_pooled *pf)
+{
+    free(pf->frame.p_start);
+    free(pf);
+}
+
+static void vlc_frame_pool_Release(vlc_frame_t *frame)
+{
+    struct vlc_frame_pooled *pf =
+        container_of(frame, struct vlc_frame_pooled, frame);
+    struct vlc_frame_pool_class *c = &vlc_frame_pool.classes[pf->class];
+    size_t depth = VLC_FRAME_POOL_CLASS_BYTES
+                 / vlc_frame_pool_ClassSize(pf->class);
+    bool recycled = false;
+
+    vlc_mutex_lock(&c->lock);
+    if (atomic_load_explicit(&vlc_frame_pool.users, memory_order_relaxed) > 0
+     && c->count < depth)
+    {
+        pf->next = c->head;
+        c->head = pf;
+        c->count++;
+        recycled = true;
+    }
+    vlc_mutex_unlock(&c->lock);
+
+    if (!recycled)
+    {
+        atomic_fetch_add_explicit(&vlc_frame_pool.drops, 1,
+                                  memory_order_relaxed);
+        vlc_frame_pool_Free(pf);
+    }
+}
+
+static const struct vlc_frame_callbacks vlc_frame_pool_cbs =
+{
+    vlc_frame_pool_Release,
+};
+
+static vlc_frame_t *vlc_frame_pool_Get(unsigned cls)
+{
+    struct vlc_frame_pool_class *c = &vlc_frame_pool.classes[cls];
+    struct vlc_frame_pooled *pf;
+
+    vlc_mutex_lock(&c->lock);
+    pf = c->head;
+    if (pf != NULL)
+    {
+        c->head = pf->next;
+        c->count--;
+    }
+    vlc_mutex_unlock(&c->lock);
+
+    if (pf != NULL)
+    {
+        atomic_fetch_add_explicit(&vlc_frame_pool.hits, 1,
+                                  memory_order_relaxed);
+        /* Reset payload, prebody and properties to the defaults */
+        return vlc_frame_Init(&pf->frame, &vlc_frame_pool_cbs,
+                              pf->frame.p_start, pf->frame.i_size);
+    }
+
+    atomic_fetch_add_explicit(&vlc_frame_pool.misses, 1,
+                              memory_order_relaxed);
+
+    size_t capacity = vlc_frame_pool_ClassSize(cls);
+    unsigned char *buf;
+#ifdef HAVE_ALIGNED_ALLOC
+    buf = aligned_alloc(VLC_FRAME_ALIGN, capacity);
+#else
+    capacity += VLC_FRAME_ALIGN;
+    buf = malloc(capacity);
+#endif
+    if (unlikely(buf == NULL))
+        return NULL;
+
+    pf = malloc(sizeof (*pf));
+    if (unlikely(pf == NULL))
+    {
+        free(buf);
+        return NULL;
+    }
+
+    pf->class = cls;
+    return vlc_frame_Init(&pf->frame, &vlc_frame_pool_cbs, buf, capacity);
+}
+
+static void vlc_frame_pool_Setup(void *data)
+{
+    (void) data;
+
+    for (unsigned i = 0; i < VLC_FRAME_POOL_CLASSES; i++)
+    {
+        struct vlc_frame_pool_class *c = &vlc_frame_pool.classes[i];
+
+        vlc_mutex_init(&c->lock);
+        c->head = NULL;
+        c->count = 0;
+    }
+}
+
+void vlc_frame_pool_Init(void)
+{
+    vlc_once(&vlc_frame_pool.once, vlc_frame_pool_Setup, NULL);
+    atomic_fetch_add_explicit(&vlc_frame_pool.users, 1, memory_order_relaxed);
+}
+
+void vlc_frame_pool_Deinit(vlc_object_t *obj)
+{
+    if (atomic_fetch_sub_explicit(&vlc_frame_pool.users, 1,
+                                  memory_order_relaxed) != 1)
+        return;
+
+    /* Last user: drain the free lists. Frames still in flight will be
+     * returned to the heap when they are released. */
+    for (unsigned i = 0; i < VLC_FRAME_POOL_CLASSES; i++)
+    {
+        struct vlc_frame_pool_class *c = &vlc_frame_pool.classes[i];
+        struct vlc_frame_pooled *pf;
+
+        vlc_mutex_lock(&c->lock);
+        pf = c->head;
+        c->head = NULL;
+        c->count = 0;
+        vlc_mutex_unlock(&c->lock);
+
+        while (pf != NULL)
+        {
+            struct vlc_frame_pooled *next = pf->next;
+
+            vlc_frame_pool_Free(pf);
+            pf = next;
+        }
+    }
+
+    size_t hits = atomic_load_explicit(&vlc_frame_pool.hits,
+                                       memory_order_relaxed);
+    size_t misses = atomic_load_explicit(&vlc_frame_pool.misses,
+                                         memory_order_relaxed);
+    size_t drops = atomic_load_explicit(&vlc_frame_pool.drops,
+                                        memory_order_relaxed);
+    size_t total = hits + misses;
+
+    msg_Dbg(obj, "frame pool: %zu allocations, %zu recycled (%zu%%), "
+            "%zu freed on overflow", total, hits,
+            total ? (100 * hits) / total : 0, drops);
+}
+
 vlc_frame_t *vlc_frame_Alloc (size_t size)
 {
     if (unlikely(size >> 28))
@@ -129,29 +343,42 @@ vlc_frame_t *vlc_frame_Alloc (size_t size)
 
     /* 2 * VLC_FRAME_PADDING: pre + post padding */
     size_t capacity = (2 * VLC_FRAME_PADDING) + size;
+    unsigned cls = vlc_frame_pool_Class(capacity);
     unsigned char *buf;
+    vlc_frame_t *f;
+
+    if (cls < VLC_FRAME_POOL_CLASSES)
+    {
+        f = vlc_frame_pool_Get(cls);
+        if (unlikely(f == NULL))
+            return NULL;
+        buf = f->p_start;
+    }
+    else
+    {
 #ifdef HAVE_ALIGNED_ALLOC
-    capacity += (-size) % VLC_FRAME_ALIGN;
-    buf = aligned_alloc(VLC_FRAME_ALIGN, capacity);
+        capacity += (-size) % VLC_FRAME_ALIGN;
+        buf = aligned_alloc(VLC_FRAME_ALIGN, capacity);
 #else
-    capacity += VLC_FRAME_ALIGN;
-    buf = malloc(capacity);
+        capacity += VLC_FRAME_ALIGN;
+        buf = malloc(capacity);
 #endif
-    if (unlikely(buf == NULL))
-        return NULL;
+        if (unlikely(buf == NULL))
+            return NULL;
 
-    vlc_frame_t *f = vlc_frame_heap_Alloc(buf, capacity);
-    if (likely(f != NULL)) {
-#ifndef HAVE_ALIGNED_ALLOC
-        /* Alignment */
-        buf += (-(uintptr_t)(void *)buf) % (uintptr_t)VLC_FRAME_ALIGN;
-#endif
-        /* Header reserve */
-        buf += VLC_FRAME_PADDING;
-        f->p_buffer = buf;
-        f->i_buffer = size;
+        f = vlc_frame_heap_Alloc(buf, capacity);
+        if (unlikely(f == NULL))
+            return NULL;
     }
 
+#ifndef HAVE_ALIGNED_ALLOC
+    /* Alignment */
+    buf += (-(uintptr_t)(void *)buf) % (uintptr_t)VLC_FRAME_ALIGN;
+#endif
+    /* Header reserve */
+    buf += VLC_FRAME_PADDING;
+    f->p_buffer = buf;
+    f->i_buffer = size;
     return f;
 }
 
@@ -182,6 +409,8 @@ static vlc_frame_t *vlc_frame_ReallocDup( vlc_frame_t *frame, ssize_t i_prebody,
     return p_rea;
 }
 
+static bool vlc_frame_IsReadOnly(const vlc_frame_t *);
+
 vlc_frame_t *vlc_frame_TryRealloc (vlc_frame_t *frame, ssize_t i_prebody, size_t i_body)
 {
     vlc_frame_Check( frame );
@@ -218,7 +447,7 @@ vlc_frame_t *vlc_frame_TryRealloc (vlc_frame_t *frame, ssize_t i_prebody, size_t
 
     if( frame->i_buffer == 0 )
     {   /* Corner case: nothing to preserve */
-        if( requested <= frame->i_size )
+        if( requested <= frame->i_size && !vlc_frame_IsReadOnly( frame ) )
         {   /* Enough room: recycle buffer */
             size_t extra = frame->i_size - requested;
 
@@ -265,6 +494,228 @@ vlc_frame_t *vlc_frame_Realloc (vlc_frame_t *frame, ssize_t prebody, size_t body
     return rea;
 }
 
+/*
+ * Slices
+ *
+ * A split frame is moved behind a reference-counted holder, and each part is
+ * a slice frame referring to a disjoint range of the same buffer.
+ *
+ * Shared frames use the same holder, but their slices refer to the same
+ * range and are read-only: they have no spare room to grow into, and are
+ * copied before being written to.
+ */
+struct vlc_frame_shared
+{
+    vlc_atomic_rc_t rc;
+    vlc_frame_t *frame;
+};
+
+struct vlc_frame_slice
+{
+    vlc_frame_t frame;
+    struct vlc_frame_shared *shared;
+    bool readonly;
+};
+
+static void vlc_frame_slice_Release(vlc_frame_t *frame)
+{
+    struct vlc_frame_slice *slice =
+        container_of(frame, struct vlc_frame_slice, frame);
+    struct vlc_frame_shared *shared = slice->shared;
+
+    if (vlc_atomic_rc_dec(&shared->rc))
+    {
+        vlc_frame_Release(shared->frame);
+        free(shared);
+    }
+    free(slice);
+}
+
+static const struct vlc_frame_callbacks vlc_frame_slice_cbs =
+{
+    vlc_frame_slice_Release,
+};
+
+vlc_frame_t *vlc_frame_Split(vlc_frame_t **restrict pp, size_t length)
+{
+    vlc_frame_t *frame = *pp;
+    struct vlc_frame_shared *shared;
+
+    vlc_frame_Check(frame);
+    assert(length <= frame->i_buffer);
+
+    struct vlc_frame_slice *head = malloc(sizeof (*head));
+    if (unlikely(head == NULL))
+        return NULL;
+
+    bool readonly = false;
+
+    if (frame->cbs == &vlc_frame_slice_cbs)
+    {
+        struct vlc_frame_slice *slice =
+            container_of(frame, struct vlc_frame_slice, frame);
+
+        shared = slice->shared;
+        readonly = slice->readonly;
+    }
+    else
+    {   /* First split: the remaining part replaces the original frame */
+        struct vlc_frame_slice *tail = malloc(sizeof (*tail));
+
+        shared = malloc(sizeof (*shared));
+        if (unlikely(tail == NULL || shared == NULL))
+        {
+            free(shared);
+            free(tail);
+            free(head);
+            return NULL;
+        }
+
+        vlc_atomic_rc_init(&shared->rc);
+        shared->frame = frame;
+
+        vlc_frame_Init(&tail->frame, &vlc_frame_slice_cbs,
+                       frame->p_start, frame->i_size);
+        tail->frame.p_buffer = frame->p_buffer;
+        tail->frame.i_buffer = frame->i_buffer;
+        tail->frame.p_next = frame->p_next;
+        vlc_frame_CopyProperties(&tail->frame, frame);
+        tail->shared = shared;
+        tail->readonly = false;
+        frame->p_next = NULL;
+        frame = &tail->frame;
+    }
+
+    vlc_atomic_rc_inc(&shared->rc);
+
+    size_t front = (frame->p_buffer - frame->p_start) + length;
+
+    vlc_frame_Init(&head->frame, &vlc_frame_slice_cbs, frame->p_start, front);
+    head->frame.p_buffer = frame->p_buffer;
+    head->frame.i_buffer = length;
+    head->shared = shared;
+    head->readonly = readonly;
+
+    frame->p_buffer += length;
+    frame->i_buffer -= length;
+    frame->p_start = frame->p_buffer;
+    frame->i_size -= front;
+
+    *pp = frame;
+    return &head->frame;
+}
+
+vlc_frame_t *vlc_frame_Share(vlc_frame_t **restrict pp)
+{
+    vlc_frame_t *frame = *pp;
+    struct vlc_frame_slice *slice;
+
+    vlc_frame_Check(frame);
+
+    struct vlc_frame_slice *view = malloc(sizeof (*view));
+    if (unlikely(view == NULL))
+        return NULL;
+
+    if (frame->cbs == &vlc_frame_slice_cbs)
+        slice = container_of(frame, struct vlc_frame_slice, frame);
+    else
+    {   /* First share: a view replaces the original frame */
+        struct vlc_frame_shared *shared = malloc(sizeof (*shared));
+
+        slice = malloc(sizeof (*slice));
+        if (unlikely(slice == NULL || shared == NULL))
+        {
+            free(shared);
+            free(slice);
+            free(view);
+            return NULL;
+        }
+
+        vlc_atomic_rc_init(&shared->rc);
+        shared->frame = frame;
+
+        vlc_frame_Init(&slice->frame, &vlc_frame_slice_cbs,
+                       frame->p_buffer, frame->i_buffer);
+        slice->frame.p_next = frame->p_next;
+        vlc_frame_CopyProperties(&slice->frame, frame);
+        slice->shared = shared;
+        frame->p_next = NULL;
+        *pp = &slice->frame;
+    }
+
+    /* Neither view may grow into the spare room of the other */
+    slice->frame.p_start = slice->frame.p_buffer;
+    slice->frame.i_size = slice->frame.i_buffer;
+    slice->readonly = true;
+
+    vlc_atomic_rc_inc(&slice->shared->rc);
+    vlc_frame_Init(&view->frame, &vlc_frame_slice_cbs,
+                   slice->frame.p_buffer, slice->frame.i_buffer);
+    vlc_frame_CopyProperties(&view->frame, &slice->frame);
+    view->shared = slice->shared;
+    view->readonly = true;
+    return &view->frame;
+}
+
+static bool vlc_frame_IsReadOnly(const vlc_frame_t *frame)
+{
+    return frame->cbs == &vlc_frame_slice_cbs
+        && container_of(frame, struct vlc_frame_slice, frame)->readonly;
+}
+
+vlc_frame_t *vlc_frame_MakeWritable(vlc_frame_t *frame)
+{
+    vlc_frame_Check(frame);
+
+    /* Other views may still be read from other threads: always copy, even
+     * if this happens to be the last one */
+    if (!vlc_frame_IsReadOnly(frame))
+        return frame;
+
+    vlc_frame_t *dup = vlc_frame_Duplicate(frame);
+    if (likely(dup != NULL))
+        dup->p_next = frame->p_next;
+    frame->p_next = NULL;
+    vlc_frame_Release(frame);
+    return dup;
+}
+
+vlc_frame_t *vlc_frame_TryJoin(vlc_frame_t *chain)
+{
+    vlc_frame_Check(chain);
+
+    if (chain->cbs != &vlc_frame_slice_cbs)
+        return NULL;
+
+    struct vlc_frame_shared *shared =
+        container_of(chain, struct vlc_frame_slice, frame)->shared;
+    size_t total = chain->i_buffer;
+    vlc_tick_t length = chain->i_length;
+
+    for (vlc_frame_t *prev = chain, *f = chain->p_next;
+         f != NULL; prev = f, f = f->p_next)
+    {
+        if (f->cbs != &vlc_frame_slice_cbs
+         || container_of(f, struct vlc_frame_slice, frame)->shared != shared
+         || prev->p_buffer + prev->i_buffer != f->p_buffer)
+            return NULL;
+        total += f->i_buffer;
+        length += f->i_length;
+    }
+
+    /* The following parts are released, their bytes now belong to the
+     * first one, which must not grow beyond the last part either */
+    size_t end = (chain->p_buffer - chain->p_start) + total;
+    if (chain->i_size < end)
+        chain->i_size = end;
+    chain->i_buffer = total;
+    chain->i_length = length;
+
+    vlc_frame_ChainRelease(chain->p_next);
+    chain->p_next = NULL;
+    return chain;
+}
+
 static void vlc_frame_heap_Release (vlc_frame_t *frame)
 {
     free (frame->p_start);
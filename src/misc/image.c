@@ -76,7 +76,14 @@ static int ImageWriteUrl( image_handler_t *, picture_t *,
 static picture_t *ImageConvert( image_handler_t *, picture_t *,
                                 const video_format_t *, video_format_t * );
 
+static block_t *ImageWriteLocked( image_handler_t *, picture_t *,
+                                  const video_format_t *, vlc_fourcc_t,
+                                  const video_format_t * );
+static picture_t *ImageConvertLocked( image_handler_t *, picture_t *,
+                                      const video_format_t *, video_format_t * );
+
 static decoder_t *CreateDecoder( image_handler_t *, const es_format_t * );
+static void DeleteDecoder( decoder_t * );
 static encoder_t *CreateEncoder( vlc_object_t *, const video_format_t *,
                                  vlc_fourcc_t, const video_format_t * );
 static filter_t *CreateConverter( vlc_object_t *, const es_format_t *,
@@ -108,6 +115,7 @@ image_handler_t *image_HandlerCreate( vlc_object_t *p_this )
     p_image->pf_convert = ImageConvert;
 
     p_image->outfifo = picture_fifo_New();
+    vlc_mutex_init( &p_image->lock );
 
     return p_image;
 }
@@ -120,12 +128,9 @@ void image_HandlerDelete( image_handler_t *p_image )
 {
     if( !p_image ) return;
 
-    if( p_image->p_dec != NULL )
-    {
-        struct decoder_owner *p_owner = dec_get_owner( p_image->p_dec );
-        es_format_Clean( &p_owner->fmt_in );
-        decoder_Destroy( p_image->p_dec );
-    }
+    for( size_t i = 0; i < ARRAY_SIZE(p_image->p_dec); i++ )
+        if( p_image->p_dec[i] != NULL )
+            DeleteDecoder( p_image->p_dec[i] );
     if( p_image->p_enc )
         vlc_encoder_Destroy( p_image->p_enc );
     if( p_image->p_converter ) DeleteConverter( p_image->p_converter );
@@ -147,9 +152,47 @@ static void ImageQueueVideo( decoder_t *p_dec, picture_t *p_pic )
     picture_fifo_Push( p_owner->p_image->outfifo, p_pic );
 }
 
-static picture_t *ImageRead( image_handler_t *p_image, block_t *p_block,
-                             const es_format_t *p_es_in,
-                             video_format_t *p_fmt_out )
+/* Returns the decoder for the codec, starting one in place of the least
+ * recently used one if needed */
+static decoder_t *GetDecoder( image_handler_t *p_image,
+                              const es_format_t *p_es_in )
+{
+    decoder_t **pp_dec = p_image->p_dec;
+    const size_t i_max = ARRAY_SIZE(p_image->p_dec);
+    size_t i = 0;
+
+    while( i < i_max - 1 && pp_dec[i] != NULL &&
+           pp_dec[i]->fmt_in->i_codec != p_es_in->video.i_chroma )
+        i++;
+
+    decoder_t *p_dec = pp_dec[i];
+    if( p_dec == NULL || p_dec->fmt_in->i_codec != p_es_in->video.i_chroma )
+    {
+        if( p_dec != NULL )
+            DeleteDecoder( p_dec );
+        p_dec = CreateDecoder( p_image, p_es_in );
+        if( p_dec != NULL && p_dec->fmt_out.i_cat != VIDEO_ES )
+        {
+            DeleteDecoder( p_dec );
+            p_dec = NULL;
+        }
+        if( p_dec == NULL )
+        {
+            memmove( &pp_dec[i], &pp_dec[i + 1],
+                     (i_max - 1 - i) * sizeof(*pp_dec) );
+            pp_dec[i_max - 1] = NULL;
+            return NULL;
+        }
+    }
+
+    memmove( &pp_dec[1], &pp_dec[0], i * sizeof(*pp_dec) );
+    pp_dec[0] = p_dec;
+    return p_dec;
+}
+
+static picture_t *ImageReadLocked( image_handler_t *p_image, block_t *p_block,
+                                   const es_format_t *p_es_in,
+                                   video_format_t *p_fmt_out )
 {
     picture_t *p_pic = NULL;
 
@@ -159,42 +202,19 @@ static picture_t *ImageRead( image_handler_t *p_image, block_t *p_block,
         return NULL;
     }
 
-    /* Check if we can reuse the current decoder */
-    if( p_image->p_dec &&
-        p_image->p_dec->fmt_in->i_codec != p_es_in->video.i_chroma )
-    {
-        struct decoder_owner *p_owner = dec_get_owner( p_image->p_dec );
-        es_format_Clean( &p_owner->fmt_in );
-        decoder_Destroy( p_image->p_dec );
-        p_image->p_dec = NULL;
-    }
-
-    /* Start a decoder */
-    if( !p_image->p_dec )
+    decoder_t *p_dec = GetDecoder( p_image, p_es_in );
+    if( !p_dec )
     {
-        p_image->p_dec = CreateDecoder( p_image, p_es_in );
-        if( !p_image->p_dec )
-        {
-            block_Release(p_block);
-            return NULL;
-        }
-        if( p_image->p_dec->fmt_out.i_cat != VIDEO_ES )
-        {
-            struct decoder_owner *p_owner = dec_get_owner( p_image->p_dec );
-            es_format_Clean( &p_owner->fmt_in );
-            decoder_Destroy( p_image->p_dec );
-            p_image->p_dec = NULL;
-            block_Release(p_block);
-            return NULL;
-        }
+        block_Release(p_block);
+        return NULL;
     }
 
     p_block->i_pts = p_block->i_dts = vlc_tick_now();
-    int ret = p_image->p_dec->pf_decode( p_image->p_dec, p_block );
+    int ret = p_dec->pf_decode( p_dec, p_block );
     if( ret == VLCDEC_SUCCESS )
     {
         /* Drain */
-        p_image->p_dec->pf_decode( p_image->p_dec, NULL );
+        p_dec->pf_decode( p_dec, NULL );
 
         p_pic = picture_fifo_Pop( p_image->outfifo );
 
@@ -217,43 +237,43 @@ static picture_t *ImageRead( image_handler_t *p_image, block_t *p_block,
     }
 
     if( !p_fmt_out->i_chroma )
-        p_fmt_out->i_chroma = p_image->p_dec->fmt_out.video.i_chroma;
+        p_fmt_out->i_chroma = p_dec->fmt_out.video.i_chroma;
     if( !p_fmt_out->i_width && p_fmt_out->i_height )
-        p_fmt_out->i_width = (int64_t)p_image->p_dec->fmt_out.video.i_width *
-                             p_image->p_dec->fmt_out.video.i_sar_num *
+        p_fmt_out->i_width = (int64_t)p_dec->fmt_out.video.i_width *
+                             p_dec->fmt_out.video.i_sar_num *
                              p_fmt_out->i_height /
-                             p_image->p_dec->fmt_out.video.i_height /
-                             p_image->p_dec->fmt_out.video.i_sar_den;
+                             p_dec->fmt_out.video.i_height /
+                             p_dec->fmt_out.video.i_sar_den;
 
     if( !p_fmt_out->i_height && p_fmt_out->i_width )
-        p_fmt_out->i_height = (int64_t)p_image->p_dec->fmt_out.video.i_height *
-                              p_image->p_dec->fmt_out.video.i_sar_den *
+        p_fmt_out->i_height = (int64_t)p_dec->fmt_out.video.i_height *
+                              p_dec->fmt_out.video.i_sar_den *
                               p_fmt_out->i_width /
-                              p_image->p_dec->fmt_out.video.i_width /
-                              p_image->p_dec->fmt_out.video.i_sar_num;
+                              p_dec->fmt_out.video.i_width /
+                              p_dec->fmt_out.video.i_sar_num;
     if( !p_fmt_out->i_width )
-        p_fmt_out->i_width = p_image->p_dec->fmt_out.video.i_width;
+        p_fmt_out->i_width = p_dec->fmt_out.video.i_width;
     if( !p_fmt_out->i_height )
-        p_fmt_out->i_height = p_image->p_dec->fmt_out.video.i_height;
+        p_fmt_out->i_height = p_dec->fmt_out.video.i_height;
     if( !p_fmt_out->i_visible_width )
         p_fmt_out->i_visible_width = p_fmt_out->i_width;
     if( !p_fmt_out->i_visible_height )
         p_fmt_out->i_visible_height = p_fmt_out->i_height;
     if( p_fmt_out->transfer == TRANSFER_FUNC_UNDEF )
-        p_fmt_out->transfer = p_image->p_dec->fmt_out.video.transfer;
+        p_fmt_out->transfer = p_dec->fmt_out.video.transfer;
     if( p_fmt_out->primaries == COLOR_PRIMARIES_UNDEF )
-        p_fmt_out->primaries = p_image->p_dec->fmt_out.video.primaries;
+        p_fmt_out->primaries = p_dec->fmt_out.video.primaries;
     if( p_fmt_out->space == COLOR_SPACE_UNDEF )
-        p_fmt_out->space = p_image->p_dec->fmt_out.video.space;
+        p_fmt_out->space = p_dec->fmt_out.video.space;
 
     /* Check if we need chroma conversion or resizing */
-    if( !video_format_IsSameChroma( &p_image->p_dec->fmt_out.video, p_fmt_out ) ||
-        p_image->p_dec->fmt_out.video.i_width != p_fmt_out->i_width ||
-        p_image->p_dec->fmt_out.video.i_height != p_fmt_out->i_height )
+    if( !video_format_IsSameChroma( &p_dec->fmt_out.video, p_fmt_out ) ||
+        p_dec->fmt_out.video.i_width != p_fmt_out->i_width ||
+        p_dec->fmt_out.video.i_height != p_fmt_out->i_height )
     {
         if( p_image->p_converter &&
             ( !video_format_IsSameChroma( &p_image->p_converter->fmt_in.video,
-                                          &p_image->p_dec->fmt_out.video ) ||
+                                          &p_dec->fmt_out.video ) ||
               !video_format_IsSameChroma( &p_image->p_converter->fmt_out.video, p_fmt_out ) ) )
         {
             /* We need to restart a new filter */
@@ -265,7 +285,7 @@ static picture_t *ImageRead( image_handler_t *p_image, block_t *p_block,
         if( !p_image->p_converter )
         {
             p_image->p_converter =
-                CreateConverter( p_image->p_parent, &p_image->p_dec->fmt_out,
+                CreateConverter( p_image->p_parent, &p_dec->fmt_out,
                                  picture_GetVideoContext(p_pic), p_fmt_out );
 
             if( !p_image->p_converter )
@@ -278,7 +298,7 @@ static picture_t *ImageRead( image_handler_t *p_image, block_t *p_block,
         {
             /* Filters should handle on-the-fly size changes */
             es_format_Clean( &p_image->p_converter->fmt_in );
-            es_format_Copy( &p_image->p_converter->fmt_in, &p_image->p_dec->fmt_out );
+            es_format_Copy( &p_image->p_converter->fmt_in, &p_dec->fmt_out );
             video_format_Clean( &p_image->p_converter->fmt_out.video );
             video_format_Copy( &p_image->p_converter->fmt_out.video, p_fmt_out);
         }
@@ -289,12 +309,44 @@ static picture_t *ImageRead( image_handler_t *p_image, block_t *p_block,
     else
     {
         video_format_Clean( p_fmt_out );
-        video_format_Copy( p_fmt_out, &p_image->p_dec->fmt_out.video );
+        video_format_Copy( p_fmt_out, &p_dec->fmt_out.video );
     }
 
     return p_pic;
 }
 
+/* The modules are only used by one thread at a time */
+static picture_t *ImageRead( image_handler_t *p_image, block_t *p_block,
+                             const es_format_t *p_es_in,
+                             video_format_t *p_fmt_out )
+{
+    vlc_mutex_lock( &p_image->lock );
+    picture_t *p_pic = ImageReadLocked( p_image, p_block, p_es_in, p_fmt_out );
+    vlc_mutex_unlock( &p_image->lock );
+    return p_pic;
+}
+
+static block_t *ImageWrite( image_handler_t *p_image, picture_t *p_pic,
+                            const video_format_t *p_fmt_in,
+                            vlc_fourcc_t codec, const video_format_t *p_fmt_out )
+{
+    vlc_mutex_lock( &p_image->lock );
+    block_t *p_block = ImageWriteLocked( p_image, p_pic, p_fmt_in, codec,
+                                         p_fmt_out );
+    vlc_mutex_unlock( &p_image->lock );
+    return p_block;
+}
+
+static picture_t *ImageConvert( image_handler_t *p_image, picture_t *p_pic,
+                                const video_format_t *p_fmt_in,
+                                video_format_t *p_fmt_out )
+{
+    vlc_mutex_lock( &p_image->lock );
+    picture_t *p_out = ImageConvertLocked( p_image, p_pic, p_fmt_in, p_fmt_out );
+    vlc_mutex_unlock( &p_image->lock );
+    return p_out;
+}
+
 static picture_t *ImageReadUrl( image_handler_t *p_image, const char *psz_url,
                                 video_format_t *p_fmt_out )
 {
@@ -354,9 +406,9 @@ error:
  *
  */
 
-static block_t *ImageWrite( image_handler_t *p_image, picture_t *p_pic,
-                            const video_format_t *p_fmt_in,
-                            vlc_fourcc_t codec, const video_format_t *p_fmt_out )
+static block_t *ImageWriteLocked( image_handler_t *p_image, picture_t *p_pic,
+                                  const video_format_t *p_fmt_in,
+                                  vlc_fourcc_t codec, const video_format_t *p_fmt_out )
 {
     /* Check if we can reuse the current encoder */
     if( p_image->p_enc &&
@@ -492,9 +544,9 @@ static int ImageWriteUrl( image_handler_t *p_image, picture_t *p_pic,
  *
  */
 
-static picture_t *ImageConvert( image_handler_t *p_image, picture_t *p_pic,
-                                const video_format_t *p_fmt_in,
-                                video_format_t *p_fmt_out )
+static picture_t *ImageConvertLocked( image_handler_t *p_image, picture_t *p_pic,
+                                      const video_format_t *p_fmt_in,
+                                      video_format_t *p_fmt_out )
 {
     if( !p_fmt_out->i_width && !p_fmt_out->i_height &&
         p_fmt_out->i_sar_num && p_fmt_out->i_sar_den &&
@@ -783,6 +835,14 @@ static filter_t *CreateConverter( vlc_object_t *p_this,
     return p_filter;
 }
 
+static void DeleteDecoder( decoder_t *p_dec )
+{
+    struct decoder_owner *p_owner = dec_get_owner( p_dec );
+
+    es_format_Clean( &p_owner->fmt_in );
+    decoder_Destroy( p_dec );
+}
+
 static void DeleteConverter( filter_t * p_filter )
 {
     vlc_filter_UnloadModule( p_filter );
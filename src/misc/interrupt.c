@@ -57,9 +57,12 @@ static thread_local vlc_interrupt_t *vlc_interrupt_var;
 void vlc_interrupt_init(vlc_interrupt_t *ctx)
 {
     vlc_mutex_init(&ctx->lock);
-    ctx->interrupted = false;
+    atomic_init(&ctx->interrupted, false);
     atomic_init(&ctx->killed, false);
     ctx->callback = NULL;
+#ifndef _WIN32
+    ctx->wake_fd[0] = ctx->wake_fd[1] = -1;
+#endif
 }
 
 vlc_interrupt_t *vlc_interrupt_create(void)
@@ -77,6 +80,12 @@ vlc_interrupt_t *vlc_interrupt_create(void)
 void vlc_interrupt_deinit(vlc_interrupt_t *ctx)
 {
     assert(ctx->callback == NULL);
+#ifndef _WIN32
+    if (ctx->wake_fd[1] != ctx->wake_fd[0])
+        vlc_close(ctx->wake_fd[1]);
+    if (ctx->wake_fd[0] != -1)
+        vlc_close(ctx->wake_fd[0]);
+#endif
 }
 
 void vlc_interrupt_destroy(vlc_interrupt_t *ctx)
@@ -95,7 +104,7 @@ void vlc_interrupt_raise(vlc_interrupt_t *ctx)
      * context are serialized. The lock also protects against invalid memory
      * accesses to the callback pointer proper, and the interrupted flag. */
     vlc_mutex_lock(&ctx->lock);
-    ctx->interrupted = true;
+    atomic_store_explicit(&ctx->interrupted, true, memory_order_relaxed);
     if (ctx->callback != NULL)
         ctx->callback(ctx->data);
     vlc_mutex_unlock(&ctx->lock);
@@ -130,7 +139,8 @@ static void vlc_interrupt_prepare(vlc_interrupt_t *ctx,
     ctx->callback = cb;
     ctx->data = data;
 
-    if (unlikely(ctx->interrupted))
+    if (unlikely(atomic_load_explicit(&ctx->interrupted,
+                                      memory_order_relaxed)))
         cb(data);
     vlc_mutex_unlock(&ctx->lock);
 }
@@ -156,10 +166,10 @@ static int vlc_interrupt_finish(vlc_interrupt_t *ctx)
     /* Wait for pending callbacks to prevent access by other threads. */
     vlc_mutex_lock(&ctx->lock);
     ctx->callback = NULL;
-    if (ctx->interrupted)
+    if (atomic_load_explicit(&ctx->interrupted, memory_order_relaxed))
     {
         ret = EINTR;
-        ctx->interrupted = false;
+        atomic_store_explicit(&ctx->interrupted, false, memory_order_relaxed);
     }
     vlc_mutex_unlock(&ctx->lock);
     return ret;
@@ -244,7 +254,7 @@ int vlc_mwait_i11e(vlc_tick_t deadline)
 
     vlc_mutex_lock(&ctx->lock);
     vlc_cleanup_push(vlc_mwait_i11e_cleanup, ctx);
-    while (!ctx->interrupted
+    while (!atomic_load_explicit(&ctx->interrupted, memory_order_relaxed)
         && vlc_cond_timedwait(&wait, &ctx->lock, deadline) == 0);
     vlc_cleanup_pop();
     vlc_mutex_unlock(&ctx->lock);
@@ -287,6 +297,14 @@ int vlc_interrupt_forward_stop(void *const data[2])
     return vlc_interrupt_finish(from);
 }
 
+/* Whether an interruption is already pending, racy but good enough to skip
+ * the non-blocking attempts */
+static bool vlc_interrupt_pending(const vlc_interrupt_t *ctx)
+{
+    return ctx != NULL
+        && atomic_load_explicit(&ctx->interrupted, memory_order_relaxed);
+}
+
 #ifndef _WIN32
 # include <fcntl.h>
 # include <sys/uio.h>
@@ -301,44 +319,63 @@ static void vlc_poll_i11e_wake(void *opaque)
     int canc;
 
     canc = vlc_savecancel();
-    while (write(fd[1], &value, sizeof (value)) == -1)
-    {
-        /* Only EINTR can happen here, so ignore the error.
-         * We still need to ensure we really wrote the value to trigger
-         * the interruption check though. */
-    }
+    /* EAGAIN means that a wake up is pending already */
+    while (write(fd[1], &value, sizeof (value)) == -1 && errno == EINTR);
     vlc_restorecancel(canc);
 }
 
+/* Consumes the wake ups, the descriptor is non-blocking */
+static void vlc_poll_i11e_drain(const int *fd)
+{
+    uint64_t dummy;
+
+    while (read(fd[0], &dummy, sizeof (dummy)) > 0 || errno == EINTR);
+}
+
 static void vlc_poll_i11e_cleanup(void *opaque)
 {
     vlc_interrupt_t *ctx = opaque;
-    int *fd = ctx->data;
 
-    vlc_interrupt_finish(ctx);
-    if (fd[1] != fd[0])
-        vlc_close(fd[1]);
-    vlc_close(fd[0]);
+    if (vlc_interrupt_finish(ctx))
+        vlc_poll_i11e_drain(ctx->wake_fd);
 }
 
-static int vlc_poll_i11e_inner(struct pollfd *restrict fds, unsigned nfds,
-                               int timeout, vlc_interrupt_t *ctx,
-                               struct pollfd *restrict ufd)
+/* The wake up descriptors are created on first use and kept with the
+ * context, as the context is attached to a single thread at a time */
+static int vlc_poll_i11e_setup(vlc_interrupt_t *ctx)
 {
-    int fd[2];
-    int ret = -1;
+    int *fd = ctx->wake_fd;
     int canc;
 
-    /* TODO: cache this */
-# if defined (HAVE_EVENTFD) && defined (EFD_CLOEXEC)
+    if (likely(fd[0] != -1))
+        return 0;
+
     canc = vlc_savecancel();
-    fd[0] = eventfd(0, EFD_CLOEXEC);
-    vlc_restorecancel(canc);
+# if defined (HAVE_EVENTFD) && defined (EFD_CLOEXEC) && defined (EFD_NONBLOCK)
+    fd[0] = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
     if (fd[0] != -1)
         fd[1] = fd[0];
     else
 # endif
-    if (vlc_pipe(fd))
+    if (vlc_pipe(fd) == 0)
+    {
+        fcntl(fd[0], F_SETFL, fcntl(fd[0], F_GETFL) | O_NONBLOCK);
+        fcntl(fd[1], F_SETFL, fcntl(fd[1], F_GETFL) | O_NONBLOCK);
+    }
+    else
+        fd[0] = fd[1] = -1;
+    vlc_restorecancel(canc);
+    return (fd[0] != -1) ? 0 : -1;
+}
+
+static int vlc_poll_i11e_inner(struct pollfd *restrict fds, unsigned nfds,
+                               int timeout, vlc_interrupt_t *ctx,
+                               struct pollfd *restrict ufd)
+{
+    int *fd = ctx->wake_fd;
+    int ret = -1;
+
+    if (vlc_poll_i11e_setup(ctx))
     {
         vlc_testcancel();
         errno = ENOMEM;
@@ -362,30 +399,17 @@ static int vlc_poll_i11e_inner(struct pollfd *restrict fds, unsigned nfds,
         fds[i].revents = ufd[i].revents;
 
     if (ret > 0 && ufd[nfds].revents)
-    {
-        uint64_t dummy;
-
-        while (read(fd[0], &dummy, sizeof (dummy)) == -1)
-        {
-            /* Only EINTR can happen here, so ignore the error.
-             * We still need to read() the value though, to ensure
-             * that the interruption is correctly acknowledged. */
-        }
         ret--;
-    }
     vlc_cleanup_pop();
 
+    /* Only an interruption wakes the descriptor up, and the callback cannot
+     * run anymore once the wait is finished */
     if (vlc_interrupt_finish(ctx))
     {
+        vlc_poll_i11e_drain(fd);
         errno = EINTR;
         ret = -1;
     }
-
-    canc = vlc_savecancel();
-    if (fd[1] != fd[0])
-        vlc_close(fd[1]);
-    vlc_close(fd[0]);
-    vlc_restorecancel(canc);
     return ret;
 }
 
@@ -559,6 +583,17 @@ ssize_t vlc_write_i11e(int fd, const void *buf, size_t count)
 
 ssize_t vlc_recvmsg_i11e(int fd, struct msghdr *msg, int flags)
 {
+#ifdef MSG_DONTWAIT
+    /* Busy sockets usually have data already, try before arming the
+     * interruption and polling. */
+    if (!vlc_interrupt_pending(vlc_interrupt_var))
+    {
+        ssize_t ret = recvmsg(fd, msg, flags | MSG_DONTWAIT);
+        if (ret >= 0 || (errno != EAGAIN && errno != EWOULDBLOCK
+                      && errno != EINTR))
+            return ret;
+    }
+#endif
     if (vlc_poll_sock(fd, POLLIN) < 0)
         return -1;
     /* NOTE: MSG_OOB and MSG_PEEK should work fine here.
@@ -32,9 +32,12 @@ void vlc_interrupt_deinit(vlc_interrupt_t *);
 struct vlc_interrupt
 {
     vlc_mutex_t lock;
-    bool interrupted;
+    atomic_bool interrupted; /* written with the lock held */
     atomic_bool killed;
     void (*callback)(void *);
     void *data;
+#ifndef _WIN32
+    int wake_fd[2]; /* cached for vlc_poll_i11e(), -1 until first used */
+#endif
 };
 #endif
@@ -38,6 +38,7 @@
 
 #include <vlc_common.h>
 #include <vlc_threads.h>
+#include <vlc_atomic.h>
 #include <vlc_interface.h>
 #include <vlc_charset.h>
 #include <vlc_modules.h>
@@ -414,6 +415,241 @@ static struct vlc_logger *vlc_LogModuleCreate(vlc_object_t *parent)
     return &module->frontend;
 }
 
+/**
+ * Asynchronous message log.
+ *
+ * A message log that formats messages into a bounded ring of preallocated
+ * slots, and passes them to its sink from a background thread, so that slow
+ * sinks (console, files, syslog...) do not delay the emitting threads.
+ * Emitters never block nor allocate: if the ring is full, the message is
+ * dropped and counted.
+ */
+#define VLC_LOG_ASYNC_SLOTS 512 /* must be a power of two */
+#define VLC_LOG_ASYNC_SIZE  512
+
+struct vlc_log_async_slot {
+    atomic_size_t seq;
+    int type;
+    vlc_log_t meta;
+    size_t offset; /**< Offset of the message within text */
+    char text[VLC_LOG_ASYNC_SIZE]; /**< Module, header and message */
+};
+
+typedef struct vlc_logger_async {
+    struct vlc_logger logger;
+    struct vlc_logger *sink;
+    vlc_thread_t thread;
+    atomic_size_t tail; /**< Next slot to write */
+    size_t head; /**< Next slot to read (background thread only) */
+    atomic_uint wakeup;
+    atomic_bool sleeping;
+    atomic_bool stop;
+    atomic_size_t dropped;
+    struct vlc_log_async_slot slots[VLC_LOG_ASYNC_SLOTS];
+} vlc_logger_async_t;
+
+static size_t vlc_LogAsyncCopy(char *buf, size_t size, const char *str)
+{
+    size_t len = strnlen(str, size - 1);
+
+    memcpy(buf, str, len);
+    buf[len] = '\0';
+    return len + 1;
+}
+
+static void vlc_vaLogAsync(void *d, int type, const vlc_log_t *item,
+                           const char *format, va_list ap)
+{
+    struct vlc_logger *logger = d;
+    vlc_logger_async_t *async =
+        container_of(logger, vlc_logger_async_t, logger);
+    struct vlc_log_async_slot *slot;
+    size_t pos = atomic_load_explicit(&async->tail, memory_order_relaxed);
+
+    /* Reserve a slot */
+    for (;;)
+    {
+        slot = &async->slots[pos & (VLC_LOG_ASYNC_SLOTS - 1)];
+
+        size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        ptrdiff_t diff = (ptrdiff_t)(seq - pos);
+
+        if (diff == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&async->tail, &pos,
+                                                      pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {   /* Full: the background thread is lagging behind */
+            atomic_fetch_add_explicit(&async->dropped, 1,
+                                      memory_order_relaxed);
+            return;
+        }
+        else
+            pos = atomic_load_explicit(&async->tail, memory_order_relaxed);
+    }
+
+    /* The module name and the header may not outlive the call: copy them.
+     * NOTE: Object types, file and function names are static constants. */
+    size_t len = vlc_LogAsyncCopy(slot->text, 64, item->psz_module);
+
+    slot->type = type;
+    slot->meta = *item;
+    slot->meta.psz_module = slot->text;
+
+    if (item->psz_header != NULL)
+    {
+        slot->meta.psz_header = slot->text + len;
+        len += vlc_LogAsyncCopy(slot->text + len, 128, item->psz_header);
+    }
+
+    slot->offset = len;
+    if (vsnprintf(slot->text + len, sizeof (slot->text) - len, format,
+                  ap) < 0)
+        slot->text[len] = '\0';
+
+    /* Publish the slot, then wake the background thread up if needed */
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_seq_cst);
+
+    if (atomic_load_explicit(&async->sleeping, memory_order_seq_cst))
+    {
+        atomic_fetch_add_explicit(&async->wakeup, 1, memory_order_relaxed);
+        vlc_atomic_notify_one(&async->wakeup);
+    }
+}
+
+static void vlc_LogAsyncSink(struct vlc_logger *sink, int type,
+                             const vlc_log_t *item, const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    sink->ops->log(sink, type, item, format, ap);
+    va_end(ap);
+}
+
+static bool vlc_LogAsyncDrain(vlc_logger_async_t *async)
+{
+    bool drained = false;
+
+    for (;;)
+    {
+        size_t pos = async->head;
+        struct vlc_log_async_slot *slot =
+            &async->slots[pos & (VLC_LOG_ASYNC_SLOTS - 1)];
+
+        if (atomic_load_explicit(&slot->seq, memory_order_acquire) != pos + 1)
+            break;
+
+        vlc_LogAsyncSink(async->sink, slot->type, &slot->meta, "%s",
+                         slot->text + slot->offset);
+        atomic_store_explicit(&slot->seq, pos + VLC_LOG_ASYNC_SLOTS,
+                              memory_order_release);
+        async->head = pos + 1;
+        drained = true;
+    }
+
+    size_t dropped = atomic_exchange_explicit(&async->dropped, 0,
+                                              memory_order_relaxed);
+    if (dropped > 0)
+    {
+        vlc_log_t meta = {
+            .i_object_id = (uintptr_t)async,
+            .psz_object_type = "logger",
+            .psz_module = "core",
+            .file = __FILE__,
+            .line = __LINE__,
+            .func = __func__,
+            .tid = vlc_thread_id(),
+        };
+
+        vlc_LogAsyncSink(async->sink, VLC_MSG_WARN, &meta,
+                         "%zu log message(s) dropped", dropped);
+    }
+    return drained;
+}
+
+static void *vlc_LogAsyncThread(void *data)
+{
+    vlc_logger_async_t *async = data;
+
+    vlc_thread_set_name("vlc-log-async");
+
+    for (;;)
+    {
+        unsigned wakeup = atomic_load_explicit(&async->wakeup,
+                                               memory_order_relaxed);
+
+        if (vlc_LogAsyncDrain(async))
+            continue;
+        if (atomic_load_explicit(&async->stop, memory_order_acquire))
+            break;
+
+        atomic_store_explicit(&async->sleeping, true, memory_order_seq_cst);
+        /* Check again, in case a message was published before sleeping */
+        size_t pos = async->head;
+        const struct vlc_log_async_slot *slot =
+            &async->slots[pos & (VLC_LOG_ASYNC_SLOTS - 1)];
+
+        if (atomic_load_explicit(&slot->seq, memory_order_seq_cst) != pos + 1
+         && !atomic_load_explicit(&async->stop, memory_order_seq_cst))
+            vlc_atomic_wait(&async->wakeup, wakeup);
+        atomic_store_explicit(&async->sleeping, false, memory_order_relaxed);
+    }
+
+    vlc_LogAsyncDrain(async);
+    return NULL;
+}
+
+static void vlc_LogAsyncClose(void *d)
+{
+    struct vlc_logger *logger = d;
+    vlc_logger_async_t *async =
+        container_of(logger, vlc_logger_async_t, logger);
+
+    atomic_store_explicit(&async->stop, true, memory_order_seq_cst);
+    atomic_fetch_add_explicit(&async->wakeup, 1, memory_order_relaxed);
+    vlc_atomic_notify_one(&async->wakeup);
+    vlc_join(async->thread, NULL);
+
+    async->sink->ops->destroy(async->sink);
+    free(async);
+}
+
+static const struct vlc_logger_operations async_ops = {
+    vlc_vaLogAsync,
+    vlc_LogAsyncClose,
+};
+
+static struct vlc_logger *vlc_LogAsyncCreate(struct vlc_logger *sink)
+{
+    vlc_logger_async_t *async = malloc(sizeof (*async));
+    if (unlikely(async == NULL))
+        return NULL;
+
+    async->logger.ops = &async_ops;
+    async->sink = sink;
+    atomic_init(&async->tail, 0);
+    async->head = 0;
+    atomic_init(&async->wakeup, 0);
+    atomic_init(&async->sleeping, false);
+    atomic_init(&async->stop, false);
+    atomic_init(&async->dropped, 0);
+
+    for (size_t i = 0; i < VLC_LOG_ASYNC_SLOTS; i++)
+        atomic_init(&async->slots[i].seq, i);
+
+    if (vlc_clone(&async->thread, vlc_LogAsyncThread, async))
+    {
+        free(async);
+        return NULL;
+    }
+    return &async->logger;
+}
+
 /**
  * Initializes the messages logging subsystem and drain the early messages to
  * the configured log.
@@ -423,6 +659,12 @@ void vlc_LogInit(libvlc_int_t *vlc)
     struct vlc_logger *logger = vlc_LogModuleCreate(VLC_OBJECT(vlc));
     if (logger == NULL)
         logger = &discard_log;
+    else if (var_InheritBool(vlc, "log-async"))
+    {
+        struct vlc_logger *async = vlc_LogAsyncCreate(logger);
+        if (likely(async != NULL))
+            logger = async;
+    }
 
     vlc_LogSwitch(vlc->obj.logger, logger);
 }
@@ -404,6 +404,9 @@ void plane_CopyPixels( plane_t *p_dst, const plane_t *p_src )
 
 void picture_CopyProperties( picture_t *p_dst, const picture_t *p_src )
 {
+    if( p_dst == p_src ) /* filtered in place */
+        return;
+
     p_dst->date = p_src->date;
     p_dst->b_force = p_src->b_force;
     p_dst->b_still = p_src->b_still;
@@ -484,6 +487,65 @@ picture_t *picture_Clone(picture_t *picture)
     return clone;
 }
 
+picture_t *picture_NewView(picture_t *picture, const video_format_t *fmt,
+                           unsigned x, unsigned y)
+{
+    if (picture->context != NULL)
+        return NULL;
+
+    const vlc_chroma_description_t *dsc =
+        vlc_fourcc_GetChromaDescription(picture->format.i_chroma);
+    if (dsc == NULL || dsc->plane_count != (unsigned)picture->i_planes
+     || fmt->i_chroma != picture->format.i_chroma)
+        return NULL;
+
+    /* Packed 4:2:2 pixels come in pairs */
+    if (dsc->plane_count == 1 && dsc->subtype == VLC_CHROMA_SUBTYPE_YUV422
+     && (x & 1))
+        return NULL;
+
+    picture_resource_t res = {
+        .pf_destroy = picture_DestroyClone,
+    };
+    unsigned offsets[PICTURE_PLANE_MAX];
+
+    for (int i = 0; i < picture->i_planes; i++) {
+        const plane_t *p = &picture->p[i];
+        const vlc_rational_t *w = &dsc->p[i].w, *h = &dsc->p[i].h;
+
+        if ((x * w->num) % w->den || (y * h->num) % h->den)
+            return NULL;
+
+        unsigned py = y * h->num / h->den;
+        if (py >= (unsigned)p->i_lines)
+            return NULL;
+
+        offsets[i] = x * w->num / w->den * p->i_pixel_pitch;
+        res.p[i].p_pixels = p->p_pixels + py * p->i_pitch + offsets[i];
+        res.p[i].i_lines = p->i_lines - py;
+        res.p[i].i_pitch = p->i_pitch;
+    }
+
+    picture_t *view = picture_NewFromResource(fmt, &res);
+    if (unlikely(view == NULL))
+        return NULL;
+
+    picture_priv_t *view_priv = container_of(view, picture_priv_t, picture);
+    view_priv->gc.opaque = picture;
+    picture_Hold(picture);
+
+    for (int i = 0; i < view->i_planes; i++) {
+        const plane_t *p = &view->p[i];
+
+        if (offsets[i] + p->i_visible_pitch > (unsigned)p->i_pitch
+         || p->i_visible_lines > p->i_lines) {
+            picture_Release(view);
+            return NULL;
+        }
+    }
+    return view;
+}
+
 int
 picture_MergeAncillaries(picture_t *pic, const vlc_ancillary_array *src_array)
 {
@@ -35,7 +35,8 @@ typedef struct
     } gc;
 
     void *pool; /* Only used by picture_pool.c */
-    struct vlc_list pool_node; /* Only used by picture_pool.c */
+    unsigned pool_index; /* Only used by picture_pool.c */
+    vlc_tick_t queued; /* Only used by the video output */
 
     vlc_ancillary_array ancillaries;
 } picture_priv_t;
@@ -29,6 +29,7 @@
 # include "config.h"
 #endif
 #include <assert.h>
+#include <errno.h>
 
 #include <vlc_common.h>
 #include <vlc_threads.h>
@@ -39,48 +40,121 @@
  *****************************************************************************/
 struct picture_fifo_t {
     vlc_mutex_t lock;
+    vlc_cond_t  wait_space;
     vlc_picture_chain_t pics;
+    size_t count;
+    size_t max; /* 0 if unbounded */
 };
 
 static void PictureFifoReset(picture_fifo_t *fifo)
 {
     vlc_picture_chain_Init( &fifo->pics );
+    fifo->count = 0;
 }
 static void PictureFifoPush(picture_fifo_t *fifo, picture_t *picture)
 {
     assert(!picture_HasChainedPics(picture));
     vlc_picture_chain_Append( &fifo->pics, picture );
+    fifo->count++;
 }
 static picture_t *PictureFifoPop(picture_fifo_t *fifo)
 {
-    return vlc_picture_chain_PopFront( &fifo->pics );
+    picture_t *picture = vlc_picture_chain_PopFront( &fifo->pics );
+    if (picture != NULL)
+        fifo->count--;
+    return picture;
+}
+static bool PictureFifoIsFull(const picture_fifo_t *fifo)
+{
+    return fifo->max != 0 && fifo->count >= fifo->max;
+}
+static void PictureFifoSignalSpace(picture_fifo_t *fifo)
+{
+    if (fifo->max != 0 && fifo->count < fifo->max)
+        vlc_cond_broadcast(&fifo->wait_space);
 }
 
-picture_fifo_t *picture_fifo_New(void)
+picture_fifo_t *picture_fifo_NewBounded(size_t max)
 {
     picture_fifo_t *fifo = malloc(sizeof(*fifo));
     if (!fifo)
         return NULL;
 
     vlc_mutex_init(&fifo->lock);
+    vlc_cond_init(&fifo->wait_space);
     PictureFifoReset(fifo);
+    fifo->max = max;
     return fifo;
 }
 
+picture_fifo_t *picture_fifo_New(void)
+{
+    return picture_fifo_NewBounded(0);
+}
+
 void picture_fifo_Push(picture_fifo_t *fifo, picture_t *picture)
 {
     vlc_mutex_lock(&fifo->lock);
     PictureFifoPush(fifo, picture);
     vlc_mutex_unlock(&fifo->lock);
 }
+int picture_fifo_WaitSpace(picture_fifo_t *fifo, vlc_tick_t deadline)
+{
+    int ret = 0;
+
+    vlc_mutex_lock(&fifo->lock);
+    while (PictureFifoIsFull(fifo) && ret == 0)
+    {
+        if (deadline == VLC_TICK_INVALID)
+            vlc_cond_wait(&fifo->wait_space, &fifo->lock);
+        else
+            ret = vlc_cond_timedwait(&fifo->wait_space, &fifo->lock, deadline);
+    }
+    if (ret != 0 && !PictureFifoIsFull(fifo))
+        ret = 0; /* room was made just on time */
+    vlc_mutex_unlock(&fifo->lock);
+
+    return ret;
+}
 picture_t *picture_fifo_Pop(picture_fifo_t *fifo)
 {
     vlc_mutex_lock(&fifo->lock);
     picture_t *picture = PictureFifoPop(fifo);
+    if (picture != NULL)
+        PictureFifoSignalSpace(fifo);
     vlc_mutex_unlock(&fifo->lock);
 
     return picture;
 }
+size_t picture_fifo_PopUntil(picture_fifo_t *fifo, vlc_tick_t date,
+                             vlc_picture_chain_t *out)
+{
+    size_t count = 0;
+
+    vlc_picture_chain_Init(out);
+
+    vlc_mutex_lock(&fifo->lock);
+    while (!vlc_picture_chain_IsEmpty(&fifo->pics)
+        && fifo->pics.front->date <= date)
+    {
+        vlc_picture_chain_Append(out, PictureFifoPop(fifo));
+        count++;
+    }
+    if (count > 0)
+        PictureFifoSignalSpace(fifo);
+    vlc_mutex_unlock(&fifo->lock);
+
+    return count;
+}
+vlc_tick_t picture_fifo_PeekDate(picture_fifo_t *fifo)
+{
+    vlc_mutex_lock(&fifo->lock);
+    vlc_tick_t date = vlc_picture_chain_IsEmpty(&fifo->pics)
+                    ? VLC_TICK_INVALID : fifo->pics.front->date;
+    vlc_mutex_unlock(&fifo->lock);
+
+    return date;
+}
 bool picture_fifo_IsEmpty(picture_fifo_t *fifo)
 {
     vlc_mutex_lock(&fifo->lock);
@@ -89,6 +163,14 @@ bool picture_fifo_IsEmpty(picture_fifo_t *fifo)
 
     return empty;
 }
+size_t picture_fifo_GetCount(picture_fifo_t *fifo)
+{
+    vlc_mutex_lock(&fifo->lock);
+    size_t count = fifo->count;
+    vlc_mutex_unlock(&fifo->lock);
+
+    return count;
+}
 void picture_fifo_Flush(picture_fifo_t *fifo, vlc_tick_t date, bool flush_before)
 {
     picture_t *picture;
@@ -98,11 +180,13 @@ void picture_fifo_Flush(picture_fifo_t *fifo, vlc_tick_t date, bool flush_before
     vlc_picture_chain_Init(&flush_chain);
 
     vlc_mutex_lock(&fifo->lock);
-    if (date == VLC_TICK_INVALID)
+    if (date == VLC_TICK_INVALID) {
         vlc_picture_chain_GetAndClear(&fifo->pics, &flush_chain);
-    else {
+        fifo->count = 0;
+    } else {
         vlc_picture_chain_t filter_chain;
         vlc_picture_chain_GetAndClear(&fifo->pics, &filter_chain);
+        fifo->count = 0;
 
         while ( !vlc_picture_chain_IsEmpty( &filter_chain ) ) {
             picture = vlc_picture_chain_PopFront( &filter_chain );
@@ -114,6 +198,7 @@ void picture_fifo_Flush(picture_fifo_t *fifo, vlc_tick_t date, bool flush_before
                 PictureFifoPush(fifo, picture);
         }
     }
+    PictureFifoSignalSpace(fifo);
     vlc_mutex_unlock(&fifo->lock);
 
     while ((picture = vlc_picture_chain_PopFront(&flush_chain)) != NULL)
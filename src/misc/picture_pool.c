@@ -35,19 +35,22 @@
 #include <vlc_threads.h>
 #include <vlc_picture_pool.h>
 #include <vlc_atomic.h>
-#include <vlc_list.h>
 #include "picture.h"
 
 #define POOL_MAX 256
+#define POOL_WORD_BITS (sizeof (unsigned long) * CHAR_BIT)
+#define POOL_WORDS ((POOL_MAX + POOL_WORD_BITS - 1) / POOL_WORD_BITS)
 
 struct picture_pool_t {
     vlc_mutex_t lock;
     vlc_cond_t  wait;
+    atomic_uint waiters;
 
     vlc_atomic_rc_t    refs;
-    bool released;
-    struct vlc_list inuse_list;
-    struct vlc_list available_list;
+    unsigned picture_count;
+    /* Bitmap of available pictures, acquired and released without locking */
+    atomic_ulong available[POOL_WORDS];
+    picture_t  *picture[];
 };
 
 static void picture_pool_Destroy(picture_pool_t *pool)
@@ -55,33 +58,51 @@ static void picture_pool_Destroy(picture_pool_t *pool)
     if (!vlc_atomic_rc_dec(&pool->refs))
         return;
 
-    assert(vlc_list_is_empty(&pool->inuse_list));
-    assert(vlc_list_is_empty(&pool->available_list));
-
     free(pool);
 }
 
 void picture_pool_Release(picture_pool_t *pool)
 {
-    vlc_mutex_lock(&pool->lock);
+    /* In-use cloned pictures hold a reference to their original picture and
+     * to the pool, so they remain valid until they are released. */
+    for (unsigned i = 0; i < pool->picture_count; i++)
+        picture_Release(pool->picture[i]);
+    picture_pool_Destroy(pool);
+}
 
-    /* Release pictures from both available and in-use lists */
-    for (size_t i = 0; i < 2; ++i)
+static int picture_pool_TryAcquire(picture_pool_t *pool)
+{
+    for (size_t i = 0; i < POOL_WORDS; i++)
     {
-        struct vlc_list *list = i == 0 ? &pool->available_list : &pool->inuse_list;
+        unsigned long mask = atomic_load(&pool->available[i]);
 
-        picture_priv_t *priv;
-        vlc_list_foreach(priv, list, pool_node)
+        while (mask != 0)
         {
-            assert(priv->pool == pool);
-            vlc_list_remove(&priv->pool_node);
-            picture_Release(&priv->picture);
+            unsigned long bit = mask & -mask;
+
+            mask = atomic_fetch_and(&pool->available[i], ~bit);
+            if (mask & bit)
+                return i * POOL_WORD_BITS + stdc_trailing_zeros(bit);
         }
     }
-    /* Prevent in-use cloned pictures to be added back to lists */
-    pool->released = true;
-    vlc_mutex_unlock(&pool->lock);
-    picture_pool_Destroy(pool);
+    return -1;
+}
+
+static void picture_pool_Return(picture_pool_t *pool, unsigned index)
+{
+    unsigned long bit = 1UL << (index % POOL_WORD_BITS);
+
+    atomic_fetch_or(&pool->available[index / POOL_WORD_BITS], bit);
+
+    /* Slow path: only bother the lock if a thread is (about to be) waiting.
+     * Both sides use sequentially consistent operations, so either the
+     * waiter sees the returned picture, or we see the waiter. */
+    if (atomic_load(&pool->waiters) > 0)
+    {
+        vlc_mutex_lock(&pool->lock);
+        vlc_cond_signal(&pool->wait);
+        vlc_mutex_unlock(&pool->lock);
+    }
 }
 
 static void picture_pool_ReleaseClone(picture_t *clone)
@@ -95,57 +116,58 @@ static void picture_pool_ReleaseClone(picture_t *clone)
     picture_pool_t *pool = original_priv->pool;
     assert(pool != NULL);
 
-    vlc_mutex_lock(&pool->lock);
-
-    if (!pool->released)
-    {
-        vlc_list_remove(&original_priv->pool_node);
-        vlc_list_append(&original_priv->pool_node, &pool->available_list);
-        vlc_cond_signal(&pool->wait);
-    }
-
-    vlc_mutex_unlock(&pool->lock);
-
+    picture_pool_Return(pool, original_priv->pool_index);
     picture_Release(original);
 
     picture_pool_Destroy(pool);
 }
 
 static picture_t *picture_pool_ClonePicture(picture_pool_t *pool,
-                                            picture_t *picture)
+                                            unsigned index)
 {
+    picture_t *picture = pool->picture[index];
     picture_t *clone = picture_InternalClone(picture, picture_pool_ReleaseClone,
                                              picture);
     if (clone != NULL) {
         assert(!picture_HasChainedPics(clone));
         vlc_atomic_rc_inc(&pool->refs);
-    }
+    } else
+        picture_pool_Return(pool, index);
     return clone;
 }
 
 static void picture_pool_AppendPic(picture_pool_t *pool, picture_t *pic)
 {
     picture_priv_t *priv = container_of(pic, picture_priv_t, picture);
+    unsigned index = pool->picture_count++;
+
     assert(priv->pool == NULL);
-    vlc_list_append(&priv->pool_node, &pool->available_list);
+    assert(index < POOL_MAX);
+    pool->picture[index] = pic;
     priv->pool = pool;
+    priv->pool_index = index;
+    atomic_fetch_or_explicit(&pool->available[index / POOL_WORD_BITS],
+                             1UL << (index % POOL_WORD_BITS),
+                             memory_order_relaxed);
 }
 
 static picture_pool_t *
-picture_pool_NewCommon(void)
+picture_pool_NewCommon(unsigned count)
 {
-    picture_pool_t *pool = malloc(sizeof(*pool));
+    picture_pool_t *pool = malloc(sizeof (*pool)
+                                  + count * sizeof (pool->picture[0]));
 
     if (unlikely(pool == NULL))
         return NULL;
 
-    vlc_list_init(&pool->inuse_list);
-    vlc_list_init(&pool->available_list);
+    pool->picture_count = 0;
+    for (size_t i = 0; i < POOL_WORDS; i++)
+        atomic_init(&pool->available[i], 0);
 
     vlc_mutex_init(&pool->lock);
     vlc_cond_init(&pool->wait);
+    atomic_init(&pool->waiters, 0);
     vlc_atomic_rc_init(&pool->refs);
-    pool->released = false;
 
     return pool;
 }
@@ -155,7 +177,7 @@ picture_pool_t *picture_pool_New(unsigned count, picture_t *const *tab)
     if (unlikely(count > POOL_MAX))
         return NULL;
 
-    picture_pool_t *pool = picture_pool_NewCommon();
+    picture_pool_t *pool = picture_pool_NewCommon(count);
     if (unlikely(pool == NULL))
         return NULL;
 
@@ -172,7 +194,7 @@ picture_pool_t *picture_pool_NewFromFormat(const video_format_t *fmt,
     if (unlikely(count > POOL_MAX))
         return NULL;
 
-    picture_pool_t *pool = picture_pool_NewCommon();
+    picture_pool_t *pool = picture_pool_NewCommon(count);
     if (unlikely(pool == NULL))
         return NULL;
 
@@ -190,51 +212,34 @@ picture_pool_t *picture_pool_NewFromFormat(const video_format_t *fmt,
     return pool;
 }
 
-static picture_t *picture_pool_GetAvailableLocked(picture_pool_t *pool)
-{
-    picture_priv_t *priv = vlc_list_first_entry_or_null(&pool->available_list,
-                                                        picture_priv_t,
-                                                        pool_node);
-    assert(priv != NULL);
-
-    assert(priv->pool == pool);
-
-    vlc_list_remove(&priv->pool_node);
-    vlc_list_append(&priv->pool_node, &pool->inuse_list);
-
-    return &priv->picture;
-}
-
 picture_t *picture_pool_Get(picture_pool_t *pool)
 {
-
-    vlc_mutex_lock(&pool->lock);
     assert(vlc_atomic_rc_get(&pool->refs) > 0);
 
-    if (vlc_list_is_empty(&pool->available_list))
-    {
-        vlc_mutex_unlock(&pool->lock);
+    int index = picture_pool_TryAcquire(pool);
+    if (index < 0)
         return NULL;
-    }
-
-    picture_t *pic = picture_pool_GetAvailableLocked(pool);
 
-    vlc_mutex_unlock(&pool->lock);
-
-    return picture_pool_ClonePicture(pool, pic);
+    return picture_pool_ClonePicture(pool, index);
 }
 
 picture_t *picture_pool_Wait(picture_pool_t *pool)
 {
-    vlc_mutex_lock(&pool->lock);
     assert(vlc_atomic_rc_get(&pool->refs) > 0);
 
-    while (vlc_list_is_empty(&pool->available_list))
-        vlc_cond_wait(&pool->wait, &pool->lock);
+    int index = picture_pool_TryAcquire(pool);
+    if (index < 0)
+    {
+        /* Slow path: the pool is empty */
+        vlc_mutex_lock(&pool->lock);
+        atomic_fetch_add(&pool->waiters, 1);
 
-    picture_t *pic = picture_pool_GetAvailableLocked(pool);
+        while ((index = picture_pool_TryAcquire(pool)) < 0)
+            vlc_cond_wait(&pool->wait, &pool->lock);
 
-    vlc_mutex_unlock(&pool->lock);
+        atomic_fetch_sub(&pool->waiters, 1);
+        vlc_mutex_unlock(&pool->lock);
+    }
 
-    return picture_pool_ClonePicture(pool, pic);
+    return picture_pool_ClonePicture(pool, index);
 }
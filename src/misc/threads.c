@@ -26,6 +26,7 @@
 #include <errno.h>
 #include <limits.h>
 #include <stdatomic.h>
+#include <time.h>
 
 #include <vlc_common.h>
 #include <vlc_threads.h>
@@ -318,6 +319,17 @@ int vlc_cond_timedwait_daytime(vlc_cond_t *cond, vlc_mutex_t *mutex,
     return ret;
 }
 
+vlc_tick_t vlc_thread_cputime(void)
+{
+#if defined(CLOCK_THREAD_CPUTIME_ID) && !defined(_WIN32)
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0)
+        return vlc_tick_from_timespec(&ts);
+#endif
+    return vlc_tick_now();
+}
+
 /*** Generic semaphores ***/
 
 void vlc_sem_init (vlc_sem_t *sem, unsigned value)
@@ -31,6 +31,14 @@
 
 int vlc_cond_timedwait_daytime(vlc_cond_t *, vlc_mutex_t *, time_t);
 
+/**
+ * CPU time consumed by the calling thread.
+ *
+ * Only differences between two values are meaningful. Where the platform
+ * cannot tell, this is the monotonic time, including the time spent waiting.
+ */
+vlc_tick_t vlc_thread_cputime(void);
+
 /*
  * Queued mutex
  *
@@ -27,9 +27,6 @@
 # include "config.h"
 #endif
 
-#ifdef HAVE_SEARCH_H
-# include <search.h>
-#endif
 #include <assert.h>
 #include <float.h>
 #include <math.h>
@@ -67,7 +64,9 @@ typedef struct variable_ops_t
  */
 struct variable_t
 {
-    char *       psz_name; /**< The variable unique name (must be first) */
+    char *       psz_name; /**< The variable unique name */
+    uint32_t     hash; /**< Hash of the name */
+    struct variable_t *hash_next; /**< Next variable in the hash bucket */
 
     /** The variable's exported value */
     vlc_value_t  val;
@@ -138,23 +137,83 @@ int_ops    = { CmpInt,     DupDummy,  FreeDummy,  },
 string_ops = { CmpString,  DupString, FreeString, },
 coords_ops = { NULL,       DupDummy,  FreeDummy,  };
 
-static int varcmp( const void *a, const void *b )
+static uint32_t VarHash( const char *psz_name )
+{
+    /* FNV-1a */
+    uint32_t hash = 2166136261u;
+
+    for (const unsigned char *p = (const unsigned char *)psz_name; *p; p++)
+        hash = (hash ^ *p) * 16777619u;
+    return hash;
+}
+
+static variable_t *VarFind( vlc_object_internals_t *priv,
+                            const char *psz_name, uint32_t hash )
+{
+    vlc_mutex_assert(&priv->var_lock);
+
+    if (priv->var_buckets == 0)
+        return NULL;
+
+    for (variable_t *var = priv->var_table[hash & (priv->var_buckets - 1)];
+         var != NULL; var = var->hash_next)
+        if (var->hash == hash && strcmp(var->psz_name, psz_name) == 0)
+            return var;
+    return NULL;
+}
+
+static int VarInsert( vlc_object_internals_t *priv, variable_t *var )
+{
+    vlc_mutex_assert(&priv->var_lock);
+
+    if (priv->var_count >= priv->var_buckets)
+    {   /* Keep the load factor under one */
+        size_t buckets = priv->var_buckets ? 2 * priv->var_buckets : 16;
+        variable_t **table = calloc(buckets, sizeof (*table));
+        if (unlikely(table == NULL))
+            return VLC_ENOMEM;
+
+        for (size_t i = 0; i < priv->var_buckets; i++)
+            for (variable_t *v = priv->var_table[i], *next; v != NULL; v = next)
+            {
+                next = v->hash_next;
+                v->hash_next = table[v->hash & (buckets - 1)];
+                table[v->hash & (buckets - 1)] = v;
+            }
+
+        free(priv->var_table);
+        priv->var_table = table;
+        priv->var_buckets = buckets;
+    }
+
+    variable_t **pp = &priv->var_table[var->hash & (priv->var_buckets - 1)];
+    var->hash_next = *pp;
+    *pp = var;
+    priv->var_count++;
+    return VLC_SUCCESS;
+}
+
+static void VarRemove( vlc_object_internals_t *priv, variable_t *var )
 {
-    const variable_t *va = a, *vb = b;
+    vlc_mutex_assert(&priv->var_lock);
 
-    /* psz_name must be first */
-    assert( va == (const void *)&va->psz_name );
-    return strcmp( va->psz_name, vb->psz_name );
+    variable_t **pp = &priv->var_table[var->hash & (priv->var_buckets - 1)];
+    while (*pp != var)
+    {
+        assert(*pp != NULL);
+        pp = &(*pp)->hash_next;
+    }
+    *pp = var->hash_next;
+    assert(priv->var_count > 0);
+    priv->var_count--;
 }
 
 static variable_t *Lookup( vlc_object_t *obj, const char *psz_name )
 {
     vlc_object_internals_t *priv = vlc_internals( obj );
-    void **pp_var;
 
     vlc_mutex_lock(&priv->var_lock);
-    pp_var = tfind( &psz_name, &priv->var_root, varcmp );
-    return (pp_var != NULL) ? *pp_var : NULL;
+    return VarFind(priv, psz_name, VarHash(psz_name));
 }
 
 static void Destroy( variable_t *p_var )
@@ -295,6 +354,7 @@ int (var_Create)( vlc_object_t *p_this, const char *psz_name, int i_type )
         return VLC_ENOMEM;
 
     p_var->psz_name = strdup( psz_name );
+    p_var->hash = VarHash( psz_name );
     p_var->psz_text = NULL;
 
     p_var->i_type = i_type & ~VLC_VAR_DOINHERIT;
@@ -354,17 +414,18 @@ int (var_Create)( vlc_object_t *p_this, const char *psz_name, int i_type )
         var_Inherit(p_this, psz_name, i_type, &p_var->val);
 
     vlc_object_internals_t *p_priv = vlc_internals( p_this );
-    void **pp_var;
     variable_t *p_oldvar;
     int ret = VLC_SUCCESS;
 
     vlc_mutex_lock( &p_priv->var_lock );
 
-    pp_var = tsearch( p_var, &p_priv->var_root, varcmp );
-    if( unlikely(pp_var == NULL) )
-        ret = VLC_ENOMEM;
-    else if( (p_oldvar = *pp_var) == p_var ) /* Variable create */
-        p_var = NULL; /* Variable created */
+    p_oldvar = VarFind( p_priv, psz_name, p_var->hash );
+    if( p_oldvar == NULL ) /* Variable create */
+    {
+        ret = VarInsert( p_priv, p_var );
+        if( likely(ret == VLC_SUCCESS) )
+            p_var = NULL; /* Variable created */
+    }
     else /* Variable already exists */
     {
         assert (((i_type ^ p_oldvar->i_type) & VLC_VAR_CLASS) == 0);
@@ -394,7 +455,7 @@ void (var_Destroy)(vlc_object_t *p_this, const char *psz_name)
     else if( --p_var->i_usage == 0 )
     {
         assert(!p_var->b_incallback);
-        tdelete( p_var, &p_priv->var_root, varcmp );
+        VarRemove( p_priv, p_var );
     }
     else
     {
@@ -407,17 +468,22 @@ void (var_Destroy)(vlc_object_t *p_this, const char *psz_name)
         Destroy( p_var );
 }
 
-static void CleanupVar( void *var )
-{
-    Destroy( var );
-}
-
 void var_DestroyAll( vlc_object_t *obj )
 {
     vlc_object_internals_t *priv = vlc_internals( obj );
 
-    tdestroy( priv->var_root, CleanupVar );
-    priv->var_root = NULL;
+    for (size_t i = 0; i < priv->var_buckets; i++)
+        for (variable_t *var = priv->var_table[i], *next; var != NULL;
+             var = next)
+        {
+            next = var->hash_next;
+            Destroy( var );
+        }
+
+    free( priv->var_table );
+    priv->var_table = NULL;
+    priv->var_buckets = 0;
+    priv->var_count = 0;
 }
 
 int (var_Change)(vlc_object_t *p_this, const char *psz_name, int i_action, ...)
@@ -673,23 +739,12 @@ int (var_Type)(vlc_object_t *p_this, const char *psz_name)
     return i_type;
 }
 
-int (var_SetChecked)(vlc_object_t *p_this, const char *psz_name,
-                     int expected_type, vlc_value_t val)
+static void SetLocked(vlc_object_t *p_this, variable_t *p_var,
+                      const char *psz_name, int expected_type,
+                      vlc_value_t val)
 {
-    variable_t *p_var;
     vlc_value_t oldval;
 
-    assert( p_this );
-
-    vlc_object_internals_t *p_priv = vlc_internals( p_this );
-
-    p_var = Lookup( p_this, psz_name );
-    if( p_var == NULL )
-    {
-        vlc_mutex_unlock( &p_priv->var_lock );
-        return VLC_ENOENT;
-    }
-
     assert( expected_type == 0 ||
             (p_var->i_type & VLC_VAR_CLASS) == expected_type );
     assert ((p_var->i_type & VLC_VAR_CLASS) != VLC_VAR_VOID);
@@ -713,6 +768,25 @@ int (var_SetChecked)(vlc_object_t *p_this, const char *psz_name,
 
     /* Free data if needed */
     p_var->ops->pf_free( &oldval );
+}
+
+int (var_SetChecked)(vlc_object_t *p_this, const char *psz_name,
+                     int expected_type, vlc_value_t val)
+{
+    variable_t *p_var;
+
+    assert( p_this );
+
+    vlc_object_internals_t *p_priv = vlc_internals( p_this );
+
+    p_var = Lookup( p_this, psz_name );
+    if( p_var == NULL )
+    {
+        vlc_mutex_unlock( &p_priv->var_lock );
+        return VLC_ENOENT;
+    }
+
+    SetLocked( p_this, p_var, psz_name, expected_type, val );
 
     vlc_mutex_unlock( &p_priv->var_lock );
     return VLC_SUCCESS;
@@ -723,6 +797,20 @@ int (var_Set)(vlc_object_t *p_this, const char *psz_name, vlc_value_t val)
     return var_SetChecked( p_this, psz_name, 0, val );
 }
 
+static void GetLocked(variable_t *p_var, int expected_type,
+                      vlc_value_t *p_val)
+{
+    assert( expected_type == 0 ||
+            (p_var->i_type & VLC_VAR_CLASS) == expected_type );
+    assert ((p_var->i_type & VLC_VAR_CLASS) != VLC_VAR_VOID);
+
+    /* Really get the variable */
+    *p_val = p_var->val;
+
+    /* Duplicate value if needed */
+    p_var->ops->pf_dup( p_val );
+}
+
 int (var_GetChecked)(vlc_object_t *p_this, const char *psz_name,
                      int expected_type, vlc_value_t *p_val)
 {
@@ -734,17 +822,7 @@ int (var_GetChecked)(vlc_object_t *p_this, const char *psz_name,
 
     p_var = Lookup( p_this, psz_name );
     if( p_var != NULL )
-    {
-        assert( expected_type == 0 ||
-                (p_var->i_type & VLC_VAR_CLASS) == expected_type );
-        assert ((p_var->i_type & VLC_VAR_CLASS) != VLC_VAR_VOID);
-
-        /* Really get the variable */
-        *p_val = p_var->val;
-
-        /* Duplicate value if needed */
-        p_var->ops->pf_dup( p_val );
-    }
+        GetLocked( p_var, expected_type, p_val );
     else
         err = VLC_ENOENT;
 
@@ -757,6 +835,61 @@ int (var_Get)(vlc_object_t *p_this, const char *psz_name, vlc_value_t *p_val)
     return var_GetChecked( p_this, psz_name, 0, p_val );
 }
 
+vlc_var_handle_t *(var_Resolve)(vlc_object_t *p_this, const char *psz_name)
+{
+    assert( p_this );
+
+    vlc_object_internals_t *p_priv = vlc_internals( p_this );
+    variable_t *p_var = Lookup( p_this, psz_name );
+
+    if( p_var != NULL )
+    {
+        p_var->i_usage++;
+        assert(p_var->i_usage != 0);
+    }
+    vlc_mutex_unlock( &p_priv->var_lock );
+    return p_var;
+}
+
+void (var_ReleaseHandle)(vlc_object_t *p_this, vlc_var_handle_t *p_var)
+{
+    vlc_object_internals_t *p_priv = vlc_internals( p_this );
+
+    vlc_mutex_lock( &p_priv->var_lock );
+    assert( p_var->i_usage > 0 );
+    if( --p_var->i_usage == 0 )
+    {
+        assert(!p_var->b_incallback);
+        VarRemove( p_priv, p_var );
+    }
+    else
+        p_var = NULL;
+    vlc_mutex_unlock( &p_priv->var_lock );
+
+    if( p_var != NULL )
+        Destroy( p_var );
+}
+
+void (var_SetHandle)(vlc_object_t *p_this, vlc_var_handle_t *p_var,
+                     int expected_type, vlc_value_t val)
+{
+    vlc_object_internals_t *p_priv = vlc_internals( p_this );
+
+    vlc_mutex_lock( &p_priv->var_lock );
+    SetLocked( p_this, p_var, p_var->psz_name, expected_type, val );
+    vlc_mutex_unlock( &p_priv->var_lock );
+}
+
+void (var_GetHandle)(vlc_object_t *p_this, vlc_var_handle_t *p_var,
+                     int expected_type, vlc_value_t *p_val)
+{
+    vlc_object_internals_t *p_priv = vlc_internals( p_this );
+
+    vlc_mutex_lock( &p_priv->var_lock );
+    GetLocked( p_var, expected_type, p_val );
+    vlc_mutex_unlock( &p_priv->var_lock );
+}
+
 typedef enum
 {
     vlc_value_callback,
@@ -1135,21 +1268,6 @@ error:
     return VLC_EGENERIC;
 }
 
-static thread_local void *twalk_ctx;
-
-static void TwalkGetNames(const void *data, const VISIT which, const int depth)
-{
-    if (which != postorder && which != leaf)
-        return;
-    (void) depth;
-
-    const variable_t *var = *(const variable_t **)data;
-    DECL_ARRAY(char *) *names = twalk_ctx;
-    char *dup = strdup(var->psz_name);
-    if (dup != NULL)
-        ARRAY_APPEND(*names, dup);
-}
-
 char **var_GetAllNames(vlc_object_t *obj)
 {
     vlc_object_internals_t *priv = vlc_internals(obj);
@@ -1157,9 +1275,15 @@ char **var_GetAllNames(vlc_object_t *obj)
     DECL_ARRAY(char *) names;
     ARRAY_INIT(names);
 
-    twalk_ctx = &names;
     vlc_mutex_lock(&priv->var_lock);
-    twalk(priv->var_root, TwalkGetNames);
+    for (size_t i = 0; i < priv->var_buckets; i++)
+        for (const variable_t *var = priv->var_table[i]; var != NULL;
+             var = var->hash_next)
+        {
+            char *dup = strdup(var->psz_name);
+            if (dup != NULL)
+                ARRAY_APPEND(names, dup);
+        }
     vlc_mutex_unlock(&priv->var_lock);
 
     if (names.i_size == 0)
@@ -38,7 +38,9 @@ struct vlc_object_internals
     const char *typename; /**< Object type human-readable name */
 
     /* Object variables */
-    void           *var_root;
+    variable_t    **var_table; /**< Hash table buckets (or NULL) */
+    size_t          var_buckets; /**< Number of buckets (a power of two) */
+    size_t          var_count; /**< Number of variables */
     vlc_mutex_t     var_lock;
 
     /* Object resources */
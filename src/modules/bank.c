@@ -105,6 +105,18 @@ static struct
 
 vlc_plugin_t *vlc_plugins = NULL;
 
+#ifdef HAVE_DYNAMIC_PLUGINS
+/** Plug-in loading statistics */
+static struct
+{
+    size_t cached; /**< Plug-ins described from a cache */
+    size_t scanned; /**< Plug-ins loaded to be described */
+    vlc_tick_t scan_time; /**< Time spent loading plug-ins to describe them */
+    atomic_size_t mapped; /**< Plug-ins loaded on first use */
+    _Atomic vlc_tick_t map_time; /**< Time spent loading plug-ins on use */
+} stats;
+#endif
+
 /**
  * Adds a module to the bank
  */
@@ -337,16 +349,25 @@ static int AllocatePluginFile (module_bank_t *bank, const char *abspath,
         if (path == NULL)
             return -1;
 
+        vlc_tick_t start = vlc_tick_now();
         plugin = module_InitDynamic(bank->obj, abspath, true);
+        vlc_tick_t duration = vlc_tick_now() - start;
+
+        stats.scanned++;
+        stats.scan_time += duration;
 
         if (plugin != NULL)
         {
+            msg_Dbg(bank->obj, "described plug-in %s in %"PRId64" us",
+                    relpath, US_FROM_VLC_TICK(duration));
             plugin->path = path;
             plugin->mtime = st->st_mtime;
             plugin->size = st->st_size;
         }
         else free(path);
     }
+    else
+        stats.cached++;
 
     if (plugin == NULL)
         return -1;
@@ -633,6 +654,7 @@ int vlc_plugin_Map(struct vlc_logger *log, vlc_plugin_t *plugin)
     /* Try to load the plug-in (without locks, so read-only) */
     assert(plugin->abspath != NULL);
 
+    vlc_tick_t start = vlc_tick_now();
     void *handle = module_Open(log, plugin->abspath, false);
     if (handle == NULL)
         return -1;
@@ -658,9 +680,22 @@ int vlc_plugin_Map(struct vlc_logger *log, vlc_plugin_t *plugin)
                               memory_order_release);
     }
     else /* Another thread won the race to load the plugin */
+    {
         vlc_dlclose(handle);
+        handle = NULL;
+    }
     vlc_mutex_unlock(&lock);
 
+    if (handle != NULL)
+    {
+        vlc_tick_t duration = vlc_tick_now() - start;
+
+        atomic_fetch_add_explicit(&stats.mapped, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&stats.map_time, duration,
+                                  memory_order_relaxed);
+        vlc_debug(log, "loaded plug-in %s in %"PRId64" us", plugin->abspath,
+                  US_FROM_VLC_TICK(duration));
+    }
     return 0;
 error:
     vlc_dlclose(handle);
@@ -808,6 +843,12 @@ void module_LoadPlugins(libvlc_int_t *obj)
     {
         module_InitStaticModules ();
 #ifdef HAVE_DYNAMIC_PLUGINS
+        stats.cached = 0;
+        stats.scanned = 0;
+        stats.scan_time = 0;
+        atomic_store_explicit(&stats.mapped, 0, memory_order_relaxed);
+        atomic_store_explicit(&stats.map_time, 0, memory_order_relaxed);
+
         msg_Dbg (obj, "searching plug-in modules");
         AllocateAllPlugins (obj);
 #endif
@@ -819,6 +860,36 @@ void module_LoadPlugins(libvlc_int_t *obj)
     vlc_mutex_unlock (&modules.lock);
 
     msg_Dbg (obj, "plug-ins loaded: %zu modules", modules.count);
+#ifdef HAVE_DYNAMIC_PLUGINS
+    msg_Dbg (obj, "plug-ins described: %zu from cache, %zu loaded in %"PRId64
+             " ms", stats.cached, stats.scanned,
+             MS_FROM_VLC_TICK(stats.scan_time));
+#endif
+}
+
+/**
+ * Reports how many plug-ins were loaded on demand.
+ *
+ * \param obj object to log the report with
+ */
+void module_LogStats(vlc_object_t *obj)
+{
+#ifdef HAVE_DYNAMIC_PLUGINS
+    size_t total = 0;
+
+    vlc_mutex_lock(&modules.lock);
+    for (vlc_plugin_t *lib = vlc_plugins; lib != NULL; lib = lib->next)
+        if (lib->abspath != NULL)
+            total++;
+    vlc_mutex_unlock(&modules.lock);
+
+    msg_Dbg(obj, "plug-ins used: %zu of %zu loaded on demand in %"PRId64" ms",
+            atomic_load_explicit(&stats.mapped, memory_order_relaxed), total,
+            MS_FROM_VLC_TICK(atomic_load_explicit(&stats.map_time,
+                                                  memory_order_relaxed)));
+#else
+    (void) obj;
+#endif
 }
 
 void module_list_free (module_t **list)
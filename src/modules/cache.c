@@ -200,17 +200,23 @@ static int vlc_cache_load_config(struct vlc_param *param, block_t *file)
         const char *psz;
         LOAD_STRING(psz);
         cfg->orig.psz = (char *)psz;
-        atomic_init(&param->value.str, NULL);
-        vlc_param_SetString(param, psz);
+
+        /* The parameter is not visible yet: no need for RCU here, unlike
+         * vlc_param_SetString(). */
+        char *str = NULL;
+        if (psz != NULL && psz[0] != '\0'
+         && unlikely((str = strdup(psz)) == NULL))
+            goto error;
+        atomic_init(&param->value.str, str);
+        cfg->value.psz = str;
 
         if (cfg->list_count)
             cfg->list.psz = xmalloc (cfg->list_count * sizeof (char *));
         for (unsigned i = 0; i < cfg->list_count; i++)
         {
             LOAD_STRING (cfg->list.psz[i]);
-            if (cfg->list.psz[i] == NULL /* NULL -> empty string */
-             && (cfg->list.psz[i] = calloc (1, 1)) == NULL)
-                goto error;
+            if (cfg->list.psz[i] == NULL) /* NULL -> empty string */
+                cfg->list.psz[i] = "";
         }
     }
     else
@@ -234,13 +240,15 @@ static int vlc_cache_load_config(struct vlc_param *param, block_t *file)
         LOAD_ARRAY(cfg->list.i, cfg->list_count);
     }
 
-    cfg->list_text = xmalloc (cfg->list_count * sizeof (char *));
+    if (cfg->list_count)
+        cfg->list_text = xmalloc (cfg->list_count * sizeof (char *));
+    else
+        cfg->list_text = NULL;
     for (unsigned i = 0; i < cfg->list_count; i++)
     {
         LOAD_STRING (cfg->list_text[i]);
-        if (cfg->list_text[i] == NULL /* NULL -> empty string */
-         && (cfg->list_text[i] = calloc (1, 1)) == NULL)
-            goto error;
+        if (cfg->list_text[i] == NULL) /* NULL -> empty string */
+            cfg->list_text[i] = "";
     }
 
     return 0;
@@ -444,7 +452,10 @@ vlc_plugin_t *vlc_cache_load(libvlc_int_t *p_this, const char *dir,
         return NULL;
     }
 
-    vlc_plugin_t *cache = NULL;
+    /* Keep the plugins in the order of the file, which is also the order of
+     * the directory scan: vlc_cache_lookup() then finds each plugin at the
+     * head of the list. */
+    vlc_plugin_t *cache = NULL, **tailp = &cache;
 
     while (file->i_buffer > 0)
     {
@@ -460,8 +471,9 @@ vlc_plugin_t *vlc_cache_load(libvlc_int_t *p_this, const char *dir,
             goto error;
         }
 
-        plugin->next = cache;
-        cache = plugin;
+        plugin->next = NULL;
+        *tailp = plugin;
+        tailp = &plugin->next;
     }
 
     file->p_next = *backingp;
@@ -471,7 +483,13 @@ vlc_plugin_t *vlc_cache_load(libvlc_int_t *p_this, const char *dir,
 error:
     msg_Warn( p_this, "plugins cache not loaded (corrupted)" );
 
-    /* TODO: cleanup */
+    while (cache != NULL)
+    {
+        vlc_plugin_t *plugin = cache;
+
+        cache = plugin->next;
+        vlc_plugin_destroy(plugin);
+    }
     block_Release(file);
     return NULL;
 }
@@ -225,11 +225,18 @@ module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
             continue;
 
         va_list ap;
+        vlc_tick_t start = vlc_tick_now();
 
         va_copy(ap, args);
         ret = probe(cb, i < strict_total, ap);
         va_end(ap);
 
+        vlc_tick_t elapsed = vlc_tick_now() - start;
+        if (elapsed >= VLC_TICK_FROM_MS(10))
+            vlc_debug(log, "%s module \"%s\" probed in %"PRId64" ms",
+                      capability, module_get_object(cand),
+                      MS_FROM_VLC_TICK(elapsed));
+
         switch (ret) {
             case VLC_SUCCESS:
                 vlc_debug(log, "using %s module \"%s\"", capability,
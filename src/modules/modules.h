@@ -111,6 +111,7 @@ int vlc_plugin_resolve(vlc_plugin_t *, vlc_plugin_cb);
 void module_InitBank (void);
 void module_LoadPlugins(libvlc_int_t *);
 void module_EndBank (bool);
+void module_LogStats(vlc_object_t *);
 int vlc_plugin_Map(struct vlc_logger *, vlc_plugin_t *);
 void *vlc_plugin_Symbol(struct vlc_logger *, vlc_plugin_t *, const char *name);
 
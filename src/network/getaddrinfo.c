@@ -35,6 +35,9 @@
 
 #include <sys/types.h>
 #include <vlc_network.h>
+#include <vlc_list.h>
+#include <vlc_variables.h>
+#include "../libvlc.h"
 
 int vlc_getnameinfo( const struct sockaddr *sa, int salen,
                      char *host, int hostlen, int *portnum, int flags )
@@ -107,6 +110,230 @@ int vlc_getaddrinfo (const char *node, unsigned port,
     return getaddrinfo (node, servname, hints, res);
 }
 
+/*
+ * Resolution cache
+ *
+ * getaddrinfo() does not expose the DNS records time-to-live, so positive
+ * results are kept for a fixed time. The cached lists are shared
+ * read-only by their users, and freed only once no longer referenced.
+ */
+#define VLC_GAI_CACHE_MAX 32
+
+struct vlc_gai_entry
+{
+    struct vlc_list node;
+    struct addrinfo *res;
+    vlc_tick_t expiry;
+    unsigned refs;
+    bool cached; /**< whether new lookups can use the entry */
+    unsigned port;
+    int family;
+    int socktype;
+    int protocol;
+    int flags;
+    char name[];
+};
+
+static struct
+{
+    vlc_mutex_t lock;
+    struct vlc_list entries; /**< most recently used first */
+    unsigned count; /**< number of cached entries */
+    unsigned users;
+    vlc_tick_t ttl;
+} vlc_gai_cache =
+{
+    VLC_STATIC_MUTEX,
+    VLC_LIST_INITIALIZER(&vlc_gai_cache.entries),
+    0, 0, 0,
+};
+
+static void vlc_gai_entry_Free(struct vlc_gai_entry *e)
+{
+    freeaddrinfo(e->res);
+    free(e);
+}
+
+/* Caller must hold the lock. Returns the entry if it can be freed. */
+static struct vlc_gai_entry *vlc_gai_entry_Uncache(struct vlc_gai_entry *e)
+{
+    assert(e->cached);
+    e->cached = false;
+    vlc_gai_cache.count--;
+
+    if (e->refs > 0)
+        return NULL;
+
+    vlc_list_remove(&e->node);
+    return e;
+}
+
+void vlc_getaddrinfo_cache_Init(libvlc_int_t *libvlc)
+{
+    vlc_tick_t ttl = VLC_TICK_FROM_SEC(var_InheritInteger(libvlc,
+                                                          "dns-cache-ttl"));
+
+    vlc_mutex_lock(&vlc_gai_cache.lock);
+    if (vlc_gai_cache.users++ == 0)
+        vlc_gai_cache.ttl = ttl;
+    vlc_mutex_unlock(&vlc_gai_cache.lock);
+}
+
+void vlc_getaddrinfo_cache_Deinit(void)
+{
+    struct vlc_list stale;
+    struct vlc_gai_entry *e;
+
+    vlc_list_init(&stale);
+    vlc_mutex_lock(&vlc_gai_cache.lock);
+    assert(vlc_gai_cache.users > 0);
+    if (--vlc_gai_cache.users == 0)
+    {
+        vlc_gai_cache.ttl = 0;
+
+        vlc_list_foreach(e, &vlc_gai_cache.entries, node)
+            if (e->cached && vlc_gai_entry_Uncache(e) != NULL)
+                vlc_list_append(&e->node, &stale);
+    }
+    vlc_mutex_unlock(&vlc_gai_cache.lock);
+
+    vlc_list_foreach(e, &stale, node)
+        vlc_gai_entry_Free(e);
+}
+
+static bool vlc_gai_entry_Match(const struct vlc_gai_entry *e,
+                                const char *name, unsigned port,
+                                const struct addrinfo *hints)
+{
+    return e->cached && e->port == port
+        && e->family == hints->ai_family
+        && e->socktype == hints->ai_socktype
+        && e->protocol == hints->ai_protocol
+        && e->flags == hints->ai_flags
+        && strcasecmp(e->name, name) == 0;
+}
+
+int vlc_getaddrinfo_cached(const char *name, unsigned port,
+                           const struct addrinfo *hints,
+                           struct addrinfo **res)
+{
+    static const struct addrinfo no_hints = { .ai_family = AF_UNSPEC };
+    struct vlc_gai_entry *e;
+    struct vlc_list stale;
+    vlc_tick_t now = vlc_tick_now();
+    vlc_tick_t ttl;
+    bool hit = false;
+
+    if (hints == NULL)
+        hints = &no_hints;
+
+    vlc_list_init(&stale);
+    vlc_mutex_lock(&vlc_gai_cache.lock);
+    ttl = vlc_gai_cache.ttl;
+
+    if (name != NULL)
+        vlc_list_foreach(e, &vlc_gai_cache.entries, node)
+        {
+            if (!e->cached)
+                continue;
+
+            if (e->expiry <= now)
+            {
+                if (vlc_gai_entry_Uncache(e) != NULL)
+                    vlc_list_append(&e->node, &stale);
+                continue;
+            }
+
+            if (vlc_gai_entry_Match(e, name, port, hints))
+            {
+                e->refs++;
+                vlc_list_remove(&e->node);
+                vlc_list_prepend(&e->node, &vlc_gai_cache.entries);
+                *res = e->res;
+                hit = true;
+                break;
+            }
+        }
+    vlc_mutex_unlock(&vlc_gai_cache.lock);
+
+    struct vlc_gai_entry *old;
+
+    vlc_list_foreach(old, &stale, node)
+        vlc_gai_entry_Free(old);
+
+    if (hit)
+        return 0;
+
+    int val = vlc_getaddrinfo_i11e(name, port, hints, res);
+    if (val != 0 || name == NULL || ttl == 0)
+        return val;
+
+    size_t len = strlen(name) + 1;
+
+    e = malloc(sizeof (*e) + len);
+    if (unlikely(e == NULL))
+        return 0; /* not cached */
+
+    e->res = *res;
+    e->expiry = now + ttl;
+    e->refs = 1;
+    e->cached = true;
+    e->port = port;
+    e->family = hints->ai_family;
+    e->socktype = hints->ai_socktype;
+    e->protocol = hints->ai_protocol;
+    e->flags = hints->ai_flags;
+    memcpy(e->name, name, len);
+
+    struct vlc_gai_entry *evicted = NULL;
+
+    vlc_mutex_lock(&vlc_gai_cache.lock);
+    vlc_list_prepend(&e->node, &vlc_gai_cache.entries);
+    vlc_gai_cache.count++;
+
+    if (vlc_gai_cache.count > VLC_GAI_CACHE_MAX)
+    {   /* Evict the least recently used entry */
+        struct vlc_gai_entry *lru;
+
+        vlc_list_reverse_foreach(lru, &vlc_gai_cache.entries, node)
+            if (lru->cached)
+            {
+                evicted = vlc_gai_entry_Uncache(lru);
+                break;
+            }
+    }
+    vlc_mutex_unlock(&vlc_gai_cache.lock);
+
+    if (evicted != NULL)
+        vlc_gai_entry_Free(evicted);
+    return 0;
+}
+
+void vlc_freeaddrinfo_cached(struct addrinfo *res)
+{
+    struct vlc_gai_entry *e;
+
+    vlc_mutex_lock(&vlc_gai_cache.lock);
+    vlc_list_foreach(e, &vlc_gai_cache.entries, node)
+        if (e->res == res)
+        {
+            assert(e->refs > 0);
+            if (--e->refs == 0 && !e->cached)
+                vlc_list_remove(&e->node);
+            else
+                e = NULL;
+            vlc_mutex_unlock(&vlc_gai_cache.lock);
+
+            if (e != NULL)
+                vlc_gai_entry_Free(e);
+            return;
+        }
+    vlc_mutex_unlock(&vlc_gai_cache.lock);
+
+    /* Not cached */
+    freeaddrinfo(res);
+}
+
 #if defined (_WIN32) || defined (__OS2__) \
  || defined (__ANDROID__) || defined (__APPLE__)
 #warning vlc_getaddrinfo_i11e() not implemented!
@@ -44,6 +44,8 @@
 #include <vlc_url.h>
 #include <vlc_mime.h>
 #include <vlc_block.h>
+#include <vlc_cpu.h>
+#include <vlc_fs.h>
 #include "../libvlc.h"
 
 #include <string.h>
@@ -71,9 +73,28 @@
 #endif
 
 static void httpd_ClientDestroy(httpd_client_t *cl);
+static void httpd_HostWake(httpd_host_t *host);
 static void httpd_AppendData(httpd_stream_t *stream, uint8_t *p_data, int i_data);
 
-/* each host run in his own thread */
+#define HTTPD_MAX_WORKERS 16
+
+/* Each worker accepts connections and serves its share of the clients in
+ * its own thread. Only the worker of a client touches its socket. */
+typedef struct
+{
+    httpd_host_t *host;
+    vlc_thread_t thread;
+    vlc_mutex_t lock; /* protects the clients */
+
+    size_t client_count;
+    struct vlc_list clients;
+    unsigned generation; /* bumped when clients are destroyed from outside */
+
+    /* interrupts the poll when stream data arrives, -1 if unavailable */
+    int wake[2];
+    atomic_bool woken;
+} httpd_worker_t;
+
 struct httpd_host_t
 {
     struct vlc_object_t obj;
@@ -87,7 +108,8 @@ struct httpd_host_t
     unsigned     nfd;
     unsigned     port;
 
-    vlc_thread_t thread;
+    /* serializes the url list and the callbacks, which do not expect to be
+     * called concurrently */
     vlc_mutex_t lock;
 
     /* all registered url (becarefull that 2 httpd_url_t could point at the same url)
@@ -96,8 +118,11 @@ struct httpd_host_t
      * */
     struct vlc_list urls;
 
-    size_t client_count;
-    struct vlc_list clients;
+    httpd_worker_t workers[HTTPD_MAX_WORKERS];
+    unsigned worker_count;
+
+    atomic_size_t client_count;
+    size_t max_clients; /* 0 for no limit */
     unsigned timeout_sec;
 
     /* TLS data */
@@ -132,6 +157,7 @@ enum
     HTTPD_CLIENT_SEND_DONE,
 
     HTTPD_CLIENT_WAITING,
+    HTTPD_CLIENT_STREAMING,
 
     HTTPD_CLIENT_DEAD,
 
@@ -148,6 +174,10 @@ struct httpd_client_t
 
     bool    b_stream_mode;
     uint8_t i_state;
+    bool    b_ready; /* the socket may be read or written without blocking */
+
+    /* stream sent from its buffer once the answer header is out */
+    httpd_stream_t *stream;
 
     vlc_tick_t i_timeout_date;
 
@@ -643,6 +673,10 @@ struct httpd_stream_t
     bool        b_has_keyframes;
     int64_t     i_last_keyframe_seen_pos;
 
+    /* A client joining or lagging behind is sent at once up to that many
+     * bytes from the last keyframe, instead of waiting for the next one. */
+    int64_t     i_burst;
+
     /* circular buffer */
     int         i_buffer_size;      /* buffer size, can't be reallocated smaller */
     uint8_t     *p_buffer;          /* buffer */
@@ -654,6 +688,14 @@ struct httpd_stream_t
     httpd_header * p_http_headers;
 };
 
+/* Must be called with the stream lock held */
+static bool httpd_StreamCanBurst(const httpd_stream_t *stream)
+{
+    return stream->b_has_keyframes && stream->i_burst > 0
+        && stream->i_buffer_pos - stream->i_last_keyframe_seen_pos
+               <= __MIN(stream->i_burst, stream->i_buffer_size);
+}
+
 static int httpd_StreamCallBack(httpd_callback_sys_t *p_sys,
                                  httpd_client_t *cl, httpd_message_t *answer,
                                  const httpd_message_t *query)
@@ -664,47 +706,8 @@ static int httpd_StreamCallBack(httpd_callback_sys_t *p_sys,
         return VLC_SUCCESS;
 
     if (answer->i_body_offset > 0) {
-        int     i_pos;
-
-        if (answer->i_body_offset >= stream->i_buffer_pos)
-            return VLC_EGENERIC;    /* wait, no data available */
-
-        if (cl->i_keyframe_wait_to_pass >= 0) {
-            if (stream->i_last_keyframe_seen_pos <= cl->i_keyframe_wait_to_pass)
-                /* still waiting for the next keyframe */
-                return VLC_EGENERIC;
-
-            /* seek to the new keyframe */
-            answer->i_body_offset = stream->i_last_keyframe_seen_pos;
-            cl->i_keyframe_wait_to_pass = -1;
-        }
-
-        if (answer->i_body_offset + stream->i_buffer_size < stream->i_buffer_pos)
-            answer->i_body_offset = stream->i_buffer_last_pos; /* this client isn't fast enough */
-
-        i_pos   = answer->i_body_offset % stream->i_buffer_size;
-        int64_t i_write = stream->i_buffer_pos - answer->i_body_offset;
-
-        if (i_write > HTTPD_CL_BUFSIZE)
-            i_write = HTTPD_CL_BUFSIZE;
-        else if (i_write <= 0)
-            return VLC_EGENERIC;    /* wait, no data available */
-
-        /* Don't go past the end of the circular buffer */
-        i_write = __MIN(i_write, stream->i_buffer_size - i_pos);
-
-        /* using HTTPD_MSG_ANSWER -> data available */
-        answer->i_proto  = HTTPD_PROTO_HTTP;
-        answer->i_version= 0;
-        answer->i_type   = HTTPD_MSG_ANSWER;
-
-        answer->i_body = i_write;
-        answer->p_body = xmalloc(i_write);
-        memcpy(answer->p_body, &stream->p_buffer[i_pos], i_write);
-
-        answer->i_body_offset += i_write;
-
-        return VLC_SUCCESS;
+        /* the data is sent from the stream buffer by httpd_ClientStream() */
+        return VLC_EGENERIC;
     } else {
         answer->i_proto  = HTTPD_PROTO_HTTP;
         answer->i_version= 0;
@@ -730,6 +733,7 @@ static int httpd_StreamCallBack(httpd_callback_sys_t *p_sys,
 
         if (query->i_type != HTTPD_MSG_HEAD) {
             cl->b_stream_mode = true;
+            cl->stream = stream;
             vlc_mutex_lock(&stream->lock);
             /* Send the header */
             if (stream->i_header > 0) {
@@ -737,11 +741,17 @@ static int httpd_StreamCallBack(httpd_callback_sys_t *p_sys,
                 answer->p_body = xmalloc(stream->i_header);
                 memcpy(answer->p_body, stream->p_header, stream->i_header);
             }
-            answer->i_body_offset = stream->i_buffer_last_pos;
-            if (stream->b_has_keyframes)
-                cl->i_keyframe_wait_to_pass = stream->i_last_keyframe_seen_pos;
-            else
+            if (httpd_StreamCanBurst(stream)) {
+                /* start from the last keyframe, still in the buffer */
+                answer->i_body_offset = stream->i_last_keyframe_seen_pos;
                 cl->i_keyframe_wait_to_pass = -1;
+            } else {
+                answer->i_body_offset = stream->i_buffer_last_pos;
+                if (stream->b_has_keyframes)
+                    cl->i_keyframe_wait_to_pass = stream->i_last_keyframe_seen_pos;
+                else
+                    cl->i_keyframe_wait_to_pass = -1;
+            }
             vlc_mutex_unlock(&stream->lock);
         } else {
             httpd_MsgAdd(answer, "Content-Length", "0");
@@ -816,6 +826,7 @@ httpd_stream_t *httpd_StreamNew(httpd_host_t *host,
     stream->i_buffer_last_pos = 1;
     stream->b_has_keyframes = false;
     stream->i_last_keyframe_seen_pos = 0;
+    stream->i_burst = 0;
     stream->i_http_headers = 0;
     stream->p_http_headers = NULL;
 
@@ -855,6 +866,13 @@ int httpd_StreamHeader(httpd_stream_t *stream, uint8_t *p_data, int i_data)
     return VLC_SUCCESS;
 }
 
+void httpd_StreamSetBurst(httpd_stream_t *stream, size_t i_max)
+{
+    vlc_mutex_lock(&stream->lock);
+    stream->i_burst = __MIN(i_max, INT64_MAX);
+    vlc_mutex_unlock(&stream->lock);
+}
+
 static void httpd_AppendData(httpd_stream_t *stream, uint8_t *p_data, int i_data)
 {
     int i_pos = stream->i_buffer_pos % stream->i_buffer_size;
@@ -891,6 +909,8 @@ int httpd_StreamSend(httpd_stream_t *stream, const block_t *p_block)
     httpd_AppendData(stream, p_block->p_buffer, p_block->i_buffer);
 
     vlc_mutex_unlock(&stream->lock);
+
+    httpd_HostWake(stream->url->host);
     return VLC_SUCCESS;
 }
 
@@ -912,6 +932,18 @@ void httpd_StreamDelete(httpd_stream_t *stream)
  * Low level
  *****************************************************************************/
 static void* httpd_HostThread(void *);
+
+static void httpd_WorkerWake(httpd_worker_t *worker)
+{
+    if (worker->wake[1] != -1 && !atomic_exchange(&worker->woken, true))
+        vlc_write(worker->wake[1], "", 1);
+}
+
+static void httpd_HostWake(httpd_host_t *host)
+{
+    for (unsigned i = 0; i < host->worker_count; i++)
+        httpd_WorkerWake(&host->workers[i]);
+}
 static httpd_host_t *httpd_HostCreate(vlc_object_t *, const char *,
                                       const char *, vlc_tls_server_t *,
                                       unsigned);
@@ -919,7 +951,8 @@ static httpd_host_t *httpd_HostCreate(vlc_object_t *, const char *,
 /* create a new host */
 httpd_host_t *vlc_http_HostNew(vlc_object_t *p_this)
 {
-    return httpd_HostCreate(p_this, "http-host", "http-port", NULL, 10);
+    return httpd_HostCreate(p_this, "http-host", "http-port", NULL,
+                            var_InheritInteger(p_this, "http-idle-timeout"));
 }
 
 httpd_host_t *vlc_https_HostNew(vlc_object_t *obj)
@@ -943,7 +976,8 @@ httpd_host_t *vlc_https_HostNew(vlc_object_t *obj)
     free(key);
     free(cert);
 
-    return httpd_HostCreate(obj, "http-host", "https-port", tls, 10);
+    return httpd_HostCreate(obj, "http-host", "https-port", tls,
+                            var_InheritInteger(obj, "http-idle-timeout"));
 }
 
 httpd_host_t *vlc_rtsp_HostNew(vlc_object_t *p_this)
@@ -1007,16 +1041,44 @@ static httpd_host_t *httpd_HostCreate(vlc_object_t *p_this,
 
     host->port     = port;
     vlc_list_init(&host->urls);
-    host->client_count = 0;
-    vlc_list_init(&host->clients);
+    atomic_init(&host->client_count, 0);
+    host->max_clients = var_InheritInteger(p_this, "http-max-clients");
     host->timeout_sec = timeout_sec;
     host->p_tls    = p_tls;
 
-    /* create the thread */
-    if (vlc_clone(&host->thread, httpd_HostThread, host)) {
-        msg_Err(p_this, "cannot spawn http host thread");
-        goto error;
+    unsigned workers = var_InheritInteger(p_this, "http-workers");
+    if (workers == 0)
+        workers = __MIN(vlc_GetCPUCount(), 4);
+    workers = VLC_CLIP(workers, 1, HTTPD_MAX_WORKERS);
+
+    /* create the threads */
+    for (host->worker_count = 0; host->worker_count < workers;
+         host->worker_count++) {
+        httpd_worker_t *worker = &host->workers[host->worker_count];
+
+        worker->host = host;
+        vlc_mutex_init(&worker->lock);
+        worker->client_count = 0;
+        vlc_list_init(&worker->clients);
+        worker->generation = 0;
+        atomic_init(&worker->woken, false);
+#ifndef _WIN32
+        if (vlc_pipe(worker->wake))
+#endif
+            worker->wake[0] = worker->wake[1] = -1;
+
+        if (vlc_clone(&worker->thread, httpd_HostThread, worker)) {
+            msg_Err(p_this, "cannot spawn http host thread");
+            if (worker->wake[0] != -1) {
+                vlc_close(worker->wake[0]);
+                vlc_close(worker->wake[1]);
+            }
+            if (host->worker_count == 0)
+                goto error;
+            break;
+        }
     }
+    msg_Dbg(p_this, "HTTP host with %u worker(s)", host->worker_count);
 
     /* now add it to httpd */
     vlc_list_append(&host->node, &httpd.hosts);
@@ -1051,16 +1113,25 @@ void httpd_HostDelete(httpd_host_t *host)
     }
 
     vlc_list_remove(&host->node);
-    vlc_cancel(host->thread);
-    vlc_join(host->thread, NULL);
+    for (unsigned i = 0; i < host->worker_count; i++)
+        vlc_cancel(host->workers[i].thread);
 
-    msg_Dbg(host, "HTTP host removed");
+    for (unsigned i = 0; i < host->worker_count; i++) {
+        httpd_worker_t *worker = &host->workers[i];
 
-    vlc_list_foreach(client, &host->clients, node) {
-        msg_Warn(host, "client still connected");
-        httpd_ClientDestroy(client);
+        vlc_join(worker->thread, NULL);
+        vlc_list_foreach(client, &worker->clients, node) {
+            msg_Warn(host, "client still connected");
+            httpd_ClientDestroy(client);
+        }
+        if (worker->wake[0] != -1) {
+            vlc_close(worker->wake[0]);
+            vlc_close(worker->wake[1]);
+        }
     }
 
+    msg_Dbg(host, "HTTP host removed");
+
     assert(vlc_list_is_empty(&host->urls));
     vlc_tls_ServerDelete(host->p_tls);
     net_ListenClose(host->fds);
@@ -1149,21 +1220,33 @@ void httpd_UrlDelete(httpd_url_t *url)
     vlc_mutex_lock(&host->lock);
     vlc_list_remove(&url->node);
 
-    free(url->psz_url);
-    free(url->psz_user);
-    free(url->psz_password);
+    vlc_mutex_unlock(&host->lock);
 
-    vlc_list_foreach(client, &host->clients, node) {
-        if (client->url != url)
-            continue;
+    /* No new client can find the url anymore. The workers take the host
+     * lock while holding their own, so they are locked after releasing it. */
+    for (unsigned i = 0; i < host->worker_count; i++) {
+        httpd_worker_t *worker = &host->workers[i];
 
-        /* TODO complete it */
-        msg_Warn(host, "force closing connections");
-        host->client_count--;
-        httpd_ClientDestroy(client);
+        vlc_mutex_lock(&worker->lock);
+        vlc_list_foreach(client, &worker->clients, node) {
+            if (client->url != url)
+                continue;
+
+            /* TODO complete it */
+            msg_Warn(host, "force closing connections");
+            worker->client_count--;
+            atomic_fetch_sub_explicit(&host->client_count, 1,
+                                      memory_order_relaxed);
+            httpd_ClientDestroy(client);
+            worker->generation++;
+        }
+        vlc_mutex_unlock(&worker->lock);
     }
+
+    free(url->psz_url);
+    free(url->psz_user);
+    free(url->psz_password);
     free(url);
-    vlc_mutex_unlock(&host->lock);
 }
 
 static void httpd_MsgInit(httpd_message_t *msg)
@@ -1270,6 +1353,8 @@ static httpd_client_t *httpd_ClientNew(vlc_tls_t *sock)
     cl->p_buffer = xmalloc(cl->i_buffer_size);
     cl->i_keyframe_wait_to_pass = -1;
     cl->b_stream_mode = false;
+    cl->b_ready = true;
+    cl->stream = NULL;
 
     httpd_MsgInit(&cl->query);
     httpd_MsgInit(&cl->answer);
@@ -1285,11 +1370,18 @@ ssize_t httpd_NetRecv (httpd_client_t *cl, uint8_t *p, size_t i_len)
 }
 
 static
-ssize_t httpd_NetSend (httpd_client_t *cl, const uint8_t *p, size_t i_len)
+ssize_t httpd_NetSendV (httpd_client_t *cl, const struct iovec *iov,
+                        unsigned count)
 {
     vlc_tls_t *sock = cl->sock;
+    return sock->ops->writev(sock, iov, count);
+}
+
+static
+ssize_t httpd_NetSend (httpd_client_t *cl, const uint8_t *p, size_t i_len)
+{
     const struct iovec iov = { .iov_base = (void *)p, .iov_len = i_len };
-    return sock->ops->writev(sock, &iov, 1);
+    return httpd_NetSendV(cl, &iov, 1);
 }
 
 
@@ -1602,7 +1694,7 @@ static int httpd_ClientRecv(httpd_client_t *cl)
 
 static int httpd_ClientSend(httpd_client_t *cl)
 {
-    int i_len;
+    ssize_t i_len;
 
     if (cl->i_buffer < 0) {
         /* We need to create the header */
@@ -1635,8 +1727,13 @@ static int httpd_ClientSend(httpd_client_t *cl)
         cl->i_buffer_size = (uint8_t*)p - cl->p_buffer;
     }
 
-    i_len = httpd_NetSend(cl, &cl->p_buffer[cl->i_buffer],
-                           cl->i_buffer_size - cl->i_buffer);
+    /* Send the body along with the rest of the header if it is ready */
+    const struct iovec iov[2] = {
+        { .iov_base = &cl->p_buffer[cl->i_buffer],
+          .iov_len = cl->i_buffer_size - cl->i_buffer },
+        { .iov_base = cl->answer.p_body, .iov_len = cl->answer.i_body },
+    };
+    i_len = httpd_NetSendV(cl, iov, cl->answer.i_body > 0 ? 2 : 1);
 
     if (i_len < 0) {
 #if defined(_WIN32)
@@ -1654,14 +1751,21 @@ static int httpd_ClientSend(httpd_client_t *cl)
     cl->i_buffer += i_len;
 
     if (cl->i_buffer >= cl->i_buffer_size) {
-        if (cl->answer.i_body == 0  && cl->answer.i_body_offset > 0) {
+        /* part of the body that went out with the header */
+        int i_body_sent = cl->i_buffer - cl->i_buffer_size;
+
+        if (cl->answer.i_body == 0  && cl->answer.i_body_offset > 0
+         && cl->stream == NULL) {
             /* catch more body data */
             int64_t i_offset = cl->answer.i_body_offset;
 
             httpd_MsgClean(&cl->answer);
             cl->answer.i_body_offset = i_offset;
 
+            httpd_host_t *host = cl->url->host;
+            vlc_mutex_lock(&host->lock);
             httpd_UrlCatchCall(cl->url, cl);
+            vlc_mutex_unlock(&host->lock);
         }
 
         if (cl->answer.i_body != 0) {
@@ -1669,7 +1773,7 @@ static int httpd_ClientSend(httpd_client_t *cl)
             free(cl->p_buffer);
             cl->p_buffer = cl->answer.p_body;
             cl->i_buffer_size = cl->answer.i_body;
-            cl->i_buffer = 0;
+            cl->i_buffer = i_body_sent;
 
             cl->answer.i_body = 0;
             cl->answer.p_body = NULL;
@@ -1679,6 +1783,68 @@ static int httpd_ClientSend(httpd_client_t *cl)
     return 0;
 }
 
+/* Writes the stream data straight from the circular buffer of the stream.
+ * Returns 1 if there is nothing to send, -1 if the socket would block. */
+static int httpd_ClientStream(httpd_client_t *cl)
+{
+    httpd_stream_t *stream = cl->stream;
+    int64_t *offset = &cl->answer.i_body_offset;
+    int val = 1;
+
+    vlc_mutex_lock(&stream->lock);
+    if (cl->i_keyframe_wait_to_pass >= 0) {
+        if (stream->i_last_keyframe_seen_pos <= cl->i_keyframe_wait_to_pass)
+            /* still waiting for the next keyframe */
+            goto out;
+
+        /* seek to the new keyframe */
+        *offset = stream->i_last_keyframe_seen_pos;
+        cl->i_keyframe_wait_to_pass = -1;
+    }
+
+    if (*offset + stream->i_buffer_size < stream->i_buffer_pos) {
+        /* this client isn't fast enough */
+        if (httpd_StreamCanBurst(stream))
+            *offset = stream->i_last_keyframe_seen_pos;
+        else
+            *offset = stream->i_buffer_last_pos;
+    }
+
+    int64_t i_write = stream->i_buffer_pos - *offset;
+    if (i_write <= 0)
+        goto out; /* wait, no data available */
+
+    /* The available data wraps at most once around the circular buffer */
+    size_t i_pos = *offset % stream->i_buffer_size;
+    size_t i_first = __MIN((size_t)i_write, stream->i_buffer_size - i_pos);
+    struct iovec iov[2] = {
+        { .iov_base = &stream->p_buffer[i_pos], .iov_len = i_first },
+        { .iov_base = stream->p_buffer, .iov_len = i_write - i_first },
+    };
+
+    vlc_tls_t *sock = cl->sock;
+    ssize_t i_len = sock->ops->writev(sock, iov, iov[1].iov_len ? 2 : 1);
+    if (i_len < 0) {
+#if defined(_WIN32)
+        if (WSAGetLastError() == WSAEWOULDBLOCK)
+#else
+        if (errno == EAGAIN)
+#endif
+        {
+            val = -1;
+            goto out;
+        }
+
+        /* Connection failed, or hung up (EPIPE) */
+        cl->i_state = HTTPD_CLIENT_DEAD;
+    } else
+        *offset += i_len;
+    val = 0;
+out:
+    vlc_mutex_unlock(&stream->lock);
+    return val;
+}
+
 static void httpd_ClientTlsHandshake(httpd_host_t *host, httpd_client_t *cl)
 {
     switch (vlc_tls_SessionHandshake(host->p_tls, cl->sock))
@@ -1730,42 +1896,157 @@ auth_failed:
     return false;
 }
 
-static void httpdLoop(httpd_host_t *host)
+static httpd_worker_t *httpd_HostPickWorker(httpd_host_t *host)
+{
+    httpd_worker_t *best = NULL;
+    size_t best_count = SIZE_MAX;
+
+    for (unsigned i = 0; i < host->worker_count; i++) {
+        httpd_worker_t *worker = &host->workers[i];
+
+        vlc_mutex_lock(&worker->lock);
+        size_t count = worker->client_count;
+        vlc_mutex_unlock(&worker->lock);
+
+        if (count < best_count) {
+            best = worker;
+            best_count = count;
+        }
+    }
+    return best;
+}
+
+static void httpdAccept(httpd_worker_t *self, int fd)
+{
+    httpd_host_t *host = self->host;
+
+    fd = vlc_accept (fd, NULL, NULL, true);
+    if (fd == -1)
+        return; /* another worker was faster */
+
+    if (host->max_clients > 0
+     && atomic_load_explicit(&host->client_count, memory_order_relaxed)
+            >= host->max_clients) {
+        msg_Warn(host, "too many clients, rejecting connection");
+        vlc_close(fd);
+        return;
+    }
+
+    setsockopt (fd, SOL_SOCKET, SO_REUSEADDR,
+            &(int){ 1 }, sizeof(int));
+
+    vlc_tls_t *sk = vlc_tls_SocketOpen(fd);
+    if (unlikely(sk == NULL))
+    {
+        vlc_close(fd);
+        return;
+    }
+
+    if (host->p_tls != NULL)
+    {
+        const char *alpn[] = { "http/1.1", NULL };
+        vlc_tls_t *tls;
+
+        tls = vlc_tls_ServerSessionCreate(host->p_tls, sk, alpn);
+        if (tls == NULL)
+        {
+            vlc_tls_SessionDelete(sk);
+            return;
+        }
+        sk = tls;
+    }
+
+    httpd_client_t *cl = httpd_ClientNew(sk);
+
+    if (unlikely(cl == NULL))
+    {
+        vlc_tls_Close(sk);
+        return;
+    }
+
+    if (host->p_tls != NULL)
+        cl->i_state = HTTPD_CLIENT_TLS_HS_OUT;
+
+    cl->i_timeout_date = vlc_tick_now()
+                       + VLC_TICK_FROM_SEC(host->timeout_sec);
+    atomic_fetch_add_explicit(&host->client_count, 1, memory_order_relaxed);
+
+    /* Hand the client over to the least busy worker */
+    httpd_worker_t *worker = httpd_HostPickWorker(host);
+
+    vlc_mutex_lock(&worker->lock);
+    worker->client_count++;
+    vlc_list_append(&cl->node, &worker->clients);
+    vlc_mutex_unlock(&worker->lock);
+
+    if (worker != self)
+        httpd_WorkerWake(worker);
+}
+
+static void httpdLoop(httpd_worker_t *worker)
 {
-    struct pollfd ufd[host->nfd + host->client_count];
+    httpd_host_t *host = worker->host;
+
+    vlc_mutex_lock(&worker->lock);
+
+    size_t client_count = worker->client_count;
+    struct pollfd ufd[host->nfd + 1 + client_count];
+    httpd_client_t *clients[client_count + 1];
     unsigned nfd;
     for (nfd = 0; nfd < host->nfd; nfd++) {
         ufd[nfd].fd = host->fds[nfd];
         ufd[nfd].events = POLLIN;
         ufd[nfd].revents = 0;
     }
+    if (worker->wake[0] != -1) {
+        ufd[nfd].fd = worker->wake[0];
+        ufd[nfd].events = POLLIN;
+        ufd[nfd].revents = 0;
+        nfd++;
+    }
+    const unsigned first_client = nfd;
+    const unsigned generation = worker->generation;
 
-    vlc_mutex_lock(&host->lock);
     /* add all socket that should be read/write and close dead connection */
     vlc_tick_t now = vlc_tick_now();
     int delay = -1;
     httpd_client_t *cl;
 
     int canc = vlc_savecancel();
-    vlc_list_foreach(cl, &host->clients, node) {
+    vlc_list_foreach(cl, &worker->clients, node) {
         int val = -1;
 
-        switch (cl->i_state) {
-            case HTTPD_CLIENT_RECEIVING:
-                val = httpd_ClientRecv(cl);
-                break;
-            case HTTPD_CLIENT_SENDING:
-                val = httpd_ClientSend(cl);
-                break;
-            case HTTPD_CLIENT_TLS_HS_IN:
-            case HTTPD_CLIENT_TLS_HS_OUT:
-                httpd_ClientTlsHandshake(host, cl);
-                break;
+        /* Only try the I/O that the socket is ready for */
+        if (cl->b_ready) {
+            switch (cl->i_state) {
+                case HTTPD_CLIENT_RECEIVING:
+                    val = httpd_ClientRecv(cl);
+                    break;
+                case HTTPD_CLIENT_SENDING:
+                    val = httpd_ClientSend(cl);
+                    break;
+                case HTTPD_CLIENT_STREAMING:
+                    val = httpd_ClientStream(cl);
+                    break;
+                case HTTPD_CLIENT_TLS_HS_IN:
+                case HTTPD_CLIENT_TLS_HS_OUT:
+                    httpd_ClientTlsHandshake(host, cl);
+                    if (cl->i_state == HTTPD_CLIENT_TLS_HS_IN
+                     || cl->i_state == HTTPD_CLIENT_TLS_HS_OUT)
+                        val = -1;
+                    else
+                        val = 0;
+                    break;
+            }
+            if (val == -1)
+                cl->b_ready = false;
         }
 
         if (cl->i_state == HTTPD_CLIENT_DEAD
          || (host->timeout_sec > 0 && cl->i_timeout_date < now)) {
-            host->client_count--;
+            worker->client_count--;
+            atomic_fetch_sub_explicit(&host->client_count, 1,
+                                      memory_order_relaxed);
             httpd_ClientDestroy(cl);
             continue;
         }
@@ -1874,8 +2155,10 @@ static void httpdLoop(httpd_host_t *host)
                     default: {
                         httpd_url_t *url;
                         bool b_auth_failed = false;
+                        bool b_deferred = false;
 
                         /* Search the url and trigger callbacks */
+                        vlc_mutex_lock(&host->lock);
                         vlc_list_foreach(url, &host->urls, node) {
                             if (strcmp(url->psz_url, query->psz_url))
                                 continue;
@@ -1888,7 +2171,15 @@ static void httpdLoop(httpd_host_t *host)
                                    break;
                             }
 
-                            if (httpd_UrlCatchCall(url, cl))
+                            int status = httpd_UrlCatchCall(url, cl);
+                            if (status == -EAGAIN) {
+                                /* Ask the callback again until it answers */
+                                cl->url = url;
+                                answer = NULL;
+                                b_deferred = true;
+                                break;
+                            }
+                            if (status)
                                 continue;
 
                             if (answer->i_proto == HTTPD_PROTO_NONE)
@@ -1901,6 +2192,7 @@ static void httpdLoop(httpd_host_t *host)
                             if (!cl->url)
                                 cl->url = url;
                         }
+                        vlc_mutex_unlock(&host->lock);
 
                         if (answer) {
                             answer->i_proto  = query->i_proto;
@@ -1926,7 +2218,8 @@ static void httpdLoop(httpd_host_t *host)
                                 httpd_MsgAdd(answer, "Connection", "close");
                         }
 
-                        cl->i_state = HTTPD_CLIENT_SENDING;
+                        cl->i_state = b_deferred ? HTTPD_CLIENT_WAITING
+                                                 : HTTPD_CLIENT_SENDING;
                     }
                 }
                 break;
@@ -1963,49 +2256,49 @@ static void httpdLoop(httpd_host_t *host)
                         cl->i_state = HTTPD_CLIENT_DEAD;
                     httpd_MsgClean(&cl->answer);
                 } else {
-                    int64_t i_offset = cl->answer.i_body_offset;
-                    httpd_MsgClean(&cl->answer);
-
-                    cl->answer.i_body_offset = i_offset;
+                    /* The answer header is out, now send the stream data */
                     free(cl->p_buffer);
                     cl->p_buffer = NULL;
                     cl->i_buffer = 0;
                     cl->i_buffer_size = 0;
 
-                    cl->i_state = HTTPD_CLIENT_WAITING;
+                    cl->i_state = HTTPD_CLIENT_STREAMING;
                 }
                 break;
 
-            case HTTPD_CLIENT_WAITING: {
-                int64_t i_offset = cl->answer.i_body_offset;
-                int i_msg = cl->query.i_type;
+            case HTTPD_CLIENT_STREAMING:
+                /* No events if there is no data: the worker is woken up by
+                 * httpd_StreamSend() */
+                if (!cl->b_ready)
+                    pufd->events = POLLOUT;
+                else if (worker->wake[0] == -1 && delay != 0)
+                    delay = 20;
+                break;
 
+            case HTTPD_CLIENT_WAITING:
+                /* Deferred answer */
+                httpd_MsgClean(&cl->answer);
                 httpd_MsgInit(&cl->answer);
-                cl->answer.i_body_offset = i_offset;
-
-                cl->url->catch[i_msg].cb(cl->url->catch[i_msg].p_sys, cl,
-                        &cl->answer, &cl->query);
-                if (cl->answer.i_type != HTTPD_MSG_NONE) {
-                    /* we have new data, so re-enter send mode */
-                    cl->i_buffer      = 0;
-                    cl->p_buffer      = cl->answer.p_body;
-                    cl->i_buffer_size = cl->answer.i_body;
-                    cl->answer.p_body = NULL;
-                    cl->answer.i_body = 0;
+                vlc_mutex_lock(&host->lock);
+                if (httpd_UrlCatchCall(cl->url, cl) != -EAGAIN) {
+                    cl->i_buffer = -1;
                     cl->i_state = HTTPD_CLIENT_SENDING;
+                    cl->b_ready = true;
+                    pufd->events = POLLOUT;
                 }
-            }
+                vlc_mutex_unlock(&host->lock);
+                break;
         }
 
         pufd->fd = vlc_tls_GetPollFD(cl->sock, &pufd->events);
 
         if (pufd->events != 0)
-            nfd++;
+            clients[nfd++ - first_client] = cl;
         /* we will wait 20ms (not too big) if HTTPD_CLIENT_WAITING */
-        else if (delay != 0)
+        else if (cl->i_state == HTTPD_CLIENT_WAITING && delay != 0)
             delay = 20;
     }
-    vlc_mutex_unlock(&host->lock);
+    vlc_mutex_unlock(&worker->lock);
     vlc_restorecancel(canc);
 
     while (poll(ufd, nfd, delay) < 0)
@@ -2015,66 +2308,37 @@ static void httpdLoop(httpd_host_t *host)
     }
 
     canc = vlc_savecancel();
-    vlc_mutex_lock(&host->lock);
-
-    /* Handle client sockets */
-    now = vlc_tick_now();
-    nfd = host->nfd;
-
-    /* Handle server sockets (accept new connections) */
-    for (nfd = 0; nfd < host->nfd; nfd++) {
-        int fd = ufd[nfd].fd;
 
-        assert (fd == host->fds[nfd]);
-
-        if (ufd[nfd].revents == 0)
-            continue;
+    if (worker->wake[0] != -1 && ufd[host->nfd].revents) {
+        char dummy[64];
 
-        /* */
-        fd = vlc_accept (fd, NULL, NULL, true);
-        if (fd == -1)
-            continue;
-        setsockopt (fd, SOL_SOCKET, SO_REUSEADDR,
-                &(int){ 1 }, sizeof(int));
-
-        vlc_tls_t *sk = vlc_tls_SocketOpen(fd);
-        if (unlikely(sk == NULL))
-        {
-            vlc_close(fd);
-            continue;
-        }
-
-        if (host->p_tls != NULL)
-        {
-            const char *alpn[] = { "http/1.1", NULL };
-            vlc_tls_t *tls;
-
-            tls = vlc_tls_ServerSessionCreate(host->p_tls, sk, alpn);
-            if (tls == NULL)
-            {
-                vlc_tls_SessionDelete(sk);
-                continue;
-            }
-            sk = tls;
-        }
-
-        cl = httpd_ClientNew(sk);
+        /* At most one byte is pending per wake up, the pipe is readable */
+        atomic_store(&worker->woken, false);
+        if (read(worker->wake[0], dummy, sizeof (dummy)) < 0)
+            msg_Err(host, "wake up error: %s", vlc_strerror_c(errno));
+    }
 
-        if (unlikely(cl == NULL))
-        {
-            vlc_tls_Close(sk);
-            continue;
-        }
+    /* Handle client sockets */
+    vlc_mutex_lock(&worker->lock);
+    if (generation == worker->generation) {
+        for (unsigned i = first_client; i < nfd; i++)
+            if (ufd[i].revents)
+                clients[i - first_client]->b_ready = true;
+    } else {
+        /* Some clients were destroyed meanwhile: try again all of them */
+        vlc_list_foreach(cl, &worker->clients, node)
+            cl->b_ready = true;
+    }
+    vlc_mutex_unlock(&worker->lock);
 
-        if (host->p_tls != NULL)
-            cl->i_state = HTTPD_CLIENT_TLS_HS_OUT;
+    /* Handle server sockets (accept new connections) */
+    for (unsigned i = 0; i < host->nfd; i++) {
+        assert (ufd[i].fd == host->fds[i]);
 
-        cl->i_timeout_date = now + VLC_TICK_FROM_SEC(host->timeout_sec);
-        host->client_count++;
-        vlc_list_append(&cl->node, &host->clients);
+        if (ufd[i].revents != 0)
+            httpdAccept(worker, ufd[i].fd);
     }
 
-    vlc_mutex_unlock(&host->lock);
     vlc_restorecancel(canc);
 }
 
@@ -2082,10 +2346,11 @@ static void* httpd_HostThread(void *data)
 {
     vlc_thread_set_name("vlc-httpd");
 
-    httpd_host_t *host = data;
+    httpd_worker_t *worker = data;
+    httpd_host_t *host = worker->host;
 
     while (atomic_load_explicit(&host->ref, memory_order_relaxed) > 0)
-        httpdLoop(host);
+        httpdLoop(worker);
     return NULL;
 }
 
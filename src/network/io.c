@@ -51,6 +51,7 @@
 #include <vlc_network.h>
 #include <vlc_poll.h>
 #include <vlc_interrupt.h>
+#include "../libvlc.h"
 #if defined (_WIN32)
 #   undef EINPROGRESS
 #   define EINPROGRESS WSAEWOULDBLOCK
@@ -120,9 +121,8 @@ int (net_Connect)(vlc_object_t *obj, const char *host, int serv,
         .ai_protocol = proto,
         .ai_flags = AI_NUMERICSERV | AI_IDN,
     }, *res;
-    int ret = -1;
 
-    int val = vlc_getaddrinfo_i11e(host, serv, &hints, &res);
+    int val = vlc_getaddrinfo_cached(host, serv, &hints, &res);
     if (val)
     {
         msg_Err(obj, "cannot resolve %s port %d : %s", host, serv,
@@ -130,80 +130,10 @@ int (net_Connect)(vlc_object_t *obj, const char *host, int serv,
         return -1;
     }
 
-    vlc_tick_t timeout = VLC_TICK_FROM_MS(var_InheritInteger(obj,
-                                                             "ipv4-timeout"));
+    int fd = net_ConnectAddrInfo(obj, res);
 
-    for (struct addrinfo *ptr = res; ptr != NULL; ptr = ptr->ai_next)
-    {
-        int fd = net_Socket(obj, ptr->ai_family,
-                            ptr->ai_socktype, ptr->ai_protocol);
-        if (fd == -1)
-        {
-            msg_Dbg(obj, "socket error: %s", vlc_strerror_c(net_errno));
-            continue;
-        }
-
-        if (connect(fd, ptr->ai_addr, ptr->ai_addrlen))
-        {
-            if (net_errno != EINPROGRESS && errno != EINTR)
-            {
-                msg_Err(obj, "connection failed: %s",
-                        vlc_strerror_c(net_errno));
-                goto next_ai;
-            }
-
-            struct pollfd ufd;
-            vlc_tick_t deadline = VLC_TICK_INVALID;
-
-            ufd.fd = fd;
-            ufd.events = POLLOUT;
-            deadline = vlc_tick_now() + timeout;
-
-            do
-            {
-                vlc_tick_t now = vlc_tick_now();
-
-                if (vlc_killed())
-                    goto next_ai;
-
-                if (now > deadline)
-                    now = deadline;
-
-                val = vlc_poll_i11e(&ufd, 1, MS_FROM_VLC_TICK(deadline - now));
-            }
-            while (val == -1 && errno == EINTR);
-
-            switch (val)
-            {
-                 case -1: /* error */
-                     msg_Err(obj, "polling error: %s", vlc_strerror_c(errno));
-                     goto next_ai;
-
-                 case 0: /* timeout */
-                     msg_Warn(obj, "connection timed out");
-                     goto next_ai;
-            }
-
-            /* There is NO WAY around checking SO_ERROR.
-             * Don't ifdef it out!!! */
-            if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &val,
-                           &(socklen_t){ sizeof (val) }) || val)
-            {
-                msg_Err(obj, "connection failed: %s", vlc_strerror_c(val));
-                goto next_ai;
-            }
-        }
-
-        msg_Dbg(obj, "connection succeeded (socket = %d)", fd);
-        ret = fd; /* success! */
-        break;
-
-next_ai: /* failure */
-        net_Close(fd);
-    }
-
-    freeaddrinfo(res);
-    return ret;
+    vlc_freeaddrinfo_cached(res);
+    return fd;
 }
 
 int *net_Listen (vlc_object_t *p_this, const char *psz_host,
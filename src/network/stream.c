@@ -45,10 +45,13 @@
 #ifndef SOL_TCP
 # define SOL_TCP IPPROTO_TCP
 #endif
+/* Unsent data threshold for reporting TCP sockets as writable */
+#define VLC_TLS_NOTSENT_LOWAT (128 * 1024)
 
 #include <vlc_common.h>
 #include <vlc_tls.h>
 #include <vlc_interrupt.h>
+#include "../libvlc.h"
 
 ssize_t vlc_tls_Read(vlc_tls_t *session, void *buf, size_t len, bool waitall)
 {
@@ -91,45 +94,72 @@ ssize_t vlc_tls_Read(vlc_tls_t *session, void *buf, size_t len, bool waitall)
     }
 }
 
-ssize_t vlc_tls_Write(vlc_tls_t *session, const void *buf, size_t len)
+ssize_t vlc_tls_WriteV(vlc_tls_t *session, const struct iovec *iov,
+                       unsigned count)
 {
     struct pollfd ufd;
-    struct iovec iov;
+    struct iovec part; /* remainder of a partially sent entry */
+    size_t offset = 0;
 
     ufd.events = POLLOUT;
     ufd.fd = vlc_tls_GetPollFD(session, &ufd.events);
-    iov.iov_base = (void *)buf;
-    iov.iov_len = len;
+
+    /* Skip leading empty entries */
+    while (count > 0 && iov->iov_len == 0)
+        iov++, count--;
 
     for (size_t sent = 0;;)
     {
+        if (count == 0)
+            return sent;
+
         if (vlc_killed())
         {
             errno = EINTR;
             return -1;
         }
 
-        ssize_t val = session->ops->writev(session, &iov, 1);
+        ssize_t val;
+
+        if (offset > 0)
+        {   /* Finish the partial entry on its own, this should be rare */
+            part.iov_base = (char *)iov->iov_base + offset;
+            part.iov_len = iov->iov_len - offset;
+            val = session->ops->writev(session, &part, 1);
+        }
+        else
+            val = session->ops->writev(session, iov, count);
+
         if (val > 0)
         {
-            iov.iov_base = ((char *)iov.iov_base) + val;
-            iov.iov_len -= val;
             sent += val;
+            offset += val;
+
+            while (count > 0 && offset >= iov->iov_len)
+            {
+                offset -= iov->iov_len;
+                iov++, count--;
+            }
+            continue;
         }
-        if (iov.iov_len == 0 || val == 0)
+        if (val == 0)
             return sent;
-        if (val == -1)
-        {
-            if (vlc_killed())
-                return -1;
-            if (errno != EINTR && errno != EAGAIN)
-                return sent ? (ssize_t)sent : -1;
-        }
+        if (vlc_killed())
+            return -1;
+        if (errno != EINTR && errno != EAGAIN)
+            return sent ? (ssize_t)sent : -1;
 
         vlc_poll_i11e(&ufd, 1, -1);
     }
 }
 
+ssize_t vlc_tls_Write(vlc_tls_t *session, const void *buf, size_t len)
+{
+    const struct iovec iov = { .iov_base = (void *)buf, .iov_len = len };
+
+    return vlc_tls_WriteV(session, &iov, 1);
+}
+
 char *vlc_tls_GetLine(vlc_tls_t *session)
 {
     char *line = NULL;
@@ -242,6 +272,15 @@ static vlc_tls_t *vlc_tls_SocketAlloc(int fd,
     tls->ops = &vlc_tls_socket_ops;
     tls->p = NULL;
 
+#ifdef TCP_NOTSENT_LOWAT
+    /* Keep little unsent data in the kernel send buffer, so that writers are
+     * only woken up when it is nearly drained. Data still in user space can
+     * be coalesced or skipped (see httpd streams). This fails harmlessly on
+     * non-TCP sockets. */
+    setsockopt(fd, SOL_TCP, TCP_NOTSENT_LOWAT,
+               &(int){ VLC_TLS_NOTSENT_LOWAT }, sizeof (int));
+#endif
+
     sock->fd = fd;
     sock->peerlen = peerlen;
     if (peerlen > 0)
@@ -428,6 +467,22 @@ vlc_tls_t *vlc_tls_SocketOpenAddrInfo(const struct addrinfo *restrict info,
     return sock;
 }
 
+vlc_tls_t *vlc_tls_SocketConnectAddrInfo(vlc_object_t *obj,
+                                         const struct addrinfo *res)
+{
+    int fd = net_ConnectAddrInfo(obj, res);
+    if (fd == -1)
+        return NULL;
+
+    if (res->ai_socktype == SOCK_STREAM && res->ai_protocol == IPPROTO_TCP)
+        setsockopt(fd, SOL_TCP, TCP_NODELAY, &(int){ 1 }, sizeof (int));
+
+    vlc_tls_t *tls = vlc_tls_SocketOpen(fd);
+    if (unlikely(tls == NULL))
+        net_Close(fd);
+    return tls;
+}
+
 vlc_tls_t *vlc_tls_SocketOpenTCP(vlc_object_t *obj, const char *name,
                                  unsigned port)
 {
@@ -440,7 +495,7 @@ vlc_tls_t *vlc_tls_SocketOpenTCP(vlc_object_t *obj, const char *name,
     assert(name != NULL);
     msg_Dbg(obj, "resolving %s ...", name);
 
-    int val = vlc_getaddrinfo_i11e(name, port, &hints, &res);
+    int val = vlc_getaddrinfo_cached(name, port, &hints, &res);
     if (val != 0)
     {   /* TODO: C locale for gai_strerror() */
         msg_Err(obj, "cannot resolve %s port %u: %s", name, port,
@@ -450,20 +505,7 @@ vlc_tls_t *vlc_tls_SocketOpenTCP(vlc_object_t *obj, const char *name,
 
     msg_Dbg(obj, "connecting to %s port %u ...", name, port);
 
-    /* TODO: implement RFC8305 */
-    for (const struct addrinfo *p = res; p != NULL; p = p->ai_next)
-    {
-        vlc_tls_t *tls = vlc_tls_SocketOpenAddrInfo(p, false);
-        if (tls == NULL)
-        {
-            msg_Err(obj, "connection error: %s", vlc_strerror_c(errno));
-            continue;
-        }
-
-        freeaddrinfo(res);
-        return tls;
-    }
-
-    freeaddrinfo(res);
-    return NULL;
+    vlc_tls_t *tls = vlc_tls_SocketConnectAddrInfo(obj, res);
+    vlc_freeaddrinfo_cached(res);
+    return tls;
 }
@@ -31,10 +31,170 @@
 
 #include <vlc_common.h>
 
+#include <errno.h>
 #include <unistd.h>
+#ifdef HAVE_POLL_H
+# include <poll.h>
+#endif
 
 #include <vlc_network.h>
+#include <vlc_poll.h>
 #include <vlc_interrupt.h>
+#include "../libvlc.h"
+#if defined (_WIN32)
+#   undef EINPROGRESS
+#   define EINPROGRESS WSAEWOULDBLOCK
+#endif
+
+/* RFC 8305 recommended connection attempt delay */
+#define CONNECT_ATTEMPT_DELAY VLC_TICK_FROM_MS(250)
+/* Maximum number of concurrent connection attempts */
+#define CONNECT_ATTEMPT_MAX 8
+
+/*****************************************************************************
+ * NextAddrInfo:
+ *****************************************************************************
+ * Returns the next address of the (same) or (other) family.
+ *****************************************************************************/
+static const struct addrinfo *NextAddrInfo( const struct addrinfo *p,
+                                            int family, bool same )
+{
+    while( p != NULL && (p->ai_family == family) != same )
+        p = p->ai_next;
+    return p;
+}
+
+int net_ConnectAddrInfo(vlc_object_t *obj, const struct addrinfo *res)
+{
+    vlc_tick_t timeout = VLC_TICK_FROM_MS(var_InheritInteger(obj,
+                                                             "ipv4-timeout"));
+    struct pollfd ufd[CONNECT_ATTEMPT_MAX];
+    vlc_tick_t deadlines[CONNECT_ATTEMPT_MAX];
+    unsigned pending = 0;
+    int fd = -1;
+
+    /* Interleave the address families, starting with the preferred one */
+    const struct addrinfo *next[2] = {
+        res, NextAddrInfo(res, res->ai_family, false),
+    };
+    unsigned turn = 0;
+    vlc_tick_t next_date = vlc_tick_now();
+
+    while (!vlc_killed())
+    {
+        vlc_tick_t now = vlc_tick_now();
+
+        if (next[turn] == NULL)
+            turn = !turn;
+
+        const struct addrinfo *ptr = next[turn];
+
+        /* Start a new attempt */
+        if (ptr != NULL && pending < CONNECT_ATTEMPT_MAX
+         && (pending == 0 || now >= next_date))
+        {
+            next[turn] = NextAddrInfo(ptr->ai_next, res->ai_family,
+                                      turn == 0);
+            turn = !turn;
+
+            int s = net_Socket(obj, ptr->ai_family, ptr->ai_socktype,
+                               ptr->ai_protocol);
+            if (s == -1)
+            {
+                msg_Dbg(obj, "socket error: %s", vlc_strerror_c(net_errno));
+                continue;
+            }
+
+            if (connect(s, ptr->ai_addr, ptr->ai_addrlen) == 0)
+            {
+                fd = s;
+                break;
+            }
+
+            if (net_errno != EINPROGRESS && errno != EINTR)
+            {
+                msg_Err(obj, "connection failed: %s",
+                        vlc_strerror_c(net_errno));
+                net_Close(s);
+                continue;
+            }
+
+            ufd[pending].fd = s;
+            ufd[pending].events = POLLOUT;
+            deadlines[pending] = now + timeout;
+            pending++;
+            next_date = now + CONNECT_ATTEMPT_DELAY;
+            continue;
+        }
+
+        if (pending == 0)
+            break; /* all attempts failed */
+
+        vlc_tick_t deadline = deadlines[0];
+
+        for (unsigned i = 1; i < pending; i++)
+            if (deadlines[i] < deadline)
+                deadline = deadlines[i];
+        if (ptr != NULL && pending < CONNECT_ATTEMPT_MAX && next_date < deadline)
+            deadline = next_date;
+        if (deadline < now)
+            deadline = now;
+
+        int val = vlc_poll_i11e(ufd, pending, MS_FROM_VLC_TICK(deadline - now));
+        if (val == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            msg_Err(obj, "polling error: %s", vlc_strerror_c(errno));
+            break;
+        }
+
+        now = vlc_tick_now();
+
+        for (unsigned i = 0; i < pending;)
+        {
+            if (ufd[i].revents)
+            {
+                /* There is NO WAY around checking SO_ERROR.
+                 * Don't ifdef it out!!! */
+                if (getsockopt(ufd[i].fd, SOL_SOCKET, SO_ERROR, &val,
+                               &(socklen_t){ sizeof (val) }) == 0 && val == 0)
+                {
+                    fd = ufd[i].fd;
+                    ufd[i] = ufd[--pending];
+                    break;
+                }
+
+                msg_Err(obj, "connection failed: %s", vlc_strerror_c(val));
+            }
+            else if (now >= deadlines[i])
+                msg_Warn(obj, "connection timed out");
+            else
+            {
+                i++;
+                continue;
+            }
+
+            /* Failed attempt: try the next address straight away */
+            net_Close(ufd[i].fd);
+            pending--;
+            ufd[i] = ufd[pending];
+            deadlines[i] = deadlines[pending];
+            next_date = now;
+        }
+
+        if (fd != -1)
+            break;
+    }
+
+    /* Abort the slower attempts */
+    for (unsigned i = 0; i < pending; i++)
+        net_Close(ufd[i].fd);
+
+    if (fd != -1)
+        msg_Dbg(obj, "connection succeeded (socket = %d)", fd);
+    return fd;
+}
 
 /*****************************************************************************
  * SocksNegotiate:
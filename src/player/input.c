@@ -98,6 +98,20 @@ vlc_player_input_UpdateTime(struct vlc_player_input *input)
 int
 vlc_player_input_Start(struct vlc_player_input *input)
 {
+    if (input->started)
+    {
+        /* Preloaded, and paused before playing anything */
+        assert(!input->preloading);
+        if (input->player->start_paused)
+        {
+            vlc_player_input_HandleState(input, VLC_PLAYER_STATE_PAUSED,
+                                         vlc_tick_now());
+            return VLC_SUCCESS;
+        }
+        return input_ControlPushHelper(input->thread, INPUT_CONTROL_SET_STATE,
+                                       &(vlc_value_t) { .i_int = PLAYING_S });
+    }
+
     int ret = input_Start(input->thread);
     if (ret != VLC_SUCCESS)
         return ret;
@@ -215,6 +229,18 @@ vlc_player_input_HandleState(struct vlc_player_input *input,
 {
     vlc_player_t *player = input->player;
 
+    if (input->preloading)
+    {
+        /* Not the current input yet, the player state is left alone */
+        input->state = state;
+        if (state == VLC_PLAYER_STATE_STOPPED && input->titles)
+        {
+            vlc_player_title_list_Release(input->titles);
+            input->titles = NULL;
+        }
+        return;
+    }
+
     /* The STOPPING state can be set earlier by the player. In that case,
      * ignore all future events except the STOPPED one */
     if (input->state == VLC_PLAYER_STATE_STOPPING
@@ -690,7 +716,10 @@ vlc_player_input_HandleTitleEvent(struct vlc_player_input *input,
                 if (input->ml.restore == VLC_RESTOREPOINT_TITLE &&
                     (size_t)input->ml.states.current_title < ev->list.count)
                 {
-                    vlc_player_SelectTitleIdx(player, input->ml.states.current_title);
+                    /* This input may not be the current one yet */
+                    vlc_value_t val = { .i_int = input->ml.states.current_title };
+                    input_ControlPushHelper(input->thread,
+                                            INPUT_CONTROL_SET_TITLE, &val);
                 }
                 input->ml.restore = VLC_RESTOREPOINT_POSITION;
             }
@@ -870,6 +899,132 @@ vlc_player_input_MouseFallback(struct vlc_player_input *input)
     vlc_player_TogglePause(player);
 }
 
+/*
+ * Handle an event of an input opened ahead of time. Return false to let the
+ * event be handled as usual, in which case the listeners are not notified
+ * unless the event tells which media it is about: the state is sent once the
+ * input becomes the current one.
+ */
+static bool
+vlc_player_input_HandlePreloadEvent(struct vlc_player_input *input,
+                                    const struct vlc_input_event *event)
+{
+    vlc_player_t *player = input->player;
+
+    switch (event->type)
+    {
+        case INPUT_EVENT_STATE:
+            if (event->state.value == END_S || event->state.value == ERROR_S)
+            {
+                /* The next media will be opened again when the current one
+                 * ends */
+                if (player->preload == input)
+                    player->preload = NULL;
+            }
+            break;
+        case INPUT_EVENT_TIMES:
+        {
+            /* The timer follows the current input */
+            vlc_tick_t duration =
+                input_GetItemDuration(input->thread, event->times.length);
+            if (input->length != duration)
+            {
+                input->length = duration;
+                input_item_SetDuration(input_GetItem(input->thread), duration);
+            }
+            return true;
+        }
+        case INPUT_EVENT_DEAD:
+            if (player->preload == input)
+                player->preload = NULL;
+            input->started = false;
+            vlc_player_destructor_AddJoinableInput(player, input);
+            return true;
+        case INPUT_EVENT_ITEM_META:
+        case INPUT_EVENT_ITEM_INFO:
+        case INPUT_EVENT_ITEM_EPG:
+        case INPUT_EVENT_SUBITEMS:
+        case INPUT_EVENT_ATTACHMENTS:
+            return false;
+        default:
+            break;
+    }
+
+    player->silent = true;
+    return false;
+}
+
+void
+vlc_player_input_SendPreloadedState(struct vlc_player_input *input)
+{
+    vlc_player_t *player = input->player;
+
+    vlc_player_SendEvent(player, on_capabilities_changed, 0,
+                         input->capabilities);
+    if (input->rate != 1.f)
+        vlc_player_SendEvent(player, on_rate_changed, input->rate);
+    if (input->length != VLC_TICK_INVALID)
+        vlc_player_SendEvent(player, on_length_changed, input->length);
+
+    struct vlc_player_program *prgm;
+    vlc_vector_foreach(prgm, &input->program_vector)
+    {
+        vlc_player_SendEvent(player, on_program_list_changed,
+                             VLC_PLAYER_LIST_ADDED, prgm);
+        if (prgm->selected)
+            vlc_player_SendEvent(player, on_program_selection_changed, -1,
+                                 prgm->group_id);
+    }
+
+    static const enum es_format_category_e cats[] = {
+        VIDEO_ES, AUDIO_ES, SPU_ES,
+    };
+    for (size_t i = 0; i < ARRAY_SIZE(cats); ++i)
+    {
+        vlc_player_track_vector *vec =
+            vlc_player_input_GetTrackVector(input, cats[i]);
+        struct vlc_player_track_priv *trackpriv;
+        vlc_vector_foreach(trackpriv, vec)
+        {
+            vlc_player_SendEvent(player, on_track_list_changed,
+                                 VLC_PLAYER_LIST_ADDED, &trackpriv->t);
+            if (trackpriv->t.selected)
+                vlc_player_SendEvent(player, on_track_selection_changed,
+                                     NULL, trackpriv->t.es_id);
+            if (trackpriv->vout != NULL)
+                vlc_player_SendEvent(player, on_vout_changed,
+                                     VLC_PLAYER_VOUT_STARTED, trackpriv->vout,
+                                     trackpriv->vout_order, trackpriv->t.es_id);
+        }
+    }
+
+    if (input->teletext_source != NULL)
+    {
+        vlc_player_SendEvent(player, on_teletext_menu_changed, true);
+        if (input->teletext_enabled)
+        {
+            vlc_player_SendEvent(player, on_teletext_enabled_changed, true);
+            vlc_player_SendEvent(player, on_teletext_page_changed,
+                                 input->teletext_page);
+        }
+    }
+
+    if (input->titles != NULL)
+    {
+        const struct vlc_player_title *title =
+            &input->titles->array[input->title_selected];
+
+        vlc_player_SendEvent(player, on_titles_changed, input->titles);
+        vlc_player_SendEvent(player, on_title_selection_changed, title,
+                             input->title_selected);
+        if (title->chapter_count > 0)
+            vlc_player_SendEvent(player, on_chapter_selection_changed, title,
+                                 input->title_selected,
+                                 &title->chapters[input->chapter_selected],
+                                 input->chapter_selected);
+    }
+}
+
 static bool
 input_thread_Events(input_thread_t *input_thread,
                     const struct vlc_input_event *event, void *user_data)
@@ -911,6 +1066,12 @@ input_thread_Events(input_thread_t *input_thread,
 
     vlc_mutex_lock(&player->lock);
 
+    if (input->preloading && vlc_player_input_HandlePreloadEvent(input, event))
+    {
+        vlc_mutex_unlock(&player->lock);
+        return true;
+    }
+
     switch (event->type)
     {
         case INPUT_EVENT_STATE:
@@ -973,6 +1134,9 @@ input_thread_Events(input_thread_t *input_thread,
                 };
                 vlc_player_UpdateTimer(player, NULL, false, &point,
                                        input->normal_time, 0, 0, priv->i_start);
+
+                if (input == player->input)
+                    vlc_player_PreloadNextMedia(player);
             }
             break;
         }
@@ -1060,6 +1224,7 @@ input_thread_Events(input_thread_t *input_thread,
             break;
     }
 
+    player->silent = false;
     vlc_mutex_unlock(&player->lock);
     return handled;
 }
@@ -1114,6 +1279,7 @@ vlc_player_input_New(vlc_player_t *player, input_item_t *item)
     input->player = player;
     input->started = false;
     input->playing = false;
+    input->preloading = false;
 
     input->state = VLC_PLAYER_STATE_STOPPED;
     input->error = VLC_PLAYER_ERROR_NONE;
@@ -1179,18 +1345,6 @@ vlc_player_input_New(vlc_player_t *player, input_item_t *item)
     }
     vlc_player_input_RestoreMlStates(input, false);
 
-    if (player->video_string_ids)
-        vlc_player_input_SelectTracksByStringIds(input, VIDEO_ES,
-                                                 player->video_string_ids);
-
-    if (player->audio_string_ids)
-        vlc_player_input_SelectTracksByStringIds(input, AUDIO_ES,
-                                                 player->audio_string_ids);
-
-    if (player->sub_string_ids)
-        vlc_player_input_SelectTracksByStringIds(input, SPU_ES,
-                                                 player->sub_string_ids);
-
     /* Initial sub/audio delay */
     const vlc_tick_t cat_delays[DATA_ES] = {
         [AUDIO_ES] =
@@ -65,6 +65,7 @@ vlc_player_OpenNextMedia(vlc_player_t *player)
     player->sub_string_ids = NULL;
 
     int ret = VLC_SUCCESS;
+    bool preloaded = false;
     if (player->releasing_media)
     {
         assert(player->media);
@@ -82,9 +83,19 @@ vlc_player_OpenNextMedia(vlc_player_t *player)
         player->media = player->next_media;
         player->next_media = NULL;
 
-        struct vlc_player_input *input = player->input =
-            vlc_player_input_New(player, player->media);
-        if (!input)
+        if (player->preload != NULL)
+        {
+            /* The next media was opened ahead of time */
+            preloaded = true;
+            player->input = player->preload;
+            player->preload = NULL;
+            assert(input_GetItem(player->input->thread) == player->media);
+            player->input->preloading = false;
+        }
+        else
+            player->input = vlc_player_input_New(player, player->media);
+
+        if (!player->input)
         {
             input_item_Release(player->media);
             player->media = NULL;
@@ -92,6 +103,8 @@ vlc_player_OpenNextMedia(vlc_player_t *player)
         }
     }
     vlc_player_SendEvent(player, on_current_media_changed, player->media);
+    if (preloaded)
+        vlc_player_input_SendPreloadedState(player->input);
     if (player->input && player->input->ml.delay_restore)
     {
         vlc_player_SendEvent(player, on_playback_restore_queried);
@@ -172,6 +185,49 @@ vlc_player_destructor_AddJoinableInput(vlc_player_t *player,
     vlc_player_destructor_AddInput(player, input);
 }
 
+void
+vlc_player_PreloadNextMedia(vlc_player_t *player)
+{
+    struct vlc_player_input *current = player->input;
+
+    assert(current != NULL);
+    if (player->preload_delay <= 0 || player->preload != NULL
+     || !player->started || player->renderer != NULL
+     || player->next_media == NULL || player->next_media == player->media
+     || current->length == VLC_TICK_INVALID
+     || current->time == VLC_TICK_INVALID
+     || current->length - current->time > player->preload_delay)
+        return;
+
+    struct vlc_player_input *input =
+        vlc_player_input_New(player, player->next_media);
+    if (input == NULL)
+        return;
+
+    /* Open the media and its decoders now, but play nothing until the
+     * current media ends */
+    input->preloading = true;
+    var_Create(input->thread, "start-paused", VLC_VAR_BOOL);
+    var_SetBool(input->thread, "start-paused", true);
+
+    if (vlc_player_input_Start(input) != VLC_SUCCESS)
+    {
+        vlc_player_input_Delete(input);
+        return;
+    }
+    player->preload = input;
+}
+
+static void
+vlc_player_CancelPreload(vlc_player_t *player)
+{
+    if (player->preload != NULL)
+    {
+        vlc_player_destructor_AddInput(player, player->preload);
+        player->preload = NULL;
+    }
+}
+
 static bool vlc_player_destructor_IsEmpty(vlc_player_t *player)
 {
     return vlc_list_is_empty(&player->destructor.inputs)
@@ -211,7 +267,8 @@ vlc_player_destructor_Thread(void *data)
              * that will call this function. */
             input_item_t *media = input_GetItem(input->thread);
             input_Stop(input->thread);
-            vlc_player_SendEvent(player, on_stopping_current_media, media);
+            if (!input->preloading)
+                vlc_player_SendEvent(player, on_stopping_current_media, media);
         }
 
         bool keep_sout = true;
@@ -219,7 +276,8 @@ vlc_player_destructor_Thread(void *data)
             !vlc_list_is_empty(&player->destructor.joinable_inputs);
         vlc_list_foreach(input, &player->destructor.joinable_inputs, node)
         {
-            vlc_player_UpdateMLStates(player, input);
+            if (!input->preloading)
+                vlc_player_UpdateMLStates(player, input);
 
             keep_sout = var_GetBool(input->thread, "sout-keep");
 
@@ -998,6 +1056,7 @@ static void
 vlc_player_InvalidateNextMedia(vlc_player_t *player)
 {
     vlc_player_assert_locked(player);
+    vlc_player_CancelPreload(player);
     if (player->next_media)
     {
         input_item_Release(player->next_media);
@@ -1054,6 +1113,9 @@ vlc_player_SetNextMedia(vlc_player_t *player, input_item_t *media)
     /* Order is important, hold the new media before releasing the old one */
     input_item_t *next_media = media != NULL ? input_item_Hold(media) : NULL;
 
+    if (next_media != player->next_media)
+        vlc_player_CancelPreload(player);
+
     if (player->next_media != NULL)
         input_item_Release(player->next_media);
 
@@ -1200,6 +1262,18 @@ vlc_player_Start(vlc_player_t *player)
 
         if (!player->input)
             return VLC_ENOMEM;
+
+        if (player->video_string_ids)
+            vlc_player_input_SelectTracksByStringIds(player->input, VIDEO_ES,
+                                                     player->video_string_ids);
+
+        if (player->audio_string_ids)
+            vlc_player_input_SelectTracksByStringIds(player->input, AUDIO_ES,
+                                                     player->audio_string_ids);
+
+        if (player->sub_string_ids)
+            vlc_player_input_SelectTracksByStringIds(player->input, SPU_ES,
+                                                     player->sub_string_ids);
     }
     assert(!player->input->started);
 
@@ -1944,6 +2018,7 @@ vlc_player_Delete(vlc_player_t *player)
         vlc_player_destructor_AddInput(player, player->input);
         player->input = NULL;
     }
+    vlc_player_CancelPreload(player);
 
     player->deleting = true;
     vlc_cond_signal(&player->destructor.wait);
@@ -1966,6 +2041,7 @@ vlc_player_Delete(vlc_player_t *player)
     free(player->audio_string_ids);
     free(player->sub_string_ids);
 
+    vlc_player_DestroyPreview(player);
     vlc_player_DestroyTimer(player);
 
     vlc_player_aout_Deinit(player);
@@ -2016,6 +2092,14 @@ vlc_player_New(vlc_object_t *parent, enum vlc_player_lock_type lock_type)
 
     player->releasing_media = false;
     player->next_media = NULL;
+    player->preload = NULL;
+    player->silent = false;
+
+    /* A preloaded input would compete for the stream output */
+    char *sout = var_InheritString(player, "sout");
+    player->preload_delay = sout == NULL ?
+        VLC_TICK_FROM_MS(var_InheritInteger(player, "gapless-preload")) : 0;
+    free(sout);
 
     player->video_string_ids = player->audio_string_ids =
     player->sub_string_ids = NULL;
@@ -2074,10 +2158,12 @@ vlc_player_New(vlc_object_t *parent, enum vlc_player_lock_type lock_type)
     player->deleting = false;
     vlc_player_InitLocks(player, lock_type);
     vlc_player_InitTimer(player);
+    vlc_player_InitPreview(player);
 
     if (vlc_clone(&player->destructor.thread, vlc_player_destructor_Thread,
                   player) != 0)
     {
+        vlc_player_DestroyPreview(player);
         vlc_player_DestroyTimer(player);
         goto error;
     }
@@ -62,6 +62,9 @@ struct vlc_player_input
     /* Monitor the OPENING_S -> PLAYING_S transition. */
     bool playing;
 
+    /* Opened ahead of time, paused until the current media ends */
+    bool preloading;
+
     enum vlc_player_state state;
     enum vlc_player_error error;
     float rate;
@@ -232,6 +235,28 @@ struct vlc_player_timer
 #define smpte_source sources[VLC_PLAYER_TIMER_TYPE_SMPTE]
 };
 
+struct vlc_player_preview_listener_id
+{
+    const struct vlc_player_preview_cbs *cbs;
+    void *cbs_data;
+    struct vlc_list node;
+};
+
+struct vlc_player_preview
+{
+    vlc_mutex_t lock;
+    /* Created on first use */
+    struct vlc_preparser_t *preparser;
+    image_handler_t *image;
+
+    input_item_t *media; /* media of the cached previews */
+    struct vlc_list entries; /* most recently used first */
+    size_t count;
+    struct vlc_player_preview_request *pending;
+
+    struct vlc_list listeners;
+};
+
 struct vlc_player_t
 {
     struct vlc_object_t obj;
@@ -247,6 +272,9 @@ struct vlc_player_t
     bool corked;
 
     struct vlc_list listeners;
+    /* Set while handling the events of a preloaded input, that must not
+     * reach the listeners */
+    bool silent;
     struct vlc_list metadata_listeners;
     struct vlc_list aout_listeners;
     struct vlc_list vout_listeners;
@@ -260,6 +288,11 @@ struct vlc_player_t
     bool releasing_media;
     input_item_t *next_media;
 
+    /* Input of the next media, opened preload_delay before the end of the
+     * current one to shorten the gap between them */
+    struct vlc_player_input *preload;
+    vlc_tick_t preload_delay;
+
     char *video_string_ids;
     char *audio_string_ids;
     char *sub_string_ids;
@@ -288,6 +321,7 @@ struct vlc_player_t
     } destructor;
 
     struct vlc_player_timer timer;
+    struct vlc_player_preview preview;
 };
 
 #ifndef NDEBUG
@@ -316,6 +350,7 @@ vlc_player_get_input_locked(vlc_player_t *player)
 
 #define vlc_player_SendEvent(player, event, ...) do { \
     vlc_player_listener_id *listener; \
+    if (!player->silent) \
     vlc_list_foreach(listener, &player->listeners, node) \
     { \
         if (listener->cbs->event) \
@@ -345,6 +380,9 @@ vlc_player_GetObject(vlc_player_t *player);
 int
 vlc_player_OpenNextMedia(vlc_player_t *player);
 
+void
+vlc_player_PreloadNextMedia(vlc_player_t *player);
+
 void
 vlc_player_destructor_AddStoppingInput(vlc_player_t *player,
                                        struct vlc_player_input *input);
@@ -463,6 +501,9 @@ void
 vlc_player_input_HandleState(struct vlc_player_input *, enum vlc_player_state,
                              vlc_tick_t state_date);
 
+void
+vlc_player_input_SendPreloadedState(struct vlc_player_input *input);
+
 /*
  * player_timer.c
 */
@@ -501,6 +542,16 @@ vlc_player_GetTimerPoint(vlc_player_t *player, bool seeking,
                          vlc_tick_t system_now,
                          vlc_tick_t *out_ts, double *out_pos);
 
+/*
+ * player_preview.c
+ */
+
+void
+vlc_player_InitPreview(vlc_player_t *player);
+
+void
+vlc_player_DestroyPreview(vlc_player_t *player);
+
 /*
  * player_vout.c
  */
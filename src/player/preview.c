@@ -0,0 +1,361 @@
+/*****************************************************************************
+ * preview.c: Player seek bar previews
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_image.h>
+#include <vlc_picture.h>
+#include <vlc_preparser.h>
+
+#include "player.h"
+
+/* Number of previews kept per media */
+#define PREVIEW_CACHE_SIZE 64
+/* Number of distinct previews along the media length */
+#define PREVIEW_STEPS 256
+#define PREVIEW_MIN_STEP VLC_TICK_FROM_SEC(1)
+#define PREVIEW_MAX_WIDTH 320
+#define PREVIEW_TIMEOUT VLC_TICK_FROM_SEC(10)
+
+struct vlc_player_preview_entry
+{
+    vlc_tick_t time;
+    picture_t *picture;
+    struct vlc_list node;
+};
+
+struct vlc_player_preview_request
+{
+    vlc_player_t *player;
+    input_item_t *media;
+    vlc_tick_t time;
+    vlc_preparser_req_id id;
+};
+
+static void
+vlc_player_preview_Clear(struct vlc_player_preview *preview)
+{
+    struct vlc_player_preview_entry *entry;
+    vlc_list_foreach(entry, &preview->entries, node)
+    {
+        picture_Release(entry->picture);
+        free(entry);
+    }
+    vlc_list_init(&preview->entries);
+    preview->count = 0;
+
+    if (preview->media != NULL)
+    {
+        input_item_Release(preview->media);
+        preview->media = NULL;
+    }
+}
+
+static struct vlc_player_preview_entry *
+vlc_player_preview_Find(struct vlc_player_preview *preview, vlc_tick_t time)
+{
+    struct vlc_player_preview_entry *entry;
+    vlc_list_foreach(entry, &preview->entries, node)
+        if (entry->time == time)
+            return entry;
+    return NULL;
+}
+
+/* The thumbnailer outputs full size pictures, keep only what a seek bar
+ * tooltip can show, with square pixels */
+static picture_t *
+vlc_player_preview_Scale(image_handler_t *image, picture_t *picture)
+{
+    const video_format_t *fmt = &picture->format;
+    unsigned sar_num = fmt->i_sar_num ? fmt->i_sar_num : 1;
+    unsigned sar_den = fmt->i_sar_den ? fmt->i_sar_den : 1;
+
+    if (fmt->i_visible_width == 0 || fmt->i_visible_height == 0
+     || (uint64_t) fmt->i_visible_width * sar_num
+        <= (uint64_t) PREVIEW_MAX_WIDTH * sar_den)
+        return picture_Hold(picture);
+
+    uint64_t height = (uint64_t) fmt->i_visible_height * PREVIEW_MAX_WIDTH
+                    * sar_den / ((uint64_t) fmt->i_visible_width * sar_num);
+
+    video_format_t fmt_out;
+    video_format_Init(&fmt_out, fmt->i_chroma);
+    fmt_out.i_width = fmt_out.i_visible_width = PREVIEW_MAX_WIDTH;
+    fmt_out.i_height = fmt_out.i_visible_height =
+        __MAX(height & ~UINT64_C(1), 2);
+    fmt_out.i_sar_num = fmt_out.i_sar_den = 1;
+
+    picture_t *scaled = image_Convert(image, picture, fmt, &fmt_out);
+    video_format_Clean(&fmt_out);
+
+    /* A bigger preview is better than none */
+    return scaled != NULL ? scaled : picture_Hold(picture);
+}
+
+static void
+vlc_player_preview_OnEnded(input_item_t *item, int status,
+                           picture_t *thumbnail, void *data)
+{
+    struct vlc_player_preview_request *req = data;
+    vlc_player_t *player = req->player;
+    struct vlc_player_preview *preview = &player->preview;
+    (void) item;
+
+    /* Scale without the lock, the image handler is thread-safe */
+    picture_t *picture = NULL;
+    if (status == VLC_SUCCESS && thumbnail != NULL)
+        picture = vlc_player_preview_Scale(preview->image, thumbnail);
+
+    vlc_mutex_lock(&preview->lock);
+
+    if (preview->pending == req)
+        preview->pending = NULL;
+
+    if (picture != NULL && req->media == preview->media
+     && vlc_player_preview_Find(preview, req->time) == NULL)
+    {
+        struct vlc_player_preview_entry *entry = malloc(sizeof(*entry));
+        if (likely(entry != NULL))
+        {
+            entry->time = req->time;
+            entry->picture = picture_Hold(picture);
+            vlc_list_prepend(&entry->node, &preview->entries);
+
+            if (++preview->count > PREVIEW_CACHE_SIZE)
+            {
+                /* Evict the least recently used preview */
+                struct vlc_player_preview_entry *last =
+                    vlc_list_last_entry_or_null(&preview->entries,
+                        struct vlc_player_preview_entry, node);
+                vlc_list_remove(&last->node);
+                picture_Release(last->picture);
+                free(last);
+                preview->count--;
+            }
+
+            vlc_player_preview_listener_id *listener;
+            vlc_list_foreach(listener, &preview->listeners, node)
+                listener->cbs->on_ready(player, req->media, req->time,
+                                        picture, listener->cbs_data);
+        }
+    }
+
+    vlc_mutex_unlock(&preview->lock);
+
+    if (picture != NULL)
+        picture_Release(picture);
+    input_item_Release(req->media);
+    free(req);
+}
+
+static bool
+vlc_player_preview_Open(vlc_player_t *player)
+{
+    struct vlc_player_preview *preview = &player->preview;
+
+    if (preview->preparser != NULL)
+        return true;
+
+    preview->image = image_HandlerCreate(player);
+    if (preview->image == NULL)
+        return false;
+
+    const struct vlc_preparser_cfg cfg = {
+        .types = VLC_PREPARSER_TYPE_THUMBNAIL,
+        .max_thumbnailer_threads = 1,
+        .timeout = PREVIEW_TIMEOUT,
+    };
+    preview->preparser = vlc_preparser_New(VLC_OBJECT(player), &cfg);
+    if (preview->preparser == NULL)
+    {
+        image_HandlerDelete(preview->image);
+        preview->image = NULL;
+        return false;
+    }
+    return true;
+}
+
+static vlc_tick_t
+vlc_player_preview_GetStep(vlc_player_t *player)
+{
+    vlc_tick_t length = vlc_player_GetLength(player);
+
+    if (length == VLC_TICK_INVALID)
+        return PREVIEW_MIN_STEP;
+    return __MAX(length / PREVIEW_STEPS, PREVIEW_MIN_STEP);
+}
+
+picture_t *
+vlc_player_preview_Get(vlc_player_t *player, vlc_tick_t time,
+                       vlc_tick_t *preview_time)
+{
+    struct vlc_player_preview *preview = &player->preview;
+    vlc_player_assert_locked(player);
+
+    input_item_t *media = player->media;
+    if (media == NULL)
+        return NULL;
+
+    vlc_tick_t step = vlc_player_preview_GetStep(player);
+    if (time < 0)
+        time = 0;
+    time -= time % step;
+    if (preview_time != NULL)
+        *preview_time = time;
+
+    static const struct vlc_thumbnailer_cbs cbs = {
+        .on_ended = vlc_player_preview_OnEnded,
+    };
+    vlc_preparser_req_id cancel_id = VLC_PREPARSER_REQ_ID_INVALID;
+    picture_t *picture = NULL;
+
+    vlc_mutex_lock(&preview->lock);
+
+    if (preview->media != media)
+    {
+        vlc_player_preview_Clear(preview);
+        preview->media = input_item_Hold(media);
+    }
+
+    struct vlc_player_preview_entry *entry =
+        vlc_player_preview_Find(preview, time);
+    if (entry != NULL)
+    {
+        /* Most recently used first */
+        vlc_list_remove(&entry->node);
+        vlc_list_prepend(&entry->node, &preview->entries);
+        picture = picture_Hold(entry->picture);
+        goto end;
+    }
+
+    struct vlc_player_preview_request *pending = preview->pending;
+    if (pending != NULL && pending->media == media && pending->time == time)
+        goto end; /* already requested */
+
+    if (!vlc_player_preview_Open(player))
+        goto end;
+
+    struct vlc_player_preview_request *req = malloc(sizeof(*req));
+    if (unlikely(req == NULL))
+        goto end;
+    req->player = player;
+    req->media = input_item_Hold(media);
+    req->time = time;
+
+    const struct vlc_thumbnailer_arg arg = {
+        .seek = {
+            .type = VLC_THUMBNAILER_SEEK_TIME,
+            .time = time,
+            /* Key frames only, the preview is not worth a precise seek */
+            .speed = VLC_THUMBNAILER_SEEK_FAST,
+        },
+        .hw_dec = false,
+    };
+    req->id = vlc_preparser_GenerateThumbnail(preview->preparser, media,
+                                              &arg, &cbs, req);
+    if (req->id == VLC_PREPARSER_REQ_ID_INVALID)
+    {
+        input_item_Release(req->media);
+        free(req);
+        goto end;
+    }
+
+    /* Only the last requested preview matters while the pointer moves */
+    if (pending != NULL)
+        cancel_id = pending->id;
+    preview->pending = req;
+
+end:
+    vlc_mutex_unlock(&preview->lock);
+
+    /* The cancelled request may end synchronously, from this thread */
+    if (cancel_id != VLC_PREPARSER_REQ_ID_INVALID)
+        vlc_preparser_Cancel(preview->preparser, cancel_id);
+    return picture;
+}
+
+vlc_player_preview_listener_id *
+vlc_player_preview_AddListener(vlc_player_t *player,
+                               const struct vlc_player_preview_cbs *cbs,
+                               void *cbs_data)
+{
+    assert(cbs && cbs->on_ready);
+
+    vlc_player_preview_listener_id *listener = malloc(sizeof(*listener));
+    if (!listener)
+        return NULL;
+
+    listener->cbs = cbs;
+    listener->cbs_data = cbs_data;
+
+    vlc_mutex_lock(&player->preview.lock);
+    vlc_list_append(&listener->node, &player->preview.listeners);
+    vlc_mutex_unlock(&player->preview.lock);
+
+    return listener;
+}
+
+void
+vlc_player_preview_RemoveListener(vlc_player_t *player,
+                                  vlc_player_preview_listener_id *listener_id)
+{
+    assert(listener_id);
+
+    vlc_mutex_lock(&player->preview.lock);
+    vlc_list_remove(&listener_id->node);
+    vlc_mutex_unlock(&player->preview.lock);
+
+    free(listener_id);
+}
+
+void
+vlc_player_InitPreview(vlc_player_t *player)
+{
+    struct vlc_player_preview *preview = &player->preview;
+
+    vlc_mutex_init(&preview->lock);
+    preview->preparser = NULL;
+    preview->image = NULL;
+    preview->media = NULL;
+    vlc_list_init(&preview->entries);
+    preview->count = 0;
+    preview->pending = NULL;
+    vlc_list_init(&preview->listeners);
+}
+
+void
+vlc_player_DestroyPreview(vlc_player_t *player)
+{
+    struct vlc_player_preview *preview = &player->preview;
+
+    assert(vlc_list_is_empty(&preview->listeners));
+
+    /* Cancel and end all the requests, without the lock */
+    if (preview->preparser != NULL)
+        vlc_preparser_Delete(preview->preparser);
+    assert(preview->pending == NULL);
+
+    vlc_player_preview_Clear(preview);
+    if (preview->image != NULL)
+        image_HandlerDelete(preview->image);
+}
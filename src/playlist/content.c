@@ -34,8 +34,12 @@ void
 vlc_playlist_ClearItems(vlc_playlist_t *playlist)
 {
     vlc_playlist_item_t *item;
+    vlc_playlist_index_Clear(&playlist->index);
     vlc_vector_foreach(item, &playlist->items)
+    {
+        item->index = SIZE_MAX;
         vlc_playlist_item_Release(item);
+    }
     vlc_vector_clear(&playlist->items);
 }
 
@@ -199,34 +203,21 @@ ssize_t
 vlc_playlist_IndexOf(vlc_playlist_t *playlist, const vlc_playlist_item_t *item)
 {
     vlc_playlist_AssertLocked(playlist);
-
-    ssize_t index;
-    vlc_vector_index_of(&playlist->items, item, &index);
-    return index;
+    return vlc_playlist_index_Find(playlist, item);
 }
 
 ssize_t
 vlc_playlist_IndexOfMedia(vlc_playlist_t *playlist, const input_item_t *media)
 {
     vlc_playlist_AssertLocked(playlist);
-
-    playlist_item_vector_t *items = &playlist->items;
-    for (size_t i = 0; i < items->size; ++i)
-        if (items->data[i]->media == media)
-            return i;
-    return -1;
+    return vlc_playlist_index_FindMedia(playlist, media);
 }
 
 ssize_t
 vlc_playlist_IndexOfId(vlc_playlist_t *playlist, uint64_t id)
 {
     vlc_playlist_AssertLocked(playlist);
-
-    playlist_item_vector_t *items = &playlist->items;
-    for (size_t i = 0; i < items->size; ++i)
-        if (items->data[i]->id == id)
-            return i;
-    return -1;
+    return vlc_playlist_index_FindId(playlist, id);
 }
 
 void
@@ -274,6 +265,9 @@ vlc_playlist_Insert(vlc_playlist_t *playlist, size_t index,
     vlc_playlist_AssertLocked(playlist);
     assert(index <= playlist->items.size);
 
+    if (!vlc_playlist_index_Reserve(&playlist->index, count))
+        return VLC_ENOMEM;
+
     /* make space in the vector */
     if (!vlc_vector_insert_hole(&playlist->items, index, count))
         return VLC_ENOMEM;
@@ -288,6 +282,7 @@ vlc_playlist_Insert(vlc_playlist_t *playlist, size_t index,
         return ret;
     }
 
+    vlc_playlist_index_Add(playlist, index, count);
     vlc_playlist_ItemsInserted(playlist, index, count, true);
     vlc_playlist_UpdateNextMedia(playlist);
 
@@ -303,6 +298,8 @@ vlc_playlist_Move(vlc_playlist_t *playlist, size_t index, size_t count,
     assert(target + count <= playlist->items.size);
 
     vlc_vector_move_slice(&playlist->items, index, count, target);
+    vlc_playlist_index_Invalidate(&playlist->index,
+                                  index < target ? index : target);
 
     vlc_playlist_ItemsMoved(playlist, index, count, target);
     vlc_playlist_UpdateNextMedia(playlist);
@@ -315,6 +312,7 @@ vlc_playlist_Remove(vlc_playlist_t *playlist, size_t index, size_t count)
     assert(index < playlist->items.size);
 
     vlc_playlist_ItemsRemoving(playlist, index, count);
+    vlc_playlist_index_Remove(playlist, index, count);
 
     for (size_t i = 0; i < count; ++i) {
         vlc_playlist_item_t *item = playlist->items.data[index + i];
@@ -358,8 +356,11 @@ vlc_playlist_Replace(vlc_playlist_t *playlist, size_t index,
     if (playlist->parser != NULL
             && old->preparser_id != VLC_PREPARSER_REQ_ID_INVALID)
         vlc_preparser_Cancel(playlist->parser, old->preparser_id);
+    /* the old item leaves room for the new one in the index */
+    vlc_playlist_index_Remove(playlist, index, 1);
     vlc_playlist_item_Release(old);
     playlist->items.data[index] = item;
+    vlc_playlist_index_Add(playlist, index, 1);
 
     vlc_playlist_ItemReplaced(playlist, index);
     return VLC_SUCCESS;
@@ -382,6 +383,9 @@ vlc_playlist_Expand(vlc_playlist_t *playlist, size_t index,
 
         if (count > 1)
         {
+            if (!vlc_playlist_index_Reserve(&playlist->index, count - 1))
+                return VLC_ENOMEM;
+
             /* make space in the vector */
             if (!vlc_vector_insert_hole(&playlist->items, index + 1, count - 1))
                 return VLC_ENOMEM;
@@ -395,6 +399,7 @@ vlc_playlist_Expand(vlc_playlist_t *playlist, size_t index,
                 vlc_vector_remove_slice(&playlist->items, index + 1, count - 1);
                 return ret;
             }
+            vlc_playlist_index_Add(playlist, index + 1, count - 1);
             vlc_playlist_ItemsInserted(playlist, index + 1, count - 1, false);
         }
 
@@ -0,0 +1,263 @@
+/*****************************************************************************
+ * playlist/index.c
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "index.h"
+
+#include "item.h"
+#include "playlist.h"
+
+#define INDEX_MIN_BUCKETS 64
+
+static inline size_t
+HashId(uint64_t id)
+{
+    /* Fibonacci hashing, ids are mostly consecutive */
+    return (id * UINT64_C(0x9e3779b97f4a7c15)) >> 32;
+}
+
+static inline size_t
+HashMedia(const input_item_t *media)
+{
+    return HashId((uintptr_t) media >> 4);
+}
+
+static inline vlc_playlist_item_t **
+BucketId(struct vlc_playlist_index *index, uint64_t id)
+{
+    return &index->by_id[HashId(id) & (index->buckets - 1)];
+}
+
+static inline vlc_playlist_item_t **
+BucketMedia(struct vlc_playlist_index *index, const input_item_t *media)
+{
+    return &index->by_media[HashMedia(media) & (index->buckets - 1)];
+}
+
+void
+vlc_playlist_index_Init(struct vlc_playlist_index *index)
+{
+    index->by_id = index->by_media = NULL;
+    index->buckets = 0;
+    index->count = 0;
+    index->valid = 0;
+}
+
+void
+vlc_playlist_index_Destroy(struct vlc_playlist_index *index)
+{
+    free(index->by_id); /* by_media is in the same allocation */
+}
+
+void
+vlc_playlist_index_Clear(struct vlc_playlist_index *index)
+{
+    if (index->buckets > 0)
+        memset(index->by_id, 0, 2 * index->buckets * sizeof (*index->by_id));
+    index->count = 0;
+    index->valid = 0;
+}
+
+bool
+vlc_playlist_index_Reserve(struct vlc_playlist_index *index, size_t count)
+{
+    size_t needed = index->count + count;
+    if (needed <= index->buckets)
+        return true;
+
+    /* Keep the load factor under one */
+    size_t buckets = index->buckets ? index->buckets : INDEX_MIN_BUCKETS;
+    while (buckets < needed)
+    {
+        if (buckets > SIZE_MAX / (4 * sizeof (*index->by_id)))
+            return false;
+        buckets *= 2;
+    }
+
+    vlc_playlist_item_t **table = calloc(2 * buckets, sizeof (*table));
+    if (unlikely(table == NULL))
+        return false;
+
+    vlc_playlist_item_t **old = index->by_id;
+    size_t old_buckets = index->buckets;
+
+    index->by_id = table;
+    index->by_media = table + buckets;
+    index->buckets = buckets;
+
+    /* Every item is in both tables, walking one is enough */
+    for (size_t i = 0; i < old_buckets; i++)
+        for (vlc_playlist_item_t *item = old[i], *next; item != NULL;
+             item = next)
+        {
+            next = item->id_next;
+
+            vlc_playlist_item_t **pp = BucketId(index, item->id);
+            item->id_next = *pp;
+            *pp = item;
+
+            pp = BucketMedia(index, item->media);
+            item->media_next = *pp;
+            *pp = item;
+        }
+
+    free(old);
+    return true;
+}
+
+void
+vlc_playlist_index_Add(vlc_playlist_t *playlist, size_t pos, size_t count)
+{
+    struct vlc_playlist_index *index = &playlist->index;
+
+    assert(index->count + count <= index->buckets);
+
+    for (size_t i = pos; i < pos + count; ++i)
+    {
+        vlc_playlist_item_t *item = playlist->items.data[i];
+
+        item->index = i;
+
+        vlc_playlist_item_t **pp = BucketId(index, item->id);
+        item->id_next = *pp;
+        *pp = item;
+
+        pp = BucketMedia(index, item->media);
+        item->media_next = *pp;
+        *pp = item;
+    }
+    index->count += count;
+
+    /* the new items are numbered, the following ones have been shifted */
+    vlc_playlist_index_Invalidate(index, pos + count);
+}
+
+void
+vlc_playlist_index_Remove(vlc_playlist_t *playlist, size_t pos, size_t count)
+{
+    struct vlc_playlist_index *index = &playlist->index;
+
+    assert(count <= index->count);
+
+    for (size_t i = pos; i < pos + count; ++i)
+    {
+        vlc_playlist_item_t *item = playlist->items.data[i];
+        vlc_playlist_item_t **pp;
+
+        for (pp = BucketId(index, item->id); *pp != item;
+             pp = &(*pp)->id_next)
+            assert(*pp != NULL);
+        *pp = item->id_next;
+
+        for (pp = BucketMedia(index, item->media); *pp != item;
+             pp = &(*pp)->media_next)
+            assert(*pp != NULL);
+        *pp = item->media_next;
+
+        /* the item may outlive its removal */
+        item->index = SIZE_MAX;
+    }
+    index->count -= count;
+
+    vlc_playlist_index_Invalidate(index, pos);
+}
+
+static void
+Renumber(vlc_playlist_t *playlist, const vlc_playlist_item_t *item)
+{
+    struct vlc_playlist_index *index = &playlist->index;
+
+    if (item->index >= index->valid)
+    {
+        for (size_t i = index->valid; i < playlist->items.size; ++i)
+            playlist->items.data[i]->index = i;
+        index->valid = playlist->items.size;
+    }
+}
+
+/* Return the position of an indexed item */
+static size_t
+Position(vlc_playlist_t *playlist, const vlc_playlist_item_t *item)
+{
+    Renumber(playlist, item);
+    assert(playlist->items.data[item->index] == item);
+    return item->index;
+}
+
+ssize_t
+vlc_playlist_index_Find(vlc_playlist_t *playlist,
+                        const vlc_playlist_item_t *item)
+{
+    if (item->index == SIZE_MAX)
+        return -1; /* not in the playlist (anymore) */
+
+    Renumber(playlist, item);
+
+    /* the item might belong to another playlist */
+    size_t pos = item->index;
+    if (pos >= playlist->items.size || playlist->items.data[pos] != item)
+        return -1;
+    return pos;
+}
+
+ssize_t
+vlc_playlist_index_FindId(vlc_playlist_t *playlist, uint64_t id)
+{
+    struct vlc_playlist_index *index = &playlist->index;
+
+    if (index->buckets == 0)
+        return -1;
+
+    for (vlc_playlist_item_t *item = *BucketId(index, id); item != NULL;
+         item = item->id_next)
+        if (item->id == id)
+            return Position(playlist, item);
+    return -1;
+}
+
+ssize_t
+vlc_playlist_index_FindMedia(vlc_playlist_t *playlist,
+                             const input_item_t *media)
+{
+    struct vlc_playlist_index *index = &playlist->index;
+    ssize_t first = -1;
+
+    if (index->buckets == 0)
+        return -1;
+
+    /* the same media may have been inserted several times */
+    for (vlc_playlist_item_t *item = *BucketMedia(index, media); item != NULL;
+         item = item->media_next)
+        if (item->media == media)
+        {
+            ssize_t pos = Position(playlist, item);
+            if (first == -1 || pos < first)
+                first = pos;
+        }
+    return first;
+}
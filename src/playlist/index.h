@@ -0,0 +1,91 @@
+/*****************************************************************************
+ * playlist/index.h
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_PLAYLIST_INDEX_H
+#define VLC_PLAYLIST_INDEX_H
+
+#include <vlc_common.h>
+
+typedef struct vlc_playlist vlc_playlist_t;
+typedef struct vlc_playlist_item vlc_playlist_item_t;
+typedef struct input_item_t input_item_t;
+
+/**
+ * Hash tables of the playlist items by id and by media.
+ *
+ * The position of each item is cached in the item. Instead of renumbering the
+ * tail of the playlist on every edit, only the number of leading items whose
+ * position is known to be right is tracked, the others are renumbered on the
+ * next lookup. A series of edits thus costs a single renumbering.
+ */
+struct vlc_playlist_index
+{
+    vlc_playlist_item_t **by_id;
+    vlc_playlist_item_t **by_media;
+    size_t buckets; /**< size of each table, a power of 2 */
+    size_t count; /**< number of indexed items */
+    size_t valid; /**< the items before this position are numbered */
+};
+
+void
+vlc_playlist_index_Init(struct vlc_playlist_index *index);
+
+void
+vlc_playlist_index_Destroy(struct vlc_playlist_index *index);
+
+/* forget all the items (they are about to be released) */
+void
+vlc_playlist_index_Clear(struct vlc_playlist_index *index);
+
+/* make room to add count items without failing */
+bool
+vlc_playlist_index_Reserve(struct vlc_playlist_index *index, size_t count);
+
+/* index the items already stored at [pos, pos + count) in the playlist, room
+ * must have been reserved */
+void
+vlc_playlist_index_Add(vlc_playlist_t *playlist, size_t pos, size_t count);
+
+/* unindex the items stored at [pos, pos + count) in the playlist, before they
+ * are removed from the vector */
+void
+vlc_playlist_index_Remove(vlc_playlist_t *playlist, size_t pos, size_t count);
+
+/* the items from pos have been moved */
+static inline void
+vlc_playlist_index_Invalidate(struct vlc_playlist_index *index, size_t pos)
+{
+    if (pos < index->valid)
+        index->valid = pos;
+}
+
+ssize_t
+vlc_playlist_index_Find(vlc_playlist_t *playlist,
+                        const vlc_playlist_item_t *item);
+
+ssize_t
+vlc_playlist_index_FindId(vlc_playlist_t *playlist, uint64_t id);
+
+/* return the first position of the media */
+ssize_t
+vlc_playlist_index_FindMedia(vlc_playlist_t *playlist,
+                             const input_item_t *media);
+
+#endif
@@ -33,6 +33,10 @@ struct vlc_playlist_item
     uint64_t id;
     vlc_preparser_req_id preparser_id;
     vlc_atomic_rc_t rc;
+    /* owned by the playlist index, see index.h */
+    size_t index; /**< cached position, SIZE_MAX if not in the playlist */
+    struct vlc_playlist_item *id_next;
+    struct vlc_playlist_item *media_next;
 };
 
 /* _New() is private, it is called when inserting new media in the playlist */
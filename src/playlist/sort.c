@@ -22,6 +22,8 @@
 # include "config.h"
 #endif
 
+#include <ctype.h>
+
 #include <vlc_common.h>
 #include <vlc_rand.h>
 #include <vlc_sort.h>
@@ -31,17 +33,27 @@
 #include "notify.h"
 #include "playlist.h"
 
+/* Playlists smaller than this are sorted by the calling thread alone */
+#define SORT_MIN_ITEMS_PER_THREAD 8192
+#define SORT_MAX_THREADS 16
+
 /**
  * Struct containing a copy of (parsed) media metadata, used for sorting
  * without locking all the items.
+ *
+ * The strings compared without case are stored in lower case, and those
+ * compared with the locale collation come with their strxfrm() key, so that
+ * comparisons are plain strcmp().
  */
 struct vlc_playlist_item_meta {
     vlc_playlist_item_t *item;
     size_t index;
     const char *title_or_name;
+    const char *title_key;
     vlc_tick_t duration;
     const char *artist;
     const char *album;
+    const char *album_key;
     const char *album_artist;
     const char *genre;
     const char *url;
@@ -71,6 +83,35 @@ vlc_playlist_item_meta_CopyString(const char **to, const char *from)
     return VLC_SUCCESS;
 }
 
+static int
+vlc_playlist_item_meta_CopyFolded(const char **to, const char *from)
+{
+    int ret = vlc_playlist_item_meta_CopyString(to, from);
+    if (ret == VLC_SUCCESS && *to)
+        /* as strcasecmp() does */
+        for (char *p = (char *) *to; *p; ++p)
+            *p = tolower((unsigned char) *p);
+    return ret;
+}
+
+static int
+vlc_playlist_item_meta_CollationKey(const char **key, const char *str)
+{
+    if (!str)
+    {
+        *key = NULL;
+        return VLC_SUCCESS;
+    }
+
+    size_t len = strxfrm(NULL, str, 0);
+    char *buf = malloc(len + 1);
+    if (unlikely(!buf))
+        return VLC_ENOMEM;
+    strxfrm(buf, str, len + 1);
+    *key = buf;
+    return VLC_SUCCESS;
+}
+
 static int
 vlc_playlist_item_meta_GetNumber(const char * str, int64_t * to)
 {
@@ -106,8 +147,12 @@ vlc_playlist_item_meta_InitField(struct vlc_playlist_item_meta *meta,
             const char *value = input_item_GetMetaLocked(media, vlc_meta_Title);
             if (EMPTY_STR(value))
                 value = media->psz_name;
-            return vlc_playlist_item_meta_CopyString(&meta->title_or_name,
-                                                     value);
+            int ret = vlc_playlist_item_meta_CopyString(&meta->title_or_name,
+                                                        value);
+            if (ret != VLC_SUCCESS)
+                return ret;
+            return vlc_playlist_item_meta_CollationKey(&meta->title_key,
+                                                       value);
         }
         case VLC_PLAYLIST_SORT_KEY_DURATION:
         {
@@ -122,24 +167,28 @@ vlc_playlist_item_meta_InitField(struct vlc_playlist_item_meta *meta,
         {
             const char *value = input_item_GetMetaLocked(media,
                                                          vlc_meta_Artist);
-            return vlc_playlist_item_meta_CopyString(&meta->artist, value);
+            return vlc_playlist_item_meta_CopyFolded(&meta->artist, value);
         }
         case VLC_PLAYLIST_SORT_KEY_ALBUM:
         {
             const char *value = input_item_GetMetaLocked(media, vlc_meta_Album);
-            return vlc_playlist_item_meta_CopyString(&meta->album, value);
+            int ret = vlc_playlist_item_meta_CopyString(&meta->album, value);
+            if (ret != VLC_SUCCESS)
+                return ret;
+            return vlc_playlist_item_meta_CollationKey(&meta->album_key,
+                                                       value);
         }
         case VLC_PLAYLIST_SORT_KEY_ALBUM_ARTIST:
         {
             const char *value = input_item_GetMetaLocked(media,
                                                          vlc_meta_AlbumArtist);
-            return vlc_playlist_item_meta_CopyString(&meta->album_artist,
+            return vlc_playlist_item_meta_CopyFolded(&meta->album_artist,
                                                      value);
         }
         case VLC_PLAYLIST_SORT_KEY_GENRE:
         {
             const char *value = input_item_GetMetaLocked(media, vlc_meta_Genre);
-            return vlc_playlist_item_meta_CopyString(&meta->genre, value);
+            return vlc_playlist_item_meta_CopyFolded(&meta->genre, value);
         }
         case VLC_PLAYLIST_SORT_KEY_DATE:
         {
@@ -216,13 +265,16 @@ static void
 vlc_playlist_item_meta_DestroyFields(struct vlc_playlist_item_meta *meta)
 {
     free((void *) meta->title_or_name);
+    free((void *) meta->title_key);
     free((void *) meta->artist);
     free((void *) meta->album);
+    free((void *) meta->album_key);
     free((void *) meta->album_artist);
     free((void *) meta->genre);
     free((void *) meta->url);
 }
 
+/* On failure, the fields initialized so far must still be destroyed */
 static int
 vlc_playlist_item_meta_InitFields(struct vlc_playlist_item_meta *meta,
         const struct vlc_playlist_sort_criterion criteria[], size_t count)
@@ -232,24 +284,18 @@ vlc_playlist_item_meta_InitFields(struct vlc_playlist_item_meta *meta,
         const struct vlc_playlist_sort_criterion *criterion = &criteria[i];
         int ret = vlc_playlist_item_meta_InitField(meta, criterion->key);
         if (unlikely(ret != VLC_SUCCESS))
-        {
-            vlc_playlist_item_meta_DestroyFields(meta);
             return ret;
-        }
     }
     return VLC_SUCCESS;
 }
 
-static struct vlc_playlist_item_meta *
-vlc_playlist_item_meta_New(size_t index, vlc_playlist_item_t *item,
-                           const struct vlc_playlist_sort_criterion criteria[],
-                           size_t count)
+/* meta must be zeroed (NULL representation is assumed to be all-zeros) */
+static int
+vlc_playlist_item_meta_Init(struct vlc_playlist_item_meta *meta, size_t index,
+                            vlc_playlist_item_t *item,
+                            const struct vlc_playlist_sort_criterion criteria[],
+                            size_t count)
 {
-    /* assume that NULL representation is all-zeros */
-    struct vlc_playlist_item_meta *meta = calloc(1, sizeof(*meta));
-    if (unlikely(!meta))
-        return NULL;
-
     meta->item = item;
     meta->index = index;
 
@@ -257,37 +303,51 @@ vlc_playlist_item_meta_New(size_t index, vlc_playlist_item_t *item,
     int ret = vlc_playlist_item_meta_InitFields(meta, criteria, count);
     vlc_mutex_unlock(&item->media->lock);
 
-    if (unlikely(ret != VLC_SUCCESS))
-    {
-        free(meta);
-        return NULL;
-    }
-
-    return meta;
-}
-
-static void
-vlc_playlist_item_meta_Delete(struct vlc_playlist_item_meta *meta)
-{
-    vlc_playlist_item_meta_DestroyFields(meta);
-    free(meta);
+    return ret;
 }
 
+/* The strings are already folded to lower case */
 static inline int
 CompareStrings(const char *a, const char *b)
 {
     if (a && b)
-        return strcasecmp(a, b);
+        return strcmp(a, b);
     if (!a && !b)
         return 0;
     return a ? 1 : -1;
 }
 
+/* Same as vlc_filenamecmp(), comparing the collation keys instead of calling
+ * strcoll() */
 static inline int
-CompareFilenameStrings(const char *a, const char *b)
+CompareFilenames(const char *a, const char *key_a,
+                 const char *b, const char *key_b)
+{
+    size_t i;
+    char ca, cb;
+
+    for (i = 0; (ca = a[i]) == (cb = b[i]); i++)
+        if (ca == '\0')
+            return 0; /* strings are exactly identical */
+
+    if ((unsigned)(ca - '0') > 9 || (unsigned)(cb - '0') > 9)
+        return strcmp(key_a, key_b);
+
+    unsigned long long ua = strtoull(a + i, NULL, 10);
+    unsigned long long ub = strtoull(b + i, NULL, 10);
+
+    if (ua == ub)
+        return strcmp(key_a, key_b);
+
+    return (ua > ub) ? +1 : -1;
+}
+
+static inline int
+CompareFilenameStrings(const char *a, const char *key_a,
+                       const char *b, const char *key_b)
 {
     if (a && b)
-        return vlc_filenamecmp(a, b);
+        return CompareFilenames(a, key_a, b, key_b);
     if (!a && !b)
         return 0;
     return a ? 1 : -1;
@@ -333,13 +393,15 @@ CompareMetaByKey(const struct vlc_playlist_item_meta *a,
     switch (key)
     {
         case VLC_PLAYLIST_SORT_KEY_TITLE:
-            return CompareFilenameStrings(a->title_or_name, b->title_or_name);
+            return CompareFilenameStrings(a->title_or_name, a->title_key,
+                                          b->title_or_name, b->title_key);
         case VLC_PLAYLIST_SORT_KEY_DURATION:
             return CompareIntegers(a->duration, b->duration);
         case VLC_PLAYLIST_SORT_KEY_ARTIST:
             return CompareStrings(a->artist, b->artist);
         case VLC_PLAYLIST_SORT_KEY_ALBUM:
-            return CompareFilenameStrings(a->album, b->album);
+            return CompareFilenameStrings(a->album, a->album_key,
+                                          b->album, b->album_key);
         case VLC_PLAYLIST_SORT_KEY_ALBUM_ARTIST:
             return CompareStrings(a->album_artist, b->album_artist);
         case VLC_PLAYLIST_SORT_KEY_GENRE:
@@ -403,42 +465,153 @@ compare_meta(const void *lhs, const void *rhs, void *userdata)
     return a->index < b->index ? -1 : 1;
 }
 
-static void
-vlc_playlist_DeleteMetaArray(struct vlc_playlist_item_meta *array[],
-                             size_t count)
+struct sort_task
 {
-    for (size_t i = 0; i < count; ++i)
-        vlc_playlist_item_meta_Delete(array[i]);
-    free(array);
+    vlc_thread_t thread;
+    bool joinable;
+    vlc_playlist_t *playlist;
+    const struct sort_request *req;
+    struct vlc_playlist_item_meta *metas;
+    struct vlc_playlist_item_meta **array;
+    struct vlc_playlist_item_meta **tmp;
+    size_t begin;
+    size_t middle; /* merge only */
+    size_t end;
+    int status;
+};
+
+/* Copy the metadata of a range of items, and sort it */
+static void *
+SortRun(void *data)
+{
+    struct sort_task *task = data;
+    vlc_playlist_t *playlist = task->playlist;
+    const struct sort_request *req = task->req;
+
+    for (size_t i = task->begin; i < task->end; ++i)
+    {
+        int ret = vlc_playlist_item_meta_Init(&task->metas[i], i,
+                                              playlist->items.data[i],
+                                              req->criteria, req->count);
+        if (unlikely(ret != VLC_SUCCESS))
+        {
+            task->status = ret;
+            return NULL;
+        }
+        task->array[i] = &task->metas[i];
+    }
+
+    vlc_qsort(&task->array[task->begin], task->end - task->begin,
+              sizeof(*task->array), compare_meta, (void *) req);
+    task->status = VLC_SUCCESS;
+    return NULL;
 }
 
-static struct vlc_playlist_item_meta **
-vlc_playlist_NewMetaArray(vlc_playlist_t *playlist,
-        const struct vlc_playlist_sort_criterion criteria[], size_t count)
+/* Merge two adjacent sorted ranges */
+static void *
+SortMerge(void *data)
 {
-    struct vlc_playlist_item_meta **array =
-            vlc_alloc(playlist->items.size, sizeof(*array));
+    struct sort_task *task = data;
+    struct vlc_playlist_item_meta **array = task->array;
+    struct vlc_playlist_item_meta **out = &task->tmp[task->begin];
+    size_t i = task->begin, j = task->middle;
 
-    if (unlikely(!array))
-        return NULL;
+    while (i < task->middle && j < task->end)
+    {
+        if (compare_meta(&array[j], &array[i], (void *) task->req) < 0)
+            *out++ = array[j++];
+        else
+            *out++ = array[i++];
+    }
+    while (i < task->middle)
+        *out++ = array[i++];
+    /* the remaining items of the second range are already in place */
+
+    size_t count = out - &task->tmp[task->begin];
+    memcpy(&array[task->begin], &task->tmp[task->begin],
+           count * sizeof(*array));
+    return NULL;
+}
 
-    size_t i;
-    for (i = 0; i < playlist->items.size; ++i)
+/* Run the tasks, the first one on the calling thread */
+static void
+RunTasks(struct sort_task tasks[], unsigned count, void *(*entry)(void *))
+{
+    for (unsigned i = 1; i < count; ++i)
     {
-        array[i] = vlc_playlist_item_meta_New(i, playlist->items.data[i],
-                                              criteria, count);
-        if (unlikely(!array[i]))
-            break;
+        tasks[i].joinable = vlc_clone(&tasks[i].thread, entry, &tasks[i]) == 0;
+        if (!tasks[i].joinable)
+            entry(&tasks[i]);
     }
 
-    if (i < playlist->items.size)
+    entry(&tasks[0]);
+
+    for (unsigned i = 1; i < count; ++i)
+        if (tasks[i].joinable)
+            vlc_join(tasks[i].thread, NULL);
+}
+
+/**
+ * Sort the items metadata into array, splitting the work between several
+ * threads for large playlists: each of them copies and sorts a range of
+ * items, then the sorted ranges are merged pairwise.
+ */
+static int
+vlc_playlist_SortMeta(vlc_playlist_t *playlist, const struct sort_request *req,
+                      struct vlc_playlist_item_meta *metas,
+                      struct vlc_playlist_item_meta *array[])
+{
+    size_t size = playlist->items.size;
+    unsigned budget = 0, count = 1;
+    struct vlc_playlist_item_meta **tmp = NULL;
+
+    if (size >= 2 * SORT_MIN_ITEMS_PER_THREAD)
     {
-        /* allocation failure */
-        vlc_playlist_DeleteMetaArray(array, i);
-        return NULL;
+        size_t max = size / SORT_MIN_ITEMS_PER_THREAD;
+        budget = vlc_CPUBudgetAcquire(__MIN(max, SORT_MAX_THREADS));
+        if (budget > 1)
+        {
+            /* merge buffer */
+            tmp = vlc_alloc(size, sizeof(*tmp));
+            if (likely(tmp))
+                count = budget;
+        }
     }
 
-    return array;
+    struct sort_task tasks[SORT_MAX_THREADS];
+    size_t bounds[SORT_MAX_THREADS + 1];
+
+    for (unsigned i = 0; i <= count; ++i)
+        bounds[i] = size * i / count;
+
+    for (unsigned i = 0; i < count; ++i)
+        tasks[i] = (struct sort_task) {
+            .playlist = playlist, .req = req, .metas = metas, .array = array,
+            .begin = bounds[i], .end = bounds[i + 1],
+        };
+    RunTasks(tasks, count, SortRun);
+
+    int ret = VLC_SUCCESS;
+    for (unsigned i = 0; i < count; ++i)
+        if (tasks[i].status != VLC_SUCCESS)
+            ret = tasks[i].status;
+
+    if (ret == VLC_SUCCESS)
+        for (unsigned width = 1; width < count; width *= 2)
+        {
+            unsigned merges = 0;
+            for (unsigned i = 0; i + width < count; i += 2 * width)
+                tasks[merges++] = (struct sort_task) {
+                    .req = req, .array = array, .tmp = tmp,
+                    .begin = bounds[i], .middle = bounds[i + width],
+                    .end = bounds[__MIN(i + 2 * width, count)],
+                };
+            RunTasks(tasks, merges, SortMerge);
+        }
+
+    free(tmp);
+    vlc_CPUBudgetRelease(budget);
+    return ret;
 }
 
 int
@@ -453,20 +626,38 @@ vlc_playlist_Sort(vlc_playlist_t *playlist,
                                  ? playlist->items.data[playlist->current]
                                  : NULL;
 
-    struct vlc_playlist_item_meta **array =
-        vlc_playlist_NewMetaArray(playlist, criteria, count);
-    if (unlikely(!array))
-        return VLC_ENOMEM;
+    size_t size = playlist->items.size;
+    if (size > 0)
+    {
+        /* assume that NULL representation is all-zeros */
+        struct vlc_playlist_item_meta *metas = calloc(size, sizeof(*metas));
+        struct vlc_playlist_item_meta **array = vlc_alloc(size, sizeof(*array));
+        if (unlikely(!metas || !array))
+        {
+            free(metas);
+            free(array);
+            return VLC_ENOMEM;
+        }
 
-    struct sort_request req = { criteria, count };
+        struct sort_request req = { criteria, count };
+        int ret = vlc_playlist_SortMeta(playlist, &req, metas, array);
 
-    vlc_qsort(array, playlist->items.size, sizeof(*array), compare_meta, &req);
+        if (ret == VLC_SUCCESS)
+        {
+            /* apply the sorting result to the playlist */
+            for (size_t i = 0; i < size; ++i)
+                playlist->items.data[i] = array[i]->item;
+            vlc_playlist_index_Invalidate(&playlist->index, 0);
+        }
 
-    /* apply the sorting result to the playlist */
-    for (size_t i = 0; i < playlist->items.size; ++i)
-        playlist->items.data[i] = array[i]->item;
+        for (size_t i = 0; i < size; ++i)
+            vlc_playlist_item_meta_DestroyFields(&metas[i]);
+        free(metas);
+        free(array);
 
-    vlc_playlist_DeleteMetaArray(array, playlist->items.size);
+        if (ret != VLC_SUCCESS)
+            return ret;
+    }
 
     struct vlc_playlist_state state;
     if (current)
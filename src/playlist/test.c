@@ -25,6 +25,7 @@
 #endif
 
 #include <stdio.h>
+#include <vlc_strings.h>
 #include "item.h"
 #include "playlist.h"
 #include "preparse.h"
@@ -1065,6 +1066,55 @@ test_index_of(void)
     vlc_playlist_Delete(playlist);
 }
 
+static void
+test_index_of_after_edits(void)
+{
+    vlc_playlist_t *playlist = vlc_playlist_New(NULL, VLC_PLAYLIST_PREPARSING_DISABLED, 0, 0);
+    assert(playlist);
+
+    input_item_t *media[200];
+    CreateDummyMediaArray(media, 200);
+
+    /* enough items to grow the hash tables */
+    int ret = vlc_playlist_Append(playlist, media, 150);
+    assert(ret == VLC_SUCCESS);
+
+    /* insert a duplicate media before the original */
+    ret = vlc_playlist_InsertOne(playlist, 10, media[100]);
+    assert(ret == VLC_SUCCESS);
+    assert(vlc_playlist_IndexOfMedia(playlist, media[100]) == 10);
+
+    vlc_playlist_Move(playlist, 20, 30, 100);
+    vlc_playlist_Remove(playlist, 5, 3);
+    ret = vlc_playlist_Insert(playlist, 60, &media[150], 50);
+    assert(ret == VLC_SUCCESS);
+    vlc_playlist_Shuffle(playlist);
+    vlc_playlist_Remove(playlist, 0, 10);
+
+    /* the indices must match a linear scan */
+    for (size_t i = 0; i < vlc_playlist_Count(playlist); ++i)
+    {
+        vlc_playlist_item_t *item = vlc_playlist_Get(playlist, i);
+        assert(vlc_playlist_IndexOf(playlist, item) == (ssize_t) i);
+        assert(vlc_playlist_IndexOfId(playlist, item->id) == (ssize_t) i);
+
+        ssize_t first = -1;
+        for (size_t j = 0; j < vlc_playlist_Count(playlist) && first == -1; ++j)
+            if (vlc_playlist_Get(playlist, j)->media == item->media)
+                first = j;
+        assert(vlc_playlist_IndexOfMedia(playlist, item->media) == first);
+    }
+
+    vlc_playlist_Clear(playlist);
+    assert(vlc_playlist_IndexOfMedia(playlist, media[0]) == -1);
+    ret = vlc_playlist_AppendOne(playlist, media[0]);
+    assert(ret == VLC_SUCCESS);
+    assert(vlc_playlist_IndexOfMedia(playlist, media[0]) == 0);
+
+    DestroyMediaArray(media, 200);
+    vlc_playlist_Delete(playlist);
+}
+
 static void
 test_prev(void)
 {
@@ -2349,6 +2399,52 @@ test_sort(void)
     vlc_playlist_Delete(playlist);
 }
 
+static void
+test_sort_large(void)
+{
+    vlc_playlist_t *playlist = vlc_playlist_New(NULL, VLC_PLAYLIST_PREPARSING_DISABLED, 0, 0);
+    assert(playlist);
+
+    /* large enough to be sorted by several threads and merged */
+    const size_t count = 50000;
+    input_item_t **media = malloc(count * sizeof(*media));
+    assert(media);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        /* many duplicate titles, numbers of different lengths */
+        media[i] = CreateDummyMedia((i * 7919) % 1000);
+        assert(media[i]);
+        media[i]->i_duration = i % 3;
+    }
+
+    int ret = vlc_playlist_Append(playlist, media, count);
+    assert(ret == VLC_SUCCESS);
+
+    struct vlc_playlist_sort_criterion criteria[] = {
+        { VLC_PLAYLIST_SORT_KEY_TITLE, VLC_PLAYLIST_SORT_ORDER_ASCENDING },
+        { VLC_PLAYLIST_SORT_KEY_DURATION, VLC_PLAYLIST_SORT_ORDER_DESCENDING },
+    };
+
+    ret = vlc_playlist_Sort(playlist, criteria, 2);
+    assert(ret == VLC_SUCCESS);
+    assert(vlc_playlist_Count(playlist) == count);
+
+    for (size_t i = 1; i < count; ++i)
+    {
+        input_item_t *prev = vlc_playlist_Get(playlist, i - 1)->media;
+        input_item_t *cur = vlc_playlist_Get(playlist, i)->media;
+        int cmp = vlc_filenamecmp(prev->psz_name, cur->psz_name);
+        assert(cmp <= 0);
+        if (cmp == 0)
+            assert(prev->i_duration >= cur->i_duration);
+    }
+
+    DestroyMediaArray(media, count);
+    free(media);
+    vlc_playlist_Delete(playlist);
+}
+
 static void
 test_stable_sort(void)
 {
@@ -2441,6 +2537,7 @@ int main(void)
     test_playback_order_changed_callbacks();
     test_callbacks_on_add_listener();
     test_index_of();
+    test_index_of_after_edits();
     test_prev();
     test_next();
     test_goto();
@@ -2459,6 +2556,7 @@ int main(void)
     test_shuffle();
     test_sort();
     test_stable_sort();
+    test_sort_large();
     return 0;
 }
 
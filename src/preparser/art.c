@@ -38,7 +38,56 @@
 
 #include "art.h"
 
-static void ArtCacheCreateDir( char *psz_dir )
+/* Forget the whole index past this number of directories */
+#define ART_INDEX_MAX 4096
+
+static void FreeIndexEntry( void *data, void *obj )
+{
+    free( data );
+    VLC_UNUSED( obj );
+}
+
+void input_art_index_Init( input_art_index_t *index )
+{
+    vlc_mutex_init( &index->lock );
+    vlc_dictionary_init( &index->dirs, 0 );
+    index->count = 0;
+}
+
+void input_art_index_Clean( input_art_index_t *index )
+{
+    vlc_dictionary_clear( &index->dirs, FreeIndexEntry, NULL );
+}
+
+static void ArtIndexSet( input_art_index_t *index, const char *psz_dir,
+                         const char *psz_uri )
+{
+    if( index == NULL )
+        return;
+
+    char *value = strdup( psz_uri != NULL ? psz_uri : "" );
+    if( unlikely(value == NULL) )
+        return;
+
+    vlc_mutex_lock( &index->lock );
+    if( vlc_dictionary_has_key( &index->dirs, psz_dir ) )
+    {
+        vlc_dictionary_remove_value_for_key( &index->dirs, psz_dir,
+                                             FreeIndexEntry, NULL );
+        index->count--;
+    }
+    else if( index->count >= ART_INDEX_MAX )
+    {
+        vlc_dictionary_clear( &index->dirs, FreeIndexEntry, NULL );
+        vlc_dictionary_init( &index->dirs, 0 );
+        index->count = 0;
+    }
+    vlc_dictionary_insert( &index->dirs, psz_dir, value );
+    index->count++;
+    vlc_mutex_unlock( &index->lock );
+}
+
+static void ArtCacheCreateDir( const char *psz_dir )
 {
     vlc_mkdir_parent(psz_dir, 0700);
 }
@@ -146,13 +195,12 @@ end:
     return psz_path;
 }
 
-static char *ArtCacheName( input_item_t *p_item, const char *psz_type )
+static char *ArtCacheName( const char *psz_path, const char *psz_type )
 {
-    char *psz_path = ArtCachePath( p_item );
     char *psz_ext = strdup( psz_type ? psz_type : "" );
     char *psz_filename = NULL;
 
-    if( unlikely( !psz_path || !psz_ext ) )
+    if( unlikely( !psz_ext ) )
         goto end;
 
     ArtCacheCreateDir( psz_path );
@@ -163,28 +211,51 @@ static char *ArtCacheName( input_item_t *p_item, const char *psz_type )
 
 end:
     free( psz_ext );
-    free( psz_path );
 
     return psz_filename;
 }
 
 /* */
-int input_FindArtInCache( input_item_t *p_item )
+int input_FindArtInCache( input_item_t *p_item, input_art_index_t *index )
 {
     char *psz_path = ArtCachePath( p_item );
 
     if( !psz_path )
         return VLC_EGENERIC;
 
+    if( index != NULL )
+    {
+        bool b_indexed, b_found = false;
+
+        vlc_mutex_lock( &index->lock );
+        const char *psz_uri = vlc_dictionary_value_for_key( &index->dirs,
+                                                            psz_path );
+        b_indexed = psz_uri != NULL;
+        if( b_indexed && *psz_uri != '\0' )
+        {
+            input_item_SetArtURL( p_item, psz_uri );
+            b_found = true;
+        }
+        vlc_mutex_unlock( &index->lock );
+
+        if( b_indexed )
+        {
+            free( psz_path );
+            return b_found ? VLC_SUCCESS : VLC_EGENERIC;
+        }
+    }
+
     /* Check if file exists */
     vlc_DIR *p_dir = vlc_opendir( psz_path );
     if( !p_dir )
     {
+        ArtIndexSet( index, psz_path, NULL );
         free( psz_path );
         return VLC_EGENERIC;
     }
 
     bool b_found = false;
+    char *psz_uri = NULL;
     const char *psz_filename;
     while( !b_found && (psz_filename = vlc_readdir( p_dir )) )
     {
@@ -194,12 +265,9 @@ int input_FindArtInCache( input_item_t *p_item )
             if( asprintf( &psz_file, "%s" DIR_SEP "%s",
                           psz_path, psz_filename ) != -1 )
             {
-                char *psz_uri = vlc_path2uri( psz_file, "file" );
+                psz_uri = vlc_path2uri( psz_file, "file" );
                 if( psz_uri )
-                {
                     input_item_SetArtURL( p_item, psz_uri );
-                    free( psz_uri );
-                }
                 free( psz_file );
             }
 
@@ -209,6 +277,9 @@ int input_FindArtInCache( input_item_t *p_item )
 
     /* */
     vlc_closedir( p_dir );
+    if( !b_found || psz_uri != NULL )
+        ArtIndexSet( index, psz_path, psz_uri );
+    free( psz_uri );
     free( psz_path );
     return b_found ? VLC_SUCCESS : VLC_EGENERIC;
 }
@@ -278,17 +349,26 @@ int input_FindArtInCacheUsingItemUID( input_item_t *p_item )
 
 /* */
 int input_SaveArt( vlc_object_t *obj, input_item_t *p_item,
-                   const void *data, size_t length, const char *psz_type )
+                   const void *data, size_t length, const char *psz_type,
+                   input_art_index_t *index )
 {
-    char *psz_filename = ArtCacheName( p_item, psz_type );
+    char *psz_path = ArtCachePath( p_item );
 
+    if( !psz_path )
+        return VLC_EGENERIC;
+
+    char *psz_filename = ArtCacheName( psz_path, psz_type );
     if( !psz_filename )
+    {
+        free( psz_path );
         return VLC_EGENERIC;
+    }
 
     char *psz_uri = vlc_path2uri( psz_filename, "file" );
     if( !psz_uri )
     {
         free( psz_filename );
+        free( psz_path );
         return VLC_EGENERIC;
     }
 
@@ -297,8 +377,10 @@ int input_SaveArt( vlc_object_t *obj, input_item_t *p_item,
     if( !vlc_stat( psz_filename, &s ) )
     {
         input_item_SetArtURL( p_item, psz_uri );
+        ArtIndexSet( index, psz_path, psz_uri );
         free( psz_filename );
         free( psz_uri );
+        free( psz_path );
         return VLC_SUCCESS;
     }
 
@@ -314,10 +396,12 @@ int input_SaveArt( vlc_object_t *obj, input_item_t *p_item,
         {
             msg_Dbg( obj, "album art saved to %s", psz_filename );
             input_item_SetArtURL( p_item, psz_uri );
+            ArtIndexSet( index, psz_path, psz_uri );
         }
         fclose( f );
     }
     free( psz_uri );
+    free( psz_path );
 
     /* save uid info */
     char *uid = input_item_GetInfo( p_item, "uid", "md5" );
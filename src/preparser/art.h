@@ -24,11 +24,27 @@
 #ifndef _INPUT_ART_H
 #define _INPUT_ART_H 1
 
-int input_FindArtInCache( input_item_t * );
+#include <vlc_arrays.h>
+
+/* In-memory index of the art cache directories, so that the tracks of an
+ * album do not list the same directory again and again */
+typedef struct
+{
+    vlc_mutex_t lock;
+    vlc_dictionary_t dirs; /* directory -> art URI, "" if there is none */
+    size_t count;
+} input_art_index_t;
+
+void input_art_index_Init( input_art_index_t * );
+void input_art_index_Clean( input_art_index_t * );
+
+/* The index can be NULL */
+int input_FindArtInCache( input_item_t *, input_art_index_t * );
 int input_FindArtInCacheUsingItemUID( input_item_t * );
 
 int input_SaveArt( vlc_object_t *, input_item_t *,
-                   const void *, size_t, const char *psz_type );
+                   const void *, size_t, const char *psz_type,
+                   input_art_index_t * );
 
 #endif
 
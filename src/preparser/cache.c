@@ -0,0 +1,548 @@
+/*****************************************************************************
+ * cache.c: persistent cache of preparsed items
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <sys/stat.h>
+#include <errno.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_configuration.h>
+#include <vlc_input_item.h>
+#include <vlc_fs.h>
+#include <vlc_strings.h>
+#include <vlc_url.h>
+#include <vlc_hash.h>
+
+#include "input/item.h"
+#include "cache.h"
+
+/* Raw audio and video formats are stored as is, so the on-disk format is tied
+ * to the exact LibVLC version. */
+#define PARSED_CACHE_STRING "preparse "PACKAGE_NAME" "PACKAGE_VERSION
+
+/* Upper bound of a stored string, including the nul terminator */
+#define PARSED_CACHE_STRING_MAX (1 << 20)
+
+/**
+ * Resolves the cache entry file name of an item.
+ *
+ * Only local regular files are cached, and only if the item has no options, as
+ * those could affect the parsing.
+ */
+static char *ParsedCacheName( input_item_t *p_item, char **ppsz_path,
+                              struct stat *p_st, char **ppsz_dir )
+{
+    char *psz_path = NULL;
+
+    vlc_mutex_lock( &p_item->lock );
+    if( p_item->i_options == 0 && p_item->psz_uri != NULL )
+        psz_path = vlc_uri2path( p_item->psz_uri );
+    vlc_mutex_unlock( &p_item->lock );
+
+    if( psz_path == NULL )
+        return NULL;
+
+    if( vlc_stat( psz_path, p_st ) || !S_ISREG( p_st->st_mode ) )
+    {
+        free( psz_path );
+        return NULL;
+    }
+
+    char *psz_cachedir = config_GetUserDir( VLC_CACHE_DIR );
+    if( unlikely(psz_cachedir == NULL) )
+    {
+        free( psz_path );
+        return NULL;
+    }
+
+    char psz_hash[VLC_HASH_MD5_DIGEST_HEX_SIZE];
+    vlc_hash_md5_t md5;
+
+    vlc_hash_md5_Init( &md5 );
+    vlc_hash_md5_Update( &md5, psz_path, strlen( psz_path ) );
+    vlc_hash_FinishHex( &md5, psz_hash );
+
+    /* Spread the entries over 256 directories */
+    char *psz_dir, *psz_name = NULL;
+    if( asprintf( &psz_dir, "%s" DIR_SEP "preparse" DIR_SEP "%.2s",
+                  psz_cachedir, psz_hash ) == -1 )
+        psz_dir = NULL;
+    else if( asprintf( &psz_name, "%s" DIR_SEP "%s", psz_dir, psz_hash ) == -1 )
+        psz_name = NULL;
+    free( psz_cachedir );
+
+    if( psz_name == NULL )
+    {
+        free( psz_dir );
+        free( psz_path );
+        return NULL;
+    }
+
+    *ppsz_path = psz_path;
+    if( ppsz_dir != NULL )
+        *ppsz_dir = psz_dir;
+    else
+        free( psz_dir );
+    return psz_name;
+}
+
+/*
+ * Loading
+ */
+static int ParsedLoadImmediate( void *out, block_t *in, size_t size )
+{
+    if( in->i_buffer < size )
+        return -1;
+
+    memcpy( out, in->p_buffer, size );
+    in->p_buffer += size;
+    in->i_buffer -= size;
+    return 0;
+}
+
+static int ParsedLoadBool( bool *out, block_t *in )
+{
+    unsigned char b;
+
+    if( ParsedLoadImmediate( &b, in, 1 ) || b > 1 )
+        return -1;
+
+    *out = b;
+    return 0;
+}
+
+static int ParsedLoadString( const char **restrict p, block_t *file )
+{
+    uint32_t size;
+
+    if( ParsedLoadImmediate( &size, file, sizeof (size) )
+     || size > PARSED_CACHE_STRING_MAX )
+        return -1;
+
+    if( size == 0 )
+    {
+        *p = NULL;
+        return 0;
+    }
+
+    const char *str = (char *)file->p_buffer;
+
+    if( file->i_buffer < size || str[size - 1] != '\0' )
+        return -1;
+
+    file->p_buffer += size;
+    file->i_buffer -= size;
+    *p = str;
+    return 0;
+}
+
+#define LOAD_IMMEDIATE(a) \
+    if( ParsedLoadImmediate( &(a), file, sizeof (a) ) ) \
+        goto error
+#define LOAD_FLAG(a) \
+    if( ParsedLoadBool( &(a), file ) ) \
+        goto error
+#define LOAD_STRING(a) \
+    if( ParsedLoadString( &(a), file ) ) \
+        goto error
+
+struct parsed_es
+{
+    es_format_t fmt;
+    const char *id;
+    bool id_stable;
+};
+
+static int ParsedLoadEs( struct parsed_es *es, block_t *file )
+{
+    const char *psz;
+
+    es_format_Init( &es->fmt, UNKNOWN_ES, 0 );
+
+    LOAD_STRING( es->id );
+    if( es->id == NULL )
+        goto error;
+    LOAD_FLAG( es->id_stable );
+    LOAD_IMMEDIATE( es->fmt.i_cat );
+    switch( es->fmt.i_cat )
+    {
+        case UNKNOWN_ES:
+        case VIDEO_ES:
+        case AUDIO_ES:
+        case SPU_ES:
+        case DATA_ES:
+            break;
+        default:
+            es->fmt.i_cat = UNKNOWN_ES;
+            goto error;
+    }
+    LOAD_IMMEDIATE( es->fmt.i_codec );
+    LOAD_IMMEDIATE( es->fmt.i_original_fourcc );
+    LOAD_IMMEDIATE( es->fmt.i_id );
+    LOAD_IMMEDIATE( es->fmt.i_group );
+    LOAD_IMMEDIATE( es->fmt.i_priority );
+    LOAD_IMMEDIATE( es->fmt.i_bitrate );
+    LOAD_IMMEDIATE( es->fmt.i_profile );
+    LOAD_IMMEDIATE( es->fmt.i_level );
+    LOAD_FLAG( es->fmt.b_packetized );
+
+    LOAD_STRING( psz );
+    if( psz != NULL && (es->fmt.psz_language = strdup( psz )) == NULL )
+        goto error;
+    LOAD_STRING( psz );
+    if( psz != NULL && (es->fmt.psz_description = strdup( psz )) == NULL )
+        goto error;
+
+    switch( es->fmt.i_cat )
+    {
+        case AUDIO_ES:
+            LOAD_IMMEDIATE( es->fmt.audio );
+            LOAD_IMMEDIATE( es->fmt.audio_replay_gain );
+            break;
+        case VIDEO_ES:
+            LOAD_IMMEDIATE( es->fmt.video );
+            es->fmt.video.p_palette = NULL;
+            break;
+        default:
+            break;
+    }
+    return 0;
+
+error:
+    es_format_Clean( &es->fmt );
+    return -1;
+}
+
+static int ParsedLoad( input_item_t *p_item, block_t *file,
+                       const char *psz_path, const struct stat *p_st )
+{
+    static const char magic[] = PARSED_CACHE_STRING;
+    struct parsed_es *es = NULL;
+    uint32_t es_count = 0, es_loaded = 0;
+    vlc_meta_t *p_meta = vlc_meta_New();
+    const char *psz;
+
+    if( unlikely(p_meta == NULL) )
+        return VLC_ENOMEM;
+
+    if( file->i_buffer < sizeof (magic)
+     || memcmp( file->p_buffer, magic, sizeof (magic) ) )
+        goto error;
+    file->p_buffer += sizeof (magic);
+    file->i_buffer -= sizeof (magic);
+
+    /* Check that the entry matches the current version of the file */
+    uint64_t size;
+    int64_t mtime;
+
+    LOAD_STRING( psz );
+    if( psz == NULL || strcmp( psz, psz_path ) )
+        goto error; /* hash collision */
+    LOAD_IMMEDIATE( size );
+    LOAD_IMMEDIATE( mtime );
+    if( size != (uint64_t)p_st->st_size || mtime != (int64_t)p_st->st_mtime )
+        goto error;
+
+    vlc_tick_t i_duration;
+    LOAD_IMMEDIATE( i_duration );
+
+    for( int i = 0; i < VLC_META_TYPE_COUNT; i++ )
+    {
+        LOAD_STRING( psz );
+        if( psz != NULL )
+            vlc_meta_Set( p_meta, i, psz );
+    }
+
+    uint32_t extra_count;
+    LOAD_IMMEDIATE( extra_count );
+    for( uint32_t i = 0; i < extra_count; i++ )
+    {
+        const char *psz_value;
+
+        LOAD_STRING( psz );
+        LOAD_STRING( psz_value );
+        if( psz == NULL )
+            goto error;
+        vlc_meta_SetExtra( p_meta, psz, psz_value );
+    }
+
+    LOAD_IMMEDIATE( es_count );
+    if( es_count > file->i_buffer ) /* sanity check */
+        goto error;
+    if( es_count > 0 )
+    {
+        es = vlc_alloc( es_count, sizeof (*es) );
+        if( unlikely(es == NULL) )
+            goto error;
+    }
+    for( ; es_loaded < es_count; es_loaded++ )
+        if( ParsedLoadEs( &es[es_loaded], file ) )
+            goto error;
+
+    /* The whole entry is valid: update the item */
+    input_item_SetDuration( p_item, i_duration );
+
+    vlc_mutex_lock( &p_item->lock );
+    if( p_item->p_meta == NULL )
+        p_item->p_meta = vlc_meta_New();
+    vlc_meta_Merge( p_item->p_meta, p_meta );
+    vlc_mutex_unlock( &p_item->lock );
+
+    for( uint32_t i = 0; i < es_count; i++ )
+    {
+        input_item_UpdateTracksInfo( p_item, &es[i].fmt, es[i].id,
+                                     es[i].id_stable );
+        es_format_Clean( &es[i].fmt );
+    }
+    free( es );
+    vlc_meta_Delete( p_meta );
+    return VLC_SUCCESS;
+
+error:
+    for( uint32_t i = 0; i < es_loaded; i++ )
+        es_format_Clean( &es[i].fmt );
+    free( es );
+    vlc_meta_Delete( p_meta );
+    return VLC_EGENERIC;
+}
+
+int input_FindParsedInCache( input_item_t *p_item )
+{
+    char *psz_path;
+    struct stat st;
+    char *psz_name = ParsedCacheName( p_item, &psz_path, &st, NULL );
+
+    if( psz_name == NULL )
+        return VLC_EGENERIC;
+
+    int ret = VLC_EGENERIC;
+    block_t *file = block_FilePath( psz_name, false );
+
+    if( file != NULL )
+    {
+        ret = ParsedLoad( p_item, file, psz_path, &st );
+        block_Release( file );
+    }
+    free( psz_name );
+    free( psz_path );
+    return ret;
+}
+
+/*
+ * Saving
+ */
+#define SAVE_IMMEDIATE( a ) \
+    if( fwrite( &(a), sizeof (a), 1, file ) != 1 ) \
+        goto error
+#define SAVE_FLAG( a ) \
+    do { \
+        char b = (a); \
+        SAVE_IMMEDIATE( b ); \
+    } while (0)
+
+static int ParsedSaveString( FILE *file, const char *str )
+{
+    size_t len = (str != NULL) ? strlen( str ) + 1 : 0;
+    uint32_t size = (len <= PARSED_CACHE_STRING_MAX) ? len : 0;
+
+    SAVE_IMMEDIATE( size );
+    if( size != 0 && fwrite( str, 1, size, file ) != size )
+    {
+error:
+        return -1;
+    }
+    return 0;
+}
+
+#define SAVE_STRING( a ) \
+    if( ParsedSaveString( file, (a) ) ) \
+        goto error
+
+static int ParsedSaveEs( FILE *file, const struct input_item_es *es )
+{
+    const es_format_t *fmt = &es->es;
+
+    SAVE_STRING( es->id );
+    SAVE_FLAG( es->id_stable );
+    SAVE_IMMEDIATE( fmt->i_cat );
+    SAVE_IMMEDIATE( fmt->i_codec );
+    SAVE_IMMEDIATE( fmt->i_original_fourcc );
+    SAVE_IMMEDIATE( fmt->i_id );
+    SAVE_IMMEDIATE( fmt->i_group );
+    SAVE_IMMEDIATE( fmt->i_priority );
+    SAVE_IMMEDIATE( fmt->i_bitrate );
+    SAVE_IMMEDIATE( fmt->i_profile );
+    SAVE_IMMEDIATE( fmt->i_level );
+    SAVE_FLAG( fmt->b_packetized );
+    SAVE_STRING( fmt->psz_language );
+    SAVE_STRING( fmt->psz_description );
+
+    switch( fmt->i_cat )
+    {
+        case AUDIO_ES:
+            SAVE_IMMEDIATE( fmt->audio );
+            SAVE_IMMEDIATE( fmt->audio_replay_gain );
+            break;
+        case VIDEO_ES:
+        {
+            video_format_t video = fmt->video;
+
+            video.p_palette = NULL;
+            SAVE_IMMEDIATE( video );
+            break;
+        }
+        default:
+            break;
+    }
+    return 0;
+
+error:
+    return -1;
+}
+
+static int ParsedSaveHeader( FILE *file, const char *psz_path,
+                             const struct stat *p_st )
+{
+    static const char magic[] = PARSED_CACHE_STRING;
+    uint64_t size = p_st->st_size;
+    int64_t mtime = p_st->st_mtime;
+
+    if( fwrite( magic, sizeof (magic), 1, file ) != 1 )
+        goto error;
+    SAVE_STRING( psz_path );
+    SAVE_IMMEDIATE( size );
+    SAVE_IMMEDIATE( mtime );
+    return 0;
+
+error:
+    return -1;
+}
+
+static int ParsedSave( FILE *file, input_item_t *p_item,
+                       const char *psz_path, const struct stat *p_st )
+{
+    char **ppsz_extra = NULL;
+
+    if( ParsedSaveHeader( file, psz_path, p_st ) )
+        return -1;
+
+    vlc_mutex_lock( &p_item->lock );
+
+    SAVE_IMMEDIATE( p_item->i_duration );
+
+    const vlc_meta_t *p_meta = p_item->p_meta;
+    for( int i = 0; i < VLC_META_TYPE_COUNT; i++ )
+        SAVE_STRING( p_meta != NULL ? vlc_meta_Get( p_meta, i ) : NULL );
+
+    uint32_t extra_count = 0;
+    if( p_meta != NULL && vlc_meta_GetExtraCount( p_meta ) > 0 )
+    {
+        ppsz_extra = vlc_meta_CopyExtraNames( p_meta );
+        if( unlikely(ppsz_extra == NULL) )
+            goto error;
+        while( ppsz_extra[extra_count] != NULL )
+            extra_count++;
+    }
+    SAVE_IMMEDIATE( extra_count );
+    for( uint32_t i = 0; i < extra_count; i++ )
+    {
+        SAVE_STRING( ppsz_extra[i] );
+        SAVE_STRING( vlc_meta_GetExtra( p_meta, ppsz_extra[i] ) );
+    }
+
+    uint32_t es_count = p_item->es_vec.size;
+    SAVE_IMMEDIATE( es_count );
+    for( uint32_t i = 0; i < es_count; i++ )
+        if( ParsedSaveEs( file, &p_item->es_vec.data[i] ) )
+            goto error;
+
+    vlc_mutex_unlock( &p_item->lock );
+
+    if( ppsz_extra != NULL )
+        for( uint32_t i = 0; i < extra_count; i++ )
+            free( ppsz_extra[i] );
+    free( ppsz_extra );
+    return fflush( file ) ? -1 : 0;
+
+error:
+    vlc_mutex_unlock( &p_item->lock );
+    if( ppsz_extra != NULL )
+        for( uint32_t i = 0; ppsz_extra[i] != NULL; i++ )
+            free( ppsz_extra[i] );
+    free( ppsz_extra );
+    return -1;
+}
+
+int input_SaveParsed( vlc_object_t *obj, input_item_t *p_item )
+{
+    char *psz_path, *psz_dir, *psz_tmp;
+    struct stat st;
+    char *psz_name = ParsedCacheName( p_item, &psz_path, &st, &psz_dir );
+
+    if( psz_name == NULL )
+        return VLC_EGENERIC;
+
+    int ret = VLC_EGENERIC;
+
+    vlc_mkdir_parent( psz_dir, 0700 );
+    free( psz_dir );
+
+    /* Write to a temporary file, then atomically replace the entry */
+    if( asprintf( &psz_tmp, "%s.%lu", psz_name, vlc_thread_id() ) == -1 )
+        goto out;
+
+    FILE *file = vlc_fopen( psz_tmp, "wb" );
+    if( file == NULL )
+    {
+        msg_Dbg( obj, "cannot create %s: %s", psz_tmp,
+                 vlc_strerror_c(errno) );
+        free( psz_tmp );
+        goto out;
+    }
+
+    if( ParsedSave( file, p_item, psz_path, &st ) )
+    {
+        msg_Warn( obj, "cannot write %s: %s", psz_tmp, vlc_strerror_c(errno) );
+        fclose( file );
+        vlc_unlink( psz_tmp );
+    }
+    else
+    {
+        fclose( file );
+#if defined( _WIN32 ) || defined( __OS2__ )
+        vlc_unlink( psz_name );
+#endif
+        if( vlc_rename( psz_tmp, psz_name ) == 0 )
+            ret = VLC_SUCCESS;
+        else
+            vlc_unlink( psz_tmp );
+    }
+    free( psz_tmp );
+out:
+    free( psz_name );
+    free( psz_path );
+    return ret;
+}
@@ -0,0 +1,38 @@
+/*****************************************************************************
+ * cache.h
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef _INPUT_PREPARSE_CACHE_H
+#define _INPUT_PREPARSE_CACHE_H 1
+
+/**
+ * Restores the parsed duration, meta data and tracks of a local file item,
+ * if they were saved with input_SaveParsed() and the file was not modified
+ * since (same path, size and modification time).
+ *
+ * @return VLC_SUCCESS on cache hit, an error code otherwise
+ */
+int input_FindParsedInCache( input_item_t * );
+
+/**
+ * Saves the parsed duration, meta data and tracks of a local file item.
+ */
+int input_SaveParsed( vlc_object_t *, input_item_t * );
+
+#endif
@@ -32,6 +32,7 @@
 #include <vlc_memstream.h>
 #include <vlc_meta_fetcher.h>
 #include <vlc_executor.h>
+#include <vlc_url.h>
 
 #include "art.h"
 #include "../libvlc.h"
@@ -39,16 +40,25 @@
 #include "input/input_interface.h"
 #include "misc/interrupt.h"
 
+/* Downloads mostly wait for the network, run more of them than searches */
+#define FETCHER_MIN_DOWNLOADS 4
+/* Maximum number of simultaneous downloads from a single server */
+#define FETCHER_MAX_HOST_CONNS 2
+
 struct input_fetcher_t {
     vlc_executor_t *executor_local;
     vlc_executor_t *executor_network;
     vlc_executor_t *executor_downloader;
 
     vlc_dictionary_t album_cache;
+    input_art_index_t art_index;
     vlc_object_t* owner;
 
     vlc_mutex_t lock;
     struct vlc_list submitted_tasks; /**< list of struct task */
+    vlc_dictionary_t downloads; /**< art URL -> task downloading it */
+    vlc_dictionary_t hosts; /**< host -> number of downloads from it */
+    vlc_cond_t host_wait;
 };
 
 struct task {
@@ -63,6 +73,9 @@ struct task {
 
     struct vlc_runnable runnable; /**< to be passed to the executor */
     struct vlc_list node; /**< node of input_fetcher_t.submitted_tasks */
+
+    struct vlc_list waiters; /**< tasks waiting for the same download */
+    struct vlc_list waiter_node; /**< node of struct task.waiters */
 };
 
 static void RunDownloader(void *);
@@ -86,6 +99,7 @@ TaskNew(input_fetcher_t *fetcher, vlc_executor_t *executor, input_item_t *item,
     task->userdata = userdata;
 
     vlc_interrupt_init(&task->interrupt);
+    vlc_list_init(&task->waiters);
 
     input_item_Hold(item);
 
@@ -277,7 +291,7 @@ static int SearchByScope(struct task *task, int scope)
     if( ! CheckArt( item )                         ||
         ! ReadAlbumCache( fetcher, item )          ||
         ! input_FindArtInCacheUsingItemUID( item ) ||
-        ! input_FindArtInCache( item )             ||
+        ! input_FindArtInCache( item, &fetcher->art_index ) ||
         ! SearchArt( fetcher, item, scope ) )
     {
         AddAlbumCache( fetcher, task->item, false );
@@ -296,33 +310,104 @@ static void NotifyArtFetchEnded(struct task *task, bool fetched)
         task->cbs->on_art_fetch_ended(task->item, fetched, task->userdata);
 }
 
-static void RunDownloader(void *userdata)
+static char *AcquireHost( input_fetcher_t *fetcher, const char *psz_url )
 {
-    vlc_thread_set_name("vlc-run-fetcher");
+    vlc_url_t url;
+    char *host = NULL;
 
-    bool fetched = false;
-    struct task *task = userdata;
-    input_fetcher_t *fetcher = task->fetcher;
+    if( vlc_UrlParse( &url, psz_url ) == 0 && url.psz_host != NULL )
+        host = strdup( url.psz_host );
+    vlc_UrlClean( &url );
+    if( host == NULL )
+        return NULL; /* not limited */
 
-    vlc_interrupt_set(&task->interrupt);
+    vlc_mutex_lock( &fetcher->lock );
+    uintptr_t count;
+    while( (count = (uintptr_t)vlc_dictionary_value_for_key( &fetcher->hosts,
+                                                             host ))
+                >= FETCHER_MAX_HOST_CONNS )
+        vlc_cond_wait( &fetcher->host_wait, &fetcher->lock );
+
+    if( count > 0 )
+        vlc_dictionary_remove_value_for_key( &fetcher->hosts, host, NULL, NULL );
+    vlc_dictionary_insert( &fetcher->hosts, host, (void *)(count + 1) );
+    vlc_mutex_unlock( &fetcher->lock );
 
-    ReadAlbumCache( fetcher, task->item );
+    return host;
+}
 
-    char *psz_arturl = input_item_GetArtURL( task->item );
-    if( !psz_arturl )
-        goto out;
+static void ReleaseHost( input_fetcher_t *fetcher, char *host )
+{
+    if( host == NULL )
+        return;
 
-    if( !strncasecmp( psz_arturl, "file://", 7 ) ||
-        !strncasecmp( psz_arturl, "attachment://", 13 ) )
+    vlc_mutex_lock( &fetcher->lock );
+    uintptr_t count = (uintptr_t)vlc_dictionary_value_for_key( &fetcher->hosts,
+                                                               host );
+    assert( count > 0 );
+    vlc_dictionary_remove_value_for_key( &fetcher->hosts, host, NULL, NULL );
+    if( count > 1 )
+        vlc_dictionary_insert( &fetcher->hosts, host, (void *)(count - 1) );
+    vlc_cond_broadcast( &fetcher->host_wait );
+    vlc_mutex_unlock( &fetcher->lock );
+
+    free( host );
+}
+
+/* Returns true if the art is already being downloaded for another item, the
+ * task is then ended along with that download */
+static bool JoinDownload( input_fetcher_t *fetcher, struct task *task,
+                          const char *psz_arturl )
+{
+    vlc_mutex_lock( &fetcher->lock );
+    struct task *owner = vlc_dictionary_value_for_key( &fetcher->downloads,
+                                                       psz_arturl );
+    if( owner != NULL )
+        vlc_list_append( &task->waiter_node, &owner->waiters );
+    else
+        vlc_dictionary_insert( &fetcher->downloads, psz_arturl, task );
+    vlc_mutex_unlock( &fetcher->lock );
+
+    return owner != NULL;
+}
+
+static void EndDownload( input_fetcher_t *fetcher, struct task *task,
+                         const char *psz_arturl, bool fetched )
+{
+    vlc_mutex_lock( &fetcher->lock );
+    vlc_dictionary_remove_value_for_key( &fetcher->downloads, psz_arturl,
+                                         NULL, NULL );
+    vlc_mutex_unlock( &fetcher->lock );
+
+    /* No more waiters can be added, share the art file with them */
+    char *art = fetched ? input_item_GetArtURL( task->item ) : NULL;
+    struct task *waiter;
+    vlc_list_foreach( waiter, &task->waiters, waiter_node )
     {
-        fetched = true;
-        goto out; /* no fetch required */
+        vlc_list_remove( &waiter->waiter_node );
+        if( art != NULL )
+        {
+            input_item_SetArtURL( waiter->item, art );
+            input_item_SetArtFetched( waiter->item, true );
+        }
+        NotifyArtFetchEnded( waiter, art != NULL );
+        FetcherRemoveTask( fetcher, waiter );
+        TaskDelete( waiter );
     }
+    free( art );
+}
 
+static bool Download( input_fetcher_t *fetcher, struct task *task,
+                      const char *psz_arturl )
+{
+    char *host = AcquireHost( fetcher, psz_arturl );
     stream_t* source = vlc_stream_NewURL( fetcher->owner, psz_arturl );
 
     if( !source )
-        goto out;
+    {
+        ReleaseHost( fetcher, host );
+        return false;
+    }
 
     struct vlc_memstream output_stream;
     vlc_memstream_open( &output_stream );
@@ -340,22 +425,58 @@ static void RunDownloader(void *userdata)
     }
 
     vlc_stream_Delete( source );
+    ReleaseHost( fetcher, host );
 
     if( vlc_memstream_close( &output_stream ) )
-        goto out;
+        return false;
 
     if( vlc_killed() )
     {
         free( output_stream.ptr );
-        goto out;
+        return false;
     }
 
     input_SaveArt( fetcher->owner, task->item, output_stream.ptr,
-                   output_stream.length, NULL );
+                   output_stream.length, NULL, &fetcher->art_index );
 
     free( output_stream.ptr );
     AddAlbumCache( fetcher, task->item, true );
-    fetched = true;
+    return true;
+}
+
+static void RunDownloader(void *userdata)
+{
+    vlc_thread_set_name("vlc-run-fetcher");
+
+    bool fetched = false;
+    struct task *task = userdata;
+    input_fetcher_t *fetcher = task->fetcher;
+
+    vlc_interrupt_set(&task->interrupt);
+
+    ReadAlbumCache( fetcher, task->item );
+
+    char *psz_arturl = input_item_GetArtURL( task->item );
+    if( !psz_arturl )
+        goto out;
+
+    if( !strncasecmp( psz_arturl, "file://", 7 ) ||
+        !strncasecmp( psz_arturl, "attachment://", 13 ) )
+    {
+        fetched = true;
+        goto out; /* no fetch required */
+    }
+
+    /* The tracks of an album usually share the same art URL */
+    if( JoinDownload( fetcher, task, psz_arturl ) )
+    {
+        vlc_interrupt_set(NULL);
+        free( psz_arturl );
+        return;
+    }
+
+    fetched = Download( fetcher, task, psz_arturl );
+    EndDownload( fetcher, task, psz_arturl, fetched );
 
 out:
     vlc_interrupt_set(NULL);
@@ -433,6 +554,7 @@ input_fetcher_t* input_fetcher_New( vlc_object_t* owner,
     int max_threads = var_InheritInteger(owner, "fetch-art-threads");
     if (max_threads < 1)
         max_threads = 1;
+    int max_downloads = __MAX(max_threads, FETCHER_MIN_DOWNLOADS);
 
     if (request_type & VLC_PREPARSER_TYPE_FETCHMETA_LOCAL)
     {
@@ -461,7 +583,7 @@ input_fetcher_t* input_fetcher_New( vlc_object_t* owner,
     else
         fetcher->executor_network = NULL;
 
-    fetcher->executor_downloader = vlc_executor_New(max_threads);
+    fetcher->executor_downloader = vlc_executor_New(max_downloads);
     if (!fetcher->executor_downloader)
     {
         if (fetcher->executor_network)
@@ -476,8 +598,12 @@ input_fetcher_t* input_fetcher_New( vlc_object_t* owner,
 
     vlc_mutex_init(&fetcher->lock);
     vlc_list_init(&fetcher->submitted_tasks);
+    vlc_dictionary_init(&fetcher->downloads, 0);
+    vlc_dictionary_init(&fetcher->hosts, 0);
+    vlc_cond_init(&fetcher->host_wait);
 
     vlc_dictionary_init( &fetcher->album_cache, 0 );
+    input_art_index_Init( &fetcher->art_index );
 
     return fetcher;
 }
@@ -531,6 +657,12 @@ void input_fetcher_Delete( input_fetcher_t* fetcher )
     assert(fetcher->executor_downloader);
     vlc_executor_Delete(fetcher->executor_downloader);
 
+    /* Every download has ended, along with the tasks waiting for it */
+    assert(vlc_dictionary_keys_count(&fetcher->downloads) == 0);
+    vlc_dictionary_clear(&fetcher->downloads, NULL, NULL);
+    vlc_dictionary_clear(&fetcher->hosts, NULL, NULL);
+
     vlc_dictionary_clear( &fetcher->album_cache, FreeCacheEntry, NULL );
+    input_art_index_Clean( &fetcher->art_index );
     free( fetcher );
 }
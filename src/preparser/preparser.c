@@ -26,6 +26,7 @@
 
 #include <vlc_common.h>
 #include <vlc_atomic.h>
+#include <vlc_aout.h>
 #include <vlc_executor.h>
 #include <vlc_preparser.h>
 #include <vlc_interrupt.h>
@@ -35,12 +36,14 @@
 #include "input/input_interface.h"
 #include "input/input_internal.h"
 #include "fetcher.h"
+#include "cache.h"
 
 union vlc_preparser_cbs
 {
     const input_item_parser_cbs_t *parser;
     const struct vlc_thumbnailer_cbs *thumbnailer;
     const struct vlc_thumbnailer_to_files_cbs *thumbnailer_to_files;
+    const struct vlc_preparser_loudness_cbs *loudness;
 };
 
 struct vlc_preparser_t
@@ -50,7 +53,9 @@ struct vlc_preparser_t
     vlc_executor_t *parser;
     vlc_executor_t *thumbnailer;
     vlc_executor_t *thumbnailer_to_files;
+    vlc_executor_t *loudness;
     vlc_tick_t timeout;
+    bool cache;
 
     vlc_mutex_t lock;
     vlc_preparser_req_id current_id;
@@ -81,10 +86,13 @@ struct task
     picture_t *pic;
     struct task_thumbnail_output *outputs;
     size_t output_count;
+    struct vlc_audio_loudness loudness;
+    bool has_loudness;
 
     vlc_sem_t preparse_ended;
     int preparse_status;
     atomic_bool interrupted;
+    bool has_subtree;
 
     struct vlc_runnable runnable; /**< to be passed to the executor */
 
@@ -108,6 +116,7 @@ TaskNew(vlc_preparser_t *preparser, void (*run)(void *), input_item_t *item,
     task->pic = NULL;
     task->outputs = NULL;
     task->output_count = 0;
+    task->has_loudness = false;
 
     if (thumb_arg == NULL)
         task->thumb_arg = (struct vlc_thumbnailer_arg) {
@@ -122,6 +131,7 @@ TaskNew(vlc_preparser_t *preparser, void (*run)(void *), input_item_t *item,
     vlc_sem_init(&task->preparse_ended, 0);
     task->preparse_status = VLC_EGENERIC;
     atomic_init(&task->interrupted, false);
+    task->has_subtree = false;
 
     task->runnable.run = run;
     task->runnable.userdata = task;
@@ -202,6 +212,8 @@ OnParserSubtreeAdded(input_item_t *item, input_item_node_t *subtree,
     VLC_UNUSED(item);
     struct task *task = task_;
 
+    task->has_subtree = true;
+
     if (atomic_load(&task->interrupted))
         return;
 
@@ -311,7 +323,20 @@ ParserRun(void *userdata)
             goto end;
         }
 
-        Parse(task, deadline);
+        /* Attachments are not cached */
+        bool cache = preparser->cache
+                  && task->cbs.parser->on_attachments_added == NULL;
+
+        if (cache && input_FindParsedInCache(task->item) == VLC_SUCCESS)
+            task->preparse_status = VLC_SUCCESS;
+        else
+        {
+            Parse(task, deadline);
+
+            if (cache && task->preparse_status == VLC_SUCCESS
+             && !task->has_subtree && !atomic_load(&task->interrupted))
+                input_SaveParsed(preparser->owner, task->item);
+        }
     }
 
     PreparserRemoveTask(preparser, task);
@@ -476,6 +501,11 @@ ThumbnailerRun(void *userdata)
     if (!input)
         goto error;
 
+    /* Only one picture is wanted: do not wait for the frame threads of the
+     * decoder to fill up before getting it */
+    var_Create(input, "low-delay", VLC_VAR_BOOL);
+    var_SetBool(input, "low-delay", true);
+
     assert(task->thumb_arg.seek.speed == VLC_THUMBNAILER_SEEK_PRECISE
         || task->thumb_arg.seek.speed == VLC_THUMBNAILER_SEEK_FAST);
     bool fast_seek = task->thumb_arg.seek.speed == VLC_THUMBNAILER_SEEK_FAST;
@@ -541,8 +571,12 @@ ThumbnailerRun(void *userdata)
 
             assert(pic != NULL);
 
+            /* Finishing a started request takes precedence over starting
+             * new ones on the shared threads */
             task->runnable.run = ThumbnailerToFilesRun;
-            vlc_executor_Submit(preparser->thumbnailer_to_files, &task->runnable);
+            vlc_executor_SubmitPriority(preparser->thumbnailer_to_files,
+                                        &task->runnable,
+                                        VLC_EXECUTOR_PRIORITY_HIGH);
             pic = NULL;
             task = NULL;
         }
@@ -559,6 +593,90 @@ error:
         TaskDelete(task);
 }
 
+static bool
+on_loudness_input_event( input_thread_t *input,
+                         const struct vlc_input_event *event, void *userdata )
+{
+    VLC_UNUSED(input);
+    struct task *task = userdata;
+
+    if (event->type == INPUT_EVENT_LOUDNESS)
+    {
+        /* Sent from the decoder thread, only read after input_Close() */
+        task->loudness = *event->loudness;
+        task->has_loudness = true;
+        return true;
+    }
+
+    if ( event->type != INPUT_EVENT_STATE ||
+         ( event->state.value != ERROR_S && event->state.value != END_S ) )
+         return false;
+
+    if (event->state.value == END_S)
+        task->preparse_status = VLC_SUCCESS;
+    vlc_sem_post(&task->preparse_ended);
+    return true;
+}
+
+static void
+LoudnessRun(void *userdata)
+{
+    vlc_thread_set_name("vlc-run-loud");
+
+    struct task *task = userdata;
+    vlc_preparser_t *preparser = task->preparser;
+
+    static const struct vlc_input_thread_callbacks cbs = {
+        .on_event = on_loudness_input_event,
+    };
+
+    const struct vlc_input_thread_cfg cfg = {
+        .type = INPUT_TYPE_LOUDNESS,
+        .hw_dec = INPUT_CFG_HW_DEC_DISABLED,
+        .cbs = &cbs,
+        .cbs_data = task,
+    };
+
+    vlc_tick_t deadline = preparser->timeout != VLC_TICK_INVALID ?
+                          vlc_tick_now() + preparser->timeout :
+                          VLC_TICK_INVALID;
+
+    input_thread_t* input =
+            input_Create( preparser->owner, task->item, &cfg );
+    if (!input)
+        goto end;
+
+    if (input_Start(input) != VLC_SUCCESS)
+    {
+        input_Close(input);
+        goto end;
+    }
+
+    bool timeout = false;
+    if (deadline == VLC_TICK_INVALID)
+        vlc_sem_wait(&task->preparse_ended);
+    else
+        timeout = vlc_sem_timedwait(&task->preparse_ended, deadline) != 0;
+
+    /* The decoders are joined: no more measurements can be received */
+    input_Stop(input);
+    input_Close(input);
+
+    if (atomic_load(&task->interrupted))
+        task->preparse_status = -EINTR;
+    else if (timeout)
+        task->preparse_status = VLC_ETIMEOUT;
+    else if (task->preparse_status == VLC_SUCCESS && !task->has_loudness)
+        task->preparse_status = VLC_EGENERIC; /* no audio */
+
+end:
+    PreparserRemoveTask(preparser, task);
+    task->cbs.loudness->on_ended(task->item, task->preparse_status,
+                                 task->preparse_status == VLC_SUCCESS ?
+                                 &task->loudness : NULL, task->userdata);
+    TaskDelete(task);
+}
+
 static void
 Interrupt(struct task *task)
 {
@@ -580,18 +698,22 @@ vlc_preparser_t* vlc_preparser_New( vlc_object_t *parent,
     assert(request_type & (VLC_PREPARSER_TYPE_FETCHMETA_ALL|
                            VLC_PREPARSER_TYPE_PARSE|
                            VLC_PREPARSER_TYPE_THUMBNAIL|
-                           VLC_PREPARSER_TYPE_THUMBNAIL_TO_FILES));
+                           VLC_PREPARSER_TYPE_THUMBNAIL_TO_FILES|
+                           VLC_PREPARSER_TYPE_LOUDNESS));
 
     unsigned parser_threads = cfg->max_parser_threads == 0 ? 1 :
                               cfg->max_parser_threads;
     unsigned thumbnailer_threads = cfg->max_thumbnailer_threads == 0 ? 1 :
                                    cfg->max_thumbnailer_threads;
+    unsigned loudness_threads = cfg->max_loudness_threads == 0 ? 1 :
+                                cfg->max_loudness_threads;
 
     vlc_preparser_t* preparser = malloc( sizeof *preparser );
     if (!preparser)
         return NULL;
 
     preparser->timeout = cfg->timeout;
+    preparser->cache = cfg->cache;
     preparser->owner = parent;
 
     if (request_type & VLC_PREPARSER_TYPE_PARSE)
@@ -615,7 +737,12 @@ vlc_preparser_t* vlc_preparser_New( vlc_object_t *parent,
     if (request_type & (VLC_PREPARSER_TYPE_THUMBNAIL |
                         VLC_PREPARSER_TYPE_THUMBNAIL_TO_FILES))
     {
-        preparser->thumbnailer = vlc_executor_New(thumbnailer_threads);
+        /* Share idle threads with the parser, if any */
+        if (preparser->parser != NULL)
+            preparser->thumbnailer =
+                vlc_executor_NewShared(preparser->parser, thumbnailer_threads);
+        else
+            preparser->thumbnailer = vlc_executor_New(thumbnailer_threads);
         if (!preparser->thumbnailer)
             goto error_thumbnail;
     }
@@ -624,19 +751,38 @@ vlc_preparser_t* vlc_preparser_New( vlc_object_t *parent,
 
     if (request_type & VLC_PREPARSER_TYPE_THUMBNAIL_TO_FILES)
     {
-        preparser->thumbnailer_to_files = vlc_executor_New(1);
+        assert(preparser->thumbnailer != NULL);
+        preparser->thumbnailer_to_files =
+            vlc_executor_NewShared(preparser->thumbnailer, 1);
         if (preparser->thumbnailer_to_files == NULL)
             goto error_thumbnail_to_files;
     }
     else
         preparser->thumbnailer_to_files = NULL;
 
+    if (request_type & VLC_PREPARSER_TYPE_LOUDNESS)
+    {
+        /* Share idle threads with the parser, if any */
+        if (preparser->parser != NULL)
+            preparser->loudness =
+                vlc_executor_NewShared(preparser->parser, loudness_threads);
+        else
+            preparser->loudness = vlc_executor_New(loudness_threads);
+        if (!preparser->loudness)
+            goto error_loudness;
+    }
+    else
+        preparser->loudness = NULL;
+
     vlc_mutex_init(&preparser->lock);
     vlc_list_init(&preparser->submitted_tasks);
     preparser->current_id = 1;
 
     return preparser;
 
+error_loudness:
+    if (preparser->thumbnailer_to_files != NULL)
+        vlc_executor_Delete(preparser->thumbnailer_to_files);
 error_thumbnail_to_files:
     if (preparser->thumbnailer != NULL)
         vlc_executor_Delete(preparser->thumbnailer);
@@ -658,6 +804,7 @@ vlc_preparser_req_id vlc_preparser_Push( vlc_preparser_t *preparser, input_item_
 {
     assert((type_options & VLC_PREPARSER_TYPE_THUMBNAIL) == 0);
     assert((type_options & VLC_PREPARSER_TYPE_THUMBNAIL_TO_FILES) == 0);
+    assert((type_options & VLC_PREPARSER_TYPE_LOUDNESS) == 0);
 
     assert(type_options & VLC_PREPARSER_TYPE_PARSE
         || type_options & VLC_PREPARSER_TYPE_FETCHMETA_ALL);
@@ -680,9 +827,17 @@ vlc_preparser_req_id vlc_preparser_Push( vlc_preparser_t *preparser, input_item_
 
     if (preparser->parser != NULL)
     {
+        enum vlc_executor_priority priority = VLC_EXECUTOR_PRIORITY_NORMAL;
+
+        if (type_options & VLC_PREPARSER_OPTION_PRIORITY_HIGH)
+            priority = VLC_EXECUTOR_PRIORITY_HIGH;
+        else if (type_options & VLC_PREPARSER_OPTION_PRIORITY_LOW)
+            priority = VLC_EXECUTOR_PRIORITY_LOW;
+
         vlc_preparser_req_id id = PreparserAddTask(preparser, task);
 
-        vlc_executor_Submit(preparser->parser, &task->runnable);
+        vlc_executor_SubmitPriority(preparser->parser, &task->runnable,
+                                    priority);
 
         return id;
     }
@@ -697,6 +852,27 @@ vlc_preparser_req_id vlc_preparser_Push( vlc_preparser_t *preparser, input_item_
     return ret == VLC_SUCCESS ? id : 0;
 }
 
+size_t vlc_preparser_PushBatch( vlc_preparser_t *preparser,
+                                input_item_t *const *items, size_t count,
+                                int type_options,
+                                const input_item_parser_cbs_t *cbs,
+                                void *cbs_userdata, vlc_preparser_req_id *ids )
+{
+    size_t scheduled = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        vlc_preparser_req_id id = vlc_preparser_Push(preparser, items[i],
+                                                     type_options, cbs,
+                                                     cbs_userdata);
+        if (id != VLC_PREPARSER_REQ_ID_INVALID)
+            scheduled++;
+        if (ids != NULL)
+            ids[i] = id;
+    }
+    return scheduled;
+}
+
 vlc_preparser_req_id
 vlc_preparser_GenerateThumbnail( vlc_preparser_t *preparser, input_item_t *item,
                                  const struct vlc_thumbnailer_arg *thumb_arg,
@@ -723,6 +899,31 @@ vlc_preparser_GenerateThumbnail( vlc_preparser_t *preparser, input_item_t *item,
     return id;
 }
 
+vlc_preparser_req_id
+vlc_preparser_MeasureLoudness( vlc_preparser_t *preparser, input_item_t *item,
+                               const struct vlc_preparser_loudness_cbs *cbs,
+                               void *cbs_userdata )
+{
+    assert(preparser->loudness != NULL);
+    assert(cbs != NULL && cbs->on_ended != NULL);
+
+    union vlc_preparser_cbs task_cbs = {
+        .loudness = cbs,
+    };
+
+    struct task *task =
+        TaskNew(preparser, LoudnessRun, item, VLC_PREPARSER_TYPE_LOUDNESS,
+                NULL, task_cbs, cbs_userdata);
+    if (task == NULL)
+        return VLC_PREPARSER_REQ_ID_INVALID;
+
+    vlc_preparser_req_id id = PreparserAddTask(preparser, task);
+
+    vlc_executor_Submit(preparser->loudness, &task->runnable);
+
+    return id;
+}
+
 static int
 CheckThumbnailerFormat(enum vlc_thumbnailer_format format,
                        enum vlc_thumbnailer_format *out_format,
@@ -890,6 +1091,12 @@ size_t vlc_preparser_Cancel( vlc_preparser_t *preparser, vlc_preparser_req_id id
                                                    &task->runnable);
                 }
             }
+            else if (task->options & VLC_PREPARSER_TYPE_LOUDNESS)
+            {
+                assert(preparser->loudness != NULL);
+                canceled = vlc_executor_Cancel(preparser->loudness,
+                                               &task->runnable);
+            }
             else /* TODO: the fetcher should be cancellable too */
                 canceled = false;
 
@@ -905,6 +1112,10 @@ size_t vlc_preparser_Cancel( vlc_preparser_t *preparser, vlc_preparser_req_id id
                     task->cbs.parser->on_ended(task->item, task->preparse_status,
                                                task->userdata);
                 }
+                else if (task->options & VLC_PREPARSER_TYPE_LOUDNESS)
+                    task->cbs.loudness->on_ended(task->item,
+                                                 task->preparse_status, NULL,
+                                                 task->userdata);
                 else if (task->options & VLC_PREPARSER_TYPE_THUMBNAIL)
                 {
                     assert((task->options & VLC_PREPARSER_TYPE_THUMBNAIL_TO_FILES) == 0);
@@ -962,5 +1173,8 @@ void vlc_preparser_Delete( vlc_preparser_t *preparser )
     if (preparser->thumbnailer_to_files != NULL)
         vlc_executor_Delete(preparser->thumbnailer_to_files);
 
+    if (preparser->loudness != NULL)
+        vlc_executor_Delete(preparser->loudness);
+
     free( preparser );
 }
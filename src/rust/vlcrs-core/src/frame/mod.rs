@@ -0,0 +1,450 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// Copyright (C) 2026 VLC authors and VideoLAN
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+
+//! Owned bindings for `vlc_frame_t`, the buffers exchanged between the
+//! access, demux, packetizer and decoder modules.
+//!
+//! The buffers are never copied by these bindings: splitting and sharing a
+//! [Frame] creates other frames referring to the same memory, which is
+//! released along with the last of them, exactly as in C.
+
+use std::{ops::Deref, ptr::NonNull};
+
+mod sys;
+
+pub use sys::{vlc_frame_t, vlc_tick};
+
+/// The frame follows a discontinuity.
+pub const FLAG_DISCONTINUITY: u32 = 0x0001;
+/// The frame is an intra frame.
+pub const FLAG_TYPE_I: u32 = 0x0002;
+/// The frame is a predicted frame.
+pub const FLAG_TYPE_P: u32 = 0x0004;
+/// The frame is a bidirectional predicted frame.
+pub const FLAG_TYPE_B: u32 = 0x0008;
+/// The frame contains a header, such as codec extradata.
+pub const FLAG_HEADER: u32 = 0x0020;
+/// The frame is scrambled.
+pub const FLAG_SCRAMBLED: u32 = 0x0100;
+/// The frame must be decoded but not displayed.
+pub const FLAG_PREROLL: u32 = 0x0200;
+/// The frame is damaged.
+pub const FLAG_CORRUPTED: u32 = 0x0400;
+/// The frame ends an access unit.
+pub const FLAG_AU_END: u32 = 0x0800;
+
+const VLC_TICK_INVALID: vlc_tick = 0;
+
+fn tick_from_c(tick: vlc_tick) -> Option<vlc_tick> {
+    (tick != VLC_TICK_INVALID).then_some(tick)
+}
+
+///
+/// An owned `vlc_frame_t`, alone and not part of any chain.
+///
+/// The payload can always be read. It can only be written to when the frame
+/// is known not to share its buffer with any other frame, see
+/// [Frame::make_writable].
+///
+pub struct Frame {
+    frame: NonNull<sys::vlc_frame_t>,
+    writable: bool,
+}
+
+// SAFETY: a frame has a single owner and may be handed to another thread, as
+//         the C code does. The buffers shared between frames are read-only.
+unsafe impl Send for Frame {}
+
+impl Frame {
+    ///
+    /// Allocate a writable frame with a payload of `size` bytes.
+    ///
+    pub fn alloc(size: usize) -> Option<Frame> {
+        // SAFETY: vlc_frame_Alloc() has no preconditions.
+        let frame = unsafe { sys::vlc_frame_Alloc(size)? };
+        Some(Frame {
+            frame,
+            writable: true,
+        })
+    }
+
+    ///
+    /// Take ownership of a frame coming from the C code.
+    ///
+    /// # Safety
+    ///
+    /// `frame` must be a valid frame, owned by the caller and not chained
+    /// to any other frame.
+    ///
+    pub unsafe fn from_raw(frame: NonNull<sys::vlc_frame_t>) -> Frame {
+        debug_assert!(unsafe { frame.as_ref() }.p_next.is_null());
+        Frame {
+            frame,
+            writable: false,
+        }
+    }
+
+    ///
+    /// Give the frame to the C code, which becomes in charge of releasing it.
+    ///
+    pub fn into_raw(self) -> NonNull<sys::vlc_frame_t> {
+        let frame = self.frame;
+        std::mem::forget(self);
+        frame
+    }
+
+    fn raw(&self) -> &sys::vlc_frame_t {
+        // SAFETY: the frame is valid as long as it is owned.
+        unsafe { self.frame.as_ref() }
+    }
+
+    fn raw_mut(&mut self) -> &mut sys::vlc_frame_t {
+        // SAFETY: the frame is valid as long as it is owned, and the
+        //         mutable borrow of self guarantees exclusive access to the
+        //         frame properties.
+        unsafe { self.frame.as_mut() }
+    }
+
+    pub fn flags(&self) -> u32 {
+        self.raw().i_flags
+    }
+
+    pub fn set_flags(&mut self, flags: u32) {
+        self.raw_mut().i_flags = flags;
+    }
+
+    pub fn pts(&self) -> Option<vlc_tick> {
+        tick_from_c(self.raw().i_pts)
+    }
+
+    pub fn set_pts(&mut self, pts: Option<vlc_tick>) {
+        self.raw_mut().i_pts = pts.unwrap_or(VLC_TICK_INVALID);
+    }
+
+    pub fn dts(&self) -> Option<vlc_tick> {
+        tick_from_c(self.raw().i_dts)
+    }
+
+    pub fn set_dts(&mut self, dts: Option<vlc_tick>) {
+        self.raw_mut().i_dts = dts.unwrap_or(VLC_TICK_INVALID);
+    }
+
+    pub fn length(&self) -> vlc_tick {
+        self.raw().i_length
+    }
+
+    pub fn set_length(&mut self, length: vlc_tick) {
+        self.raw_mut().i_length = length;
+    }
+
+    ///
+    /// Get the payload for writing, if the frame is known to be writable.
+    ///
+    /// Frames coming from the C code, split from them or shared are not
+    /// known to be writable: use [Frame::make_writable] first.
+    ///
+    pub fn as_mut_slice(&mut self) -> Option<&mut [u8]> {
+        if !self.writable {
+            return None;
+        }
+        let frame = self.raw_mut();
+        // SAFETY: the payload is not shared with any other frame.
+        Some(unsafe { std::slice::from_raw_parts_mut(frame.p_buffer, frame.i_buffer) })
+    }
+
+    ///
+    /// Ensure the payload can be written to, copying it only if it is shared
+    /// with other frames.
+    ///
+    /// The frame is released if the copy cannot be allocated.
+    ///
+    pub fn make_writable(self) -> Option<Frame> {
+        if self.writable {
+            return Some(self);
+        }
+        // SAFETY: the ownership of the frame is given to
+        //         vlc_frame_MakeWritable(), which returns the writable frame.
+        let frame = unsafe { sys::vlc_frame_MakeWritable(self.into_raw())? };
+        Some(Frame {
+            frame,
+            writable: true,
+        })
+    }
+
+    ///
+    /// Create another read-only frame with the same payload and properties,
+    /// without copying.
+    ///
+    /// Both frames become read-only, until [Frame::make_writable] copies them.
+    ///
+    pub fn share(&mut self) -> Option<Frame> {
+        // SAFETY: vlc_frame_Share() may replace the frame with a view of the
+        //         same payload, which stays owned by self.
+        let view = unsafe { sys::vlc_frame_Share(&mut self.frame)? };
+        self.writable = false;
+        Some(Frame {
+            frame: view,
+            writable: false,
+        })
+    }
+
+    ///
+    /// Split the first `length` bytes of the payload off into another frame,
+    /// without copying.
+    ///
+    /// The returned frame has default properties, the remaining part keeps
+    /// those of the original frame.
+    ///
+    /// # Panics
+    ///
+    /// Panics if `length` exceeds the payload size.
+    ///
+    pub fn split_to(&mut self, length: usize) -> Option<Frame> {
+        assert!(length <= self.len(), "split beyond the frame payload");
+        // SAFETY: vlc_frame_Split() updates the frame to its remaining part,
+        //         which stays owned by self. Both parts refer to disjoint
+        //         ranges of the buffer and keep the original writability.
+        let head = unsafe { sys::vlc_frame_Split(&mut self.frame, length)? };
+        Some(Frame {
+            frame: head,
+            writable: self.writable,
+        })
+    }
+}
+
+impl Deref for Frame {
+    type Target = [u8];
+
+    fn deref(&self) -> &[u8] {
+        let frame = self.raw();
+        if frame.i_buffer == 0 {
+            return &[];
+        }
+        // SAFETY: the payload is valid and not written to while borrowed.
+        unsafe { std::slice::from_raw_parts(frame.p_buffer, frame.i_buffer) }
+    }
+}
+
+impl Drop for Frame {
+    fn drop(&mut self) {
+        // SAFETY: the frame is owned and not chained.
+        unsafe { sys::vlc_frame_Release(self.frame) };
+    }
+}
+
+///
+/// An owned chain of `vlc_frame_t`, linked through their `p_next` pointer.
+///
+/// Frames can be moved in and out of the chain without any allocation.
+///
+pub struct FrameChain {
+    head: Option<NonNull<sys::vlc_frame_t>>,
+    tail: Option<NonNull<sys::vlc_frame_t>>,
+}
+
+// SAFETY: see Frame.
+unsafe impl Send for FrameChain {}
+
+impl Default for FrameChain {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl FrameChain {
+    pub const fn new() -> FrameChain {
+        FrameChain {
+            head: None,
+            tail: None,
+        }
+    }
+
+    ///
+    /// Take ownership of a chain of frames coming from the C code.
+    ///
+    /// # Safety
+    ///
+    /// `chain` must be NULL or a valid chain of frames owned by the caller.
+    ///
+    pub unsafe fn from_raw(chain: *mut sys::vlc_frame_t) -> FrameChain {
+        let head = NonNull::new(chain);
+        let mut tail = head;
+        while let Some(frame) = tail {
+            match NonNull::new(unsafe { frame.as_ref() }.p_next) {
+                Some(next) => tail = Some(next),
+                None => break,
+            }
+        }
+        FrameChain { head, tail }
+    }
+
+    ///
+    /// Give the chain to the C code, which becomes in charge of releasing it.
+    ///
+    pub fn into_raw(self) -> *mut sys::vlc_frame_t {
+        let head = self.head;
+        std::mem::forget(self);
+        head.map_or(std::ptr::null_mut(), NonNull::as_ptr)
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.head.is_none()
+    }
+
+    pub fn push_back(&mut self, frame: Frame) {
+        let frame = frame.into_raw();
+        match self.tail {
+            // SAFETY: the tail is owned by the chain.
+            Some(mut tail) => unsafe { tail.as_mut() }.p_next = frame.as_ptr(),
+            None => self.head = Some(frame),
+        }
+        self.tail = Some(frame);
+    }
+
+    pub fn pop_front(&mut self) -> Option<Frame> {
+        let mut head = self.head?;
+        // SAFETY: the head is owned by the chain, and is unlinked from it
+        //         before being returned.
+        let next = unsafe { head.as_ref() }.p_next;
+        unsafe { head.as_mut() }.p_next = std::ptr::null_mut();
+        self.head = NonNull::new(next);
+        if self.head.is_none() {
+            self.tail = None;
+        }
+        Some(unsafe { Frame::from_raw(head) })
+    }
+
+    ///
+    /// Iterate over the payloads of the frames of the chain.
+    ///
+    pub fn iter(&self) -> FrameChainIter<'_> {
+        FrameChainIter {
+            current: self.head,
+            _chain: std::marker::PhantomData,
+        }
+    }
+
+    ///
+    /// Get the total size of the payloads of the chain.
+    ///
+    pub fn byte_len(&self) -> usize {
+        self.iter().map(<[u8]>::len).sum()
+    }
+
+    ///
+    /// Join frames split from the same frame back, without copying.
+    ///
+    /// The chain is returned as is if its frames are not adjacent parts of a
+    /// single frame.
+    ///
+    pub fn try_join(self) -> Result<Frame, FrameChain> {
+        let Some(head) = self.head else {
+            return Err(self);
+        };
+        // SAFETY: vlc_frame_TryJoin() leaves the chain untouched on failure,
+        //         and releases the rest of the chain on success.
+        match unsafe { sys::vlc_frame_TryJoin(head) } {
+            Some(frame) => {
+                std::mem::forget(self);
+                Ok(unsafe { Frame::from_raw(frame) })
+            }
+            None => Err(self),
+        }
+    }
+}
+
+impl Drop for FrameChain {
+    fn drop(&mut self) {
+        while self.pop_front().is_some() {}
+    }
+}
+
+impl Extend<Frame> for FrameChain {
+    fn extend<I: IntoIterator<Item = Frame>>(&mut self, iter: I) {
+        for frame in iter {
+            self.push_back(frame);
+        }
+    }
+}
+
+impl FromIterator<Frame> for FrameChain {
+    fn from_iter<I: IntoIterator<Item = Frame>>(iter: I) -> Self {
+        let mut chain = FrameChain::new();
+        chain.extend(iter);
+        chain
+    }
+}
+
+/// Iterate over the payloads of a [FrameChain].
+pub struct FrameChainIter<'a> {
+    current: Option<NonNull<sys::vlc_frame_t>>,
+    _chain: std::marker::PhantomData<&'a FrameChain>,
+}
+
+impl<'a> Iterator for FrameChainIter<'a> {
+    type Item = &'a [u8];
+
+    fn next(&mut self) -> Option<&'a [u8]> {
+        // SAFETY: the frames are owned by the borrowed chain.
+        let frame = unsafe { self.current?.as_ref() };
+        self.current = NonNull::new(frame.p_next);
+        if frame.i_buffer == 0 {
+            return Some(&[]);
+        }
+        Some(unsafe { std::slice::from_raw_parts(frame.p_buffer, frame.i_buffer) })
+    }
+}
+
+#[cfg(test)]
+mod test {
+    use crate::frame::{Frame, FrameChain};
+
+    #[test]
+    fn test_split_and_join() {
+        let mut frame = Frame::alloc(16).unwrap();
+        for (i, byte) in frame.as_mut_slice().unwrap().iter_mut().enumerate() {
+            *byte = i as u8;
+        }
+        frame.set_pts(Some(42));
+
+        let head = frame.split_to(4).unwrap();
+        assert_eq!(&head[..], &[0, 1, 2, 3]);
+        assert_eq!(frame.len(), 12);
+        assert_eq!(frame.pts(), Some(42));
+        assert_eq!(head.pts(), None);
+
+        let chain: FrameChain = [head, frame].into_iter().collect();
+        assert_eq!(chain.byte_len(), 16);
+        let joined = chain.try_join().ok().unwrap();
+        assert_eq!(joined.len(), 16);
+        assert_eq!(joined[15], 15);
+    }
+
+    #[test]
+    fn test_share() {
+        let mut frame = Frame::alloc(8).unwrap();
+        frame.as_mut_slice().unwrap().fill(7);
+
+        let view = frame.share().unwrap();
+        assert!(frame.as_mut_slice().is_none());
+        assert_eq!(&view[..], &frame[..]);
+
+        let mut copy = view.make_writable().unwrap();
+        copy.as_mut_slice().unwrap()[0] = 0;
+        assert_eq!(frame[0], 7);
+    }
+}
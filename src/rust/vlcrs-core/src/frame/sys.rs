@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: LGPL-2.1-or-later
+// Copyright (C) 2026 VLC authors and VideoLAN
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, write to the Free Software Foundation,
+// Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+
+#![allow(non_camel_case_types)]
+
+use std::{
+    ffi::{c_uint, c_void},
+    ptr::NonNull,
+};
+
+pub type vlc_tick = i64;
+
+#[repr(C)]
+pub struct vlc_ancillary_array {
+    pub cap: usize,
+    pub size: usize,
+    pub data: *mut *mut c_void,
+}
+
+#[repr(C)]
+pub struct vlc_frame_callbacks {
+    pub free: Option<unsafe extern "C" fn(*mut vlc_frame_t)>,
+}
+
+#[repr(C)]
+pub struct vlc_frame_t {
+    pub p_next: *mut vlc_frame_t,
+
+    pub p_buffer: *mut u8,
+    pub i_buffer: usize,
+    pub p_start: *mut u8,
+    pub i_size: usize,
+
+    pub i_flags: u32,
+    pub i_nb_samples: c_uint,
+
+    pub i_pts: vlc_tick,
+    pub i_dts: vlc_tick,
+    pub i_length: vlc_tick,
+
+    pub ancillaries: vlc_ancillary_array,
+
+    pub cbs: *const vlc_frame_callbacks,
+}
+
+extern "C" {
+    pub fn vlc_frame_Alloc(size: usize) -> Option<NonNull<vlc_frame_t>>;
+    pub fn vlc_frame_Release(frame: NonNull<vlc_frame_t>);
+    pub fn vlc_frame_Split(
+        pp: &mut NonNull<vlc_frame_t>,
+        length: usize,
+    ) -> Option<NonNull<vlc_frame_t>>;
+    pub fn vlc_frame_TryJoin(chain: NonNull<vlc_frame_t>) -> Option<NonNull<vlc_frame_t>>;
+    pub fn vlc_frame_Share(pp: &mut NonNull<vlc_frame_t>) -> Option<NonNull<vlc_frame_t>>;
+    pub fn vlc_frame_MakeWritable(frame: NonNull<vlc_frame_t>) -> Option<NonNull<vlc_frame_t>>;
+}
@@ -33,6 +33,8 @@ pub mod plugin;
 
 pub mod object;
 
+pub mod frame;
+
 pub mod tracer;
 
 pub(crate) mod convert;
@@ -86,11 +86,251 @@ static void test_block (void)
     //assert (block == NULL);
 }
 
+static void test_block_Split(void)
+{
+    block_t *block = block_Alloc(sizeof (text));
+    assert(block != NULL);
+
+    memcpy(block->p_buffer, text, sizeof (text));
+    block->i_flags = BLOCK_FLAG_DISCONTINUITY;
+
+    block_t *head = block_Split(&block, 4);
+    assert(head != NULL);
+    assert(head->i_buffer == 4);
+    assert(!memcmp(head->p_buffer, text, 4));
+    assert(head->i_flags == 0);
+    assert(block->i_buffer == sizeof (text) - 4);
+    assert(!memcmp(block->p_buffer, text + 4, block->i_buffer));
+    assert(block->i_flags == BLOCK_FLAG_DISCONTINUITY);
+
+    /* Splitting a part shares the same buffer */
+    block_t *middle = block_Split(&block, 8);
+    assert(middle != NULL);
+    assert(middle->p_buffer == head->p_buffer + 4);
+    assert(!memcmp(middle->p_buffer, text + 4, 8));
+
+    /* Parts cannot grow into each other */
+    head = block_Realloc(head, 0, 4 + 8);
+    assert(head != NULL);
+    assert(head->p_buffer != middle->p_buffer - 4);
+    memset(head->p_buffer, 'A', head->i_buffer);
+    assert(!memcmp(middle->p_buffer, text + 4, 8));
+
+    /* The buffer outlives the part it was split from */
+    block_Release(block);
+    block_Release(head);
+    assert(!memcmp(middle->p_buffer, text + 4, 8));
+
+    block_t *part = block_Split(&middle, 8);
+    assert(part != NULL);
+    assert(middle->i_buffer == 0);
+    block_Release(middle);
+    assert(!memcmp(part->p_buffer, text + 4, 8));
+    block_Release(part);
+}
+
+static void test_block_Share(void)
+{
+    block_t *block = block_Alloc(sizeof (text));
+    assert(block != NULL);
+
+    memcpy(block->p_buffer, text, sizeof (text));
+    block->i_pts = 42;
+    block->i_flags = BLOCK_FLAG_DISCONTINUITY;
+
+    block_t *view = block_Share(&block);
+    assert(view != NULL);
+    assert(view->p_buffer == block->p_buffer);
+    assert(view->i_buffer == sizeof (text));
+    assert(view->i_pts == 42);
+    assert(view->i_flags == BLOCK_FLAG_DISCONTINUITY);
+
+    block_t *other = block_Share(&view);
+    assert(other != NULL);
+    assert(other->p_buffer == block->p_buffer);
+
+    /* Views are copied before being written to */
+    view = block_MakeWritable(view);
+    assert(view != NULL);
+    assert(view->p_buffer != block->p_buffer);
+    assert(view->i_pts == 42);
+    memset(view->p_buffer, 'A', view->i_buffer);
+    assert(!memcmp(block->p_buffer, text, sizeof (text)));
+    block_Release(view);
+
+    /* Views cannot grow into the spare room of the original frame */
+    other = block_Realloc(other, 4, other->i_buffer);
+    assert(other != NULL);
+    assert(other->p_buffer + 4 != block->p_buffer);
+    memset(other->p_buffer, 'B', 4);
+    assert(!memcmp(block->p_buffer, text, sizeof (text)));
+    block_Release(other);
+
+    /* Emptied views are not recycled */
+    block_t *last = block_Share(&block);
+    assert(last != NULL);
+    last = block_Realloc(last, 0, 0);
+    assert(last != NULL);
+    last = block_Realloc(last, 0, 4);
+    assert(last != NULL);
+    memset(last->p_buffer, 'C', 4);
+    assert(!memcmp(block->p_buffer, text, sizeof (text)));
+    block_Release(last);
+
+    /* The buffer outlives the original frame */
+    view = block_Share(&block);
+    assert(view != NULL);
+    block_Release(block);
+    assert(!memcmp(view->p_buffer, text, sizeof (text)));
+
+    /* Plain frames are already writable */
+    block = block_Alloc(4);
+    assert(block != NULL);
+    assert(block_MakeWritable(block) == block);
+    block_Release(block);
+    block_Release(view);
+}
+
+static void test_block_TryJoin(void)
+{
+    block_t *block = block_Alloc(sizeof (text));
+    assert(block != NULL);
+
+    memcpy(block->p_buffer, text, sizeof (text));
+    block->i_dts = 42;
+
+    /* Only split parts can be joined */
+    block_t *other = block_Alloc(4);
+    assert(other != NULL);
+    block->p_next = other;
+    assert(block_TryJoin(block) == NULL);
+    block->p_next = NULL;
+
+    block_t *head = block_Split(&block, 4);
+    assert(head != NULL);
+    head->i_dts = 1;
+    block_t *middle = block_Split(&block, 8);
+    assert(middle != NULL);
+
+    /* Parts must follow each other */
+    head->p_next = block;
+    assert(block_TryJoin(head) == NULL);
+    other->p_next = middle;
+    head->p_next = other;
+    assert(block_TryJoin(head) == NULL);
+    other->p_next = NULL;
+    block_Release(other);
+
+    head->p_next = middle;
+    middle->p_next = block;
+    block_t *joined = block_ChainGather(head);
+    assert(joined == head);
+    assert(joined->p_next == NULL);
+    assert(joined->i_buffer == sizeof (text));
+    assert(joined->i_dts == 1);
+    assert(!memcmp(joined->p_buffer, text, sizeof (text)));
+
+    /* The joined part cannot grow in place over the buffer it came from */
+    joined = block_Realloc(joined, 0, sizeof (text) + 1);
+    assert(joined != NULL);
+    assert(!memcmp(joined->p_buffer, text, sizeof (text)));
+    block_Release(joined);
+}
+
+#define RING_FRAMES 10000
+
+static void *test_ring_producer(void *data)
+{
+    vlc_frame_ring_t *ring = data;
+
+    for (size_t i = 0; i < RING_FRAMES;)
+    {
+        vlc_frame_t *batch[7];
+        size_t count = 0;
+
+        while (count < ARRAY_SIZE(batch) && i + count < RING_FRAMES)
+        {
+            batch[count] = block_Alloc(sizeof (size_t));
+            assert(batch[count] != NULL);
+            memcpy(batch[count]->p_buffer, &(size_t){ i + count },
+                   sizeof (size_t));
+            count++;
+        }
+
+        size_t sent = 0;
+        while (sent < count)
+            sent += vlc_frame_ring_Enqueue(ring, batch + sent, count - sent);
+        i += count;
+    }
+    return NULL;
+}
+
+static void test_ring(void)
+{
+    vlc_frame_ring_t *ring = vlc_frame_ring_New(3);
+    assert(ring != NULL);
+
+    /* Capacity is rounded up to 4 */
+    vlc_frame_t *frames[5];
+    for (size_t i = 0; i < ARRAY_SIZE(frames); i++)
+    {
+        frames[i] = block_Alloc(i + 1);
+        assert(frames[i] != NULL);
+    }
+    assert(vlc_frame_ring_Enqueue(ring, frames, 5) == 4);
+    assert(vlc_frame_ring_GetCount(ring) == 4);
+    assert(vlc_frame_ring_GetBytes(ring) == 1 + 2 + 3 + 4);
+    block_Release(frames[4]);
+
+    vlc_frame_t *out[8];
+    assert(vlc_frame_ring_Dequeue(ring, out, 1) == 1);
+    assert(out[0] == frames[0]);
+    block_Release(out[0]);
+    assert(vlc_frame_ring_GetBytes(ring) == 2 + 3 + 4);
+    vlc_frame_ring_Delete(ring);
+
+    /* Concurrent batched hand-off */
+    vlc_thread_t th;
+
+    ring = vlc_frame_ring_New(16);
+    assert(ring != NULL);
+    assert(!vlc_clone(&th, test_ring_producer, ring));
+
+    for (size_t i = 0; i < RING_FRAMES;)
+    {
+        size_t count = vlc_frame_ring_Dequeue(ring, out, ARRAY_SIZE(out));
+
+        if (count == 0)
+        {
+            vlc_frame_ring_Wait(ring);
+            continue;
+        }
+
+        for (size_t j = 0; j < count; j++, i++)
+        {
+            size_t val;
+
+            memcpy(&val, out[j]->p_buffer, sizeof (val));
+            assert(val == i);
+            block_Release(out[j]);
+        }
+    }
+
+    vlc_join(th, NULL);
+    assert(vlc_frame_ring_GetCount(ring) == 0);
+    assert(vlc_frame_ring_GetBytes(ring) == 0);
+    vlc_frame_ring_Delete(ring);
+}
+
 int main (void)
 {
     test_block_File(false);
     test_block_File(true);
     test_block ();
+    test_block_Split ();
+    test_block_Share ();
+    test_block_TryJoin ();
+    test_ring ();
     return 0;
 }
 
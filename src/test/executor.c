@@ -271,6 +271,141 @@ static void test_task_chain(void)
         assert(array[i] == 2 * i);
 }
 
+struct order_data
+{
+    vlc_mutex_t lock;
+    vlc_cond_t cond;
+    bool blocked;
+    bool started;
+    int order[4];
+    int count;
+};
+
+struct order_task
+{
+    struct order_data *data;
+    int id;
+    struct vlc_runnable runnable;
+};
+
+static void RunOrder(void *userdata)
+{
+    struct order_task *task = userdata;
+    struct order_data *data = task->data;
+
+    vlc_mutex_lock(&data->lock);
+    data->started = true;
+    vlc_cond_broadcast(&data->cond);
+    while (data->blocked)
+        vlc_cond_wait(&data->cond, &data->lock);
+    data->order[data->count++] = task->id;
+    vlc_mutex_unlock(&data->lock);
+}
+
+static void test_priority(void)
+{
+    vlc_executor_t *executor = vlc_executor_New(1);
+    assert(executor);
+
+    struct order_data data;
+    vlc_mutex_init(&data.lock);
+    vlc_cond_init(&data.cond);
+    data.blocked = true;
+    data.started = false;
+    data.count = 0;
+
+    struct order_task tasks[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        tasks[i].data = &data;
+        tasks[i].id = i;
+        tasks[i].runnable.run = RunOrder;
+        tasks[i].runnable.userdata = &tasks[i];
+    }
+
+    /* The first task blocks the only thread while the others are queued */
+    vlc_executor_Submit(executor, &tasks[0].runnable);
+
+    vlc_mutex_lock(&data.lock);
+    while (!data.started)
+        vlc_cond_wait(&data.cond, &data.lock);
+    vlc_mutex_unlock(&data.lock);
+
+    vlc_executor_SubmitPriority(executor, &tasks[1].runnable,
+                                VLC_EXECUTOR_PRIORITY_LOW);
+    vlc_executor_SubmitPriority(executor, &tasks[2].runnable,
+                                VLC_EXECUTOR_PRIORITY_NORMAL);
+    vlc_executor_SubmitPriority(executor, &tasks[3].runnable,
+                                VLC_EXECUTOR_PRIORITY_HIGH);
+
+    vlc_mutex_lock(&data.lock);
+    data.blocked = false;
+    vlc_cond_broadcast(&data.cond);
+    vlc_mutex_unlock(&data.lock);
+
+    vlc_executor_WaitIdle(executor);
+
+    assert(data.count == 4);
+    assert(data.order[0] == 0);
+    assert(data.order[1] == 3);
+    assert(data.order[2] == 2);
+    assert(data.order[3] == 1);
+
+    struct vlc_executor_stats stats;
+    vlc_executor_GetStats(executor, &stats);
+    assert(stats.queued == 0);
+    assert(stats.running == 0);
+    assert(stats.started == 4);
+    assert(stats.canceled == 0);
+    assert(stats.max_queued >= 3);
+    assert(stats.max_wait <= stats.total_wait);
+
+    vlc_executor_Delete(executor);
+}
+
+static void test_shared(void)
+{
+    vlc_executor_t *first = vlc_executor_New(2);
+    assert(first);
+    vlc_executor_t *second = vlc_executor_NewShared(first, 1);
+    assert(second);
+
+    struct data data1, data2;
+    InitData(&data1);
+    InitData(&data2);
+
+    struct vlc_runnable runnables1[50], runnables2[50];
+    for (int i = 0; i < 50; ++i)
+    {
+        runnables1[i].run = RunIncrement;
+        runnables1[i].userdata = &data1;
+        vlc_executor_Submit(first, &runnables1[i]);
+
+        runnables2[i].run = RunIncrement;
+        runnables2[i].userdata = &data2;
+        vlc_executor_Submit(second, &runnables2[i]);
+    }
+
+    vlc_executor_WaitIdle(second);
+    assert(data2.ended == 50);
+
+    /* The threads must survive the deletion of the first executor */
+    vlc_executor_WaitIdle(first);
+    assert(data1.ended == 50);
+    vlc_executor_Delete(first);
+
+    for (int i = 0; i < 50; ++i)
+        vlc_executor_Submit(second, &runnables2[i]);
+    vlc_executor_WaitIdle(second);
+    assert(data2.ended == 100);
+
+    struct vlc_executor_stats stats;
+    vlc_executor_GetStats(second, &stats);
+    assert(stats.started == 100);
+
+    vlc_executor_Delete(second);
+}
+
 int main(void)
 {
     test_single_runnable();
@@ -278,5 +413,7 @@ int main(void)
     test_blocking_delete();
     test_cancel();
     test_task_chain();
+    test_priority();
+    test_shared();
     return 0;
 }
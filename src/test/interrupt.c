@@ -87,6 +87,8 @@ static void test_context_simple(vlc_interrupt_t *ctx)
     vlc_interrupt_raise(ctx);
     assert(vlc_poll_i11e(NULL, 0, 1000000000) == -1);
     assert(errno == EINTR);
+    /* The wake up is consumed with the interruption */
+    assert(vlc_poll_i11e(NULL, 0, 1) == 0);
 
     c = 12;
     assert(vlc_write_i11e(fds[0], &c, 1) == 1);
@@ -104,6 +106,13 @@ static void test_context_simple(vlc_interrupt_t *ctx)
     assert(vlc_recvfrom_i11e(fds[1], &c, 1, 0, NULL, 0) == -1);
     assert(errno == EINTR);
 
+    /* Pending interruptions win over available data */
+    assert(vlc_sendto_i11e(fds[0], &c, 1, 0, NULL, 0) == 1);
+    vlc_interrupt_raise(ctx);
+    assert(vlc_recvfrom_i11e(fds[1], &c, 1, 0, NULL, 0) == -1);
+    assert(errno == EINTR);
+    assert(vlc_recvfrom_i11e(fds[1], &c, 1, 0, NULL, 0) == 1);
+
     vlc_interrupt_raise(ctx);
     assert(vlc_accept_i11e(fds[1], NULL, NULL, true) < 0);
 
@@ -27,6 +27,7 @@
 #include <assert.h>
 
 #include <vlc_common.h>
+#include <vlc_threads.h>
 #include <vlc_es.h>
 #include <vlc_picture_pool.h>
 
@@ -87,6 +88,45 @@ static void test(bool zombie)
             picture_Release(pics[i]);
 }
 
+static void *test_wait_thread(void *data)
+{
+    picture_t **pics = data;
+
+    for (unsigned i = 0; i < PICTURES; i++)
+        picture_Release(pics[i]);
+    return NULL;
+}
+
+static void test_wait(void)
+{
+    picture_t *pics[PICTURES];
+    vlc_thread_t th;
+
+    pool = picture_pool_NewFromFormat(&fmt, PICTURES);
+    assert(pool != NULL);
+
+    for (unsigned round = 0; round < 100; round++) {
+        for (unsigned i = 0; i < PICTURES; i++) {
+            pics[i] = picture_pool_Get(pool);
+            assert(pics[i] != NULL);
+        }
+        assert(picture_pool_Get(pool) == NULL);
+
+        /* Pictures are returned from another thread while we wait */
+        assert(!vlc_clone(&th, test_wait_thread, pics));
+
+        for (unsigned i = 0; i < PICTURES; i++) {
+            picture_t *pic = picture_pool_Wait(pool);
+            assert(pic != NULL);
+            picture_Release(pic);
+        }
+
+        vlc_join(th, NULL);
+    }
+
+    picture_pool_Release(pool);
+}
+
 int main(void)
 {
     video_format_Init(&fmt, VLC_CODEC_I420);
@@ -99,6 +139,7 @@ int main(void)
 
     test(false);
     test(true);
+    test_wait();
 
     return 0;
 }
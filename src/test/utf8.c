@@ -122,6 +122,50 @@ static void test_strcasestr (const char *h, const char *n, ssize_t offset)
     }
 }
 
+static void test_ascii_span (void)
+{
+    char buf[80];
+
+    printf ("Checking ASCII spans...\n");
+
+    /* move the first non-ASCII byte across the vector and word boundaries */
+    for (size_t len = 0; len < sizeof (buf); len++)
+    {
+        memset (buf, 'a', len);
+        if (vlc_ascii_span (buf, len) != len)
+        {
+            printf (" ERROR: ASCII span of %zu bytes\n", len);
+            exit (20);
+        }
+
+        for (size_t pos = 0; pos < len; pos++)
+        {
+            buf[pos] = '\xE9';
+            if (vlc_ascii_span (buf, len) != pos)
+            {
+                printf (" ERROR: non-ASCII byte at %zu of %zu\n", pos, len);
+                exit (21);
+            }
+            buf[pos] = 'a';
+        }
+    }
+}
+
+static void test_charset (const char *charset, const char *in,
+                          const char *out)
+{
+    printf ("\"%s\" from %s should be \"%s\"...\n", in, charset,
+            (out != NULL) ? out : "(null)");
+
+    char *str = FromCharset (charset, in, strlen (in));
+    if ((str == NULL) != (out == NULL)
+     || (str != NULL && strcmp (str, out)))
+    {
+        printf (" ERROR: got \"%s\"\n", (str != NULL) ? str : "(null)");
+        exit (30);
+    }
+    free (str);
+}
 
 int main (void)
 {
@@ -192,5 +236,14 @@ int main (void)
     test_strcasestr ("Télé", "élé", 1);
     test_strcasestr ("Télé", "léé", -1);
 
+    test_ascii_span ();
+    /* with and without iconv */
+    test_charset ("ISO_8859-1", "T\xE9l\xE9vision", "Télévision");
+    test_charset ("ISO_8859-1", "Television", "Television");
+    test_charset ("ISO_6937", "Cost: $5", "Cost: $5");
+    test_charset ("UTF-8", "T\xC3\xA9l\xC3\xA9vision", "Télévision");
+    test_charset ("UTF-8", "T\xE9l\xE9vision", NULL);
+    test_charset ("ISO_8859-15", "\xA4", "\xE2\x82\xAC");
+
     return 0;
 }
@@ -44,6 +44,9 @@
 #endif
 #include <errno.h>
 #include <wctype.h>
+#ifdef __SSE2__
+# include <emmintrin.h>
+#endif
 
 /**
  * Formats an UTF-8 string as vfprintf(), then print it, with
@@ -177,6 +180,34 @@ ssize_t vlc_towc (const char *str, uint32_t *restrict pwc)
     return -1;
 }
 
+size_t vlc_ascii_span(const char *str, size_t length)
+{
+    size_t i = 0;
+
+#ifdef __SSE2__
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(str + i));
+        unsigned mask = _mm_movemask_epi8(v); /* the high bits */
+
+        if (mask != 0)
+            return i + ctz(mask);
+    }
+#endif
+    for (; i + sizeof (uint64_t) <= length; i += sizeof (uint64_t))
+    {
+        uint64_t word;
+
+        memcpy(&word, str + i, sizeof (word));
+        if (word & UINT64_C(0x8080808080808080))
+            break;
+    }
+
+    while (i < length && (unsigned char)str[i] < 0x80)
+        i++;
+    return i;
+}
+
 /**
  * Look for an UTF-8 string within another one in a case-insensitive fashion.
  * Beware that this is quite slow. Contrary to strcasestr(), this function
@@ -223,6 +254,87 @@ char *vlc_strcasestr (const char *haystack, const char *needle)
     return NULL;
 }
 
+/* Character sets that encode ASCII as is */
+static bool IsASCIICompatible(const char *charset)
+{
+    static const char prefixes[][12] = {
+        "ISO_8859-", "ISO-8859-", "ISO8859-", "LATIN", "CP125", "WINDOWS-125",
+        "ASCII", "US-ASCII", "UTF-8", "UTF8", "ISO_6937", "ISO6937",
+    };
+
+    for (size_t i = 0; i < ARRAY_SIZE(prefixes); i++)
+        if (strncasecmp(charset, prefixes[i], strlen(prefixes[i])) == 0)
+            return true;
+    return false;
+}
+
+static bool IsLatin1(const char *charset)
+{
+    return !strcasecmp(charset, "ISO_8859-1")
+        || !strcasecmp(charset, "ISO-8859-1")
+        || !strcasecmp(charset, "ISO8859-1")
+        || !strcasecmp(charset, "LATIN1");
+}
+
+/* ISO 8859-1 maps to the first 256 code points */
+static char *Latin1ToUTF8(const unsigned char *in, size_t length)
+{
+    char *out = malloc(2 * length + 1), *p = out;
+    if (unlikely(out == NULL))
+        return NULL;
+
+    for (size_t i = 0; i < length && in[i] != '\0'; i++)
+    {
+        if (in[i] < 0x80)
+            *(p++) = in[i];
+        else
+        {
+            *(p++) = 0xC0 | (in[i] >> 6);
+            *(p++) = 0x80 | (in[i] & 0x3F);
+        }
+    }
+    *p = '\0';
+    return out;
+}
+
+/**
+ * Converts the common cases without iconv: plain ASCII text, Latin-1 and
+ * UTF-8, which make up most of the subtitles and of the DVB EPG text.
+ *
+ * @retval false the conversion must be done by iconv
+ */
+static bool FromCharsetDirect(const char *charset, const char *in,
+                              size_t length, char **outp)
+{
+    if (!strcasecmp(charset, "UTF-8") || !strcasecmp(charset, "UTF8"))
+    {
+        /* like iconv, stop at the first nul */
+        char *out = strndup(in, length);
+        if (out != NULL && IsUTF8(out) == NULL)
+        {
+            free(out);
+            out = NULL;
+        }
+        *outp = out;
+        return true;
+    }
+
+    size_t ascii = vlc_ascii_span(in, length);
+
+    if (ascii == length && IsASCIICompatible(charset))
+    {
+        *outp = strndup(in, length);
+        return true;
+    }
+
+    if (IsLatin1(charset))
+    {
+        *outp = Latin1ToUTF8((const unsigned char *)in, length);
+        return true;
+    }
+    return false;
+}
+
 /**
  * Converts a string from the given character encoding to utf-8.
  *
@@ -231,6 +343,10 @@ char *vlc_strcasestr (const char *haystack, const char *needle)
  */
 char *FromCharset(const char *charset, const void *data, size_t data_size)
 {
+    char *direct;
+    if (FromCharsetDirect(charset, data, data_size, &direct))
+        return direct;
+
     vlc_iconv_t handle = vlc_iconv_open ("UTF-8", charset);
     if (handle == (vlc_iconv_t)(-1))
         return NULL;
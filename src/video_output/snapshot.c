@@ -47,8 +47,20 @@ struct vout_snapshot {
     bool        is_available;
     int         request_count;
     vlc_picture_chain_t pics;
+    struct vlc_list requests; /* asynchronous requests */
 };
 
+/* Moves the pending asynchronous requests to a local list */
+static void TakeRequests(vout_snapshot_t *snap, struct vlc_list *requests)
+{
+    if (vlc_list_is_empty(&snap->requests)) {
+        vlc_list_init(requests);
+        return;
+    }
+    vlc_list_replace(&snap->requests, requests);
+    vlc_list_init(&snap->requests);
+}
+
 vout_snapshot_t *vout_snapshot_New(void)
 {
     vout_snapshot_t *snap = malloc(sizeof (*snap));
@@ -61,6 +73,7 @@ vout_snapshot_t *vout_snapshot_New(void)
     snap->is_available = true;
     snap->request_count = 0;
     vlc_picture_chain_Init( &snap->pics );
+    vlc_list_init(&snap->requests);
     return snap;
 }
 
@@ -69,6 +82,7 @@ void vout_snapshot_Destroy(vout_snapshot_t *snap)
     if (snap == NULL)
         return;
 
+    assert(vlc_list_is_empty(&snap->requests));
     while ( !vlc_picture_chain_IsEmpty( &snap->pics ) ) {
         picture_t *picture = vlc_picture_chain_PopFront( &snap->pics );
         picture_Release(picture);
@@ -86,8 +100,15 @@ void vout_snapshot_End(vout_snapshot_t *snap)
 
     snap->is_available = false;
 
+    struct vlc_list requests;
+    TakeRequests(snap, &requests);
+
     vlc_cond_broadcast(&snap->wait);
     vlc_mutex_unlock(&snap->lock);
+
+    struct vout_snapshot_request *req;
+    vlc_list_foreach(req, &requests, node)
+        req->on_picture(req, NULL);
 }
 
 /* */
@@ -117,6 +138,19 @@ picture_t *vout_snapshot_Get(vout_snapshot_t *snap, vlc_tick_t timeout)
     return picture;
 }
 
+void vout_snapshot_Request(vout_snapshot_t *snap,
+                           struct vout_snapshot_request *req)
+{
+    vlc_mutex_lock(&snap->lock);
+    bool available = snap->is_available;
+    if (available)
+        vlc_list_append(&req->node, &snap->requests);
+    vlc_mutex_unlock(&snap->lock);
+
+    if (!available)
+        req->on_picture(req, NULL);
+}
+
 bool vout_snapshot_IsRequested(vout_snapshot_t *snap)
 {
     if (snap == NULL)
@@ -124,7 +158,8 @@ bool vout_snapshot_IsRequested(vout_snapshot_t *snap)
 
     bool has_request = false;
     if (!vlc_mutex_trylock(&snap->lock)) {
-        has_request = snap->request_count > 0;
+        has_request = snap->request_count > 0
+                   || !vlc_list_is_empty(&snap->requests);
         vlc_mutex_unlock(&snap->lock);
     }
     return has_request;
@@ -151,8 +186,21 @@ void vout_snapshot_Set(vout_snapshot_t *snap,
         vlc_picture_chain_Append( &snap->pics, dup );
         snap->request_count--;
     }
+
+    struct vlc_list requests;
+    TakeRequests(snap, &requests);
+
     vlc_cond_broadcast(&snap->wait);
     vlc_mutex_unlock(&snap->lock);
+
+    /* Only references are taken here: the encoding is left to the requests */
+    struct vout_snapshot_request *req;
+    vlc_list_foreach(req, &requests, node) {
+        picture_t *dup = picture_Clone(picture);
+        if (dup != NULL)
+            video_format_CopyCrop(&dup->format, fmt);
+        req->on_picture(req, dup);
+    }
 }
 /* */
 char *vout_snapshot_GetDirectory(void)
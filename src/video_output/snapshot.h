@@ -24,9 +24,25 @@
 #define LIBVLC_VOUT_INTERNAL_SNAPSHOT_H
 
 #include <vlc_picture.h>
+#include <vlc_list.h>
 
 typedef struct vout_snapshot vout_snapshot_t;
 
+/**
+ * Asynchronous snapshot request.
+ */
+struct vout_snapshot_request {
+    /**
+     * Called once, with a clone of the picture to snapshot, or NULL if the
+     * snapshots are no longer available. It is called with the vout
+     * rendering, it must not block.
+     */
+    void (*on_picture)(struct vout_snapshot_request *, picture_t *);
+
+    /* Private data of the vout_snapshot_t */
+    struct vlc_list node;
+};
+
 /* */
 vout_snapshot_t *vout_snapshot_New(void);
 void vout_snapshot_Destroy(vout_snapshot_t *);
@@ -36,6 +52,12 @@ void vout_snapshot_End(vout_snapshot_t *);
 /* */
 picture_t *vout_snapshot_Get(vout_snapshot_t *, vlc_tick_t timeout);
 
+/**
+ * Queues an asynchronous request, completed by the next call to
+ * vout_snapshot_Set() or by vout_snapshot_End().
+ */
+void vout_snapshot_Request(vout_snapshot_t *, struct vout_snapshot_request *);
+
 /**
  * It tells if they are pending snapshot request
  */
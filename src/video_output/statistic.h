@@ -23,6 +23,15 @@
 #ifndef LIBVLC_VOUT_STATISTIC_H
 # define LIBVLC_VOUT_STATISTIC_H
 # include <stdatomic.h>
+# include <vlc_input_item.h>
+
+/** Per-frame latency histograms: the n-th bucket counts the pictures that
+ * took less than 2^n ms, the last one all the others */
+struct vout_statistic_latency {
+    unsigned queue[INPUT_STATS_FRAME_LATENCY_BUCKETS]; /**< decoded to rendered */
+    unsigned render[INPUT_STATS_FRAME_LATENCY_BUCKETS]; /**< rendering time */
+    unsigned present[INPUT_STATS_FRAME_LATENCY_BUCKETS]; /**< displayed to vsync */
+};
 
 /* NOTE: Both statistics are atomic on their own, so one might be older than
  * the other one. Currently, only one of them is updated at a time, so this
@@ -31,6 +40,12 @@ typedef struct {
     atomic_uint displayed;
     atomic_uint lost;
     atomic_uint late;
+    atomic_uintmax_t render_time; /**< GPU time reported by the display */
+    atomic_uint queue[INPUT_STATS_FRAME_LATENCY_BUCKETS];
+    atomic_uint render[INPUT_STATS_FRAME_LATENCY_BUCKETS];
+    atomic_uint present[INPUT_STATS_FRAME_LATENCY_BUCKETS];
+    atomic_uintmax_t filter_time; /**< CPU time of the filter chains */
+    atomic_uintmax_t display_time; /**< CPU time of the display module */
 } vout_statistic_t;
 
 static inline void vout_statistic_Init(vout_statistic_t *stat)
@@ -38,6 +53,15 @@ static inline void vout_statistic_Init(vout_statistic_t *stat)
     atomic_init(&stat->displayed, 0);
     atomic_init(&stat->lost, 0);
     atomic_init(&stat->late, 0);
+    atomic_init(&stat->render_time, 0);
+    for (size_t i = 0; i < INPUT_STATS_FRAME_LATENCY_BUCKETS; i++)
+    {
+        atomic_init(&stat->queue[i], 0);
+        atomic_init(&stat->render[i], 0);
+        atomic_init(&stat->present[i], 0);
+    }
+    atomic_init(&stat->filter_time, 0);
+    atomic_init(&stat->display_time, 0);
 }
 
 static inline void vout_statistic_Clean(vout_statistic_t *stat)
@@ -48,12 +72,25 @@ static inline void vout_statistic_Clean(vout_statistic_t *stat)
 static inline void vout_statistic_GetReset(vout_statistic_t *stat,
                                            unsigned *restrict displayed,
                                            unsigned *restrict lost,
-                                           unsigned *restrict late)
+                                           unsigned *restrict late,
+                                           vlc_tick_t *restrict render_time,
+                                           struct vout_statistic_latency *restrict latency)
 {
     *displayed = atomic_exchange_explicit(&stat->displayed, 0,
                                           memory_order_relaxed);
     *lost = atomic_exchange_explicit(&stat->lost, 0, memory_order_relaxed);
     *late = atomic_exchange_explicit(&stat->late, 0, memory_order_relaxed);
+    *render_time = atomic_exchange_explicit(&stat->render_time, 0,
+                                            memory_order_relaxed);
+    for (size_t i = 0; i < INPUT_STATS_FRAME_LATENCY_BUCKETS; i++)
+    {
+        latency->queue[i] = atomic_exchange_explicit(&stat->queue[i], 0,
+                                                     memory_order_relaxed);
+        latency->render[i] = atomic_exchange_explicit(&stat->render[i], 0,
+                                                      memory_order_relaxed);
+        latency->present[i] = atomic_exchange_explicit(&stat->present[i], 0,
+                                                       memory_order_relaxed);
+    }
 }
 
 static inline void vout_statistic_AddDisplayed(vout_statistic_t *stat,
@@ -73,4 +110,70 @@ static inline void vout_statistic_AddLate(vout_statistic_t *stat, int late)
     atomic_fetch_add_explicit(&stat->late, late, memory_order_relaxed);
 }
 
+static inline void vout_statistic_AddRenderTime(vout_statistic_t *stat,
+                                                vlc_tick_t render_time)
+{
+    atomic_fetch_add_explicit(&stat->render_time, render_time,
+                              memory_order_relaxed);
+}
+
+static inline void vout_statistic_AddLatency(atomic_uint *histogram,
+                                             vlc_tick_t latency)
+{
+    size_t i = 0;
+    vlc_tick_t bound = VLC_TICK_FROM_MS(1);
+
+    while (i < INPUT_STATS_FRAME_LATENCY_BUCKETS - 1 && latency >= bound)
+    {
+        bound *= 2;
+        i++;
+    }
+    atomic_fetch_add_explicit(&histogram[i], 1, memory_order_relaxed);
+}
+
+/* Time between the decoder queuing the picture and its rendering */
+static inline void vout_statistic_AddQueueLatency(vout_statistic_t *stat,
+                                                  vlc_tick_t latency)
+{
+    vout_statistic_AddLatency(stat->queue, latency);
+}
+
+/* Time spent filtering, blending and preparing the picture */
+static inline void vout_statistic_AddRenderLatency(vout_statistic_t *stat,
+                                                   vlc_tick_t latency)
+{
+    vout_statistic_AddLatency(stat->render, latency);
+}
+
+static inline void vout_statistic_AddFilterTime(vout_statistic_t *stat,
+                                                vlc_tick_t cpu_time)
+{
+    atomic_fetch_add_explicit(&stat->filter_time, cpu_time,
+                              memory_order_relaxed);
+}
+
+static inline void vout_statistic_AddDisplayTime(vout_statistic_t *stat,
+                                                 vlc_tick_t cpu_time)
+{
+    atomic_fetch_add_explicit(&stat->display_time, cpu_time,
+                              memory_order_relaxed);
+}
+
+static inline void vout_statistic_GetResetCpuTime(vout_statistic_t *stat,
+                                                  vlc_tick_t *restrict filter,
+                                                  vlc_tick_t *restrict display)
+{
+    *filter = atomic_exchange_explicit(&stat->filter_time, 0,
+                                       memory_order_relaxed);
+    *display = atomic_exchange_explicit(&stat->display_time, 0,
+                                        memory_order_relaxed);
+}
+
+/* Time between the display of the picture and its scan out */
+static inline void vout_statistic_AddPresentLatency(vout_statistic_t *stat,
+                                                    vlc_tick_t latency)
+{
+    vout_statistic_AddLatency(stat->present, latency);
+}
+
 #endif
@@ -52,6 +52,7 @@
 #include <vlc_codec.h>
 #include <vlc_tracer.h>
 #include <vlc_atomic.h>
+#include <vlc_executor.h>
 
 #include "../libvlc.h"
 #include "vout_private.h"
@@ -61,6 +62,7 @@
 #include "video_window.h"
 #include "../misc/variables.h"
 #include "../misc/threads.h"
+#include "../misc/picture.h"
 #include "../clock/clock.h"
 #include "statistic.h"
 #include "chrono.h"
@@ -119,6 +121,7 @@ typedef struct vout_thread_sys_t
         bool        is_interlaced;
         picture_t   *decoded; // decoded picture before passed through chain_static
         picture_t   *current;
+        vlc_tick_t  queued;     /**< date the decoded picture was queued */
         video_projection_mode_t projection;
     } displayed;
 
@@ -164,6 +167,16 @@ typedef struct vout_thread_sys_t
         struct filter_chain_t *chain_interactive;
     } filter;
 
+    /* Display presentation feedback */
+    struct {
+        vlc_mutex_t lock;
+        bool        pacing;
+        vlc_tick_t  vblank;     /**< last reported scan out date */
+        vlc_tick_t  period;     /**< refresh period, 0 if unknown/variable */
+        vlc_tick_t  target;     /**< scan out date aimed at by the picture */
+        vlc_tick_t  displayed;  /**< display date of the picture */
+    } present;
+
     picture_fifo_t  *decoder_fifo;
     struct {
         vout_chrono_t static_filter;
@@ -272,11 +285,22 @@ static void vout_UpdateWindowSizeLocked(vout_thread_sys_t *vout)
 
 /* */
 void vout_GetResetStatistic(vout_thread_t *vout, unsigned *restrict displayed,
-                            unsigned *restrict lost, unsigned *restrict late)
+                            unsigned *restrict lost, unsigned *restrict late,
+                            vlc_tick_t *restrict render_time,
+                            struct vout_statistic_latency *restrict latency)
 {
     vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
     assert(!sys->dummy);
-    vout_statistic_GetReset( &sys->statistic, displayed, lost, late );
+    vout_statistic_GetReset( &sys->statistic, displayed, lost, late,
+                             render_time, latency );
+}
+
+void vout_GetResetCpuTime(vout_thread_t *vout, vlc_tick_t *restrict filter,
+                          vlc_tick_t *restrict display)
+{
+    vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
+    assert(!sys->dummy);
+    vout_statistic_GetResetCpuTime(&sys->statistic, filter, display);
 }
 
 bool vout_IsEmpty(vout_thread_t *vout)
@@ -404,6 +428,7 @@ void vout_PutPicture(vout_thread_t *vout, picture_t *picture)
     vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
     assert(!sys->dummy);
     assert( !picture_HasChainedPics( picture ) );
+    container_of(picture, picture_priv_t, picture)->queued = vlc_tick_now();
     picture_fifo_Push(sys->decoder_fifo, picture);
     vout_control_Wake(&sys->control);
 }
@@ -444,6 +469,84 @@ int vout_GetSnapshot(vout_thread_t *vout,
     return VLC_SUCCESS;
 }
 
+struct vout_snapshot_task {
+    struct vout_snapshot_request request;
+    struct vlc_runnable runnable;
+    vlc_executor_t *executor;
+    vout_thread_t *vout;
+    picture_t *picture;
+    vlc_fourcc_t codec;
+    int width;
+    int height;
+    vout_snapshot_cb cb;
+    void *opaque;
+};
+
+static void SnapshotEncode(void *userdata)
+{
+    struct vout_snapshot_task *task = userdata;
+    vout_thread_t *vout = task->vout;
+    block_t *image = NULL;
+    video_format_t fmt;
+
+    if (task->picture == NULL)
+        msg_Err(vout, "Failed to grab a snapshot");
+    else {
+        if (picture_Export(VLC_OBJECT(vout), &image, &fmt, task->picture,
+                           task->codec, task->width, task->height, false)) {
+            msg_Err(vout, "Failed to convert image for snapshot");
+            image = NULL;
+        }
+        picture_Release(task->picture);
+    }
+
+    task->cb(task->opaque, image, image != NULL ? &fmt : NULL);
+    vout_Release(vout);
+    free(task);
+}
+
+static void SnapshotReady(struct vout_snapshot_request *req,
+                          picture_t *picture)
+{
+    struct vout_snapshot_task *task =
+        container_of(req, struct vout_snapshot_task, request);
+
+    task->picture = picture;
+    vlc_executor_Submit(task->executor, &task->runnable);
+}
+
+int vout_RequestSnapshot(vout_thread_t *vout, const char *type,
+                         vout_snapshot_cb cb, void *opaque)
+{
+    vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
+    assert(!sys->dummy);
+
+    vlc_executor_t *executor =
+        libvlc_GetSnapshotExecutor(vlc_object_instance(vout));
+    if (unlikely(executor == NULL))
+        return VLC_ENOMEM;
+
+    struct vout_snapshot_task *task = malloc(sizeof (*task));
+    if (unlikely(task == NULL))
+        return VLC_ENOMEM;
+
+    task->codec = VLC_CODEC_PNG;
+    if (type && image_Type2Fourcc(type))
+        task->codec = image_Type2Fourcc(type);
+    task->width = var_InheritInteger(vout, "snapshot-width");
+    task->height = var_InheritInteger(vout, "snapshot-height");
+    task->cb = cb;
+    task->opaque = opaque;
+    task->executor = executor;
+    task->vout = vout_Hold(vout);
+    task->runnable.run = SnapshotEncode;
+    task->runnable.userdata = task;
+    task->request.on_picture = SnapshotReady;
+
+    vout_snapshot_Request(sys->snapshot, &task->request);
+    return VLC_SUCCESS;
+}
+
 /* vout_Control* are usable by anyone at anytime */
 void vout_ChangeFullscreen(vout_thread_t *vout, const char *id)
 {
@@ -1027,6 +1130,86 @@ static bool IsPictureLateToProcess(vout_thread_sys_t *vout, const video_format_t
     return false;
 }
 
+static void VoutResetPresent(vout_thread_sys_t *sys)
+{
+    vlc_mutex_lock(&sys->present.lock);
+    sys->present.vblank = VLC_TICK_INVALID;
+    sys->present.period = 0;
+    sys->present.target = VLC_TICK_INVALID;
+    sys->present.displayed = VLC_TICK_INVALID;
+    vlc_mutex_unlock(&sys->present.lock);
+}
+
+void vout_ReportPresented(vout_thread_t *vout, vlc_tick_t date,
+                          vlc_tick_t refresh_period)
+{
+    vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
+
+    vlc_mutex_lock(&sys->present.lock);
+    const vlc_tick_t target = sys->present.target;
+    const vlc_tick_t displayed = sys->present.displayed;
+    sys->present.vblank = date;
+    sys->present.period = refresh_period;
+    sys->present.target = VLC_TICK_INVALID;
+    sys->present.displayed = VLC_TICK_INVALID;
+    vlc_mutex_unlock(&sys->present.lock);
+
+    if (displayed != VLC_TICK_INVALID && date >= displayed)
+        vout_statistic_AddPresentLatency(&sys->statistic, date - displayed);
+
+    if (target == VLC_TICK_INVALID)
+        return;
+
+    /* A picture reaching the screen more than one refresh after its target
+     * missed its refresh: the previous picture was shown once more. */
+    const vlc_tick_t slack = refresh_period > 0 ? refresh_period
+                                                : VOUT_DISPLAY_LATE_THRESHOLD;
+    if (date - target > slack)
+    {
+        struct vlc_tracer *tracer = GetTracer(sys);
+        if (tracer != NULL)
+            vlc_tracer_TraceEvent(tracer, "RENDER", sys->str_id, "missed");
+        vout_statistic_AddLate(&sys->statistic, 1);
+    }
+}
+
+void vout_ReportRendered(vout_thread_t *vout, vlc_tick_t gpu_time)
+{
+    vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
+
+    vout_statistic_AddRenderTime(&sys->statistic, gpu_time);
+}
+
+/**
+ * Aligns the date to hand a picture to the display on the refresh cycle.
+ *
+ * The picture is aimed at the refresh closest to date and is submitted half
+ * a refresh before it. Without feedback, or with a variable refresh rate,
+ * the display takes the picture on time and date is returned unchanged.
+ */
+static vlc_tick_t VoutPaceDeadline(vout_thread_sys_t *sys, vlc_tick_t date,
+                                   vlc_tick_t *target)
+{
+    *target = date;
+    if (!sys->present.pacing)
+        return date;
+
+    vlc_mutex_lock(&sys->present.lock);
+    const vlc_tick_t vblank = sys->present.vblank;
+    const vlc_tick_t period = sys->present.period;
+    vlc_mutex_unlock(&sys->present.lock);
+
+    if (vblank == VLC_TICK_INVALID || period <= 0)
+        return date;
+
+    const vlc_tick_t offset = date - vblank + period / 2;
+    vlc_tick_t n = offset / period;
+    if (offset % period < 0)
+        n--; /* round towards minus infinity */
+    *target = vblank + n * period;
+    return *target - period / 2;
+}
+
 static inline vlc_tick_t GetRenderDelay(vout_thread_sys_t *sys)
 {
     return vout_chrono_GetHigh(&sys->chrono.render) + VOUT_MWAIT_TOLERANCE;
@@ -1062,20 +1245,22 @@ static picture_t *PreparePicture(vout_thread_sys_t *vout, bool reuse_decoded,
             decoded = picture_Hold(sys->displayed.decoded);
             if (decoded == NULL)
                 break;
+            sys->displayed.queued = VLC_TICK_INVALID;
         } else {
             decoded = picture_fifo_Pop(sys->decoder_fifo);
             if (decoded == NULL)
                 break;
+            sys->displayed.queued =
+                container_of(decoded, picture_priv_t, picture)->queued;
 
             if (!decoded->b_force)
             {
                 const vlc_tick_t system_now = vlc_tick_now();
                 uint32_t clock_id;
-                vlc_clock_Lock(sys->clock);
                 const vlc_tick_t system_pts =
-                    vlc_clock_ConvertToSystem(sys->clock, system_now,
-                                              decoded->date, sys->rate, &clock_id);
-                vlc_clock_Unlock(sys->clock);
+                    vlc_clock_ConvertToSystemUnlocked(sys->clock, system_now,
+                                                      decoded->date, sys->rate,
+                                                      &clock_id);
                 if (clock_id != sys->clock_id)
                 {
                     sys->clock_id = clock_id;
@@ -1128,7 +1313,10 @@ static picture_t *PreparePicture(vout_thread_sys_t *vout, bool reuse_decoded,
         sys->displayed.is_interlaced = !decoded->b_progressive;
 
         vout_chrono_Start(&sys->chrono.static_filter);
+        vlc_tick_t cpu_start = vlc_thread_cputime();
         picture = filter_chain_VideoFilter(sys->filter.chain_static, sys->displayed.decoded);
+        vout_statistic_AddFilterTime(&sys->statistic,
+                                     vlc_thread_cputime() - cpu_start);
         vout_chrono_Stop(&sys->chrono.static_filter);
     }
 
@@ -1248,11 +1436,9 @@ static int PrerenderPicture(vout_thread_sys_t *sys, picture_t *filtered,
         render_subtitle_date = system_now;
     else
     {
-        vlc_clock_Lock(sys->clock);
         render_subtitle_date = filtered->date <= VLC_TICK_0 ? system_now :
-            vlc_clock_ConvertToSystem(sys->clock, system_now, filtered->date,
-                                      sys->rate, NULL);
-        vlc_clock_Unlock(sys->clock);
+            vlc_clock_ConvertToSystemUnlocked(sys->clock, system_now,
+                                              filtered->date, sys->rate, NULL);
     }
 
     /*
@@ -1397,10 +1583,22 @@ static int PrerenderPicture(vout_thread_sys_t *sys, picture_t *filtered,
 static int RenderPicture(vout_thread_sys_t *sys, bool render_now)
 {
     vout_display_t *vd = sys->display;
+    const vlc_tick_t render_start = vlc_tick_now();
+
+    /* Redisplayed pictures only account for the rendering */
+    if (sys->displayed.queued != VLC_TICK_INVALID)
+    {
+        vout_statistic_AddQueueLatency(&sys->statistic,
+                                       render_start - sys->displayed.queued);
+        sys->displayed.queued = VLC_TICK_INVALID;
+    }
 
     vout_chrono_Start(&sys->chrono.render);
 
+    vlc_tick_t cpu_start = vlc_thread_cputime();
     picture_t *filtered = FilterPictureInteractive(sys);
+    vout_statistic_AddFilterTime(&sys->statistic,
+                                 vlc_thread_cputime() - cpu_start);
     if (!filtered)
         return VLC_EGENERIC;
 
@@ -1421,26 +1619,42 @@ static int RenderPicture(vout_thread_sys_t *sys, bool render_now)
     vlc_tick_t system_now = vlc_tick_now();
     const vlc_tick_t pts = todisplay->date;
     vlc_tick_t system_pts;
+    vlc_tick_t target = VLC_TICK_INVALID;
     if (render_now)
         system_pts = system_now;
     else
     {
-        vlc_clock_Lock(sys->clock);
         assert(!sys->displayed.current->b_force);
-        system_pts = vlc_clock_ConvertToSystem(sys->clock, system_now, pts,
-                                               sys->rate, NULL);
-        vlc_clock_Unlock(sys->clock);
+        system_pts = vlc_clock_ConvertToSystemUnlocked(sys->clock, system_now,
+                                                       pts, sys->rate, NULL);
     }
 
     const unsigned frame_rate = todisplay->format.i_frame_rate;
     const unsigned frame_rate_base = todisplay->format.i_frame_rate_base;
 
     if (vd->ops->prepare != NULL)
+    {
+        cpu_start = vlc_thread_cputime();
         vd->ops->prepare(vd, todisplay, subpic, system_pts);
+        vout_statistic_AddDisplayTime(&sys->statistic,
+                                      vlc_thread_cputime() - cpu_start);
+    }
 
     vout_chrono_Stop(&sys->chrono.render);
+    vout_statistic_AddRenderLatency(&sys->statistic,
+                                    vlc_tick_now() - render_start);
 
     struct vlc_tracer *tracer = GetTracer(sys);
+    if (tracer != NULL && system_pts != VLC_TICK_MAX)
+        vlc_tracer_TraceWithTs(tracer, system_now,
+                               VLC_TRACE("type", "RENDER"),
+                               VLC_TRACE("id", sys->str_id),
+                               VLC_TRACE("event", "prepare"),
+                               VLC_TRACE_TICK_NS("pts", pts),
+                               VLC_TRACE_TICK_NS("system_pts", system_pts),
+                               VLC_TRACE_TICK_NS("duration",
+                                                 vlc_tick_now() - system_now),
+                               VLC_TRACE_END);
     system_now = vlc_tick_now();
     if (!render_now)
     {
@@ -1470,15 +1684,16 @@ static int RenderPicture(vout_thread_sys_t *sys, bool render_now)
             {
                 vlc_tick_t deadline;
                 if (vlc_clock_IsPaused(sys->clock))
-                    deadline = max_deadline;
+                    deadline = target = max_deadline;
                 else
                 {
                     assert(!sys->displayed.current->b_force);
                     deadline = vlc_clock_ConvertToSystem(sys->clock,
                                                          vlc_tick_now(), pts,
                                                          sys->rate, NULL);
+                    deadline = VoutPaceDeadline(sys, deadline, &target);
                     if (deadline > max_deadline)
-                        deadline = max_deadline;
+                        deadline = target = max_deadline;
                 }
 
                 if (sys->clock_nowait)
@@ -1501,8 +1716,27 @@ static int RenderPicture(vout_thread_sys_t *sys, bool render_now)
         sys->displayed.date = system_now;
     }
 
+    /* Only pictures displayed on time are checked against the feedback */
+    vlc_mutex_lock(&sys->present.lock);
+    sys->present.target = target;
+    sys->present.displayed = vlc_tick_now();
+    vlc_mutex_unlock(&sys->present.lock);
+
     /* Display the direct buffer returned by vout_RenderPicture */
+    vlc_tick_t display_start = vlc_tick_now();
+    cpu_start = vlc_thread_cputime();
     vout_display_Display(vd, todisplay);
+    vout_statistic_AddDisplayTime(&sys->statistic,
+                                  vlc_thread_cputime() - cpu_start);
+    if (tracer != NULL)
+        vlc_tracer_TraceWithTs(tracer, display_start,
+                               VLC_TRACE("type", "RENDER"),
+                               VLC_TRACE("id", sys->str_id),
+                               VLC_TRACE("event", "display"),
+                               VLC_TRACE_TICK_NS("pts", pts),
+                               VLC_TRACE_TICK_NS("duration",
+                                                 vlc_tick_now() - display_start),
+                               VLC_TRACE_END);
     vlc_clock_Lock(sys->clock);
     vlc_tick_t drift = vlc_clock_UpdateVideo(sys->clock,
                                              vlc_tick_now(),
@@ -1594,11 +1828,10 @@ static bool UpdateCurrentPicture(vout_thread_sys_t *sys)
     }
 
     const vlc_tick_t system_now = vlc_tick_now();
-    vlc_clock_Lock(sys->clock);
     const vlc_tick_t system_swap_current =
-        vlc_clock_ConvertToSystem(sys->clock, system_now,
-                                  sys->displayed.current->date, sys->rate, NULL);
-    vlc_clock_Unlock(sys->clock);
+        vlc_clock_ConvertToSystemUnlocked(sys->clock, system_now,
+                                          sys->displayed.current->date,
+                                          sys->rate, NULL);
 
     vlc_tick_t system_prepare_current = system_swap_current - GetRenderDelay(sys);
     if (unlikely(system_prepare_current > system_now))
@@ -1621,6 +1854,20 @@ static bool UpdateCurrentPicture(vout_thread_sys_t *sys)
     return true;
 }
 
+/* Displays mixing frames render every refresh. If the refresh period is not
+ * known, they are fed as fast as possible and their swapchain blocks on the
+ * refreshes. */
+static vlc_tick_t GetRedisplayDelay(vout_thread_sys_t *sys)
+{
+    if (!sys->display->info.mixes_frames)
+        return VOUT_REDISPLAY_DELAY;
+
+    vlc_mutex_lock(&sys->present.lock);
+    vlc_tick_t period = sys->present.period;
+    vlc_mutex_unlock(&sys->present.lock);
+    return __MIN(period, VOUT_REDISPLAY_DELAY);
+}
+
 static vlc_tick_t DisplayPicture(vout_thread_sys_t *vout)
 {
     vout_thread_sys_t *sys = vout;
@@ -1651,8 +1898,9 @@ static vlc_tick_t DisplayPicture(vout_thread_sys_t *vout)
     }
     else if (likely(sys->displayed.date != VLC_TICK_INVALID))
     {
+        vlc_tick_t redisplay_delay = GetRedisplayDelay(sys);
         // next date we need to display again the current picture
-        vlc_tick_t date_refresh = sys->displayed.date + VOUT_REDISPLAY_DELAY - GetRenderDelay(sys);
+        vlc_tick_t date_refresh = sys->displayed.date + redisplay_delay - GetRenderDelay(sys);
         const vlc_tick_t system_now = vlc_tick_now();
         /* FIXME/XXX we must redisplay the last decoded picture (because
         * of potential vout updated, or filters update or SPU update)
@@ -1669,6 +1917,8 @@ static vlc_tick_t DisplayPicture(vout_thread_sys_t *vout)
             return __MIN(date_refresh, max_deadline);
         }
         RenderPicture(vout, true);
+        if (redisplay_delay < VOUT_REDISPLAY_DELAY)
+            return vlc_tick_now() + redisplay_delay - GetRenderDelay(sys);
     }
 
     // wait until the next deadline or a control
@@ -1870,6 +2120,7 @@ static int vout_Start(vout_thread_sys_t *vout, vlc_video_context *vctx, const vo
 
     /* Reinitialize chrono to ensure we re-compute any new render timing. */
     VoutResetChronoLocked(sys);
+    VoutResetPresent(sys);
 
     /* Setup the window size, protected by the display_lock */
     dcfg.display.width = sys->window_width;
@@ -1902,6 +2153,7 @@ static int vout_Start(vout_thread_sys_t *vout, vlc_video_context *vctx, const vo
 
     sys->displayed.current       = NULL;
     sys->displayed.decoded       = NULL;
+    sys->displayed.queued        = VLC_TICK_INVALID;
     sys->displayed.date          = VLC_TICK_INVALID;
     sys->displayed.timestamp     = VLC_TICK_INVALID;
     sys->displayed.is_interlaced = false;
@@ -2227,6 +2479,13 @@ vout_thread_t *vout_Create(vlc_object_t *object)
 
     sys->is_late_dropped = var_InheritBool(vout, "drop-late-frames");
 
+    vlc_mutex_init(&sys->present.lock);
+    sys->present.pacing = var_InheritBool(vout, "display-pacing");
+    sys->present.vblank = VLC_TICK_INVALID;
+    sys->present.period = 0;
+    sys->present.target = VLC_TICK_INVALID;
+    sys->present.displayed = VLC_TICK_INVALID;
+
     vlc_mutex_init(&sys->filter.lock);
 
     vlc_mutex_init(&sys->clock_lock);
@@ -181,6 +181,20 @@ void vout_ResetProjection(vout_thread_t *);
  */
 bool vout_FilterMouse(vout_thread_t *vout, vlc_mouse_t *mouse);
 
+/**
+ * Records the presentation feedback of the display.
+ *
+ * Called from any thread, once per displayed picture, with the system time
+ * the picture was scanned out and the refresh period (0 if unknown).
+ */
+void vout_ReportPresented(vout_thread_t *vout, vlc_tick_t date,
+                          vlc_tick_t refresh_period);
+
+/**
+ * Records the GPU render time of a displayed picture.
+ */
+void vout_ReportRendered(vout_thread_t *vout, vlc_tick_t gpu_time);
+
 /* */
 void vout_CreateVars( vout_thread_t * );
 void vout_IntfInit( vout_thread_t * );
@@ -230,11 +244,22 @@ void vout_ChangeSpuRate( vout_thread_t *, size_t channel_id, float rate );
 void vout_ChangeSpuDelay( vout_thread_t *, size_t channel_id, vlc_tick_t delay );
 
 
+struct vout_statistic_latency;
+
 /**
  * This function will return and reset internal statistics.
  */
 void vout_GetResetStatistic( vout_thread_t *p_vout, unsigned *pi_displayed,
-                             unsigned *pi_lost, unsigned *pi_late );
+                             unsigned *pi_lost, unsigned *pi_late,
+                             vlc_tick_t *pi_render_time,
+                             struct vout_statistic_latency *p_latency );
+
+/**
+ * This function will return and reset the CPU time spent in the filter
+ * chains and the display module.
+ */
+void vout_GetResetCpuTime( vout_thread_t *p_vout, vlc_tick_t *pi_filter,
+                           vlc_tick_t *pi_display );
 
 /**
  * This function will force to display the next picture while paused
@@ -84,6 +84,35 @@ struct subtitle_position_cache
 };
 typedef struct VLC_VECTOR(struct subtitle_position_cache) subtitles_positions_vector;
 
+/* Everything a rendered region depends on, zero-padded for memcmp() */
+struct spu_render_cache_key
+{
+    const subpicture_t *subpic;
+    const subpicture_region_t *region;
+    const picture_t *picture;
+    int64_t order;
+    int channel_order;
+    int subpic_alpha;
+    unsigned original_width, original_height;
+    int x, y, align, alpha;
+    int max_width, max_height;
+    unsigned width, height;
+    unsigned sar_num, sar_den;
+    bool subtitle, text, absolute, in_window;
+};
+typedef struct VLC_VECTOR(struct spu_render_cache_key) spu_render_keys_vector;
+
+/* Output the region set is rendered for */
+struct spu_render_cache_target
+{
+    video_format_t fmt_dst;
+    unsigned src_width, src_height;
+    vout_display_place_t video_position;
+    vlc_fourcc_t chroma_list[SPU_CHROMALIST_COUNT];
+    bool spu_in_full_window;
+    bool external_scale;
+};
+
 typedef struct spu_private_t spu_private_t;
 
 struct spu_private_t {
@@ -117,6 +146,15 @@ struct spu_private_t {
     int secondary_alignment;       /**< Force alignment for secondary subs */
     subtitles_positions_vector subs_pos;
 
+    /* Last rendered region set, reused while nothing changes */
+    struct
+    {
+        vlc_render_subpicture *output;
+        struct spu_render_cache_target target;
+        spu_render_keys_vector keys;
+        spu_render_keys_vector lookup;  /**< keys of the current set */
+    } render_cache;
+
     video_palette_t palette;              /**< force palette of subpicture */
 
     /* Subpiture filters */
@@ -762,28 +800,27 @@ static size_t spu_channel_UpdateDates(struct spu_channel *channel,
     if (!channel->clock)
         goto end;
 
-    vlc_clock_Lock(channel->clock);
     spu_render_entry_t *entry;
     vlc_vector_foreach_ref(entry, &channel->entries)
     {
         assert(entry);
 
-        entry->start = vlc_clock_ConvertToSystem(channel->clock, system_now,
-                                                 entry->orgstart, channel->rate,
-                                                 NULL);
+        entry->start = vlc_clock_ConvertToSystemUnlocked(channel->clock,
+                                                         system_now,
+                                                         entry->orgstart,
+                                                         channel->rate, NULL);
 
         if (entry->orgstop != VLC_TICK_INVALID)
         {
-            entry->stop = vlc_clock_ConvertToSystem(channel->clock,
-                                                    system_now,
-                                                    entry->orgstop,
-                                                    channel->rate,
-                                                    NULL);
+            entry->stop = vlc_clock_ConvertToSystemUnlocked(channel->clock,
+                                                            system_now,
+                                                            entry->orgstop,
+                                                            channel->rate,
+                                                            NULL);
         }
         else
             entry->stop = VLC_TICK_INVALID;
     }
-    vlc_clock_Unlock(channel->clock);
 
 end:
     return channel->entries.size;
@@ -1527,6 +1564,165 @@ static vlc_render_subpicture *SpuRenderSubpictures(spu_t *spu,
     return output;
 }
 
+static void SpuRenderCacheInvalidate(spu_private_t *sys)
+{
+    if (sys->render_cache.output != NULL)
+    {
+        vlc_render_subpicture_Delete(sys->render_cache.output);
+        sys->render_cache.output = NULL;
+    }
+}
+
+static void SpuRenderCacheTarget(struct spu_render_cache_target *target,
+                                 const vlc_fourcc_t *chroma_list,
+                                 const video_format_t *fmt_dst,
+                                 const video_format_t *fmt_src,
+                                 bool spu_in_full_window,
+                                 const vout_display_place_t *video_position,
+                                 bool external_scale)
+{
+    memset(target, 0, sizeof(*target));
+    target->fmt_dst.i_chroma         = fmt_dst->i_chroma;
+    target->fmt_dst.i_x_offset       = fmt_dst->i_x_offset;
+    target->fmt_dst.i_y_offset       = fmt_dst->i_y_offset;
+    target->fmt_dst.i_visible_width  = fmt_dst->i_visible_width;
+    target->fmt_dst.i_visible_height = fmt_dst->i_visible_height;
+    target->fmt_dst.i_sar_num        = fmt_dst->i_sar_num;
+    target->fmt_dst.i_sar_den        = fmt_dst->i_sar_den;
+    target->src_width  = fmt_src->i_visible_width;
+    target->src_height = fmt_src->i_visible_height;
+    target->video_position = *video_position;
+    for (size_t i = 0; i < SPU_CHROMALIST_COUNT && chroma_list[i]; i++)
+        target->chroma_list[i] = chroma_list[i];
+    target->spu_in_full_window = spu_in_full_window;
+    target->external_scale = external_scale;
+}
+
+/**
+ * Builds the keys of the regions of the sorted subpictures.
+ *
+ * \return false if the set can not be cached (fading subpictures)
+ */
+static bool SpuRenderCacheKeys(spu_render_keys_vector *keys,
+                               size_t i_subpicture,
+                               const spu_render_entry_t *p_entries)
+{
+    keys->size = 0; /* keep the allocation from frame to frame */
+
+    for (size_t i = 0; i < i_subpicture; i++) {
+        const subpicture_t *subpic = p_entries[i].subpic;
+        const subpicture_region_t *region;
+
+        if (subpic->b_fade)
+            return false;
+
+        vlc_spu_regions_foreach_const(region, &subpic->regions) {
+            struct spu_render_cache_key key;
+
+            memset(&key, 0, sizeof(key));
+            key.subpic          = subpic;
+            key.region          = region;
+            key.picture         = region->p_picture;
+            key.order           = subpic->i_order;
+            key.channel_order   = p_entries[i].channel_order;
+            key.subpic_alpha    = subpic->i_alpha;
+            key.original_width  = subpic->i_original_picture_width;
+            key.original_height = subpic->i_original_picture_height;
+            key.x               = region->i_x;
+            key.y               = region->i_y;
+            key.align           = region->i_align;
+            key.alpha           = region->i_alpha;
+            key.max_width       = region->i_max_width;
+            key.max_height      = region->i_max_height;
+            key.width           = region->fmt.i_visible_width;
+            key.height          = region->fmt.i_visible_height;
+            key.sar_num         = region->fmt.i_sar_num;
+            key.sar_den         = region->fmt.i_sar_den;
+            key.subtitle        = subpic->b_subtitle;
+            key.text            = subpicture_region_IsText(region);
+            key.absolute        = region->b_absolute;
+            key.in_window       = region->b_in_window;
+
+            if (!vlc_vector_push(keys, key))
+                return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Copies a render, sharing the pixels of its regions.
+ */
+static vlc_render_subpicture *SpuRenderDuplicate(const vlc_render_subpicture *render)
+{
+    vlc_render_subpicture *output = vlc_render_subpicture_New();
+    if (unlikely(output == NULL))
+        return NULL;
+    output->i_order = render->i_order;
+
+    const struct subpicture_region_rendered *region;
+    vlc_vector_foreach(region, &render->regions) {
+        struct subpicture_region_rendered *dst = malloc(sizeof(*dst));
+        if (unlikely(dst == NULL))
+            goto error;
+        *dst = *region;
+        dst->p_picture = picture_Clone(region->p_picture);
+        if (unlikely(dst->p_picture == NULL))
+        {
+            free(dst);
+            goto error;
+        }
+        if (!vlc_vector_push(&output->regions, dst))
+        {
+            picture_Release(dst->p_picture);
+            free(dst);
+            goto error;
+        }
+    }
+    return output;
+error:
+    vlc_render_subpicture_Delete(output);
+    return NULL;
+}
+
+/**
+ * Returns a copy of the cached render if it was made for the same region
+ * set and output.
+ */
+static vlc_render_subpicture *SpuRenderCacheGet(spu_private_t *sys,
+                                const struct spu_render_cache_target *target,
+                                const spu_render_keys_vector *keys)
+{
+    if (sys->render_cache.output == NULL
+     || memcmp(&sys->render_cache.target, target, sizeof(*target))
+     || sys->render_cache.keys.size != keys->size
+     || memcmp(sys->render_cache.keys.data, keys->data,
+               keys->size * sizeof(*keys->data)))
+        return NULL;
+
+    return SpuRenderDuplicate(sys->render_cache.output);
+}
+
+/**
+ * Keeps a copy of a render for the following calls.
+ */
+static void SpuRenderCachePut(spu_private_t *sys,
+                              const struct spu_render_cache_target *target,
+                              size_t i_subpicture,
+                              const spu_render_entry_t *p_entries,
+                              const vlc_render_subpicture *render)
+{
+    SpuRenderCacheInvalidate(sys);
+
+    /* Text regions were replaced by their rendering: key the new ones */
+    if (render == NULL
+     || !SpuRenderCacheKeys(&sys->render_cache.keys, i_subpicture, p_entries))
+        return;
+
+    sys->render_cache.target = *target;
+    sys->render_cache.output = SpuRenderDuplicate(render);
+}
+
 /*****************************************************************************
  * Object variables callbacks
  *****************************************************************************/
@@ -1540,6 +1736,7 @@ static void SetHighlights(spu_t *spu, const vlc_spu_highlight_t *hl)
 
     vlc_mutex_assert(&sys->lock);
 
+    SpuRenderCacheInvalidate(sys);
     sys->palette.i_entries = 0;
     sys->crop_highlight = false;
 
@@ -1862,6 +2059,10 @@ static void spu_Cleanup(spu_t *spu)
 
     vlc_vector_destroy(&sys->subs_pos);
 
+    SpuRenderCacheInvalidate(sys);
+    vlc_vector_destroy(&sys->render_cache.keys);
+    vlc_vector_destroy(&sys->render_cache.lookup);
+
     vlc_vector_destroy(&sys->channels);
 
     vlc_vector_clear(&sys->prerender.vector);
@@ -1928,6 +2129,9 @@ spu_t *spu_Create(vlc_object_t *object, vout_thread_t *vout)
     sys->secondary_alignment = var_InheritInteger(spu,
                                                   "secondary-sub-alignment");
     vlc_vector_init(&sys->subs_pos);
+    sys->render_cache.output = NULL;
+    vlc_vector_init(&sys->render_cache.keys);
+    vlc_vector_init(&sys->render_cache.lookup);
 
     sys->source_chain_update = NULL;
     sys->filter_chain_update = NULL;
@@ -2145,19 +2349,16 @@ void spu_PutSubpicture(spu_t *spu, subpicture_t *subpic)
     {
         vlc_tick_t system_now = vlc_tick_now();
 
-        vlc_clock_Lock(channel->clock);
         subpic->i_start =
-            vlc_clock_ConvertToSystem(channel->clock, system_now,
-                                      orgstart, channel->rate, NULL);
+            vlc_clock_ConvertToSystemUnlocked(channel->clock, system_now,
+                                              orgstart, channel->rate, NULL);
         if (orgstop != VLC_TICK_INVALID)
         {
             subpic->i_stop =
-                vlc_clock_ConvertToSystem(channel->clock, system_now,
-                                      orgstop, channel->rate, NULL);
+                vlc_clock_ConvertToSystemUnlocked(channel->clock, system_now,
+                                                  orgstop, channel->rate, NULL);
         }
 
-        vlc_clock_Unlock(channel->clock);
-
         spu_channel_EarlyRemoveLate(sys, channel, system_now);
 
         /* Maybe the new one is also already expired */
@@ -2332,17 +2533,32 @@ vlc_render_subpicture *spu_Render(spu_t *spu,
      * XXX The order is *really* important for overlap subtitles positioning */
     qsort(subpicture_array, subpicture_count, sizeof(*subpicture_array), SpuRenderCmp);
 
+    /* Reuse the previous rendering if nothing changed */
+    struct spu_render_cache_target target;
+    SpuRenderCacheTarget(&target, chroma_list, fmt_dst, fmt_src,
+                         spu_in_full_window, video_position, external_scale);
+
+    vlc_render_subpicture *render = NULL;
+    if (SpuRenderCacheKeys(&sys->render_cache.lookup,
+                           subpicture_count, subpicture_array))
+        render = SpuRenderCacheGet(sys, &target, &sys->render_cache.lookup);
+
     /* Render the subpictures */
-    vlc_render_subpicture *render = SpuRenderSubpictures(spu,
-                                                subpicture_count, subpicture_array,
-                                                chroma_list,
-                                                fmt_dst,
-                                                fmt_src,
-                                                spu_in_full_window,
-                                                video_position,
-                                                system_now,
-                                                render_subtitle_date,
-                                                external_scale);
+    if (render == NULL)
+    {
+        render = SpuRenderSubpictures(spu,
+                                      subpicture_count, subpicture_array,
+                                      chroma_list,
+                                      fmt_dst,
+                                      fmt_src,
+                                      spu_in_full_window,
+                                      video_position,
+                                      system_now,
+                                      render_subtitle_date,
+                                      external_scale);
+        SpuRenderCachePut(sys, &target, subpicture_count, subpicture_array,
+                          render);
+    }
     free(subpicture_array);
     vlc_mutex_unlock(&sys->lock);
 
@@ -2464,6 +2680,7 @@ void spu_ChangeChannelOrderMargin(spu_t *spu, enum vlc_vout_order order,
         default:
             vlc_assert_unreachable();
     }
+    SpuRenderCacheInvalidate(sys);
     vlc_mutex_unlock(&sys->lock);
 }
 
@@ -49,6 +49,16 @@ static void VoutViewpointMoved(void *sys, const vlc_viewpoint_t *vp)
     var_SetAddress(vout, "viewpoint-moved", (void*)vp);
 }
 
+static void VoutPresented(void *sys, vlc_tick_t date, vlc_tick_t period)
+{
+    vout_ReportPresented(sys, date, period);
+}
+
+static void VoutRendered(void *sys, vlc_tick_t gpu_time)
+{
+    vout_ReportRendered(sys, gpu_time);
+}
+
 /*****************************************************************************
  *
  *****************************************************************************/
@@ -58,7 +68,9 @@ vout_display_t *vout_OpenWrapper(vout_thread_t *vout,
 {
     vout_display_t *vd;
     vout_display_owner_t owner = {
-        .viewpoint_moved = VoutViewpointMoved, .sys = vout,
+        .viewpoint_moved = VoutViewpointMoved, .presented = VoutPresented,
+        .rendered = VoutRendered,
+        .sys = vout,
     };
     const char *modlist;
     char *modlistbuf = NULL;
@@ -0,0 +1,117 @@
+/*****************************************************************************
+ * ts_index.c: MPEG TS seek index tests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <vlc_common.h>
+#include <vlc_fs.h>
+
+#include "../../../modules/demux/mpeg/ts_index.h"
+
+#include "../../libvlc/test.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define ASSERT(a) do {\
+    if(!(a)) { \
+        fprintf(stderr, "failed line %d\n", __LINE__); \
+        goto error; } \
+    } while(0)
+
+int main(void)
+{
+    ts_index_t index, loaded;
+    vlc_tick_t found;
+    uint64_t low, high;
+    int ret = 1;
+
+    char source[] = "/tmp/vlc-test-ts-index-XXXXXX";
+    int fd = vlc_mkstemp(source);
+    if(fd == -1)
+        return 77;
+    if(write(fd, "data", 4) != 4)
+    {
+        close(fd);
+        unlink(source);
+        return 77;
+    }
+    close(fd);
+
+    test_init();
+
+    ts_index_Init(&index);
+    ts_index_Init(&loaded);
+
+    ASSERT(!ts_index_Lookup(&index, 1, VLC_TICK_FROM_SEC(1), &found, &low, &high));
+
+    /* Out of order insertion, as done by seek probing */
+    for(int i=10; i>=0; i-=2)
+        ts_index_Add(&index, 1, VLC_TICK_FROM_SEC(i), i * 1000);
+    for(int i=1; i<10; i+=2)
+        ts_index_Add(&index, 1, VLC_TICK_FROM_SEC(i), i * 1000);
+    ASSERT(index.i_count == 11);
+    ASSERT(index.b_dirty);
+
+    /* Other programs, too close entries and mismatching order are rejected */
+    ts_index_Add(&index, 2, VLC_TICK_FROM_SEC(20), 20000);
+    ts_index_Add(&index, 1, VLC_TICK_FROM_SEC(3) + 1, 3100);
+    ts_index_Add(&index, 1, VLC_TICK_FROM_SEC(12), 500);
+    ts_index_Add(&index, 1, -1, 0);
+    ASSERT(index.i_count == 11);
+
+    ASSERT(ts_index_Lookup(&index, 1, VLC_TICK_FROM_MS(4500), &found, &low, &high));
+    ASSERT(found == VLC_TICK_FROM_SEC(4) && low == 4000 && high == 5000);
+    ASSERT(ts_index_Lookup(&index, 1, VLC_TICK_FROM_SEC(0), &found, &low, &high));
+    ASSERT(found == 0 && low == 0 && high == 1000);
+    ASSERT(ts_index_Lookup(&index, 1, VLC_TICK_FROM_SEC(60), &found, &low, &high));
+    ASSERT(found == VLC_TICK_FROM_SEC(10) && low == 10000 && high == UINT64_MAX);
+    ASSERT(!ts_index_Lookup(&index, 2, VLC_TICK_FROM_SEC(1), &found, &low, &high));
+
+    /* Persistence */
+    char file[sizeof(source) + 6];
+    snprintf(file, sizeof(file), "%s.index", source);
+    ASSERT(ts_index_Save(&index, file, source) == VLC_SUCCESS);
+    ASSERT(ts_index_Load(&loaded, file, source) == VLC_SUCCESS);
+    ASSERT(!loaded.b_dirty);
+    ASSERT(loaded.i_program == 1 && loaded.i_count == index.i_count);
+    ASSERT(ts_index_Lookup(&loaded, 1, VLC_TICK_FROM_MS(7200), &found, &low, &high));
+    ASSERT(found == VLC_TICK_FROM_SEC(7) && low == 7000 && high == 8000);
+    ts_index_Clean(&loaded);
+
+    /* A modified source invalidates the index */
+    FILE *f = vlc_fopen(source, "ab");
+    ASSERT(f);
+    fputs("more", f);
+    fclose(f);
+    ASSERT(ts_index_Load(&loaded, file, source) != VLC_SUCCESS);
+    ASSERT(loaded.i_count == 0);
+
+    ret = 0;
+error:
+    ts_index_Clean(&index);
+    ts_index_Clean(&loaded);
+    unlink(source);
+    snprintf(file, sizeof(file), "%s.index", source);
+    unlink(file);
+    return ret;
+}
@@ -0,0 +1,153 @@
+/*****************************************************************************
+ * ts_sync.c: MPEG TS packet sync tests and benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <vlc_common.h>
+#include <vlc_tick.h>
+
+#include "../../../modules/demux/mpeg/ts_sync.h"
+
+#include "../../libvlc/test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define ASSERT(a) do {\
+    if(!(a)) { \
+        fprintf(stderr, "failed line %d\n", __LINE__); \
+        return 1; } \
+    } while(0)
+
+#define BENCH_PACKETS (64 * 1024)
+#define BENCH_LOOPS   16
+
+static void Fill(uint8_t *p, size_t i_packets,
+                 unsigned i_packet_size, unsigned i_header_size)
+{
+    for(size_t i=0; i<i_packets; i++)
+    {
+        uint8_t *pkt = &p[i * i_packet_size];
+        memset(pkt, 0x00, i_packet_size);
+        pkt[i_header_size] = TS_SYNC_BYTE;
+        pkt[i_header_size + 1] = (i >> 8) & 0x1F;
+        pkt[i_header_size + 2] = i & 0xFF;
+    }
+}
+
+/* Reference byte by byte scan, as done before */
+static size_t CountBytewise(const uint8_t *p, size_t i_buf,
+                            unsigned i_packet_size, unsigned i_header_size)
+{
+    size_t i_count = 0;
+    while((i_count + 1) * i_packet_size <= i_buf &&
+          p[i_count * i_packet_size + i_header_size] == TS_SYNC_BYTE)
+        i_count++;
+    return i_count;
+}
+
+static int TestSize(unsigned i_packet_size, unsigned i_header_size)
+{
+    const size_t i_packets = 100;
+    uint8_t *p = malloc(i_packets * i_packet_size + 7);
+    ASSERT(p);
+    Fill(p, i_packets, i_packet_size, i_header_size);
+
+    const size_t i_buf = i_packets * i_packet_size;
+    ASSERT(ts_sync_Count(p, i_buf, i_packet_size, i_header_size) == i_packets);
+    ASSERT(ts_sync_Count(p, i_packet_size - 1, i_packet_size, i_header_size) == 0);
+    for(size_t i=0; i<i_packets; i+=13)
+    {
+        p[i * i_packet_size + i_header_size] = 0x00;
+        ASSERT(ts_sync_Count(p, i_buf, i_packet_size, i_header_size) == i);
+        ASSERT(CountBytewise(p, i_buf, i_packet_size, i_header_size) == i);
+        p[i * i_packet_size + i_header_size] = TS_SYNC_BYTE;
+    }
+
+    size_t i_skip;
+    ASSERT(ts_sync_Find(p, i_buf, i_packet_size, i_header_size, &i_skip));
+    ASSERT(i_skip == 0);
+
+    /* A lone sync byte in garbage must not be taken as a packet start */
+    memmove(&p[7], p, i_buf);
+    memset(p, 0x00, 7);
+    p[2] = TS_SYNC_BYTE;
+    ASSERT(ts_sync_Find(p, i_buf + 7, i_packet_size, i_header_size, &i_skip));
+    ASSERT(i_skip == 7);
+
+    /* No sync at all: everything that can't hold a next sync byte is dropped */
+    memset(p, 0x00, i_buf);
+    ASSERT(!ts_sync_Find(p, i_buf, i_packet_size, i_header_size, &i_skip));
+    ASSERT(i_skip == i_buf - i_packet_size - i_header_size);
+    ASSERT(!ts_sync_Find(p, i_packet_size, i_packet_size, i_header_size, &i_skip));
+    ASSERT(i_skip == 0);
+
+    free(p);
+    return 0;
+}
+
+static int Bench(void)
+{
+    const size_t i_buf = BENCH_PACKETS * 188;
+    uint8_t *p = malloc(i_buf);
+    ASSERT(p);
+    Fill(p, BENCH_PACKETS, 188, 0);
+
+    vlc_tick_t t0 = vlc_tick_now();
+    for(int i=0; i<BENCH_LOOPS; i++)
+        ASSERT(CountBytewise(p, i_buf, 188, 0) == BENCH_PACKETS);
+    vlc_tick_t t1 = vlc_tick_now();
+    for(int i=0; i<BENCH_LOOPS; i++)
+        ASSERT(ts_sync_Count(p, i_buf, 188, 0) == BENCH_PACKETS);
+    vlc_tick_t t2 = vlc_tick_now();
+
+    /* Garbage scan: one candidate sync byte every 97 bytes */
+    memset(p, 0x00, i_buf);
+    for(size_t i=0; i<i_buf; i+=97)
+        p[i] = TS_SYNC_BYTE;
+    size_t i_skip;
+    vlc_tick_t t3 = vlc_tick_now();
+    for(int i=0; i<BENCH_LOOPS; i++)
+        ASSERT(!ts_sync_Find(p, i_buf, 188, 0, &i_skip));
+    vlc_tick_t t4 = vlc_tick_now();
+
+    const double mb = (double) i_buf * BENCH_LOOPS / (1024 * 1024);
+    fprintf(stderr, "sync check bytewise: %.0f MiB/s\n",
+            mb / secf_from_vlc_tick(__MAX(t1 - t0, 1)));
+    fprintf(stderr, "sync check batched:  %.0f MiB/s\n",
+            mb / secf_from_vlc_tick(__MAX(t2 - t1, 1)));
+    fprintf(stderr, "resync scan:         %.0f MiB/s\n",
+            mb / secf_from_vlc_tick(__MAX(t4 - t3, 1)));
+
+    free(p);
+    return 0;
+}
+
+int main(void)
+{
+    test_init();
+
+    ASSERT(TestSize(188, 0) == 0);
+    ASSERT(TestSize(192, 4) == 0);
+    ASSERT(TestSize(204, 0) == 0);
+
+    return Bench();
+}
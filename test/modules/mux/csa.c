@@ -0,0 +1,167 @@
+/*****************************************************************************
+ * csa.c: DVB-CSA scrambling tests and benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <vlc_common.h>
+#include <vlc_tick.h>
+
+#include "../../../modules/mux/mpeg/csa.h"
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define ASSERT(a) do {\
+    if(!(a)) { \
+        fprintf(stderr, "failed line %d\n", __LINE__); \
+        return 1; } \
+    } while(0)
+
+#define PACKETS       1000
+#define BENCH_PACKETS (16 * 1024)
+#define BENCH_LOOPS   8
+
+static void Fill(uint8_t *p, size_t i_packets)
+{
+    for(size_t i=0; i<i_packets; i++)
+    {
+        uint8_t *pkt = &p[i * 188];
+        pkt[0] = 0x47;
+        pkt[1] = 0x01;
+        pkt[2] = 0x00;
+        pkt[3] = 0x10 | (i & 0x0F);
+        for(size_t j=4; j<188; j++)
+            pkt[j] = (i * 31 + j) & 0xFF;
+        /* Some adaptation fields, down to leaving less than a block */
+        if(i % 7 == 0)
+        {
+            pkt[3] |= 0x20;
+            pkt[4] = (i / 7) % 184;
+        }
+    }
+}
+
+static int Test(csa_t *csa, int i_pkt_size)
+{
+    uint8_t *ref = malloc(PACKETS * 188);
+    uint8_t *p = malloc(PACKETS * 188);
+    uint8_t **pp = malloc(PACKETS * sizeof(*pp));
+    ASSERT(ref && p && pp);
+    Fill(ref, PACKETS);
+    Fill(p, PACKETS);
+
+    for(size_t i=0; i<PACKETS; i++)
+    {
+        csa_Encrypt(csa, &ref[i * 188], i_pkt_size);
+        pp[i] = &p[i * 188];
+    }
+    /* Odd counts leave a partial batch */
+    csa_EncryptBatch(csa, pp, 1, i_pkt_size);
+    csa_EncryptBatch(csa, &pp[1], PACKETS - 1, i_pkt_size);
+    ASSERT(!memcmp(ref, p, PACKETS * 188));
+
+    Fill(ref, PACKETS);
+    for(size_t i=0; i<PACKETS; i++)
+        csa_Decrypt(csa, &p[i * 188], i_pkt_size);
+    ASSERT(!memcmp(ref, p, PACKETS * 188));
+
+    free(pp);
+    free(p);
+    free(ref);
+    return 0;
+}
+
+static int Bench(csa_t *csa)
+{
+    uint8_t *p = malloc(BENCH_PACKETS * 188);
+    uint8_t **pp = malloc(BENCH_PACKETS * sizeof(*pp));
+    ASSERT(p && pp);
+    Fill(p, BENCH_PACKETS);
+    for(size_t i=0; i<BENCH_PACKETS; i++)
+        pp[i] = &p[i * 188];
+
+    vlc_tick_t t0 = vlc_tick_now();
+    for(int i=0; i<BENCH_LOOPS; i++)
+    {
+        for(size_t j=0; j<BENCH_PACKETS; j++)
+        {
+            csa_Encrypt(csa, pp[j], 188);
+            pp[j][3] &= 0x3f; /* scramble again on the next loop */
+        }
+    }
+    vlc_tick_t t1 = vlc_tick_now();
+    for(int i=0; i<BENCH_LOOPS; i++)
+    {
+        csa_EncryptBatch(csa, pp, BENCH_PACKETS, 188);
+        for(size_t j=0; j<BENCH_PACKETS; j++)
+            pp[j][3] &= 0x3f;
+    }
+    vlc_tick_t t2 = vlc_tick_now();
+
+    const double pkts = (double) BENCH_PACKETS * BENCH_LOOPS;
+    fprintf(stderr, "csa per packet: %.0f packets/s\n",
+            pkts / secf_from_vlc_tick(__MAX(t1 - t0, 1)));
+    fprintf(stderr, "csa bitsliced:  %.0f packets/s\n",
+            pkts / secf_from_vlc_tick(__MAX(t2 - t1, 1)));
+
+    free(pp);
+    free(p);
+    return 0;
+}
+
+int main(void)
+{
+#ifndef HAVE_DVBCSA
+    return 77;
+#else
+    test_init();
+
+    const char *const args[] = {
+        "-vvv",
+    };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    ASSERT(vlc);
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    csa_t *csa = csa_New();
+    ASSERT(csa);
+    char ck[] = "0x0123456789abcdef";
+    char ck2[] = "fedcba9876543210";
+    ASSERT(csa_SetCW(obj, csa, ck, true) == VLC_SUCCESS);
+    ASSERT(csa_SetCW(obj, csa, ck2, false) == VLC_SUCCESS);
+
+    csa_UseKey(obj, csa, true);
+    ASSERT(Test(csa, 188) == 0);
+    csa_UseKey(obj, csa, false);
+    ASSERT(Test(csa, 188) == 0);
+    ASSERT(Test(csa, 100) == 0);
+
+    int ret = Bench(csa);
+
+    csa_Delete(csa);
+    libvlc_release(vlc);
+    return ret;
+#endif
+}
@@ -0,0 +1,112 @@
+/*****************************************************************************
+ * ts_cbr.c: MPEG TS constant mux rate tests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <vlc_common.h>
+#include <vlc_tick.h>
+
+#include "../../../modules/mux/mpeg/cbr.h"
+
+#include "../../libvlc/test.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#define ASSERT(a) do {\
+    if(!(a)) { \
+        fprintf(stderr, "failed line %d\n", __LINE__); \
+        return 1; } \
+    } while(0)
+
+#define PERIODS 1000
+
+static int TestRate(uint64_t i_rate)
+{
+    ts_cbr_t cbr;
+    ts_cbr_Init(&cbr, i_rate);
+
+    const vlc_tick_t i_start = VLC_TICK_0 + VLC_TICK_FROM_SEC(3600);
+    const double f_packet = 188.0 * 8 / i_rate; /* seconds */
+    vlc_tick_t i_end = i_start;
+    vlc_tick_t i_prev = VLC_TICK_INVALID;
+    double f_jitter = 0, f_jitter_90k = 0;
+
+    srand(i_rate);
+    for(int i=0; i<PERIODS; i++)
+    {
+        /* shaping periods of irregular lengths, as cut by the muxer */
+        const vlc_tick_t i_begin = i_end;
+        i_end += VLC_TICK_FROM_MS(100) + rand() % VLC_TICK_FROM_MS(200);
+
+        uint64_t i_slots = ts_cbr_Slots(&cbr, i_begin, i_end);
+        ASSERT(ts_cbr_Slots(&cbr, i_begin, i_end) == i_slots);
+        while(i_slots--)
+        {
+            const uint64_t n = ts_cbr_Next(&cbr);
+            const vlc_tick_t i_date = ts_cbr_Date(&cbr, n);
+            ASSERT(i_date < i_end);
+            ASSERT(i_prev == VLC_TICK_INVALID || i_date > i_prev ||
+                   f_packet < 1e-6);
+            i_prev = i_date;
+
+            /* the PCR must follow the ideal constant rate clock */
+            const double f_ideal = n * f_packet * 27000000;
+            const double f_diff = fabs((double) ts_cbr_PCR(&cbr, n) - f_ideal);
+            f_jitter = __MAX(f_jitter, f_diff);
+            /* a PCR from the microsecond date at 90 kHz, as in VBR */
+            const double f_90k = (double) ((i_date - i_start) * 9 / 100) * 300;
+            f_jitter_90k = __MAX(f_jitter_90k, fabs(f_90k - f_ideal));
+        }
+        /* no slot left before the end, the next one is after it */
+        ASSERT(ts_cbr_Slots(&cbr, i_begin, i_end) == 0);
+        ASSERT(ts_cbr_Date(&cbr, cbr.i_packets) >= i_end);
+    }
+
+    /* the rate is exact over the whole run */
+    const double f_expected = secf_from_vlc_tick(i_end - i_start) / f_packet;
+    ASSERT(fabs((double) cbr.i_packets - f_expected) <= 1);
+    ASSERT(f_jitter <= 1);
+
+    fprintf(stderr, "%"PRIu64" bits/s: %"PRIu64" packets, PCR jitter %.1f ns "
+            "(%.1f ns at 90 kHz)\n", i_rate, cbr.i_packets,
+            f_jitter * 1000 / 27, f_jitter_90k * 1000 / 27);
+
+    /* restarting after a discontinuity */
+    ts_cbr_Reset(&cbr);
+    ASSERT(ts_cbr_Slots(&cbr, i_end + VLC_TICK_FROM_SEC(10),
+                        i_end + VLC_TICK_FROM_SEC(11)) ==
+           (i_rate + 188 * 8 - 1) / (188 * 8));
+    ASSERT(cbr.i_start == i_end + VLC_TICK_FROM_SEC(10));
+    return 0;
+}
+
+int main(void)
+{
+    test_init();
+
+    ASSERT(TestRate(38014706) == 0); /* DVB-C 256-QAM, 8 MHz */
+    ASSERT(TestRate(3000000) == 0);
+    ASSERT(TestRate(270000000) == 0); /* DVB-ASI */
+
+    return 0;
+}
@@ -28,6 +28,7 @@
 #include <vlc_common.h>
 #include <vlc_block.h>
 #include <vlc_block_helper.h>
+#include <vlc_tick.h>
 
 #include "../modules/packetizer/startcode_helper.h"
 
@@ -64,6 +65,38 @@ static int check_set( const uint8_t *p_set, const uint8_t *p_end,
     return 0;
 }
 
+typedef const uint8_t *(*startcode_find_t)(const uint8_t *, const uint8_t *);
+
+static const struct
+{
+    const char *name;
+    startcode_find_t pf_find;
+} simd_impls[] = {
+#ifdef CAN_COMPILE_SSE2
+    { "sse2", startcode_FindAnnexB_SSE2 },
+#endif
+#ifdef CAN_COMPILE_AVX2
+    { "avx2", startcode_FindAnnexB_AVX2 },
+#endif
+#ifdef STARTCODE_HAS_NEON
+    { "neon", startcode_FindAnnexB_NEON },
+#endif
+    { "default", startcode_FindAnnexB },
+};
+
+static bool simd_available( size_t i )
+{
+#ifdef CAN_COMPILE_SSE2
+    if( simd_impls[i].pf_find == startcode_FindAnnexB_SSE2 )
+        return vlc_CPU_SSE2();
+#endif
+#ifdef CAN_COMPILE_AVX2
+    if( simd_impls[i].pf_find == startcode_FindAnnexB_AVX2 )
+        return vlc_CPU_AVX2();
+#endif
+    return simd_impls[i].pf_find != startcode_FindAnnexB_Bits;
+}
+
 static int run_annexb_sets( const uint8_t *p_set, const uint8_t *p_end,
                             const struct results_s *p_results, size_t i_results,
                             ssize_t i_results_offset )
@@ -77,19 +110,96 @@ static int run_annexb_sets( const uint8_t *p_set, const uint8_t *p_end,
         return i_ret;
 
     /* Perform same tests on simd optimized code */
-    if( startcode_FindAnnexB_Bits != startcode_FindAnnexB )
+    for( size_t i = 0; i < ARRAY_SIZE(simd_impls); i++ )
     {
-        printf("checking asm:\n");
+        if( !simd_available( i ) )
+        {
+            printf("%s not available, skipping test:\n", simd_impls[i].name);
+            continue;
+        }
+        printf("checking %s:\n", simd_impls[i].name);
         i_ret = check_set( p_set, p_end, p_results, i_results, i_results_offset,
-                           startcode_FindAnnexB );
+                           simd_impls[i].pf_find );
         if( i_ret != 0 )
             return i_ret;
     }
-    else printf("asm not built in, skipping test:\n");
 
     return 0;
 }
 
+/* Compares all lookups with the bits one over every alignment and size
+ * of a random, start code dense buffer */
+static int run_annexb_random( void )
+{
+    uint8_t data[256];
+    srand( 0 );
+    for( size_t i = 0; i < sizeof(data); i++ )
+        data[i] = (rand() & 3) ? 0 : 1 + (rand() & 1);
+
+    for( size_t i = 0; i < ARRAY_SIZE(simd_impls); i++ )
+    {
+        if( !simd_available( i ) )
+            continue;
+        for( size_t start = 0; start < 64; start++ )
+        {
+            for( size_t end = start + 3; end <= sizeof(data); end++ )
+            {
+                const uint8_t *p = &data[start];
+                const uint8_t *q = &data[start];
+                while( p && q )
+                {
+                    p = startcode_FindAnnexB_Bits( p, &data[end] );
+                    q = simd_impls[i].pf_find( q, &data[end] );
+                    if( p != q )
+                    {
+                        printf("%s mismatch range %zu-%zu\n",
+                               simd_impls[i].name, start, end);
+                        return 1;
+                    }
+                    if( p )
+                        p = q = p + 1;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* Prints the lookup throughput over a start code free buffer */
+static void run_annexb_throughput( void )
+{
+    const size_t i_size = 1 << 22;
+    uint8_t *p_data = malloc( i_size );
+    if( !p_data )
+        return;
+    for( size_t i = 0; i < i_size; i++ )
+        p_data[i] = (i & 255) ? 0x42 : 0x00; /* sparse zeros as in ES */
+
+    for( size_t i = 0; i < ARRAY_SIZE(simd_impls) + 1; i++ )
+    {
+        startcode_find_t pf_find = startcode_FindAnnexB_Bits;
+        const char *psz_name = "bits";
+        if( i > 0 )
+        {
+            if( !simd_available( i - 1 ) )
+                continue;
+            pf_find = simd_impls[i - 1].pf_find;
+            psz_name = simd_impls[i - 1].name;
+        }
+        vlc_tick_t start = vlc_tick_now();
+        const uint8_t *p_found = NULL;
+        for( unsigned j = 0; j < 16 && !p_found; j++ )
+            p_found = pf_find( p_data, p_data + i_size );
+        assert( p_found == NULL );
+        vlc_tick_t elapsed = vlc_tick_now() - start;
+        if( elapsed > 0 )
+            printf("* %s: %"PRId64" MiB/s\n", psz_name,
+                   (int64_t)(16 * (i_size >> 20) * CLOCK_FREQ / elapsed));
+    }
+    free( p_data );
+}
+
 int main( void )
 {
     const uint8_t test1_annexbdata[] = { 0, 0, 0, 1, 0x55, 0x55, 0x55, 0x55, 0x55, // 9
@@ -134,5 +244,12 @@ int main( void )
             return i_ret;
     }
 
+    printf("* Running tests on random sets:\n");
+    i_ret = run_annexb_random();
+    if( i_ret != 0 )
+        return i_ret;
+
+    run_annexb_throughput();
+
     return 0;
 }
@@ -31,6 +31,7 @@
 #include <vlc_block.h>
 #include "../modules/packetizer/hxxx_nal.h"
 #include "../modules/packetizer/hxxx_nal.c"
+#include "../modules/packetizer/hxxx_ep3b.h"
 
 static void test_iterators( const uint8_t *p_ab, size_t i_ab, /* AnnexB */
                             const uint8_t **pp_prefix, size_t *pi_prefix /* Prefixed */ )
@@ -224,9 +225,61 @@ static void test_annexb( void )
     test_iterators( NULL, 0, p_res, rgi_res );
 }
 
+/* Inserts emulation prevention bytes */
+static size_t rbsp_to_ep3b( const uint8_t *p_rbsp, size_t i_rbsp, uint8_t *p_dst )
+{
+    size_t j = 0;
+    unsigned i_zeros = 0;
+    for( size_t i = 0; i < i_rbsp; i++ )
+    {
+        if( i_zeros == 2 && p_rbsp[i] <= 3 )
+        {
+            p_dst[j++] = 3;
+            i_zeros = 0;
+        }
+        p_dst[j++] = p_rbsp[i];
+        i_zeros = p_rbsp[i] ? 0 : i_zeros + 1;
+    }
+    return j;
+}
+
+static void test_ep3b( void )
+{
+    uint8_t rbsp[2048];
+    uint8_t ep3b[2048 * 3 / 2];
+
+    printf("\nTEST ep3b skipping\n");
+    srand( 0 );
+    for( size_t i = 0; i < ARRAY_SIZE(rbsp); i++ )
+    {
+        /* long escape free runs, with escaped sequences in between */
+        if( (i % 97) >= 91 )
+            rbsp[i] = (i % 97) < 94 ? 0 : rand() & 3;
+        else
+            rbsp[i] = 0x10 + (rand() % 0xE0);
+    }
+    const size_t i_ep3b = rbsp_to_ep3b( rbsp, ARRAY_SIZE(rbsp), ep3b );
+    assert( i_ep3b > ARRAY_SIZE(rbsp) );
+
+    for( size_t i_step = 1; i_step < 200; i_step += 7 )
+    {
+        bs_t bs;
+        struct hxxx_bsfw_ep3b_ctx_s bsctx;
+        hxxx_bsfw_ep3b_ctx_init( &bsctx );
+        bs_init_custom( &bs, ep3b, i_ep3b, &hxxx_bsfw_ep3b_callbacks, &bsctx );
+        for( size_t i = 0; i + i_step < ARRAY_SIZE(rbsp); i += i_step + 1 )
+        {
+            bs_skip( &bs, i_step * 8 );
+            assert( bs_read( &bs, 8 ) == rbsp[i + i_step] );
+            assert( !bs_error( &bs ) );
+        }
+    }
+}
+
 int main( void )
 {
     test_annexb();
+    test_ep3b();
 
     return 0;
 }
@@ -373,6 +373,43 @@ static void test_clock_slave_only(
 
     destroy_fixture_simple(&f);
 }
+/**
+ * Check that the lock-free conversion matches the locked one.
+ **/
+static void test_clock_unlocked_conversion(struct vlc_logger *logger)
+{
+    fprintf(stderr, "%s:\n", __func__);
+    struct clock_fixture_simple f = init_fixture_simple(logger, false, 0, 0);
+    const vlc_tick_t now = VLC_TICK_FROM_MS(1000);
+
+    vlc_clock_main_Lock(f.main);
+    vlc_clock_Start(f.input, now, now * 1000);
+    vlc_clock_Start(f.master, now, now * 1000);
+    vlc_clock_Start(f.slave, now, now * 1000);
+    vlc_clock_Update(f.master, now, now * 1000, 1.);
+    vlc_clock_Update(f.master, now + VLC_TICK_FROM_MS(20),
+                     now * 1000 + VLC_TICK_FROM_MS(21), 1.);
+    vlc_clock_SetDelay(f.slave, VLC_TICK_FROM_MS(100));
+    vlc_clock_main_Unlock(f.main);
+
+    for (vlc_tick_t ts = now * 1000; ts < now * 1000 + VLC_TICK_FROM_SEC(1);
+         ts += VLC_TICK_FROM_MS(33))
+    {
+        uint32_t unlocked_id, locked_id;
+        vlc_tick_t unlocked = vlc_clock_ConvertToSystemUnlocked(f.slave, now,
+                                                                ts, 1.5,
+                                                                &unlocked_id);
+        vlc_clock_main_Lock(f.main);
+        vlc_tick_t locked = vlc_clock_ConvertToSystem(f.slave, now, ts, 1.5,
+                                                      &locked_id);
+        vlc_clock_main_Unlock(f.main);
+        assert(unlocked == locked);
+        assert(unlocked_id == locked_id);
+    }
+
+    destroy_fixture_simple(&f);
+}
+
 int main(void)
 {
     libvlc_instance_t *libvlc = libvlc_new(0, NULL);
@@ -456,6 +493,7 @@ int main(void)
 
     test_clock_start_reset(logger);
     test_clock_slave_only(logger);
+    test_clock_unlocked_conversion(logger);
 
     libvlc_release(libvlc);
 }
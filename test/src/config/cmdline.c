@@ -0,0 +1,104 @@
+/*****************************************************************************
+ * cmdline.c: test command line parsing and configuration lookups
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include <string.h>
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_configuration.h>
+#include <vlc_tick.h>
+
+#define STARTUP_RUNS 5
+
+static const char *const parse_args[] = {
+    "--ignore-config", "--no-video-title-show", "--video-title-timeout=1234",
+    "--sub-language", "fr", "--stats-modules", "--nostats-modules",
+};
+
+static void test_parse(void)
+{
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(parse_args), parse_args);
+    assert(vlc != NULL);
+
+    libvlc_int_t *obj = vlc->p_libvlc_int;
+
+    assert(!var_InheritBool(obj, "video-title-show"));
+    assert(var_InheritInteger(obj, "video-title-timeout") == 1234);
+    char *str = var_InheritString(obj, "sub-language");
+    assert(str != NULL && strcmp(str, "fr") == 0);
+    free(str);
+    /* the last occurrence wins */
+    assert(!var_InheritBool(obj, "stats-modules"));
+
+    /* the index knows every option, and only them */
+    assert(config_GetType("video-title-show") == VLC_VAR_BOOL);
+    assert(config_GetType("video-title-timeout") == VLC_VAR_INTEGER);
+    assert(config_GetType("sub-language") == VLC_VAR_STRING);
+    assert(config_GetType("video-title") == 0);
+    assert(config_GetType("video-title-show-") == 0);
+    assert(config_GetType("") == 0);
+
+    libvlc_release(vlc);
+}
+
+static void test_no_options(void)
+{
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    assert(vlc != NULL);
+
+    /* the defaults are untouched */
+    assert(var_InheritBool(vlc->p_libvlc_int, "video-title-show"));
+    libvlc_release(vlc);
+}
+
+static vlc_tick_t measure_startup(int argc, const char *const *argv)
+{
+    vlc_tick_t best = VLC_TICK_MAX;
+
+    for (unsigned i = 0; i < STARTUP_RUNS; i++)
+    {
+        vlc_tick_t start = vlc_tick_now();
+        libvlc_instance_t *vlc = libvlc_new(argc, argv);
+        vlc_tick_t elapsed = vlc_tick_now() - start;
+
+        assert(vlc != NULL);
+        libvlc_release(vlc);
+        if (elapsed < best)
+            best = elapsed;
+    }
+    return best;
+}
+
+int main(void)
+{
+    test_init();
+
+    test_log("Testing command line parsing\n");
+    test_parse();
+    test_no_options();
+
+    test_log("startup without options: %"PRId64" us\n",
+             US_FROM_VLC_TICK(measure_startup(0, NULL)));
+    test_log("startup with options: %"PRId64" us\n",
+             US_FROM_VLC_TICK(measure_startup(ARRAY_SIZE(parse_args),
+                                              parse_args)));
+    return 0;
+}
@@ -18,6 +18,7 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
  *****************************************************************************/
 
+#include <stdint.h>
 #include <vlc/vlc.h>
 
 #if 0
@@ -26,6 +27,25 @@
 #define debug(...) (void)0
 #endif
 
+/* stages run by the decoders build, the demuxer output is dropped otherwise */
+enum vlc_run_stage
+{
+    VLC_RUN_DECODE = 0,
+    VLC_RUN_PACKETIZE,
+    VLC_RUN_DEMUX,
+};
+
+/* counters filled while processing, if requested */
+struct vlc_run_stats
+{
+    char demux[32]; /* name of the demux module */
+    uint64_t bytes; /* bytes read by the demuxer */
+    uint64_t packets; /* blocks output by the demuxer */
+    uint64_t packetized; /* blocks output by the packetizers */
+    uint64_t decoded; /* pictures, audio blocks and subpictures decoded */
+    int64_t elapsed; /* ticks from the demuxer creation until all is drained */
+};
+
 struct vlc_run_args
 {
     /* force specific target name (demux or decoder name). NULL to don't force
@@ -37,6 +57,12 @@ struct vlc_run_args
 
     /* true to test demux controls */
     bool test_demux_controls;
+
+    /* last stage to run (decoders builds only) */
+    enum vlc_run_stage stage;
+
+    /* NULL to not collect statistics */
+    struct vlc_run_stats *stats;
 };
 
 void vlc_run_args_init(struct vlc_run_args *args);
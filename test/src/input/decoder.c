@@ -44,6 +44,8 @@ struct decoder_owner
     decoder_t dec;
     es_format_t fmt_in;
     decoder_t *packetizer;
+    bool decode;
+    struct vlc_run_stats *stats;
 };
 
 static inline struct decoder_owner *dec_get_owner(decoder_t *dec)
@@ -51,6 +53,13 @@ static inline struct decoder_owner *dec_get_owner(decoder_t *dec)
     return container_of(dec, struct decoder_owner, dec);
 }
 
+static inline void count_decoded(decoder_t *dec)
+{
+    struct decoder_owner *owner = dec_get_owner(dec);
+    if (owner->stats != NULL)
+        owner->stats->decoded++;
+}
+
 static subpicture_t *spu_new_buffer_decoder(decoder_t *dec,
                                             const subpicture_updater_t * p_subpic)
 {
@@ -67,13 +76,13 @@ static vlc_decoder_device * get_no_device( decoder_t *dec )
 
 static void queue_video(decoder_t *dec, picture_t *pic)
 {
-    (void) dec;
+    count_decoded(dec);
     picture_Release(pic);
 }
 
 static void queue_audio(decoder_t *dec, block_t *p_block)
 {
-    (void) dec;
+    count_decoded(dec);
     block_Release(p_block);
 }
 static void queue_cc(decoder_t *dec, block_t *p_block, const decoder_cc_desc_t *desc)
@@ -83,7 +92,7 @@ static void queue_cc(decoder_t *dec, block_t *p_block, const decoder_cc_desc_t *
 }
 static void queue_sub(decoder_t *dec, subpicture_t *p_subpic)
 {
-    (void) dec;
+    count_decoded(dec);
     subpicture_Delete(p_subpic);
 }
 
@@ -140,7 +149,8 @@ void test_decoder_destroy(decoder_t *decoder)
     decoder_destroy_clean(decoder);
 }
 
-decoder_t *test_decoder_create(vlc_object_t *parent, const es_format_t *fmt)
+decoder_t *test_decoder_create(vlc_object_t *parent, const es_format_t *fmt,
+                               bool decode, struct vlc_run_stats *stats)
 {
     assert(parent && fmt);
     decoder_t *packetizer = decoder_create(parent);
@@ -155,6 +165,8 @@ decoder_t *test_decoder_create(vlc_object_t *parent, const es_format_t *fmt)
 
     struct decoder_owner *owner = dec_get_owner(decoder);
     owner->packetizer = packetizer;
+    owner->decode = decode;
+    owner->stats = stats;
 
     static const struct decoder_owner_callbacks dec_video_cbs =
     {
@@ -202,6 +214,9 @@ decoder_t *test_decoder_create(vlc_object_t *parent, const es_format_t *fmt)
         return NULL;
     }
 
+    if (!decode)
+        return decoder; /* the decoder only holds the packetizer */
+
     if (decoder_load(decoder, false, &packetizer->fmt_out) != VLC_SUCCESS)
     {
         decoder_destroy_clean(packetizer);
@@ -218,7 +233,7 @@ int test_decoder_process(decoder_t *decoder, block_t *p_block)
     decoder_t *packetizer = owner->packetizer;
 
     /* This case can happen if a decoder reload failed */
-    if (decoder->p_module == NULL)
+    if (owner->decode && decoder->p_module == NULL)
     {
         if (p_block != NULL)
             block_Release(p_block);
@@ -230,6 +245,15 @@ int test_decoder_process(decoder_t *decoder, block_t *p_block)
     while ((p_packetized_block =
                 packetizer->pf_packetize(packetizer, pp_block)))
     {
+        if (owner->stats != NULL)
+            for (block_t *b = p_packetized_block; b != NULL; b = b->p_next)
+                owner->stats->packetized++;
+
+        if (!owner->decode)
+        {
+            block_ChainRelease(p_packetized_block);
+            continue;
+        }
 
         if (!es_format_IsSimilar(decoder->fmt_in, &packetizer->fmt_out))
         {
@@ -273,7 +297,7 @@ int test_decoder_process(decoder_t *decoder, block_t *p_block)
             p_packetized_block = p_next;
         }
     }
-    if (p_block == NULL) /* Drain */
+    if (p_block == NULL && owner->decode) /* Drain */
         decoder->pf_decode(decoder, NULL);
     return VLC_SUCCESS;
 }
@@ -20,6 +20,8 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
  *****************************************************************************/
 
-decoder_t *test_decoder_create(vlc_object_t *parent, const es_format_t *fmt);
+/* only the packetizer is run if decode is false, stats may be NULL */
+decoder_t *test_decoder_create(vlc_object_t *parent, const es_format_t *fmt,
+                               bool decode, struct vlc_run_stats *stats);
 void test_decoder_destroy(decoder_t *decoder);
 int test_decoder_process(decoder_t *decoder, block_t *block);
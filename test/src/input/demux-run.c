@@ -56,6 +56,7 @@ struct test_es_out_t
 {
     struct es_out_t out;
     struct es_out_id_t *ids;
+    const struct vlc_run_args *args;
 #ifdef HAVE_DECODERS
     vlc_object_t *parent;
 #endif
@@ -85,10 +86,16 @@ static es_out_id_t *EsOutAdd(es_out_t *out, input_source_t* in, const es_format_
     id->next = ctx->ids;
     ctx->ids = id;
 #ifdef HAVE_DECODERS
-    es_format_Copy(&id->fmt, fmt);
-    id->decoder = test_decoder_create(ctx->parent, &id->fmt);
-    if (id->decoder == NULL)
-        es_format_Clean(&id->fmt);
+    id->decoder = NULL;
+    if (ctx->args->stage != VLC_RUN_DEMUX)
+    {
+        es_format_Copy(&id->fmt, fmt);
+        id->decoder = test_decoder_create(ctx->parent, &id->fmt,
+                                          ctx->args->stage == VLC_RUN_DECODE,
+                                          ctx->args->stats);
+        if (id->decoder == NULL)
+            es_format_Clean(&id->fmt);
+    }
 #endif
 
     debug("[%p] Added   ES\n", (void *)id);
@@ -110,6 +117,9 @@ static int EsOutSend(es_out_t *out, es_out_id_t *id, block_t *block)
 
     //debug("[%p] Sent    ES: %zu\n", (void *)idd, block->i_buffer);
     EsOutCheckId(ctx, id);
+    if (ctx->args->stats != NULL)
+        for (block_t *b = block; b != NULL; b = b->p_next)
+            ctx->args->stats->packets++;
 #ifdef HAVE_DECODERS
     if (id->decoder)
         test_decoder_process(id->decoder, block);
@@ -164,8 +174,14 @@ static int EsOutControl(es_out_t *out, input_source_t* in, int query, va_list ar
 #ifdef HAVE_DECODERS
             es_out_id_t* id = va_arg(args, es_out_id_t*);
             EsOutCheckId(ctx, id);
+            if (id->decoder == NULL)
+                break;
             test_decoder_destroy(id->decoder);
-            test_decoder_create(ctx->parent, &id->fmt);
+            id->decoder = test_decoder_create(ctx->parent, &id->fmt,
+                                              ctx->args->stage == VLC_RUN_DECODE,
+                                              ctx->args->stats);
+            if (id->decoder == NULL)
+                es_format_Clean(&id->fmt);
 #endif
             break;
         }
@@ -223,7 +239,8 @@ static const struct es_out_callbacks es_out_cbs =
     .destroy = EsOutDestroy,
 };
 
-static es_out_t *test_es_out_create(vlc_object_t *parent)
+static es_out_t *test_es_out_create(vlc_object_t *parent,
+                                    const struct vlc_run_args *args)
 {
     vlc_object_InitInputConfig(parent, true, false);
 
@@ -235,6 +252,7 @@ static es_out_t *test_es_out_create(vlc_object_t *parent)
     }
 
     ctx->ids = NULL;
+    ctx->args = args;
 
     es_out_t *out = &ctx->out;
     out->cbs = &es_out_cbs;
@@ -293,10 +311,11 @@ static int demux_process_stream(const struct vlc_run_args *args, stream_t *s)
     if (s == NULL)
         return -1;
 
-    es_out_t *out = test_es_out_create(VLC_OBJECT(s));
+    es_out_t *out = test_es_out_create(VLC_OBJECT(s), args);
     if (out == NULL)
         return -1;
 
+    vlc_tick_t start = vlc_tick_now();
     demux_t *demux = demux_New(VLC_OBJECT(s), name, "vlc://nop", s, out);
     if (demux == NULL)
     {
@@ -333,9 +352,23 @@ static int demux_process_stream(const struct vlc_run_args *args, stream_t *s)
         i++;
     }
 
+    if (args->stats != NULL)
+    {
+        struct vlc_run_stats *stats = args->stats;
+        char *module = var_GetString(demux, "module-name");
+
+        snprintf(stats->demux, sizeof (stats->demux), "%s",
+                 module != NULL ? module : "?");
+        free(module);
+        stats->bytes = vlc_stream_Tell(s);
+    }
+
     demux_Delete(demux);
     es_out_Delete(out);
 
+    if (args->stats != NULL)
+        args->stats->elapsed = vlc_tick_now() - start;
+
     debug("Completed with %" PRIuMAX " iteration(s).\n", i);
 
     return val == VLC_DEMUXER_EOF ? 0 : -1;
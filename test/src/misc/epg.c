@@ -135,5 +135,24 @@ int main( void )
     assert_current( p_epg, "B" );
     vlc_epg_Delete( p_epg );
 
+    /* Test event comparison */
+    printf("--test %d\n", i++);
+    p_epg = vlc_epg_New( 0, 0 );
+    assert(p_epg);
+    EPG_ADD( p_epg,  42, 20, "A" );
+    EPG_ADD( p_epg,  62, 20, "B" );
+    vlc_epg_t *p_dup = vlc_epg_Duplicate( p_epg );
+    assert(p_dup && p_dup->i_event == 2);
+    assert( vlc_epg_event_Equals( p_epg->pp_event[0], p_dup->pp_event[0] ) );
+    assert( !vlc_epg_event_Equals( p_epg->pp_event[0], p_dup->pp_event[1] ) );
+    p_dup->pp_event[1]->psz_description = strdup( "desc" );
+    assert( !vlc_epg_event_Equals( p_epg->pp_event[1], p_dup->pp_event[1] ) );
+    p_epg->pp_event[1]->psz_description = strdup( "desc" );
+    assert( vlc_epg_event_Equals( p_epg->pp_event[1], p_dup->pp_event[1] ) );
+    p_dup->pp_event[1]->i_rating = 12;
+    assert( !vlc_epg_event_Equals( p_epg->pp_event[1], p_dup->pp_event[1] ) );
+    vlc_epg_Delete( p_dup );
+    vlc_epg_Delete( p_epg );
+
     return 0;
 }
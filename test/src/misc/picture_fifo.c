@@ -0,0 +1,138 @@
+/*****************************************************************************
+ * picture_fifo.c: test the picture fifo
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <errno.h>
+
+#include <vlc_common.h>
+#include <vlc_picture.h>
+#include <vlc_picture_fifo.h>
+#include <vlc_threads.h>
+#include <vlc_tick.h>
+
+static picture_t *NewPicture(vlc_tick_t date)
+{
+    video_format_t fmt;
+
+    video_format_Init(&fmt, VLC_CODEC_GREY);
+    video_format_Setup(&fmt, VLC_CODEC_GREY, 16, 16, 16, 16, 1, 1);
+
+    picture_t *pic = picture_NewFromFormat(&fmt);
+    assert(pic != NULL);
+    pic->date = date;
+    video_format_Clean(&fmt);
+    return pic;
+}
+
+static void test_unbounded(void)
+{
+    picture_fifo_t *fifo = picture_fifo_New();
+    assert(fifo != NULL);
+
+    assert(picture_fifo_IsEmpty(fifo));
+    assert(picture_fifo_PeekDate(fifo) == VLC_TICK_INVALID);
+    assert(picture_fifo_WaitSpace(fifo, VLC_TICK_0) == 0);
+
+    for (int i = 1; i <= 10; i++)
+        picture_fifo_Push(fifo, NewPicture(VLC_TICK_FROM_MS(i)));
+    assert(picture_fifo_GetCount(fifo) == 10);
+    assert(picture_fifo_WaitSpace(fifo, VLC_TICK_0) == 0);
+    assert(picture_fifo_PeekDate(fifo) == VLC_TICK_FROM_MS(1));
+
+    picture_t *pic = picture_fifo_Pop(fifo);
+    assert(pic != NULL && pic->date == VLC_TICK_FROM_MS(1));
+    picture_Release(pic);
+
+    /* the leading pictures, in order */
+    vlc_picture_chain_t chain;
+    assert(picture_fifo_PopUntil(fifo, VLC_TICK_FROM_MS(4), &chain) == 3);
+    for (int i = 2; i <= 4; i++)
+    {
+        pic = vlc_picture_chain_PopFront(&chain);
+        assert(pic != NULL && pic->date == VLC_TICK_FROM_MS(i));
+        picture_Release(pic);
+    }
+    assert(vlc_picture_chain_IsEmpty(&chain));
+    assert(picture_fifo_PopUntil(fifo, VLC_TICK_FROM_MS(4), &chain) == 0);
+    assert(vlc_picture_chain_IsEmpty(&chain));
+    assert(picture_fifo_GetCount(fifo) == 6);
+
+    picture_fifo_Flush(fifo, VLC_TICK_FROM_MS(7), true);
+    assert(picture_fifo_GetCount(fifo) == 3);
+    assert(picture_fifo_PeekDate(fifo) == VLC_TICK_FROM_MS(8));
+    picture_fifo_Flush(fifo, VLC_TICK_FROM_MS(9), false);
+    assert(picture_fifo_GetCount(fifo) == 1);
+
+    picture_fifo_Delete(fifo);
+}
+
+static void *Consume(void *data)
+{
+    picture_fifo_t *fifo = data;
+
+    /* let the producer wait first, most of the time */
+    vlc_tick_sleep(VLC_TICK_FROM_MS(10));
+    picture_Release(picture_fifo_Pop(fifo));
+    return NULL;
+}
+
+static void test_bounded(void)
+{
+    picture_fifo_t *fifo = picture_fifo_NewBounded(2);
+    assert(fifo != NULL);
+
+    picture_fifo_Push(fifo, NewPicture(VLC_TICK_FROM_MS(1)));
+    assert(picture_fifo_WaitSpace(fifo, VLC_TICK_INVALID) == 0);
+    picture_fifo_Push(fifo, NewPicture(VLC_TICK_FROM_MS(2)));
+
+    /* full, nobody is making room */
+    vlc_tick_t deadline = vlc_tick_now() + VLC_TICK_FROM_MS(10);
+    assert(picture_fifo_WaitSpace(fifo, deadline) == ETIMEDOUT);
+    assert(vlc_tick_now() >= deadline);
+
+    /* room made by another thread */
+    vlc_thread_t th;
+
+    assert(vlc_clone(&th, Consume, fifo) == 0);
+    assert(picture_fifo_WaitSpace(fifo, VLC_TICK_INVALID) == 0);
+    vlc_join(th, NULL);
+    assert(picture_fifo_GetCount(fifo) == 1);
+
+    /* room made by a flush */
+    picture_fifo_Push(fifo, NewPicture(VLC_TICK_FROM_MS(3)));
+    assert(picture_fifo_WaitSpace(fifo, vlc_tick_now()) == ETIMEDOUT);
+    picture_fifo_Flush(fifo, VLC_TICK_INVALID, true);
+    assert(picture_fifo_IsEmpty(fifo));
+    assert(picture_fifo_WaitSpace(fifo, vlc_tick_now()) == 0);
+
+    picture_fifo_Delete(fifo);
+}
+
+int main(void)
+{
+    test_unbounded();
+    test_bounded();
+    return 0;
+}
@@ -444,6 +444,57 @@ static void test_creation_and_type( libvlc_int_t *p_libvlc )
     assert( var_Get( p_libvlc, "bla", &val ) == VLC_ENOENT );
 }
 
+static void test_handles( libvlc_int_t *p_libvlc )
+{
+    vlc_var_handle_t *handles[VAR_COUNT];
+
+    /* callback() resets var_value[] on each change */
+    for( unsigned i = 0; i < VAR_COUNT; i++ )
+    {
+        var_Create( p_libvlc, psz_var_name[i], VLC_VAR_INTEGER );
+        var_AddCallback( p_libvlc, psz_var_name[i], callback, psz_var_name );
+        handles[i] = var_Resolve( p_libvlc, psz_var_name[i] );
+        assert( handles[i] != NULL );
+    }
+    assert( var_Resolve( p_libvlc, "bla" ) == NULL );
+
+    for( unsigned i = 0; i < VAR_COUNT; i++ )
+    {
+        int i_temp = rand();
+        var_SetHandleInteger( p_libvlc, handles[i], i_temp );
+        assert( var_value[i].i_int == i_temp );
+        assert( var_GetInteger( p_libvlc, psz_var_name[i] ) == i_temp );
+        var_SetInteger( p_libvlc, psz_var_name[i], i_temp + 1 );
+        assert( var_GetHandleInteger( p_libvlc, handles[i] ) == i_temp + 1 );
+    }
+
+    /* The handle keeps the variable alive */
+    for( unsigned i = 0; i < VAR_COUNT; i++ )
+    {
+        var_DelCallback( p_libvlc, psz_var_name[i], callback, psz_var_name );
+        var_Destroy( p_libvlc, psz_var_name[i] );
+        assert( var_Type( p_libvlc, psz_var_name[i] ) == VLC_VAR_INTEGER );
+        var_ReleaseHandle( p_libvlc, handles[i] );
+        assert( var_Type( p_libvlc, psz_var_name[i] ) == 0 );
+    }
+
+    /* Enough variables to grow the table several times */
+    char name[16];
+    for( int i = 0; i < 1000; i++ )
+    {
+        snprintf( name, sizeof (name), "bla%d", i );
+        var_Create( p_libvlc, name, VLC_VAR_INTEGER );
+        var_SetInteger( p_libvlc, name, i );
+    }
+    for( int i = 0; i < 1000; i++ )
+    {
+        snprintf( name, sizeof (name), "bla%d", i );
+        assert( var_GetInteger( p_libvlc, name ) == i );
+        var_Destroy( p_libvlc, name );
+        assert( var_Type( p_libvlc, name ) == 0 );
+    }
+}
+
 static void test_variables( libvlc_instance_t *p_vlc )
 {
     libvlc_int_t *p_libvlc = p_vlc->p_libvlc_int;
@@ -481,6 +532,9 @@ static void test_variables( libvlc_instance_t *p_vlc )
 
     test_log( "Testing type at creation\n" );
     test_creation_and_type( p_libvlc );
+
+    test_log( "Testing variable handles\n" );
+    test_handles( p_libvlc );
 }
 
 
@@ -263,6 +263,7 @@ struct media_params
 #define DISABLE_VIDEO        (1 << 2)
 #define DISABLE_AUDIO        (1 << 3)
 #define AUDIO_INSTANT_DRAIN  (1 << 4)
+#define GAPLESS_PRELOAD      (1 << 5)
 
 struct ctx
 {
@@ -1930,6 +1931,56 @@ test_pause(struct ctx *ctx)
     test_end(ctx);
 }
 
+static bool
+stats_has_module(const struct input_stats_t *stats, const char *kind,
+                 const char *name)
+{
+    for (size_t i = 0; i < stats->i_modules; i++)
+    {
+        const struct input_stats_module_t *m = &stats->modules[i];
+        if (!strcmp(m->psz_kind, kind)
+         && (name == NULL || !strcmp(m->psz_name, name)))
+            return m->i_calls > 0;
+    }
+    return false;
+}
+
+static void
+test_module_stats(struct ctx *ctx)
+{
+    test_log("module_stats\n");
+    vlc_player_t *player = ctx->player;
+    vlc_object_t *libvlc = VLC_OBJECT(ctx->vlc->p_libvlc_int);
+
+    var_Create(libvlc, "stats-modules", VLC_VAR_BOOL);
+    var_SetBool(libvlc, "stats-modules", true);
+
+    struct media_params params = DEFAULT_MEDIA_PARAMS(VLC_TICK_FROM_SEC(10));
+    player_set_next_mock_media(ctx, "media1", &params);
+    player_start(ctx);
+
+    /* The demuxer and the audio and video decoders are accounted */
+    {
+        vec_on_statistics_changed *vec = &ctx->report.on_statistics_changed;
+        for (;;)
+        {
+            if (vec->size > 0)
+            {
+                const struct input_stats_t *stats = &VEC_LAST(vec);
+                if (stats_has_module(stats, "demux", "mock")
+                 && stats_has_module(stats, "decoder", "araw")
+                 && stats_has_module(stats, "decoder", "rawvideo"))
+                    break;
+                assert(stats->i_modules <= INPUT_STATS_MAX_MODULES);
+            }
+            vlc_player_CondWait(player, &ctx->wait);
+        }
+    }
+
+    test_end(ctx);
+    var_SetBool(libvlc, "stats-modules", false);
+}
+
 static void
 test_seeks(struct ctx *ctx)
 {
@@ -2285,6 +2336,7 @@ ctx_init(struct ctx *ctx, int flags)
         (flags & DISABLE_VIDEO) ? "--no-video" : "--video",
         (flags & DISABLE_AUDIO) ? "--no-audio" : "--audio",
         "--text-renderer=tdummy,none",
+        (flags & GAPLESS_PRELOAD) ? "--gapless-preload=1000" : "--gapless-preload=0",
 #ifdef TEST_CLOCK_MONOTONIC
         "--clock-master=monotonic",
 #endif
@@ -3153,6 +3205,7 @@ main(void)
     test_next_media(&ctx);
     test_seeks(&ctx);
     test_pause(&ctx);
+    test_module_stats(&ctx);
     test_capabilities_pause(&ctx);
     test_capabilities_seek(&ctx);
     test_error(&ctx);
@@ -3172,6 +3225,12 @@ main(void)
 
     ctx_destroy(&ctx);
 
+    /* Test with the next media opened ahead of time */
+    ctx_init(&ctx, GAPLESS_PRELOAD);
+    test_next_media(&ctx);
+    test_set_current_media(&ctx);
+    ctx_destroy(&ctx);
+
     /* Test with instantaneous audio drain */
     ctx_init(&ctx, AUDIO_INSTANT_DRAIN);
     test_clock_discontinuities(&ctx);
@@ -0,0 +1,216 @@
+/*****************************************************************************
+ * loudness.c: test the preparser loudness measurement API
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_modules.h>
+#include <vlc_preparser.h>
+#include <vlc_input_item.h>
+
+#include <errno.h>
+
+#define MOCK_DURATION VLC_TICK_FROM_SEC( 10 )
+
+static const struct
+{
+    uint32_t i_nb_video_tracks;
+    uint32_t i_nb_audio_tracks;
+    bool b_expected_success;
+} test_params[] = {
+    /* Sine wave of 0.2 on each channel */
+    { 0, 1, true },
+    /* Only the audio is decoded */
+    { 1, 1, true },
+    /* Several audio tracks, only the default one is measured */
+    { 0, 2, true },
+    /* Nothing to measure */
+    { 1, 0, false },
+};
+
+struct test_ctx
+{
+    vlc_mutex_t lock;
+    vlc_cond_t cond;
+    size_t pending;
+};
+
+struct test_item
+{
+    struct test_ctx *ctx;
+    size_t idx;
+};
+
+static void loudness_callback( input_item_t *item, int status,
+                               const struct vlc_audio_loudness *loudness,
+                               void *data )
+{
+    (void) item;
+    struct test_item *test_item = data;
+    struct test_ctx *ctx = test_item->ctx;
+    size_t idx = test_item->idx;
+
+    if ( test_params[idx].b_expected_success )
+    {
+        assert( status == VLC_SUCCESS );
+        assert( loudness != NULL );
+        /* about -14.7 LUFS for a stereo sine of 0.2 */
+        assert( loudness->loudness_integrated > -16.0 );
+        assert( loudness->loudness_integrated < -13.0 );
+        assert( loudness->truepeak > 0.19 && loudness->truepeak < 0.22 );
+    }
+    else
+    {
+        assert( status == VLC_EGENERIC );
+        assert( loudness == NULL );
+    }
+
+    vlc_mutex_lock( &ctx->lock );
+    assert( ctx->pending > 0 );
+    ctx->pending--;
+    vlc_cond_signal( &ctx->cond );
+    vlc_mutex_unlock( &ctx->lock );
+}
+
+static void test_loudness( libvlc_instance_t *vlc )
+{
+    /* Measure all the items in parallel */
+    const struct vlc_preparser_cfg cfg = {
+        .types = VLC_PREPARSER_TYPE_LOUDNESS,
+        .max_loudness_threads = ARRAY_SIZE(test_params),
+        .timeout = VLC_TICK_INVALID,
+    };
+    vlc_preparser_t *preparser =
+        vlc_preparser_New( VLC_OBJECT( vlc->p_libvlc_int ), &cfg );
+    assert( preparser != NULL );
+
+    struct test_ctx ctx = { .pending = ARRAY_SIZE(test_params) };
+    vlc_mutex_init( &ctx.lock );
+    vlc_cond_init( &ctx.cond );
+
+    static const struct vlc_preparser_loudness_cbs cbs = {
+        .on_ended = loudness_callback,
+    };
+
+    input_item_t *items[ARRAY_SIZE(test_params)];
+    struct test_item test_items[ARRAY_SIZE(test_params)];
+    for ( size_t i = 0; i < ARRAY_SIZE(test_params); ++i )
+    {
+        char *psz_mrl;
+        if ( asprintf( &psz_mrl, "mock://video_track_count=%u;audio_track_count=%u"
+                       ";length=%" PRId64 ";audio_sinewave_amplitude=0.2",
+                       test_params[i].i_nb_video_tracks,
+                       test_params[i].i_nb_audio_tracks, MOCK_DURATION ) < 0 )
+            assert( !"Failed to allocate mock mrl" );
+        items[i] = input_item_New( psz_mrl, "mock item" );
+        assert( items[i] != NULL );
+        free( psz_mrl );
+
+        test_items[i] = (struct test_item) { .ctx = &ctx, .idx = i };
+        vlc_preparser_req_id id =
+            vlc_preparser_MeasureLoudness( preparser, items[i], &cbs,
+                                           &test_items[i] );
+        assert( id != VLC_PREPARSER_REQ_ID_INVALID );
+    }
+
+    vlc_mutex_lock( &ctx.lock );
+    while ( ctx.pending > 0 )
+        vlc_cond_wait( &ctx.cond, &ctx.lock );
+    vlc_mutex_unlock( &ctx.lock );
+
+    for ( size_t i = 0; i < ARRAY_SIZE(test_params); ++i )
+        input_item_Release( items[i] );
+
+    vlc_preparser_Delete( preparser );
+}
+
+static void loudness_callback_cancel( input_item_t *item, int status,
+                                      const struct vlc_audio_loudness *loudness,
+                                      void *data )
+{
+    (void) item;
+    assert( loudness == NULL );
+    assert( status == -EINTR );
+
+    vlc_sem_t *sem = data;
+    vlc_sem_post( sem );
+}
+
+static void test_cancel_loudness( libvlc_instance_t *vlc )
+{
+    const struct vlc_preparser_cfg cfg = {
+        .types = VLC_PREPARSER_TYPE_LOUDNESS,
+        .timeout = VLC_TICK_INVALID,
+    };
+    vlc_preparser_t *preparser =
+        vlc_preparser_New( VLC_OBJECT( vlc->p_libvlc_int ), &cfg );
+    assert( preparser != NULL );
+
+    const char *psz_mrl = "mock://video_track_count=0;audio_track_count=1;"
+                          /* measuring will take the same time as length */
+                          "can_control_pace=false;"
+                          "length=20000000";
+    input_item_t *item = input_item_New( psz_mrl, "mock item" );
+    assert( item != NULL );
+
+    static const struct vlc_preparser_loudness_cbs cbs = {
+        .on_ended = loudness_callback_cancel,
+    };
+
+    vlc_sem_t sem;
+    vlc_sem_init( &sem, 0 );
+    vlc_preparser_req_id id =
+        vlc_preparser_MeasureLoudness( preparser, item, &cbs, &sem );
+    assert( id != VLC_PREPARSER_REQ_ID_INVALID );
+
+    vlc_preparser_Cancel( preparser, id );
+
+    vlc_sem_wait( &sem );
+
+    input_item_Release( item );
+
+    vlc_preparser_Delete( preparser );
+}
+
+int main( void )
+{
+    test_init();
+
+    static const char * argv[] = {
+        "-v",
+        "--ignore-config",
+    };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
+    assert(vlc);
+
+    if ( !module_exists( "ebur128" ) )
+    {
+        libvlc_release( vlc );
+        return 77;
+    }
+
+    test_loudness( vlc );
+    test_cancel_loudness( vlc );
+
+    libvlc_release( vlc );
+    return 0;
+}
@@ -0,0 +1,596 @@
+/*****************************************************************************
+ * vlc-core-bench.c: libvlccore primitives benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Measures the throughput of the core primitives the pipeline relies on,
+ * with an increasing number of threads hammering the same object, e.g.:
+ *
+ *   vlc-core-bench -t 8 -f csv > results.csv
+ *   vlc-core-bench -b fifo,pool -n 100000
+ *
+ * Every benchmark is run with 1, 2, 4... threads up to the given maximum, so
+ * that contention shows up as throughput that does not scale. */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <vlc/vlc.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_executor.h>
+#include <vlc_picture.h>
+#include <vlc_picture_pool.h>
+#include <vlc_threads.h>
+#include <vlc_tick.h>
+#include <vlc_variables.h>
+
+#include "../lib/libvlc_internal.h"
+#include "../src/clock/clock.h"
+
+enum output_format
+{
+    OUTPUT_TEXT,
+    OUTPUT_CSV,
+};
+
+struct bench;
+
+struct bench_ctx
+{
+    const struct bench *bench;
+    libvlc_int_t *obj;
+    unsigned threads;
+    unsigned long iterations; /* per thread */
+    void *data;
+
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    bool go;
+    atomic_ullong latency; /* sum of the measured latencies, in ticks */
+};
+
+struct bench
+{
+    const char *name;
+    const char *desc;
+    /* prepares the shared object, returns false on error */
+    bool (*setup)(struct bench_ctx *);
+    /* runs the iterations of one thread */
+    void (*run)(struct bench_ctx *, unsigned index);
+    void (*teardown)(struct bench_ctx *);
+    /* runs the whole benchmark, instead of run() in each thread */
+    void (*drive)(struct bench_ctx *);
+};
+
+static unsigned max_threads;
+static unsigned long iterations = 1000000;
+static enum output_format output = OUTPUT_TEXT;
+static const char *bench_list = NULL;
+
+/*** Blocks ***/
+
+static void RunBlock(struct bench_ctx *ctx, size_t size)
+{
+    for (unsigned long i = 0; i < ctx->iterations; i++)
+    {
+        block_t *block = block_Alloc(size);
+        if (unlikely(block == NULL))
+            abort();
+        block->p_buffer[0] = i;
+        block_Release(block);
+    }
+}
+
+static void RunBlockSmall(struct bench_ctx *ctx, unsigned index)
+{
+    RunBlock(ctx, 7 * 188);
+    (void) index;
+}
+
+static void RunBlockLarge(struct bench_ctx *ctx, unsigned index)
+{
+    RunBlock(ctx, 1920 * 1080 * 3 / 2);
+    (void) index;
+}
+
+/*** FIFO: one consumer for all the producers ***/
+
+static bool SetupFifo(struct bench_ctx *ctx)
+{
+    ctx->data = block_FifoNew();
+    return ctx->data != NULL;
+}
+
+static void TeardownFifo(struct bench_ctx *ctx)
+{
+    block_FifoRelease(ctx->data);
+}
+
+static void *FifoConsumer(void *data)
+{
+    struct bench_ctx *ctx = data;
+    unsigned long count = ctx->iterations * ctx->threads;
+
+    while (count-- > 0)
+        block_Release(block_FifoGet(ctx->data));
+    return NULL;
+}
+
+static void RunFifo(struct bench_ctx *ctx, unsigned index)
+{
+    vlc_thread_t consumer;
+
+    /* the first producer also starts the consumer */
+    if (index == 0
+     && vlc_clone(&consumer, FifoConsumer, ctx))
+        abort();
+
+    for (unsigned long i = 0; i < ctx->iterations; i++)
+    {
+        block_t *block = block_Alloc(7 * 188);
+        if (unlikely(block == NULL))
+            abort();
+        block_FifoPut(ctx->data, block);
+    }
+
+    if (index == 0)
+        vlc_join(consumer, NULL);
+}
+
+/*** Picture pool ***/
+
+static bool SetupPool(struct bench_ctx *ctx)
+{
+    video_format_t fmt;
+
+    video_format_Init(&fmt, VLC_CODEC_I420);
+    video_format_Setup(&fmt, VLC_CODEC_I420, 64, 64, 64, 64, 1, 1);
+    /* as many pictures as threads, so that none waits */
+    ctx->data = picture_pool_NewFromFormat(&fmt, ctx->threads);
+    return ctx->data != NULL;
+}
+
+static void TeardownPool(struct bench_ctx *ctx)
+{
+    picture_pool_Release(ctx->data);
+}
+
+static void RunPool(struct bench_ctx *ctx, unsigned index)
+{
+    for (unsigned long i = 0; i < ctx->iterations; i++)
+        picture_Release(picture_pool_Wait(ctx->data));
+    (void) index;
+}
+
+/*** Executor: latency from the submission to the execution ***/
+
+struct bench_task
+{
+    struct bench_ctx *ctx;
+    vlc_tick_t submitted;
+    struct vlc_runnable runnable;
+};
+
+static void RunTask(void *data)
+{
+    struct bench_task *task = data;
+
+    atomic_fetch_add_explicit(&task->ctx->latency,
+                              vlc_tick_now() - task->submitted,
+                              memory_order_relaxed);
+}
+
+static void DriveExecutor(struct bench_ctx *ctx)
+{
+    vlc_executor_t *executor = vlc_executor_New(ctx->threads);
+    unsigned long count = __MAX(ctx->iterations / 16, 1);
+    struct bench_task *tasks = vlc_alloc(count, sizeof (*tasks));
+
+    if (executor == NULL || tasks == NULL)
+        abort();
+
+    for (unsigned long i = 0; i < count; i++)
+    {
+        struct bench_task *task = &tasks[i];
+
+        task->ctx = ctx;
+        task->runnable.run = RunTask;
+        task->runnable.userdata = task;
+        task->submitted = vlc_tick_now();
+        vlc_executor_Submit(executor, &task->runnable);
+    }
+    vlc_executor_WaitIdle(executor);
+    vlc_executor_Delete(executor);
+    free(tasks);
+    ctx->iterations = count;
+}
+
+/*** Variables ***/
+
+static bool SetupVar(struct bench_ctx *ctx)
+{
+    return var_Create(ctx->obj, "bench-value", VLC_VAR_INTEGER) == VLC_SUCCESS;
+}
+
+static void TeardownVar(struct bench_ctx *ctx)
+{
+    var_Destroy(ctx->obj, "bench-value");
+}
+
+static void RunVar(struct bench_ctx *ctx, unsigned index)
+{
+    for (unsigned long i = 0; i < ctx->iterations; i++)
+    {
+        if (i & 1)
+            (void) var_GetInteger(ctx->obj, "bench-value");
+        else
+            var_SetInteger(ctx->obj, "bench-value", i);
+    }
+    (void) index;
+}
+
+/*** Clock conversions ***/
+
+struct bench_clock
+{
+    vlc_clock_main_t *main;
+    vlc_clock_t *master;
+    vlc_clock_t *slave;
+};
+
+static bool SetupClock(struct bench_ctx *ctx)
+{
+    struct bench_clock *clock = malloc(sizeof (*clock));
+    if (clock == NULL)
+        return false;
+
+    clock->main = vlc_clock_main_New(ctx->obj->obj.logger, NULL);
+    if (clock->main == NULL)
+    {
+        free(clock);
+        return false;
+    }
+
+    vlc_clock_main_Lock(clock->main);
+    clock->master = vlc_clock_main_CreateMaster(clock->main, "bench", NULL,
+                                                NULL);
+    clock->slave = vlc_clock_main_CreateSlave(clock->main, "bench-slave",
+                                              VIDEO_ES, NULL, NULL);
+    vlc_clock_main_Unlock(clock->main);
+    assert(clock->master != NULL && clock->slave != NULL);
+
+    /* a few points, so that the conversion uses the drift estimation */
+    vlc_tick_t now = vlc_tick_now();
+    vlc_clock_Lock(clock->master);
+    for (unsigned i = 0; i < 10; i++)
+        vlc_clock_Update(clock->master, now + VLC_TICK_FROM_MS(10 * i),
+                         VLC_TICK_0 + VLC_TICK_FROM_MS(10 * i), 1.);
+    vlc_clock_Unlock(clock->master);
+
+    ctx->data = clock;
+    return true;
+}
+
+static void TeardownClock(struct bench_ctx *ctx)
+{
+    struct bench_clock *clock = ctx->data;
+
+    vlc_clock_Delete(clock->slave);
+    vlc_clock_Delete(clock->master);
+    vlc_clock_main_Delete(clock->main);
+    free(clock);
+}
+
+static void RunClock(struct bench_ctx *ctx, unsigned index)
+{
+    struct bench_clock *clock = ctx->data;
+    vlc_tick_t now = vlc_tick_now();
+
+    for (unsigned long i = 0; i < ctx->iterations; i++)
+        (void) vlc_clock_ConvertToSystemUnlocked(clock->slave, now,
+                                                 VLC_TICK_0 + i, 1., NULL);
+    (void) index;
+}
+
+/*** Logging ***/
+
+static void LogCallback(void *data, int level, const libvlc_log_t *ctx,
+                        const char *fmt, va_list args)
+{
+    char buf[256];
+
+    /* format the message, as any actual logger would */
+    vsnprintf(buf, sizeof (buf), fmt, args);
+    (void) data; (void) level; (void) ctx;
+}
+
+static void RunLog(struct bench_ctx *ctx, unsigned index)
+{
+    for (unsigned long i = 0; i < ctx->iterations; i++)
+        msg_Warn(ctx->obj, "thread %u message %lu", index, i);
+}
+
+static const struct bench benches[] = {
+    { "block", "small block alloc/release", NULL, RunBlockSmall, NULL, NULL },
+    { "frame", "frame sized block alloc/release", NULL, RunBlockLarge, NULL,
+      NULL },
+    { "fifo", "FIFO put (with one consumer thread)", SetupFifo, RunFifo,
+      TeardownFifo, NULL },
+    { "pool", "picture pool wait/release", SetupPool, RunPool, TeardownPool,
+      NULL },
+    { "executor", "executor task latency", NULL, NULL, NULL, DriveExecutor },
+    { "var", "integer variable set/get", SetupVar, RunVar, TeardownVar, NULL },
+    { "clock", "clock conversion to system time", SetupClock, RunClock,
+      TeardownClock, NULL },
+    { "log", "log message", NULL, RunLog, NULL, NULL },
+};
+
+static void usage(const char *name, int ret)
+{
+    fprintf(stderr,
+            "Usage: %s [-b bench[,bench...]] [-t threads] [-n iterations]\n"
+            "          [-f text|csv]\n"
+            "\n"
+            "  -b  benchmarks to run (default: all) among:\n", name);
+    for (size_t i = 0; i < ARRAY_SIZE(benches); i++)
+        fprintf(stderr, "        %-9s %s\n", benches[i].name,
+                benches[i].desc);
+    fprintf(stderr,
+            "  -t  largest number of threads (default: CPU count)\n"
+            "  -n  iterations per thread (default: 1000000)\n"
+            "  -f  output format (default: text)\n");
+    exit(ret);
+}
+
+/* extracts options from command line */
+static void cmdline(int argc, char *argv[])
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "b:f:hn:t:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'b':
+                bench_list = optarg;
+                break;
+
+            case 'f':
+                if (!strcmp(optarg, "text"))
+                    output = OUTPUT_TEXT;
+                else if (!strcmp(optarg, "csv"))
+                    output = OUTPUT_CSV;
+                else
+                    usage(argv[0], 1);
+                break;
+
+            case 'h':
+                usage(argv[0], 0);
+                break;
+
+            case 'n':
+                iterations = strtoul(optarg, NULL, 0);
+                if (iterations == 0)
+                    usage(argv[0], 1);
+                break;
+
+            case 't':
+                max_threads = strtoul(optarg, NULL, 0);
+                if (max_threads == 0)
+                    usage(argv[0], 1);
+                break;
+
+            default:
+                usage(argv[0], 1);
+                break;
+        }
+    }
+
+    if (optind < argc)
+        usage(argv[0], 1);
+}
+
+static bool Selected(const char *name)
+{
+    if (bench_list == NULL)
+        return true;
+
+    size_t len = strlen(name);
+    for (const char *p = bench_list; *p != '\0'; p += strcspn(p, ","))
+    {
+        p += strspn(p, ",");
+        if (!strncmp(p, name, len) && (p[len] == ',' || p[len] == '\0'))
+            return true;
+    }
+    return false;
+}
+
+struct worker
+{
+    struct bench_ctx *ctx;
+    unsigned index;
+    vlc_thread_t thread;
+};
+
+static void *Worker(void *data)
+{
+    struct worker *worker = data;
+    struct bench_ctx *ctx = worker->ctx;
+
+    /* all the threads start together */
+    vlc_mutex_lock(&ctx->lock);
+    while (!ctx->go)
+        vlc_cond_wait(&ctx->wait, &ctx->lock);
+    vlc_mutex_unlock(&ctx->lock);
+
+    ctx->bench->run(ctx, worker->index);
+    return NULL;
+}
+
+static vlc_tick_t Run(struct bench_ctx *ctx)
+{
+    const struct bench *bench = ctx->bench;
+    vlc_tick_t start;
+
+    if (bench->drive != NULL)
+    {
+        start = vlc_tick_now();
+        bench->drive(ctx);
+        return vlc_tick_now() - start;
+    }
+
+    struct worker *workers = vlc_alloc(ctx->threads, sizeof (*workers));
+    if (workers == NULL)
+        abort();
+
+    ctx->go = false;
+    for (unsigned i = 0; i < ctx->threads; i++)
+    {
+        workers[i].ctx = ctx;
+        workers[i].index = i;
+        if (vlc_clone(&workers[i].thread, Worker, &workers[i]))
+            abort();
+    }
+
+    vlc_mutex_lock(&ctx->lock);
+    ctx->go = true;
+    start = vlc_tick_now();
+    vlc_cond_broadcast(&ctx->wait);
+    vlc_mutex_unlock(&ctx->lock);
+
+    for (unsigned i = 0; i < ctx->threads; i++)
+        vlc_join(workers[i].thread, NULL);
+
+    vlc_tick_t elapsed = vlc_tick_now() - start;
+    free(workers);
+    return elapsed;
+}
+
+static void PrintResult(const struct bench_ctx *ctx, vlc_tick_t elapsed)
+{
+    double seconds = elapsed > 0 ? secf_from_vlc_tick(elapsed) : 1e-6;
+    double ops = (double) ctx->iterations * ctx->threads;
+    double rate = ops / seconds;
+    double ns = seconds * 1e9 / ops * ctx->threads; /* per thread */
+    double latency = 0.;
+
+    if (ctx->bench->drive != NULL)
+    {
+        /* the tasks are submitted from a single thread */
+        ops = ctx->iterations;
+        rate = ops / seconds;
+        ns = seconds * 1e9 / ops;
+        latency = secf_from_vlc_tick(atomic_load(&ctx->latency)) * 1e6 / ops;
+    }
+
+    switch (output)
+    {
+        case OUTPUT_TEXT:
+            printf("%-9s %7u %14.0f %12.1f", ctx->bench->name, ctx->threads,
+                   rate, ns);
+            if (ctx->bench->drive != NULL)
+                printf("  (%.1f us latency)", latency);
+            putchar('\n');
+            break;
+
+        case OUTPUT_CSV:
+            printf("%s,%u,%.0f,%.6f,%.1f,%.3f\n", ctx->bench->name,
+                   ctx->threads, ops, seconds, ns, latency);
+            break;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    static const char *const args[] = { "--ignore-config", "-q" };
+
+    cmdline(argc, argv);
+    if (max_threads == 0)
+        max_threads = vlc_GetCPUCount();
+
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    if (vlc == NULL)
+        return 1;
+    libvlc_log_set(vlc, LogCallback, NULL);
+
+    switch (output)
+    {
+        case OUTPUT_TEXT:
+            printf("%-9s %7s %14s %12s\n", "bench", "threads", "ops/s",
+                   "ns/op");
+            break;
+        case OUTPUT_CSV:
+            puts("bench,threads,ops,seconds,ns_per_op,latency_us");
+            break;
+    }
+
+    int ret = 0;
+
+    for (size_t i = 0; i < ARRAY_SIZE(benches); i++)
+    {
+        const struct bench *bench = &benches[i];
+
+        if (!Selected(bench->name))
+            continue;
+
+        /* 1, 2, 4... threads and the maximum */
+        for (unsigned threads = 1; threads <= max_threads;
+             threads = (threads < max_threads && 2 * threads > max_threads)
+                       ? max_threads : 2 * threads)
+        {
+            struct bench_ctx ctx = {
+                .bench = bench,
+                .obj = vlc->p_libvlc_int,
+                .threads = threads,
+                .iterations = iterations,
+            };
+
+            vlc_mutex_init(&ctx.lock);
+            vlc_cond_init(&ctx.wait);
+            atomic_init(&ctx.latency, 0);
+
+            if (bench->setup != NULL && !bench->setup(&ctx))
+            {
+                fprintf(stderr, "%s: setup failed\n", bench->name);
+                ret = 1;
+                break;
+            }
+
+            PrintResult(&ctx, Run(&ctx));
+
+            if (bench->teardown != NULL)
+                bench->teardown(&ctx);
+            if (threads == max_threads)
+                break;
+        }
+    }
+
+    libvlc_release(vlc);
+    return ret;
+}
@@ -0,0 +1,382 @@
+/*****************************************************************************
+ * vlc-demux-bench.c: demuxer throughput benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Runs each file of a corpus through the demuxer only, the demuxer and the
+ * packetizers, and up to the decoders, as vlc-demux-dec-run does, e.g.:
+ *
+ *   vlc-demux-bench -n 5 -f json movie.ts movie.mp4 movie.mkv > results.json
+ *
+ * Each run happens in a child process, so that its peak memory use can be
+ * told apart from the other runs. The fastest run of each stage is reported
+ * with its throughput, its packet rates and the largest peak memory use. */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#ifndef _WIN32
+# include <sys/resource.h>
+# include <sys/wait.h>
+#endif
+#ifdef __GLIBC__
+# if __GLIBC_PREREQ(2, 33)
+#  include <malloc.h>
+#  define HAVE_MALLINFO2
+# endif
+#endif
+
+#include <vlc_common.h>
+#include <vlc_tick.h>
+
+#include "src/input/demux-run.h"
+
+static const char *const stage_names[] = {
+    [VLC_RUN_DEMUX] = "demux",
+    [VLC_RUN_PACKETIZE] = "packetize",
+    [VLC_RUN_DECODE] = "decode",
+};
+
+/* from the fastest to the slowest */
+static const enum vlc_run_stage stage_order[] = {
+    VLC_RUN_DEMUX, VLC_RUN_PACKETIZE, VLC_RUN_DECODE,
+};
+
+enum output_format
+{
+    OUTPUT_TEXT,
+    OUTPUT_CSV,
+    OUTPUT_JSON,
+};
+
+struct result
+{
+    struct vlc_run_stats stats;
+    long peak_rss; /* KiB */
+    long heap; /* KiB, heap size at the end of the run */
+    int status;
+};
+
+static const char *demux_name = NULL;
+static unsigned stages = (1 << VLC_RUN_DEMUX) | (1 << VLC_RUN_PACKETIZE)
+                       | (1 << VLC_RUN_DECODE);
+static unsigned runs = 3;
+static enum output_format output = OUTPUT_TEXT;
+static unsigned verbose = 0;
+
+static void usage(const char *name, int ret)
+{
+    fprintf(stderr,
+            "Usage: %s [-s stage[,stage...]] [-n runs] [-f text|csv|json]\n"
+            "          [-m demux] [-v] <file> [file...]\n"
+            "\n"
+            "  -s  stages to run among demux, packetize and decode\n"
+            "      (default: all)\n"
+            "  -n  runs of each stage, the fastest is reported (default: 3)\n"
+            "  -f  output format, csv and json (one object per line) are\n"
+            "      meant to be compared between versions (default: text)\n"
+            "  -m  demux module to use (default: probe)\n",
+            name);
+    exit(ret);
+}
+
+static void parse_stages(const char *name, const char *str)
+{
+    char *list = strdup(str);
+    if (list == NULL)
+        exit(1);
+
+    stages = 0;
+    for (char *save, *s = strtok_r(list, ",", &save); s != NULL;
+         s = strtok_r(NULL, ",", &save))
+    {
+        size_t i = 0;
+        while (i < ARRAY_SIZE(stage_names) && strcmp(s, stage_names[i]))
+            i++;
+        if (i == ARRAY_SIZE(stage_names))
+        {
+            fprintf(stderr, "Unknown stage: %s\n", s);
+            usage(name, 1);
+        }
+        stages |= 1 << i;
+    }
+    free(list);
+
+    if (stages == 0)
+        usage(name, 1);
+}
+
+/* extracts options from command line */
+static void cmdline(int argc, char *argv[])
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "f:hm:n:s:v")) != -1)
+    {
+        switch (opt)
+        {
+            case 'f':
+                if (!strcmp(optarg, "text"))
+                    output = OUTPUT_TEXT;
+                else if (!strcmp(optarg, "csv"))
+                    output = OUTPUT_CSV;
+                else if (!strcmp(optarg, "json"))
+                    output = OUTPUT_JSON;
+                else
+                    usage(argv[0], 1);
+                break;
+
+            case 'h':
+                usage(argv[0], 0);
+                break;
+
+            case 'm':
+                demux_name = optarg;
+                break;
+
+            case 'n':
+                runs = strtoul(optarg, NULL, 0);
+                if (runs == 0)
+                    usage(argv[0], 1);
+                break;
+
+            case 's':
+                parse_stages(argv[0], optarg);
+                break;
+
+            case 'v':
+                verbose++;
+                break;
+
+            default:
+                usage(argv[0], 1);
+                break;
+        }
+    }
+
+    if (optind >= argc)
+        usage(argv[0], 1);
+}
+
+static void RunStage(const char *path, enum vlc_run_stage stage,
+                     struct result *res)
+{
+    struct vlc_run_args args;
+
+    vlc_run_args_init(&args);
+    if (demux_name != NULL)
+        args.name = demux_name;
+    if (verbose > 0)
+        args.verbose = verbose;
+    args.stage = stage;
+    args.stats = &res->stats;
+
+    memset(res, 0, sizeof (*res));
+    res->status = vlc_demux_process_path(&args, path);
+
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+# ifdef __APPLE__
+        res->peak_rss = usage.ru_maxrss / 1024; /* in bytes */
+# else
+        res->peak_rss = usage.ru_maxrss;
+# endif
+#endif
+#ifdef HAVE_MALLINFO2
+    struct mallinfo2 info = mallinfo2();
+    res->heap = (info.arena + info.hblkhd) / 1024;
+#endif
+}
+
+/* Runs a stage in a child process, with its own LibVLC instance */
+static void Run(const char *path, enum vlc_run_stage stage,
+                struct result *res)
+{
+#ifndef _WIN32
+    int fds[2];
+
+    fflush(stdout);
+    if (pipe(fds) == 0)
+    {
+        pid_t pid = fork();
+
+        if (pid == 0)
+        {
+            close(fds[0]);
+            RunStage(path, stage, res);
+            ssize_t val = write(fds[1], res, sizeof (*res));
+            _exit(val == (ssize_t) sizeof (*res) ? 0 : 1);
+        }
+
+        close(fds[1]);
+        if (pid != -1)
+        {
+            ssize_t val = read(fds[0], res, sizeof (*res));
+
+            while (waitpid(pid, NULL, 0) == -1 && errno == EINTR);
+            close(fds[0]);
+            if (val != (ssize_t) sizeof (*res))
+            {
+                memset(res, 0, sizeof (*res));
+                res->status = -1; /* the child crashed */
+            }
+            return;
+        }
+        close(fds[0]);
+    }
+#endif
+    /* no process isolation, the memory use is cumulative */
+    RunStage(path, stage, res);
+}
+
+static void PrintString(const char *str)
+{
+    putchar('"');
+    for (const char *p = str; *p != '\0'; p++)
+    {
+        unsigned char c = *p;
+
+        if (c == '"' || c == '\\')
+            printf("\\%c", c);
+        else if (c < 0x20)
+            printf("\\u%04x", c);
+        else
+            putchar(c);
+    }
+    putchar('"');
+}
+
+static void PrintHeader(void)
+{
+    switch (output)
+    {
+        case OUTPUT_TEXT:
+            printf("%-9s %-10s %10s %9s %12s %10s %10s %9s  %s\n", "stage",
+                   "demux", "MB", "MB/s", "packets/s", "packetized",
+                   "decoded", "RSS KiB", "file");
+            break;
+        case OUTPUT_CSV:
+            puts("file,stage,status,demux,bytes,seconds,mb_per_sec,packets,"
+                 "packets_per_sec,packetized,decoded,peak_rss_kib,heap_kib");
+            break;
+        case OUTPUT_JSON:
+            break;
+    }
+}
+
+static void PrintResult(const char *path, enum vlc_run_stage stage,
+                        const struct result *res)
+{
+    const struct vlc_run_stats *stats = &res->stats;
+    double seconds = stats->elapsed > 0 ? secf_from_vlc_tick(stats->elapsed)
+                                        : 1e-6;
+    double mbps = stats->bytes / seconds / 1e6;
+    double pps = stats->packets / seconds;
+
+    switch (output)
+    {
+        case OUTPUT_TEXT:
+            printf("%-9s %-10s %10.1f %9.1f %12.0f %10"PRIu64" %10"PRIu64
+                   " %9ld  %s%s\n", stage_names[stage], stats->demux,
+                   stats->bytes / 1e6, mbps, pps, stats->packetized,
+                   stats->decoded, res->peak_rss, path,
+                   res->status ? " (failed)" : "");
+            break;
+
+        case OUTPUT_CSV:
+            putchar('"');
+            for (const char *p = path; *p != '\0'; p++)
+            {
+                if (*p == '"')
+                    putchar('"');
+                putchar(*p);
+            }
+            printf("\",%s,%d,%s,%"PRIu64",%.6f,%.3f,%"PRIu64",%.1f,%"PRIu64
+                   ",%"PRIu64",%ld,%ld\n", stage_names[stage], res->status,
+                   stats->demux, stats->bytes, seconds, mbps, stats->packets,
+                   pps, stats->packetized, stats->decoded, res->peak_rss,
+                   res->heap);
+            break;
+
+        case OUTPUT_JSON:
+            printf("{\"file\":");
+            PrintString(path);
+            printf(",\"stage\":\"%s\",\"status\":%d,\"demux\":",
+                   stage_names[stage], res->status);
+            PrintString(stats->demux);
+            printf(",\"bytes\":%"PRIu64",\"seconds\":%.6f,\"mb_per_sec\":%.3f,"
+                   "\"packets\":%"PRIu64",\"packets_per_sec\":%.1f,"
+                   "\"packetized\":%"PRIu64",\"decoded\":%"PRIu64","
+                   "\"peak_rss_kib\":%ld,\"heap_kib\":%ld}\n",
+                   stats->bytes, seconds, mbps, stats->packets, pps,
+                   stats->packetized, stats->decoded, res->peak_rss,
+                   res->heap);
+            break;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int ret = 0;
+
+    cmdline(argc, argv);
+    PrintHeader();
+
+    for (int i = optind; i < argc; i++)
+    {
+        const char *path = argv[i];
+
+        for (size_t j = 0; j < ARRAY_SIZE(stage_order); j++)
+        {
+            enum vlc_run_stage stage = stage_order[j];
+            if (!(stages & (1 << stage)))
+                continue;
+
+            struct result best, res;
+            long peak_rss = 0, heap = 0;
+
+            for (unsigned n = 0; n < runs; n++)
+            {
+                Run(path, stage, &res);
+                if (n == 0 || res.stats.elapsed < best.stats.elapsed)
+                    best = res;
+                peak_rss = __MAX(peak_rss, res.peak_rss);
+                heap = __MAX(heap, res.heap);
+                if (res.status != 0)
+                {
+                    best = res; /* do not insist on broken files */
+                    break;
+                }
+            }
+            best.peak_rss = peak_rss;
+            best.heap = heap;
+
+            PrintResult(path, stage, &best);
+            if (best.status != 0)
+                ret = 1;
+        }
+    }
+    return ret;
+}
@@ -0,0 +1,577 @@
+/*****************************************************************************
+ * vlc-filter-bench.c: benchmark driver for video filters and converters
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Instantiates one "video filter", "video converter" or "video blending"
+ * module and runs it on the same pictures a number of times, e.g.:
+ *
+ *   vlc-filter-bench -m 'deinterlace{mode=yadif}' -i I420
+ *   vlc-filter-bench -c converter -i I420 -o RGBX -s 3840x2160
+ *   vlc-filter-bench -c blend -i YUVA -o NV12 -s 1920x1080 -S 800x200
+ *
+ * The pictures are filled with noise, unless an image file is given.
+ *
+ * Audio resamplers run on noise blocks of float samples, e.g. to compare
+ * their cost while the input rate drifts by 20Hz:
+ *
+ *   vlc-filter-bench -c resampler -m soxr -r 44100:48000 -d 20 */
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <locale.h>
+
+#include <vlc/vlc.h>
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_block.h>
+#include <vlc_configuration.h>
+#include <vlc_filter.h>
+#include <vlc_fourcc.h>
+#include <vlc_image.h>
+#include <vlc_picture.h>
+#include <vlc_tick.h>
+#include <vlc_url.h>
+
+#include "../lib/libvlc_internal.h"
+
+static const struct
+{
+    const char *name;
+    const char *capability;
+} bench_types[] = {
+    { "filter",    "video filter" },
+    { "converter", "video converter" },
+    { "blend",     "video blending" },
+    { "resampler", "audio resampler" },
+};
+
+static const char *capability = "video filter";
+static const char *module = NULL;
+static const char *image_path = NULL;
+static vlc_fourcc_t chroma_in = VLC_CODEC_I420;
+static vlc_fourcc_t chroma_out = 0;
+static unsigned width = 1920, height = 1080;
+static unsigned width_out = 0, height_out = 0;
+static unsigned rate_in = 44100, rate_out = 48000;
+static unsigned channels = 2;
+static unsigned drift = 0;
+static unsigned iterations = 1000;
+static unsigned warmup = 10;
+static int verbosity = 0;
+
+static void usage(const char *name, int ret)
+{
+    fprintf(stderr,
+            "Usage: %s [-c filter|converter|blend] [-m module{options}]\n"
+            "          [-i chroma] [-o chroma] [-s WxH] [-S WxH]\n"
+            "          [-f image] [-n iterations] [-w warmup] [-v]\n"
+            "       %s -c resampler [-m module{options}] [-r IN:OUT]\n"
+            "          [-C channels] [-d Hz] [-n iterations] [-w warmup] [-v]\n"
+            "\n"
+            "  -c  module type (default: filter)\n"
+            "  -m  module name and options, in filter chain syntax\n"
+            "  -i  input chroma (default: I420)\n"
+            "  -o  output chroma (default: the input chroma)\n"
+            "  -s  input size, or destination size when blending\n"
+            "      (default: 1920x1080)\n"
+            "  -S  output size, or blended picture size (default: -s)\n"
+            "  -f  image to load instead of noise\n"
+            "  -n  timed iterations (default: 1000)\n"
+            "  -w  untimed iterations run first (default: 10)\n"
+            "  -r  resampler input and output rates (default: 44100:48000)\n"
+            "  -C  resampler channels (default: 2)\n"
+            "  -d  input rate change alternated on every block, as drift\n"
+            "      compensation does (default: 0)\n",
+            name, name);
+    exit(ret);
+}
+
+static void parse_size(const char *name, const char *str,
+                       unsigned *w, unsigned *h)
+{
+    if (sscanf(str, "%ux%u", w, h) != 2 || *w == 0 || *h == 0)
+        usage(name, 1);
+}
+
+static vlc_fourcc_t parse_chroma(const char *name, const char *str)
+{
+    vlc_fourcc_t fcc = vlc_fourcc_GetCodecFromString(VIDEO_ES, str);
+
+    if (fcc == 0)
+    {
+        fprintf(stderr, "Unknown chroma: %s\n", str);
+        usage(name, 1);
+    }
+    return fcc;
+}
+
+/* extracts options from command line */
+static void cmdline(int argc, char *argv[])
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "c:C:d:f:hi:m:n:o:r:s:S:vw:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'C':
+                channels = strtoul(optarg, NULL, 0);
+                if (channels == 0 || channels >= ARRAY_SIZE(vlc_chan_maps))
+                    usage(argv[0], 1);
+                break;
+
+            case 'd':
+                drift = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'r':
+                if (sscanf(optarg, "%u:%u", &rate_in, &rate_out) != 2
+                 || rate_in == 0 || rate_out == 0)
+                    usage(argv[0], 1);
+                break;
+
+            case 'c':
+                capability = NULL;
+                for (size_t i = 0; i < ARRAY_SIZE(bench_types); i++)
+                    if (!strcmp(optarg, bench_types[i].name))
+                        capability = bench_types[i].capability;
+                if (capability == NULL)
+                    usage(argv[0], 1);
+                break;
+
+            case 'f':
+                image_path = optarg;
+                break;
+
+            case 'h':
+                usage(argv[0], 0);
+                break;
+
+            case 'i':
+                chroma_in = parse_chroma(argv[0], optarg);
+                break;
+
+            case 'm':
+                module = optarg;
+                break;
+
+            case 'n':
+                iterations = strtoul(optarg, NULL, 0);
+                if (iterations == 0)
+                    usage(argv[0], 1);
+                break;
+
+            case 'o':
+                chroma_out = parse_chroma(argv[0], optarg);
+                break;
+
+            case 's':
+                parse_size(argv[0], optarg, &width, &height);
+                break;
+
+            case 'S':
+                parse_size(argv[0], optarg, &width_out, &height_out);
+                break;
+
+            case 'v':
+                verbosity++;
+                if (verbosity > 2)
+                    verbosity = 2;
+                break;
+
+            case 'w':
+                warmup = strtoul(optarg, NULL, 0);
+                break;
+
+            default:
+                usage(argv[0], 1);
+                break;
+        }
+    }
+
+    if (chroma_out == 0)
+        chroma_out = chroma_in;
+    if (width_out == 0)
+    {
+        width_out = width;
+        height_out = height;
+    }
+}
+
+static libvlc_instance_t *create_libvlc(void)
+{
+    char verbose_flag[2] = "0";
+    verbose_flag[0] = '0' + verbosity;
+    const char* const args[] = {
+        "--verbose", verbose_flag,
+    };
+
+    return libvlc_new(sizeof args / sizeof *args, args);
+}
+
+static void InitFormat(video_format_t *fmt, vlc_fourcc_t chroma,
+                       unsigned w, unsigned h)
+{
+    video_format_Init(fmt, chroma);
+    fmt->i_width = fmt->i_visible_width = w;
+    fmt->i_height = fmt->i_visible_height = h;
+    fmt->i_sar_num = fmt->i_sar_den = 1;
+    fmt->i_frame_rate = 25;
+    fmt->i_frame_rate_base = 1;
+}
+
+static void FillNoise(picture_t *pic)
+{
+    uint32_t seed = 0x12345678;
+
+    for (int i = 0; i < pic->i_planes; i++)
+    {
+        plane_t *p = &pic->p[i];
+
+        for (int y = 0; y < p->i_lines; y++)
+        {
+            uint8_t *line = &p->p_pixels[y * p->i_pitch];
+
+            for (int x = 0; x < p->i_pitch; x++)
+            {
+                seed = seed * 1664525 + 1013904223;
+                line[x] = seed >> 24;
+            }
+        }
+    }
+}
+
+static picture_t *CreatePicture(vlc_object_t *obj, const video_format_t *fmt)
+{
+    picture_t *pic;
+
+    if (image_path != NULL)
+    {
+        image_handler_t *ih = image_HandlerCreate(obj);
+        if (ih == NULL)
+            return NULL;
+
+        video_format_t fmt_out = *fmt;
+
+        char *url = vlc_path2uri(image_path, NULL);
+        pic = url != NULL ? image_ReadUrl(ih, url, &fmt_out) : NULL;
+        free(url);
+        image_HandlerDelete(ih);
+
+        if (pic != NULL && (fmt_out.i_visible_width != fmt->i_visible_width
+                         || fmt_out.i_visible_height != fmt->i_visible_height))
+        {
+            fprintf(stderr, "Cannot scale %s to %ux%u\n", image_path,
+                    fmt->i_visible_width, fmt->i_visible_height);
+            picture_Release(pic);
+            pic = NULL;
+        }
+        video_format_Clean(&fmt_out);
+    }
+    else
+    {
+        pic = picture_NewFromFormat(fmt);
+        if (pic != NULL)
+            FillNoise(pic);
+    }
+
+    if (pic == NULL)
+        fprintf(stderr, "Cannot create a %4.4s %ux%u picture\n",
+                (const char *)&fmt->i_chroma, fmt->i_visible_width,
+                fmt->i_visible_height);
+    return pic;
+}
+
+/* Bytes of the visible area of a picture */
+static uint64_t PictureBytes(const picture_t *pic)
+{
+    uint64_t bytes = 0;
+
+    for (int i = 0; i < pic->i_planes; i++)
+        bytes += (uint64_t)pic->p[i].i_visible_pitch
+               * pic->p[i].i_visible_lines;
+    return bytes;
+}
+
+static picture_t *NewOutputPicture(filter_t *filter)
+{
+    return picture_NewFromFormat(&filter->fmt_out.video);
+}
+
+static const struct filter_video_callbacks video_cbs = {
+    .buffer_new = NewOutputPicture,
+};
+
+/* Runs the filter once, returns the number of bytes output */
+static uint64_t RunFilter(filter_t *filter, picture_t *in, vlc_tick_t date)
+{
+    picture_t *pic = picture_Hold(in);
+    uint64_t bytes = 0;
+
+    pic->date = date;
+    pic = filter->ops->filter_video(filter, pic);
+    while (pic != NULL)
+    {
+        picture_t *next = pic->p_next;
+
+        bytes += PictureBytes(pic);
+        pic->p_next = NULL;
+        picture_Release(pic);
+        pic = next;
+    }
+    return bytes;
+}
+
+static void InitAudioFormat(es_format_t *fmt, unsigned rate)
+{
+    es_format_Init(fmt, AUDIO_ES, VLC_CODEC_FL32);
+    fmt->audio.i_format = VLC_CODEC_FL32;
+    fmt->audio.i_rate = rate;
+    fmt->audio.i_physical_channels = vlc_chan_maps[channels];
+    fmt->audio.i_chan_mode = 0;
+    aout_FormatPrepare(&fmt->audio);
+}
+
+static int BenchAudio(vlc_object_t *root)
+{
+    const unsigned frames = 1024;
+    char *name = NULL;
+    config_chain_t *cfg = NULL;
+    int ret = -1;
+
+    if (module != NULL)
+        free(config_ChainCreate(&name, &cfg, module));
+
+    filter_t *filter = vlc_object_create(root, sizeof (*filter));
+    if (filter == NULL)
+        goto out;
+
+    InitAudioFormat(&filter->fmt_in, rate_in);
+    InitAudioFormat(&filter->fmt_out, rate_out);
+    filter->psz_name = name;
+    filter->p_cfg = cfg;
+
+    float *noise = vlc_alloc(frames * channels, sizeof (*noise));
+    if (noise == NULL)
+        goto error;
+
+    uint32_t seed = 0x12345678;
+    for (unsigned i = 0; i < frames * channels; i++)
+    {
+        seed = seed * 1664525 + 1013904223;
+        noise[i] = (int32_t)seed * 0x1.p-31f;
+    }
+
+    if (vlc_filter_LoadModule(filter, capability, name, name != NULL) == NULL)
+    {
+        fprintf(stderr, "No %s module for %u channels %uHz -> %uHz\n",
+                capability, channels, rate_in, rate_out);
+        goto error;
+    }
+
+    const vlc_tick_t block_duration = vlc_tick_from_samples(frames, rate_in);
+    vlc_tick_t date = VLC_TICK_0, elapsed = 0;
+    uint64_t frames_out = 0;
+
+    for (unsigned i = 0; i < warmup + iterations; i++, date += block_duration)
+    {
+        block_t *block = block_Alloc(frames * channels * sizeof (*noise));
+        if (block == NULL)
+            break;
+        memcpy(block->p_buffer, noise, block->i_buffer);
+        block->i_nb_samples = frames;
+        block->i_pts = block->i_dts = date;
+        block->i_length = block_duration;
+
+        /* Alternate around the nominal rate, as the audio output would */
+        filter->fmt_in.audio.i_rate = (i & 1) ? rate_in + drift
+                                             : rate_in - drift;
+
+        vlc_tick_t start = vlc_tick_now();
+        block = filter->ops->filter_audio(filter, block);
+        if (i >= warmup)
+        {
+            elapsed += vlc_tick_now() - start;
+            if (block != NULL)
+                frames_out += block->i_nb_samples;
+        }
+        if (block != NULL)
+            block_Release(block);
+    }
+    filter->fmt_in.audio.i_rate = rate_in;
+
+    if (elapsed <= 0)
+        elapsed = 1;
+
+    /* Cost of a second of audio of one channel */
+    const double channel_seconds = (double)iterations * frames * channels
+                                 / rate_in;
+
+    printf("%s%s%s: %u channels %uHz -> %uHz, drift %uHz\n",
+           capability, name != NULL ? " " : "", name != NULL ? name : "",
+           channels, rate_in, rate_out, drift);
+    printf("%u iterations in %.3f s: %.0f ns/block, %.1f us/channel-second, "
+           "%"PRIu64" frames out\n",
+           iterations, secf_from_vlc_tick(elapsed),
+           (double)NS_FROM_VLC_TICK(elapsed) / iterations,
+           (double)US_FROM_VLC_TICK(elapsed) / channel_seconds, frames_out);
+    ret = 0;
+
+    vlc_filter_UnloadModule(filter);
+error:
+    free(noise);
+    es_format_Clean(&filter->fmt_in);
+    es_format_Clean(&filter->fmt_out);
+    vlc_object_delete(filter);
+out:
+    config_ChainDestroy(cfg);
+    free(name);
+    return ret;
+}
+
+static int Bench(vlc_object_t *root)
+{
+    const bool blend = !strcmp(capability, "video blending");
+    video_format_t fmt_in, fmt_out;
+    char *name = NULL;
+    config_chain_t *cfg = NULL;
+    int ret = -1;
+
+    InitFormat(&fmt_in, chroma_in, blend ? width_out : width,
+               blend ? height_out : height);
+    InitFormat(&fmt_out, chroma_out, blend ? width : width_out,
+               blend ? height : height_out);
+
+    if (module != NULL)
+        free(config_ChainCreate(&name, &cfg, module));
+
+    filter_t *filter = vlc_object_create(root, sizeof (*filter));
+    if (filter == NULL)
+        goto out;
+
+    es_format_Init(&filter->fmt_in, VIDEO_ES, chroma_in);
+    video_format_Copy(&filter->fmt_in.video, &fmt_in);
+    es_format_Init(&filter->fmt_out, VIDEO_ES, chroma_out);
+    video_format_Copy(&filter->fmt_out.video, &fmt_out);
+    filter->psz_name = name;
+    filter->p_cfg = cfg;
+    filter->owner.video = &video_cbs;
+
+    picture_t *src = CreatePicture(root, &fmt_in);
+    picture_t *dst = blend ? CreatePicture(root, &fmt_out) : NULL;
+    if (src == NULL || (blend && dst == NULL))
+        goto error;
+
+    if (vlc_filter_LoadModule(filter, capability, name, name != NULL) == NULL)
+    {
+        fprintf(stderr, "No %s module for %4.4s %ux%u -> %4.4s %ux%u\n",
+                capability, (const char *)&chroma_in, fmt_in.i_visible_width,
+                fmt_in.i_visible_height, (const char *)&chroma_out,
+                fmt_out.i_visible_width, fmt_out.i_visible_height);
+        goto error;
+    }
+
+    const vlc_tick_t frame_duration = VLC_TICK_FROM_MS(40);
+    vlc_tick_t date = VLC_TICK_0;
+    uint64_t bytes = 0;
+
+    for (unsigned i = 0; i < warmup; i++, date += frame_duration)
+    {
+        if (blend)
+            filter->ops->blend_video(filter, dst, src, 0, 0, 255);
+        else
+            RunFilter(filter, src, date);
+    }
+
+    vlc_tick_t start = vlc_tick_now();
+    for (unsigned i = 0; i < iterations; i++, date += frame_duration)
+    {
+        if (blend)
+        {
+            filter->ops->blend_video(filter, dst, src, 0, 0, 255);
+            bytes += 2 * PictureBytes(src);
+        }
+        else
+            bytes += PictureBytes(src) + RunFilter(filter, src, date);
+    }
+    vlc_tick_t elapsed = vlc_tick_now() - start;
+
+    if (elapsed <= 0)
+        elapsed = 1;
+
+    printf("%s%s%s: %4.4s %ux%u -> %4.4s %ux%u\n",
+           capability, name != NULL ? " " : "", name != NULL ? name : "",
+           (const char *)&chroma_in, fmt_in.i_visible_width,
+           fmt_in.i_visible_height, (const char *)&chroma_out,
+           fmt_out.i_visible_width, fmt_out.i_visible_height);
+    printf("%u iterations in %.3f s: %.0f ns/frame, %.3f GB/s\n",
+           iterations, secf_from_vlc_tick(elapsed),
+           (double)NS_FROM_VLC_TICK(elapsed) / iterations,
+           (double)bytes / NS_FROM_VLC_TICK(elapsed));
+    ret = 0;
+
+    vlc_filter_UnloadModule(filter);
+error:
+    if (dst != NULL)
+        picture_Release(dst);
+    if (src != NULL)
+        picture_Release(src);
+    es_format_Clean(&filter->fmt_in);
+    es_format_Clean(&filter->fmt_out);
+    vlc_object_delete(filter);
+out:
+    config_ChainDestroy(cfg);
+    free(name);
+    video_format_Clean(&fmt_in);
+    video_format_Clean(&fmt_out);
+    return ret;
+}
+
+int main(int argc, char *argv[])
+{
+#ifdef TOP_BUILDDIR
+    setenv ("VLC_PLUGIN_PATH", TOP_BUILDDIR"/modules", 1);
+    setenv ("VLC_DATA_PATH", TOP_SRCDIR"/share", 1);
+    setenv ("VLC_LIB_PATH", TOP_BUILDDIR"/modules", 1);
+#endif
+
+    /* mandatory to support UTF-8 filenames (provided the locale is well set)*/
+    setlocale(LC_ALL, "");
+
+    cmdline(argc, argv);
+
+    /* starts vlc */
+    libvlc_instance_t *libvlc = create_libvlc();
+    assert(libvlc);
+
+    int ret = !strcmp(capability, "audio resampler")
+            ? BenchAudio(&libvlc->p_libvlc_int->obj)
+            : Bench(&libvlc->p_libvlc_int->obj);
+
+    libvlc_release(libvlc);
+    return ret;
+}